@@ -55,6 +55,7 @@
 #include <utils/mnemath.h>
 
 #include <iostream>
+#include <functional>
 
 
 //*************************************************************************************************************
@@ -71,6 +72,71 @@ using namespace UTILSLIB;
 using namespace INVERSELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+QVariant computeMNE(const QString& evokedFile, const QString& invFile, int setno, float lambda2, const QString& method, AnalyzeTask& task)
+{
+    //*********************************************************************************************************
+    // LOAD DATA
+    //*********************************************************************************************************
+
+    QFile t_fileEvoked(evokedFile);
+    QFile t_fileInv(invFile);
+
+    //
+    //   Read the data first
+    //
+    QPair<QVariant, QVariant> baseline(QVariant(), 0);
+
+    FiffEvoked evoked(t_fileEvoked, setno, baseline);
+    if(evoked.isEmpty())
+        return QVariant();
+
+    task.setProgress(20);
+
+    //
+    //   Read the inverse operator
+    //
+    MNEInverseOperator inverse_operator(t_fileInv);
+
+    if(task.isCanceled())
+        return QVariant();
+
+    task.setProgress(50);
+
+
+    //*********************************************************************************************************
+    // Compute MNE
+    //*********************************************************************************************************
+
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compute MNE for %s >>>>>>>>>>>>>>>>>>>>>>>>>\n", evoked.comment.toUtf8().constData());
+
+    //
+    // Compute inverse solution
+    //
+    MinimumNorm minimumNorm(inverse_operator, lambda2, method);
+    MNESourceEstimate sourceEstimate = minimumNorm.calculateInverse(evoked);
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compute MNE Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+
+    task.setProgress(100);
+
+    std::cout << "\npart ( block( 0, 0, 10, 10) ) of the inverse solution:\n" << sourceEstimate.data.block(0,0,10,10) << std::endl;
+    printf("tmin = %f s\n", sourceEstimate.tmin);
+    printf("tstep = %f s\n", sourceEstimate.tstep);
+
+    return QVariant::fromValue(sourceEstimate);
+}
+
+} // namespace
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -179,61 +245,31 @@ void InvMNE::calculate()
 
     int setno = 0;
 
-
     //*********************************************************************************************************
-    // LOAD DATA
+    // Reuse a previous MNE Solution with the same data and settings
     //*********************************************************************************************************
 
-    QFile t_fileEvoked(evokedFile);
-    QFile t_fileInv(invFile);
-
-    bool dSPM = false;
-    bool sLORETA = false;
-
-    if(method == "dSPM") {
-        dSPM = true;
-    } else if(method == "sLORETA") {
-        sLORETA = true;
-    }
-
-    //
-    //   Read the data first
-    //
-    QPair<QVariant, QVariant> baseline(QVariant(), 0);
+    QString sKey = AnalyzeData::resultKey(getName(), QStringList() << evokedFile << invFile, QVariantList() << setno << lambda2 << method);
 
-    FiffEvoked evoked(t_fileEvoked, setno, baseline);
-    if(evoked.isEmpty())
+    if(globalData()->hasResult(sKey)) {
+        printf("Reusing the MNE solution computed before\n");
+        globalData()->addSTC(globalData()->result(sKey).value<MNESourceEstimate>());
         return;
-
-    //
-    //   Read the inverse operator
-    //
-    MNEInverseOperator inverse_operator(t_fileInv);
-
-
-    //*********************************************************************************************************
-    // Compute MNE
-    //*********************************************************************************************************
-
-
-    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compute MNE for %s >>>>>>>>>>>>>>>>>>>>>>>>>\n", evoked.comment.toUtf8().constData());
-
-    //
-    // Compute inverse solution
-    //
-    MinimumNorm minimumNorm(inverse_operator, lambda2, method);
-    MNESourceEstimate sourceEstimate = minimumNorm.calculateInverse(evoked);
-
-    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compute MNE Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
-
+    }
 
     //*********************************************************************************************************
-    // Store MNE Solution
+    // Compute MNE in the background and store the MNE Solution
     //*********************************************************************************************************
 
-    std::cout << "\npart ( block( 0, 0, 10, 10) ) of the inverse solution:\n" << sourceEstimate.data.block(0,0,10,10) << std::endl;
-    printf("tmin = %f s\n", sourceEstimate.tmin);
-    printf("tstep = %f s\n", sourceEstimate.tstep);
-
-    globalData()->addSTC(sourceEstimate);
+    QSharedPointer<AnalyzeData> pData = globalData();
+
+    globalData()->taskScheduler()->submit(getName(),
+                                          std::bind(computeMNE, evokedFile, invFile, setno, lambda2, method, std::placeholders::_1),
+                                          [pData, sKey](const QVariant& result) {
+                                              if(!result.isValid()) {
+                                                  return;
+                                              }
+                                              pData->cacheResult(sKey, result);
+                                              pData->addSTC(result.value<MNESourceEstimate>());
+                                          });
 }
@@ -41,6 +41,7 @@
 #include "music.h"
 #include "FormFiles/musiccontrol.h"
 
+#include <anShared/Management/analyzedata.h>
 
 #include <fs/label.h>
 #include <fs/surface.h>
@@ -63,10 +64,13 @@
 #include <utils/mnemath.h>
 
 #include <iostream>
+#include <functional>
 
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QFuture>
+#include <QFileInfo>
 
 
 
@@ -85,6 +89,133 @@ using namespace UTILSLIB;
 using namespace DISP3DLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+QVariant computeRapMusic(const QString& fwdFileOption, const QString& evokedFileOption, const QString& subjectOption, const QString& subjectDirectoryOption, const QString& annotOption, const QString& surfOption, const QString& t_sFileNameStc, qint32 numDipolePairs, bool doMovie, AnalyzeTask& task)
+{
+    //Load data
+    QFile t_fileFwd(fwdFileOption);
+    QFile t_fileEvoked(evokedFileOption);
+    QString subject(subjectOption);
+    QString subjectDir(subjectDirectoryOption);
+
+    //The subject is read while the measurement and the forward solution are loaded
+    QFuture<AnnotationSet> t_futureAnnotationSet = AnnotationSet::readAsync(subject, 2, annotOption, subjectDir);
+    QFuture<SurfaceSet> t_futureSurfSet = SurfaceSet::readAsync(subject, 2, surfOption, subjectDir);
+
+
+    // Load data
+    fiff_int_t setno = 1;
+    QPair<QVariant, QVariant> baseline(QVariant(), 0);
+    FiffEvoked evoked(t_fileEvoked, setno, baseline);
+    if(evoked.isEmpty())
+        return QVariant();
+
+    std::cout << "evoked first " << evoked.first << "; last " << evoked.last << std::endl;
+
+    MNEForwardSolution t_Fwd(t_fileFwd);
+    if(t_Fwd.isEmpty())
+        return QVariant();
+
+    QStringList ch_sel_names = t_Fwd.info.ch_names;
+    FiffEvoked pickedEvoked = evoked.pick_channels(ch_sel_names);
+
+    AnnotationSet t_annotationSet = t_futureAnnotationSet.result();
+    SurfaceSet t_surfSet = t_futureSurfSet.result();
+
+    if(task.isCanceled())
+        return QVariant();
+
+    task.setProgress(30);
+
+    //
+    // Cluster forward solution;
+    //
+    MNEForwardSolution t_clusteredFwd = t_Fwd.cluster_forward_solution(t_annotationSet, 20);//40);
+
+//    std::cout << "Size " << t_clusteredFwd.sol->data.rows() << " x " << t_clusteredFwd.sol->data.cols() << std::endl;
+//    std::cout << "Clustered Fwd:\n" << t_clusteredFwd.sol->data.row(0) << std::endl;
+
+    if(task.isCanceled())
+        return QVariant();
+
+    task.setProgress(60);
+
+    RapMusic t_rapMusic(t_clusteredFwd, false, numDipolePairs);
+
+    int iWinSize = 200;
+    if(doMovie) {
+        t_rapMusic.setStcAttr(iWinSize, 0.6f);
+    }
+
+    MNESourceEstimate sourceEstimate = t_rapMusic.calculateInverse(pickedEvoked);
+
+    if(doMovie) {
+        //Select only the activations once
+        MatrixXd dataPicked(sourceEstimate.data.rows(), int(std::floor(sourceEstimate.data.cols()/iWinSize)));
+
+        for(int i = 0; i < dataPicked.cols(); ++i) {
+            dataPicked.col(i) = sourceEstimate.data.col(i*iWinSize);
+        }
+
+        sourceEstimate.data = dataPicked;
+    }
+
+    //Select only the activations once
+    MatrixXd dataPicked(sourceEstimate.data.rows(), int(std::floor(sourceEstimate.data.cols()/iWinSize)));
+
+    for(int i = 0; i < dataPicked.cols(); ++i) {
+        dataPicked.col(i) = sourceEstimate.data.col(i*iWinSize);
+    }
+
+    sourceEstimate.data = dataPicked;
+
+    if(sourceEstimate.isEmpty())
+        return QVariant();
+
+//    //Visualize the results
+//    View3D::SPtr testWindow = View3D::SPtr(new View3D());
+//    Data3DTreeModel::SPtr p3DDataModel = Data3DTreeModel::SPtr(new Data3DTreeModel());
+
+//    testWindow->setModel(p3DDataModel);
+
+//    p3DDataModel->addSurfaceSet(parser.value(subjectOption), evoked.comment, t_surfSet, t_annotationSet);
+
+//    //Add rt source loc data and init some visualization values
+//    if(MneEstimateTreeItem* pRTDataItem = p3DDataModel->addSourceData(parser.value(subjectOption), evoked.comment, sourceEstimate, t_clusteredFwd)) {
+//        pRTDataItem->setLoopState(true);
+//        pRTDataItem->setTimeInterval(17);
+//        pRTDataItem->setNumberAverages(1);
+//        pRTDataItem->setStreamingState(true);
+//        pRTDataItem->setNormalization(QVector3D(0.01,0.5,1.0));
+//        pRTDataItem->setVisualizationType("Annotation based");
+//        pRTDataItem->setColortable("Hot");
+//    }
+//    testWindow->show();
+
+//    Control3DWidget::SPtr control3DWidget = Control3DWidget::SPtr(new Control3DWidget());
+//    control3DWidget->init(p3DDataModel, testWindow);
+//    control3DWidget->show();
+
+    if(!t_sFileNameStc.isEmpty())
+    {
+        QFile t_fileClusteredStc(t_sFileNameStc);
+        sourceEstimate.write(t_fileClusteredStc);
+    }
+
+    task.setProgress(100);
+
+    return QVariant::fromValue(sourceEstimate);
+}
+
+} // namespace
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -188,101 +319,27 @@ void Music::calculate()
 
     bool doMovie = false;
 
-    //Load data
-    QFile t_fileFwd(fwdFileOption);
-    QFile t_fileEvoked(evokedFileOption);
-    QString subject(subjectOption);
-    QString subjectDir(subjectDirectoryOption);
-
-    AnnotationSet t_annotationSet(subject, 2, annotOption, subjectDir);
-    SurfaceSet t_surfSet(subject, 2, surfOption, subjectDir);
-
-
-    // Load data
-    fiff_int_t setno = 1;
-    QPair<QVariant, QVariant> baseline(QVariant(), 0);
-    FiffEvoked evoked(t_fileEvoked, setno, baseline);
-    if(evoked.isEmpty())
-        return;
-
-    std::cout << "evoked first " << evoked.first << "; last " << evoked.last << std::endl;
-
-    MNEForwardSolution t_Fwd(t_fileFwd);
-    if(t_Fwd.isEmpty())
-        return;
-
-    QStringList ch_sel_names = t_Fwd.info.ch_names;
-    FiffEvoked pickedEvoked = evoked.pick_channels(ch_sel_names);
-
-    //
-    // Cluster forward solution;
-    //
-    MNEForwardSolution t_clusteredFwd = t_Fwd.cluster_forward_solution(t_annotationSet, 20);//40);
-
-//    std::cout << "Size " << t_clusteredFwd.sol->data.rows() << " x " << t_clusteredFwd.sol->data.cols() << std::endl;
-//    std::cout << "Clustered Fwd:\n" << t_clusteredFwd.sol->data.row(0) << std::endl;
-
-    RapMusic t_rapMusic(t_clusteredFwd, false, numDipolePairs);
-
-    int iWinSize = 200;
-    if(doMovie) {
-        t_rapMusic.setStcAttr(iWinSize, 0.6f);
-    }
-
-    MNESourceEstimate sourceEstimate = t_rapMusic.calculateInverse(pickedEvoked);
-
-    if(doMovie) {
-        //Select only the activations once
-        MatrixXd dataPicked(sourceEstimate.data.rows(), int(std::floor(sourceEstimate.data.cols()/iWinSize)));
-
-        for(int i = 0; i < dataPicked.cols(); ++i) {
-            dataPicked.col(i) = sourceEstimate.data.col(i*iWinSize);
-        }
-
-        sourceEstimate.data = dataPicked;
-    }
-
-    //Select only the activations once
-    MatrixXd dataPicked(sourceEstimate.data.rows(), int(std::floor(sourceEstimate.data.cols()/iWinSize)));
+    //Reuse a previous RAP MUSIC solution with the same data and settings
+    QString sKey = AnalyzeData::resultKey(getName(),
+                                          QStringList() << fwdFileOption << evokedFileOption,
+                                          QVariantList() << subjectOption << QFileInfo(subjectDirectoryOption).absoluteFilePath() << annotOption << surfOption << numDipolePairs << doMovie);
 
-    for(int i = 0; i < dataPicked.cols(); ++i) {
-        dataPicked.col(i) = sourceEstimate.data.col(i*iWinSize);
-    }
-
-    sourceEstimate.data = dataPicked;
-
-    if(sourceEstimate.isEmpty())
+    if(globalData()->hasResult(sKey)) {
+        printf("Reusing the RAP MUSIC solution computed before\n");
+        globalData()->addSTC(globalData()->result(sKey).value<MNESourceEstimate>());
         return;
-
-//    //Visualize the results
-//    View3D::SPtr testWindow = View3D::SPtr(new View3D());
-//    Data3DTreeModel::SPtr p3DDataModel = Data3DTreeModel::SPtr(new Data3DTreeModel());
-
-//    testWindow->setModel(p3DDataModel);
-
-//    p3DDataModel->addSurfaceSet(parser.value(subjectOption), evoked.comment, t_surfSet, t_annotationSet);
-
-//    //Add rt source loc data and init some visualization values
-//    if(MneEstimateTreeItem* pRTDataItem = p3DDataModel->addSourceData(parser.value(subjectOption), evoked.comment, sourceEstimate, t_clusteredFwd)) {
-//        pRTDataItem->setLoopState(true);
-//        pRTDataItem->setTimeInterval(17);
-//        pRTDataItem->setNumberAverages(1);
-//        pRTDataItem->setStreamingState(true);
-//        pRTDataItem->setNormalization(QVector3D(0.01,0.5,1.0));
-//        pRTDataItem->setVisualizationType("Annotation based");
-//        pRTDataItem->setColortable("Hot");
-//    }
-//    testWindow->show();
-
-//    Control3DWidget::SPtr control3DWidget = Control3DWidget::SPtr(new Control3DWidget());
-//    control3DWidget->init(p3DDataModel, testWindow);
-//    control3DWidget->show();
-
-    if(!t_sFileNameStc.isEmpty())
-    {
-        QFile t_fileClusteredStc(t_sFileNameStc);
-        sourceEstimate.write(t_fileClusteredStc);
     }
 
-//    return a.exec();
+    //Compute RAP MUSIC in the background
+    QSharedPointer<AnalyzeData> pData = globalData();
+
+    globalData()->taskScheduler()->submit(getName(),
+                                          std::bind(computeRapMusic, fwdFileOption, evokedFileOption, subjectOption, subjectDirectoryOption, annotOption, surfOption, t_sFileNameStc, numDipolePairs, doMovie, std::placeholders::_1),
+                                          [pData, sKey](const QVariant& result) {
+                                              if(!result.isValid()) {
+                                                  return;
+                                              }
+                                              pData->cacheResult(sKey, result);
+                                              pData->addSTC(result.value<MNESourceEstimate>());
+                                          });
 }
@@ -46,6 +46,10 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -67,6 +71,8 @@ AnalyzeData::AnalyzeData(QObject *parent)
 , m_iCurrentEstimate(-1)
 , m_iCurrentSample(0)
 , m_iCurrentECDSet(-1)
+, m_pTaskScheduler(TaskScheduler::SPtr(new TaskScheduler))
+, m_qCacheResults(16)
 {
 
 }
@@ -142,3 +148,64 @@ const QList< QPair< DipoleFitSettings, ECDSet > >& AnalyzeData::ecdSets() const
 {
     return m_qListECDSets;
 }
+
+
+//*************************************************************************************************************
+
+TaskScheduler::SPtr AnalyzeData::taskScheduler() const
+{
+    return m_pTaskScheduler;
+}
+
+
+//*************************************************************************************************************
+
+QString AnalyzeData::resultKey(const QString& sOperation, const QStringList& lInputFiles, const QVariantList& lParameters)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    //A changed input file gets a new key, even if its path stays the same
+    for(int i = 0; i < lInputFiles.size(); ++i) {
+        QFileInfo fileInfo(lInputFiles[i]);
+        hash.addData(QString("%1|%2|%3;").arg(fileInfo.absoluteFilePath()).arg(fileInfo.size()).arg(fileInfo.lastModified().toMSecsSinceEpoch()).toUtf8());
+    }
+
+    for(int i = 0; i < lParameters.size(); ++i) {
+        hash.addData(QString("%1|%2;").arg(lParameters[i].typeName()).arg(lParameters[i].toString()).toUtf8());
+    }
+
+    return QString("%1:%2").arg(sOperation).arg(QString(hash.result().toHex()));
+}
+
+
+//*************************************************************************************************************
+
+bool AnalyzeData::hasResult(const QString& sKey) const
+{
+    return m_qCacheResults.contains(sKey);
+}
+
+
+//*************************************************************************************************************
+
+QVariant AnalyzeData::result(const QString& sKey) const
+{
+    QVariant* pResult = m_qCacheResults.object(sKey);
+    return pResult ? *pResult : QVariant();
+}
+
+
+//*************************************************************************************************************
+
+void AnalyzeData::cacheResult(const QString& sKey, const QVariant& result)
+{
+    m_qCacheResults.insert(sKey, new QVariant(result));
+}
+
+
+//*************************************************************************************************************
+
+void AnalyzeData::clearResults()
+{
+    m_qCacheResults.clear();
+}
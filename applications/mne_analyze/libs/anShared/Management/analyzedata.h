@@ -42,6 +42,7 @@
 //=============================================================================================================
 
 #include "../anshared_global.h"
+#include "taskscheduler.h"
 
 #include <mne/mne_sourceestimate.h>
 
@@ -57,6 +58,9 @@
 #include <QPair>
 #include <QList>
 #include <QSharedPointer>
+#include <QCache>
+#include <QStringList>
+#include <QVariant>
 
 
 //*************************************************************************************************************
@@ -123,6 +127,16 @@ public:
     void addECDSet( INVERSELIB::DipoleFitSettings &ecdSettings,  INVERSELIB::ECDSet &ecdSet );  /*!< Sets the current ECD Set. @param [in] ecdSettings  Sets the settings corresponding to the current ECD Set; @param [in] ecdSet  Sets the current ECD Set;*/
     const QList< QPair< INVERSELIB::DipoleFitSettings, INVERSELIB::ECDSet > >& ecdSets() const; /*!< Returns a list of all past ECD Sets. @return All past ECD Sets.*/
 
+//Tasks
+    TaskScheduler::SPtr taskScheduler() const;              /*!< Returns the task scheduler the extensions submit their heavy work to. @return The task scheduler.*/
+
+//Results
+    static QString resultKey(const QString& sOperation, const QStringList& lInputFiles, const QVariantList& lParameters);  /*!< Returns the cache key of a result. Input files are identified by their path, size and modification time. @param [in] sOperation  The name of the operation; @param [in] lInputFiles  The input files; @param [in] lParameters  The parameters; @return The key.*/
+    bool hasResult(const QString& sKey) const;              /*!< Returns whether a result is cached. @param [in] sKey  The key, see resultKey; @return true if cached.*/
+    QVariant result(const QString& sKey) const;             /*!< Returns a cached result. @param [in] sKey  The key, see resultKey; @return The result, an invalid QVariant if not cached.*/
+    void cacheResult(const QString& sKey, const QVariant& result);  /*!< Caches a result, the least recently used ones are dropped. @param [in] sKey  The key, see resultKey; @param [in] result  The result;*/
+    void clearResults();                                    /*!< Drops all cached results.*/
+
 // Database -> Consider using abstract item models or other datamanagement architecture
 private:
 // STCs
@@ -133,6 +147,10 @@ private:
 // ECDs
     QList< QPair< INVERSELIB::DipoleFitSettings, INVERSELIB::ECDSet > > m_qListECDSets;     /**< List of all past ECD Sets.*/
     int                                                                 m_iCurrentECDSet;   /**< Current ECD Set */
+
+// Tasks and results
+    TaskScheduler::SPtr                 m_pTaskScheduler;       /**< The task scheduler shared by all extensions.*/
+    QCache<QString, QVariant>           m_qCacheResults;        /**< The cached results by key.*/
 };
 
 //*************************************************************************************************************
@@ -142,4 +160,9 @@ private:
 
 } //Namespace
 
+#ifndef metatype_mnesourceestimate
+#define metatype_mnesourceestimate
+Q_DECLARE_METATYPE(MNELIB::MNESourceEstimate);  /**< Provides QT META type declaration of the MNELIB::MNESourceEstimate type. For signal/slot and QVariant usage.*/
+#endif
+
 #endif //ANALYZEDATA_H
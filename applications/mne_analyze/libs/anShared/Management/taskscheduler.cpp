@@ -0,0 +1,285 @@
+//=============================================================================================================
+/**
+* @file     taskscheduler.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the TaskScheduler class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "taskscheduler.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent>
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace ANSHAREDLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+AnalyzeTask::AnalyzeTask(TaskScheduler* pScheduler, int iId, const QString& sName, int iPriority, const WorkFunction& work, const FinishedFunction& finished)
+: m_pScheduler(pScheduler)
+, m_iId(iId)
+, m_sName(sName)
+, m_iPriority(iPriority)
+, m_work(work)
+, m_finished(finished)
+, m_iCanceled(0)
+{
+
+}
+
+
+//*************************************************************************************************************
+
+int AnalyzeTask::id() const
+{
+    return m_iId;
+}
+
+
+//*************************************************************************************************************
+
+QString AnalyzeTask::name() const
+{
+    return m_sName;
+}
+
+
+//*************************************************************************************************************
+
+int AnalyzeTask::priority() const
+{
+    return m_iPriority;
+}
+
+
+//*************************************************************************************************************
+
+bool AnalyzeTask::isCanceled() const
+{
+    return m_iCanceled.load() != 0;
+}
+
+
+//*************************************************************************************************************
+
+void AnalyzeTask::setProgress(int iProgress)
+{
+    emit m_pScheduler->taskProgress_signal(m_iId, qBound(0, iProgress, 100));
+}
+
+
+//*************************************************************************************************************
+
+TaskScheduler::TaskScheduler(int iMaxThreads, QObject *parent)
+: QObject(parent)
+, m_iNextId(0)
+{
+    m_threadPool.setMaxThreadCount(qMax(1, iMaxThreads));
+}
+
+
+//*************************************************************************************************************
+
+TaskScheduler::~TaskScheduler()
+{
+    cancelAll();
+    m_threadPool.waitForDone();
+}
+
+
+//*************************************************************************************************************
+
+int TaskScheduler::submit(const QString& sName, const AnalyzeTask::WorkFunction& work, const AnalyzeTask::FinishedFunction& finished, int iPriority)
+{
+    m_qMutex.lock();
+
+    AnalyzeTask::SPtr pTask(new AnalyzeTask(this, m_iNextId++, sName, iPriority, work, finished));
+
+    //Keep the pending tasks sorted by priority, tasks with the same priority stay in submission order
+    int iPos = 0;
+    while(iPos < m_qListPending.size() && m_qListPending[iPos]->priority() >= iPriority) {
+        ++iPos;
+    }
+    m_qListPending.insert(iPos, pTask);
+
+    m_qMutex.unlock();
+
+    //Every submission starts one run, which takes the pending task with the highest priority
+    QtConcurrent::run(&m_threadPool, this, &TaskScheduler::runNext);
+
+    return pTask->id();
+}
+
+
+//*************************************************************************************************************
+
+bool TaskScheduler::cancel(int iId)
+{
+    m_qMutex.lock();
+
+    for(int i = 0; i < m_qListPending.size(); ++i) {
+        if(m_qListPending[i]->id() == iId) {
+            m_qListPending.removeAt(i);
+            m_qMutex.unlock();
+
+            emit taskCanceled_signal(iId);
+            return true;
+        }
+    }
+
+    bool bRunning = m_qMapRunning.contains(iId);
+    if(bRunning) {
+        m_qMapRunning[iId]->m_iCanceled.store(1);
+    }
+
+    m_qMutex.unlock();
+
+    return bRunning;
+}
+
+
+//*************************************************************************************************************
+
+void TaskScheduler::cancelAll()
+{
+    m_qMutex.lock();
+
+    QList<AnalyzeTask::SPtr> qListPending = m_qListPending;
+    m_qListPending.clear();
+
+    QMap<int, AnalyzeTask::SPtr>::iterator it;
+    for(it = m_qMapRunning.begin(); it != m_qMapRunning.end(); ++it) {
+        it.value()->m_iCanceled.store(1);
+    }
+
+    m_qMutex.unlock();
+
+    for(int i = 0; i < qListPending.size(); ++i) {
+        emit taskCanceled_signal(qListPending[i]->id());
+    }
+}
+
+
+//*************************************************************************************************************
+
+int TaskScheduler::pendingTasks() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_qListPending.size();
+}
+
+
+//*************************************************************************************************************
+
+int TaskScheduler::runningTasks() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_qMapRunning.size();
+}
+
+
+//*************************************************************************************************************
+
+bool TaskScheduler::waitForDone(int msecs)
+{
+    return m_threadPool.waitForDone(msecs);
+}
+
+
+//*************************************************************************************************************
+
+void TaskScheduler::onTaskDone(int iId, const QVariant& result)
+{
+    m_qMutex.lock();
+    AnalyzeTask::SPtr pTask = m_qMapRunning.take(iId);
+    m_qMutex.unlock();
+
+    if(!pTask) {
+        return;
+    }
+
+    if(pTask->isCanceled()) {
+        emit taskCanceled_signal(iId);
+        return;
+    }
+
+    if(pTask->m_finished) {
+        pTask->m_finished(result);
+    }
+
+    emit taskFinished_signal(iId, result);
+}
+
+
+//*************************************************************************************************************
+
+void TaskScheduler::runNext()
+{
+    m_qMutex.lock();
+
+    //The task of this run was canceled before it was started
+    if(m_qListPending.isEmpty()) {
+        m_qMutex.unlock();
+        return;
+    }
+
+    AnalyzeTask::SPtr pTask = m_qListPending.takeFirst();
+    m_qMapRunning.insert(pTask->id(), pTask);
+
+    m_qMutex.unlock();
+
+    emit taskStarted_signal(pTask->id(), pTask->name());
+
+    QVariant result = pTask->m_work(*pTask);
+
+    QMetaObject::invokeMethod(this, "onTaskDone", Qt::QueuedConnection, Q_ARG(int, pTask->id()), Q_ARG(QVariant, result));
+}
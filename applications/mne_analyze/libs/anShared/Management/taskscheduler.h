@@ -0,0 +1,243 @@
+//=============================================================================================================
+/**
+* @file     taskscheduler.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the TaskScheduler class.
+*
+*/
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../anshared_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+#include <QVariant>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QThread>
+#include <QThreadPool>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <functional>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE ANSHAREDLIB
+//=============================================================================================================
+
+namespace ANSHAREDLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class TaskScheduler;
+
+
+//=========================================================================================================
+/**
+* DECLARE CLASS AnalyzeTask
+*
+* @brief The AnalyzeTask class is the handle a work function gets to report its progress and to check for cancellation.
+*/
+class ANSHAREDSHARED_EXPORT AnalyzeTask
+{
+public:
+    typedef QSharedPointer<AnalyzeTask> SPtr;                                   /**< Shared pointer type for AnalyzeTask. */
+    typedef std::function<QVariant(AnalyzeTask& task)> WorkFunction;            /**< The work, runs on a worker thread and returns the result. */
+    typedef std::function<void(const QVariant& result)> FinishedFunction;      /**< Receives the result on the scheduler's thread. */
+
+    int id() const;                                     /*!< Returns the id of the task. @return The id.*/
+    QString name() const;                               /*!< Returns the name of the task. @return The name.*/
+    int priority() const;                               /*!< Returns the priority of the task. @return The priority.*/
+    bool isCanceled() const;                            /*!< Returns whether the task was canceled. Long running work should check this regularly and return early. @return true if canceled.*/
+    void setProgress(int iProgress);                    /*!< Reports the progress. @param [in] iProgress  The progress in percent;*/
+
+private:
+    friend class TaskScheduler;
+
+    AnalyzeTask(TaskScheduler* pScheduler, int iId, const QString& sName, int iPriority, const WorkFunction& work, const FinishedFunction& finished);
+
+    TaskScheduler*      m_pScheduler;   /**< The scheduler which runs the task. */
+    int                 m_iId;          /**< The id of the task. */
+    QString             m_sName;        /**< The name of the task. */
+    int                 m_iPriority;    /**< The priority of the task. */
+    WorkFunction        m_work;         /**< The work. */
+    FinishedFunction    m_finished;     /**< The function which receives the result. */
+    QAtomicInt          m_iCanceled;    /**< Whether the task was canceled. */
+};
+
+
+//=========================================================================================================
+/**
+* The TaskScheduler runs the heavy work of the extensions on a pool of worker threads, so the GUI stays responsive.
+* Pending tasks are started by priority, tasks with the same priority in the order they were submitted. Pending
+* tasks can be canceled right away, running tasks when they check AnalyzeTask::isCanceled. The results are
+* handed to the finished functions on the thread the scheduler lives in, i.e. the GUI thread.
+*
+* @brief The TaskScheduler class provides a prioritized worker pool for the extensions.
+*/
+class ANSHAREDSHARED_EXPORT TaskScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    typedef QSharedPointer<TaskScheduler> SPtr;               /**< Shared pointer type for TaskScheduler. */
+    typedef QSharedPointer<const TaskScheduler> ConstSPtr;    /**< Const shared pointer type for TaskScheduler. */
+
+    //=========================================================================================================
+    /**
+    * Constructs the TaskScheduler.
+    *
+    * @param [in] iMaxThreads   Maximal number of tasks which run at the same time.
+    * @param [in] parent        The parent object.
+    */
+    TaskScheduler(int iMaxThreads = QThread::idealThreadCount(), QObject* parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destroys the TaskScheduler. All tasks are canceled and the running ones are waited for.
+    */
+    virtual ~TaskScheduler();
+
+    //=========================================================================================================
+    /**
+    * Submits a task.
+    *
+    * @param [in] sName         The name of the task, e.g. the name of the extension.
+    * @param [in] work          The work, runs on a worker thread and returns the result.
+    * @param [in] finished      Receives the result on the scheduler's thread, is not called for canceled tasks.
+    * @param [in] iPriority     The priority, tasks with a higher priority are started first.
+    *
+    * @return the id of the task.
+    */
+    int submit(const QString& sName, const AnalyzeTask::WorkFunction& work, const AnalyzeTask::FinishedFunction& finished = AnalyzeTask::FinishedFunction(), int iPriority = 0);
+
+    //=========================================================================================================
+    /**
+    * Cancels a task.
+    *
+    * @param [in] iId   The id of the task.
+    *
+    * @return true if the task was pending or running, false otherwise.
+    */
+    bool cancel(int iId);
+
+    //=========================================================================================================
+    /**
+    * Cancels all pending and running tasks.
+    */
+    void cancelAll();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of tasks which were not started yet.
+    *
+    * @return the number of pending tasks.
+    */
+    int pendingTasks() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of running tasks.
+    *
+    * @return the number of running tasks.
+    */
+    int runningTasks() const;
+
+    //=========================================================================================================
+    /**
+    * Waits until all tasks were run.
+    *
+    * @param [in] msecs     Maximal time to wait, -1 waits without limit.
+    *
+    * @return true if all tasks were run, false if the time ran out.
+    */
+    bool waitForDone(int msecs = -1);
+
+signals:
+    void taskStarted_signal(int id, const QString& name);           /**< Emmited on the worker thread when a task is started. @param [in] id  The task id; @param [in] name  The task name;*/
+    void taskProgress_signal(int id, int progress);                 /**< Emmited on the worker thread when a task reports progress. @param [in] id  The task id; @param [in] progress  The progress in percent;*/
+    void taskFinished_signal(int id, const QVariant& result);       /**< Emmited after the finished function of a task was called. @param [in] id  The task id; @param [in] result  The result;*/
+    void taskCanceled_signal(int id);                               /**< Emmited when a canceled task was removed. @param [in] id  The task id;*/
+
+private slots:
+    //=========================================================================================================
+    /**
+    * Hands the result of a task to its finished function, runs on the scheduler's thread.
+    *
+    * @param [in] iId       The id of the task.
+    * @param [in] result    The result.
+    */
+    void onTaskDone(int iId, const QVariant& result);
+
+private:
+    friend class AnalyzeTask;
+
+    //=========================================================================================================
+    /**
+    * Runs the pending task with the highest priority, runs on a worker thread.
+    */
+    void runNext();
+
+    mutable QMutex                      m_qMutex;           /**< Guards the task lists. */
+    QList<AnalyzeTask::SPtr>            m_qListPending;     /**< The pending tasks, sorted by priority. */
+    QMap<int, AnalyzeTask::SPtr>        m_qMapRunning;      /**< The running tasks by id. */
+    int                                 m_iNextId;          /**< The id of the next task. */
+    QThreadPool                         m_threadPool;       /**< The worker threads. */
+};
+
+} //Namespace
+
+#endif //TASKSCHEDULER_H
@@ -37,7 +37,7 @@ include(../../../../mne-cpp.pri)
 
 TEMPLATE = lib
 
-QT += widgets svg
+QT += widgets svg concurrent
 
 DEFINES += ANSHARED_LIBRARY
 
@@ -69,7 +69,8 @@ DESTDIR = $${MNE_LIBRARY_DIR}
 SOURCES += \
     Management/analyzedata.cpp \
     Management/analyzesettings.cpp \
-    Management/extensionmanager.cpp
+    Management/extensionmanager.cpp \
+    Management/taskscheduler.cpp
 
 HEADERS += \
     anshared_global.h \
@@ -77,6 +78,7 @@ HEADERS += \
     Management/analyzedata.h \
     Management/analyzesettings.h \
     Management/extensionmanager.h \
+    Management/taskscheduler.h \
     Interfaces/IStandardView.h
 
 
@@ -42,6 +42,8 @@
 
 #include "rawdelegate.h"
 
+#include <cmath>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -150,7 +152,8 @@ void RawDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, c
 
         //Plot data path
         path = QPainterPath(QPointF(option.rect.x()+t_rawModel->relFiffCursor(), option.rect.y()));
-        createPlotPath(index, option, path, listPairs, channelMean);
+        QRectF visibleRect = painter->hasClipping() ? painter->clipBoundingRect() : QRectF(option.rect);
+        createPlotPath(index, option, path, listPairs, channelMean, visibleRect);
 
         if(option.state & QStyle::State_Selected) {
             pen.setStyle(Qt::SolidLine);
@@ -220,7 +223,7 @@ void RawDelegate::setScaleMap(const QMap<QString,double> &scaleMap)
 
 //*************************************************************************************************************
 
-void RawDelegate::createPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, QList<RowVectorPair>& listPairs, double channelMean) const
+void RawDelegate::createPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, QList<RowVectorPair>& listPairs, double channelMean, const QRectF &visibleRect) const
 {
     //get maximum range of respective channel type (range value in FiffChInfo does not seem to contain a reasonable value)
     qint32 kind = (static_cast<const RawModel*>(index.model()))->m_chInfolist[index.row()].kind;
@@ -258,30 +261,77 @@ void RawDelegate::createPlotPath(const QModelIndex &index, const QStyleOptionVie
     }
     }
 
-    double dValue;
     double dScaleY = option.rect.height()/(2*dMaxValue);
 
     double y_base = -path.currentPosition().y();
-    QPointF qSamplePosition;
+    double x_base = path.currentPosition().x();
+
+    //only the samples in the visible area (plus one on each side) are added, sample j is plotted at x_base+(j+1)*m_dDx
+    qint32 firstSample = qMax(0, (qint32)std::floor((visibleRect.left() - x_base) / m_dDx) - 2);
+    qint32 lastSample = (qint32)std::ceil((visibleRect.right() - x_base) / m_dDx) + 1;
 
-    path.moveTo(path.currentPosition().x(), -(y_base + ((*(listPairs[0].first) - channelMean)*dScaleY)));
+    //pick the coarsest envelope which still has at least one entry per pixel
+    int level = -1;
+    for(int l = 0; l < DataPackage::numberEnvelopeLevels(); ++l) {
+        if(DataPackage::envelopeDecimation(l) * m_dDx <= 1.0)
+            level = l;
+    }
 
-    //plot all rows from list of pairs
-    for(qint8 i=0; i < listPairs.size(); ++i) {
-        //create lines from one to the next sample
-        for(qint32 j=0; j < listPairs[i].second; ++j)
-        {
-            double val = *(listPairs[i].first+j);
+    bool bStarted = false;
+    qint32 offset = 0;
 
-            //subtract mean of the channel here (if wanted by the user)
-            dValue = (val - channelMean)*dScaleY;
+    if(level < 0) {
+        //plot all visible samples from list of pairs
+        for(qint8 i=0; i < listPairs.size(); ++i) {
+            qint32 begin = qMax(0, firstSample - offset);
+            qint32 end = qMin(listPairs[i].second, lastSample - offset + 1);
 
-            double newY = y_base+dValue;
+            //create lines from one to the next sample
+            for(qint32 j=begin; j < end; ++j)
+            {
+                double val = *(listPairs[i].first+j);
 
-            qSamplePosition.setY(-newY);
-            qSamplePosition.setX(path.currentPosition().x()+m_dDx);
+                //subtract mean of the channel here (if wanted by the user)
+                QPointF qSamplePosition(x_base + (offset+j+1)*m_dDx, -(y_base + (val - channelMean)*dScaleY));
 
-            path.lineTo(qSamplePosition);
+                if(bStarted) {
+                    path.lineTo(qSamplePosition);
+                } else {
+                    path.moveTo(qSamplePosition);
+                    bStarted = true;
+                }
+            }
+
+            offset += listPairs[i].second;
+        }
+    } else {
+        //plot a vertical line from the minimum to the maximum of each visible envelope entry
+        QList<RowEnvelope> listEnvelopes = (static_cast<const RawModel*>(index.model()))->channelEnvelope(index.row(), level);
+
+        for(qint8 i=0; i < listEnvelopes.size() && i < listPairs.size(); ++i) {
+            const RowEnvelope& envelope = listEnvelopes[i];
+
+            if(envelope.iLength > 0) {
+                qint32 begin = qMax(0, (firstSample - offset) / envelope.iDecimation);
+                qint32 end = qMin(envelope.iLength, (lastSample - offset) / envelope.iDecimation + 1);
+
+                for(qint32 k=begin; k < end; ++k) {
+                    double x = x_base + (offset + (k+0.5)*envelope.iDecimation)*m_dDx;
+                    QPointF qMinPosition(x, -(y_base + (envelope.pMin[k] - channelMean)*dScaleY));
+                    QPointF qMaxPosition(x, -(y_base + (envelope.pMax[k] - channelMean)*dScaleY));
+
+                    if(bStarted) {
+                        path.lineTo(qMinPosition);
+                    } else {
+                        path.moveTo(qMinPosition);
+                        bStarted = true;
+                    }
+
+                    path.lineTo(qMaxPosition);
+                }
+            }
+
+            offset += listPairs[i].second;
         }
     }
 
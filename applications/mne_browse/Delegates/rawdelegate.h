@@ -168,12 +168,14 @@ public:
 private:
     //=========================================================================================================
     /**
-    * createPlotPath creates the QPointer path for the data plot.
+    * createPlotPath creates the QPointer path for the data plot. Only the samples inside the visible area are added.
+    * If several samples fall onto one pixel, the min/max envelope of the matching decimation level is drawn instead.
     *
     * @param[in] index QModelIndex for accessing associated data and model object.
     * @param[in,out] path The QPointerPath to create for the data plot.
+    * @param[in] visibleRect The area which needs to be painted.
     */
-    void createPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, QList<RowVectorPair>& listPairs, double channelMean) const;
+    void createPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, QList<RowVectorPair>& listPairs, double channelMean, const QRectF &visibleRect) const;
 
     //=========================================================================================================
     /**
@@ -363,9 +363,6 @@ bool EventModel::setData(const QModelIndex & index, const QVariant & value, int
 
 bool EventModel::loadEventData(QFile& qFile)
 {
-    beginResetModel();
-    clearModel();
-
     // Read events
     MatrixXi events;
 
@@ -378,6 +375,19 @@ bool EventModel::loadEventData(QFile& qFile)
 
     qDebug() << QString("Events read from %1").arg(qFile.fileName());
 
+    setEventData(events);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void EventModel::setEventData(const MatrixXi& events)
+{
+    beginResetModel();
+    clearModel();
+
     //set loaded fiff event data
     for(int i = 0; i < events.rows(); i++) {
         m_dataSamples.append(events(i,0));
@@ -401,8 +411,6 @@ bool EventModel::loadEventData(QFile& qFile)
     endResetModel();
 
     m_bFileloaded = true;
-
-    return true;
 }
 
 
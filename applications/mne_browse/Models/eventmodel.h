@@ -135,6 +135,14 @@ public:
     */
     bool loadEventData(QFile& qFile);
 
+    //=========================================================================================================
+    /**
+    * setEventData replaces the events of the model, e.g. with the events detected in the raw data
+    *
+    * @param events the events (events x 3), the sample is in the first and the type in the last column
+    */
+    void setEventData(const MatrixXi& events);
+
     //=========================================================================================================
     /**
     * saveEventData saves events to a fiff event data file
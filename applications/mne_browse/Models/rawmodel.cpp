@@ -73,6 +73,8 @@ RawModel::RawModel(QObject *parent)
 , m_bStartReached(false)
 , m_bEndReached(false)
 , m_bReloading(false)
+, m_iOperatorGeneration(0)
+, m_iProcessingGeneration(0)
 , m_bProcessing(false)
 , m_pFiffInfo(new FiffInfo())
 , m_pfiffIO(QSharedPointer<FiffIO>(new FiffIO()))
@@ -100,18 +102,11 @@ RawModel::RawModel(QObject *parent)
     //connect filtering reloading - this is done after a new block has been loaded
     connect(this,&RawModel::dataReloaded,[this](){
         if(!m_assignedOperators.empty())
-            updateOperatorsConcurrently();
+            updateOperatorsConcurrently(m_bReloadBefore ? 0 : m_data.size()-1);
     });
 
-//    connect(&m_operatorFutureWatcher,&QFutureWatcher<QPair<int,RowVectorXd> >::resultReadyAt,[this](int index){
-//        insertProcessedData(index);
-//    });
-    connect(&m_operatorFutureWatcher,&QFutureWatcher<void>::finished,[this](){
-        insertProcessedDataAll();
-    });
-//    connect(&m_operatorFutureWatcher,&QFutureWatcher<QPair<int,RowVectorXd> >::progressValueChanged,[this](int progressValue){
-//        qDebug() << "RawModel: ProgressValue m_operatorFutureWatcher, " << progressValue << " items processed out of" << m_listTmpChData.size();
-//    });
+    connect(&m_operatorFutureWatcher,&QFutureWatcher<QList<QPair<int,RowVectorXd> > >::finished,
+            this, &RawModel::insertProcessedWindow);
 }
 
 
@@ -123,6 +118,8 @@ RawModel::RawModel(QFile &qFile, QObject *parent)
 , m_bStartReached(false)
 , m_bEndReached(false)
 , m_bReloading(false)
+, m_iOperatorGeneration(0)
+, m_iProcessingGeneration(0)
 , m_bProcessing(false)
 , m_pFiffInfo(new FiffInfo())
 , m_pfiffIO(QSharedPointer<FiffIO>(new FiffIO()))
@@ -146,18 +143,11 @@ RawModel::RawModel(QFile &qFile, QObject *parent)
 
     connect(this,&RawModel::dataReloaded,[this](){
         if(!m_assignedOperators.empty())
-            updateOperatorsConcurrently();
+            updateOperatorsConcurrently(m_bReloadBefore ? 0 : m_data.size()-1);
     });
 
-//    connect(&m_operatorFutureWatcher,&QFutureWatcher<QPair<int,RowVectorXd> >::resultReadyAt,[this](int index){
-//        insertProcessedData(index);
-//    });
-    connect(&m_operatorFutureWatcher,&QFutureWatcher<void>::finished,[this](){
-        insertProcessedDataAll();
-    });
-//    connect(&m_operatorFutureWatcher,&QFutureWatcher<QPair<int,RowVectorXd> >::progressValueChanged,[this](int progressValue){
-//        qDebug() << "RawModel: ProgressValue m_operatorFutureWatcher, " << progressValue << " items processed out of" << m_listTmpChData.size();
-//    });
+    connect(&m_operatorFutureWatcher,&QFutureWatcher<QList<QPair<int,RowVectorXd> > >::finished,
+            this, &RawModel::insertProcessedWindow);
 }
 
 
@@ -204,8 +194,7 @@ QVariant RawModel::data(const QModelIndex &index, int role) const
                 QList<RowVectorPair> listRowVectorPair;
 
                 for(qint16 i=0; i < m_data.size(); ++i) {
-                    //if channel is not filtered or background Processing pending...
-                    if(!m_assignedOperators.contains(index.row()) || (m_bProcessing && m_bReloadBefore && i==0) || (m_bProcessing && !m_bReloadBefore && i==m_data.size()-1)) {
+                    if(!showsProcessedData(index.row(), i)) {
                         rowVectorPair.first = m_data[i]->dataRaw().data() + index.row()*m_data[i]->dataRaw().cols();
                         rowVectorPair.second  = m_data[i]->dataRaw().cols();
                     }
@@ -273,6 +262,23 @@ QVariant RawModel::data(const QModelIndex &index, int role) const
 }
 
 
+//*************************************************************************************************************
+
+QList<RowEnvelope> RawModel::channelEnvelope(int row, int level) const
+{
+    QList<RowEnvelope> listEnvelopes;
+
+    for(qint16 i=0; i < m_data.size(); ++i) {
+        if(!showsProcessedData(row, i))
+            listEnvelopes.append(m_data[i]->envelopeRaw(row, level));
+        else
+            listEnvelopes.append(m_data[i]->envelopeProc(row, level));
+    }
+
+    return listEnvelopes;
+}
+
+
 //*************************************************************************************************************
 
 QVariant RawModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -390,8 +396,14 @@ bool RawModel::loadFiffData(QFile* qFile)
         int start = m_iAbsFiffCursor;
         int end = start + m_iWindowSize - 1;
 
-        if(!m_pfiffIO->m_qlistRaw[0]->read_raw_segment(t_data, t_times, start, end))
+        m_pTileCache = RawTileCache::SPtr(new RawTileCache(m_pfiffIO->m_qlistRaw[0], TILECACHE_TILE_SIZE, TILECACHE_MAX_TILES, TILECACHE_PREFETCH_TILES));
+
+        if(!m_pTileCache->readSegment(t_data, t_times, start, end)) {
+            endResetModel();
             return false;
+        }
+
+        m_pTileCache->prefetch(start, end, true);
 
         newDataPackage = QSharedPointer<DataPackage>(new DataPackage(t_data, (MatrixXdR)t_times));
 
@@ -492,6 +504,17 @@ void RawModel::loadFiffInfos()
 }
 
 
+//*************************************************************************************************************
+
+bool RawModel::showsProcessedData(int row, int window) const
+{
+    //the raw data is shown if the channel is not filtered or background processing of this window is pending
+    return m_assignedOperators.contains(row)
+            && m_data[window] != m_pProcessingWindow
+            && !m_listPendingWindows.contains(m_data[window]);
+}
+
+
 //*************************************************************************************************************
 
 void RawModel::clearModel()
@@ -502,9 +525,12 @@ void RawModel::clearModel()
 
     //data model structure
     m_data.clear();
+    m_pTileCache.clear();
 
     //MNEOperators
     m_assignedOperators.clear();
+    m_listPendingWindows.clear();
+    ++m_iOperatorGeneration;
 
     //View parameters
     m_iAbsFiffCursor = 0;
@@ -541,10 +567,10 @@ void RawModel::resetPosition(qint32 position)
     int start = m_iAbsFiffCursor;
     int end = start + m_iWindowSize - 1;
 
-    m_Mutex.lock();
-    if(!m_pfiffIO->m_qlistRaw[0]->read_raw_segment(t_data, t_times, start, end))
+    if(!m_pTileCache->readSegment(t_data, t_times, start, end))
         qDebug() << "RawModel: Error resetting position of Fiff file!";
-    m_Mutex.unlock();
+
+    m_pTileCache->prefetch(start, end, true);
 
     //build data package
     QSharedPointer<DataPackage> newDataPackage;
@@ -609,6 +635,9 @@ void RawModel::reloadFiffData(bool before)
 
     m_bReloading = true;
 
+    //read ahead in scroll direction while this window is assembled
+    m_pTileCache->prefetch(start, end, !before);
+
     //read data with respect to start and end point
     QFuture<QPair<MatrixXd,MatrixXd> > future = QtConcurrent::run(this,&RawModel::readSegment,start,end);
 
@@ -626,12 +655,8 @@ QPair<MatrixXd,MatrixXd> RawModel::readSegment(fiff_int_t from, fiff_int_t to)
 {
     QPair<MatrixXd,MatrixXd> datatime;
 
-    m_Mutex.lock();
-    if(!m_pfiffIO->m_qlistRaw[0]->read_raw_segment(datatime.first, datatime.second, from, to)) {
+    if(!m_pTileCache->readSegment(datatime.first, datatime.second, from, to))
         printf("RawModel: Error when reading raw data!");
-        return datatime;
-    }
-    m_Mutex.unlock();
 
     return datatime;
 }
@@ -715,14 +740,7 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
         }
     }
 
-    m_bProcessing = true;
-
-    for(int i=0; i<m_data.size(); i++)
-        updateOperatorsConcurrently(i);
-
-    performOverlapAdd();
-
-    m_bProcessing = false;
+    updateOperatorsConcurrently();
 
     emit assignedOperatorsChanged(m_assignedOperators);
 
@@ -753,14 +771,7 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
         }
     }
 
-    m_bProcessing = true;
-
-    for(int i=0; i<m_data.size(); i++)
-        updateOperatorsConcurrently(i);
-
-    performOverlapAdd();
-
-    m_bProcessing = false;
+    updateOperatorsConcurrently();
 
     emit assignedOperatorsChanged(m_assignedOperators);
 
@@ -770,26 +781,54 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
 
 //*************************************************************************************************************
 
-void RawModel::applyOperatorsConcurrently(QPair<int,RowVectorXd>& chdata) const
+void RawModel::applyOperatorsConcurrently(QList<QPair<int,RowVectorXd> >& listChData, const QMap<int,QSharedPointer<MNEOperator> >& assignedOperators)
 {
-    QSharedPointer<FilterOperator> filter;
+    //Group the channels by their operators, so that each filter runs once over all channels it is assigned to
+    QList<QList<QSharedPointer<MNEOperator> > > listOperatorGroups;
+    QList<QList<int> > listGroupRows;
+
+    for(int i = 0; i < listChData.size(); ++i) {
+        QList<QSharedPointer<MNEOperator> > ops = assignedOperators.values(listChData[i].first);
+
+        int group = listOperatorGroups.indexOf(ops);
+        if(group < 0) {
+            listOperatorGroups.append(ops);
+            listGroupRows.append(QList<int>());
+            group = listOperatorGroups.size()-1;
+        }
 
-    //QList<int> listFilteredChs = m_assignedOperators.keys();
+        listGroupRows[group].append(i);
+    }
 
-    QList<QSharedPointer<MNEOperator> > ops = m_assignedOperators.values(chdata.first);
-    for(qint32 i=0; i < ops.size(); ++i) {
-        switch(ops[i]->m_OperatorType) {
-        case MNEOperator::FILTER: {
-            filter = ops[i].staticCast<FilterOperator>();
-            RowVectorXd tmp = filter->applyFFTFilter(chdata.second);
-            chdata.second = tmp;
-        }
-        case MNEOperator::PCA: {
-            //do something
-        }
+    for(int g = 0; g < listOperatorGroups.size(); ++g) {
+        const QList<int>& rows = listGroupRows[g];
+
+        for(qint32 i = 0; i < listOperatorGroups[g].size(); ++i) {
+            const QSharedPointer<MNEOperator>& op = listOperatorGroups[g][i];
+
+            switch(op->m_OperatorType) {
+            case MNEOperator::FILTER: {
+                MatrixXd matData(rows.size(), listChData[rows.first()].second.cols());
+                for(int r = 0; r < rows.size(); ++r)
+                    matData.row(r) = listChData[rows[r]].second;
+
+                MatrixXd matFiltered = op.staticCast<FilterOperator>()->applyFFTFilter(matData);
+                if(matFiltered.rows() != matData.rows())
+                    break;
+
+                for(int r = 0; r < rows.size(); ++r)
+                    listChData[rows[r]].second = matFiltered.row(r);
+                break;
+            }
+            case MNEOperator::PCA: {
+                //do something
+                break;
+            }
+            default:
+                break;
+            }
         }
     }
-//    return chdata;
 }
 
 
@@ -804,14 +843,7 @@ void RawModel::updateOperators(QModelIndex chan)
         }
     }
 
-    m_bProcessing = true;
-
-    for(int i=0; i<m_data.size(); i++)
-        updateOperatorsConcurrently(i);
-
-    performOverlapAdd();
-
-    m_bProcessing = false;
+    updateOperatorsConcurrently();
 
     emit assignedOperatorsChanged(m_assignedOperators);
 }
@@ -832,14 +864,7 @@ void RawModel::updateOperators(QModelIndexList chlist)
         }
     }
 
-    m_bProcessing = true;
-
-    for(int i=0; i<m_data.size(); i++)
-        updateOperatorsConcurrently(i);
-
-    performOverlapAdd();
-
-    m_bProcessing = false;
+    updateOperatorsConcurrently();
 
     emit assignedOperatorsChanged(m_assignedOperators);
 }
@@ -1054,45 +1079,30 @@ void RawModel::insertReloadedData(QPair<MatrixXd,MatrixXd> dataTimesPair)
 
 void RawModel::updateOperatorsConcurrently()
 {
-    m_bProcessing = true;
-
-    QList<int> listFilteredChs = m_assignedOperators.keys();
-    m_listTmpChData.clear();
-
-    //get the rows which are to be filtered out of the m_data matrix. Note that this is done windows wise, hence jumps in the filtered signal might be visible
-    for(qint32 i=0; i < listFilteredChs.size(); ++i) {
-        if(m_bReloadBefore)
-            m_listTmpChData.append(QPair<int,RowVectorXd>(listFilteredChs[i],m_data.first()->dataRawOrig().row(listFilteredChs[i])));
-        else
-            m_listTmpChData.append(QPair<int,RowVectorXd>(listFilteredChs[i],m_data.last()->dataRawOrig().row(listFilteredChs[i])));
-    }
-
-    qDebug() << "RawModel: Starting of concurrent PROCESSING operation of" << listFilteredChs.size() << "items";
-
-    //************* here it could be also performed QtConcurrent::mapped() *************
-    // advantage: QFutureWatcher would give partial results -> signal resultsReadyAt(int idx)
-    // disadvantage: data needs to be copied twice (also to QFuture<QPair<int,RowVectorXd> > object) instead of once (to m_listTmpChData)
+    //drop the results of previous operator settings which are still pending
+    ++m_iOperatorGeneration;
+    m_listPendingWindows.clear();
 
-    //generate lambda function
-//    std::function<QPair<int,RowVectorXd> (QPair<int,RowVectorXd>&)> applyOps = [this](QPair<int,RowVectorXd>& chdata) -> QPair<int,RowVectorXd> {
-//        return applyOperatorsConcurrently(chdata);
-//    };
-
-//    QFuture<QPair<int,RowVectorXd> > future = QtConcurrent::mapped(m_listTmpChData.begin(),m_listTmpChData.end(),applyOps);
-    //**************************************************************************************************************************************************************************
+    if(m_data.empty())
+        return;
 
-    QFuture<void > future = QtConcurrent::map(m_listTmpChData,[this](QPair<int,RowVectorXd>& chdata) {
-        return applyOperatorsConcurrently(chdata);
-    });
+    //visible window first, then its neighbours alternating to the right and to the left
+    int visibleWindow = 0;
+    if(m_iWindowSize > 0)
+        visibleWindow = qBound(0, (m_iCurAbsScrollPos - m_iAbsFiffCursor) / m_iWindowSize, m_data.size()-1);
 
-    m_operatorFutureWatcher.setFuture(future);
+    for(int distance = 0; distance < m_data.size(); ++distance) {
+        if(visibleWindow + distance < m_data.size())
+            m_listPendingWindows.append(m_data[visibleWindow + distance]);
+        if(distance > 0 && visibleWindow - distance >= 0)
+            m_listPendingWindows.append(m_data[visibleWindow - distance]);
+    }
 
-    //Wait for thread to be finished processig the data, then insert data
-    //future.waitForFinished();
+    m_bProcessing = true;
 
-    qDebug() << "RawModel: finished concurrent PROCESSING operation of" << listFilteredChs.size() << "items";
+    qDebug() << "RawModel: Scheduled PROCESSING of" << m_listPendingWindows.size() << "windows starting with window" << visibleWindow;
 
-    //insertProcessedDataAll();
+    processNextWindow();
 }
 
 
@@ -1101,128 +1111,91 @@ void RawModel::updateOperatorsConcurrently()
 void RawModel::updateOperatorsConcurrently(int windowIndex)
 {
     if(windowIndex >= m_data.size() || windowIndex < 0)
-        windowIndex = 0;
-
-    QList<int> listFilteredChs = m_assignedOperators.keys();
-    m_listTmpChData.clear();
-
-    //get the rows which are to be filtered out of the m_data matrix. Note that this is done windows wise, hence jumps in the filtered signal might be visible
-    for(qint32 i=0; i < listFilteredChs.size(); ++i) {
-        if(m_bReloadBefore)
-            m_listTmpChData.append(QPair<int,RowVectorXd>(listFilteredChs[i],m_data[windowIndex]->dataRawOrig().row(listFilteredChs[i])));
-        else
-            m_listTmpChData.append(QPair<int,RowVectorXd>(listFilteredChs[i],m_data[windowIndex]->dataRawOrig().row(listFilteredChs[i])));
-    }
-
-    qDebug() << "RawModel: Starting of concurrent PROCESSING operation of" << listFilteredChs.size() << "items in m_data block"<<windowIndex;
-
-    //************* here it could be also performed QtConcurrent::mapped() *************
-    // advantage: QFutureWatcher would give partial results -> signal resultsReadyAt(int idx)
-    // disadvantage: data needs to be copied twice (also to QFuture<QPair<int,RowVectorXd> > object) instead of once (to m_listTmpChData)
-
-    //generate lambda function
-//    std::function<QPair<int,RowVectorXd> (QPair<int,RowVectorXd>&)> applyOps = [this](QPair<int,RowVectorXd>& chdata) -> QPair<int,RowVectorXd> {
-//        return applyOperatorsConcurrently(chdata);
-//    };
-
-//    QFuture<QPair<int,RowVectorXd> > future = QtConcurrent::mapped(m_listTmpChData.begin(),m_listTmpChData.end(),applyOps);
-    //**************************************************************************************************************************************************************************
-
-    QFuture<void > future = QtConcurrent::map(m_listTmpChData,[this](QPair<int,RowVectorXd>& chdata) {
-        return applyOperatorsConcurrently(chdata);
-    });
+        return;
 
-    //Wait for thread to be finished processig the data, then insert data
-    future.waitForFinished();
+    //process this window before the other pending ones
+    m_listPendingWindows.removeAll(m_data[windowIndex]);
+    m_listPendingWindows.prepend(m_data[windowIndex]);
 
-    qDebug() << "RawModel: finished concurrent PROCESSING operation of" << listFilteredChs.size() << "items";
+    m_bProcessing = true;
 
-    insertProcessedDataAll(windowIndex);
+    processNextWindow();
 }
 
 
 //*************************************************************************************************************
 
-void RawModel::insertProcessedDataRow(int rowIndex)
+void RawModel::processNextWindow()
 {
-    QList<int> listFilteredChs = m_assignedOperators.keys();
-
-    int dataLength = m_iWindowSize;
-    if(m_bReloadBefore)
-        dataLength = m_data.first()->dataRaw().cols();
-    else
-        dataLength = m_data.last()->dataRaw().cols();
-
-    int cutFront = m_iCurrentFFTLength/4;
-    int cutBack = m_iCurrentFFTLength/4 + (m_listTmpChData[0].second.cols()-m_iCurrentFFTLength/2-dataLength);
-
-    if(m_bReloadBefore)
-        m_data.first()->setOrigProcData(m_listTmpChData[rowIndex].second, m_listTmpChData[rowIndex].first, cutFront, cutBack);
-    else
-        m_data.last()->setOrigProcData(m_listTmpChData[rowIndex].second, m_listTmpChData[rowIndex].first, cutFront, cutBack);
-
-    performOverlapAdd();
+    if(m_operatorFutureWatcher.isRunning())
+        return;
 
-    emit dataChanged(createIndex(listFilteredChs[rowIndex],1),createIndex(listFilteredChs[rowIndex],1));
+    //skip windows which were dropped from m_data in the meantime
+    while(!m_listPendingWindows.isEmpty() && !m_data.contains(m_listPendingWindows.first()))
+        m_listPendingWindows.removeFirst();
 
-    if(rowIndex == listFilteredChs.last())
+    if(m_listPendingWindows.isEmpty() || m_assignedOperators.empty()) {
+        m_listPendingWindows.clear();
+        m_pProcessingWindow.clear();
         m_bProcessing = false;
-}
-
-
-//*************************************************************************************************************
-
-void RawModel::insertProcessedDataAll(int windowIndex)
-{
-    if(windowIndex >= m_data.size() || windowIndex < 0 || m_assignedOperators.empty())
-        windowIndex = 0;
+        return;
+    }
 
-    QList<int> listFilteredChs = m_assignedOperators.keys();
+    m_pProcessingWindow = m_listPendingWindows.takeFirst();
+    m_iProcessingGeneration = m_iOperatorGeneration;
 
-    int dataLength = m_data[windowIndex]->dataRaw().cols();;
+    //get the rows which are to be filtered out of the window. The background-thread works on copies, so m_data can change meanwhile
+    QList<int> listFilteredChs = m_assignedOperators.uniqueKeys();
+    QList<QPair<int,RowVectorXd> > listChData;
 
-    int cutFront = m_iCurrentFFTLength/4;
-    int cutBack = m_iCurrentFFTLength/4 + (m_listTmpChData[0].second.cols()-m_iCurrentFFTLength/2-dataLength);
+    for(qint32 i=0; i < listFilteredChs.size(); ++i)
+        listChData.append(QPair<int,RowVectorXd>(listFilteredChs[i],m_pProcessingWindow->dataRawOrig().row(listFilteredChs[i])));
 
-    //Set and cut original data to window size and calculate mean for filtered data
-    for(int i=0; i < listFilteredChs.size(); ++i)
-        m_data[windowIndex]->setOrigProcData(m_listTmpChData[i].second, listFilteredChs[i], cutFront, cutBack);
+    QMap<int,QSharedPointer<MNEOperator> > assignedOperators = m_assignedOperators;
 
-    emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size(),1));
+    QFuture<QList<QPair<int,RowVectorXd> > > future = QtConcurrent::run([listChData, assignedOperators]() mutable {
+        applyOperatorsConcurrently(listChData, assignedOperators);
+        return listChData;
+    });
 
-    qDebug() << "RawModel: Finished inserting" << listFilteredChs.size() << "channels in window "<<windowIndex;
+    m_operatorFutureWatcher.setFuture(future);
 }
 
 
 //*************************************************************************************************************
 
-void RawModel::insertProcessedDataAll()
+void RawModel::insertProcessedWindow()
 {
-    QList<int> listFilteredChs = m_assignedOperators.keys();
+    QSharedPointer<DataPackage> window = m_pProcessingWindow;
+    m_pProcessingWindow.clear();
 
-    int dataLength = m_iWindowSize;
-    if(m_bReloadBefore)
-        dataLength = m_data.first()->dataRaw().cols();
-    else
-        dataLength = m_data.last()->dataRaw().cols();
+    int windowIndex = m_data.indexOf(window);
 
-    int cutFront = m_iCurrentFFTLength/4;
-    int cutBack = m_iCurrentFFTLength/4 + (m_listTmpChData[0].second.cols()-m_iCurrentFFTLength/2-dataLength);
-
-    //Set and cut original data to window size and calculate mean for filtered data
-    for(int i=0; i < listFilteredChs.size(); ++i) {
-        if(m_bReloadBefore)
-            m_data.first()->setOrigProcData(m_listTmpChData[i].second, listFilteredChs[i], cutFront, cutBack);
-        else
-            m_data.last()->setOrigProcData(m_listTmpChData[i].second, listFilteredChs[i], cutFront, cutBack);
+    if(m_iProcessingGeneration != m_iOperatorGeneration || windowIndex < 0) {
+        qDebug() << "RawModel: Dropped outdated PROCESSING result";
     }
+    else {
+        QList<QPair<int,RowVectorXd> > listChData = m_operatorFutureWatcher.result();
 
-    performOverlapAdd();
+        int dataLength = window->dataRaw().cols();
+        int cutFront = m_iCurrentFFTLength/4;
 
-    emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size(),1));
+        //Set and cut original data to window size and calculate mean for filtered data
+        for(int i=0; i < listChData.size(); ++i) {
+            int cutBack = m_iCurrentFFTLength/4 + (listChData[i].second.cols()-m_iCurrentFFTLength/2-dataLength);
+            window->setOrigProcData(listChData[i].second, listChData[i].first, cutFront, cutBack);
+        }
 
-    qDebug() << "RawModel: Finished inserting" << listFilteredChs.size() << "channels.";
-    m_bProcessing = false;
+        //the overlap of the neighbouring windows depends on this window as well
+        for(int i = windowIndex-1; i <= windowIndex+1; ++i)
+            performOverlapAdd(i);
+
+        emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size()-1,1));
+
+        qDebug() << "RawModel: Finished inserting" << listChData.size() << "channels in window" << windowIndex;
+    }
+
+    processNextWindow();
 }
 
 
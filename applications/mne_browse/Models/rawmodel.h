@@ -52,7 +52,8 @@
 *           of the QtConcurrent features. [2]
 *           Therefore, the methods updateOperatorsConcurrently() and readSegment() is run in a background-thread. Once the results
 *           are ready the m_operatorFutureWatcher and m_reloadFutureWatcher emits a signal that is connect to the slots
-*           insertProcessedData() and insertReloadedData(), respectively.
+*           insertProcessedWindow() and insertReloadedData(), respectively. Operators are applied one window after the other,
+*           starting with the visible window, so that changing the filter settings again drops the windows still pending.
 *
 *           MNEOperators such as FilterOperators are stored in m_Operators. The MNEOperators that are applied to any
 *           individual channel are stored in the QMap m_assignedOperators.
@@ -75,6 +76,7 @@
 #include "../Utils/filteroperator.h"
 #include "../Utils/rawsettings.h"
 #include "../Utils/datapackage.h"
+#include "../Utils/rawtilecache.h"
 
 
 //*************************************************************************************************************
@@ -179,6 +181,16 @@ public:
     */
     bool writeFiffData(QIODevice *p_IODevice);
 
+    //=========================================================================================================
+    /**
+    * channelEnvelope returns the min/max envelope of a channel for all loaded windows, following the same raw/processed selection as the DisplayRole.
+    *
+    * @param row the channel row
+    * @param level the decimation level, see DataPackage::envelopeDecimation
+    * @return one envelope per loaded window
+    */
+    QList<RowEnvelope> channelEnvelope(int row, int level) const;
+
     //VARIABLES
     bool                                        m_bFileloaded;  /**< true when a Fiff file is loaded */
     QList<FiffChInfo>                           m_chInfolist;   /**< List of FiffChInfo objects that holds the corresponding channels information */
@@ -206,6 +218,26 @@ private:
     */
     void clearModel();
 
+    //=========================================================================================================
+    /**
+    * showsProcessedData returns whether the processed instead of the raw data of a window is shown for a channel.
+    *
+    * @param row the channel row
+    * @param window the index of the window in m_data
+    * @return true if the processed data is shown
+    */
+    bool showsProcessedData(int row, int window) const;
+
+    //=========================================================================================================
+    /**
+    * applyOperatorsConcurrently applies the MNEOperators assigned to the channels of a window to their rows and modifies them in-place.
+    * Channels sharing the same FilterOperators are filtered together in one batch.
+    *
+    * @param listChData pairs of a channel number and the corresponding row of the window
+    * @param assignedOperators the MNEOperators assigned to the channels
+    */
+    static void applyOperatorsConcurrently(QList<QPair<int,RowVectorXd> > &listChData, const QMap<int,QSharedPointer<MNEOperator> > &assignedOperators);
+
     //=========================================================================================================
     /**
     * resetPosition reset the position of the current m_iAbsFiffCursor if a ScrollBar position is selected, whose data is not yet loaded.
@@ -224,7 +256,7 @@ private:
 
     //=========================================================================================================
     /**
-    * @brief readSegment is the wrapper method to read a segment from the raw fiff file
+    * @brief readSegment is the wrapper method to read a segment from the raw fiff file, the segment is assembled from m_pTileCache
     *
     * @param from the start point to read from the file
     * @param to the end point to read from the file
@@ -243,16 +275,17 @@ private:
     bool                                    m_bReloading;               /**< signals when the reloading is ongoing. */
 
     //Concurrent processing
-//    QFutureWatcher<QPair<int,RowVectorXd> > m_operatorFutureWatcher; /**< QFutureWatcher for watching process of applying Operators to reloaded fiff data. */
-    QFutureWatcher<void>                    m_operatorFutureWatcher;    /**< QFutureWatcher for watching process of applying Operators to reloaded fiff data. */
-    QList<QPair<int,RowVectorXd> >          m_listTmpChData;            /**< contains pairs with a channel number and the corresponding RowVectorXd. */
+    QFutureWatcher<QList<QPair<int,RowVectorXd> > > m_operatorFutureWatcher;  /**< QFutureWatcher for watching process of applying Operators to one window of m_data. */
+    QList<QSharedPointer<DataPackage> >     m_listPendingWindows;       /**< Windows of m_data whose processed data is outdated, in the order they are processed. */
+    QSharedPointer<DataPackage>             m_pProcessingWindow;        /**< Window of m_data which is processed in the background-thread. */
+    int                                     m_iOperatorGeneration;      /**< Increased whenever the operators are applied anew, results of older generations are dropped. */
+    int                                     m_iProcessingGeneration;    /**< Generation of the operators applied in the background-thread. */
     bool                                    m_bProcessing;              /**< true when processing in a background-thread is ongoing.*/
     QString                                 m_filterChType;
 
-    QMutex                                  m_Mutex;                    /**< mutex for locking against simultaenous access to shared objects >. */
-
     //Fiff data structure
     QList<QSharedPointer<DataPackage> >     m_data;                     /**< List that holds the fiff matrix data <n_channels x n_samples>. */
+    RawTileCache::SPtr                      m_pTileCache;               /**< Cache of sample blocks the windows in m_data are assembled from. */
 
     //Filter operators
     QMap<int,QSharedPointer<MNEOperator> >  m_assignedOperators;        /**< Map of MNEOperator types to channels.*/
@@ -330,14 +363,6 @@ public slots:
     */
     void applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOperator> &operatorPtr);
 
-    //=========================================================================================================
-    /**
-    * applyOperatorsConcurrently updates all applied MNEOperators to a given RowVectorXd and modifies it in-place
-    *
-    * @param chdata[in,out] represents the channel data as a RowVectorXd
-    */
-    void applyOperatorsConcurrently(QPair<int, RowVectorXd> &chdata) const;
-
     //=========================================================================================================
     /**
     * updateOperators updates all set operator to channels according to m_assignedOperators
@@ -415,13 +440,14 @@ private slots:
 
     //=========================================================================================================
     /**
-    * updateOperatorsConcurrently runs the processing of the MNEOperators in a background-thread
+    * updateOperatorsConcurrently applies the MNEOperators anew to all windows in a background-thread, starting with the visible
+    * window and continuing with its neighbours. Results of a previous call which are still pending are dropped.
     */
     void updateOperatorsConcurrently();
 
     //=========================================================================================================
     /**
-    * updateOperatorsConcurrently runs the processing of the MNEOperators in a background-thread for a given index of the data package list m_data
+    * updateOperatorsConcurrently processes the window with the given index of the data package list m_data next in a background-thread
     *
     * @param windowIndex the index of m_data which is to be filtered
     */
@@ -429,25 +455,16 @@ private slots:
 
     //=========================================================================================================
     /**
-    * insertProcessedDataRow inserts the processed data row into m_data when background-thread has finished (this method would be used for QtConcurrent::mapped)
-    *
-    * @param index represents the row index in m_data
-    */
-    void insertProcessedDataRow(int rowIndex);
-
-    //=========================================================================================================
-    /**
-    * insertProcessedDataAll inserts all the processed data into m_data[windowIndex] when background-thread has finished
-    *
-    * @param index represents the window index in m_data
+    * processNextWindow starts processing the next pending window in a background-thread unless a window is processed already
     */
-    void insertProcessedDataAll(int windowIndex);
+    void processNextWindow();
 
     //=========================================================================================================
     /**
-    * insertProcessedDataAll inserts all the processed data into m_data in front (m_ReloadFront = true) or back (m_ReloadFront = false) when background-thread has finished (this method would be used for QtConcurrent::map)
+    * insertProcessedWindow inserts the processed data into its window when the background-thread has finished,
+    * updates the overlap with the neighbouring windows and continues with the next pending window
     */
-    void insertProcessedDataAll();
+    void insertProcessedWindow();
 
     //=========================================================================================================
     /**
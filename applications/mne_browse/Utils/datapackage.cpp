@@ -40,6 +40,7 @@
 //=============================================================================================================
 
 #include "datapackage.h"
+#include "rawsettings.h"
 
 
 //*************************************************************************************************************
@@ -78,6 +79,7 @@ DataPackage::DataPackage(const MatrixXdR &originalRawData, const MatrixXdR &orig
     //Init mean data
     m_dataRawMean = calculateMatMean(m_dataRawMapped);
     m_dataProcMean = calculateMatMean(m_dataProcMapped);
+    updateEnvelope(m_dataProcMapped, -1, m_envelopeProcMin, m_envelopeProcMax);
 }
 
 
@@ -97,8 +99,9 @@ void DataPackage::setOrigRawData(const MatrixXdR &originalRawData, int cutFront,
     if(cutBack != m_iCutBackRaw)
         m_iCutBackRaw = cutBack;
 
-    //Calculate mean
+    //Calculate mean and envelope
     m_dataRawMean = calculateMatMean(m_dataRawMapped);
+    updateEnvelope(m_dataRawMapped, -1, m_envelopeRawMin, m_envelopeRawMax);
 }
 
 
@@ -123,8 +126,9 @@ void DataPackage::setOrigRawData(const RowVectorXd &originalRawData, int row, in
     if(cutBack != m_iCutBackRaw)
         m_iCutBackRaw = cutBack;
 
-    //Calculate mean
+    //Calculate mean and envelope
     m_dataRawMean(row) = calculateRowMean(m_dataRawMapped.row(row));
+    updateEnvelope(m_dataRawMapped, row, m_envelopeRawMin, m_envelopeRawMax);
 }
 
 
@@ -144,8 +148,9 @@ void DataPackage::setOrigProcData(const MatrixXdR &originalProcData, int cutFron
     if(cutBack != m_iCutBackProc)
         m_iCutBackProc = cutBack;
 
-    //Calculate mean
+    //Calculate mean and envelope
     m_dataProcMean = calculateMatMean(m_dataProcMapped);
+    updateEnvelope(m_dataProcMapped, -1, m_envelopeProcMin, m_envelopeProcMax);
 }
 
 
@@ -162,8 +167,9 @@ void DataPackage::setMappedProcData(const MatrixXdR &originalProcData, int cutFr
     if(cutBack != m_iCutBackProc)
         m_iCutBackProc = cutBack;
 
-    //Calculate mean
+    //Calculate mean and envelope
     m_dataProcMean = calculateMatMean(m_dataProcMapped);
+    updateEnvelope(m_dataProcMapped, -1, m_envelopeProcMin, m_envelopeProcMax);
 }
 
 
@@ -188,8 +194,9 @@ void DataPackage::setOrigProcData(const RowVectorXd &originalProcData, int row,
     if(cutBack != m_iCutBackProc)
         m_iCutBackProc = cutBack;
 
-    //Calculate mean
+    //Calculate mean and envelope
     m_dataProcMean(row) = calculateRowMean(m_dataProcMapped.row(row));
+    updateEnvelope(m_dataProcMapped, row, m_envelopeProcMin, m_envelopeProcMax);
 }
 
 
@@ -211,8 +218,9 @@ void DataPackage::setMappedProcData(const RowVectorXd &originalProcData, int row
     if(cutBack != m_iCutBackProc)
         m_iCutBackProc = cutBack;
 
-    //Calculate mean
+    //Calculate mean and envelope
     m_dataProcMean(row) = calculateRowMean(m_dataProcMapped.row(row));
+    updateEnvelope(m_dataProcMapped, row, m_envelopeProcMin, m_envelopeProcMax);
 }
 
 //*************************************************************************************************************
@@ -286,8 +294,41 @@ void DataPackage::applyFFTFilter(int channelNumber, QSharedPointer<FilterOperato
     //Cut filtered m_dataProcOriginal
     m_dataProcMapped = cutData(m_dataProcOriginal, m_iCutFrontProc, m_iCutBackProc);
 
-    //Calculate mean
+    //Calculate mean and envelope
     m_dataProcMean(channelNumber) = calculateRowMean(m_dataProcMapped);
+    updateEnvelope(m_dataProcMapped, channelNumber, m_envelopeProcMin, m_envelopeProcMax);
+}
+
+
+//*************************************************************************************************************
+
+RowEnvelope DataPackage::envelopeRaw(int row, int level)
+{
+    return envelope(row, level, m_envelopeRawMin, m_envelopeRawMax);
+}
+
+
+//*************************************************************************************************************
+
+RowEnvelope DataPackage::envelopeProc(int row, int level)
+{
+    return envelope(row, level, m_envelopeProcMin, m_envelopeProcMax);
+}
+
+
+//*************************************************************************************************************
+
+int DataPackage::envelopeDecimation(int level)
+{
+    return DATAPACKAGE_ENVELOPE_DECIMATION << level;
+}
+
+
+//*************************************************************************************************************
+
+int DataPackage::numberEnvelopeLevels()
+{
+    return DATAPACKAGE_ENVELOPE_LEVELS;
 }
 
 
@@ -345,3 +386,74 @@ double DataPackage::calculateRowMean(const VectorXd &dataRow)
 
 
 
+
+
+//*************************************************************************************************************
+
+void DataPackage::updateEnvelope(const MatrixXdR &data, int row, QVector<MatrixXfR> &envelopeMin, QVector<MatrixXfR> &envelopeMax)
+{
+    const int levels = numberEnvelopeLevels();
+
+    //Rebuild the whole pyramid if a single row was requested but the data size changed
+    if(row < 0 || envelopeMin.size() != levels || envelopeMin[0].rows() != data.rows()
+            || envelopeMin[0].cols() != (data.cols() + DATAPACKAGE_ENVELOPE_DECIMATION - 1) / DATAPACKAGE_ENVELOPE_DECIMATION) {
+        envelopeMin.resize(levels);
+        envelopeMax.resize(levels);
+
+        for(int l = 0; l < levels; ++l) {
+            const int decimation = envelopeDecimation(l);
+            envelopeMin[l].resize(data.rows(), (data.cols() + decimation - 1) / decimation);
+            envelopeMax[l].resize(data.rows(), (data.cols() + decimation - 1) / decimation);
+        }
+
+        for(int r = 0; r < data.rows(); ++r)
+            updateEnvelope(data, r, envelopeMin, envelopeMax);
+
+        return;
+    }
+
+    if(row >= data.rows())
+        return;
+
+    //The finest level is calculated from the samples
+    const int samples = data.cols();
+
+    for(int k = 0; k < envelopeMin[0].cols(); ++k) {
+        const int first = k * DATAPACKAGE_ENVELOPE_DECIMATION;
+        const int length = qMin(DATAPACKAGE_ENVELOPE_DECIMATION, samples - first);
+
+        envelopeMin[0](row, k) = data.row(row).segment(first, length).minCoeff();
+        envelopeMax[0](row, k) = data.row(row).segment(first, length).maxCoeff();
+    }
+
+    //Every coarser level merges two entries of the previous one
+    for(int l = 1; l < levels; ++l) {
+        const int entries = envelopeMin[l-1].cols();
+
+        for(int k = 0; k < envelopeMin[l].cols(); ++k) {
+            const int first = 2 * k;
+            const int second = qMin(first + 1, entries - 1);
+
+            envelopeMin[l](row, k) = qMin(envelopeMin[l-1](row, first), envelopeMin[l-1](row, second));
+            envelopeMax[l](row, k) = qMax(envelopeMax[l-1](row, first), envelopeMax[l-1](row, second));
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+RowEnvelope DataPackage::envelope(int row, int level, const QVector<MatrixXfR> &envelopeMin, const QVector<MatrixXfR> &envelopeMax) const
+{
+    RowEnvelope rowEnvelope = {Q_NULLPTR, Q_NULLPTR, 0, 0};
+
+    if(level < 0 || level >= envelopeMin.size() || row < 0 || row >= envelopeMin[level].rows())
+        return rowEnvelope;
+
+    rowEnvelope.pMin = envelopeMin[level].data() + row*envelopeMin[level].cols();
+    rowEnvelope.pMax = envelopeMax[level].data() + row*envelopeMax[level].cols();
+    rowEnvelope.iLength = envelopeMin[level].cols();
+    rowEnvelope.iDecimation = envelopeDecimation(level);
+
+    return rowEnvelope;
+}
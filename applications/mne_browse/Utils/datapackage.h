@@ -52,6 +52,7 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -224,6 +225,43 @@ public:
     */
     void applyFFTFilter(int channelNumber, QSharedPointer<FilterOperator> filter, bool useRawData = true);
 
+    //=========================================================================================================
+    /**
+    * Returns the min/max envelope of a row of the mapped raw data.
+    *
+    * @param row the row index
+    * @param level the decimation level, see envelopeDecimation
+    * @return the envelope, empty if row or level are out of range
+    */
+    RowEnvelope envelopeRaw(int row, int level);
+
+    //=========================================================================================================
+    /**
+    * Returns the min/max envelope of a row of the mapped processed data.
+    *
+    * @param row the row index
+    * @param level the decimation level, see envelopeDecimation
+    * @return the envelope, empty if row or level are out of range
+    */
+    RowEnvelope envelopeProc(int row, int level);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples merged into one envelope entry at a level. The decimation doubles from level to level.
+    *
+    * @param level the decimation level
+    * @return the number of samples per envelope entry
+    */
+    static int envelopeDecimation(int level);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of envelope levels which are kept for each data package.
+    *
+    * @return the number of levels
+    */
+    static int numberEnvelopeLevels();
+
 private:
     //=========================================================================================================
     /**
@@ -263,6 +301,29 @@ private:
     */
     double calculateRowMean(const VectorXd &dataRow);
 
+    //=========================================================================================================
+    /**
+    * updateEnvelope recalculates the min/max pyramid of the data. If a row is given and the pyramid fits the data size, only this row is recalculated.
+    *
+    * @param data the mapped data
+    * @param row the row to update, -1 to update all rows
+    * @param envelopeMin the minima of each level
+    * @param envelopeMax the maxima of each level
+    */
+    void updateEnvelope(const MatrixXdR &data, int row, QVector<MatrixXfR> &envelopeMin, QVector<MatrixXfR> &envelopeMax);
+
+    //=========================================================================================================
+    /**
+    * Returns a row of the envelope pyramid.
+    *
+    * @param row the row index
+    * @param level the decimation level
+    * @param envelopeMin the minima of each level
+    * @param envelopeMax the maxima of each level
+    * @return the envelope, empty if row or level are out of range
+    */
+    RowEnvelope envelope(int row, int level, const QVector<MatrixXfR> &envelopeMin, const QVector<MatrixXfR> &envelopeMax) const;
+
     //Time data
     MatrixXdR   m_timeRawMapped;        /**< The mapped/cut time data */
     MatrixXdR   m_timeRawOriginal;      /**< the original time data */
@@ -271,11 +332,15 @@ private:
     MatrixXdR   m_dataRawMapped;        /**< The mapped/cut raw data */
     MatrixXdR   m_dataRawOriginal;      /**< The original raw data */
     VectorXd    m_dataRawMean;          /**< The mean of the mapped/cut raw data */
+    QVector<MatrixXfR> m_envelopeRawMin;    /**< The min envelope pyramid of the mapped/cut raw data */
+    QVector<MatrixXfR> m_envelopeRawMax;    /**< The max envelope pyramid of the mapped/cut raw data */
 
     //Processed data
     MatrixXdR   m_dataProcOriginal;     /**< The mapped/cut processed/filtered data */
     MatrixXdR   m_dataProcMapped;       /**< The original processed/filtered data */
     VectorXd    m_dataProcMean;         /**< The mean of the mapped/cut processed/filtered data */
+    QVector<MatrixXfR> m_envelopeProcMin;   /**< The min envelope pyramid of the mapped/cut processed/filtered data */
+    QVector<MatrixXfR> m_envelopeProcMax;   /**< The max envelope pyramid of the mapped/cut processed/filtered data */
 
     //Cutting parameters
     int m_iCutFrontRaw;                 /**< The last used cut front value of the raw data */
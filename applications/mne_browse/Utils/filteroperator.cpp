@@ -43,6 +43,14 @@
 #include "filteroperator.h"
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -191,3 +199,18 @@ RowVectorXd FilterOperator::applyFFTFilter(const RowVectorXd& data) const
     //Return filtered data still with zeros at front and end
     return t_filteredTime;
 }
+
+
+//*************************************************************************************************************
+
+MatrixXd FilterOperator::applyFFTFilter(const MatrixXd& data) const
+{
+    MatrixXd filteredData;
+
+    //Same zero padding as for a single row, the rows are distributed over one FFT workspace per thread
+    FFTFilterBatch batch(m_dFFTCoeffA, m_iFFTlength);
+    if(!batch.filter(data, filteredData, m_iFFTlength/4-m_iFilterOrder/2))
+        qDebug() << "FilterOperator::applyFFTFilter - Could not filter data of" << data.cols() << "samples with FFT length" << m_iFFTlength;
+
+    return filteredData;
+}
@@ -66,6 +66,7 @@
 #include <mne/mne.h>
 #include <utils/filterTools/parksmcclellan.h>
 #include <utils/filterTools/cosinefilter.h>
+#include <utils/filterTools/fftfilterbatch.h>
 #include "disp/helpers/mneoperator.h"
 
 
@@ -158,6 +159,15 @@ public:
     */
     RowVectorXd applyFFTFilter(const RowVectorXd& data) const;
 
+    //=========================================================================================================
+    /**
+    * FilterOperator::applyFFTFilter filters all rows of a matrix at once, batched over the available threads
+    *
+    * @param data the input data which is to be filtered, one row per channel
+    * @return the filtered rows, each as returned by applyFFTFilter(const RowVectorXd&)
+    */
+    MatrixXd applyFFTFilter(const MatrixXd& data) const;
+
     double          m_sFreq;            /**< the sampling frequency. */
     int             m_iFilterOrder;     /**< represents the order of the filter instance. */
     int             m_iFFTlength;       /**< represents the filter length. */
@@ -83,6 +83,15 @@
 #define MODEL_NUM_FILTER_TAPS 80 //number of filter taps, required to take into account because of FFT convolution (zero padding)
 #define MODEL_MAX_NUM_FILTER_TAPS 0 //number of maximal filter taps
 
+//RawTileCache
+#define TILECACHE_TILE_SIZE 1024 //length of a cached sample block [in samples]
+#define TILECACHE_MAX_TILES 32 //number of sample blocks that are at maximum remained in the cache
+#define TILECACHE_PREFETCH_TILES 4 //number of sample blocks that are read ahead in scroll direction
+
+//DataPackage
+#define DATAPACKAGE_ENVELOPE_DECIMATION 4 //number of samples merged into one min/max entry at the finest envelope level
+#define DATAPACKAGE_ENVELOPE_LEVELS 10 //number of envelope levels, the decimation doubles from level to level
+
 //RawDelegate
 //Look
 #define DELEGATE_PLOT_HEIGHT 40 //height of a single plot (row)
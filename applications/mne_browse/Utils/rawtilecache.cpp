@@ -0,0 +1,257 @@
+//=============================================================================================================
+/**
+* @file     rawtilecache.cpp
+* @author   Lorenz Esch <lorenz.esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>;
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the RawTileCache class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rawtilecache.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNEBROWSE;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RawTileCache::RawTileCache(QSharedPointer<FiffRawData> pRaw, qint32 iTileSize, qint32 iMaxTiles, qint32 iPrefetchTiles)
+: m_pRaw(pRaw)
+, m_iTileSize(qMax(iTileSize, 1))
+, m_iMaxTiles(qMax(iMaxTiles, 1))
+, m_iNumTiles(0)
+, m_bAbortPrefetch(0)
+{
+    //prefetched tiles must not push the tiles of the current segment out of the cache
+    m_iPrefetchTiles = qBound(0, iPrefetchTiles, m_iMaxTiles/2);
+
+    if(!m_pRaw)
+        return;
+
+    m_iNumTiles = (m_pRaw->last_samp - m_pRaw->first_samp)/m_iTileSize + 1;
+
+    if(!m_pRaw->file || !m_pRaw->file->map_file())
+        qDebug() << "RawTileCache: Fiff file could not be memory mapped, tiles are read through the stream.";
+}
+
+
+//*************************************************************************************************************
+
+RawTileCache::~RawTileCache()
+{
+    m_bAbortPrefetch.store(1);
+    m_prefetchFuture.waitForFinished();
+}
+
+
+//*************************************************************************************************************
+
+bool RawTileCache::readSegment(MatrixXd &data, MatrixXd &times, fiff_int_t from, fiff_int_t to)
+{
+    if(!m_pRaw)
+        return false;
+
+    from = qMax(from, m_pRaw->first_samp);
+    to = qMin(to, m_pRaw->last_samp);
+
+    if(from > to) {
+        qDebug() << "RawTileCache: No data in the requested range" << from << "to" << to;
+        return false;
+    }
+
+    qint32 iFirstTile = (from - m_pRaw->first_samp)/m_iTileSize;
+    qint32 iLastTile = (to - m_pRaw->first_samp)/m_iTileSize;
+    qint32 iSamples = to - from + 1;
+    qint32 iDest = 0;
+
+    for(qint32 i = iFirstTile; i <= iLastTile; ++i) {
+        QSharedPointer<const Tile> pTile = tile(i);
+        if(!pTile) {
+            qDebug() << "RawTileCache: Error when reading tile" << i;
+            return false;
+        }
+
+        //copy the part of the tile which overlaps with the segment
+        fiff_int_t iTileStart = m_pRaw->first_samp + i*m_iTileSize;
+        qint32 iBegin = qMax(from, iTileStart) - iTileStart;
+        qint32 iEnd = qMin(to, iTileStart + (fiff_int_t)pTile->first.cols() - 1) - iTileStart;
+        qint32 iCount = iEnd - iBegin + 1;
+        if(iCount <= 0)
+            break;
+
+        if(iDest == 0) {
+            data.resize(pTile->first.rows(), iSamples);
+            times.resize(pTile->second.rows(), iSamples);
+        }
+
+        data.middleCols(iDest, iCount) = pTile->first.middleCols(iBegin, iCount);
+        times.middleCols(iDest, iCount) = pTile->second.middleCols(iBegin, iCount);
+        iDest += iCount;
+    }
+
+    if(iDest < iSamples) {
+        data.conservativeResize(NoChange, iDest);
+        times.conservativeResize(NoChange, iDest);
+    }
+
+    return iDest > 0;
+}
+
+
+//*************************************************************************************************************
+
+void RawTileCache::prefetch(fiff_int_t from, fiff_int_t to, bool forward)
+{
+    if(!m_pRaw || m_iPrefetchTiles == 0 || m_prefetchFuture.isRunning())
+        return;
+
+    qint32 iFirstTile = (qMax(from, m_pRaw->first_samp) - m_pRaw->first_samp)/m_iTileSize;
+    qint32 iLastTile = (qMin(to, m_pRaw->last_samp) - m_pRaw->first_samp)/m_iTileSize;
+
+    QList<qint32> listTiles;
+    for(qint32 i = 1; i <= m_iPrefetchTiles; ++i) {
+        qint32 iTile = forward ? iLastTile + i : iFirstTile - i;
+        if(iTile < 0 || iTile >= m_iNumTiles)
+            break;
+
+        if(!cachedTile(iTile, false))
+            listTiles.append(iTile);
+    }
+
+    if(listTiles.isEmpty())
+        return;
+
+    m_prefetchFuture = QtConcurrent::run(this, &RawTileCache::prefetchTiles, listTiles);
+}
+
+
+//*************************************************************************************************************
+
+int RawTileCache::numberTiles()
+{
+    QMutexLocker locker(&m_cacheMutex);
+    return m_hashTiles.size();
+}
+
+
+//*************************************************************************************************************
+
+QSharedPointer<const RawTileCache::Tile> RawTileCache::tile(qint32 iTile)
+{
+    QSharedPointer<const Tile> pTile = cachedTile(iTile, true);
+    if(pTile)
+        return pTile;
+
+    return loadTile(iTile);
+}
+
+
+//*************************************************************************************************************
+
+QSharedPointer<const RawTileCache::Tile> RawTileCache::cachedTile(qint32 iTile, bool bTouch)
+{
+    QMutexLocker locker(&m_cacheMutex);
+
+    QSharedPointer<const Tile> pTile = m_hashTiles.value(iTile);
+    if(pTile && bTouch) {
+        m_listRecentTiles.removeOne(iTile);
+        m_listRecentTiles.prepend(iTile);
+    }
+
+    return pTile;
+}
+
+
+//*************************************************************************************************************
+
+QSharedPointer<const RawTileCache::Tile> RawTileCache::loadTile(qint32 iTile)
+{
+    QMutexLocker readLocker(&m_readMutex);
+
+    //the tile might have been read by the prefetch while waiting for the file
+    QSharedPointer<const Tile> pCached = cachedTile(iTile, true);
+    if(pCached)
+        return pCached;
+
+    fiff_int_t from = m_pRaw->first_samp + iTile*m_iTileSize;
+    fiff_int_t to = qMin(from + m_iTileSize - 1, m_pRaw->last_samp);
+
+    QSharedPointer<Tile> pTile(new Tile);
+    if(!m_pRaw->read_raw_segment(pTile->first, pTile->second, from, to))
+        return QSharedPointer<const Tile>();
+
+    QMutexLocker cacheLocker(&m_cacheMutex);
+
+    m_hashTiles.insert(iTile, pTile);
+    m_listRecentTiles.prepend(iTile);
+
+    //drop the least recently used tiles
+    while(m_listRecentTiles.size() > m_iMaxTiles)
+        m_hashTiles.remove(m_listRecentTiles.takeLast());
+
+    return pTile;
+}
+
+
+//*************************************************************************************************************
+
+void RawTileCache::prefetchTiles(const QList<qint32> &listTiles)
+{
+    for(qint32 i = 0; i < listTiles.size(); ++i) {
+        if(m_bAbortPrefetch.load())
+            return;
+
+        if(!cachedTile(listTiles[i], false))
+            loadTile(listTiles[i]);
+    }
+}
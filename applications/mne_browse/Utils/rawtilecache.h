@@ -0,0 +1,205 @@
+//=============================================================================================================
+/**
+* @file     rawtilecache.h
+* @author   Lorenz Esch <lorenz.esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>;
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the RawTileCache class.
+*
+*/
+
+#ifndef RAWTILECACHE_H
+#define RAWTILECACHE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_raw_data.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QMutex>
+#include <QFuture>
+#include <QAtomicInt>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNEBROWSE
+//=============================================================================================================
+
+namespace MNEBROWSE
+{
+
+
+//=============================================================================================================
+/**
+* RawTileCache...
+*
+* @brief The RawTileCache class holds fixed-size sample blocks (tiles) of a raw fiff file. Segments are assembled
+*        from these tiles, the least recently used tiles are dropped once the cache is full. Tiles ahead of the
+*        current scroll direction are read in a background-thread, so that scrolling does not wait for the disk.
+*/
+class RawTileCache
+{
+public:
+    typedef QSharedPointer<RawTileCache> SPtr;              /**< Shared pointer type for RawTileCache. */
+    typedef QSharedPointer<const RawTileCache> ConstSPtr;   /**< Const shared pointer type for RawTileCache. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a RawTileCache. The file of the raw data is memory mapped if possible.
+    *
+    * @param pRaw the raw data the tiles are read from
+    * @param iTileSize the length of a tile [in samples]
+    * @param iMaxTiles the number of tiles which are at maximum kept in the cache
+    * @param iPrefetchTiles the number of tiles which are read ahead of a segment
+    */
+    RawTileCache(QSharedPointer<FiffRawData> pRaw, qint32 iTileSize, qint32 iMaxTiles, qint32 iPrefetchTiles);
+
+    //=========================================================================================================
+    /**
+    * Destroys the RawTileCache. A running prefetch is stopped before.
+    */
+    ~RawTileCache();
+
+    //=========================================================================================================
+    /**
+    * Reads a segment from the cache. Missing tiles are read from the file. This method is thread-safe.
+    *
+    * @param data returns the data matrix (channels x samples)
+    * @param times returns the time values corresponding to the samples
+    * @param from the first sample to include
+    * @param to the last sample to include
+    * @return true if succeeded, false otherwise
+    */
+    bool readSegment(MatrixXd &data, MatrixXd &times, fiff_int_t from, fiff_int_t to);
+
+    //=========================================================================================================
+    /**
+    * Reads the tiles next to a segment in a background-thread. Nothing happens while a prefetch is still running.
+    *
+    * @param from the first sample of the segment
+    * @param to the last sample of the segment
+    * @param forward whether the tiles after (true) or before (false) the segment are read
+    */
+    void prefetch(fiff_int_t from, fiff_int_t to, bool forward);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of tiles currently held in the cache.
+    *
+    * @return the number of tiles
+    */
+    int numberTiles();
+
+private:
+    typedef QPair<MatrixXd,MatrixXd> Tile;                  /**< The data and times matrices of a tile. */
+
+    //=========================================================================================================
+    /**
+    * Returns a tile and marks it as most recently used. The tile is read from the file if it is not cached.
+    *
+    * @param iTile the index of the tile
+    * @return the tile, a null pointer if reading failed
+    */
+    QSharedPointer<const Tile> tile(qint32 iTile);
+
+    //=========================================================================================================
+    /**
+    * Looks up a cached tile.
+    *
+    * @param iTile the index of the tile
+    * @param bTouch whether the tile is marked as most recently used
+    * @return the tile, a null pointer if it is not cached
+    */
+    QSharedPointer<const Tile> cachedTile(qint32 iTile, bool bTouch);
+
+    //=========================================================================================================
+    /**
+    * Reads a tile from the file and inserts it into the cache.
+    *
+    * @param iTile the index of the tile
+    * @return the tile, a null pointer if reading failed
+    */
+    QSharedPointer<const Tile> loadTile(qint32 iTile);
+
+    //=========================================================================================================
+    /**
+    * Reads the given tiles, runs in the background-thread started by prefetch.
+    *
+    * @param listTiles the indices of the tiles to read
+    */
+    void prefetchTiles(const QList<qint32> &listTiles);
+
+    QSharedPointer<FiffRawData>                 m_pRaw;             /**< The raw data the tiles are read from. */
+
+    qint32                                      m_iTileSize;        /**< Length of a tile [in samples]. */
+    qint32                                      m_iMaxTiles;        /**< Number of tiles which are at maximum kept in the cache. */
+    qint32                                      m_iPrefetchTiles;   /**< Number of tiles which are read ahead of a segment. */
+    qint32                                      m_iNumTiles;        /**< Number of tiles of the whole file. */
+
+    QMutex                                      m_cacheMutex;       /**< Guards m_hashTiles and m_listRecentTiles. */
+    QMutex                                      m_readMutex;        /**< Serializes the file access. */
+    QHash<qint32, QSharedPointer<const Tile> >  m_hashTiles;        /**< The cached tiles, keyed by their index. */
+    QList<qint32>                               m_listRecentTiles;  /**< The indices of the cached tiles, most recently used first. */
+
+    QFuture<void>                               m_prefetchFuture;   /**< The future of the running prefetch. */
+    QAtomicInt                                  m_bAbortPrefetch;   /**< Set when a running prefetch is to be stopped. */
+};
+
+} // NAMESPACE MNEBROWSE
+
+#endif // RAWTILECACHE_H
@@ -75,10 +75,23 @@ namespace MNEBROWSE
 {
 
 typedef Matrix<double,Dynamic,Dynamic,RowMajor> MatrixXdR;
+typedef Matrix<float,Dynamic,Dynamic,RowMajor> MatrixXfR;
 typedef QPair<const double*,qint32> RowVectorPair;
 typedef QPair<const float*,qint32> RowVectorPairF;
 typedef QPair<int,int> QPairInts;
 
+//=============================================================================================================
+/**
+* The min/max envelope of one channel row at one decimation level. Entry k holds the minimum and maximum of the
+* samples [k*iDecimation, (k+1)*iDecimation).
+*/
+struct RowEnvelope {
+    const float*    pMin;           /**< The minimum of each block of samples. */
+    const float*    pMax;           /**< The maximum of each block of samples. */
+    qint32          iLength;        /**< The number of entries. */
+    qint32          iDecimation;    /**< The number of samples per entry. */
+};
+
 namespace RawModelRoles
 {
     enum ItemRole{GetChannelMean = Qt::UserRole + 1000};
@@ -347,6 +347,7 @@ void MainWindow::connectMenus()
     connect(ui->m_openAction, &QAction::triggered, this, &MainWindow::openFile);
     connect(ui->m_writeAction, &QAction::triggered, this, &MainWindow::writeFile);
     connect(ui->m_loadEvents, &QAction::triggered, this, &MainWindow::loadEvents);
+    connect(ui->m_detectEvents, &QAction::triggered, this, &MainWindow::detectEvents);
     connect(ui->m_saveEvents, &QAction::triggered, this, &MainWindow::saveEvents);
     connect(ui->m_loadEvokedAction, &QAction::triggered, this, &MainWindow::loadEvoked);
     connect(ui->m_quitAction, SIGNAL(triggered()), qApp, SLOT(quit()));
@@ -641,6 +642,62 @@ void MainWindow::loadEvents()
 }
 
 
+//*************************************************************************************************************
+
+void MainWindow::detectEvents()
+{
+    FiffInfo::SPtr pFiffInfo = m_pDataWindow->getDataModel()->m_pFiffInfo;
+    if(!m_pDataWindow->getDataModel()->m_bFileloaded || !pFiffInfo) {
+        qDebug("No fiff data file loaded to detect events in");
+        return;
+    }
+
+    QStringList lTriggerChannels;
+    if(pFiffInfo->ch_names.contains("STI 014"))
+        lTriggerChannels << "STI 014";
+    else if(pFiffInfo->ch_names.contains("STI101"))
+        lTriggerChannels << "STI101";
+    else {
+        qDebug("No stim channel found to detect events in");
+        return;
+    }
+
+    //Run the scan in a seperate thread, the chunks are scanned in parallel
+    FiffEventScanner scanner(lTriggerChannels);
+    QString fileName = m_qFileRaw.fileName();
+    MatrixXi events;
+
+    QFutureWatcher<bool> scanFutureWatcher;
+    QProgressDialog progressDialog("Detecting events...", QString(), 0, 0, this, Qt::Dialog);
+
+    connect(&scanFutureWatcher, &QFutureWatcher<bool>::finished,
+            &progressDialog, &QProgressDialog::reset);
+
+    scanFutureWatcher.setFuture(QtConcurrent::run([&]() {
+        return scanner.scanFile(fileName, events);
+    }));
+
+    progressDialog.exec();
+
+    scanFutureWatcher.waitForFinished();
+
+    if(!scanFutureWatcher.future().result()) {
+        qDebug("ERROR detecting events in %s", fileName.toUtf8().data());
+        return;
+    }
+
+    m_pEventWindow->getEventModel()->setEventData(events);
+    qDebug() << events.rows() << "events detected in" << fileName;
+
+    //Update status bar
+    setWindowStatus();
+
+    //Show event window
+    if(!m_pEventWindow->isVisible())
+        m_pEventWindow->show();
+}
+
+
 //*************************************************************************************************************
 
 void MainWindow::saveEvents()
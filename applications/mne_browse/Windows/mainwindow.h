@@ -113,6 +113,7 @@
 //=============================================================================================================
 
 #include <fiff/fiff.h>
+#include <fiff/fiff_event_scanner.h>
 #include <mne/mne.h>
 
 
@@ -196,6 +197,13 @@ private:
     */
     void loadEvents();
 
+    //=========================================================================================================
+    /**
+    * detectEvents finds the events in the stim channel of the loaded fiff data file. The scan runs in parallel
+    * over chunks of the file, its result is cached next to the file and reloaded from there the next time.
+    */
+    void detectEvents();
+
     //=========================================================================================================
     /**
     * saveEvents saves the event data to file.
@@ -96,6 +96,7 @@ SOURCES += \
     Windows/scalewindow.cpp \
     Windows/chinfowindow.cpp \
     Utils/datapackage.cpp \    
+    Utils/rawtilecache.cpp \
     Windows/noisereductionwindow.cpp
 
 HEADERS += \
@@ -124,6 +125,7 @@ HEADERS += \
     Windows/chinfowindow.h \
     Windows/noisereductionwindow.h \
     Utils/datapackage.h \
+    Utils/rawtilecache.h \
 
 FORMS += \
     Windows/eventwindowdock.ui \
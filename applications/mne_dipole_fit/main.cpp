@@ -92,6 +92,23 @@ int main(int argc, char *argv[])
 
     DipoleFitSettings settings(&argc,argv);
     DipoleFit dipFit(&settings);
+
+    /*
+    * Batch mode: one setup for all data files, no viewer
+    */
+    if (!settings.batchnames.isEmpty()) {
+        QList<ECDSet> sets = dipFit.calculateBatchFit();
+        for (int k = 0; k < sets.size(); k++) {
+            if (sets[k].size() == 0)
+                continue;
+            if (!sets[k].save_dipoles_dip(settings.batchdipnames[k]))
+                printf("Dipoles could not be safed to %s.",settings.batchdipnames[k].toUtf8().data());
+            if (!settings.batchbdipnames[k].isEmpty() && !sets[k].save_dipoles_bdip(settings.batchbdipnames[k]))
+                printf("Dipoles could not be safed to %s.",settings.batchbdipnames[k].toUtf8().data());
+        }
+        return 0;
+    }
+
     ECDSet set = dipFit.calculateFit();
 
     ECDView::SPtr pEcdViewer;
@@ -56,6 +56,7 @@
 #include <QApplication>
 #include <QModelIndex>
 #include <QMessageBox>
+#include <QtConcurrent>
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -64,6 +65,46 @@
 
 using namespace UTILSLIB;
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+// parameters of one dictionary atom, the samples are calculated concurrently and written in order afterwards
+struct AtomParameters
+{
+    qint32 id;
+    qint32 sample_count;
+    EditorWindow::AtomType type;
+    qreal scale;
+    qreal modu;
+    qreal phase;
+    qreal chirp;
+};
+
+static QString calc_atom_samples(const AtomParameters &params)
+{
+    QStringList resultList;
+    if(params.type == EditorWindow::Chirp)
+    {
+        ChirpAtom cAtom;
+        resultList = cAtom.create_string_values(params.sample_count, params.scale, params.sample_count / 2, params.modu, params.phase, params.chirp);
+    }
+    else
+    {
+        GaborAtom gAtom;
+        resultList = gAtom.create_string_values(params.sample_count, params.scale, params.sample_count / 2, params.modu, params.phase);
+    }
+
+    QString samples_to_xml;
+    for (qint32 it = 0; it < resultList.length(); it++)
+    {
+        samples_to_xml.append(resultList.at(it));
+        samples_to_xml.append(":");
+    }
+    return samples_to_xml;
+}
+
 //*************************************************************************************************************
 //=============================================================================================================
 // FORWARD DECLARATIONS
@@ -1326,11 +1367,6 @@ void EditorWindow::on_rb_ChirpAtomType_toggled(bool checked)
 // calc all atoms with choosen parameters and save to list and to drive
 void EditorWindow::on_btt_CalcAtoms_clicked()
 {
-    QStringList resultList;
-    resultList.clear();
-
-
-
     if(partDictName.isEmpty())
     {
         QMessageBox::warning(this, tr("Error"),
@@ -1373,8 +1409,10 @@ void EditorWindow::on_btt_CalcAtoms_clicked()
         xmlWriter.writeAttribute("atom_count", QString::number(atomCount));
         xmlWriter.writeAttribute("source_dict", partDictName);
 
-        ChirpAtom *cAtom = new ChirpAtom();
-        GaborAtom *gAtom = new GaborAtom();
+        QList<AtomParameters> atomParamsList;
+        AtomParameters atomParams;
+        atomParams.sample_count = ui->spb_AtomLength->value();
+        atomParams.type = atomType;
 
         if(ui->chb_CombAllPara->isChecked())
         {
@@ -1404,38 +1442,12 @@ void EditorWindow::on_btt_CalcAtoms_clicked()
                             qreal tempChirp = ui->dspb_StartValueChirp->value();
                             if(chirpList.length() > 0 && chirpCount < chirpList.length()) tempChirp = chirpList.at(chirpCount);
 
-                            if(atomType == EditorWindow::Chirp)
-                             {
-                                resultList = cAtom->create_string_values(ui->spb_AtomLength->value(), tempScale, ui->spb_AtomLength->value() / 2, tempModu, tempPhase, tempChirp);
-                                xmlWriter.writeStartElement("ATOM");
-                                xmlWriter.writeAttribute("ID", QString::number(atomIndex));
-                                xmlWriter.writeAttribute("scale", QString::number(tempScale));
-                                xmlWriter.writeAttribute("modu", QString::number(tempModu));
-                                xmlWriter.writeAttribute("phase", QString::number(tempPhase));
-                                xmlWriter.writeAttribute("chirp", QString::number(tempChirp));
-
-                            }
-                            else if(atomType == EditorWindow::Gauss)
-                            {
-                                resultList = gAtom->create_string_values(ui->spb_AtomLength->value(), tempScale, ui->spb_AtomLength->value() / 2, tempModu, tempPhase);
-                                xmlWriter.writeStartElement("ATOM");                                
-                                xmlWriter.writeAttribute("ID", QString::number(atomIndex));                                
-                                xmlWriter.writeAttribute("scale", QString::number(tempScale));
-                                xmlWriter.writeAttribute("modu", QString::number(tempModu));
-                                xmlWriter.writeAttribute("phase", QString::number(tempPhase));
-                            }
-
-                            xmlWriter.writeStartElement("samples");
-                            QString samples_to_xml;
-                            for (qint32 it = 0; it < resultList.length(); it++)
-                            {
-                                samples_to_xml.append(resultList.at(it));
-                                samples_to_xml.append(":");
-                            }
-                            xmlWriter.writeAttribute("samples", samples_to_xml);
-                            xmlWriter.writeEndElement();
-
-                            xmlWriter.writeEndElement();
+                            atomParams.id = atomIndex;
+                            atomParams.scale = tempScale;
+                            atomParams.modu = tempModu;
+                            atomParams.phase = tempPhase;
+                            atomParams.chirp = tempChirp;
+                            atomParamsList.append(atomParams);
 
                             atomIndex++;
                             scaleCount++;
@@ -1478,42 +1490,35 @@ void EditorWindow::on_btt_CalcAtoms_clicked()
                 qreal tempChirp = ui->dspb_StartValueChirp->value();
                 if(chirpList.length() > 0 && i < chirpList.length()) tempChirp = chirpList.at(i);
 
-                if(atomType == EditorWindow::Chirp)
-                {
-                    resultList = cAtom->create_string_values(ui->spb_AtomLength->value(), tempScale, ui->spb_AtomLength->value() / 2, tempModu, tempPhase, tempChirp);
-                    xmlWriter.writeStartElement("ATOM");
-                    xmlWriter.writeAttribute("ID", QString::number(i));
-                    xmlWriter.writeAttribute("scale", QString::number(tempScale));
-                    xmlWriter.writeAttribute("modu", QString::number(tempModu));
-                    xmlWriter.writeAttribute("phase", QString::number(tempPhase));
-                    xmlWriter.writeAttribute("chirp", QString::number(tempChirp));
-                }
-                else if(atomType == EditorWindow::Gauss)
-                {                    
-                    resultList = gAtom->create_string_values(ui->spb_AtomLength->value(), tempScale, ui->spb_AtomLength->value() / 2, tempModu, tempPhase);
-                    xmlWriter.writeStartElement("ATOM");
-                    xmlWriter.writeAttribute("ID", QString::number(i));
-                    xmlWriter.writeAttribute("scale", QString::number(tempScale));
-                    xmlWriter.writeAttribute("modu", QString::number(tempModu));
-                    xmlWriter.writeAttribute("phase", QString::number(tempPhase));
-                }               
-
-                xmlWriter.writeStartElement("samples");
-                QString samples_to_xml;
-                for (qint32 it = 0; it < resultList.length(); it++)
-                {
-                    samples_to_xml.append(resultList.at(it));
-                    samples_to_xml.append(":");
-                }
-                xmlWriter.writeAttribute("samples", samples_to_xml);
-                xmlWriter.writeEndElement();    //samples
-                xmlWriter.writeEndElement();    //ATOM
+                atomParams.id = i;
+                atomParams.scale = tempScale;
+                atomParams.modu = tempModu;
+                atomParams.phase = tempPhase;
+                atomParams.chirp = tempChirp;
+                atomParamsList.append(atomParams);
 
                 i++;
             }
         }
-        delete cAtom;
-        delete gAtom;
+
+        //the samples of all atoms are independent of each other
+        QList<QString> samplesList = QtConcurrent::blockingMapped(atomParamsList, calc_atom_samples);
+
+        for(qint32 i = 0; i < atomParamsList.length(); i++)
+        {
+            xmlWriter.writeStartElement("ATOM");
+            xmlWriter.writeAttribute("ID", QString::number(atomParamsList.at(i).id));
+            xmlWriter.writeAttribute("scale", QString::number(atomParamsList.at(i).scale));
+            xmlWriter.writeAttribute("modu", QString::number(atomParamsList.at(i).modu));
+            xmlWriter.writeAttribute("phase", QString::number(atomParamsList.at(i).phase));
+            if(atomType == EditorWindow::Chirp)
+                xmlWriter.writeAttribute("chirp", QString::number(atomParamsList.at(i).chirp));
+
+            xmlWriter.writeStartElement("samples");
+            xmlWriter.writeAttribute("samples", samplesList.at(i));
+            xmlWriter.writeEndElement();    //samples
+            xmlWriter.writeEndElement();    //ATOM
+        }
 
         xmlWriter.writeEndElement();    //build_Atoms
         xmlWriter.writeEndElement();    //COUNT
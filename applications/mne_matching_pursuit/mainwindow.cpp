@@ -47,6 +47,7 @@
 #include "math.h"
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "mpjobqueue.h"
 
 
 //*************************************************************************************************************
@@ -109,6 +110,7 @@ FiffEvoked _pick_evoked;
 
 QTimer *_counter_timer;
 QThread* mp_Thread;
+MpJobQueue *mp_Job_Queue = NULL;
 AdaptiveMp *adaptive_Mp;
 FixDictMp *fixDict_Mp ;
 Formulaeditor *_formula_editor;
@@ -1431,7 +1433,10 @@ void MainWindow::on_btt_Calc_clicked()
     //cancel calculation thread
     else if(ui->btt_Calc->text() == "cancel")
     {
-        emit mp_Thread->requestInterruption();
+        if(mp_Job_Queue != NULL)
+            mp_Job_Queue->cancel();
+        else
+            emit mp_Thread->requestInterruption();
         ui->btt_Calc->setText("wait...");
     }
 }
@@ -1822,6 +1827,7 @@ void MainWindow::tbv_selection_changed(const QModelIndex& topLeft, const QModelI
 void MainWindow::calc_thread_finished()
 {
     is_calulating = false;
+    mp_Job_Queue = NULL;
     tbv_is_loading = true;
 
     if(_fix_dict_atom_list.isEmpty() && !_adaptive_atom_list.isEmpty())
@@ -1932,9 +1938,38 @@ void MainWindow::calc_thread_finished()
 
 void MainWindow::calc_adaptiv_mp(MatrixXd signal, truncation_criterion criterion)
 {
-    adaptive_Mp = new AdaptiveMp();
     qreal res_energy = ui->dsb_energy->value();
 
+    QSettings settings;
+    bool fixphase = settings.value("fixPhase", false).toBool();
+    bool trial_separation = settings.value("trial_separation", false).toBool();
+    qint32 boost = settings.value("boost", 100).toInt();
+    qint32 iterations = settings.value("adaptive_iterations", 1E3).toInt();
+    qreal reflection = settings.value("adaptive_reflection", 1.00).toDouble();
+    qreal expansion = settings.value("adaptive_expansion", 0.20).toDouble();
+    qreal contraction = settings.value("adaptive_contraction", 0.5).toDouble();
+    qreal fullcontraction = settings.value("adaptive_fullcontraction", 0.50).toDouble();
+
+    //the channels of a trial separated decomposition are independent, each one is decomposed by its own job
+    if(trial_separation && signal.cols() > 1)
+    {
+        mp_Job_Queue = new MpJobQueue;
+
+        connect(mp_Job_Queue, SIGNAL(current_result(qint32, qint32, qreal, qreal, MatrixXd, adaptive_atom_list, fix_dict_atom_list)),
+                        this, SLOT(recieve_result(qint32, qint32, qreal, qreal, MatrixXd, adaptive_atom_list, fix_dict_atom_list)));
+        connect(mp_Job_Queue, SIGNAL(send_warning(qint32)), this, SLOT(recieve_warnings(qint32)));
+        connect(mp_Job_Queue, SIGNAL(finished_calc()), this, SLOT(calc_thread_finished()));
+        connect(mp_Job_Queue, SIGNAL(finished_calc()), mp_Job_Queue, SLOT(deleteLater()));
+
+        qint32 max_iterations = (criterion == SignalEnergy) ? MAXINT32 : ui->sb_Iterations->value();
+        qreal epsilon = (criterion == Iterations) ? qreal(MININT32) : res_energy;
+
+        mp_Job_Queue->start(signal, max_iterations, epsilon, fixphase, boost, iterations, reflection, expansion, contraction, fullcontraction);
+        return;
+    }
+
+    adaptive_Mp = new AdaptiveMp();
+
     //threading
     mp_Thread = new QThread;
     adaptive_Mp->moveToThread(mp_Thread);
@@ -1950,15 +1985,6 @@ void MainWindow::calc_adaptiv_mp(MatrixXd signal, truncation_criterion criterion
 
     connect(adaptive_Mp, SIGNAL(send_warning(qint32)), this, SLOT(recieve_warnings(qint32)));
 
-    QSettings settings;
-    bool fixphase = settings.value("fixPhase", false).toBool();
-    bool trial_separation = settings.value("trial_separation", false).toBool();
-    qint32 boost = settings.value("boost", 100).toInt();
-    qint32 iterations = settings.value("adaptive_iterations", 1E3).toInt();
-    qreal reflection = settings.value("adaptive_reflection", 1.00).toDouble();
-    qreal expansion = settings.value("adaptive_expansion", 0.20).toDouble();
-    qreal contraction = settings.value("adaptive_contraction", 0.5).toDouble();
-    qreal fullcontraction = settings.value("adaptive_fullcontraction", 0.50).toDouble();
     switch(criterion)
     {
         case Iterations:        
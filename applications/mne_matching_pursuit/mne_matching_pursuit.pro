@@ -83,7 +83,8 @@ SOURCES += \
     mainwindow.cpp \
     processdurationmessagebox.cpp \
     treebaseddictwindow.cpp \
-    settingwindow.cpp
+    settingwindow.cpp \
+    mpjobqueue.cpp
 
 HEADERS += \
     editorwindow.h \
@@ -93,7 +94,8 @@ HEADERS += \
     mainwindow.h \
     processdurationmessagebox.h \
     treebaseddictwindow.h \
-    settingwindow.h
+    settingwindow.h \
+    mpjobqueue.h
 
 FORMS += \
     editorwindow.ui \
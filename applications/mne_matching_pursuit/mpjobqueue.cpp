@@ -0,0 +1,338 @@
+//=============================================================================================================
+/**
+* @file     mpjobqueue.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Implementation of the MpJobQueue class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mpjobqueue.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS MpJob
+//=============================================================================================================
+
+MpJob::MpJob(qint32 channel, QObject *parent)
+: QObject(parent)
+, m_iChannel(channel)
+, m_pThread(NULL)
+{
+}
+
+
+//*************************************************************************************************************
+
+void MpJob::start(const MatrixXd &signal, qint32 max_iterations, qreal epsilon, bool fix_phase, qint32 boost, qint32 simplex_it,
+                  qreal simplex_reflection, qreal simplex_expansion, qreal simplex_contraction, qreal simplex_full_contraction)
+{
+    AdaptiveMp *adaptive_Mp = new AdaptiveMp();
+
+    //threading
+    m_pThread = new QThread;
+    adaptive_Mp->moveToThread(m_pThread);
+
+    connect(this, SIGNAL(send_input(MatrixXd, qint32, qreal, bool, qint32, qint32, qreal, qreal, qreal, qreal, bool)),
+            adaptive_Mp, SLOT(recieve_input(MatrixXd, qint32, qreal, bool, qint32, qint32, qreal, qreal, qreal, qreal, bool)));
+    connect(adaptive_Mp, SIGNAL(current_result(qint32, qint32, qreal, qreal, MatrixXd, adaptive_atom_list, fix_dict_atom_list)),
+                   this, SLOT(recieve_result(qint32, qint32, qreal, qreal, MatrixXd, adaptive_atom_list, fix_dict_atom_list)));
+    connect(adaptive_Mp, SIGNAL(send_warning(qint32)), this, SIGNAL(job_warning(qint32)));
+    connect(adaptive_Mp, SIGNAL(finished_calc()), m_pThread, SLOT(quit()));
+    connect(adaptive_Mp, SIGNAL(finished_calc()), adaptive_Mp, SLOT(deleteLater()));
+    connect(m_pThread, SIGNAL(finished()), this, SLOT(thread_finished()));
+    connect(m_pThread, SIGNAL(finished()), m_pThread, SLOT(deleteLater()));
+
+    //a single channel is trial separated as well, so the atoms carry max_scalar_product and phase
+    emit send_input(signal, max_iterations, epsilon, fix_phase, boost, simplex_it,
+                    simplex_reflection, simplex_expansion, simplex_contraction, simplex_full_contraction, true);
+
+    disconnect(this, SIGNAL(send_input(MatrixXd, qint32, qreal, bool, qint32, qint32, qreal, qreal, qreal, qreal, bool)),
+               adaptive_Mp, SLOT(recieve_input(MatrixXd, qint32, qreal, bool, qint32, qint32, qreal, qreal, qreal, qreal, bool)));
+
+    m_pThread->start();
+}
+
+
+//*************************************************************************************************************
+
+void MpJob::cancel()
+{
+    if(m_pThread)
+        m_pThread->requestInterruption();
+}
+
+
+//*************************************************************************************************************
+
+void MpJob::recieve_result(qint32 current_iteration, qint32 max_iterations, qreal current_energy, qreal max_energy, MatrixXd residuum,
+                           adaptive_atom_list adaptive_atom_res_list, fix_dict_atom_list fix_dict_atom_res_list)
+{
+    Q_UNUSED(current_iteration);
+    Q_UNUSED(max_iterations);
+    Q_UNUSED(max_energy);
+    Q_UNUSED(fix_dict_atom_res_list);
+
+    if(adaptive_atom_res_list.isEmpty() || adaptive_atom_res_list.last().isEmpty())
+        return;
+
+    emit job_result(m_iChannel, current_energy, residuum, adaptive_atom_res_list.last().last());
+}
+
+
+//*************************************************************************************************************
+
+void MpJob::thread_finished()
+{
+    m_pThread = NULL;
+    emit job_finished(m_iChannel);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS MpJobQueue
+//=============================================================================================================
+
+MpJobQueue::MpJobQueue(QObject *parent)
+: QObject(parent)
+, m_iMaxIterations(0)
+, m_dEpsilon(0)
+, m_bFixPhase(false)
+, m_iBoost(0)
+, m_iSimplexIt(0)
+, m_dSimplexReflection(0)
+, m_dSimplexExpansion(0)
+, m_dSimplexContraction(0)
+, m_dSimplexFullContraction(0)
+, m_iNextChannel(0)
+, m_iMaxJobs(qMax(1, QThread::idealThreadCount()))
+, m_iIteration(0)
+, m_dSignalEnergy(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void MpJobQueue::start(const MatrixXd &signal, qint32 max_iterations, qreal epsilon, bool fix_phase, qint32 boost, qint32 simplex_it,
+                       qreal simplex_reflection, qreal simplex_expansion, qreal simplex_contraction, qreal simplex_full_contraction)
+{
+    m_matSignal = signal;
+    m_matResiduum = signal;
+    m_iMaxIterations = max_iterations;
+    m_dEpsilon = epsilon;
+    m_bFixPhase = fix_phase;
+    m_iBoost = boost;
+    m_iSimplexIt = simplex_it;
+    m_dSimplexReflection = simplex_reflection;
+    m_dSimplexExpansion = simplex_expansion;
+    m_dSimplexContraction = simplex_contraction;
+    m_dSimplexFullContraction = simplex_full_contraction;
+
+    m_iNextChannel = 0;
+    m_iIteration = 0;
+    m_dSignalEnergy = signal.squaredNorm();
+
+    m_qListFinished.clear();
+    m_qListPendingAtoms.clear();
+    m_qListPendingEnergies.clear();
+    m_qListPendingResidua.clear();
+    m_qListLastAtoms.clear();
+    m_qListEnergies.clear();
+    m_qListAtoms.clear();
+    m_qListWarnings.clear();
+
+    for(qint32 chn = 0; chn < signal.cols(); chn++)
+    {
+        //atom without energy for channels which finished before the others
+        GaborAtom empty_atom;
+        empty_atom.sample_count = signal.rows();
+        empty_atom.scale = signal.rows();
+        empty_atom.translation = 0;
+        empty_atom.modulation = 0;
+        empty_atom.phase = 0;
+        empty_atom.max_scalar_product = 0;
+        empty_atom.energy = 0;
+
+        m_qListFinished.append(false);
+        m_qListPendingAtoms.append(QList<GaborAtom>());
+        m_qListPendingEnergies.append(QList<qreal>());
+        m_qListPendingResidua.append(QList<VectorXd>());
+        m_qListLastAtoms.append(empty_atom);
+        m_qListEnergies.append(0);
+    }
+
+    if(signal.cols() == 0)
+    {
+        emit finished_calc();
+        return;
+    }
+
+    start_jobs();
+}
+
+
+//*************************************************************************************************************
+
+void MpJobQueue::cancel()
+{
+    m_iNextChannel = m_matSignal.cols();
+
+    QMap<qint32, MpJob*>::iterator it;
+    for(it = m_qMapRunningJobs.begin(); it != m_qMapRunningJobs.end(); ++it)
+        it.value()->cancel();
+}
+
+
+//*************************************************************************************************************
+
+void MpJobQueue::start_jobs()
+{
+    while(m_qMapRunningJobs.size() < m_iMaxJobs && m_iNextChannel < m_matSignal.cols())
+    {
+        qint32 chn = m_iNextChannel++;
+
+        MpJob *job = new MpJob(chn, this);
+        connect(job, SIGNAL(job_result(qint32, qreal, MatrixXd, GaborAtom)), this, SLOT(recieve_job_result(qint32, qreal, MatrixXd, GaborAtom)));
+        connect(job, SIGNAL(job_warning(qint32)), this, SLOT(recieve_job_warning(qint32)));
+        connect(job, SIGNAL(job_finished(qint32)), this, SLOT(job_finished(qint32)));
+
+        m_qMapRunningJobs.insert(chn, job);
+
+        job->start(m_matSignal.col(chn), m_iMaxIterations, m_dEpsilon, m_bFixPhase, m_iBoost, m_iSimplexIt,
+                   m_dSimplexReflection, m_dSimplexExpansion, m_dSimplexContraction, m_dSimplexFullContraction);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MpJobQueue::recieve_job_result(qint32 channel, qreal current_energy, MatrixXd residuum, GaborAtom atom)
+{
+    m_qListPendingAtoms[channel].append(atom);
+    m_qListPendingEnergies[channel].append(current_energy);
+    m_qListPendingResidua[channel].append(residuum.col(0));
+
+    emit_iterations();
+}
+
+
+//*************************************************************************************************************
+
+void MpJobQueue::recieve_job_warning(qint32 warning)
+{
+    //every job reports e.g. its interruption, the user is told once
+    if(m_qListWarnings.contains(warning))
+        return;
+
+    m_qListWarnings.append(warning);
+    emit send_warning(warning);
+}
+
+
+//*************************************************************************************************************
+
+void MpJobQueue::job_finished(qint32 channel)
+{
+    MpJob *job = m_qMapRunningJobs.take(channel);
+    if(job)
+        job->deleteLater();
+
+    m_qListFinished[channel] = true;
+
+    start_jobs();
+    emit_iterations();
+
+    if(m_qMapRunningJobs.isEmpty() && m_iNextChannel >= m_matSignal.cols())
+    {
+        //channels which were never started because of a cancel are finished as well
+        for(qint32 chn = 0; chn < m_qListFinished.size(); chn++)
+            m_qListFinished[chn] = true;
+        emit_iterations();
+
+        emit finished_calc();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MpJobQueue::emit_iterations()
+{
+    forever
+    {
+        bool complete = true;
+        bool has_atom = false;
+        for(qint32 chn = 0; chn < m_qListPendingAtoms.size(); chn++)
+        {
+            if(!m_qListPendingAtoms.at(chn).isEmpty())
+                has_atom = true;
+            else if(!m_qListFinished.at(chn))
+                complete = false;
+        }
+
+        if(!complete || !has_atom)
+            return;
+
+        QList<GaborAtom> atoms_in_chns;
+        for(qint32 chn = 0; chn < m_qListPendingAtoms.size(); chn++)
+        {
+            if(!m_qListPendingAtoms.at(chn).isEmpty())
+            {
+                m_qListLastAtoms[chn] = m_qListPendingAtoms[chn].takeFirst();
+                m_qListEnergies[chn] = m_qListPendingEnergies[chn].takeFirst();
+                m_matResiduum.col(chn) = m_qListPendingResidua[chn].takeFirst();
+                atoms_in_chns.append(m_qListLastAtoms.at(chn));
+            }
+            else
+            {
+                GaborAtom empty_atom = m_qListLastAtoms.at(chn);
+                empty_atom.max_scalar_product = 0;
+                empty_atom.energy = 0;
+                atoms_in_chns.append(empty_atom);
+            }
+        }
+
+        qreal current_energy = 0;
+        for(qint32 chn = 0; chn < m_qListEnergies.size(); chn++)
+            current_energy += m_qListEnergies.at(chn);
+
+        m_qListAtoms.append(atoms_in_chns);
+        m_iIteration++;
+
+        emit current_result(m_iIteration, m_iMaxIterations, current_energy, m_dSignalEnergy, m_matResiduum, m_qListAtoms, fix_dict_atom_list());
+    }
+}
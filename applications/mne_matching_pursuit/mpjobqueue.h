@@ -0,0 +1,215 @@
+//=============================================================================================================
+/**
+* @file     mpjobqueue.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MpJobQueue class declaration, runs the single channel decompositions of the trial separated adaptive matching pursuit concurrently.
+*
+*/
+
+#ifndef MPJOBQUEUE_H
+#define MPJOBQUEUE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/mp/atom.h>
+#include <utils/mp/adaptivemp.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QObject>
+#include <QThread>
+#include <QList>
+#include <QMap>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//=============================================================================================================
+/**
+* Decomposes one channel with its own AdaptiveMp in its own thread and reports the results with the channel index.
+*
+* @brief Single channel decomposition job of the MpJobQueue
+*/
+class MpJob : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef QList<QList<GaborAtom> > adaptive_atom_list;
+    typedef QList<FixDictAtom> fix_dict_atom_list;
+
+    //=========================================================================================================
+    /**
+    * Constructs the job of one channel
+    *
+    * @param[in] channel    index of the channel in the signal matrix of the queue
+    * @param[in] parent     parent of the job
+    */
+    explicit MpJob(qint32 channel, QObject *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Starts the decomposition of the single channel signal in a new thread
+    *
+    * @param[in] signal     single channel signal
+    * @param[in] ...        the parameters of AdaptiveMp::recieve_input
+    */
+    void start(const MatrixXd &signal, qint32 max_iterations, qreal epsilon, bool fix_phase, qint32 boost, qint32 simplex_it,
+               qreal simplex_reflection, qreal simplex_expansion, qreal simplex_contraction, qreal simplex_full_contraction);
+
+    //=========================================================================================================
+    /**
+    * Asks the decomposition to stop after the current iteration
+    */
+    void cancel();
+
+signals:
+    void send_input(MatrixXd, qint32, qreal, bool, qint32, qint32, qreal, qreal, qreal, qreal, bool);
+    void job_result(qint32 channel, qreal current_energy, MatrixXd residuum, GaborAtom atom);
+    void job_warning(qint32 warning);
+    void job_finished(qint32 channel);
+
+private slots:
+    void recieve_result(qint32 current_iteration, qint32 max_iterations, qreal current_energy, qreal max_energy, MatrixXd residuum,
+                        adaptive_atom_list adaptive_atom_res_list, fix_dict_atom_list fix_dict_atom_res_list);
+    void thread_finished();
+
+private:
+    qint32      m_iChannel;     /**< Index of the decomposed channel */
+    QThread*    m_pThread;      /**< Thread running the AdaptiveMp of the channel */
+};
+
+
+//=============================================================================================================
+/**
+* Runs the trial separated adaptive decomposition with one AdaptiveMp per channel, at most as many at the same
+* time as there are cores. The per channel results are merged into the iterations of the multichannel
+* decomposition in the format of AdaptiveMp::current_result, a channel whose decomposition already finished
+* contributes an atom without energy.
+*
+* @brief Queue of concurrent, cancellable single channel decompositions
+*/
+class MpJobQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef QList<QList<GaborAtom> > adaptive_atom_list;
+    typedef QList<FixDictAtom> fix_dict_atom_list;
+
+    //=========================================================================================================
+    /**
+    * Constructs the queue
+    *
+    * @param[in] parent     parent of the queue
+    */
+    explicit MpJobQueue(QObject *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Queues one job per channel of the signal and starts the first ones.
+    *
+    * @param[in] signal     multichannel signal, one channel per column
+    * @param[in] ...        the parameters of AdaptiveMp::recieve_input, the energy criterion applies per channel
+    */
+    void start(const MatrixXd &signal, qint32 max_iterations, qreal epsilon, bool fix_phase, qint32 boost, qint32 simplex_it,
+               qreal simplex_reflection, qreal simplex_expansion, qreal simplex_contraction, qreal simplex_full_contraction);
+
+    //=========================================================================================================
+    /**
+    * Drops the jobs not yet started and interrupts the running ones. finished_calc is emitted once the running
+    * jobs stopped.
+    */
+    void cancel();
+
+signals:
+    void current_result(qint32, qint32, qreal, qreal, MatrixXd, adaptive_atom_list, fix_dict_atom_list);
+    void send_warning(qint32);
+    void finished_calc();
+
+private slots:
+    void recieve_job_result(qint32 channel, qreal current_energy, MatrixXd residuum, GaborAtom atom);
+    void recieve_job_warning(qint32 warning);
+    void job_finished(qint32 channel);
+
+private:
+    //=========================================================================================================
+    /**
+    * Starts queued jobs until all cores are busy
+    */
+    void start_jobs();
+
+    //=========================================================================================================
+    /**
+    * Emits all iterations for which every channel delivered its atom or is finished
+    */
+    void emit_iterations();
+
+    MatrixXd                    m_matSignal;            /**< Multichannel signal */
+    MatrixXd                    m_matResiduum;          /**< Residuum of the emitted iterations */
+    qint32                      m_iMaxIterations;       /**< Maximum number of iterations per channel */
+    qreal                       m_dEpsilon;             /**< Energy criterion per channel */
+    bool                        m_bFixPhase;            /**< Fixed phase */
+    qint32                      m_iBoost;               /**< Boost of the scale search */
+    qint32                      m_iSimplexIt;           /**< Simplex iterations */
+    qreal                       m_dSimplexReflection;   /**< Simplex reflection */
+    qreal                       m_dSimplexExpansion;    /**< Simplex expansion */
+    qreal                       m_dSimplexContraction;  /**< Simplex contraction */
+    qreal                       m_dSimplexFullContraction;  /**< Simplex full contraction */
+
+    qint32                      m_iNextChannel;         /**< Next channel to start a job for */
+    qint32                      m_iMaxJobs;             /**< Maximum number of concurrent jobs */
+    qint32                      m_iIteration;           /**< Number of emitted iterations */
+    qreal                       m_dSignalEnergy;        /**< Energy of the multichannel signal */
+    QMap<qint32, MpJob*>        m_qMapRunningJobs;      /**< Running jobs by channel */
+    QList<bool>                 m_qListFinished;        /**< Channels whose job finished */
+    QList<QList<GaborAtom> >    m_qListPendingAtoms;    /**< Atoms of each channel not emitted yet */
+    QList<QList<qreal> >        m_qListPendingEnergies; /**< Explained energy of each channel after the pending atoms */
+    QList<QList<VectorXd> >     m_qListPendingResidua;  /**< Residuum of each channel after the pending atoms */
+    QList<GaborAtom>            m_qListLastAtoms;       /**< Last emitted atom of each channel */
+    QList<qreal>                m_qListEnergies;        /**< Explained energy of each channel in the emitted iterations */
+    adaptive_atom_list          m_qListAtoms;           /**< Emitted iterations */
+    QList<qint32>               m_qListWarnings;        /**< Warnings already forwarded */
+};
+
+#endif // MPJOBQUEUE_H
@@ -73,12 +73,14 @@ DESTDIR = $${MNE_BINARY_DIR}/mne_rt_server_plugins
 
 SOURCES += \
         fiffsimulator.cpp \
-        fiffproducer.cpp
+        fiffproducer.cpp \
+        samplepacer.cpp
 
 HEADERS += \
         fiffsimulator.h\
         fiffsimulator_global.h \
         fiffproducer.h \
+        samplepacer.h \
         ../../mne_rt_server/IConnector.h #IConnector is a Q_OBJECT and the resulting moc file needs to be known -> that's why inclution is important!
 
 
@@ -41,6 +41,8 @@
 #include "fiffproducer.h"
 #include "fiffsimulator.h"
 
+#include <fiff/fiff_raw_prefetcher.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -105,98 +107,135 @@ void FiffProducer::run()
     m_pFiffSimulator->m_RawInfo.file = p_pStream;
 
     //
-    //   Set up the reading parameters
+    //   Set up the reading parameters, the file is read in quanta independent of the block size handed out
     //
     fiff_int_t from = m_pFiffSimulator->m_RawInfo.first_samp;
     fiff_int_t to = m_pFiffSimulator->m_RawInfo.last_samp;
-//    float quantum_sec = (float)uiSamplePeriod/1000000.0f; //read and write in 10 sec junks
-    fiff_int_t quantum = m_pFiffSimulator->m_uiBufferSampleSize;//ceil(quantum_sec*m_pFiffSimulator->m_pRawInfo->info.sfreq);
+    qint32 nchan = m_pFiffSimulator->m_RawInfo.info.nchan;
+    qint32 blockSize = m_pFiffSimulator->m_uiBufferSampleSize;
+    fiff_int_t quantum = m_pFiffSimulator->m_iReadQuantum > 0 ? m_pFiffSimulator->m_iReadQuantum : blockSize;
 
-    qDebug() << "quantum " << quantum;
+    qDebug() << "quantum " << quantum << "block size " << blockSize;
+
+    bool t_bPreload = m_pFiffSimulator->m_bPreload;
 
     //
-    //   To read the whole file at once set
-    //
-    //quantum     = to - from + 1;
+    //   Read ahead on a separate thread to keep disk latency out of the simulated stream
     //
+    FiffRawPrefetcher::SPtr t_pPrefetcher;
+    if(!t_bPreload && m_pFiffSimulator->m_iPrefetchDepth > 0)
+        t_pPrefetcher = FiffRawPrefetcher::SPtr(new FiffRawPrefetcher(m_pFiffSimulator->m_RawInfo, quantum, m_pFiffSimulator->m_iPrefetchDepth));
+
     //
-    //   Read and write all the data
+    //   Preloaded mode: read the whole file once, the simulation then loops from memory without touching the disk
     //
+    if(t_bPreload && (m_sPreloadedFile != m_pFiffSimulator->m_RawInfo.info.filename || m_matPreloaded.rows() != nchan)) {
+        m_matPreloaded.resize(0,0);
+        m_sPreloadedFile.clear();
+
+        if(!preload(from, to, quantum)) {
+            if(m_bIsRunning)
+                printf("error during preload of the simulation file\n");
+            return;
+        }
 
-    fiff_int_t first, last;
+        m_sPreloadedFile = m_pFiffSimulator->m_RawInfo.info.filename;
+        printf("Preloaded %d samples (%.1f MB)\n", (int)m_matPreloaded.cols(), (double)m_matPreloaded.size() * sizeof(float) / (1024.0 * 1024.0));
+    }
+
+    //
+    //   Cut the source segments into blocks of the buffer size, wrapping around at the end of the file
+    //
     MatrixXd data;
     MatrixXd times;
+    MatrixXf segment;
+    fiff_int_t first = from;
+    qint32 position = 0;
 
-    first = from;
-
-//    //Calibration - Is taken care of during read_raw_segment(...) later in the code
-//    qint32 nchan = m_pFiffSimulator->m_RawInfo.info.nchan;
-//    MatrixXd cals(1,nchan);
-//    SparseMatrix<double> inv_calsMat(nchan, nchan);
-//    for(qint32 i = 0; i < nchan; ++i)
-//        inv_calsMat.insert(i, i) = 1.0f/m_pFiffSimulator->m_RawInfo.info.chs[i].cal;
-
-    //Not good cause production time is not accurate
-    //loading and thread sleep is longer than thread sleep time - better to have a extra loading thread
-    // ToDo restructure this producer as laoding buffer --> and thread sleep to simulator buffer
-    fiff_int_t t_iDiff;
-    bool t_bRestart = false;
+    MatrixXf block(nchan, blockSize);
 
     while(m_bIsRunning)
     {
-        last = first+quantum-1;
-        if (last > to)
+        qint32 filled = 0;
+
+        while(filled < blockSize && m_bIsRunning)
         {
-            t_iDiff = last - to;
-            t_bRestart = true;
+            if(!t_bPreload && position == segment.cols()) {
+                fiff_int_t last = qMin(first + quantum - 1, to);
+
+                if (!(t_pPrefetcher ? t_pPrefetcher->read_raw_segment(data,times,first,last) : m_pFiffSimulator->m_RawInfo.read_raw_segment(data,times,first,last)) || data.cols() == 0)
+                {
+                    printf("error during read_raw_segment\n");
+                    m_bIsRunning = false;
+                    break;
+                }
+
+                segment = data.cast<float>();
+                position = 0;
+
+                first = last + 1;
+                if(first > to) {
+                    //
+                    // Case end of Simulation: restart file from the beginning
+                    //
+                    printf("### RESTART Simulation File ###\r\n");
+                    first = from;
+                }
+            }
 
-            last = to;
-        }
+            const MatrixXf& source = t_bPreload ? m_matPreloaded : segment;
 
-        if (!m_pFiffSimulator->m_RawInfo.read_raw_segment(data,times,first,last))
-        {
-            printf("error during read_raw_segment\n");
+            qint32 n = qMin(blockSize - filled, (qint32)source.cols() - position);
+            block.block(0, filled, nchan, n) = source.block(0, position, nchan, n);
+            filled += n;
+            position += n;
+
+            if(t_bPreload && position == source.cols()) {
+                printf("### RESTART Simulation File ###\r\n");
+                position = 0;
+            }
         }
 
-        MatrixXf tmp = data.cast<float>();//(inv_calsMat*data).cast<float>();
+        if(filled < blockSize)
+            break;
 
-        if(t_bRestart)
-        {
-            //
-            // Case end of Simulation: restart file from the beginning and read remaining bytes
-            //
-            printf("### RESTART Simulation File ###\r\n");
+        // call blocks until there is free space in the buffer
+        m_pFiffSimulator->m_pRawMatrixBuffer->push(&block);
+    }
 
-            first = from;
-            last = first+t_iDiff-1;
+    if(t_pPrefetcher)
+    {
+        t_pPrefetcher->stop();
+        FiffRawPrefetcherStats stats = t_pPrefetcher->stats();
+        printf("Read-ahead: %lld hits, %lld misses, %lld waits\n", stats.hits, stats.misses, stats.waits);
+    }
 
-            if (!m_pFiffSimulator->m_RawInfo.read_raw_segment(data,times,first,last))
-            {
-                printf("error during read_raw_segment\n");
-            }
+    // close datastream in this thread
+//    delete m_pFiffSimulator->m_RawInfo.file;
+//    m_pFiffSimulator->m_RawInfo.file = NULL;
+}
 
-            MatrixXf tmp2 = data.cast<float>();//(inv_calsMat*data).cast<float>();
 
-            MatrixXf tmp3(tmp.rows(), tmp.cols()+tmp2.cols());
+//*************************************************************************************************************
 
-            tmp3.block(0,0,tmp.rows(),tmp.cols()) = tmp;
-            tmp3.block(0,tmp.cols(),tmp.rows(),tmp2.cols()) = tmp2;
+bool FiffProducer::preload(fiff_int_t p_iFrom, fiff_int_t p_iTo, fiff_int_t p_iQuantum)
+{
+    MatrixXd data;
+    MatrixXd times;
 
-            tmp = tmp3;
+    //Read in quanta to avoid holding the whole file in double precision
+    m_matPreloaded.resize(m_pFiffSimulator->m_RawInfo.info.nchan, p_iTo - p_iFrom + 1);
 
-            t_bRestart = false;
-            first += t_iDiff;
-        }
-        else
-        {
-            first += quantum;
+    for(fiff_int_t first = p_iFrom; first <= p_iTo && m_bIsRunning; first += p_iQuantum) {
+        fiff_int_t last = qMin(first + p_iQuantum - 1, p_iTo);
+
+        if(!m_pFiffSimulator->m_RawInfo.read_raw_segment(data, times, first, last) || data.cols() != last - first + 1) {
+            m_matPreloaded.resize(0,0);
+            return false;
         }
 
-        // call blocks until there is free space in the buffer
-        m_pFiffSimulator->m_pRawMatrixBuffer->push(&tmp);
+        m_matPreloaded.block(0, first - p_iFrom, data.rows(), data.cols()) = data.cast<float>();
     }
 
-    // close datastream in this thread
-//    delete m_pFiffSimulator->m_RawInfo.file;
-//    m_pFiffSimulator->m_RawInfo.file = NULL;
+    return m_bIsRunning;
 }
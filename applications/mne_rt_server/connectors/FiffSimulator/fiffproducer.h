@@ -44,6 +44,16 @@
 
 //#include "circularbuffer.h"
 
+#include <fiff/fiff_types.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -51,6 +61,7 @@
 //=============================================================================================================
 
 #include <QThread>
+#include <QString>
 
 
 //*************************************************************************************************************
@@ -116,8 +127,23 @@ protected:
     virtual void run();
 
 private:
+    //=========================================================================================================
+    /**
+    * Reads the given sample range of the simulation file into the preload matrix.
+    *
+    * @param[in] p_iFrom        First sample to read.
+    * @param[in] p_iTo          Last sample to read.
+    * @param[in] p_iQuantum     Number of samples read at once.
+    *
+    * @return true if the whole range was read.
+    */
+    bool preload(FIFFLIB::fiff_int_t p_iFrom, FIFFLIB::fiff_int_t p_iTo, FIFFLIB::fiff_int_t p_iQuantum);
+
     FiffSimulator*  m_pFiffSimulator;   /**< Holds a pointer to corresponding FiffSimulator.*/
     bool            m_bIsRunning;       /**< Holds whether ECGProducer is running.*/
+
+    Eigen::MatrixXf m_matPreloaded;     /**< The whole simulation file, when running preloaded.*/
+    QString         m_sPreloadedFile;   /**< The file m_matPreloaded was read from.*/
 };
 
 } // NAMESPACE
@@ -99,6 +99,8 @@ const QString FiffSimulator::Commands::GETBUFSIZE   = "getbufsize";
 const QString FiffSimulator::Commands::ACCEL        = "accel";
 const QString FiffSimulator::Commands::GETACCEL     = "getaccel";
 const QString FiffSimulator::Commands::SIMFILE      = "simfile";
+const QString FiffSimulator::Commands::PRELOAD      = "preload";
+const QString FiffSimulator::Commands::GETPACING    = "getpacing";
 
 
 //*************************************************************************************************************
@@ -112,6 +114,9 @@ FiffSimulator::FiffSimulator()
 , m_uiBufferSampleSize(100)//(4)
 , m_AccelerationFactor(1.0)
 , m_TrueSamplingRate(0.0)
+, m_iPrefetchDepth(4)
+, m_iReadQuantum(0)
+, m_bPreload(false)
 , m_pRawMatrixBuffer(NULL)
 , m_bIsRunning(false)
 {
@@ -285,6 +290,68 @@ void FiffSimulator::comSimfile(Command p_command)
 }
 
 
+//*************************************************************************************************************
+
+void FiffSimulator::comPreload(Command p_command)
+{
+    QString t_sMode = p_command.pValues()[0].toString();
+
+    if(t_sMode == "on" || t_sMode == "off")
+    {
+        bool t_bWasRunning = m_bIsRunning;
+
+        if(m_bIsRunning)
+        {
+            m_pFiffProducer->stop();
+            this->stop();
+        }
+
+        m_bPreload = t_sMode == "on";
+
+        if(t_bWasRunning)
+            this->start();
+
+        QString str = QString("\tSet %1 preload mode %2\r\n\n").arg(getName()).arg(t_sMode);
+
+        m_commandManager[Commands::PRELOAD].reply(str);
+    }
+    else
+        m_commandManager[Commands::PRELOAD].reply("Preload mode not set, use on or off\r\n");
+}
+
+
+//*************************************************************************************************************
+
+void FiffSimulator::comGetPacing(Command p_command)
+{
+    SamplePacer::Statistics t_statistics = m_pacer.statistics();
+
+    bool t_bCommandIsJson = p_command.isJson();
+    if(t_bCommandIsJson)
+    {
+        //
+        //create JSON help object
+        //
+        QJsonObject t_qJsonObjectRoot;
+        t_qJsonObjectRoot.insert("blocks", QJsonValue((double)t_statistics.iBlocks));
+        t_qJsonObjectRoot.insert("late", QJsonValue((double)t_statistics.iLate));
+        t_qJsonObjectRoot.insert("resyncs", QJsonValue((double)t_statistics.iResyncs));
+        t_qJsonObjectRoot.insert("meanjitter", QJsonValue((double)t_statistics.iMeanJitterUs));
+        t_qJsonObjectRoot.insert("maxjitter", QJsonValue((double)t_statistics.iMaxJitterUs));
+        QJsonDocument p_qJsonDocument(t_qJsonObjectRoot);
+
+        m_commandManager[Commands::GETPACING].reply(p_qJsonDocument.toJson());
+    }
+    else
+    {
+        QString str = QString("\t%1 blocks, %2 late, %3 resyncs, jitter mean %4 us, max %5 us\r\n\n")
+                .arg(t_statistics.iBlocks).arg(t_statistics.iLate).arg(t_statistics.iResyncs)
+                .arg(t_statistics.iMeanJitterUs).arg(t_statistics.iMaxJitterUs);
+        m_commandManager[Commands::GETPACING].reply(str);
+    }
+}
+
+
 //*************************************************************************************************************
 
 void FiffSimulator::connectCommandManager()
@@ -295,6 +362,8 @@ void FiffSimulator::connectCommandManager()
     QObject::connect(&m_commandManager[Commands::ACCEL], &Command::executed, this, &FiffSimulator::comAccel);
     QObject::connect(&m_commandManager[Commands::GETACCEL], &Command::executed, this, &FiffSimulator::comGetAccel);
     QObject::connect(&m_commandManager[Commands::SIMFILE], &Command::executed, this, &FiffSimulator::comSimfile);
+    QObject::connect(&m_commandManager[Commands::PRELOAD], &Command::executed, this, &FiffSimulator::comPreload);
+    QObject::connect(&m_commandManager[Commands::GETPACING], &Command::executed, this, &FiffSimulator::comGetPacing);
 }
 
 
@@ -326,6 +395,9 @@ void FiffSimulator::init()
     {
         QTextStream in(&t_qFile);
         QString key = "simFile = ";
+        QString prefetchKey = "prefetchDepth = ";
+        QString quantumKey = "readQuantum = ";
+        QString preloadKey = "preload = ";
         while (!in.atEnd()) {
             QString line = in.readLine();
             if(line.contains(key, Qt::CaseInsensitive))
@@ -344,6 +416,34 @@ void FiffSimulator::init()
                     t_qFileMeas.close();
                 }
             }
+            else if(line.contains(prefetchKey, Qt::CaseInsensitive))
+            {
+                qint32 idx = line.indexOf(prefetchKey) + prefetchKey.size();
+                bool ok = false;
+                qint32 depth = line.mid(idx).trimmed().toInt(&ok);
+                if(ok && depth >= 0)
+                {
+                    m_iPrefetchDepth = depth;
+                    std::cout << "\tRead-ahead depth: " << depth << std::endl;
+                }
+            }
+            else if(line.contains(quantumKey, Qt::CaseInsensitive))
+            {
+                qint32 idx = line.indexOf(quantumKey) + quantumKey.size();
+                bool ok = false;
+                qint32 quantum = line.mid(idx).trimmed().toInt(&ok);
+                if(ok && quantum >= 0)
+                {
+                    m_iReadQuantum = quantum;
+                    std::cout << "\tRead quantum: " << quantum << std::endl;
+                }
+            }
+            else if(line.contains(preloadKey, Qt::CaseInsensitive))
+            {
+                qint32 idx = line.indexOf(preloadKey) + preloadKey.size();
+                m_bPreload = line.mid(idx).trimmed().compare("true", Qt::CaseInsensitive) == 0;
+                std::cout << "\tPreload: " << (m_bPreload ? "true" : "false") << std::endl;
+            }
         }
         t_qFile.close();
     }
@@ -378,6 +478,10 @@ bool FiffSimulator::stop()
 {
     this->m_pFiffProducer->stop();
     m_bIsRunning = false;
+
+    //Release a pop which waits for the empty circular buffer, otherwise the thread would never terminate
+    if(m_pRawMatrixBuffer)
+        m_pRawMatrixBuffer->releaseFromPop();
     QThread::wait();
 
     return true;
@@ -520,10 +624,8 @@ void FiffSimulator::run()
 {
     m_bIsRunning = true;
 
-    float t_fSamplingFrequency = m_RawInfo.info.sfreq;
-    float t_fBuffSampleSize = (float)m_uiBufferSampleSize;
-
-    quint32 uiSamplePeriod = (unsigned int) ((t_fBuffSampleSize/t_fSamplingFrequency)*1000000.0f);
+    //The sampling frequency already includes the acceleration factor
+    m_pacer.start(m_RawInfo.info.sfreq);
 
 //    quint32 count = 0;
 
@@ -533,7 +635,14 @@ void FiffSimulator::run()
 //        ++count;
 //        printf("%d raw buffer (%d x %d) generated\r\n", count, t_pRawBuffer->rows(), t_pRawBuffer->cols());
 
-        emit remitRawBuffer(t_pRawBuffer);
-        usleep(uiSamplePeriod);
+        //The zero matrix of a released pop is not handed over
+        if(!m_bIsRunning)
+            break;
+
+        //Release each buffer when its last sample would have been acquired
+        m_pacer.waitForBlock(t_pRawBuffer->cols());
+
+        if(!releaseRawBuffer(t_pRawBuffer))
+            qDebug() << "FiffSimulator::run - Raw buffer hand-off is full, buffer dropped.";
     }
 }
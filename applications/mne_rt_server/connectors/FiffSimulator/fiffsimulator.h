@@ -42,6 +42,7 @@
 //=============================================================================================================
 
 #include "fiffsimulator_global.h"
+#include "samplepacer.h"
 #include "../../mne_rt_server/IConnector.h"
 
 
@@ -111,6 +112,8 @@ public:
         static const QString ACCEL;
         static const QString GETACCEL;
         static const QString SIMFILE;
+        static const QString PRELOAD;
+        static const QString GETPACING;
     };
 
     //=========================================================================================================
@@ -183,6 +186,22 @@ private:
     */
     void comSimfile(Command p_command);
 
+    //=========================================================================================================
+    /**
+    * Switches between streaming the simulation file from disk and looping it preloaded in memory
+    *
+    * @param[in] p_command  The preload command.
+    */
+    void comPreload(Command p_command);
+
+    //=========================================================================================================
+    /**
+    * Returns the pacing statistics of the current simulation
+    *
+    * @param[in] p_command  The pacing statistics command.
+    */
+    void comGetPacing(Command p_command);
+
     //////////
 
     //=========================================================================================================
@@ -201,6 +220,10 @@ private:
     quint32         m_uiBufferSampleSize;   /**< Sample size of the buffer */
     float           m_AccelerationFactor;   /**< Acceleration factor to simulate different sampling rates. */
     float           m_TrueSamplingRate;     /**< The true sampling rate of the fif file. */
+    qint32          m_iPrefetchDepth;       /**< Number of buffers the producer reads ahead, 0 reads synchronously. */
+    qint32          m_iReadQuantum;         /**< Number of samples read from the file at once, 0 reads in buffer sample size. */
+    bool            m_bPreload;             /**< Whether the simulation file is looped from memory instead of from disk. */
+    SamplePacer     m_pacer;                /**< Releases the buffers at the nominal sampling rate. */
 
     RawMatrixBuffer* m_pRawMatrixBuffer;    /**< The Circular Raw Matrix Buffer. */
 
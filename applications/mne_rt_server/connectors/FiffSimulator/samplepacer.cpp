@@ -0,0 +1,160 @@
+//=============================================================================================================
+/**
+* @file     samplepacer.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     implementation of the SamplePacer Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "samplepacer.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+#include <QThread>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFSIMULATORPLUGIN;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+    const qint64 SPIN_NS    = 1000000;      /**< The last part of the wait which is yielded instead of slept.*/
+    const qint64 MAX_LAG_MS = 1000;         /**< Lag after which the schedule is re-anchored.*/
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+SamplePacer::SamplePacer()
+: m_dSFreq(1.0)
+, m_iAnchorNs(0)
+, m_iSamples(0)
+, m_iJitterSumUs(0)
+{
+    m_statistics.iBlocks = 0;
+    m_statistics.iLate = 0;
+    m_statistics.iResyncs = 0;
+    m_statistics.iMeanJitterUs = 0;
+    m_statistics.iMaxJitterUs = 0;
+}
+
+
+//*************************************************************************************************************
+
+void SamplePacer::start(double p_dSFreq)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    m_dSFreq = p_dSFreq > 0 ? p_dSFreq : 1.0;
+    m_timer.start();
+    m_iAnchorNs = 0;
+    m_iSamples = 0;
+    m_iJitterSumUs = 0;
+
+    m_statistics.iBlocks = 0;
+    m_statistics.iLate = 0;
+    m_statistics.iResyncs = 0;
+    m_statistics.iMeanJitterUs = 0;
+    m_statistics.iMaxJitterUs = 0;
+}
+
+
+//*************************************************************************************************************
+
+void SamplePacer::waitForBlock(qint32 p_iSamples)
+{
+    m_iSamples += p_iSamples;
+
+    //Derive the deadline from the total sample count, never from the previous wake-up
+    qint64 iDeadlineNs = m_iAnchorNs + (qint64)((double)m_iSamples / m_dSFreq * 1.0e9);
+    qint64 iNowNs = m_timer.nsecsElapsed();
+
+    bool bLate = iNowNs > iDeadlineNs;
+    bool bResync = iNowNs - iDeadlineNs > MAX_LAG_MS * 1000000;
+
+    if(bResync) {
+        m_iAnchorNs += iNowNs - iDeadlineNs;
+        iDeadlineNs = iNowNs;
+    }
+
+    while(iNowNs < iDeadlineNs) {
+        qint64 iRemainingNs = iDeadlineNs - iNowNs;
+        if(iRemainingNs > 2 * SPIN_NS)
+            QThread::usleep((unsigned long)((iRemainingNs - SPIN_NS) / 1000));
+        else
+            QThread::yieldCurrentThread();
+        iNowNs = m_timer.nsecsElapsed();
+    }
+
+    qint64 iJitterUs = (iNowNs - iDeadlineNs) / 1000;
+
+    QMutexLocker locker(&m_qMutex);
+    ++m_statistics.iBlocks;
+    if(bLate)
+        ++m_statistics.iLate;
+    if(bResync)
+        ++m_statistics.iResyncs;
+    m_iJitterSumUs += iJitterUs;
+    m_statistics.iMeanJitterUs = m_iJitterSumUs / m_statistics.iBlocks;
+    if(iJitterUs > m_statistics.iMaxJitterUs)
+        m_statistics.iMaxJitterUs = iJitterUs;
+}
+
+
+//*************************************************************************************************************
+
+SamplePacer::Statistics SamplePacer::statistics() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_statistics;
+}
@@ -0,0 +1,125 @@
+//=============================================================================================================
+/**
+* @file     samplepacer.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     declaration of the SamplePacer Class.
+*
+*/
+
+#ifndef SAMPLEPACER_H
+#define SAMPLEPACER_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QElapsedTimer>
+#include <QMutex>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FiffConnectorPlugin
+//=============================================================================================================
+
+namespace FIFFSIMULATORPLUGIN
+{
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS SamplePacer
+*
+* @brief The SamplePacer class releases sample blocks on an absolute schedule derived from the sampling rate.
+*
+* Each deadline is computed from the total number of samples released since start() on a monotonic clock, so
+* wake-up latencies do not accumulate into drift. The pacer sleeps coarsely and yields the last millisecond to
+* hit the deadline closely. When the caller falls behind by more than MAX_LAG_MS the schedule is re-anchored
+* instead of bursting the backlog out.
+*/
+class SamplePacer
+{
+public:
+    /** Pacing statistics since the last start(). */
+    struct Statistics
+    {
+        qint64 iBlocks;             /**< Number of released blocks.*/
+        qint64 iLate;               /**< Number of blocks which were handed in after their deadline.*/
+        qint64 iResyncs;            /**< Number of times the schedule was re-anchored.*/
+        qint64 iMeanJitterUs;       /**< Mean absolute deviation of the release from the deadline in microseconds.*/
+        qint64 iMaxJitterUs;        /**< Maximal deviation of the release from the deadline in microseconds.*/
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a SamplePacer.
+    */
+    SamplePacer();
+
+    //=========================================================================================================
+    /**
+    * Anchors the schedule at the current time and resets the statistics.
+    *
+    * @param[in] p_dSFreq   The sampling frequency the blocks are released with.
+    */
+    void start(double p_dSFreq);
+
+    //=========================================================================================================
+    /**
+    * Blocks until a block of the given number of samples is due, i.e. until its last sample would have been
+    * acquired at the nominal sampling rate.
+    *
+    * @param[in] p_iSamples Number of samples of the block to release.
+    */
+    void waitForBlock(qint32 p_iSamples);
+
+    //=========================================================================================================
+    /**
+    * Returns the pacing statistics.
+    *
+    * @return the statistics since the last start().
+    */
+    Statistics statistics() const;
+
+private:
+    mutable QMutex  m_qMutex;           /**< Guards the statistics.*/
+    QElapsedTimer   m_timer;            /**< Monotonic time base.*/
+    double          m_dSFreq;           /**< The sampling frequency.*/
+    qint64          m_iAnchorNs;        /**< Time of sample zero in nanoseconds of the time base.*/
+    qint64          m_iSamples;         /**< Number of samples released since the anchor.*/
+    qint64          m_iJitterSumUs;     /**< Accumulated absolute jitter in microseconds.*/
+    Statistics      m_statistics;       /**< The pacing statistics.*/
+};
+
+} // NAMESPACE
+
+#endif // SAMPLEPACER_H
@@ -233,7 +233,11 @@ bool Neuromag::start()
 bool Neuromag::stop()
 {
     m_bIsRunning = false;
-    QThread::wait();//ToDo: This thread will never be terminated when circular buffer is blocking the thread (happens when circularbuffer is empty)
+
+    //Release a pop which waits for the empty circular buffer, otherwise the thread would never terminate
+    if(m_pRawMatrixBuffer)
+        m_pRawMatrixBuffer->releaseFromPop();
+    QThread::wait();
     
     m_pDacqServer->m_bIsRunning = false;
     m_pDacqServer->wait();
@@ -261,7 +265,12 @@ void Neuromag::run()
 //            ++count;
 //            printf("%d raw buffer (%d x %d) generated\r\n", count, t_pRawBuffer->rows(), t_pRawBuffer->cols());
 
-            emit remitRawBuffer(t_pRawBuffer);
+            //The zero matrix of a released pop is not handed over
+            if(!m_bIsRunning)
+                break;
+
+            if(!releaseRawBuffer(t_pRawBuffer))
+                qDebug() << "Neuromag::run - Raw buffer hand-off is full, buffer dropped.";
         }
     }
 }
@@ -43,6 +43,7 @@
 
 #include <fiff/fiff_info.h>
 #include <realtime/rtCommand/commandmanager.h>
+#include <utils/generics/lockfreering.h>
 
 
 //*************************************************************************************************************
@@ -98,6 +99,7 @@ enum ConnectorID
 //=============================================================================================================
 
 #define RAW_BUFFFER_SIZE  10
+#define RAW_BUFFER_RING_SIZE  64
 
 
 //*************************************************************************************************************
@@ -110,6 +112,14 @@ using namespace REALTIMELIB;
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// TYPEDEFS
+//=============================================================================================================
+
+typedef IOBUFFER::LockFreeRing<QSharedPointer<Eigen::MatrixXf> > RawBufferRing;   /**< Hands the raw buffers from the connectors over to the FiffStreamServer. */
+
+
 //=========================================================================================================
 /**
 * The IConnector class is the interface class for all connectors.
@@ -214,12 +224,28 @@ public:
     */
     virtual void info(qint32 ID) = 0;
 
+    //=========================================================================================================
+    /**
+    * Sets the ring through which the raw buffers are handed over to the FiffStreamServer. Has to be set
+    * before the connector is started.
+    *
+    * @param [in] p_pRawBufferRing  the hand-off ring, NULL to discard the raw buffers.
+    */
+    inline void setRawBufferRing(RawBufferRing::SPtr p_pRawBufferRing);
+
 signals:
     void remitMeasInfo(qint32, FIFFLIB::FiffInfo);
 
-    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf>);
-
 protected:
+    //=========================================================================================================
+    /**
+    * Hands a raw buffer over to the FiffStreamServer without waiting. Called by the connector thread.
+    *
+    * @param [in] p_pMatRawBuffer   the raw buffer.
+    *
+    * @return true if the buffer was handed over, false if the hand-off ring is full, shut down or not set.
+    */
+    inline bool releaseRawBuffer(QSharedPointer<Eigen::MatrixXf> p_pMatRawBuffer);
 
     //=========================================================================================================
     /**
@@ -233,6 +259,8 @@ protected:
 
     CommandManager  m_commandManager;       /**< The CommandManager of the connector. */
 
+    RawBufferRing::SPtr m_pRawBufferRing;   /**< The ring the raw buffers are handed over to the FiffStreamServer with. */
+
 private:
     bool        m_bIsActive;                /**< Holds the activation status. */
 };
@@ -272,6 +300,22 @@ inline void IConnector::setStatus(bool status)
     m_commandManager.setStatus(status);
 }
 
+
+//*************************************************************************************************************
+
+inline void IConnector::setRawBufferRing(RawBufferRing::SPtr p_pRawBufferRing)
+{
+    m_pRawBufferRing = p_pRawBufferRing;
+}
+
+
+//*************************************************************************************************************
+
+inline bool IConnector::releaseRawBuffer(QSharedPointer<Eigen::MatrixXf> p_pMatRawBuffer)
+{
+    return m_pRawBufferRing && m_pRawBufferRing->tryPush(p_pMatRawBuffer);
+}
+
 } //Namespace
 
 #ifndef IConnector_iid
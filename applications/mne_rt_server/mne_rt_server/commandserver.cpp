@@ -58,6 +58,15 @@
 #include <iostream>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QJsonDocument>
+#include <QJsonObject>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -96,14 +105,15 @@ void CommandServer::incommingCommand(QString p_sCommand, qint32 p_iThreadID)
 
     m_iCurrentCommandThreadID = p_iThreadID;
 
-    if(!m_commandParser.parse(p_sCommand, t_qListParsedCommands))
+    //JSON requests without a known command have to be answered as well, pipelining clients wait for a reply
+    if(!m_commandParser.parse(p_sCommand, t_qListParsedCommands) || t_qListParsedCommands.isEmpty())
     {
         QByteArray t_blockReply;
         t_blockReply.append("command unknown\r\n");
         printf("%s", t_blockReply.data());
 
         //send reply
-        emit replyCommand(t_blockReply, p_iThreadID);
+        emit replyCommand(tagReply(t_blockReply, m_commandParser.getRequestId()), p_iThreadID);
     }
 }
 
@@ -160,7 +170,20 @@ void CommandServer::prepareReply(QString p_sReply, Command p_command)
     //print
 //    printf("%s",p_sReply.toUtf8().constData());
 
-    emit replyCommand(p_sReply, t_iThreadID);
+    emit replyCommand(tagReply(p_sReply, p_command.requestId()), t_iThreadID);
+}
+
+
+//*************************************************************************************************************
+
+QString CommandServer::tagReply(const QString &p_sReply, qint32 p_iRequestId)
+{
+    if(p_iRequestId < 0)
+        return p_sReply;
+
+    QJsonObject t_jsonObjectReply;
+    t_jsonObjectReply.insert(QString("id"), QJsonValue(p_iRequestId));
+    t_jsonObjectReply.insert(QString("reply"), QJsonValue(p_sReply));
 
-    Q_UNUSED(p_command);
+    return QString(QJsonDocument(t_jsonObjectReply).toJson(QJsonDocument::Compact));
 }
@@ -158,6 +158,18 @@ protected:
     void incomingConnection(qintptr socketDescriptor);
 
 private:
+    //=========================================================================================================
+    /**
+    * Tags a reply with the correlation id of its request. Replies are then sent as {"id":<id>,"reply":<reply>},
+    * which lets pipelining clients match them to their requests.
+    *
+    * @param[in] p_sReply       The reply.
+    * @param[in] p_iRequestId   Correlation id of the request, -1 if it had none.
+    *
+    * @return the tagged reply, or the untouched reply if the request had no id.
+    */
+    static QString tagReply(const QString &p_sReply, qint32 p_iRequestId);
+
     qint32 m_iThreadCount;              /**< Is incresed each time a new command client connects to mne_rt_server. */
 
     CommandParser m_commandParser;      /**< Command parser. */
@@ -47,6 +47,7 @@
 //=============================================================================================================
 
 #include <QtNetwork>
+#include <QElapsedTimer>
 
 
 //*************************************************************************************************************
@@ -60,6 +61,19 @@ using namespace RTSERVER;
 #define USENEWSERVER 1
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+    const int IDLE_POLL_MS = 100;           /**< Socket wait when no commands are in flight. */
+    const int REPLY_POLL_MS = 1;            /**< Socket wait while the replies to received commands are expected. */
+    const qint64 REPLY_WINDOW_MS = 1000;    /**< Time after a command during which its replies are expected. */
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -92,7 +106,7 @@ void CommandThread::attachCommandReply(QString p_blockReply, qint32 p_iID)
     if(p_iID == m_iThreadID)
     {
         m_qMutex.lock();
-        m_qSendData = p_blockReply;
+        m_qListSendData.append(p_blockReply);
         m_qMutex.unlock();
     }
 }
@@ -120,6 +134,11 @@ void CommandThread::run()
     QDataStream t_FiffStreamIn(&t_qTcpSocket);
     t_FiffStreamIn.setVersion(QDataStream::Qt_5_1);
 
+#ifdef USENEWSERVER
+    quint16 t_iBlockSize = 0;
+    QElapsedTimer t_timerLastCommand;
+#endif
+
 #ifndef USENEWSERVER
     qint64 t_iMaxBufSize = 1024;
 #endif
@@ -128,56 +147,62 @@ void CommandThread::run()
     {
 #ifdef USENEWSERVER
         //
-        // Write available data
+        // Write available data, each reply in its own block
         //
-        if(m_qSendData.size() > 0)
+        m_qMutex.lock();
+        QStringList t_qListSendData = m_qListSendData;
+        m_qListSendData.clear();
+        m_qMutex.unlock();
+
+        for(qint32 i = 0; i < t_qListSendData.size(); ++i)
         {
             QByteArray block;
             QDataStream out(&block, QIODevice::WriteOnly);
             out.setVersion(QDataStream::Qt_5_1);
             out << (quint16)0;
-            m_qMutex.lock();
-            out << m_qSendData;
-            m_qSendData.clear();
-            m_qMutex.unlock();
+            out << t_qListSendData[i];
             out.device()->seek(0);
             out << (quint16)(block.size() - sizeof(quint16));
 
             t_qTcpSocket.write(block);
-            t_qTcpSocket.waitForBytesWritten();
         }
+        if(!t_qListSendData.isEmpty())
+            t_qTcpSocket.waitForBytesWritten();
 
         //
-        // Read: Wait 100ms for incomming tag header, read and continue
+        // Read: Wait for incomming blocks, shortly while replies are expected, 100ms otherwise
         //
+        bool t_bRepliesExpected = t_timerLastCommand.isValid() && t_timerLastCommand.elapsed() < REPLY_WINDOW_MS;
+        t_qTcpSocket.waitForReadyRead(t_bRepliesExpected ? REPLY_POLL_MS : IDLE_POLL_MS);
 
-        t_qTcpSocket.waitForReadyRead(100);
-
-        if (t_qTcpSocket.bytesAvailable() >= (int)sizeof(quint16))
+        //
+        // Read all complete blocks, pipelining clients send several commands without waiting for the replies
+        //
+        forever
         {
-            quint16 blockSize = 0;
-
-            bool respComplete = false;
-            t_FiffStreamIn >> blockSize;
-
-            while(!respComplete && blockSize < 65000)//Sanity Check -> allowed maximal blocksize is 65.000
+            if(t_iBlockSize == 0)
             {
-                if (t_qTcpSocket.bytesAvailable() >= blockSize)
-                {
-                    QString t_sCommand;
+                if(t_qTcpSocket.bytesAvailable() < (int)sizeof(quint16))
+                    break;
+                t_FiffStreamIn >> t_iBlockSize;
+            }
 
-                    t_FiffStreamIn >> t_sCommand;
+            if(t_qTcpSocket.bytesAvailable() < t_iBlockSize)
+                break;
 
-                    t_sCommand = t_sCommand.simplified();
+            QString t_sCommand;
+            t_FiffStreamIn >> t_sCommand;
+            t_iBlockSize = 0;
 
-                    //
-                    // Parse command
-                    //
-                    if(!t_sCommand.isEmpty())
-                        emit newCommand(t_sCommand, m_iThreadID);
+            t_sCommand = t_sCommand.simplified();
 
-                    respComplete = true;
-                }
+            //
+            // Parse command
+            //
+            if(!t_sCommand.isEmpty())
+            {
+                emit newCommand(t_sCommand, m_iThreadID);
+                t_timerLastCommand.start();
             }
         }
 
@@ -43,6 +43,7 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QStringList>
 #include <QTcpSocket>
 
 
@@ -80,7 +81,7 @@ private:
     qint32 m_iThreadID;
 
     QMutex m_qMutex;
-    QString m_qSendData;
+    QStringList m_qListSendData;    /**< Queued replies, pipelined commands get one reply each. */
 
 };
 
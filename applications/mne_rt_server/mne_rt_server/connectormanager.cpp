@@ -86,6 +86,7 @@ using namespace RTSERVER;
 ConnectorManager::ConnectorManager(FiffStreamServer* p_pFiffStreamServer, QObject *parent)
 : QPluginLoader(parent)
 , m_pFiffStreamServer(p_pFiffStreamServer)
+, m_pStreamMerger(new StreamMerger(this))
 {
 
 }
@@ -95,6 +96,9 @@ ConnectorManager::ConnectorManager(FiffStreamServer* p_pFiffStreamServer, QObjec
 
 ConnectorManager::~ConnectorManager()
 {
+    m_pStreamMerger->stop();
+    m_pStreamMerger->clearInputs();
+
     QVector<IConnector*>::const_iterator it = s_vecConnectors.begin();
     for( ; it != s_vecConnectors.end(); ++it)
         delete (*it);
@@ -157,12 +161,88 @@ void ConnectorManager::comSelcon(Command p_command)
 }
 
 
+//*************************************************************************************************************
+
+void ConnectorManager::comAddcon(Command p_command)
+{
+    bool t_bIsInt;
+    QString str;
+
+    qint32 t_id = p_command.pValues()[0].toInt(&t_bIsInt);
+    IConnector* t_pConnector = t_bIsInt ? getConnector(t_id) : NULL;
+
+    if(!t_pConnector)
+        str = QString("\tID %1 doesn't match a connector ID.\r\n\n").arg(p_command.pValues()[0].toString());
+    else if(t_pConnector->isActive())
+        str = QString("\t%1 is already active.\r\n\n").arg(t_pConnector->getName());
+    else
+    {
+        //The measurement is stopped, the merged stream starts with the next start command
+        stopActiveConnectors();
+        this->disconnectActiveConnector();
+
+        t_pConnector->setStatus(true);
+        m_vecSecondaryConnectors.append(t_pConnector);
+
+        this->connectActiveConnector();
+
+        str = QString("\t%1 added, its stream is merged into the one of %2.\r\n\n").arg(t_pConnector->getName()).arg(getActiveConnector()->getName());
+    }
+
+    qDebug() << str;
+
+    QByteArray t_blockReply = str.toUtf8();
+    t_blockReply.append(this->getConnectorList(p_command.isJson()));
+    qobject_cast<MNERTServer*> (this->parent())->getCommandManager()["addcon"].reply(t_blockReply);
+}
+
+
+//*************************************************************************************************************
+
+void ConnectorManager::comRemcon(Command p_command)
+{
+    bool t_bIsInt;
+    QString str;
+
+    qint32 t_id = p_command.pValues()[0].toInt(&t_bIsInt);
+    IConnector* t_pConnector = t_bIsInt ? getConnector(t_id) : NULL;
+
+    if(!t_pConnector || !m_vecSecondaryConnectors.contains(t_pConnector))
+        str = QString("\tID %1 doesn't match an added connector, use selcon to change the primary connector.\r\n\n").arg(p_command.pValues()[0].toString());
+    else
+    {
+        stopActiveConnectors();
+        this->disconnectActiveConnector();
+
+        m_vecSecondaryConnectors.remove(m_vecSecondaryConnectors.indexOf(t_pConnector));
+        t_pConnector->setStatus(false);
+
+        this->connectActiveConnector();
+
+        str = QString("\t%1 removed.\r\n\n").arg(t_pConnector->getName());
+    }
+
+    qDebug() << str;
+
+    QByteArray t_blockReply = str.toUtf8();
+    t_blockReply.append(this->getConnectorList(p_command.isJson()));
+    qobject_cast<MNERTServer*> (this->parent())->getCommandManager()["remcon"].reply(t_blockReply);
+}
+
+
 //*************************************************************************************************************
 
 void ConnectorManager::comStart(Command p_command)//comMeas
 {
-    getActiveConnector()->start();
-    qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["start"].reply("Starting active connector.\n");
+    //The merger has to take the buffers before the connectors produce them
+    if(!m_vecSecondaryConnectors.isEmpty())
+        m_pStreamMerger->start();
+
+    QVector<IConnector*> t_vecConnectors = getActiveConnectors();
+    for(qint32 i = 0; i < t_vecConnectors.size(); ++i)
+        t_vecConnectors[i]->start();
+
+    qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["start"].reply(t_vecConnectors.size() > 1 ? "Starting active connectors.\n" : "Starting active connector.\n");
 
     Q_UNUSED(p_command);
 }
@@ -172,13 +252,25 @@ void ConnectorManager::comStart(Command p_command)//comMeas
 
 void ConnectorManager::comStopAll(Command p_command)
 {
-    getActiveConnector()->stop();
+    stopActiveConnectors();
     qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["stop-all"].reply("Stoping all connectors.\r\n");
 
     Q_UNUSED(p_command);
 }
 
 
+//*************************************************************************************************************
+
+void ConnectorManager::stopActiveConnectors()
+{
+    QVector<IConnector*> t_vecConnectors = getActiveConnectors();
+    for(qint32 i = 0; i < t_vecConnectors.size(); ++i)
+        t_vecConnectors[i]->stop();
+
+    m_pStreamMerger->stop();
+}
+
+
 //*************************************************************************************************************
 
 void ConnectorManager::connectActiveConnector()
@@ -199,25 +291,41 @@ void ConnectorManager::connectActiveConnector()
         //The speed probably doesn't matter for most cases, but there may be some extreme cases of repeated
         //calling that makes a difference.
 
-        //
-        // Meas Info
-        //
-        // connect command server and connector manager
-        QObject::connect(   this->m_pFiffStreamServer, &FiffStreamServer::requestMeasInfo,
-                            t_activeConnector, &IConnector::info);
-
-        // connect connector manager and fiff stream server
-        QObject::connect(   t_activeConnector, &IConnector::remitMeasInfo,
-                            this->m_pFiffStreamServer, &FiffStreamServer::forwardMeasInfo);
-
-        //
-        // Raw Data
-        //
-        // connect command server and connector manager
-
-        // connect connector manager and fiff stream server
-        QObject::connect(   t_activeConnector, &IConnector::remitRawBuffer,
-                            this->m_pFiffStreamServer, &FiffStreamServer::forwardRawBuffer);
+        if(m_vecSecondaryConnectors.isEmpty())
+        {
+            //
+            // Meas Info
+            //
+            // connect command server and connector manager
+            QObject::connect(   this->m_pFiffStreamServer, &FiffStreamServer::requestMeasInfo,
+                                t_activeConnector, &IConnector::info);
+
+            // connect connector manager and fiff stream server
+            QObject::connect(   t_activeConnector, &IConnector::remitMeasInfo,
+                                this->m_pFiffStreamServer, &FiffStreamServer::forwardMeasInfo);
+
+            //
+            // Raw Data
+            //
+            // hand the raw buffers over to the fiff stream server through its lock-free ring, the ring is shared by
+            // all connectors for the lifetime of the server
+            t_activeConnector->setRawBufferRing(this->m_pFiffStreamServer->getRawBufferRing());
+        }
+        else
+        {
+            //
+            // Merged streams
+            //
+            // with additional connectors the stream merger is put in between, it answers the info requests with
+            // the merged info and hands the merged raw buffers over through the ring of the fiff stream server
+            m_pStreamMerger->setInputs(getActiveConnectors(), this->m_pFiffStreamServer->getRawBufferRing());
+
+            QObject::connect(   this->m_pFiffStreamServer, &FiffStreamServer::requestMeasInfo,
+                                m_pStreamMerger, &StreamMerger::requestInfo);
+
+            QObject::connect(   m_pStreamMerger, &StreamMerger::remitMeasInfo,
+                                this->m_pFiffStreamServer, &FiffStreamServer::forwardMeasInfo);
+        }
     }
     else
     {
@@ -255,6 +363,13 @@ void ConnectorManager::disconnectActiveConnector()
 
         this->m_pFiffStreamServer->disconnect(t_activeConnector);
 
+        //
+        // Merged streams
+        //
+        m_pStreamMerger->disconnect(this->m_pFiffStreamServer);
+        this->m_pFiffStreamServer->disconnect(m_pStreamMerger);
+        m_pStreamMerger->clearInputs();
+
         //
         // Raw Data
         //
@@ -283,7 +398,7 @@ IConnector* ConnectorManager::getActiveConnector()
     QVector<IConnector*>::const_iterator it = s_vecConnectors.begin();
     for( ; it != s_vecConnectors.end(); ++it)
     {
-        if((*it)->isActive())
+        if((*it)->isActive() && !m_vecSecondaryConnectors.contains(*it))
             return *it;
     }
 
@@ -291,6 +406,35 @@ IConnector* ConnectorManager::getActiveConnector()
 }
 
 
+//*************************************************************************************************************
+
+QVector<IConnector*> ConnectorManager::getActiveConnectors()
+{
+    QVector<IConnector*> t_vecConnectors;
+
+    IConnector* t_pPrimaryConnector = getActiveConnector();
+    if(t_pPrimaryConnector)
+        t_vecConnectors.append(t_pPrimaryConnector);
+
+    t_vecConnectors += m_vecSecondaryConnectors;
+
+    return t_vecConnectors;
+}
+
+
+//*************************************************************************************************************
+
+IConnector* ConnectorManager::getConnector(qint32 ID) const
+{
+    QVector<IConnector*>::const_iterator it = s_vecConnectors.begin();
+    for( ; it != s_vecConnectors.end(); ++it)
+        if((*it)->getConnectorID() == ID)
+            return *it;
+
+    return NULL;
+}
+
+
 //*************************************************************************************************************
 
 QByteArray ConnectorManager::getConnectorList(bool p_bFlagJSON) const
@@ -312,6 +456,9 @@ QByteArray ConnectorManager::getConnectorList(bool p_bFlagJSON) const
             //insert isActive
             t_qJsonObjectConnector.insert(QString("active"), QJsonValue((*it)->isActive()));
 
+            //insert whether it is merged into the primary connector
+            t_qJsonObjectConnector.insert(QString("merged"), QJsonValue(m_vecSecondaryConnectors.contains(*it)));
+
             //insert Connector JsonObject
             t_qJsonObjectConnectors.insert((*it)->getName(),t_qJsonObjectConnector);//QJsonObject());//QJsonValue());
 
@@ -330,7 +477,9 @@ QByteArray ConnectorManager::getConnectorList(bool p_bFlagJSON) const
             QVector<IConnector*>::const_iterator it = s_vecConnectors.begin();
             for( ; it != s_vecConnectors.end(); ++it)
             {
-                if((*it)->isActive())
+                if(m_vecSecondaryConnectors.contains(*it))
+                    t_blockConnectorList.append(QString("  +  (%1) %2\r\n").arg((*it)->getConnectorID()).arg((*it)->getName()));
+                else if((*it)->isActive())
                     t_blockConnectorList.append(QString("  *  (%1) %2\r\n").arg((*it)->getConnectorID()).arg((*it)->getName()));
                 else
                     t_blockConnectorList.append(QString("     (%1) %2\r\n").arg((*it)->getConnectorID()).arg((*it)->getName()));
@@ -352,6 +501,8 @@ void ConnectorManager::connectCommands()
 
     QObject::connect(&t_pMNERTServer->getCommandManager()["conlist"], &Command::executed, this, &ConnectorManager::comConlist);
     QObject::connect(&t_pMNERTServer->getCommandManager()["selcon"], &Command::executed, this, &ConnectorManager::comSelcon);
+    QObject::connect(&t_pMNERTServer->getCommandManager()["addcon"], &Command::executed, this, &ConnectorManager::comAddcon);
+    QObject::connect(&t_pMNERTServer->getCommandManager()["remcon"], &Command::executed, this, &ConnectorManager::comRemcon);
     QObject::connect(&t_pMNERTServer->getCommandManager()["start"], &Command::executed, this, &ConnectorManager::comStart);
     QObject::connect(&t_pMNERTServer->getCommandManager()["stop-all"], &Command::executed, this, &ConnectorManager::comStopAll);
 }
@@ -476,10 +627,14 @@ QByteArray ConnectorManager::setActiveConnector(qint32 ID)
            IConnector* t_pActiveConnector = getActiveConnector();
 
            //Stop and disconnect active connector
-           t_pActiveConnector->stop();
+           stopActiveConnectors();
            this->disconnectActiveConnector();
            t_pActiveConnector->setStatus(false);
 
+           //an added connector becomes the primary one
+           if(m_vecSecondaryConnectors.contains(t_pNewActiveConnector))
+               m_vecSecondaryConnectors.remove(m_vecSecondaryConnectors.indexOf(t_pNewActiveConnector));
+
            //set new active connector
            t_pNewActiveConnector->setStatus(true);
            this->connectActiveConnector();
@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "IConnector.h"
+#include "streammerger.h"
 
 
 //*************************************************************************************************************
@@ -141,12 +142,21 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns vector containing active ISensor plugins.
+    * Returns the active primary connector, the one selected by selcon.
     *
-    * @return reference to vector containing active ISensor plugins.
+    * @return the primary connector, NULL if none is active.
     */
     IConnector* getActiveConnector();
 
+    //=========================================================================================================
+    /**
+    * Returns all active connectors, the primary connector first followed by the ones added with addcon. More
+    * than one active connector are merged into one stream by the StreamMerger.
+    *
+    * @return the active connectors.
+    */
+    QVector<IConnector*> getActiveConnectors();
+
     //=========================================================================================================
     /**
     * Returns vector containing all plugins.
@@ -194,6 +204,22 @@ private:
     */
     void comSelcon(Command p_command);
 
+    //=========================================================================================================
+    /**
+    * Activates an additional connector, its stream is merged into the one of the primary connector
+    *
+    * @param[in] p_command  The add connector command.
+    */
+    void comAddcon(Command p_command);
+
+    //=========================================================================================================
+    /**
+    * Deactivates a connector added with addcon
+    *
+    * @param[in] p_command  The remove connector command.
+    */
+    void comRemcon(Command p_command);
+
     //=========================================================================================================
     /**
     * Starts the Measurement
@@ -210,12 +236,31 @@ private:
     */
     void comStopAll(Command p_command);
 
+    //=========================================================================================================
+    /**
+    * Stops the active connectors and the stream merger.
+    */
+    void stopActiveConnectors();
+
+    //=========================================================================================================
+    /**
+    * Returns the connector with the given id.
+    *
+    * @param[in] ID     the connector id.
+    *
+    * @return the connector, NULL if there is none with this id.
+    */
+    IConnector* getConnector(qint32 ID) const;
+
 
 
 
     static QVector<IConnector*> s_vecConnectors;       /**< Holds vector of all plugins. */
 
     FiffStreamServer* m_pFiffStreamServer;
+
+    QVector<IConnector*> m_vecSecondaryConnectors;    /**< Connectors added with addcon, merged into the stream of the primary connector. */
+    StreamMerger* m_pStreamMerger;                    /**< Merges the streams when more than one connector is active. */
 };
 
 
@@ -43,6 +43,9 @@
 
 #include "mne_rt_server.h"
 
+#include <fiff/fiff_constants.h>
+#include <fiff/fiff_stream.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -69,8 +72,14 @@ using namespace FIFFLIB;
 FiffStreamServer::FiffStreamServer(QObject *parent)
 : QTcpServer(parent)
 , m_iNextClientId(0)
+, m_iSendQueueSize(100)
+, m_sendQueuePolicy(FiffStreamThread::DropOldest)
+, m_pRawBufferRing(new RawBufferRing(RAW_BUFFER_RING_SIZE))
 {
+    m_pMulticastPublisher = new MulticastPublisher();
 
+    m_pRawBufferForwarder = new RawBufferForwarder(m_pRawBufferRing, this);
+    m_pRawBufferForwarder->start();
 }
 
 
@@ -78,6 +87,11 @@ FiffStreamServer::FiffStreamServer(QObject *parent)
 
 FiffStreamServer::~FiffStreamServer()
 {
+    m_pRawBufferForwarder->stop();
+    delete m_pRawBufferForwarder;
+
+    delete m_pMulticastPublisher;
+
     emit closeFiffStreamServer();
 }
 
@@ -88,13 +102,18 @@ void FiffStreamServer::comClist(Command p_command)
 {
     //ToDo JSON
     QString t_sOutput("");
-    t_sOutput.append("\tID\tAlias\r\n");
+    t_sOutput.append("\tID\tAlias\tQueued\tMax\tSent\tDropped\tLag[ms]\tMaxLag[ms]\r\n");
+    m_qMutexClientList.lock();
     QMap<qint32, FiffStreamThread*>::iterator i;
     for (i = this->m_qClientList.begin(); i != this->m_qClientList.end(); ++i)
     {
-        QString str = QString("\t%1\t%2\r\n").arg(i.key()).arg(i.value()->getAlias());
+        FiffStreamThread::SendStatistics t_stats = i.value()->getSendStatistics();
+        QString str = QString("\t%1\t%2\t%3\t%4\t%5\t%6\t%7\t%8\r\n").arg(i.key()).arg(i.value()->getAlias())
+                .arg(t_stats.iQueued).arg(t_stats.iMaxQueued).arg(t_stats.iSent).arg(t_stats.iDropped)
+                .arg(t_stats.iLagMs).arg(t_stats.iMaxLagMs);
         t_sOutput.append(str);
     }
+    m_qMutexClientList.unlock();
     t_sOutput.append("\n");
     qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["clist"].reply(t_sOutput);
 
@@ -173,6 +192,95 @@ void FiffStreamServer::comStopAll(Command p_command)
 }
 
 
+//*************************************************************************************************************
+
+void FiffStreamServer::comSendqueue(Command p_command)
+{
+    QString t_sOutput("");
+
+    qint32 t_iSize = p_command["size"].toInt();
+    QString t_sPolicy = p_command["policy"].toString();
+
+    if(t_iSize > 0)
+        m_iSendQueueSize = t_iSize;
+
+    if(t_sPolicy.compare("disconnect", Qt::CaseInsensitive) == 0)
+        m_sendQueuePolicy = FiffStreamThread::Disconnect;
+    else if(t_sPolicy.compare("drop", Qt::CaseInsensitive) == 0)
+        m_sendQueuePolicy = FiffStreamThread::DropOldest;
+    else if(!t_sPolicy.isEmpty())
+        t_sOutput.append(QString("\twarning: unknown policy '%1', use 'drop' or 'disconnect'\r\n").arg(t_sPolicy));
+
+    m_qMutexClientList.lock();
+    QMap<qint32, FiffStreamThread*>::iterator i;
+    for (i = this->m_qClientList.begin(); i != this->m_qClientList.end(); ++i)
+        i.value()->setSendQueue(m_iSendQueueSize, m_sendQueuePolicy);
+    m_qMutexClientList.unlock();
+
+    t_sOutput.append(QString("\tsend queue size %1, overflow policy '%2'\r\n\n").arg(m_iSendQueueSize).arg(m_sendQueuePolicy == FiffStreamThread::Disconnect ? "disconnect" : "drop"));
+    qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["sendqueue"].reply(t_sOutput);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamServer::comHandoff(Command p_command)
+{
+    RawBufferRing::Statistics t_stats = m_pRawBufferRing->statistics();
+
+    QString t_sOutput("");
+    t_sOutput.append("\tSlots\tQueued\tPushed\tForwarded\tDropped\tLatency[us]\tMean[us]\tMax[us]\r\n");
+    t_sOutput.append(QString("\t%1\t%2\t%3\t%4\t\t%5\t%6\t\t%7\t\t%8\r\n\n").arg(m_pRawBufferRing->size()).arg(m_pRawBufferRing->count())
+            .arg(t_stats.iPushed).arg(t_stats.iPopped).arg(t_stats.iDropped)
+            .arg(t_stats.iLastLatencyUs).arg(t_stats.iMeanLatencyUs).arg(t_stats.iMaxLatencyUs));
+    qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["handoff"].reply(t_sOutput);
+
+    Q_UNUSED(p_command);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamServer::comMulticast(Command p_command)
+{
+    QString t_sOutput("");
+
+    QString t_sGroup = p_command["group"].toString();
+    qint32 t_iPort = p_command["port"].toInt();
+    qint32 t_iTtl = p_command["ttl"].toInt();
+
+    if(t_sGroup.compare("off", Qt::CaseInsensitive) == 0)
+    {
+        m_pMulticastPublisher->stop();
+    }
+    else if(!t_sGroup.isEmpty())
+    {
+        QHostAddress t_group(t_sGroup);
+        if(!t_group.isMulticast())
+            t_sOutput.append(QString("\terror: '%1' is not a multicast address\r\n").arg(t_sGroup));
+        else if(t_iPort <= 0 || t_iPort > 65535)
+            t_sOutput.append(QString("\terror: invalid port %1\r\n").arg(t_iPort));
+        else
+            m_pMulticastPublisher->start(t_group, t_iPort, t_iTtl);
+    }
+
+    if(m_pMulticastPublisher->isPublishing())
+    {
+        MulticastPublisher::Statistics t_stats = m_pMulticastPublisher->getStatistics();
+        t_sOutput.append(QString("\tpublishing to %1:%2\r\n").arg(m_pMulticastPublisher->getGroup().toString()).arg(m_pMulticastPublisher->getPort()));
+        t_sOutput.append("\tBuffers\tDatagrams\tRetransmitted\tUnavailable\tDropped\r\n");
+        t_sOutput.append(QString("\t%1\t%2\t\t%3\t\t%4\t\t%5\r\n\n").arg(t_stats.iBuffers).arg(t_stats.iDatagrams)
+                .arg(t_stats.iRetransmitted).arg(t_stats.iUnavailable).arg(t_stats.iDropped));
+    }
+    else
+    {
+        t_sOutput.append("\tmulticast is off\r\n\n");
+    }
+
+    qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["multicast"].reply(t_sOutput);
+}
+
+
 //*************************************************************************************************************
 
 void FiffStreamServer::connectCommands()
@@ -185,6 +293,9 @@ void FiffStreamServer::connectCommands()
     QObject::connect(&t_pMNERTServer->getCommandManager()["start"], &Command::executed, this, &FiffStreamServer::comStart);
     QObject::connect(&t_pMNERTServer->getCommandManager()["stop"], &Command::executed, this, &FiffStreamServer::comStop);
     QObject::connect(&t_pMNERTServer->getCommandManager()["stop-all"], &Command::executed, this, &FiffStreamServer::comStopAll);
+    QObject::connect(&t_pMNERTServer->getCommandManager()["sendqueue"], &Command::executed, this, &FiffStreamServer::comSendqueue);
+    QObject::connect(&t_pMNERTServer->getCommandManager()["handoff"], &Command::executed, this, &FiffStreamServer::comHandoff);
+    QObject::connect(&t_pMNERTServer->getCommandManager()["multicast"], &Command::executed, this, &FiffStreamServer::comMulticast);
 
 //    t_pMNERTServer->getCommandManager().connectSlot(QString("clist"), this, &FiffStreamServer::comClist);
 //    t_pMNERTServer->getCommandManager().connectSlot(QString("measinfo"), this, &FiffStreamServer::comMeasinfo);
@@ -313,6 +424,8 @@ QByteArray FiffStreamServer::parseToId(QString& p_sRawId, qint32& p_iParsedId)
     QByteArray t_blockCmdIdInfo;
     if(!p_sRawId.isEmpty())
     {
+        QMutexLocker locker(&m_qMutexClientList);
+
         bool t_isInt;
         qint32 t_id = p_sRawId.toInt(&t_isInt);
 
@@ -364,6 +477,18 @@ QByteArray FiffStreamServer::parseToId(QString& p_sRawId, qint32& p_iParsedId)
 //}
 
 
+//*************************************************************************************************************
+
+void FiffStreamServer::removeClient(qint32 id)
+{
+    QMutexLocker locker(&m_qMutexClientList);
+
+    FiffStreamThread* t_pStreamThread = m_qClientList.take(id);
+    if(t_pStreamThread)
+        this->disconnect(t_pStreamThread);
+}
+
+
 //*************************************************************************************************************
 
 void FiffStreamServer::forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo)
@@ -373,10 +498,33 @@ void FiffStreamServer::forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo)
 
 
 //*************************************************************************************************************
-//ToDo increase preformance --> try inline
+
 void FiffStreamServer::forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
 {
-    emit remitRawBuffer(m_pMatRawData);
+    QMutexLocker locker(&m_qMutexClientList);
+
+    bool t_bPublish = m_pMulticastPublisher->isPublishing();
+
+    if(m_qClientList.isEmpty() && !t_bPublish)
+        return;
+
+    //Serialize the buffer only once, the encoded bytes are shared by the multicast group and all clients without
+    //their own subscription
+    bool t_bSerialize = t_bPublish;
+    QMap<qint32, FiffStreamThread*>::iterator i;
+    for (i = this->m_qClientList.begin(); i != this->m_qClientList.end() && !t_bSerialize; ++i)
+        t_bSerialize = !i.value()->hasSubscription();
+
+    QByteArray t_blockRawBuffer;
+    if(t_bSerialize) {
+        FiffStream t_FiffStreamOut(&t_blockRawBuffer, QIODevice::WriteOnly);
+        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER, m_pMatRawData->data(), m_pMatRawData->rows()*m_pMatRawData->cols());
+    }
+
+    if(t_bPublish)
+        m_pMulticastPublisher->publish(t_blockRawBuffer);
+
+    emit remitRawBuffer(m_pMatRawData, t_blockRawBuffer);
 }
 
 
@@ -385,8 +533,11 @@ void FiffStreamServer::forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRa
 void FiffStreamServer::incomingConnection(qintptr socketDescriptor)
 {
     FiffStreamThread* t_pStreamThread = new FiffStreamThread(m_iNextClientId, socketDescriptor, this);
+    t_pStreamThread->setSendQueue(m_iSendQueueSize, m_sendQueuePolicy);
 
+    m_qMutexClientList.lock();
     m_qClientList.insert(m_iNextClientId, t_pStreamThread);
+    m_qMutexClientList.unlock();
     ++m_iNextClientId;
 
     //when thread has finished it gets deleted
@@ -41,6 +41,10 @@
 // MNE INCLUDES
 //=============================================================================================================
 
+#include "fiffstreamthread.h"
+#include "rawbufferforwarder.h"
+#include "multicastpublisher.h"
+
 #include <fiff/fiff_info.h>
 #include <realtime/rtCommand/commandmanager.h>
 
@@ -52,6 +56,7 @@
 
 #include <QStringList>
 #include <QTcpServer>
+#include <QMutex>
 
 
 //*************************************************************************************************************
@@ -76,8 +81,6 @@ using namespace REALTIMELIB;
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
-class FiffStreamThread;
-
 //=============================================================================================================
 /**
 * DECLARE CLASS FiffStreamServer
@@ -106,12 +109,38 @@ public:
     */
     inline FiffStreamThread* getClient(qint32 id);
 
+    //=========================================================================================================
+    /**
+    * Removes a client from the client list and disconnects it from the server signals. Takes the client list
+    * lock, so the RawBufferForwarder no longer reaches the client once this returns. Called by the client
+    * before it is torn down.
+    *
+    * @param[in] id     The client id.
+    */
+    void removeClient(qint32 id);
+
     //=========================================================================================================
     /**
     * connect fiff stream server to mne_rt_server commands
     */
     void connectCommands();
 
+    //=========================================================================================================
+    /**
+    * Returns the ring through which the connectors hand their raw buffers over.
+    *
+    * @return the hand-off ring.
+    */
+    inline RawBufferRing::SPtr getRawBufferRing() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the publisher of the multicast raw data stream.
+    *
+    * @return the multicast publisher.
+    */
+    inline MulticastPublisher* getMulticastPublisher() const;
+
 //    virtual bool parseCommand(QStringList& p_sListCommand, QByteArray& p_blockOutputInfo);
 
 
@@ -123,6 +152,13 @@ public:
 
 //public slots: --> in Qt 5 not anymore declared as slot
     void forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo);
+
+    //=========================================================================================================
+    /**
+    * Distributes a raw buffer to the data clients. Called by the RawBufferForwarder thread.
+    *
+    * @param[in] m_pMatRawData  The raw buffer.
+    */
     void forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
 
 signals:
@@ -132,7 +168,7 @@ signals:
     void stopMeasFiffStreamClient(qint32 ID);
 
     void remitMeasInfo(qint32 ID, const FIFFLIB::FiffInfo& p_fiffInfo);
-    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf>);
+    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf> p_pMatRawData, const QByteArray& p_blockRawBuffer);
 
     void closeFiffStreamServer();
 
@@ -181,10 +217,42 @@ private:
     */
     void comStopAll(Command p_command);
 
+    //=========================================================================================================
+    /**
+    * Sets the send queue size and overflow policy of all current and future clients
+    *
+    * @param[in] p_command  The send queue command.
+    */
+    void comSendqueue(Command p_command);
+
+    //=========================================================================================================
+    /**
+    * Prints the statistics of the raw buffer hand-off from the connectors
+    *
+    * @param[in] p_command  The hand-off command.
+    */
+    void comHandoff(Command p_command);
+
+    //=========================================================================================================
+    /**
+    * Starts, stops or prints the multicast raw data stream
+    *
+    * @param[in] p_command  The multicast command.
+    */
+    void comMulticast(Command p_command);
+
     QByteArray parseToId(QString& p_sRawId, qint32& p_iParsedId);
 
     QMap<qint32, FiffStreamThread*> m_qClientList;
     qint32                          m_iNextClientId;
+    QMutex                          m_qMutexClientList;     /**< Guards all accesses of the client list, the RawBufferForwarder reads it from its own thread. */
+
+    RawBufferRing::SPtr             m_pRawBufferRing;       /**< Hands the raw buffers over from the connectors. */
+    RawBufferForwarder*             m_pRawBufferForwarder;  /**< Forwards the handed over raw buffers to the clients. */
+    MulticastPublisher*             m_pMulticastPublisher;  /**< Publishes the raw buffers to a multicast group. */
+
+    qint32                              m_iSendQueueSize;       /**< Maximal number of raw buffers queued per client. */
+    FiffStreamThread::OverflowPolicy    m_sendQueuePolicy;      /**< What to do when the send queue of a client is full. */
 
 };
 
@@ -196,7 +264,24 @@ private:
 
 FiffStreamThread* FiffStreamServer::getClient(qint32 id)
 {
-    return m_qClientList[id];
+    QMutexLocker locker(&m_qMutexClientList);
+    return m_qClientList.value(id, NULL);
+}
+
+
+//*************************************************************************************************************
+
+RawBufferRing::SPtr FiffStreamServer::getRawBufferRing() const
+{
+    return m_pRawBufferRing;
+}
+
+
+//*************************************************************************************************************
+
+MulticastPublisher* FiffStreamServer::getMulticastPublisher() const
+{
+    return m_pMulticastPublisher;
 }
 
 } // NAMESPACE
@@ -43,6 +43,10 @@
 #include "fiffstreamserver.h"
 #include "mne_rt_commands.h"
 
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <string.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -60,6 +64,7 @@
 //=============================================================================================================
 
 #include <QtNetwork>
+#include <QtCore/qfloat16.h>
 
 
 //*************************************************************************************************************
@@ -70,6 +75,46 @@
 using namespace UTILSLIB;
 using namespace RTSERVER;
 using namespace FIFFLIB;
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+const qint32 SHMEM_RING_CAPACITY = 16*1024*1024;   /**< Capacity of the shared memory ring of a local client in bytes. */
+
+//=============================================================================================================
+/**
+* Designs the anti-alias lowpass of a decimation, a Hamming windowed sinc with its cutoff at 80% of the
+* decimated Nyquist frequency.
+*
+* @param[in] iDecimation    the decimation factor.
+*
+* @return the filter taps, normalized to unit gain.
+*/
+VectorXf designAntiAliasFilter(qint32 iDecimation)
+{
+    qint32 iOrder = 16 * iDecimation;
+    double dCutoff = 0.4 / iDecimation;
+
+    VectorXf vecTaps(iOrder + 1);
+    for(qint32 n = 0; n <= iOrder; ++n) {
+        double m = n - iOrder / 2;
+        double dSinc = m == 0 ? 2.0 * dCutoff : sin(2.0 * M_PI * dCutoff * m) / (M_PI * m);
+        double dWindow = 0.54 - 0.46 * cos(2.0 * M_PI * n / iOrder);
+        vecTaps(n) = dSinc * dWindow;
+    }
+
+    return vecTaps / vecTaps.sum();
+}
+
+} // NAMESPACE
 
 
 //*************************************************************************************************************
@@ -82,9 +127,24 @@ FiffStreamThread::FiffStreamThread(qint32 id, int socketDescriptor, QObject *par
 , m_iDataClientId(id)
 , m_sDataClientAlias(QString(""))
 , m_iSocketDescriptor(socketDescriptor)
+, m_iMaxQueued(100)
+, m_overflowPolicy(DropOldest)
+, m_iSubDecimation(1)
+, m_subEncoding(RtRawCodec::Float32)
+, m_bResetSubState(true)
+, m_iDecimationPhase(0)
+, m_bMulticast(false)
 , m_bIsSendingRawBuffer(false)
 , m_bIsRunning(false)
 {
+    m_sendStatistics.iQueued = 0;
+    m_sendStatistics.iMaxQueued = 0;
+    m_sendStatistics.iSent = 0;
+    m_sendStatistics.iDropped = 0;
+    m_sendStatistics.iLagMs = 0;
+    m_sendStatistics.iMaxLagMs = 0;
+
+    m_timer.start();
 }
 
 
@@ -92,10 +152,10 @@ FiffStreamThread::FiffStreamThread(qint32 id, int socketDescriptor, QObject *par
 
 FiffStreamThread::~FiffStreamThread()
 {
-    //Remove from client list
+    //Remove from client list before the teardown, the forwarder must not reach this client anymore
     FiffStreamServer* t_pFiffStreamServer = qobject_cast<FiffStreamServer*>(this->parent());
     if(t_pFiffStreamServer)
-        t_pFiffStreamServer->m_qClientList.remove(m_iDataClientId);
+        t_pFiffStreamServer->removeClient(m_iDataClientId);
 
     m_bIsRunning = false;
     QThread::wait();
@@ -110,11 +170,17 @@ void FiffStreamThread::startMeas(qint32 ID)
     {
         qDebug() << "Activate raw buffer sending.";
 
-        m_qMutex.lock();
         // ToDo send start meas
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        RawBufferItem t_start;
+        FiffStream t_FiffStreamOut(&t_start.blockData, QIODevice::WriteOnly);
         t_FiffStreamOut.start_block(FIFFB_RAW_DATA);
+        t_start.bControl = true;
+
+        m_qMutex.lock();
+        t_start.iTimestamp = m_timer.elapsed();
+        m_qQueueRawBuffer.enqueue(t_start);
         m_bIsSendingRawBuffer = true;
+        m_bResetSubState = true;
         m_qMutex.unlock();
     }
 }
@@ -129,9 +195,15 @@ void FiffStreamThread::stopMeas(qint32 ID)
     {
         qDebug() << "stop raw buffer sending.";
 
-        m_qMutex.lock();
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        //Queued after the pending raw buffers, which have to go out before the end of the raw data block
+        RawBufferItem t_end;
+        FiffStream t_FiffStreamOut(&t_end.blockData, QIODevice::WriteOnly);
         t_FiffStreamOut.end_block(FIFFB_RAW_DATA);
+        t_end.bControl = true;
+
+        m_qMutex.lock();
+        t_end.iTimestamp = m_timer.elapsed();
+        m_qQueueRawBuffer.enqueue(t_end);
         m_bIsSendingRawBuffer = false;
         m_qMutex.unlock();
     }
@@ -164,6 +236,83 @@ void FiffStreamThread::parseCommand(FiffTag::SPtr p_pTag)
             printf("FiffStreamClient (ID %d): send client ID %d\r\n\n", m_iDataClientId, m_iDataClientId);
             writeClientId();
         }
+        else if(t_iCmd == MNE_RT_SET_CLIENT_CHANNELS)
+        {
+            //
+            // Subscribe to a channel subset, an empty list subscribes to all channels
+            //
+            QString t_sChannels = QString(p_pTag->mid(4, p_pTag->size()-4));
+
+            QMutexLocker locker(&m_qMutex);
+            m_qListSubChannels = FiffStream::split_name_list(t_sChannels);
+            resolveSubscribedChannels();
+            m_bResetSubState = true;
+            if(m_qListSubChannels.isEmpty())
+                printf("FiffStreamClient (ID %d): subscribed to all channels\r\n\n", m_iDataClientId);
+            else
+                printf("FiffStreamClient (ID %d): subscribed to %d channels\r\n\n", m_iDataClientId, m_qListSubChannels.size());
+        }
+        else if(t_iCmd == MNE_RT_SET_CLIENT_DECIMATION)
+        {
+            //
+            // Subscribe to a decimated stream
+            //
+            qint32 t_iDecimation = QString(p_pTag->mid(4, p_pTag->size()-4)).toInt();
+
+            QMutexLocker locker(&m_qMutex);
+            m_iSubDecimation = t_iDecimation > 1 ? t_iDecimation : 1;
+            m_bResetSubState = true;
+            printf("FiffStreamClient (ID %d): decimation = %d\r\n\n", m_iDataClientId, m_iSubDecimation);
+        }
+        else if(t_iCmd == MNE_RT_SET_CLIENT_ENCODING)
+        {
+            //
+            // Select single (float32) or half (float16) precision, or quantized and compressed (int16, int24) samples
+            //
+            QString t_sEncoding = QString(p_pTag->mid(4, p_pTag->size()-4));
+
+            QMutexLocker locker(&m_qMutex);
+            m_subEncoding = RtRawCodec::encodingFromName(t_sEncoding);
+            printf("FiffStreamClient (ID %d): encoding = '%s'\r\n\n", m_iDataClientId, RtRawCodec::encodingName(m_subEncoding).toUtf8().constData());
+        }
+        else if(t_iCmd == MNE_RT_SET_CLIENT_TRANSPORT)
+        {
+            //
+            // Send the raw buffers through a shared memory ring or the socket, the command channel stays on TCP
+            //
+            QString t_sTransport = QString(p_pTag->mid(4, p_pTag->size()-4));
+
+            m_qMutex.lock();
+            m_bMulticast = t_sTransport.compare("multicast", Qt::CaseInsensitive) == 0;
+            m_qMutex.unlock();
+
+            if(t_sTransport.compare("shmem", Qt::CaseInsensitive) == 0)
+            {
+                if(!m_pShmemRing)
+                {
+                    m_pShmemRing = RtShmemRing::SPtr(new RtShmemRing(RtShmemRing::clientKey(m_iDataClientId)));
+                    if(!m_pShmemRing->create(SHMEM_RING_CAPACITY))
+                        m_pShmemRing.clear();
+                }
+            }
+            else
+            {
+                m_pShmemRing.clear();
+            }
+
+            printf("FiffStreamClient (ID %d): transport = '%s'\r\n\n", m_iDataClientId, m_bMulticast ? "multicast" : m_pShmemRing ? "shmem" : "tcp");
+        }
+        else if(t_iCmd == MNE_RT_REQUEST_RETRANSMISSION)
+        {
+            //
+            // Send lost multicast datagrams again
+            //
+            QStringList t_qListRange = QString(p_pTag->mid(4, p_pTag->size()-4)).split(":");
+
+            FiffStreamServer* t_pParentServer = qobject_cast<FiffStreamServer*>(this->parent());
+            if(t_qListRange.size() == 2 && t_pParentServer)
+                t_pParentServer->getMulticastPublisher()->requestRetransmission(t_qListRange[0].toUInt(), t_qListRange[1].toUInt(), m_peerAddress);
+        }
         else
         {
             printf("FiffStreamClient (ID %d): unknown command\r\n\n", m_iDataClientId);
@@ -178,24 +327,254 @@ void FiffStreamThread::parseCommand(FiffTag::SPtr p_pTag)
 
 //*************************************************************************************************************
 
-void FiffStreamThread::sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
+void FiffStreamThread::setSendQueue(qint32 iMaxQueued, OverflowPolicy policy)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_iMaxQueued = iMaxQueued > 0 ? iMaxQueued : 1;
+    m_overflowPolicy = policy;
+}
+
+
+//*************************************************************************************************************
+
+FiffStreamThread::SendStatistics FiffStreamThread::getSendStatistics()
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_sendStatistics;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStreamThread::hasSubscription()
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_vecSubSel.size() > 0 || m_iSubDecimation > 1 || m_subEncoding != RtRawCodec::Float32;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamThread::resolveSubscribedChannels()
+{
+    m_vecSubSel.resize(0);
+
+    //The names are resolved again as soon as the measurement info is known
+    if(m_qListSubChannels.isEmpty() || m_qListChNames.isEmpty())
+        return;
+
+    m_vecSubSel = FiffInfoBase::pick_channels(m_qListChNames, m_qListSubChannels);
+
+    if(m_vecSubSel.size() == 0)
+        printf("FiffStreamClient (ID %d): none of the subscribed channels is available, sending all channels\r\n\n", m_iDataClientId);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamThread::sendRawBuffer(QSharedPointer<Eigen::MatrixXf> p_pMatRawData, const QByteArray& p_blockRawBuffer)
 {
     if(m_bIsSendingRawBuffer)
     {
-//        qDebug() << "Send RawBuffer to client";
+        QMutexLocker locker(&m_qMutex);
 
-        m_qMutex.lock();
+        //The multicast group carries the raw buffers of this client
+        if(m_bMulticast)
+            return;
 
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
-        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER,m_pMatRawData->data(),m_pMatRawData->rows()*m_pMatRawData->cols());
+        qint32 t_iQueued = 0;
+        for(qint32 i = 0; i < m_qQueueRawBuffer.size(); ++i)
+            if(!m_qQueueRawBuffer.at(i).bControl)
+                ++t_iQueued;
 
-        m_qMutex.unlock();
+        if(t_iQueued >= m_iMaxQueued)
+        {
+            if(m_overflowPolicy == Disconnect)
+            {
+                printf("FiffStreamClient (ID %d): send queue is full, disconnecting\r\n\n", m_iDataClientId);
+                m_qQueueRawBuffer.clear();
+                m_sendStatistics.iQueued = 0;
+                m_bIsSendingRawBuffer = false;
+                m_bIsRunning = false;
+                return;
+            }
 
+            //Drop the oldest raw buffer, but keep the block start and end
+            for(qint32 i = 0; i < m_qQueueRawBuffer.size(); ++i) {
+                if(!m_qQueueRawBuffer.at(i).bControl) {
+                    m_qQueueRawBuffer.removeAt(i);
+                    break;
+                }
+            }
+            --t_iQueued;
+            ++m_sendStatistics.iDropped;
+        }
+
+        RawBufferItem t_item;
+        t_item.iTimestamp = m_timer.elapsed();
+        t_item.bControl = false;
+
+        //Clients with their own subscription encode the buffer in their own thread, all others share the bytes
+        if(m_vecSubSel.size() > 0 || m_iSubDecimation > 1 || m_subEncoding != RtRawCodec::Float32 || p_blockRawBuffer.isEmpty())
+            t_item.pMatData = p_pMatRawData;
+        else
+            t_item.blockData = p_blockRawBuffer;
+
+        m_qQueueRawBuffer.enqueue(t_item);
+
+        m_sendStatistics.iQueued = t_iQueued + 1;
+        m_sendStatistics.iMaxQueued = qMax(m_sendStatistics.iMaxQueued, m_sendStatistics.iQueued);
     }
-//    else
-//    {
-//        qDebug() << "Send RawBuffer is not activated";
-//    }
+}
+
+
+//*************************************************************************************************************
+
+QByteArray FiffStreamThread::encodeRawBuffer(const MatrixXf& p_matRawData, const RowVectorXi& p_vecSel, qint32 p_iDecimation, RtRawCodec::Encoding p_encoding, const VectorXf& p_vecLsb)
+{
+    //Channel selection
+    MatrixXf t_matData;
+    if(p_vecSel.size() > 0) {
+        t_matData.resize(p_vecSel.size(), p_matRawData.cols());
+        for(qint32 i = 0; i < p_vecSel.size(); ++i)
+            t_matData.row(i) = p_matRawData.row(p_vecSel[i]);
+    } else {
+        t_matData = p_matRawData;
+    }
+
+    //Anti-alias filtering and decimation, the filter state is carried over from buffer to buffer
+    if(p_iDecimation > 1) {
+        if(m_vecAntiAliasTaps.size() != 16 * p_iDecimation + 1 || m_matAntiAliasState.rows() != t_matData.rows()) {
+            m_vecAntiAliasTaps = designAntiAliasFilter(p_iDecimation);
+            m_matAntiAliasState = MatrixXf::Zero(t_matData.rows(), m_vecAntiAliasTaps.size() - 1);
+            m_iDecimationPhase = 0;
+        }
+
+        qint32 t_iTaps = m_vecAntiAliasTaps.size();
+        qint32 t_iSamples = t_matData.cols();
+
+        MatrixXf t_matExtended(t_matData.rows(), t_iTaps - 1 + t_iSamples);
+        t_matExtended << m_matAntiAliasState, t_matData;
+
+        qint32 t_iOut = m_iDecimationPhase < t_iSamples ? (t_iSamples - 1 - m_iDecimationPhase) / p_iDecimation + 1 : 0;
+
+        MatrixXf t_matDecimated(t_matData.rows(), t_iOut);
+        for(qint32 j = 0; j < t_iOut; ++j)
+            t_matDecimated.col(j) = t_matExtended.middleCols(m_iDecimationPhase + j * p_iDecimation, t_iTaps) * m_vecAntiAliasTaps;
+
+        m_iDecimationPhase += t_iOut * p_iDecimation - t_iSamples;
+        m_matAntiAliasState = t_matExtended.rightCols(t_iTaps - 1);
+
+        t_matData = t_matDecimated;
+    }
+
+    QByteArray t_blockRawBuffer;
+    if(t_matData.size() == 0)
+        return t_blockRawBuffer;
+
+    FiffStream t_FiffStreamOut(&t_blockRawBuffer, QIODevice::WriteOnly);
+
+    if(RtRawCodec::quantizationBits(p_encoding) > 0) {
+        //Quantized, delta and Rice coded samples, see RtRawCodec. Clients which did not select it get floats
+        VectorXf t_vecLsb;
+        if(p_vecSel.size() > 0 && p_vecLsb.size() > 0) {
+            t_vecLsb.resize(p_vecSel.size());
+            for(qint32 i = 0; i < p_vecSel.size(); ++i)
+                t_vecLsb[i] = p_vecSel[i] < p_vecLsb.size() ? p_vecLsb[p_vecSel[i]] : 0.0f;
+        } else {
+            t_vecLsb = p_vecLsb;
+        }
+
+        QByteArray t_payload = RtRawCodec::encode(t_matData, t_vecLsb, RtRawCodec::quantizationBits(p_encoding));
+
+        t_FiffStreamOut << (qint32)FIFF_DATA_BUFFER;
+        t_FiffStreamOut << (qint32)FIFFT_BYTE;
+        t_FiffStreamOut << (qint32)t_payload.size();
+        t_FiffStreamOut << (qint32)FIFFV_NEXT_SEQ;
+        t_FiffStreamOut.writeRawData(t_payload.constData(), t_payload.size());
+    } else if(p_encoding == RtRawCodec::Float16) {
+        //IEEE half precision samples, tagged as FIFFT_SHORT to get the 16 bit byte order conversion
+        fiff_int_t t_iSize = (fiff_int_t)t_matData.size();
+
+        t_FiffStreamOut << (qint32)FIFF_DATA_BUFFER;
+        t_FiffStreamOut << (qint32)FIFFT_SHORT;
+        t_FiffStreamOut << (qint32)(t_iSize * 2);
+        t_FiffStreamOut << (qint32)FIFFV_NEXT_SEQ;
+
+        for(fiff_int_t i = 0; i < t_iSize; ++i) {
+            qfloat16 t_half(t_matData.data()[i]);
+            quint16 t_bits;
+            memcpy(&t_bits, &t_half, sizeof(quint16));
+            t_FiffStreamOut << t_bits;
+        }
+    } else {
+        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER, t_matData.data(), t_matData.size());
+    }
+
+    return t_blockRawBuffer;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStreamThread::takeNextBlock(QByteArray& p_blockSend, bool& p_bRawData)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    //Measurement info and client id first, they are never dropped
+    if(!m_qSendBlock.isEmpty())
+    {
+        p_blockSend = m_qSendBlock;
+        p_bRawData = false;
+        m_qSendBlock.clear();
+        return true;
+    }
+
+    p_bRawData = true;
+
+    while(!m_qQueueRawBuffer.isEmpty())
+    {
+        RawBufferItem t_item = m_qQueueRawBuffer.dequeue();
+
+        if(t_item.bControl)
+        {
+            p_blockSend = t_item.blockData;
+            return true;
+        }
+
+        m_sendStatistics.iQueued = qMax(m_sendStatistics.iQueued - 1, 0);
+        m_sendStatistics.iLagMs = m_timer.elapsed() - t_item.iTimestamp;
+        m_sendStatistics.iMaxLagMs = qMax(m_sendStatistics.iMaxLagMs, m_sendStatistics.iLagMs);
+
+        if(t_item.pMatData)
+        {
+            if(m_bResetSubState)
+            {
+                m_matAntiAliasState.resize(0, 0);
+                m_bResetSubState = false;
+            }
+
+            RowVectorXi t_vecSel = m_vecSubSel;
+            qint32 t_iDecimation = m_iSubDecimation;
+            RtRawCodec::Encoding t_encoding = m_subEncoding;
+            VectorXf t_vecLsb = m_vecChLsb;
+
+            //Encode without holding the lock
+            locker.unlock();
+            t_item.blockData = encodeRawBuffer(*t_item.pMatData, t_vecSel, t_iDecimation, t_encoding, t_vecLsb);
+            locker.relock();
+        }
+
+        //A decimated buffer might be too short to contain a sample
+        if(!t_item.blockData.isEmpty())
+        {
+            p_blockSend = t_item.blockData;
+            ++m_sendStatistics.iSent;
+            return true;
+        }
+    }
+
+    return false;
 }
 
 
@@ -227,6 +606,22 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
     {
         m_qMutex.lock();
 
+        m_qListChNames = p_fiffInfo.ch_names;
+        resolveSubscribedChannels();
+
+        //Calibration of the channels, the quantized encodings use it as step
+        m_vecChLsb.resize(p_fiffInfo.chs.size());
+        for(qint32 i = 0; i < p_fiffInfo.chs.size(); ++i)
+            m_vecChLsb[i] = p_fiffInfo.chs[i].cal * p_fiffInfo.chs[i].range;
+
+        //The client receives the info of the channels and sampling rate it subscribed to
+        FiffInfo t_fiffInfo = m_vecSubSel.size() > 0 ? p_fiffInfo.pick_info(m_vecSubSel) : p_fiffInfo;
+        if(m_iSubDecimation > 1)
+        {
+            t_fiffInfo.sfreq /= m_iSubDecimation;
+            t_fiffInfo.lowpass = qMin(t_fiffInfo.lowpass, 0.8f * t_fiffInfo.sfreq / 2.0f);
+        }
+
         FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
 
 //        qint32 init_info[2];
@@ -237,7 +632,7 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 
 //FiffStream::start_writing_raw
 
-        p_fiffInfo.writeToStream(&t_FiffStreamOut);
+        t_fiffInfo.writeToStream(&t_FiffStreamOut);
         m_qMutex.unlock();
 
 //        qDebug() << "MeasInfo Blocksize: " << m_qSendBlock.size();
@@ -249,6 +644,8 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 
 void FiffStreamThread::writeClientId()
 {
+    QMutexLocker locker(&m_qMutex);
+
     FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
 
     t_FiffStreamOut.write_int(FIFF_MNE_RT_CLIENT_ID, &m_iDataClientId);
@@ -302,8 +699,9 @@ void FiffStreamThread::run()
 
     connect(t_pParentServer, &FiffStreamServer::remitMeasInfo,
             this, &FiffStreamThread::sendMeasurementInfo);
+    //Emitted by the RawBufferForwarder thread, sendRawBuffer only locks the send queue
     connect(t_pParentServer, &FiffStreamServer::remitRawBuffer,
-            this, &FiffStreamThread::sendRawBuffer);
+            this, &FiffStreamThread::sendRawBuffer, Qt::DirectConnection);
     connect(t_pParentServer, &FiffStreamServer::startMeasFiffStreamClient,
             this, &FiffStreamThread::startMeas);
     connect(t_pParentServer, &FiffStreamServer::stopMeasFiffStreamClient,
@@ -316,6 +714,7 @@ void FiffStreamThread::run()
     }
     else
     {
+        m_peerAddress = t_qTcpSocket.peerAddress();
         printf("FiffStreamClient (assigned ID %d) accepted from\n\tIP:\t%s\n\tPort:\t%d\n\n",
                m_iDataClientId,
                QHostAddress(t_qTcpSocket.peerAddress()).toString().toUtf8().constData(),
@@ -324,32 +723,37 @@ void FiffStreamThread::run()
 
     FiffStream t_FiffStreamIn(&t_qTcpSocket);
 
+    QByteArray t_blockPending;
+    bool t_bPendingRawData = false;
+
 //    int i = 0;
     while(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState && m_bIsRunning)
     {
         //
-        // Write available data
+        // Write available data. The lock is only held while taking the next block, the socket is written without
+        // it. Once the socket or the shared memory ring has a backlog the block is kept pending and the remaining
+        // raw buffers wait in the bounded send queue.
         //
-        m_qMutex.lock();
-        qint32 t_iBlockSize = m_qSendBlock.size();
-//        qDebug() << "data available" << t_iBlockSize;
-        if(t_iBlockSize > 0)
+        while(m_bIsRunning && (!t_blockPending.isEmpty() || takeNextBlock(t_blockPending, t_bPendingRawData)))
         {
-            qint32 t_iBytesWritten = t_qTcpSocket.write(m_qSendBlock);
-//            qDebug() << ++i<< "[wrote bytes] " << t_iBytesWritten;
-            t_qTcpSocket.waitForBytesWritten();
-            if(t_iBytesWritten == t_iBlockSize)
+            if(t_bPendingRawData && m_pShmemRing)
             {
-                m_qSendBlock.clear();
+                if(t_blockPending.size() > m_pShmemRing->capacity())
+                    printf("FiffStreamClient (ID %d): raw buffer of %d bytes exceeds the shared memory ring, dropped\r\n\n", m_iDataClientId, t_blockPending.size());
+                else if(!m_pShmemRing->write(t_blockPending))
+                    break;
             }
             else
             {
-                //we have to store bytes which were not written to the socket, due to writing limit
-                //m_qSendBlock = m_qSendBlock.mid(t_iBytesWritten, t_iBlockSize-t_iBytesWritten);
-                m_qSendBlock.remove(0,t_iBytesWritten); //higher performance then mid
+                if(t_qTcpSocket.bytesToWrite() > 0)
+                    break;
+
+                t_qTcpSocket.write(t_blockPending);
+                t_qTcpSocket.waitForBytesWritten();
             }
+
+            t_blockPending.clear();
         }
-        m_qMutex.unlock();
 
         //
         // Read: Wait 10ms for incomming tag header, read and continue
@@ -381,6 +785,8 @@ void FiffStreamThread::run()
         }
     }
 
+    m_pShmemRing.clear();
+
     t_qTcpSocket.disconnectFromHost();
     if(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState)
         t_qTcpSocket.waitForDisconnected();
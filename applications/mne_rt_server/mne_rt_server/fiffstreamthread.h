@@ -43,6 +43,8 @@
 
 #include <fiff/fiff_stream.h>
 #include <fiff/fiff_info.h>
+#include <realtime/rtClient/rtshmemring.h>
+#include <realtime/rtClient/rtrawcodec.h>
 
 
 //*************************************************************************************************************
@@ -52,8 +54,12 @@
 
 #include <QThread>
 #include <QTcpSocket>
+#include <QHostAddress>
 #include <QMutex>
 #include <QSharedPointer>
+#include <QQueue>
+#include <QPair>
+#include <QElapsedTimer>
 
 
 //*************************************************************************************************************
@@ -81,6 +87,28 @@ class FiffStreamThread : public QThread
 {
     Q_OBJECT
 public:
+    //=========================================================================================================
+    /**
+    * What to do when the send queue of a client is full.
+    */
+    enum OverflowPolicy {
+        DropOldest,     /**< Discard the oldest queued raw buffer. */
+        Disconnect      /**< Disconnect the client. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Send statistics of a client.
+    */
+    struct SendStatistics {
+        qint32 iQueued;         /**< Number of raw buffers currently waiting in the send queue. */
+        qint32 iMaxQueued;      /**< Largest number of raw buffers which were waiting at the same time. */
+        qint64 iSent;           /**< Number of raw buffers written to the socket. */
+        qint64 iDropped;        /**< Number of raw buffers dropped because the send queue was full. */
+        qint64 iLagMs;          /**< Time the last sent raw buffer spent in the send queue, in ms. */
+        qint64 iMaxLagMs;       /**< Longest time a raw buffer spent in the send queue, in ms. */
+    };
+
     FiffStreamThread(qint32 id, int socketDescriptor, QObject *parent);
 
     ~FiffStreamThread();
@@ -91,6 +119,32 @@ public:
 
     inline QString getAlias();
 
+    //=========================================================================================================
+    /**
+    * Sets the size of the send queue and the policy which is applied when it is full.
+    *
+    * @param[in] iMaxQueued     the maximal number of raw buffers waiting to be sent.
+    * @param[in] policy         the overflow policy.
+    */
+    void setSendQueue(qint32 iMaxQueued, OverflowPolicy policy);
+
+    //=========================================================================================================
+    /**
+    * Returns the send statistics of this client.
+    *
+    * @return the send statistics.
+    */
+    SendStatistics getSendStatistics();
+
+    //=========================================================================================================
+    /**
+    * Returns whether the client subscribed to a channel subset, a decimated or a differently encoded stream. Such
+    * clients cannot use the raw buffers which are serialized once for all clients.
+    *
+    * @return true if the client has its own subscription.
+    */
+    bool hasSubscription();
+
 //    void deactivateRawBufferSending();
 
 
@@ -112,6 +166,39 @@ private:
     QMutex m_qMutex;
     QByteArray m_qSendBlock;
 
+    //=========================================================================================================
+    /**
+    * A raw buffer waiting in the send queue.
+    */
+    struct RawBufferItem {
+        qint64 iTimestamp;                          /**< The enqueue time. */
+        QByteArray blockData;                       /**< The serialized buffer which is shared with all other clients, empty if the client has its own subscription. */
+        QSharedPointer<Eigen::MatrixXf> pMatData;   /**< The raw buffer, encoded by the client thread according to the subscription. */
+        bool bControl;                              /**< Whether blockData is a raw data block start or end, which is never dropped. */
+    };
+
+    QQueue<RawBufferItem> m_qQueueRawBuffer;                /**< Raw buffers waiting to be sent. */
+    qint32 m_iMaxQueued;                                    /**< Maximal number of queued raw buffers. */
+    OverflowPolicy m_overflowPolicy;                        /**< What to do when the send queue is full. */
+    QElapsedTimer m_timer;                                  /**< Time base of the queue lag. */
+    SendStatistics m_sendStatistics;                        /**< The send statistics. */
+
+    QStringList m_qListSubChannels;                         /**< Subscribed channel names, empty for all channels. */
+    qint32 m_iSubDecimation;                                /**< Subscribed decimation factor, 1 for the full sampling rate. */
+    REALTIMELIB::RtRawCodec::Encoding m_subEncoding;        /**< Subscribed sample encoding. */
+    QStringList m_qListChNames;                             /**< Channel names of the last measurement info, used to resolve the subscribed channels. */
+    Eigen::VectorXf m_vecChLsb;                             /**< Calibration step (cal * range) of the channels of the last measurement info, used by the quantized encodings. */
+    Eigen::RowVectorXi m_vecSubSel;                         /**< Resolved indices of the subscribed channels, empty for all channels. */
+    bool m_bResetSubState;                                  /**< Whether the anti-alias filter state has to be reset. */
+
+    Eigen::VectorXf m_vecAntiAliasTaps;                     /**< Anti-alias lowpass of the decimation. Only used by the client thread. */
+    Eigen::MatrixXf m_matAntiAliasState;                    /**< Last input samples of the anti-alias lowpass. Only used by the client thread. */
+    qint32 m_iDecimationPhase;                              /**< Offset of the next decimated sample within the next raw buffer. Only used by the client thread. */
+
+    REALTIMELIB::RtShmemRing::SPtr m_pShmemRing;            /**< Shared memory ring the raw buffers are written to instead of the socket, NULL for TCP. Only used by the client thread. */
+    bool m_bMulticast;                                      /**< Whether the client receives the raw buffers from the multicast group, only the raw data block start and end are sent. */
+    QHostAddress m_peerAddress;                             /**< Address of the client, retransmitted datagrams are sent to it. Only used by the client thread. */
+
     bool m_bIsSendingRawBuffer;
 
     bool m_bIsRunning;
@@ -122,7 +209,39 @@ private:
 
     void sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo);
 
-    void sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
+    void sendRawBuffer(QSharedPointer<Eigen::MatrixXf> p_pMatRawData, const QByteArray& p_blockRawBuffer);
+
+    //=========================================================================================================
+    /**
+    * Resolves the subscribed channel names to indices. The mutex has to be locked.
+    */
+    void resolveSubscribedChannels();
+
+    //=========================================================================================================
+    /**
+    * Selects, decimates and serializes a raw buffer according to the subscription. Called by the client thread.
+    *
+    * @param[in] p_matRawData       the raw buffer.
+    * @param[in] p_vecSel           the subscribed channel indices, empty for all channels.
+    * @param[in] p_iDecimation      the decimation factor.
+    * @param[in] p_encoding         the sample encoding.
+    * @param[in] p_vecLsb           the calibration step of the channels, used by the quantized encodings.
+    *
+    * @return the serialized buffer, empty if the decimation did not yield any sample.
+    */
+    QByteArray encodeRawBuffer(const Eigen::MatrixXf& p_matRawData, const Eigen::RowVectorXi& p_vecSel, qint32 p_iDecimation, REALTIMELIB::RtRawCodec::Encoding p_encoding, const Eigen::VectorXf& p_vecLsb);
+
+    //=========================================================================================================
+    /**
+    * Takes the next block which is to be written to the socket. Control messages go first, then the queued raw buffers.
+    *
+    * @param[out] p_blockSend   the block to write.
+    * @param[out] p_bRawData    whether the block was taken from the raw buffer queue, which can be sent through the
+    *                           shared memory ring.
+    *
+    * @return true if a block was taken, false if there is nothing to send.
+    */
+    bool takeNextBlock(QByteArray& p_blockSend, bool& p_bRawData);
     //void readToBuffer1();
 //    void readProc(QTcpSocket& p_qTcpSocket);
 };
@@ -44,6 +44,8 @@
 
 #include "mne_rt_server.h"
 
+#include <utils/executionconfig.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -52,6 +54,7 @@
 
 #include <QtCore/QCoreApplication>
 #include <QObject>
+#include <QCommandLineParser>
 
 
 //*************************************************************************************************************
@@ -80,6 +83,15 @@ int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription("MNE Real-time Server");
+    parser.addHelpOption();
+    parser.addOption(UTILSLIB::ExecutionConfig::commandLineOption());
+    parser.process(app);
+
+    if(parser.isSet("execution") && !UTILSLIB::ExecutionConfig::configure(parser.value("execution")))
+        return 1;
+
     MNERTServer t_MneRtServer;
     QObject::connect(&t_MneRtServer, SIGNAL(closeServer()), &app, SLOT(quit()));
 
@@ -51,6 +51,11 @@ namespace RTSERVER
 
 #define MNE_RT_GET_CLIENT_ID        1       /**< Request client id at mne_rt_server */
 #define MNE_RT_SET_CLIENT_ALIAS     2       /**< Set client alias at mne_rt_server */
+#define MNE_RT_SET_CLIENT_CHANNELS  3       /**< Subscribe to a ':' separated channel list at mne_rt_server, empty for all channels */
+#define MNE_RT_SET_CLIENT_DECIMATION 4      /**< Subscribe to a decimated stream at mne_rt_server, the anti-alias filtering is done by the server */
+#define MNE_RT_SET_CLIENT_ENCODING  5       /**< Select the sample encoding at mne_rt_server, "float32" (default), "float16", or the compressed "int16" and "int24" */
+#define MNE_RT_SET_CLIENT_TRANSPORT 6       /**< Select the raw buffer transport at mne_rt_server, "tcp" (default), "shmem" for local clients or "multicast" */
+#define MNE_RT_REQUEST_RETRANSMISSION 7     /**< Request multicast datagrams again, "first:last" sequence numbers, they are sent by unicast */
 
 } // NAMESPACE
 
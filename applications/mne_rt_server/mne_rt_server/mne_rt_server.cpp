@@ -316,6 +316,15 @@ void MNERTServer::init()
     QString t_sJsonCommand =
             "{"
             "   \"commands\": {"
+            "       \"addcon\": {"
+            "           \"description\": \"Adds a connector whose stream is merged into the one of the selected connector, if a measurement is running it will be stopped.\","
+            "           \"parameters\": {"
+            "               \"ConID\": {"
+            "                   \"description\": \"Connector ID\","
+            "                   \"type\": \"int\" "
+            "               }"
+            "           }"
+            "        },"
             "       \"clist\": {"
             "           \"description\": \"Prints and sends all available FiffStreamClients.\","
             "           \"parameters\": {}"
@@ -328,6 +337,10 @@ void MNERTServer::init()
             "           \"description\": \"Prints and sends all available connectors.\","
             "           \"parameters\": {}"
             "        },"
+            "       \"handoff\": {"
+            "           \"description\": \"Prints the statistics of the raw buffer hand-off from the connector.\","
+            "           \"parameters\": {}"
+            "        },"
             "       \"help\": {"
             "           \"description\": \"Prints and sends this list.\","
             "           \"parameters\": {}"
@@ -341,6 +354,32 @@ void MNERTServer::init()
             "               }"
             "           }"
             "       },"
+            "       \"multicast\": {"
+            "           \"description\": \"Publishes the raw buffers to a UDP multicast group and prints its state, the group off stops publishing.\","
+            "           \"parameters\": {"
+            "               \"group\": {"
+            "                   \"description\": \"Multicast group address or off\","
+            "                   \"type\": \"QString\" "
+            "               },"
+            "               \"port\": {"
+            "                   \"description\": \"Port of the multicast group\","
+            "                   \"type\": \"int\" "
+            "               },"
+            "               \"ttl\": {"
+            "                   \"description\": \"Time to live of the datagrams, 1 for the local subnet\","
+            "                   \"type\": \"int\" "
+            "               }"
+            "           }"
+            "        },"
+            "       \"remcon\": {"
+            "           \"description\": \"Removes a connector added with addcon, if a measurement is running it will be stopped.\","
+            "           \"parameters\": {"
+            "               \"ConID\": {"
+            "                   \"description\": \"Connector ID\","
+            "                   \"type\": \"int\" "
+            "               }"
+            "           }"
+            "        },"
             "       \"selcon\": {"
             "           \"description\": \"Selects a new connector, if a measurement is running it will be stopped.\","
             "           \"parameters\": {"
@@ -350,6 +389,19 @@ void MNERTServer::init()
             "               }"
             "           }"
             "        },"
+            "       \"sendqueue\": {"
+            "           \"description\": \"Sets the raw buffer send queue of all FiffStreamClients.\","
+            "           \"parameters\": {"
+            "               \"size\": {"
+            "                   \"description\": \"Maximal number of queued raw buffers per client\","
+            "                   \"type\": \"int\" "
+            "               },"
+            "               \"policy\": {"
+            "                   \"description\": \"What to do with a full queue: drop (oldest buffer) or disconnect\","
+            "                   \"type\": \"QString\" "
+            "               }"
+            "           }"
+            "        },"
             "       \"start\": {"
             "           \"description\": \"Adds specified FiffStreamClient to raw data buffer receivers. If acquisition is not already started, it is triggered.\","
             "           \"parameters\": {"
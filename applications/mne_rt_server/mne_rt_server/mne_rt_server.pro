@@ -80,6 +80,9 @@ SOURCES += \
     mne_rt_server.cpp \
     fiffstreamserver.cpp \
     fiffstreamthread.cpp \
+    rawbufferforwarder.cpp \
+    multicastpublisher.cpp \
+    streammerger.cpp \
     commandserver.cpp \
     commandthread.cpp
 
@@ -91,6 +94,9 @@ HEADERS += \
     mne_rt_server.h \
     fiffstreamserver.h \
     fiffstreamthread.h \
+    rawbufferforwarder.h \
+    multicastpublisher.h \
+    streammerger.h \
     commandserver.h \
     commandthread.h \
     mne_rt_commands.h
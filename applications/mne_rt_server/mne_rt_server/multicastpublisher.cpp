@@ -0,0 +1,257 @@
+//=============================================================================================================
+/**
+* @file     multicastpublisher.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Limin Sun <liminsun@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh, Limin Sun and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Definition of the MulticastPublisher Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "multicastpublisher.h"
+
+#include <realtime/rtClient/rtmulticastfragment.h>
+
+#include <string.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTSERVER;
+using namespace REALTIMELIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+const qint32 HISTORY_SIZE = 4096;           /**< Number of datagrams kept for retransmission, a power of two. */
+const quint32 MAX_RETRANSMISSION = 1024;    /**< Maximal number of datagrams of one retransmission request. */
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MulticastPublisher::MulticastPublisher()
+: m_ringRawBuffers(64)
+, m_qVecHistory(HISTORY_SIZE)
+, m_uiNextSequence(0)
+, m_uiNextBufferId(0)
+, m_iPort(0)
+, m_iTtl(1)
+, m_iIsPublishing(0)
+{
+    m_statistics.iBuffers = 0;
+    m_statistics.iDatagrams = 0;
+    m_statistics.iRetransmitted = 0;
+    m_statistics.iUnavailable = 0;
+    m_statistics.iDropped = 0;
+}
+
+
+//*************************************************************************************************************
+
+MulticastPublisher::~MulticastPublisher()
+{
+    stop();
+}
+
+
+//*************************************************************************************************************
+
+void MulticastPublisher::start(const QHostAddress& p_group, quint16 p_iPort, qint32 p_iTtl)
+{
+    stop();
+
+    m_group = p_group;
+    m_iPort = p_iPort;
+    m_iTtl = p_iTtl > 0 ? p_iTtl : 1;
+
+    //Buffers which were queued before are outdated
+    QByteArray t_blockRawBuffer;
+    while(m_ringRawBuffers.tryPop(t_blockRawBuffer))
+        ;
+
+    m_iIsPublishing.storeRelease(1);
+    QThread::start();
+}
+
+
+//*************************************************************************************************************
+
+void MulticastPublisher::stop()
+{
+    m_iIsPublishing.storeRelease(0);
+
+    if(this->isRunning())
+        QThread::wait();
+}
+
+
+//*************************************************************************************************************
+
+void MulticastPublisher::publish(const QByteArray& p_blockRawBuffer)
+{
+    if(!isPublishing())
+        return;
+
+    if(!m_ringRawBuffers.tryPush(p_blockRawBuffer)) {
+        QMutexLocker locker(&m_qMutex);
+        ++m_statistics.iDropped;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MulticastPublisher::requestRetransmission(quint32 p_uiFirst, quint32 p_uiLast, const QHostAddress& p_address)
+{
+    if(!isPublishing() || p_uiLast - p_uiFirst >= MAX_RETRANSMISSION)
+        return;
+
+    Retransmission t_retransmission;
+    t_retransmission.uiFirst = p_uiFirst;
+    t_retransmission.uiLast = p_uiLast;
+    t_retransmission.address = p_address;
+
+    QMutexLocker locker(&m_qMutex);
+    m_qListRetransmissions.append(t_retransmission);
+}
+
+
+//*************************************************************************************************************
+
+MulticastPublisher::Statistics MulticastPublisher::getStatistics()
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_statistics;
+}
+
+
+//*************************************************************************************************************
+
+void MulticastPublisher::run()
+{
+    QUdpSocket t_qUdpSocket;
+    t_qUdpSocket.setSocketOption(QAbstractSocket::MulticastTtlOption, m_iTtl);
+
+    printf("Multicast publisher: sending raw buffers to %s:%d\n\n", m_group.toString().toUtf8().constData(), m_iPort);
+
+    QByteArray t_blockRawBuffer;
+    while(isPublishing())
+    {
+        if(m_ringRawBuffers.pop(t_blockRawBuffer, 10))
+            sendRawBuffer(t_qUdpSocket, t_blockRawBuffer);
+
+        m_qMutex.lock();
+        QList<Retransmission> t_qListRetransmissions = m_qListRetransmissions;
+        m_qListRetransmissions.clear();
+        m_qMutex.unlock();
+
+        qint64 t_iRetransmitted = 0;
+        qint64 t_iUnavailable = 0;
+        for(qint32 i = 0; i < t_qListRetransmissions.size(); ++i)
+        {
+            const Retransmission& t_retransmission = t_qListRetransmissions[i];
+            for(quint32 uiSeq = t_retransmission.uiFirst; uiSeq - t_retransmission.uiFirst <= t_retransmission.uiLast - t_retransmission.uiFirst; ++uiSeq)
+            {
+                //Only datagrams which were sent and are still kept, the history slot holds the sequence number
+                const QByteArray& t_datagram = m_qVecHistory[uiSeq & (HISTORY_SIZE - 1)];
+                RtMulticastFragment t_fragment;
+                if(m_uiNextSequence - uiSeq - 1 < (quint32)HISTORY_SIZE
+                        && t_fragment.read(t_datagram.constData(), t_datagram.size())
+                        && t_fragment.uiSequence == uiSeq)
+                {
+                    t_qUdpSocket.writeDatagram(t_datagram, t_retransmission.address, m_iPort);
+                    ++t_iRetransmitted;
+                }
+                else
+                {
+                    ++t_iUnavailable;
+                }
+            }
+        }
+
+        if(t_iRetransmitted > 0 || t_iUnavailable > 0)
+        {
+            QMutexLocker locker(&m_qMutex);
+            m_statistics.iRetransmitted += t_iRetransmitted;
+            m_statistics.iUnavailable += t_iUnavailable;
+        }
+    }
+
+    printf("Multicast publisher: stopped\n\n");
+}
+
+
+//*************************************************************************************************************
+
+void MulticastPublisher::sendRawBuffer(QUdpSocket& p_qUdpSocket, const QByteArray& p_blockRawBuffer)
+{
+    RtMulticastFragment t_fragment;
+    t_fragment.uiBufferId = m_uiNextBufferId++;
+    t_fragment.uiBufferSize = p_blockRawBuffer.size();
+    t_fragment.uiNumFragments = (t_fragment.uiBufferSize + RtMulticastFragment::MAX_PAYLOAD - 1) / RtMulticastFragment::MAX_PAYLOAD;
+
+    for(quint16 i = 0; i < t_fragment.uiNumFragments; ++i)
+    {
+        t_fragment.uiFragment = i;
+        t_fragment.uiSequence = m_uiNextSequence++;
+
+        qint32 t_iPayload = RtMulticastFragment::payloadSize(t_fragment.uiBufferSize, i);
+
+        //The history slot is reused, its memory is only allocated once
+        QByteArray& t_datagram = m_qVecHistory[t_fragment.uiSequence & (HISTORY_SIZE - 1)];
+        t_datagram.resize(RtMulticastFragment::HEADER_SIZE + t_iPayload);
+        t_fragment.write(t_datagram.data());
+        memcpy(t_datagram.data() + RtMulticastFragment::HEADER_SIZE, p_blockRawBuffer.constData() + i * RtMulticastFragment::MAX_PAYLOAD, t_iPayload);
+
+        p_qUdpSocket.writeDatagram(t_datagram, m_group, m_iPort);
+    }
+
+    QMutexLocker locker(&m_qMutex);
+    ++m_statistics.iBuffers;
+    m_statistics.iDatagrams += t_fragment.uiNumFragments;
+}
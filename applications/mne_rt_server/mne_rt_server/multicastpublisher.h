@@ -0,0 +1,234 @@
+//=============================================================================================================
+/**
+* @file     multicastpublisher.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Declaration of the MulticastPublisher Class.
+*
+*/
+
+#ifndef MULTICASTPUBLISHER_H
+#define MULTICASTPUBLISHER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/lockfreering.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+#include <QMutex>
+#include <QList>
+#include <QVector>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QUdpSocket>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTSERVER
+//=============================================================================================================
+
+namespace RTSERVER
+{
+
+//=============================================================================================================
+/**
+* Sends the serialized raw buffers to a UDP multicast group, so one acquisition reaches many machines with a
+* single stream. The buffers are split into sequence numbered fragments (see REALTIMELIB::RtMulticastFragment).
+* The last fragments are kept, a client which detected a gap requests them through its data connection and they
+* are sent to it by unicast. Measurement info and commands stay on the TCP connections.
+*
+* @brief The MulticastPublisher class publishes the raw buffers to a multicast group.
+*/
+class MulticastPublisher : public QThread
+{
+public:
+    //=========================================================================================================
+    /**
+    * Publishing statistics.
+    */
+    struct Statistics {
+        qint64 iBuffers;            /**< Number of published raw buffers. */
+        qint64 iDatagrams;          /**< Number of sent datagrams. */
+        qint64 iRetransmitted;      /**< Number of datagrams sent again on request. */
+        qint64 iUnavailable;        /**< Number of requested datagrams which were not kept anymore. */
+        qint64 iDropped;            /**< Number of raw buffers dropped because the publisher fell behind. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Creates the MulticastPublisher.
+    */
+    MulticastPublisher();
+
+    //=========================================================================================================
+    /**
+    * Destroys the MulticastPublisher.
+    */
+    ~MulticastPublisher();
+
+    //=========================================================================================================
+    /**
+    * Starts publishing, a running publisher is restarted with the new group.
+    *
+    * @param[in] p_group    The multicast group.
+    * @param[in] p_iPort    The port of the group.
+    * @param[in] p_iTtl     The time to live of the datagrams, 1 keeps them in the local subnet.
+    */
+    void start(const QHostAddress& p_group, quint16 p_iPort, qint32 p_iTtl);
+
+    //=========================================================================================================
+    /**
+    * Stops publishing.
+    */
+    void stop();
+
+    //=========================================================================================================
+    /**
+    * Returns whether raw buffers are published.
+    */
+    inline bool isPublishing() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the multicast group.
+    */
+    inline QHostAddress getGroup() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the port of the multicast group.
+    */
+    inline quint16 getPort() const;
+
+    //=========================================================================================================
+    /**
+    * Queues a serialized raw buffer for publishing without waiting. Called by the RawBufferForwarder thread.
+    *
+    * @param[in] p_blockRawBuffer   The serialized FIFF_DATA_BUFFER tag.
+    */
+    void publish(const QByteArray& p_blockRawBuffer);
+
+    //=========================================================================================================
+    /**
+    * Requests to send datagrams again. Called by the data client threads.
+    *
+    * @param[in] p_uiFirst      Sequence number of the first datagram.
+    * @param[in] p_uiLast       Sequence number of the last datagram.
+    * @param[in] p_address      The address of the client, the datagrams are sent to it at the group port.
+    */
+    void requestRetransmission(quint32 p_uiFirst, quint32 p_uiLast, const QHostAddress& p_address);
+
+    //=========================================================================================================
+    /**
+    * Returns the publishing statistics.
+    */
+    Statistics getStatistics();
+
+protected:
+    //=========================================================================================================
+    /**
+    * Sends the queued raw buffers and serves the retransmission requests until stopped.
+    */
+    virtual void run();
+
+private:
+    //=========================================================================================================
+    /**
+    * A pending retransmission request.
+    */
+    struct Retransmission {
+        quint32 uiFirst;            /**< Sequence number of the first datagram. */
+        quint32 uiLast;             /**< Sequence number of the last datagram. */
+        QHostAddress address;       /**< Address of the requesting client. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Fragments a raw buffer and sends the datagrams to the group. Publisher thread only.
+    *
+    * @param[in] p_qUdpSocket       The socket to send with.
+    * @param[in] p_blockRawBuffer   The serialized raw buffer.
+    */
+    void sendRawBuffer(QUdpSocket& p_qUdpSocket, const QByteArray& p_blockRawBuffer);
+
+    IOBUFFER::LockFreeRing<QByteArray>  m_ringRawBuffers;       /**< Raw buffers waiting to be published. */
+    QVector<QByteArray>                 m_qVecHistory;          /**< The last datagrams, indexed by their sequence number. Publisher thread only. */
+    quint32                             m_uiNextSequence;       /**< Sequence number of the next datagram. Publisher thread only. */
+    quint32                             m_uiNextBufferId;       /**< Number of the next raw buffer. Publisher thread only. */
+
+    QMutex                              m_qMutex;               /**< Guards the retransmission requests and the statistics. */
+    QList<Retransmission>               m_qListRetransmissions; /**< Pending retransmission requests. */
+    Statistics                          m_statistics;           /**< The publishing statistics. */
+
+    QHostAddress                        m_group;                /**< The multicast group. */
+    quint16                             m_iPort;                /**< The port of the group. */
+    qint32                              m_iTtl;                 /**< The time to live of the datagrams. */
+    QAtomicInt                          m_iIsPublishing;        /**< Set while raw buffers are published. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool MulticastPublisher::isPublishing() const
+{
+    return m_iIsPublishing.loadAcquire() != 0;
+}
+
+
+//*************************************************************************************************************
+
+inline QHostAddress MulticastPublisher::getGroup() const
+{
+    return m_group;
+}
+
+
+//*************************************************************************************************************
+
+inline quint16 MulticastPublisher::getPort() const
+{
+    return m_iPort;
+}
+
+} // NAMESPACE
+
+#endif // MULTICASTPUBLISHER_H
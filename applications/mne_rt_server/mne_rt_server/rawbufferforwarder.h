@@ -0,0 +1,116 @@
+//=============================================================================================================
+/**
+* @file     rawbufferforwarder.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Declaration of the RawBufferForwarder Class.
+*
+*/
+
+#ifndef RAWBUFFERFORWARDER_H
+#define RAWBUFFERFORWARDER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "IConnector.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTSERVER
+//=============================================================================================================
+
+namespace RTSERVER
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FiffStreamServer;
+
+
+//=============================================================================================================
+/**
+* Takes the raw buffers the connectors handed over through the ring and forwards them to the FiffStreamServer,
+* without going through the event loop of the main thread.
+*
+* @brief The RawBufferForwarder class is the consumer of the raw buffer hand-off ring.
+*/
+class RawBufferForwarder : public QThread
+{
+public:
+    //=========================================================================================================
+    /**
+    * Creates the RawBufferForwarder.
+    *
+    * @param[in] p_pRawBufferRing   the hand-off ring.
+    * @param[in] p_pServer          the server the raw buffers are forwarded to.
+    */
+    RawBufferForwarder(RawBufferRing::SPtr p_pRawBufferRing, FiffStreamServer* p_pServer);
+
+    //=========================================================================================================
+    /**
+    * Destroys the RawBufferForwarder.
+    */
+    ~RawBufferForwarder();
+
+    //=========================================================================================================
+    /**
+    * Shuts the ring down and waits until the raw buffers which are left were forwarded.
+    */
+    void stop();
+
+protected:
+    //=========================================================================================================
+    /**
+    * Forwards raw buffers until the ring is shut down.
+    */
+    virtual void run();
+
+private:
+    RawBufferRing::SPtr     m_pRawBufferRing;   /**< The hand-off ring. */
+    FiffStreamServer*       m_pServer;          /**< The server the raw buffers are forwarded to. */
+};
+
+} // NAMESPACE
+
+#endif // RAWBUFFERFORWARDER_H
@@ -0,0 +1,506 @@
+//=============================================================================================================
+/**
+* @file     streammerger.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     implementation of the StreamMerger Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "streammerger.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+#include <QElapsedTimer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTSERVER;
+using namespace FIFFLIB;
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+    const qint32 INFO_REQUEST_ID    = -1;       /**< Data client id of the info requests of the merger itself. */
+    const unsigned long POLL_US     = 250;      /**< Sleep when no ring had a buffer. */
+    const unsigned int POOL_SIZE    = 2 * RAW_BUFFER_RING_SIZE;     /**< Number of merged blocks kept for reuse. */
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE LOCAL CLASSES
+//=============================================================================================================
+
+/** Keeps the released merged blocks for reuse, the blocks still held by clients keep it alive. */
+class StreamMerger::BlockPool
+{
+public:
+    BlockPool() : m_freeRing(POOL_SIZE) {}
+
+    ~BlockPool()
+    {
+        MatrixXf* t_pBlock;
+        while(m_freeRing.tryPop(t_pBlock))
+            delete t_pBlock;
+    }
+
+    IOBUFFER::LockFreeRing<MatrixXf*> m_freeRing;   /**< The released blocks. */
+};
+
+
+//*************************************************************************************************************
+
+/** Deleter of the merged blocks, gives them back to the pool instead of freeing them. */
+struct StreamMerger::BlockRecycler
+{
+    QSharedPointer<BlockPool> pPool;
+
+    void operator()(MatrixXf* p_pBlock) const
+    {
+        if(!pPool->m_freeRing.tryPush(p_pBlock))
+            delete p_pBlock;
+    }
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+StreamMerger::StreamMerger(QObject* parent)
+: QThread(parent)
+, m_pBlockPool(new BlockPool)
+, m_iPendingHead(0)
+, m_iPendingCount(0)
+, m_bIsRunning(false)
+{
+    m_statistics.iMerged = 0;
+    m_statistics.iDropped = 0;
+    m_statistics.iUnderruns = 0;
+    m_statistics.iResyncs = 0;
+}
+
+
+//*************************************************************************************************************
+
+StreamMerger::~StreamMerger()
+{
+    stop();
+    clearInputs();
+}
+
+
+//*************************************************************************************************************
+
+void StreamMerger::setInputs(const QVector<IConnector*>& p_vecConnectors, RawBufferRing::SPtr p_pOutputRing)
+{
+    clearInputs();
+
+    m_pOutputRing = p_pOutputRing;
+
+    for(qint32 i = 0; i < p_vecConnectors.size(); ++i)
+    {
+        Input t_input;
+        t_input.pConnector = p_vecConnectors[i];
+        t_input.pRing = RawBufferRing::SPtr(new RawBufferRing(RAW_BUFFER_RING_SIZE));
+        t_input.bHasInfo = false;
+        t_input.iChannels = 0;
+        t_input.dSFreq = 0.0;
+
+        m_vecInputs.append(t_input);
+
+        t_input.pConnector->setRawBufferRing(t_input.pRing);
+
+        QObject::connect(t_input.pConnector, &IConnector::remitMeasInfo,
+                         this, [this, i](qint32 ID, FIFFLIB::FiffInfo p_fiffInfo) {
+            Q_UNUSED(ID);
+            onInputInfo(i, p_fiffInfo);
+        });
+    }
+}
+
+
+//*************************************************************************************************************
+
+void StreamMerger::clearInputs()
+{
+    for(qint32 i = 0; i < m_vecInputs.size(); ++i)
+    {
+        m_vecInputs[i].pConnector->disconnect(this);
+        m_vecInputs[i].pConnector->setRawBufferRing(RawBufferRing::SPtr());
+    }
+
+    QMutexLocker locker(&m_qMutex);
+    m_vecInputs.clear();
+    m_qListPendingIds.clear();
+    m_pOutputRing.clear();
+}
+
+
+//*************************************************************************************************************
+
+void StreamMerger::requestInfo(qint32 ID)
+{
+    if(!m_qListPendingIds.contains(ID))
+        m_qListPendingIds.append(ID);
+
+    //Each connector answers with its current info, the merged info is emitted with the last answer
+    for(qint32 i = 0; i < m_vecInputs.size(); ++i)
+        m_vecInputs[i].bHasInfo = false;
+
+    for(qint32 i = 0; i < m_vecInputs.size(); ++i)
+        m_vecInputs[i].pConnector->info(ID);
+}
+
+
+//*************************************************************************************************************
+
+bool StreamMerger::start()
+{
+    if(this->isRunning() || m_vecInputs.size() < 2)
+        return false;
+
+    //The merger needs the channels and sampling rates before it can merge any buffer
+    for(qint32 i = 0; i < m_vecInputs.size(); ++i)
+        if(!m_vecInputs[i].bHasInfo)
+            m_vecInputs[i].pConnector->info(INFO_REQUEST_ID);
+
+    m_qMutex.lock();
+    m_statistics.iMerged = 0;
+    m_statistics.iDropped = 0;
+    m_statistics.iUnderruns = 0;
+    m_statistics.iResyncs = 0;
+    m_qMutex.unlock();
+
+    m_bIsRunning = true;
+    QThread::start();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool StreamMerger::stop()
+{
+    if(!this->isRunning())
+        return true;
+
+    m_bIsRunning = false;
+    QThread::wait();
+
+    Statistics t_statistics = getStatistics();
+    printf("Stream merger: %lld merged, %lld dropped, %lld held samples, %lld resyncs\n",
+           t_statistics.iMerged, t_statistics.iDropped, t_statistics.iUnderruns, t_statistics.iResyncs);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+StreamMerger::Statistics StreamMerger::getStatistics() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_statistics;
+}
+
+
+//*************************************************************************************************************
+
+void StreamMerger::onInputInfo(qint32 p_iInput, const FiffInfo& p_fiffInfo)
+{
+    if(p_iInput >= m_vecInputs.size())
+        return;
+
+    m_vecInputs[p_iInput].fiffInfo = p_fiffInfo;
+    m_vecInputs[p_iInput].bHasInfo = true;
+
+    m_qMutex.lock();
+    m_vecInputs[p_iInput].iChannels = p_fiffInfo.nchan;
+    m_vecInputs[p_iInput].dSFreq = p_fiffInfo.sfreq;
+    m_qMutex.unlock();
+
+    for(qint32 i = 0; i < m_vecInputs.size(); ++i)
+        if(!m_vecInputs[i].bHasInfo)
+            return;
+
+    //
+    // The channels of the secondary connectors follow the primary channels, the primary defines the sampling rate
+    //
+    FiffInfo t_fiffInfo = m_vecInputs[0].fiffInfo;
+
+    for(qint32 k = 1; k < m_vecInputs.size(); ++k)
+    {
+        const FiffInfo& t_fiffInfoSecondary = m_vecInputs[k].fiffInfo;
+
+        for(qint32 c = 0; c < t_fiffInfoSecondary.chs.size(); ++c)
+        {
+            FiffChInfo t_chInfo = t_fiffInfoSecondary.chs[c];
+
+            if(t_fiffInfo.ch_names.contains(t_chInfo.ch_name))
+                printf("Stream merger: channel %s of %s is not unique\n", t_chInfo.ch_name.toUtf8().constData(), m_vecInputs[k].pConnector->getName());
+
+            t_chInfo.scanNo = t_fiffInfo.chs.size() + 1;
+            t_fiffInfo.chs.append(t_chInfo);
+            t_fiffInfo.ch_names.append(t_chInfo.ch_name);
+        }
+
+        for(qint32 b = 0; b < t_fiffInfoSecondary.bads.size(); ++b)
+            if(!t_fiffInfo.bads.contains(t_fiffInfoSecondary.bads[b]))
+                t_fiffInfo.bads.append(t_fiffInfoSecondary.bads[b]);
+
+        t_fiffInfo.lowpass = qMin(t_fiffInfo.lowpass, t_fiffInfoSecondary.lowpass);
+        t_fiffInfo.highpass = qMax(t_fiffInfo.highpass, t_fiffInfoSecondary.highpass);
+    }
+
+    t_fiffInfo.nchan = t_fiffInfo.chs.size();
+
+    QList<qint32> t_qListIds = m_qListPendingIds;
+    m_qListPendingIds.clear();
+
+    for(qint32 i = 0; i < t_qListIds.size(); ++i)
+        if(t_qListIds[i] != INFO_REQUEST_ID)
+            emit remitMeasInfo(t_qListIds[i], t_fiffInfo);
+}
+
+
+//*************************************************************************************************************
+
+void StreamMerger::run()
+{
+    QElapsedTimer t_timer;
+    t_timer.start();
+
+    qint32 t_iInputs = m_vecInputs.size();
+
+    m_vecChannels.fill(0, t_iInputs);
+    m_vecSFreq.fill(0.0, t_iInputs);
+
+    for(qint32 i = 0; i < t_iInputs; ++i)
+        m_vecInputs[i].aligner.prepare(0, 0.0, 0.0);
+
+    m_vecPendingBuffers.fill(QSharedPointer<MatrixXf>(), RAW_BUFFER_RING_SIZE);
+    m_vecPendingArrivalNs.fill(0, RAW_BUFFER_RING_SIZE);
+    m_iPendingHead = 0;
+    m_iPendingCount = 0;
+
+    QSharedPointer<MatrixXf> t_pMatRawBuffer;
+
+    while(m_bIsRunning)
+    {
+        bool t_bIdle = true;
+        bool t_bKnown = updateFormat();
+
+        //Take the secondary buffers first, so the alignment of the primary buffer sees the latest arrivals
+        for(qint32 i = 1; i < t_iInputs; ++i)
+        {
+            while(m_vecInputs[i].pRing->tryPop(t_pMatRawBuffer))
+            {
+                m_vecInputs[i].aligner.append(*t_pMatRawBuffer, t_timer.nsecsElapsed());
+                t_bIdle = false;
+            }
+        }
+
+        while(m_vecInputs[0].pRing->tryPop(t_pMatRawBuffer))
+        {
+            t_bIdle = false;
+
+            //The merged stream is only consistent with the merged info when all channels are known
+            if(!t_bKnown || t_pMatRawBuffer->rows() != m_vecChannels[0]) {
+                QMutexLocker locker(&m_qMutex);
+                ++m_statistics.iDropped;
+                continue;
+            }
+
+            if(m_iPendingCount == m_vecPendingBuffers.size())
+                mergePending();
+
+            qint32 t_iTail = (m_iPendingHead + m_iPendingCount) % m_vecPendingBuffers.size();
+            m_vecPendingBuffers[t_iTail] = t_pMatRawBuffer;
+            m_vecPendingArrivalNs[t_iTail] = t_timer.nsecsElapsed();
+            ++m_iPendingCount;
+        }
+
+        t_pMatRawBuffer.clear();
+
+        //
+        // A primary buffer is merged once the secondary samples of its time have arrived, i.e. after the largest
+        // latency of the secondary inputs
+        //
+        qint64 t_iLatencyNs = 0;
+        for(qint32 i = 1; i < t_iInputs; ++i)
+            t_iLatencyNs = qMax(t_iLatencyNs, m_vecInputs[i].aligner.latencyNs());
+
+        while(m_iPendingCount > 0 && t_timer.nsecsElapsed() - m_vecPendingArrivalNs[m_iPendingHead] >= t_iLatencyNs)
+        {
+            mergePending();
+            t_bIdle = false;
+        }
+
+        if(t_bIdle)
+            QThread::usleep(POLL_US);
+    }
+
+    //The held buffers are not merged any more
+    QMutexLocker locker(&m_qMutex);
+    m_statistics.iDropped += m_iPendingCount;
+
+    for(qint32 i = 0; i < m_vecPendingBuffers.size(); ++i)
+        m_vecPendingBuffers[i].clear();
+    m_iPendingCount = 0;
+}
+
+
+//*************************************************************************************************************
+
+bool StreamMerger::updateFormat()
+{
+    bool t_bKnown = true;
+
+    m_qMutex.lock();
+    for(qint32 i = 0; i < m_vecInputs.size(); ++i)
+    {
+        m_vecChannels[i] = m_vecInputs[i].iChannels;
+        m_vecSFreq[i] = m_vecInputs[i].dSFreq;
+        t_bKnown = t_bKnown && m_vecChannels[i] > 0 && m_vecSFreq[i] > 0.0;
+    }
+    m_qMutex.unlock();
+
+    for(qint32 i = 1; i < m_vecInputs.size(); ++i)
+    {
+        RtStreamAligner& t_aligner = m_vecInputs[i].aligner;
+
+        if(t_aligner.numChannels() != m_vecChannels[i] || t_aligner.sFreq() != m_vecSFreq[i] || t_aligner.refSFreq() != m_vecSFreq[0])
+            t_aligner.prepare(m_vecChannels[i], m_vecSFreq[i], m_vecSFreq[0]);
+    }
+
+    return t_bKnown;
+}
+
+
+//*************************************************************************************************************
+
+void StreamMerger::mergePending()
+{
+    const MatrixXf& t_matRawBuffer = *m_vecPendingBuffers[m_iPendingHead];
+    qint64 t_iArrivalNs = m_vecPendingArrivalNs[m_iPendingHead];
+
+    qint32 t_iRows = 0;
+    bool t_bKnown = true;
+    for(qint32 i = 0; i < m_vecChannels.size(); ++i)
+    {
+        t_iRows += m_vecChannels[i];
+        t_bKnown = t_bKnown && m_vecChannels[i] > 0;
+    }
+
+    //The format may have changed while the buffer was held
+    if(!t_bKnown || t_matRawBuffer.rows() != m_vecChannels[0])
+    {
+        m_vecPendingBuffers[m_iPendingHead].clear();
+        m_iPendingHead = (m_iPendingHead + 1) % m_vecPendingBuffers.size();
+        --m_iPendingCount;
+
+        QMutexLocker locker(&m_qMutex);
+        ++m_statistics.iDropped;
+        return;
+    }
+
+    QSharedPointer<MatrixXf> t_pMatMerged = acquireBlock(t_iRows, t_matRawBuffer.cols());
+
+    t_pMatMerged->topRows(m_vecChannels[0]) = t_matRawBuffer;
+
+    qint64 t_iHeld = 0;
+    qint64 t_iResyncs = 0;
+
+    qint32 t_iRow = m_vecChannels[0];
+    for(qint32 i = 1; i < m_vecInputs.size(); ++i)
+    {
+        bool t_bResynced = false;
+        t_iHeld += m_vecInputs[i].aligner.resample(t_iArrivalNs, *t_pMatMerged, t_iRow, t_bResynced);
+        if(t_bResynced)
+            ++t_iResyncs;
+        t_iRow += m_vecChannels[i];
+    }
+
+    m_vecPendingBuffers[m_iPendingHead].clear();
+    m_iPendingHead = (m_iPendingHead + 1) % m_vecPendingBuffers.size();
+    --m_iPendingCount;
+
+    bool t_bHandedOver = m_pOutputRing && m_pOutputRing->tryPush(t_pMatMerged);
+
+    QMutexLocker locker(&m_qMutex);
+    m_statistics.iUnderruns += t_iHeld;
+    m_statistics.iResyncs += t_iResyncs;
+    if(t_bHandedOver)
+        ++m_statistics.iMerged;
+    else
+        ++m_statistics.iDropped;
+}
+
+
+//*************************************************************************************************************
+
+QSharedPointer<MatrixXf> StreamMerger::acquireBlock(qint32 p_iRows, qint32 p_iCols)
+{
+    MatrixXf* t_pBlock = NULL;
+
+    if(!m_pBlockPool->m_freeRing.tryPop(t_pBlock))
+        t_pBlock = new MatrixXf(p_iRows, p_iCols);
+    else if(t_pBlock->rows() != p_iRows || t_pBlock->cols() != p_iCols)
+        t_pBlock->resize(p_iRows, p_iCols);
+
+    BlockRecycler t_recycler;
+    t_recycler.pPool = m_pBlockPool;
+
+    return QSharedPointer<MatrixXf>(t_pBlock, t_recycler);
+}
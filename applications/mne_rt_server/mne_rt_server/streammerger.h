@@ -0,0 +1,234 @@
+//=============================================================================================================
+/**
+* @file     streammerger.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     declaration of the StreamMerger Class.
+*
+*/
+
+#ifndef STREAMMERGER_H
+#define STREAMMERGER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "IConnector.h"
+
+#include <realtime/rtProcessing/rtstreamaligner.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+#include <QMutex>
+#include <QVector>
+#include <QList>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RTSERVER
+//=============================================================================================================
+
+namespace RTSERVER
+{
+
+//=============================================================================================================
+/**
+* Merges the streams of several simultaneously active connectors into one measurement info and one raw stream.
+* The first input is the primary connector, its sampling rate and buffer size define the merged stream. The
+* other inputs are aligned to it by the arrival time of their buffers and resampled to its clock by an
+* RtStreamAligner. The primary buffers are held back by the latency of the secondary streams, so the secondary
+* samples of the same time have arrived when a buffer is merged. Each merged buffer is written into a
+* preallocated block which returns to a pool when all clients released it.
+*
+* @brief The StreamMerger class fans the raw streams of multiple connectors in.
+*/
+class StreamMerger : public QThread
+{
+    Q_OBJECT
+
+public:
+    /** Merge statistics since the last start(). */
+    struct Statistics
+    {
+        qint64 iMerged;         /**< Number of merged buffers handed over to the FiffStreamServer. */
+        qint64 iDropped;        /**< Number of primary buffers dropped, the channels were unknown or the hand-off ring was full. */
+        qint64 iUnderruns;      /**< Number of secondary samples which had not arrived in time and were held. */
+        qint64 iResyncs;        /**< Number of times a secondary stream was aligned again. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Creates the StreamMerger.
+    *
+    * @param[in] parent     the parent object.
+    */
+    StreamMerger(QObject* parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destroys the StreamMerger.
+    */
+    ~StreamMerger();
+
+    //=========================================================================================================
+    /**
+    * Sets the connectors to merge while the merger is stopped. Each connector gets its own hand-off ring.
+    *
+    * @param[in] p_vecConnectors    the connectors, the primary connector first.
+    * @param[in] p_pOutputRing      the ring the merged buffers are handed over to the FiffStreamServer with.
+    */
+    void setInputs(const QVector<IConnector*>& p_vecConnectors, RawBufferRing::SPtr p_pOutputRing);
+
+    //=========================================================================================================
+    /**
+    * Detaches the connectors from the merger while it is stopped.
+    */
+    void clearInputs();
+
+    //=========================================================================================================
+    /**
+    * Requests the measurement info of all connectors, the merged info is emitted once all of them answered.
+    *
+    * @param[in] ID     ID of the data client to send to.
+    */
+    void requestInfo(qint32 ID);
+
+    //=========================================================================================================
+    /**
+    * Starts merging. Requests the measurement info of the connectors which did not send it yet.
+    *
+    * @return true if the merger was started.
+    */
+    bool start();
+
+    //=========================================================================================================
+    /**
+    * Stops merging and prints the statistics.
+    *
+    * @return true if successful.
+    */
+    bool stop();
+
+    //=========================================================================================================
+    /**
+    * Returns the merge statistics.
+    *
+    * @return the statistics since the last start().
+    */
+    Statistics getStatistics() const;
+
+signals:
+    void remitMeasInfo(qint32, FIFFLIB::FiffInfo);
+
+protected:
+    //=========================================================================================================
+    /**
+    * Polls the hand-off rings of the connectors and merges each primary buffer.
+    */
+    virtual void run();
+
+private:
+    class BlockPool;
+    struct BlockRecycler;
+
+    /** A merged connector. */
+    struct Input
+    {
+        IConnector*             pConnector;     /**< The connector. */
+        RawBufferRing::SPtr     pRing;          /**< The ring the connector hands its raw buffers over with. */
+        FIFFLIB::FiffInfo       fiffInfo;       /**< The measurement info of the connector. Only used by the main thread. */
+        bool                    bHasInfo;       /**< Whether fiffInfo was received. Only used by the main thread. */
+        qint32                  iChannels;      /**< Number of channels, 0 while unknown. Guarded by the mutex. */
+        double                  dSFreq;         /**< Sampling frequency. Guarded by the mutex. */
+        REALTIMELIB::RtStreamAligner aligner;   /**< Aligns a secondary input to the primary input. Only used by the merger thread. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Stores the measurement info of an input and emits the merged info when all inputs answered.
+    *
+    * @param[in] p_iInput       index of the input.
+    * @param[in] p_fiffInfo     the measurement info of the input.
+    */
+    void onInputInfo(qint32 p_iInput, const FIFFLIB::FiffInfo& p_fiffInfo);
+
+    //=========================================================================================================
+    /**
+    * Takes the channel counts and sampling frequencies of the inputs over and prepares the aligners of the
+    * secondary inputs whose format changed. Called by the merger thread.
+    *
+    * @return true if the format of all inputs is known.
+    */
+    bool updateFormat();
+
+    //=========================================================================================================
+    /**
+    * Merges the oldest held primary buffer with the secondary inputs and hands it over to the FiffStreamServer.
+    * Called by the merger thread.
+    */
+    void mergePending();
+
+    //=========================================================================================================
+    /**
+    * Takes a block of the given size from the pool, allocating it only when the pool is empty.
+    *
+    * @param[in] p_iRows    number of rows.
+    * @param[in] p_iCols    number of columns.
+    *
+    * @return the block, it returns to the pool when the last reference is released.
+    */
+    QSharedPointer<Eigen::MatrixXf> acquireBlock(qint32 p_iRows, qint32 p_iCols);
+
+    mutable QMutex              m_qMutex;           /**< Guards the channel counts, the sampling frequencies and the statistics. */
+    QVector<Input>              m_vecInputs;        /**< The merged connectors, the primary connector first. */
+    RawBufferRing::SPtr         m_pOutputRing;      /**< The ring the merged buffers are handed over with. */
+    QList<qint32>               m_qListPendingIds;  /**< Data clients waiting for the merged measurement info. */
+    QSharedPointer<BlockPool>   m_pBlockPool;       /**< Released merged blocks. */
+    QVector<qint32>             m_vecChannels;      /**< Channel counts of the inputs, the merger thread's copy. */
+    QVector<double>             m_vecSFreq;         /**< Sampling frequencies of the inputs, the merger thread's copy. */
+    QVector<QSharedPointer<Eigen::MatrixXf> > m_vecPendingBuffers;  /**< Ring of the primary buffers held back by the latency of the secondary inputs. */
+    QVector<qint64>             m_vecPendingArrivalNs;  /**< Arrival times of the held primary buffers. */
+    qint32                      m_iPendingHead;     /**< Index of the oldest held primary buffer. */
+    qint32                      m_iPendingCount;    /**< Number of held primary buffers. */
+    Statistics                  m_statistics;       /**< The merge statistics. */
+    bool                        m_bIsRunning;       /**< Whether the merger thread is running. */
+};
+
+} // NAMESPACE
+
+#endif // STREAMMERGER_H
@@ -0,0 +1,684 @@
+//=============================================================================================================
+/**
+* @file     chunkeddownload.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the implementation of the ChunkedDownload class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "chunkeddownload.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QNetworkRequest>
+#include <QTextStream>
+#include <QTimer>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define FRONT_BLOCK_SIZE        (4*1024*1024)   /**< Bytes hashed and piped per step of processFront(). */
+#define EXTRACTION_BACKLOG      (32*1024*1024)  /**< Bytes the extraction may have pending before piping pauses. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+ChunkedDownload::ChunkedDownload(QObject *parent)
+: QObject(parent)
+, m_sCacheDir(defaultCacheDir())
+, m_iConnections(4)
+, m_iChunkSize(16*1024*1024)
+, m_iMaxRetries(3)
+, m_bCached(false)
+, m_bRanges(false)
+, m_bFailed(false)
+, m_bProcessFrontPending(false)
+, m_iTotal(-1)
+, m_iNextChunk(0)
+, m_hash(QCryptographicHash::Sha256)
+, m_iFront(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+ChunkedDownload::~ChunkedDownload()
+{
+    QList<QNetworkReply*> lReplies = m_qMapReplies.keys();
+    for(int i = 0; i < lReplies.size(); ++i) {
+        lReplies[i]->disconnect(this);
+        lReplies[i]->abort();
+        lReplies[i]->deleteLater();
+    }
+
+    if(m_pExtraction) {
+        m_pExtraction->disconnect(this);
+        m_pExtraction->kill();
+        m_pExtraction->waitForFinished();
+    }
+}
+
+
+//*************************************************************************************************************
+
+QString ChunkedDownload::defaultCacheDir()
+{
+    QString sCacheDir = QString::fromLocal8Bit(qgetenv("MNE_DATA_CACHE"));
+
+    if(sCacheDir.isEmpty()) {
+        sCacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "/mne-cpp";
+    }
+
+    return sCacheDir;
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::setCacheDir(const QString& sCacheDir)
+{
+    m_sCacheDir = sCacheDir;
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::setConnections(int iConnections)
+{
+    m_iConnections = qMax(1, iConnections);
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::setChunkSize(qint64 iChunkSize)
+{
+    m_iChunkSize = qMax<qint64>(64*1024, iChunkSize);
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::setExpectedSha256(const QString& sSha256)
+{
+    m_sExpectedSha256 = sSha256.toLower();
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::setExtraction(const QString& sProgram, const QStringList& lArguments, const QString& sWorkingDir)
+{
+    m_sExtractionProgram = sProgram;
+    m_lExtractionArguments = lArguments;
+    m_sExtractionDir = sWorkingDir;
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::start(const QUrl& url)
+{
+    m_url = url;
+    m_bFailed = false;
+
+    QDir dirCache(m_sCacheDir);
+    if(!dirCache.mkpath("index")) {
+        fail(QString("Cannot create the cache %1").arg(m_sCacheDir));
+        return;
+    }
+    shareFile(m_sCacheDir);
+    shareFile(dirCache.filePath("index"));
+
+    //A known checksum addresses the file directly
+    if(!m_sExpectedSha256.isEmpty() && QFile::exists(dirCache.filePath(m_sExpectedSha256 + ".tar.gz"))) {
+        useCachedFile(dirCache.filePath(m_sExpectedSha256 + ".tar.gz"));
+        return;
+    }
+
+    emit message("Connecting...");
+
+    QNetworkReply* pReply = m_qNetworkManager.head(QNetworkRequest(m_url));
+    connect(pReply, &QNetworkReply::finished, this, &ChunkedDownload::onHeadFinished);
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::onHeadFinished()
+{
+    QNetworkReply* pReply = qobject_cast<QNetworkReply*>(sender());
+    pReply->deleteLater();
+
+    //Servers which do not answer HEAD requests, e.g. FTP, are downloaded with one request
+    QString sVersion;
+    m_iTotal = -1;
+    m_bRanges = false;
+
+    if(pReply->error() == QNetworkReply::NoError) {
+        bool bOk = false;
+        qint64 iLength = pReply->header(QNetworkRequest::ContentLengthHeader).toLongLong(&bOk);
+        if(bOk && iLength > 0) {
+            m_iTotal = iLength;
+        }
+
+        m_bRanges = m_iTotal > 0 && pReply->rawHeader("Accept-Ranges").trimmed().toLower() == "bytes";
+        sVersion = QString::fromLatin1(pReply->rawHeader("ETag") + pReply->rawHeader("Last-Modified"));
+    }
+
+    //The same URL, size and version share one cache entry
+    QByteArray baKey = m_url.toEncoded() + "\n" + QByteArray::number(m_iTotal) + "\n" + sVersion.toLatin1();
+    m_sKey = QString::fromLatin1(QCryptographicHash::hash(baKey, QCryptographicHash::Sha1).toHex());
+
+    QDir dirCache(m_sCacheDir);
+    QFile fileIndex(dirCache.filePath("index/" + m_sKey));
+
+    if(fileIndex.open(QIODevice::ReadOnly)) {
+        QString sSha256 = QString::fromLatin1(fileIndex.readAll()).trimmed();
+        fileIndex.close();
+
+        if(!sSha256.isEmpty() && QFile::exists(dirCache.filePath(sSha256 + ".tar.gz"))) {
+            useCachedFile(dirCache.filePath(sSha256 + ".tar.gz"));
+            return;
+        }
+    }
+
+    acquireLock();
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::acquireLock()
+{
+    QDir dirCache(m_sCacheDir);
+
+    m_pLockFile = QSharedPointer<QLockFile>(new QLockFile(dirCache.filePath(m_sKey + ".lock")));
+    m_pLockFile->setStaleLockTime(0);
+
+    if(!m_pLockFile->tryLock(0)) {
+        emit message("Waiting for another download of the same data...");
+        QTimer::singleShot(1000, this, &ChunkedDownload::acquireLock);
+        return;
+    }
+    shareFile(m_pLockFile->fileName());
+
+    //Another process may have finished the file in the meantime
+    QFile fileIndex(dirCache.filePath("index/" + m_sKey));
+    if(fileIndex.open(QIODevice::ReadOnly)) {
+        QString sSha256 = QString::fromLatin1(fileIndex.readAll()).trimmed();
+        fileIndex.close();
+
+        if(!sSha256.isEmpty() && QFile::exists(dirCache.filePath(sSha256 + ".tar.gz"))) {
+            m_pLockFile->unlock();
+            useCachedFile(dirCache.filePath(sSha256 + ".tar.gz"));
+            return;
+        }
+    }
+
+    int iChunks = m_bRanges ? int((m_iTotal + m_iChunkSize - 1) / m_iChunkSize) : 1;
+    m_qVecChunkReceived.fill(0, iChunks);
+    m_qVecChunkRetries.fill(0, iChunks);
+    m_iNextChunk = 0;
+
+    //Resume the finished chunks of an earlier run, which is only possible with ranged requests
+    m_qFile.setFileName(dirCache.filePath(m_sKey + ".part"));
+    m_qFileChunks.setFileName(dirCache.filePath(m_sKey + ".part.chunks"));
+
+    int iResumed = 0;
+    if(m_bRanges && m_qFile.exists() && m_qFile.size() == m_iTotal && m_qFileChunks.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QTextStream in(&m_qFileChunks);
+        while(!in.atEnd()) {
+            bool bOk = false;
+            int iChunk = in.readLine().toInt(&bOk);
+            if(bOk && iChunk >= 0 && iChunk < iChunks && m_qVecChunkReceived[iChunk] == 0) {
+                m_qVecChunkReceived[iChunk] = qMin(m_iChunkSize, m_iTotal - iChunk * m_iChunkSize);
+                ++iResumed;
+            }
+        }
+        m_qFileChunks.close();
+    } else {
+        m_qFile.remove();
+        m_qFileChunks.remove();
+    }
+
+    if(!m_qFile.open(QIODevice::ReadWrite | QIODevice::Unbuffered)
+            || !m_qFileChunks.open(QIODevice::Append | QIODevice::Text)
+            || (m_bRanges && !m_qFile.resize(m_iTotal))) {
+        fail(QString("Cannot write to the cache %1").arg(m_sCacheDir));
+        return;
+    }
+    shareFile(m_qFile.fileName());
+    shareFile(m_qFileChunks.fileName());
+
+    m_bCached = false;
+    m_hash.reset();
+    m_iFront = 0;
+
+    if(!m_sExtractionProgram.isEmpty()) {
+        m_pExtraction = QSharedPointer<QProcess>(new QProcess);
+        m_pExtraction->setWorkingDirectory(m_sExtractionDir);
+        m_pExtraction->setProcessChannelMode(QProcess::ForwardedChannels);
+        connect(m_pExtraction.data(), &QProcess::bytesWritten, this, &ChunkedDownload::processFront);
+        connect(m_pExtraction.data(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                this, &ChunkedDownload::onExtractionFinished);
+        m_pExtraction->start(m_sExtractionProgram, m_lExtractionArguments);
+    }
+
+    if(iResumed > 0) {
+        emit message(QString("Resuming download, %1 of %2 chunks are available...").arg(iResumed).arg(iChunks));
+    } else {
+        emit message(QString("Downloading with %1 connections...").arg(m_bRanges ? qMin(m_iConnections, iChunks) : 1));
+    }
+
+    requestChunks();
+    processFront();
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::useCachedFile(const QString& sFilePath)
+{
+    emit message("Using the data of the cache...");
+
+    m_qFile.setFileName(sFilePath);
+    if(!m_qFile.open(QIODevice::ReadOnly)) {
+        fail(QString("Cannot read %1").arg(sFilePath));
+        return;
+    }
+
+    //The whole file is available, it is verified and extracted like a finished download
+    m_bCached = true;
+    m_bRanges = false;
+    m_iTotal = m_qFile.size();
+    m_qVecChunkReceived.fill(m_iTotal, 1);
+    m_qVecChunkRetries.fill(0, 1);
+    m_iNextChunk = 1;
+    m_hash.reset();
+    m_iFront = 0;
+
+    if(!m_sExtractionProgram.isEmpty()) {
+        m_pExtraction = QSharedPointer<QProcess>(new QProcess);
+        m_pExtraction->setWorkingDirectory(m_sExtractionDir);
+        m_pExtraction->setProcessChannelMode(QProcess::ForwardedChannels);
+        connect(m_pExtraction.data(), &QProcess::bytesWritten, this, &ChunkedDownload::processFront);
+        connect(m_pExtraction.data(), static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                this, &ChunkedDownload::onExtractionFinished);
+        m_pExtraction->start(m_sExtractionProgram, m_lExtractionArguments);
+    }
+
+    processFront();
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::requestChunks()
+{
+    while(!m_bFailed && m_qMapReplies.size() < (m_bRanges ? m_iConnections : 1) && m_iNextChunk < m_qVecChunkReceived.size()) {
+        int iChunk = m_iNextChunk++;
+
+        qint64 iChunkBegin = iChunk * m_iChunkSize;
+        qint64 iChunkSize = m_bRanges ? qMin(m_iChunkSize, m_iTotal - iChunkBegin) : -1;
+
+        if(iChunkSize > 0 && m_qVecChunkReceived[iChunk] == iChunkSize) {
+            continue;
+        }
+
+        //A chunk is always requested as a whole, data of an interrupted request is overwritten
+        m_qVecChunkReceived[iChunk] = 0;
+
+        QNetworkRequest request(m_url);
+        if(m_bRanges) {
+            request.setRawHeader("Range", QString("bytes=%1-%2").arg(iChunkBegin).arg(iChunkBegin + iChunkSize - 1).toLatin1());
+        }
+
+        QNetworkReply* pReply = m_qNetworkManager.get(request);
+        m_qMapReplies.insert(pReply, iChunk);
+
+        connect(pReply, &QNetworkReply::readyRead, this, &ChunkedDownload::onReplyReadyRead);
+        connect(pReply, &QNetworkReply::finished, this, &ChunkedDownload::onReplyFinished);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::onReplyReadyRead()
+{
+    QNetworkReply* pReply = qobject_cast<QNetworkReply*>(sender());
+    if(!pReply || !m_qMapReplies.contains(pReply) || m_bFailed) {
+        return;
+    }
+
+    int iChunk = m_qMapReplies.value(pReply);
+
+    //A server which ignores the range sends the whole file, which only fits the first chunk
+    if(m_bRanges && pReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206) {
+        fail("The server does not support ranged requests as announced");
+        return;
+    }
+
+    QByteArray baData = pReply->readAll();
+    qint64 iLimit = m_bRanges ? qMin(m_iChunkSize, m_iTotal - iChunk * m_iChunkSize) : -1;
+
+    if(iLimit >= 0 && m_qVecChunkReceived[iChunk] + baData.size() > iLimit) {
+        fail("The server sent more data than requested");
+        return;
+    }
+
+    if(!m_qFile.seek(iChunk * m_iChunkSize + m_qVecChunkReceived[iChunk]) || m_qFile.write(baData) != baData.size()) {
+        fail(QString("Cannot write to the cache %1").arg(m_sCacheDir));
+        return;
+    }
+
+    m_qVecChunkReceived[iChunk] += baData.size();
+
+    qint64 iReceived = 0;
+    for(int i = 0; i < m_qVecChunkReceived.size(); ++i) {
+        iReceived += m_qVecChunkReceived[i];
+    }
+    emit progress(iReceived, m_iTotal);
+
+    processFront();
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::onReplyFinished()
+{
+    QNetworkReply* pReply = qobject_cast<QNetworkReply*>(sender());
+    if(!pReply || !m_qMapReplies.contains(pReply)) {
+        return;
+    }
+
+    onReplyReadyRead();
+
+    int iChunk = m_qMapReplies.take(pReply);
+    pReply->deleteLater();
+
+    if(m_bFailed) {
+        return;
+    }
+
+    qint64 iChunkSize = m_bRanges ? qMin(m_iChunkSize, m_iTotal - iChunk * m_iChunkSize) : m_qVecChunkReceived[iChunk];
+
+    if(pReply->error() != QNetworkReply::NoError || m_qVecChunkReceived[iChunk] != iChunkSize) {
+        //Only ranged chunks can be repeated without restarting the whole file
+        if(!m_bRanges || ++m_qVecChunkRetries[iChunk] > m_iMaxRetries) {
+            fail(QString("Download failed: %1").arg(pReply->errorString()));
+            return;
+        }
+
+        qWarning() << "ChunkedDownload::onReplyFinished - Retrying chunk" << iChunk << ":" << pReply->errorString();
+        m_iNextChunk = qMin(m_iNextChunk, iChunk);
+        m_qVecChunkReceived[iChunk] = 0;
+    } else {
+        if(!m_bRanges) {
+            m_iTotal = iChunkSize;
+        }
+
+        m_qFileChunks.write(QByteArray::number(iChunk) + "\n");
+        m_qFileChunks.flush();
+    }
+
+    requestChunks();
+    processFront();
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::processFront()
+{
+    m_bProcessFrontPending = false;
+
+    if(m_bFailed) {
+        return;
+    }
+
+    qint64 iEnd = frontEnd();
+    qint64 iStepEnd = qMin(iEnd, m_iFront + FRONT_BLOCK_SIZE);
+
+    while(m_iFront < iStepEnd) {
+        //Pause while the extraction is behind, it continues with the next bytesWritten
+        if(m_pExtraction && m_pExtraction->bytesToWrite() > EXTRACTION_BACKLOG) {
+            return;
+        }
+
+        if(!m_qFile.seek(m_iFront)) {
+            fail("Cannot read the downloaded data");
+            return;
+        }
+
+        QByteArray baData = m_qFile.read(qMin<qint64>(1024*1024, iStepEnd - m_iFront));
+        if(baData.isEmpty()) {
+            fail("Cannot read the downloaded data");
+            return;
+        }
+
+        m_hash.addData(baData);
+        if(m_pExtraction) {
+            m_pExtraction->write(baData);
+        }
+
+        m_iFront += baData.size();
+    }
+
+    if(m_iFront < iEnd) {
+        //Large available fronts, e.g. of resumed or cached files, are processed in steps to keep the events going
+        if(!m_bProcessFrontPending) {
+            m_bProcessFrontPending = true;
+            QTimer::singleShot(0, this, &ChunkedDownload::processFront);
+        }
+        return;
+    }
+
+    if(m_qMapReplies.isEmpty() && m_iNextChunk >= m_qVecChunkReceived.size() && m_iTotal >= 0 && m_iFront == m_iTotal) {
+        complete();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::complete()
+{
+    QString sSha256 = QString::fromLatin1(m_hash.result().toHex());
+    QString sFilePath = m_qFile.fileName();
+
+    m_qFile.close();
+    m_qFileChunks.close();
+
+    QDir dirCache(m_sCacheDir);
+
+    if(!m_sExpectedSha256.isEmpty() && sSha256 != m_sExpectedSha256) {
+        QFile::remove(sFilePath);
+        m_qFileChunks.remove();
+
+        fail(QString("Checksum mismatch, expected %1 but got %2").arg(m_sExpectedSha256).arg(sSha256));
+        return;
+    }
+
+    if(!m_bCached) {
+        //Content addressed, another process may already have stored the same file
+        QString sCachedFilePath = dirCache.filePath(sSha256 + ".tar.gz");
+
+        if(QFile::exists(sCachedFilePath)) {
+            QFile::remove(sFilePath);
+        } else if(!QFile::rename(sFilePath, sCachedFilePath)) {
+            fail(QString("Cannot store the download in the cache %1").arg(m_sCacheDir));
+            return;
+        }
+        sFilePath = sCachedFilePath;
+        m_qFileChunks.remove();
+
+        QFile fileIndex(dirCache.filePath("index/" + m_sKey));
+        if(fileIndex.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fileIndex.write(sSha256.toLatin1() + "\n");
+            fileIndex.close();
+            shareFile(fileIndex.fileName());
+        }
+
+        if(m_pLockFile) {
+            m_pLockFile->unlock();
+        }
+
+        m_bCached = true;
+        m_qFile.setFileName(sFilePath);
+    }
+
+    if(m_pExtraction) {
+        emit message("Finishing the extraction...");
+        m_pExtraction->closeWriteChannel();
+        return;
+    }
+
+    emit finished(true, sFilePath);
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::onExtractionFinished(int iExitCode, QProcess::ExitStatus exitStatus)
+{
+    QSharedPointer<QProcess> pExtraction = m_pExtraction;
+    m_pExtraction.clear();
+
+    if(m_bFailed) {
+        return;
+    }
+
+    if(exitStatus != QProcess::NormalExit || iExitCode != 0) {
+        fail(QString("Extraction failed with exit code %1").arg(iExitCode));
+        return;
+    }
+
+    //The extraction may only end before all data was piped if the archive is broken
+    if(!m_bCached || m_qFile.isOpen()) {
+        fail("Extraction ended before the end of the data");
+        return;
+    }
+
+    emit finished(true, m_qFile.fileName());
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::fail(const QString& sReason)
+{
+    if(m_bFailed) {
+        return;
+    }
+    m_bFailed = true;
+
+    qWarning() << "ChunkedDownload -" << sReason;
+
+    QList<QNetworkReply*> lReplies = m_qMapReplies.keys();
+    m_qMapReplies.clear();
+    for(int i = 0; i < lReplies.size(); ++i) {
+        lReplies[i]->disconnect(this);
+        lReplies[i]->abort();
+        lReplies[i]->deleteLater();
+    }
+
+    if(m_pExtraction) {
+        m_pExtraction->disconnect(this);
+        m_pExtraction->kill();
+        m_pExtraction->waitForFinished();
+        m_pExtraction.clear();
+    }
+
+    m_qFile.close();
+    m_qFileChunks.close();
+
+    if(m_pLockFile) {
+        m_pLockFile->unlock();
+    }
+
+    emit message(sReason);
+    emit finished(false, QString());
+}
+
+
+//*************************************************************************************************************
+
+qint64 ChunkedDownload::frontEnd() const
+{
+    qint64 iEnd = 0;
+
+    for(int i = 0; i < m_qVecChunkReceived.size(); ++i) {
+        iEnd += m_qVecChunkReceived[i];
+
+        qint64 iChunkSize = m_bRanges ? qMin(m_iChunkSize, m_iTotal - i * m_iChunkSize) : -1;
+        if(m_qVecChunkReceived[i] != iChunkSize) {
+            break;
+        }
+    }
+
+    return iEnd;
+}
+
+
+//*************************************************************************************************************
+
+void ChunkedDownload::shareFile(const QString& sFilePath)
+{
+    QFile::Permissions permissions = QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup | QFile::WriteGroup | QFile::ReadOther | QFile::WriteOther;
+
+    if(QFileInfo(sFilePath).isDir()) {
+        permissions |= QFile::ExeOwner | QFile::ExeGroup | QFile::ExeOther;
+    }
+
+    QFile::setPermissions(sFilePath, permissions);
+}
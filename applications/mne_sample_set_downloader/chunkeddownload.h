@@ -0,0 +1,286 @@
+//=============================================================================================================
+/**
+* @file     chunkeddownload.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the ChunkedDownload class.
+*
+*/
+
+#ifndef CHUNKEDDOWNLOAD_H
+#define CHUNKEDDOWNLOAD_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QCryptographicHash>
+#include <QLockFile>
+#include <QProcess>
+#include <QFile>
+#include <QUrl>
+#include <QVector>
+#include <QMap>
+#include <QSharedPointer>
+
+
+//=============================================================================================================
+/**
+* Downloads a file with several parallel ranged requests into a cache which several users can share.
+*
+* The cache holds the finished files under their SHA-256 checksum (<sha256>.tar.gz) and an index which maps the
+* URL, size and version of a download to that checksum, so a file is only downloaded once per cache. Unfinished
+* downloads are kept as <key>.part together with the list of finished chunks and are resumed by the next run,
+* servers without range support are downloaded with one sequential request. The finished front of the file is
+* hashed and optionally piped into an extraction process while the remaining chunks are still downloading.
+*
+* @brief Parallel resumable chunked download with a content addressed cache.
+*/
+class ChunkedDownload : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef QSharedPointer<ChunkedDownload> SPtr;            /**< Shared pointer type for ChunkedDownload. */
+    typedef QSharedPointer<const ChunkedDownload> ConstSPtr; /**< Const shared pointer type for ChunkedDownload. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a ChunkedDownload.
+    *
+    * @param[in] parent     The parent object.
+    */
+    explicit ChunkedDownload(QObject *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destroys the ChunkedDownload. An unfinished download stays in the cache and is resumed later on.
+    */
+    ~ChunkedDownload();
+
+    //=========================================================================================================
+    /**
+    * Returns the default cache directory, which is $MNE_DATA_CACHE if set and the generic cache location
+    * otherwise.
+    *
+    * @return the cache directory.
+    */
+    static QString defaultCacheDir();
+
+    //=========================================================================================================
+    /**
+    * Sets the directory of the cache.
+    *
+    * @param[in] sCacheDir      The cache directory.
+    */
+    void setCacheDir(const QString& sCacheDir);
+
+    //=========================================================================================================
+    /**
+    * Sets the number of parallel requests.
+    *
+    * @param[in] iConnections   The number of requests, at least 1.
+    */
+    void setConnections(int iConnections);
+
+    //=========================================================================================================
+    /**
+    * Sets the size of one chunk.
+    *
+    * @param[in] iChunkSize     The size in bytes.
+    */
+    void setChunkSize(qint64 iChunkSize);
+
+    //=========================================================================================================
+    /**
+    * Sets the expected checksum. A file with another checksum is rejected and removed from the cache.
+    *
+    * @param[in] sSha256        The SHA-256 checksum as hex string, empty to accept any file.
+    */
+    void setExpectedSha256(const QString& sSha256);
+
+    //=========================================================================================================
+    /**
+    * Sets the command the file is piped into while it is downloaded, e.g. "tar" "-xzf" "-".
+    *
+    * @param[in] sProgram       The program, empty to not extract the file.
+    * @param[in] lArguments     The arguments.
+    * @param[in] sWorkingDir    The working directory of the program.
+    */
+    void setExtraction(const QString& sProgram, const QStringList& lArguments, const QString& sWorkingDir);
+
+    //=========================================================================================================
+    /**
+    * Starts the download or takes the file from the cache.
+    *
+    * @param[in] url            The location of the file.
+    */
+    void start(const QUrl& url);
+
+signals:
+    //=========================================================================================================
+    /**
+    * Emitted when new data arrived.
+    *
+    * @param[in] iReceived      The number of bytes which are available, including resumed chunks.
+    * @param[in] iTotal         The size of the file, -1 if unknown.
+    */
+    void progress(qint64 iReceived, qint64 iTotal);
+
+    //=========================================================================================================
+    /**
+    * Emitted with status information for the user.
+    *
+    * @param[in] sMessage       The status information.
+    */
+    void message(const QString& sMessage);
+
+    //=========================================================================================================
+    /**
+    * Emitted when the file is available and extracted.
+    *
+    * @param[in] bSuccess       Whether the file was downloaded, verified and extracted.
+    * @param[in] sFilePath      The file in the cache, empty on failure.
+    */
+    void finished(bool bSuccess, const QString& sFilePath);
+
+private:
+    //=========================================================================================================
+    /**
+    * Evaluates the size, range support and version reported by the server.
+    */
+    void onHeadFinished();
+
+    //=========================================================================================================
+    /**
+    * Takes the lock of the partial download and resumes or starts it. Retries while another process holds it.
+    */
+    void acquireLock();
+
+    //=========================================================================================================
+    /**
+    * Continues with a file which was found in the cache.
+    *
+    * @param[in] sFilePath      The file in the cache.
+    */
+    void useCachedFile(const QString& sFilePath);
+
+    //=========================================================================================================
+    /**
+    * Starts requests for pending chunks until the number of connections is reached.
+    */
+    void requestChunks();
+
+    //=========================================================================================================
+    /**
+    * Writes the data of a reply to its position in the partial file.
+    */
+    void onReplyReadyRead();
+
+    //=========================================================================================================
+    /**
+    * Completes or retries the chunk of a reply.
+    */
+    void onReplyFinished();
+
+    //=========================================================================================================
+    /**
+    * Hashes the newly completed front of the file and pipes it into the extraction.
+    */
+    void processFront();
+
+    //=========================================================================================================
+    /**
+    * Moves the verified file into the cache and waits for the extraction.
+    */
+    void complete();
+
+    //=========================================================================================================
+    /**
+    * Is called when the extraction finished.
+    */
+    void onExtractionFinished(int iExitCode, QProcess::ExitStatus exitStatus);
+
+    //=========================================================================================================
+    /**
+    * Stops all requests and the extraction and reports the failure.
+    *
+    * @param[in] sReason        The reason of the failure.
+    */
+    void fail(const QString& sReason);
+
+    //=========================================================================================================
+    /**
+    * Returns the end of the finished front of the file.
+    */
+    qint64 frontEnd() const;
+
+    //=========================================================================================================
+    /**
+    * Makes a file of the cache readable and writable for all users of the cache.
+    */
+    static void shareFile(const QString& sFilePath);
+
+    QNetworkAccessManager           m_qNetworkManager;      /**< Sends the requests. */
+    QUrl                            m_url;                  /**< Location of the file. */
+    QString                         m_sCacheDir;            /**< Directory of the cache. */
+    QString                         m_sKey;                 /**< Cache key of the URL, size and version. */
+    QString                         m_sExpectedSha256;      /**< Expected checksum, empty to accept any. */
+    int                             m_iConnections;         /**< Number of parallel requests. */
+    qint64                          m_iChunkSize;           /**< Size of one chunk in bytes. */
+    int                             m_iMaxRetries;          /**< Number of retries of a failed chunk. */
+
+    QString                         m_sExtractionProgram;   /**< Program the file is piped into. */
+    QStringList                     m_lExtractionArguments; /**< Arguments of the extraction program. */
+    QString                         m_sExtractionDir;       /**< Working directory of the extraction program. */
+    QSharedPointer<QProcess>        m_pExtraction;          /**< The running extraction. */
+
+    QSharedPointer<QLockFile>       m_pLockFile;            /**< Keeps other processes from writing the same partial file. */
+    QFile                           m_qFile;                /**< The partial file or the cached file. */
+    QFile                           m_qFileChunks;          /**< List of finished chunks of the partial file. */
+    bool                            m_bCached;              /**< Whether m_qFile already is in the cache. */
+    bool                            m_bRanges;              /**< Whether the server supports ranged requests. */
+    bool                            m_bFailed;              /**< Whether the download failed. */
+    bool                            m_bProcessFrontPending; /**< Whether processFront() is scheduled. */
+
+    qint64                          m_iTotal;               /**< Size of the file, -1 if unknown. */
+    QVector<qint64>                 m_qVecChunkReceived;    /**< Number of received bytes per chunk. */
+    QVector<int>                    m_qVecChunkRetries;     /**< Number of retries per chunk. */
+    int                             m_iNextChunk;           /**< First chunk which may still need a request. */
+    QMap<QNetworkReply*, int>       m_qMapReplies;          /**< The running requests and their chunks. */
+
+    QCryptographicHash              m_hash;                 /**< Checksum of the processed front. */
+    qint64                          m_iFront;               /**< End of the processed front. */
+};
+
+#endif // CHUNKEDDOWNLOAD_H
@@ -118,27 +118,18 @@ void Downloader::onDownloadButtonClicked()
     ui->m_progressBar->show();
     ui->m_label->setText("DOWNLOADING FILES...");
 
-    QNetworkAccessManager *manager = new QNetworkAccessManager;
     QString url = "ftp://surfer.nmr.mgh.harvard.edu/pub/data/MNE-sample-data-processed.tar.gz"; //"ftp://surfer.nmr.mgh.harvard.edu/pub/data/test_data.tar.gz";
-    m_qReply = QSharedPointer<QNetworkReply> (manager->get(QNetworkRequest(url)));
 
-    connect(m_qReply.data(), &QNetworkReply::readyRead, this, &Downloader::dataReady);
-    connect(m_qReply.data(), &QNetworkReply::finished, this, &Downloader::downloadFinished);
+    connect(&m_chunkedDownload, &ChunkedDownload::progress, this, &Downloader::downloadProgress);
+    connect(&m_chunkedDownload, &ChunkedDownload::message, ui->m_label, &QLabel::setText);
+    connect(&m_chunkedDownload, &ChunkedDownload::finished, this, &Downloader::downloadFinished);
 
-    if (m_qFile.fileName() != "sample.tar.gz") {
-        m_qFile.setFileName("sample.tar.gz");
-    }
-
-    if(!m_qFile.open(QIODevice::Append)) {
-        qDebug() << "Downloader::onDownloadButtonClicked - Cannot open file";
-    }
-
-    connect(m_qReply.data(), &QNetworkReply::downloadProgress, this, &Downloader::downloadProgress);
-    QEventLoop loop;
-    connect(m_qReply.data(), &QNetworkReply::finished, &loop, &QEventLoop::quit);
-    loop.exec();
+#ifndef _WIN32
+    //Extract while downloading
+    m_chunkedDownload.setExtraction("tar", QStringList() << "-xzf" << "-", m_qCurrentPath);
+#endif
 
-    return;
+    m_chunkedDownload.start(QUrl(url));
 }
 
 //*************************************************************************************************************
@@ -170,28 +161,31 @@ void Downloader::onExitButtonClicked()
 
 //*************************************************************************************************************
 
-void Downloader::dataReady()
-{
-    if (m_qReply != NULL)
-        m_qFile.write(m_qReply->readAll());
-    return;
-}
-
 void Downloader::downloadProgress(qint64 recieved, qint64 total)
 {
-    ui->m_progressBar->setMaximum(total);
-    ui->m_progressBar->setValue(recieved);
+    //Unknown sizes show a busy indicator
+    ui->m_progressBar->setMaximum(total > 0 ? 1000 : 0);
+    ui->m_progressBar->setValue(total > 0 ? int(1000 * recieved / total) : 0);
 }
 
 //*************************************************************************************************************
 
 #ifdef _WIN32
 
-void Downloader::downloadFinished()
+void Downloader::downloadFinished(bool bSuccess, const QString& sFilePath)
 {
-    if (m_qReply != NULL)
-        m_qFile.write(m_qReply->readAll());
-    m_qFile.close();
+    if (!bSuccess) {
+        ui->m_downloadButton->setEnabled(true);
+        return;
+    }
+
+    //7zip extracts the local copy of the cached archive
+    m_qFile.setFileName("sample.tar.gz");
+    m_qFile.remove();
+    if (!QFile::copy(sFilePath, m_qFile.fileName())) {
+        ui->m_label->setText("Cannot copy the archive out of the cache");
+        return;
+    }
     m_bDownloadStatus = true;
     QString zipPath ="\"" + QString (ui->m_filePath->text()) + "\"";
     ui->m_progressBar->setEnabled(false);
@@ -266,13 +260,19 @@ void Downloader::readyToExtract(bool stat)
 
 //*************************************************************************************************************
 
-void Downloader::downloadFinished()
+void Downloader::downloadFinished(bool bSuccess, const QString& sFilePath)
 {
-    if (m_qReply != NULL)
-        m_qFile.write(m_qReply->readAll());
+    Q_UNUSED(sFilePath);
+
+    if (!bSuccess) {
+        ui->m_downloadButton->setEnabled(true);
+        return;
+    }
+
+    //The archive was extracted while it was downloaded
     m_bDownloadStatus = true;
     ui->m_progressBar->setEnabled(false);
-    readyToExtract(m_bDownloadStatus);
+    done();
     return;
 }
 
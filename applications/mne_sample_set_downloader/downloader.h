@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "extract.h"
+#include "chunkeddownload.h"
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -123,15 +124,13 @@ private:
 
     //=========================================================================================================
     /**
-    * Calls the extract class once the download is finished.
-    */
-    void downloadFinished();
-
-    //=========================================================================================================
-    /**
-    * Writes data onto harddrive once it arrives.
+    * Calls the extract class once the download is finished. On Linux & OSX the data was already extracted while
+    * it was downloaded.
+    *
+    * @param[in] bSuccess   True if the archive was downloaded, verified and, where streamed, extracted
+    * @param[in] sFilePath  Path of the archive in the cache
     */
-    void dataReady();
+    void downloadFinished(bool bSuccess, const QString& sFilePath);
 
     //=========================================================================================================
     /**
@@ -144,7 +143,7 @@ private:
     void downloadProgress(qint64 recieved, qint64 total);
 
     Ui::Downloader *ui;                                     /**< Sets up the GUI. */
-    QSharedPointer<QNetworkReply>   m_qReply;               /**< Networkreply */
+    ChunkedDownload                 m_chunkedDownload;      /**< Parallel, resumable and cached download of the data set. */
     QFile                           m_qFile;                /**< Temporary file for the dataset. */
     Extract                         m_extractor;            /**< Extractor for the data set. */
     QString                         m_qCurrentPath;         /**< Location of the temporary file. */
@@ -48,6 +48,8 @@
 //=============================================================================================================
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
 
 
 //*************************************************************************************************************
@@ -65,6 +67,62 @@
 */
 int main(int argc, char *argv[])
 {
+    //Without a GUI, e.g. on cluster nodes, the data set is fetched and extracted into the current directory
+    bool bNoGui = false;
+    for(int i = 1; i < argc; ++i) {
+        if(QString(argv[i]) == "--no-gui") {
+            bNoGui = true;
+        }
+    }
+
+    if(bNoGui) {
+        QCoreApplication a(argc, argv);
+
+        QCommandLineParser parser;
+        parser.setApplicationDescription("MNE Sample Data Downloader");
+        parser.addHelpOption();
+        parser.addOption(QCommandLineOption("no-gui", "Download and extract without a GUI."));
+        QCommandLineOption urlOption("url", "Location of the <archive>.", "archive", "ftp://surfer.nmr.mgh.harvard.edu/pub/data/MNE-sample-data-processed.tar.gz");
+        QCommandLineOption shaOption("sha256", "Expected SHA-256 <checksum> of the archive.", "checksum");
+        QCommandLineOption cacheOption("cache", "Shared cache <directory>, defaults to MNE_DATA_CACHE.", "directory", ChunkedDownload::defaultCacheDir());
+        QCommandLineOption connectionsOption("connections", "Number of parallel <connections>.", "connections", "4");
+        QCommandLineOption chunkOption("chunk-size", "Size of the ranged requests in <MB>.", "MB", "16");
+        parser.addOption(urlOption);
+        parser.addOption(shaOption);
+        parser.addOption(cacheOption);
+        parser.addOption(connectionsOption);
+        parser.addOption(chunkOption);
+        parser.process(a);
+
+        ChunkedDownload download;
+        download.setCacheDir(parser.value(cacheOption));
+        download.setConnections(parser.value(connectionsOption).toInt());
+        download.setChunkSize(parser.value(chunkOption).toLongLong() * 1024 * 1024);
+        download.setExpectedSha256(parser.value(shaOption));
+        download.setExtraction("tar", QStringList() << "-xzf" << "-", QDir::currentPath());
+
+        QTextStream out(stdout);
+        int iLastPercent = -1;
+        QObject::connect(&download, &ChunkedDownload::message, [&out](const QString& sMessage) {
+            out << sMessage << endl;
+        });
+        QObject::connect(&download, &ChunkedDownload::progress, [&out, &iLastPercent](qint64 iReceived, qint64 iTotal) {
+            int iPercent = iTotal > 0 ? int(100 * iReceived / iTotal) : -1;
+            if(iPercent != iLastPercent && iPercent % 5 == 0) {
+                out << iPercent << "%" << endl;
+                iLastPercent = iPercent;
+            }
+        });
+        QObject::connect(&download, &ChunkedDownload::finished, [&a](bool bSuccess, const QString& sFilePath) {
+            Q_UNUSED(sFilePath);
+            a.exit(bSuccess ? 0 : 1);
+        });
+
+        download.start(QUrl(parser.value(urlOption)));
+
+        return a.exec();
+    }
+
     QApplication a(argc, argv);
     QFile oldFile("sample.tar.gz");
     oldFile.remove();
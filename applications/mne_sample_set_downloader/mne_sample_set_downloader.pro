@@ -57,11 +57,13 @@ DESTDIR =  $${MNE_BINARY_DIR}
 
 SOURCES += main.cpp\
     downloader.cpp \
-    extract.cpp
+    extract.cpp \
+    chunkeddownload.cpp
 
 HEADERS  += \
     downloader.h \
-    extract.h
+    extract.h \
+    chunkeddownload.h
 
 FORMS    += \
     downloader.ui
@@ -127,14 +127,16 @@ void FrequencySpectrumDelegate::paint(QPainter *painter, const QStyleOptionViewI
 //                painter->setBrushOrigin(oldBO);
 //            }
 
-            //Get data
-            QVariant variant = index.model()->data(index,Qt::DisplayRole);
-            RowVectorXd data = variant.value< RowVectorXd >();
-
+            //Get data, the cached plot path only needs it when the row's spectrum changed
+            RowVectorXd data;
+            if(m_tableview_row == index.row())
+                data = index.model()->data(index,Qt::DisplayRole).value< RowVectorXd >();
 
             const FrequencySpectrumModel* t_pModel = static_cast<const FrequencySpectrumModel*>(index.model());
 
-            if(data.size() > 0)
+            QPainterPath plotPath = cachedPlotPath(index, option, data);
+
+            if(!plotPath.isEmpty())
             {
                 QPainterPath path(QPointF(option.rect.x(),option.rect.y()));//QPointF(option.rect.x()+t_rtmsaModel->relFiffCursor()-1,option.rect.y()));
 
@@ -144,7 +146,8 @@ void FrequencySpectrumDelegate::paint(QPainter *painter, const QStyleOptionViewI
                 createGridTick(index, option, painter);
 
                 //capture the mouse
-                capturePoint(index, option, path, data, painter);
+                if(data.size() > 0)
+                    capturePoint(index, option, path, data, painter);
 
                 painter->save();
                 QPen pen;
@@ -154,14 +157,9 @@ void FrequencySpectrumDelegate::paint(QPainter *painter, const QStyleOptionViewI
                 painter->drawPath(path);
                 painter->restore();
 
-
                 //Plot data path
-                path = QPainterPath(QPointF(option.rect.x(),option.rect.y()));//QPointF(option.rect.x()+t_rtmsaModel->relFiffCursor(),option.rect.y()));
-
-                createPlotPath(index, option, path, data);
-
                 painter->save();
-                painter->translate(0,t_fPlotHeight/2);
+                painter->translate(0,option.rect.y()+t_fPlotHeight/2);
                 painter->setRenderHint(QPainter::Antialiasing, true);
 
                 if(option.state & QStyle::State_Selected)
@@ -169,7 +167,7 @@ void FrequencySpectrumDelegate::paint(QPainter *painter, const QStyleOptionViewI
                 else
                     painter->setPen(QPen(t_pModel->isFreezed() ? Qt::darkGray : Qt::darkBlue, 1, Qt::SolidLine));
 
-                painter->drawPath(path);
+                painter->drawPath(plotPath);
                 painter->restore();
             }
             painter->restore();
@@ -213,6 +211,11 @@ void FrequencySpectrumDelegate::rcvMouseLoc(int tableview_row, int mousex, int m
 
     if(mousex != m_mousex){
 
+    //Only the row left by the cursor and the row under it need to be repainted
+    QRect updateRect = m_visRect.united(visRect);
+    updateRect.setLeft(0);
+    updateRect.setRight(m_tableview->viewport()->width());
+
     m_tableview_row = tableview_row;
     m_mousex = mousex;
     m_mousey = mousey;
@@ -221,7 +224,7 @@ void FrequencySpectrumDelegate::rcvMouseLoc(int tableview_row, int mousex, int m
     m_x_rate = (float)m_mousex/(float)m_visRect.width();
 
 
-    m_tableview->viewport()->repaint();
+    m_tableview->viewport()->update(updateRect);
     }
 }
 
@@ -355,22 +358,79 @@ void FrequencySpectrumDelegate::createPlotPath(const QModelIndex &index, const Q
     }
 
 
-    //create lines from one to the next sample
-    qint32 i;
-    for(i = lowerIdx+1; i <= upperIdx; ++i) {
+    //create lines from one to the next sample. Bins falling into the same pixel column, which is most of them
+    //towards the upper end of a logarithmic axis, are collapsed to their minimum and maximum.
+    const RowVectorXd &vecFreqScaleBound = t_pModel->getFreqScaleBound();
+    qint32 iColumn = -1;
+    float fMin = 0, fMax = 0, fLast = 0;
+    qint32 iBinsInColumn = 0;
+
+    for(qint32 i = lowerIdx+1; i <= upperIdx; ++i) {
         float val = data[i]-data[0]; //remove first sample data[0] as offset
         fValue = val*fScaleY;
 
         float newY = y_base+fValue;
+        float newX = (double)option.rect.width()*vecFreqScaleBound[i];
+
+        if((qint32)newX == iColumn && i < upperIdx) {
+            fMin = qMin(fMin, newY);
+            fMax = qMax(fMax, newY);
+            fLast = newY;
+            ++iBinsInColumn;
+            continue;
+        }
+
+        if(iBinsInColumn > 1) {
+            path.lineTo(qSamplePosition.x(), fMin);
+            path.lineTo(qSamplePosition.x(), fMax);
+            path.lineTo(qSamplePosition.x(), fLast);
+        }
 
         qSamplePosition.setY(newY);
-        qSamplePosition.setX((double)option.rect.width()*t_pModel->getFreqScaleBound()[i]);
+        qSamplePosition.setX(newX);
 
         path.lineTo(qSamplePosition);
+
+        iColumn = (qint32)newX;
+        fMin = fMax = fLast = newY;
+        iBinsInColumn = 1;
     }
 }
 
 
+//*************************************************************************************************************
+
+QPainterPath FrequencySpectrumDelegate::cachedPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, RowVectorXd& data) const
+{
+    const FrequencySpectrumModel* t_pModel = static_cast<const FrequencySpectrumModel*>(index.model());
+
+    qint32 iRowVersion = t_pModel->getRowVersion(index.row());
+    qint32 iScaleVersion = t_pModel->getScaleVersion();
+
+    QHash<qint32, PlotPathCache>::const_iterator it = m_qHashPlotPaths.constFind(index.row());
+    if(it != m_qHashPlotPaths.constEnd()
+            && it->iRowVersion == iRowVersion
+            && it->iScaleVersion == iScaleVersion
+            && it->size == option.rect.size())
+        return it->path;
+
+    if(data.size() == 0)
+        data = index.model()->data(index,Qt::DisplayRole).value< RowVectorXd >();
+
+    PlotPathCache cache;
+    cache.iRowVersion = iRowVersion;
+    cache.iScaleVersion = iScaleVersion;
+    cache.size = option.rect.size();
+
+    if(data.size() > 0 && t_pModel->getUpperFrqBound() < data.size())
+        createPlotPath(index, option, cache.path, data);
+
+    m_qHashPlotPaths.insert(index.row(), cache);
+
+    return cache.path;
+}
+
+
 //*************************************************************************************************************
 
 void FrequencySpectrumDelegate::createGridPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, RowVectorXd& data) const
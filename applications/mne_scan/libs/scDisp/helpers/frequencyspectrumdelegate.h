@@ -43,6 +43,8 @@
 #include <QAbstractItemDelegate>
 #include <QTableView>
 #include <QMouseEvent>
+#include <QPainterPath>
+#include <QHash>
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -147,6 +149,19 @@ private:
     */
     void createPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, RowVectorXd& data) const;
 
+    //=========================================================================================================
+    /**
+    * Returns the plot path of the given row, created relative to the row origin. The path is cached per row
+    * and rebuilt only when the row's spectrum, the frequency axis or the row size changed.
+    *
+    * @param[in] index      QModelIndex for accessing associated data and model object.
+    * @param[in] option     Describes the parameters used to draw an item in a view widget
+    * @param[in,out] data   The spectrum of the row, fetched from the model when it is empty and needed.
+    *
+    * @return the plot path, empty if there is no data to plot
+    */
+    QPainterPath cachedPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, RowVectorXd& data) const;
+
     //=========================================================================================================
     /**
     * createGridPath Creates the QPointer path for the grid plot.
@@ -181,6 +196,15 @@ private:
 
     qint8 m_iScaleType;      /**< scale type */
 
+    struct PlotPathCache {
+        QPainterPath path;      /**< The plot path relative to the row origin */
+        qint32 iRowVersion;     /**< Version of the spectrum the path was created from */
+        qint32 iScaleVersion;   /**< Version of the frequency axis the path was created with */
+        QSize size;             /**< Size of the row the path was created for */
+    };
+
+    mutable QHash<qint32, PlotPathCache> m_qHashPlotPaths;  /**< Cached plot paths per row */
+
 
 
 };
@@ -63,6 +63,7 @@ FrequencySpectrumModel::FrequencySpectrumModel(QObject *parent)
 , m_iLowerFrqIdx(0)
 , m_iUpperFrqIdx(0)
 , m_iScaleType(0)
+, m_iScaleVersion(0)
 {
 }
 
@@ -204,6 +205,21 @@ void FrequencySpectrumModel::setScaleType(qint8 ScaleType)
 
 void FrequencySpectrumModel::addData(const MatrixXd &data)
 {
+    bool bDimensionChanged = data.rows() != m_dataCurrent.rows() || data.cols() != m_dataCurrent.cols();
+
+    //Find the channels whose spectrum changed and bump their version
+    QVector<bool> qVecChanged(data.rows(), true);
+    if(bDimensionChanged) {
+        m_qVecRowVersion.fill(0, data.rows());
+        ++m_iScaleVersion;
+    } else {
+        for(qint32 i = 0; i < data.rows(); ++i) {
+            qVecChanged[i] = data.row(i) != m_dataCurrent.row(i);
+            if(qVecChanged[i])
+                ++m_qVecRowVersion[i];
+        }
+    }
+
     m_dataCurrent = data;
 
     if(m_vecFreqScale.size() != m_dataCurrent.cols() && m_pFiffInfo)
@@ -230,15 +246,35 @@ void FrequencySpectrumModel::addData(const MatrixXd &data)
         m_iLowerFrqIdx = 0;
         m_iUpperFrqIdx = m_vecFreqScale.size()-1;
 
+        ++m_iScaleVersion;
 
         m_bInitialized = true;
     }
 
-    //Update data content
-    QModelIndex topLeft = this->index(0,1);
-    QModelIndex bottomRight = this->index(m_dataCurrent.rows()-1,1);
+    //The freezed spectra are still on display, nothing to update
+    if(m_bIsFreezed)
+        return;
+
     QVector<int> roles; roles << Qt::DisplayRole;
-    emit dataChanged(topLeft, bottomRight, roles);
+
+    if(bDimensionChanged) {
+        emit dataChanged(this->index(0,1), this->index(rowCount()-1,1), roles);
+        return;
+    }
+
+    //Update only the contiguous runs of rows whose channels changed
+    qint32 iFirstChanged = -1;
+    for(qint32 row = 0; row <= rowCount(); ++row) {
+        qint32 r = row < rowCount() ? m_qMapIdxRowSelection.value(row, -1) : -1;
+        bool bChanged = r >= 0 && r < qVecChanged.size() && qVecChanged[r];
+
+        if(bChanged && iFirstChanged < 0) {
+            iFirstChanged = row;
+        } else if(!bChanged && iFirstChanged >= 0) {
+            emit dataChanged(this->index(iFirstChanged,1), this->index(row-1,1), roles);
+            iFirstChanged = -1;
+        }
+    }
 }
 
 
@@ -260,6 +296,8 @@ void FrequencySpectrumModel::selectRows(const QList<qint32> &selection)
         }
     }
 
+    ++m_iScaleVersion;
+
     emit newSelection(selection);
 
     endResetModel();
@@ -277,6 +315,8 @@ void FrequencySpectrumModel::resetSelection()
     for(qint32 i = 0; i < m_pFiffInfo->chs.size(); ++i)
         m_qMapIdxRowSelection.insert(i,i);
 
+    ++m_iScaleVersion;
+
     endResetModel();
 }
 
@@ -287,8 +327,10 @@ void FrequencySpectrumModel::toggleFreeze(const QModelIndex &)
 {
     m_bIsFreezed = !m_bIsFreezed;
 
-    if(m_bIsFreezed)
+    if(m_bIsFreezed) {
         m_dataCurrentFreeze = m_dataCurrent;
+        m_qVecRowVersionFreeze = m_qVecRowVersion;
+    }
 
     //Update data content
     QModelIndex topLeft = this->index(0,1);
@@ -331,5 +373,7 @@ void FrequencySpectrumModel::setBoundaries(float fLowerFrqBound, float fUpperFrq
     for(qint32 i = 0; i < m_vecFreqScaleBound.size(); ++i)
         m_vecFreqScaleBound[i] = (m_vecFreqScaleBound[i] - m_vecFreqScale[m_iLowerFrqIdx]) / (m_vecFreqScale[m_iUpperFrqIdx] - m_vecFreqScale[m_iLowerFrqIdx]);
 
+    ++m_iScaleVersion;
+
     endResetModel();
 }
@@ -52,6 +52,7 @@
 //=============================================================================================================
 
 #include <QAbstractTableModel>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -264,6 +265,26 @@ public:
     */
     inline qint32 getUpperFrqBound() const;
 
+    //=========================================================================================================
+    /**
+    * Returns the version of the spectrum currently shown in the given row. The version changes whenever the
+    * displayed spectrum of the row changes, which lets the delegate reuse its cached plot paths.
+    *
+    * @param[in] row    the row of the table view
+    *
+    * @return the version of the displayed spectrum
+    */
+    inline qint32 getRowVersion(qint32 row) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the version of the frequency axis. It changes whenever the frequency scale, the plotting boundaries
+    * or the row selection change.
+    *
+    * @return the version of the frequency axis
+    */
+    inline qint32 getScaleVersion() const;
+
 signals:
     //=========================================================================================================
     /**
@@ -287,6 +308,10 @@ private:
 
     MatrixXd m_dataCurrentFreeze;   /**< List that holds the current data when freezed*/
 
+    QVector<qint32> m_qVecRowVersion;          /**< Per channel version of the current data */
+    QVector<qint32> m_qVecRowVersionFreeze;    /**< Per channel version of the freezed data */
+    qint32 m_iScaleVersion;                    /**< Version of the frequency axis and row selection */
+
     float m_fSps;               /**< Sampling rate */
     qint32 m_iT;                /**< Time window */
 
@@ -368,6 +393,25 @@ inline qint32 FrequencySpectrumModel::getUpperFrqBound() const
     return m_iUpperFrqIdx;
 }
 
+
+//*************************************************************************************************************
+
+inline qint32 FrequencySpectrumModel::getRowVersion(qint32 row) const
+{
+    qint32 r = m_qMapIdxRowSelection.value(row, -1);
+    const QVector<qint32> &qVecVersion = m_bIsFreezed ? m_qVecRowVersionFreeze : m_qVecRowVersion;
+
+    return r >= 0 && r < qVecVersion.size() ? qVecVersion[r] : -1;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 FrequencySpectrumModel::getScaleVersion() const
+{
+    return m_iScaleVersion;
+}
+
 } // NAMESPACE
 
 #ifndef metatype_rowvectorxd
@@ -15,7 +15,12 @@
 
 #include <QPainter>
 #include <QDebug>
+#include <QtConcurrent>
 #include <iostream>
+#include <vector>
+#include <cmath>
+#include <climits>
+#include <algorithm>
 
 
 //*************************************************************************************************************
@@ -24,6 +29,25 @@
 //=============================================================================================================
 
 using namespace SCDISPLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+//Density colors per modality
+const QRgb RGB_GRAD = qRgb(31, 119, 180);
+const QRgb RGB_MAG  = qRgb(214, 39, 40);
+const QRgb RGB_EEG  = qRgb(44, 160, 44);
+const QRgb RGB_EOG  = qRgb(148, 103, 189);
+const QRgb RGB_MISC = qRgb(140, 86, 75);
+
+}
 
 
 //*************************************************************************************************************
@@ -47,7 +71,12 @@ RealTimeButterflyPlot::RealTimeButterflyPlot(QWidget *parent)
 , m_fMaxEEG(0.0)
 , m_fMaxEOG(0.0)
 , m_fMaxMISC(0.0)
+, m_bDensityMode(false)
+, m_bDensityModalityColors(false)
+, m_bDensityPending(false)
 {
+    connect(&m_densityWatcher, &QFutureWatcher<QImage>::finished,
+            this, &RealTimeButterflyPlot::onDensityImageReady);
 }
 
 
@@ -65,7 +94,12 @@ void RealTimeButterflyPlot::dataUpdate(const QModelIndex& topLeft, const QModelI
         m_bIsInit = true;
     }
 
-    update();
+    //In density mode the finished image triggers the repaint
+    if(m_bDensityMode) {
+        updateDensityImage();
+    } else {
+        update();
+    }
 }
 
 
@@ -177,52 +211,22 @@ void RealTimeButterflyPlot::paintEvent(QPaintEvent* paintEvent)
             painter.restore();
         }
 
-        painter.translate(0,this->height()/2);
-
         //Actual average data
-        for(qint32 r = 0; r < m_iNumChannels; ++r) {
-            if(m_lSelectedChannels.contains(r)) {
-                qint32 kind = m_pRealTimeEvokedModel->getKind(r);
-
-                //Display only selected kinds
-                switch(kind) {
-                    case FIFFV_MEG_CH: {
-                        qint32 unit = m_pRealTimeEvokedModel->getUnit(r);
-                        if(unit == FIFF_UNIT_T_M) {
-                            if(m_bShowGRAD)
-                                break;
-                            else
-                                continue;
-                        }
-                        else if(unit == FIFF_UNIT_T)
-                        {
-                            if(m_bShowMAG)
-                                break;
-                            else
-                                continue;
-                        }
-                        continue;
-                    }
-                    case FIFFV_EEG_CH: {
-                        if(m_bShowEEG)
-                            break;
-                        else
-                            continue;
-                    }
-                    case FIFFV_EOG_CH: {
-                        if(m_bShowEOG)
-                            break;
-                        else
-                            continue;
-                    }
-                    case FIFFV_MISC_CH: {
-                        if(m_bShowMISC)
-                            break;
-                        else
-                            continue;
-                    }
-                    default:
-                        continue;
+        if(m_bDensityMode) {
+            if(!m_imgDensity.isNull()) {
+                painter.save();
+                if(m_pRealTimeEvokedModel->isFreezed()) {
+                    painter.setOpacity(0.5);
+                }
+                painter.drawImage(this->rect(), m_imgDensity);
+                painter.restore();
+            }
+        } else {
+            painter.translate(0,this->height()/2);
+
+            for(qint32 r = 0; r < m_iNumChannels; ++r) {
+                if(!isChannelShown(r)) {
+                    continue;
                 }
 
                 painter.save();
@@ -250,62 +254,7 @@ void RealTimeButterflyPlot::paintEvent(QPaintEvent* paintEvent)
 
 void RealTimeButterflyPlot::createPlotPath(qint32 row, QPainter& painter) const
 {
-    //get maximum range of respective channel type (range value in FiffChInfo does not seem to contain a reasonable value)
-    qint32 kind = m_pRealTimeEvokedModel->getKind(row);
-    float fMaxValue = 1e-9f;
-
-    switch(kind) {
-        case FIFFV_MEG_CH: {
-            qint32 unit = m_pRealTimeEvokedModel->getUnit(row);
-            if(unit == FIFF_UNIT_T_M) { //gradiometers
-                fMaxValue = 1e-10f;
-                if(m_pRealTimeEvokedModel->getScaling().contains(FIFF_UNIT_T_M))
-                    fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFF_UNIT_T_M];
-            }
-            else if(unit == FIFF_UNIT_T) //magnitometers
-            {
-//                if(m_pRealTimeEvokedModel->getCoil(row) == FIFFV_COIL_BABY_MAG)
-//                    fMaxValue = 1e-11f;
-//                else
-                fMaxValue = 1e-11f;
-
-                if(m_pRealTimeEvokedModel->getScaling().contains(FIFF_UNIT_T))
-                    fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFF_UNIT_T];
-            }
-            break;
-        }
-
-        case FIFFV_REF_MEG_CH: {  /*11/04/14 Added by Limin: MEG reference channel */
-            fMaxValue = 1e-11f;
-            if(m_pRealTimeEvokedModel->getScaling().contains(FIFF_UNIT_T))
-                fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFF_UNIT_T];
-            break;
-        }
-        case FIFFV_EEG_CH: {
-            fMaxValue = 1e-4f;
-            if(m_pRealTimeEvokedModel->getScaling().contains(FIFFV_EEG_CH))
-                fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFFV_EEG_CH];
-            break;
-        }
-        case FIFFV_EOG_CH: {
-            fMaxValue = 1e-3f;
-            if(m_pRealTimeEvokedModel->getScaling().contains(FIFFV_EOG_CH))
-                fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFFV_EOG_CH];
-            break;
-        }
-        case FIFFV_STIM_CH: {
-            fMaxValue = 5;
-            if(m_pRealTimeEvokedModel->getScaling().contains(FIFFV_STIM_CH))
-                fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFFV_STIM_CH];
-            break;
-        }
-        case FIFFV_MISC_CH: {
-            fMaxValue = 1e-3f;
-            if(m_pRealTimeEvokedModel->getScaling().contains(FIFFV_MISC_CH))
-                fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFFV_MISC_CH];
-            break;
-        }
-    }
+    float fMaxValue = getMaxValue(row);
 
     float fValue;
     float fScaleY = this->height()/(2*fMaxValue);
@@ -427,7 +376,7 @@ void RealTimeButterflyPlot::setSettings(const QList< Modality >& p_qListModaliti
 
         }
     }
-    update();
+    updateView();
 }
 
 
@@ -437,7 +386,7 @@ void RealTimeButterflyPlot::setSelectedChannels(const QList<int> &selectedChanne
 {
     m_lSelectedChannels = selectedChannels;
 
-    update();
+    updateView();
 }
 
 
@@ -445,6 +394,10 @@ void RealTimeButterflyPlot::setSelectedChannels(const QList<int> &selectedChanne
 
 void RealTimeButterflyPlot::updateView()
 {
+    if(m_bDensityMode) {
+        updateDensityImage();
+    }
+
     update();
 }
 
@@ -455,7 +408,7 @@ void RealTimeButterflyPlot::setBackgroundColor(const QColor& backgroundColor)
 {
     m_colCurrentBackgroundColor = backgroundColor;
 
-    update();
+    updateView();
 }
 
 
@@ -473,6 +426,346 @@ void RealTimeButterflyPlot::setAverageInformationMap(const QMap<double, QPair<QC
 {
     m_qMapAverageColor = mapAvr;
 
+    updateView();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeButterflyPlot::setDensityMode(bool bDensityMode, bool bModalityColors)
+{
+    m_bDensityMode = bDensityMode;
+    m_bDensityModalityColors = bModalityColors;
+
+    if(!m_bDensityMode) {
+        m_imgDensity = QImage();
+    }
+
+    updateView();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeButterflyPlot::resizeEvent(QResizeEvent* event)
+{
+    //The old image is stretched until the new one is rendered
+    if(m_bDensityMode) {
+        updateDensityImage();
+    }
+
+    QWidget::resizeEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+bool RealTimeButterflyPlot::isChannelShown(qint32 row) const
+{
+    if(!m_lSelectedChannels.contains(row)) {
+        return false;
+    }
+
+    //Display only selected kinds
+    switch(m_pRealTimeEvokedModel->getKind(row)) {
+        case FIFFV_MEG_CH: {
+            qint32 unit = m_pRealTimeEvokedModel->getUnit(row);
+            if(unit == FIFF_UNIT_T_M) {
+                return m_bShowGRAD;
+            } else if(unit == FIFF_UNIT_T) {
+                return m_bShowMAG;
+            }
+            return false;
+        }
+        case FIFFV_EEG_CH:
+            return m_bShowEEG;
+        case FIFFV_EOG_CH:
+            return m_bShowEOG;
+        case FIFFV_MISC_CH:
+            return m_bShowMISC;
+        default:
+            return false;
+    }
+}
+
+
+//*************************************************************************************************************
+
+float RealTimeButterflyPlot::getMaxValue(qint32 row) const
+{
+    //get maximum range of respective channel type (range value in FiffChInfo does not seem to contain a reasonable value)
+    qint32 kind = m_pRealTimeEvokedModel->getKind(row);
+    float fMaxValue = 1e-9f;
+
+    switch(kind) {
+        case FIFFV_MEG_CH: {
+            qint32 unit = m_pRealTimeEvokedModel->getUnit(row);
+            if(unit == FIFF_UNIT_T_M) { //gradiometers
+                fMaxValue = 1e-10f;
+                if(m_pRealTimeEvokedModel->getScaling().contains(FIFF_UNIT_T_M))
+                    fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFF_UNIT_T_M];
+            }
+            else if(unit == FIFF_UNIT_T) //magnitometers
+            {
+//                if(m_pRealTimeEvokedModel->getCoil(row) == FIFFV_COIL_BABY_MAG)
+//                    fMaxValue = 1e-11f;
+//                else
+                fMaxValue = 1e-11f;
+
+                if(m_pRealTimeEvokedModel->getScaling().contains(FIFF_UNIT_T))
+                    fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFF_UNIT_T];
+            }
+            break;
+        }
+
+        case FIFFV_REF_MEG_CH: {  /*11/04/14 Added by Limin: MEG reference channel */
+            fMaxValue = 1e-11f;
+            if(m_pRealTimeEvokedModel->getScaling().contains(FIFF_UNIT_T))
+                fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFF_UNIT_T];
+            break;
+        }
+        case FIFFV_EEG_CH: {
+            fMaxValue = 1e-4f;
+            if(m_pRealTimeEvokedModel->getScaling().contains(FIFFV_EEG_CH))
+                fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFFV_EEG_CH];
+            break;
+        }
+        case FIFFV_EOG_CH: {
+            fMaxValue = 1e-3f;
+            if(m_pRealTimeEvokedModel->getScaling().contains(FIFFV_EOG_CH))
+                fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFFV_EOG_CH];
+            break;
+        }
+        case FIFFV_STIM_CH: {
+            fMaxValue = 5;
+            if(m_pRealTimeEvokedModel->getScaling().contains(FIFFV_STIM_CH))
+                fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFFV_STIM_CH];
+            break;
+        }
+        case FIFFV_MISC_CH: {
+            fMaxValue = 1e-3f;
+            if(m_pRealTimeEvokedModel->getScaling().contains(FIFFV_MISC_CH))
+                fMaxValue = m_pRealTimeEvokedModel->getScaling()[FIFFV_MISC_CH];
+            break;
+        }
+    }
+
+    return fMaxValue;
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeButterflyPlot::updateDensityImage()
+{
+    if(!m_bDensityMode || !m_bIsInit || this->width() <= 2 || this->height() <= 2) {
+        return;
+    }
+
+    if(m_densityWatcher.isRunning()) {
+        m_bDensityPending = true;
+        return;
+    }
+
+    m_bDensityPending = false;
+
+    //Gather the traces on the GUI thread, the model is not accessed by the worker
+    QList<DensityTrace> lTraces;
+
+    for(qint32 r = 0; r < m_iNumChannels; ++r) {
+        if(!isChannelShown(r)) {
+            continue;
+        }
+
+        QRgb rgb = m_pRealTimeEvokedModel->getColor(r).rgb();
+        if(m_bDensityModalityColors) {
+            switch(m_pRealTimeEvokedModel->getKind(r)) {
+                case FIFFV_MEG_CH:
+                    rgb = m_pRealTimeEvokedModel->getUnit(r) == FIFF_UNIT_T_M ? RGB_GRAD : RGB_MAG;
+                    break;
+                case FIFFV_EEG_CH:
+                    rgb = RGB_EEG;
+                    break;
+                case FIFFV_EOG_CH:
+                    rgb = RGB_EOG;
+                    break;
+                default:
+                    rgb = RGB_MISC;
+            }
+        }
+
+        float fScaleY = this->height()/(2*getMaxValue(r));
+
+        QList<SCDISPLIB::AvrTypeRowVector> rowVec = m_pRealTimeEvokedModel->data(r,1).value<QList<SCDISPLIB::AvrTypeRowVector> >();
+
+        for(int j = 0; j < rowVec.size(); ++j) {
+            if(m_qMapAverageColor[rowVec.at(j).first].second.second && rowVec.at(j).second.cols() > 0) {
+                DensityTrace trace;
+                trace.vecData = rowVec.at(j).second;
+                trace.fScaleY = fScaleY;
+                trace.rgb = rgb;
+                lTraces.append(trace);
+            }
+        }
+    }
+
+    //A single color contrasts with the background
+    QRgb rgbDefault = m_colCurrentBackgroundColor.lightness() > 127 ? qRgb(0, 0, 0) : qRgb(255, 255, 255);
+
+    m_densityWatcher.setFuture(QtConcurrent::run(&RealTimeButterflyPlot::renderDensityImage,
+                                                 lTraces,
+                                                 this->size(),
+                                                 m_pRealTimeEvokedModel->getNumSamples(),
+                                                 m_bDensityModalityColors,
+                                                 rgbDefault));
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeButterflyPlot::onDensityImageReady()
+{
+    //Drop the result if the mode was left in the meantime
+    if(m_bDensityMode) {
+        m_imgDensity = m_densityWatcher.result();
+    }
+
+    if(m_bDensityPending) {
+        updateDensityImage();
+    }
+
     update();
 }
 
+
+//*************************************************************************************************************
+
+QImage RealTimeButterflyPlot::renderDensityImage(const QList<DensityTrace>& lTraces, const QSize& size, qint32 iNumSamples, bool bColorTraces, QRgb rgbDefault)
+{
+    const int iWidth = size.width();
+    const int iHeight = size.height();
+
+    QImage image(size, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+
+    if(lTraces.isEmpty() || iNumSamples < 2) {
+        return image;
+    }
+
+    //The buffers are stored column major, a trace fills vertical spans
+    std::vector<float> vecHits(iWidth*iHeight, 0.0f);
+    std::vector<float> vecRed, vecGreen, vecBlue;
+    if(bColorTraces) {
+        vecRed.assign(iWidth*iHeight, 0.0f);
+        vecGreen.assign(iWidth*iHeight, 0.0f);
+        vecBlue.assign(iWidth*iHeight, 0.0f);
+    }
+
+    std::vector<int> vecSpanMin(iWidth), vecSpanMax(iWidth);
+
+    float fDx = (float)(iWidth-2) / ((float)iNumSamples-1.0f);
+    float fWinMaxVal = ((float)iHeight-2)/2.0f;
+    float fBaseY = iHeight/2.0f;
+
+    for(int t = 0; t < lTraces.size(); ++t) {
+        const DensityTrace& trace = lTraces.at(t);
+
+        std::fill(vecSpanMin.begin(), vecSpanMin.end(), INT_MAX);
+        std::fill(vecSpanMax.begin(), vecSpanMax.end(), INT_MIN);
+        int iFirstCol = INT_MAX;
+        int iLastCol = INT_MIN;
+
+        //Extends the span of a column by the y range [fY0,fY1]
+        auto mark = [&](int iCol, float fY0, float fY1) {
+            if(iCol < 0 || iCol >= iWidth) {
+                return;
+            }
+            int iLow = qBound(0, (int)std::floor(qMin(fY0, fY1)), iHeight-1);
+            int iHigh = qBound(0, (int)std::floor(qMax(fY0, fY1)), iHeight-1);
+            vecSpanMin[iCol] = qMin(vecSpanMin[iCol], iLow);
+            vecSpanMax[iCol] = qMax(vecSpanMax[iCol], iHigh);
+            iFirstCol = qMin(iFirstCol, iCol);
+            iLastCol = qMax(iLastCol, iCol);
+        };
+
+        auto toPixelY = [&](double dValue) {
+            float fValue = dValue*trace.fScaleY;
+            fValue = fValue > fWinMaxVal ? fWinMaxVal : fValue < -fWinMaxVal ? -fWinMaxVal : fValue;
+            return fBaseY - fValue;
+        };
+
+        float fPrevX = 1.0f;
+        float fPrevY = toPixelY(trace.vecData[0]);
+        mark((int)fPrevX, fPrevY, fPrevY);
+
+        for(int i = 1; i < trace.vecData.cols(); ++i) {
+            float fX = 1.0f + i*fDx;
+            float fY = toPixelY(trace.vecData[i]);
+
+            int iCol0 = (int)fPrevX;
+            int iCol1 = (int)fX;
+
+            if(iCol0 == iCol1) {
+                mark(iCol0, fPrevY, fY);
+            } else {
+                //Split the segment at the column borders
+                float fSlope = (fY - fPrevY) / (fX - fPrevX);
+                for(int c = iCol0; c <= iCol1 && c < iWidth; ++c) {
+                    float fXa = qMax(fPrevX, (float)c);
+                    float fXb = qMin(fX, (float)(c+1));
+                    mark(c, fPrevY + (fXa-fPrevX)*fSlope, fPrevY + (fXb-fPrevX)*fSlope);
+                }
+            }
+
+            fPrevX = fX;
+            fPrevY = fY;
+        }
+
+        //Accumulate the spans, every trace hits a pixel at most once
+        float fRed = qRed(trace.rgb);
+        float fGreen = qGreen(trace.rgb);
+        float fBlue = qBlue(trace.rgb);
+
+        for(int c = iFirstCol; c <= iLastCol; ++c) {
+            int iOffset = c*iHeight;
+            for(int y = vecSpanMin[c]; y <= vecSpanMax[c]; ++y) {
+                vecHits[iOffset+y] += 1.0f;
+                if(bColorTraces) {
+                    vecRed[iOffset+y] += fRed;
+                    vecGreen[iOffset+y] += fGreen;
+                    vecBlue[iOffset+y] += fBlue;
+                }
+            }
+        }
+    }
+
+    float fMaxHits = *std::max_element(vecHits.begin(), vecHits.end());
+    if(fMaxHits <= 0.0f) {
+        return image;
+    }
+
+    //Map the hits logarithmically, so single traces stay visible next to dense bundles
+    float fNorm = 1.0f / std::log(1.0f + fMaxHits);
+
+    for(int y = 0; y < iHeight; ++y) {
+        QRgb* pLine = reinterpret_cast<QRgb*>(image.scanLine(y));
+
+        for(int c = 0; c < iWidth; ++c) {
+            int iIdx = c*iHeight+y;
+            float fHits = vecHits[iIdx];
+            if(fHits <= 0.0f) {
+                continue;
+            }
+
+            int iAlpha = 40 + (int)(215.0f * std::log(1.0f + fHits) * fNorm);
+
+            if(bColorTraces) {
+                pLine[c] = qRgba((int)(vecRed[iIdx]/fHits), (int)(vecGreen[iIdx]/fHits), (int)(vecBlue[iIdx]/fHits), iAlpha);
+            } else {
+                pLine[c] = qRgba(qRed(rgbDefault), qGreen(rgbDefault), qBlue(rgbDefault), iAlpha);
+            }
+        }
+    }
+
+    return image;
+}
@@ -20,6 +20,16 @@
 #include <QPolygonF>
 #include <QColor>
 #include <QSharedPointer>
+#include <QImage>
+#include <QFutureWatcher>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
 
 
 //*************************************************************************************************************
@@ -67,6 +77,32 @@ public:
     */
     void setAverageInformationMap(const QMap<double, QPair<QColor, QPair<QString,bool> > >& mapAvr);
 
+    //=========================================================================================================
+    /**
+    * Switches between drawing every channel as a path and the density mode. In density mode the traces are
+    * accumulated into an image on a worker thread and the GUI thread only presents the finished image.
+    *
+    * @param [in] bDensityMode      Whether to rasterize the traces into a density image.
+    * @param [in] bModalityColors   Whether to color the density per modality instead of in a single color.
+    */
+    void setDensityMode(bool bDensityMode, bool bModalityColors = false);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the density mode is active.
+    *
+    * @return true if the traces are rasterized into a density image.
+    */
+    inline bool isDensityMode() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the density is colored per modality.
+    *
+    * @return true if the density is colored per modality.
+    */
+    inline bool hasDensityModalityColors() const;
+
 protected:
     //=========================================================================================================
     /**
@@ -77,7 +113,72 @@ protected:
     */
     virtual void paintEvent(QPaintEvent* paintEvent );
 
+    //=========================================================================================================
+    /**
+    * Rerenders the density image for the new size.
+    *
+    * @param [in] event pointer to ResizeEvent -> not used.
+    */
+    virtual void resizeEvent(QResizeEvent* event);
+
 private:
+    /**
+    * A trace which is rasterized by the density worker.
+    */
+    struct DensityTrace {
+        Eigen::RowVectorXd  vecData;        /**< The samples of the trace. */
+        float               fScaleY;        /**< Pixels per unit. */
+        QRgb                rgb;            /**< The color of the trace. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Returns whether the channel is selected and its kind is shown.
+    *
+    * @param[in] row    The row of the channel.
+    *
+    * @return true if the channel is drawn.
+    */
+    bool isChannelShown(qint32 row) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the value which is mapped to the upper border of the plot for the kind of the channel.
+    *
+    * @param[in] row    The row of the channel.
+    *
+    * @return the maximum value.
+    */
+    float getMaxValue(qint32 row) const;
+
+    //=========================================================================================================
+    /**
+    * Collects the visible traces and hands them to the density worker. If the worker is still busy the update
+    * is done as soon as it finishes, so intermediate updates are dropped.
+    */
+    void updateDensityImage();
+
+    //=========================================================================================================
+    /**
+    * Takes over the image of the density worker.
+    */
+    void onDensityImageReady();
+
+    //=========================================================================================================
+    /**
+    * Accumulates the traces into a density image, this runs on the worker thread. Every trace adds at most one
+    * hit per pixel, the hit count is mapped logarithmically to the opacity.
+    *
+    * @param[in] lTraces        The traces to rasterize.
+    * @param[in] size           The size of the image.
+    * @param[in] iNumSamples    The number of samples which span the width of the image.
+    * @param[in] bColorTraces   Whether to mix the trace colors, otherwise rgbDefault is used.
+    * @param[in] rgbDefault     The color of the density in single color mode.
+    *
+    * @return the density image.
+    */
+    static QImage renderDensityImage(const QList<DensityTrace>& lTraces, const QSize& size, qint32 iNumSamples, bool bColorTraces, QRgb rgbDefault);
+
     //=========================================================================================================
     /**
     * createPlotPath creates the QPointer path for the data plot.
@@ -109,6 +210,12 @@ private:
 
     QMap<double, QPair<QColor, QPair<QString,bool> > >      m_qMapAverageColor;             /**< Average colors and names. */
 
+    bool                    m_bDensityMode;                     /**< Whether the traces are rasterized into a density image. */
+    bool                    m_bDensityModalityColors;           /**< Whether the density is colored per modality. */
+    bool                    m_bDensityPending;                  /**< Whether the density image needs to be rendered again once the worker finished. */
+    QImage                  m_imgDensity;                       /**< The last density image. */
+    QFutureWatcher<QImage>  m_densityWatcher;                   /**< Watches the density worker. */
+
 };
 
 
@@ -136,6 +243,22 @@ inline void RealTimeButterflyPlot::setModel(RealTimeEvokedSetModel* model)
 }
 
 
+//*************************************************************************************************************
+
+inline bool RealTimeButterflyPlot::isDensityMode() const
+{
+    return m_bDensityMode;
+}
+
+
+//*************************************************************************************************************
+
+inline bool RealTimeButterflyPlot::hasDensityModalityColors() const
+{
+    return m_bDensityModalityColors;
+}
+
+
 } // NAMESPACE
 
 #endif // REALTIMEBUTTERFLYPLOT_H
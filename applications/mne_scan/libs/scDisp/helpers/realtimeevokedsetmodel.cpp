@@ -315,38 +315,56 @@ void RealTimeEvokedSetModel::setRTESet(QSharedPointer<RealTimeEvokedSet> &pRTESe
 
 void RealTimeEvokedSetModel::updateData()
 {
-    m_matData.clear();
-    m_matDataFiltered.clear();
+    const QList<FiffEvoked>& lEvoked = m_pRTESet->getValue()->evoked;
+
+    //A frozen copy shares the matrices, drop them instead of detaching a copy which is overwritten anyway
+    if(m_bIsFreezed || m_matData.size() != lEvoked.size()) {
+        m_matData.clear();
+        m_matDataFiltered.clear();
+    }
+
     m_lAvrTypes.clear();
 
-    for(int i = 0; i < m_pRTESet->getValue()->evoked.size(); ++i) {
-        bool doProj = m_bProjActivated && m_pRTESet->getValue()->evoked.at(i).data.cols() > 0 && m_pRTESet->getValue()->evoked.at(i).data.rows() == m_matProj.cols() ? true : false;
+    for(int i = 0; i < lEvoked.size(); ++i) {
+        const MatrixXd& matEvoked = lEvoked.at(i).data;
 
-        bool doComp = m_bCompActivated && m_pRTESet->getValue()->evoked.at(i).data.cols() > 0 && m_pRTESet->getValue()->evoked.at(i).data.rows() == m_matComp.cols() ? true : false;
+        //Reuse the matrices of the last update, they are only reallocated if the dimensions change
+        if(i >= m_matData.size()) {
+            m_matData.append(MatrixXd());
+            m_matDataFiltered.append(MatrixXd());
+        }
+
+        MatrixXd& matData = m_matData[i];
+
+        bool doProj = m_bProjActivated && matEvoked.cols() > 0 && matEvoked.rows() == m_matProj.cols() ? true : false;
+
+        bool doComp = m_bCompActivated && matEvoked.cols() > 0 && matEvoked.rows() == m_matComp.cols() ? true : false;
 
         if(doComp) {
             if(doProj) {
                 //Comp + Proj
-                m_matData.append(m_matSparseProjCompMult * m_pRTESet->getValue()->evoked.at(i).data);
+                matData.noalias() = m_matSparseProjCompMult * matEvoked;
             } else {
                 //Comp
-                m_matData.append(m_matSparseCompMult * m_pRTESet->getValue()->evoked.at(i).data);
+                matData.noalias() = m_matSparseCompMult * matEvoked;
             }
         } else {
             if(doProj) {
                 //Proj
-                m_matData.append(m_matSparseProjMult * m_pRTESet->getValue()->evoked.at(i).data);
+                matData.noalias() = m_matSparseProjMult * matEvoked;
             } else {
                 //None - Raw
-                m_matData.append(m_pRTESet->getValue()->evoked.at(i).data);
+                matData = matEvoked;
             }
         }
 
-        m_matDataFiltered.append(MatrixXd::Zero(m_pRTESet->getValue()->evoked.at(i).data.rows(), m_pRTESet->getValue()->evoked.at(i).data.cols()));
+        if(m_matDataFiltered.at(i).rows() != matEvoked.rows() || m_matDataFiltered.at(i).cols() != matEvoked.cols()) {
+            m_matDataFiltered[i] = MatrixXd::Zero(matEvoked.rows(), matEvoked.cols());
+        }
 
-        m_pairBaseline = m_pRTESet->getValue()->evoked.at(i).baseline;
+        m_pairBaseline = lEvoked.at(i).baseline;
 
-        m_lAvrTypes.append(m_pRTESet->getValue()->evoked.at(i).comment.toDouble());
+        m_lAvrTypes.append(lEvoked.at(i).comment.toDouble());
     }
 
     if(!m_filterData.isEmpty()) {
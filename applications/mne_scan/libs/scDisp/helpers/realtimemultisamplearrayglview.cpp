@@ -0,0 +1,518 @@
+//=============================================================================================================
+/**
+* @file     realtimemultisamplearrayglview.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the RealTimeMultiSampleArrayGLView Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "realtimemultisamplearrayglview.h"
+
+#include "realtimemultisamplearraymodel.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QOpenGLShaderProgram>
+#include <QOpenGLContext>
+#include <QPainter>
+#include <QWheelEvent>
+#include <QMouseEvent>
+#include <QVector4D>
+#include <QBrush>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCDISPLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+//x: sample distance, y: value scaling, z: row center, w: value offset, all in normalized device coordinates
+const char* vertexShaderSource =
+    "attribute highp float aPosition;\n"
+    "attribute highp float aValue;\n"
+    "uniform highp vec4 uTransform;\n"
+    "void main() {\n"
+    "    gl_Position = vec4(-1.0 + aPosition * uTransform.x, uTransform.z + (aValue - uTransform.w) * uTransform.y, 0.0, 1.0);\n"
+    "}\n";
+
+const char* fragmentShaderSource =
+    "uniform lowp vec4 uColor;\n"
+    "void main() {\n"
+    "    gl_FragColor = uColor;\n"
+    "}\n";
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RealTimeMultiSampleArrayGLView::RealTimeMultiSampleArrayGLView(QWidget *parent)
+: QOpenGLWidget(parent)
+, m_pModel(Q_NULLPTR)
+, m_positionBuffer(QOpenGLBuffer::VertexBuffer)
+, m_valueBuffer(QOpenGLBuffer::VertexBuffer)
+, m_iUniformTransform(-1)
+, m_iUniformColor(-1)
+, m_iAttributePosition(-1)
+, m_iAttributeValue(-1)
+, m_iRingSize(0)
+, m_iNumberRings(0)
+, m_iLastSampleIndex(0)
+, m_iPendingSamples(0)
+, m_fRowHeight(80.0f)
+, m_iScrollPosition(0)
+, m_colorSignal(Qt::darkBlue)
+, m_colorFreeze(Qt::darkGray)
+, m_colorBackground(Qt::white)
+{
+    QColor colorMarker(233,0,43);
+    colorMarker.setAlpha(160);
+
+    m_penMarker = QPen(colorMarker, 2, Qt::DashLine);
+}
+
+
+//*************************************************************************************************************
+
+RealTimeMultiSampleArrayGLView::~RealTimeMultiSampleArrayGLView()
+{
+    cleanupGL();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::setModel(RealTimeMultiSampleArrayModel *pModel)
+{
+    if(m_pModel)
+        disconnect(m_pModel, Q_NULLPTR, this, Q_NULLPTR);
+
+    m_pModel = pModel;
+
+    if(m_pModel) {
+        connect(m_pModel, &QAbstractItemModel::dataChanged,
+                this, &RealTimeMultiSampleArrayGLView::onDataChanged);
+        connect(m_pModel, &QAbstractItemModel::modelReset,
+                this, &RealTimeMultiSampleArrayGLView::onModelReset);
+        connect(m_pModel, &QAbstractItemModel::layoutChanged,
+                this, &RealTimeMultiSampleArrayGLView::onModelReset);
+    }
+
+    onModelReset();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::setRowHeight(float fRowHeight)
+{
+    m_fRowHeight = qMax(fRowHeight, 1.0f);
+
+    clampScrollPosition();
+    update();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::setRowHidden(int row, bool hide)
+{
+    if(row < 0)
+        return;
+
+    if(row >= m_vecHiddenRows.size())
+        m_vecHiddenRows.resize(row + 1);
+
+    m_vecHiddenRows[row] = hide;
+
+    clampScrollPosition();
+    update();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::setSignalColor(const QColor& signalColor)
+{
+    m_colorSignal = signalColor;
+    update();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::setBackgroundColor(const QColor& backgroundColor)
+{
+    m_colorBackground = backgroundColor;
+    update();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::initializeGL()
+{
+    initializeOpenGLFunctions();
+
+    connect(context(), &QOpenGLContext::aboutToBeDestroyed,
+            this, &RealTimeMultiSampleArrayGLView::cleanupGL, Qt::UniqueConnection);
+
+    m_pProgram = QSharedPointer<QOpenGLShaderProgram>::create();
+
+    if(!m_pProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShaderSource)
+            || !m_pProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSource)
+            || !m_pProgram->link()) {
+        qDebug() << "RealTimeMultiSampleArrayGLView::initializeGL - Could not build the shader program:" << m_pProgram->log();
+        m_pProgram.clear();
+        return;
+    }
+
+    m_iUniformTransform = m_pProgram->uniformLocation("uTransform");
+    m_iUniformColor = m_pProgram->uniformLocation("uColor");
+    m_iAttributePosition = m_pProgram->attributeLocation("aPosition");
+    m_iAttributeValue = m_pProgram->attributeLocation("aValue");
+
+    m_positionBuffer.create();
+    m_valueBuffer.create();
+    m_valueBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+
+    //The buffers of a new context are empty
+    m_iRingSize = 0;
+    m_iNumberRings = 0;
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::paintGL()
+{
+    glClearColor(m_colorBackground.redF(), m_colorBackground.greenF(), m_colorBackground.blueF(), 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if(!m_pModel || !m_pProgram || height() <= 0)
+        return;
+
+    uploadSamples();
+
+    if(m_iRingSize < 2 || m_iNumberRings == 0)
+        return;
+
+    clampScrollPosition();
+
+    QVector<int> vecRows = shownRows();
+    int iFirst = m_iScrollPosition / m_fRowHeight;
+    int iLast = qMin(vecRows.size() - 1, (int)((m_iScrollPosition + height()) / m_fRowHeight));
+    int iRatio = devicePixelRatio();
+
+    //Tint the background of bad channels
+    glEnable(GL_SCISSOR_TEST);
+
+    for(int i = iFirst; i <= iLast; ++i) {
+        QVariant v = m_pModel->data(m_pModel->index(vecRows[i],1), Qt::BackgroundRole);
+
+        if(v.canConvert<QBrush>()) {
+            QColor color = qvariant_cast<QBrush>(v).color();
+            float fAlpha = color.alphaF();
+            float fTop = i * m_fRowHeight - m_iScrollPosition;
+
+            glScissor(0, (height() - fTop - m_fRowHeight) * iRatio, width() * iRatio, m_fRowHeight * iRatio);
+            glClearColor(m_colorBackground.redF() * (1.0f - fAlpha) + color.redF() * fAlpha,
+                         m_colorBackground.greenF() * (1.0f - fAlpha) + color.greenF() * fAlpha,
+                         m_colorBackground.blueF() * (1.0f - fAlpha) + color.blueF() * fAlpha,
+                         1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+    }
+
+    glDisable(GL_SCISSOR_TEST);
+
+    //Draw the traces
+    int iCurrentSample = qBound(0, m_pModel->getCurrentSampleIndex(), m_iRingSize);
+
+    m_pProgram->bind();
+    m_pProgram->setUniformValue(m_iUniformColor, m_pModel->isFreezed() ? m_colorFreeze : m_colorSignal);
+
+    m_positionBuffer.bind();
+    m_pProgram->enableAttributeArray(m_iAttributePosition);
+    m_pProgram->setAttributeBuffer(m_iAttributePosition, GL_FLOAT, 0, 1);
+
+    m_valueBuffer.bind();
+    m_pProgram->enableAttributeArray(m_iAttributeValue);
+
+    for(int i = iFirst; i <= iLast; ++i) {
+        int row = vecRows[i];
+        const double* pData = m_vecUploadedData[row];
+        if(!pData)
+            continue;
+
+        float fCenter = 1.0f - 2.0f * (i * m_fRowHeight - m_iScrollPosition + m_fRowHeight / 2) / height();
+        float fScaleY = m_fRowHeight / (height() * m_pModel->getMaxValue(row));
+
+        m_pProgram->setAttributeBuffer(m_iAttributeValue, GL_FLOAT, row * m_iRingSize * sizeof(float), 1);
+
+        //The current data is drawn relative to its first sample, the rest of the last data relative to the first sample of the last data
+        if(iCurrentSample > 1) {
+            m_pProgram->setUniformValue(m_iUniformTransform, QVector4D(2.0f / m_iRingSize, fScaleY, fCenter, pData[0]));
+            glDrawArrays(GL_LINE_STRIP, 0, iCurrentSample);
+        }
+
+        if(m_iRingSize - iCurrentSample > 1) {
+            m_pProgram->setUniformValue(m_iUniformTransform, QVector4D(2.0f / m_iRingSize, fScaleY, fCenter, m_pModel->getLastBlockFirstValue(row)));
+            glDrawArrays(GL_LINE_STRIP, iCurrentSample, m_iRingSize - iCurrentSample);
+        }
+    }
+
+    m_pProgram->disableAttributeArray(m_iAttributeValue);
+    m_pProgram->disableAttributeArray(m_iAttributePosition);
+    m_valueBuffer.release();
+    m_pProgram->release();
+
+    //Plot current position marker
+    QPainter painter(this);
+    painter.setPen(m_penMarker);
+
+    float fMarkerX = (float)width() * iCurrentSample / m_iRingSize;
+    painter.drawLine(QPointF(fMarkerX, 0), QPointF(fMarkerX, height()));
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::wheelEvent(QWheelEvent* wheelEvent)
+{
+    m_iScrollPosition -= wheelEvent->angleDelta().y() / 120.0 * m_fRowHeight;
+
+    clampScrollPosition();
+    update();
+
+    wheelEvent->accept();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::mouseDoubleClickEvent(QMouseEvent* mouseEvent)
+{
+    QVector<int> vecRows = shownRows();
+    int i = (mouseEvent->pos().y() + m_iScrollPosition) / m_fRowHeight;
+
+    if(m_pModel && i >= 0 && i < vecRows.size())
+        m_pModel->toggleFreeze(m_pModel->index(vecRows[i],1));
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::cleanupGL()
+{
+    if(!m_pProgram)
+        return;
+
+    makeCurrent();
+    m_positionBuffer.destroy();
+    m_valueBuffer.destroy();
+    m_pProgram.clear();
+    doneCurrent();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::onDataChanged()
+{
+    int iCurrentSample = m_pModel->getCurrentSampleIndex();
+    int iSamples = m_pModel->getMaxSamples();
+
+    //Accumulate the new samples until the next frame, a full ring is the maximum
+    if(iSamples > 0) {
+        int iNewSamples = iCurrentSample - m_iLastSampleIndex;
+        if(iNewSamples < 0)
+            iNewSamples += iSamples;
+
+        m_iPendingSamples = qMin(m_iPendingSamples + iNewSamples, iSamples);
+    }
+
+    m_iLastSampleIndex = iCurrentSample;
+
+    update();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::onModelReset()
+{
+    m_vecUploadedData.fill(Q_NULLPTR);
+    m_iPendingSamples = 0;
+    m_iLastSampleIndex = m_pModel ? m_pModel->getCurrentSampleIndex() : 0;
+
+    clampScrollPosition();
+    update();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::uploadSamples()
+{
+    int iRows = m_pModel->rowCount();
+    int iSamples = m_pModel->getMaxSamples();
+
+    //Reallocate the rings whenever the number of channels or the display length changed
+    if(iRows != m_iNumberRings || iSamples != m_iRingSize) {
+        m_iNumberRings = iRows;
+        m_iRingSize = iSamples;
+        m_vecUploadedData.fill(Q_NULLPTR, iRows);
+
+        if(iRows <= 0 || iSamples <= 0)
+            return;
+
+        QVector<float> vecPositions(iSamples);
+        for(int i = 0; i < iSamples; ++i)
+            vecPositions[i] = i;
+
+        m_positionBuffer.bind();
+        m_positionBuffer.allocate(vecPositions.constData(), iSamples * sizeof(float));
+        m_positionBuffer.release();
+
+        m_valueBuffer.bind();
+        m_valueBuffer.allocate(iRows * iSamples * sizeof(float));
+        m_valueBuffer.release();
+    }
+
+    if(m_iNumberRings <= 0 || m_iRingSize <= 0)
+        return;
+
+    int iCurrentSample = qBound(0, m_pModel->getCurrentSampleIndex(), m_iRingSize);
+
+    m_valueBuffer.bind();
+
+    for(int row = 0; row < m_iNumberRings; ++row) {
+        if(row < m_vecHiddenRows.size() && m_vecHiddenRows[row]) {
+            m_vecUploadedData[row] = Q_NULLPTR;
+            continue;
+        }
+
+        RowVectorPair data = m_pModel->data(m_pModel->index(row,1)).value<RowVectorPair>();
+
+        if(!data.first || data.second != m_iRingSize) {
+            m_vecUploadedData[row] = Q_NULLPTR;
+            continue;
+        }
+
+        //Upload the whole ring if the row shows other data than before (selection, freeze, filter), else only the new samples
+        if(data.first != m_vecUploadedData[row] || m_iPendingSamples >= m_iRingSize) {
+            uploadRow(row, data.first, 0, m_iRingSize);
+        } else if(m_iPendingSamples > 0) {
+            int iFrom = iCurrentSample - m_iPendingSamples;
+
+            if(iFrom >= 0) {
+                uploadRow(row, data.first, iFrom, m_iPendingSamples);
+            } else {
+                uploadRow(row, data.first, iFrom + m_iRingSize, -iFrom);
+                uploadRow(row, data.first, 0, iCurrentSample);
+            }
+        }
+
+        m_vecUploadedData[row] = data.first;
+    }
+
+    m_valueBuffer.release();
+
+    m_iPendingSamples = 0;
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::uploadRow(int row, const double* pData, int from, int count)
+{
+    if(count <= 0)
+        return;
+
+    m_vecUploadBuffer.resize(count);
+    for(int i = 0; i < count; ++i)
+        m_vecUploadBuffer[i] = pData[from + i];
+
+    m_valueBuffer.write((row * m_iRingSize + from) * sizeof(float), m_vecUploadBuffer.constData(), count * sizeof(float));
+}
+
+
+//*************************************************************************************************************
+
+QVector<int> RealTimeMultiSampleArrayGLView::shownRows() const
+{
+    QVector<int> vecRows;
+
+    if(!m_pModel)
+        return vecRows;
+
+    int iRows = m_pModel->rowCount();
+    vecRows.reserve(iRows);
+
+    for(int row = 0; row < iRows; ++row)
+        if(row >= m_vecHiddenRows.size() || !m_vecHiddenRows[row])
+            vecRows.append(row);
+
+    return vecRows;
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayGLView::clampScrollPosition()
+{
+    int iMaxPosition = qMax(0, (int)(shownRows().size() * m_fRowHeight) - height());
+
+    m_iScrollPosition = qBound(0, m_iScrollPosition, iMaxPosition);
+}
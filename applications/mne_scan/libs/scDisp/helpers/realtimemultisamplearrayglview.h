@@ -0,0 +1,258 @@
+//=============================================================================================================
+/**
+* @file     realtimemultisamplearrayglview.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the RealTimeMultiSampleArrayGLView Class.
+*
+*/
+
+#ifndef REALTIMEMULTISAMPLEARRAYGLVIEW_H
+#define REALTIMEMULTISAMPLEARRAYGLVIEW_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QOpenGLWidget>
+#include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QSharedPointer>
+#include <QVector>
+#include <QColor>
+#include <QPen>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class QOpenGLShaderProgram;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCDISPLIB
+//=============================================================================================================
+
+namespace SCDISPLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// SCDISPLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+class RealTimeMultiSampleArrayModel;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS RealTimeMultiSampleArrayGLView
+*
+* @brief The RealTimeMultiSampleArrayGLView class draws the channels of a RealTimeMultiSampleArrayModel as OpenGL
+*        line strips. Every channel owns a ring of the display length in a vertex buffer, of which only the samples
+*        added since the last frame are uploaded. It is an alternative to the RealTimeMultiSampleArrayDelegate.
+*/
+class RealTimeMultiSampleArrayGLView : public QOpenGLWidget, protected QOpenGLFunctions
+{
+    Q_OBJECT
+public:
+    typedef QSharedPointer<RealTimeMultiSampleArrayGLView> SPtr;              /**< Shared pointer type for RealTimeMultiSampleArrayGLView. */
+    typedef QSharedPointer<const RealTimeMultiSampleArrayGLView> ConstSPtr;   /**< Const shared pointer type for RealTimeMultiSampleArrayGLView. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a RealTimeMultiSampleArrayGLView which is a child of parent.
+    *
+    * @param[in] parent     Parent of the view
+    */
+    RealTimeMultiSampleArrayGLView(QWidget *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destroys the RealTimeMultiSampleArrayGLView and releases its OpenGL resources.
+    */
+    ~RealTimeMultiSampleArrayGLView();
+
+    //=========================================================================================================
+    /**
+    * Sets the model whose data is drawn.
+    *
+    * @param[in] pModel     The model
+    */
+    void setModel(RealTimeMultiSampleArrayModel *pModel);
+
+    //=========================================================================================================
+    /**
+    * Sets the height of a single channel row.
+    *
+    * @param[in] fRowHeight     The row height in pixels
+    */
+    void setRowHeight(float fRowHeight);
+
+    //=========================================================================================================
+    /**
+    * Hides or shows a channel row.
+    *
+    * @param[in] row    The row
+    * @param[in] hide   Whether the row is hidden
+    */
+    void setRowHidden(int row, bool hide);
+
+public slots:
+    //=========================================================================================================
+    /**
+    * Set the signal color.
+    *
+    * @param [in] signalColor  The new signal color.
+    */
+    void setSignalColor(const QColor& signalColor);
+
+    //=========================================================================================================
+    /**
+    * Set the background color.
+    *
+    * @param [in] backgroundColor  The new background color.
+    */
+    void setBackgroundColor(const QColor& backgroundColor);
+
+protected:
+    //=========================================================================================================
+    /**
+    * Creates the shader program and the vertex buffers.
+    */
+    virtual void initializeGL();
+
+    //=========================================================================================================
+    /**
+    * Uploads the new samples and draws the visible channel rows.
+    */
+    virtual void paintGL();
+
+    //=========================================================================================================
+    /**
+    * Scrolls through the channel rows.
+    *
+    * @param [in] wheelEvent    pointer to WheelEvent.
+    */
+    virtual void wheelEvent(QWheelEvent* wheelEvent);
+
+    //=========================================================================================================
+    /**
+    * Toggles the freeze state of the model.
+    *
+    * @param [in] mouseEvent    pointer to MouseEvent.
+    */
+    virtual void mouseDoubleClickEvent(QMouseEvent* mouseEvent);
+
+private:
+    //=========================================================================================================
+    /**
+    * Releases the OpenGL resources before the context is destroyed.
+    */
+    void cleanupGL();
+
+    //=========================================================================================================
+    /**
+    * Counts the samples which were added to the model since the last frame.
+    */
+    void onDataChanged();
+
+    //=========================================================================================================
+    /**
+    * Schedules an upload of all samples.
+    */
+    void onModelReset();
+
+    //=========================================================================================================
+    /**
+    * Updates the vertex buffers to the current model data. Only the samples which were added since the last
+    * frame are uploaded, unless the buffers were reallocated or a row points to other data now.
+    */
+    void uploadSamples();
+
+    //=========================================================================================================
+    /**
+    * Uploads a range of samples of a single row into its ring. The value buffer needs to be bound.
+    *
+    * @param[in] row        The row
+    * @param[in] pData      The samples of the row
+    * @param[in] from       The first sample to upload
+    * @param[in] count      The number of samples to upload
+    */
+    void uploadRow(int row, const double* pData, int from, int count);
+
+    //=========================================================================================================
+    /**
+    * Returns the rows which are not hidden, in the order in which they are drawn.
+    *
+    * @return the shown rows
+    */
+    QVector<int> shownRows() const;
+
+    //=========================================================================================================
+    /**
+    * Clamps the scroll position to the height of all shown rows.
+    */
+    void clampScrollPosition();
+
+    RealTimeMultiSampleArrayModel*          m_pModel;               /**< The model whose data is drawn. */
+
+    QSharedPointer<QOpenGLShaderProgram>    m_pProgram;             /**< The shader program which maps the samples to the rows. */
+    QOpenGLBuffer                           m_positionBuffer;       /**< The sample positions 0 ... n-1, shared by all rows. */
+    QOpenGLBuffer                           m_valueBuffer;          /**< The sample rings of all rows, one after the other. */
+    int                                     m_iUniformTransform;    /**< Location of the transform uniform. */
+    int                                     m_iUniformColor;        /**< Location of the color uniform. */
+    int                                     m_iAttributePosition;   /**< Location of the position attribute. */
+    int                                     m_iAttributeValue;      /**< Location of the value attribute. */
+
+    int                                     m_iRingSize;            /**< The number of samples of a ring. */
+    int                                     m_iNumberRings;         /**< The number of rings in m_valueBuffer. */
+    int                                     m_iLastSampleIndex;     /**< The current sample index of the model at the last data change. */
+    int                                     m_iPendingSamples;      /**< The number of samples added since the last upload. */
+    QVector<const double*>                  m_vecUploadedData;      /**< The data each ring was uploaded from, used to detect row, freeze and filter changes. */
+    QVector<float>                          m_vecUploadBuffer;      /**< Conversion buffer for the uploads. */
+    QVector<bool>                           m_vecHiddenRows;        /**< Whether a row is hidden. */
+
+    float                                   m_fRowHeight;           /**< The height of a row in pixels. */
+    int                                     m_iScrollPosition;      /**< The vertical scroll position in pixels. */
+
+    QColor                                  m_colorSignal;          /**< The signal color. */
+    QColor                                  m_colorFreeze;          /**< The signal color while the model is freezed. */
+    QColor                                  m_colorBackground;      /**< The background color. */
+    QPen                                    m_penMarker;            /**< Pen for drawing the current position marker. */
+};
+
+} // NAMESPACE SCDISPLIB
+
+#endif // REALTIMEMULTISAMPLEARRAYGLVIEW_H
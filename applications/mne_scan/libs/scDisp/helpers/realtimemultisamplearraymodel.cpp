@@ -333,6 +333,9 @@ void RealTimeMultiSampleArrayModel::setFiffInfo(FiffInfo::SPtr& p_pFiffInfo)
 
         m_matOverlap.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxFilterLength);
 
+        m_qVecChVisible.fill(true, m_pFiffInfo->chs.size());
+        m_qVecChStale.fill(false, m_pFiffInfo->chs.size());
+
         m_matSparseProjMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
         m_matSparseCompMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
         m_matSparseSpharaMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
@@ -414,7 +417,7 @@ MatrixXd RealTimeMultiSampleArrayModel::getLastBlock()
 
 //*************************************************************************************************************
 
-void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
+void RealTimeMultiSampleArrayModel::addData(const QList<MatrixBlock> &data)
 {
     //SSP
     bool doProj = m_bProjActivated && m_matDataRaw.cols() > 0 && m_matDataRaw.rows() == m_matProj.cols() ? true : false;
@@ -425,10 +428,11 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
     //SPHARA
     bool doSphara = m_bSpharaActivated && m_matSparseSpharaMult.cols() > 0 && m_matDataRaw.rows() == m_matSparseSpharaMult.cols() ? true : false;
 
-    //Copy new data into the global data matrix
+    //Copy new data into the global data matrix, the blocks are read in place
     for(qint32 b = 0; b < data.size(); ++b) {
-        int nCol = data.at(b).cols();
-        int nRow = data.at(b).rows();
+        const MatrixXd& matBlock = data.at(b).matrix();
+        int nCol = matBlock.cols();
+        int nRow = matBlock.rows();
 
         if(nRow != m_matDataRaw.rows()) {
             std::cout<<"incoming data does not match internal data row size. Returning..."<<std::endl;
@@ -451,19 +455,19 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
             if(doComp) {
                 if(doProj) {
                     //Comp + Proj
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjCompMult * data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjCompMult * matBlock.block(0,0,nRow,m_iResidual);
                 } else {
                     //Comp
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseCompMult * data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseCompMult * matBlock.block(0,0,nRow,m_iResidual);
                 }
             } else {
                 if(doProj)
                 {
                     //Proj
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjMult * data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = m_matSparseProjMult * matBlock.block(0,0,nRow,m_iResidual);
                 } else {
                     //None - Raw
-                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = data.at(b).block(0,0,nRow,m_iResidual);
+                    m_matDataRaw.block(0, m_iCurrentSample, nRow, m_iResidual) = matBlock.block(0,0,nRow,m_iResidual);
                 }
             }
 
@@ -494,18 +498,18 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
         if(doComp) {
             if(doProj) {
                 //Comp + Proj
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjCompMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjCompMult * matBlock;
             } else {
                 //Comp
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseCompMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseCompMult * matBlock;
             }
         } else {
             if(doProj) {
                 //Proj
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjMult * data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = m_matSparseProjMult * matBlock;
             } else {
                 //None - Raw
-                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = data.at(b);
+                m_matDataRaw.block(0, m_iCurrentSample, nRow, nCol) = matBlock;
             }
         }
 
@@ -542,8 +546,18 @@ void RealTimeMultiSampleArrayModel::addData(const QList<MatrixXd> &data)
         if(m_bTriggerDetectionActive) {
             int iOldDetectedTriggers = m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].size();
 
-            QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksMax(data.at(b), m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, true);
-            //QList<QPair<int,double> > qMapDetectedTrigger = DetectTrigger::detectTriggerFlanksGrad(data.at(b), m_iCurrentTriggerChIndex, m_iCurrentSample-nCol, m_dTriggerThreshold, false, "Rising");
+            //The detector carries its state over the block borders, it starts over when the trigger channel changes
+            if(!m_pTriggerDetector || m_pTriggerDetector->triggerChannels().first() != m_iCurrentTriggerChIndex) {
+                m_pTriggerDetector = TriggerDetector::SPtr(new TriggerDetector(QList<int>() << m_iCurrentTriggerChIndex, m_dTriggerThreshold, TriggerDetector::LevelMode, true));
+            }
+            m_pTriggerDetector->setThreshold(m_dTriggerThreshold);
+
+            QList<QPair<int,double> > qMapDetectedTrigger;
+            int iEvents = m_pTriggerDetector->detect(matBlock);
+            for(int i = 0; i < iEvents; ++i) {
+                const TriggerDetector::Event& event = m_pTriggerDetector->event(i);
+                qMapDetectedTrigger.append(QPair<int,double>(m_iCurrentSample - nCol + int(event.iSample - m_pTriggerDetector->blockStart()), event.dValue));
+            }
 
             //Append results to already found triggers
             m_qMapDetectedTrigger[m_iCurrentTriggerChIndex].append(qMapDetectedTrigger);
@@ -609,6 +623,67 @@ fiff_int_t RealTimeMultiSampleArrayModel::getCoil(qint32 row) const
 }
 
 
+//*************************************************************************************************************
+
+double RealTimeMultiSampleArrayModel::getMaxValue(qint32 row) const
+{
+    //get maximum range of respective channel type (range value in FiffChInfo does not seem to contain a reasonable value)
+    double dMaxValue = 1e-9f;
+
+    switch(getKind(row)) {
+        case FIFFV_MEG_CH: {
+            qint32 unit = getUnit(row);
+            if(unit == FIFF_UNIT_T_M) { //gradiometers
+                dMaxValue = 1e-10f;
+                if(m_qMapChScaling.contains(FIFF_UNIT_T_M))
+                    dMaxValue = m_qMapChScaling[FIFF_UNIT_T_M];
+            }
+            else if(unit == FIFF_UNIT_T) //magnetometers
+            {
+                dMaxValue = 1e-11f;
+
+                if(m_qMapChScaling.contains(FIFF_UNIT_T))
+                    dMaxValue = m_qMapChScaling[FIFF_UNIT_T];
+            }
+            break;
+        }
+
+        case FIFFV_REF_MEG_CH: {  /*11/04/14 Added by Limin: MEG reference channel */
+            dMaxValue = 1e-11f;
+            if(m_qMapChScaling.contains(FIFF_UNIT_T))
+                dMaxValue = m_qMapChScaling[FIFF_UNIT_T];
+            break;
+        }
+        case FIFFV_EEG_CH: {
+            dMaxValue = 1e-4f;
+            if(m_qMapChScaling.contains(FIFFV_EEG_CH))
+                dMaxValue = m_qMapChScaling[FIFFV_EEG_CH];
+            break;
+        }
+        case FIFFV_EOG_CH: {
+            dMaxValue = 1e-3f;
+            if(m_qMapChScaling.contains(FIFFV_EOG_CH))
+                dMaxValue = m_qMapChScaling[FIFFV_EOG_CH];
+            break;
+        }
+        case FIFFV_STIM_CH: {
+            dMaxValue = 5;
+            if(m_qMapChScaling.contains(FIFFV_STIM_CH))
+                dMaxValue = m_qMapChScaling[FIFFV_STIM_CH];
+            break;
+        }
+        case FIFFV_MISC_CH: {
+            dMaxValue = 1e-3f;
+            if(m_qMapChScaling.contains(FIFFV_MISC_CH))
+                dMaxValue = m_qMapChScaling[FIFFV_MISC_CH];
+            break;
+        }
+    }
+
+    return dMaxValue;
+}
+
+
 //*************************************************************************************************************
 
 void RealTimeMultiSampleArrayModel::selectRows(const QList<qint32> &selection)
@@ -817,6 +892,9 @@ void RealTimeMultiSampleArrayModel::updateCompensator(int to)
 void RealTimeMultiSampleArrayModel::updateSpharaActivation(bool state)
 {
     m_bSpharaActivated = state;
+
+    //SPHARA needs all channels to be filtered
+    updateStaleChannels();
 }
 
 
@@ -905,14 +983,28 @@ void RealTimeMultiSampleArrayModel::updateSpharaOptions(const QString& sSytemTyp
 void RealTimeMultiSampleArrayModel::filterChanged(QList<FilterData> filterData)
 {
     m_filterData = filterData;
+    m_lFIRFilterData.clear();
+    m_matIIRSections.resize(0, 6);
 
+    //IIR filters have no taps and thus no overlap, they are cascaded and keep their state between blocks instead
     m_iMaxFilterLength = 1;
     for(int i=0; i<filterData.size(); ++i) {
+        if(filterData.at(i).isIIR()) {
+            const MatrixXd& sections = filterData.at(i).m_matSOS;
+            m_matIIRSections.conservativeResize(m_matIIRSections.rows() + sections.rows(), 6);
+            m_matIIRSections.bottomRows(sections.rows()) = sections;
+            continue;
+        }
+
+        m_lFIRFilterData.append(filterData.at(i));
+
         if(m_iMaxFilterLength<filterData.at(i).m_iFilterOrder) {
             m_iMaxFilterLength = filterData.at(i).m_iFilterOrder;
         }
     }
 
+    m_biquadCascade.setSections(m_matIIRSections, m_pFiffInfo->chs.size());
+
     m_matOverlap.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxFilterLength);
     m_matOverlap.setZero();
 
@@ -1017,6 +1109,29 @@ void RealTimeMultiSampleArrayModel::createFilterChannelList(QStringList channelN
 }
 
 
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayModel::setVisibleRows(int iFirstRow, int iLastRow)
+{
+    if(m_qVecChVisible.isEmpty())
+        return;
+
+    m_qVecChVisible.fill(false);
+
+    iFirstRow = qMax(iFirstRow, 0);
+    iLastRow = qMin(iLastRow, rowCount()-1);
+
+    for(int row = iFirstRow; row <= iLastRow; ++row) {
+        qint32 iChIdx = m_qMapIdxRowSelection.value(row,0);
+
+        if(iChIdx < m_qVecChVisible.size())
+            m_qVecChVisible[iChIdx] = true;
+    }
+
+    updateStaleChannels();
+}
+
+
 //*************************************************************************************************************
 
 void RealTimeMultiSampleArrayModel::markChBad(QModelIndex ch, bool status)
@@ -1132,10 +1247,24 @@ void doFilterPerChannelRTMSA(QPair<QList<FilterData>,QPair<int,RowVectorXd> > &c
 //*************************************************************************************************************
 
 void RealTimeMultiSampleArrayModel::filterChannelsConcurrently()
+{
+    QList<int> lChannels;
+
+    for(qint32 i = 0; i < m_matDataRaw.rows(); ++i) {
+        lChannels.append(i);
+    }
+
+    filterChannelsConcurrently(lChannels);
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayModel::filterChannelsConcurrently(const QList<int>& lChannels)
 {
     //std::cout<<"START RealTimeMultiSampleArrayModel::filterChannelsConcurrently"<<std::endl;
 
-    if(m_filterData.isEmpty())
+    if(m_filterData.isEmpty() || lChannels.isEmpty())
         return;
 
     //Create temporary filters with higher fft length because we are going to filter all available data at once for one time
@@ -1145,16 +1274,16 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently()
     int exp = ceil(MNEMath::log2(fftLength));
     fftLength = pow(2, exp) < 512 ? 512 : pow(2, exp);
 
-    for(int i = 0; i<m_filterData.size(); ++i) {
-        FilterData tempFilter(m_filterData.at(i).m_sName,
-                              m_filterData.at(i).m_Type,
-                              m_filterData.at(i).m_iFilterOrder,
-                              m_filterData.at(i).m_dCenterFreq,
-                              m_filterData.at(i).m_dBandwidth,
-                              m_filterData.at(i).m_dParksWidth,
-                              m_filterData.at(i).m_sFreq,
+    for(int i = 0; i<m_lFIRFilterData.size(); ++i) {
+        FilterData tempFilter(m_lFIRFilterData.at(i).m_sName,
+                              m_lFIRFilterData.at(i).m_Type,
+                              m_lFIRFilterData.at(i).m_iFilterOrder,
+                              m_lFIRFilterData.at(i).m_dCenterFreq,
+                              m_lFIRFilterData.at(i).m_dBandwidth,
+                              m_lFIRFilterData.at(i).m_dParksWidth,
+                              m_lFIRFilterData.at(i).m_sFreq,
                               fftLength,
-                              m_filterData.at(i).m_designMethod);
+                              m_lFIRFilterData.at(i).m_designMethod);
 
         tempFilterList.append(tempFilter);
     }
@@ -1164,10 +1293,17 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently()
     QList<int> notFilterChannelIndex;
 
     //Also append mirrored data in front and back to get rid of edge effects
-    for(qint32 i=0; i<m_matDataRaw.rows(); ++i) {
+    for(int c = 0; c < lChannels.size(); ++c) {
+        qint32 i = lChannels.at(c);
+
         if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name)) {
             RowVectorXd datTemp(m_matDataRaw.row(i).cols() + 2 * m_iMaxFilterLength);
             datTemp << m_matDataRaw.row(i).head(m_iMaxFilterLength).reverse(), m_matDataRaw.row(i), m_matDataRaw.row(i).tail(m_iMaxFilterLength).reverse();
+
+            //IIR filters run causally like in the block-wise path, they do not change the length of the data
+            if(m_matIIRSections.rows() > 0)
+                datTemp = BiquadCascade::filterRow(m_matIIRSections, datTemp, false);
+
             timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(tempFilterList,QPair<int,RowVectorXd>(i,datTemp)));
         }
         else
@@ -1192,7 +1328,9 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently()
         m_matDataFiltered.row(notFilterChannelIndex.at(i)) = m_matDataRaw.row(notFilterChannelIndex.at(i));
 
     if(!m_bIsFreezed) {
-        m_vecLastBlockFirstValuesFiltered = m_matDataFiltered.col(0);
+        for(int c = 0; c < lChannels.size(); ++c) {
+            m_vecLastBlockFirstValuesFiltered[lChannels.at(c)] = m_matDataFiltered(lChannels.at(c), 0);
+        }
     }
 
     //std::cout<<"END RealTimeMultiSampleArrayModel::filterChannelsConcurrently"<<std::endl;
@@ -1208,15 +1346,34 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently(const MatrixXd &d
     if(iDataIndex >= m_matDataFiltered.cols() || data.cols() < m_iMaxFilterLength)
         return;
 
+    //IIR filters run causally on all channels, also the deferred ones, so their state stays continuous from block to block
+    MatrixXd matData = data;
+    if(m_matIIRSections.rows() > 0) {
+        if(m_biquadCascade.channels() != matData.rows())
+            m_biquadCascade.setSections(m_matIIRSections, matData.rows());
+
+        m_biquadCascade.filter(matData, matData);
+    }
+
     //Generate QList structure which can be handled by the QConcurrent framework
     QList<QPair<QList<FilterData>,QPair<int,RowVectorXd> > > timeData;
     QList<int> notFilterChannelIndex;
 
-    for(qint32 i = 0; i < data.rows(); ++i) {
-        if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name))
-            timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(m_filterData,QPair<int,RowVectorXd>(i,data.row(i))));
-        else
+    for(qint32 i = 0; i < matData.rows(); ++i) {
+        //Channels which are out of view are filtered as a whole once they are scrolled into view again
+        if(isChannelDeferred(i)) {
+            m_qVecChStale[i] = true;
+            continue;
+        }
+
+        if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name)) {
+            if(m_lFIRFilterData.isEmpty())
+                m_matDataFiltered.row(i).segment(iDataIndex,matData.cols()) = matData.row(i);
+            else
+                timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(m_lFIRFilterData,QPair<int,RowVectorXd>(i,matData.row(i))));
+        } else {
             notFilterChannelIndex.append(i);
+        }
     }
 
     //Do the concurrent filtering
@@ -1314,6 +1471,28 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently(const MatrixXd &d
 }
 
 
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayModel::updateStaleChannels()
+{
+    QList<int> lChannels;
+
+    for(int i = 0; i < m_qVecChStale.size(); ++i) {
+        if(m_qVecChStale[i] && !isChannelDeferred(i)) {
+            lChannels.append(i);
+            m_qVecChStale[i] = false;
+        }
+    }
+
+    if(lChannels.isEmpty() || m_filterData.isEmpty())
+        return;
+
+    filterChannelsConcurrently(lChannels);
+
+    emit dataChanged(createIndex(0,1), createIndex(rowCount()-1,1));
+}
+
+
 //*************************************************************************************************************
 
 void RealTimeMultiSampleArrayModel::clearModel()
@@ -1327,6 +1506,7 @@ void RealTimeMultiSampleArrayModel::clearModel()
     m_vecLastBlockFirstValuesFiltered.setZero();
     m_vecLastBlockFirstValuesRaw.setZero();
     m_matOverlap.setZero();
+    m_biquadCascade.reset();
 
     endResetModel();
 
@@ -43,12 +43,15 @@
 //=============================================================================================================
 
 #include <scMeas/realtimesamplearraychinfo.h>
+#include <scMeas/matrixblock.h>
 #include <fiff/fiff_types.h>
 #include <fiff/fiff_info.h>
 
 #include <utils/filterTools/filterdata.h>
+#include <utils/filterTools/biquadcascade.h>
 #include <utils/mnemath.h>
 #include <utils/detecttrigger.h>
+#include <utils/triggerdetector.h>
 #include <utils/ioutils.h>
 #include <utils/filterTools/sphara.h>
 
@@ -63,6 +66,7 @@
 #include <QtConcurrent/QtConcurrent>
 #include <QFuture>
 #include <QColor>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -197,9 +201,9 @@ public:
     /**
     * Adds multiple time points (QVector) for a channel set (VectorXd)
     *
-    * @param[in] data       data to add (Time points of channel samples)
+    * @param[in] data       data to add (Time points of channel samples), the shared blocks are not copied
     */
-    void addData(const QList<MatrixXd> &data);
+    void addData(const QList<MatrixBlock> &data);
 
     //=========================================================================================================
     /**
@@ -231,6 +235,17 @@ public:
     */
     fiff_int_t getCoil(qint32 row) const;
 
+    //=========================================================================================================
+    /**
+    * Returns the amplitude which is mapped to half of the row height for a given channel number. The value is
+    * taken from the current scaling of the channel type.
+    *
+    * @param[in] row    row number which correspodns to a given channel
+    *
+    * @return maximum value to plot of given channel number
+    */
+    double getMaxValue(qint32 row) const;
+
     //=========================================================================================================
     /**
     * Returns the maximal number of samples of the downsampled data to display
@@ -463,6 +478,16 @@ public:
     */
     void createFilterChannelList(QStringList channelNames);
 
+    //=========================================================================================================
+    /**
+    * Sets the range of rows which are currently shown in the view. The display filtering of all other channels
+    * is deferred and caught up on as soon as they are scrolled into view.
+    *
+    * @param[in] iFirstRow    the first visible row
+    * @param[in] iLastRow     the last visible row
+    */
+    void setVisibleRows(int iFirstRow, int iLastRow);
+
     //=========================================================================================================
     /**
     * markChBad marks the selected channels as bad/good in m_chInfolist
@@ -525,6 +550,30 @@ private:
     */
     void filterChannelsConcurrently();
 
+    //=========================================================================================================
+    /**
+    * Calculates the filtered version of the given channels in m_matDataRaw
+    *
+    * @param [in] lChannels     indices of the channels which are to be filtered
+    */
+    void filterChannelsConcurrently(const QList<int>& lChannels);
+
+    //=========================================================================================================
+    /**
+    * Filters all channels whose filtered data is outdated and which are not deferred anymore.
+    */
+    void updateStaleChannels();
+
+    //=========================================================================================================
+    /**
+    * Returns whether the display filtering of a channel is currently deferred because it is not in view.
+    *
+    * @param [in] iChIdx    the channel index
+    *
+    * @return whether the channel is deferred
+    */
+    inline bool isChannelDeferred(int iChIdx) const;
+
     //=========================================================================================================
     /**
     * Calculates the filtered version of the raw input data
@@ -598,15 +647,21 @@ private:
     QMap<double, QColor>                m_qMapTriggerColor;                         /**< Current colors for all trigger channels. */
     QMap<int,QList<QPair<int,double> > >m_qMapDetectedTrigger;                      /**< Detected trigger for each trigger channel. */
     QList<int>                          m_lTriggerChannelIndices;                   /**< List of all trigger channel indices. */
+    TriggerDetector::SPtr               m_pTriggerDetector;                         /**< Trigger flank detection of the current trigger channel, carries its state from block to block. */
     QMap<int,QList<QPair<int,double> > >m_qMapDetectedTriggerFreeze;                /**< Detected trigger for each trigger channel while display is freezed. */
     QMap<int,QList<QPair<int,double> > >m_qMapDetectedTriggerOld;                   /**< Old detected trigger for each trigger channel. */
     QMap<int,QList<QPair<int,double> > >m_qMapDetectedTriggerOldFreeze;             /**< Old detected trigger for each trigger channel while display is freezed. */
     QMap<qint32,float>                  m_qMapChScaling;                            /**< Channel scaling map. */
     QList<FilterData>                   m_filterData;                               /**< List of currently active filters. */
+    QList<FilterData>                   m_lFIRFilterData;                           /**< The FIR filters of m_filterData, applied block by block with overlap-add. */
+    MatrixXd                            m_matIIRSections;                           /**< Second-order sections of all IIR filters of m_filterData. */
+    BiquadCascade                       m_biquadCascade;                            /**< Runs m_matIIRSections on all channels and carries the filter state from block to block. */
     QList<RealTimeSampleArrayChInfo>    m_qListChInfo;                              /**< Channel info list. ToDo: Obsolete*/
     QStringList                         m_filterChannelList;                        /**< List of channels which are to be filtered.*/
     QStringList                         m_visibleChannelList;                       /**< List of currently visible channels in the view.*/
     QMap<qint32,qint32>                 m_qMapIdxRowSelection;                      /**< Selection mapping.*/
+    QVector<bool>                       m_qVecChVisible;                            /**< Whether a channel is currently shown in the view.*/
+    QVector<bool>                       m_qVecChStale;                              /**< Whether the filtered data of a channel is outdated because its filtering was deferred.*/
 
 signals:
     //=========================================================================================================
@@ -788,6 +843,18 @@ inline int RealTimeMultiSampleArrayModel::getCurrentTriggerIndex() const
 }
 
 
+//*************************************************************************************************************
+
+inline bool RealTimeMultiSampleArrayModel::isChannelDeferred(int iChIdx) const
+{
+    //SPHARA mixes all channels, hence nothing can be deferred while it is active
+    if(m_bSpharaActivated || iChIdx >= m_qVecChVisible.size())
+        return false;
+
+    return !m_qVecChVisible[iChIdx];
+}
+
+
 //*************************************************************************************************************
 
 inline bool RealTimeMultiSampleArrayModel::triggerDetectionActive() const
@@ -396,12 +396,14 @@ void HPIWidget::alignFiducials(const QString& fileNameDigData)
     QFile t_fileDigDataReference("./resources/general/hpiAlignment/fsaverage-fiducials.fif");
     FiffDigitizerData* t_digDataReference = new FiffDigitizerData(t_fileDigDataReference);
 
+    //Stop refining once the RMS distance changes less than 0.1 mm
     MneSurfaceOrVolume::align_fiducials(t_digData,
                                         t_digDataReference,
                                         surface,
                                         10,
                                         1,
-                                        0);
+                                        0,
+                                        1e-4f);
 
     QMatrix4x4 mat;
     for(int r = 0; r < 3; ++r) {
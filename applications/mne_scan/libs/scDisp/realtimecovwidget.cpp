@@ -97,6 +97,7 @@ RealTimeCovWidget::RealTimeCovWidget(QSharedPointer<RealTimeCov> pRTC, QSharedPo
 : NewMeasurementWidget(parent)
 , m_pRTC(pRTC)
 , m_bInitialized(false)
+, m_bDataPending(false)
 {
     Q_UNUSED(pTime)
 
@@ -149,18 +150,47 @@ void RealTimeCovWidget::update(SCMEASLIB::NewMeasurement::SPtr)
 
 void RealTimeCovWidget::getData()
 {
+    //Only the latest covariance is shown, so hidden updates are skipped
+    if(!isVisible()) {
+        m_bDataPending = true;
+        return;
+    }
+
+    m_bDataPending = false;
+
     if(!m_bInitialized || m_pRTC->getValue()->names.size() != m_qListChNames.size())
         if(m_pRTC->isInitialized())
             init();
 
     if(m_bInitialized)
     {
-        MatrixXd data = (m_matSelectorT * m_pRTC->getValue()->data) * m_matSelector;
-        m_pImageSc->updateData(data);
+        //Pick the channels by index, the full covariance is not copied
+        const MatrixXd& matCov = m_pRTC->getValue()->data;
+        qint32 iNumSel = m_qListSelChannel.size();
+
+        if(m_matSelected.rows() != iNumSel)
+            m_matSelected.resize(iNumSel, iNumSel);
+
+        for(qint32 j = 0; j < iNumSel; ++j)
+            for(qint32 i = 0; i < iNumSel; ++i)
+                m_matSelected(i,j) = matCov(m_qListSelChannel[i], m_qListSelChannel[j]);
+
+        m_pImageSc->updateData(m_matSelected);
     }
 }
 
 
+//*************************************************************************************************************
+
+void RealTimeCovWidget::showEvent(QShowEvent* event)
+{
+    NewMeasurementWidget::showEvent(event);
+
+    if(m_bDataPending)
+        getData();
+}
+
+
 //*************************************************************************************************************
 
 void RealTimeCovWidget::init()
@@ -174,22 +204,15 @@ void RealTimeCovWidget::init()
 
         m_qListChNames = m_pRTC->getValue()->names;
 
-        QList<qint32> qListSelChannel;
+        m_qListSelChannel.clear();
         for(qint32 i = 0; i < m_qListChNames.size(); ++i)
         {
             foreach (const QString &type, m_qListPickTypes) {
-                if (m_qListChNames[i].contains(type))
-                    qListSelChannel.append(i);
+                if (m_qListChNames[i].contains(type) && i < m_pRTC->getValue()->data.cols())
+                    m_qListSelChannel.append(i);
             }
         }
 
-        m_matSelector = MatrixXd::Zero(m_pRTC->getValue()->data.cols(), qListSelChannel.size());
-
-        for(qint32 i = 0; i  < qListSelChannel.size(); ++i)
-            m_matSelector(qListSelChannel[i],i) = 1;
-
-        m_matSelectorT = m_matSelector.transpose();
-
         m_bInitialized = true;
     }
 }
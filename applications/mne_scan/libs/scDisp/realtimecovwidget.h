@@ -165,6 +165,15 @@ public:
     */
     void showModalitySelectionWidget();
 
+protected:
+    //=========================================================================================================
+    /**
+    * Catches up on the data which arrived while the widget was hidden.
+    *
+    * @param [in] event     the show event.
+    */
+    virtual void showEvent(QShowEvent* event);
+
 private:
     QSharedPointer<RealTimeCov> m_pRTC;                     /**< The real-time covariance measurement. */
 
@@ -177,8 +186,9 @@ private:
     QStringList m_qListChNames;                 /**< Channel names */
 
     QStringList m_qListPickTypes;               /**< Channel Types to pick */
-    MatrixXd m_matSelector;                     /**< Selction matrix */
-    MatrixXd m_matSelectorT;                    /**< Transposed selction matrix */
+    QList<qint32> m_qListSelChannel;            /**< Indices of the picked channels */
+    MatrixXd m_matSelected;                     /**< The covariance of the picked channels */
+    bool m_bDataPending;                        /**< Whether data arrived while the widget was hidden */
 
     ImageSc* m_pImageSc;                        /**< The covariance colormap */
 
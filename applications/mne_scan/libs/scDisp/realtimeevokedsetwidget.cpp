@@ -113,6 +113,7 @@ RealTimeEvokedSetWidget::RealTimeEvokedSetWidget(QSharedPointer<RealTimeEvokedSe
 , m_pFilterWindow(Q_NULLPTR)
 , m_pFiffInfo(Q_NULLPTR)
 , m_bInitialized(false)
+, m_bDataPending(false)
 {
     Q_UNUSED(pTime)
     //qRegisterMetaType<SCDISPLIB::AverageInfoMap>("SCDISPLIB::AverageInfoMap");
@@ -134,6 +135,24 @@ RealTimeEvokedSetWidget::RealTimeEvokedSetWidget(QSharedPointer<RealTimeEvokedSe
     addDisplayAction(m_pActionQuickControl);
     m_pActionQuickControl->setVisible(false);
 
+    m_pActionDensity = new QAction(tr("Density"),this);
+    m_pActionDensity->setCheckable(true);
+    m_pActionDensity->setStatusTip(tr("Rasterize the butterfly plot into a density image"));
+    m_pActionDensity->setToolTip(tr("Rasterize the butterfly plot into a density image"));
+    connect(m_pActionDensity, &QAction::toggled,
+            this, &RealTimeEvokedSetWidget::onDensityModeChanged);
+    addDisplayAction(m_pActionDensity);
+    m_pActionDensity->setVisible(false);
+
+    m_pActionDensityModality = new QAction(tr("Modality colors"),this);
+    m_pActionDensityModality->setCheckable(true);
+    m_pActionDensityModality->setStatusTip(tr("Color the butterfly density per modality"));
+    m_pActionDensityModality->setToolTip(tr("Color the butterfly density per modality"));
+    connect(m_pActionDensityModality, &QAction::toggled,
+            this, &RealTimeEvokedSetWidget::onDensityModeChanged);
+    addDisplayAction(m_pActionDensityModality);
+    m_pActionDensityModality->setVisible(false);
+
     //set vertical layout
     m_pRTESetLayout = new QVBoxLayout(this);
 
@@ -248,6 +267,10 @@ RealTimeEvokedSetWidget::~RealTimeEvokedSetWidget()
             settings.setValue(QString("RTESW/%1/butterflyBackgroundColor").arg(t_sRTESWName), m_pButterflyPlot->getBackgroundColor());
             settings.setValue(QString("RTESW/%1/layoutBackgroundColor").arg(t_sRTESWName), m_pAverageScene->backgroundBrush().color());
         }
+
+        //Store butterfly density mode
+        settings.setValue(QString("RTESW/%1/butterflyDensityMode").arg(t_sRTESWName), m_pButterflyPlot->isDensityMode());
+        settings.setValue(QString("RTESW/%1/butterflyDensityModalityColors").arg(t_sRTESWName), m_pButterflyPlot->hasDensityModalityColors());
     }
 }
 
@@ -264,6 +287,14 @@ void RealTimeEvokedSetWidget::update(SCMEASLIB::NewMeasurement::SPtr)
 
 void RealTimeEvokedSetWidget::getData()
 {
+    //The evoked set always holds the complete averages, so hidden updates are skipped
+    if(!isVisible()) {
+        m_bDataPending = true;
+        return;
+    }
+
+    m_bDataPending = false;
+
     if(!m_bInitialized) {
         if(m_pRTESet->isInitialized()) {
             m_qListChInfo = m_pRTESet->chInfo();
@@ -593,6 +624,19 @@ void RealTimeEvokedSetWidget::init()
 
         m_pButterflyPlot->setBackgroundColor(settings.value(QString("RTESW/%1/butterflyBackgroundColor").arg(t_sRTESWName), butterflyBackgroundDefault).value<QColor>());
 
+        //Rasterize the butterfly plot for large channel counts
+        m_pActionDensity->blockSignals(true);
+        m_pActionDensityModality->blockSignals(true);
+        m_pActionDensity->setChecked(settings.value(QString("RTESW/%1/butterflyDensityMode").arg(t_sRTESWName), false).toBool());
+        m_pActionDensityModality->setChecked(settings.value(QString("RTESW/%1/butterflyDensityModalityColors").arg(t_sRTESWName), false).toBool());
+        m_pActionDensity->blockSignals(false);
+        m_pActionDensityModality->blockSignals(false);
+
+        onDensityModeChanged();
+
+        m_pActionDensity->setVisible(true);
+        m_pActionDensityModality->setVisible(true);
+
         //Initialized
         m_bInitialized = true;
     }
@@ -669,6 +713,16 @@ void RealTimeEvokedSetWidget::showQuickControlWidget()
 }
 
 
+//*************************************************************************************************************
+
+void RealTimeEvokedSetWidget::onDensityModeChanged()
+{
+    if(m_pButterflyPlot) {
+        m_pButterflyPlot->setDensityMode(m_pActionDensity->isChecked(), m_pActionDensityModality->isChecked());
+    }
+}
+
+
 //*************************************************************************************************************
 
 void RealTimeEvokedSetWidget::onSelectionChanged()
@@ -805,6 +859,18 @@ void RealTimeEvokedSetWidget::onMakeScreenshot(const QString& imageType)
 }
 
 
+//*************************************************************************************************************
+
+void RealTimeEvokedSetWidget::showEvent(QShowEvent * event)
+{
+    NewMeasurementWidget::showEvent(event);
+
+    if(m_bDataPending) {
+        getData();
+    }
+}
+
+
 //*************************************************************************************************************
 
 void RealTimeEvokedSetWidget::wheelEvent(QWheelEvent * event)
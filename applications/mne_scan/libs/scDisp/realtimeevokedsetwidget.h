@@ -123,6 +123,10 @@ using namespace DISPLIB;
 /**
 * DECLARE CLASS RealTimeMultiSampleArrayNewWidget
 *
+* The butterfly plot can draw the traces as paths or rasterize them into a density image. The mode is selected with
+* the density display actions and is stored per display in the RTESW/<name>/butterflyDensityMode and
+* RTESW/<name>/butterflyDensityModalityColors settings.
+*
 * @brief The RealTimeMultiSampleArrayNewWidget class provides a real-time curve display.
 */
 class SCDISPSHARED_EXPORT RealTimeEvokedSetWidget : public NewMeasurementWidget
@@ -212,6 +216,12 @@ private slots:
     */
     void showQuickControlWidget();
 
+    //=========================================================================================================
+    /**
+    * Passes the state of the density actions on to the butterfly plot
+    */
+    void onDensityModeChanged();
+
     //=========================================================================================================
     /**
     * call this function whenever a selection was made in teh evoked data set list
@@ -247,6 +257,12 @@ private:
     */
     virtual void wheelEvent(QWheelEvent * event);    
 
+    //=========================================================================================================
+    /**
+    * Reimplemented showEvent, catches up on the data which arrived while the widget was hidden
+    */
+    virtual void showEvent(QShowEvent * event);
+
     //=========================================================================================================
     /**
     * Reimplemented eventFilter
@@ -263,6 +279,7 @@ private:
     FilterWindow::SPtr                  m_pFilterWindow;            /**< Filter window. */
 
     bool                                m_bInitialized;             /**< Is Initialized */
+    bool                                m_bDataPending;             /**< Whether data arrived while the widget was hidden */
     bool                                m_bHideBadChannels;         /**< hide bad channels flag. */
     qint32                              m_iMaxFilterTapSize;        /**< maximum number of allowed filter taps. This number depends on the size of the receiving blocks. */
 
@@ -270,6 +287,8 @@ private:
 
     QAction*                            m_pActionSelectSensors;     /**< show roi select widget */
     QAction*                            m_pActionQuickControl;      /**< Show quick control widget. */
+    QAction*                            m_pActionDensity;           /**< Rasterize the butterfly plot into a density image. */
+    QAction*                            m_pActionDensityModality;   /**< Color the butterfly density per modality. */
 
     QVBoxLayout*                        m_pRTESetLayout;            /**< RTE Widget layout */
     QLabel*                             m_pLabelInit;               /**< Initialization Label */
@@ -50,6 +50,7 @@
 
 #include "helpers/realtimemultisamplearraymodel.h"
 #include "helpers/realtimemultisamplearraydelegate.h"
+#include "helpers/realtimemultisamplearrayglview.h"
 #include "helpers/quickcontrolwidget.h"
 
 #include <disp/filterwindow.h>
@@ -57,6 +58,7 @@
 #include <disp/helpers/chinfomodel.h>
 
 #include <scMeas/newrealtimemultisamplearray.h>
+#include <scMeas/latencymonitor.h>
 
 #include <mne/mne_bem.h>
 
@@ -74,6 +76,7 @@
 #include <QMenu>
 #include <QAction>
 #include <QHeaderView>
+#include <QScrollBar>
 
 
 //*************************************************************************************************************
@@ -105,6 +108,7 @@ RealTimeMultiSampleArrayWidget::RealTimeMultiSampleArrayWidget(QSharedPointer<Ne
 , m_fSamplingRate(1024)
 , m_bHideBadChannels(false)
 , m_iMaxFilterTapSize(0)
+, m_pGLView(Q_NULLPTR)
 , m_pRtEEGSensorDataItem(Q_NULLPTR)
 , m_pRtMEGSensorDataItem(Q_NULLPTR)
 , m_bVisualize3DSensorData(false)
@@ -133,6 +137,16 @@ RealTimeMultiSampleArrayWidget::RealTimeMultiSampleArrayWidget(QSharedPointer<Ne
     addDisplayAction(m_pActionQuickControl);
     m_pActionQuickControl->setVisible(true);
 
+    bool bOpenGLRendering = QSettings().value(QString("RTMSAW/%1/openGLRendering").arg(m_pRTMSA->getName()), false).toBool();
+
+    m_pActionOpenGL = new QAction(tr("OpenGL"),this);
+    m_pActionOpenGL->setCheckable(true);
+    m_pActionOpenGL->setChecked(bOpenGLRendering);
+    m_pActionOpenGL->setStatusTip(tr("Draw the traces with OpenGL, takes effect when the display is opened the next time"));
+    m_pActionOpenGL->setToolTip(tr("Draw the traces with OpenGL, takes effect when the display is opened the next time"));
+    addDisplayAction(m_pActionOpenGL);
+    m_pActionOpenGL->setVisible(true);
+
     //Create toolboxes with table view and real-time interpolation plot
     m_pToolBox = QSharedPointer<QToolBox>::create(this);
     m_pToolBox->hide();
@@ -144,6 +158,10 @@ RealTimeMultiSampleArrayWidget::RealTimeMultiSampleArrayWidget(QSharedPointer<Ne
     m_pTableView->viewport()->installEventFilter(this);
     m_pTableView->setMouseTracking(true);
 
+    //OpenGL trace view
+    if(bOpenGLRendering)
+        m_pGLView = new RealTimeMultiSampleArrayGLView();
+
     //Sensor interpolation view
     if(m_bVisualize3DSensorData) {
         m_pAction3DControl = new QAction(QIcon(":/images/3DControl.png"), tr("Shows the 3D control widget (F9)"),this);
@@ -173,6 +191,9 @@ RealTimeMultiSampleArrayWidget::RealTimeMultiSampleArrayWidget(QSharedPointer<Ne
     //Add views to toolbox
     m_pToolBox->insertItem(0, m_pTableView, QIcon(), "Signal time plot");
 
+    if(m_pGLView)
+        m_pToolBox->insertItem(0, m_pGLView, QIcon(), "Signal time plot (OpenGL)");
+
     m_pToolBox->setCurrentIndex(0);
 
     //set layout
@@ -241,6 +262,9 @@ RealTimeMultiSampleArrayWidget::~RealTimeMultiSampleArrayWidget()
         //Store show/hide bad channel flag
         settings.setValue(QString("RTMSAW/%1/showHideBad").arg(t_sRTMSAWName), m_bHideBadChannels);
 
+        //Store rendering backend
+        settings.setValue(QString("RTMSAW/%1/openGLRendering").arg(t_sRTMSAWName), m_pActionOpenGL->isChecked());
+
         //Store selected layout file
         if(m_pSelectionManagerWindow) {
             settings.setValue(QString("RTMSAW/%1/selectedLayoutFile").arg(t_sRTMSAWName), m_pSelectionManagerWindow->getCurrentLayoutFile());
@@ -317,6 +341,8 @@ void RealTimeMultiSampleArrayWidget::update(SCMEASLIB::NewMeasurement::SPtr)
         //Add data to table view
         m_pRTMSAModel->addData(m_pRTMSA->getMultiSampleArray());
 
+        LatencyMonitor::record(QString("Display/%1").arg(m_pRTMSA->getName()), m_pRTMSA->getTimestamp());
+
         //Add data to 3D interpolation
         if(m_bVisualize3DSensorData) {
             //Get data from model since we also want to interpolate the processed data
@@ -436,8 +462,19 @@ void RealTimeMultiSampleArrayWidget::init()
 
         m_pTableView->setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
 
-//        connect(m_pTableView->verticalScrollBar(), &QScrollBar::valueChanged,
-//                this, &RealTimeMultiSampleArrayWidget::visibleRowsChanged);
+        if(m_pGLView) {
+            m_pGLView->setModel(m_pRTMSAModel.data());
+            m_pGLView->setRowHeight(m_fZoomFactor*m_fDefaultSectionSize);
+        }
+
+        //Only the channels in the viewport are filtered, the others catch up once they are scrolled into view
+        connect(m_pTableView->verticalScrollBar(), &QScrollBar::valueChanged,
+                this, &RealTimeMultiSampleArrayWidget::visibleRowsChanged);
+        connect(m_pTableView->verticalScrollBar(), &QScrollBar::rangeChanged,
+                this, [this](int min, int max) {
+                    Q_UNUSED(min)
+                    visibleRowsChanged(max);
+                });
 
         if(settings.value(QString("RTMSAW/%1/showHideBad").arg(t_sRTMSAWName), false).toBool())
             hideBadChannels();
@@ -452,6 +489,8 @@ void RealTimeMultiSampleArrayWidget::init()
 
         this->onTableViewBackgroundColorChanged(background);
         m_pRTMSADelegate->setSignalColor(signal);
+        if(m_pGLView)
+            m_pGLView->setSignalColor(signal);
 
         //
         //-------- Init context menu --------
@@ -597,6 +636,10 @@ void RealTimeMultiSampleArrayWidget::init()
         connect(m_pQuickControlWidget.data(), &QuickControlWidget::signalColorChanged,
                 m_pRTMSADelegate.data(), &RealTimeMultiSampleArrayDelegate::setSignalColor);
 
+        if(m_pGLView)
+            connect(m_pQuickControlWidget.data(), &QuickControlWidget::signalColorChanged,
+                    m_pGLView, &RealTimeMultiSampleArrayGLView::setSignalColor);
+
         //Handle background color changes
         connect(m_pQuickControlWidget.data(), &QuickControlWidget::backgroundColorChanged,
                 this, &RealTimeMultiSampleArrayWidget::onTableViewBackgroundColorChanged);
@@ -727,6 +770,8 @@ void RealTimeMultiSampleArrayWidget::channelContextMenu(QPoint pos)
 void RealTimeMultiSampleArrayWidget::resizeEvent(QResizeEvent* resizeEvent)
 {
     Q_UNUSED(resizeEvent)
+
+    visibleRowsChanged(0);
 }
 
 
@@ -814,6 +859,9 @@ void RealTimeMultiSampleArrayWidget::zoomChanged(double zoomFac)
     m_fZoomFactor = zoomFac;
 
     m_pTableView->verticalHeader()->setDefaultSectionSize(m_fZoomFactor*m_fDefaultSectionSize);//Row Height
+
+    if(m_pGLView)
+        m_pGLView->setRowHeight(m_fZoomFactor*m_fDefaultSectionSize);
 }
 
 
@@ -835,13 +883,13 @@ void RealTimeMultiSampleArrayWidget::applySelection()
     for(int i = 0; i<m_pRTMSAModel->rowCount(); i++) {
         //if channel is a bad channel and bad channels are to be hidden -> do not show
         if(m_qListCurrentSelection.contains(i))
-            m_pTableView->showRow(i);
+            setRowHidden(i, false);
         else
-            m_pTableView->hideRow(i);
+            setRowHidden(i, true);
     }
 
     //Update the visible channel list which are to be filtered
-    //visibleRowsChanged(0);
+    visibleRowsChanged(0);
 
     //m_pRTMSAModel->selectRows(m_qListCurrentSelection);
 }
@@ -852,10 +900,10 @@ void RealTimeMultiSampleArrayWidget::applySelection()
 void RealTimeMultiSampleArrayWidget::hideSelection()
 {
     for(int i=0; i<m_qListCurrentSelection.size(); i++)
-        m_pTableView->hideRow(m_qListCurrentSelection.at(i));
+        setRowHidden(m_qListCurrentSelection.at(i), true);
 
     //Update the visible channel list which are to be filtered
-    //visibleRowsChanged(0);
+    visibleRowsChanged(0);
 }
 
 
@@ -867,16 +915,16 @@ void RealTimeMultiSampleArrayWidget::resetSelection()
     for(qint32 i = 0; i < m_qListChInfo.size(); ++i) {
         if(m_qListBadChannels.contains(i)) {
             if(!m_bHideBadChannels) {
-                m_pTableView->showRow(i);
+                setRowHidden(i, false);
             }
         }
         else {
-            m_pTableView->showRow(i);
+            setRowHidden(i, false);
         }
     }
 
     //Update the visible channel list which are to be filtered
-    //visibleRowsChanged(0);
+    visibleRowsChanged(0);
 }
 
 
@@ -892,13 +940,13 @@ void RealTimeMultiSampleArrayWidget::showSelectedChannelsOnly(QStringList select
 
         //if channel is a bad channel and bad channels are to be hidden -> do not show
         if(!selectedChannels.contains(channel) || (m_qListBadChannels.contains(i) && m_bHideBadChannels))
-            m_pTableView->hideRow(i);
+            setRowHidden(i, true);
         else
-            m_pTableView->showRow(i);
+            setRowHidden(i, false);
     }
 
     //Update the visible channel list which are to be filtered
-    //visibleRowsChanged(0);
+    visibleRowsChanged(0);
 }
 
 
@@ -907,27 +955,32 @@ void RealTimeMultiSampleArrayWidget::showSelectedChannelsOnly(QStringList select
 void RealTimeMultiSampleArrayWidget::visibleRowsChanged(int value)
 {
     Q_UNUSED(value);
-    //std::cout <<"Visible channels: "<< m_pTableView->rowAt(0) << "-" << m_pTableView->rowAt(m_pTableView->height())<<std::endl;
 
-    int from = m_pTableView->rowAt(0);
-    if(from != 0)
-        from--;
+    if(!m_pRTMSAModel || !m_pTableView)
+        return;
 
-    int to = m_pTableView->rowAt(m_pTableView->height()-1);
-    if(to != m_pRTMSAModel->rowCount()-1)
-        to++;
+    int iRowCount = m_pRTMSAModel->rowCount();
 
-    if(from > to)
-        to = m_pRTMSAModel->rowCount()-1;
+    //The OpenGL view and the 3D interpolation use the processed data of all channels
+    if(m_pGLView || m_bVisualize3DSensorData) {
+        m_pRTMSAModel->setVisibleRows(0, iRowCount-1);
+        return;
+    }
 
-    QStringList channelNames;
+    //Keep one extra row on each side so that partly visible rows are always up to date
+    int from = m_pTableView->rowAt(0);
+    if(from > 0)
+        from--;
+    else
+        from = 0;
 
-    for(int i = from; i<=to; i++) {
-        channelNames << m_pRTMSAModel->data(m_pRTMSAModel->index(i, 0), Qt::DisplayRole).toString();
-        //std::cout << m_pRTMSAModel->data(m_pRTMSAModel->index(i, 0), Qt::DisplayRole).toString().toStdString() << std::endl;
-    }
+    int to = m_pTableView->rowAt(m_pTableView->viewport()->height()-1);
+    if(to < 0)
+        to = iRowCount-1;
+    else if(to < iRowCount-1)
+        to++;
 
-    m_pRTMSAModel->createFilterChannelList(channelNames);
+    m_pRTMSAModel->setVisibleRows(from, to);
 }
 
 
@@ -979,13 +1032,13 @@ void RealTimeMultiSampleArrayWidget::hideBadChannels()
     //Hide non selected channels/rows in the data views
     for(int i = 0; i<m_qListBadChannels.size(); i++) {
         if(m_bHideBadChannels)
-            m_pTableView->hideRow(m_qListBadChannels.at(i));
+            setRowHidden(m_qListBadChannels.at(i), true);
         else
-            m_pTableView->showRow(m_qListBadChannels.at(i));
+            setRowHidden(m_qListBadChannels.at(i), false);
     }
 
     //Update the visible channel list which are to be filtered
-    //visibleRowsChanged(0);
+    visibleRowsChanged(0);
 }
 
 
@@ -1034,6 +1087,9 @@ void RealTimeMultiSampleArrayWidget::showQuickControlWidget()
 void RealTimeMultiSampleArrayWidget::onTableViewBackgroundColorChanged(const QColor& backgroundColor)
 {
     m_pTableView->setStyleSheet(QString("background-color: rgb(%1, %2, %3);").arg(backgroundColor.red()).arg(backgroundColor.green()).arg(backgroundColor.blue()));
+
+    if(m_pGLView)
+        m_pGLView->setBackgroundColor(backgroundColor);
 }
 
 
@@ -1068,3 +1124,14 @@ void RealTimeMultiSampleArrayWidget::onMakeScreenshot(const QString& imageType)
         pixMap.save(fileName);
     }
 }
+
+
+//*************************************************************************************************************
+
+void RealTimeMultiSampleArrayWidget::setRowHidden(int row, bool hide)
+{
+    m_pTableView->setRowHidden(row, hide);
+
+    if(m_pGLView)
+        m_pGLView->setRowHidden(row, hide);
+}
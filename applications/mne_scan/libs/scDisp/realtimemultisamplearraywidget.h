@@ -116,6 +116,7 @@ namespace SCDISPLIB
 
 class RealTimeMultiSampleArrayModel;
 class RealTimeMultiSampleArrayDelegate;
+class RealTimeMultiSampleArrayGLView;
 class QuickControlWidget;
 
 
@@ -123,6 +124,10 @@ class QuickControlWidget;
 /**
 * DECLARE CLASS RealTimeMultiSampleArrayWidget
 *
+* The traces are drawn by a QTableView with RealTimeMultiSampleArrayDelegate. The OpenGL trace view is selected
+* with the OpenGL display action and is stored per display in the RTMSAW/<name>/openGLRendering setting. It is
+* created when the display is opened, the table view stays available as software fallback.
+*
 * @brief The RealTimeMultiSampleArrayWidget class provides a real-time curve display.
 */
 class SCDISPSHARED_EXPORT RealTimeMultiSampleArrayWidget : public NewMeasurementWidget
@@ -382,6 +387,15 @@ private slots:
     void onMakeScreenshot(const QString& imageType);
 
 private:
+    //=========================================================================================================
+    /**
+    * Hides or shows a channel row in the table view and, if present, in the OpenGL view
+    *
+    * @param [in] row   The row.
+    * @param [in] hide  Whether the row is hidden.
+    */
+    void setRowHidden(int row, bool hide);
+
     QSharedPointer<RealTimeMultiSampleArrayModel>           m_pRTMSAModel;                  /**< RTMSA data model */
     QSharedPointer<RealTimeMultiSampleArrayDelegate>        m_pRTMSADelegate;               /**< RTMSA data delegate */
     QSharedPointer<QuickControlWidget>                      m_pQuickControlWidget;          /**< quick control widget. */
@@ -409,6 +423,7 @@ private:
     QSharedPointer<FIFFLIB::FiffInfo>           m_pFiffInfo;                    /**< FiffInfo, which is used insteadd of ListChInfo*/
 
     QTableView*                                 m_pTableView;                   /**< the QTableView being part of the model/view framework of Qt. */
+    RealTimeMultiSampleArrayGLView*             m_pGLView;                      /**< the OpenGL trace view, NULL if OpenGL rendering is not selected. The table view is kept as software fallback. */
     QSharedPointer<QToolBox>                    m_pToolBox;                     /**< The toolbox which holds the table view and real-time interpolation plot. */
 
     QSharedPointer<DISP3DLIB::View3D>           m_p3DView;                      /**< The Disp3D view. */
@@ -422,6 +437,7 @@ private:
     QAction*                                    m_pActionSelectSensors;         /**< show roi select widget */
     QAction*                                    m_pActionHideBad;               /**< Hide bad channels. */
     QAction*                                    m_pActionQuickControl;          /**< Show quick control widget. */
+    QAction*                                    m_pActionOpenGL;                /**< Selects the OpenGL trace view, takes effect when the display is opened the next time. */
     QAction*                                    m_pAction3DControl;             /**< Show 3D View control widget */
  };
 
@@ -89,6 +89,7 @@ SOURCES += \
     helpers/realtimebutterflyplot.cpp \
     helpers/realtimemultisamplearraymodel.cpp \
     helpers/realtimemultisamplearraydelegate.cpp \
+    helpers/realtimemultisamplearrayglview.cpp \
     helpers/realtimeevokedmodel.cpp \
     helpers/realtimeevokedsetmodel.cpp \
     helpers/covmodalitywidget.cpp \
@@ -112,6 +113,7 @@ HEADERS += \
     frequencyspectrumwidget.h \
     helpers/realtimemultisamplearraymodel.h \
     helpers/realtimemultisamplearraydelegate.h \
+    helpers/realtimemultisamplearrayglview.h \
     helpers/realtimeevokedmodel.h \
     helpers/realtimeevokedsetmodel.h \
     helpers/realtimebutterflyplot.h \
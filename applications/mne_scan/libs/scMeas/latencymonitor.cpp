@@ -0,0 +1,227 @@
+//=============================================================================================================
+/**
+* @file     latencymonitor.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the LatencyMonitor Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "latencymonitor.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QAtomicInt>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCMEASLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+struct LatencyRegistry
+{
+    LatencyRegistry()
+    : enabled(qEnvironmentVariableIsSet("MNE_SCAN_LATENCY") ? 1 : 0)
+    {
+        clock.start();
+    }
+
+    QAtomicInt                      enabled;
+    QElapsedTimer                   clock;
+    QMutex                          mutex;
+    QMap<QString, LatencyHistogram> histograms;
+};
+
+Q_GLOBAL_STATIC(LatencyRegistry, latencyRegistry)
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+LatencyHistogram::LatencyHistogram()
+: count(0)
+, sum(0)
+, min(0)
+, max(0)
+, bins(NumBins, 0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void LatencyHistogram::add(qint64 iUsec)
+{
+    if(iUsec < 0)
+        iUsec = 0;
+
+    int iBin = 0;
+    for(qint64 v = iUsec; v > 1 && iBin < NumBins - 1; v >>= 1)
+        ++iBin;
+
+    ++bins[iBin];
+
+    if(count == 0 || iUsec < min)
+        min = iUsec;
+    if(count == 0 || iUsec > max)
+        max = iUsec;
+
+    sum += iUsec;
+    ++count;
+}
+
+
+//*************************************************************************************************************
+
+qint64 LatencyHistogram::percentile(double dFraction) const
+{
+    if(count == 0)
+        return 0;
+
+    qint64 iTarget = (qint64)(dFraction * count + 0.5);
+    qint64 iSum = 0;
+    for(int i = 0; i < NumBins; ++i) {
+        iSum += bins[i];
+        if(iSum >= iTarget)
+            return qMin(((qint64)1) << (i + 1), max);
+    }
+
+    return max;
+}
+
+
+//*************************************************************************************************************
+
+bool LatencyMonitor::isEnabled()
+{
+    return latencyRegistry()->enabled.load() != 0;
+}
+
+
+//*************************************************************************************************************
+
+void LatencyMonitor::setEnabled(bool bEnabled)
+{
+    latencyRegistry()->enabled.store(bEnabled ? 1 : 0);
+}
+
+
+//*************************************************************************************************************
+
+qint64 LatencyMonitor::now()
+{
+    return latencyRegistry()->clock.nsecsElapsed() / 1000;
+}
+
+
+//*************************************************************************************************************
+
+void LatencyMonitor::record(const QString& sStage, qint64 iTimestamp)
+{
+    if(iTimestamp < 0 || !isEnabled())
+        return;
+
+    qint64 iLatency = now() - iTimestamp;
+
+    LatencyRegistry* pRegistry = latencyRegistry();
+    QMutexLocker locker(&pRegistry->mutex);
+    pRegistry->histograms[sStage].add(iLatency);
+}
+
+
+//*************************************************************************************************************
+
+QMap<QString, LatencyHistogram> LatencyMonitor::histograms()
+{
+    LatencyRegistry* pRegistry = latencyRegistry();
+    QMutexLocker locker(&pRegistry->mutex);
+    return pRegistry->histograms;
+}
+
+
+//*************************************************************************************************************
+
+QStringList LatencyMonitor::report()
+{
+    QMap<QString, LatencyHistogram> mapHistograms = histograms();
+
+    QStringList slReport;
+    slReport << QString("%1 %2 %3 %4 %5 %6").arg("stage", -48).arg("count", 8).arg("mean[us]", 10).arg("p50[us]", 10).arg("p99[us]", 10).arg("max[us]", 10);
+
+    QMap<QString, LatencyHistogram>::const_iterator it;
+    for(it = mapHistograms.constBegin(); it != mapHistograms.constEnd(); ++it) {
+        const LatencyHistogram& hist = it.value();
+        slReport << QString("%1 %2 %3 %4 %5 %6").arg(it.key(), -48)
+                    .arg(hist.count, 8)
+                    .arg(hist.count > 0 ? hist.sum / hist.count : 0, 10)
+                    .arg(hist.percentile(0.5), 10)
+                    .arg(hist.percentile(0.99), 10)
+                    .arg(hist.max, 10);
+    }
+
+    return slReport;
+}
+
+
+//*************************************************************************************************************
+
+void LatencyMonitor::reset()
+{
+    LatencyRegistry* pRegistry = latencyRegistry();
+    QMutexLocker locker(&pRegistry->mutex);
+    pRegistry->histograms.clear();
+}
@@ -0,0 +1,174 @@
+//=============================================================================================================
+/**
+* @file     latencymonitor.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the LatencyMonitor Class.
+*
+*/
+
+#ifndef LATENCYMONITOR_H
+#define LATENCYMONITOR_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "scmeas_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMap>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCMEASLIB
+//=============================================================================================================
+
+namespace SCMEASLIB
+{
+
+//=============================================================================================================
+/**
+* Latency histogram of one pipeline stage. Bin i counts latencies in [2^i, 2^(i+1)) microseconds.
+*
+* @brief Latency histogram with logarithmic bins.
+*/
+struct SCMEASSHARED_EXPORT LatencyHistogram
+{
+    enum { NumBins = 32 };
+
+    LatencyHistogram();
+
+    //=========================================================================================================
+    /**
+    * Adds one latency to the histogram.
+    *
+    * @param[in] iUsec      the latency in microseconds.
+    */
+    void add(qint64 iUsec);
+
+    //=========================================================================================================
+    /**
+    * Returns the upper bin edge below which the given fraction of all latencies lies.
+    *
+    * @param[in] dFraction  fraction between 0 and 1, i.e. 0.5 for the median.
+    *
+    * @return the percentile in microseconds.
+    */
+    qint64 percentile(double dFraction) const;
+
+    qint64          count;      /**< Number of recorded latencies. */
+    qint64          sum;        /**< Sum of all latencies in microseconds. */
+    qint64          min;        /**< Smallest latency in microseconds. */
+    qint64          max;        /**< Largest latency in microseconds. */
+    QVector<qint64> bins;       /**< Logarithmic bins. */
+};
+
+
+//=============================================================================================================
+/**
+* Collects end-to-end latencies of the real-time pipeline. Measurements stamp each block with the time it
+* entered the pipeline, the connectors and plugins then record the age of the block at each stage they pass.
+* The monitor is disabled by default and can be enabled by setEnabled or by setting the MNE_SCAN_LATENCY
+* environment variable. When disabled, all calls return immediately.
+*
+* @brief Process wide registry of per-stage latency histograms.
+*/
+class SCMEASSHARED_EXPORT LatencyMonitor
+{
+public:
+    //=========================================================================================================
+    /**
+    * Returns whether latency recording is enabled.
+    *
+    * @return true if enabled.
+    */
+    static bool isEnabled();
+
+    //=========================================================================================================
+    /**
+    * Enables or disables latency recording.
+    *
+    * @param[in] bEnabled   whether to record latencies.
+    */
+    static void setEnabled(bool bEnabled);
+
+    //=========================================================================================================
+    /**
+    * Returns the current time of the monotonic pipeline clock.
+    *
+    * @return the time in microseconds since the clock was first used.
+    */
+    static qint64 now();
+
+    //=========================================================================================================
+    /**
+    * Records the age of a block at the given stage. Negative timestamps are ignored.
+    *
+    * @param[in] sStage         name of the stage, i.e. "NoiseReduction/NoiseReductionOut: output".
+    * @param[in] iTimestamp     the time the block entered the pipeline, as returned by now().
+    */
+    static void record(const QString& sStage, qint64 iTimestamp);
+
+    //=========================================================================================================
+    /**
+    * Returns a copy of the histograms recorded so far.
+    *
+    * @return the histograms keyed by stage name.
+    */
+    static QMap<QString, LatencyHistogram> histograms();
+
+    //=========================================================================================================
+    /**
+    * Returns a table with count, mean, median, 99th percentile and maximum of each stage.
+    *
+    * @return the report, one line per stage.
+    */
+    static QStringList report();
+
+    //=========================================================================================================
+    /**
+    * Clears all histograms.
+    */
+    static void reset();
+};
+
+} //NAMESPACE
+
+#endif // LATENCYMONITOR_H
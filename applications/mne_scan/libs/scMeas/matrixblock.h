@@ -0,0 +1,230 @@
+//=============================================================================================================
+/**
+* @file     matrixblock.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the MatrixBlock Class.
+*
+*/
+
+#ifndef MATRIXBLOCK_H
+#define MATRIXBLOCK_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "scmeas_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedData>
+#include <QSharedDataPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCMEASLIB
+//=============================================================================================================
+
+namespace SCMEASLIB
+{
+
+
+//=========================================================================================================
+/**
+* The shared payload of a MatrixBlock.
+*/
+class MatrixBlockData : public QSharedData
+{
+public:
+    MatrixBlockData() {}
+    MatrixBlockData(const MatrixBlockData &other) : QSharedData(other), matData(other.matData) {}
+    explicit MatrixBlockData(const Eigen::MatrixXd &mat) : matData(mat) {}
+    explicit MatrixBlockData(Eigen::MatrixXd &&mat) : matData(std::move(mat)) {}
+
+    Eigen::MatrixXd matData;    /**< The sample block. */
+};
+
+
+//=========================================================================================================
+/**
+* A reference counted data block which is passed between the mne_scan plugins and displays. Copies of a
+* MatrixBlock share the same buffer, so a measurement can hand its blocks to any number of consumers and
+* threads without copying the samples. The block is copied on write, i.e. only when a holder asks for
+* writable access while the buffer is still shared.
+*
+* @brief Implicitly shared sample block.
+*/
+class SCMEASSHARED_EXPORT MatrixBlock
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs an empty block.
+    */
+    MatrixBlock();
+
+    //=========================================================================================================
+    /**
+    * Constructs a block holding a copy of the given matrix.
+    *
+    * @param[in] mat    the samples.
+    */
+    explicit MatrixBlock(const Eigen::MatrixXd &mat);
+
+    //=========================================================================================================
+    /**
+    * Constructs a block by taking over the buffer of the given matrix.
+    *
+    * @param[in] mat    the samples, mat is left empty.
+    */
+    explicit MatrixBlock(Eigen::MatrixXd &&mat);
+
+    //=========================================================================================================
+    /**
+    * Returns read access to the samples, this never copies.
+    *
+    * @return the samples.
+    */
+    inline const Eigen::MatrixXd& matrix() const;
+
+    //=========================================================================================================
+    /**
+    * Returns write access to the samples. The buffer is detached first if other blocks share it.
+    *
+    * @return the writable samples.
+    */
+    inline Eigen::MatrixXd& writableMatrix();
+
+    //=========================================================================================================
+    /**
+    * Read access to the samples, so a block can be used wherever a const MatrixXd reference is expected.
+    */
+    inline operator const Eigen::MatrixXd&() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of rows (channels) of the block.
+    *
+    * @return the number of rows.
+    */
+    inline Eigen::Index rows() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of columns (samples) of the block.
+    *
+    * @return the number of columns.
+    */
+    inline Eigen::Index cols() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the buffer is shared with other blocks, i.e. whether writableMatrix() would copy.
+    *
+    * @return true if the buffer is shared.
+    */
+    inline bool isShared() const;
+
+private:
+    QSharedDataPointer<MatrixBlockData> d;  /**< The shared samples. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline const Eigen::MatrixXd& MatrixBlock::matrix() const
+{
+    return d->matData;
+}
+
+
+//*************************************************************************************************************
+
+inline Eigen::MatrixXd& MatrixBlock::writableMatrix()
+{
+    return d->matData;
+}
+
+
+//*************************************************************************************************************
+
+inline MatrixBlock::operator const Eigen::MatrixXd&() const
+{
+    return d->matData;
+}
+
+
+//*************************************************************************************************************
+
+inline Eigen::Index MatrixBlock::rows() const
+{
+    return d->matData.rows();
+}
+
+
+//*************************************************************************************************************
+
+inline Eigen::Index MatrixBlock::cols() const
+{
+    return d->matData.cols();
+}
+
+
+//*************************************************************************************************************
+
+inline bool MatrixBlock::isShared() const
+{
+    return d->ref.load() > 1;
+}
+
+} // NAMESPACE
+
+//QList stores the block in place, copying it only copies the pointer
+Q_DECLARE_TYPEINFO(SCMEASLIB::MatrixBlock, Q_MOVABLE_TYPE);
+
+#endif // MATRIXBLOCK_H
@@ -58,6 +58,7 @@ NewMeasurement::NewMeasurement(int type, QObject *parent)
 : QObject(parent)
 , m_iMetaTypeId(type)
 , m_bVisibility(true)
+, m_iTimestamp(-1)
 {
 //    qWarning() << "QMetaType" << type;
 }
@@ -125,6 +125,15 @@ public:
     */
     inline int type() const;
 
+    //=========================================================================================================
+    /**
+    * Returns the time the oldest data of the current notification entered the pipeline, as given by
+    * LatencyMonitor::now(). It is used to record the latency at each stage the Measurement passes.
+    *
+    * @return the timestamp in microseconds, or -1 if the Measurement is not stamped.
+    */
+    inline qint64 getTimestamp() const;
+
 signals:
     void notify();
 
@@ -137,11 +146,20 @@ protected:
     */
     inline void setType(int type);
 
+    //=========================================================================================================
+    /**
+    * Sets the time the oldest data of the current notification entered the pipeline.
+    *
+    * @param[in] iTimestamp     the timestamp in microseconds, or -1 to mark the Measurement as not stamped.
+    */
+    inline void setTimestamp(qint64 iTimestamp);
+
 private:
     mutable QMutex  m_qMutex;   /**< Mutex to ensure thread safety */
     int     m_iMetaTypeId;      /**< QMetaType id of the Measurement */
     QString m_qString_Name;     /**< Name of the Measurement */
     bool    m_bVisibility;      /**< Visibility status */
+    qint64  m_iTimestamp;       /**< Pipeline entry time of the current data in microseconds, -1 if not stamped */
 };
 
 
@@ -201,6 +219,24 @@ inline int NewMeasurement::type() const
     return m_iMetaTypeId;
 }
 
+
+//*************************************************************************************************************
+
+inline qint64 NewMeasurement::getTimestamp() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iTimestamp;
+}
+
+
+//*************************************************************************************************************
+
+inline void NewMeasurement::setTimestamp(qint64 iTimestamp)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_iTimestamp = iTimestamp;
+}
+
 } //NAMESPACE
 
 Q_DECLARE_METATYPE(SCMEASLIB::NewMeasurement::SPtr)
@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "newrealtimemultisamplearray.h"
+#include "latencymonitor.h"
 
 #include <iostream>
 
@@ -238,14 +239,25 @@ void NewRealTimeMultiSampleArray::initFromFiffInfo(FiffInfo::SPtr &p_pFiffInfo)
 
 //*************************************************************************************************************
 
-void NewRealTimeMultiSampleArray::setValue(const MatrixXd& mat)
+void NewRealTimeMultiSampleArray::setValue(const MatrixXd& mat, qint64 iTimestamp)
+{
+    if(!m_bChInfoIsInit)
+        return;
+
+    setValue(MatrixBlock(mat), iTimestamp);
+}
+
+
+//*************************************************************************************************************
+
+void NewRealTimeMultiSampleArray::setValue(const MatrixBlock& block, qint64 iTimestamp)
 {
     if(!m_bChInfoIsInit)
         return;
 
     m_qMutex.lock();
     //check vector size
-    if(mat.rows() != m_qListChInfo.size())
+    if(block.rows() != m_qListChInfo.size())
         qCritical() << "Error Occured in RealTimeMultiSampleArrayNew::setVector: Vector size does not match the number of channels! ";
 
     //ToDo
@@ -256,15 +268,22 @@ void NewRealTimeMultiSampleArray::setValue(const MatrixXd& mat)
 //        else if(v[i] > m_qListChInfo[i].getMaxValue()) v[i] = m_qListChInfo[i].getMaxValue();
 //    }
 
-    //Store
-    m_matSamples.push_back(mat);
+    //Store, this only shares the buffer
+    m_matSamples.push_back(block);
+
+    //Stamp the block so the connected stages can record its latency
+    bool bStamped = LatencyMonitor::isEnabled();
+    if(bStamped)
+        m_qListTimestamps.push_back(iTimestamp < 0 ? LatencyMonitor::now() : iTimestamp);
 
     m_qMutex.unlock();
     if(m_matSamples.size() >= m_iMultiArraySize)
     {
+        setTimestamp(bStamped && !m_qListTimestamps.isEmpty() ? m_qListTimestamps.first() : -1);
         emit notify();
         m_qMutex.lock();
         m_matSamples.clear();
+        m_qListTimestamps.clear();
         m_qMutex.unlock();
     }
 }
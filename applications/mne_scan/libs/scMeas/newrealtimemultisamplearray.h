@@ -45,6 +45,7 @@
 #include "scmeas_global.h"
 #include "newmeasurement.h"
 #include "realtimesamplearraychinfo.h"
+#include "matrixblock.h"
 
 #include <fiff/fiff_info.h>
 
@@ -223,19 +224,41 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns the gathered multi sample array.
+    * Returns the gathered multi sample array. The blocks share their buffers with the producer and with every
+    * other consumer, take a copy of a block to keep it beyond the notify() call.
     *
     * @return the current multi sample array.
     */
-    inline const QList< MatrixXd >& getMultiSampleArray();
+    inline const QList< MatrixBlock >& getMultiSampleArray();
+
+    //=========================================================================================================
+    /**
+    * Returns the pipeline entry times of the gathered sample arrays. The list runs parallel to
+    * getMultiSampleArray() and is only filled while the LatencyMonitor is enabled.
+    *
+    * @return the timestamps in microseconds, as given by LatencyMonitor::now().
+    */
+    inline const QList<qint64>& getTimestamps();
 
     //=========================================================================================================
     /**
     * Attaches a value to the sample array list.
     *
-    * @param [in] mat   the value which is attached to the sample array list.
+    * @param [in] mat           the value which is attached to the sample array list.
+    * @param [in] iTimestamp    the time the data entered the pipeline, i.e. the timestamp of the input block a
+    *                           plugin processed. Default is -1, which stamps the data with the current time.
+    */
+    virtual void setValue(const MatrixXd& mat, qint64 iTimestamp = -1);
+
+    //=========================================================================================================
+    /**
+    * Attaches a block to the sample array list without copying the samples. This is the preferred way to pass
+    * on data which already lives in a MatrixBlock or which is moved in by MatrixBlock(MatrixXd&&).
+    *
+    * @param [in] block         the block which is attached to the sample array list.
+    * @param [in] iTimestamp    the time the data entered the pipeline, see setValue(const MatrixXd&, qint64).
     */
-    virtual void setValue(const MatrixXd& mat);
+    void setValue(const MatrixBlock& block, qint64 iTimestamp = -1);
 
     //=========================================================================================================
     /**
@@ -255,7 +278,8 @@ private:
     double                      m_dSamplingRate;    /**< Sampling rate of the RealTimeSampleArray.*/
 //    MatrixXd                    m_vecValue;         /**< The current attached sample vector.*/
     qint32                      m_iMultiArraySize; /**< Sample size of the multi sample array.*/
-    QList< MatrixXd >           m_matSamples;       /**< The multi sample array.*/
+    QList< MatrixBlock >        m_matSamples;       /**< The multi sample array.*/
+    QList<qint64>               m_qListTimestamps;  /**< Pipeline entry times of the multi sample array.*/
     QList<RealTimeSampleArrayChInfo> m_qListChInfo; /**< Channel info list.*/
     bool                        m_bChInfoIsInit;    /**< If channel info is initialized.*/
 };
@@ -270,6 +294,7 @@ inline void NewRealTimeMultiSampleArray::clear()
 {
     QMutexLocker locker(&m_qMutex);
     m_matSamples.clear();
+    m_qListTimestamps.clear();
 }
 
 
@@ -387,11 +412,19 @@ qint32 NewRealTimeMultiSampleArray::getMultiArraySize() const
 
 //*************************************************************************************************************
 
-inline const QList< MatrixXd >& NewRealTimeMultiSampleArray::getMultiSampleArray()
+inline const QList< MatrixBlock >& NewRealTimeMultiSampleArray::getMultiSampleArray()
 {
     return m_matSamples;
 }
 
+
+//*************************************************************************************************************
+
+inline const QList<qint64>& NewRealTimeMultiSampleArray::getTimestamps()
+{
+    return m_qListTimestamps;
+}
+
 } // NAMESPACE
 
 Q_DECLARE_METATYPE(SCMEASLIB::NewRealTimeMultiSampleArray::SPtr)
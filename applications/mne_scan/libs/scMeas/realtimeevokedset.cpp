@@ -139,6 +139,46 @@ void RealTimeEvokedSet::setValue(FiffEvokedSet& v, FiffInfo::SPtr p_fiffinfo)
     *m_pFiffEvokedSet = v;
     m_qMutex.unlock();
 
+    initFromFirstValue(p_fiffinfo);
+
+    emit notify();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeEvokedSet::updateValue(const FiffEvokedSet& v, FiffInfo::SPtr p_fiffinfo)
+{
+    //Merge
+    m_qMutex.lock();
+    for(qint32 i = 0; i < v.evoked.size(); ++i)
+    {
+        //Evoked data with another time axis belong to new averaging settings and replace the outdated ones
+        if(!m_pFiffEvokedSet->evoked.isEmpty() && m_pFiffEvokedSet->evoked.at(0).times.size() != v.evoked.at(i).times.size())
+            m_pFiffEvokedSet->evoked.clear();
+
+        qint32 iEvokedIdx = -1;
+        for(qint32 j = 0; j < m_pFiffEvokedSet->evoked.size() && iEvokedIdx < 0; ++j)
+            if(m_pFiffEvokedSet->evoked.at(j).comment == v.evoked.at(i).comment)
+                iEvokedIdx = j;
+
+        if(iEvokedIdx >= 0)
+            m_pFiffEvokedSet->evoked[iEvokedIdx] = v.evoked.at(i);
+        else
+            m_pFiffEvokedSet->evoked.append(v.evoked.at(i));
+    }
+    m_qMutex.unlock();
+
+    initFromFirstValue(p_fiffinfo);
+
+    emit notify();
+}
+
+
+//*************************************************************************************************************
+
+void RealTimeEvokedSet::initFromFirstValue(FiffInfo::SPtr p_fiffinfo)
+{
     if(!m_bInitialized)
     {
         init(p_fiffinfo);
@@ -161,8 +201,6 @@ void RealTimeEvokedSet::setValue(FiffEvokedSet& v, FiffInfo::SPtr p_fiffinfo)
         m_bInitialized = true;
         m_qMutex.unlock();
     }
-
-    emit notify();
 }
 
 
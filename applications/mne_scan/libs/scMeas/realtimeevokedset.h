@@ -187,6 +187,17 @@ public:
     */
     virtual void setValue(FiffEvokedSet &v, FiffInfo::SPtr p_fiffinfo);
 
+    //=========================================================================================================
+    /**
+    * Merges changed evoked data into the current set and distributes it. The evoked data are matched by their
+    * comment, evoked data of new conditions are appended. The other conditions are neither copied nor changed,
+    * unless the changed evoked data have another number of samples, which replaces the whole set.
+    *
+    * @param [in] v             the evoked set which holds the changed evoked data.
+    * @param [in] p_fiffinfo    the evoked fiff info as shared pointer.
+    */
+    virtual void updateValue(const FiffEvokedSet &v, FiffInfo::SPtr p_fiffinfo);
+
     //=========================================================================================================
     /**
     * Returns the current value set.
@@ -229,6 +240,14 @@ private:
     */
     void init(FiffInfo::SPtr p_fiffInfo);
 
+    //=========================================================================================================
+    /**
+    * Inits the channel infos and the number of pre-stimulus samples with the first evoked set.
+    *
+    * @param[in] p_fiffInfo     Info to init from
+    */
+    void initFromFirstValue(FiffInfo::SPtr p_fiffInfo);
+
     mutable QMutex                      m_qMutex;           /**< Mutex to ensure thread safety */
 
     FIFFLIB::FiffEvokedSet::SPtr        m_pFiffEvokedSet;   /**< Evoked data set*/
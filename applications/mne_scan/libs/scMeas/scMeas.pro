@@ -76,7 +76,9 @@ SOURCES += \
     realtimeevoked.cpp \
     realtimeevokedset.cpp \
     realtimecov.cpp \
-    frequencyspectrum.cpp
+    frequencyspectrum.cpp \
+    latencymonitor.cpp \
+    matrixblock.cpp
 
 
 HEADERS += \
@@ -92,7 +94,9 @@ HEADERS += \
     realtimeevoked.h \
     realtimeevokedset.h \
     realtimecov.h \
-    frequencyspectrum.h
+    frequencyspectrum.h \
+    latencymonitor.h \
+    matrixblock.h
 
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
@@ -0,0 +1,242 @@
+//=============================================================================================================
+/**
+* @file     amplifierproducer.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+*
+* @brief    Contains the implementation of the AmplifierProducer class.
+*
+*/
+
+#ifndef AMPLIFIERPRODUCER_CPP //Because this cpp is part of the header -> template
+#define AMPLIFIERPRODUCER_CPP
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "amplifierproducer.h"
+#include "metricsregistry.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDateTime>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename _Tp>
+AmplifierProducer<_Tp>::AmplifierProducer()
+: m_bIsRunning(false)
+, m_iNumberOfChannels(0)
+, m_iBlockSize(0)
+, m_ulPollInterval(0)
+, m_uiNumPushed(0)
+, m_uiNumPopped(0)
+, m_iNumBlocks(0)
+, m_iNumOverflows(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+AmplifierProducer<_Tp>::~AmplifierProducer()
+{
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+bool AmplifierProducer<_Tp>::pop(MatrixType& matBlock, qint64* pTimestamp)
+{
+    if(!m_pRing) {
+        matBlock.setZero(0, 0);
+        return false;
+    }
+
+    matBlock.resize(m_iNumberOfChannels, m_iBlockSize);
+
+    const _Tp* pSlot = m_pRing->claimPopSlot();
+    if(!pSlot) {
+        matBlock.setZero();
+        return false;
+    }
+
+    memcpy(matBlock.data(), pSlot, matBlock.size()*sizeof(_Tp));
+    if(pTimestamp)
+        *pTimestamp = m_vecTimestamps.at(m_uiNumPopped % m_pRing->size());
+
+    ++m_uiNumPopped;
+    m_pRing->commitPopSlot();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+void AmplifierProducer<_Tp>::releaseFromPop()
+{
+    if(m_pRing)
+        m_pRing->releaseFromPop();
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+void AmplifierProducer<_Tp>::clear()
+{
+    //Pop the blocks one by one, so the timestamps stay assigned to their slots
+    if(m_pRing) {
+        while(m_pRing->count() > 0 && m_pRing->claimPopSlot()) {
+            ++m_uiNumPopped;
+            m_pRing->commitPopSlot();
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+bool AmplifierProducer<_Tp>::startProducer(int iNumberOfChannels, int iBlockSize, double dSamplingFrequency, int iRingSize)
+{
+    if(this->isRunning())
+        stopProducer();
+
+    if(iNumberOfChannels <= 0 || iBlockSize <= 0 || iRingSize <= 0) {
+        qWarning() << "AmplifierProducer::startProducer - Invalid block of" << iNumberOfChannels << "x" << iBlockSize << "in a ring of" << iRingSize;
+        return false;
+    }
+
+    m_iNumberOfChannels = iNumberOfChannels;
+    m_iBlockSize = iBlockSize;
+
+    //Poll a device without a complete block again after a quarter of a block
+    m_ulPollInterval = dSamplingFrequency > 0 ? ulong(250000.0 * m_iBlockSize / dSamplingFrequency) : 0;
+
+    m_pRing = QSharedPointer<IOBUFFER::LockFreeMatrixBuffer<_Tp> >(new IOBUFFER::LockFreeMatrixBuffer<_Tp>(iRingSize, m_iNumberOfChannels, m_iBlockSize));
+    m_vecTimestamps.fill(0, iRingSize);
+    m_matDroppedBlock.resize(m_iNumberOfChannels, m_iBlockSize);
+
+    m_uiNumPushed = 0;
+    m_uiNumPopped = 0;
+    m_iNumBlocks.storeRelease(0);
+    m_iNumOverflows.storeRelease(0);
+
+    m_bIsRunning = true;
+    QThread::start();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+void AmplifierProducer<_Tp>::stopProducer()
+{
+    m_bIsRunning = false;
+    QThread::wait();
+
+    if(m_iNumOverflows.loadAcquire() > 0)
+        qWarning() << "AmplifierProducer::stopProducer -" << getNumOverflows() << "of" << getNumBlocks() << "blocks were dropped because the ring was full";
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+void AmplifierProducer<_Tp>::run()
+{
+    qint64* pTimestamps = m_vecTimestamps.data();
+
+    const QString sName = objectName().isEmpty() ? QString("Amplifier") : objectName();
+    const QString sDropped = QString("%1/producer: dropped blocks").arg(sName);
+    const QString sFillLevel = QString("%1/producer: fill level").arg(sName);
+
+    while(m_bIsRunning) {
+        //Drop the block instead of stalling the device if the consumer fell behind
+        bool bRingFull = m_pRing->count() >= m_pRing->size();
+
+        _Tp* pSlot = bRingFull ? m_matDroppedBlock.data() : m_pRing->claimPushSlot();
+        if(!pSlot)
+            continue;
+
+        BlockMap matBlock(pSlot, m_iNumberOfChannels, m_iBlockSize);
+
+        if(!readBlock(matBlock)) {
+            if(m_ulPollInterval > 0)
+                QThread::usleep(m_ulPollInterval);
+            continue;
+        }
+
+        m_iNumBlocks.ref();
+
+        if(bRingFull) {
+            m_iNumOverflows.ref();
+            MetricsRegistry::addCounter(sDropped);
+            continue;
+        }
+
+        pTimestamps[m_uiNumPushed % m_pRing->size()] = QDateTime::currentMSecsSinceEpoch();
+        ++m_uiNumPushed;
+        m_pRing->commitPushSlot();
+
+        MetricsRegistry::setGauge(sFillLevel, (double)m_pRing->count() / m_pRing->size());
+    }
+}
+
+} // NAMESPACE SCSHAREDLIB
+
+#endif // AMPLIFIERPRODUCER_CPP
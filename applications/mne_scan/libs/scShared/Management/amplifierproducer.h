@@ -0,0 +1,294 @@
+//=============================================================================================================
+/**
+* @file     amplifierproducer.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+*
+* @brief    Contains the declaration of the AmplifierProducer class.
+*
+*/
+
+#ifndef AMPLIFIERPRODUCER_H
+#define AMPLIFIERPRODUCER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+
+#include <utils/generics/lockfreematrixbuffer.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QThread>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+
+//=========================================================================================================
+/**
+* AmplifierProducer is the acquisition thread of an amplifier plugin. The derived producer only reads one block
+* of the device into a given matrix, which is a slot of a lock-free single-producer/single-consumer ring, so the
+* samples are converted from the device format straight into the memory the plugin pops from. Every block is
+* timestamped when the driver returned it. If the plugin falls behind, the device is still drained and the block
+* is dropped and counted instead of stalling the driver.
+*
+* @brief Shared producer thread of the amplifier plugins
+*/
+template<typename _Tp>
+class AmplifierProducer : public QThread
+{
+public:
+    typedef Eigen::Matrix<_Tp, Eigen::Dynamic, Eigen::Dynamic> MatrixType;     /**< Block type. */
+    typedef Eigen::Map<MatrixType> BlockMap;                                    /**< Block in a slot of the ring. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an AmplifierProducer.
+    */
+    AmplifierProducer();
+
+    //=========================================================================================================
+    /**
+    * Destroys the AmplifierProducer. Derived producers have to stop the thread in their destructor.
+    */
+    virtual ~AmplifierProducer();
+
+    //=========================================================================================================
+    /**
+    * Returns the oldest block. Waits for a block. Consumer thread only.
+    *
+    * @param [out] matBlock     the block (channels x samples), a zero matrix if the wait was released.
+    * @param [out] pTimestamp   if given, the time the driver returned the block [msecs since epoch].
+    *
+    * @return true if a block was popped, false if the wait was released or the producer was not started.
+    */
+    bool pop(MatrixType& matBlock, qint64* pTimestamp = Q_NULLPTR);
+
+    //=========================================================================================================
+    /**
+    * Releases a waiting or the next waiting pop().
+    */
+    void releaseFromPop();
+
+    //=========================================================================================================
+    /**
+    * Drops all blocks which have not been popped yet. Consumer thread only.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of channels of a block.
+    *
+    * @return the number of channels.
+    */
+    inline int getNumberOfChannels() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples of a block.
+    *
+    * @return the block size.
+    */
+    inline int getBlockSize() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of blocks read from the device since the start, including dropped ones.
+    *
+    * @return the number of blocks.
+    */
+    inline quint32 getNumBlocks() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of blocks dropped since the start because the ring was full.
+    *
+    * @return the number of dropped blocks.
+    */
+    inline quint32 getNumOverflows() const;
+
+    //=========================================================================================================
+    /**
+    * Converts scan-major device samples to a column-major block, i.e. sample n of scan i is read from element
+    * i*iScanStride + n of the source. The source does not need to be aligned.
+    *
+    * @param [in] pSource       device samples of type _Src.
+    * @param [in] iScanStride   distance of two converted scans in elements of _Src.
+    * @param [in] iChannels     number of channels to convert per scan.
+    * @param [in] iSamples      number of scans to convert.
+    * @param [in] scale         factor applied to each sample, e.g. the resolution of the device.
+    * @param [out] pTarget      first element of the target block area.
+    * @param [in] iTargetRows   number of rows of the target block.
+    */
+    template<typename _Src>
+    static inline void convertScans(const void* pSource, int iScanStride, int iChannels, int iSamples, _Tp scale, _Tp* pTarget, int iTargetRows);
+
+protected:
+    //=========================================================================================================
+    /**
+    * Creates the ring and starts the thread. To be called by the derived producer once the device is initialised.
+    *
+    * @param [in] iNumberOfChannels     number of channels of a block.
+    * @param [in] iBlockSize            number of samples of a block.
+    * @param [in] dSamplingFrequency    sampling frequency, sets how long to wait if the device has no block yet.
+    * @param [in] iRingSize             number of blocks the ring holds.
+    *
+    * @return true if the thread was started.
+    */
+    bool startProducer(int iNumberOfChannels, int iBlockSize, double dSamplingFrequency, int iRingSize = 8);
+
+    //=========================================================================================================
+    /**
+    * Stops the thread and waits for it. The device can be uninitialised afterwards.
+    */
+    void stopProducer();
+
+    //=========================================================================================================
+    /**
+    * Reads the next block from the device. Runs in the producer thread.
+    *
+    * @param [out] matBlock     the block (channels x samples) to fill in place.
+    *
+    * @return true if the block was filled, false if the device has no complete block yet or failed.
+    */
+    virtual bool readBlock(BlockMap& matBlock) = 0;
+
+    //=========================================================================================================
+    /**
+    * The producer loop. Reads the device into the ring as long as the producer runs.
+    */
+    virtual void run();
+
+    volatile bool       m_bIsRunning;               /**< Whether the producer thread runs. */
+
+private:
+    QSharedPointer<IOBUFFER::LockFreeMatrixBuffer<_Tp> >    m_pRing;    /**< Holds the acquired blocks. */
+
+    QVector<qint64>     m_vecTimestamps;            /**< Timestamps per ring slot [msecs since epoch]. */
+    MatrixType          m_matDroppedBlock;          /**< Drains the device while the ring is full. */
+    int                 m_iNumberOfChannels;        /**< Number of channels of a block. */
+    int                 m_iBlockSize;               /**< Number of samples of a block. */
+    ulong               m_ulPollInterval;           /**< Wait while the device has no complete block [usecs]. */
+    quint32             m_uiNumPushed;              /**< Blocks pushed to the ring, producer thread only. */
+    quint32             m_uiNumPopped;              /**< Blocks popped from the ring, consumer thread only. */
+    QAtomicInt          m_iNumBlocks;               /**< Blocks read from the device. */
+    QAtomicInt          m_iNumOverflows;            /**< Blocks dropped because the ring was full. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+template<typename _Tp>
+inline int AmplifierProducer<_Tp>::getNumberOfChannels() const
+{
+    return m_iNumberOfChannels;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline int AmplifierProducer<_Tp>::getBlockSize() const
+{
+    return m_iBlockSize;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 AmplifierProducer<_Tp>::getNumBlocks() const
+{
+    return (quint32)m_iNumBlocks.loadAcquire();
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 AmplifierProducer<_Tp>::getNumOverflows() const
+{
+    return (quint32)m_iNumOverflows.loadAcquire();
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+template<typename _Src>
+inline void AmplifierProducer<_Tp>::convertScans(const void* pSource, int iScanStride, int iChannels, int iSamples, _Tp scale, _Tp* pTarget, int iTargetRows)
+{
+    const char* pScan = static_cast<const char*>(pSource);
+
+    for(int i = 0; i < iSamples; ++i) {
+        _Tp* pColumn = pTarget + i*iTargetRows;
+        for(int n = 0; n < iChannels; ++n) {
+            _Src value;
+            memcpy(&value, pScan + n*sizeof(_Src), sizeof(_Src));
+            pColumn[n] = _Tp(value) * scale;
+        }
+        pScan += iScanStride*sizeof(_Src);
+    }
+}
+
+} // NAMESPACE SCSHAREDLIB
+
+//Make the template definition visible to compiler in the first point of instantiation
+#include "amplifierproducer.cpp"
+
+#endif // AMPLIFIERPRODUCER_H
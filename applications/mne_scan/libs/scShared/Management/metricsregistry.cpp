@@ -0,0 +1,242 @@
+//=============================================================================================================
+/**
+* @file     metricsregistry.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MetricsRegistry definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "metricsregistry.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SCSHAREDLIB;
+using namespace SCMEASLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+struct MetricsStore
+{
+    QMutex                  mutex;
+    QMap<QString, Metric>   metrics;
+};
+
+Q_GLOBAL_STATIC(MetricsStore, metricsStore)
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+Metric::Metric()
+: type(Counter)
+, count(0)
+, value(0.0)
+, maxValue(0.0)
+, updatedUs(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void MetricsRegistry::addCounter(const QString& sName, qint64 iIncrement)
+{
+    qint64 iNow = LatencyMonitor::now();
+
+    MetricsStore* pStore = metricsStore();
+    QMutexLocker locker(&pStore->mutex);
+
+    Metric& metric = pStore->metrics[sName];
+    metric.type = Metric::Counter;
+    metric.count += iIncrement;
+    metric.updatedUs = iNow;
+}
+
+
+//*************************************************************************************************************
+
+void MetricsRegistry::setGauge(const QString& sName, double dValue)
+{
+    qint64 iNow = LatencyMonitor::now();
+
+    MetricsStore* pStore = metricsStore();
+    QMutexLocker locker(&pStore->mutex);
+
+    Metric& metric = pStore->metrics[sName];
+    metric.type = Metric::Gauge;
+    metric.maxValue = metric.count == 0 ? dValue : qMax(metric.maxValue, dValue);
+    metric.value = dValue;
+    ++metric.count;
+    metric.updatedUs = iNow;
+}
+
+
+//*************************************************************************************************************
+
+void MetricsRegistry::recordDuration(const QString& sName, qint64 iUsec)
+{
+    qint64 iNow = LatencyMonitor::now();
+
+    MetricsStore* pStore = metricsStore();
+    QMutexLocker locker(&pStore->mutex);
+
+    Metric& metric = pStore->metrics[sName];
+    metric.type = Metric::Histogram;
+    metric.histogram.add(iUsec);
+    metric.count = metric.histogram.count;
+    metric.updatedUs = iNow;
+}
+
+
+//*************************************************************************************************************
+
+QMap<QString, Metric> MetricsRegistry::metrics()
+{
+    MetricsStore* pStore = metricsStore();
+    QMutexLocker locker(&pStore->mutex);
+    return pStore->metrics;
+}
+
+
+//*************************************************************************************************************
+
+QStringList MetricsRegistry::report()
+{
+    QMap<QString, Metric> mapMetrics = metrics();
+
+    QStringList slReport;
+    slReport << QString("%1 %2 %3").arg("metric", -48).arg("type", -9).arg("value");
+
+    QMap<QString, Metric>::const_iterator it;
+    for(it = mapMetrics.constBegin(); it != mapMetrics.constEnd(); ++it) {
+        const Metric& metric = it.value();
+        switch(metric.type) {
+            case Metric::Counter:
+                slReport << QString("%1 %2 %3").arg(it.key(), -48).arg("counter", -9).arg(metric.count);
+                break;
+            case Metric::Gauge:
+                slReport << QString("%1 %2 %3 (max %4)").arg(it.key(), -48).arg("gauge", -9).arg(metric.value).arg(metric.maxValue);
+                break;
+            case Metric::Histogram:
+                slReport << QString("%1 %2 n=%3 mean=%4us p99=%5us max=%6us").arg(it.key(), -48).arg("histogram", -9)
+                            .arg(metric.histogram.count)
+                            .arg(metric.histogram.count > 0 ? metric.histogram.sum / metric.histogram.count : 0)
+                            .arg(metric.histogram.percentile(0.99))
+                            .arg(metric.histogram.max);
+                break;
+        }
+    }
+
+    return slReport;
+}
+
+
+//*************************************************************************************************************
+
+QByteArray MetricsRegistry::toJson()
+{
+    QMap<QString, Metric> mapMetrics = metrics();
+
+    QJsonObject jsonMetrics;
+
+    QMap<QString, Metric>::const_iterator it;
+    for(it = mapMetrics.constBegin(); it != mapMetrics.constEnd(); ++it) {
+        const Metric& metric = it.value();
+
+        QJsonObject jsonMetric;
+        jsonMetric.insert("updated_us", (double)metric.updatedUs);
+
+        switch(metric.type) {
+            case Metric::Counter:
+                jsonMetric.insert("type", QString("counter"));
+                jsonMetric.insert("count", (double)metric.count);
+                break;
+            case Metric::Gauge:
+                jsonMetric.insert("type", QString("gauge"));
+                jsonMetric.insert("value", metric.value);
+                jsonMetric.insert("max", metric.maxValue);
+                break;
+            case Metric::Histogram:
+                jsonMetric.insert("type", QString("histogram"));
+                jsonMetric.insert("count", (double)metric.histogram.count);
+                jsonMetric.insert("mean_us", metric.histogram.count > 0 ? (double)metric.histogram.sum / metric.histogram.count : 0.0);
+                jsonMetric.insert("p50_us", (double)metric.histogram.percentile(0.5));
+                jsonMetric.insert("p99_us", (double)metric.histogram.percentile(0.99));
+                jsonMetric.insert("max_us", (double)metric.histogram.max);
+                break;
+        }
+
+        jsonMetrics.insert(it.key(), jsonMetric);
+    }
+
+    return QJsonDocument(jsonMetrics).toJson(QJsonDocument::Compact);
+}
+
+
+//*************************************************************************************************************
+
+void MetricsRegistry::reset()
+{
+    MetricsStore* pStore = metricsStore();
+    QMutexLocker locker(&pStore->mutex);
+    pStore->metrics.clear();
+}
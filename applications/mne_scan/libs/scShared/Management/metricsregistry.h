@@ -0,0 +1,165 @@
+//=============================================================================================================
+/**
+* @file     metricsregistry.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MetricsRegistry declaration.
+*
+*/
+
+#ifndef METRICSREGISTRY_H
+#define METRICSREGISTRY_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../scshared_global.h"
+
+#include <scMeas/latencymonitor.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QByteArray>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SCSHAREDLIB
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+
+//=============================================================================================================
+/**
+* Value of one runtime metric.
+*
+* @brief Counter, gauge or histogram of the MetricsRegistry.
+*/
+struct SCSHAREDSHARED_EXPORT Metric
+{
+    enum Type {
+        Counter,        /**< Monotonic count, e.g. samples or dropped blocks. */
+        Gauge,          /**< Last value of a level, e.g. a buffer fill level. */
+        Histogram       /**< Distribution of durations in microseconds, e.g. the processing time per block. */
+    };
+
+    Metric();
+
+    Type                            type;           /**< The type of the metric. */
+    qint64                          count;          /**< The counter value, the number of gauge updates or histogram samples. */
+    double                          value;          /**< The last gauge value. */
+    double                          maxValue;       /**< The largest gauge value. */
+    qint64                          updatedUs;      /**< Time of the last update, see SCMEASLIB::LatencyMonitor::now(). */
+    SCMEASLIB::LatencyHistogram     histogram;      /**< The durations of a histogram. */
+};
+
+
+//=============================================================================================================
+/**
+* Process wide registry of runtime metrics of the MNE Scan pipeline. Sensor plugins count their samples and
+* dropped blocks and report buffer fill levels, the connectors time the update of each plugin for every block
+* and the recordings count the written samples. The metrics are shown in the Metrics dock of MNE Scan and can be
+* exported as JSON. Names follow the stages of the LatencyMonitor, i.e. "<plugin>/<quantity>".
+*
+* @brief Counters, gauges and histograms of the running pipeline.
+*/
+class SCSHAREDSHARED_EXPORT MetricsRegistry
+{
+public:
+    //=========================================================================================================
+    /**
+    * Adds to a counter.
+    *
+    * @param[in] sName          name of the counter.
+    * @param[in] iIncrement     the increment.
+    */
+    static void addCounter(const QString& sName, qint64 iIncrement = 1);
+
+    //=========================================================================================================
+    /**
+    * Sets a gauge.
+    *
+    * @param[in] sName      name of the gauge.
+    * @param[in] dValue     the current value.
+    */
+    static void setGauge(const QString& sName, double dValue);
+
+    //=========================================================================================================
+    /**
+    * Adds a duration to a histogram.
+    *
+    * @param[in] sName      name of the histogram.
+    * @param[in] iUsec      the duration in microseconds.
+    */
+    static void recordDuration(const QString& sName, qint64 iUsec);
+
+    //=========================================================================================================
+    /**
+    * Returns a copy of the metrics recorded so far.
+    *
+    * @return the metrics keyed by name.
+    */
+    static QMap<QString, Metric> metrics();
+
+    //=========================================================================================================
+    /**
+    * Returns a table of all metrics, one line per metric.
+    *
+    * @return the report.
+    */
+    static QStringList report();
+
+    //=========================================================================================================
+    /**
+    * Returns all metrics as a JSON object keyed by name, i.e. to send them to a monitoring client.
+    *
+    * @return the compact JSON document.
+    */
+    static QByteArray toJson();
+
+    //=========================================================================================================
+    /**
+    * Clears all metrics.
+    */
+    static void reset();
+};
+
+} //NAMESPACE
+
+#endif // METRICSREGISTRY_H
@@ -41,6 +41,11 @@
 #include "pluginconnector.h"
 #include "../Interfaces/IPlugin.h"
 
+#include "metricsregistry.h"
+
+#include <scMeas/latencymonitor.h>
+#include <scMeas/newrealtimemultisamplearray.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -48,6 +53,7 @@
 //=============================================================================================================
 
 using namespace SCSHAREDLIB;
+using namespace SCMEASLIB;
 
 
 //*************************************************************************************************************
@@ -62,3 +68,44 @@ PluginConnector::PluginConnector(IPlugin *parent, const QString &name, const QSt
 , m_sDescription(descr)
 {
 }
+
+
+//*************************************************************************************************************
+
+void PluginConnector::recordLatency(qint64 iTimestamp) const
+{
+    if(iTimestamp < 0 || !LatencyMonitor::isEnabled())
+        return;
+
+    QString sPlugin = m_pPlugin ? m_pPlugin->getName() : QString("Unknown");
+    LatencyMonitor::record(QString("%1/%2 (%3)").arg(sPlugin).arg(m_sName).arg(isInputConnector() ? "in" : "out"), iTimestamp);
+}
+
+
+//*************************************************************************************************************
+
+QString PluginConnector::metricName(const QString& sQuantity) const
+{
+    QString sPlugin = m_pPlugin ? m_pPlugin->getName() : QString("Unknown");
+    return QString("%1/%2 (%3): %4").arg(sPlugin).arg(m_sName).arg(isInputConnector() ? "in" : "out").arg(sQuantity);
+}
+
+
+//*************************************************************************************************************
+
+void PluginConnector::recordThroughput(const QSharedPointer<NewMeasurement>& pMeasurement) const
+{
+    MetricsRegistry::addCounter(metricName("blocks"));
+
+    QSharedPointer<NewRealTimeMultiSampleArray> pRTMSA = pMeasurement.dynamicCast<NewRealTimeMultiSampleArray>();
+    if(!pRTMSA)
+        return;
+
+    const QList<MatrixBlock>& qListBlocks = pRTMSA->getMultiSampleArray();
+
+    qint64 iSamples = 0;
+    for(int i = 0; i < qListBlocks.size(); ++i)
+        iSamples += qListBlocks[i].cols();
+
+    MetricsRegistry::addCounter(metricName("samples"), iSamples);
+}
@@ -71,6 +71,16 @@ namespace SCSHAREDLIB
 
 class IPlugin;
 
+} // NAMESPACE
+
+namespace SCMEASLIB
+{
+class NewMeasurement;
+}
+
+namespace SCSHAREDLIB
+{
+
 
 //=============================================================================================================
 /**
@@ -130,6 +140,34 @@ signals:
 
 
 protected:
+    //=========================================================================================================
+    /**
+     * Records the latency of data passing this connector with the LatencyMonitor. The stage is named after the
+     * plugin and the connector, i.e. "Noise Reduction/NoiseReductionOut (out)".
+     *
+     * @param[in] iTimestamp     the pipeline entry time of the data, see NewMeasurement::getTimestamp().
+     */
+    void recordLatency(qint64 iTimestamp) const;
+
+    //=========================================================================================================
+    /**
+     * Returns the name of a metric of this connector in the MetricsRegistry, i.e.
+     * "Noise Reduction/NoiseReductionOut (out): samples".
+     *
+     * @param[in] sQuantity      the measured quantity.
+     *
+     * @return the metric name.
+     */
+    QString metricName(const QString& sQuantity) const;
+
+    //=========================================================================================================
+    /**
+     * Counts the blocks and, for sample arrays, the samples which pass this connector in the MetricsRegistry.
+     *
+     * @param[in] pMeasurement   the measurement which notified.
+     */
+    void recordThroughput(const QSharedPointer<SCMEASLIB::NewMeasurement>& pMeasurement) const;
+
     IPlugin* m_pPlugin;  /**< Plugin to which connector belongs to */
 
     //actual obeserver pattern - think of an other implementation --> currently similiar to OpenWalnut
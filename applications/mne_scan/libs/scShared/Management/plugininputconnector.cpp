@@ -41,6 +41,22 @@
 #include "plugininputconnector.h"
 #include "../Interfaces/IPlugin.h"
 
+#include "metricsregistry.h"
+
+#include <scMeas/latencymonitor.h>
+
+#include <utils/tracer.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QMutexLocker>
+#include <QTimer>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -48,6 +64,8 @@
 //=============================================================================================================
 
 using namespace SCSHAREDLIB;
+using namespace SCMEASLIB;
+using namespace Eigen;
 
 
 //*************************************************************************************************************
@@ -57,7 +75,16 @@ using namespace SCSHAREDLIB;
 
 PluginInputConnector::PluginInputConnector(IPlugin *parent, const QString &name, const QString &descr)
 : PluginConnector(parent, name, descr)
+, m_iMinBlockSize(0)
+, m_iMaxBlockSize(0)
+, m_iLatencyBudgetMSec(50)
+, m_iPendingSamples(0)
+, m_pFlushTimer(new QTimer(this))
+, m_bFlushArmed(false)
 {
+    m_pFlushTimer->setSingleShot(true);
+    m_pFlushTimer->setInterval(m_iLatencyBudgetMSec);
+    connect(m_pFlushTimer, &QTimer::timeout, this, &PluginInputConnector::onFlushTimeout);
 }
 
 
@@ -77,9 +104,188 @@ bool PluginInputConnector::isOutputConnector() const
 }
 
 
+//*************************************************************************************************************
+
+void PluginInputConnector::setPreferredBlockSize(qint32 iMinSamples, qint32 iMaxSamples)
+{
+    m_iMinBlockSize = iMinSamples > 0 ? iMinSamples : 0;
+    QMutexLocker locker(&m_qMutex);
+
+    m_iMaxBlockSize = iMaxSamples > 0 ? qMax(iMaxSamples, m_iMinBlockSize) : 0;
+
+    //Force a new setup with the next block
+    m_pBatchSource.clear();
+}
+
+
+//*************************************************************************************************************
+
+void PluginInputConnector::setLatencyBudget(qint32 iMSec)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    m_iLatencyBudgetMSec = iMSec > 0 ? iMSec : 0;
+    m_pFlushTimer->setInterval(m_iLatencyBudgetMSec);
+}
+
+
 //*************************************************************************************************************
 
 void PluginInputConnector::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 {
+    MNE_TRACE_SCOPE("PluginInputConnector::update", "mne_scan");
+
+    if(pMeasurement)
+        recordLatency(pMeasurement->getTimestamp());
+
+    NewRealTimeMultiSampleArray::SPtr pRTMSA;
+    if(isBatching())
+        pRTMSA = pMeasurement.dynamicCast<NewRealTimeMultiSampleArray>();
+
+    if(!pRTMSA || !pRTMSA->isChInit()) {
+        dispatch(pMeasurement);
+        return;
+    }
+
+    QMutexLocker locker(&m_qMutex);
+
+    if(pMeasurement != m_pBatchSource)
+        initBatch(pRTMSA);
+
+    //Queue the new blocks, this only shares their buffers
+    const QList<MatrixBlock>& qListBlocks = pRTMSA->getMultiSampleArray();
+    const QList<qint64>& qListTimestamps = pRTMSA->getTimestamps();
+
+    for(int i = 0; i < qListBlocks.size(); ++i) {
+        if(qListBlocks[i].rows() != (int)m_pBatch->getNumChannels()) {
+            qWarning() << "PluginInputConnector::update - Block dimension does not match the number of channels, skipping block";
+            continue;
+        }
+
+        m_qListPending.append(qListBlocks[i]);
+        m_qListPendingTimestamps.append(qListTimestamps.value(i, -1));
+        m_iPendingSamples += qListBlocks[i].cols();
+    }
+
+    //The latency budget caps the number of samples which are held back
+    qint32 iTarget = m_iMinBlockSize;
+    double dSFreq = m_pBatch->getSamplingRate();
+    if(m_iLatencyBudgetMSec > 0 && dSFreq > 0)
+        iTarget = qMax(1, qMin(iTarget, (qint32)(m_iLatencyBudgetMSec * dSFreq / 1000.0)));
+
+    while(m_iPendingSamples > 0 && m_iPendingSamples >= iTarget)
+        sendBatch(m_iMaxBlockSize > 0 ? qMin(m_iPendingSamples, m_iMaxBlockSize) : m_iPendingSamples);
+
+    //Arm the flush for the held back samples, update() is called from the thread of the sending plugin
+    if(m_iPendingSamples == 0) {
+        m_bFlushArmed = false;
+    } else if(!m_bFlushArmed && m_iLatencyBudgetMSec > 0) {
+        m_bFlushArmed = true;
+        QMetaObject::invokeMethod(m_pFlushTimer, "start", Qt::QueuedConnection);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void PluginInputConnector::initBatch(const NewRealTimeMultiSampleArray::SPtr& pSource)
+{
+    m_pBatch = NewRealTimeMultiSampleArray::SPtr(new NewRealTimeMultiSampleArray);
+
+    if(pSource->info()) {
+        m_pBatch->initFromFiffInfo(pSource->info());
+    } else {
+        m_pBatch->init(pSource->chInfo());
+        m_pBatch->setSamplingRate(pSource->getSamplingRate());
+    }
+
+    m_pBatch->setName(pSource->getName());
+    m_pBatch->setVisibility(pSource->isVisible());
+    m_pBatch->setXMLLayoutFile(pSource->getXMLLayoutFile());
+    m_pBatch->setDisplayFlags(pSource->getDisplayFlags());
+    m_pBatch->setMultiArraySize(1);
+
+    connect(m_pBatch.data(), &NewMeasurement::notify, this, &PluginInputConnector::onBatchNotify, Qt::DirectConnection);
+
+    m_pBatchSource = pSource;
+    m_qListPending.clear();
+    m_qListPendingTimestamps.clear();
+    m_iPendingSamples = 0;
+    m_bFlushArmed = false;
+}
+
+
+//*************************************************************************************************************
+
+void PluginInputConnector::sendBatch(qint32 iSamples)
+{
+    qint64 iTimestamp = m_qListPendingTimestamps.first();
+
+    //A block which fits the batch exactly is passed on as it is
+    if(m_qListPending.first().cols() == iSamples) {
+        MatrixBlock block = m_qListPending.takeFirst();
+        m_qListPendingTimestamps.removeFirst();
+        m_iPendingSamples -= iSamples;
+
+        m_pBatch->setValue(block, iTimestamp);
+        return;
+    }
+
+    if(m_matBatch.rows() != m_qListPending.first().rows() || m_matBatch.cols() != iSamples)
+        m_matBatch.resize(m_qListPending.first().rows(), iSamples);
+
+    qint32 iFilled = 0;
+    while(iFilled < iSamples) {
+        const MatrixXd& matBlock = m_qListPending.first().matrix();
+        qint32 iTake = qMin((qint32)matBlock.cols(), iSamples - iFilled);
+
+        m_matBatch.middleCols(iFilled, iTake) = matBlock.leftCols(iTake);
+        iFilled += iTake;
+
+        if(iTake == matBlock.cols()) {
+            m_qListPending.removeFirst();
+            m_qListPendingTimestamps.removeFirst();
+        } else {
+            //Keep the rest of a split block for the next batch
+            MatrixXd matRest = matBlock.rightCols(matBlock.cols() - iTake);
+            m_qListPending.first() = MatrixBlock(std::move(matRest));
+        }
+    }
+
+    m_iPendingSamples -= iSamples;
+
+    m_pBatch->setValue(m_matBatch, iTimestamp);
+}
+
+
+//*************************************************************************************************************
+
+void PluginInputConnector::onBatchNotify()
+{
+    dispatch(m_pBatch);
+}
+
+
+//*************************************************************************************************************
+
+void PluginInputConnector::onFlushTimeout()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    m_bFlushArmed = false;
+
+    while(m_iPendingSamples > 0)
+        sendBatch(m_iMaxBlockSize > 0 ? qMin(m_iPendingSamples, m_iMaxBlockSize) : m_iPendingSamples);
+}
+
+
+//*************************************************************************************************************
+
+void PluginInputConnector::dispatch(const NewMeasurement::SPtr& pMeasurement)
+{
+    qint64 iStart = LatencyMonitor::now();
+
     emit notify(pMeasurement);
+
+    MetricsRegistry::recordDuration(metricName("update time"), LatencyMonitor::now() - iStart);
 }
@@ -45,6 +45,7 @@
 #include "pluginconnector.h"
 
 #include <scMeas/newmeasurement.h>
+#include <scMeas/newrealtimemultisamplearray.h>
 
 
 //*************************************************************************************************************
@@ -53,6 +54,24 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QList>
+#include <QMutex>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class QTimer;
 
 
 //*************************************************************************************************************
@@ -67,6 +86,13 @@ namespace SCSHAREDLIB
 /**
 * Base class to connect plug-in data streams.
 *
+* By default every notification of the connected output is passed on as it is. A plugin can opt in to batching
+* by declaring its preferred block size with setPreferredBlockSize(). The connector then coalesces the samples of
+* consecutive NewRealTimeMultiSampleArray blocks and notifies with one block of at least the minimum and at most
+* the maximum size. The latency budget caps the number of samples the connector holds back, so small drivers are
+* not stalled by a large minimum size. Samples which are still held back when the budget has passed are flushed,
+* even if no further block arrives. Other measurement types are always passed on unchanged.
+*
 * @brief The PluginConnector class provides the base to connect plug-in data
 */
 class SCSHAREDSHARED_EXPORT PluginInputConnector : public PluginConnector
@@ -108,6 +134,32 @@ public:
      */
     virtual bool isOutputConnector() const;
 
+    //=========================================================================================================
+    /**
+     * Enables batching of NewRealTimeMultiSampleArray blocks. Call before the measurement is started.
+     *
+     * @param[in] iMinSamples    minimum number of samples per notified block. 0 disables batching (default).
+     * @param[in] iMaxSamples    maximum number of samples per notified block. 0 for no limit (default).
+     */
+    void setPreferredBlockSize(qint32 iMinSamples, qint32 iMaxSamples = 0);
+
+    //=========================================================================================================
+    /**
+     * Sets the maximum time worth of samples which is held back while batching. Default is 50 ms.
+     *
+     * @param[in] iMSec          the latency budget in milliseconds. 0 for no limit, samples are then only sent
+     *                           once the minimum block size is reached.
+     */
+    void setLatencyBudget(qint32 iMSec);
+
+    //=========================================================================================================
+    /**
+     * Returns whether this connector batches incoming blocks.
+     *
+     * @return true if batching is enabled.
+     */
+    inline bool isBatching() const;
+
 
 signals:
     void notify(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
@@ -115,10 +167,70 @@ signals:
 public slots:
     void update(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
 
+private:
+    //=========================================================================================================
+    /**
+     * Sets up the batch measurement as a copy of the source description and drops all pending samples.
+     *
+     * @param[in] pSource        the measurement the blocks are taken from.
+     */
+    void initBatch(const SCMEASLIB::NewRealTimeMultiSampleArray::SPtr& pSource);
+
+    //=========================================================================================================
+    /**
+     * Moves the first iSamples pending samples to the batch measurement, which in turn notifies.
+     *
+     * @param[in] iSamples       number of samples to send.
+     */
+    void sendBatch(qint32 iSamples);
 
+    //=========================================================================================================
+    /**
+     * Passes the notification of the batch measurement on.
+     */
+    void onBatchNotify();
 
+    //=========================================================================================================
+    /**
+     * Sends all samples which are still pending once the latency budget has passed.
+     */
+    void onFlushTimeout();
+
+    //=========================================================================================================
+    /**
+     * Notifies the receiving plugin and records the time its update took in the MetricsRegistry.
+     *
+     * @param[in] pMeasurement   the measurement to pass on.
+     */
+    void dispatch(const SCMEASLIB::NewMeasurement::SPtr& pMeasurement);
+
+    qint32                                          m_iMinBlockSize;            /**< Minimum samples per batch, 0 if batching is disabled. */
+    qint32                                          m_iMaxBlockSize;            /**< Maximum samples per batch, 0 for no limit. */
+    qint32                                          m_iLatencyBudgetMSec;       /**< Maximum time worth of samples held back. */
+
+    SCMEASLIB::NewMeasurement::SPtr                 m_pBatchSource;             /**< The measurement the pending samples were taken from. */
+    SCMEASLIB::NewRealTimeMultiSampleArray::SPtr    m_pBatch;                   /**< The measurement the batches are sent with. */
+    QList<SCMEASLIB::MatrixBlock>                   m_qListPending;             /**< Blocks which were not sent yet. */
+    QList<qint64>                                   m_qListPendingTimestamps;   /**< Pipeline entry times of the pending blocks. */
+    qint32                                          m_iPendingSamples;          /**< Number of pending samples. */
+    Eigen::MatrixXd                                 m_matBatch;                 /**< Storage of the batch which is being sent. */
+
+    QMutex                                          m_qMutex;                   /**< Guards the pending samples, update() and the flush timer run in different threads. */
+    QTimer*                                         m_pFlushTimer;              /**< Single shot timer which flushes the pending samples after the latency budget. */
+    bool                                            m_bFlushArmed;              /**< Whether the flush timer was started for the pending samples. */
 };
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool PluginInputConnector::isBatching() const
+{
+    return m_iMinBlockSize > 0;
+}
+
 } // NAMESPACE
 
 #endif // PLUGININPUTCONNECTOR_H
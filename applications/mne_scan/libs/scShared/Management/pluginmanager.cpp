@@ -53,6 +53,8 @@
 
 #include <QDir>
 #include <QDebug>
+#include <QJsonObject>
+#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -63,6 +65,17 @@
 using namespace SCSHAREDLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+static void loadLibrary(QPluginLoader*& pLoader)
+{
+    pLoader->load();
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -90,57 +103,76 @@ void PluginManager::loadPlugins(const QString& dir)
 
     foreach(QString file, PluginsDir.entryList(QDir::Files))
     {
-        this->setFileName(PluginsDir.absoluteFilePath(file));
-        QObject *pPlugin = this->instance();
+        QPluginLoader* pLoader = new QPluginLoader(PluginsDir.absoluteFilePath(file), this);
 
-        // IPlugin
-        if(pPlugin)
+        // The metadata is read from the file, the library itself is not loaded
+        QJsonObject metaData = pLoader->metaData();
+        if(metaData.value("IID").toString().isEmpty())
         {
-            qDebug() << "Try to load Plugin " << file;
-
-            // plugins are always disabled when they are first loaded
-            m_qVecPlugins.push_back(qobject_cast<IPlugin*>(pPlugin));
+            delete pLoader;
+            continue;
+        }
 
-            IPlugin::PluginType pluginType = qobject_cast<IPlugin*>(pPlugin)->getType();
+        QString sName = metaData.value("MetaData").toObject().value("name").toString();
+        QString sType = metaData.value("MetaData").toObject().value("type").toString();
 
-            // ISensor
-            if(pluginType == IPlugin::_ISensor)
-            {
-                ISensor* pSensor = qobject_cast<ISensor*>(pPlugin);
-                if(pSensor)
-                {
-                    m_qVecSensorPlugins.push_back(pSensor);
-                    qDebug() << "Sensor " << pSensor->getName() << " loaded.";
-                }
-            }
-            // IAlgorithm
-            else if(pluginType == IPlugin::_IAlgorithm)
+        if(!sName.isEmpty() && (sType == "sensor" || sType == "algorithm" || sType == "io"))
+        {
+            if(findByName(sName) >= 0)
             {
-                IAlgorithm* pAlgorithm = qobject_cast<IAlgorithm*>(pPlugin);
-                if(pAlgorithm)
-                {
-                    m_qVecAlgorithmPlugins.push_back(pAlgorithm);
-                    qDebug() << "RTAlgorithm " << pAlgorithm->getName() << " loaded.";
-                }
+                delete pLoader;
+                continue;
             }
-            // IIO
-            else if(pluginType == IPlugin::_IIO)
+
+            IPlugin::PluginType pluginType = IPlugin::_IIO;
+            if(sType == "sensor")
+                pluginType = IPlugin::_ISensor;
+            else if(sType == "algorithm")
+                pluginType = IPlugin::_IAlgorithm;
+
+            registerPlugin(pLoader, sName, pluginType);
+            qDebug() << "Plugin " << sName << " registered.";
+        }
+        else
+        {
+            // Without metadata name and type are only known from the instance
+            qDebug() << "Try to load Plugin " << file;
+
+            IPlugin* pPlugin = qobject_cast<IPlugin*>(pLoader->instance());
+            if(!pPlugin || findByName(pPlugin->getName()) >= 0)
             {
-                IIO* pIO = qobject_cast<IIO*>(pPlugin);
-                if(pIO)
-                {
-                    m_qVecIOPlugins.push_back(pIO);
-                    qDebug() << "RTVisualization " << pIO->getName() << " loaded.";
-                }
+                delete pLoader;
+                continue;
             }
 
-            //ToDo other Plugins - like Visualization
+            addInstance(registerPlugin(pLoader, pPlugin->getName(), pPlugin->getType()), pPlugin);
+        }
+    }
+}
+
 
+//*************************************************************************************************************
+
+void PluginManager::instantiatePlugins(const QStringList& names)
+{
+    QList<int> qListIdx;
+    QList<QPluginLoader*> qListLoaders;
+
+    foreach(QString name, names)
+    {
+        int idx = findByName(name);
+        if(idx >= 0 && !m_qVecPlugins[idx] && !qListIdx.contains(idx))
+        {
+            qListIdx.append(idx);
+            qListLoaders.append(m_qVecLoaders[idx]);
         }
-//        else
-//            qDebug() << "Plugin " << file << " could not be instantiated!";
     }
 
+    // The plugin libraries are independent of each other. Their objects have to live in this thread though.
+    QtConcurrent::blockingMap(qListLoaders, loadLibrary);
+
+    for(int i = 0; i < qListIdx.size(); ++i)
+        getPlugin(qListIdx[i]);
 }
 
 
@@ -148,10 +180,95 @@ void PluginManager::loadPlugins(const QString& dir)
 
 int PluginManager::findByName(const QString& name)
 {
-    QVector<IPlugin*>::const_iterator it = m_qVecPlugins.begin();
-    for(int i = 0; it != m_qVecPlugins.end(); ++i, ++it)
-        if((*it)->getName() == name)
-            return i;
+    return m_qListNames.indexOf(name);
+}
+
+
+//*************************************************************************************************************
+
+IPlugin* PluginManager::getPlugin(int idx)
+{
+    if(idx < 0 || idx >= m_qVecPlugins.size())
+        return Q_NULLPTR;
+
+    if(!m_qVecPlugins[idx])
+    {
+        IPlugin* pPlugin = qobject_cast<IPlugin*>(m_qVecLoaders[idx]->instance());
+        if(!pPlugin)
+        {
+            qWarning() << "Plugin " << m_qListNames[idx] << " could not be instantiated: " << m_qVecLoaders[idx]->errorString();
+            return Q_NULLPTR;
+        }
+        addInstance(idx, pPlugin);
+    }
+
+    return m_qVecPlugins[idx];
+}
+
+
+//*************************************************************************************************************
+
+QStringList PluginManager::getPluginNames(IPlugin::PluginType type) const
+{
+    QStringList names;
+    for(int i = 0; i < m_qListNames.size(); ++i)
+        if(m_qVecTypes[i] == type)
+            names.append(m_qListNames[i]);
+
+    return names;
+}
+
+
+//*************************************************************************************************************
+
+int PluginManager::registerPlugin(QPluginLoader* pLoader, const QString& name, IPlugin::PluginType type)
+{
+    m_qVecLoaders.push_back(pLoader);
+    m_qListNames.append(name);
+    m_qVecTypes.push_back(type);
+    m_qVecPlugins.push_back(Q_NULLPTR);
+
+    return m_qVecPlugins.size()-1;
+}
+
+
+//*************************************************************************************************************
+
+void PluginManager::addInstance(int idx, IPlugin* pPlugin)
+{
+    // plugins are always disabled when they are first loaded
+    m_qVecPlugins[idx] = pPlugin;
+
+    // ISensor
+    if(m_qVecTypes[idx] == IPlugin::_ISensor)
+    {
+        ISensor* pSensor = qobject_cast<ISensor*>(pPlugin);
+        if(pSensor)
+        {
+            m_qVecSensorPlugins.push_back(pSensor);
+            qDebug() << "Sensor " << pSensor->getName() << " loaded.";
+        }
+    }
+    // IAlgorithm
+    else if(m_qVecTypes[idx] == IPlugin::_IAlgorithm)
+    {
+        IAlgorithm* pAlgorithm = qobject_cast<IAlgorithm*>(pPlugin);
+        if(pAlgorithm)
+        {
+            m_qVecAlgorithmPlugins.push_back(pAlgorithm);
+            qDebug() << "RTAlgorithm " << pAlgorithm->getName() << " loaded.";
+        }
+    }
+    // IIO
+    else if(m_qVecTypes[idx] == IPlugin::_IIO)
+    {
+        IIO* pIO = qobject_cast<IIO*>(pPlugin);
+        if(pIO)
+        {
+            m_qVecIOPlugins.push_back(pIO);
+            qDebug() << "RTVisualization " << pIO->getName() << " loaded.";
+        }
+    }
 
-    return -1;
+    //ToDo other Plugins - like Visualization
 }
@@ -42,6 +42,7 @@
 //=============================================================================================================
 
 #include "../scshared_global.h"
+#include "../Interfaces/IPlugin.h"
 
 
 //*************************************************************************************************************
@@ -50,6 +51,7 @@
 //=============================================================================================================
 
 #include <QVector>
+#include <QStringList>
 #include <QPluginLoader>
 
 
@@ -67,7 +69,6 @@ namespace SCSHAREDLIB
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
-class IPlugin;
 class ISensor;
 class IAlgorithm;
 class IIO;
@@ -106,12 +107,23 @@ public:
 
     //=========================================================================================================
     /**
-    * Loads plugins from given directory.
+    * Registers the plugins of the given directory. Name and type are read from the plugin metadata without
+    * loading the libraries, a plugin is instantiated when it is first requested with getPlugin. Plugins
+    * without name and type in their metadata are instantiated right away.
     *
     * @param [in] dir   the plugin directory.
     */
     void loadPlugins(const QString& dir);
 
+    //=========================================================================================================
+    /**
+    * Instantiates the given plugins, e.g. the ones of a scene which is restored. The libraries are loaded
+    * concurrently, the plugin objects are created in the calling thread afterwards.
+    *
+    * @param [in] names the plugin names.
+    */
+    void instantiatePlugins(const QStringList& names);
+
     //=========================================================================================================
     /**
     * Finds index of plugin by name.
@@ -124,7 +136,27 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns vector containing all plugins.
+    * Returns the plugin at the given index and instantiates it if needed.
+    *
+    * @param [in] idx   index of the plugin, see findByName.
+    *
+    * @return the plugin, NULL if it could not be instantiated.
+    */
+    IPlugin* getPlugin(int idx);
+
+    //=========================================================================================================
+    /**
+    * Returns the names of all registered plugins of the given type.
+    *
+    * @param [in] type  the plugin type.
+    *
+    * @return the plugin names.
+    */
+    QStringList getPluginNames(IPlugin::PluginType type) const;
+
+    //=========================================================================================================
+    /**
+    * Returns vector containing all plugins, plugins which are not instantiated yet are NULL.
     *
     * @return reference to vector containing all plugins.
     */
@@ -132,7 +164,7 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns vector containing ISensor plugins.
+    * Returns vector containing the instantiated ISensor plugins.
     *
     * @return reference to vector containing ISensor plugins.
     */
@@ -140,7 +172,7 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns vector containing IAlgorithm plugins
+    * Returns vector containing the instantiated IAlgorithm plugins
     *
     * @return reference to vector containing IRTAlgorithm plugins
     */
@@ -148,7 +180,7 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns vector containing IIO plugins
+    * Returns vector containing the instantiated IIO plugins
     *
     * @return reference to vector containing IRTVisulaiztaion plugins
     */
@@ -156,7 +188,32 @@ public:
 
 
 private:
-    QVector<IPlugin*>    m_qVecPlugins;             /**< Vector of all plugins. */
+    //=========================================================================================================
+    /**
+    * Registers a plugin.
+    *
+    * @param [in] pLoader   the loader of the plugin library.
+    * @param [in] name      the plugin name.
+    * @param [in] type      the plugin type.
+    *
+    * @return index of the plugin.
+    */
+    int registerPlugin(QPluginLoader* pLoader, const QString& name, IPlugin::PluginType type);
+
+    //=========================================================================================================
+    /**
+    * Stores an instantiated plugin and sorts it into the vector of its type.
+    *
+    * @param [in] idx       index of the plugin.
+    * @param [in] pPlugin   the plugin instance.
+    */
+    void addInstance(int idx, IPlugin* pPlugin);
+
+    QVector<QPluginLoader*>         m_qVecLoaders;      /**< Loader of each registered plugin. */
+    QStringList                     m_qListNames;       /**< Name of each registered plugin. */
+    QVector<IPlugin::PluginType>    m_qVecTypes;        /**< Type of each registered plugin. */
+
+    QVector<IPlugin*>    m_qVecPlugins;             /**< Vector of all plugins, NULL until instantiated. */
 
     QVector<ISensor*>    m_qVecSensorPlugins;       /**< Vector of all ISensor plugins. */
     QVector<IAlgorithm*> m_qVecAlgorithmPlugins;    /**< Vector of all IAlgorithm plugins. */
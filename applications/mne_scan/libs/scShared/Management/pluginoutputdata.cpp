@@ -90,7 +90,12 @@ PluginOutputData<T>::PluginOutputData(IPlugin *parent, const QString &name, cons
 template <class T>
 void PluginOutputData<T>::update()
 {
-    emit notify(qSharedPointerDynamicCast<SCMEASLIB::NewMeasurement>(m_pMeasurement));
+    QSharedPointer<SCMEASLIB::NewMeasurement> t_measurement = qSharedPointerDynamicCast<SCMEASLIB::NewMeasurement>(m_pMeasurement);
+
+    recordLatency(t_measurement->getTimestamp());
+    recordThroughput(t_measurement);
+
+    emit notify(t_measurement);
 }
 
 }//Namespace
@@ -37,7 +37,7 @@ include(../../../../mne-cpp.pri)
 
 TEMPLATE = lib
 
-QT += widgets svg
+QT += widgets svg concurrent
 
 DEFINES += SCSHARED_LIBRARY
 
@@ -76,7 +76,9 @@ SOURCES += \
     Management/pluginconnectorconnection.cpp \
     Management/pluginconnectorconnectionwidget.cpp \
     Management/pluginscenemanager.cpp \
-    Management/displaymanager.cpp
+    Management/displaymanager.cpp \
+    Management/amplifierproducer.cpp \
+    Management/metricsregistry.cpp
 
 HEADERS += \
     scshared_global.h \
@@ -93,7 +95,9 @@ HEADERS += \
     Management/pluginconnectorconnection.h \
     Management/pluginconnectorconnectionwidget.h \
     Management/pluginscenemanager.h \
-    Management/displaymanager.h
+    Management/displaymanager.h \
+    Management/amplifierproducer.h \
+    Management/metricsregistry.h
 
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
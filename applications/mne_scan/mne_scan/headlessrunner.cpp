@@ -0,0 +1,339 @@
+//=============================================================================================================
+/**
+* @file     headlessrunner.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the implementation of the HeadlessRunner class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "headlessrunner.h"
+
+#include <scShared/Management/pluginmanager.h>
+#include <scShared/Management/pluginscenemanager.h>
+#include <scShared/Management/pluginconnectorconnection.h>
+#include <scShared/Management/pluginoutputconnector.h>
+#include <scShared/Management/metricsregistry.h>
+
+#include <scMeas/newrealtimemultisamplearray.h>
+#include <scMeas/latencymonitor.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QCoreApplication>
+#include <QDomDocument>
+#include <QFile>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNESCAN;
+using namespace SCSHAREDLIB;
+using namespace SCMEASLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// CONST
+//=============================================================================================================
+
+extern const char* pluginDir;       /**< holds path to plugins, defined next to the MainWindow.*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+HeadlessRunner::HeadlessRunner(QObject *parent)
+: QObject(parent)
+, m_pPluginManager(new PluginManager)
+, m_pPluginSceneManager(new PluginSceneManager)
+, m_iLastReportMSec(0)
+, m_bIsRunning(false)
+{
+    m_pPluginManager->loadPlugins(QCoreApplication::applicationDirPath()+pluginDir);
+
+    connect(&m_timerReport, &QTimer::timeout, this, [this]() {
+        report(false);
+    });
+}
+
+
+//*************************************************************************************************************
+
+HeadlessRunner::~HeadlessRunner()
+{
+    if(m_bIsRunning)
+        stop();
+
+    m_qListConnections.clear();
+    m_pPluginSceneManager->clear();
+}
+
+
+//*************************************************************************************************************
+
+bool HeadlessRunner::loadConfig(const QString& sFilePath)
+{
+    QDomDocument doc("PluginConfig");
+    QFile file(sFilePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "HeadlessRunner::loadConfig - Could not open" << sFilePath;
+        return false;
+    }
+    if (!doc.setContent(&file)) {
+        qWarning() << "HeadlessRunner::loadConfig - Could not parse" << sFilePath;
+        file.close();
+        return false;
+    }
+    file.close();
+
+    QDomElement docElem = doc.documentElement();
+    if(docElem.tagName() != "PluginTree") {
+        qWarning() << "HeadlessRunner::loadConfig -" << sFilePath << "is no plugin configuration";
+        return false;
+    }
+
+    //
+    // Instantiate the plugins of the scene first, their libraries are loaded concurrently
+    //
+    QStringList qListPluginNames;
+    QDomNodeList qListPluginNodes = docElem.elementsByTagName("Plugin");
+    for(int i = 0; i < qListPluginNodes.size(); ++i)
+        qListPluginNames.append(qListPluginNodes.at(i).toElement().attribute("name"));
+    m_pPluginManager->instantiatePlugins(qListPluginNames);
+
+    QDomNode nodePluginTree = docElem.firstChild();
+    while(!nodePluginTree.isNull()) {
+        QDomElement elementPluginTree = nodePluginTree.toElement();
+        //
+        // Create Plugins, the scene positions are of no use here
+        //
+        if(elementPluginTree.tagName() == "Plugins") {
+            QDomNode nodePlugins = elementPluginTree.firstChild();
+            while(!nodePlugins.isNull()) {
+                QDomElement e = nodePlugins.toElement();
+                nodePlugins = nodePlugins.nextSibling();
+                if(e.isNull())
+                    continue;
+
+                qint32 idx = m_pPluginManager->findByName(e.attribute("name"));
+                if(idx < 0) {
+                    qWarning() << "HeadlessRunner::loadConfig - Plugin" << e.attribute("name") << "is not available";
+                    continue;
+                }
+
+                IPlugin* pPlugin = m_pPluginManager->getPlugin(idx);
+                IPlugin::SPtr pAddedPlugin;
+                if(!pPlugin || !m_pPluginSceneManager->addPlugin(pPlugin, pAddedPlugin))
+                    qWarning() << "HeadlessRunner::loadConfig - Could not add plugin" << e.attribute("name");
+            }
+        }
+        //
+        // Create Connections
+        //
+        if(elementPluginTree.tagName() == "Connections") {
+            QDomNode nodeConnections = elementPluginTree.firstChild();
+            while(!nodeConnections.isNull()) {
+                QDomElement e = nodeConnections.toElement();
+                nodeConnections = nodeConnections.nextSibling();
+                if(e.isNull())
+                    continue;
+
+                IPlugin::SPtr pSender, pReceiver;
+                const PluginSceneManager::PluginList& lPlugins = m_pPluginSceneManager->getPlugins();
+                for(qint32 i = 0; i < lPlugins.size(); ++i) {
+                    if(lPlugins[i]->getName() == e.attribute("sender"))
+                        pSender = lPlugins[i];
+                    if(lPlugins[i]->getName() == e.attribute("receiver"))
+                        pReceiver = lPlugins[i];
+                }
+
+                if(!pSender || !pReceiver)
+                    continue;
+
+                PluginConnectorConnection::SPtr pConnection = PluginConnectorConnection::create(pSender, pReceiver);
+                if(pConnection->isConnected())
+                    m_qListConnections.append(pConnection);
+                else
+                    qWarning() << "HeadlessRunner::loadConfig - Could not connect" << e.attribute("sender") << "to" << e.attribute("receiver");
+            }
+        }
+        nodePluginTree = nodePluginTree.nextSibling();
+    }
+
+    return !m_pPluginSceneManager->getPlugins().isEmpty();
+}
+
+
+//*************************************************************************************************************
+
+bool HeadlessRunner::start(int iDurationSec, int iIntervalSec)
+{
+    LatencyMonitor::reset();
+
+    //Count every block which leaves a plugin, the counters run in the threads of the plugins
+    m_qListThroughput.clear();
+    const PluginSceneManager::PluginList& lPlugins = m_pPluginSceneManager->getPlugins();
+    for(qint32 i = 0; i < lPlugins.size(); ++i) {
+        for(qint32 j = 0; j < lPlugins[i]->getOutputConnectors().size(); ++j) {
+            PluginOutputConnector::SPtr pOutput = lPlugins[i]->getOutputConnectors()[j];
+
+            Throughput throughput;
+            throughput.sName = QString("%1/%2").arg(lPlugins[i]->getName()).arg(pOutput->getName());
+            throughput.dSFreq = 0.0;
+            throughput.iBlocks = throughput.iSamples = throughput.iBlocksLast = throughput.iSamplesLast = 0;
+
+            int iIdx = m_qListThroughput.size();
+            m_qListThroughput.append(throughput);
+
+            connect(pOutput.data(), &PluginOutputConnector::notify, this, [this, iIdx](NewMeasurement::SPtr pMeasurement) {
+                countBlock(iIdx, pMeasurement);
+            }, Qt::DirectConnection);
+        }
+    }
+
+    if(!m_pPluginSceneManager->startPlugins()) {
+        qWarning() << "HeadlessRunner::start - Not able to start at least one sensor plugin!";
+        return false;
+    }
+
+    m_bIsRunning = true;
+    m_timerRun.start();
+    m_iLastReportMSec = 0;
+
+    if(iIntervalSec > 0)
+        m_timerReport.start(iIntervalSec*1000);
+
+    if(iDurationSec > 0) {
+        QTimer::singleShot(iDurationSec*1000, this, [this]() {
+            stop();
+            QCoreApplication::quit();
+        });
+    }
+
+    qDebug() << "HeadlessRunner - Pipeline with" << lPlugins.size() << "plugins started";
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void HeadlessRunner::stop()
+{
+    if(!m_bIsRunning)
+        return;
+
+    m_timerReport.stop();
+    m_pPluginSceneManager->stopPlugins();
+    m_bIsRunning = false;
+
+    report(true);
+
+    if(LatencyMonitor::isEnabled()) {
+        QStringList slReport = LatencyMonitor::report();
+        for(int i = 0; i < slReport.size(); ++i)
+            qDebug() << qPrintable(slReport[i]);
+    }
+
+    QStringList slMetrics = MetricsRegistry::report();
+    for(int i = 0; i < slMetrics.size(); ++i)
+        qDebug() << qPrintable(slMetrics[i]);
+}
+
+
+//*************************************************************************************************************
+
+void HeadlessRunner::countBlock(int iIdx, NewMeasurement::SPtr pMeasurement)
+{
+    qint64 iSamples = 0;
+    double dSFreq = 0.0;
+
+    if(NewRealTimeMultiSampleArray::SPtr pRTMSA = pMeasurement.dynamicCast<NewRealTimeMultiSampleArray>()) {
+        const QList<MatrixBlock>& lBlocks = pRTMSA->getMultiSampleArray();
+        for(int i = 0; i < lBlocks.size(); ++i)
+            iSamples += lBlocks[i].cols();
+        dSFreq = pRTMSA->getSamplingRate();
+    }
+
+    QMutexLocker locker(&m_qMutex);
+    Throughput& throughput = m_qListThroughput[iIdx];
+    ++throughput.iBlocks;
+    throughput.iSamples += iSamples;
+    if(dSFreq > 0.0)
+        throughput.dSFreq = dSFreq;
+}
+
+
+//*************************************************************************************************************
+
+void HeadlessRunner::report(bool bTotal)
+{
+    qint64 iNowMSec = m_timerRun.elapsed();
+    double dSec = (bTotal ? iNowMSec : iNowMSec - m_iLastReportMSec) / 1000.0;
+    m_iLastReportMSec = iNowMSec;
+
+    if(dSec <= 0.0)
+        return;
+
+    qDebug() << qPrintable(QString("HeadlessRunner - %1 after %2 s").arg(bTotal ? "Summary" : "Throughput").arg(iNowMSec / 1000.0, 0, 'f', 1));
+
+    QMutexLocker locker(&m_qMutex);
+    for(int i = 0; i < m_qListThroughput.size(); ++i) {
+        Throughput& throughput = m_qListThroughput[i];
+
+        qint64 iBlocks = bTotal ? throughput.iBlocks : throughput.iBlocks - throughput.iBlocksLast;
+        qint64 iSamples = bTotal ? throughput.iSamples : throughput.iSamples - throughput.iSamplesLast;
+        throughput.iBlocksLast = throughput.iBlocks;
+        throughput.iSamplesLast = throughput.iSamples;
+
+        //The real-time factor tells how much faster than the acquisition the output runs
+        QString sRate = QString("  %1: %2 blocks/s").arg(throughput.sName, -40).arg(iBlocks / dSec, 0, 'f', 1);
+        if(throughput.dSFreq > 0.0)
+            sRate += QString(", %1 samples/s (%2 x real-time)").arg(iSamples / dSec, 0, 'f', 0).arg(iSamples / dSec / throughput.dSFreq, 0, 'f', 2);
+
+        qDebug() << qPrintable(sRate);
+    }
+}
@@ -0,0 +1,185 @@
+//=============================================================================================================
+/**
+* @file     headlessrunner.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the HeadlessRunner class.
+*
+*/
+
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <scMeas/newmeasurement.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QList>
+#include <QMutex>
+#include <QTimer>
+#include <QElapsedTimer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+namespace SCSHAREDLIB
+{
+class PluginManager;
+class PluginSceneManager;
+class PluginConnectorConnection;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNESCAN
+//=============================================================================================================
+
+namespace MNESCAN
+{
+
+
+//=============================================================================================================
+/**
+* Runs a saved plugin scene without the main window. Only the plugins and their connections are created, no
+* display is attached to the measurements, so the pipeline runs at the rate of the sensor plugins. The data
+* rate of every plugin output is reported in regular intervals and when the run ends.
+*
+* @brief The HeadlessRunner class runs a pipeline without displays.
+*/
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+public:
+    typedef QSharedPointer<HeadlessRunner> SPtr;               /**< Shared pointer type for HeadlessRunner. */
+    typedef QSharedPointer<const HeadlessRunner> ConstSPtr;    /**< Const shared pointer type for HeadlessRunner. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a HeadlessRunner and loads the available plugins.
+    *
+    * @param [in] parent    pointer to parent Object.
+    */
+    explicit HeadlessRunner(QObject *parent = Q_NULLPTR);
+
+    //=========================================================================================================
+    /**
+    * Destroys the HeadlessRunner and stops the pipeline if it is still running.
+    */
+    ~HeadlessRunner();
+
+    //=========================================================================================================
+    /**
+    * Creates the plugins and connections of a configuration which was saved by the plugin scene.
+    *
+    * @param [in] sFilePath     path of the xml configuration.
+    *
+    * @return true if the configuration contains at least one plugin.
+    */
+    bool loadConfig(const QString& sFilePath);
+
+    //=========================================================================================================
+    /**
+    * Starts the pipeline.
+    *
+    * @param [in] iDurationSec      the run time after which the pipeline is stopped and the application quits,
+    *                               0 runs until the application is terminated.
+    * @param [in] iIntervalSec      the interval of the throughput reports, 0 reports only at the end.
+    *
+    * @return true if at least one sensor plugin was started.
+    */
+    bool start(int iDurationSec = 0, int iIntervalSec = 5);
+
+    //=========================================================================================================
+    /**
+    * Stops the pipeline and prints the summary.
+    */
+    void stop();
+
+private:
+    /**
+    * Throughput of one plugin output.
+    */
+    struct Throughput {
+        QString     sName;          /**< Plugin and connector name. */
+        double      dSFreq;         /**< Sampling rate of the output, 0 if the output is no sample array. */
+        qint64      iBlocks;        /**< Number of blocks sent. */
+        qint64      iSamples;       /**< Number of samples sent. */
+        qint64      iBlocksLast;    /**< Number of blocks at the last report. */
+        qint64      iSamplesLast;   /**< Number of samples at the last report. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Counts a block of an output, this is called from the thread of the sending plugin.
+    *
+    * @param [in] iIdx          index of the output.
+    * @param [in] pMeasurement  the sent measurement.
+    */
+    void countBlock(int iIdx, SCMEASLIB::NewMeasurement::SPtr pMeasurement);
+
+    //=========================================================================================================
+    /**
+    * Prints the throughput of every output.
+    *
+    * @param [in] bTotal    whether to report the averages of the whole run instead of the last interval.
+    */
+    void report(bool bTotal);
+
+    QSharedPointer<SCSHAREDLIB::PluginManager>          m_pPluginManager;           /**< Holds the available plugins. */
+    QSharedPointer<SCSHAREDLIB::PluginSceneManager>     m_pPluginSceneManager;      /**< Holds the plugins of the pipeline. */
+    QList<QSharedPointer<SCSHAREDLIB::PluginConnectorConnection> > m_qListConnections;  /**< The connections of the pipeline. */
+
+    QMutex                  m_qMutex;                   /**< Guards the throughput counters. */
+    QList<Throughput>       m_qListThroughput;          /**< Throughput per plugin output. */
+
+    QTimer                  m_timerReport;              /**< Triggers the throughput reports. */
+    QElapsedTimer           m_timerRun;                 /**< Measures the run time. */
+    qint64                  m_iLastReportMSec;          /**< Run time of the last report. */
+    bool                    m_bIsRunning;               /**< Whether the pipeline is running. */
+};
+
+} //NAMESPACE
+
+#endif // HEADLESSRUNNER_H
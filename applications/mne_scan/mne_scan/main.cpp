@@ -40,17 +40,21 @@
 
 #include "mainsplashscreen.h"
 #include "mainwindow.h"
+#include "headlessrunner.h"
 
 
 #include <scMeas/measurementtypes.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 #include <scMeas/newnumeric.h>
+#include <scMeas/latencymonitor.h>
 
 #include <scShared/Management/pluginconnectorconnection.h>
 #include <scShared/Management/pluginoutputdata.h>
 #include <scShared/Management/plugininputdata.h>
 #include <scShared/Interfaces/IPlugin.h>
 
+#include <utils/executionconfig.h>
+
 
 #include <Eigen/Core>
 
@@ -63,6 +67,7 @@
 #include <QtGui>
 #include <QApplication>
 #include <QSharedPointer>
+#include <QCommandLineParser>
 
 
 //*************************************************************************************************************
@@ -160,15 +165,61 @@ void customMessageHandler(QtMsgType type, const QMessageLogContext &context, con
 */
 int main(int argc, char *argv[])
 {
+    //A headless run needs no display, widgets which plugins create anyway are rendered offscreen
+    for(int i = 1; i < argc; ++i) {
+        if(QString(argv[i]).startsWith("--headless") && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+            break;
+        }
+    }
+
     QApplication app(argc, argv);
 
     //Store application info to use QSettings
     QCoreApplication::setOrganizationName("MNE-CPP");
     QCoreApplication::setOrganizationDomain("www.tu-ilmenau.de/mne-cpp");
     QCoreApplication::setApplicationName(CInfo::AppNameShort());
+    QCoreApplication::setApplicationVersion(CInfo::AppVersion());
 
     SCMEASLIB::MeasurementTypes::registerTypes();
 
+    QCommandLineParser parser;
+    parser.setApplicationDescription(CInfo::AppName());
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption headlessOption("headless", "Runs the pipeline of the plugin configuration <file> without any displays.", "file");
+    QCommandLineOption durationOption("duration", "Stops a headless run after <sec> seconds, by default it runs until terminated.", "sec", "0");
+    QCommandLineOption statsOption("stats-interval", "Reports the throughput of a headless run every <sec> seconds.", "sec", "5");
+    QCommandLineOption latencyOption("latency", "Records the pipeline latencies of a headless run.");
+
+    parser.addOption(headlessOption);
+    parser.addOption(durationOption);
+    parser.addOption(statsOption);
+    parser.addOption(latencyOption);
+    parser.addOption(UTILSLIB::ExecutionConfig::commandLineOption());
+
+    parser.process(app);
+
+    //Limit the processing threads, so they leave the cores of the acquisition alone
+    if(parser.isSet("execution") && !UTILSLIB::ExecutionConfig::configure(parser.value("execution")))
+        return 1;
+
+    if(parser.isSet(headlessOption)) {
+        if(parser.isSet(latencyOption))
+            SCMEASLIB::LatencyMonitor::setEnabled(true);
+
+        HeadlessRunner runner;
+
+        if(!runner.loadConfig(parser.value(headlessOption)))
+            return 1;
+
+        if(!runner.start(parser.value(durationOption).toInt(), parser.value(statsOption).toInt()))
+            return 1;
+
+        return app.exec();
+    }
+
     QPixmap pixmap(":/images/splashscreen.png");
     MainSplashScreen::SPtr splashscreen(new MainSplashScreen(pixmap));
     splashscreen->show();
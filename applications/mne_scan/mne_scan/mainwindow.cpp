@@ -42,11 +42,14 @@
 #include <scShared/Management/pluginscenemanager.h>
 #include <scShared/Management/displaymanager.h>
 
+#include <scMeas/latencymonitor.h>
+
 //GUI
 #include "mainwindow.h"
 #include "runwidget.h"
 #include "startupwidget.h"
 #include "plugingui.h"
+#include "metricswidget.h"
 
 
 //*************************************************************************************************************
@@ -125,6 +128,7 @@ MainWindow::MainWindow(QWidget *parent)
     createToolBars();
     createPluginDockWindow();
     createLogDockWindow();
+    createMetricsDockWindow();
 
 //    //ToDo Debug Startup
 //    writeToLog(tr("Test normal message, Max"), _LogKndMessage, _LogLvMax);
@@ -587,6 +591,25 @@ void MainWindow::createLogDockWindow()
 }
 
 
+//*************************************************************************************************************
+
+void MainWindow::createMetricsDockWindow()
+{
+    m_pDockWidget_Metrics = new QDockWidget(tr("Metrics"), this);
+
+    m_pMetricsWidget = new MetricsWidget(m_pDockWidget_Metrics);
+
+    m_pDockWidget_Metrics->setWidget(m_pMetricsWidget);
+
+    m_pDockWidget_Metrics->setAllowedAreas(Qt::BottomDockWidgetArea | Qt::RightDockWidgetArea);
+    addDockWidget(Qt::BottomDockWidgetArea, m_pDockWidget_Metrics);
+
+    m_pDockWidget_Metrics->hide();
+
+    m_pMenuView->addAction(m_pDockWidget_Metrics->toggleViewAction());
+}
+
+
 //*************************************************************************************************************
 //Plugin stuff
 void MainWindow::updatePluginWidget(SCSHAREDLIB::IPlugin::SPtr pPlugin)
@@ -690,6 +713,8 @@ void MainWindow::startMeasurement()
 {
     writeToLog(tr("Starting real-time measurement..."), _LogKndMessage, _LogLvMin);
 
+    SCMEASLIB::LatencyMonitor::reset();
+
     if(!m_pPluginSceneManager->startPlugins())
     {
         QMessageBox::information(0, tr("MNE Scan - Start"), QString(QObject::tr("Not able to start at least one sensor plugin!")), QMessageBox::Ok);
@@ -722,7 +747,14 @@ void MainWindow::stopMeasurement()
 
     updatePluginWidget(m_pPluginGui->getCurrentPlugin());
 
+    //Dump the pipeline latencies gathered during the measurement
+    if(SCMEASLIB::LatencyMonitor::isEnabled()) {
+        QStringList slReport = SCMEASLIB::LatencyMonitor::report();
+        for(int i = 0; i < slReport.size(); ++i)
+            qDebug() << qPrintable(slReport[i]);
 
+        writeToLog(QString("<pre>%1</pre>").arg(slReport.join("\n").toHtmlEscaped()), _LogKndMessage, _LogLvNormal);
+    }
 
 //    PluginManager::stopPlugins();
 
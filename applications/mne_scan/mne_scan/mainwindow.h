@@ -105,6 +105,7 @@ class StartUpWidget;
 class PluginGui;
 
 class RunWidget;
+class MetricsWidget;
 class PluginDockWidget;
 
 
@@ -247,6 +248,7 @@ private:
 
     void createPluginDockWindow();                          /**< Creates plugin dock widget.*/
     void createLogDockWindow();                             /**< Creates log dock widget.*/
+    void createMetricsDockWindow();                         /**< Creates metrics dock widget.*/
 
     //Plugin Management
     QDockWidget*                        m_pPluginGuiDockWidget;         /**< Dock widget which holds the plugin gui. */
@@ -258,6 +260,10 @@ private:
     QDockWidget*                        m_pDockWidget_Log;              /**< Holds the dock widget containing the log.*/
     QTextBrowser*                       m_pTextBrowser_Log;             /**< Holds the text browser for the log.*/
 
+    //Metrics
+    QDockWidget*                        m_pDockWidget_Metrics;          /**< Holds the dock widget containing the runtime metrics.*/
+    MetricsWidget*                      m_pMetricsWidget;               /**< Holds the table of runtime metrics.*/
+
     LogLevel                            m_eLogLevelCurrent;             /**< Holds the current log level.*/
 
     QSharedPointer<QWidget>             m_pAboutWindow;                 /**< Holds the widget containing the about information.*/
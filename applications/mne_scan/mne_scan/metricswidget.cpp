@@ -0,0 +1,209 @@
+//=============================================================================================================
+/**
+* @file     metricswidget.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the MetricsWidget class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "metricswidget.h"
+
+#include <scMeas/latencymonitor.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QHeaderView>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimer>
+#include <QVBoxLayout>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define METRICS_WIDGET_REFRESH_MSEC     1000    /**< Refresh interval of the table. */
+#define METRICS_WIDGET_FILL_WARNING     0.8     /**< Fill level from which a gauge is highlighted. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNESCAN;
+using namespace SCSHAREDLIB;
+using namespace SCMEASLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MetricsWidget::MetricsWidget(QWidget *parent)
+: QWidget(parent)
+, m_iPreviousUs(0)
+{
+    m_pTableWidget = new QTableWidget(0, 6, this);
+    m_pTableWidget->setHorizontalHeaderLabels(QStringList() << tr("Metric") << tr("Value") << tr("Rate [1/s]") << tr("Mean") << tr("p99") << tr("Max"));
+    m_pTableWidget->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    m_pTableWidget->verticalHeader()->hide();
+    m_pTableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_pTableWidget->setSelectionMode(QAbstractItemView::NoSelection);
+
+    QPushButton* pButtonReset = new QPushButton(tr("Reset"), this);
+    connect(pButtonReset, &QPushButton::clicked, this, &MetricsWidget::onReset);
+
+    QVBoxLayout* pVBoxLayout = new QVBoxLayout;
+    pVBoxLayout->addWidget(m_pTableWidget);
+    pVBoxLayout->addWidget(pButtonReset, 0, Qt::AlignRight);
+    setLayout(pVBoxLayout);
+
+    m_pTimer = new QTimer(this);
+    m_pTimer->setInterval(METRICS_WIDGET_REFRESH_MSEC);
+    connect(m_pTimer, &QTimer::timeout, this, &MetricsWidget::refresh);
+}
+
+
+//*************************************************************************************************************
+
+MetricsWidget::~MetricsWidget()
+{
+}
+
+
+//*************************************************************************************************************
+
+void MetricsWidget::refresh()
+{
+    QMap<QString, Metric> mapMetrics = MetricsRegistry::metrics();
+    qint64 iNowUs = LatencyMonitor::now();
+    double dElapsed = m_iPreviousUs > 0 ? (iNowUs - m_iPreviousUs) / 1.0e6 : 0.0;
+
+    QMap<QString, Metric>::const_iterator it;
+    for(it = mapMetrics.constBegin(); it != mapMetrics.constEnd(); ++it) {
+        const Metric& metric = it.value();
+
+        if(!m_mapRows.contains(it.key())) {
+            int iRow = m_pTableWidget->rowCount();
+            m_pTableWidget->insertRow(iRow);
+            m_pTableWidget->setItem(iRow, 0, new QTableWidgetItem(it.key()));
+            for(int iCol = 1; iCol < m_pTableWidget->columnCount(); ++iCol) {
+                QTableWidgetItem* pItem = new QTableWidgetItem;
+                pItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                m_pTableWidget->setItem(iRow, iCol, pItem);
+            }
+            m_mapRows.insert(it.key(), iRow);
+        }
+
+        int iRow = m_mapRows.value(it.key());
+        QStringList slColumns;
+        bool bWarning = false;
+
+        switch(metric.type) {
+            case Metric::Counter: {
+                double dRate = 0.0;
+                if(dElapsed > 0.0 && m_mapPrevious.contains(it.key()))
+                    dRate = (metric.count - m_mapPrevious.value(it.key()).count) / dElapsed;
+                slColumns << QString::number(metric.count) << QString::number(dRate, 'f', 1) << QString() << QString() << QString();
+                bWarning = it.key().contains("dropped") && dRate > 0.0;
+                break;
+            }
+            case Metric::Gauge:
+                slColumns << QString::number(metric.value, 'g', 3) << QString() << QString() << QString() << QString::number(metric.maxValue, 'g', 3);
+                bWarning = it.key().contains("fill level") && metric.value >= METRICS_WIDGET_FILL_WARNING;
+                break;
+            case Metric::Histogram:
+                slColumns << QString::number(metric.histogram.count) << QString()
+                          << QString("%1 us").arg(metric.histogram.count > 0 ? metric.histogram.sum / metric.histogram.count : 0)
+                          << QString("%1 us").arg(metric.histogram.percentile(0.99))
+                          << QString("%1 us").arg(metric.histogram.max);
+                break;
+        }
+
+        for(int i = 0; i < slColumns.size(); ++i) {
+            QTableWidgetItem* pItem = m_pTableWidget->item(iRow, i + 1);
+            pItem->setText(slColumns[i]);
+            pItem->setBackground(bWarning ? QBrush(QColor(255, 160, 160)) : QBrush());
+        }
+    }
+
+    m_mapPrevious = mapMetrics;
+    m_iPreviousUs = iNowUs;
+}
+
+
+//*************************************************************************************************************
+
+void MetricsWidget::showEvent(QShowEvent* event)
+{
+    QWidget::showEvent(event);
+
+    refresh();
+    m_pTimer->start();
+}
+
+
+//*************************************************************************************************************
+
+void MetricsWidget::hideEvent(QHideEvent* event)
+{
+    m_pTimer->stop();
+
+    QWidget::hideEvent(event);
+}
+
+
+//*************************************************************************************************************
+
+void MetricsWidget::onReset()
+{
+    MetricsRegistry::reset();
+
+    m_pTableWidget->setRowCount(0);
+    m_mapRows.clear();
+    m_mapPrevious.clear();
+    m_iPreviousUs = 0;
+
+    refresh();
+}
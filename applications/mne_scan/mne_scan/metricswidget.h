@@ -0,0 +1,136 @@
+//=============================================================================================================
+/**
+* @file     metricswidget.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the MetricsWidget class.
+*
+*/
+
+#ifndef METRICSWIDGET_H
+#define METRICSWIDGET_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <scShared/Management/metricsregistry.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QWidget>
+#include <QMap>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class QTableWidget;
+class QTimer;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNESCAN
+//=============================================================================================================
+
+namespace MNESCAN
+{
+
+//=============================================================================================================
+/**
+* DECLARE CLASS MetricsWidget
+*
+* @brief The MetricsWidget class shows the runtime metrics of the MetricsRegistry. Counters are shown with their
+* rate since the last refresh, gauges with their maximum and histograms with mean, 99th percentile and maximum.
+* Fill levels above METRICS_WIDGET_FILL_WARNING and growing drop counters are highlighted, so a backlog is
+* noticed before data is lost.
+*/
+class MetricsWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a MetricsWidget which is a child of parent.
+    *
+    * @param [in] parent pointer to parent widget.
+    */
+    MetricsWidget(QWidget* parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destroys the MetricsWidget.
+    */
+    virtual ~MetricsWidget();
+
+    //=========================================================================================================
+    /**
+    * Reads the metrics and updates the table.
+    */
+    void refresh();
+
+protected:
+    //=========================================================================================================
+    /**
+    * Refreshes right away and starts the refresh timer.
+    */
+    virtual void showEvent(QShowEvent* event);
+
+    //=========================================================================================================
+    /**
+    * Stops the refresh timer.
+    */
+    virtual void hideEvent(QHideEvent* event);
+
+private:
+    //=========================================================================================================
+    /**
+    * Clears the metrics of the registry and the table.
+    */
+    void onReset();
+
+    QTableWidget*                           m_pTableWidget;     /**< Holds the table of metrics. */
+    QTimer*                                 m_pTimer;           /**< Triggers the refresh. */
+    QMap<QString, int>                      m_mapRows;          /**< Table row of each metric. */
+    QMap<QString, SCSHAREDLIB::Metric>      m_mapPrevious;      /**< Metrics of the last refresh, to compute the rates. */
+    qint64                                  m_iPreviousUs;      /**< Time of the last refresh. */
+};
+
+} // NAMESPACE
+
+#endif // METRICSWIDGET_H
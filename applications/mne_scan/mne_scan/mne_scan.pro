@@ -98,7 +98,9 @@ SOURCES += \
     pluginitem.cpp \
     plugingui.cpp \
     arrow.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    metricswidget.cpp \
+    headlessrunner.cpp
 
 HEADERS += \
     info.h \
@@ -109,7 +111,9 @@ HEADERS += \
     pluginitem.h \
     plugingui.h \
     arrow.h \
-    mainwindow.h
+    mainwindow.h \
+    metricswidget.h \
+    headlessrunner.h
 
 FORMS +=
 
@@ -206,6 +206,15 @@ void PluginGui::loadConfig(const QString& sPath, const QString& sFileName)
         return;
     }
 
+    //
+    // Instantiate the plugins of the scene first, their libraries are loaded concurrently
+    //
+    QStringList qListPluginNames;
+    QDomNodeList qListPluginNodes = docElem.elementsByTagName("Plugin");
+    for(int i = 0; i < qListPluginNodes.size(); ++i)
+        qListPluginNames.append(qListPluginNodes.at(i).toElement().attribute("name"));
+    m_pPluginManager->instantiatePlugins(qListPluginNames);
+
     QDomNode nodePluginTree = docElem.firstChild();
     while(!nodePluginTree.isNull()) {
         QDomElement elementPluginTree = nodePluginTree.toElement();
@@ -593,8 +602,8 @@ void PluginGui::createToolbars()
     //Sensors
     m_pSensorToolButton = new QToolButton;
     QMenu *menuSensors = new QMenu;
-    for(qint32 i = 0; i < m_pPluginManager->getSensorPlugins().size(); ++i)
-        createItemAction(m_pPluginManager->getSensorPlugins()[i]->getName(), menuSensors);
+    foreach(QString name, m_pPluginManager->getPluginNames(SCSHAREDLIB::IPlugin::_ISensor))
+        createItemAction(name, menuSensors);
 
     m_pSensorToolButton->setMenu(menuSensors);
     m_pSensorToolButton->setPopupMode(QToolButton::InstantPopup);
@@ -605,8 +614,8 @@ void PluginGui::createToolbars()
     //Algorithms
     m_pAlgorithmToolButton = new QToolButton;
     QMenu *menuAlgorithms = new QMenu;
-    for(qint32 i = 0; i < m_pPluginManager->getAlgorithmPlugins().size(); ++i)
-        createItemAction(m_pPluginManager->getAlgorithmPlugins()[i]->getName(), menuAlgorithms);
+    foreach(QString name, m_pPluginManager->getPluginNames(SCSHAREDLIB::IPlugin::_IAlgorithm))
+        createItemAction(name, menuAlgorithms);
 
     m_pAlgorithmToolButton->setMenu(menuAlgorithms);
     m_pAlgorithmToolButton->setPopupMode(QToolButton::InstantPopup);
@@ -617,8 +626,8 @@ void PluginGui::createToolbars()
     //IOs
     m_pIOToolButton = new QToolButton;
     QMenu *menuIo = new QMenu;
-    for(qint32 i = 0; i < m_pPluginManager->getIOPlugins().size(); ++i)
-        createItemAction(m_pPluginManager->getIOPlugins()[i]->getName(), menuIo);
+    foreach(QString name, m_pPluginManager->getPluginNames(SCSHAREDLIB::IPlugin::_IIO))
+        createItemAction(name, menuIo);
 
     m_pIOToolButton->setMenu(menuIo);
     m_pIOToolButton->setPopupMode(QToolButton::InstantPopup);
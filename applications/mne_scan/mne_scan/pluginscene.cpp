@@ -123,9 +123,9 @@ bool PluginScene::insertPlugin(QAction* pActionPluginItem, SCSHAREDLIB::IPlugin:
     {
         QString name = pActionPluginItem->text();
         qint32 idx = m_pPluginGui->m_pPluginManager->findByName(name);
-        SCSHAREDLIB::IPlugin* pPlugin = m_pPluginGui->m_pPluginManager->getPlugins()[idx];
+        SCSHAREDLIB::IPlugin* pPlugin = m_pPluginGui->m_pPluginManager->getPlugin(idx);
 
-        if(m_pPluginGui->m_pPluginSceneManager->addPlugin(pPlugin, pAddedPlugin))
+        if(pPlugin && m_pPluginGui->m_pPluginSceneManager->addPlugin(pPlugin, pAddedPlugin))
         {
             //If only single instance -> disable insert action
             if(!pPlugin->multiInstanceAllowed())
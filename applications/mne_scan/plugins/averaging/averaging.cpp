@@ -675,12 +675,13 @@ void Averaging::run()
             m_qMutex.lock();
             if(m_qVecEvokedData.size() > 0)
             {
-                FiffEvokedSet t_fiffEvokedSet = *m_qVecEvokedData[0].data();
+                //The set only holds the conditions which changed, they are merged into the output
+                const FiffEvokedSet& t_fiffEvokedSet = *m_qVecEvokedData[0].data();
 
 #ifdef DEBUG_AVERAGING
                 std::cout << "EVK:" << t_fiffEvoked.data.row(0) << std::endl;
 #endif
-                m_pAveragingOutput->data()->setValue(t_fiffEvokedSet, m_pFiffInfo);
+                m_pAveragingOutput->data()->updateValue(t_fiffEvokedSet, m_pFiffInfo);
 
                 m_qVecEvokedData.pop_front();
 
@@ -56,6 +56,7 @@
 #include <realtime/rtClient/rtcmdclient.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 #include <scDisp/hpiwidget.h>
+#include <scShared/Management/metricsregistry.h>
 
 
 //*************************************************************************************************************
@@ -73,6 +74,7 @@
 #include <QDateTime>
 
 #include <QQuaternion>
+#include <QtEndian>
 
 
 //*************************************************************************************************************
@@ -111,7 +113,6 @@ BabyMEG::BabyMEG()
 , m_sFiffCompensators(QCoreApplication::applicationDirPath() + "/mne_scan_plugins/resources/babymeg/compensator.fif")
 , m_sBadChannels(QCoreApplication::applicationDirPath() + "/mne_scan_plugins/resources/babymeg/both.bad")
 , m_iRecordingMSeconds(5*60*1000)
-, m_iSplitCount(0)
 , m_bDoContinousHPI(false)
 {
     m_pActionSetupProject = new QAction(QIcon(":/images/database.png"), tr("Setup Project"),this);
@@ -223,7 +224,7 @@ void BabyMEG::init()
     connect(pInfo.data(), &BabyMEGInfo::fiffInfoAvailable,
             this, &BabyMEG::setFiffInfo);
     connect(pInfo.data(), &BabyMEGInfo::SendDataPackage,
-            this, &BabyMEG::setFiffData);
+            this, &BabyMEG::setFiffData, Qt::DirectConnection);
     connect(pInfo.data(), &BabyMEGInfo::SendCMDPackage,
             this, &BabyMEG::setCMDData);
     connect(pInfo.data(), &BabyMEGInfo::GainInfoUpdate,
@@ -344,13 +345,14 @@ QWidget* BabyMEG::setupWidget()
 void BabyMEG::run()
 {
     MatrixXf matValue;
-    qint32 size = 0;
 
     while(m_bIsRunning) {
         if(m_pRawMatrixBuffer) {
             //pop matrix
             matValue = m_pRawMatrixBuffer->pop();
 
+            SCSHAREDLIB::MetricsRegistry::setGauge(QString("%1/buffer: fill level").arg(getName()), m_pRawMatrixBuffer->fillLevel());
+
             //Update HPI data (for single and continous HPI fitting)
             updateHPI(matValue);
 
@@ -364,18 +366,11 @@ void BabyMEG::run()
 
             //Write raw data to fif file
             if(m_bWriteToFile) {
-                size += matValue.rows()*matValue.cols() * 4;
-
-                if(size > MAX_DATA_LEN) {
-                    size = 0;
-                    this->splitRecordingFile();
-                }
-
                 m_mutex.lock();
                 m_pOutfid->write_raw_buffer(matValue.cast<double>());
                 m_mutex.unlock();
-            } else {
-                size = 0;
+
+                SCSHAREDLIB::MetricsRegistry::addCounter(QString("%1/recording: samples").arg(getName()), matValue.cols());
             }
 
             if(m_pRTMSABabyMEG) {
@@ -507,27 +502,36 @@ void BabyMEG::setFiffData(QByteArray DATA)
     //get the first byte -- the data format
     int dformat = DATA.left(1).toInt();
 
-    DATA.remove(0,1);
     qint32 rows = m_pFiffInfo->nchan;
-    qint32 cols = (DATA.size()/dformat)/rows;
+    if(dformat <= 0 || rows <= 0) {
+        qDebug() << "[BabyMEG] Data package of format" << dformat << "with" << rows << "channels can not be read";
+        return;
+    }
 
-    qDebug() << "[BabyMEG] Matrix " << rows << "x" << cols << " [Data bytes:" << dformat << "]";
+    qint32 cols = ((DATA.size() - 1)/dformat)/rows;
 
-    MatrixXf rawData(Map<MatrixXf>( (float*)DATA.data(),rows, cols ));
+    qDebug() << "[BabyMEG] Matrix " << rows << "x" << cols << " [Data bytes:" << dformat << "]";
 
-    for(qint32 i = 0; i < rows*cols; ++i)
-        IOUtils::swap_floatp(rawData.data()+i);
+    // swap the big endian samples straight from the receive buffer into the preallocated block
+    if(m_matRawData.rows() != rows || m_matRawData.cols() != cols)
+        m_matRawData.resize(rows, cols);
 
+    const uchar* pSamples = reinterpret_cast<const uchar*>(DATA.constData()) + 1;
+    float* pRawData = m_matRawData.data();
+    for(qint32 i = 0; i < rows*cols; ++i) {
+        quint32 sample = qFromBigEndian<quint32>(pSamples + i*sizeof(float));
+        memcpy(pRawData + i, &sample, sizeof(float));
+    }
 
     if(m_bIsRunning)
     {
         if(!m_pRawMatrixBuffer)
             m_pRawMatrixBuffer = CircularMatrixBuffer<float>::SPtr(new CircularMatrixBuffer<float>(40, rows, cols));
 
-        m_pRawMatrixBuffer->push(&rawData);
+        m_pRawMatrixBuffer->push(&m_matRawData);
     }
 
-    emit DataToSquidCtrlGUI(rawData);
+    emit DataToSquidCtrlGUI(m_matRawData);
 }
 
 
@@ -745,37 +749,6 @@ void BabyMEG::showSqdCtrlDialog()
 }
 
 
-//*************************************************************************************************************
-
-void BabyMEG::splitRecordingFile()
-{
-    //qDebug() << "Split recording file";
-    ++m_iSplitCount;
-    QString nextFileName = m_sRecordFile.remove("_raw.fif");
-    nextFileName += QString("-%1_raw.fif").arg(m_iSplitCount);
-
-    //Write the link to the next file
-    qint32 data;
-    m_pOutfid->start_block(FIFFB_REF);
-    data = FIFFV_ROLE_NEXT_FILE;
-    m_pOutfid->write_int(FIFF_REF_ROLE,&data);
-    m_pOutfid->write_string(FIFF_REF_FILE_NAME, nextFileName);
-    m_pOutfid->write_id(FIFF_REF_FILE_ID);//ToDo meas_id
-    data = m_iSplitCount - 1;
-    m_pOutfid->write_int(FIFF_REF_FILE_NUM, &data);
-    m_pOutfid->end_block(FIFFB_REF);
-
-    //finish file
-    m_pOutfid->finish_writing_raw();
-
-    //start next file
-    m_qFileOut.setFileName(nextFileName);
-    m_pOutfid = FiffStream::start_writing_raw(m_qFileOut, *m_pFiffInfo, m_cals, defaultMatrixXi, false);
-    fiff_int_t first = 0;
-    m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
-}
-
-
 //*************************************************************************************************************
 
 void BabyMEG::toggleRecordingFile()
@@ -787,7 +760,6 @@ void BabyMEG::toggleRecordingFile()
         m_mutex.unlock();
 
         m_bWriteToFile = false;
-        m_iSplitCount = 0;
 
         //Stop record timer
         m_pRecordTimer->stop();
@@ -796,8 +768,6 @@ void BabyMEG::toggleRecordingFile()
 
         m_pActionRecordFile->setIcon(QIcon(":/images/record.png"));
     } else {
-        m_iSplitCount = 0;
-
         if(!m_pFiffInfo) {
             QMessageBox msgBox;
             msgBox.setText("FiffInfo missing!");
@@ -829,6 +799,10 @@ void BabyMEG::toggleRecordingFile()
         m_pOutfid = FiffStream::start_writing_raw(m_qFileOut, *m_pFiffInfo, m_cals, defaultMatrixXi, false);
         fiff_int_t first = 0;
         m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+        //Scaling and disk writes are done on the writer thread of the stream, run() only queues the buffers
+        m_pOutfid->start_async_writing();
+        //Once a file reaches MAX_DATA_LEN the recording continues in <name>_raw-1.fif, ..., which is prepared in the background
+        m_pOutfid->start_split_writing(MAX_DATA_LEN, first);
         m_mutex.unlock();
 
         m_bWriteToFile = true;
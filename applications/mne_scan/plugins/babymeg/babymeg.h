@@ -241,9 +241,10 @@ protected:
 
     //=========================================================================================================
     /**
-    * Sets the Fiff Info data.
+    * Sets the Fiff Info data. The big endian samples are converted directly into a preallocated block which is
+    * pushed to the raw matrix buffer.
     *
-    * @param[in] DATA    the Fiff Info data.
+    * @param[in] DATA    the Fiff Info data. It refers to the receive buffer of the client and is only valid during the call.
     */
     void setFiffData(QByteArray DATA);
 
@@ -335,12 +336,6 @@ protected:
     */
     void showSqdCtrlDialog();
 
-    //=========================================================================================================
-    /**
-    * Determines current file. And starts a new one.
-    */
-    void splitRecordingFile();
-
     //=========================================================================================================
     /**
     * Starts or stops a file recording depending on the current recording state.
@@ -402,6 +397,7 @@ protected:
     SCSHAREDLIB::PluginOutputData<SCMEASLIB::NewRealTimeMultiSampleArray>::SPtr m_pRTMSABabyMEG;    /**< The NewRealTimeMultiSampleArray to provide the rt_server Channels.*/
 
     QSharedPointer<IOBUFFER::RawMatrixBuffer>                                   m_pRawMatrixBuffer; /**< Holds incoming raw data. */
+    Eigen::MatrixXf                                                             m_matRawData;       /**< Preallocated block the incoming data packages are converted to. */
 
     QSharedPointer<BabyMEGClient>           m_pMyClient;                    /**< TCP/IP communication between Qt and Labview. */
     QSharedPointer<BabyMEGClient>           m_pMyClientComm;                /**< TCP/IP communication between Qt and Labview - communication. */
@@ -421,7 +417,6 @@ protected:
 
     qint16                                  m_iBlinkStatus;                 /**< The blink status of the recording button.*/
     qint32                                  m_iBufferSize;                  /**< The raw data buffer size.*/
-    qint32                                  m_iSplitCount;                  /**< File split count */
     int                                     m_iRecordingMSeconds;           /**< Recording length in mseconds.*/
 
     bool                                    m_bWriteToFile;                 /**< Flag for for writing the received samples to a file. Defined by the user via the GUI.*/
@@ -60,6 +60,17 @@
 using namespace BABYMEGPLUGIN;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+    const int RECEIVE_BUFFER_SIZE = 1 << 24;    /**< Initial capacity of the receive buffer [bytes], holds several data packages of 400+ channels. */
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -96,6 +107,10 @@ BabyMEGClient::BabyMEGClient(int myPort, QObject *parent)
     numBlock = 0;
     DataACK = false;
 
+    buffer.resize(RECEIVE_BUFFER_SIZE);
+    m_iBufferStart = 0;
+    m_iBufferEnd = 0;
+
 }
 
 
@@ -221,7 +236,7 @@ void BabyMEGClient::ConnectToBabyMEG()
             qDebug()<< "Send the initial parameter request";
             if (tcpSocket->state()==QAbstractSocket::ConnectedState)
             {
-                buffer.clear();
+                clearBuffer();
 //                SendCommand("INFO");
                 SendCommand("DATA");
             }
@@ -313,17 +328,15 @@ void BabyMEGClient::SendCommandToBabyMEG()
 
 void BabyMEGClient::ReadToBuffer()
 {
-
-    QByteArray dat;
-
-    int numBytes = tcpSocket->bytesAvailable();
+    qint64 numBytes = tcpSocket->bytesAvailable();
 //    qDebug() << "1.byte available: " << numBytes;
     if (numBytes > 0){
-        dat = tcpSocket->read(numBytes); // read all pending data
-//        qDebug()<<"[dat Size]"<<dat.size();
-        if (!dat.isEmpty()){
-            buffer.append(dat); // and append it to your own buffer
-//            qDebug()<<"[ReadToBuffer: Buffer Size]"<<buffer.size();
+        // read all pending data straight behind the unparsed bytes
+        reserveBuffer(numBytes);
+        qint64 readBytes = tcpSocket->read(buffer.data() + m_iBufferEnd, numBytes);
+        if (readBytes > 0){
+            m_iBufferEnd += readBytes;
+//            qDebug()<<"[ReadToBuffer: Buffer Size]"<<bufferedBytes();
         }
         else
         {
@@ -333,124 +346,167 @@ void BabyMEGClient::ReadToBuffer()
 //    qDebug()<<"read buffer is done!";
 
     handleBuffer();
+
+    // start over at the front once everything is parsed, this avoids moving bytes for the next read
+    if (bufferedBytes() == 0)
+        clearBuffer();
+
     return;
 }
 
 
+//*************************************************************************************************************
+
+void BabyMEGClient::reserveBuffer(qint64 numBytes)
+{
+    if (m_iBufferEnd + numBytes <= buffer.size())
+        return;
+
+    int numPending = bufferedBytes();
+    if (numPending > 0 && m_iBufferStart > 0)
+        memmove(buffer.data(), buffer.constData() + m_iBufferStart, numPending);
+    m_iBufferStart = 0;
+    m_iBufferEnd = numPending;
+
+    if (numPending + numBytes > buffer.size())
+        buffer.resize(qMax<qint64>(2*buffer.size(), numPending + numBytes));
+}
+
+
+//*************************************************************************************************************
+
+void BabyMEGClient::clearBuffer()
+{
+    m_iBufferStart = 0;
+    m_iBufferEnd = 0;
+}
+
+
 //*************************************************************************************************************
 
 void BabyMEGClient::handleBuffer()
 {
-    if(buffer.size()>= 8){
-        QByteArray CMD = buffer.left(4);
-        QByteArray DLEN = buffer.mid(4,4);
-        int tmp = MGH_LM_Byte2Int(DLEN);
+    while(bufferedBytes() >= 8){
+        const char* pHeader = buffer.constData() + m_iBufferStart;
+        QByteArray CMD = QByteArray::fromRawData(pHeader, 4);
+        int tmp = qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(pHeader) + 4);
 //        qDebug() << "First 4 bytes + length" << CMD << "["<<CMD.toHex()<<"]";
 //        qDebug() << "Command[" << CMD <<"]";
 //        qDebug() << "Body Length[" << tmp << "]";
 
-        if (tmp <= (buffer.size() - 8))
-        {
-            buffer.remove(0,8);
-
-            int OPT = 0;
-
-            if (CMD == "INFO")
-                OPT = 1;
-            else if (CMD == "DATR")
-                OPT = 2;
-            else if (CMD == "COMD")
-                OPT = 3;
-            else if (CMD == "QUIT")
-                OPT = 4;
-            else if (CMD == "COMS")
-                OPT = 5;
-            else if (CMD == "QUIS")
-                OPT = 6;
-            else if (CMD == "INFG")
-                OPT = 7;
-
-            switch (OPT){
-            case 1:
-                // from buffer get data package
-                {
-                QByteArray PARA = buffer.left(tmp);
-                qDebug()<<"[INFO]"<<PARA;
-                //Parse parameters from PARA string
-                myBabyMEGInfo->MGH_LM_Parse_Para(PARA);
-                buffer.remove(0,tmp);
-                qDebug()<<"INFO has been received!!!!";
+        // wait for the rest of the package
+        if (tmp < 0 || tmp > (bufferedBytes() - 8))
+            break;
+
+        m_iBufferStart += 8;
+
+        int OPT = 0;
+
+        if (CMD == "INFO")
+            OPT = 1;
+        else if (CMD == "DATR")
+            OPT = 2;
+        else if (CMD == "COMD")
+            OPT = 3;
+        else if (CMD == "QUIT")
+            OPT = 4;
+        else if (CMD == "COMS")
+            OPT = 5;
+        else if (CMD == "QUIS")
+            OPT = 6;
+        else if (CMD == "INFG")
+            OPT = 7;
+
+        const char* pBody = buffer.constData() + m_iBufferStart;
+
+        switch (OPT){
+        case 1:
+            // from buffer get data package
+            {
+            QByteArray PARA(pBody, tmp);
+            m_iBufferStart += tmp;
+            qDebug()<<"[INFO]"<<PARA;
+            //Parse parameters from PARA string
+            myBabyMEGInfo->MGH_LM_Parse_Para(PARA);
+            qDebug()<<"INFO has been received!!!!";
 //                qDebug()<<"ACQ Start";
 //                SendCommand("DATA");
-                }
-                break;
-            case 2:
-                // read data package from buffer
-                // Ask for the next data block
+            }
+            break;
+        case 2:
+            // read data package from buffer
+            // Ask for the next data block
 
-                SendCommand("DATA");
-                DispatchDataPackage(tmp);
+            SendCommand("DATA");
 
-                break;
-            case 3:
-                {
-                QByteArray RESP = buffer.left(tmp);
-                qDebug()<< "5.Readbytes:"<<RESP.size();
-                qDebug() << RESP;
-                }
-                buffer.remove(0,tmp);
+            // a reconnect while sending drops the received bytes
+            if (tmp > bufferedBytes())
+                return;
 
-                break;
-            case 4:  //quit
-                qDebug()<<"Quit";
-
-                SendCommand("QREL");
-                tcpSocket->disconnectFromHost();
-                if(tcpSocket->state() != QAbstractSocket::UnconnectedState)
-                            tcpSocket->waitForDisconnected();
-                m_bSocketIsConnected = false;
-                qDebug()<< "Disconnect Server";
-                qDebug()<< "Client is End!";
-                qDebug()<< "You can close this application or restart to connect Server.";
+            DispatchDataPackage(tmp);
 
-                break;
-            case 5://command short connection
-                {
-                QByteArray RESP = buffer.left(tmp);
-                qDebug()<< "5.Readbytes:"<<RESP.size();
-                qDebug() << RESP;
-                myBabyMEGInfo->MGH_LM_Send_CMDPackage(RESP);
-                }
-                buffer.remove(0,tmp);
-                SendCommand("QUIT");
-                break;
-            case 6:  //quit
-                qDebug()<<"Quit";
-
-                SendCommand("QREL");
-                tcpSocket->disconnectFromHost();
-                if(tcpSocket->state() != QAbstractSocket::UnconnectedState)
-                            tcpSocket->waitForDisconnected();
-                m_bSocketIsConnected = false;
-                qDebug()<< "Disconnect Server";
-                break;
-            case 7: //INFG
-                {
-                QByteArray PARA = buffer.left(tmp);
-                qDebug()<<"[INFG]"<<PARA;
-                //Parse parameters from PARA string
-                myBabyMEGInfo->MGH_LM_Parse_Para_Infg(PARA);
-                buffer.remove(0,tmp);
-                qDebug()<<"INFG has been received!!!!";
-                }
-                break;
+            break;
+        case 3:
+            {
+            QByteArray RESP(pBody, tmp);
+            m_iBufferStart += tmp;
+            qDebug()<< "5.Readbytes:"<<RESP.size();
+            qDebug() << RESP;
+            }
 
-            default:
-                qDebug()<< "Unknow Type";
-                break;
+            break;
+        case 4:  //quit
+            qDebug()<<"Quit";
+            m_iBufferStart += tmp;
+
+            SendCommand("QREL");
+            tcpSocket->disconnectFromHost();
+            if(tcpSocket->state() != QAbstractSocket::UnconnectedState)
+                        tcpSocket->waitForDisconnected();
+            m_bSocketIsConnected = false;
+            qDebug()<< "Disconnect Server";
+            qDebug()<< "Client is End!";
+            qDebug()<< "You can close this application or restart to connect Server.";
+
+            break;
+        case 5://command short connection
+            {
+            QByteArray RESP(pBody, tmp);
+            m_iBufferStart += tmp;
+            qDebug()<< "5.Readbytes:"<<RESP.size();
+            qDebug() << RESP;
+            myBabyMEGInfo->MGH_LM_Send_CMDPackage(RESP);
             }
+            SendCommand("QUIT");
+            break;
+        case 6:  //quit
+            qDebug()<<"Quit";
+            m_iBufferStart += tmp;
+
+            SendCommand("QREL");
+            tcpSocket->disconnectFromHost();
+            if(tcpSocket->state() != QAbstractSocket::UnconnectedState)
+                        tcpSocket->waitForDisconnected();
+            m_bSocketIsConnected = false;
+            qDebug()<< "Disconnect Server";
+            break;
+        case 7: //INFG
+            {
+            QByteArray PARA(pBody, tmp);
+            m_iBufferStart += tmp;
+            qDebug()<<"[INFG]"<<PARA;
+            //Parse parameters from PARA string
+            myBabyMEGInfo->MGH_LM_Parse_Para_Infg(PARA);
+            qDebug()<<"INFG has been received!!!!";
+            }
+            break;
+
+        default:
+            qDebug()<< "Unknow Type";
+            m_iBufferStart += tmp;
+            break;
         }
-    }// buffer is not empty and larger than 8 bytes
+    }// buffer holds a complete package
 
 }
 
@@ -460,16 +516,16 @@ void BabyMEGClient::handleBuffer()
 void BabyMEGClient::DispatchDataPackage(int tmp)
 {
 
-//    qDebug()<<"Acq data from buffer  [buffer size() =" << buffer.size()<<"]";
-    QByteArray DATA = buffer.left(tmp);
+//    qDebug()<<"Acq data from buffer  [buffer size() =" << bufferedBytes()<<"]";
+    // the package is handed over in place, the plugin converts it before the buffer is touched again
+    QByteArray DATA = QByteArray::fromRawData(buffer.constData() + m_iBufferStart, tmp);
     qDebug()<< "5.Readbytes:"<<DATA.size();
     myBabyMEGInfo->MGH_LM_Send_DataPackage(DATA);
 //    myBabyMEGInfo->EnQueue(DATA);
-    buffer.remove(0,tmp);
-//    qDebug()<<"Rest buffer  [buffer size() =" << buffer.size()<<"]";
+    m_iBufferStart += tmp;
+//    qDebug()<<"Rest buffer  [buffer size() =" << bufferedBytes()<<"]";
     numBlock ++;
     qDebug()<< "Next Block ..." << numBlock;
-//    DATA.clear();
 
     ReadNextBlock(tmp);
 }
@@ -479,29 +535,29 @@ void BabyMEGClient::DispatchDataPackage(int tmp)
 
 void BabyMEGClient::ReadNextBlock(int tmp)
 {
-    QByteArray CMD1;
-    QByteArray DLEN1;
-    QByteArray DATA1;
-    int tmp1;
-    while (buffer.size()>=(tmp+8))
+    Q_UNUSED(tmp);
+
+    while (bufferedBytes() >= 8)
     { // process the extra data block to reduce the load of data buffer
-        CMD1 = buffer.left(4);
+        const char* pHeader = buffer.constData() + m_iBufferStart;
+        QByteArray CMD1 = QByteArray::fromRawData(pHeader, 4);
         qDebug()<<"CMD"<< CMD1;
         if (CMD1 == "DATR")
         {
-            DLEN1 = buffer.mid(4,4);
-            tmp1 = MGH_LM_Byte2Int(DLEN1);
-            qDebug() << "[2]First 4 bytes + length" << CMD1 << "["<<CMD1.toHex()<<"]";
+            int tmp1 = qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(pHeader) + 4);
             qDebug() << "[2]Command[" << CMD1 <<"]";
             qDebug() << "[2]Body Length[" << tmp1 << "]";
 
-            buffer.remove(0,8);
-            DATA1 = buffer.left(tmp1);
+            // wait for the rest of the package
+            if (tmp1 < 0 || tmp1 > bufferedBytes() - 8)
+                break;
+
+            m_iBufferStart += 8;
+            QByteArray DATA1 = QByteArray::fromRawData(buffer.constData() + m_iBufferStart, tmp1);
             myBabyMEGInfo->MGH_LM_Send_DataPackage(DATA1);
 //            myBabyMEGInfo->EnQueue(DATA1);
-            buffer.remove(0,tmp1);
-            qDebug()<<"End of DataPackeage" << buffer.left(3);
-            qDebug()<<"[2]Rest buffer  [buffer size() =" << buffer.size()<<"]";
+            m_iBufferStart += tmp1;
+            qDebug()<<"[2]Rest buffer  [buffer size() =" << bufferedBytes()<<"]";
             numBlock ++;
             qDebug()<< "[2]Next Block ..." << numBlock;
         }
@@ -510,11 +566,8 @@ void BabyMEGClient::ReadNextBlock(int tmp)
             qDebug()<<"[CMD1]"<<CMD1.toHex();
             break;
         }
-        qDebug()<<"[ReadNextBlock:buffer size]"<<buffer.size();
+        qDebug()<<"[ReadNextBlock:buffer size]"<<bufferedBytes();
     }
-    DATA1.clear();
-    CMD1.clear();
-    DLEN1.clear();
 }
 
 
@@ -552,7 +605,7 @@ void BabyMEGClient::SendCommand(QString s)
             qDebug()<<"Not in Connected state";
             //re-connect to server
             ConnectToBabyMEG();
-            buffer.clear();
+            clearBuffer();
             SendCommand("DATA");
         }
 //    sleep(1);
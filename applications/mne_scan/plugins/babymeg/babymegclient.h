@@ -153,7 +153,7 @@ public:
 
     //=========================================================================================================
     /**
-    * Dispatch the data package
+    * Dispatch the data package which starts at the read position of the receive buffer
     *
     * @param[in] tmp -- block size
     */
@@ -161,7 +161,7 @@ public:
 
     //=========================================================================================================
     /**
-    * Read next data block
+    * Dispatch all further complete data blocks of the receive buffer
     *
     * @param[in] tmp -- block size
     */
@@ -177,12 +177,20 @@ public:
 
     //=========================================================================================================
     /**
-    * Handle the data buffer connecting to the TCP socket
+    * Handle the data buffer connecting to the TCP socket. Complete packages are parsed in place.
     *
     * @param[in] void
     */
     void handleBuffer();
 
+    //=========================================================================================================
+    /**
+    * Drop all received bytes
+    *
+    * @param[in] void
+    */
+    void clearBuffer();
+
     //=========================================================================================================
     /**
     * Connect to BabyMEG server
@@ -240,6 +248,25 @@ public:
     QByteArray                  buffer;
 
 private:
+    //=========================================================================================================
+    /**
+    * Makes room for appending bytes to the receive buffer. The unparsed bytes are moved to the front and the
+    * buffer only grows if they do not fit otherwise.
+    *
+    * @param[in] numBytes -- number of bytes to append
+    */
+    void reserveBuffer(qint64 numBytes);
+
+    //=========================================================================================================
+    /**
+    * Number of received bytes which are not parsed yet
+    *
+    * @param[in] void
+    */
+    inline int bufferedBytes() const;
+
+    int                         m_iBufferStart;         /**< Read position of the receive buffer. */
+    int                         m_iBufferEnd;           /**< Write position of the receive buffer. */
     bool                        m_bSocketIsConnected;
     QTcpSocket*                 tcpSocket;
 
@@ -261,6 +288,14 @@ inline bool BabyMEGClient::isConnected() const
     return m_bSocketIsConnected;
 }
 
+
+//*************************************************************************************************************
+
+inline int BabyMEGClient::bufferedBytes() const
+{
+    return m_iBufferEnd - m_iBufferStart;
+}
+
 } // NAMESPACE
 
 #endif // BABYMEGCLIENT_H
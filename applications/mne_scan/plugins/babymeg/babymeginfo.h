@@ -143,7 +143,8 @@ public:
     /**
     * Send data package
     *
-    * @param[in] DATA       QByteArray contains MEG data.
+    * @param[in] DATA       QByteArray contains MEG data. It refers to the receive buffer of the client, so receivers
+    *                       have to be connected directly and copy what they keep.
     */
     void MGH_LM_Send_DataPackage(QByteArray DATA);
     //=========================================================================================================
@@ -407,6 +407,17 @@ void BCI::updateSensor(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
                 m_outStreamDebug << m_filterOperator->m_dCoeffA(0,i) << endl;
 
             m_outStreamDebug << "---------------------------------------------------------------------" << endl;
+
+            // Preallocate the working matrices of the feature pipeline
+            rows = m_matSlidingWindowSensor.rows();
+            cols = m_matSlidingWindowSensor.cols();
+
+            m_fftFilterBatchSensor.setSpectrum(m_filterOperator->m_dFFTCoeffA, m_filterOperator->m_iFFTlength);
+            m_matWindowSensor.resize(rows, cols);
+            m_vecMeanSensor.resize(rows);
+            m_matPaddedSensor.resize(rows, cols + 2*m_filterOperator->m_dCoeffA.cols());
+            m_matFilteredSensor.resize(rows, cols);
+            m_matFeaturesSensor.setZero(rows, m_iNumberFeatures);
         }
 
         // Only process data when fiff info has been initialised in run() method
@@ -415,7 +426,7 @@ void BCI::updateSensor(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
             MatrixXd t_mat(pRTMSA->getNumChannels(), pRTMSA->getMultiArraySize());
 
             for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i)
-                t_mat.col(i) = pRTMSA->getMultiSampleArray()[i];
+                t_mat.col(i) = pRTMSA->getMultiSampleArray()[i].matrix();
 
             m_pBCIBuffer_Sensor->push(&t_mat);
         }
@@ -450,67 +461,36 @@ void BCI::updateSource(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
 //*************************************************************************************************************
 
-void BCI::applyMeanCorrectionConcurrently(QPair<int, RowVectorXd> &chdata)
+void BCI::filterSensorWindow()
 {
-    chdata.second = chdata.second.array() - chdata.second.mean(); // Row vector needs to be transformed to a array in order to subract a scalar
-}
-
+    int iTaps = m_filterOperator->m_dCoeffA.cols();
+    int iLength = m_matWindowSensor.cols();
 
-//*************************************************************************************************************
-
-void BCI::applyFilterOperatorConcurrently(QPair<int, RowVectorXd> &chdata)
-{
-    chdata.second = m_filterOperator->applyFFTFilter(chdata.second);
-}
-
-
-//*************************************************************************************************************
-
-QPair< int,QList<double> > BCI::applyFeatureCalcConcurrentlyOnSensorLevel(const QPair<int, RowVectorXd> &chdata)
-{
-    RowVectorXd data = chdata.second;
-    QList<double> features;
-
-    // TODO: Divide into subsignals
-    switch(m_iFeatureCalculationType)
+    if(m_filterOperator->isIIR() || m_fftFilterBatchSensor.isEmpty() || iLength < iTaps)
     {
-        case 0:
-            features << data.squaredNorm(); // Compute variance
-            break;
-        case 1:
-            features << std::abs(log10(data.squaredNorm())); // Compute log of variance
-            break;
-        default:
-            features << data.squaredNorm(); // Compute variance
-            break;
+        for(int i = 0; i < m_matWindowSensor.rows(); i++)
+            m_matFilteredSensor.row(i) = m_filterOperator->applyFFTFilter(m_matWindowSensor.row(i));
+        return;
     }
 
-    return QPair< int,QList<double> >(chdata.first, features);
-}
+    m_matPaddedSensor.leftCols(iTaps) = m_matWindowSensor.leftCols(iTaps).rowwise().reverse();
+    m_matPaddedSensor.middleCols(iTaps, iLength) = m_matWindowSensor;
+    m_matPaddedSensor.rightCols(iTaps) = m_matWindowSensor.rightCols(iTaps).rowwise().reverse();
 
-
-//*************************************************************************************************************
-
-double BCI::applyClassificationCalcConcurrentlyOnSensorLevel(QList<double> &featData)
-{
-   return classificationBoundaryValue(featData);
+    // Same output segment as FilterData::applyFFTFilter without overhead
+    if(!m_fftFilterBatchSensor.filter(m_matPaddedSensor, m_matFilteredSensor, 0, iTaps/2, iLength))
+        m_matFilteredSensor = m_matWindowSensor;
 }
 
 
 //*************************************************************************************************************
 
-double BCI::classificationBoundaryValue(const QList<double> &featData)
+double BCI::classificationBoundaryValue(const VectorXd &featData)
 {
     double return_val = 0;
 
-    if(featData.size() == m_vLoadedSensorBoundary[1].size())
-    {
-        VectorXd feat_temp(featData.size());
-        for(int i = 0; i<featData.size(); i++)
-            feat_temp(i) = featData.at(i);
-
-        return_val = m_vLoadedSensorBoundary[0](0) + m_vLoadedSensorBoundary[1].dot(feat_temp);
-    }
+    if(m_vLoadedSensorBoundary.size() > 1 && featData.size() == m_vLoadedSensorBoundary[1].size())
+        return_val = m_vLoadedSensorBoundary[0](0) + m_vLoadedSensorBoundary[1].dot(featData);
 
     return return_val;
 }
@@ -521,7 +501,7 @@ double BCI::classificationBoundaryValue(const QList<double> &featData)
 void BCI::clearFeatures()
 {
     m_qMutex.lock();
-        m_lFeaturesSensor.clear();
+        m_matFeaturesSensor.setZero();
     m_qMutex.unlock();
 }
 
@@ -538,23 +518,17 @@ void BCI::clearClassifications()
 
 //*************************************************************************************************************
 
-bool BCI::hasThresholdArtefact(const QList< QPair<int,RowVectorXd> > &data)
+bool BCI::hasThresholdArtefact(const MatrixXd &data)
 {
     // Perform simple threshold artefact reduction
     double max = 0;
     double min = 0;
 
-    if(m_bUseArtefactThresholdReduction)
+    if(m_bUseArtefactThresholdReduction && data.size() > 0)
     {
-        // find min max in current m_matSlidingWindowSensor/qlMatrixRows after mean was subtracted
-        for(int i = 0; i<data.size(); i++)
-        {
-            if(data.at(i).second.maxCoeff() > max)
-                max = data.at(i).second.maxCoeff();
-
-            if(data.at(i).second.minCoeff() < min)
-                min = data.at(i).second.minCoeff();
-        }
+        // find min max in current m_matSlidingWindowSensor after mean was subtracted
+        max = qMax(max, data.maxCoeff());
+        min = qMin(min, data.minCoeff());
     }
 
 //    cout<<"max: "<<max<<endl;
@@ -681,28 +655,23 @@ void BCI::BCIOnSensorLevel()
 //                    }
             }
 
-            // ----2---- Transform matrix into QList structure, so that QTConcurrent can handle it properly
+            // ----2---- Copy the window, the working matrices are preallocated and keep their size
             //cout<<"----2----"<<endl;
-            QList< QPair<int,RowVectorXd> > qlMatrixRows;
-            for(int i = 0; i< m_matSlidingWindowSensor.rows(); i++)
-                qlMatrixRows << QPair<int,RowVectorXd>(i, m_matSlidingWindowSensor.row(i));
+            m_matWindowSensor = m_matSlidingWindowSensor;
 
-            int iNumberOfFeatures = qlMatrixRows.size();
+            int iNumberOfFeatures = m_matWindowSensor.rows();
 
-            // ----3---- Subtract mean in m_matSlidingWindowSensor concurrently using map()
+            // ----3---- Subtract mean in place
             //cout<<"----3----"<<endl;
             if(m_bSubtractMean)
             {
-                QFuture<void> futureMean = QtConcurrent::map(qlMatrixRows,[this](QPair<int,RowVectorXd>& rowdata) {
-                    applyMeanCorrectionConcurrently(rowdata);
-                });
-
-                futureMean.waitForFinished();
+                m_vecMeanSensor = m_matWindowSensor.rowwise().mean();
+                m_matWindowSensor.colwise() -= m_vecMeanSensor;
             }
 
             // ----4---- Do simple threshold artefact reduction
             //cout<<"----4----"<<endl;
-            if(hasThresholdArtefact(qlMatrixRows) == false)
+            if(hasThresholdArtefact(m_matWindowSensor) == false)
             {
                 // Look for trigger flag
                 if(lookForTrigger(m_matStimChannelSensor) && !m_bTriggerActivated)
@@ -712,98 +681,67 @@ void BCI::BCIOnSensorLevel()
                     m_bTriggerActivated = true;
                 }
 
-                // ----5---- Filter data in m_matSlidingWindowSensor concurrently using map()
+                // ----5---- Filter all rows of the window at once
                 //cout<<"----5----"<<endl;
-                // TODO: work only on qlMatrixRows -> filteredRows doesnt need to be created -> more efficient
-                QList< QPair<int,RowVectorXd> > filteredRows = qlMatrixRows;
-
                 if(m_bUseFilter)
-                {
-                    QFuture<void> futureFilter = QtConcurrent::map(filteredRows,[this](QPair<int,RowVectorXd>& chdata) {
-                        applyFilterOperatorConcurrently(chdata);
-                    });
-
-                    futureFilter.waitForFinished();
-                }
-
-//                    // Write data before and after filtering to debug file
-//                    for(int i=0; i<qlMatrixRows.size(); i++)
-//                        m_outStreamDebug << "qlMatrixRows at row " << i << ": " << qlMatrixRows.at(i).second << "\n";
-
-//                    m_outStreamDebug<<endl;
-
-//                    for(int i=0; i<filteredRows.size(); i++)
-//                        m_outStreamDebug << "filteredRows at row " << i << ": " << filteredRows.at(i).second << "\n";
-
-//                    m_outStreamDebug << endl << "---------------------------------------------------------" << endl << endl;
+                    filterSensorWindow();
+                else
+                    m_matFilteredSensor = m_matWindowSensor;
 
 //                    // Write filtered data continously to file
-//                    for(int i = 0; i<filteredRows.at(0).second.size() ;i++)
-//                        m_outStreamDebug << filteredRows.at(0).second(i)<<endl;
+//                    for(int i = 0; i<m_matFilteredSensor.cols() ;i++)
+//                        m_outStreamDebug << m_matFilteredSensor(0,i)<<endl;
 
-                // ----6---- Calculate features concurrently using mapped()
+                // ----6---- Calculate the features of all rows at once
                 //cout<<"----6----"<<endl;
-                std::function< QPair<int,QList<double> > (QPair<int,RowVectorXd>&)> applyOpsFeatures = [this](QPair<int,RowVectorXd>& chdata) -> QPair< int,QList<double> > {
-                    return applyFeatureCalcConcurrentlyOnSensorLevel(chdata);
-                };
-
-                QFuture< QPair< int,QList<double> > > futureCalculatedFeatures = QtConcurrent::mapped(filteredRows.begin(), filteredRows.end(), applyOpsFeatures);
-
-                futureCalculatedFeatures.waitForFinished();
+                if(m_iNumberOfCalculatedFeatures >= m_matFeaturesSensor.cols() || m_matFeaturesSensor.rows() != iNumberOfFeatures)
+                    m_matFeaturesSensor.conservativeResize(iNumberOfFeatures, qMax(m_iNumberFeatures, m_iNumberOfCalculatedFeatures+1));
 
-                m_iNumberOfCalculatedFeatures++;
+                // TODO: Divide into subsignals
+                switch(m_iFeatureCalculationType)
+                {
+                    case 1:
+                        m_matFeaturesSensor.col(m_iNumberOfCalculatedFeatures) = m_matFilteredSensor.rowwise().squaredNorm().array().log10().abs().matrix(); // Compute log of variance
+                        break;
+                    default:
+                        m_matFeaturesSensor.col(m_iNumberOfCalculatedFeatures) = m_matFilteredSensor.rowwise().squaredNorm(); // Compute variance
+                        break;
+                }
 
-                // ----7---- Store features
+                // ----7---- Count stored features
                 //cout<<"----7----"<<endl;
-                m_lFeaturesSensor.append(futureCalculatedFeatures.results());
+                m_iNumberOfCalculatedFeatures++;
 
                 // ----8---- If enough features (windows) have been calculated (processed) -> classify all features and average results
                 //cout<<"----8----"<<endl;
-                if(m_iNumberOfCalculatedFeatures == m_iNumberFeatures)
+                if(m_iNumberOfCalculatedFeatures >= m_iNumberFeatures)
                 {
-                    // Transform m_lFeaturesSensor into an easier file structure -> create feature points
-                    QList< QList<double> > lFeaturesSensor_new;
+                    // Display features, one feature point per window
+                    if(m_bDisplayFeatures)
+                    {
+                        QList< QList<double> > lFeaturesSensor_new;
 
-                    for(int i = 0; i<m_lFeaturesSensor.size()-iNumberOfFeatures+1; i = i + iNumberOfFeatures) // iterate over QPair feature List
-                        for(int z = 0; z<m_lFeaturesSensor.at(0).second.size(); z++) // iterate over number of sub signals
+                        for(int i = 0; i<m_iNumberOfCalculatedFeatures; i++)
                         {
                             QList<double> temp;
                             for(int t = 0; t<iNumberOfFeatures; t++) // iterate over chosen features (electrodes)
-                                temp.append(m_lFeaturesSensor.at(i+t).second.at(z));
+                                temp.append(m_matFeaturesSensor(t,i));
                             lFeaturesSensor_new.append(temp);
                         }
 
-//                        //Check sizes
-//                        cout<<"lFeaturesSensor_new.size()"<<lFeaturesSensor_new.size()<<endl;
-//                        cout<<"lFeaturesSensor_new.at(0).size()"<<lFeaturesSensor_new.at(0).size()<<endl;
-//                        cout<<"m_lFeaturesSensor.size()"<<m_lFeaturesSensor.size()<<endl;
-
-                    // Display features
-                    if(m_bDisplayFeatures)
                         emit paintFeatures((MyQList)lFeaturesSensor_new, m_bTriggerActivated);
+                    }
 
                     // Reset trigger
                     m_bTriggerActivated = false;
 
-                    // ----9---- Classify features concurrently using mapped() ----------
+                    // ----9---- Average the features of all windows
                     //cout<<"----9----"<<endl;
+                    VectorXd variances = m_matFeaturesSensor.leftCols(m_iNumberOfCalculatedFeatures).rowwise().mean();
 
-                    std::function<double (QList<double>&)> applyOpsClassification = [this](QList<double>& featData){
-                        return applyClassificationCalcConcurrentlyOnSensorLevel(featData);
-                    };
-
-                    QFuture<double> futureClassificationResults = QtConcurrent::mapped(lFeaturesSensor_new.begin(), lFeaturesSensor_new.end(), applyOpsClassification);
-
-                    futureClassificationResults.waitForFinished();
-
-                    // ----10---- Generate final classification result -> average all classification results
+                    // ----10---- Generate final classification result -> the decision function is linear, so the average of the classification results of all windows is the classification result of the averaged features
                     //cout<<"----10----"<<endl;
-                    double dfinalResult = 0;
-
-                    for(int i = 0; i<futureClassificationResults.resultCount() ;i++)
-                        dfinalResult += futureClassificationResults.resultAt(i);
-
-                    dfinalResult = dfinalResult/futureClassificationResults.resultCount();
+                    double dfinalResult = classificationBoundaryValue(variances);
                     cout << "dfinalResult: " << dfinalResult << endl << endl;
 
                     // ----11---- Store final result
@@ -812,23 +750,14 @@ void BCI::BCIOnSensorLevel()
 
                     // ----12---- Send result to the output stream, i.e. which is connected to the triggerbox
                     //cout<<"----12----"<<endl;
-                    VectorXd variances(iNumberOfFeatures);
-                    variances.setZero();
-
-                    for(int i = 0; i<lFeaturesSensor_new.size(); i++)
-                        for(int t = 0; t<iNumberOfFeatures; t++)
-                            variances(t) = variances(t) + lFeaturesSensor_new.at(i).at(t);
-
-                    variances = variances/lFeaturesSensor_new.size();
-
                     m_pBCIOutputOne->data()->setValue(dfinalResult);
                     m_pBCIOutputTwo->data()->setValue(variances(0));
                     m_pBCIOutputThree->data()->setValue(variances(1));
 
-                    for(int i = 0; i<filteredRows.at(0).second.cols() ; i++)
+                    for(int i = 0; i<m_matFilteredSensor.cols() ; i++)
                     {
-                        m_pBCIOutputFour->data()->setValue(filteredRows.at(0).second(0,i));
-                        m_pBCIOutputFive->data()->setValue(filteredRows.at(1).second(0,i));
+                        m_pBCIOutputFour->data()->setValue(m_matFilteredSensor(0,i));
+                        m_pBCIOutputFive->data()->setValue(m_matFilteredSensor(1,i));
                     }
 
                     // Clear classifications
@@ -845,21 +774,15 @@ void BCI::BCIOnSensorLevel()
                 m_pBCIOutputTwo->data()->setValue(0);
                 m_pBCIOutputThree->data()->setValue(0);
 
-                QList< QPair<int,RowVectorXd> > filteredRows = qlMatrixRows;
-
                 if(m_bUseFilter)
-                {
-                    QFuture<void> futureFilter = QtConcurrent::map(filteredRows,[this](QPair<int,RowVectorXd>& chdata) {
-                        applyFilterOperatorConcurrently(chdata);
-                    });
-
-                    futureFilter.waitForFinished();
-                }
+                    filterSensorWindow();
+                else
+                    m_matFilteredSensor = m_matWindowSensor;
 
-                for(int i = 0; i<filteredRows.at(0).second.cols() ; i++)
+                for(int i = 0; i<m_matFilteredSensor.cols() ; i++)
                 {
-                    m_pBCIOutputFour->data()->setValue(filteredRows.at(0).second(0,i));
-                    m_pBCIOutputFive->data()->setValue(filteredRows.at(1).second(0,i));
+                    m_pBCIOutputFour->data()->setValue(m_matFilteredSensor(0,i));
+                    m_pBCIOutputFive->data()->setValue(m_matFilteredSensor(1,i));
                 }
             }
 
@@ -52,6 +52,7 @@
 #include <scMeas/realtimesourceestimate.h>
 
 #include <utils/filterTools/filterdata.h>
+#include <utils/filterTools/fftfilterbatch.h>
 
 #include <fstream>
 
@@ -166,46 +167,19 @@ protected:
 
     //=========================================================================================================
     /**
-    * Calculates the filtered signal of chdata
-    *
-    * @param [in] rowdata QPair with number of the row and the data samples as a RowVectorXd.
-    */
-    void applyMeanCorrectionConcurrently(QPair<int,RowVectorXd>& rowdata);
-
-    //=========================================================================================================
-    /**
-    * Calculates the filtered signal of chdata
-    *
-    * @param [in] chdata QPair with number of the row and the data samples as a RowVectorXd.
-    */
-    void applyFilterOperatorConcurrently(QPair<int,RowVectorXd> &chdata);
-
-    //=========================================================================================================
-    /**
-    * Calculates the features on sensor level
-    *
-    * @param [in] chdata QPair with number of the row and the data samples as a RowVectorXd.
-    * @param [out] QPair<int,QList<double>> calculated features.
-    */
-    QPair< int,QList<double> > applyFeatureCalcConcurrentlyOnSensorLevel(const QPair<int,RowVectorXd> &chdata);
-
-    //=========================================================================================================
-    /**
-    * Classifies the features on sensor level
-    *
-    * @param [in] featData QList<double> holds the feature data point (i.e. 2 electrodes make this parameter have size of 2).
-    * @param [out] double calculated classification value.
+    * Filters all rows of m_matWindowSensor into m_matFilteredSensor in one batch. The edges are mirrored the same
+    * way as FilterData::applyFFTFilter does for a single row.
     */
-    double applyClassificationCalcConcurrentlyOnSensorLevel(QList<double> &featData);
+    void filterSensorWindow();
 
     //=========================================================================================================
     /**
     * Calculates the function value of the decision function (boundary) for a given feature point
     *
-    * @param [in] featData QList<double> holds the feature data point (i.e. 2 electrodes make this parameter have size of 2).
+    * @param [in] featData holds the feature data point (i.e. 2 electrodes make this parameter have size of 2).
     * @param [out] double function value.
     */
-    double classificationBoundaryValue(const QList<double> &featData);
+    double classificationBoundaryValue(const VectorXd &featData);
 
     //=========================================================================================================
     /**
@@ -226,7 +200,7 @@ protected:
     * Check for artefact in data
     *
     */
-    bool hasThresholdArtefact(const QList<QPair<int, RowVectorXd> > &data);
+    bool hasThresholdArtefact(const MatrixXd &data);
 
     //=========================================================================================================
     /**
@@ -274,6 +248,7 @@ private:
     IOBUFFER::CircularMatrixBuffer<double>::SPtr                  m_pBCIBuffer_Source;    /**< Holds incoming source level data.*/
 
     QSharedPointer<UTILSLIB::FilterData>                          m_filterOperator;       /**< Holds filter with specified properties by the user.*/
+    UTILSLIB::FFTFilterBatch                                      m_fftFilterBatchSensor; /**< Applies m_filterOperator to all rows of the sensor level window at once.*/
 
     QSharedPointer<BCIFeatureWindow>                    m_BCIFeatureWindow;     /**< Holds pointer to BCIFeatureWindow for visualization purposes.*/
 
@@ -296,7 +271,11 @@ private:
     QVector< VectorXd >     m_vLoadedSensorBoundary;            /**< Sensor level: Loaded decision boundary on sensor level. */
     QStringList             m_slChosenFeatureSensor;            /**< Sensor level: Features used to calculate data points in feature space on sensor level. */
     QMap<QString, int>      m_mapElectrodePinningScheme;        /**< Sensor level: Loaded pinning scheme of the Duke 128 EEG cap. */
-    QList< QPair< int,QList<double> > >  m_lFeaturesSensor;     /**< Sensor level: Features calculated on sensor level. */
+    MatrixXd                m_matWindowSensor;                  /**< Sensor level: Mean corrected copy of m_matSlidingWindowSensor. */
+    VectorXd                m_vecMeanSensor;                    /**< Sensor level: Mean of each row of m_matSlidingWindowSensor. */
+    MatrixXd                m_matPaddedSensor;                  /**< Sensor level: Mirrored edges and m_matWindowSensor, the input of the filter. */
+    MatrixXd                m_matFilteredSensor;                /**< Sensor level: Filtered m_matWindowSensor. */
+    MatrixXd                m_matFeaturesSensor;                /**< Sensor level: Features calculated on sensor level, one column per window. */
     QList<double>           m_lClassResultsSensor;              /**< Sensor level: Classification results on sensor level. */
     MatrixXd                m_matStimChannelSensor;             /**< Sensor level: Stim channel. */
     MatrixXd                m_matTimeBetweenWindowsStimSensor;  /**< Sensor level: Stim channel. */
@@ -42,6 +42,8 @@
 #include "brainamp.h"
 #include "brainampproducer.h"
 
+#include <scShared/Management/metricsregistry.h>
+
 #include "FormFiles/brainampsetupwidget.h"
 #include "FormFiles/brainampsetupprojectwidget.h"
 
@@ -84,7 +86,6 @@ using namespace Eigen;
 BrainAMP::BrainAMP()
 : m_pRMTSA_BrainAMP(0)
 , m_qStringResourcePath(qApp->applicationDirPath()+"/mne_scan_plugins/resources/brainamp/")
-, m_pRawMatrixBuffer_In(0)
 , m_pBrainAMPProducer(new BrainAMPProducer(this))
 , m_dLPAShift(0.01)
 , m_dRPAShift(0.01)
@@ -321,10 +322,7 @@ bool BrainAMP::start()
     m_pRMTSA_BrainAMP->data()->setMultiArraySize(1);
     m_pRMTSA_BrainAMP->data()->setSamplingRate(m_iSamplingFreq);
 
-    //Buffer
-    m_pRawMatrixBuffer_In = QSharedPointer<RawMatrixBuffer>(new RawMatrixBuffer(8, m_pFiffInfo->nchan, m_iSamplesPerBlock));
-    m_qListReceivedSamples.clear();
-
+    //The producer holds the ring buffer of the incoming raw data
     m_pBrainAMPProducer->start(m_iSamplesPerBlock,
                        m_iSamplingFreq,
                        m_sOutputFilePath,
@@ -354,29 +352,15 @@ bool BrainAMP::stop()
     //Wait until this thread (BrainAMP) is stopped
     m_bIsRunning = false;
 
-    //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the pop function (acquire statement)
-    m_pRawMatrixBuffer_In->releaseFromPop();
-
-    m_pRawMatrixBuffer_In->clear();
+    //In case the ring blocks the thread -> Release it and let it exit from the pop function
+    m_pBrainAMPProducer->releaseFromPop();
 
     m_pRMTSA_BrainAMP->data()->clear();
 
-    m_qListReceivedSamples.clear();
-
     return true;
 }
 
 
-//*************************************************************************************************************
-
-void BrainAMP::setSampleData(MatrixXd &matRawBuffer)
-{
-    m_mutex.lock();
-    m_qListReceivedSamples.append(matRawBuffer);
-    m_mutex.unlock();
-}
-
-
 //*************************************************************************************************************
 
 IPlugin::PluginType BrainAMP::getType() const
@@ -424,30 +408,23 @@ void BrainAMP::onUpdateCardinalPoints(const QString& sLPA, double dLPA, const QS
 
 void BrainAMP::run()
 {
+    MatrixXd matValue;
+
     while(m_bIsRunning)
     {
-        if(m_pBrainAMPProducer->isRunning())
+        //Wait for the next block of the producer
+        if(m_pBrainAMPProducer->isRunning() && m_pBrainAMPProducer->pop(matValue))
         {
-            m_mutex.lock();
-
-            if(m_qListReceivedSamples.isEmpty() == false)
-            {
-                MatrixXd matValue;
-                matValue = m_qListReceivedSamples.first();
-                m_qListReceivedSamples.removeFirst();
-
-                //Write raw data to fif file
-                if(m_bWriteToFile) {
-                    m_pOutfid->write_raw_buffer(matValue, m_cals);
-                }
-
-                //emit values to real time multi sample array
-                //qDebug()<<"BrainAMP::run() - mat size"<<matValue.rows()<<"x"<<matValue.cols();
-                //std::cout << "BrainAMP::run() - matValue.block(10,10)" << matValue.block(0,0,10,10) << std::endl;
-                m_pRMTSA_BrainAMP->data()->setValue(matValue);
+            //Write raw data to fif file
+            if(m_bWriteToFile) {
+                m_pOutfid->write_raw_buffer(matValue, m_cals);
+                SCSHAREDLIB::MetricsRegistry::addCounter(QString("%1/recording: samples").arg(getName()), matValue.cols());
             }
 
-            m_mutex.unlock();            
+            //emit values to real time multi sample array
+            //qDebug()<<"BrainAMP::run() - mat size"<<matValue.rows()<<"x"<<matValue.cols();
+            //std::cout << "BrainAMP::run() - matValue.block(10,10)" << matValue.block(0,0,10,10) << std::endl;
+            m_pRMTSA_BrainAMP->data()->setValue(matValue);
         }
     }
 
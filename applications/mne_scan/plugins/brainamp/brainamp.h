@@ -170,12 +170,6 @@ public:
     */
     virtual bool stop();
 
-    //=========================================================================================================
-    /**
-    * Set/Add received samples to a QList.
-    */
-    void setSampleData(Eigen::MatrixXd &matRawBuffer);
-
     virtual IPlugin::PluginType getType() const;
     virtual QString getName() const;
 
@@ -232,8 +226,6 @@ private:
     QSharedPointer<SCSHAREDLIB::PluginOutputData<SCMEASLIB::NewRealTimeMultiSampleArray> >  m_pRMTSA_BrainAMP;              /**< The RealTimeSampleArray to provide the EEG data.*/
     QSharedPointer<BrainAMPSetupProjectWidget>                                              m_pBrainAMPSetupProjectWidget;  /**< Widget for checking the impedances*/
 
-    QSharedPointer<IOBUFFER::RawMatrixBuffer>     m_pRawMatrixBuffer_In;              /**< Holds incoming raw data.*/
-
     QString                             m_qStringResourcePath;              /**< The path to the EEG resource directory.*/
 
     int                                 m_iSamplingFreq;                    /**< The sampling frequency defined by the user via the GUI (in Hertz).*/
@@ -274,10 +266,6 @@ private:
     QSharedPointer<QTimer>              m_pTimerRecordingChange;            /**< timer to control blinking of the recording icon */
     qint16                              m_iBlinkStatus;                     /**< flag for recording icon blinking */
 
-    QList<Eigen::MatrixXd>              m_qListReceivedSamples;             /**< list with alle the received samples in form of differentley sized matrices. */
-
-    QMutex                              m_mutex;
-
 };
 
 } // NAMESPACE
@@ -249,7 +249,7 @@ bool BrainAMPDriver::uninitDevice()
 
 //*************************************************************************************************************
 
-bool BrainAMPDriver::getSampleMatrixValue(Eigen::MatrixXd &sampleMatrix)
+bool BrainAMPDriver::getSampleMatrixValue(Eigen::Ref<Eigen::MatrixXd> sampleMatrix)
 {
     //Check if device was initialised and connected correctly
     if(!m_bInitDeviceSuccess)
@@ -260,12 +260,16 @@ bool BrainAMPDriver::getSampleMatrixValue(Eigen::MatrixXd &sampleMatrix)
 
     //printf("BrainAMPDriver::getSampleMatrixValue iDownsample: %d\n", m_uiDownsample);
 
-    sampleMatrix = Eigen::MatrixXd(Setup.nChannels + 1, m_uiSamplesPerBlock);
-    sampleMatrix.setZero(); // Clear matrix - set all elements to zero
+    if(sampleMatrix.rows() != Setup.nChannels + 1 || sampleMatrix.cols() != m_uiSamplesPerBlock)
+    {
+        printf("BrainAMPDriver::getSampleMatrixValue - Matrix of %d x %d does not fit the block size\n", (int)sampleMatrix.rows(), (int)sampleMatrix.cols());
+        return false;
+    }
 
     // Get the data
     // Data including marker channel
-    vector<short>pnData((Setup.nChannels + 1) * Setup.nPoints);
+    vector<short>& pnData = m_vecRawData;
+    pnData.resize((Setup.nChannels + 1) * Setup.nPoints);
 
     // Pure data
     // Check for error
@@ -303,18 +307,14 @@ bool BrainAMPDriver::getSampleMatrixValue(Eigen::MatrixXd &sampleMatrix)
         }
 
 
-        //Transform into matrix structure
-        int counter = 0;
-        for (int i = 0; i < m_uiSamplesPerBlock; ++i) {
-            for (int n = 0; n < Setup.nChannels + 1; ++n) {
-                sampleMatrix(n,i) = pnData[counter] * 100e-09;
-                counter++;
-            }
-
-            if(counter + ((m_uiDownsample - 1) * (Setup.nChannels + 1)) < pnData.size()) {
-                counter += ((m_uiDownsample - 1) * (Setup.nChannels + 1));
-            }
-        }
+        //Transform into matrix structure, only every m_uiDownsample-th scan is kept
+        BrainAMPProducer::convertScans<short>(&pnData[0],
+                                              (Setup.nChannels + 1) * m_uiDownsample,
+                                              Setup.nChannels + 1,
+                                              m_uiSamplesPerBlock,
+                                              100e-09,
+                                              sampleMatrix.data(),
+                                              sampleMatrix.outerStride());
 
         bBlockReceived = true;
     }
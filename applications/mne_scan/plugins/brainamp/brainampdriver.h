@@ -56,6 +56,8 @@
 
 #include <Eigen/Core>
 
+#include <vector>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -131,10 +133,10 @@ public:
     //=========================================================================================================
     /**
     * Get sample from the device in form of a mtrix.
-    * @param [in] MatrixXf the block sample values in form of a matrix.
+    * @param [in] sampleMatrix the block sample values in form of a matrix, it has to be sized (channels + marker) x samples per block.
     * @param [out] bool returns true if sample was successfully written to the input variable, false otherwise.
     */
-    bool getSampleMatrixValue(Eigen::MatrixXd& sampleMatrix);
+    bool getSampleMatrixValue(Eigen::Ref<Eigen::MatrixXd> sampleMatrix);
 
     //=========================================================================================================
     /**
@@ -192,6 +194,8 @@ private:
 
     BA_SETUP                    Setup;                              /**< Setup structure.*/
 
+    std::vector<short>          m_vecRawData;                       /**< Holds one block of device samples including the marker channel.*/
+
 };
 
 } // NAMESPACE
@@ -77,8 +77,8 @@ using namespace Eigen;
 BrainAMPProducer::BrainAMPProducer(BrainAMP* pBrainAmp)
 : m_pBrainAmp(pBrainAmp)
 , m_pBrainAmpDriver(new BrainAMPDriver(this))
-, m_bIsRunning(true)
 {
+    setObjectName("BrainAMP");
 }
 
 
@@ -86,6 +86,8 @@ BrainAMPProducer::BrainAMPProducer(BrainAMP* pBrainAmp)
 
 BrainAMPProducer::~BrainAMPProducer()
 {
+    if(this->isRunning())
+        stop();
 }
 
 
@@ -102,8 +104,7 @@ void BrainAMPProducer::start(int iSamplesPerBlock,
                                 sOutputFilePath,
                                 bMeasureImpedance))
     {
-        m_bIsRunning = true;
-        QThread::start();
+        startProducer(m_pBrainAmp->m_pFiffInfo->nchan, iSamplesPerBlock, iSamplingFrequency);
     }
     else
         m_bIsRunning = false;
@@ -115,10 +116,7 @@ void BrainAMPProducer::start(int iSamplesPerBlock,
 void BrainAMPProducer::stop()
 {
     //Wait until this thread (BrainAMPProducer) is stopped
-    m_bIsRunning = false;
-
-    while(this->isRunning())
-        m_bIsRunning = false;
+    stopProducer();
 
     //Unitialise device only after the thread stopped
     m_pBrainAmpDriver->uninitDevice();
@@ -127,20 +125,10 @@ void BrainAMPProducer::stop()
 
 //*************************************************************************************************************
 
-void BrainAMPProducer::run()
+bool BrainAMPProducer::readBlock(BlockMap& matBlock)
 {
-    while(m_bIsRunning)
-    {
-        //std::cout<<"BrainAMPProducer::run()"<<std::endl;
-        //Get the TMSi EEG data out of the device buffer and write received data to a QList
-        MatrixXd matRawBuffer;
-
-        if(m_pBrainAmpDriver->getSampleMatrixValue(matRawBuffer)) {
-            m_pBrainAmp->setSampleData(matRawBuffer);
-        }
-    }
-
-    std::cout<<"EXITING - BrainAMPProducer::run()"<<std::endl;
+    //Get the BrainAMP EEG data out of the device buffer straight into the ring
+    return m_pBrainAmpDriver->getSampleMatrixValue(matBlock);
 }
 
 
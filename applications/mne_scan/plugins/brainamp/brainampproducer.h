@@ -45,7 +45,7 @@
 
 #include "brainamp_global.h"
 
-#include <utils/generics/circularbuffer.h>
+#include <scShared/Management/amplifierproducer.h>
 
 
 //*************************************************************************************************************
@@ -56,14 +56,6 @@
 #include <Eigen/Eigen>
 
 
-//*************************************************************************************************************
-//=============================================================================================================
-// QT INCLUDES
-//=============================================================================================================
-
-#include <QThread>
-
-
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE NAMESPACE BRAINAMPPLUGIN
@@ -88,7 +80,7 @@ class BrainAMPDriver;
 *
 * @brief The BrainAMPProducer class provides a EEG data producer for a given sampling rate.
 */
-class BRAINAMPSHARED_EXPORT BrainAMPProducer : public QThread
+class BRAINAMPSHARED_EXPORT BrainAMPProducer : public SCSHAREDLIB::AmplifierProducer<double>
 {
 public:
     //=========================================================================================================
@@ -127,17 +119,17 @@ public:
 protected:
     //=========================================================================================================
     /**
-    * The starting point for the thread. After calling start(), the newly created thread calls this function.
-    * Returning from this method will end the execution of the thread.
-    * Pure virtual method inherited by QThread.
+    * Reads the next block from the device into a slot of the producer's ring.
+    *
+    * @param [out] matBlock     the block to fill.
+    *
+    * @return true if the block was filled.
     */
-    virtual void run();
+    virtual bool readBlock(BlockMap& matBlock);
 
 private:
     BrainAMP*                           m_pBrainAmp;            /**< A pointer to the corresponding BrainAmp class.*/
     QSharedPointer<BrainAMPDriver>      m_pBrainAmpDriver;      /**< A pointer to the corresponding BrainAmp driver class.*/
-
-    bool                                m_bIsRunning;           /**< Whether BrainAMPProducer is running.*/
 };
 
 } // NAMESPACE
@@ -0,0 +1,162 @@
+//=============================================================================================================
+/**
+* @file     deepinferencesetupwidget.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the DeepInferenceSetupWidget class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "deepinferencesetupwidget.h"
+#include "../deepinference.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QFileDialog>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DEEPINFERENCEPLUGIN;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+DeepInferenceSetupWidget::DeepInferenceSetupWidget(DeepInference* pDeepInference, QWidget *parent)
+: QWidget(parent)
+, m_pDeepInference(pDeepInference)
+{
+    ui.setupUi(this);
+
+    ui.m_qLineEdit_ModelFile->setText(m_pDeepInference->getModelFile());
+    ui.m_qSpinBox_Device->setValue(m_pDeepInference->getGpuId());
+    ui.m_qSpinBox_WindowLength->setValue(m_pDeepInference->getWindowLength());
+    ui.m_qSpinBox_Stride->setValue(m_pDeepInference->getStride());
+    ui.m_qSpinBox_BatchSize->setValue(m_pDeepInference->getBatchSize());
+    ui.m_qDoubleSpinBox_LatencyBudget->setValue(m_pDeepInference->getLatencyBudget());
+
+    //Always connect GUI elemts after ui.setpUi has been called
+    connect(ui.m_qPushButton_ModelFile, &QPushButton::released,
+            this, &DeepInferenceSetupWidget::onModelFileClicked);
+    connect(ui.m_qSpinBox_Device, &QSpinBox::editingFinished,
+            this, &DeepInferenceSetupWidget::onDeviceChanged);
+    connect(ui.m_qSpinBox_WindowLength, &QSpinBox::editingFinished,
+            this, &DeepInferenceSetupWidget::onWindowParametersChanged);
+    connect(ui.m_qSpinBox_Stride, &QSpinBox::editingFinished,
+            this, &DeepInferenceSetupWidget::onWindowParametersChanged);
+    connect(ui.m_qSpinBox_BatchSize, &QSpinBox::editingFinished,
+            this, &DeepInferenceSetupWidget::onWindowParametersChanged);
+    connect(ui.m_qDoubleSpinBox_LatencyBudget, &QDoubleSpinBox::editingFinished,
+            this, &DeepInferenceSetupWidget::onLatencyBudgetChanged);
+
+    connect(m_pDeepInference, &DeepInference::resultAvailable,
+            this, &DeepInferenceSetupWidget::onResultAvailable);
+}
+
+
+//*************************************************************************************************************
+
+DeepInferenceSetupWidget::~DeepInferenceSetupWidget()
+{
+
+}
+
+
+//*************************************************************************************************************
+
+void DeepInferenceSetupWidget::onModelFileClicked()
+{
+    QString sFileName = QFileDialog::getOpenFileName(this,
+                                                     tr("Open CNTK model"),
+                                                     ui.m_qLineEdit_ModelFile->text(),
+                                                     tr("CNTK models (*.model *.dnn);;All files (*)"));
+
+    if(sFileName.isEmpty()) {
+        return;
+    }
+
+    if(m_pDeepInference->loadModel(sFileName)) {
+        ui.m_qLineEdit_ModelFile->setText(sFileName);
+    } else {
+        QMessageBox::warning(this, tr("Deep Inference"), tr("Could not load the model %1.").arg(sFileName));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void DeepInferenceSetupWidget::onWindowParametersChanged()
+{
+    m_pDeepInference->setWindowParameters(ui.m_qSpinBox_WindowLength->value(),
+                                          ui.m_qSpinBox_Stride->value(),
+                                          ui.m_qSpinBox_BatchSize->value());
+}
+
+
+//*************************************************************************************************************
+
+void DeepInferenceSetupWidget::onLatencyBudgetChanged()
+{
+    m_pDeepInference->setLatencyBudget(ui.m_qDoubleSpinBox_LatencyBudget->value());
+}
+
+
+//*************************************************************************************************************
+
+void DeepInferenceSetupWidget::onDeviceChanged()
+{
+    m_pDeepInference->setGpuId(ui.m_qSpinBox_Device->value());
+}
+
+
+//*************************************************************************************************************
+
+void DeepInferenceSetupWidget::onResultAvailable(int iClass, double dScore, int iNumWindows, double dLatency, qint64 iDroppedWindows)
+{
+    ui.m_qLabel_Class->setText(QString::number(iClass));
+    ui.m_qLabel_Score->setText(QString::number(dScore, 'g', 4));
+    ui.m_qLabel_Latency->setText(tr("%1 ms for %2 windows").arg(dLatency, 0, 'f', 2).arg(iNumWindows));
+    ui.m_qLabel_Dropped->setText(QString::number(iDroppedWindows));
+}
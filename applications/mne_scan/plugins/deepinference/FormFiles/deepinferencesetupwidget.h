@@ -0,0 +1,147 @@
+//=============================================================================================================
+/**
+* @file     deepinferencesetupwidget.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the DeepInferenceSetupWidget class.
+*
+*/
+
+#ifndef DEEPINFERENCESETUPWIDGET_H
+#define DEEPINFERENCESETUPWIDGET_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../deepinference_global.h"
+#include "../ui_deepinferencesetup.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtWidgets>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DEEPINFERENCEPLUGIN
+//=============================================================================================================
+
+namespace DEEPINFERENCEPLUGIN
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class DeepInference;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS DeepInferenceSetupWidget
+*
+* @brief The DeepInferenceSetupWidget class provides the DeepInference configuration window.
+*/
+class DEEPINFERENCESHARED_EXPORT DeepInferenceSetupWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+
+    //=========================================================================================================
+    /**
+    * Constructs a DeepInferenceSetupWidget which is a child of parent.
+    *
+    * @param [in] pDeepInference    a pointer to the corresponding DeepInference.
+    * @param [in] parent            pointer to parent widget; If parent is 0, the new DeepInferenceSetupWidget becomes a window. If parent is another widget, DeepInferenceSetupWidget becomes a child window inside parent. DeepInferenceSetupWidget is deleted when its parent is deleted.
+    */
+    DeepInferenceSetupWidget(DeepInference* pDeepInference, QWidget *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destroys the DeepInferenceSetupWidget.
+    * All DeepInferenceSetupWidget's children are deleted first. The application exits if DeepInferenceSetupWidget is the main widget.
+    */
+    ~DeepInferenceSetupWidget();
+
+private slots:
+    //=========================================================================================================
+    /**
+    * Selects and loads a model file.
+    */
+    void onModelFileClicked();
+
+    //=========================================================================================================
+    /**
+    * Hands the window parameters over to the DeepInference.
+    */
+    void onWindowParametersChanged();
+
+    //=========================================================================================================
+    /**
+    * Hands the latency budget over to the DeepInference.
+    */
+    void onLatencyBudgetChanged();
+
+    //=========================================================================================================
+    /**
+    * Hands the selected device over to the DeepInference.
+    */
+    void onDeviceChanged();
+
+    //=========================================================================================================
+    /**
+    * Shows the result of the latest batch.
+    *
+    * @param[in] iClass             Index of the largest output of the newest window.
+    * @param[in] dScore             Value of the largest output of the newest window.
+    * @param[in] iNumWindows        Number of evaluated windows.
+    * @param[in] dLatency           Evaluation time of the batch in ms.
+    * @param[in] iDroppedWindows    Number of windows dropped since the start.
+    */
+    void onResultAvailable(int iClass, double dScore, int iNumWindows, double dLatency, qint64 iDroppedWindows);
+
+private:
+    DeepInference* m_pDeepInference;        /**< Holds a pointer to corresponding DeepInference object.*/
+
+    Ui::DeepInferenceSetupWidget ui;        /**< Holds the user interface for the DeepInferenceSetupWidget.*/
+};
+
+} // NAMESPACE
+
+#endif // DEEPINFERENCESETUPWIDGET_H
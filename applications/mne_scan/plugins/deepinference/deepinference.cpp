@@ -0,0 +1,464 @@
+//=============================================================================================================
+/**
+* @file     deepinference.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the DeepInference class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "deepinference.h"
+#include "FormFiles/deepinferencesetupwidget.h"
+
+#include <scShared/Management/metricsregistry.h>
+#include <scMeas/latencymonitor.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DEEPINFERENCEPLUGIN;
+using namespace SCSHAREDLIB;
+using namespace SCMEASLIB;
+using namespace DEEPLIB;
+using namespace IOBUFFER;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+DeepInference::DeepInference()
+: m_bIsRunning(false)
+, m_bSettingsChanged(true)
+, m_iWindowLength(100)
+, m_iStride(10)
+, m_iBatchSize(8)
+, m_iGpuId(-1)
+, m_dLatencyBudget(20.0)
+, m_dWindowCost(0.0)
+, m_pDeep(Deep::SPtr(new Deep))
+, m_pDeepInferenceBuffer(Q_NULLPTR)
+, m_pDeepInferenceInput(Q_NULLPTR)
+, m_pDeepInferenceOutput(Q_NULLPTR)
+{
+}
+
+
+//*************************************************************************************************************
+
+DeepInference::~DeepInference()
+{
+    if(this->isRunning())
+        stop();
+}
+
+
+//*************************************************************************************************************
+
+QSharedPointer<IPlugin> DeepInference::clone() const
+{
+    QSharedPointer<DeepInference> pDeepInferenceClone(new DeepInference);
+    return pDeepInferenceClone;
+}
+
+
+//*************************************************************************************************************
+
+void DeepInference::init()
+{
+    // Input
+    m_pDeepInferenceInput = PluginInputData<NewRealTimeMultiSampleArray>::create(this, "DeepInferenceIn", "Deep inference input data");
+    connect(m_pDeepInferenceInput.data(), &PluginInputConnector::notify, this, &DeepInference::update, Qt::DirectConnection);
+    m_inputConnectors.append(m_pDeepInferenceInput);
+
+    // Output
+    m_pDeepInferenceOutput = PluginOutputData<NewRealTimeMultiSampleArray>::create(this, "DeepInferenceOut", "Deep inference output data");
+    m_outputConnectors.append(m_pDeepInferenceOutput);
+
+    //Delete Buffer - will be initailzed with first incoming data
+    if(!m_pDeepInferenceBuffer.isNull())
+        m_pDeepInferenceBuffer.clear();
+}
+
+
+//*************************************************************************************************************
+
+void DeepInference::unload()
+{
+
+}
+
+
+//*************************************************************************************************************
+
+bool DeepInference::start()
+{
+    //Check if the thread is already or still running. This can happen if the start button is pressed immediately after the stop button was pressed. In this case the stopping process is not finished yet but the start process is initiated.
+    if(this->isRunning())
+        QThread::wait();
+
+    m_qMutex.lock();
+    m_bSettingsChanged = true;
+    m_dWindowCost = 0.0;
+    m_qMutex.unlock();
+
+    m_bIsRunning = true;
+
+    //Start thread
+    QThread::start();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool DeepInference::stop()
+{
+    m_bIsRunning = false;
+
+    if(m_pDeepInferenceBuffer) {
+        m_pDeepInferenceBuffer->releaseFromPop();
+        m_pDeepInferenceBuffer->releaseFromPush();
+
+        m_pDeepInferenceBuffer->clear();
+    }
+
+    m_qMutexTimestamps.lock();
+    m_qQueueTimestamps.clear();
+    m_qMutexTimestamps.unlock();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+IPlugin::PluginType DeepInference::getType() const
+{
+    return _IAlgorithm;
+}
+
+
+//*************************************************************************************************************
+
+QString DeepInference::getName() const
+{
+    return "Deep Inference";
+}
+
+
+//*************************************************************************************************************
+
+QWidget* DeepInference::setupWidget()
+{
+    DeepInferenceSetupWidget* setupWidget = new DeepInferenceSetupWidget(this);//widget is later distroyed by CentralWidget - so it has to be created everytime new
+    return setupWidget;
+}
+
+
+//*************************************************************************************************************
+
+void DeepInference::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
+{
+    QSharedPointer<NewRealTimeMultiSampleArray> pRTMSA = pMeasurement.dynamicCast<NewRealTimeMultiSampleArray>();
+
+    if(pRTMSA) {
+        //Check if buffer initialized
+        if(!m_pDeepInferenceBuffer) {
+            m_pDeepInferenceBuffer = CircularMatrixBuffer<double>::SPtr(new _double_CircularMatrixBuffer(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
+        }
+
+        //Fiff information
+        if(!m_pFiffInfo) {
+            m_pFiffInfo = pRTMSA->info();
+
+            m_pDeepInferenceOutput->data()->initFromFiffInfo(m_pFiffInfo);
+            m_pDeepInferenceOutput->data()->setMultiArraySize(1);
+            m_pDeepInferenceOutput->data()->setVisibility(true);
+        }
+
+        MatrixXd t_mat;
+
+        for(unsigned char i = 0; i < pRTMSA->getMultiArraySize(); ++i) {
+            t_mat = pRTMSA->getMultiSampleArray()[i];
+
+            //Keep the timestamp next to the block, so the latency can be measured from the input's entry time
+            m_qMutexTimestamps.lock();
+            m_qQueueTimestamps.enqueue(pRTMSA->getTimestamps().value(i, -1));
+            m_qMutexTimestamps.unlock();
+
+            m_pDeepInferenceBuffer->push(&t_mat);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool DeepInference::loadModel(const QString& sFileName)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(!m_pDeep->loadModel(sFileName, Deep::selectDevice(m_iGpuId))) {
+        qWarning() << "DeepInference::loadModel - Could not load model" << sFileName;
+        m_sModelFile.clear();
+        return false;
+    }
+
+    m_sModelFile = sFileName;
+    m_bSettingsChanged = true;
+    m_dWindowCost = 0.0;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void DeepInference::setWindowParameters(int iWindowLength, int iStride, int iBatchSize)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    m_iWindowLength = qMax(1, iWindowLength);
+    m_iStride = qMax(1, iStride);
+    m_iBatchSize = qMax(1, iBatchSize);
+    m_bSettingsChanged = true;
+}
+
+
+//*************************************************************************************************************
+
+void DeepInference::setLatencyBudget(double dLatencyBudget)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    m_dLatencyBudget = qMax(0.0, dLatencyBudget);
+}
+
+
+//*************************************************************************************************************
+
+void DeepInference::setGpuId(int iGpuId)
+{
+    QString sModelFile;
+
+    m_qMutex.lock();
+    if(iGpuId != m_iGpuId) {
+        m_iGpuId = iGpuId;
+        sModelFile = m_sModelFile;
+    }
+    m_qMutex.unlock();
+
+    if(!sModelFile.isEmpty()) {
+        loadModel(sModelFile);
+    }
+}
+
+
+//*************************************************************************************************************
+
+QString DeepInference::getModelFile() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_sModelFile;
+}
+
+
+//*************************************************************************************************************
+
+int DeepInference::getWindowLength() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iWindowLength;
+}
+
+
+//*************************************************************************************************************
+
+int DeepInference::getStride() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iStride;
+}
+
+
+//*************************************************************************************************************
+
+int DeepInference::getBatchSize() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iBatchSize;
+}
+
+
+//*************************************************************************************************************
+
+double DeepInference::getLatencyBudget() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_dLatencyBudget;
+}
+
+
+//*************************************************************************************************************
+
+int DeepInference::getGpuId() const
+{
+    QMutexLocker locker(&m_qMutex);
+    return m_iGpuId;
+}
+
+
+//*************************************************************************************************************
+
+void DeepInference::run()
+{
+    //
+    // Wait for Fiff Info
+    //
+    while(!m_pFiffInfo)
+        msleep(10);// Wait for fiff Info
+
+    MatrixXd t_mat;
+    qint64 iTimestamp;
+
+    while(m_bIsRunning)
+    {
+        //Dispatch the inputs
+        t_mat = m_pDeepInferenceBuffer->pop();
+
+        m_qMutexTimestamps.lock();
+        iTimestamp = m_qQueueTimestamps.isEmpty() ? -1 : m_qQueueTimestamps.dequeue();
+        m_qMutexTimestamps.unlock();
+
+        //Send the data to the connected plugins and the online display
+        m_pDeepInferenceOutput->data()->setValue(t_mat, iTimestamp);
+
+        m_qMutex.lock();
+
+        //Re-allocate the window ring and the batch only when the settings or the bad channels changed
+        if(m_bSettingsChanged || m_qListBads != m_pFiffInfo->bads) {
+            m_qListBads = m_pFiffInfo->bads;
+            m_vecPicks = m_pFiffInfo->pick_types(true, true, false, QStringList(), m_qListBads);
+            m_windowBuffer.resize(m_vecPicks.cols(), m_iWindowLength, m_iStride, m_iBatchSize);
+            m_qListInputs = QList<MatrixXf>() << MatrixXf(m_iBatchSize, m_windowBuffer.numFeatures());
+            m_bSettingsChanged = false;
+        }
+
+        MatrixXd t_matPicked(m_vecPicks.cols(), t_mat.cols());
+
+        for(qint32 i = 0; i < m_vecPicks.cols(); ++i) {
+            t_matPicked.row(i) = t_mat.row(m_vecPicks(i));
+        }
+
+        m_windowBuffer.push(t_matPicked);
+
+        if(!m_sModelFile.isEmpty()) {
+            evaluateWindows(iTimestamp);
+        }
+
+        m_qMutex.unlock();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void DeepInference::evaluateWindows(qint64 iTimestamp)
+{
+    int iNumWindows = m_windowBuffer.availableWindows();
+
+    if(iNumWindows == 0) {
+        return;
+    }
+
+    //Evaluate only as many of the newest windows as fit into the latency budget
+    int iMaxWindows = m_iBatchSize;
+
+    if(m_dWindowCost > 0.0) {
+        iMaxWindows = qBound(1, static_cast<int>(m_dLatencyBudget / m_dWindowCost), m_iBatchSize);
+    }
+
+    if(iNumWindows > iMaxWindows) {
+        m_windowBuffer.skipWindows(iNumWindows - iMaxWindows);
+    }
+
+    iNumWindows = m_windowBuffer.takeWindows(iMaxWindows);
+
+    //The input keeps its allocation as long as the batch size does not change
+    m_qListInputs[0] = m_windowBuffer.batch().topRows(iNumWindows);
+
+    qint64 iStart = LatencyMonitor::now();
+
+    try {
+        if(!m_pDeep->evalModelBatch(m_qListInputs, m_qListOutputs, Deep::selectDevice(m_iGpuId))) {
+            return;
+        }
+    } catch(const char* sError) {
+        qWarning() << "DeepInference::evaluateWindows - Evaluation failed:" << sError;
+        m_sModelFile.clear();
+        return;
+    }
+
+    qint64 iDuration = LatencyMonitor::now() - iStart;
+    double dLatency = iDuration / 1000.0;
+
+    //Smooth the cost of one window, a single slow batch should not empty the following ones
+    double dWindowCost = dLatency / iNumWindows;
+    m_dWindowCost = m_dWindowCost > 0.0 ? 0.8 * m_dWindowCost + 0.2 * dWindowCost : dWindowCost;
+
+    MetricsRegistry::recordDuration(QString("%1/inference time").arg(getName()), iDuration);
+    MetricsRegistry::addCounter(QString("%1/windows").arg(getName()), iNumWindows);
+    MetricsRegistry::setGauge(QString("%1/dropped windows").arg(getName()), m_windowBuffer.droppedWindows());
+
+    if(iTimestamp >= 0) {
+        LatencyMonitor::record(QString("%1/inference").arg(getName()), iTimestamp);
+    }
+
+    const MatrixXf& matOutput = m_qListOutputs[0];
+
+    if(matOutput.size() > 0) {
+        int iClass;
+        float fScore = matOutput.row(matOutput.rows() - 1).maxCoeff(&iClass);
+
+        emit resultAvailable(iClass, fScore, iNumWindows, dLatency, m_windowBuffer.droppedWindows());
+    }
+}
@@ -0,0 +1,234 @@
+//=============================================================================================================
+/**
+* @file     deepinference.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the DeepInference class.
+*
+*/
+
+#ifndef DEEPINFERENCE_H
+#define DEEPINFERENCE_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "deepinference_global.h"
+#include "slidingwindowbuffer.h"
+
+#include <scShared/Interfaces/IAlgorithm.h>
+#include <utils/generics/circularmatrixbuffer.h>
+#include <scMeas/newrealtimemultisamplearray.h>
+#include <deep/deep.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtWidgets>
+#include <QtCore/QtPlugin>
+#include <QMutex>
+#include <QQueue>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DEEPINFERENCEPLUGIN
+//=============================================================================================================
+
+namespace DEEPINFERENCEPLUGIN
+{
+
+
+//=============================================================================================================
+/**
+* The DeepInference plugin evaluates a CNTK model, loaded with DEEPLIB::Deep, on sliding windows of the incoming
+* MEG/EEG channels. The windows are collected and evaluated in batches. Windows which can not be evaluated within
+* the latency budget are dropped, so the results always refer to the newest data. The input data is passed
+* through to the output.
+*
+* @brief The DeepInference class provides real-time deep model inference.
+*/
+class DEEPINFERENCESHARED_EXPORT DeepInference : public SCSHAREDLIB::IAlgorithm
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "scsharedlib/1.0" FILE "deepinference.json") //New Qt5 Plugin system replaces Q_EXPORT_PLUGIN2 macro
+    // Use the Q_INTERFACES() macro to tell Qt's meta-object system about the interfaces
+    Q_INTERFACES(SCSHAREDLIB::IAlgorithm)
+
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a DeepInference.
+    */
+    DeepInference();
+
+    //=========================================================================================================
+    /**
+    * Destroys the DeepInference.
+    */
+    ~DeepInference();
+
+    //=========================================================================================================
+    /**
+    * IAlgorithm functions
+    */
+    virtual QSharedPointer<IPlugin> clone() const;
+    virtual void init();
+    virtual void unload();
+    virtual bool start();
+    virtual bool stop();
+    virtual IPlugin::PluginType getType() const;
+    virtual QString getName() const;
+    virtual QWidget* setupWidget();
+
+    //=========================================================================================================
+    /**
+    * Udates the pugin with new (incoming) data.
+    *
+    * @param[in] pMeasurement    The incoming data in form of a generalized NewMeasurement.
+    */
+    void update(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
+
+    //=========================================================================================================
+    /**
+    * Loads the CNTK model on the selected device.
+    *
+    * @param[in] sFileName  The model file.
+    *
+    * @return true if the model was loaded, false otherwise.
+    */
+    bool loadModel(const QString& sFileName);
+
+    //=========================================================================================================
+    /**
+    * Sets the window parameters. They are applied to the next incoming data block.
+    *
+    * @param[in] iWindowLength  Number of samples of one window.
+    * @param[in] iStride        Number of samples between the starts of two consecutive windows.
+    * @param[in] iBatchSize     Maximal number of windows evaluated at once.
+    */
+    void setWindowParameters(int iWindowLength, int iStride, int iBatchSize);
+
+    //=========================================================================================================
+    /**
+    * Sets the latency budget of one batch evaluation.
+    *
+    * @param[in] dLatencyBudget     The budget in ms.
+    */
+    void setLatencyBudget(double dLatencyBudget);
+
+    //=========================================================================================================
+    /**
+    * Sets the GPU to evaluate on. A loaded model is reloaded on the new device.
+    *
+    * @param[in] iGpuId     Id of the GPU, -1 selects the CPU.
+    */
+    void setGpuId(int iGpuId);
+
+    //=========================================================================================================
+    /**
+    * Getters of the current settings.
+    */
+    QString getModelFile() const;
+    int getWindowLength() const;
+    int getStride() const;
+    int getBatchSize() const;
+    double getLatencyBudget() const;
+    int getGpuId() const;
+
+protected:
+    //=========================================================================================================
+    /**
+    * IAlgorithm function
+    */
+    virtual void run();
+
+private:
+    //=========================================================================================================
+    /**
+    * Evaluates the available windows. The batch is limited to the number of windows which can be evaluated
+    * within the latency budget, older windows are dropped.
+    *
+    * @param[in] iTimestamp     Entry time of the newest data block, -1 if unknown.
+    */
+    void evaluateWindows(qint64 iTimestamp);
+
+    bool                                            m_bIsRunning;           /**< Flag whether thread is running.*/
+    bool                                            m_bSettingsChanged;     /**< Flag whether the window buffer needs to be re-allocated.*/
+
+    int                                             m_iWindowLength;        /**< Number of samples of one window.*/
+    int                                             m_iStride;              /**< Number of samples between two window starts.*/
+    int                                             m_iBatchSize;           /**< Maximal number of windows evaluated at once.*/
+    int                                             m_iGpuId;               /**< Id of the GPU to evaluate on, -1 for the CPU.*/
+    double                                          m_dLatencyBudget;       /**< Latency budget of one batch evaluation in ms.*/
+    double                                          m_dWindowCost;          /**< Running estimate of the evaluation time of one window in ms.*/
+
+    QString                                         m_sModelFile;           /**< The loaded model file.*/
+    mutable QMutex                                  m_qMutex;               /**< Guards the model and the settings.*/
+
+    FIFFLIB::FiffInfo::SPtr                         m_pFiffInfo;            /**< Fiff measurement info.*/
+    Eigen::RowVectorXi                              m_vecPicks;             /**< The channels which are fed to the model.*/
+    QStringList                                     m_qListBads;            /**< The bad channels the picks were made with.*/
+
+    DEEPLIB::Deep::SPtr                             m_pDeep;                /**< The model.*/
+    SlidingWindowBuffer                             m_windowBuffer;         /**< The pre-allocated window ring and batch.*/
+    QList<Eigen::MatrixXf>                          m_qListInputs;          /**< The batch handed to the model.*/
+    QList<Eigen::MatrixXf>                          m_qListOutputs;         /**< The results of the batch.*/
+
+    QSharedPointer<IOBUFFER::_double_CircularMatrixBuffer>  m_pDeepInferenceBuffer;     /**< Holds incoming data.*/
+
+    QMutex                                          m_qMutexTimestamps;     /**< Guards the timestamp queue.*/
+    QQueue<qint64>                                  m_qQueueTimestamps;     /**< Entry times of the buffered blocks.*/
+
+    SCSHAREDLIB::PluginInputData<SCMEASLIB::NewRealTimeMultiSampleArray>::SPtr      m_pDeepInferenceInput;      /**< The NewRealTimeMultiSampleArray of the DeepInference input.*/
+    SCSHAREDLIB::PluginOutputData<SCMEASLIB::NewRealTimeMultiSampleArray>::SPtr     m_pDeepInferenceOutput;     /**< The NewRealTimeMultiSampleArray of the DeepInference output.*/
+
+signals:
+    //=========================================================================================================
+    /**
+    * Emitted when a batch of windows was evaluated.
+    *
+    * @param[in] iClass             Index of the largest output of the newest window.
+    * @param[in] dScore             Value of the largest output of the newest window.
+    * @param[in] iNumWindows        Number of evaluated windows.
+    * @param[in] dLatency           Evaluation time of the batch in ms.
+    * @param[in] iDroppedWindows    Number of windows dropped since the start.
+    */
+    void resultAvailable(int iClass, double dScore, int iNumWindows, double dLatency, qint64 iDroppedWindows);
+};
+
+} // NAMESPACE
+
+#endif // DEEPINFERENCE_H
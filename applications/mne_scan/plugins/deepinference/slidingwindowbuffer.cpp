@@ -0,0 +1,179 @@
+//=============================================================================================================
+/**
+* @file     slidingwindowbuffer.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the SlidingWindowBuffer class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "slidingwindowbuffer.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DEEPINFERENCEPLUGIN;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+SlidingWindowBuffer::SlidingWindowBuffer(int iNumChannels, int iWindowLength, int iStride, int iMaxWindows)
+{
+    resize(iNumChannels, iWindowLength, iStride, iMaxWindows);
+}
+
+
+//*************************************************************************************************************
+
+void SlidingWindowBuffer::resize(int iNumChannels, int iWindowLength, int iStride, int iMaxWindows)
+{
+    m_iNumChannels = qMax(0, iNumChannels);
+    m_iWindowLength = qMax(1, iWindowLength);
+    m_iStride = qMax(1, iStride);
+    m_iMaxWindows = qMax(1, iMaxWindows);
+
+    //The ring holds the samples of all windows which can be kept at once
+    m_matRing.setZero(m_iNumChannels, m_iWindowLength + (m_iMaxWindows - 1) * m_iStride);
+    m_matBatch.setZero(m_iMaxWindows, m_iNumChannels * m_iWindowLength);
+
+    clear();
+}
+
+
+//*************************************************************************************************************
+
+void SlidingWindowBuffer::clear()
+{
+    m_iNumSamples = 0;
+    m_iNextWindowStart = 0;
+    m_iDroppedWindows = 0;
+}
+
+
+//*************************************************************************************************************
+
+void SlidingWindowBuffer::push(const MatrixXd& matData)
+{
+    if(matData.rows() != m_iNumChannels) {
+        qWarning("SlidingWindowBuffer::push - Number of channels (%d) does not match the buffer (%d).", static_cast<int>(matData.rows()), m_iNumChannels);
+        return;
+    }
+
+    const qint64 iCapacity = m_matRing.cols();
+    qint64 iFrom = 0;
+
+    //Only the newest samples of a block longer than the ring survive
+    if(matData.cols() > iCapacity) {
+        iFrom = matData.cols() - iCapacity;
+        m_iNumSamples += iFrom;
+    }
+
+    while(iFrom < matData.cols()) {
+        const qint64 iPos = m_iNumSamples % iCapacity;
+        const qint64 iCount = qMin(iCapacity - iPos, static_cast<qint64>(matData.cols()) - iFrom);
+
+        m_matRing.middleCols(iPos, iCount) = matData.middleCols(iFrom, iCount).cast<float>();
+
+        iFrom += iCount;
+        m_iNumSamples += iCount;
+    }
+
+    //Drop the windows which start at overwritten samples
+    const qint64 iOldest = m_iNumSamples - iCapacity;
+
+    if(m_iNextWindowStart < iOldest) {
+        const qint64 iSkip = (iOldest - m_iNextWindowStart + m_iStride - 1) / m_iStride;
+        m_iNextWindowStart += iSkip * m_iStride;
+        m_iDroppedWindows += iSkip;
+    }
+}
+
+
+//*************************************************************************************************************
+
+int SlidingWindowBuffer::availableWindows() const
+{
+    if(m_iNumChannels == 0 || m_iNextWindowStart + m_iWindowLength > m_iNumSamples) {
+        return 0;
+    }
+
+    return static_cast<int>((m_iNumSamples - m_iWindowLength - m_iNextWindowStart) / m_iStride + 1);
+}
+
+
+//*************************************************************************************************************
+
+void SlidingWindowBuffer::skipWindows(int iCount)
+{
+    iCount = qBound(0, iCount, availableWindows());
+
+    m_iNextWindowStart += static_cast<qint64>(iCount) * m_iStride;
+    m_iDroppedWindows += iCount;
+}
+
+
+//*************************************************************************************************************
+
+int SlidingWindowBuffer::takeWindows(int iMaxCount)
+{
+    const int iCount = qBound(0, iMaxCount, qMin(availableWindows(), m_iMaxWindows));
+    const qint64 iCapacity = m_matRing.cols();
+
+    for(int i = 0; i < iCount; ++i) {
+        const qint64 iPos = m_iNextWindowStart % iCapacity;
+        const qint64 iFirst = qMin(static_cast<qint64>(m_iWindowLength), iCapacity - iPos);
+        const qint64 iSecond = m_iWindowLength - iFirst;
+
+        //A window which wraps around the end of the ring is copied in two parts
+        for(int c = 0; c < m_iNumChannels; ++c) {
+            m_matBatch.row(i).segment(c * m_iWindowLength, iFirst) = m_matRing.row(c).segment(iPos, iFirst);
+
+            if(iSecond > 0) {
+                m_matBatch.row(i).segment(c * m_iWindowLength + iFirst, iSecond) = m_matRing.row(c).head(iSecond);
+            }
+        }
+
+        m_iNextWindowStart += m_iStride;
+    }
+
+    return iCount;
+}
@@ -0,0 +1,214 @@
+//=============================================================================================================
+/**
+* @file     slidingwindowbuffer.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the SlidingWindowBuffer class.
+*
+*/
+
+#ifndef SLIDINGWINDOWBUFFER_H
+#define SLIDINGWINDOWBUFFER_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "deepinference_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtGlobal>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DEEPINFERENCEPLUGIN
+//=============================================================================================================
+
+namespace DEEPINFERENCEPLUGIN
+{
+
+
+//=============================================================================================================
+/**
+* The SlidingWindowBuffer keeps the latest samples of the picked channels in a pre-allocated ring and cuts them
+* into overlapping windows. Each window is flattened channel by channel into one row of a pre-allocated batch
+* matrix (row = window, cols = channels x window length), which is the sample layout of DEEPLIB::Deep.
+*
+* @brief Ring buffer which cuts incoming data into strided windows for batched model evaluation.
+*/
+class DEEPINFERENCESHARED_EXPORT SlidingWindowBuffer
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a SlidingWindowBuffer.
+    *
+    * @param[in] iNumChannels   Number of channels of one window.
+    * @param[in] iWindowLength  Number of samples of one window.
+    * @param[in] iStride        Number of samples between the starts of two consecutive windows.
+    * @param[in] iMaxWindows    Maximal number of windows which are kept and handed out at once.
+    */
+    SlidingWindowBuffer(int iNumChannels = 0, int iWindowLength = 1, int iStride = 1, int iMaxWindows = 1);
+
+    //=========================================================================================================
+    /**
+    * Re-allocates the ring and the batch matrix and drops all samples.
+    *
+    * @param[in] iNumChannels   Number of channels of one window.
+    * @param[in] iWindowLength  Number of samples of one window.
+    * @param[in] iStride        Number of samples between the starts of two consecutive windows.
+    * @param[in] iMaxWindows    Maximal number of windows which are kept and handed out at once.
+    */
+    void resize(int iNumChannels, int iWindowLength, int iStride, int iMaxWindows);
+
+    //=========================================================================================================
+    /**
+    * Drops all samples and windows, the allocations are kept.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Appends new samples. Windows whose samples were overwritten before they were taken are dropped.
+    *
+    * @param[in] matData    The new samples (rows = channels, cols = samples).
+    */
+    void push(const Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of complete windows which were not taken yet.
+    *
+    * @return the number of available windows.
+    */
+    int availableWindows() const;
+
+    //=========================================================================================================
+    /**
+    * Skips the oldest available windows, e.g. the ones which could not be evaluated in time.
+    *
+    * @param[in] iCount     Number of windows to skip.
+    */
+    void skipWindows(int iCount);
+
+    //=========================================================================================================
+    /**
+    * Copies the oldest available windows into the top rows of the batch matrix.
+    *
+    * @param[in] iMaxCount  Maximal number of windows to take.
+    *
+    * @return the number of windows which were copied into batch().
+    */
+    int takeWindows(int iMaxCount);
+
+    //=========================================================================================================
+    /**
+    * Returns the batch matrix filled by takeWindows (rows = windows, cols = channels x window length).
+    *
+    * @return the batch matrix.
+    */
+    inline const Eigen::MatrixXf& batch() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of windows which were dropped since the last clear, because their samples were
+    * overwritten or because they were skipped.
+    *
+    * @return the number of dropped windows.
+    */
+    inline qint64 droppedWindows() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of features of one window, i.e. channels x window length.
+    *
+    * @return the number of features.
+    */
+    inline int numFeatures() const;
+
+private:
+    int                 m_iNumChannels;         /**< Number of channels of one window. */
+    int                 m_iWindowLength;        /**< Number of samples of one window. */
+    int                 m_iStride;              /**< Number of samples between two window starts. */
+    int                 m_iMaxWindows;          /**< Maximal number of windows kept at once. */
+
+    Eigen::MatrixXf     m_matRing;              /**< The ring of samples (rows = channels, cols = samples). */
+    Eigen::MatrixXf     m_matBatch;             /**< The flattened windows (rows = windows, cols = features). */
+
+    qint64              m_iNumSamples;          /**< Number of samples pushed since the last clear. */
+    qint64              m_iNextWindowStart;     /**< Absolute sample index at which the next window starts. */
+    qint64              m_iDroppedWindows;      /**< Number of dropped windows since the last clear. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline const Eigen::MatrixXf& SlidingWindowBuffer::batch() const
+{
+    return m_matBatch;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 SlidingWindowBuffer::droppedWindows() const
+{
+    return m_iDroppedWindows;
+}
+
+
+//*************************************************************************************************************
+
+inline int SlidingWindowBuffer::numFeatures() const
+{
+    return m_iNumChannels * m_iWindowLength;
+}
+
+} // NAMESPACE
+
+#endif // SLIDINGWINDOWBUFFER_H
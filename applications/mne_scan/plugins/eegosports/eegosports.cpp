@@ -42,6 +42,8 @@
 #include "eegosports.h"
 #include "eegosportsproducer.h"
 
+#include <scShared/Management/metricsregistry.h>
+
 #include "FormFiles/eegosportssetupwidget.h"
 #include "FormFiles/eegosportssetupprojectwidget.h"
 
@@ -526,9 +528,7 @@ bool EEGoSports::start()
     m_pRMTSA_EEGoSports->data()->setMultiArraySize(1);
     m_pRMTSA_EEGoSports->data()->setSamplingRate(m_iSamplingFreq);
 
-    //Buffer
-    m_qListReceivedSamples.clear();
-
+    //The producer holds the ring buffer of the incoming raw data
     m_pEEGoSportsProducer->start(m_iNumberOfChannels,
                        m_iSamplesPerBlock,
                        m_iSamplingFreq,
@@ -551,27 +551,18 @@ bool EEGoSports::start()
 
 bool EEGoSports::stop()
 {
-    //Stop the producer thread first
-    m_pEEGoSportsProducer->stop();
-
     //Wait until this thread (EEGoSports) is stopped
     m_bIsRunning = false;
 
-    m_pRMTSA_EEGoSports->data()->clear();
-
-    m_qListReceivedSamples.clear();
-
-    return true;
-}
+    //In case the ring blocks the thread -> Release it and let it exit from the pop function
+    m_pEEGoSportsProducer->releaseFromPop();
 
+    //Stop the producer thread
+    m_pEEGoSportsProducer->stop();
 
-//*************************************************************************************************************
+    m_pRMTSA_EEGoSports->data()->clear();
 
-void EEGoSports::setSampleData(MatrixXd &matRawBuffer)
-{
-    m_mutex.lock();
-    m_qListReceivedSamples.append(matRawBuffer);
-    m_mutex.unlock();
+    return true;
 }
 
 
@@ -739,24 +730,17 @@ void EEGoSports::run()
     MatrixXd matValue;
 
     while(m_bIsRunning) {
-        if(m_pEEGoSportsProducer->isRunning()) {
-            m_mutex.lock();
-
-            if(m_qListReceivedSamples.isEmpty() == false) {
-
-                matValue = m_qListReceivedSamples.takeFirst();
-
-                //Write raw data to fif file
-                if(m_bWriteToFile) {
-                    m_pOutfid->write_raw_buffer(matValue, m_cals);
-                }
-
-                //emit values to real time multi sample array
-                //qDebug()<<"EEGoSports::run() - mat size"<<matValue.rows()<<"x"<<matValue.cols();
-                m_pRMTSA_EEGoSports->data()->setValue(matValue);
+        //Wait for the next block of the producer
+        if(m_pEEGoSportsProducer->isRunning() && m_pEEGoSportsProducer->pop(matValue)) {
+            //Write raw data to fif file
+            if(m_bWriteToFile) {
+                m_pOutfid->write_raw_buffer(matValue, m_cals);
+                SCSHAREDLIB::MetricsRegistry::addCounter(QString("%1/recording: samples").arg(getName()), matValue.cols());
             }
 
-            m_mutex.unlock();            
+            //emit values to real time multi sample array
+            //qDebug()<<"EEGoSports::run() - mat size"<<matValue.rows()<<"x"<<matValue.cols();
+            m_pRMTSA_EEGoSports->data()->setValue(matValue);
         }
     }
 
@@ -171,12 +171,6 @@ public:
     */
     virtual bool stop();
 
-    //=========================================================================================================
-    /**
-    * Set/Add received samples to a QList.
-    */
-    void setSampleData(Eigen::MatrixXd &matRawBuffer);
-
     virtual IPlugin::PluginType getType() const;
     virtual QString getName() const;
 
@@ -266,16 +260,11 @@ private:
 
     QSharedPointer<EEGoSportsProducer>  m_pEEGoSportsProducer;              /**< The EEGoSportsProducer.*/
 
-    QMutex                              m_mutex;                            /**< Holds the threads mutex.*/
-
     QAction*                            m_pActionSetupProject;              /**< Shows setup project dialog */
     QAction*                            m_pActionStartRecording;            /**< Starts to record data */
 
     QSharedPointer<QTimer>              m_pTimerRecordingChange;            /**< Timer to control blinking of the recording icon */
     qint16                              m_iBlinkStatus;                     /**< Flag for recording icon blinking */
-
-    QList<Eigen::MatrixXd>              m_qListReceivedSamples;             /**< List with alle the received samples in form of differentley sized matrices. */
-
 };
 
 } // NAMESPACE
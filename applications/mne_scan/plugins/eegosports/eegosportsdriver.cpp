@@ -183,7 +183,7 @@ bool EEGoSportsDriver::uninitDevice()
 
 //*************************************************************************************************************
 
-bool EEGoSportsDriver::getSampleMatrixValue(Eigen::MatrixXd &sampleMatrix)
+bool EEGoSportsDriver::getSampleMatrixValue(Eigen::Ref<Eigen::MatrixXd> sampleMatrix)
 {
     //Check if device was initialised and connected correctly
     if(!m_bInitDeviceSuccess) {
@@ -191,7 +191,12 @@ bool EEGoSportsDriver::getSampleMatrixValue(Eigen::MatrixXd &sampleMatrix)
         return false;
     }
 
-    sampleMatrix = MatrixXd::Zero(m_uiNumberOfChannels, m_uiSamplesPerBlock);
+    if(sampleMatrix.rows() != (int)m_uiNumberOfChannels || sampleMatrix.cols() != (int)m_uiSamplesPerBlock) {
+        std::cout << "Plugin EEGoSports - ERROR - getSampleMatrixValue() - The matrix is of size " << sampleMatrix.rows() << "x" << sampleMatrix.cols() << " instead of " << m_uiNumberOfChannels << "x" << m_uiSamplesPerBlock << std::endl;
+        return false;
+    }
+
+    sampleMatrix.setZero();
 
     uint iSampleIterator, iReceivedSamples, iChannelCount, i, j;
 
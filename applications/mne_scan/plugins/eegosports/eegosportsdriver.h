@@ -127,11 +127,12 @@ public:
 
     //=========================================================================================================
     /**
-    * Get sample from the device in form of a mtrix.
-    * @param [in] MatrixXf the block sample values in form of a matrix.
+    * Get sample from the device in form of a mtrix. The matrix is filled in place and has to be of size
+    * number of channels x samples per block.
+    * @param [in] MatrixXd the block sample values in form of a matrix.
     * @param [out] bool returns true if sample was successfully written to the input variable, false otherwise.
     */
-    bool getSampleMatrixValue(Eigen::MatrixXd& sampleMatrix);
+    bool getSampleMatrixValue(Eigen::Ref<Eigen::MatrixXd> sampleMatrix);
 
     //=========================================================================================================
     /**
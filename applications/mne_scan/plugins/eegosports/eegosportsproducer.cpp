@@ -71,8 +71,8 @@ using namespace Eigen;
 EEGoSportsProducer::EEGoSportsProducer(EEGoSports* pEEGoSports)
 : m_pEEGoSports(pEEGoSports)
 , m_pEEGoSportsDriver(new EEGoSportsDriver(this))
-, m_bIsRunning(true)
 {
+    setObjectName("EEGoSports");
 }
 
 
@@ -80,6 +80,9 @@ EEGoSportsProducer::EEGoSportsProducer(EEGoSports* pEEGoSports)
 
 EEGoSportsProducer::~EEGoSportsProducer()
 {
+    if(this->isRunning()) {
+        stop();
+    }
 }
 
 
@@ -99,8 +102,7 @@ void EEGoSportsProducer::start(int iNumberOfChannels,
                                 bWriteDriverDebugToFile,
                                 sOutputFilePath,
                                 bMeasureImpedance)) {
-        m_bIsRunning = true;
-        QThread::start();
+        startProducer(iNumberOfChannels, iSamplesPerBlock, iSamplingFrequency);
     } else {
         m_bIsRunning = false;
     }
@@ -112,11 +114,7 @@ void EEGoSportsProducer::start(int iNumberOfChannels,
 void EEGoSportsProducer::stop()
 {
     //Wait until this thread (EEGoSportsProducer) is stopped
-    m_bIsRunning = false;
-
-    while(this->isRunning()) {
-        m_bIsRunning = false;
-    }
+    stopProducer();
 
     //Unitialise device only after the thread stopped
     m_pEEGoSportsDriver->uninitDevice();
@@ -125,16 +123,10 @@ void EEGoSportsProducer::stop()
 
 //*************************************************************************************************************
 
-void EEGoSportsProducer::run()
+bool EEGoSportsProducer::readBlock(BlockMap& matBlock)
 {
-    MatrixXd matRawBuffer;
-
-    while(m_bIsRunning) {
-        //Get the EEG data out of the device buffer and send it to main thread
-        if(m_pEEGoSportsDriver->getSampleMatrixValue(matRawBuffer)) {
-            m_pEEGoSports->setSampleData(matRawBuffer);
-        }
-    }
+    //Get the EEG data out of the device buffer straight into the ring
+    return m_pEEGoSportsDriver->getSampleMatrixValue(matBlock);
 }
 
 
@@ -43,6 +43,8 @@
 // INCLUDES
 //=============================================================================================================
 
+#include <scShared/Management/amplifierproducer.h>
+
 #include <Eigen/Eigen>
 
 
@@ -51,7 +53,6 @@
 // QT INCLUDES
 //=============================================================================================================
 
-#include <QThread>
 #include <QSharedPointer>
 
 
@@ -79,7 +80,7 @@ class EEGoSportsDriver;
 *
 * @brief The EEGoSportsProducer class provides a EEG data producer for a given sampling rate.
 */
-class EEGoSportsProducer : public QThread
+class EEGoSportsProducer : public SCSHAREDLIB::AmplifierProducer<double>
 {
 
 public:
@@ -123,17 +124,17 @@ public:
 protected:
     //=========================================================================================================
     /**
-    * The starting point for the thread. After calling start(), the newly created thread calls this function.
-    * Returning from this method will end the execution of the thread.
-    * Pure virtual method inherited by QThread.
+    * Reads the next block from the device into a slot of the producer's ring.
+    *
+    * @param [out] matBlock     the block to fill.
+    *
+    * @return true if the block was filled.
     */
-    virtual void run();
+    virtual bool readBlock(BlockMap& matBlock);
 
 private:
     EEGoSports*                         m_pEEGoSports;              /**< A pointer to the corresponding EEGoSports class.*/
     QSharedPointer<EEGoSportsDriver>    m_pEEGoSportsDriver;        /**< A pointer to the corresponding EEGoSportsDriver class.*/
-
-    bool                                m_bIsRunning;               /**< Whether EEGoSportsProducer is running.*/
 };
 
 } // NAMESPACE
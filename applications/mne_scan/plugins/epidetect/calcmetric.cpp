@@ -88,6 +88,8 @@ CalcMetric::CalcMetric()
     m_bSetNewFuzzyEn = false;
     m_bSetNewKurtosis = false;
     m_bHistoryReady=false;
+    m_iChannelCount = 0;
+    m_lastHalfMoments.iLength = 0;
 
 }
 
@@ -112,6 +114,30 @@ QPair<RowVectorXd, QPair<QList<double>, int> > createInputList(RowVectorXd input
 }
 
 
+//*************************************************************************************************************
+
+double similaritySum(const ArrayXd &diff, int m, int count, double r, double n)
+{
+    //diff(i) is the difference of two samples lag apart, pattern i of both spans diff(i) ... diff(i+m-1)
+    ArrayXd mean = diff.head(count);
+    for (int k = 1; k < m; k++)
+        mean += diff.segment(k, count);
+    mean /= m;
+
+    ArrayXd distance = (diff.head(count) - mean).abs();
+    for (int k = 1; k < m; k++)
+        distance = distance.max((diff.segment(k, count) - mean).abs());
+
+    //The exponent is usually a small integer, pow is avoided then
+    if (n == 1.0)
+        return ((-1)*distance/r).exp().sum();
+    else if (n == 2.0)
+        return ((-1)*distance.square()/r).exp().sum();
+    else
+        return ((-1)*(distance.pow(n))/r).exp().sum();
+}
+
+
 //*************************************************************************************************************
 
 double calcFuzzyEn(QPair<RowVectorXd, QPair<QList<double>, int> > input)//RowVectorXd data, double mean, double stdDev, int dim, double r, double n)
@@ -125,53 +151,34 @@ double calcFuzzyEn(QPair<RowVectorXd, QPair<QList<double>, int> > input)//RowVec
     double r = doubleInputValues[2];
     double n = doubleInputValues[3];
     int length = data.cols();
-    double fuzzyEn;
-    ArrayXd arDataNorm = (data.array()- mean).array()/(stdDev);
-    VectorXd dataNorm = arDataNorm;
-    Vector2d phi;
+    ArrayXd dataNorm = ((data.array()- mean)/(stdDev)).transpose();
 
-    for(int j=0; j<2; j++)
-    {
-        int m = dim+j;
-        MatrixXd patterns;
-        patterns.resize(m, length-m+1);
-
-        if (m==1)
-            patterns = dataNorm;
-        else
-        {
-            for(int i=0; i<m; i++)
-                patterns.row(i)=dataNorm.segment(i,length-m+1);
+    //The patterns of embedding dimension dim and dim+1 are compared in the same pass. The distance of two
+    //patterns only depends on the differences of their samples, so all pattern pairs of one lag are compared at
+    //once. The similarity is symmetric, only pairs with a positive lag are computed.
+    int patterns[2] = {length-dim+1, length-dim};
+    Vector2d similarity(0.0, 0.0);
 
-        }
-
-        VectorXd patternsMean = patterns.colwise().mean();
-        patterns = patterns.rowwise() - patternsMean.transpose(); //check whether correct
-        VectorXd aux;
-        aux.resize(length-m+1);
+    for (int lag = 1; lag < patterns[0]; lag++)
+    {
+        ArrayXd diff = dataNorm.head(length-lag) - dataNorm.tail(length-lag);
 
-        for (int i = 0; i< length-m+1; i++)
+        for (int j = 0; j < 2; j++)
         {
-            MatrixXd column;
-            column.resize(patterns.rows(),patterns.cols());
-            for (int l= 0; l < patterns.cols(); l++)
-                column.col(l) = patterns.col(i);
-
-            VectorXd distance = ((patterns.array()-column.array()).abs()).colwise().maxCoeff();
-                //cout <<  "dist " << i << ": " << distance << "\n";
-            VectorXd similarty = (((-1)*(distance.array().pow(n)))/r).exp();
-                //cout << "simi " << i << ": " << similarty << "\n";
-
-            aux(i) = ((similarty.sum()-1)/(length-m-1));
-
+            if (lag < patterns[j])
+                similarity[j] += similaritySum(diff, dim+j, patterns[j]-lag, r, n);
         }
+    }
 
-        phi[j] = (aux.sum()/(length-m));
+    Vector2d phi;
 
+    for (int j = 0; j < 2; j++)
+    {
+        int m = dim+j;
+        phi[j] = 2*similarity[j]/((length-m-1)*double(length-m));
     }
 
-    fuzzyEn = log(phi[0])-log(phi[1]);
-
+    double fuzzyEn = log(phi[0])-log(phi[1]);
 
     return fuzzyEn;
 
@@ -416,11 +423,106 @@ void CalcMetric::calcKurtosis(int start, int end)
 
 //*************************************************************************************************************
 
-void CalcMetric::calcAll(Eigen::MatrixXd input, int dim, double r, double n)
+CalcMetric::Moments CalcMetric::segmentMoments(const MatrixXd &data)
+{
+    Moments moments;
+    moments.iLength = data.cols();
+    moments.vecMin = data.rowwise().minCoeff();
+    moments.vecMax = data.rowwise().maxCoeff();
+    moments.vecMean = data.rowwise().mean();
+
+    ArrayXXd deviation = (data.colwise() - moments.vecMean).array();
+    ArrayXXd deviationSquared = deviation.square();
+    moments.vecM2 = deviationSquared.rowwise().sum();
+    moments.vecM3 = (deviationSquared*deviation).rowwise().sum();
+    moments.vecM4 = deviationSquared.square().rowwise().sum();
+
+    return moments;
+}
+
+
+//*************************************************************************************************************
+
+CalcMetric::Moments CalcMetric::combineMoments(const Moments &first, const Moments &second)
+{
+    //Pairwise update of the central moments (Pebay 2008)
+    double nA = first.iLength;
+    double nB = second.iLength;
+    double nAB = nA+nB;
+
+    ArrayXd delta = (second.vecMean - first.vecMean).array();
+    ArrayXd deltaSquared = delta.square();
+    ArrayXd m2A = first.vecM2.array();
+    ArrayXd m2B = second.vecM2.array();
+
+    Moments moments;
+    moments.iLength = first.iLength + second.iLength;
+    moments.vecMin = first.vecMin.cwiseMin(second.vecMin);
+    moments.vecMax = first.vecMax.cwiseMax(second.vecMax);
+    moments.vecMean = first.vecMean + (delta*(nB/nAB)).matrix();
+    moments.vecM2 = (m2A + m2B + deltaSquared*(nA*nB/nAB)).matrix();
+    moments.vecM3 = (first.vecM3.array() + second.vecM3.array()
+                     + deltaSquared*delta*(nA*nB*(nA-nB)/(nAB*nAB))
+                     + 3*delta*(nA*m2B - nB*m2A)/nAB).matrix();
+    moments.vecM4 = (first.vecM4.array() + second.vecM4.array()
+                     + deltaSquared.square()*(nA*nB*(nA*nA-nA*nB+nB*nB)/(nAB*nAB*nAB))
+                     + 6*deltaSquared*(nA*nA*m2B + nB*nB*m2A)/(nAB*nAB)
+                     + 4*delta*(nA*second.vecM3.array() - nB*first.vecM3.array())/nAB).matrix();
+
+    return moments;
+}
+
+
+//*************************************************************************************************************
+
+void CalcMetric::calcMoments(bool bSliding)
+{
+    if (m_bSetNewP2P)
+    {
+        m_dmatP2PHistory.col(m_iP2PHistoryPosition) = m_dvecP2P;
+        m_bSetNewP2P = false;
+        m_iP2PHistoryPosition++;
+        if (m_iP2PHistoryPosition>(m_iListLength-1))
+            m_iP2PHistoryPosition = 0;
+    }
+
+    if (m_bSetNewKurtosis)
+    {
+        m_dmatKurtosisHistory.col(m_iKurtosisHistoryPosition) = m_dvecKurtosis;
+        m_bSetNewKurtosis = false;
+        m_iKurtosisHistoryPosition++;
+        if (m_iKurtosisHistoryPosition>(m_iListLength-1))
+            m_iKurtosisHistoryPosition = 0;
+    }
+
+    int firstLength = m_iDataLength/2;
+
+    Moments firstHalf;
+    if (bSliding && m_lastHalfMoments.iLength == firstLength && m_lastHalfMoments.vecMean.rows() == m_iChannelCount)
+        firstHalf = m_lastHalfMoments;
+    else
+        firstHalf = segmentMoments(m_dmatData.leftCols(firstLength));
+
+    m_lastHalfMoments = segmentMoments(m_dmatData.rightCols(m_iDataLength-firstLength));
+
+    Moments window = firstLength > 0 ? combineMoments(firstHalf, m_lastHalfMoments) : m_lastHalfMoments;
+
+    m_dvecP2P = window.vecMax - window.vecMin;
+    m_dvecMean = window.vecMean;
+    m_dvecStdDev = (window.vecM2/(m_iDataLength-1)).cwiseSqrt();
+    m_dvecKurtosis = (m_iDataLength*window.vecM4.array()/window.vecM2.array().square()).matrix();
+
+    m_bSetNewP2P = true;
+    m_bSetNewKurtosis = true;
+}
+
+
+//*************************************************************************************************************
+
+void CalcMetric::calcAll(Eigen::MatrixXd input, int dim, double r, double n, bool bSliding)
 {
     this->setData(input);
-    this->calcP2P();
-    this->calcKurtosis(0,1000);
+    this->calcMoments(bSliding);
     m_lFuzzyEnUsedChs.clear();
 
     if (m_iFuzzyEnStart == m_iFuzzyEnStep-1)
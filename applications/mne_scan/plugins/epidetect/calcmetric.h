@@ -97,8 +97,10 @@ public:
     * @param [in] dim embedding dimension of fuzzy entropy.
     * @param [in] r width of fuzzy exponential function.
     * @param [in] n step of fuzzy exponential function.
+    * @param [in] bSliding true if the first half of input is the second half of the input of the last call. The
+    *                      moments of that half are reused then.
     */
-    void calcAll(Eigen::MatrixXd input, int dim, double r, double n);
+    void calcAll(Eigen::MatrixXd input, int dim, double r, double n, bool bSliding = false);
 
     //=========================================================================================================
     /**
@@ -182,6 +184,51 @@ public:
     int                                     m_iFuzzyEnStep;             /**< Number of channels which are skipped after every calculation of FuzzyEn.*/
 
 private:
+    //=========================================================================================================
+    /**
+    * Per channel extrema and central moments of a segment. Moments of adjacent segments can be combined, so a
+    * sliding window only needs the moments of its new samples.
+    */
+    struct Moments
+    {
+        int                                 iLength;                    /**< Number of samples of the segment, 0 if not set.*/
+        Eigen::VectorXd                     vecMin;                     /**< Minimum of each channel.*/
+        Eigen::VectorXd                     vecMax;                     /**< Maximum of each channel.*/
+        Eigen::VectorXd                     vecMean;                    /**< Mean of each channel.*/
+        Eigen::VectorXd                     vecM2;                      /**< Sum of the squared deviations from the mean.*/
+        Eigen::VectorXd                     vecM3;                      /**< Sum of the cubed deviations from the mean.*/
+        Eigen::VectorXd                     vecM4;                      /**< Sum of the deviations from the mean to the fourth power.*/
+    };
+
+    //=========================================================================================================
+    /**
+    * Calculates peak-to-peak magnitude, mean, standard deviation and kurtosis of all channels from the moments of
+    * the two halves of m_dmatData.
+    *
+    * @param [in] bSliding true if the moments of the first half are those of the cached second half of the last data.
+    */
+    void calcMoments(bool bSliding);
+
+    //=========================================================================================================
+    /**
+    * Calculates the extrema and central moments of a segment in one vectorized pass.
+    *
+    * @param [in] data the segment.
+    * @param [out] returns the moments.
+    */
+    static Moments segmentMoments(const Eigen::MatrixXd &data);
+
+    //=========================================================================================================
+    /**
+    * Combines the moments of two adjacent segments.
+    *
+    * @param [in] first moments of the first segment.
+    * @param [in] second moments of the second segment.
+    * @param [out] returns the moments of the joined segment.
+    */
+    static Moments combineMoments(const Moments &first, const Moments &second);
+
+    Moments                                 m_lastHalfMoments;          /**< The moments of the second half of the last data.*/
 
     Eigen::MatrixXd                         m_dmatData;                 /**< The currently used data-set.*/
     Eigen::Matrix<bool, Eigen::Dynamic, 1>  m_bFuzzyEnCalc;             /**< Contains information for each channel whether or not FuzzyEn has been calculated.*/
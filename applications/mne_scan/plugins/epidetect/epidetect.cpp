@@ -310,6 +310,9 @@ void Epidetect::run()
         timer.start();
         MatrixXd window;
 
+        //The first half of the overlapping window is the second half of the last window
+        bool bSliding = overlap;
+
         if (!overlap)
         {
             firstHalfTrimmed = trimmedData.block(0, 0, trimmedData.rows(), (trimmedData.cols()/2));
@@ -336,7 +339,7 @@ void Epidetect::run()
 
         calculator.m_iListLength = m_iListLength;
         calculator.m_iFuzzyEnStep = m_iFuzzyEnStep;
-        calculator.calcAll(window, m_iDim, m_dR , m_iN);
+        calculator.calcAll(window, m_iDim, m_dR , m_iN, bSliding);
         MatrixXd mu;
         MatrixXd p2pHistory =calculator.getP2PHistory();
         MatrixXd kurtosisHistory = calculator.getKurtosisHistory();
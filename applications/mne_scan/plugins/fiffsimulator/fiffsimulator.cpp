@@ -47,6 +47,7 @@
 #include <fiff/fiff_info.h>
 #include <scMeas/newrealtimemultisamplearray.h>
 #include <scDisp/hpiwidget.h>
+#include <scShared/Management/metricsregistry.h>
 
 
 //*************************************************************************************************************
@@ -170,7 +171,7 @@ bool FiffSimulator::start()
     {
         //Set buffer size
         (*m_pRtCmdClient)["bufsize"].pValues()[0].setValue(m_iBufferSize);
-        (*m_pRtCmdClient)["bufsize"].send();
+        m_pRtCmdClient->postCommandJSON((*m_pRtCmdClient)["bufsize"]);
 
         // Buffer
         m_qMutex.lock();
@@ -266,6 +267,8 @@ void FiffSimulator::run()
         //pop matrix
         matValue = m_pRawMatrixBuffer_In->pop();
 
+        SCSHAREDLIB::MetricsRegistry::setGauge(QString("%1/buffer: fill level").arg(getName()), m_pRawMatrixBuffer_In->fillLevel());
+
         //Update HPI data (for single and continous HPI fitting)
         updateHPI(matValue);
 
@@ -369,21 +372,22 @@ void FiffSimulator::connectCmdClient()
                 requestInfo();
 
             //
-            // Read Connectors
+            // Read Connectors and Buffer Size, both requests are pipelined in one round trip
             //
+            QStringList t_qListReplies = m_pRtCmdClient->sendCommandsJSON(QList<Command>() << (*m_pRtCmdClient)["conlist"]
+                                                                                           << (*m_pRtCmdClient)["getbufsize"]);
+
             if(m_qMapConnectors.size() == 0)
-                m_iActiveConnectorId = m_pRtCmdClient->requestConnectors(m_qMapConnectors);
+                m_iActiveConnectorId = RtCmdClient::parseConnectors(t_qListReplies[0], m_qMapConnectors);
+
+            m_iBufferSize = RtCmdClient::parseBufsize(t_qListReplies[1]);
 
+            //a connector change requests the buffer size of the new connector
             QMap<qint32, QString>::const_iterator it;
             for(it = m_qMapConnectors.begin(); it != m_qMapConnectors.end(); ++it)
                 if(it.value().compare("Fiff File Simulator") == 0 && m_iActiveConnectorId != it.key())
                     changeConnector(it.key());
 
-            //
-            // Read Buffer Size
-            //
-            m_iBufferSize = m_pRtCmdClient->requestBufsize();
-
             emit cmdConnectionChanged(m_bCmdClientIsConnected);
         }
         m_qMutex.unlock();
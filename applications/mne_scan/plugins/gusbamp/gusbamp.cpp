@@ -42,6 +42,8 @@
 #include "gusbamp.h"
 #include "gusbampproducer.h"   
 
+#include <scShared/Management/metricsregistry.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -72,7 +74,6 @@ using namespace std;
 GUSBAmp::GUSBAmp()
 : m_pRTMSA_GUSBAmp(0)
 , m_qStringResourcePath(qApp->applicationDirPath()+"/resources/mne_scan/plugins/gusbamp/")
-, m_pRawMatrixBuffer_In(0)
 , m_pGUSBAmpProducer(new GUSBAmpProducer(this))
 , m_iNumberOfChannels(0)
 , m_iSamplesPerBlock(0)
@@ -247,9 +248,8 @@ bool GUSBAmp::start()
     m_pGUSBAmpProducer->start(m_vSerials, m_viChannelsToAcquire, m_iSampleRate);
 
 
-    //after device was started: ask for size of SampleMatrix to set the buffer matrix (bevor setUpFiffInfo() is started)
+    //after device was started: ask for size of SampleMatrix (bevor setUpFiffInfo() is started), the producer holds the ring buffer of this size
     m_viSizeOfSampleMatrix = m_pGUSBAmpProducer->getSizeOfSampleMatrix();
-    m_pRawMatrixBuffer_In = QSharedPointer<RawMatrixBuffer>(new RawMatrixBuffer(8, m_viSizeOfSampleMatrix[0], m_viSizeOfSampleMatrix[1]));
 
     //set the parameters for number of channels (rows of matrix) and samples (columns of matrix)
     m_iNumberOfChannels = m_viSizeOfSampleMatrix[0];
@@ -288,10 +288,10 @@ bool GUSBAmp::stop()
     //Wait until this thread (GUSBAmp) is stopped
     m_bIsRunning = false;
 
-    //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the pop function (acquire statement)
-    m_pRawMatrixBuffer_In->releaseFromPop();
+    //In case the ring blocks the thread -> Release it and let it exit from the pop function
+    m_pGUSBAmpProducer->releaseFromPop();
 
-    m_pRawMatrixBuffer_In->clear();
+    m_pGUSBAmpProducer->clear();
 
     m_pRTMSA_GUSBAmp->data()->clear();
 
@@ -333,15 +333,15 @@ QWidget* GUSBAmp::setupWidget()
 void GUSBAmp::run()
 {
     qint32 size = 0;
+    MatrixXf matValue;
 
     //get Matrix from the producer
     while(m_bIsRunning)
     {
         //pop matrix only if the producer thread is running
-        if(m_pGUSBAmpProducer->isRunning())
+        if(m_pGUSBAmpProducer->isRunning() && m_pGUSBAmpProducer->pop(matValue))
         {
             //qDebug()<<"GUSBAmp is running";
-            MatrixXf matValue = m_pRawMatrixBuffer_In->pop();
             MatrixXf matValue_show = matValue/1000000; //matvalue for showing
 
             for(int i = 0; i < matValue.cols(); i++){
@@ -356,6 +356,7 @@ void GUSBAmp::run()
             if(m_bWriteToFile)
             {
                 m_pOutfid->write_raw_buffer(matValue.cast<double>(), m_cals);
+                SCSHAREDLIB::MetricsRegistry::addCounter(QString("%1/recording: samples").arg(getName()), matValue.cols());
                 size += matValue.cols();
 
                 //                qDebug()<<"size"<<size;
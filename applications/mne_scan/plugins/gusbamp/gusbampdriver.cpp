@@ -357,8 +357,14 @@ bool GUSBAmpDriver::uninitDevice()
 
 //*************************************************************************************************************
 
-bool GUSBAmpDriver::getSampleMatrixValue(MatrixXf& sampleMatrix)
+bool GUSBAmpDriver::getSampleMatrixValue(Ref<MatrixXf> sampleMatrix)
 {
+    if(sampleMatrix.rows() != m_sizeOfMatrix[0] || sampleMatrix.cols() != m_sizeOfMatrix[1])
+    {
+        cout << "Error on data transfer: the matrix does not fit the size of the sample matrix." << "\n";
+        return 0;
+    }
+
     sampleMatrix.setZero(); // Clear matrix - set all elements to zero
 
     for(int queueIndex=0; queueIndex<m_QUEUE_SIZE; queueIndex++)
@@ -392,25 +398,18 @@ bool GUSBAmpDriver::getSampleMatrixValue(MatrixXf& sampleMatrix)
         //Data is aligned as follows: element at position destBuffer(scanIndex * (m_chNumberOfChannels + m_bTrigger) + channelIndex) * sizeof(float) + HEADER_SIZE is sample of channel channelIndex (zero-based) of the scan with zero-based scanIndex.
         //channelIndex ranges from 0..numDevices*numChannelsPerDevices where numDevices equals the number of recorded devices and numChannelsPerDevice the number of channels from each of those devices.
         //It is assumed that all devices provide the same number of channels.
-        for (int scanIndex = 0; scanIndex < m_iNumberOfScans; scanIndex++)
+        //Each device fills its rows of the scans of this queue, the trigger line is skipped
+        for (int deviceIndex = 0; deviceIndex < m_numDevices; deviceIndex++)
         {
-            for (int deviceIndex = 0; deviceIndex < m_numDevices; deviceIndex++)
-            {
-                for(int channelIndex = 0; channelIndex<m_chNumberOfChannels; channelIndex++)
-                {
-                    BYTE ByteValue[sizeof(float)];
-                    float   FloatValue;
-
-                    for(int i=0;i<sizeof(float);i++)
-                    {
-                        ByteValue[i] = m_buffers[deviceIndex][queueIndex][(scanIndex * (m_chNumberOfChannels + m_bTrigger) + channelIndex) * sizeof(float) + HEADER_SIZE + i];
-                    }
-                    memcpy(&FloatValue, &ByteValue, sizeof(float));
-
-                    //store float-value to Matrix
-                    sampleMatrix(channelIndex + deviceIndex*int(m_chNumberOfChannels), scanIndex + queueIndex * m_iNumberOfScans) = FloatValue;
-                }
-            }
+            float* pTarget = sampleMatrix.data() + deviceIndex*int(m_chNumberOfChannels) + queueIndex*m_iNumberOfScans*sampleMatrix.outerStride();
+
+            GUSBAmpProducer::convertScans<float>(m_buffers[deviceIndex][queueIndex] + HEADER_SIZE,
+                                                 m_chNumberOfChannels + m_bTrigger,
+                                                 m_chNumberOfChannels,
+                                                 m_iNumberOfScans,
+                                                 1.0f,
+                                                 pTarget,
+                                                 sampleMatrix.outerStride());
         }
 
         //add new GetData call to the queue replacing the currently received one
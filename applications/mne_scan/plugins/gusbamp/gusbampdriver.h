@@ -140,12 +140,13 @@ public:
 
     //=========================================================================================================
     /**
-    * Get sample from the device in form of a mtrix.
+    * Get sample from the device in form of a mtrix. The matrix is filled in place and has to be of the size
+    * returned by getSizeOfSampleMatrix().
     * @param [in]   MatrixXf    the block sample values in form of a matrix.
     *
     * @return                   returns true if sample was successfully written to the input variable, false otherwise.
     */
-    bool getSampleMatrixValue(Eigen::MatrixXf& sampleMatrix);
+    bool getSampleMatrixValue(Eigen::Ref<Eigen::MatrixXf> sampleMatrix);
 
     //=========================================================================================================
     /**
@@ -50,7 +50,6 @@
 //=============================================================================================================
 
 using namespace GUSBAMPPLUGIN;
-using namespace IOBUFFER;
 using namespace std;
 
 
@@ -62,10 +61,11 @@ using namespace std;
 GUSBAmpProducer::GUSBAmpProducer(GUSBAmp* pGUSBAmp)
 : m_pGUSBAmp(pGUSBAmp)
 , m_pGUSBAmpDriver(new GUSBAmpDriver(this))
-, m_bIsRunning(true)
 , m_iSampRate(1200)
 , m_sFilePath("data")
 {
+    setObjectName("gUSBAmp");
+
     m_viSizeOfSampleMatrix.resize(2,0);
 
     m_vSerials.resize(1);
@@ -78,6 +78,8 @@ GUSBAmpProducer::GUSBAmpProducer(GUSBAmp* pGUSBAmp)
 GUSBAmpProducer::~GUSBAmpProducer()
 {
     //qDebug() << "GUSBAmpProducer::~GUSBAmpProducer()" << endl;
+    if(this->isRunning())
+        stop();
 }
 
 
@@ -95,10 +97,7 @@ void GUSBAmpProducer::start(vector<QString> &serials, vector<int> channels, int
 
     //Initialise and starting the device
     if(m_pGUSBAmpDriver->initDevice())
-    {
-        m_bIsRunning = true;
-        QThread::start();
-    }
+        startProducer(m_viSizeOfSampleMatrix[0], m_viSizeOfSampleMatrix[1], sampleRate);
     else
         m_bIsRunning = false;
 }
@@ -108,15 +107,8 @@ void GUSBAmpProducer::start(vector<QString> &serials, vector<int> channels, int
 
 void GUSBAmpProducer::stop()
 {
-    //Wait until this thread (GUSBAmpProducer) is stopped
-    m_bIsRunning = false;
-
-    //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the push function (acquire statement)
-    m_pGUSBAmp->m_pRawMatrixBuffer_In->releaseFromPush();
-
-    while(this->isRunning()){
-        m_bIsRunning = false;
-    }
+    //Wait until this thread (GUSBAmpProducer) is stopped, a full ring does not block it
+    stopProducer();
 
     //Unitialise device only after the thread stopped
     m_pGUSBAmpDriver->uninitDevice();
@@ -126,17 +118,10 @@ void GUSBAmpProducer::stop()
 
 //*************************************************************************************************************
 
-void GUSBAmpProducer::run()
+bool GUSBAmpProducer::readBlock(BlockMap& matBlock)
 {
-    MatrixXf matRawBuffer(m_viSizeOfSampleMatrix[0],m_viSizeOfSampleMatrix[1]);
-
-    while(m_bIsRunning)
-    {
-        //qDebug()<<"GUSBAmpProducer::run()"<<endl;
-        //Get the GUSBAmp EEG data out of the device buffer and write received data to circular buffer
-        if(m_pGUSBAmpDriver->getSampleMatrixValue(matRawBuffer))
-            m_pGUSBAmp->m_pRawMatrixBuffer_In->push(&matRawBuffer);
-    }
+    //Get the GUSBAmp EEG data out of the device buffer straight into the ring
+    return m_pGUSBAmpDriver->getSampleMatrixValue(matBlock);
 }
 
 
@@ -44,7 +44,7 @@
 //=============================================================================================================
 
 #include <gusbamp_global.h>
-#include <utils/generics/circularbuffer.h>
+#include <scShared/Management/amplifierproducer.h>
 #include <vector>
 #include <Windows.h>
 
@@ -54,7 +54,6 @@
 // QT INCLUDES
 //=============================================================================================================
 
-#include <QThread>
 #include <QDebug>
 
 
@@ -82,7 +81,7 @@ class GUSBAmpDriver;
 *
 * @brief The EEGProducer class provides a EEG data producer for a given sampling rate.
 */
-class GUSBAMPSHARED_EXPORT GUSBAmpProducer : public QThread
+class GUSBAMPSHARED_EXPORT GUSBAmpProducer : public SCSHAREDLIB::AmplifierProducer<float>
 {
 public:
     //=========================================================================================================
@@ -126,16 +125,17 @@ public:
 protected:
     //=========================================================================================================
     /**
-    * The starting point for the thread. After calling start(), the newly created thread calls this function.
-    * Returning from this method will end the execution of the thread.
-    * Pure virtual method inherited by QThread.
+    * Reads the next block from the device into a slot of the producer's ring.
+    *
+    * @param [out] matBlock     the block to fill.
+    *
+    * @return true if the block was filled.
     */
-    virtual void run();
+    virtual bool readBlock(BlockMap& matBlock);
 
 private:
     GUSBAmp*                        m_pGUSBAmp;            /**< A pointer to the corresponding GUSBAmp class.*/
     QSharedPointer<GUSBAmpDriver>   m_pGUSBAmpDriver;      /**< A pointer to the corresponding GUSBAmp driver class.*/
-    bool                            m_bIsRunning;          /**< Whether GUSBAmpProducer is running.*/
 
     int                 m_iSampRate;            /**< sample rate of the device */
     QString             m_sFilePath;            /**< path of the file of written data */
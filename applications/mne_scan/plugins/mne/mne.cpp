@@ -79,6 +79,8 @@ MNE::MNE()
 , m_iNumAverages(1)
 , m_iDownSample(2)
 , m_sAvrType("1")
+, m_iNumWorkers(qMax(1, QThread::idealThreadCount() / 2))
+, m_iNumSamples(0)
 {
 
 }
@@ -447,22 +449,107 @@ void MNE::updateRTE(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 void MNE::updateInvOp(MNEInverseOperator::SPtr p_pInvOp)
 {
     //qDebug() << "MNE::updateInvOp - START";
-    m_pInvOp = p_pInvOp;
+    //The kernel is prepared in the background by run(), operators which arrive meanwhile replace each other
+    QMutexLocker locker(&m_qMutex);
+    m_pInvOpNew = p_pInvOp;
+}
+
+
+//*************************************************************************************************************
+
+void MNE::setDownSample(qint32 p_iDownSample)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_iDownSample = qMax(1, p_iDownSample);
+}
+
 
+//*************************************************************************************************************
+
+void MNE::setNumWorkers(qint32 p_iNumWorkers)
+{
+    m_iNumWorkers = qMax(1, p_iNumWorkers);
+}
+
+
+//*************************************************************************************************************
+
+MinimumNorm::SPtr MNE::prepareMinimumNorm(MNEInverseOperator::SPtr p_pInvOp, qint32 p_iNumAverages)
+{
     double snr = 3.0;
     double lambda2 = 1.0 / pow(snr, 2); //ToDo estimate lambda using covariance
 
     QString method("dSPM"); //"MNE" | "dSPM" | "sLORETA"
 
-    m_qMutex.lock();
-
-    m_pMinimumNorm = MinimumNorm::SPtr(new MinimumNorm(*m_pInvOp.data(), lambda2, method));
+    MinimumNorm::SPtr t_pMinimumNorm(new MinimumNorm(*p_pInvOp.data(), lambda2, method));
 
     //
     //   Set up the inverse according to the parameters
     //
-    m_pMinimumNorm->doInverseSetup(m_iNumAverages,false);
-    m_qMutex.unlock();
+    t_pMinimumNorm->doInverseSetup(p_iNumAverages,false);
+
+    //Form the kernel now, so the workers only read it
+    t_pMinimumNorm->getKernel();
+
+    return t_pMinimumNorm;
+}
+
+
+//*************************************************************************************************************
+
+MNESourceEstimate MNE::applyInverse(MinimumNorm::SPtr p_pMinimumNorm, MatrixXd p_matData, qint32 p_iFirst, qint32 p_iStep, float p_fTmin, float p_fTstep)
+{
+    if(p_iFirst >= p_matData.cols())
+        return MNESourceEstimate();
+
+    if(p_iFirst == 0 && p_iStep == 1)
+        return p_pMinimumNorm->calculateInverse(p_matData, p_fTmin, p_fTstep);
+
+    //The inverse is linear, so the dropped samples do not need to be mapped
+    qint32 t_iNumUsed = (p_matData.cols() - 1 - p_iFirst) / p_iStep + 1;
+    MatrixXd t_matUsed = Map<const MatrixXd, 0, OuterStride<> >(p_matData.data() + p_iFirst * p_matData.rows(),
+                                                                 p_matData.rows(),
+                                                                 t_iNumUsed,
+                                                                 OuterStride<>(p_iStep * p_matData.rows()));
+
+    return p_pMinimumNorm->calculateInverse(t_matUsed, p_fTmin, p_fTstep);
+}
+
+
+//*************************************************************************************************************
+
+void MNE::queueInverse(const MatrixXd &p_matData, qint32 p_iFirst, qint32 p_iStep, float p_fTmin, float p_fTstep)
+{
+    //Limit the number of queued blocks, so a slow kernel can not pile up data
+    while(m_qListInverseFutures.size() >= 2 * m_qThreadPool.maxThreadCount()) {
+        m_qListInverseFutures.first().waitForFinished();
+        emitFinishedInverses();
+    }
+
+    MinimumNorm::SPtr t_pMinimumNorm = m_pMinimumNorm;
+    m_qListInverseFutures.append(QtConcurrent::run(&m_qThreadPool, [=]() {
+        return applyInverse(t_pMinimumNorm, p_matData, p_iFirst, p_iStep, p_fTmin, p_fTstep);
+    }));
+
+    emitFinishedInverses();
+}
+
+
+//*************************************************************************************************************
+
+void MNE::emitFinishedInverses(bool p_bWait)
+{
+    while(!m_qListInverseFutures.isEmpty()) {
+        if(p_bWait)
+            m_qListInverseFutures.first().waitForFinished();
+        else if(!m_qListInverseFutures.first().isFinished())
+            return;
+
+        MNESourceEstimate sourceEstimate = m_qListInverseFutures.takeFirst().result();
+
+        if(!sourceEstimate.isEmpty())
+            m_pRTSEOutput->data()->setValue(sourceEstimate);
+    }
 }
 
 
@@ -501,6 +588,11 @@ void MNE::run()
     connect(m_pRtInvOp.data(), &RtInvOp::invOperatorCalculated,
             this, &MNE::updateInvOp);
     m_pMinimumNorm.reset();
+    m_pInvOpNew.reset();
+    m_pInvOpPreparing.reset();
+    m_iNumSamples = 0;
+
+    m_qThreadPool.setMaxThreadCount(m_iNumWorkers);
 
     //
     // Start the rt helpers
@@ -512,8 +604,6 @@ void MNE::run()
     //
     m_bProcessData = true;
 
-    qint32 skip_count = 0;
-
 //    //
 //    // TEMP INV LOADING START
 //    //
@@ -554,71 +644,73 @@ void MNE::run()
             m_qMutex.unlock();
         }
 
+        //Swap in a prepared kernel, blocks which are already queued finish with the previous one
+        if(m_pInvOpPreparing && m_futureMinimumNorm.isFinished())
+        {
+            m_pMinimumNorm = m_futureMinimumNorm.result();
+            m_pInvOp = m_pInvOpPreparing;
+            m_pInvOpPreparing.reset();
+        }
+
+        //Prepare the kernel of the latest inverse operator in the background
         m_qMutex.lock();
+        if(m_pInvOpNew && !m_pInvOpPreparing)
+        {
+            m_pInvOpPreparing = m_pInvOpNew;
+            m_pInvOpNew.reset();
+            m_futureMinimumNorm = QtConcurrent::run(&MNE::prepareMinimumNorm, m_pInvOpPreparing, m_iNumAverages);
+        }
         qint32 t_evokedSize = m_qVecFiffEvoked.size();
+        qint32 t_iDownSample = m_iDownSample;
         m_qMutex.unlock();
 
         //Process data raw data from a RTMSA
         if(m_pMatrixDataBuffer)
         {
             //qDebug()<<"MNE::run - Processing RTMSA data";
-            if(m_pMinimumNorm && ((skip_count % m_iDownSample) == 0))
-            {
-                MatrixXd rawSegment = m_pMatrixDataBuffer->pop();
+            MatrixXd rawSegment = m_pMatrixDataBuffer->pop();
 
-                float tmin = 1 / m_pFiffInfo->sfreq;
-                float tstep = 1 / m_pFiffInfo->sfreq;
+            if(m_pMinimumNorm)
+            {
+                //Keep the downsampling phase continuous across blocks
+                qint32 t_iFirst = (t_iDownSample - m_iNumSamples % t_iDownSample) % t_iDownSample;
 
-                m_qMutex.lock();
+                float tmin = ((float)(m_iNumSamples + t_iFirst)) / m_pFiffInfo->sfreq;
+                float tstep = ((float)t_iDownSample) / m_pFiffInfo->sfreq;
 
                 //TODO: Add picking here. See evoked part as input.
-                MNESourceEstimate sourceEstimate = m_pMinimumNorm->calculateInverse(rawSegment, tmin, tstep);
-
-                m_qMutex.unlock();
-
-                m_pRTSEOutput->data()->setValue(sourceEstimate);
-            }
-            else
-            {
-                m_qMutex.lock();
-                m_qVecFiffEvoked.pop_front();
-                m_qMutex.unlock();
+                queueInverse(rawSegment, t_iFirst, t_iDownSample, tmin, tstep);
             }
-            ++skip_count;
+
+            m_iNumSamples += rawSegment.cols();
         }
 
         //Process data from averaging
         if(t_evokedSize > 0)
         {
             //qDebug() << "MNE::run - Processing RTE data - t_evokedSize" << t_evokedSize;
-            if(m_pMinimumNorm && ((skip_count % m_iDownSample) == 0))
-            {
-                m_qMutex.lock();
-                FiffEvoked t_fiffEvoked = m_qVecFiffEvoked[0];
-                //qDebug()<<"MNE::run - t_fiffEvoked.data.rows()"<<t_fiffEvoked.data.rows();
-                m_qVecFiffEvoked.pop_front();
-                m_qMutex.unlock();
+            m_qMutex.lock();
+            FiffEvoked t_fiffEvoked = m_qVecFiffEvoked[0];
+            //qDebug()<<"MNE::run - t_fiffEvoked.data.rows()"<<t_fiffEvoked.data.rows();
+            m_qVecFiffEvoked.pop_front();
+            m_qMutex.unlock();
 
+            if(m_pMinimumNorm)
+            {
                 float tmin = ((float)t_fiffEvoked.first) / t_fiffEvoked.info.sfreq;
-                float tstep = 1/t_fiffEvoked.info.sfreq;
-
-                m_qMutex.lock();
+                float tstep = ((float)t_iDownSample) / t_fiffEvoked.info.sfreq;
 
                 t_fiffEvoked = t_fiffEvoked.pick_channels(m_pInvOp->noise_cov->names);
 
-                MNESourceEstimate sourceEstimate = m_pMinimumNorm->calculateInverse(t_fiffEvoked.data, tmin, tstep);
-
-                m_qMutex.unlock();
-
-                m_pRTSEOutput->data()->setValue(sourceEstimate);
+                queueInverse(t_fiffEvoked.data, 0, t_iDownSample, tmin, tstep);
             }
-            else
-            {
-                m_qMutex.lock();
-                m_qVecFiffEvoked.pop_front();
-                m_qMutex.unlock();
-            }
-            ++skip_count;
         }
+
+        emitFinishedInverses();
     }
+
+    emitFinishedInverses(true);
+
+    if(m_pInvOpPreparing)
+        m_futureMinimumNorm.waitForFinished();
 }
@@ -69,6 +69,8 @@
 
 #include <QtWidgets>
 #include <QFile>
+#include <QFuture>
+#include <QThreadPool>
 
 
 //*************************************************************************************************************
@@ -191,6 +193,30 @@ public:
     */
     void updateInvOp(MNEInverseOperator::SPtr p_pInvOp);
 
+    //=========================================================================================================
+    /**
+    * Sets the source level downsampling. Only every p_iDownSample-th sample of the incoming data is mapped to the
+    * source space. Since the inverse is linear, the samples are dropped before the kernel is applied.
+    *
+    * The value stays a reduction factor and not a target sampling rate: the source estimates are emitted at
+    * sfreq/p_iDownSample. Earlier versions applied the same factor to whole blocks, i.e. only every
+    * p_iDownSample-th block was mapped. The amount of mapped data is the same, but the source estimates are now
+    * evenly spaced in time instead of having gaps of whole blocks. The value is not stored in the settings, so
+    * there is nothing to migrate.
+    *
+    * @param[in] p_iDownSample  The downsampling factor, 1 keeps all samples. Default is 2.
+    */
+    void setDownSample(qint32 p_iDownSample);
+
+    //=========================================================================================================
+    /**
+    * Sets the number of worker threads which apply the inverse kernel to the incoming blocks. Takes effect with
+    * the next start.
+    *
+    * @param[in] p_iNumWorkers  The number of worker threads.
+    */
+    void setNumWorkers(qint32 p_iNumWorkers);
+
 signals:
     //=========================================================================================================
     /**
@@ -208,6 +234,54 @@ protected:
     virtual void run();
 
 private:
+    //=========================================================================================================
+    /**
+    * Prepares a minimum norm estimation for an inverse operator. Runs in the background, so the current kernel is
+    * applied until the new one is ready.
+    *
+    * @param[in] p_pInvOp       The inverse operator.
+    * @param[in] p_iNumAverages The number of averages.
+    *
+    * @return the prepared minimum norm estimation.
+    */
+    static MinimumNorm::SPtr prepareMinimumNorm(MNEInverseOperator::SPtr p_pInvOp, qint32 p_iNumAverages);
+
+    //=========================================================================================================
+    /**
+    * Applies a prepared minimum norm estimation to every p_iStep-th sample of a data block, starting at sample
+    * p_iFirst. Is called by the workers, each keeps its own reference to the kernel it started with.
+    *
+    * @param[in] p_pMinimumNorm The prepared minimum norm estimation.
+    * @param[in] p_matData      The data block.
+    * @param[in] p_iFirst       First sample to use.
+    * @param[in] p_iStep        Step between the used samples.
+    * @param[in] p_fTmin        Time of the first used sample.
+    * @param[in] p_fTstep       Time between the used samples.
+    *
+    * @return the source estimate, empty if no sample is used.
+    */
+    static MNESourceEstimate applyInverse(MinimumNorm::SPtr p_pMinimumNorm, MatrixXd p_matData, qint32 p_iFirst, qint32 p_iStep, float p_fTmin, float p_fTstep);
+
+    //=========================================================================================================
+    /**
+    * Queues a data block for the workers. Finished source estimates are emitted in the order of their blocks.
+    *
+    * @param[in] p_matData      The data block.
+    * @param[in] p_iFirst       First sample to use.
+    * @param[in] p_iStep        Step between the used samples.
+    * @param[in] p_fTmin        Time of the first used sample.
+    * @param[in] p_fTstep       Time between the used samples.
+    */
+    void queueInverse(const MatrixXd &p_matData, qint32 p_iFirst, qint32 p_iStep, float p_fTmin, float p_fTstep);
+
+    //=========================================================================================================
+    /**
+    * Emits the finished source estimates in order.
+    *
+    * @param[in] p_bWait    Wait for all queued blocks.
+    */
+    void emitFinishedInverses(bool p_bWait = false);
+
     PluginInputData<NewRealTimeMultiSampleArray>::SPtr      m_pRTMSAInput;          /**< The RealTimeMultiSampleArray input.*/
     PluginInputData<RealTimeEvokedSet>::SPtr                m_pRTESInput;            /**< The RealTimeEvoked input.*/
     PluginInputData<RealTimeCov>::SPtr                      m_pRTCInput;            /**< The RealTimeCov input.*/
@@ -250,7 +324,16 @@ private:
     MNEInverseOperator::SPtr    m_pInvOp;           /**< The inverse operator. */
 
     MinimumNorm::SPtr           m_pMinimumNorm;     /**< Minimum Norm Estimation. */
-    qint32                      m_iDownSample;      /**< Sampling rate */
+    qint32                      m_iDownSample;      /**< Source level downsampling factor, every m_iDownSample-th sample is mapped. This was a block skipping factor before, see setDownSample(). */
+
+    MNEInverseOperator::SPtr    m_pInvOpNew;        /**< The latest inverse operator, not yet in preparation. */
+    MNEInverseOperator::SPtr    m_pInvOpPreparing;  /**< The inverse operator in preparation. */
+    QFuture<MinimumNorm::SPtr>  m_futureMinimumNorm;/**< The minimum norm estimation in preparation. */
+
+    QThreadPool                 m_qThreadPool;      /**< The workers which apply the inverse kernel. */
+    qint32                      m_iNumWorkers;      /**< Number of workers. */
+    QList<QFuture<MNESourceEstimate> > m_qListInverseFutures; /**< Queued blocks, in order. */
+    qint64                      m_iNumSamples;      /**< Number of raw samples received so far. */
 
     QString                     m_sAvrType;         /**< The average type */
 
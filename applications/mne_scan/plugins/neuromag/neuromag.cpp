@@ -239,21 +239,22 @@ void Neuromag::connectCmdClient()
             //    readProjectors();
 
             //
-            // Read Connectors
+            // Read Connectors and Buffer Size, both requests are pipelined in one round trip
             //
+            QStringList t_qListReplies = m_pRtCmdClient->sendCommandsJSON(QList<Command>() << (*m_pRtCmdClient)["conlist"]
+                                                                                           << (*m_pRtCmdClient)["getbufsize"]);
+
             if(m_qMapConnectors.size() == 0)
-                m_iActiveConnectorId = m_pRtCmdClient->requestConnectors(m_qMapConnectors);
+                m_iActiveConnectorId = RtCmdClient::parseConnectors(t_qListReplies[0], m_qMapConnectors);
+
+            m_iBufferSize = RtCmdClient::parseBufsize(t_qListReplies[1]);
 
+            //a connector change requests the buffer size of the new connector
             QMap<qint32, QString>::const_iterator it;
             for(it = m_qMapConnectors.begin(); it != m_qMapConnectors.end(); ++it)
                 if(it.value().compare("Neuromag Connector") == 0 && m_iActiveConnectorId != it.key())
                     changeConnector(it.key());
 
-            //
-            // Read Buffer Size
-            //
-            m_iBufferSize = m_pRtCmdClient->requestBufsize();
-
             emit cmdConnectionChanged(m_bCmdClientIsConnected);
         }
         rtServerMutex.unlock();
@@ -314,7 +315,7 @@ bool Neuromag::start()
 
         //Set buffer size
         (*m_pRtCmdClient)["bufsize"].pValues()[0].setValue(m_iBufferSize);
-        (*m_pRtCmdClient)["bufsize"].send();
+        m_pRtCmdClient->postCommandJSON((*m_pRtCmdClient)["bufsize"]);
 
         // Buffer
         m_pRawMatrixBuffer_In = QSharedPointer<RawMatrixBuffer>(new RawMatrixBuffer(8,m_pFiffInfo->nchan,m_iBufferSize));
@@ -62,6 +62,7 @@ NoiseReductionOptionsWidget::NoiseReductionOptionsWidget(NoiseReduction* toolbox
 , m_pNoiseReductionToolbox(toolbox)
 , m_enableDisableProjectors(Q_NULLPTR)
 , m_pShowFilterOptions(Q_NULLPTR)
+, m_pSinglePrecision(Q_NULLPTR)
 , m_pCompSignalMapper(Q_NULLPTR)
 {
     this->setWindowTitle("Noise reduction options");
@@ -194,6 +195,14 @@ void NoiseReductionOptionsWidget::filterGroupChanged(QList<QCheckBox*> list)
         topLayout->addWidget(m_qFilterListCheckBox[u], u, 0);
     }
 
+    //Add check box for the precision of the filter
+    m_pSinglePrecision = new QCheckBox("Filter in single precision");
+    m_pSinglePrecision->setChecked(m_pNoiseReductionToolbox->singlePrecision());
+    connect(m_pSinglePrecision, &QCheckBox::toggled,
+            m_pNoiseReductionToolbox, &NoiseReduction::setSinglePrecision);
+
+    topLayout->addWidget(m_pSinglePrecision, u, 0);
+
     //Add push button for filter options
     m_pShowFilterOptions = new QPushButton();
 //        m_pShowFilterOptions->setText("Open Filter options");
@@ -188,6 +188,7 @@ private:
 
     QCheckBox *                             m_enableDisableProjectors;      /**< Holds the enable disable all check box. */
     QPushButton*                            m_pShowFilterOptions;           /**< Holds the show filter options button. */
+    QCheckBox*                              m_pSinglePrecision;             /**< Holds the single precision filter check box. */
 
     QSignalMapper*                          m_pCompSignalMapper;            /**< The signal mapper. */
 
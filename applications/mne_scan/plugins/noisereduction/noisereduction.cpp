@@ -40,6 +40,9 @@
 
 #include "noisereduction.h"
 
+#include <scMeas/latencymonitor.h>
+#include <scShared/Management/metricsregistry.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -65,12 +68,18 @@ NoiseReduction::NoiseReduction()
 : m_bIsRunning(false)
 , m_pNoiseReductionInput(NULL)
 , m_pNoiseReductionOutput(NULL)
-, m_pNoiseReductionBuffer(CircularMatrixBuffer<double>::SPtr())
+, m_pNoiseReductionBuffer(LockFreeMatrixBuffer<double>::SPtr())
 , m_iMaxFilterTapSize(0)
 , m_bSpharaActive(false)
 , m_bFilterActivated(false)
 , m_bProjActivated(false)
 , m_bCompActivated(false)
+, m_bOperatorDirty(true)
+#ifdef MNE_RT_FLOAT
+, m_bSinglePrecision(true)
+#else
+, m_bSinglePrecision(false)
+#endif
 , m_sCurrentSystem("VectorView")
 , m_pRTMSA(NewRealTimeMultiSampleArray::SPtr(new NewRealTimeMultiSampleArray()))
 , m_pFilterWindow(Q_NULLPTR)
@@ -129,6 +138,8 @@ NoiseReduction::~NoiseReduction()
             settings.setValue(QString("RTNRW/%1/filterUserDesignActive").arg(t_sRTMSAName), m_pFilterWindow->userDesignedFiltersIsActive());
             settings.setValue(QString("RTNRW/%1/filterChannelType").arg(t_sRTMSAName), m_pFilterWindow->getChannelType());
         }
+
+        settings.setValue(QString("RTNRW/%1/singlePrecision").arg(t_sRTMSAName), m_bSinglePrecision);
     }
 }
 
@@ -162,7 +173,7 @@ void NoiseReduction::init()
 
     //Delete Buffer - will be initailzed with first incoming data
     if(!m_pNoiseReductionBuffer.isNull())
-        m_pNoiseReductionBuffer = CircularMatrixBuffer<double>::SPtr();
+        m_pNoiseReductionBuffer = LockFreeMatrixBuffer<double>::SPtr();
 
     //Handle projections
     connect(m_pOptionsWidget.data(), &NoiseReductionOptionsWidget::projSelectionChanged,
@@ -210,6 +221,10 @@ bool NoiseReduction::stop()
 
     m_pNoiseReductionBuffer->clear();
 
+    m_qMutexTimestamps.lock();
+    m_qQueueTimestamps.clear();
+    m_qMutexTimestamps.unlock();
+
     return true;
 }
 
@@ -250,7 +265,7 @@ void NoiseReduction::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
     if(m_pRTMSA) {
         //Check if buffer initialized
         if(!m_pNoiseReductionBuffer) {
-            m_pNoiseReductionBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, m_pRTMSA->getNumChannels(), m_pRTMSA->getMultiSampleArray()[0].cols()));
+            m_pNoiseReductionBuffer = LockFreeMatrixBuffer<double>::SPtr(new LockFreeMatrixBuffer<double>(64, m_pRTMSA->getNumChannels(), m_pRTMSA->getMultiSampleArray()[0].cols()));
         }
 
         //Fiff information
@@ -261,13 +276,11 @@ void NoiseReduction::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
             m_matSparseProjMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
             m_matSparseCompMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
             m_matSparseSpharaMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
-            m_matSparseProjCompMult = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
             m_matSparseFull = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
 
             m_matSparseProjMult.setIdentity();
             m_matSparseCompMult.setIdentity();
             m_matSparseSpharaMult.setIdentity();
-            m_matSparseProjCompMult.setIdentity();
             m_matSparseFull.setIdentity();
 
             m_pOptionsWidget->setFiffInfo(m_pFiffInfo);
@@ -282,11 +295,25 @@ void NoiseReduction::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
             initFilter();
         }
 
-        MatrixXd t_mat;
-
+        //Write the incoming blocks directly into the ring
         for(unsigned char i = 0; i < m_pRTMSA->getMultiArraySize(); ++i) {
-            t_mat = m_pRTMSA->getMultiSampleArray()[i];
-            m_pNoiseReductionBuffer->push(&t_mat);
+            const MatrixXd& t_mat = m_pRTMSA->getMultiSampleArray()[i];
+
+            if(t_mat.rows() != (int)m_pNoiseReductionBuffer->rows() || t_mat.cols() != (int)m_pNoiseReductionBuffer->cols()) {
+                qWarning() << "NoiseReduction::update - Block dimension does not match the buffer, skipping block";
+                continue;
+            }
+
+            if(double* pSlot = m_pNoiseReductionBuffer->claimPushSlot()) {
+                Map<MatrixXd>(pSlot, t_mat.rows(), t_mat.cols()) = t_mat;
+
+                //Keep the timestamp next to the block, so the output can be stamped with the input's entry time
+                m_qMutexTimestamps.lock();
+                m_qQueueTimestamps.enqueue(m_pRTMSA->getTimestamps().value(i, -1));
+                m_qMutexTimestamps.unlock();
+
+                m_pNoiseReductionBuffer->commitPushSlot();
+            }
         }
     }
 }
@@ -309,10 +336,33 @@ void NoiseReduction::setSpharaMode(bool state)
 {
     m_mutex.lock();
     m_bSpharaActive = state;
+    m_bOperatorDirty = true;
     m_mutex.unlock();
 }
 
 
+//*************************************************************************************************************
+
+void NoiseReduction::setSinglePrecision(bool state)
+{
+    m_mutex.lock();
+    m_bSinglePrecision = state;
+
+    //Drop the history of the other precision, so it does not leak into the stream when switching back
+    m_pRtFilter = RtFilter::SPtr(new RtFilter());
+    m_pRtFilterFloat = RtFilterF::SPtr(new RtFilterF());
+    m_mutex.unlock();
+}
+
+
+//*************************************************************************************************************
+
+bool NoiseReduction::singlePrecision() const
+{
+    return m_bSinglePrecision;
+}
+
+
 //*************************************************************************************************************
 
 void NoiseReduction::setSpharaNBaseFcts(int nBaseFctsGrad, int nBaseFctsMag)
@@ -385,10 +435,7 @@ void NoiseReduction::updateProjection()
         if(tripletList.size() > 0)
             m_matSparseProjMult.setFromTriplets(tripletList.begin(), tripletList.end());
 
-        //Create full multiplication matrix
-        m_matSparseProjCompMult = m_matSparseProjMult * m_matSparseCompMult;
-
-        m_matSparseFull = m_matSparseProjMult * m_matSparseCompMult;
+        m_bOperatorDirty = true;
         m_mutex.unlock();
     }
 }
@@ -444,10 +491,7 @@ void NoiseReduction::updateCompensator(int to)
             m_matSparseCompMult.setFromTriplets(tripletList.begin(), tripletList.end());
         }
 
-        //Create full multiplication matrix
-        m_matSparseProjCompMult = m_matSparseProjMult * m_matSparseCompMult;
-
-        m_matSparseFull = m_matSparseProjMult * m_matSparseCompMult;
+        m_bOperatorDirty = true;
     }
 }
 
@@ -474,6 +518,8 @@ void NoiseReduction::setFilterChannelType(QString sType)
             }
         }
     }
+
+    m_bOperatorDirty = true;
 }
 
 
@@ -496,7 +542,10 @@ void NoiseReduction::filterChanged(QList<FilterData> filterData)
 
 void NoiseReduction::filterActivated(bool state)
 {
+    m_mutex.lock();
     m_bFilterActivated = state;
+    m_bOperatorDirty = true;
+    m_mutex.unlock();
 }
 
 
@@ -593,15 +642,18 @@ void NoiseReduction::initFilter()
     connect(m_pOptionsWidget.data(), &NoiseReductionOptionsWidget::showFilterOptions,
             this, &NoiseReduction::showFilterWidget);
 
+    //Set stored filter settings from last session, the precision is the build default until it was chosen for this pipeline
+    QString t_sRTMSAName = m_pRTMSA->getName();
+    QSettings settings;
+    m_bSinglePrecision = settings.value(QString("RTNRW/%1/singlePrecision").arg(t_sRTMSAName), m_bSinglePrecision).toBool();
+
     m_pOptionsWidget->filterGroupChanged(m_pFilterWindow->getActivationCheckBoxList());
 
     m_pRtFilter = RtFilter::SPtr(new RtFilter());
+    m_pRtFilterFloat = RtFilterF::SPtr(new RtFilterF());
 
     this->setFilterChannelType("MEG");
 
-    //Set stored filter settings from last session
-    QString t_sRTMSAName = m_pRTMSA->getName();
-    QSettings settings;
     m_pFilterWindow->setFilterParameters(settings.value(QString("RTNRW/%1/filterHP").arg(t_sRTMSAName), 5.0).toDouble(),
                                             settings.value(QString("RTNRW/%1/filterLP").arg(t_sRTMSAName), 40.0).toDouble(),
                                             settings.value(QString("RTNRW/%1/filterOrder").arg(t_sRTMSAName), 128).toInt(),
@@ -706,12 +758,138 @@ void NoiseReduction::createSpharaOperator()
     //Create full multiplication matrix
     m_matSparseSpharaMult = matSparseSpharaMultFirst * matSparseSpharaMultSecond;
 
-    m_matSparseFull = m_matSparseProjMult * m_matSparseCompMult;
+    m_bOperatorDirty = true;
 
     m_mutex.unlock();
 }
 
 
+//*************************************************************************************************************
+
+void NoiseReduction::updateOperator()
+{
+    qint32 nchan = this->m_pFiffInfo->nchan;
+
+    SparseMatrix<double> matIdentity(nchan, nchan);
+    matIdentity.setIdentity();
+
+    //Compensator and SSP projector are always applied before the filter
+    SparseMatrix<double> matPre = matIdentity;
+
+    if(m_bCompActivated && m_matSparseCompMult.rows() == nchan && m_matSparseCompMult.cols() == nchan) {
+        matPre = m_matSparseCompMult;
+    }
+
+    if(m_bProjActivated && m_matSparseProjMult.rows() == nchan && m_matSparseProjMult.cols() == nchan) {
+        matPre = m_matSparseProjMult * matPre;
+    }
+
+    SparseMatrix<double> matPost = matIdentity;
+
+    if(m_bSpharaActive && m_matSparseSpharaMult.rows() == nchan && m_matSparseSpharaMult.cols() == nchan) {
+        //Set bad channels to zero so they do not get smeared into
+        SparseMatrix<double> matBads = matIdentity;
+        for(int i = 0; i < m_pFiffInfo->bads.size(); ++i) {
+            int index = m_pFiffInfo->ch_names.indexOf(m_pFiffInfo->bads.at(i));
+            if(index >= 0 && index < nchan) {
+                matBads.coeffRef(index, index) = 0.0;
+            }
+        }
+        matBads.prune(0.0);
+
+        matPost = m_matSparseSpharaMult * matBads;
+    }
+
+    //SPHARA commutes with the filter if it only mixes channels which are either both filtered or both unfiltered,
+    //since unfiltered channels are delayed by the filter delay
+    bool bCommutes = true;
+
+    if(m_bFilterActivated) {
+        VectorXi vecFiltered = VectorXi::Zero(nchan);
+        for(int i = 0; i < m_lFilterChannelList.size(); ++i) {
+            if(m_lFilterChannelList.at(i) < nchan) {
+                vecFiltered(m_lFilterChannelList.at(i)) = 1;
+            }
+        }
+
+        for(int k = 0; k < matPost.outerSize() && bCommutes; ++k) {
+            for(SparseMatrix<double>::InnerIterator it(matPost, k); it; ++it) {
+                if(vecFiltered(it.row()) != vecFiltered(it.col())) {
+                    bCommutes = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    if(bCommutes) {
+        matPre = matPost * matPre;
+        matPost = matIdentity;
+    }
+
+    m_matSparseFull = matPost * matPre;
+
+    compactOperator(matPre, m_matSparsePreFilter, m_vecPreFilterRows);
+    compactOperator(matPost, m_matSparsePostFilter, m_vecPostFilterRows);
+
+    m_lOperatorBads = m_pFiffInfo->bads;
+    m_bOperatorDirty = false;
+}
+
+
+//*************************************************************************************************************
+
+void NoiseReduction::applyOperator(const SparseMatrix<double>& matOp, const VectorXi& vecRows, MatrixXd& matData)
+{
+    if(vecRows.size() == 0 || matOp.cols() != matData.rows()) {
+        return;
+    }
+
+    //Rows which equal the identity are left untouched
+    m_matOperatorWorkspace.noalias() = matOp * matData;
+
+    for(int i = 0; i < vecRows.size(); ++i) {
+        matData.row(vecRows(i)) = m_matOperatorWorkspace.row(i);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void NoiseReduction::compactOperator(const SparseMatrix<double>& matOp, SparseMatrix<double>& matCompact, VectorXi& vecRows)
+{
+    SparseMatrix<double, RowMajor> matRowMajor = matOp;
+
+    typedef Eigen::Triplet<double> T;
+    std::vector<T> tripletList;
+    tripletList.reserve(matRowMajor.nonZeros());
+
+    vecRows.resize(matRowMajor.rows());
+    int iNumRows = 0;
+
+    for(int r = 0; r < matRowMajor.outerSize(); ++r) {
+        bool bIdentity = matRowMajor.innerVector(r).nonZeros() == 1;
+        for(SparseMatrix<double, RowMajor>::InnerIterator it(matRowMajor, r); it && bIdentity; ++it) {
+            bIdentity = it.col() == r && it.value() == 1.0;
+        }
+
+        if(!bIdentity) {
+            for(SparseMatrix<double, RowMajor>::InnerIterator it(matRowMajor, r); it; ++it) {
+                tripletList.push_back(T(iNumRows, it.col(), it.value()));
+            }
+            vecRows(iNumRows++) = r;
+        }
+    }
+
+    vecRows.conservativeResize(iNumRows);
+
+    matCompact = SparseMatrix<double>(iNumRows, matRowMajor.cols());
+    if(tripletList.size() > 0) {
+        matCompact.setFromTriplets(tripletList.begin(), tripletList.end());
+    }
+}
+
+
 //*************************************************************************************************************
 
 void NoiseReduction::run()
@@ -730,49 +908,52 @@ void NoiseReduction::run()
     initSphara();
     createSpharaOperator();
 
+    MatrixXd t_mat;
+    qint64 iTimestamp;
+
     while(m_bIsRunning)
     {
         //Dispatch the inputs
-        MatrixXd t_mat = m_pNoiseReductionBuffer->pop();
+        if(!m_pNoiseReductionBuffer->pop(t_mat))
+            continue;
+
+        m_qMutexTimestamps.lock();
+        iTimestamp = m_qQueueTimestamps.isEmpty() ? -1 : m_qQueueTimestamps.dequeue();
+        m_qMutexTimestamps.unlock();
+
+        qint64 iStart = SCMEASLIB::LatencyMonitor::now();
 
         m_mutex.lock();
 
-        //Do SSP's and compensators here
-        if(m_bCompActivated) {
-            if(m_bProjActivated) {
-                //Comp + Proj
-                t_mat = m_matSparseProjCompMult * t_mat;
-            } else {
-                //Comp
-                t_mat = m_matSparseCompMult * t_mat;
-            }
-        } else {
-            if(m_bProjActivated) {
-                //Proj
-                t_mat = m_matSparseProjMult * t_mat;
-            } else {
-                //None - Raw
-            }
+        if(m_bOperatorDirty || m_lOperatorBads != m_pFiffInfo->bads) {
+            updateOperator();
         }
 
+        //Do compensators, SSP's and, if possible, SPHARA here in one pass
+        applyOperator(m_matSparsePreFilter, m_vecPreFilterRows, t_mat);
+
         //Do temporal filtering here
         if(m_bFilterActivated) {
-            t_mat = m_pRtFilter->filterChannelsConcurrently(t_mat, m_iMaxFilterLength, m_lFilterChannelList, m_filterData);
+            if(m_bSinglePrecision) {
+                //The copies keep their storage between blocks of the same dimension
+                m_matBlockFloat = t_mat.cast<float>();
+                if(m_pRtFilterFloat->filterChannelsConcurrently(m_matBlockFloat, m_matFilteredFloat, m_lFilterChannelList, m_filterData)) {
+                    t_mat = m_matFilteredFloat.cast<double>();
+                }
+            } else {
+                //The output matrix is swapped with the block, so both keep their storage
+                if(m_pRtFilter->filterChannelsConcurrently(t_mat, m_matFiltered, m_lFilterChannelList, m_filterData)) {
+                    t_mat.swap(m_matFiltered);
+                }
+            }
         }
 
 //        qDebug()<<"t_mat dim:"<<t_mat.rows()<<"x"<<t_mat.cols();
 //        qDebug()<<"m_lFilterChannelList.size():"<<m_lFilterChannelList.size();
 //        qDebug()<<"m_filterData.size():"<<m_filterData.size();
 
-        //Do SPHARA here
-        if(m_bSpharaActive) {
-            //Set bad channels to zero so they do not get smeared into
-            for(int i = 0; i < m_pFiffInfo->bads.size(); ++i) {
-                t_mat.row(m_pFiffInfo->ch_names.indexOf(m_pFiffInfo->bads.at(i))).setZero();
-            }
-
-            t_mat = m_matSparseSpharaMult * t_mat;
-        }
+        //Do SPHARA here if it mixes filtered and unfiltered channels
+        applyOperator(m_matSparsePostFilter, m_vecPostFilterRows, t_mat);
 
 //        //Common average
 //        MatrixXd commonAvr = MatrixXd(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
@@ -798,7 +979,9 @@ void NoiseReduction::run()
 
         m_mutex.unlock();
 
+        SCSHAREDLIB::MetricsRegistry::recordDuration(QString("%1/processing time").arg(getName()), SCMEASLIB::LatencyMonitor::now() - iStart);
+
         //Send the data to the connected plugins and the online display
-        m_pNoiseReductionOutput->data()->setValue(t_mat);
+        m_pNoiseReductionOutput->data()->setValue(t_mat, iTimestamp);
     }
 }
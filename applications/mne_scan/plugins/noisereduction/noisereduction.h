@@ -53,7 +53,7 @@
 
 #include <realtime/rtProcessing/rtfilter.h>
 
-#include <utils/generics/circularmatrixbuffer.h>
+#include <utils/generics/lockfreematrixbuffer.h>
 
 #include <scMeas/newrealtimemultisamplearray.h>
 
@@ -71,6 +71,7 @@
 #include <QDebug>
 #include <QSettings>
 #include <QElapsedTimer>
+#include <QQueue>
 
 
 //*************************************************************************************************************
@@ -153,6 +154,14 @@ public:
     */
     void update(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
 
+    //=========================================================================================================
+    /**
+    * Returns whether the temporal filter of this pipeline runs in single precision.
+    *
+    * @return true for single precision, false for double precision.
+    */
+    bool singlePrecision() const;
+
 public slots:
     //=========================================================================================================
     /**
@@ -179,6 +188,15 @@ public slots:
     */
     void setSpharaNBaseFcts(int nBaseFctsGrad, int nBaseFctsMag);
 
+    //=========================================================================================================
+    /**
+    * Set whether the temporal filter of this pipeline runs in single precision. The filter is prepared again
+    * with the next block.
+    *
+    * @param[in] state    True for single precision, false for double precision.
+    */
+    void setSinglePrecision(bool state);
+
 protected slots:
     //=========================================================================================================
     /**
@@ -249,6 +267,34 @@ protected:
     */
     void createSpharaOperator();
 
+    //=========================================================================================================
+    /**
+    * Fuses compensator, SSP projector and SPHARA operator to the operators which are applied before and after the
+    * temporal filter. SPHARA is moved in front of the filter, i.e. all three are applied in one pass, as long as it
+    * only mixes channels which are treated alike by the filter. Has to be called with m_mutex locked.
+    */
+    void updateOperator();
+
+    //=========================================================================================================
+    /**
+    * Applies a fused operator to the rows of the data it changes.
+    *
+    * @param[in] matOp      The operator restricted to the changed rows, see compactOperator.
+    * @param[in] vecRows    The indices of the changed rows.
+    * @param[in, out] matData   The data.
+    */
+    void applyOperator(const Eigen::SparseMatrix<double>& matOp, const Eigen::VectorXi& vecRows, Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+    * Restricts an operator to its rows which differ from the identity.
+    *
+    * @param[in] matOp          The full operator.
+    * @param[out] matCompact    The rows of the operator which differ from the identity.
+    * @param[out] vecRows       The indices of these rows.
+    */
+    static void compactOperator(const Eigen::SparseMatrix<double>& matOp, Eigen::SparseMatrix<double>& matCompact, Eigen::VectorXi& vecRows);
+
     //=========================================================================================================
     /**
     * IAlgorithm function
@@ -263,6 +309,8 @@ private:
     bool                            m_bSpharaActive;                            /**< Flag whether thread is running.*/
     bool                            m_bProjActivated;                           /**< Projections activated */
     bool                            m_bFilterActivated;                         /**< Projections activated */
+    bool                            m_bOperatorDirty;                           /**< Whether a setting changed since the operators were fused */
+    bool                            m_bSinglePrecision;                         /**< Whether the temporal filter runs in single precision */
 
     int                             m_iNBaseFctsFirst;                          /**< The number of grad/inner base functions to use for calculating the sphara opreator.*/
     int                             m_iNBaseFctsSecond;                         /**< The number of grad/outer base functions to use for calculating the sphara opreator.*/
@@ -282,10 +330,21 @@ private:
     Eigen::VectorXi                 m_vecIndicesFirstEEG;                       /**< The indices of the channels to pick for the second SPHARA operator in case of an EEG system.*/
 
     Eigen::SparseMatrix<double>     m_matSparseSpharaMult;                      /**< The final sparse SPHARA operator .*/
-    Eigen::SparseMatrix<double>     m_matSparseProjCompMult;                    /**< The final sparse projection + compensator operator.*/
     Eigen::SparseMatrix<double>     m_matSparseProjMult;                        /**< The final sparse SSP projector */
     Eigen::SparseMatrix<double>     m_matSparseCompMult;                        /**< The final sparse compensator matrix */
     Eigen::SparseMatrix<double>     m_matSparseFull;                            /**< The final sparse full multiplication matrix  */
+    Eigen::SparseMatrix<double>     m_matSparsePreFilter;                       /**< The changed rows of the fused operator applied before the filter.*/
+    Eigen::SparseMatrix<double>     m_matSparsePostFilter;                      /**< The changed rows of the fused operator applied after the filter.*/
+
+    Eigen::VectorXi                 m_vecPreFilterRows;                         /**< The row indices of m_matSparsePreFilter.*/
+    Eigen::VectorXi                 m_vecPostFilterRows;                        /**< The row indices of m_matSparsePostFilter.*/
+
+    Eigen::MatrixXd                 m_matOperatorWorkspace;                     /**< Workspace holding the changed rows while an operator is applied.*/
+    Eigen::MatrixXd                 m_matFiltered;                              /**< Output of the temporal filter, swapped with the block.*/
+    Eigen::MatrixXf                 m_matBlockFloat;                            /**< Single precision copy of the block, input of the single precision filter.*/
+    Eigen::MatrixXf                 m_matFilteredFloat;                         /**< Output of the single precision filter.*/
+
+    QStringList                     m_lOperatorBads;                            /**< The bad channels the operators were fused for.*/
 
     Eigen::MatrixXd                 m_matSpharaVVGradLoaded;                    /**< The loaded VectorView gradiometer basis functions.*/
     Eigen::MatrixXd                 m_matSpharaVVMagLoaded;                     /**< The loaded VectorView magnetometer basis functions.*/
@@ -297,13 +356,16 @@ private:
 
     FIFFLIB::FiffInfo::SPtr                         m_pFiffInfo;                /**< Fiff measurement info.*/
 
-    IOBUFFER::CircularMatrixBuffer<double>::SPtr    m_pNoiseReductionBuffer;    /**< Holds incoming data.*/
+    IOBUFFER::LockFreeMatrixBuffer<double>::SPtr    m_pNoiseReductionBuffer;    /**< Holds incoming data.*/
+    QQueue<qint64>                                  m_qQueueTimestamps;         /**< Pipeline entry times of the blocks in m_pNoiseReductionBuffer, used for latency monitoring.*/
+    QMutex                                          m_qMutexTimestamps;         /**< Guards m_qQueueTimestamps.*/
 
     NoiseReductionOptionsWidget::SPtr               m_pOptionsWidget;           /**< The noise reduction option widget object.*/
     QAction*                                        m_pActionShowOptionsWidget; /**< The noise reduction option widget action.*/
 
     DISPLIB::FilterWindow::SPtr                     m_pFilterWindow;            /**< Filter window. */
     REALTIMELIB::RtFilter::SPtr                       m_pRtFilter;                /**< Real time filter object. */
+    REALTIMELIB::RtFilterF::SPtr                      m_pRtFilterFloat;           /**< Single precision real time filter object. */
 
     SCMEASLIB::NewRealTimeMultiSampleArray::SPtr     m_pRTMSA;                   /**< the real time multi sample array object. */
 
@@ -76,5 +76,11 @@ contains(MNECPP_CONFIG, buildBasicMneScanVersion) {
         ssvepbci \
         neuronalconnectivity \
         reference
+
+    #Algorithms which need CNTK
+    !isEmpty( CNTK_INCLUDE_DIR ) {
+        SUBDIRS += \
+            deepinference
+    }
 }
 
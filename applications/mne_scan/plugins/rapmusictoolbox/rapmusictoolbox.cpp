@@ -78,6 +78,8 @@ RapMusicToolbox::RapMusicToolbox()
 , m_sSurfaceDir("./MNE-sample-data/subjects/sample/surf")
 , m_iNumAverages(10)
 , m_iDownSample(4)
+, m_fStreamWindow(0.2f)
+, m_iStreamNumSamples(0)
 {
 
 }
@@ -118,6 +120,10 @@ void RapMusicToolbox::init()
     connect(m_pRTEInput.data(), &PluginInputConnector::notify, this, &RapMusicToolbox::updateRTE, Qt::DirectConnection);
     m_inputConnectors.append(m_pRTEInput);
 
+    m_pRTMSAInput = PluginInputData<NewRealTimeMultiSampleArray>::create(this, "RapMusic Toolbox RTMSA In", "RapMusic Toolbox real-time multi sample array input data");
+    connect(m_pRTMSAInput.data(), &PluginInputConnector::notify, this, &RapMusicToolbox::updateRTMSA, Qt::DirectConnection);
+    m_inputConnectors.append(m_pRTMSAInput);
+
     // Output
     m_pRTSEOutput = PluginOutputData<RealTimeSourceEstimate>::create(this, "MNEOut", "RapMusic Toolbox output data");
     m_outputConnectors.append(m_pRTSEOutput);
@@ -157,6 +163,7 @@ void RapMusicToolbox::calcFiffInfo()
         }
 
         RowVectorXi sel = m_pFiffInfoEvoked->pick_channels(m_qListPickChannels);
+        m_vecPickRows = sel;
 
         m_pFiffInfo = QSharedPointer<FiffInfo>(new FiffInfo(m_pFiffInfoEvoked->pick_info(sel)));
     }
@@ -223,7 +230,10 @@ bool RapMusicToolbox::stop()
     m_bIsRunning = false;
 
     if(m_bProcessData) // Only clear if buffers have been initialised
+    {
         m_qVecFiffEvoked.clear();
+        m_qVecRawBlocks.clear();
+    }
 
     // Stop filling buffers with data from the inputs
     m_bProcessData = false;
@@ -288,6 +298,36 @@ void RapMusicToolbox::updateRTE(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 }
 
 
+//*************************************************************************************************************
+
+void RapMusicToolbox::updateRTMSA(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
+{
+    QSharedPointer<NewRealTimeMultiSampleArray> pRTMSA = pMeasurement.dynamicCast<NewRealTimeMultiSampleArray>();
+
+    QMutexLocker locker(&m_qMutex);
+    if(pRTMSA && m_bReceiveData)
+    {
+        //Fiff Information of the raw data
+        if(!m_pFiffInfoEvoked && pRTMSA->info())
+            m_pFiffInfoEvoked = QSharedPointer<FiffInfo>(new FiffInfo(*pRTMSA->info()));
+
+        if(m_bProcessData)
+        {
+            for(qint32 i = 0; i < pRTMSA->getMultiSampleArray().size(); ++i)
+            {
+                const MatrixXd& t_mat = pRTMSA->getMultiSampleArray()[i];
+
+                MatrixXd t_matPicked(m_vecPickRows.size(), t_mat.cols());
+                for(qint32 j = 0; j < m_vecPickRows.size(); ++j)
+                    t_matPicked.row(j) = t_mat.row(m_vecPickRows[j]);
+
+                m_qVecRawBlocks.push_back(t_matPicked);
+            }
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 void RapMusicToolbox::run()
@@ -319,6 +359,10 @@ void RapMusicToolbox::run()
 
     m_pPwlRapMusic = RapMusic::SPtr(new RapMusic(*m_pClusteredFwd, false, numDipolePairs));
 
+    //Sliding window of the raw data
+    m_pPwlRapMusic->setStreamAttr(qMax(1, (qint32)(m_fStreamWindow * m_pFiffInfo->sfreq)));
+    m_iStreamNumSamples = 0;
+
     //
     // start processing data
     //
@@ -337,8 +381,34 @@ void RapMusicToolbox::run()
 
         m_qMutex.lock();
         qint32 t_evokedSize = m_qVecFiffEvoked.size();
+        qint32 t_rawSize = m_qVecRawBlocks.size();
         m_qMutex.unlock();
 
+        //Streaming mode: all blocks received since the last window are one step of the sliding window, so the
+        //localization keeps up with the data
+        if(t_rawSize > 0 && m_pPwlRapMusic)
+        {
+            m_qMutex.lock();
+            qint32 t_iNumCols = 0;
+            for(qint32 i = 0; i < m_qVecRawBlocks.size(); ++i)
+                t_iNumCols += m_qVecRawBlocks[i].cols();
+
+            MatrixXd t_matRaw(m_qVecRawBlocks[0].rows(), t_iNumCols);
+            for(qint32 i = 0, c = 0; i < m_qVecRawBlocks.size(); c += m_qVecRawBlocks[i].cols(), ++i)
+                t_matRaw.middleCols(c, m_qVecRawBlocks[i].cols()) = m_qVecRawBlocks[i];
+
+            m_qVecRawBlocks.clear();
+            m_qMutex.unlock();
+
+            float t_fTStep = 1.0f / m_pFiffInfo->sfreq;
+
+            MNESourceEstimate sourceEstimate = m_pPwlRapMusic->calculateInverseStream(t_matRaw, m_iStreamNumSamples * t_fTStep, t_fTStep);
+            m_iStreamNumSamples += t_matRaw.cols();
+
+            if(!sourceEstimate.isEmpty())
+                m_pRTSEOutput->data()->setValue(sourceEstimate);
+        }
+
         if(t_evokedSize > 0)
         {
             if(m_pPwlRapMusic && ((skip_count % 10) == 0))
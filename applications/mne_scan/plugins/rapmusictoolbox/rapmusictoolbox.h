@@ -57,6 +57,7 @@
 
 #include <scMeas/realtimesourceestimate.h>
 #include <scMeas/realtimeevoked.h>
+#include <scMeas/newrealtimemultisamplearray.h>
 
 
 //*************************************************************************************************************
@@ -165,6 +166,14 @@ public:
     */
     void updateRTE(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
 
+    //=========================================================================================================
+    /**
+    * Slot to update the raw data, which is localized on a sliding window (streaming mode)
+    *
+    * @param[in] pMeasurement   The raw data block to be appended
+    */
+    void updateRTMSA(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
+
 signals:
     //=========================================================================================================
     /**
@@ -183,12 +192,14 @@ protected:
 
 private:
     PluginInputData<RealTimeEvoked>::SPtr   m_pRTEInput;    /**< The RealTimeEvoked input.*/
+    PluginInputData<NewRealTimeMultiSampleArray>::SPtr  m_pRTMSAInput;  /**< The raw data input of the streaming mode.*/
 
     PluginOutputData<RealTimeSourceEstimate>::SPtr      m_pRTSEOutput;  /**< The RealTimeSourceEstimate output.*/
 
     QMutex m_qMutex;
 
     QVector<FiffEvoked> m_qVecFiffEvoked;
+    QVector<Eigen::MatrixXd> m_qVecRawBlocks;   /**< Received raw data blocks, picked to the forward channels. */
     qint32 m_iNumAverages;
 
     bool m_bIsRunning;      /**< If source lab is running */
@@ -208,14 +219,18 @@ private:
     SurfaceSet::SPtr            m_pSurfaceSet;      /**< Surface set. */
 
     FiffInfo::SPtr              m_pFiffInfo;        /**< Fiff information. */
-    FiffInfo::SPtr              m_pFiffInfoEvoked;  /**< Fiff information of the evoked. */
+    FiffInfo::SPtr              m_pFiffInfoEvoked;  /**< Fiff information of the evoked or the raw data. */
     FiffInfoBase::SPtr          m_pFiffInfoForward; /**< Fiff information of the forward solution. */
 
     QStringList                 m_qListPickChannels;        /**< Channels to pick */
+    Eigen::RowVectorXi          m_vecPickRows;              /**< Rows of the raw data of the channels to pick */
 
-    PwlRapMusic::SPtr           m_pPwlRapMusic;     /**< Powell RAP MUSIC. */
+    RapMusic::SPtr              m_pPwlRapMusic;     /**< RAP MUSIC. */
     qint32                      m_iDownSample;      /**< Sampling rate */
 
+    float                       m_fStreamWindow;        /**< Length of the sliding window of the streaming mode [s] */
+    qint64                      m_iStreamNumSamples;    /**< Number of raw samples localized since the start */
+
 //    RealTimeSourceEstimate::SPtr m_pRTSE_MNE; /**< Source Estimate output channel. */
 };
 
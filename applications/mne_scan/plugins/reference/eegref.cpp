@@ -51,6 +51,14 @@
 #include <Eigen/Dense>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -66,6 +74,7 @@ using namespace Eigen;
 //=============================================================================================================
 
 EEGRef::EEGRef()
+: m_iNumChannels(-1)
 {
 }
 
@@ -74,42 +83,85 @@ EEGRef::EEGRef()
 
 MatrixXd EEGRef::applyCAR(MatrixXd &matIER, FIFFLIB::FiffInfo::SPtr &pFiffInfo)
 {
-    unsigned int numTrueCh  = 0;
-    unsigned int numCh      = pFiffInfo->chs.size();
-    MatrixXd matOnes        = MatrixXd::Ones(numCh, numCh);
-    MatrixXd matCenter      = MatrixXd::Identity(numCh, numCh);
+    EEGRef eegRef;
+    eegRef.updateChannels(*pFiffInfo);
+
+    MatrixXd matCAR = matIER;
+    eegRef.applyCARInPlace(matCAR);
+
+    return matCAR;
+}
+
+
+//*************************************************************************************************************
+
+void EEGRef::updateChannels(const FIFFLIB::FiffInfo& fiffInfo)
+{
+    if(m_iNumChannels == fiffInfo.chs.size() && m_qListBads == fiffInfo.bads)
+        return;
 
-    //determine the number of true channels
-    for(unsigned int i = 0; i < numCh; ++i)
+    m_iNumChannels = fiffInfo.chs.size();
+    m_qListBads = fiffInfo.bads;
+
+    QList<int> qListRefIdx, qListBadIdx;
+    for(int i = 0; i < m_iNumChannels; ++i)
     {
-        if(pFiffInfo->chs.at(i).ch_name.contains("EEG") && !pFiffInfo->bads.contains(pFiffInfo->chs.at(i).ch_name))
-        {
-            numTrueCh++;
-        }
-        else
+        if(fiffInfo.chs.at(i).ch_name.contains("EEG"))
         {
-            // excluding non-EEG channels from the centering matrix
-            matOnes.row(i).setZero();
-            matOnes.col(i).setZero();
-            matCenter.row(i).setZero();
-            matCenter.col(i).setZero();
+            if(fiffInfo.bads.contains(fiffInfo.chs.at(i).ch_name))
+                qListBadIdx.append(i);
+            else
+                qListRefIdx.append(i);
         }
     }
 
-    //detrmine centering matrix
-    matCenter = matCenter - (1/double(numTrueCh))*matOnes;
+    m_vecRefIdx.resize(qListRefIdx.size());
+    for(int i = 0; i < qListRefIdx.size(); ++i)
+        m_vecRefIdx[i] = qListRefIdx[i];
+
+    m_vecBadIdx.resize(qListBadIdx.size());
+    for(int i = 0; i < qListBadIdx.size(); ++i)
+        m_vecBadIdx[i] = qListBadIdx[i];
+}
 
-    // determine EEG CAR data matrix
-    MatrixXd matCAR = matCenter*matIER;
 
-    //add former excluded non-EEG channels to the EEG CAR data matrix
-    for(unsigned int i = 0; i < numCh; ++i)
+//*************************************************************************************************************
+
+void EEGRef::registerStage(const SampleStage& stage)
+{
+    m_qListStages.append(stage);
+}
+
+
+//*************************************************************************************************************
+
+void EEGRef::applyCARInPlace(MatrixXd& matData) const
+{
+    if(matData.rows() != m_iNumChannels)
     {
-        if(!pFiffInfo->chs.at(i).ch_name.contains("EEG"))
-        {
-            matCAR.row(i) = matIER.row(i);
-        }
+        qWarning() << "EEGRef::applyCARInPlace - Data block has" << matData.rows() << "channels instead of" << m_iNumChannels;
+        return;
     }
 
-    return matCAR;
+    const double dNorm = m_vecRefIdx.size() > 0 ? 1.0/m_vecRefIdx.size() : 0.0;
+
+    // One sample of all channels is contiguous, so each sample is read and written once
+    for(int j = 0; j < matData.cols(); ++j)
+    {
+        double* pSample = matData.col(j).data();
+
+        double dMean = 0.0;
+        for(int i = 0; i < m_vecRefIdx.size(); ++i)
+            dMean += pSample[m_vecRefIdx[i]];
+        dMean *= dNorm;
+
+        for(int i = 0; i < m_vecRefIdx.size(); ++i)
+            pSample[m_vecRefIdx[i]] -= dMean;
+
+        for(int i = 0; i < m_vecBadIdx.size(); ++i)
+            pSample[m_vecBadIdx[i]] = 0.0;
+
+        for(int k = 0; k < m_qListStages.size(); ++k)
+            m_qListStages[k](matData.col(j));
+    }
 }
@@ -54,6 +54,8 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QStringList>
+#include <QList>
 
 
 //*************************************************************************************************************
@@ -64,6 +66,14 @@
 #include <Eigen/Dense>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <functional>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE NAMESPACE REFERENCEPLUGIN
@@ -85,6 +95,7 @@ class REFERENCESHARED_EXPORT EEGRef
 public:
     typedef QSharedPointer<EEGRef> SPtr;            /**< Shared pointer type for EEGRef. */
     typedef QSharedPointer<const EEGRef> ConstSPtr; /**< Const shared pointer type for EEGRef. */
+    typedef std::function<void(Eigen::Ref<Eigen::VectorXd>)> SampleStage;    /**< Processing of one sample of all channels, applied after the reference. */
 
     //=========================================================================================================
     /**
@@ -103,6 +114,40 @@ public:
     */
     static Eigen::MatrixXd applyCAR(Eigen::MatrixXd& matIER, FIFFLIB::FiffInfo::SPtr &pFiffInfo);
 
+    //=========================================================================================================
+    /**
+    * Builds the index lists of the referenced EEG channels and of the bad EEG channels. The lists are only
+    * rebuilt if the channels or the bad channels changed.
+    *
+    * @param[in] fiffInfo       the Fiff-Info of the EEG data stream
+    */
+    void updateChannels(const FIFFLIB::FiffInfo& fiffInfo);
+
+    //=========================================================================================================
+    /**
+    * Registers a processing stage which is run on each sample right after its re-referencing, while the sample
+    * is still in the cache. Other EEG preprocessing can be fused into the reference pass this way.
+    *
+    * @param[in] stage          the processing of one sample, a column of the data block
+    */
+    void registerStage(const SampleStage& stage);
+
+    //=========================================================================================================
+    /**
+    * Transforms the data block to common average reference in place. For each sample the mean of the good EEG
+    * channels is subtracted from them and bad EEG channels are set to zero, other channels are left untouched.
+    * The registered stages are applied in the same pass. This is O(channels x samples).
+    *
+    * @param[in,out] matData    data block, one channel per row
+    */
+    void applyCARInPlace(Eigen::MatrixXd& matData) const;
+
+private:
+    Eigen::VectorXi         m_vecRefIdx;        /**< Indices of the good EEG channels, their mean is the reference. */
+    Eigen::VectorXi         m_vecBadIdx;        /**< Indices of the bad EEG channels. */
+    qint32                  m_iNumChannels;     /**< Number of channels the index lists were built for. */
+    QStringList             m_qListBads;        /**< Bad channels the index lists were built for. */
+    QList<SampleStage>      m_qListStages;      /**< Registered processing stages. */
 };
 
 
@@ -227,15 +227,27 @@ void Reference::run()
         //Dispatch the inputs
         MatrixXd t_mat = m_pRefBuffer->pop();
 
-        // apply common average reference
-        MatrixXd matCAR = EEGRef::applyCAR(t_mat, m_pFiffInfo);
+        // apply common average reference and the registered stages in place
+        m_qMutex.lock();
+        m_eegRef.updateChannels(*m_pFiffInfo);
+        m_eegRef.applyCARInPlace(t_mat);
+        m_qMutex.unlock();
 
         //Send the data to the connected plugins and the online display
-        m_pRefOutput->data()->setValue(matCAR);
+        m_pRefOutput->data()->setValue(t_mat);
     }
 }
 
 
+//*************************************************************************************************************
+
+void Reference::registerSampleStage(const EEGRef::SampleStage& stage)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_eegRef.registerStage(stage);
+}
+
+
 //*************************************************************************************************************
 
 void Reference::showRefToolbarWidget()
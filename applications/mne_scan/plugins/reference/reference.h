@@ -62,6 +62,7 @@
 #include <QtWidgets>
 #include <QtCore/QtPlugin>
 #include <QDebug>
+#include <QMutex>
 
 
 //*************************************************************************************************************
@@ -127,6 +128,14 @@ public:
     */
     void update(SCMEASLIB::NewMeasurement::SPtr pMeasurement);
 
+    //=========================================================================================================
+    /**
+    * Registers an EEG preprocessing stage which is fused into the reference pass, see EEGRef::registerStage.
+    *
+    * @param[in] stage          the processing of one sample of all channels.
+    */
+    void registerSampleStage(const EEGRef::SampleStage& stage);
+
 protected:
     //=========================================================================================================
     /**
@@ -150,6 +159,9 @@ private:
 
     QSharedPointer<IOBUFFER::_double_CircularMatrixBuffer>  m_pRefBuffer;                   /**< Holds incoming data.*/
 
+    EEGRef                                              m_eegRef;                       /**< The common average reference with its channel index lists and stages.*/
+    QMutex                                              m_qMutex;                       /**< Guards m_eegRef.*/
+
     SCSHAREDLIB::PluginInputData<SCMEASLIB::NewRealTimeMultiSampleArray>::SPtr      m_pRefInput;      /**< The NewRealTimeMultiSampleArray of the Reference input.*/
     SCSHAREDLIB::PluginOutputData<SCMEASLIB::NewRealTimeMultiSampleArray>::SPtr     m_pRefOutput;     /**< The NewRealTimeMultiSampleArray of the Reference output.*/
 
@@ -78,6 +78,12 @@ RtSssSetupWidget::RtSssSetupWidget(RtSss* toolbox, QWidget *parent)
     connect(ui.m_qSpinBox_LoutRR, SIGNAL(valueChanged (int)), this, SLOT(setNewLoutRR(int)));
     connect(ui.m_qSpinBox_Lin, SIGNAL(valueChanged (int)), this, SLOT(setNewLin(int)));
     connect(ui.m_qSpinBox_Lout, SIGNAL(valueChanged (int)), this, SLOT(setNewLout(int)));
+
+    connect(ui.m_qCheckBox_Tsss, &QCheckBox::toggled, this, &RtSssSetupWidget::signalNewTsss);
+    connect(ui.m_qDoubleSpinBox_TsssBufferLength, static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged),
+            this, &RtSssSetupWidget::signalNewTsssBufferLength);
+    connect(ui.m_qDoubleSpinBox_TsssCorrLimit, static_cast<void (QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged),
+            this, &RtSssSetupWidget::signalNewTsssCorrLimit);
 }
 
 
@@ -138,6 +144,21 @@ int RtSssSetupWidget::getLout()
     return ui.m_qSpinBox_Lout->value();
 }
 
+bool RtSssSetupWidget::getTsss()
+{
+    return ui.m_qCheckBox_Tsss->isChecked();
+}
+
+double RtSssSetupWidget::getTsssBufferLength()
+{
+    return ui.m_qDoubleSpinBox_TsssBufferLength->value();
+}
+
+double RtSssSetupWidget::getTsssCorrLimit()
+{
+    return ui.m_qDoubleSpinBox_TsssCorrLimit->value();
+}
+
 
 //*************************************************************************************************************
 
@@ -109,12 +109,18 @@ public:
     int getLoutRR();
     int getLin();
     int getLout();
+    bool getTsss();
+    double getTsssBufferLength();
+    double getTsssCorrLimit();
 
 signals:
     void signalNewLinRR(int val);
     void signalNewLoutRR(int val);
     void signalNewLin(int val);
     void signalNewLout(int val);
+    void signalNewTsss(bool val);
+    void signalNewTsssBufferLength(double val);
+    void signalNewTsssCorrLimit(double val);
 
 private slots:
     //=========================================================================================================
@@ -40,6 +40,7 @@
 
 #include "rtsss.h"
 #include "rtsssalgo.h"
+#include "rttsssalgo.h"
 #include "FormFiles/rtssssetupwidget.h"
 
 //*************************************************************************************************************
@@ -51,10 +52,9 @@
 #include <QDebug>
 #include <QFuture>
 #include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QSettings>
 
-RtSssAlgo rsss;
-
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -66,6 +66,17 @@ using namespace SCSHAREDLIB;
 using namespace SCMEASLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+    const int SSS_OPERATOR_CACHE_SIZE = 8;     /**< Number of recently used SSS operators which are kept. */
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -79,6 +90,9 @@ RtSss::RtSss()
 , LoutRR(0)
 , Lin(0)
 , Lout(0)
+, m_bTsss(false)
+, m_dTsssBufferLength(4.0)
+, m_dTsssCorrLimit(0.98)
 {
 }
 
@@ -216,11 +230,17 @@ QWidget* RtSss::setupWidget()
     connect(widget, &RtSssSetupWidget::signalNewLoutRR, this, &RtSss::setLoutRR);
     connect(widget, &RtSssSetupWidget::signalNewLin, this, &RtSss::setLin);
     connect(widget, &RtSssSetupWidget::signalNewLout, this, &RtSss::setLout);
+    connect(widget, &RtSssSetupWidget::signalNewTsss, this, &RtSss::setTsss);
+    connect(widget, &RtSssSetupWidget::signalNewTsssBufferLength, this, &RtSss::setTsssBufferLength);
+    connect(widget, &RtSssSetupWidget::signalNewTsssCorrLimit, this, &RtSss::setTsssCorrLimit);
 
     LinRR = widget->getLinRR();
     LoutRR = widget->getLoutRR();
     Lin = widget->getLin();
     Lout = widget->getLout();
+    m_bTsss = widget->getTsss();
+    m_dTsssBufferLength = widget->getTsssBufferLength();
+    m_dTsssCorrLimit = widget->getTsssCorrLimit();
 
     return widget;
 }
@@ -262,6 +282,30 @@ void RtSss::setLout(int val)
 }
 
 
+//*************************************************************************************************************
+
+void RtSss::setTsss(bool val)
+{
+    m_bTsss = val;
+}
+
+
+//*************************************************************************************************************
+
+void RtSss::setTsssBufferLength(double val)
+{
+    m_dTsssBufferLength = val;
+}
+
+
+//*************************************************************************************************************
+
+void RtSss::setTsssCorrLimit(double val)
+{
+    m_dTsssCorrLimit = val;
+}
+
+
 //*************************************************************************************************************
 
 void RtSss::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
@@ -276,9 +320,18 @@ void RtSss::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
         if(!m_pRtSssBuffer)
             m_pRtSssBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(32, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
 
-        //Fiff information
-        if(!m_pFiffInfo)
-            m_pFiffInfo = pRTMSA->info();
+        //Fiff information, the source info is updated by other threads (e.g. the HPI fit), so only a copy is kept
+        if(pRTMSA->info())
+        {
+            QMutexLocker locker(&m_qMutexFiffInfo);
+
+            if(!m_pFiffInfo) {
+                m_pFiffInfo = FiffInfo::SPtr(new FiffInfo(*pRTMSA->info()));
+            } else {
+                m_pFiffInfo->dev_head_t = pRTMSA->info()->dev_head_t;
+                m_pFiffInfo->bads = pRTMSA->info()->bads;
+            }
+        }
 
         if(m_bProcessData)
         {
@@ -295,21 +348,65 @@ void RtSss::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
 
 //*************************************************************************************************************
 
-MatrixXd rt_sss(const MatrixXd &p_mat)
+QString RtSss::operatorKey(const FiffInfo &p_fiffInfo, const QList<int> &p_qListOrders)
 {
-    MatrixXd out;
-    out = rsss.getSSSRR(p_mat);
-    return out;
+    QString t_sKey;
+
+    for(qint32 i = 0; i < p_qListOrders.size(); ++i)
+        t_sKey.append(QString("%1 ").arg(p_qListOrders[i]));
+
+    //head positions closer than 0.1 mm and 0.1 mrad share one operator
+    for(qint32 r = 0; r < 3; ++r)
+        for(qint32 c = 0; c < 4; ++c)
+            t_sKey.append(QString("%1 ").arg(qRound(p_fiffInfo.dev_head_t.trans(r,c) * 1e4)));
+
+    t_sKey.append(p_fiffInfo.bads.join(","));
+
+    return t_sKey;
 }
 
 
 //*************************************************************************************************************
 
-void RtSss::run()
+RtSss::SssOperator RtSss::buildOperator(FiffInfo p_fiffInfo, QList<int> p_qListOrders)
 {
-//    QList<MatrixXd> lineqn;
-    MatrixXd lineqn;
+    SssOperator t_operator;
+    t_operator.sKey = operatorKey(p_fiffInfo, p_qListOrders);
 
+    //Find index vector for wanted meg channels
+    QStringList exclude;
+    for(int i = 0; i < p_fiffInfo.chs.size(); i++) {
+        if(p_fiffInfo.chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_MAG)
+            exclude<<p_fiffInfo.chs.at(i).ch_name;
+    }
+
+    exclude<<p_fiffInfo.bads;
+
+    QString chType("mag");
+    t_operator.pickedChannels = p_fiffInfo.pick_types(chType,false, false, QStringList(),exclude);
+
+    // Set MEG channel infomation and the number of spherical harmonics expansion to rtSSS
+    t_operator.pRtSssAlgo = QSharedPointer<RtSssAlgo>(new RtSssAlgo);
+    t_operator.pRtSssAlgo->setMEGInfo(FiffInfo::SPtr(new FiffInfo(p_fiffInfo)), t_operator.pickedChannels);
+    t_operator.pRtSssAlgo->setSSSParameter(p_qListOrders);
+
+    // The expansion origin is fixed in head coordinates and follows the head in device coordinates. Without a
+    // head position dev_head_t is the identity.
+    Vector4d t_vecOriginHead(0.0, 0.0, 0.04, 1.0);
+    Vector4d t_vecOriginDevice = p_fiffInfo.dev_head_t.invtrans.cast<double>() * t_vecOriginHead;
+    t_operator.pRtSssAlgo->setOrigin(t_vecOriginDevice.head(3));
+
+    //  Build linear equation
+    t_operator.pRtSssAlgo->buildLinearEqn();
+
+    return t_operator;
+}
+
+
+//*************************************************************************************************************
+
+void RtSss::run()
+{
     m_bIsRunning = true;
 
     // start receiving data
@@ -318,112 +415,50 @@ void RtSss::run()
 
     // Read Fiff Info
     //
-    while(!m_pFiffInfo)
-        msleep(10);// Wait for fiff Info
+    // The processing thread and the operator builds work on their own copies of the info
+    FiffInfo t_fiffInfo;
+    bool t_bFiffInfo = false;
+    while(!t_bFiffInfo)
+    {
+        m_qMutexFiffInfo.lock();
+        if(m_pFiffInfo) {
+            t_fiffInfo = *m_pFiffInfo;
+            t_bFiffInfo = true;
+        }
+        m_qMutexFiffInfo.unlock();
 
-    //Find index vector for wanted meg channels
-    QStringList exclude;
-    for(int i = 0; i < m_pFiffInfo->chs.size(); i++) {
-        if(m_pFiffInfo->chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_MAG)
-            exclude<<m_pFiffInfo->chs.at(i).ch_name;
+        if(!t_bFiffInfo)
+            msleep(10);// Wait for fiff Info
     }
 
-    exclude<<m_pFiffInfo->bads;
-
-//    qDebug()<< exclude ;
-
-    QString chType("mag");
-    RowVectorXi pickedChannels = m_pFiffInfo->pick_types(chType,false, false, QStringList(),exclude);
-    qDebug()<< "finished pickedChannels";
-    qint32 nmegchanused = pickedChannels.cols();
-
-//    for(int i = 0; i < nmegchanused; i++)
-//        std::cout << " pickedID= " << pickedChannels(i) <<", ";
-
-//    qDebug()<< "number of picked channels for rtSSS= " << nmegchanused;
-
     // Initialize output
-    m_pRTMSAOutput->data()->initFromFiffInfo(m_pFiffInfo);
+    m_pRTMSAOutput->data()->initFromFiffInfo(FiffInfo::SPtr(new FiffInfo(t_fiffInfo)));
     m_pRTMSAOutput->data()->setMultiArraySize(1);
     // m_pRTMSAOutput->data()->setSamplingRate(m_pFiffInfo->sfreq);
     m_pRTMSAOutput->data()->setVisibility(true);
 
-    // Set MEG channel infomation to rtSSS
-//    rsss.setMEGInfo(m_pFiffInfo);
-//    std::cout << "****** coil trans ****** " << std::endl;
-//    std::cout <<  m_pFiffInfo->chs[pickedChannels(1)].coil_trans << std::endl;
-//    return;
-    rsss.setMEGInfo(m_pFiffInfo, pickedChannels);
-//    qDebug() << " setMEGInfo finished";
-
-    // Get channel information
-    qint32 nmegchan = rsss.getNumMEGChan();
-    //qint32 nmegchanused = rsss.getNumMEGChanUsed();
-    //qDebug() << "number of meg channels(run): " << nmegchan;
-    VectorXi badch = rsss.getBadChan();
-
-    // Load and set the number of spherical harmonics expansion
-    //qDebug() << "LinRR (run): " << LinRR << ", LoutRR (run): " << LoutRR <<", Lin (run): " << Lin <<", Lout (run): " << Lout;
+    //  Build the initial linear equation, later ones are built in the background while processing goes on
+    qDebug() << "building an initial SSS linear equation .....";
     QList<int> expOrder;
     expOrder << LinRR << LoutRR << Lin << Lout;
-    rsss.setSSSParameter(expOrder);
-
-//    // Find out if coils are all gradiometers, all magnetometers, or both.
-//    // When both gradiometers and magnetometers are used,
-//    //      MagScale facor of 100 must be appiled to magnetomters.
-//    float MagScale;
-//    if ((0 < CoilGrad.sum()) && (CoilGrad.sum() < NumCoil))  MagScale = 100;
-//    else MagScale = 1;
-
-//    VectorXd CoilScale;
-//    CoilScale.setOnes(NumCoil);
-//    for(int i=0; i<NumCoil; i++)
-//    {
-//        if (CoilGrad(i) == 0) CoilScale(i) = MagScale;
-////        std::cout <<  "i=" << i << "CoilGrad: " << CoilGrad(i) << ",  CoilScale: " << CoilScale(i) << std::endl;
-//    }
 
-    // Find a starting MEG channel index fiff
-    // When the MEG recording of the first channel is saved starting from the first row in the signal matrix, the startID_MEGch will be 0.
-    // When the MEG recording of the first channel is saved starting not from the first row and being followed by others like EEG,
-    //   the startID_MEGch will be the first encounter of MEG channel other than zero.
-    //
-//    qint32 startID_MEGch = 0;
-//    for(qint32 i = 0; i < m_pFiffInfo->nchan; ++i)
-//        if(m_pFiffInfo->chs[i].kind == FIFFV_MEG_CH)
-//        {
-//            startID_MEGch = i;
-//            break;
-//        }
-    //qDebug() << "strat id: " << startID_MEGch;
+    SssOperator t_operator = buildOperator(t_fiffInfo, expOrder);
+    m_qListOperatorCache.clear();
+    m_qListOperatorCache.prepend(t_operator);
 
-    //  Build linear equation
-    qDebug() << "building an initial SSS linear equation .....";
-    lineqn = rsss.buildLinearEqn();
+    QFuture<SssOperator> t_futureOperator;
+    bool t_bOperatorPending = false;
 
-    //qDebug() << "..finished !!";
+    // The tSSS stage is recreated when it is switched on or its parameters change
+    QSharedPointer<RtTsssAlgo> t_pRtTsssAlgo;
+    qint32 t_iTsssSamples = 0;
+    double t_dTsssCorrLimit = 0.0;
 
     // start processing data
     m_bProcessData = true;
-    qint32 HEADMOV_COR_cnt = 15 ;
-    qint32 cnt=0;
-    //qDebug() << "rtSSS started.....";
-
-    bool m_bIsHeadMov = true;
 
     while(m_bIsRunning)
     {
-//        if (m_bIsHeadMov)
-//        {
-//            lineqn = rsss.buildLinearEqn();
-            //qDebug() << "rebuilt SSS linear equation .....";
-//            m_bIsHeadMov = false;
-//        }
-//        else
-//        {
-//            m_bIsHeadMov = true;
-//        }
-
         qint16 nrows = m_pRtSssBuffer->rows();
 
         if(nrows > 0) // check if init
@@ -432,61 +467,104 @@ void RtSss::run()
             MatrixXd in_mat = m_pRtSssBuffer->pop();
 //            qDebug() << "size of in_mat (run): " << in_mat.rows() << " x " << in_mat.cols();
 
+            // Take over a finished operator
+            if(t_bOperatorPending && t_futureOperator.isFinished())
+            {
+                t_operator = t_futureOperator.result();
+                t_bOperatorPending = false;
+
+                m_qListOperatorCache.prepend(t_operator);
+                while(m_qListOperatorCache.size() > SSS_OPERATOR_CACHE_SIZE)
+                    m_qListOperatorCache.removeLast();
+            }
+
+            // A new head position, e.g. from the HPI fit, new bads or new expansion orders need another operator.
+            // A cached one is used right away, otherwise it is built in the background.
+            expOrder.clear();
+            expOrder << LinRR << LoutRR << Lin << Lout;
+            m_qMutexFiffInfo.lock();
+            t_fiffInfo.dev_head_t = m_pFiffInfo->dev_head_t;
+            t_fiffInfo.bads = m_pFiffInfo->bads;
+            m_qMutexFiffInfo.unlock();
+
+            QString t_sKey = operatorKey(t_fiffInfo, expOrder);
+
+            if(t_sKey != t_operator.sKey && !t_bOperatorPending)
+            {
+                qint32 t_iCached = -1;
+                for(qint32 i = 0; i < m_qListOperatorCache.size() && t_iCached < 0; ++i)
+                    if(m_qListOperatorCache[i].sKey == t_sKey)
+                        t_iCached = i;
+
+                if(t_iCached >= 0)
+                {
+                    t_operator = m_qListOperatorCache.takeAt(t_iCached);
+                    m_qListOperatorCache.prepend(t_operator);
+                }
+                else
+                {
+                    qDebug() << "rebuilding SSS linear equation in the background .....";
+                    t_futureOperator = QtConcurrent::run(&RtSss::buildOperator, t_fiffInfo, expOrder);
+                    t_bOperatorPending = true;
+                }
+            }
+
+            const RowVectorXi& pickedChannels = t_operator.pickedChannels;
+
             //Generate new matrix from picked channels
             MatrixXd in_mat_used(pickedChannels.cols(), in_mat.cols());
 
             for(qint32 i = 0; i < in_mat_used.rows(); ++i)
                 in_mat_used.row(i) = in_mat.row(pickedChannels(i));
 
-//            //  Remove bad channel signals
-//            MatrixXd in_mat_used(nmegchanused, in_mat.cols());
-////            qDebug() << "size of in_mat_used (run): " << in_mat_used.rows() << " x " << in_mat_used.cols();
-//            for(qint32 i = 0, k = 0; i < nmegchan; ++i)
-//                if (badch(i) == 0)
-//                {
-//                    in_mat_used.row(k) = in_mat.row(i);
-//                    k++;
-//                }
-//            in_mat_used = in_mat.block(0,0,nmegchanused,in_mat.cols());
-
-           in_mat_used = rt_sss(in_mat_used);
-
-            // Implement Concurrent mapreduced for parallel processing
-            // divide the in_mat_used into 2 or 4 matrices, which renders 50ms or 25ms data
-//            QList<MatrixXd> list_in_mat;
-//            qint32 nSubSample = 20;
-//            qint32 nThread = in_mat_used.cols() / nSubSample;
-
-//            for(qint32 ith = 0; ith < nThread; ++ ith) {
-//                if(ith*nSubSample+nSubSample < in_mat_used.cols())
-//                    list_in_mat.append(in_mat_used.block(0,ith*nSubSample,nmegchanused,in_mat_used.cols()-(ith*nSubSample)));
-//                else
-//                    list_in_mat.append(in_mat_used.block(0,ith*nSubSample,nmegchanused,nSubSample));
-//            }
-//            qDebug() << "rtSSS split up done!";
-
-//            QFuture<MatrixXd> res = QtConcurrent::mapped(list_in_mat, rt_sss);
-//            res.waitForFinished();
-
-//            qDebug() << "rtSSS mapped done!";
-
-//            for(qint32 ith = 0; ith < nThread; ++ ith)
-//                in_mat_used.block(0,ith*nSubSample,nmegchanused,nSubSample)= res.resultAt(ith);
-
-            // Replace raw signal by SSS signal
-            for(qint32 i = 0; i < in_mat_used.rows(); ++i) {
-                in_mat.row(pickedChannels(i)) = in_mat_used.row(i);
-//                qDebug() <<    in_mat.row(pickedChannels(i));
+            if(!m_bTsss)
+            {
+                t_pRtTsssAlgo.clear();
+
+                in_mat_used = t_operator.pRtSssAlgo->getSSSRR(in_mat_used);
+
+                // Replace raw signal by SSS signal
+                for(qint32 i = 0; i < in_mat_used.rows(); ++i) {
+                    in_mat.row(pickedChannels(i)) = in_mat_used.row(i);
+//                    qDebug() <<    in_mat.row(pickedChannels(i));
+                }
+
+                // Output to display
+                m_pRTMSAOutput->data()->setValue(0.01* in_mat);
+                continue;
+            }
+
+            qint32 t_iSamples = (qint32)(m_dTsssBufferLength * t_fiffInfo.sfreq);
+            if(!t_pRtTsssAlgo || t_iSamples != t_iTsssSamples || m_dTsssCorrLimit != t_dTsssCorrLimit)
+            {
+                t_iTsssSamples = t_iSamples;
+                t_dTsssCorrLimit = m_dTsssCorrLimit;
+                t_pRtTsssAlgo = QSharedPointer<RtTsssAlgo>(new RtTsssAlgo(t_iTsssSamples, t_dTsssCorrLimit));
             }
 
-            // Output to display
-            m_pRTMSAOutput->data()->setValue(0.01* in_mat);
+            // tSSS works on the robust expansion coefficients, the cleaned internal part is projected back
+            MatrixXd t_matCoeffs;
+            t_operator.pRtSssAlgo->getSSSRR(in_mat_used, &t_matCoeffs);
+
+            qint32 t_iNumIn = t_operator.pRtSssAlgo->getNumBasisIn();
+            t_pRtTsssAlgo->append(in_mat, t_matCoeffs.topRows(t_iNumIn), t_matCoeffs.bottomRows(t_matCoeffs.rows() - t_iNumIn));
 
-//            cnt++;
-//            qDebug() << cnt << "   " ;
+            MatrixXd t_matRaw, t_matCoeffIn;
+            while(t_pRtTsssAlgo->take(in_mat.cols(), t_matRaw, t_matCoeffIn))
+            {
+                in_mat_used = t_operator.pRtSssAlgo->getSSSIn(t_matCoeffIn);
+
+                for(qint32 i = 0; i < in_mat_used.rows(); ++i)
+                    t_matRaw.row(pickedChannels(i)) = in_mat_used.row(i);
+
+                m_pRTMSAOutput->data()->setValue(0.01* t_matRaw);
+            }
         }
     }
 
+    if(t_bOperatorPending)
+        t_futureOperator.waitForFinished();
+
     m_bProcessData = false;
     m_bReceiveData = false;
     //qDebug() << "rtSSS stopped.";
@@ -63,6 +63,16 @@
 //=============================================================================================================
 
 #include <QtWidgets>
+#include <QFuture>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class RtSssAlgo;
 
 
 //*************************************************************************************************************
@@ -151,11 +161,47 @@ public:
     void setLoutRR(int);
     void setLin(int);
     void setLout(int);
+    void setTsss(bool);
+    void setTsssBufferLength(double);
+    void setTsssCorrLimit(double);
 
 protected:
     virtual void run();
 
 private:
+    //=========================================================================================================
+    /**
+    * The SSS operator of one head position, bad channel set and set of expansion orders.
+    */
+    struct SssOperator
+    {
+        QString                     sKey;               /**< Identifies head position, bads and expansion orders. */
+        Eigen::RowVectorXi          pickedChannels;     /**< The channels the operator is built for. */
+        QSharedPointer<RtSssAlgo>   pRtSssAlgo;         /**< The algorithm with its precomputed linear equation. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Returns the key of the operator which fits the current head position, bads and expansion orders.
+    *
+    * @param[in] p_fiffInfo     The measurement info with the current head position and bads.
+    * @param[in] p_qListOrders  The expansion orders LinRR, LoutRR, Lin and Lout.
+    *
+    * @return the operator key.
+    */
+    static QString operatorKey(const FiffInfo &p_fiffInfo, const QList<int> &p_qListOrders);
+
+    //=========================================================================================================
+    /**
+    * Builds the SSS operator, it is run on a worker thread when the head position or the bads change.
+    *
+    * @param[in] p_fiffInfo     The measurement info with the current head position and bads.
+    * @param[in] p_qListOrders  The expansion orders LinRR, LoutRR, Lin and Lout.
+    *
+    * @return the operator.
+    */
+    static SssOperator buildOperator(FiffInfo p_fiffInfo, QList<int> p_qListOrders);
+
 //    PluginInputData<NewRealTimeSampleArray>::SPtr   m_pDummyInput;      /**< The RealTimeSampleArray of the DummyToolbox input.*/
 //    PluginOutputData<NewRealTimeSampleArray>::SPtr  m_pDummyOutput;    /**< The RealTimeSampleArray of the DummyToolbox output.*/
     PluginInputData<NewRealTimeSampleArray>::SPtr   m_pRTSAInput;      /**< The RealTimeSampleArray of the RtSss input.*/
@@ -169,12 +215,19 @@ private:
     bool m_bReceiveData;    /**< If thread is ready to receive data */
     bool m_bProcessData;    /**< If data should be received for processing */
 
-    FiffInfo::SPtr              m_pFiffInfo;        /**< Fiff information. */
+    FiffInfo::SPtr              m_pFiffInfo;        /**< Own copy of the Fiff information, guarded by m_qMutexFiffInfo. */
+    QMutex                      m_qMutexFiffInfo;   /**< Guards m_pFiffInfo, update() and run() are called from different threads. */
 
     CircularMatrixBuffer<double>::SPtr m_pRtSssBuffer;   /**< Holds incoming rt server data.*/
 
     int LinRR, LoutRR, Lin, Lout;
 
+    bool    m_bTsss;                /**< If temporal SSS is applied after the spatial SSS. */
+    double  m_dTsssBufferLength;    /**< The tSSS correlation window in seconds. */
+    double  m_dTsssCorrLimit;       /**< The subspace correlation at which tSSS removes a component. */
+
+    QList<SssOperator> m_qListOperatorCache;   /**< Recently used operators, most recent first. */
+
     QMutex m_qMutex;
 
     //    dBuffer::SPtr   m_pRtSssBuffer;      /**< Holds incoming data.*/
@@ -76,6 +76,7 @@ SOURCES += \
 #        FormFiles/rtsssrunwidget.cpp \
         FormFiles/rtsssaboutwidget.cpp \
         rtsssalgo.cpp \
+        rttsssalgo.cpp \
     rtsssalgo_test.cpp
 
 HEADERS += \
@@ -85,6 +86,7 @@ HEADERS += \
 #        FormFiles/rtsssrunwidget.h \
         FormFiles/rtsssaboutwidget.h \
         rtsssalgo.h \
+        rttsssalgo.h \
     rtsssalgo_test.h
 
 FORMS += \
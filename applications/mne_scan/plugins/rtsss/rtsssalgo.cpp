@@ -145,6 +145,14 @@ MatrixXd RtSssAlgo::buildLinearEqn()
 
     EqnARR = CoilScale.asDiagonal() * EqnARR;
     EqnA = CoilScale.asDiagonal() * EqnA;
+
+    // Precompute everything which doesn't depend on the data, per block getSSSOLS is a single product and
+    // getSSSRR only iterates for the samples with outlying coils
+    EqnRRInv = (EqnARR.transpose() * EqnARR).inverse();
+    EqnInv = (EqnA.transpose() * EqnA).inverse();
+    EqnRRSolve = EqnRRInv * EqnARR.transpose();
+    EqnSolve = EqnInv * EqnA.transpose();
+    ProjIn = EqnIn * EqnSolve.topRows(EqnIn.cols());
 //        std::cout << "pass 1" << std::endl;
 //        std::cout << "MEGData: " << MEGData.rows() << " x " << MEGData.cols() << std::endl;
 //    EqnB = CoilScale.asDiagonal() * MEGData;
@@ -190,6 +198,11 @@ void RtSssAlgo::setSSSParameter(QList<int> expansionOrder)
     LOutOLS = expansionOrder[3];
 }
 
+void RtSssAlgo::setOrigin(const Vector3d &origin)
+{
+    Origin = origin;
+}
+
 void RtSssAlgo::setMEGInfo(FiffInfo::SPtr fiffInfo, RowVectorXi pickedChannels)
 {
     //qDebug() << "setMEGInfo START";
@@ -816,12 +829,12 @@ void RtSssAlgo::getSphereToCartesianVector()
 
 //QList<MatrixXd> RtSssAlgo::getSSSRR(MatrixXd EqnIn, MatrixXd EqnOut, MatrixXd EqnARR, MatrixXd EqnA, MatrixXd EqnB)
 //QList<MatrixXd> RtSssAlgo::getSSSRR(MatrixXd EqnB)
-MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB)
+MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB, MatrixXd *Coeffs)
 {
     //qDebug() << "getSSSRR START";
 
     int NumBIn, NumBOut, NumCoil, NumExp;
-    MatrixXd EqnRRInv, EqnInv, SSSIn, SSSOut, Weight; //, ErrRel;
+    MatrixXd SSSIn, SSSOut, Weight; //, ErrRel;
     VectorXd ErrRel;
     double RR_K1, RR_K2, RR_K3;
     double eqn_scale0, eqn_scale;
@@ -842,10 +855,14 @@ MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB)
     NumCoil = EqnB.rows();
     NumExp = EqnB.cols();
 
-    EqnRRInv = (EqnARR.transpose() * EqnARR).inverse();
-    EqnInv = (EqnA.transpose() * EqnA).inverse();
+    // OLS solutions of all samples at once, EqnRRInv and EqnInv are precomputed by buildLinearEqn
+    MatrixXd sol_X_RR = EqnRRSolve * EqnB;
+    MatrixXd err_RR = EqnARR * sol_X_RR - EqnB;
 
-    SSSIn.setZero(NumCoil,NumExp);
+    // samples without outlying coils keep all weights at one, their robust solution is the OLS solution
+    SSSIn = ProjIn * EqnB;
+    if(Coeffs)
+        *Coeffs = EqnSolve * EqnB;
     SSSOut.setZero(NumCoil,NumExp);
     Weight.setZero(NumCoil,NumExp);
     ErrRel.setZero(NumExp);
@@ -856,14 +873,20 @@ MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB)
     for(int i=0; i<NumExp; i++)
     {
 //      % solve OLS solution
-        sol_X = EqnRRInv * (EqnARR.transpose() * EqnB.col(i));
+        sol_X = sol_X_RR.col(i);
 //        std::cout << "sol_X ************************" << endl << sol_X.transpose() << endl;
 
 //      % scale linear equation
-        eqn_err = EqnARR * sol_X - EqnB.col(i);
+        eqn_err = err_RR.col(i);
         eqn_scale0 = stdev(eqn_err);
         eqn_err = eqn_err.cwiseAbs() / eqn_scale0;
 
+        if(eqn_err.maxCoeff() <= RR_K1)
+        {
+            Weight.col(i).setOnes();
+            continue;
+        }
+
 //      % solve iteratively re-weighted least squares (Bi-Square) -- subspace
         sol_X_old.setConstant(sol_X.rows(), sol_X.cols(), 1e30);
 //        while (((sol_X-sol_X_old).norm() / sol_X.norm()) > ErrTolRel)
@@ -949,6 +972,9 @@ MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB)
         SSSIn.col(i) = EqnIn * sol_in;
         SSSOut.col(i) = EqnOut * sol_out;
 
+        if(Coeffs)
+            Coeffs->col(i) = sol_X;
+
     }
     RRsss.append(SSSIn);
     RRsss.append(SSSOut);
@@ -989,47 +1015,9 @@ MatrixXd RtSssAlgo::getSSSOLS(MatrixXd EqnB)
 {
     //qDebug() << "getSSSOLS START";
 
-    int NumBIn, NumBOut, NumCoil, NumExp;
-    MatrixXd EqnRRInv, EqnInv, SSSIn, SSSOut;
-    MatrixXd sol_X, sol_in, sol_out;
-    VectorXd ErrRel;
-    QList<MatrixXd> OLSsss;
-
-//  % initialization
-    NumBIn = EqnIn.cols();
-    NumBOut = EqnOut.cols();
-    NumCoil = EqnB.rows();
-    NumExp = EqnB.cols();
-
-    EqnRRInv = (EqnA.transpose() * EqnA).inverse();
-    SSSIn.setZero(NumCoil,NumExp);
-    SSSOut.setZero(NumCoil,NumExp);
-    ErrRel.setZero(NumExp);
-
-    for (int i=0; i<NumExp; i++)
-    {
-//      % solve OLS solution
-        sol_X = EqnRRInv * (EqnA.transpose() * EqnB.col(i));
-
-        ErrRel(i) = (EqnA * sol_X - EqnB.col(i)).norm() / EqnB.col(i).norm();
-
-        sol_in = sol_X.block(0,0,NumBIn,1);
-
-        sol_out = sol_X.block(NumBIn,0, NumBOut,1);    // probably NumBIn+0 is correct.  Please debug !!!!
-
-//      % recover internal/external MEG siganl
-        SSSIn.col(i) = EqnIn * sol_in;
-        SSSOut.col(i) = EqnOut * sol_out;
-    }
-
-    OLSsss.append(SSSIn);
-    OLSsss.append(SSSOut);
-    OLSsss.append(ErrRel);
-
-    //qDebug() << "getSSSOLS END";
-
-//    return OLSsss;
-    return SSSIn;
+//  % the OLS reconstruction of the internal signal is linear in the data, the projector is precomputed by
+//  % buildLinearEqn: SSSIn = EqnIn * sol_in with sol_X = EqnInv * EqnA' * EqnB
+    return ProjIn * EqnB;
 }
 
 // Return number of meg channels
@@ -1038,6 +1026,21 @@ qint32 RtSssAlgo::getNumMEGChanUsed()
     return NumCoil;
 }
 
+MatrixXd RtSssAlgo::getSSSIn(const MatrixXd &CoeffsIn) const
+{
+    return EqnIn * CoeffsIn;
+}
+
+qint32 RtSssAlgo::getNumBasisIn() const
+{
+    return EqnIn.cols();
+}
+
+qint32 RtSssAlgo::getNumBasisOut() const
+{
+    return EqnOut.cols();
+}
+
 qint32 RtSssAlgo::getNumMEGChan()
 {
     return NumMEGChan;
@@ -101,7 +101,7 @@ public:
 
 //    QList<MatrixXd> getSSSRR(MatrixXd EqnIn, MatrixXd EqnOut, MatrixXd EqnARR, MatrixXd EqnA, MatrixXd EqnB);
 //    QList<MatrixXd> getSSSRR(MatrixXd EqnB);
-    MatrixXd getSSSRR(MatrixXd EqnB);
+    MatrixXd getSSSRR(MatrixXd EqnB, MatrixXd *Coeffs = 0);   // Coeffs optionally receives the expansion coefficients
 
 //    QList<MatrixXd> getSSSOLS(MatrixXd EqnIn, MatrixXd EqnOut, MatrixXd EqnA, MatrixXd EqnB);
 //    QList<MatrixXd> getSSSOLS(MatrixXd EqnB);
@@ -109,8 +109,15 @@ public:
 
     QList<MatrixXd> getLinEqn();
 
+    // Reconstruction of the internal signal from its expansion coefficients, the first getNumBasisIn() rows of
+    // the coefficients returned by getSSSRR
+    MatrixXd getSSSIn(const MatrixXd &CoeffsIn) const;
+    qint32 getNumBasisIn() const;
+    qint32 getNumBasisOut() const;
+
     void setMEGInfo(FiffInfo::SPtr fiffinfo, RowVectorXi);
     void setSSSParameter(QList<int>);
+    void setOrigin(const Vector3d &origin);     // expansion origin in device coordinates, call after setMEGInfo
     qint32 getNumMEGChan();
     qint32 getNumMEGChanUsed();
     qint32 getNumMEGBadChan();
@@ -141,6 +148,12 @@ private:
     MatrixXd BInX, BInY, BInZ, BOutX, BOutY, BOutZ;
     MatrixXd EqnInRR, EqnOutRR, EqnIn, EqnOut, EqnARR, EqnA, EqnB;
 
+    // Precomputed by buildLinearEqn, they only depend on the coils and the origin
+    MatrixXd EqnRRInv, EqnInv;      // inverses of the normal equations of EqnARR and EqnA
+    MatrixXd EqnRRSolve;            // EqnRRInv * EqnARR', least squares solution of the subspace
+    MatrixXd EqnSolve;              // EqnInv * EqnA', least squares solution of the full equation
+    MatrixXd ProjIn;                // EqnIn * EqnSolve(internal rows), OLS reconstruction of the internal signal
+
     VectorXd R, PHI, THETA;
     VectorXd R_X, R_Y, R_Z;
     VectorXd PHI_X, PHI_Y, PHI_Z;
@@ -0,0 +1,285 @@
+//=============================================================================================================
+/**
+* @file     rttsssalgo.cpp
+* @author   Seok Lew <slew@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the RtTsssAlgo class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rttsssalgo.h"
+
+#include <cmath>
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RtSssPlugin;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+    const double TSSS_EIG_TOL = 1e-12;      /**< Eigenvalues of a Gram matrix below this fraction of the largest are dropped. */
+
+    //=========================================================================================================
+    /**
+    * Appends the columns of a block to a buffer which holds p_iNum valid columns. The capacity is grown when needed.
+    */
+    void appendCols(MatrixXd &p_matBuffer, qint32 &p_iNum, const MatrixXd &p_matBlock)
+    {
+        if(p_matBuffer.rows() != p_matBlock.rows())
+        {
+            p_matBuffer.resize(p_matBlock.rows(), 2 * p_matBlock.cols());
+            p_iNum = 0;
+        }
+
+        if(p_iNum + p_matBlock.cols() > p_matBuffer.cols())
+            p_matBuffer.conservativeResize(NoChange, 2 * (p_iNum + p_matBlock.cols()));
+
+        p_matBuffer.middleCols(p_iNum, p_matBlock.cols()) = p_matBlock;
+        p_iNum += p_matBlock.cols();
+    }
+
+    //=========================================================================================================
+    /**
+    * Drops the first p_iCols columns of a buffer which holds p_iNum valid columns.
+    */
+    void dropCols(MatrixXd &p_matBuffer, qint32 &p_iNum, qint32 p_iCols)
+    {
+        const qint32 t_iRemaining = p_iNum - p_iCols;
+
+        // The matrix is column major, the remaining columns are a contiguous block
+        if(t_iRemaining > 0)
+            std::memmove(p_matBuffer.data(), p_matBuffer.data() + p_iCols * p_matBuffer.rows(), t_iRemaining * p_matBuffer.rows() * sizeof(double));
+
+        p_iNum = t_iRemaining;
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtTsssAlgo::RtTsssAlgo(qint32 p_iBufferSamples, double p_dCorrLimit)
+: m_iWindow(2 * qMax(1, (p_iBufferSamples + 1) / 2))
+, m_iHop(m_iWindow / 2)
+, m_dCorrLimit(p_dCorrLimit)
+, m_iNumComponents(0)
+{
+    m_vecHann.resize(m_iWindow);
+    for(qint32 i = 0; i < m_iWindow; ++i)
+        m_vecHann(i) = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / m_iWindow);
+
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void RtTsssAlgo::reset()
+{
+    m_iNumIn = 0;
+    m_iNumReady = 0;
+    m_iNumComponents = 0;
+    m_bFirstWindow = true;
+
+    m_matRaw.resize(0, 0);
+    m_matIn.resize(0, 0);
+    m_matOut.resize(0, 0);
+    m_matRawReady.resize(0, 0);
+    m_matInReady.resize(0, 0);
+}
+
+
+//*************************************************************************************************************
+
+void RtTsssAlgo::append(const MatrixXd &p_matRaw, const MatrixXd &p_matCoeffIn, const MatrixXd &p_matCoeffOut)
+{
+    if(p_matRaw.cols() != p_matCoeffIn.cols() || p_matRaw.cols() != p_matCoeffOut.cols())
+    {
+        qWarning("RtTsssAlgo::append - the blocks differ in their number of samples.");
+        return;
+    }
+
+    if((m_iNumIn > 0 || m_iNumReady > 0)
+            && (m_matRaw.rows() != p_matRaw.rows() || m_matIn.rows() != p_matCoeffIn.rows() || m_matOut.rows() != p_matCoeffOut.rows()))
+        reset();
+
+    qint32 t_iNum = m_iNumIn;
+    appendCols(m_matRaw, t_iNum, p_matRaw);
+    t_iNum = m_iNumIn;
+    appendCols(m_matIn, t_iNum, p_matCoeffIn);
+    t_iNum = m_iNumIn;
+    appendCols(m_matOut, t_iNum, p_matCoeffOut);
+    m_iNumIn = t_iNum;
+
+    while(m_iNumIn >= m_iWindow)
+        processWindow();
+}
+
+
+//*************************************************************************************************************
+
+bool RtTsssAlgo::take(qint32 p_iSamples, MatrixXd &p_matRaw, MatrixXd &p_matCoeffIn)
+{
+    if(m_iNumReady < p_iSamples)
+        return false;
+
+    p_matRaw = m_matRawReady.leftCols(p_iSamples);
+    p_matCoeffIn = m_matInReady.leftCols(p_iSamples);
+
+    qint32 t_iNum = m_iNumReady;
+    dropCols(m_matRawReady, t_iNum, p_iSamples);
+    t_iNum = m_iNumReady;
+    dropCols(m_matInReady, t_iNum, p_iSamples);
+    m_iNumReady = t_iNum;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtTsssAlgo::processWindow()
+{
+    const MatrixXd t_matIn = m_matIn.leftCols(m_iWindow);
+    const MatrixXd t_matOut = m_matOut.leftCols(m_iWindow);
+
+    // Gram matrices of the first half are kept from the last window, only the second half is new
+    if(m_bFirstWindow)
+    {
+        m_matGramIn = t_matIn.leftCols(m_iHop) * t_matIn.leftCols(m_iHop).transpose();
+        m_matGramOut = t_matOut.leftCols(m_iHop) * t_matOut.leftCols(m_iHop).transpose();
+        m_matCross = t_matIn.leftCols(m_iHop) * t_matOut.leftCols(m_iHop).transpose();
+    }
+
+    MatrixXd t_matGramInHop = t_matIn.rightCols(m_iHop) * t_matIn.rightCols(m_iHop).transpose();
+    MatrixXd t_matGramOutHop = t_matOut.rightCols(m_iHop) * t_matOut.rightCols(m_iHop).transpose();
+    MatrixXd t_matCrossHop = t_matIn.rightCols(m_iHop) * t_matOut.rightCols(m_iHop).transpose();
+
+    MatrixXd t_matGramIn = m_matGramIn + t_matGramInHop;
+    MatrixXd t_matGramOut = m_matGramOut + t_matGramOutHop;
+    MatrixXd t_matCross = m_matCross + t_matCrossHop;
+
+    // The canonical correlations of the temporal subspaces spanned by the internal and the external coefficients
+    MatrixXd t_matWhiteIn = whitening(t_matGramIn);
+    MatrixXd t_matWhiteOut = whitening(t_matGramOut);
+
+    MatrixXd t_matCleanIn = t_matIn;
+    m_iNumComponents = 0;
+
+    if(t_matWhiteIn.cols() > 0 && t_matWhiteOut.cols() > 0)
+    {
+        JacobiSVD<MatrixXd> t_svd(t_matWhiteIn.transpose() * t_matCross * t_matWhiteOut, ComputeThinU);
+
+        while(m_iNumComponents < t_svd.singularValues().size() && t_svd.singularValues()(m_iNumComponents) >= m_dCorrLimit)
+            ++m_iNumComponents;
+
+        if(m_iNumComponents > 0)
+        {
+            // Q'X are the orthonormal time courses of the intersection, X is projected onto their complement
+            MatrixXd t_matQ = t_matWhiteIn * t_svd.matrixU().leftCols(m_iNumComponents);
+            t_matCleanIn -= (t_matGramIn * t_matQ) * (t_matQ.transpose() * t_matIn);
+        }
+    }
+
+    // Overlap add, the first half of the first window has no predecessor and is taken unweighted
+    MatrixXd t_matReady(t_matCleanIn.rows(), m_iHop);
+    if(m_bFirstWindow)
+        t_matReady = t_matCleanIn.leftCols(m_iHop);
+    else
+        t_matReady = m_matPending + (t_matCleanIn.leftCols(m_iHop).array().rowwise() * m_vecHann.head(m_iHop).array()).matrix();
+
+    m_matPending = (t_matCleanIn.rightCols(m_iHop).array().rowwise() * m_vecHann.tail(m_iHop).array()).matrix();
+
+    qint32 t_iNum = m_iNumReady;
+    appendCols(m_matRawReady, t_iNum, m_matRaw.leftCols(m_iHop));
+    t_iNum = m_iNumReady;
+    appendCols(m_matInReady, t_iNum, t_matReady);
+    m_iNumReady = t_iNum;
+
+    // The second half becomes the first half of the next window
+    m_matGramIn = t_matGramInHop;
+    m_matGramOut = t_matGramOutHop;
+    m_matCross = t_matCrossHop;
+    m_bFirstWindow = false;
+
+    t_iNum = m_iNumIn;
+    dropCols(m_matRaw, t_iNum, m_iHop);
+    t_iNum = m_iNumIn;
+    dropCols(m_matIn, t_iNum, m_iHop);
+    t_iNum = m_iNumIn;
+    dropCols(m_matOut, t_iNum, m_iHop);
+    m_iNumIn = t_iNum;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtTsssAlgo::whitening(const MatrixXd &p_matGram)
+{
+    SelfAdjointEigenSolver<MatrixXd> t_eig(p_matGram);
+
+    const VectorXd &t_vecEval = t_eig.eigenvalues();
+    const double t_dMax = t_vecEval.size() > 0 ? t_vecEval(t_vecEval.size() - 1) : 0.0;
+
+    // Eigenvalues are sorted in increasing order
+    qint32 t_iFirst = 0;
+    while(t_iFirst < t_vecEval.size() && t_vecEval(t_iFirst) <= TSSS_EIG_TOL * t_dMax)
+        ++t_iFirst;
+
+    if(t_dMax <= 0.0)
+        t_iFirst = t_vecEval.size();
+
+    const qint32 t_iRank = t_vecEval.size() - t_iFirst;
+
+    MatrixXd t_matWhite = t_eig.eigenvectors().rightCols(t_iRank);
+    for(qint32 i = 0; i < t_iRank; ++i)
+        t_matWhite.col(i) /= std::sqrt(t_vecEval(t_iFirst + i));
+
+    return t_matWhite;
+}
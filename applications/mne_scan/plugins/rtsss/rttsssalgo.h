@@ -0,0 +1,197 @@
+//=============================================================================================================
+/**
+* @file     rttsssalgo.h
+* @author   Seok Lew <slew@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the RtTsssAlgo class.
+*
+*/
+
+
+#ifndef RTTSSSALGO_H
+#define RTTSSSALGO_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Dense>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtGlobal>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE RtSssPlugin
+//=============================================================================================================
+
+namespace RtSssPlugin
+{
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS RtTsssAlgo
+*
+* @brief The RtTsssAlgo class removes the temporal components which the internal and the external SSS
+* expansions have in common (temporal SSS) on a stream of SSS coefficients.
+*
+* The coefficients are processed in sliding windows of p_iBufferSamples samples with a hop of half a window. The
+* correlation of a window is assembled from the Gram matrices of its two half windows, so every sample enters the
+* Gram matrices once. The cleaned windows are overlap-added with a periodic Hann window, which sums to one at a
+* hop of half a window. A sample leaves the stage at the latest one window after it was appended.
+*/
+class RtTsssAlgo
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a RtTsssAlgo.
+    *
+    * @param[in] p_iBufferSamples   The length of the correlation window in samples, rounded up to an even number.
+    * @param[in] p_dCorrLimit       The subspace correlation at which a temporal component is removed.
+    */
+    RtTsssAlgo(qint32 p_iBufferSamples, double p_dCorrLimit);
+
+    //=========================================================================================================
+    /**
+    * Drops all buffered samples, e.g. when the number of expansion coefficients changes.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Appends a block of samples. The stage is reset when the number of rows differs from the buffered samples.
+    *
+    * @param[in] p_matRaw       The measured block with all channels, it is delayed alongside the coefficients.
+    * @param[in] p_matCoeffIn   The internal expansion coefficients of the block.
+    * @param[in] p_matCoeffOut  The external expansion coefficients of the block.
+    */
+    void append(const Eigen::MatrixXd &p_matRaw, const Eigen::MatrixXd &p_matCoeffIn, const Eigen::MatrixXd &p_matCoeffOut);
+
+    //=========================================================================================================
+    /**
+    * Takes a block of cleaned samples.
+    *
+    * @param[in] p_iSamples         The number of samples to take.
+    * @param[out] p_matRaw          The delayed measured block.
+    * @param[out] p_matCoeffIn      The cleaned internal expansion coefficients of the block.
+    *
+    * @return true if enough cleaned samples were available, false otherwise.
+    */
+    bool take(qint32 p_iSamples, Eigen::MatrixXd &p_matRaw, Eigen::MatrixXd &p_matCoeffIn);
+
+    //=========================================================================================================
+    /**
+    * Returns the maximal delay of a sample in the stage.
+    *
+    * @return the latency in samples.
+    */
+    inline qint32 latency() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of temporal components removed from the last window.
+    *
+    * @return the number of removed components.
+    */
+    inline qint32 getNumComponents() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Cleans the oldest window and moves its first half to the output.
+    */
+    void processWindow();
+
+    //=========================================================================================================
+    /**
+    * Returns the orthonormal eigenvectors of a Gram matrix scaled by the inverse square roots of their eigenvalues,
+    * i.e. the whitening of the rows. Eigenvalues close to zero are dropped.
+    *
+    * @param[in] p_matGram  The Gram matrix.
+    *
+    * @return the whitening matrix with one column per retained eigenvalue.
+    */
+    static Eigen::MatrixXd whitening(const Eigen::MatrixXd &p_matGram);
+
+    qint32  m_iWindow;          /**< The correlation window length in samples. */
+    qint32  m_iHop;             /**< The hop between two windows, half a window. */
+    double  m_dCorrLimit;       /**< The subspace correlation at which a component is removed. */
+    qint32  m_iNumComponents;   /**< The number of components removed from the last window. */
+
+    Eigen::RowVectorXd  m_vecHann;  /**< The periodic Hann window. */
+
+    Eigen::MatrixXd m_matRaw;       /**< The measured samples which were not processed yet. */
+    Eigen::MatrixXd m_matIn;        /**< The internal coefficients which were not processed yet. */
+    Eigen::MatrixXd m_matOut;       /**< The external coefficients which were not processed yet. */
+    qint32          m_iNumIn;       /**< The number of samples which were not processed yet. */
+
+    Eigen::MatrixXd m_matGramIn;    /**< The internal Gram matrix of the first half of the next window. */
+    Eigen::MatrixXd m_matGramOut;   /**< The external Gram matrix of the first half of the next window. */
+    Eigen::MatrixXd m_matCross;     /**< The cross Gram matrix of the first half of the next window. */
+    bool            m_bFirstWindow; /**< If no window was processed since the last reset. */
+
+    Eigen::MatrixXd m_matPending;   /**< The weighted second half of the last cleaned window. */
+
+    Eigen::MatrixXd m_matRawReady;  /**< The delayed measured samples of the cleaned samples. */
+    Eigen::MatrixXd m_matInReady;   /**< The cleaned internal coefficients. */
+    qint32          m_iNumReady;    /**< The number of cleaned samples. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint32 RtTsssAlgo::latency() const
+{
+    return m_iWindow;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 RtTsssAlgo::getNumComponents() const
+{
+    return m_iNumComponents;
+}
+
+} // NAMESPACE
+
+#endif // RTTSSSALGO_H
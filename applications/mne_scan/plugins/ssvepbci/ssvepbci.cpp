@@ -214,6 +214,7 @@ bool SsvepBci::start()
     m_iDownSampleIndex   = 0;
     m_iFormerDownSampleIndex = 0;
     m_iWindowSize        = 8;
+    m_ssvepBciDetector.reset();
     m_bIsRunning    = true;
 
     // starting the thread for data processing
@@ -539,6 +540,7 @@ void SsvepBci::changeSSVEPParameter(){
             m_iReadToWriteBuffer = 0;
             m_iDownSampleIndex   = 0;
             m_iFormerDownSampleIndex = 0;
+            m_ssvepBciDetector.reset();
 
             // resize the time window with new electrode numbers
             m_matSlidingTimeWindow.resize(m_lElectrodeNumbers.size(), m_iTimeWindowLength);
@@ -739,9 +741,19 @@ void SsvepBci::ssvepBciOnSensor()
     // calculate buffer between read- and write index
     m_iReadToWriteBuffer = m_iReadToWriteBuffer + writtenSamples;
 
+    // the detector keeps the segment statistics of the largest window, new parameters restart it
+    m_ssvepBciDetector.setParameters(m_lAllFrequencies, m_iNumberOfHarmonics, m_iPowerLine, m_dSampleFrequency, m_iReadSampleSize, 40);
+
     // execute processing loop as long as there is new data to be red from the time window
     while(m_iReadToWriteBuffer >= m_iReadSampleSize)
     {
+        // reduce the newest read segment to its statistics
+        MatrixXd t_matSegment(m_matSlidingTimeWindow.rows(), m_iReadSampleSize);
+        for(int j = 0; j < m_iReadSampleSize; j++){
+            t_matSegment.col(j) = m_matSlidingTimeWindow.col((m_iReadIndex - (m_iReadSampleSize - 1) + j + m_iTimeWindowLength) % m_iTimeWindowLength);
+        }
+        m_ssvepBciDetector.addSegment(t_matSegment);
+
         if(m_iCounter > m_iNumberOfClassBreaks)
         {
             // determine window size according to former counted miss classifications
@@ -753,44 +765,46 @@ void SsvepBci::ssvepBciOnSensor()
                 m_iWindowSize = 40;
             }
 
-            // create current data matrix Y
-            MatrixXd Y;
-            readFromSlidingTimeWindow(Y);
-
-            // create realtive timeline according to Y
-            int samples = Y.rows();
-            ArrayXd t = 2*M_PI/m_dSampleFrequency * ArrayXd::LinSpaced(samples, 1, samples);
-
-            // Remove 50 Hz Power line signal
-            if(m_bRemovePowerLine){
-                MatrixXd Zp(samples,2);
-                ArrayXd t_PL = t*m_iPowerLine;
-                Zp.col(0) = t_PL.sin();
-                Zp.col(1) = t_PL.cos();
-                MatrixXd Zp_help = Zp.transpose()*Zp;
-                Y = Y - Zp*Zp_help.inverse()*Zp.transpose()*Y;
-            }
-
-            qDebug() << "size of Matrix:" << Y.rows() << Y.cols();
-
-            // apply feature extraction for all frequencies of interest
+            // apply feature extraction for all frequencies of interest from the segment statistics, the samples
+            // of the window are only read again while the detector has not yet seen enough segments
             VectorXd ssvepProbabilities(m_lAllFrequencies.size());
-            for(int i = 0; i < m_lAllFrequencies.size(); i++)
+            if(!m_ssvepBciDetector.calcFeatures(m_iWindowSize, m_bRemovePowerLine, m_bUseMEC, ssvepProbabilities))
             {
-                // create reference signal matrix X
-                MatrixXd X(samples, 2*m_iNumberOfHarmonics);
-                for(int k = 0; k < m_iNumberOfHarmonics; k++){
-                    ArrayXd t_k = t*(k+1)*m_lAllFrequencies.at(i);
-                    X.col(2*k)      = t_k.sin();
-                    X.col(2*k+1)    = t_k.cos();
+                // create current data matrix Y
+                MatrixXd Y;
+                readFromSlidingTimeWindow(Y);
+
+                // create realtive timeline according to Y
+                int samples = Y.rows();
+                ArrayXd t = 2*M_PI/m_dSampleFrequency * ArrayXd::LinSpaced(samples, 1, samples);
+
+                // Remove 50 Hz Power line signal
+                if(m_bRemovePowerLine){
+                    MatrixXd Zp(samples,2);
+                    ArrayXd t_PL = t*m_iPowerLine;
+                    Zp.col(0) = t_PL.sin();
+                    Zp.col(1) = t_PL.cos();
+                    MatrixXd Zp_help = Zp.transpose()*Zp;
+                    Y = Y - Zp*Zp_help.inverse()*Zp.transpose()*Y;
                 }
 
-                // extracting the features from the data Y with the reference signal X
-                if(m_bUseMEC){
-                    ssvepProbabilities(i) = MEC(Y, X); // using Minimum Energy Combination as feature-extraction tool
-                }
-                else{
-                    ssvepProbabilities(i) = CCA(Y, X); // using Canonical Correlation Analysis as feature-extraction tool
+                for(int i = 0; i < m_lAllFrequencies.size(); i++)
+                {
+                    // create reference signal matrix X
+                    MatrixXd X(samples, 2*m_iNumberOfHarmonics);
+                    for(int k = 0; k < m_iNumberOfHarmonics; k++){
+                        ArrayXd t_k = t*(k+1)*m_lAllFrequencies.at(i);
+                        X.col(2*k)      = t_k.sin();
+                        X.col(2*k+1)    = t_k.cos();
+                    }
+
+                    // extracting the features from the data Y with the reference signal X
+                    if(m_bUseMEC){
+                        ssvepProbabilities(i) = MEC(Y, X); // using Minimum Energy Combination as feature-extraction tool
+                    }
+                    else{
+                        ssvepProbabilities(i) = CCA(Y, X); // using Canonical Correlation Analysis as feature-extraction tool
+                    }
                 }
             }
 
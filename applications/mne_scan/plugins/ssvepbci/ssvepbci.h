@@ -44,6 +44,7 @@
 //=============================================================================================================
 
 #include "ssvepbci_global.h"
+#include "ssvepbcidetector.h"
 
 #include <scShared/Interfaces/IAlgorithm.h>
 #include <utils/generics/circularmatrixbuffer.h>
@@ -428,6 +429,7 @@ private:
     int                     m_iReadToWriteBuffer;               /**< number of samples from the current readindex to current write index */
     int                     m_iNumberOfClassBreaks;             /**< number of classifiactions whicht will be skipped if a classifiaction was made */
     int                     m_iWindowSize;                      /**< size of current time window */
+    SsvepBciDetector        m_ssvepBciDetector;                 /**< MEC and CCA from the statistics of the read segments of the sliding time window */
     // SSVEP parameter
     QList<int>              m_lElectrodeNumbers;                /**< Sensor level: numbers of chosen electrode channels. */
     QList<double>           m_lDesFrequencies;                  /**< Contains desired frequencies. */
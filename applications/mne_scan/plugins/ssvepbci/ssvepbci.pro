@@ -80,6 +80,7 @@ SOURCES += \
         ssvepbciflickeringitem.cpp \
         FormFiles/ssvepbciconfigurationwidget.cpp \
         screenkeyboard.cpp \
+        ssvepbcidetector.cpp \
 
 HEADERS += \
         ssvepbci.h\
@@ -91,6 +92,7 @@ HEADERS += \
         ssvepbciflickeringitem.h \
         FormFiles/ssvepbciconfigurationwidget.h \
         screenkeyboard.h \
+        ssvepbcidetector.h \
 
 
 FORMS += \
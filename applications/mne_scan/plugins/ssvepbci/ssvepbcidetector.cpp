@@ -0,0 +1,325 @@
+//=============================================================================================================
+/**
+* @file     ssvepbcidetector.cpp
+* @author   Viktor Klüber <viktor.klueber@tu-ilmenau.de>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Viktor Klüber, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the SsvepBciDetector class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "ssvepbcidetector.h"
+
+#include <complex>
+#include <math.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SSVEPBCIPLUGIN;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+    const double WHITENING_TOL = 1e-12;     /**< Eigenvalues below this fraction of the largest one span no signal. */
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+SsvepBciDetector::SsvepBciDetector()
+: m_iNumberOfHarmonics(0)
+, m_dPowerLine(0)
+, m_dSampleFrequency(0)
+, m_iSegmentSize(0)
+, m_iMaxSegments(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void SsvepBciDetector::setParameters(const QList<double> &lFrequencies, int iNumberOfHarmonics, double dPowerLine, double dSampleFrequency, int iSegmentSize, int iMaxSegments)
+{
+    if(lFrequencies == m_lFrequencies && iNumberOfHarmonics == m_iNumberOfHarmonics && dPowerLine == m_dPowerLine
+            && dSampleFrequency == m_dSampleFrequency && iSegmentSize == m_iSegmentSize && iMaxSegments == m_iMaxSegments){
+        return;
+    }
+
+    m_lFrequencies = lFrequencies;
+    m_iNumberOfHarmonics = iNumberOfHarmonics;
+    m_dPowerLine = dPowerLine;
+    m_dSampleFrequency = dSampleFrequency;
+    m_iSegmentSize = iSegmentSize;
+    m_iMaxSegments = iMaxSegments;
+
+    // spectral lines of all frequencies and harmonics, the power line last
+    int iLines = m_lFrequencies.size()*m_iNumberOfHarmonics + 1;
+    m_vecOmega.resize(iLines);
+    for(int i = 0; i < m_lFrequencies.size(); i++){
+        for(int k = 0; k < m_iNumberOfHarmonics; k++){
+            m_vecOmega(i*m_iNumberOfHarmonics + k) = 2*M_PI/m_dSampleFrequency * (k+1)*m_lFrequencies.at(i);
+        }
+    }
+    m_vecOmega(iLines - 1) = 2*M_PI/m_dSampleFrequency * m_dPowerLine;
+
+    m_matPhasors.resize(m_iSegmentSize, iLines);
+    for(int j = 0; j < m_iSegmentSize; j++){
+        for(int q = 0; q < iLines; q++){
+            m_matPhasors(j, q) = std::polar(1.0, m_vecOmega(q)*j);
+        }
+    }
+
+    m_mapReferences.clear();
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void SsvepBciDetector::reset()
+{
+    m_lSegments.clear();
+}
+
+
+//*************************************************************************************************************
+
+void SsvepBciDetector::addSegment(const MatrixXd &matSegment)
+{
+    if(matSegment.cols() != m_iSegmentSize){
+        qWarning() << "SsvepBciDetector::addSegment - segment size" << matSegment.cols() << "does not match" << m_iSegmentSize;
+        return;
+    }
+
+    // a new channel selection starts a new window
+    if(!m_lSegments.isEmpty() && m_lSegments.first().vecSum.size() != matSegment.rows()){
+        m_lSegments.clear();
+    }
+
+    SegmentStatistics t_segment;
+    t_segment.vecSum = matSegment.rowwise().sum();
+    t_segment.matGram = matSegment * matSegment.transpose();
+    t_segment.matSpectrum = matSegment.cast<std::complex<double> >() * m_matPhasors;
+
+    m_lSegments.append(t_segment);
+    while(m_lSegments.size() > m_iMaxSegments){
+        m_lSegments.removeFirst();
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool SsvepBciDetector::calcFeatures(int iNumSegments, bool bRemovePowerLine, bool bUseMEC, VectorXd &vecFeatures)
+{
+    if(iNumSegments <= 0 || iNumSegments > m_lSegments.size()){
+        return false;
+    }
+
+    int iHarmonics = m_iNumberOfHarmonics;
+    int iLines = m_vecOmega.size();
+    int iChannels = m_lSegments.first().vecSum.size();
+    int iSamples = iNumSegments*m_iSegmentSize;
+
+    // assemble the window: the spectral lines are shifted from the segment starts to the window timeline (1..n)
+    VectorXd vecSumY = VectorXd::Zero(iChannels);
+    MatrixXd matYY = MatrixXd::Zero(iChannels, iChannels);
+    MatrixXcd matSpectrum = MatrixXcd::Zero(iChannels, iLines);
+    VectorXcd vecShift(iLines);
+
+    for(int b = 0; b < iNumSegments; b++){
+        const SegmentStatistics &t_segment = m_lSegments.at(m_lSegments.size() - iNumSegments + b);
+
+        for(int q = 0; q < iLines; q++){
+            vecShift(q) = std::polar(1.0, m_vecOmega(q)*(b*m_iSegmentSize + 1));
+        }
+
+        vecSumY += t_segment.vecSum;
+        matYY += t_segment.matGram;
+        matSpectrum += t_segment.matSpectrum * vecShift.asDiagonal();
+    }
+
+    // projections onto the reference signals: sine rows are imaginary, cosine rows are real parts
+    MatrixXd matXY(2*iLines, iChannels);
+    for(int q = 0; q < iLines; q++){
+        matXY.row(2*q)      = matSpectrum.col(q).imag().transpose();
+        matXY.row(2*q+1)    = matSpectrum.col(q).real().transpose();
+    }
+
+    const ReferenceStatistics &t_reference = referenceStatistics(iSamples);
+
+    // Remove power line signal: Y <- (I - Zp*(Zp'*Zp)^-1*Zp')*Y expressed by the sums and cross products
+    if(bRemovePowerLine){
+        int p = 2*(iLines - 1);
+        MatrixXd matZpPinv = whitening(t_reference.matGram.block(p, p, 2, 2));
+        matZpPinv = matZpPinv*matZpPinv.transpose();
+
+        MatrixXd matZpY = matXY.middleRows(p, 2);
+        MatrixXd matProj = matZpPinv*matZpY;
+
+        matYY -= matZpY.transpose()*matProj;
+        vecSumY -= (t_reference.vecSum.segment(p, 2).transpose()*matProj).transpose();
+        matXY -= t_reference.matGram.middleCols(p, 2)*matProj;
+    }
+
+    vecFeatures.resize(m_lFrequencies.size());
+
+    MatrixXd matWy;
+    if(!bUseMEC){
+        VectorXd vecMeanY = vecSumY/iSamples;
+        matWy = whitening(matYY - iSamples*vecMeanY*vecMeanY.transpose());
+    }
+
+    for(int i = 0; i < m_lFrequencies.size(); i++){
+        int c = 2*i*iHarmonics;
+        MatrixXd matXX = t_reference.matGram.block(c, c, 2*iHarmonics, 2*iHarmonics);
+        MatrixXd matXiY = matXY.middleRows(c, 2*iHarmonics);
+
+        if(bUseMEC){
+            // Minimum Energy Combination: remove SSVEP harmonic frequencies and find the noise eigenvalues
+            MatrixXd matYtYt = matYY - matXiY.transpose()*matXX.inverse()*matXiY;
+            SelfAdjointEigenSolver<MatrixXd> eigensolver(matYtYt);
+
+            // Determine number of channels Ns
+            int Ns;
+            VectorXd cumsum = eigensolver.eigenvalues();
+            for(int j = 1; j < cumsum.size(); j++){
+                cumsum(j) += cumsum(j - 1);
+            }
+            for(Ns = 0; Ns < cumsum.size(); Ns++){
+                if(cumsum(Ns)/eigensolver.eigenvalues().sum() > 0.1){
+                    break;
+                }
+            }
+            Ns += 1;
+
+            // Signal energy of the spatially filtered channels S = Y*W on all harmonics
+            MatrixXd W = eigensolver.eigenvectors().leftCols(Ns);
+            for(int k = 0; k < Ns; k++){
+                W.col(k) = W.col(k)*(1/sqrt(eigensolver.eigenvalues()(k)));
+            }
+
+            MatrixXd P = matXiY*W;
+            vecFeatures(i) = 1 / double(iHarmonics*Ns) * P.array().square().sum();
+        }
+        else{
+            // Canonical Correlation Analysis: largest singular value of the whitened centered cross covariance
+            VectorXd vecMeanX = t_reference.vecSum.segment(c, 2*iHarmonics)/iSamples;
+            VectorXd vecMeanY = vecSumY/iSamples;
+
+            MatrixXd matWx = whitening(matXX - iSamples*vecMeanX*vecMeanX.transpose());
+            MatrixXd matSxy = matXiY - iSamples*vecMeanX*vecMeanY.transpose();
+
+            if(matWx.cols() == 0 || matWy.cols() == 0){
+                vecFeatures(i) = 0;
+            }
+            else{
+                JacobiSVD<MatrixXd> svd(matWx.transpose()*matSxy*matWy);
+                vecFeatures(i) = svd.singularValues().maxCoeff();
+            }
+        }
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+const SsvepBciDetector::ReferenceStatistics& SsvepBciDetector::referenceStatistics(int iSamples)
+{
+    if(!m_mapReferences.contains(iSamples)){
+        // reference sines and cosines on the window timeline 1..n
+        ArrayXd t = ArrayXd::LinSpaced(iSamples, 1, iSamples);
+        MatrixXd matX(iSamples, 2*m_vecOmega.size());
+        for(int q = 0; q < m_vecOmega.size(); q++){
+            ArrayXd t_q = t*m_vecOmega(q);
+            matX.col(2*q)   = t_q.sin();
+            matX.col(2*q+1) = t_q.cos();
+        }
+
+        ReferenceStatistics t_reference;
+        t_reference.vecSum = matX.colwise().sum().transpose();
+        t_reference.matGram = matX.transpose()*matX;
+        m_mapReferences.insert(iSamples, t_reference);
+    }
+
+    return m_mapReferences[iSamples];
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd SsvepBciDetector::whitening(const MatrixXd &matS)
+{
+    SelfAdjointEigenSolver<MatrixXd> eigensolver(matS);
+    const VectorXd &vecEig = eigensolver.eigenvalues();
+
+    double dTol = WHITENING_TOL * vecEig.cwiseAbs().maxCoeff();
+    int iRank = 0;
+    for(int k = 0; k < vecEig.size(); k++){
+        if(vecEig(k) > dTol && vecEig(k) > 0){
+            iRank++;
+        }
+    }
+
+    // eigenvalues are sorted in increasing order, the range is spanned by the last ones
+    MatrixXd matW = eigensolver.eigenvectors().rightCols(iRank);
+    for(int k = 0; k < iRank; k++){
+        matW.col(k) /= sqrt(vecEig(vecEig.size() - iRank + k));
+    }
+
+    return matW;
+}
@@ -0,0 +1,202 @@
+//=============================================================================================================
+/**
+* @file     ssvepbcidetector.h
+* @author   Viktor Klüber <viktor.klueber@tu-ilmenau.de>;
+*           Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Viktor Klüber, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the SsvepBciDetector class.
+*
+*/
+
+#ifndef SSVEPBCIDETECTOR_H
+#define SSVEPBCIDETECTOR_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <ssvepbci_global.h>
+
+#include <Eigen/Dense>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QList>
+#include <QMap>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SSVEPBCIPLUGIN
+//=============================================================================================================
+
+namespace SSVEPBCIPLUGIN
+{
+
+//=============================================================================================================
+/**
+* DECLARE CLASS SsvepBciDetector
+*
+* @brief SsvepBciDetector evaluates MEC and CCA on a sliding time window without touching the samples of the
+* window again. Every read segment is reduced once to its channel sums, its channel covariance and its spectral
+* lines at all stimulus frequencies, harmonics and the power line. A window is assembled from these segment
+* statistics by phase shifting the spectral lines to the window start, so MEC and CCA only solve problems of the
+* size of the channel and harmonic numbers.
+*/
+class SSVEPBCISHARED_EXPORT SsvepBciDetector
+{
+
+public:
+    //=========================================================================================================
+    /**
+    * constructs a SsvepBciDetector object
+    */
+    SsvepBciDetector();
+
+    //=========================================================================================================
+    /**
+    * Sets the detection parameters. The collected segments are dropped if any of the parameters changed.
+    *
+    * @param[in]  lFrequencies          frequencies which are examined [Hz].
+    * @param[in]  iNumberOfHarmonics    number of harmonics of the reference signals, including the fundamental.
+    * @param[in]  dPowerLine            power line frequency [Hz].
+    * @param[in]  dSampleFrequency      sample frequency of the segments [Hz].
+    * @param[in]  iSegmentSize          number of samples of one segment.
+    * @param[in]  iMaxSegments          maximal number of segments of one window.
+    */
+    void setParameters(const QList<double> &lFrequencies, int iNumberOfHarmonics, double dPowerLine, double dSampleFrequency, int iSegmentSize, int iMaxSegments);
+
+    //=========================================================================================================
+    /**
+    * Drops all collected segments.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Adds the newest segment of the sliding time window. The oldest segment is dropped when more than the
+    * maximal number of segments are held.
+    *
+    * @param[in]  matSegment    segment data (channels x samples).
+    */
+    void addSegment(const Eigen::MatrixXd &matSegment);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of collected segments.
+    *
+    * @return number of segments which are available for a window.
+    */
+    inline int getNumSegments() const;
+
+    //=========================================================================================================
+    /**
+    * Calculates the MEC energies or the CCA correlations of all frequencies for the window made of the newest
+    * segments. The results equal SsvepBci::MEC and SsvepBci::CCA applied to the same samples.
+    *
+    * @param[in]  iNumSegments      number of segments of the window.
+    * @param[in]  bRemovePowerLine  whether the power line is projected out of the data first.
+    * @param[in]  bUseMEC           true for MEC, false for CCA.
+    * @param[out] vecFeatures       one feature per frequency.
+    *
+    * @return false if not enough segments are available.
+    */
+    bool calcFeatures(int iNumSegments, bool bRemovePowerLine, bool bUseMEC, Eigen::VectorXd &vecFeatures);
+
+private:
+    //=========================================================================================================
+    /**
+    * Statistics of one segment.
+    */
+    struct SegmentStatistics {
+        Eigen::VectorXd     vecSum;         /**< Sum of the samples of each channel. */
+        Eigen::MatrixXd     matGram;        /**< Channel cross products (channels x channels). */
+        Eigen::MatrixXcd    matSpectrum;    /**< Spectral lines relative to the segment start (channels x lines). */
+    };
+
+    //=========================================================================================================
+    /**
+    * Sums and cross products of the reference sines and cosines of one window length.
+    */
+    struct ReferenceStatistics {
+        Eigen::VectorXd     vecSum;         /**< Sum of each reference signal. */
+        Eigen::MatrixXd     matGram;        /**< Cross products of the reference signals. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Returns the reference statistics for a window length, they are calculated at the first request.
+    *
+    * @param[in]  iSamples      number of samples of the window.
+    *
+    * @return the reference statistics.
+    */
+    const ReferenceStatistics& referenceStatistics(int iSamples);
+
+    //=========================================================================================================
+    /**
+    * Calculates a matrix W with W^T*S*W = I on the range of the symmetric positive semidefinite matrix S.
+    *
+    * @param[in]  matS      symmetric matrix.
+    *
+    * @return the whitening matrix.
+    */
+    static Eigen::MatrixXd whitening(const Eigen::MatrixXd &matS);
+
+    QList<double>                   m_lFrequencies;         /**< Examined frequencies [Hz]. */
+    int                             m_iNumberOfHarmonics;   /**< Number of harmonics including the fundamental. */
+    double                          m_dPowerLine;           /**< Power line frequency [Hz]. */
+    double                          m_dSampleFrequency;     /**< Sample frequency [Hz]. */
+    int                             m_iSegmentSize;         /**< Number of samples of one segment. */
+    int                             m_iMaxSegments;         /**< Maximal number of segments of one window. */
+
+    Eigen::VectorXd                 m_vecOmega;             /**< Angular frequency of each spectral line [rad/sample]; frequency-major with the harmonics, the power line last. */
+    Eigen::MatrixXcd                m_matPhasors;           /**< Phasors of the spectral lines over one segment (samples x lines). */
+    QList<SegmentStatistics>        m_lSegments;            /**< Statistics of the newest segments, the oldest first. */
+    QMap<int, ReferenceStatistics>  m_mapReferences;        /**< Reference statistics per window length. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int SsvepBciDetector::getNumSegments() const
+{
+    return m_lSegments.size();
+}
+
+}       // NAMESPACE
+
+#endif  // SSVEPBCIDETECTOR_H
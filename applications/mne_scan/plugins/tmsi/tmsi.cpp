@@ -42,6 +42,8 @@
 #include "tmsi.h"
 #include "tmsiproducer.h"
 
+#include <scShared/Management/metricsregistry.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -69,7 +71,6 @@ using namespace TMSIPlugin;
 TMSI::TMSI()
 : m_pRMTSA_TMSI(0)
 , m_qStringResourcePath(qApp->applicationDirPath()+"/resources/mne_scan/plugins/tmsi/")
-, m_pRawMatrixBuffer_In(0)
 , m_pTMSIProducer(new TMSIProducer(this))
 {
     // Create record file option action bar item/button
@@ -512,9 +513,7 @@ bool TMSI::start()
     m_pRMTSA_TMSI->data()->setMultiArraySize(m_iSamplesPerBlock);
     m_pRMTSA_TMSI->data()->setSamplingRate(m_iSamplingFreq);
 
-    //Buffer
-    m_pRawMatrixBuffer_In = QSharedPointer<RawMatrixBuffer>(new RawMatrixBuffer(8, m_iNumberOfChannels, m_iSamplesPerBlock));
-
+    //The producer holds the ring buffer of the incoming raw data
     m_pTMSIProducer->start(m_iNumberOfChannels,
                        m_iSamplingFreq,
                        m_iSamplesPerBlock,
@@ -559,10 +558,10 @@ bool TMSI::stop()
     //Wait until this thread (TMSI) is stopped
     m_bIsRunning = false;
 
-    //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the pop function (acquire statement)
-    m_pRawMatrixBuffer_In->releaseFromPop();
+    //In case the ring blocks the thread -> Release it and let it exit from the pop function
+    m_pTMSIProducer->releaseFromPop();
 
-    m_pRawMatrixBuffer_In->clear();
+    m_pTMSIProducer->clear();
 
     m_pRMTSA_TMSI->data()->clear();
 
@@ -649,24 +648,22 @@ void TMSI::splitRecordingFile()
 void TMSI::run()
 {
     qint32 size = 0;
+    MatrixXf matValue;
 
     while(m_bIsRunning)
     {
         //std::cout<<"TMSI::run(s)"<<std::endl;
 
         // Check impedances - send new impedance values to graphic scene
-        if(m_pTMSIProducer->isRunning() && m_bCheckImpedances)
+        if(m_pTMSIProducer->isRunning() && m_bCheckImpedances && m_pTMSIProducer->pop(matValue))
         {
-            MatrixXf matValue = m_pRawMatrixBuffer_In->pop();
-
             for(qint32 i = 0; i < matValue.cols(); ++i)
                 m_pTmsiImpedanceWidget->updateGraphicScene(matValue.col(i).cast<double>());
         }
 
         //pop matrix only if the producer thread is running
-        if(m_pTMSIProducer->isRunning() && !m_bCheckImpedances)
+        if(m_pTMSIProducer->isRunning() && !m_bCheckImpedances && m_pTMSIProducer->pop(matValue))
         {
-            MatrixXf matValue = m_pRawMatrixBuffer_In->pop();
 
             // Set Beep trigger (if activated)
             if(m_bBeepTrigger && m_qTimerTrigger.elapsed() >= m_iTriggerInterval)
@@ -684,6 +681,7 @@ void TMSI::run()
             //Write raw data to fif file
             if(m_bWriteToFile) {
                 m_pOutfid->write_raw_buffer(matValue.cast<double>(), m_cals);
+                SCSHAREDLIB::MetricsRegistry::addCounter(QString("%1/recording: samples").arg(getName()), matValue.cols());
                 size += matValue.cols();
 
 //                qDebug()<<"size"<<size;
@@ -362,7 +362,7 @@ bool TMSIDriver::uninitDevice()
 
 //*************************************************************************************************************
 
- bool TMSIDriver::getSampleMatrixValue(MatrixXf& sampleMatrix)
+ bool TMSIDriver::getSampleMatrixValue(Ref<MatrixXf> sampleMatrix)
 {
     //Check if the driver DLL was loaded
     if(!m_bDllLoaded)
@@ -375,12 +375,33 @@ bool TMSIDriver::uninitDevice()
         return false;
     }
 
+    if(sampleMatrix.rows() != (int)m_uiNumberOfChannels || sampleMatrix.cols() != (int)m_uiSamplesPerBlock)
+    {
+        cout << "Plugin TMSI - ERROR - getSampleMatrixValue() - The matrix is of size " << sampleMatrix.rows() << "x" << sampleMatrix.cols() << " instead of " << m_uiNumberOfChannels << "x" << m_uiSamplesPerBlock << endl;
+        return false;
+    }
+
     sampleMatrix.setZero(); // Clear matrix - set all elements to zero
     uint iSamplesWrittenToMatrix = 0;
     int channelMax = 0;
     int sampleMax = 0;
     int sampleIterator = 0;
 
+    //If the number of available channels is smaller than the number defined by the user -> set the channelMax to the smaller number
+    if(m_uiNumberOfAvailableChannels < m_uiNumberOfChannels)
+        channelMax = m_uiNumberOfAvailableChannels;
+    else
+        channelMax = m_uiNumberOfChannels;
+
+    //Gain, offset and exponent of each channel are the same for all samples of the block
+    QVector<double> vecGain(channelMax), vecOffset(channelMax), vecScale(channelMax);
+    for(int channelIterator = 0; channelIterator < channelMax; channelIterator++)
+    {
+        vecGain[channelIterator] = m_bUseUnitGain ? m_vUnitGain[channelIterator] : 1;
+        vecOffset[channelIterator] = m_bUseUnitOffset ? m_vUnitOffSet[channelIterator] : 0;
+        vecScale[channelIterator] = m_bUseChExponent ? pow(10., (double)m_vExponentChannel[channelIterator]) : 1;
+    }
+
     //get samples from device until the complete matrix is filled, i.e. the samples per block size is met
     while(iSamplesWrittenToMatrix < m_uiSamplesPerBlock)
     {
@@ -400,12 +421,6 @@ bool TMSIDriver::uninitDevice()
                     m_vSampleBlockBuffer.push_back((double)m_lSignalBuffer[j]);
             }
 
-            //If the number of available channels is smaller than the number defined by the user -> set the channelMax to the smaller number
-            if(m_uiNumberOfAvailableChannels < m_uiNumberOfChannels)
-                channelMax = m_uiNumberOfAvailableChannels;
-            else
-                channelMax = m_uiNumberOfChannels;
-
             //If the number of the samples which were already written to the matrix plus the last received number of samples is larger then the defined block size
             //-> only fill until the matrix is completeley filled with samples. The other (unused) samples are still stored in the vector buffer m_vSampleBlockBuffer and will be used in the next matrix which is to be sent to the circular buffer
             if(iSamplesWrittenToMatrix + ulNumSamplesReceived > m_uiSamplesPerBlock)
@@ -413,18 +428,20 @@ bool TMSIDriver::uninitDevice()
             else
                 sampleMax = ulNumSamplesReceived + sampleIterator;
 
-            //Read the needed number of samples from the vector buffer to store them in the matrix
+            //Read the needed number of samples from the vector buffer to store them in the matrix, the read samples are removed at once afterwards
+            const double* pSampleBlockBuffer = m_vSampleBlockBuffer.constData();
+            int iBufferIndex = 0;
+
             for(; sampleIterator < sampleMax; sampleIterator++)
             {
                 for(int channelIterator = 0; channelIterator < channelMax; channelIterator++)
-                {
-                    sampleMatrix(channelIterator, sampleIterator) = ((m_vSampleBlockBuffer.first() * (m_bUseUnitGain ? m_vUnitGain[channelIterator] : 1)) + (m_bUseUnitOffset ? m_vUnitOffSet[channelIterator] : 0)) * (m_bUseChExponent ? pow(10., (double)m_vExponentChannel[channelIterator]) : 1);
-                    m_vSampleBlockBuffer.pop_front();
-                }
+                    sampleMatrix(channelIterator, sampleIterator) = (pSampleBlockBuffer[iBufferIndex++] * vecGain[channelIterator] + vecOffset[channelIterator]) * vecScale[channelIterator];
 
                 actualSamplesWritten ++;
             }
 
+            m_vSampleBlockBuffer.remove(0, iBufferIndex);
+
             iSamplesWrittenToMatrix = iSamplesWrittenToMatrix + actualSamplesWritten;
         }
 
@@ -288,11 +288,12 @@ public:
 
     //=========================================================================================================
     /**
-    * Get sample from the device in form of a mtrix.
+    * Get sample from the device in form of a mtrix. The matrix is filled in place and has to be of size
+    * number of channels x samples per block.
     * @param [in] MatrixXf the block sample values in form of a matrix.
     * @param [out] bool returns true if sample was successfully written to the input variable, false otherwise.
     */
-    bool getSampleMatrixValue(MatrixXf& sampleMatrix);
+    bool getSampleMatrixValue(Ref<MatrixXf> sampleMatrix);
 
     //=========================================================================================================
     /**
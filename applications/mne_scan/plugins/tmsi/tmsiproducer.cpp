@@ -62,8 +62,8 @@ using namespace TMSIPlugin;
 TMSIProducer::TMSIProducer(TMSI* pTMSI)
 : m_pTMSI(pTMSI)
 , m_pTMSIDriver(new TMSIDriver(this))
-, m_bIsRunning(true)
 {
+    setObjectName("TMSI");
 }
 
 
@@ -72,6 +72,8 @@ TMSIProducer::TMSIProducer(TMSI* pTMSI)
 TMSIProducer::~TMSIProducer()
 {
     //cout << "TMSIProducer::~TMSIProducer()" << endl;
+    if(this->isRunning())
+        stop();
 }
 
 
@@ -100,8 +102,7 @@ void TMSIProducer::start(int iNumberOfChannels,
                               bUseCommonAverage,
                               bMeasureImpedance))
     {
-        m_bIsRunning = true;
-        QThread::start();
+        startProducer(iNumberOfChannels, iSamplesPerBlock, iSamplingFrequency);
     }
     else
         m_bIsRunning = false;
@@ -112,14 +113,8 @@ void TMSIProducer::start(int iNumberOfChannels,
 
 void TMSIProducer::stop()
 {
-    //Wait until this thread (TMSIProducer) is stopped
-    m_bIsRunning = false;
-
-    //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the push function (acquire statement)
-    m_pTMSI->m_pRawMatrixBuffer_In->releaseFromPush();
-
-    while(this->isRunning())
-        m_bIsRunning = false;
+    //Wait until this thread (TMSIProducer) is stopped, a full ring does not block it
+    stopProducer();
 
     //Unitialise device only after the thread stopped
     m_pTMSIDriver->uninitDevice();
@@ -128,19 +123,10 @@ void TMSIProducer::stop()
 
 //*************************************************************************************************************
 
-void TMSIProducer::run()
+bool TMSIProducer::readBlock(BlockMap& matBlock)
 {
-    MatrixXf matRawBuffer(m_pTMSI->m_iNumberOfChannels, m_pTMSI->m_iSamplesPerBlock);
-
-    while(m_bIsRunning)
-    {
-        //std::cout<<"TMSIProducer::run()"<<std::endl;
-        //Get the TMSi EEG data out of the device buffer and write received data to circular buffer
-        if(m_pTMSIDriver->getSampleMatrixValue(matRawBuffer))
-            m_pTMSI->m_pRawMatrixBuffer_In->push(&matRawBuffer);
-    }
-
-    //std::cout<<"EXITING - TMSIProducer::run()"<<std::endl;
+    //Get the TMSi EEG data out of the device buffer straight into the ring
+    return m_pTMSIDriver->getSampleMatrixValue(matBlock);
 }
 
 
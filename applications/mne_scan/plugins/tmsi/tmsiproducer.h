@@ -43,15 +43,7 @@
 // INCLUDES
 //=============================================================================================================
 
-#include <utils/generics/circularbuffer.h>
-
-
-//*************************************************************************************************************
-//=============================================================================================================
-// QT INCLUDES
-//=============================================================================================================
-
-#include <QThread>
+#include <scShared/Management/amplifierproducer.h>
 
 
 //*************************************************************************************************************
@@ -86,7 +78,7 @@ class TMSIDriver;
 *
 * @brief The EEGProducer class provides a EEG data producer for a given sampling rate.
 */
-class TMSIProducer : public QThread
+class TMSIProducer : public SCSHAREDLIB::AmplifierProducer<float>
 {
 public:
     //=========================================================================================================
@@ -137,18 +129,17 @@ public:
 protected:
     //=========================================================================================================
     /**
-    * The starting point for the thread. After calling start(), the newly created thread calls this function.
-    * Returning from this method will end the execution of the thread.
-    * Pure virtual method inherited by QThread.
+    * Reads the next block from the device into a slot of the producer's ring.
+    *
+    * @param [out] matBlock     the block to fill.
+    *
+    * @return true if the block was filled.
     */
-    virtual void run();
+    virtual bool readBlock(BlockMap& matBlock);
 
 private:
     TMSI*                       m_pTMSI;            /**< A pointer to the corresponding TMSI class.*/
     QSharedPointer<TMSIDriver>  m_pTMSIDriver;      /**< A pointer to the corresponding TMSI driver class.*/
-
-    bool                        m_bIsRunning;       /**< Whether TMSIProducer is running.*/
-
 };
 
 } // NAMESPACE
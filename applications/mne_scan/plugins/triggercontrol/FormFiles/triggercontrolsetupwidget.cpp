@@ -46,6 +46,7 @@
 #include "serialport.h"
 
 #include "../triggercontrol.h"
+#include "../triggeroutputthread.h"
 
 
 //*************************************************************************************************************
@@ -103,6 +104,11 @@ TriggerControlSetupWidget::TriggerControlSetupWidget(TriggerControl* toolbox, QW
     ui.m_qComboBox_ChannelList->addItem(QLatin1String("Kanal 15"));
     ui.m_qComboBox_ChannelList->addItem(QLatin1String("Kanal 16"));
 
+    // latency statistics of the trigger outputs
+    connect(ui.m_qCheckBox_RoundTrip, &QCheckBox::toggled, m_pTriggerControl, &TriggerControl::setMeasureRoundTrip);
+
+    connect(&m_qTimerLatency, &QTimer::timeout, this, &TriggerControlSetupWidget::updateLatency);
+    m_qTimerLatency.start(500);
 }
 
 //*************************************************************************************************************
@@ -215,7 +221,7 @@ void TriggerControlPlugin::TriggerControlSetupWidget::on_m_qPushButton_Send_rele
     m_pTriggerControl->m_pSerialPort->encodedig();
 
     // send data
-    m_pTriggerControl->m_pSerialPort->sendData(m_pTriggerControl->m_pSerialPort->m_data);
+    m_pTriggerControl->sendData(m_pTriggerControl->m_pSerialPort->m_data);
 
     std::cout << "Digital data sent" << std::endl;
 }
@@ -240,7 +246,7 @@ void TriggerControlPlugin::TriggerControlSetupWidget::on_m_qPushButton_Sendanalo
     m_pTriggerControl->m_pSerialPort->encodeana();
 
     // send data
-    m_pTriggerControl->m_pSerialPort->sendData(m_pTriggerControl->m_pSerialPort->m_data);
+    m_pTriggerControl->sendData(m_pTriggerControl->m_pSerialPort->m_data);
 
     std::cout << "Analog data sent" << std::endl;
 
@@ -250,7 +256,7 @@ void TriggerControlPlugin::TriggerControlSetupWidget::on_m_qPushButton_RetrieveD
 {
     m_pTriggerControl->m_pSerialPort->m_retrievetyp = 0;    // digital channel desired
     m_pTriggerControl->m_pSerialPort->encoderetr();
-    m_pTriggerControl->m_pSerialPort->sendData(m_pTriggerControl->m_pSerialPort->m_data);
+    m_pTriggerControl->sendData(m_pTriggerControl->m_pSerialPort->m_data);
 }
 
 
@@ -272,7 +278,7 @@ void TriggerControlPlugin::TriggerControlSetupWidget::on_m_qPushButton_RetrieveA
 
     m_pTriggerControl->m_pSerialPort->encoderetr();
 
-    m_pTriggerControl->m_pSerialPort->sendData(m_pTriggerControl->m_pSerialPort->m_data);
+    m_pTriggerControl->sendData(m_pTriggerControl->m_pSerialPort->m_data);
 }
 
 
@@ -282,3 +288,42 @@ void TriggerControlPlugin::TriggerControlSetupWidget::on_m_qPushButton_ConnectCh
 {
     m_pTriggerControl->m_pSerialPort->m_wiredChannel = ui.m_qComboBox_ChannelList->currentIndex();
 }
+
+
+//*************************************************************************************************************
+
+void TriggerControlSetupWidget::updateLatency()
+{
+    TriggerLatency t_latency = m_pTriggerControl->latency();
+
+    if(t_latency.queue.count == 0)
+    {
+        ui.m_qLabel_Latency->setText(QString("No trigger outputs yet (%1 dropped)").arg(t_latency.iDropped));
+        return;
+    }
+
+    QString t_sText = QString("Outputs: %1, last at sample %2, %3 dropped\n")
+            .arg(t_latency.queue.count).arg(t_latency.iLastSample).arg(t_latency.iDropped);
+
+    t_sText += QString("Queue: mean %1 ms, max %2 ms\n")
+            .arg(t_latency.queue.sum / 1000.0 / t_latency.queue.count, 0, 'f', 3)
+            .arg(t_latency.queue.max / 1000.0, 0, 'f', 3);
+
+    t_sText += QString("Write: mean %1 ms, max %2 ms")
+            .arg(t_latency.write.sum / 1000.0 / t_latency.write.count, 0, 'f', 3)
+            .arg(t_latency.write.max / 1000.0, 0, 'f', 3);
+
+    if(t_latency.roundTrip.count > 0 || t_latency.iLostEchoes > 0)
+    {
+        t_sText += QString("\nRound trip: ");
+        if(t_latency.roundTrip.count > 0)
+            t_sText += QString("min %1 ms, mean %2 ms, max %3 ms, 95% below %4 ms, ")
+                    .arg(t_latency.roundTrip.min / 1000.0, 0, 'f', 3)
+                    .arg(t_latency.roundTrip.sum / 1000.0 / t_latency.roundTrip.count, 0, 'f', 3)
+                    .arg(t_latency.roundTrip.max / 1000.0, 0, 'f', 3)
+                    .arg(t_latency.roundTrip.percentile(0.95) / 1000.0, 0, 'f', 3);
+        t_sText += QString("%1 lost").arg(t_latency.iLostEchoes);
+    }
+
+    ui.m_qLabel_Latency->setText(t_sText);
+}
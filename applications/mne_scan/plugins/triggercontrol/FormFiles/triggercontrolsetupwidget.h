@@ -150,6 +150,12 @@ private slots:
     */
     void on_m_qPushButton_ConnectChannel_released();
 
+    //=========================================================================================================
+    /**
+    * Shows the current latency statistics of the trigger outputs.
+    */
+    void updateLatency();
+
 private:
     //=========================================================================================================
     /**
@@ -168,6 +174,8 @@ private:
 
     TriggerControl* m_pTriggerControl;          /**< Holds a pointer to the TriggerControl widget.*/
 
+    QTimer          m_qTimerLatency;            /**< Refreshes the latency statistics.*/
+
     Ui::TriggerControlSetupWidgetClass ui;      /**< Holds the user interface for the TriggerControlSetupWidget.*/
 };
 
@@ -453,6 +453,9 @@ void SerialPort::readData()
 {
     QByteArray t_incomingArray = m_qSerialPort.readAll();
 
+    if(t_incomingArray.size() < 4)
+        return;
+
     if(((t_incomingArray[0]&0x03) == 0x00) && ((t_incomingArray[1]&0x03) == 0x01) && ((t_incomingArray[2]&0x03) == 0x02) && ((t_incomingArray[3]&0x03) == 0x03))
     {
         if ((t_incomingArray[0]&0xC0) == 0x00)
@@ -462,7 +465,12 @@ void SerialPort::readData()
             decodeana(t_incomingArray);
 
         else
+        {
             std::cout << "Error while reading the data. Correct transfer protocol?" << std::endl;
+            return;
+        }
+
+        emit byteReceived();
     }
 
 
@@ -533,5 +541,30 @@ void SerialPort::sendData(const QByteArray &data)
 }
 
 
+//*************************************************************************************************************
+
+bool SerialPort::waitForBytesWritten(int msecs)
+{
+    return m_qSerialPort.waitForBytesWritten(msecs);
+}
+
+
+//*************************************************************************************************************
+
+bool SerialPort::waitForReadyRead(int msecs)
+{
+    return m_qSerialPort.waitForReadyRead(msecs);
+}
+
+
+//*************************************************************************************************************
+
+void SerialPort::attachToThread(QThread* pThread)
+{
+    m_qSerialPort.moveToThread(pThread);
+    moveToThread(pThread);
+}
+
+
 
 
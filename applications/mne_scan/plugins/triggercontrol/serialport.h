@@ -51,6 +51,7 @@
 
 #include <QSerialPort>
 #include <QVector>
+#include <QThread>
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -173,6 +174,35 @@ public:
     */
     void sendData(const QByteArray &data);
 
+    //=========================================================================================================
+    /**
+    * Blocks until the pending output has been handed to the device. Used by threads without an event loop.
+    *
+    * @param[in] msecs      Timeout in milliseconds.
+    *
+    * @return true if all bytes were written before the timeout.
+    */
+    bool waitForBytesWritten(int msecs);
+
+    //=========================================================================================================
+    /**
+    * Blocks until new input is available and reads it. Used by threads without an event loop.
+    *
+    * @param[in] msecs      Timeout in milliseconds.
+    *
+    * @return true if data was read before the timeout.
+    */
+    bool waitForReadyRead(int msecs);
+
+    //=========================================================================================================
+    /**
+    * Moves the port together with its QSerialPort to another thread. Has to be called from the thread the
+    * port currently lives in.
+    *
+    * @param[in] pThread    The thread which from then on owns the port.
+    */
+    void attachToThread(QThread* pThread);
+
     //=========================================================================================================
     /**
     * Reads the input information after checking whether it is formally correct.
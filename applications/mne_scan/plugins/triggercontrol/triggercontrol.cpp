@@ -43,6 +43,7 @@
 #include "FormFiles/triggercontrolsetupwidget.h"
 
 #include "serialport.h"
+#include "triggeroutputthread.h"
 
 
 //*************************************************************************************************************
@@ -86,6 +87,7 @@ using namespace SCMEASLIB;
 TriggerControl::TriggerControl()
 : m_pTriggerOutput(NULL)
 , m_pSerialPort(new SerialPort) // initialize a new serial port
+, m_pTriggerOutputThread(new TriggerOutputThread(m_pSerialPort))
 , m_iBaud(115000)
 , m_pDataSingleChannel(new dBuffer(1024))
 , m_iNumChs(0)
@@ -176,6 +178,9 @@ void TriggerControl::unload()
 
 bool TriggerControl::start()
 {
+    // Trigger outputs bypass the GUI event loop and are written by a time critical thread
+    m_pTriggerOutputThread->startOutput();
+
     m_bIsRunning = true;
     QThread::start();
 
@@ -235,14 +240,31 @@ bool TriggerControl::start()
 
 bool TriggerControl::stop()
 {
-    m_pSerialPort->close();
-
     m_bIsRunning = false;
 
     // Stop threads
     QThread::terminate();
     QThread::wait();
 
+    m_pTriggerOutputThread->stopOutput();
+
+    m_pSerialPort->close();
+
+    // Store the trigger outputs together with the acquisition sample they were written at
+    QVector<TriggerStamp> t_qVecStamps = m_pTriggerOutputThread->stamps();
+
+    QFile t_fileStamps(qApp->applicationDirPath()+"/mne_scan_plugins/resources/triggercontrol/t_triggers.txt");
+    if(!t_qVecStamps.isEmpty() && t_fileStamps.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QTextStream out(&t_fileStamps);
+
+        out << "sample\tqueue_us\twrite_us\troundtrip_us" << endl;
+        for(int i = 0; i < t_qVecStamps.size(); ++i)
+            out << t_qVecStamps[i].iSample << "\t" << t_qVecStamps[i].iQueueUsec << "\t"
+                << t_qVecStamps[i].iWriteUsec << "\t" << t_qVecStamps[i].iRoundTripUsec << endl;
+
+        t_fileStamps.close();
+    }
+
     m_pDataSingleChannel->clear();
 
 
@@ -341,6 +363,13 @@ void TriggerControl::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
         if(!m_pDataMatrixBuffer)
             m_pDataMatrixBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(64, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
 
+        // Advance the acquisition sample clock the trigger outputs are stamped with
+        const QList<qint64>& t_qListTimestamps = pRTMSA->getTimestamps();
+        for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i)
+            m_pTriggerOutputThread->updateSampleClock(pRTMSA->getMultiSampleArray()[i].cols(),
+                                                      pRTMSA->getSamplingRate(),
+                                                      i < t_qListTimestamps.size() ? t_qListTimestamps[i] : -1);
+
 //        MatrixXd t_mat;
 
 //        for(qint32 i = 0; i < pRTMSA->getMultiArraySize(); ++i)
@@ -536,9 +565,9 @@ void TriggerControl::run()
 
     while(m_bIsRunning)
     {
-        emit sendByte(1, m_pSerialPort->m_wiredChannel);
+        m_pTriggerOutputThread->sendTrigger(1, m_pSerialPort->m_wiredChannel);
         msleep(20);
-        emit sendByte(0, m_pSerialPort->m_wiredChannel);
+        m_pTriggerOutputThread->sendTrigger(0, m_pSerialPort->m_wiredChannel);
         msleep(500);
     }
 
@@ -686,6 +715,12 @@ void TriggerControl::run()
 
 void TriggerControl::sendByteTo(int value, int channel)
 {
+    if (m_pTriggerOutputThread->isRunning())
+    {
+        m_pTriggerOutputThread->sendTrigger(value, channel);
+        return;
+    }
+
     if (value == 0)
     {
         m_pSerialPort->m_digchannel.replace(channel,0); // select 1st digital channel
@@ -710,6 +745,33 @@ void TriggerControl::byteReceived()
 }
 
 
+//*************************************************************************************************************
+
+void TriggerControl::sendData(const QByteArray& data)
+{
+    if(m_pTriggerOutputThread->isRunning())
+        m_pTriggerOutputThread->sendData(data);
+    else
+        m_pSerialPort->sendData(data);
+}
+
+
+//*************************************************************************************************************
+
+void TriggerControl::setMeasureRoundTrip(bool bMeasureRoundTrip)
+{
+    m_pTriggerOutputThread->setMeasureRoundTrip(bMeasureRoundTrip);
+}
+
+
+//*************************************************************************************************************
+
+TriggerLatency TriggerControl::latency() const
+{
+    return m_pTriggerOutputThread->latency();
+}
+
+
 //*************************************************************************************************************
 
 double TriggerControl::corr(VectorXd a, VectorXd b)
@@ -86,6 +86,8 @@ using namespace IOBUFFER;
 
 class SettingsWidget;
 class SerialPort;
+class TriggerOutputThread;
+struct TriggerLatency;
 
 
 //=============================================================================================================
@@ -186,6 +188,31 @@ public:
     */
     void byteReceived();
 
+    //=========================================================================================================
+    /**
+    * Sends an encoded command to the serial port. While the plugin runs the command is posted to the trigger
+    * output thread, which owns the port then.
+    *
+    * @param[in] data       The byte array according to the transfer protocol (see manual).
+    */
+    void sendData(const QByteArray& data);
+
+    //=========================================================================================================
+    /**
+    * Enables or disables the round trip measurement of the trigger outputs.
+    *
+    * @param[in] bMeasureRoundTrip  Whether to wait for the answer of the device after each output.
+    */
+    void setMeasureRoundTrip(bool bMeasureRoundTrip);
+
+    //=========================================================================================================
+    /**
+    * Returns the latency statistics of the trigger outputs since the last start.
+    *
+    * @return the latency statistics.
+    */
+    TriggerLatency latency() const;
+
 signals:
 //    void sendByte(int value);
     void sendByte(int value, int channel);
@@ -214,6 +241,7 @@ private:
     bool m_bBspBool;
 
     QSharedPointer<SerialPort> m_pSerialPort;
+    QSharedPointer<TriggerOutputThread> m_pTriggerOutputThread;   /**< Writes the trigger outputs with time critical priority.*/
 
     qint32 m_iBaud;
 
@@ -70,7 +70,8 @@ SOURCES += \
         FormFiles/triggercontrolsetupwidget.cpp \
         FormFiles/triggercontrolaboutwidget.cpp \
         FormFiles/settingswidget.cpp \
-        serialport.cpp
+        serialport.cpp \
+        triggeroutputthread.cpp
 
 HEADERS += \
         triggercontrol.h\
@@ -78,7 +79,8 @@ HEADERS += \
         FormFiles/triggercontrolsetupwidget.h \
         FormFiles/triggercontrolaboutwidget.h \
         FormFiles/settingswidget.h \
-        serialport.h
+        serialport.h \
+        triggeroutputthread.h
 
 FORMS += \
         FormFiles/triggercontrolsetup.ui \
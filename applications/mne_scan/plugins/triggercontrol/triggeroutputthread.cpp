@@ -0,0 +1,368 @@
+//=============================================================================================================
+/**
+* @file     triggeroutputthread.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the implementation of the TriggerOutputThread class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "triggeroutputthread.h"
+#include "serialport.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace TriggerControlPlugin;
+using namespace SCMEASLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+TriggerOutputThread::TriggerOutputThread(QSharedPointer<SerialPort> pSerialPort, QObject* parent)
+: QThread(parent)
+, m_pSerialPort(pSerialPort)
+, m_pOwnerThread(NULL)
+, m_iEnqueuePos(0)
+, m_iDequeuePos(0)
+, m_bIsRunning(false)
+, m_bMeasureRoundTrip(false)
+, m_bEchoReceived(false)
+, m_iDropped(0)
+, m_iClockSamples(0)
+, m_iClockTime(-1)
+, m_dSFreq(0.0)
+{
+    for(int i = 0; i < TRIGGER_QUEUE_SIZE; ++i)
+        m_commands[i].iSequence.store(i);
+
+    m_latency.iLostEchoes = 0;
+    m_latency.iDropped = 0;
+    m_latency.iLastSample = -1;
+}
+
+
+//*************************************************************************************************************
+
+TriggerOutputThread::~TriggerOutputThread()
+{
+    if(isRunning())
+        stopOutput();
+}
+
+
+//*************************************************************************************************************
+
+void TriggerOutputThread::startOutput()
+{
+    if(isRunning())
+        return;
+
+    m_qMutexClock.lock();
+    m_iClockSamples = 0;
+    m_iClockTime = -1;
+    m_dSFreq = 0.0;
+    m_qMutexClock.unlock();
+
+    m_qMutexLatency.lock();
+    m_latency = TriggerLatency();
+    m_latency.iLostEchoes = 0;
+    m_latency.iDropped = 0;
+    m_latency.iLastSample = -1;
+    m_qVecStamps.clear();
+    m_qMutexLatency.unlock();
+
+    m_iDropped.store(0);
+
+    // The port has no event loop in the output thread, it is read and written with the blocking calls instead
+    m_pOwnerThread = m_pSerialPort->thread();
+    m_pSerialPort->attachToThread(this);
+
+    m_bIsRunning = true;
+    start(QThread::TimeCriticalPriority);
+}
+
+
+//*************************************************************************************************************
+
+void TriggerOutputThread::stopOutput()
+{
+    m_bIsRunning = false;
+    m_semCommands.release();
+
+    wait();
+}
+
+
+//*************************************************************************************************************
+
+bool TriggerOutputThread::sendTrigger(int iValue, int iChannel)
+{
+    return enqueue(QByteArray(), iValue, iChannel);
+}
+
+
+//*************************************************************************************************************
+
+bool TriggerOutputThread::sendData(const QByteArray& data)
+{
+    return enqueue(data, 0, -1);
+}
+
+
+//*************************************************************************************************************
+
+void TriggerOutputThread::updateSampleClock(qint64 iNumSamples, double dSFreq, qint64 iTimestamp)
+{
+    QMutexLocker locker(&m_qMutexClock);
+
+    m_iClockSamples += iNumSamples;
+    m_iClockTime = iTimestamp < 0 ? LatencyMonitor::now() : iTimestamp;
+    m_dSFreq = dSFreq;
+}
+
+
+//*************************************************************************************************************
+
+void TriggerOutputThread::setMeasureRoundTrip(bool bMeasureRoundTrip)
+{
+    m_bMeasureRoundTrip = bMeasureRoundTrip;
+}
+
+
+//*************************************************************************************************************
+
+TriggerLatency TriggerOutputThread::latency() const
+{
+    QMutexLocker locker(&m_qMutexLatency);
+
+    TriggerLatency t_latency = m_latency;
+    t_latency.iDropped = m_iDropped.load();
+
+    return t_latency;
+}
+
+
+//*************************************************************************************************************
+
+QVector<TriggerStamp> TriggerOutputThread::stamps() const
+{
+    QMutexLocker locker(&m_qMutexLatency);
+    return m_qVecStamps;
+}
+
+
+//*************************************************************************************************************
+
+void TriggerOutputThread::run()
+{
+    connect(m_pSerialPort.data(), &SerialPort::byteReceived, this, &TriggerOutputThread::onEchoReceived, Qt::DirectConnection);
+
+    QByteArray t_data;
+    int t_iValue = 0, t_iChannel = -1;
+    qint64 t_iQueued = 0;
+
+    while(m_bIsRunning)
+    {
+        // A producer may still be publishing an earlier slot when it is woken, so the queue is drained on every
+        // wake up and surplus wake ups find it empty
+        m_semCommands.tryAcquire(1, 10);
+
+        while(m_bIsRunning && dequeue(t_data, t_iValue, t_iChannel, t_iQueued))
+            write(t_data, t_iValue, t_iChannel, t_iQueued);
+
+        // Without an event loop incoming data is only read here
+        m_pSerialPort->waitForReadyRead(0);
+    }
+
+    disconnect(m_pSerialPort.data(), &SerialPort::byteReceived, this, &TriggerOutputThread::onEchoReceived);
+
+    // Commands posted after the stop are discarded
+    while(dequeue(t_data, t_iValue, t_iChannel, t_iQueued))
+        ;
+    m_semCommands.acquire(m_semCommands.available());
+
+    m_pSerialPort->attachToThread(m_pOwnerThread);
+}
+
+
+//*************************************************************************************************************
+
+void TriggerOutputThread::write(QByteArray& data, int iValue, int iChannel, qint64 iQueued)
+{
+    if(iChannel >= 0)
+    {
+        m_pSerialPort->m_digchannel.replace(iChannel, iValue == 0 ? 0 : 1);
+        m_pSerialPort->encodedig();
+        data = m_pSerialPort->m_data;
+    }
+
+    m_bEchoReceived = false;
+
+    TriggerStamp t_stamp;
+    qint64 t_iWrite = LatencyMonitor::now();
+    t_stamp.iSample = sampleAt(t_iWrite);
+    t_stamp.iQueueUsec = t_iWrite - iQueued;
+
+    m_pSerialPort->sendData(data);
+    m_pSerialPort->waitForBytesWritten(TRIGGER_WRITE_TIMEOUT);
+
+    t_stamp.iWriteUsec = LatencyMonitor::now() - t_iWrite;
+    t_stamp.iRoundTripUsec = -1;
+
+    if(m_bMeasureRoundTrip)
+    {
+        qint64 t_iRemaining = TRIGGER_ECHO_TIMEOUT;
+        while(!m_bEchoReceived && t_iRemaining > 0)
+        {
+            m_pSerialPort->waitForReadyRead((int)t_iRemaining);
+            t_iRemaining = TRIGGER_ECHO_TIMEOUT - (LatencyMonitor::now() - t_iWrite) / 1000;
+        }
+
+        if(m_bEchoReceived)
+            t_stamp.iRoundTripUsec = LatencyMonitor::now() - t_iWrite;
+    }
+
+    QMutexLocker locker(&m_qMutexLatency);
+
+    m_latency.queue.add(t_stamp.iQueueUsec);
+    m_latency.write.add(t_stamp.iWriteUsec);
+    if(t_stamp.iRoundTripUsec >= 0)
+        m_latency.roundTrip.add(t_stamp.iRoundTripUsec);
+    else if(m_bMeasureRoundTrip)
+        ++m_latency.iLostEchoes;
+    m_latency.iLastSample = t_stamp.iSample;
+
+    m_qVecStamps.append(t_stamp);
+}
+
+
+//*************************************************************************************************************
+
+bool TriggerOutputThread::enqueue(const QByteArray& data, int iValue, int iChannel)
+{
+    // Bounded multi producer queue: a producer claims a position by advancing m_iEnqueuePos and publishes the
+    // slot by setting its sequence, so no producer ever blocks another one or the output thread.
+    Command* t_pCommand;
+    int t_iPos = m_iEnqueuePos.load();
+
+    forever
+    {
+        t_pCommand = &m_commands[t_iPos & (TRIGGER_QUEUE_SIZE - 1)];
+        int t_iDiff = t_pCommand->iSequence.loadAcquire() - t_iPos;
+
+        if(t_iDiff == 0)
+        {
+            if(m_iEnqueuePos.testAndSetRelaxed(t_iPos, t_iPos + 1))
+                break;
+            t_iPos = m_iEnqueuePos.load();
+        }
+        else if(t_iDiff < 0)
+        {
+            m_iDropped.fetchAndAddRelaxed(1);
+            return false;
+        }
+        else
+        {
+            t_iPos = m_iEnqueuePos.load();
+        }
+    }
+
+    t_pCommand->data = data;
+    t_pCommand->iValue = iValue;
+    t_pCommand->iChannel = iChannel;
+    t_pCommand->iQueued = LatencyMonitor::now();
+    t_pCommand->iSequence.storeRelease(t_iPos + 1);
+
+    m_semCommands.release();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool TriggerOutputThread::dequeue(QByteArray& data, int& iValue, int& iChannel, qint64& iQueued)
+{
+    Command& t_command = m_commands[m_iDequeuePos & (TRIGGER_QUEUE_SIZE - 1)];
+
+    if(t_command.iSequence.loadAcquire() - (m_iDequeuePos + 1) < 0)
+        return false;
+
+    data = t_command.data;
+    iValue = t_command.iValue;
+    iChannel = t_command.iChannel;
+    iQueued = t_command.iQueued;
+    t_command.data.clear();
+
+    t_command.iSequence.storeRelease(m_iDequeuePos + TRIGGER_QUEUE_SIZE);
+    ++m_iDequeuePos;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+qint64 TriggerOutputThread::sampleAt(qint64 iTime) const
+{
+    QMutexLocker locker(&m_qMutexClock);
+
+    if(m_dSFreq <= 0.0 || m_iClockTime < 0)
+        return -1;
+
+    return m_iClockSamples + (qint64)((iTime - m_iClockTime) * 1e-6 * m_dSFreq + 0.5);
+}
+
+
+//*************************************************************************************************************
+
+void TriggerOutputThread::onEchoReceived()
+{
+    m_bEchoReceived = true;
+}
@@ -0,0 +1,291 @@
+//=============================================================================================================
+/**
+* @file     triggeroutputthread.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the TriggerOutputThread class.
+*
+*/
+
+#ifndef TRIGGEROUTPUTTHREAD_H
+#define TRIGGEROUTPUTTHREAD_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <scMeas/latencymonitor.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QSemaphore>
+#include <QMutex>
+#include <QVector>
+#include <QByteArray>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define TRIGGER_QUEUE_SIZE          256     /**< Number of commands the output queue holds, has to be a power of two. */
+#define TRIGGER_WRITE_TIMEOUT       100     /**< Time in ms to wait for the port to take over a command. */
+#define TRIGGER_ECHO_TIMEOUT        50      /**< Time in ms to wait for the device to answer a command. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE TriggerControlPlugin
+//=============================================================================================================
+
+namespace TriggerControlPlugin
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class SerialPort;
+
+
+//=============================================================================================================
+/**
+* One trigger output, stamped with the acquisition sample which was recorded while it was written.
+*/
+struct TriggerStamp
+{
+    qint64  iSample;        /**< Acquisition sample at the time of writing, -1 if no data was received yet. */
+    qint64  iQueueUsec;     /**< Time the command waited in the queue in microseconds. */
+    qint64  iWriteUsec;     /**< Time the port took to take over the command in microseconds. */
+    qint64  iRoundTripUsec; /**< Time until the device answered in microseconds, -1 if not measured or lost. */
+};
+
+
+//=============================================================================================================
+/**
+* Latency statistics of the trigger outputs.
+*/
+struct TriggerLatency
+{
+    SCMEASLIB::LatencyHistogram queue;      /**< Time between posting and writing a command. */
+    SCMEASLIB::LatencyHistogram write;      /**< Time the port took to take over a command. */
+    SCMEASLIB::LatencyHistogram roundTrip;  /**< Time between writing a command and the answer of the device. */
+    qint64  iLostEchoes;                    /**< Number of commands the device did not answer in time. */
+    qint64  iDropped;                       /**< Number of commands dropped because the queue was full. */
+    qint64  iLastSample;                    /**< Acquisition sample of the last output. */
+};
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TriggerOutputThread
+*
+* @brief The TriggerOutputThread writes trigger commands to the serial port from a time critical thread.
+*
+* Commands are posted to a bounded lock-free queue, so the acquisition and the GUI never wait for the port and
+* the output never waits for the GUI event loop. While the thread runs it owns the serial port. Every output
+* is stamped with the acquisition sample recorded at the time of writing, which is extrapolated from the last
+* received data block.
+*/
+class TriggerOutputThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a TriggerOutputThread.
+    *
+    * @param[in] pSerialPort    The port the commands are written to.
+    * @param[in] parent         The parent object.
+    */
+    TriggerOutputThread(QSharedPointer<SerialPort> pSerialPort, QObject* parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Destroys the TriggerOutputThread.
+    */
+    ~TriggerOutputThread();
+
+    //=========================================================================================================
+    /**
+    * Takes over the serial port and starts the output thread with time critical priority. Has to be called
+    * from the thread the port lives in.
+    */
+    void startOutput();
+
+    //=========================================================================================================
+    /**
+    * Stops the output thread and hands the serial port back.
+    */
+    void stopOutput();
+
+    //=========================================================================================================
+    /**
+    * Posts a digital trigger command. Lock-free, may be called from any thread.
+    *
+    * @param[in] iValue     1 sets and 0 resets the channel.
+    * @param[in] iChannel   The digital output channel.
+    *
+    * @return false if the queue was full and the command was dropped.
+    */
+    bool sendTrigger(int iValue, int iChannel);
+
+    //=========================================================================================================
+    /**
+    * Posts an already encoded command. Lock-free, may be called from any thread.
+    *
+    * @param[in] data       The byte array according to the transfer protocol.
+    *
+    * @return false if the queue was full and the command was dropped.
+    */
+    bool sendData(const QByteArray& data);
+
+    //=========================================================================================================
+    /**
+    * Advances the acquisition sample clock by one received data block.
+    *
+    * @param[in] iNumSamples    Number of samples in the block.
+    * @param[in] dSFreq         The sampling frequency.
+    * @param[in] iTimestamp     The time the block entered the pipeline as given by LatencyMonitor::now(), -1
+    *                           stamps the block with the current time.
+    */
+    void updateSampleClock(qint64 iNumSamples, double dSFreq, qint64 iTimestamp = -1);
+
+    //=========================================================================================================
+    /**
+    * Enables or disables the round trip measurement. The device has to answer every command for it.
+    *
+    * @param[in] bMeasureRoundTrip  Whether to wait for the answer of the device after each command.
+    */
+    void setMeasureRoundTrip(bool bMeasureRoundTrip);
+
+    //=========================================================================================================
+    /**
+    * Returns the latency statistics of the outputs.
+    *
+    * @return the statistics since the last start.
+    */
+    TriggerLatency latency() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the stamps of all outputs since the last start.
+    *
+    * @return the stamps in output order.
+    */
+    QVector<TriggerStamp> stamps() const;
+
+protected:
+    //=========================================================================================================
+    /**
+    * Writes the posted commands until stopOutput() is called.
+    */
+    virtual void run();
+
+private:
+    /**
+    * One slot of the output queue.
+    */
+    struct Command {
+        QAtomicInt  iSequence;      /**< Position of the slot in the queue, tells producers and consumer whose turn it is. */
+        QByteArray  data;           /**< The encoded command, empty for a digital trigger. */
+        int         iValue;         /**< The trigger value. */
+        int         iChannel;       /**< The trigger channel. */
+        qint64      iQueued;        /**< The time the command was posted. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Writes one command and records its stamp. Only called by the output thread.
+    */
+    void write(QByteArray& data, int iValue, int iChannel, qint64 iQueued);
+
+    //=========================================================================================================
+    /**
+    * Puts a command into the queue. Safe for any number of producers.
+    */
+    bool enqueue(const QByteArray& data, int iValue, int iChannel);
+
+    //=========================================================================================================
+    /**
+    * Takes the next command from the queue. Only called by the output thread.
+    */
+    bool dequeue(QByteArray& data, int& iValue, int& iChannel, qint64& iQueued);
+
+    //=========================================================================================================
+    /**
+    * Returns the acquisition sample recorded at the given time.
+    */
+    qint64 sampleAt(qint64 iTime) const;
+
+    //=========================================================================================================
+    /**
+    * Is called when the device answered.
+    */
+    void onEchoReceived();
+
+    QSharedPointer<SerialPort>  m_pSerialPort;      /**< The port the commands are written to. */
+    QThread*                    m_pOwnerThread;     /**< The thread the port is handed back to. */
+
+    Command                     m_commands[TRIGGER_QUEUE_SIZE]; /**< The ring of queue slots. */
+    QAtomicInt                  m_iEnqueuePos;      /**< Next queue position to be written by a producer. */
+    int                         m_iDequeuePos;      /**< Next queue position to be read by the output thread. */
+    QSemaphore                  m_semCommands;      /**< Wakes the output thread for posted commands. */
+
+    volatile bool               m_bIsRunning;       /**< Whether the output thread is running. */
+    volatile bool               m_bMeasureRoundTrip;/**< Whether to wait for the answer of the device. */
+    volatile bool               m_bEchoReceived;    /**< Whether the device answered the current command. */
+    QAtomicInt                  m_iDropped;         /**< Number of commands dropped because the queue was full. */
+
+    mutable QMutex              m_qMutexClock;      /**< Guards the sample clock. */
+    qint64                      m_iClockSamples;    /**< Number of acquired samples. */
+    qint64                      m_iClockTime;       /**< The time the last block entered the pipeline. */
+    double                      m_dSFreq;           /**< The sampling frequency, 0 before data was received. */
+
+    mutable QMutex              m_qMutexLatency;    /**< Guards the statistics and stamps. */
+    TriggerLatency              m_latency;          /**< The latency statistics. */
+    QVector<TriggerStamp>       m_qVecStamps;       /**< The stamps of all outputs. */
+};
+
+} // NAMESPACE
+
+#endif // TRIGGEROUTPUTTHREAD_H
@@ -41,8 +41,22 @@
 
 #include "mne_show_fiff_settings.h"
 #include "mne_fiff_exp_set.h"
+#include "mne_fiff_scanner.h"
+
+#include <utils/executionconfig.h>
+
 #include <stdio.h>
 
+#ifdef _WIN32
+#include <io.h>
+#define dup _dup
+#define dup2 _dup2
+#define fdopen _fdopen
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -79,6 +93,24 @@ int main(int argc, char *argv[])
     QCoreApplication app(argc, argv);
 
     MneShowFiffSettings settings(&argc,argv);
+
+    if (!settings.execution.isEmpty() && !UTILSLIB::ExecutionConfig::configure(settings.execution))
+        return 1;
+
+    if (!settings.scan.isEmpty()) {
+        //
+        //   Keep stdout for the JSON lines, the messages of the fiff library go to stderr
+        //
+        fflush(stdout);
+        FILE *out = fdopen(dup(fileno(stdout)),"w");
+        dup2(fileno(stderr),fileno(stdout));
+
+        bool ok = MneFiffScanner::scan(out ? out : stderr, settings.scan, settings.threads, settings.rawdir_cache);
+        if (out)
+            fclose(out);
+        return ok ? 0 : 1;
+    }
+
     MneFiffExpSet expSet = MneFiffExpSet::read_fiff_explanations(QCoreApplication::applicationDirPath()+"/resources/general/explanations/fiff_explanations.txt");
     expSet.show_fiff_contents(stdout, settings);
 
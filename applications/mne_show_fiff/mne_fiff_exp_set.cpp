@@ -45,6 +45,7 @@
 
 #include <fiff/fiff_tag.h>
 #include <fiff/fiff_stream.h>
+#include <fiff/fiff_dir_entry.h>
 
 #include <iostream>
 
@@ -239,288 +240,364 @@ QList<MneFiffExp>::const_iterator MneFiffExpSet::constEnd() const
 
 bool MneFiffExpSet::show_fiff_contents(FILE *out, const MneShowFiffSettings &settings)
 {
-    return show_fiff_contents(out,settings.inname, settings.verbose,settings.tags,settings.indent,settings.long_strings,settings.blocks_only);
+    return show_fiff_contents(out,settings.inname, settings.verbose,settings.tags,settings.indent,settings.long_strings,settings.blocks_only,settings.depth,settings.stream);
 }
 
 
 //*************************************************************************************************************
 
-bool MneFiffExpSet::show_fiff_contents(FILE *out, const QString &name, bool verbose, const QList<int> &tags, int indent_step, bool long_strings, bool blocks_only)
+bool MneFiffExpSet::show_fiff_contents(FILE *out, const QString &name, bool verbose, const QList<int> &tags, int indent_step, bool long_strings, bool blocks_only, int max_depth, bool streaming)
 {
     QFile file(name);
     FiffStream::SPtr stream(new FiffStream(&file));
 
     FiffDirEntry::SPtr this_ent;
+    ShowFiffState state;
+    state.indent    = 0;
+    state.depth     = 0;
+    state.count     = 0;
+    state.prev_kind = -1;
+    state.first     = true;
+
+    if (!streaming) {
+        if (!stream->open())
+            return false;
+
+        //        for (auto this_ent : stream->dir()) {//C++11
+        for (int i = 0; i < stream->dir().size(); ++i) {
+            this_ent = stream->dir()[i];
+            show_fiff_entry(out,stream,this_ent,this_ent->pos,verbose,tags,indent_step,long_strings,blocks_only,max_depth,state);
+        }
+    }
+    else {
+        //
+        //   Walk the tags one after another instead of reading the directory first. Only the tag headers are
+        //   read, the data only of the tags which are printed.
+        //
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCritical("Cannot open %s\n", name.toUtf8().constData());
+            return false;
+        }
+
+        fiff_long_t pos = 0;
+        fiff_int_t  kind, type, size, next;
+        int         ntag = 0;
+
+        while (pos >= 0 && pos + (fiff_long_t)FIFFC_TAG_INFO_SIZE <= file.size()) {
+            if (!file.seek(pos))
+                break;
+            *stream >> kind >> type >> size >> next;
+            if (stream->status() != QDataStream::Ok || size < 0)
+                break;
+
+            if (ntag == 0 && kind != FIFF_FILE_ID) {
+                qCritical("FIFF file should start with FIFF_FILE_ID!");
+                file.close();
+                return false;
+            }
+
+            //
+            //   The directory lists the tags, it is not one of them
+            //
+            if (kind != FIFF_DIR) {
+                this_ent = FiffDirEntry::SPtr(new FiffDirEntry());
+                this_ent->kind = kind;
+                this_ent->type = type;
+                this_ent->size = size;
+                this_ent->pos  = (fiff_int_t)pos;     // Only valid below 2GB, the data is read from pos
+                show_fiff_entry(out,stream,this_ent,pos,verbose,tags,indent_step,long_strings,blocks_only,max_depth,state);
+            }
+
+            if (next == FIFFV_NEXT_NONE)
+                break;
+            pos = next > 0 ? (fiff_long_t)next : pos + (fiff_long_t)FIFFC_TAG_INFO_SIZE + size;
+
+            //
+            //   Let the output appear while the file is still being read
+            //
+            if (++ntag % 256 == 0)
+                fflush(out);
+        }
+    }
+
+    if (!verbose && !blocks_only) {
+        if (state.count > 1)
+            fprintf(out," [%d]\n",state.count);
+        else
+            fprintf(out,"\n");
+    }
+    fflush(out);
+
+    stream->close();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void MneFiffExpSet::show_fiff_entry(FILE *out, QSharedPointer<FiffStream> &stream, const QSharedPointer<FiffDirEntry> &this_ent, fiff_long_t pos, bool verbose, const QList<int> &tags, int indent_step, bool long_strings, bool blocks_only, int max_depth, ShowFiffState &state)
+{
     FiffTag::SPtr   tag;
     int             day,month,year;
     int             block;
-    int             count = 0;
-    int             prev_kind;
-    int             indent = 0;
+    int             depth;
     bool            show_it = false;
     QString         s;
     bool            output_taginfo = false;
     QList<MneFiffExp>::const_iterator exp;
 
-    if (!stream->open())
-        return false;
-    prev_kind = -1;
+    //
+    //   Blocks are one level deeper than the block they are contained in, the tags of a block one level deeper
+    //   than the block itself
+    //
+    if (this_ent->kind == FIFF_BLOCK_START)
+        depth = state.depth++;
+    else if (this_ent->kind == FIFF_BLOCK_END)
+        depth = --state.depth;
+    else
+        depth = state.depth;
+    bool deep_enough = max_depth < 0 || depth <= max_depth;
 
     if (blocks_only) {
-        //        for (auto this_ent : stream->dir()) {//C++11
-        for (int i = 0; i < stream->dir().size(); ++i) {
-            this_ent = stream->dir()[i];
-            if (this_ent->kind == FIFF_BLOCK_START || this_ent->kind == FIFF_BLOCK_END) {
-                if (this_ent->kind == FIFF_BLOCK_END)
-                    indent = indent - indent_step;
-                if (this_ent->kind == FIFF_BLOCK_START) {
-                    for (int k = 0; k < indent; k++)
-                        fprintf(out," ");
-                    if ( stream->read_tag(tag, this_ent->pos) ) {
-                        block = *tag->toInt();
-                        exp = this->find_fiff_explanation(CLASS_BLOCK,block);
-                        if (exp != this->constEnd())
-                            fprintf(out,"%-d = %-s\n",exp->kind,exp->text.toUtf8().constData());
-                        else
-                            fprintf(out,"%-d = %-s\n",block,"Not explained");
-                    }
+        if (this_ent->kind == FIFF_BLOCK_START || this_ent->kind == FIFF_BLOCK_END) {
+            if (this_ent->kind == FIFF_BLOCK_END)
+                state.indent = state.indent - indent_step;
+            if (this_ent->kind == FIFF_BLOCK_START && deep_enough) {
+                for (int k = 0; k < state.indent; k++)
+                    fprintf(out," ");
+                if ( stream->read_tag(tag, pos) ) {
+                    block = *tag->toInt();
+                    exp = this->find_fiff_explanation(CLASS_BLOCK,block);
+                    if (exp != this->constEnd())
+                        fprintf(out,"%-d = %-s\n",exp->kind,exp->text.toUtf8().constData());
+                    else
+                        fprintf(out,"%-d = %-s\n",block,"Not explained");
                 }
-                if (this_ent->kind == FIFF_BLOCK_START)
-                    indent = indent + indent_step;
             }
+            if (this_ent->kind == FIFF_BLOCK_START)
+                state.indent = state.indent + indent_step;
         }
+        state.first = false;
+        return;
     }
+
+    if (tags.size() == 0)
+        show_it = true;
     else {
-        //        for (auto this_ent : stream->dir()) {//C++11
-        for (int i = 0; i < stream->dir().size(); ++i) {
-            this_ent = stream->dir()[i];
-            if (tags.size() == 0)
+        show_it = false;
+        for (int k = 0; k < tags.size(); k++) {
+            if (this_ent->kind == tags[k]) {
                 show_it = true;
-            else {
-                show_it = false;
-                for (int k = 0; k < tags.size(); k++) {
-                    if (this_ent->kind == tags[k]) {
-                        show_it = true;
-                        break;
-                    }
-                }
+                break;
             }
-            if (show_it) {
-                if (this_ent->kind == FIFF_BLOCK_START || this_ent->kind == FIFF_BLOCK_END) {
-                    if (!verbose) {
-                        if (count > 1)
-                            fprintf(out," [%d]\n",count);
-                        else if (this_ent != stream->dir()[0])
-                            fprintf(out,"\n");
-                    }
-                    if (this_ent->kind == FIFF_BLOCK_END)
-                        indent = indent - indent_step;
-                    for (int k = 0; k < indent; k++)
-                        fprintf(out," ");
-                    exp = this->find_fiff_explanation(CLASS_TAG,this_ent->kind);
-                    if (exp != this->constEnd())
-                        fprintf(out,"%4d = %-s",exp->kind,exp->text.toUtf8().constData());
-                    else
-                        fprintf(out,"%4d = %-s",this_ent->kind,"Not explained");
-                    if ( stream->read_tag(tag,this_ent->pos)) {
-                        block = *tag->toInt();
-                        exp = this->find_fiff_explanation(CLASS_BLOCK,block);
-                        if (exp != this->constEnd())
-                            fprintf(out,"\t%-d = %-s",exp->kind,exp->text.toUtf8().constData());
+        }
+    }
+    show_it = show_it && deep_enough;
+
+    if (show_it) {
+        if (this_ent->kind == FIFF_BLOCK_START || this_ent->kind == FIFF_BLOCK_END) {
+            if (!verbose) {
+                if (state.count > 1)
+                    fprintf(out," [%d]\n",state.count);
+                else if (!state.first)
+                    fprintf(out,"\n");
+            }
+            if (this_ent->kind == FIFF_BLOCK_END)
+                state.indent = state.indent - indent_step;
+            for (int k = 0; k < state.indent; k++)
+                fprintf(out," ");
+            exp = this->find_fiff_explanation(CLASS_TAG,this_ent->kind);
+            if (exp != this->constEnd())
+                fprintf(out,"%4d = %-s",exp->kind,exp->text.toUtf8().constData());
+            else
+                fprintf(out,"%4d = %-s",this_ent->kind,"Not explained");
+            if ( stream->read_tag(tag,pos)) {
+                block = *tag->toInt();
+                exp = this->find_fiff_explanation(CLASS_BLOCK,block);
+                if (exp != this->constEnd())
+                    fprintf(out,"\t%-d = %-s",exp->kind,exp->text.toUtf8().constData());
+                else
+                    fprintf(out,"\t%-d = %-s",block,"Not explained");
+            }
+            if ( this_ent->kind == FIFF_BLOCK_START)
+                state.indent = state.indent + indent_step;
+            state.count = 1;
+            if (verbose)
+                fprintf(out,"\n");
+        }
+        else if (verbose) {
+            for (int k = 0; k < state.indent; k++)
+                fprintf(out," ");
+            if (output_taginfo) {
+                fprintf(out,"%d %d ",this_ent->size,this_ent->type);
+            }
+            exp = this->find_fiff_explanation(CLASS_TAG,this_ent->kind);
+            if (exp != this->constEnd())
+                fprintf(out,"%4d = %-18s",exp->kind,exp->text.toUtf8().constData());
+            else
+                fprintf(out,"%4d = %-18s",this_ent->kind,"Not explained");
+            if (FiffTag::fiff_type_fundamental(this_ent->type) == FIFFTS_FS_MATRIX) {
+                fprintf(out,"TODO print_matrix");
+                //                        print_matrix(out,in,this_ent);
+            }
+            else {
+                switch (this_ent->type) {
+                case FIFFT_INT :
+                    if (stream->read_tag(tag,pos)) {
+                        if (this_ent->kind == FIFF_BLOCK_START ||
+                                this_ent->kind == FIFF_BLOCK_END) {
+                            block = *tag->toInt();
+                            exp = this->find_fiff_explanation(CLASS_BLOCK,block);
+                            if (exp != this->constEnd())
+                                fprintf(out,"\t%-d = %s",exp->kind,exp->text.toUtf8().constData());
+                            else
+                                fprintf(out,"\t%-d = %-s",block,"Not explained");
+                        }
+                        else if (this_ent->kind == FIFF_MEAS_DATE) {
+                            QDateTime ltime;
+                            ltime.setTime_t(tag->toInt()[0]);
+                            fprintf(out,"\t%s",ltime.toString().toUtf8().constData());
+                        }
+                        else if (tag->size() == sizeof(fiff_int_t))
+                            fprintf(out,"\t%d",*tag->toInt());
                         else
-                            fprintf(out,"\t%-d = %-s",block,"Not explained");
+                            fprintf(out,"\t%d ints",(int)(tag->size()/sizeof(fiff_int_t)));
                     }
-                    if ( this_ent->kind == FIFF_BLOCK_START)
-                        indent = indent + indent_step;
-                    count = 1;
-                    if (verbose)
-                        fprintf(out,"\n");
-                }
-                else if (verbose) {
-                    for (int k = 0; k < indent; k++)
-                        fprintf(out," ");
-                    if (output_taginfo) {
-                        fprintf(out,"%d %d ",this_ent->size,this_ent->type);
+                    break;
+                case FIFFT_UINT :
+                    if (stream->read_tag(tag,pos)) {
+                        if (tag->size() == sizeof(fiff_int_t))
+                            fprintf(out,"\t%d",*tag->toUnsignedInt());
+                        else
+                            fprintf(out,"\t%d u_ints",(int)(tag->size()/sizeof(fiff_int_t)));
                     }
-                    exp = this->find_fiff_explanation(CLASS_TAG,this_ent->kind);
-                    if (exp != this->constEnd())
-                        fprintf(out,"%4d = %-18s",exp->kind,exp->text.toUtf8().constData());
-                    else
-                        fprintf(out,"%4d = %-18s",this_ent->kind,"Not explained");
-                    if (FiffTag::fiff_type_fundamental(this_ent->type) == FIFFTS_FS_MATRIX) {
-                        fprintf(out,"TODO print_matrix");
-                        //                        print_matrix(out,in,this_ent);
+                    break;
+                case FIFFT_JULIAN :
+                    if (stream->read_tag(tag,pos)) {
+                        fprintf(out,"TODO fiff_caldate");
+                        //                                fiff_caldate (*(fiff_julian_t *)tag.data,&day,&month,&year);
+                        fprintf(out,"\t%d.%d.%d",day,month,year);
                     }
-                    else {
-                        switch (this_ent->type) {
-                        case FIFFT_INT :
-                            if (stream->read_tag(tag,this_ent->pos)) {
-                                if (this_ent->kind == FIFF_BLOCK_START ||
-                                        this_ent->kind == FIFF_BLOCK_END) {
-                                    block = *tag->toInt();
-                                    exp = this->find_fiff_explanation(CLASS_BLOCK,block);
-                                    if (exp != this->constEnd())
-                                        fprintf(out,"\t%-d = %s",exp->kind,exp->text.toUtf8().constData());
-                                    else
-                                        fprintf(out,"\t%-d = %-s",block,"Not explained");
-                                }
-                                else if (this_ent->kind == FIFF_MEAS_DATE) {
-                                    QDateTime ltime;
-                                    ltime.setTime_t(tag->toInt()[0]);
-                                    fprintf(out,"\t%s",ltime.toString().toUtf8().constData());
-                                }
-                                else if (tag->size() == sizeof(fiff_int_t))
-                                    fprintf(out,"\t%d",*tag->toInt());
-                                else
-                                    fprintf(out,"\t%d ints",(int)(tag->size()/sizeof(fiff_int_t)));
-                            }
-                            break;
-                        case FIFFT_UINT :
-                            if (stream->read_tag(tag,this_ent->pos)) {
-                                if (tag->size() == sizeof(fiff_int_t))
-                                    fprintf(out,"\t%d",*tag->toUnsignedInt());
-                                else
-                                    fprintf(out,"\t%d u_ints",(int)(tag->size()/sizeof(fiff_int_t)));
-                            }
-                            break;
-                        case FIFFT_JULIAN :
-                            if (stream->read_tag(tag,this_ent->pos)) {
-                                fprintf(out,"TODO fiff_caldate");
-                                //                                fiff_caldate (*(fiff_julian_t *)tag.data,&day,&month,&year);
-                                fprintf(out,"\t%d.%d.%d",day,month,year);
-                            }
-                            break;
-                        case FIFFT_STRING :
-                            if (stream->read_tag(tag,this_ent->pos)) {
-                                s = tag->toString();
-                                if (long_strings)
-                                    fprintf(out,"\t%s",tag->toString().toUtf8().constData());
-                                else {
-                                    if ((s.indexOf("\n")) != -1)
-                                        s.replace(s.indexOf("\n"), 2, "\0");
-                                    else if (s.size() > LONG_LINE) {
-                                        s.truncate(LONG_LINE);
-                                        s += "...";
-                                    }
-                                    fprintf(out,"\t%s",s.toUtf8().constData());
-                                }
-                            }
-                            break;
-                        case FIFFT_FLOAT :
-                            if (stream->read_tag(tag,this_ent->pos)) {
-                                if (tag->size() == sizeof(fiff_float_t))
-                                    fprintf(out,"\t%g",*tag->toFloat());
-                                else
-                                    fprintf(out,"\t%d floats",(int)(tag->size()/sizeof(fiff_float_t)));
-                            }
-                            break;
-                        case FIFFT_DOUBLE :
-                            if (stream->read_tag(tag,this_ent->pos)) {
-                                if (tag->size() == sizeof(fiff_double_t))
-                                    fprintf(out,"\t%g",*tag->toDouble());
-                                else
-                                    fprintf(out,"\t%d doubles",(int)(tag->size()/sizeof(fiff_double_t)));
-                            }
-                            break;
-                        case FIFFT_COMPLEX_FLOAT :
-                            if (stream->read_tag(tag,this_ent->pos)) {
-                                float *fdata = tag->toFloat();
-                                if (tag->size() == 2*sizeof(fiff_float_t))
-                                    fprintf(out,"\t(%g %g)",fdata[0],fdata[1]);
-                                else
-                                    fprintf(out,"\t%d complex numbers",
-                                            (int)(tag->size()/(2*sizeof(fiff_float_t))));
-                            }
-                            break;
-                        case FIFFT_COMPLEX_DOUBLE :
-                            if (stream->read_tag(tag,this_ent->pos)) {
-                                double *ddata = tag->toDouble();
-                                if (tag->size() == 2*sizeof(fiff_double_t))
-                                    fprintf(out,"\t(%g %g)",ddata[0],ddata[1]);
-                                else
-                                    fprintf(out,"\t%d double complex numbers",
-                                            (int)(tag->size()/(2*sizeof(fiff_double_t))));
+                    break;
+                case FIFFT_STRING :
+                    if (stream->read_tag(tag,pos)) {
+                        s = tag->toString();
+                        if (long_strings)
+                            fprintf(out,"\t%s",tag->toString().toUtf8().constData());
+                        else {
+                            if ((s.indexOf("\n")) != -1)
+                                s.replace(s.indexOf("\n"), 2, "\0");
+                            else if (s.size() > LONG_LINE) {
+                                s.truncate(LONG_LINE);
+                                s += "...";
                             }
-                            break;
-                        case FIFFT_CH_INFO_STRUCT :
-                            if (stream->read_tag(tag,this_ent->pos))
-                                fprintf(out,"TODO print_ch_info");
-                            //                                print_ch_info (out,set,(fiff_ch_info_t *)tag.data);
-                            break;
-                        case FIFFT_ID_STRUCT :
-                            if (stream->read_tag(tag,this_ent->pos))
-                                fprintf(out,"TODO print_file_id");
-                            //                                if (tag.size == sizeof(fiff_id_t))
-                            //                                    print_file_id (out,(fiff_id_t *)tag.data);
-                            break;
-                        case FIFFT_DIG_POINT_STRUCT :
-                            if (stream->read_tag(tag,this_ent->pos))
-                                fprintf(out,"TODO print_dig_point");
-                            //                                if (tag.size == sizeof(fiff_dig_point_t))
-                            //                                    print_dig_point (out,(fiff_dig_point_t *)tag.data);
-                            break;
-                        case FIFFT_DIG_STRING_STRUCT :
-                            if (stream->read_tag(tag,this_ent->pos)) {
-#ifdef FOO
-                                if ((ds = decode_fiff_dig_string(&tag)) != NULL)
-                                    print_dig_string (ds);
-                                free_fiff_dig_string(ds);
-#endif
-                            }
-                            break;
-                        case FIFFT_COORD_TRANS_STRUCT :
-                            if (stream->read_tag(tag,this_ent->pos))
-                                fprintf(out,"TODO print_transform");
-                            //                                if (tag.size == sizeof(fiff_coord_trans_t))
-                            //                                    print_transform   (out,(fiff_coord_trans_t *)tag.data);
-                            break;
-                        default :
-                            if (this_ent->kind == FIFF_DIG_STRING)
-                                fprintf(out,"type = %d\n",this_ent->type);
-                            if (this_ent->size > 0)
-                                fprintf(out,"\t%d bytes",this_ent->size);
-                            break;
+                            fprintf(out,"\t%s",s.toUtf8().constData());
                         }
                     }
-                    fprintf(out,"\n");
-                    prev_kind = this_ent->kind;
-                }
-                else {
-                    if (this_ent->kind != prev_kind) {
-                        if (count > 1)
-                            fprintf(out," [%d]\n",count);
-                        else if (this_ent != stream->dir()[0])
-                            fprintf(out,"\n");
-                        for (int k = 0; k < indent; k++)
-                            fprintf(out," ");
-                        exp = this->find_fiff_explanation(CLASS_TAG,this_ent->kind);
-                        if (exp != this->constEnd())
-                            fprintf(out,"%4d = %-s",exp->kind,exp->text.toUtf8().constData());
+                    break;
+                case FIFFT_FLOAT :
+                    if (stream->read_tag(tag,pos)) {
+                        if (tag->size() == sizeof(fiff_float_t))
+                            fprintf(out,"\t%g",*tag->toFloat());
                         else
-                            fprintf(out,"%4d = %-s",this_ent->kind,"Not explained");
-                        count = 1;
+                            fprintf(out,"\t%d floats",(int)(tag->size()/sizeof(fiff_float_t)));
                     }
-                    else
-                        count++;
+                    break;
+                case FIFFT_DOUBLE :
+                    if (stream->read_tag(tag,pos)) {
+                        if (tag->size() == sizeof(fiff_double_t))
+                            fprintf(out,"\t%g",*tag->toDouble());
+                        else
+                            fprintf(out,"\t%d doubles",(int)(tag->size()/sizeof(fiff_double_t)));
+                    }
+                    break;
+                case FIFFT_COMPLEX_FLOAT :
+                    if (stream->read_tag(tag,pos)) {
+                        float *fdata = tag->toFloat();
+                        if (tag->size() == 2*sizeof(fiff_float_t))
+                            fprintf(out,"\t(%g %g)",fdata[0],fdata[1]);
+                        else
+                            fprintf(out,"\t%d complex numbers",
+                                    (int)(tag->size()/(2*sizeof(fiff_float_t))));
+                    }
+                    break;
+                case FIFFT_COMPLEX_DOUBLE :
+                    if (stream->read_tag(tag,pos)) {
+                        double *ddata = tag->toDouble();
+                        if (tag->size() == 2*sizeof(fiff_double_t))
+                            fprintf(out,"\t(%g %g)",ddata[0],ddata[1]);
+                        else
+                            fprintf(out,"\t%d double complex numbers",
+                                    (int)(tag->size()/(2*sizeof(fiff_double_t))));
+                    }
+                    break;
+                case FIFFT_CH_INFO_STRUCT :
+                    if (stream->read_tag(tag,pos))
+                        fprintf(out,"TODO print_ch_info");
+                    //                                print_ch_info (out,set,(fiff_ch_info_t *)tag.data);
+                    break;
+                case FIFFT_ID_STRUCT :
+                    if (stream->read_tag(tag,pos))
+                        fprintf(out,"TODO print_file_id");
+                    //                                if (tag.size == sizeof(fiff_id_t))
+                    //                                    print_file_id (out,(fiff_id_t *)tag.data);
+                    break;
+                case FIFFT_DIG_POINT_STRUCT :
+                    if (stream->read_tag(tag,pos))
+                        fprintf(out,"TODO print_dig_point");
+                    //                                if (tag.size == sizeof(fiff_dig_point_t))
+                    //                                    print_dig_point (out,(fiff_dig_point_t *)tag.data);
+                    break;
+                case FIFFT_DIG_STRING_STRUCT :
+                    if (stream->read_tag(tag,pos)) {
+#ifdef FOO
+                        if ((ds = decode_fiff_dig_string(&tag)) != NULL)
+                            print_dig_string (ds);
+                        free_fiff_dig_string(ds);
+#endif
+                    }
+                    break;
+                case FIFFT_COORD_TRANS_STRUCT :
+                    if (stream->read_tag(tag,pos))
+                        fprintf(out,"TODO print_transform");
+                    //                                if (tag.size == sizeof(fiff_coord_trans_t))
+                    //                                    print_transform   (out,(fiff_coord_trans_t *)tag.data);
+                    break;
+                default :
+                    if (this_ent->kind == FIFF_DIG_STRING)
+                        fprintf(out,"type = %d\n",this_ent->type);
+                    if (this_ent->size > 0)
+                        fprintf(out,"\t%d bytes",this_ent->size);
+                    break;
                 }
             }
-            prev_kind = this_ent->kind;
+            fprintf(out,"\n");
         }
-        if (!verbose) {
-            if (count > 1)
-                fprintf(out," [%d]\n",count);
+        else {
+            if (this_ent->kind != state.prev_kind) {
+                if (state.count > 1)
+                    fprintf(out," [%d]\n",state.count);
+                else if (!state.first)
+                    fprintf(out,"\n");
+                for (int k = 0; k < state.indent; k++)
+                    fprintf(out," ");
+                exp = this->find_fiff_explanation(CLASS_TAG,this_ent->kind);
+                if (exp != this->constEnd())
+                    fprintf(out,"%4d = %-s",exp->kind,exp->text.toUtf8().constData());
+                else
+                    fprintf(out,"%4d = %-s",this_ent->kind,"Not explained");
+                state.count = 1;
+            }
             else
-                fprintf(out,"\n");
+                state.count++;
         }
     }
-
-    stream->close();
-
-    return true;
+    state.prev_kind = this_ent->kind;
+    state.first = false;
 }
 
 
-
 //*************************************************************************************************************
 
 void MneFiffExpSet::sort_fiff_explanations()
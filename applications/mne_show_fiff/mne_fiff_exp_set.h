@@ -65,6 +65,11 @@
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
+namespace FIFFLIB {
+    class FiffStream;
+    class FiffDirEntry;
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -213,12 +218,44 @@ public:
     * @param[in] indent_step    Indentation step
     * @param[in] long_strings   Print long strings in full?
     * @param[in] blocks_only    Print blocks only?
+    * @param[in] max_depth      Print only blocks and tags up to this block depth, all if < 0 (optional, default = -1)
+    * @param[in] streaming      Walk the tags one after another instead of reading the directory first, the output
+    *                           starts right away (optional, default = false)
     *
     * @return true if succeeded
     */
-    bool show_fiff_contents (FILE *out, const QString& name, bool verbose, const QList<int>& tags, int indent_step, bool long_strings, bool blocks_only);
+    bool show_fiff_contents (FILE *out, const QString& name, bool verbose, const QList<int>& tags, int indent_step, bool long_strings, bool blocks_only, int max_depth = -1, bool streaming = false);
 
 private:
+    /**
+    * The state of show_fiff_contents carried from one tag to the next
+    */
+    struct ShowFiffState {
+        int     indent;         /**< Current indentation. */
+        int     depth;          /**< Current block depth. */
+        int     count;          /**< Number of consecutive tags of the same kind in terse output. */
+        int     prev_kind;      /**< Kind of the previous tag. */
+        bool    first;          /**< True until the first tag was processed. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Shows a single tag of a fif file, its data is only read if it is printed.
+    *
+    * @param[in] out            Output file
+    * @param[in] stream         The opened fiff stream
+    * @param[in] this_ent       The tag to show
+    * @param[in] pos            Position of the tag in the file
+    * @param[in] verbose        Verbose output?
+    * @param[in] tags           Output these specific tags?
+    * @param[in] indent_step    Indentation step
+    * @param[in] long_strings   Print long strings in full?
+    * @param[in] blocks_only    Print blocks only?
+    * @param[in] max_depth      Print only blocks and tags up to this block depth, all if < 0
+    * @param[in, out] state     The state carried from one tag to the next
+    */
+    void show_fiff_entry (FILE *out, QSharedPointer<FIFFLIB::FiffStream>& stream, const QSharedPointer<FIFFLIB::FiffDirEntry>& this_ent, qint64 pos, bool verbose, const QList<int>& tags, int indent_step, bool long_strings, bool blocks_only, int max_depth, ShowFiffState& state);
+
     //=========================================================================================================
     /**
     * Sort the fiff explanation set
@@ -0,0 +1,262 @@
+//=============================================================================================================
+/**
+* @file     mne_fiff_scanner.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MneFiffScanner class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_fiff_scanner.h"
+
+#include <fiff/fiff_stream.h>
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_info.h>
+#include <fiff/fiff_dir_node.h>
+
+#include <utils/executionconfig.h>
+
+#include <stdio.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SHOWFIFF;
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+#define SCAN_MEAS_INFO_FIELDS  (FiffStream::MeasInfoBasic | FiffStream::MeasInfoProjs | FiffStream::MeasInfoBads)
+
+
+//*************************************************************************************************************
+
+/*
+* Functor for QtConcurrent::blockingMapped
+*/
+struct ScanFile
+{
+    typedef QJsonObject result_type;
+
+    ScanFile(bool use_rawdir_cache) : m_bUseRawdirCache(use_rawdir_cache) {}
+
+    QJsonObject operator()(const QString& name) const
+    {
+        return MneFiffScanner::scan_file(name, m_bUseRawdirCache);
+    }
+
+    bool m_bUseRawdirCache;
+};
+
+
+//*************************************************************************************************************
+
+static QJsonArray to_json_array(const QStringList& list)
+{
+    QJsonArray array;
+    for (int k = 0; k < list.size(); ++k)
+        array.append(list[k]);
+    return array;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+QStringList MneFiffScanner::collect_files(const QStringList& names)
+{
+    QStringList files;
+    for (int k = 0; k < names.size(); ++k) {
+        QFileInfo info(names[k]);
+        if (info.isDir()) {
+            QStringList found;
+            QDirIterator it(names[k], QStringList() << "*.fif", QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext())
+                found << it.next();
+            found.sort();
+            files << found;
+        }
+        else
+            files << names[k];
+    }
+    return files;
+}
+
+
+//*************************************************************************************************************
+
+QJsonObject MneFiffScanner::scan_file(const QString& name, bool use_rawdir_cache)
+{
+    QJsonObject result;
+    result["file"] = name;
+    result["size"] = static_cast<double>(QFileInfo(name).size());
+
+    //
+    //   Find out what is in the file
+    //
+    QFile file(name);
+    FiffStream::SPtr stream(new FiffStream(&file));
+    if (!stream->open()) {
+        result["ok"] = false;
+        result["error"] = QString("cannot open file");
+        return result;
+    }
+
+    FiffDirNode::SPtr tree = stream->dirtree();
+    QStringList kinds;
+    bool hasRaw = tree->has_kind(FIFFB_RAW_DATA) || tree->has_kind(FIFFB_CONTINUOUS_DATA) || tree->has_kind(FIFFB_SMSH_RAW_DATA);
+    if (hasRaw)
+        kinds << "raw";
+    if (tree->has_kind(FIFFB_EVOKED))
+        kinds << "evoked";
+    if (tree->has_kind(FIFFB_MNE_FORWARD_SOLUTION))
+        kinds << "forward";
+    if (tree->has_kind(FIFFB_MNE_INVERSE_SOLUTION))
+        kinds << "inverse";
+    if (tree->has_kind(FIFFB_MNE_COV))
+        kinds << "cov";
+    result["kinds"] = to_json_array(kinds);
+
+    //
+    //   Read only the parts of the measurement info which are reported
+    //
+    FiffInfo info;
+    FiffDirNode::SPtr meas;
+    bool ok = false;
+    if (hasRaw) {
+        stream->close();
+        FiffRawData raw;
+        ok = FiffStream::setup_read_raw(file, raw, true, use_rawdir_cache, SCAN_MEAS_INFO_FIELDS);
+        if (ok) {
+            info = raw.info;
+            result["first_samp"] = raw.first_samp;
+            result["last_samp"] = raw.last_samp;
+            result["duration"] = (raw.last_samp - raw.first_samp + 1)/info.sfreq;
+            result["buffers"] = raw.rawdir.size();
+        }
+    }
+    else if (tree->has_kind(FIFFB_MEAS)) {
+        ok = stream->read_meas_info(tree, info, meas, SCAN_MEAS_INFO_FIELDS);
+        stream->close();
+    }
+    else {
+        stream->close();
+        result["ok"] = true;
+        return result;
+    }
+
+    result["ok"] = ok;
+    if (!ok) {
+        result["error"] = QString("cannot read the measurement info");
+        return result;
+    }
+
+    result["nchan"] = info.nchan;
+    result["sfreq"] = info.sfreq;
+    result["highpass"] = info.highpass;
+    result["lowpass"] = info.lowpass;
+    result["meas_date"] = info.meas_date[0];
+    result["ch_names"] = to_json_array(info.ch_names);
+    result["bads"] = to_json_array(info.bads);
+
+    //
+    //   The projectors with the description and the active flag of their FIFFB_PROJ_ITEM blocks
+    //
+    QJsonArray projs;
+    for (int k = 0; k < info.projs.size(); ++k) {
+        QJsonObject proj;
+        proj["desc"] = info.projs[k].desc;
+        proj["kind"] = info.projs[k].kind;
+        proj["active"] = info.projs[k].active;
+        proj["nvec"] = info.projs[k].data->nrow;
+        projs.append(proj);
+    }
+    result["projs"] = projs;
+
+    return result;
+}
+
+
+//*************************************************************************************************************
+
+bool MneFiffScanner::scan(FILE *out, const QStringList& names, int threads, bool use_rawdir_cache)
+{
+    QStringList files = collect_files(names);
+    if (files.isEmpty()) {
+        qCritical("No fif files to scan.");
+        return false;
+    }
+
+    if (threads > 0)
+        UTILSLIB::ExecutionConfig::setPool("default", threads, UTILSLIB::ExecutionConfig::priority(), UTILSLIB::ExecutionConfig::cores());
+
+    fprintf(stderr,"Scanning %d files with %d threads...\n", files.size(), QThreadPool::globalInstance()->maxThreadCount());
+
+    QList<QJsonObject> results = QtConcurrent::blockingMapped<QList<QJsonObject> >(files, ScanFile(use_rawdir_cache));
+
+    bool ok = true;
+    for (int k = 0; k < results.size(); ++k) {
+        fprintf(out,"%s\n",QJsonDocument(results[k]).toJson(QJsonDocument::Compact).constData());
+        if (!results[k]["ok"].toBool())
+            ok = false;
+    }
+    fflush(out);
+
+    return ok;
+}
@@ -0,0 +1,115 @@
+//=============================================================================================================
+/**
+* @file     mne_fiff_scanner.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MneFiffScanner class declaration.
+*
+*/
+
+#ifndef MNEFIFFSCANNER_H
+#define MNEFIFFSCANNER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <stdio.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE SHOWFIFF
+//=============================================================================================================
+
+namespace SHOWFIFF
+{
+
+//=============================================================================================================
+/**
+* Scans many fif files in parallel and reports their metadata as JSON lines, one object per file:
+* file name and size, the data kinds found in the file, the basic measurement info, the bad channels, the SSP
+* projectors and for raw data the sample range. Only the parts of the measurement info which are reported are
+* parsed.
+*
+* @brief Batch fiff metadata scanner
+*/
+class MneFiffScanner
+{
+public:
+    //=========================================================================================================
+    /**
+    * Collects the fif files to scan. Directories are searched recursively for *.fif files.
+    *
+    * @param[in] names      Files and directories
+    *
+    * @return the fif files
+    */
+    static QStringList collect_files(const QStringList& names);
+
+    //=========================================================================================================
+    /**
+    * Scans the metadata of a single file.
+    *
+    * @param[in] name               The fif file
+    * @param[in] use_rawdir_cache   Use (and write) the raw directory cache of raw data files
+    *
+    * @return the JSON object of the file
+    */
+    static QJsonObject scan_file(const QString& name, bool use_rawdir_cache);
+
+    //=========================================================================================================
+    /**
+    * Scans the given files and directories in parallel and writes one JSON line per file. The lines keep the
+    * order of the collected files.
+    *
+    * @param[in] out                Where to write the JSON lines
+    * @param[in] names              Files and directories to scan
+    * @param[in] threads            Number of parallel scans, the ideal thread count if <= 0
+    * @param[in] use_rawdir_cache   Use (and write) the raw directory cache of raw data files
+    *
+    * @return true if all files could be scanned, false otherwise
+    */
+    static bool scan(FILE *out, const QStringList& names, int threads, bool use_rawdir_cache);
+};
+
+} //NAMESPACE SHOWFIFF
+
+#endif // MNEFIFFSCANNER_H
@@ -37,6 +37,7 @@ include(../../mne-cpp.pri)
 
 TEMPLATE = app
 
+QT += concurrent
 QT -= gui
 
 VERSION = $${MNE_CPP_VERSION}
@@ -73,12 +74,14 @@ SOURCES += \
     main.cpp \
     mne_fiff_exp.cpp \
     mne_fiff_exp_set.cpp \
-    mne_show_fiff_settings.cpp
+    mne_show_fiff_settings.cpp \
+    mne_fiff_scanner.cpp
 
 HEADERS += \
     mne_fiff_exp.h \
     mne_fiff_exp_set.h \
-    mne_show_fiff_settings.h
+    mne_show_fiff_settings.h \
+    mne_fiff_scanner.h
 
 RESOURCE_FILES +=\
     $${ROOT_DIR}/resources/general/explanations/fiff_explanations.txt \
@@ -72,6 +72,10 @@ MneShowFiffSettings::MneShowFiffSettings()
 , verbose(false)
 , long_strings(false)
 , blocks_only(false)
+, depth(-1)
+, stream(false)
+, threads(-1)
+, rawdir_cache(false)
 {
 
 }
@@ -84,6 +88,10 @@ MneShowFiffSettings::MneShowFiffSettings(int *argc,char **argv)
 , verbose(false)
 , long_strings(false)
 , blocks_only(false)
+, depth(-1)
+, stream(false)
+, threads(-1)
+, rawdir_cache(false)
 {
     if (!check_args(argc,argv))
         return;
@@ -124,6 +132,12 @@ void MneShowFiffSettings::usage(char *name)
     fprintf(stderr,"\t--indent no       Number of spaces to use in indentation (default %d in terse and 0 in verbose output)\n",indent);
     fprintf(stderr,"\t--tag no          Provide information about these tags (can have multiple of these).\n");
     fprintf(stderr,"\t--long            Print long strings in full?\n");
+    fprintf(stderr,"\t--depth no        Only list blocks and tags up to this block depth (0 = top level blocks).\n");
+    fprintf(stderr,"\t--stream          Walk the tags one after another instead of reading the directory first (output starts right away).\n");
+    fprintf(stderr,"\t--scan name       Scan the metadata of this file or of all fif files in this directory and print one JSON line per file (can have multiple of these).\n");
+    fprintf(stderr,"\t--threads no      Number of files scanned in parallel (default: number of cores).\n");
+    fprintf(stderr,"\t--rawdir-cache    Use and write the raw directory cache when scanning.\n");
+    fprintf(stderr,"\t--execution cfg   Configure the thread pools, e.g. \"default=4@0-3\" (see UTILSLIB::ExecutionConfig).\n");
     fprintf(stderr,"\t--help            print this info.\n");
     fprintf(stderr,"\t--version         print version info.\n\n");
 }
@@ -206,6 +220,54 @@ bool MneShowFiffSettings::check_args (int *argc,char **argv)
             if (val >= 0)
                 indent = val;
         }
+        else if (strcmp(argv[k],"--depth") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical("--depth: argument required.");
+                return false;
+            }
+            if (sscanf(argv[k+1],"%d",&val) != 1) {
+                qCritical("Incomprehensible number : %s",argv[k+1]);
+                return false;
+            }
+            depth = val;
+        }
+        else if (strcmp(argv[k],"--stream") == 0) {
+            found = 1;
+            stream = true;
+        }
+        else if (strcmp(argv[k],"--scan") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical("--scan: argument required.");
+                return false;
+            }
+            scan.append(QString(argv[k+1]));
+        }
+        else if (strcmp(argv[k],"--threads") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical("--threads: argument required.");
+                return false;
+            }
+            if (sscanf(argv[k+1],"%d",&val) != 1) {
+                qCritical("Incomprehensible number : %s",argv[k+1]);
+                return false;
+            }
+            threads = val;
+        }
+        else if (strcmp(argv[k],"--execution") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical("--execution: argument required.");
+                return false;
+            }
+            execution = QString(argv[k+1]);
+        }
+        else if (strcmp(argv[k],"--rawdir-cache") == 0) {
+            found = 1;
+            rawdir_cache = true;
+        }
         else if (strcmp(argv[k],"--verbose") == 0) {
             found = 1;
             verbose = true;
@@ -57,6 +57,7 @@
 
 #include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 #include <QList>
 
 
@@ -120,6 +121,12 @@ public:
     QList<int>  tags;           /**< Provide information about these tags (can have multiple of these). */
     bool        long_strings;   /**< Print long strings in full? */
     bool        blocks_only;    /**< Only list the blocks (the tree structure). */
+    int         depth;          /**< Only list blocks and tags up to this block depth (all if < 0). */
+    bool        stream;         /**< Walk the tags one after another instead of reading the directory first. */
+    QStringList scan;           /**< Files and directories to scan for metadata (JSON lines output). */
+    int         threads;        /**< Number of parallel scans in scan mode (the ideal thread count if <= 0). */
+    bool        rawdir_cache;   /**< Use the raw directory cache in scan mode. */
+    QString     execution;      /**< The thread pool configuration, see UTILSLIB::ExecutionConfig::configure. */
 
 private:
     void usage(char *name);
@@ -0,0 +1,226 @@
+//=============================================================================================================
+/**
+* @file     main.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Example of removing EOG and ECG artifacts from raw data with ICA
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <iostream>
+#include <math.h>
+
+#include <fiff/fiff.h>
+#include <utils/ica.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtCore/QCoreApplication>
+#include <QFile>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+* The function main marks the entry point of the program.
+* By default, main has the storage class extern.
+*
+* @param [in] argc (argument count) is an integer that indicates how many arguments were entered on the command line when the program was started.
+* @param [in] argv (argument vector) is an array of pointers to arrays of character objects. The array objects are null-terminated strings, representing the arguments that were entered on the command line when the program was started.
+* @return the value that was set to exit() (which is 0 if exit() is called via quit()).
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    // Command Line Parser
+    QCommandLineParser parser;
+    parser.setApplicationDescription("ICA Raw Example");
+    parser.addHelpOption();
+
+    QCommandLineOption inputOption("fileIn", "The input file <in>.", "in", "./MNE-sample-data/MEG/sample/sample_audvis_raw.fif");
+    QCommandLineOption componentsOption("components", "The number of independent <components>.", "components", "40");
+    QCommandLineOption decimationOption("decim", "Fit on every <decim>-th sample.", "decim", "3");
+    QCommandLineOption durationOption("duration", "Fit on the first <duration> seconds.", "duration", "60");
+    QCommandLineOption thresholdOption("threshold", "The z-score <threshold> of artifact components.", "threshold", "3.0");
+
+    parser.addOption(inputOption);
+    parser.addOption(componentsOption);
+    parser.addOption(decimationOption);
+    parser.addOption(durationOption);
+    parser.addOption(thresholdOption);
+
+    parser.process(a);
+
+    QFile t_fileIn(parser.value(inputOption));
+
+    //
+    //   Setup for reading the raw data
+    //
+    FiffRawData raw(t_fileIn);
+
+    //
+    //   MEG and EEG channels without the bad ones are decomposed, EOG and ECG channels are the references
+    //
+    RowVectorXi picks = raw.info.pick_types(true, true, false, QStringList(), raw.info.bads);
+    if(picks.cols() == 0) {
+        printf("no MEG or EEG channels found\n");
+        return -1;
+    }
+
+    QVector<int> vecPicks;
+    for(int i = 0; i < picks.cols(); ++i) {
+        vecPicks.append(picks(i));
+    }
+
+    QVector<int> vecReferences;
+    for(int i = 0; i < raw.info.nchan; ++i) {
+        if(raw.info.chs[i].kind == FIFFV_EOG_CH || raw.info.chs[i].kind == FIFFV_ECG_CH) {
+            vecReferences.append(i);
+        }
+    }
+
+    //
+    //   Read the fitting segment with the current projection applied
+    //
+    fiff_int_t from = raw.first_samp;
+    fiff_int_t to = qMin(raw.last_samp, from + fiff_int_t(ceil(parser.value(durationOption).toDouble()*raw.info.sfreq)) - 1);
+
+    MatrixXd data, times;
+    if(!raw.read_raw_segment(data, times, from, to)) {
+        printf("error during read_raw_segment\n");
+        return -1;
+    }
+
+    MatrixXd matMeg(vecPicks.size(), data.cols());
+    for(int i = 0; i < vecPicks.size(); ++i) {
+        matMeg.row(i) = data.row(vecPicks[i]);
+    }
+
+    //
+    //   Decompose
+    //
+    QElapsedTimer timer;
+    timer.start();
+
+    Ica ica;
+    if(!ica.fit(matMeg, parser.value(componentsOption).toInt(), parser.value(decimationOption).toInt())) {
+        printf("ICA did not converge\n");
+        return -1;
+    }
+
+    printf("Fitted %d components in %d iterations (%lld ms)\n", ica.components(), ica.iterations(), (long long)timer.elapsed());
+
+    //
+    //   Find the components which follow the references
+    //
+    QVector<int> vecExclude;
+    for(int i = 0; i < vecReferences.size(); ++i) {
+        VectorXd vecScores = ica.scores(matMeg, data.row(vecReferences[i]));
+        QVector<int> vecFound = Ica::findOutliers(vecScores, parser.value(thresholdOption).toDouble());
+
+        printf("%s:", raw.info.ch_names[vecReferences[i]].toUtf8().constData());
+        for(int j = 0; j < vecFound.size(); ++j) {
+            printf(" %d (%.2f)", vecFound[j], vecScores(vecFound[j]));
+            if(!vecExclude.contains(vecFound[j])) {
+                vecExclude.append(vecFound[j]);
+            }
+        }
+        printf("\n");
+    }
+
+    if(vecExclude.isEmpty()) {
+        printf("No artifact components found\n");
+        return 0;
+    }
+
+    //
+    //   Fold the removal into the projection of the raw data, every following read returns cleaned data
+    //
+    MatrixXd matIca = ica.projector(vecExclude, vecPicks, raw.info.nchan);
+    if(raw.proj.size() == 0) {
+        raw.proj = matIca;
+    } else {
+        raw.proj = matIca * raw.proj;
+    }
+
+    MatrixXd cleaned;
+    if(!raw.read_raw_segment(cleaned, times, from, to)) {
+        printf("error during read_raw_segment\n");
+        return -1;
+    }
+
+    for(int i = 0; i < vecReferences.size(); ++i) {
+        RowVectorXd vecRef = data.row(vecReferences[i]).array() - data.row(vecReferences[i]).mean();
+        vecRef /= vecRef.norm();
+
+        double dBefore = 0.0, dAfter = 0.0;
+        for(int j = 0; j < vecPicks.size(); ++j) {
+            RowVectorXd vecBefore = data.row(vecPicks[j]).array() - data.row(vecPicks[j]).mean();
+            RowVectorXd vecAfter = cleaned.row(vecPicks[j]).array() - cleaned.row(vecPicks[j]).mean();
+            dBefore += std::abs(vecBefore.dot(vecRef)) / vecBefore.norm();
+            dAfter += std::abs(vecAfter.dot(vecRef)) / vecAfter.norm();
+        }
+
+        printf("Mean correlation with %s: %.3f before, %.3f after\n",
+               raw.info.ch_names[vecReferences[i]].toUtf8().constData(),
+               dBefore / vecPicks.size(),
+               dAfter / vecPicks.size());
+    }
+
+    printf("Finished\n");
+
+    return 0;
+}
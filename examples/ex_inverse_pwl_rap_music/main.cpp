@@ -70,6 +70,7 @@
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QVector3D>
+#include <QElapsedTimer>
 
 
 //*************************************************************************************************************
@@ -116,6 +117,7 @@ int main(int argc, char *argv[])
     QCommandLineOption doMovieOption("doMovie", "Create overlapping movie.", "doMovie", "false");
     QCommandLineOption annotOption("annotType", "Annotation type <type>.", "type", "aparc.a2009s");
     QCommandLineOption surfOption("surfType", "Surface type <type>.", "type", "orig");
+    QCommandLineOption hierarchyOption("hierarchy", "Compare the coarse-to-fine search with <number> levels against the full search.", "number", "0");
 
     parser.addOption(fwdFileOption);
     parser.addOption(evokedFileOption);
@@ -126,6 +128,7 @@ int main(int argc, char *argv[])
     parser.addOption(doMovieOption);
     parser.addOption(annotOption);
     parser.addOption(surfOption);
+    parser.addOption(hierarchyOption);
     parser.process(app);
 
     // Parse command line parameters
@@ -139,6 +142,7 @@ int main(int argc, char *argv[])
     QString t_sFileNameStc(parser.value(stcFileOption));
 
     qint32 numDipolePairs = parser.value(numDipolePairsOption).toInt();
+    qint32 numLevels = parser.value(hierarchyOption).toInt();
 
     bool doMovie = false;
     if(parser.value(doMovieOption) == "false" || parser.value(doMovieOption) == "0") {
@@ -196,6 +200,33 @@ int main(int argc, char *argv[])
 
     std::cout << "source estimated" << std::endl;
 
+    //
+    // Compare the coarse-to-fine search against the full search
+    //
+    if(numLevels > 0) {
+        QList< DipolePair<double> > t_qListFull;
+        QList< DipolePair<double> > t_qListHierarchical;
+        QElapsedTimer t_timer;
+
+        t_timer.start();
+        t_pwlRapMusic.calculateInverse(pickedEvoked.data, t_qListFull);
+        qint64 t_iFullTime = t_timer.elapsed();
+
+        t_pwlRapMusic.setHierarchy(numLevels);
+
+        t_timer.restart();
+        t_pwlRapMusic.calculateInverse(pickedEvoked.data, t_qListHierarchical);
+        qint64 t_iHierarchicalTime = t_timer.elapsed();
+
+        t_pwlRapMusic.setHierarchy(0);
+
+        std::cout << "Full search: " << t_iFullTime << " ms; coarse-to-fine search (" << numLevels << " levels): " << t_iHierarchicalTime << " ms" << std::endl;
+        for(qint32 i = 0; i < t_qListFull.size() && i < t_qListHierarchical.size(); ++i) {
+            std::cout << "Pair " << i+1 << ": full " << t_qListFull[i].m_iIdx1 << " - " << t_qListFull[i].m_iIdx2 << " (" << t_qListFull[i].m_vCorrelation << ")"
+                      << "; coarse-to-fine " << t_qListHierarchical[i].m_iIdx1 << " - " << t_qListHierarchical[i].m_iIdx2 << " (" << t_qListHierarchical[i].m_vCorrelation << ")" << std::endl;
+        }
+    }
+
     if(sourceEstimate.isEmpty())
         return 1;
 
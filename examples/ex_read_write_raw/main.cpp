@@ -91,9 +91,11 @@ int main(int argc, char *argv[])
 
     QCommandLineOption inputOption("fileIn", "The input file <in>.", "in", "./MNE-sample-data/MEG/sample/sample_audvis_raw.fif");
     QCommandLineOption outputOption("fileOut", "The output file <out>.", "out", "./MNE-sample-data/MEG/sample/test_output.fif");
+    QCommandLineOption splitOption("splitSize", "Split the output file into parts of <size> MB, 0 writes a single file.", "size", "0");
 
     parser.addOption(inputOption);
     parser.addOption(outputOption);
+    parser.addOption(splitOption);
 
     parser.process(a);
 
@@ -135,6 +137,10 @@ int main(int argc, char *argv[])
     RowVectorXd cals;
 
     FiffStream::SPtr outfid = FiffStream::start_writing_raw(t_fileOut,raw.info, cals/*, picks*/);
+
+    fiff_long_t splitSize = parser.value(splitOption).toLongLong()*1024*1024;
+    if(splitSize > 0)
+        outfid->start_split_writing(splitSize, raw.first_samp);
     //
     //   Set up the reading parameters
     //
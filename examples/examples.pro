@@ -46,6 +46,7 @@ SUBDIRS += \
     ex_evoked_grad_amp \
     ex_fiff_io \
     ex_find_evoked \
+    ex_ica_raw \
     ex_inverse_mne \
     ex_make_inverse_operator \
     ex_make_layout \
@@ -43,6 +43,8 @@
 
 #include "connectivitysettings.h"
 #include "network/network.h"
+#include "network/networkedge.h"
+#include "network/networknode.h"
 #include "metrics/correlation.h"
 #include "metrics/crosscorrelation.h"
 #include "metrics/coherence.h"
@@ -52,6 +54,7 @@
 #include "metrics/weightedphaselagindex.h"
 #include "metrics/unbiasedsquaredphaselagindex.h"
 #include "metrics/debiasedsquaredweightedphaselagindex.h"
+#include "metrics/abstractmetric.h"
 
 
 //*************************************************************************************************************
@@ -59,6 +62,9 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QDebug>
+#include <QVector>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -78,6 +84,53 @@ using namespace CONNECTIVITYLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+//=============================================================================================================
+/**
+* Collapses the frequency resolved edge weights of a network to the mean over the given frequency columns.
+*
+* @param[in] network        The frequency resolved network.
+* @param[in] vecColumns     The frequency columns of the band.
+*
+* @return The band network with 1x1 edge weights.
+*/
+Network bandNetwork(const Network& network, const QVector<int>& vecColumns)
+{
+    Network finalNetwork(network.getConnectivityMethod());
+
+    for(int i = 0; i < network.getNodes().size(); ++i) {
+        const NetworkNode::SPtr& pNode = network.getNodes().at(i);
+        finalNetwork.append(NetworkNode::SPtr(new NetworkNode(pNode->getId(), pNode->getVert())));
+    }
+
+    for(int i = 0; i < network.getEdges().size(); ++i) {
+        const NetworkEdge::SPtr& pEdge = network.getEdges().at(i);
+        Eigen::MatrixXd matFreqWeight = pEdge->getWeight();
+        Eigen::MatrixXd matWeight = Eigen::MatrixXd::Zero(1, matFreqWeight.cols());
+
+        for(int c = 0; c < vecColumns.size(); ++c) {
+            matWeight += matFreqWeight.row(vecColumns.at(c));
+        }
+        if(!vecColumns.isEmpty()) {
+            matWeight /= vecColumns.size();
+        }
+
+        int iStart = pEdge->getStartNode()->getId();
+        int iEnd = pEdge->getEndNode()->getId();
+        QSharedPointer<NetworkEdge> pBandEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork.getNodes()[iStart],
+                                                                                            finalNetwork.getNodes()[iEnd],
+                                                                                            matWeight));
+
+        finalNetwork.getNodeAt(iStart)->append(pBandEdge);
+        finalNetwork.append(pBandEdge);
+    }
+
+    return finalNetwork;
+}
+
+} // namespace
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -128,3 +181,93 @@ Network Connectivity::calculateConnectivity() const
 
     return Network();
 }
+
+
+//*************************************************************************************************************
+
+QList<Network> Connectivity::calculateConnectivities() const
+{
+    const QStringList& lMethods = m_pConnectivitySettings->m_sConnectivityMethods;
+    const QList<Eigen::MatrixXd>& matDataList = m_pConnectivitySettings->m_matDataList;
+    const Eigen::MatrixX3f& matVert = m_pConnectivitySettings->m_matNodePositions;
+    QList<QPair<float,float> > lBands = m_pConnectivitySettings->m_lFrequencyBands;
+    QList<Network> lNetworks;
+
+    if(!lBands.isEmpty() && m_pConnectivitySettings->m_fSFreq <= 0.0f) {
+        qWarning() << "Connectivity::calculateConnectivities - The sampling frequency is unknown, set it with ConnectivitySettings::setFiffInfo. Using the full frequency axis.";
+        lBands.clear();
+    }
+
+    // Compute the tapered spectra once for all spectral methods
+    TaperedSpectra spectra;
+    QStringList lSpectralMethods;
+    lSpectralMethods << "PLI" << "COH" << "IMAGCOH" << "PLV" << "WPLI" << "USPLI" << "DSWPLI";
+    for(int i = 0; i < lMethods.size(); ++i) {
+        if(lSpectralMethods.contains(lMethods.at(i))) {
+            spectra = AbstractMetric::computeTaperedSpectra(matDataList,
+                                                            m_pConnectivitySettings->m_iNfft,
+                                                            m_pConnectivitySettings->m_sWindowType,
+                                                            lBands,
+                                                            m_pConnectivitySettings->m_fSFreq);
+            break;
+        }
+    }
+
+    for(int i = 0; i < lMethods.size(); ++i) {
+        const QString& sMethod = lMethods.at(i);
+
+        if(sMethod == "COR") {
+            lNetworks.append(Correlation::correlationCoeff(matDataList, matVert));
+        } else if(sMethod == "XCOR") {
+            lNetworks.append(CrossCorrelation::crossCorrelation(matDataList, matVert));
+        } else if(sMethod == "PLI") {
+            lNetworks.append(PhaseLagIndex::phaseLagIndex(spectra, matVert));
+        } else if(sMethod == "COH") {
+            lNetworks.append(Coherence::coherence(spectra, matVert));
+        } else if(sMethod == "IMAGCOH") {
+            lNetworks.append(ImagCoherence::imagCoherence(spectra, matVert));
+        } else if(sMethod == "PLV") {
+            lNetworks.append(PhaseLockingValue::phaseLockingValue(spectra, matVert));
+        } else if(sMethod == "WPLI") {
+            lNetworks.append(WeightedPhaseLagIndex::weightedPhaseLagIndex(spectra, matVert));
+        } else if(sMethod == "USPLI") {
+            lNetworks.append(UnbiasedSquaredPhaseLagIndex::unbiasedSquaredPhaseLagIndex(spectra, matVert));
+        } else if(sMethod == "DSWPLI") {
+            lNetworks.append(DebiasedSquaredWeightedPhaseLagIndex::debiasedSquaredWeightedPhaseLagIndex(spectra, matVert));
+        } else {
+            qDebug() << "Connectivity::calculateConnectivities - Unknown method" << sMethod;
+            lNetworks.append(Network());
+        }
+    }
+
+    if(lBands.isEmpty()) {
+        return lNetworks;
+    }
+
+    // Split the stored frequency columns into the requested bands
+    QList<QVector<int> > lBandColumns;
+    for(int b = 0; b < lBands.size(); ++b) {
+        QVector<int> vecColumns;
+        for(int c = 0; c < spectra.vecFreqBins.size(); ++c) {
+            float fFreq = spectra.vecFreqBins(c) * m_pConnectivitySettings->m_fSFreq / spectra.iNfft;
+            if(fFreq >= lBands.at(b).first && fFreq <= lBands.at(b).second) {
+                vecColumns.append(c);
+            }
+        }
+        if(vecColumns.isEmpty()) {
+            qDebug() << "Connectivity::calculateConnectivities - No frequency bin in band" << lBands.at(b).first << lBands.at(b).second;
+        }
+        lBandColumns.append(vecColumns);
+    }
+
+    // The correlation based methods are not frequency resolved and are repeated for every band
+    QList<Network> lBandNetworks;
+    for(int i = 0; i < lMethods.size(); ++i) {
+        bool bSpectral = lSpectralMethods.contains(lMethods.at(i));
+        for(int b = 0; b < lBands.size(); ++b) {
+            lBandNetworks.append(bSpectral ? bandNetwork(lNetworks.at(i), lBandColumns.at(b)) : lNetworks.at(i));
+        }
+    }
+
+    return lBandNetworks;
+}
@@ -51,6 +51,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QList>
 
 
 //*************************************************************************************************************
@@ -111,6 +112,19 @@ public:
     */
     Network calculateConnectivity() const;
 
+    //=========================================================================================================
+    /**
+    * Computes one network per method in the settings. The tapered spectra are computed once and shared by
+    * all spectral methods.
+    *
+    * If frequency bands are set, only the FFT bins within the bands are computed and one network per method and
+    * band is returned, with the edge weights averaged over the band. The networks are ordered by method first
+    * and band second.
+    *
+    * @return Returns the networks in the order of the methods. Unknown methods yield an empty network.
+    */
+    QList<Network> calculateConnectivities() const;
+
 protected:
     QSharedPointer<ConnectivitySettings>    m_pConnectivitySettings;           /**< The current connectivity settings. */
 };
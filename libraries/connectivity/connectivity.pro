@@ -51,10 +51,16 @@ CONFIG(debug, debug|release) {
 
 LIBS += -L$${MNE_LIBRARY_DIR}
 CONFIG(debug, debug|release) {
-    LIBS += -lMNE$${MNE_LIB_VERSION}Utilsd
+    LIBS += -lMNE$${MNE_LIB_VERSION}Utilsd \
+            -lMNE$${MNE_LIB_VERSION}Fsd \
+            -lMNE$${MNE_LIB_VERSION}Fiffd \
+            -lMNE$${MNE_LIB_VERSION}Mned
 }
 else {
-    LIBS += -lMNE$${MNE_LIB_VERSION}Utils
+    LIBS += -lMNE$${MNE_LIB_VERSION}Utils \
+            -lMNE$${MNE_LIB_VERSION}Fs \
+            -lMNE$${MNE_LIB_VERSION}Fiff \
+            -lMNE$${MNE_LIB_VERSION}Mne
 }
 
 DESTDIR = $${MNE_LIBRARY_DIR}
@@ -82,8 +88,13 @@ SOURCES += \
     network/network.cpp \
     network/networknode.cpp \
     network/networkedge.cpp \
+    network/sparsenetwork.cpp \
+    network/graphmetrics.cpp \
     connectivitysettings.cpp \
-    connectivity.cpp
+    connectivity.cpp \
+    incrementalconnectivity.cpp \
+    connectivitystatistics.cpp \
+    sourceroireduction.cpp
 
 HEADERS += \
     connectivity_global.h \
@@ -101,8 +112,13 @@ HEADERS += \
     network/network.h \
     network/networknode.h \
     network/networkedge.h \
+    network/sparsenetwork.h \
+    network/graphmetrics.h \
     connectivitysettings.h \
-    connectivity.h
+    connectivity.h \
+    incrementalconnectivity.h \
+    connectivitystatistics.h \
+    sourceroireduction.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
 INCLUDEPATH += $${MNE_INCLUDE_DIR}
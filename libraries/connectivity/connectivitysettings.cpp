@@ -41,6 +41,8 @@
 
 #include "connectivitysettings.h"
 
+#include <fiff/fiff_info.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -62,6 +64,7 @@
 //=============================================================================================================
 
 using namespace CONNECTIVITYLIB;
+using namespace FIFFLIB;
 
 
 //*************************************************************************************************************
@@ -76,7 +79,18 @@ using namespace CONNECTIVITYLIB;
 //=============================================================================================================
 
 ConnectivitySettings::ConnectivitySettings()
+: m_iNfft(-1)
+, m_sWindowType("hanning")
+, m_fSFreq(-1.0f)
+{
+}
+
+
+//*************************************************************************************************************
+
+void ConnectivitySettings::setFiffInfo(const FiffInfo& info)
 {
+    m_fSFreq = info.sfreq;
 }
 
 
@@ -51,6 +51,9 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QList>
+#include <QPair>
+#include <QString>
 
 
 //*************************************************************************************************************
@@ -66,6 +69,10 @@
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
+namespace FIFFLIB {
+    class FiffInfo;
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -100,6 +107,14 @@ public:
     */
     explicit ConnectivitySettings();
 
+    //=========================================================================================================
+    /**
+    * Takes the sampling frequency from the measurement info of the data.
+    *
+    * @param[in] info   The measurement info.
+    */
+    void setFiffInfo(const FIFFLIB::FiffInfo& info);
+
     QStringList                 m_sConnectivityMethods;         /**< The connectivity methods. */
 
     QList<Eigen::MatrixXd>      m_matDataList;                  /**< The input data. */
@@ -107,6 +122,8 @@ public:
 
     int                         m_iNfft;                        /**< The FFT length used for spectral estimation. */
     QString                     m_sWindowType;                  /**< The window type used to compute tapered spectra. */
+    float                       m_fSFreq;                       /**< The sampling frequency in Hz, see setFiffInfo. Needed for frequency bands, -1 if unknown. */
+    QList<QPair<float,float> >  m_lFrequencyBands;              /**< The [fmin,fmax] frequency bands in Hz. Empty uses the full frequency axis. */
 
 protected:
 
@@ -0,0 +1,283 @@
+//=============================================================================================================
+/**
+* @file     connectivitystatistics.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     ConnectivityStatistics class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "connectivitystatistics.h"
+
+#include "connectivitysettings.h"
+#include "metrics/abstractmetric.h"
+#include "metrics/coherence.h"
+#include "metrics/imagcoherence.h"
+#include "metrics/phaselockingvalue.h"
+#include "metrics/phaselagindex.h"
+#include "metrics/unbiasedsquaredphaselagindex.h"
+#include "metrics/weightedphaselagindex.h"
+#include "metrics/debiasedsquaredweightedphaselagindex.h"
+
+#include <utils/executionconfig.h>
+
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QList>
+#include <QThread>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace CONNECTIVITYLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+struct SurrogateJob {
+    const TaperedSpectra*               pSpectra;       /**< The observed tapered spectra. */
+    const QVector<MatrixXd>*            pObserved;      /**< The observed connectivity. */
+    QString                             sMethod;        /**< The connectivity method. */
+    ConnectivityStatistics::SurrogateType type;         /**< The way the surrogate is generated. */
+    unsigned int                        uiSeed;         /**< The seed of the surrogate. */
+    QVector<MatrixXd>                   vecExceedances; /**< 1 where the surrogate is at least as large as the observation. */
+};
+
+void computeSurrogate(SurrogateJob& job)
+{
+    QVector<MatrixXd> vecSurrogate = ConnectivityStatistics::computeMetric(ConnectivityStatistics::surrogateSpectra(*job.pSpectra,
+                                                                                                                   job.type,
+                                                                                                                   job.uiSeed),
+                                                                           job.sMethod);
+
+    job.vecExceedances.clear();
+    for(int i = 0; i < vecSurrogate.size(); ++i) {
+        job.vecExceedances.append((vecSurrogate.at(i).array().abs() >= job.pObserved->at(i).array().abs()).cast<double>().matrix());
+    }
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+ConnectivityStatistics::ConnectivityStatistics()
+{
+}
+
+
+//*************************************************************************************************************
+
+QStringList ConnectivityStatistics::supportedMethods()
+{
+    QStringList lMethods;
+    lMethods << "COH" << "IMAGCOH" << "PLV" << "PLI" << "USPLI" << "WPLI" << "DSWPLI";
+    return lMethods;
+}
+
+
+//*************************************************************************************************************
+
+SurrogateResult ConnectivityStatistics::surrogateTest(const ConnectivitySettings& connectivitySettings,
+                                                      const QString& sMethod,
+                                                      int iNSurrogates,
+                                                      SurrogateType type,
+                                                      unsigned int uiSeed)
+{
+    return surrogateTest(AbstractMetric::computeTaperedSpectra(connectivitySettings.m_matDataList,
+                                                               connectivitySettings.m_iNfft,
+                                                               connectivitySettings.m_sWindowType,
+                                                               connectivitySettings.m_lFrequencyBands,
+                                                               connectivitySettings.m_fSFreq),
+                         sMethod,
+                         iNSurrogates,
+                         type,
+                         uiSeed);
+}
+
+
+//*************************************************************************************************************
+
+SurrogateResult ConnectivityStatistics::surrogateTest(const TaperedSpectra& spectra,
+                                                      const QString& sMethod,
+                                                      int iNSurrogates,
+                                                      SurrogateType type,
+                                                      unsigned int uiSeed)
+{
+    SurrogateResult result;
+
+    if(!supportedMethods().contains(sMethod)) {
+        qDebug() << "ConnectivityStatistics::surrogateTest - Unknown method" << sMethod;
+        return result;
+    }
+
+    result.vecObserved = computeMetric(spectra, sMethod);
+
+    QVector<MatrixXd> vecCounts;
+    for(int i = 0; i < result.vecObserved.size(); ++i) {
+        vecCounts.append(MatrixXd::Zero(result.vecObserved.at(i).rows(), result.vecObserved.at(i).cols()));
+    }
+
+    // Run the surrogates in batches of the thread count, so only one batch of surrogate results is held at a time
+    int iBatchSize = UTILSLIB::ExecutionConfig::threadCount();
+
+    for(int iStart = 0; iStart < iNSurrogates; iStart += iBatchSize) {
+        QList<SurrogateJob> lJobs;
+        for(int s = iStart; s < qMin(iStart + iBatchSize, iNSurrogates); ++s) {
+            SurrogateJob job;
+            job.pSpectra = &spectra;
+            job.pObserved = &result.vecObserved;
+            job.sMethod = sMethod;
+            job.type = type;
+            job.uiSeed = uiSeed + s;
+            lJobs.append(job);
+        }
+
+        QtConcurrent::blockingMap(lJobs, computeSurrogate);
+
+        for(int j = 0; j < lJobs.size(); ++j) {
+            for(int i = 0; i < vecCounts.size(); ++i) {
+                vecCounts[i] += lJobs.at(j).vecExceedances.at(i);
+            }
+        }
+    }
+
+    result.iNSurrogates = qMax(0, iNSurrogates);
+    for(int i = 0; i < vecCounts.size(); ++i) {
+        result.vecPValues.append((vecCounts.at(i).array() + 1.0) / (result.iNSurrogates + 1.0));
+    }
+
+    return result;
+}
+
+
+//*************************************************************************************************************
+
+TaperedSpectra ConnectivityStatistics::surrogateSpectra(const TaperedSpectra& spectra,
+                                                        SurrogateType type,
+                                                        unsigned int uiSeed)
+{
+    TaperedSpectra surrogate = spectra;
+    int iNTrials = spectra.vecTapSpectra.size();
+
+    std::mt19937 generator(uiSeed);
+
+    if(type == PhaseRandomization) {
+        std::uniform_real_distribution<double> phaseDistribution(0.0, 2.0 * M_PI);
+
+        // The same phase for all tapers of a frequency keeps the taper average of the power
+        for(int t = 0; t < iNTrials; ++t) {
+            QVector<MatrixXcd>& vecTrial = surrogate.vecTapSpectra[t];
+
+            for(int r = 0; r < vecTrial.size(); ++r) {
+                RowVectorXcd vecPhase(vecTrial.at(r).cols());
+                for(int f = 0; f < vecPhase.size(); ++f) {
+                    vecPhase(f) = std::polar(1.0, phaseDistribution(generator));
+                }
+                vecTrial[r] = vecTrial.at(r).array().rowwise() * vecPhase.array();
+            }
+        }
+    } else {
+        // Every row but the first is paired with its own permutation of the trials
+        QVector<int> vecOrder(iNTrials);
+
+        for(int r = 1; r < spectra.iNRows; ++r) {
+            for(int t = 0; t < iNTrials; ++t) {
+                vecOrder[t] = t;
+            }
+            std::shuffle(vecOrder.begin(), vecOrder.end(), generator);
+
+            for(int t = 0; t < iNTrials; ++t) {
+                surrogate.vecTapSpectra[t][r] = spectra.vecTapSpectra.at(vecOrder.at(t)).at(r);
+            }
+        }
+    }
+
+    return surrogate;
+}
+
+
+//*************************************************************************************************************
+
+QVector<MatrixXd> ConnectivityStatistics::computeMetric(const TaperedSpectra& spectra,
+                                                        const QString& sMethod)
+{
+    if(sMethod == "COH") {
+        return Coherence::computeCoherence(spectra);
+    } else if(sMethod == "IMAGCOH") {
+        return ImagCoherence::computeImagCoherence(spectra);
+    } else if(sMethod == "PLV") {
+        return PhaseLockingValue::computePLV(spectra);
+    } else if(sMethod == "PLI") {
+        return PhaseLagIndex::computePLI(spectra);
+    } else if(sMethod == "USPLI") {
+        return UnbiasedSquaredPhaseLagIndex::computeUnbiasedSquaredPLI(spectra);
+    } else if(sMethod == "WPLI") {
+        return WeightedPhaseLagIndex::computeWPLI(spectra);
+    } else if(sMethod == "DSWPLI") {
+        return DebiasedSquaredWeightedPhaseLagIndex::computeDebiasedSquaredWPLI(spectra);
+    }
+
+    qDebug() << "ConnectivityStatistics::computeMetric - Unknown method" << sMethod;
+    return QVector<MatrixXd>();
+}
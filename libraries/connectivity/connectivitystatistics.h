@@ -0,0 +1,222 @@
+//=============================================================================================================
+/**
+* @file     connectivitystatistics.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     ConnectivityStatistics class declaration.
+*
+*/
+
+#ifndef CONNECTIVITYSTATISTICS_H
+#define CONNECTIVITYSTATISTICS_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "connectivity_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE CONNECTIVITYLIB
+//=============================================================================================================
+
+namespace CONNECTIVITYLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// CONNECTIVITYLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+class ConnectivitySettings;
+struct TaperedSpectra;
+
+
+//=============================================================================================================
+/**
+* The result of a surrogate test. All matrices have the layout of the metric, i.e. one rows x frequencies
+* matrix per seed row.
+*/
+struct SurrogateResult {
+    QVector<Eigen::MatrixXd>    vecObserved;        /**< The observed connectivity. */
+    QVector<Eigen::MatrixXd>    vecPValues;         /**< The p-values of the observed connectivity. */
+    int                         iNSurrogates;       /**< The number of surrogates the p-values are based on. */
+
+    SurrogateResult() : iNSurrogates(0) {}
+};
+
+
+//=============================================================================================================
+/**
+* Tests spectral connectivity against surrogate data. The surrogates are generated from the tapered spectra of
+* the observed data, so no FFT is repeated per surrogate:
+*
+* PhaseRandomization adds an independent random phase to every trial, row and frequency. The power spectra are
+* kept, the phase relation between the rows is destroyed.
+*
+* TrialShuffling pairs the spectra of every row with the spectra of randomly permuted trials of the other rows.
+* The per trial spectra are kept, the trial locked relation between the rows is destroyed.
+*
+* The p-value of each entry is (1 + number of surrogates with an absolute value at least as large as the
+* observed one) / (1 + number of surrogates). The surrogates are computed in parallel and generated from
+* per surrogate seeds, so the result does not depend on the scheduling.
+*
+* Supported methods are "COH", "IMAGCOH", "PLV", "PLI", "USPLI", "WPLI" and "DSWPLI".
+*
+* @brief Surrogate statistics for spectral connectivity.
+*/
+class CONNECTIVITYSHARED_EXPORT ConnectivityStatistics
+{
+
+public:
+    typedef QSharedPointer<ConnectivityStatistics> SPtr;            /**< Shared pointer type for ConnectivityStatistics. */
+    typedef QSharedPointer<const ConnectivityStatistics> ConstSPtr; /**< Const shared pointer type for ConnectivityStatistics. */
+
+    enum SurrogateType {
+        PhaseRandomization,
+        TrialShuffling
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a ConnectivityStatistics object.
+    */
+    explicit ConnectivityStatistics();
+
+    //=========================================================================================================
+    /**
+    * Returns the methods which can be tested.
+    *
+    * @return The supported methods.
+    */
+    static QStringList supportedMethods();
+
+    //=========================================================================================================
+    /**
+    * Tests the connectivity of the data in the settings. The tapered spectra are computed once with the FFT
+    * length, window and frequency bands of the settings.
+    *
+    * @param[in] connectivitySettings   The connectivity settings holding the data.
+    * @param[in] sMethod                The connectivity method.
+    * @param[in] iNSurrogates           The number of surrogates.
+    * @param[in] type                   The way the surrogates are generated.
+    * @param[in] uiSeed                 The seed of the random number generation.
+    *
+    * @return The observed connectivity and its p-values.
+    */
+    static SurrogateResult surrogateTest(const ConnectivitySettings& connectivitySettings,
+                                         const QString& sMethod,
+                                         int iNSurrogates,
+                                         SurrogateType type = PhaseRandomization,
+                                         unsigned int uiSeed = 0);
+
+    //=========================================================================================================
+    /**
+    * Tests the connectivity of precomputed tapered spectra.
+    *
+    * @param[in] spectra            The tapered spectra of all trials, see AbstractMetric::computeTaperedSpectra.
+    * @param[in] sMethod            The connectivity method.
+    * @param[in] iNSurrogates       The number of surrogates.
+    * @param[in] type               The way the surrogates are generated.
+    * @param[in] uiSeed             The seed of the random number generation.
+    *
+    * @return The observed connectivity and its p-values.
+    */
+    static SurrogateResult surrogateTest(const TaperedSpectra& spectra,
+                                         const QString& sMethod,
+                                         int iNSurrogates,
+                                         SurrogateType type = PhaseRandomization,
+                                         unsigned int uiSeed = 0);
+
+    //=========================================================================================================
+    /**
+    * Generates the tapered spectra of one surrogate.
+    *
+    * @param[in] spectra            The tapered spectra of all trials.
+    * @param[in] type               The way the surrogate is generated.
+    * @param[in] uiSeed             The seed of the surrogate.
+    *
+    * @return The surrogate spectra.
+    */
+    static TaperedSpectra surrogateSpectra(const TaperedSpectra& spectra,
+                                           SurrogateType type,
+                                           unsigned int uiSeed);
+
+    //=========================================================================================================
+    /**
+    * Computes a connectivity metric from tapered spectra.
+    *
+    * @param[in] spectra            The tapered spectra of all trials.
+    * @param[in] sMethod            The connectivity method.
+    *
+    * @return The connectivity, one rows x frequencies matrix per seed row. Empty for unsupported methods.
+    */
+    static QVector<Eigen::MatrixXd> computeMetric(const TaperedSpectra& spectra,
+                                                  const QString& sMethod);
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+
+} // namespace CONNECTIVITYLIB
+
+#endif // CONNECTIVITYSTATISTICS_H
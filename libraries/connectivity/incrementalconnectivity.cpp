@@ -0,0 +1,316 @@
+//=============================================================================================================
+/**
+* @file     incrementalconnectivity.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     IncrementalConnectivity class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "incrementalconnectivity.h"
+
+#include "network/network.h"
+#include "network/networkedge.h"
+#include "network/networknode.h"
+#include "metrics/abstractmetric.h"
+
+#include <utils/spectral.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace CONNECTIVITYLIB;
+using namespace Eigen;
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+IncrementalConnectivity::IncrementalConnectivity(const QString& sMethod,
+                                                 int iNfft,
+                                                 const QString& sWindowType,
+                                                 int iWindowSize)
+: m_sMethod(sMethod)
+, m_iNfft(iNfft)
+, m_sWindowType(sWindowType)
+, m_iWindowSize(iWindowSize)
+, m_iNRows(0)
+, m_iNFreqs(0)
+{
+    if(!supportedMethods().contains(m_sMethod)) {
+        qDebug() << "IncrementalConnectivity::IncrementalConnectivity - Method" << m_sMethod << "can not be estimated incrementally";
+    }
+}
+
+
+//*************************************************************************************************************
+
+QStringList IncrementalConnectivity::supportedMethods()
+{
+    QStringList lMethods;
+    lMethods << "COH" << "IMAGCOH" << "PLV" << "PLI" << "USPLI" << "WPLI" << "DSWPLI";
+    return lMethods;
+}
+
+
+//*************************************************************************************************************
+
+void IncrementalConnectivity::setNodePositions(const MatrixX3f& matNodePositions)
+{
+    m_matNodePositions = matNodePositions;
+}
+
+
+//*************************************************************************************************************
+
+void IncrementalConnectivity::addTrial(const MatrixXd& matTrial)
+{
+    if(!m_lTrials.isEmpty() && (matTrial.rows() != m_lTrials.first().rows() || matTrial.cols() != m_lTrials.first().cols())) {
+        qDebug() << "IncrementalConnectivity::addTrial - Trial dimensions changed, resetting the estimate";
+        clear();
+    }
+
+    if(m_iWindowSize > 0) {
+        while(m_lTrials.size() >= m_iWindowSize) {
+            removeOldestTrial();
+        }
+    }
+
+    QList<MatrixXd> lTrial;
+    lTrial.append(matTrial);
+    TaperedSpectra spectra = AbstractMetric::computeTaperedSpectra(lTrial, m_iNfft, m_sWindowType);
+
+    if(m_lTrials.isEmpty()) {
+        m_iNRows = spectra.iNRows;
+        m_iNFreqs = spectra.iNFreqs;
+
+        for(int j = 0; j < m_iNRows; ++j) {
+            m_vecCsdSum.append(MatrixXcd::Zero(m_iNRows, m_iNFreqs));
+            m_vecImagSum.append(MatrixXd::Zero(m_iNRows, m_iNFreqs));
+            m_vecImagAbsSum.append(MatrixXd::Zero(m_iNRows, m_iNFreqs));
+            m_vecImagSquaredSum.append(MatrixXd::Zero(m_iNRows, m_iNFreqs));
+        }
+    }
+
+    accumulate(spectra, 1.0);
+    m_lTrials.append(matTrial);
+}
+
+
+//*************************************************************************************************************
+
+void IncrementalConnectivity::removeOldestTrial()
+{
+    if(m_lTrials.isEmpty()) {
+        return;
+    }
+
+    // Start from exact zeros once the window runs empty, so no rounding is carried over
+    if(m_lTrials.size() == 1) {
+        clear();
+        return;
+    }
+
+    QList<MatrixXd> lTrial;
+    lTrial.append(m_lTrials.takeFirst());
+    accumulate(AbstractMetric::computeTaperedSpectra(lTrial, m_iNfft, m_sWindowType), -1.0);
+}
+
+
+//*************************************************************************************************************
+
+void IncrementalConnectivity::clear()
+{
+    m_lTrials.clear();
+    m_iNRows = 0;
+    m_iNFreqs = 0;
+    m_vecCsdSum.clear();
+    m_vecImagSum.clear();
+    m_vecImagAbsSum.clear();
+    m_vecImagSquaredSum.clear();
+}
+
+
+//*************************************************************************************************************
+
+int IncrementalConnectivity::getNumberTrials() const
+{
+    return m_lTrials.size();
+}
+
+
+//*************************************************************************************************************
+
+Network IncrementalConnectivity::getNetwork() const
+{
+    QString sName = "Unknown";
+    if(m_sMethod == "COH") {
+        sName = "Coherence";
+    } else if(m_sMethod == "IMAGCOH") {
+        sName = "ImagCoherence";
+    } else if(m_sMethod == "PLV") {
+        sName = "New Phase Locking Value";
+    } else if(m_sMethod == "PLI") {
+        sName = "Phase Lag Index";
+    } else if(m_sMethod == "USPLI") {
+        sName = "Unbiased Squared Phase Lag Index";
+    } else if(m_sMethod == "WPLI") {
+        sName = "Weighted Phase Lag Index";
+    } else if(m_sMethod == "DSWPLI") {
+        sName = "Debiased Squared Weighted Phase Lag Index";
+    }
+
+    Network finalNetwork(sName);
+
+    if(m_lTrials.isEmpty()) {
+        qDebug() << "IncrementalConnectivity::getNetwork - No trials in the window";
+        return finalNetwork;
+    }
+
+    //Create nodes
+    RowVectorXf rowVert = RowVectorXf::Zero(3);
+
+    for(int i = 0; i < m_iNRows; ++i) {
+        if(m_matNodePositions.rows() != 0 && i < m_matNodePositions.rows()) {
+            rowVert(0) = m_matNodePositions.row(i)(0);
+            rowVert(1) = m_matNodePositions.row(i)(1);
+            rowVert(2) = m_matNodePositions.row(i)(2);
+        }
+
+        finalNetwork.append(NetworkNode::SPtr(new NetworkNode(i, rowVert)));
+    }
+
+    //Compute the metric from the running sums
+    double dNTrials = m_lTrials.size();
+    QVector<MatrixXd> vecConnectivity;
+
+    for(int j = 0; j < m_iNRows; ++j) {
+        if(m_sMethod == "COH" || m_sMethod == "IMAGCOH") {
+            MatrixXcd matCoh(m_iNRows, m_iNFreqs);
+            for(int k = 0; k < m_iNRows; ++k) {
+                ArrayXd vecPsd = m_vecCsdSum.at(j).row(j).real().array() * m_vecCsdSum.at(k).row(k).real().array();
+                matCoh.row(k) = m_vecCsdSum.at(j).row(k).array() / vecPsd.sqrt().cast<std::complex<double> >().transpose();
+            }
+            vecConnectivity.append(m_sMethod == "COH" ? MatrixXd(matCoh.cwiseAbs()) : MatrixXd(matCoh.imag()));
+        } else if(m_sMethod == "PLV") {
+            vecConnectivity.append(m_vecCsdSum.at(j).cwiseAbs() / dNTrials);
+        } else if(m_sMethod == "PLI") {
+            vecConnectivity.append(m_vecImagSum.at(j).cwiseAbs() / dNTrials);
+        } else if(m_sMethod == "USPLI") {
+            MatrixXd matPLI = m_vecImagSum.at(j).cwiseAbs() / dNTrials;
+            vecConnectivity.append((dNTrials * matPLI.array().square() - 1.0) / (dNTrials - 1.0));
+        } else if(m_sMethod == "WPLI") {
+            MatrixXd matDenom = m_vecImagAbsSum.at(j);
+            matDenom = (matDenom.array() == 0.).select(INFINITY, matDenom);
+            vecConnectivity.append(m_vecImagSum.at(j).cwiseAbs().cwiseQuotient(matDenom));
+        } else if(m_sMethod == "DSWPLI") {
+            MatrixXd matNom = m_vecImagSum.at(j).array().square();
+            matNom -= m_vecImagSquaredSum.at(j);
+            MatrixXd matDenom = m_vecImagAbsSum.at(j).array().square();
+            matDenom -= m_vecImagSquaredSum.at(j);
+            matDenom = (matDenom.array() == 0.).select(INFINITY, matDenom);
+            vecConnectivity.append(matNom.cwiseQuotient(matDenom));
+        } else {
+            return finalNetwork;
+        }
+    }
+
+    //Add edges to network
+    for(int i = 0; i < vecConnectivity.length(); ++i) {
+        for(int j = 0; j < m_iNRows; ++j) {
+            MatrixXd matWeight = vecConnectivity.at(i).row(j).transpose();
+
+            QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork.getNodes()[i], finalNetwork.getNodes()[j], matWeight));
+
+            finalNetwork.getNodeAt(i)->append(pEdge);
+            finalNetwork.append(pEdge);
+        }
+    }
+
+    return finalNetwork;
+}
+
+
+//*************************************************************************************************************
+
+void IncrementalConnectivity::accumulate(const TaperedSpectra& spectra, double dSign)
+{
+    const QVector<MatrixXcd>& vecTapSpectra = spectra.vecTapSpectra.at(0);
+
+    for(int j = 0; j < m_iNRows; ++j) {
+        MatrixXcd matCsd = MatrixXcd(m_iNRows, m_iNFreqs);
+        for(int k = 0; k < m_iNRows; ++k) {
+            matCsd.row(k) = Spectral::csdFromTaperedSpectra(vecTapSpectra.at(j), vecTapSpectra.at(k),
+                                                            spectra.vecTapWeights, spectra.vecTapWeights,
+                                                            spectra.iNfft, 1.0);
+        }
+
+        // Only the terms of the chosen method are accumulated
+        if(m_sMethod == "COH" || m_sMethod == "IMAGCOH") {
+            m_vecCsdSum[j] += dSign * matCsd;
+        } else if(m_sMethod == "PLV") {
+            m_vecCsdSum[j] += dSign * matCsd.cwiseQuotient(matCsd.cwiseAbs());
+        } else if(m_sMethod == "PLI" || m_sMethod == "USPLI") {
+            m_vecImagSum[j] += dSign * matCsd.imag().cwiseSign();
+        } else if(m_sMethod == "WPLI" || m_sMethod == "DSWPLI") {
+            MatrixXd matCsdImag = matCsd.imag();
+            m_vecImagSum[j] += dSign * matCsdImag;
+            m_vecImagAbsSum[j] += dSign * matCsdImag.cwiseAbs();
+            if(m_sMethod == "DSWPLI") {
+                m_vecImagSquaredSum[j] += dSign * matCsdImag.array().square().matrix();
+            }
+        }
+    }
+}
@@ -0,0 +1,210 @@
+//=============================================================================================================
+/**
+* @file     incrementalconnectivity.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     IncrementalConnectivity class declaration.
+*
+*/
+
+#ifndef INCREMENTALCONNECTIVITY_H
+#define INCREMENTALCONNECTIVITY_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "connectivity_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE CONNECTIVITYLIB
+//=============================================================================================================
+
+namespace CONNECTIVITYLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// CONNECTIVITYLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+class Network;
+struct TaperedSpectra;
+
+
+//=============================================================================================================
+/**
+* Estimates a spectral connectivity network over a sliding window of trials. Instead of recomputing all trials
+* on every update, the per trial CSD terms are kept in running sums. Adding or evicting a trial therefore costs
+* the computation of one trial only, independent of the window size.
+*
+* Supported methods are "COH", "IMAGCOH", "PLV", "PLI", "USPLI", "WPLI" and "DSWPLI".
+*
+* @brief Incremental spectral connectivity estimation for real-time use.
+*/
+class CONNECTIVITYSHARED_EXPORT IncrementalConnectivity
+{
+
+public:
+    typedef QSharedPointer<IncrementalConnectivity> SPtr;            /**< Shared pointer type for IncrementalConnectivity. */
+    typedef QSharedPointer<const IncrementalConnectivity> ConstSPtr; /**< Const shared pointer type for IncrementalConnectivity. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an IncrementalConnectivity object.
+    *
+    * @param[in] sMethod        The connectivity method.
+    * @param[in] iNfft          The FFT length. Values below the trial length are raised to the trial length.
+    * @param[in] sWindowType    The type of the window function used to compute tapered spectra.
+    * @param[in] iWindowSize    The maximum number of trials in the window. Values below 1 keep all trials.
+    */
+    explicit IncrementalConnectivity(const QString& sMethod,
+                                     int iNfft = -1,
+                                     const QString& sWindowType = "hanning",
+                                     int iWindowSize = -1);
+
+    //=========================================================================================================
+    /**
+    * Returns the methods which can be estimated incrementally.
+    *
+    * @return The supported methods.
+    */
+    static QStringList supportedMethods();
+
+    //=========================================================================================================
+    /**
+    * Sets the node positions used for the networks.
+    *
+    * @param[in] matNodePositions   The node positions.
+    */
+    void setNodePositions(const Eigen::MatrixX3f& matNodePositions);
+
+    //=========================================================================================================
+    /**
+    * Adds a trial to the window. If the window is full, the oldest trial is evicted first. A trial with a
+    * different number of rows or samples than the trials in the window resets the estimate.
+    *
+    * @param[in] matTrial       The trial data, rows x samples.
+    */
+    void addTrial(const Eigen::MatrixXd& matTrial);
+
+    //=========================================================================================================
+    /**
+    * Evicts the oldest trial from the window.
+    */
+    void removeOldestTrial();
+
+    //=========================================================================================================
+    /**
+    * Removes all trials and resets the running sums.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of trials in the window.
+    *
+    * @return The number of trials.
+    */
+    int getNumberTrials() const;
+
+    //=========================================================================================================
+    /**
+    * Computes the network from the running sums of the trials in the window.
+    *
+    * @return Returns the network. The network is empty if the window holds no trials.
+    */
+    Network getNetwork() const;
+
+protected:
+    //=========================================================================================================
+    /**
+    * Adds the CSD terms of a trial to the running sums, or subtracts them.
+    *
+    * @param[in] spectra        The tapered spectra of the trial.
+    * @param[in] dSign          1.0 to add the trial, -1.0 to subtract it.
+    */
+    void accumulate(const TaperedSpectra& spectra, double dSign);
+
+    QString                             m_sMethod;              /**< The connectivity method. */
+    int                                 m_iNfft;                /**< The requested FFT length. */
+    QString                             m_sWindowType;          /**< The window type used to compute tapered spectra. */
+    int                                 m_iWindowSize;          /**< The maximum number of trials in the window. */
+    Eigen::MatrixX3f                    m_matNodePositions;     /**< The node positions. */
+
+    QList<Eigen::MatrixXd>              m_lTrials;              /**< The trials in the window, needed to evict them. */
+    int                                 m_iNRows;               /**< The number of rows (nodes). */
+    int                                 m_iNFreqs;              /**< The number of frequency bins. */
+
+    QVector<Eigen::MatrixXcd>           m_vecCsdSum;            /**< Running sum of the complex CSD terms (CSD or normalized CSD) per seed. */
+    QVector<Eigen::MatrixXd>            m_vecImagSum;           /**< Running sum of the imaginary CSD or of its sign per seed. */
+    QVector<Eigen::MatrixXd>            m_vecImagAbsSum;        /**< Running sum of the absolute imaginary CSD per seed. */
+    QVector<Eigen::MatrixXd>            m_vecImagSquaredSum;    /**< Running sum of the squared imaginary CSD per seed. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+
+} // namespace CONNECTIVITYLIB
+
+#endif // INCREMENTALCONNECTIVITY_H
@@ -41,12 +41,18 @@
 
 #include "abstractmetric.h"
 
+#include <utils/spectral.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QDebug>
+#include <QtConcurrent>
+#include <QThreadPool>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -60,6 +66,8 @@
 //=============================================================================================================
 
 using namespace CONNECTIVITYLIB;
+using namespace Eigen;
+using namespace UTILSLIB;
 
 
 //*************************************************************************************************************
@@ -67,6 +75,43 @@ using namespace CONNECTIVITYLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+struct TrialSpectraJob {
+    const MatrixXd*         pData;          /**< The trial data. */
+    const MatrixXd*         pTapers;        /**< The tapers. */
+    int                     iNfft;          /**< The FFT length. */
+    const VectorXi*         pFreqBins;      /**< The FFT bins to keep. */
+    bool                    bUseThreads;    /**< Whether to distribute the rows over threads, used for a single trial. */
+    QVector<MatrixXcd>      vecTapSpectra;  /**< The resulting tapered spectra per row. */
+};
+
+void computeTrialSpectra(TrialSpectraJob& job)
+{
+    //Remove mean
+    MatrixXd matInputData = *job.pData;
+    for (int i = 0; i < matInputData.rows(); ++i) {
+        matInputData.row(i).array() -= matInputData.row(i).mean();
+    }
+
+    const VectorXi& vecFreqBins = *job.pFreqBins;
+    job.vecTapSpectra = Spectral::computeTaperedSpectraMatrix(matInputData, *job.pTapers, job.iNfft, job.bUseThreads);
+
+    // Keep only the requested bins
+    for (int j = 0; j < job.vecTapSpectra.size(); ++j) {
+        const MatrixXcd& matTapSpectra = job.vecTapSpectra.at(j);
+        if (vecFreqBins.size() != matTapSpectra.cols()) {
+            MatrixXcd matSelected(matTapSpectra.rows(), vecFreqBins.size());
+            for (int f = 0; f < vecFreqBins.size(); ++f) {
+                matSelected.col(f) = matTapSpectra.col(vecFreqBins(f));
+            }
+            job.vecTapSpectra[j] = matSelected;
+        }
+    }
+}
+
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -77,3 +122,94 @@ AbstractMetric::AbstractMetric()
 {
 }
 
+
+//*************************************************************************************************************
+
+TaperedSpectra AbstractMetric::computeTaperedSpectra(const QList<MatrixXd> &matDataList,
+                                                     int iNfft,
+                                                     const QString &sWindowType,
+                                                     const QList<QPair<float,float> > &lFrequencyBands,
+                                                     float fSFreq)
+{
+    TaperedSpectra spectra;
+
+    if(matDataList.empty()) {
+        return spectra;
+    }
+
+    // Check that iNfft >= signal length
+    int iSignalLength = matDataList.at(0).cols();
+    if (iNfft < iSignalLength) {
+        iNfft = iSignalLength;
+    }
+
+    // Generate tapers
+    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, sWindowType);
+
+    spectra.vecTapWeights = tapers.second;
+    spectra.iNfft = iNfft;
+    spectra.iNRows = matDataList.at(0).rows();
+    int iNAllFreqs = int(floor(iNfft / 2.0)) + 1;
+
+    // Select the bins within the requested bands
+    QList<QPair<float,float> > lBands = lFrequencyBands;
+    if (!lBands.isEmpty() && fSFreq <= 0.0f) {
+        qWarning() << "AbstractMetric::computeTaperedSpectra - The sampling frequency is unknown. Using the full frequency axis.";
+        lBands.clear();
+    }
+    QVector<int> vecBins;
+    for (int f = 0; f < iNAllFreqs; ++f) {
+        float fFreq = f * fSFreq / iNfft;
+        bool bKeep = lBands.isEmpty();
+        for (int b = 0; b < lBands.size() && !bKeep; ++b) {
+            bKeep = fFreq >= lBands.at(b).first && fFreq <= lBands.at(b).second;
+        }
+        if (bKeep) {
+            vecBins.append(f);
+        }
+    }
+    spectra.vecFreqBins.resize(vecBins.size());
+    for (int f = 0; f < vecBins.size(); ++f) {
+        spectra.vecFreqBins(f) = vecBins.at(f);
+    }
+    spectra.iNFreqs = vecBins.size();
+
+    // Generate the tapered spectra of all trials in parallel
+    QList<TrialSpectraJob> lJobs;
+    for (int i = 0; i < matDataList.length(); ++i) {
+        TrialSpectraJob job;
+        job.pData = &matDataList.at(i);
+        job.pTapers = &tapers.first;
+        job.iNfft = iNfft;
+        job.pFreqBins = &spectra.vecFreqBins;
+        job.bUseThreads = matDataList.length() == 1;
+        lJobs.append(job);
+    }
+
+    QtConcurrent::blockingMap(lJobs, computeTrialSpectra);
+
+    for (int i = 0; i < lJobs.length(); ++i) {
+        spectra.vecTapSpectra.append(lJobs.at(i).vecTapSpectra);
+    }
+
+    return spectra;
+}
+
+
+//*************************************************************************************************************
+
+QList<QPair<int,int> > AbstractMetric::trialBlocks(int iNTrials)
+{
+    QList<QPair<int,int> > lBlocks;
+    int iNBlocks = qMax(1, qMin(iNTrials, QThreadPool::globalInstance()->maxThreadCount()));
+
+    for (int b = 0; b < iNBlocks; ++b) {
+        int iFirst = (b * iNTrials) / iNBlocks;
+        int iLast = ((b + 1) * iNTrials) / iNBlocks;
+        if (iLast > iFirst) {
+            lBlocks.append(QPair<int,int>(iFirst, iLast));
+        }
+    }
+
+    return lBlocks;
+}
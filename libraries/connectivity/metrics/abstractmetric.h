@@ -51,6 +51,11 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <QPair>
+#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -81,6 +86,37 @@ namespace CONNECTIVITYLIB {
 //=============================================================================================================
 
 
+//=============================================================================================================
+/**
+* Tapered spectra of all trials. They are computed once per data set and shared by all spectral metrics.
+* The spectra can be restricted to a subset of the FFT bins. The half spectrum scaling of the CSD then refers to the
+* stored columns, which is fine for the implemented metrics since they are invariant to a per bin scaling.
+*/
+struct TaperedSpectra {
+    QList<QVector<Eigen::MatrixXcd> >   vecTapSpectra;      /**< The tapered spectra (tapers x frequencies) per trial and row. */
+    Eigen::VectorXd                     vecTapWeights;      /**< The taper weights. */
+    int                                 iNfft;              /**< The FFT length. */
+    int                                 iNRows;             /**< The number of rows (nodes). */
+    int                                 iNFreqs;            /**< The number of stored frequency bins. */
+    Eigen::VectorXi                     vecFreqBins;        /**< The FFT bin of each stored frequency column. */
+
+    TaperedSpectra() : iNfft(0), iNRows(0), iNFreqs(0) {}
+};
+
+
+//=============================================================================================================
+/**
+* A contiguous block of trials which one thread accumulates into its own sums, see AbstractMetric::trialBlocks.
+*/
+template<typename T>
+struct TrialBlock {
+    const TaperedSpectra*       pSpectra;           /**< The tapered spectra of all trials. */
+    int                         iFirstTrial;        /**< The first trial of this block. */
+    int                         iLastTrial;         /**< One past the last trial of this block. */
+    QVector<QVector<T> >        vecSums;            /**< The sums of this block, one matrix (rows x frequencies) per sum and seed. */
+};
+
+
 //=============================================================================================================
 /**
 * This class provides basic functionalities for all implemented metrics.
@@ -100,7 +136,76 @@ public:
     */
     explicit AbstractMetric();
 
+    //=========================================================================================================
+    /**
+    * Removes the mean of each row and computes the tapered spectra of all trials in parallel.
+    *
+    * @param[in] matDataList        The input data.
+    * @param[in] iNfft              The FFT length. Values below the signal length are raised to the signal length.
+    * @param[in] sWindowType        The type of the window function used to compute tapered spectra.
+    * @param[in] lFrequencyBands    Only keep the FFT bins within these [fmin,fmax] bands in Hz. Empty keeps all bins.
+    * @param[in] fSFreq             The sampling frequency in Hz, used to map the bands to FFT bins.
+    *
+    * @return                       The tapered spectra of all trials.
+    */
+    static TaperedSpectra computeTaperedSpectra(const QList<Eigen::MatrixXd> &matDataList,
+                                                int iNfft,
+                                                const QString &sWindowType,
+                                                const QList<QPair<float,float> > &lFrequencyBands = QList<QPair<float,float> >(),
+                                                float fSFreq = 1.0f);
+
 protected:
+    //=========================================================================================================
+    /**
+    * Accumulates sums over all trials in parallel. The trials are split into blocks, each block is accumulated
+    * on its own thread and the block sums are added in block order afterwards.
+    *
+    * @param[in] spectra        The tapered spectra of all trials.
+    * @param[in] iNSums         The number of sums to accumulate.
+    * @param[in] accumulate     Adds the contribution of the trials of one block to the sums of that block.
+    *
+    * @return                   The sums over all trials, one matrix (rows x frequencies) per sum and seed.
+    */
+    template<typename T>
+    static QVector<QVector<T> > accumulateTrialBlocks(const TaperedSpectra& spectra, int iNSums, void (*accumulate)(TrialBlock<T>&));
+
+    //=========================================================================================================
+    /**
+    * Splits the trials into contiguous blocks, one per thread of the global thread pool. Each block is
+    * accumulated into its own sums, which are reduced in block order afterwards.
+    *
+    * @param[in] iNTrials       The number of trials.
+    *
+    * @return                   The first and one past the last trial of each block.
+    */
+    static QList<QPair<int,int> > trialBlocks(int iNTrials);
+
+private:
+    //=========================================================================================================
+    /**
+    * Creates the trial blocks of trialBlocks() with zero initialized sums.
+    *
+    * @param[in] spectra        The tapered spectra of all trials.
+    * @param[in] iNSums         The number of sums each block accumulates.
+    *
+    * @return                   The trial blocks.
+    */
+    template<typename T>
+    static QList<TrialBlock<T> > makeTrialBlocks(const TaperedSpectra& spectra, int iNSums);
+
+    //=========================================================================================================
+    /**
+    * Adds the sums of the trial blocks in block order, so that the result is deterministic for a given thread
+    * count.
+    *
+    * @param[in] lBlocks        The accumulated trial blocks.
+    * @param[in] spectra        The tapered spectra of all trials.
+    * @param[in] iNSums         The number of sums each block accumulates.
+    *
+    * @return                   The sums over all trials, one matrix per sum and seed.
+    */
+    template<typename T>
+    static QVector<QVector<T> > reduceTrialBlocks(const QList<TrialBlock<T> >& lBlocks, const TaperedSpectra& spectra, int iNSums);
 
 };
 
@@ -110,6 +215,63 @@ protected:
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+template<typename T>
+QVector<QVector<T> > AbstractMetric::accumulateTrialBlocks(const TaperedSpectra& spectra, int iNSums, void (*accumulate)(TrialBlock<T>&))
+{
+    QList<TrialBlock<T> > lBlocks = makeTrialBlocks<T>(spectra, iNSums);
+    QtConcurrent::blockingMap(lBlocks, accumulate);
+
+    return reduceTrialBlocks(lBlocks, spectra, iNSums);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+QList<TrialBlock<T> > AbstractMetric::makeTrialBlocks(const TaperedSpectra& spectra, int iNSums)
+{
+    QList<QPair<int,int> > lTrialBlocks = trialBlocks(spectra.vecTapSpectra.length());
+    QList<TrialBlock<T> > lBlocks;
+
+    for (int b = 0; b < lTrialBlocks.size(); ++b) {
+        TrialBlock<T> block;
+        block.pSpectra = &spectra;
+        block.iFirstTrial = lTrialBlocks.at(b).first;
+        block.iLastTrial = lTrialBlocks.at(b).second;
+
+        // Every block owns its sums, so that the threads never detach shared data
+        for (int s = 0; s < iNSums; ++s) {
+            QVector<T> vecSum;
+            for (int j = 0; j < spectra.iNRows; ++j) {
+                vecSum.append(T::Zero(spectra.iNRows, spectra.iNFreqs));
+            }
+            block.vecSums.append(vecSum);
+        }
+        lBlocks.append(block);
+    }
+
+    return lBlocks;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+QVector<QVector<T> > AbstractMetric::reduceTrialBlocks(const QList<TrialBlock<T> >& lBlocks, const TaperedSpectra& spectra, int iNSums)
+{
+    QVector<QVector<T> > vecSums(iNSums, QVector<T>(spectra.iNRows, T::Zero(spectra.iNRows, spectra.iNFreqs)));
+
+    for (int b = 0; b < lBlocks.size(); ++b) {
+        for (int s = 0; s < iNSums; ++s) {
+            for (int j = 0; j < spectra.iNRows; ++j) {
+                vecSums[s][j] += lBlocks.at(b).vecSums.at(s).at(j);
+            }
+        }
+    }
+
+    return vecSums;
+}
+
 
 } // namespace CONNECTIVITYLIB
 
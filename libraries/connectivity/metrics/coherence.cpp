@@ -94,16 +94,24 @@ Coherence::Coherence()
 
 Network Coherence::coherence(const QList<MatrixXd> &matDataList, const MatrixX3f& matVert, int iNfft,
                              const QString &sWindowType)
+{
+    return Coherence::coherence(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType), matVert);
+}
+
+
+//*************************************************************************************************************
+
+Network Coherence::coherence(const TaperedSpectra& spectra, const MatrixX3f& matVert)
 {
     Network finalNetwork("Coherence");
 
-    if(matDataList.empty()) {
+    if(spectra.vecTapSpectra.isEmpty()) {
         qDebug() << "Coherence::coherence - Input data is empty";
         return finalNetwork;
     }
 
     //Create nodes
-    int rows = matDataList.first().rows();
+    int rows = spectra.iNRows;
     RowVectorXf rowVert = RowVectorXf::Zero(3);
 
     for(int i = 0; i < rows; ++i) {
@@ -117,11 +125,11 @@ Network Coherence::coherence(const QList<MatrixXd> &matDataList, const MatrixX3f
     }
 
     //Calculate all-to-all coherence matrix over epochs
-    QVector<MatrixXd> vecCoh = Coherence::computeCoherence(matDataList, iNfft, sWindowType);
+    QVector<MatrixXd> vecCoh = Coherence::computeCoherence(spectra);
 
     //Add edges to network
     for(int i = 0; i < vecCoh.length(); ++i) {
-        for(int j = 0; j < matDataList.at(0).rows(); ++j) {
+        for(int j = 0; j < spectra.iNRows; ++j) {
             MatrixXd matWeight = vecCoh.at(i).row(j).transpose();
 
             QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork.getNodes()[i], finalNetwork.getNodes()[j], matWeight));
@@ -140,7 +148,15 @@ Network Coherence::coherence(const QList<MatrixXd> &matDataList, const MatrixX3f
 QVector<MatrixXd> Coherence::computeCoherence(const QList<MatrixXd> &matDataList,
                                               int iNfft, const QString &sWindowType)
 {
-    QVector<MatrixXcd> vecCoherency = Coherency::computeCoherency(matDataList, iNfft, sWindowType);
+    return Coherence::computeCoherence(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType));
+}
+
+
+//*************************************************************************************************************
+
+QVector<MatrixXd> Coherence::computeCoherence(const TaperedSpectra& spectra)
+{
+    QVector<MatrixXcd> vecCoherency = Coherency::computeCoherency(spectra);
     QVector<MatrixXd> vecCoherence;
     for(int i = 0; i < vecCoherency.length(); ++i) {
         vecCoherence.append(vecCoherency.at(i).cwiseAbs());
@@ -30,7 +30,6 @@
 *
 * @note Notes:
 * - Some of this code was adapted from mne-python (https://martinos.org/mne) with permission from Alexandre Gramfort.
-* - QtConcurrent can be used to speed up computation.
 *
 * @brief     Coherency class declaration.
 *
@@ -65,6 +64,7 @@
 //=============================================================================================================
 
 #include <unsupported/Eigen/FFT>
+#include <Eigen/Dense>
 
 
 //*************************************************************************************************************
@@ -82,6 +82,48 @@ using namespace UTILSLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+struct FrequencyCoherencyJob {
+    const TaperedSpectra*   pSpectra;       /**< The tapered spectra of all trials. */
+    MatrixXcd*              pCoherency;     /**< The coherency per seed, targets x frequencies, detached before the jobs run. Column iFreq is written. */
+    int                     iFreq;          /**< The frequency bin. */
+};
+
+void computeFrequencyCoherency(FrequencyCoherencyJob& job)
+{
+    const TaperedSpectra& spectra = *job.pSpectra;
+    int iNRows = spectra.iNRows;
+    int iNTapers = spectra.vecTapWeights.rows();
+    int iNTrials = spectra.vecTapSpectra.length();
+
+    // Weighted spectra of this bin, one column per row and one row per taper and trial
+    MatrixXcd matY(iNTapers * iNTrials, iNRows);
+    for (int i = 0; i < iNTrials; ++i) {
+        for (int j = 0; j < iNRows; ++j) {
+            matY.block(i * iNTapers, j, iNTapers, 1) = spectra.vecTapWeights.asDiagonal() * spectra.vecTapSpectra.at(i).at(j).col(job.iFreq);
+        }
+    }
+
+    // CSD summed over tapers and trials, CSD(j,k) = sum Y(:,j) * conj(Y(:,k)), upper triangle only
+    MatrixXcd matCsd = MatrixXcd::Zero(iNRows, iNRows);
+    matCsd.selfadjointView<Upper>().rankUpdate(matY.transpose());
+
+    // The normalization of csdFromTaperedSpectra cancels in the coherency, the PSD is the diagonal
+    VectorXd vecPsdSqrt = matCsd.diagonal().real().cwiseSqrt();
+
+    for (int j = 0; j < iNRows; ++j) {
+        MatrixXcd& matCoh = job.pCoherency[j];
+        for (int k = j; k < iNRows; ++k) {
+            std::complex<double> coh = matCsd(j,k) / (vecPsdSqrt(j) * vecPsdSqrt(k));
+            matCoh(k, job.iFreq) = coh;
+            job.pCoherency[k](j, job.iFreq) = std::conj(coh);
+        }
+    }
+}
+
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -98,66 +140,39 @@ Coherency::Coherency()
 QVector<MatrixXcd> Coherency::computeCoherency(const QList<MatrixXd> &matDataList,
                                                int iNfft, const QString &sWindowType)
 {
-    // Check that iNfft >= signal length
-    int iSignalLength = matDataList.at(0).cols();
-    if (iNfft < iSignalLength) {
-        iNfft = iSignalLength;
-    }
+    return Coherency::computeCoherency(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType));
+}
 
-    // Generate tapers
-    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, sWindowType);
 
-    // Initialize vecPsdAvg and vecCsdAvg
-    int iNRows = matDataList.at(0).rows();
-    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
-    MatrixXd matPsdAvg = MatrixXd::Zero(iNRows, iNFreqs);
-    QVector<MatrixXcd> vecCsdAvg;
-    for (int j = 0; j < iNRows; ++j) {
-        vecCsdAvg.append(MatrixXcd::Zero(iNRows, iNFreqs));
-    }
-
-    // Generate tapered spectra, PSD, and CSD and sum over epoch
-    // This part could be parallelized with QtConcurrent::mappedReduced
-    for (int i = 0; i < matDataList.length(); ++i) {
-        //Remove mean
-        MatrixXd matInputData = matDataList.at(i);
-        for (int i = 0; i < matInputData.rows(); ++i) {
-            matInputData.row(i).array() -= matInputData.row(i).mean();
-        }
+//*************************************************************************************************************
 
-        // This part could be parallelized with QtConcurrent::mapped
-        QVector<MatrixXcd> vecTapSpectra;
-        for (int j = 0; j < iNRows; ++j) {
-            MatrixXcd matTmpSpectra = Spectral::computeTaperedSpectra(matInputData.row(j), tapers.first, iNfft);
-            vecTapSpectra.append(matTmpSpectra);
-        }
+QVector<MatrixXcd> Coherency::computeCoherency(const TaperedSpectra& spectra)
+{
+    int iNRows = spectra.iNRows;
+    int iNFreqs = spectra.iNFreqs;
 
-        // This part could be parallelized with QtConcurrent::mappedReduced
-        for (int j = 0; j < iNRows; ++j) {
-            RowVectorXd vecTmpPsd = Spectral::psdFromTaperedSpectra(vecTapSpectra.at(j), tapers.second,
-                                                                    iNfft, 1.0);
-            matPsdAvg.row(j) += vecTmpPsd;
-        }
+    QVector<MatrixXcd> vecCoherency;
+    for (int j = 0; j < iNRows; ++j) {
+        vecCoherency.append(MatrixXcd::Zero(iNRows, iNFreqs));
+    }
 
-        // This part could be parallelized with QtConcurrent::mappedReduced
-        for (int j = 0; j < iNRows; ++j) {
-            MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
-            for (int k = 0; k < iNRows; ++k) {
-                matCsd.row(k) = Spectral::csdFromTaperedSpectra(vecTapSpectra.at(j), vecTapSpectra.at(k),
-                                                                tapers.second, tapers.second, iNfft, 1.0);
-            }
-            vecCsdAvg.replace(j, vecCsdAvg.at(j) + matCsd);
-        }
+    if(spectra.vecTapSpectra.isEmpty()) {
+        return vecCoherency;
     }
-    matPsdAvg = matPsdAvg.cwiseSqrt();
 
-    QVector<MatrixXcd> vecCoherency;
-    for (int i = 0; i < iNRows; ++i) {
-        MatrixXd matPSDtmp = MatrixXd::Zero(iNRows, iNFreqs);
-        for(int j = 0; j < iNRows; ++j){
-            matPSDtmp.row(j) = matPsdAvg.row(i).cwiseProduct(matPsdAvg.row(j));
-        }
-        vecCoherency.append(vecCsdAvg.at(i).cwiseQuotient(matPSDtmp));
+    // Every frequency bin is an independent Hermitian rank update, compute them in parallel.
+    // The jobs write through data() so that no thread detaches the shared vector.
+    MatrixXcd* pCoherency = vecCoherency.data();
+    QList<FrequencyCoherencyJob> lJobs;
+    for (int f = 0; f < iNFreqs; ++f) {
+        FrequencyCoherencyJob job;
+        job.pSpectra = &spectra;
+        job.pCoherency = pCoherency;
+        job.iFreq = f;
+        lJobs.append(job);
     }
+
+    QtConcurrent::blockingMap(lJobs, computeFrequencyCoherency);
+
     return vecCoherency;
 }
@@ -120,6 +120,16 @@ public:
     static QVector<Eigen::MatrixXcd> computeCoherency(const QList<Eigen::MatrixXd> &matDataList,
                                                       int iNfft=-1,
                                                       const QString &sWindowType="hanning");
+
+    //=========================================================================================================
+    /**
+    * Calculates the coherency of the rows of the data matrix from precomputed tapered spectra.
+    *
+    * @param[in] spectra        The tapered spectra of all trials, see AbstractMetric::computeTaperedSpectra.
+    *
+    * @return                   The connectivity information in form of a QVector of matrices.
+    */
+    static QVector<Eigen::MatrixXcd> computeCoherency(const TaperedSpectra& spectra);
 };
 
 
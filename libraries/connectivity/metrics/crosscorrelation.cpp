@@ -76,6 +76,71 @@ using namespace Eigen;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+struct XCorrSpectrumJob {
+    const MatrixXd*         pData;          /**< The epoch data. */
+    int                     iRow;           /**< The row to transform. */
+    int                     iFftSize;       /**< The zero padded FFT length. */
+    RowVectorXcd            vecSpectrum;    /**< The resulting half spectrum. */
+};
+
+void computeXCorrSpectrum(XCorrSpectrumJob& job)
+{
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    RowVectorXd vecPadded = RowVectorXd::Zero(job.iFftSize);
+    vecPadded.head(job.pData->cols()) = job.pData->row(job.iRow);
+
+    fft.fwd(job.vecSpectrum, vecPadded);
+}
+
+struct XCorrRowJob {
+    const QVector<RowVectorXcd>*    pSpectra;       /**< The half spectra of all rows. */
+    int                             iRow;           /**< The seed row. */
+    int                             iFftSize;       /**< The zero padded FFT length. */
+    int                             iMaxLag;        /**< The maximal lag in samples. */
+    RowVectorXd                     vecMax;         /**< The maximum over the lag window for all targets >= iRow. */
+    RowVectorXi                     vecLag;         /**< The lag of the maximum for all targets >= iRow. */
+};
+
+void computeXCorrRow(XCorrRowJob& job)
+{
+    // One FFT object per job, so its cached plan is reused for all pairs of this row
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    const QVector<RowVectorXcd>& vecSpectra = *job.pSpectra;
+    const RowVectorXcd& vecSeed = vecSpectra.at(job.iRow);
+    RowVectorXcd vecProduct;
+    RowVectorXd vecXCorr;
+
+    job.vecMax = RowVectorXd::Zero(vecSpectra.size());
+    job.vecLag = RowVectorXi::Zero(vecSpectra.size());
+
+    for(int j = job.iRow; j < vecSpectra.size(); ++j) {
+        vecProduct = vecSeed.cwiseProduct(vecSpectra.at(j).conjugate());
+        fft.inv(vecXCorr, vecProduct, job.iFftSize);
+
+        // Non negative lags are at the front of the circular result, negative lags at the back
+        int iLag = 0;
+        double dMax = vecXCorr.head(job.iMaxLag + 1).maxCoeff(&iLag);
+        if(job.iMaxLag > 0) {
+            int iTail = 0;
+            double dTail = vecXCorr.tail(job.iMaxLag).maxCoeff(&iTail);
+            if(dTail > dMax) {
+                dMax = dTail;
+                iLag = iTail - job.iMaxLag;
+            }
+        }
+        job.vecMax(j) = dMax;
+        job.vecLag(j) = iLag;
+    }
+}
+
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -89,7 +154,7 @@ CrossCorrelation::CrossCorrelation()
 
 //*************************************************************************************************************
 
-Network CrossCorrelation::crossCorrelation(const QList<MatrixXd> &matDataList, const MatrixX3f& matVert)
+Network CrossCorrelation::crossCorrelation(const QList<MatrixXd> &matDataList, const MatrixX3f& matVert, int iMaxLag)
 {
     Network finalNetwork("Cross Correlation");
 
@@ -113,10 +178,10 @@ Network CrossCorrelation::crossCorrelation(const QList<MatrixXd> &matDataList, c
     }
 
     //Calculate connectivity matrix over epochs and average afterwards
-    QFuture<MatrixXd> resultMat = QtConcurrent::mappedReduced(matDataList, calculate, sum);
-    resultMat.waitForFinished();
-
-    MatrixXd matDist = resultMat.result();
+    MatrixXd matDist = MatrixXd::Zero(rows, rows);
+    for(int i = 0; i < matDataList.size(); ++i) {
+        matDist += calculate(matDataList.at(i), iMaxLag);
+    }
     matDist /= matDataList.size();
 
     //Add edges to network
@@ -138,93 +203,75 @@ Network CrossCorrelation::crossCorrelation(const QList<MatrixXd> &matDataList, c
 
 //*************************************************************************************************************
 
-QPair<int,double> CrossCorrelation::calcCrossCorrelation(const RowVectorXd &vecFirst, const RowVectorXd &vecSecond)
+MatrixXi CrossCorrelation::crossCorrelationLags(const MatrixXd &data, int iMaxLag)
 {
-    Eigen::FFT<double> fft;
-
-    int N = std::max(vecFirst.cols(), vecSecond.cols());
-
-    //Compute the FFT size as the "next power of 2" of the input vector's length (max)
-    int b = ceil(log2(2.0 * N - 1));
-    int fftsize = pow(2,b);
-//    int end = fftsize - 1;
-//    int maxlag = N - 1;
-
-    //Zero Padd
-    RowVectorXd xCorrInputVecFirst = RowVectorXd::Zero(fftsize);
-    xCorrInputVecFirst.head(vecFirst.cols()) = vecFirst;
+    MatrixXi matLag;
+    calculate(data, iMaxLag, &matLag);
 
-    RowVectorXd xCorrInputVecSecond = RowVectorXd::Zero(fftsize);
-    xCorrInputVecSecond.head(vecSecond.cols()) = vecSecond;
+    return matLag;
+}
 
-    //FFT for freq domain to both vectors
-    RowVectorXcd freqvec;
-    RowVectorXcd freqvec2;
 
-    fft.fwd(freqvec, xCorrInputVecFirst);
-    fft.fwd(freqvec2, xCorrInputVecSecond);
+//*************************************************************************************************************
 
-    //Create conjugate complex
-    freqvec2.conjugate();
+MatrixXd CrossCorrelation::calculate(const MatrixXd &data, int iMaxLag, MatrixXi* pMatLag)
+{
+    int iNRows = data.rows();
+    int N = data.cols();
 
-    //Main step of cross corr
-    for (int i = 0; i < fftsize; i++) {
-        freqvec[i] = freqvec[i] * freqvec2[i];
+    MatrixXd matDist = MatrixXd::Zero(iNRows, iNRows);
+    if(pMatLag) {
+        *pMatLag = MatrixXi::Zero(iNRows, iNRows);
+    }
+    if(iNRows == 0 || N == 0) {
+        return matDist;
     }
 
-    RowVectorXd result;
-    fft.inv(result, freqvec);
-
-    //Will get rid of extra zero padding
-    RowVectorXd result2 = result;//.segment(maxlag, N);
-
-    QPair<int,int> minMaxRange;
-    int idx = 0;
-    result2.minCoeff(&idx);
-    minMaxRange.first = idx;
-    result2.maxCoeff(&idx);
-    minMaxRange.second = idx;
-
-//    std::cout<<"result2(minMaxRange.first)"<<result2(minMaxRange.first)<<std::endl;
-//    std::cout<<"result2(minMaxRange.second)"<<result2(minMaxRange.second)<<std::endl;
-//    std::cout<<"b"<<b<<std::endl;
-//    std::cout<<"fftsize"<<fftsize<<std::endl;
-//    std::cout<<"end"<<end<<std::endl;
-//    std::cout<<"maxlag"<<maxlag<<std::endl;
+    if(iMaxLag < 0 || iMaxLag > N - 1) {
+        iMaxLag = N - 1;
+    }
 
-    //Return val
-    int resultIndex = minMaxRange.second;
-    double maxValue = result2(resultIndex);
+    //Compute the FFT size as the "next power of 2" which holds all lags up to iMaxLag without circular wrap around
+    int b = ceil(log2(double(N + iMaxLag)));
+    int iFftSize = pow(2,b);
+
+    //Transform every row once, the spectra are shared by all pairs
+    QList<XCorrSpectrumJob> lSpectrumJobs;
+    for(int i = 0; i < iNRows; ++i) {
+        XCorrSpectrumJob job;
+        job.pData = &data;
+        job.iRow = i;
+        job.iFftSize = iFftSize;
+        lSpectrumJobs.append(job);
+    }
 
-    return QPair<int,double>(resultIndex, maxValue);
-}
+    QtConcurrent::blockingMap(lSpectrumJobs, computeXCorrSpectrum);
 
+    QVector<RowVectorXcd> vecSpectra;
+    vecSpectra.reserve(iNRows);
+    for(int i = 0; i < iNRows; ++i) {
+        vecSpectra.append(lSpectrumJobs.at(i).vecSpectrum);
+    }
 
-//*************************************************************************************************************
+    //Correlate the pairs in parallel, one job per seed row
+    QList<XCorrRowJob> lRowJobs;
+    for(int i = 0; i < iNRows; ++i) {
+        XCorrRowJob job;
+        job.pSpectra = &vecSpectra;
+        job.iRow = i;
+        job.iFftSize = iFftSize;
+        job.iMaxLag = iMaxLag;
+        lRowJobs.append(job);
+    }
 
-MatrixXd CrossCorrelation::calculate(const MatrixXd &data)
-{
-    MatrixXd matDist(data.rows(), data.rows());
-    matDist.setZero();
+    QtConcurrent::blockingMap(lRowJobs, computeXCorrRow);
 
-    for(int i = 0; i < data.rows(); ++i) {
-        for(int j = i; j < data.rows(); ++j) {
-            matDist(i,j) += calcCrossCorrelation(data.row(i), data.row(j)).second;
+    for(int i = 0; i < iNRows; ++i) {
+        matDist.row(i).tail(iNRows - i) = lRowJobs.at(i).vecMax.tail(iNRows - i);
+        if(pMatLag) {
+            pMatLag->row(i).tail(iNRows - i) = lRowJobs.at(i).vecLag.tail(iNRows - i);
         }
     }
 
     return matDist;
 }
-
-
-//*************************************************************************************************************
-
-void CrossCorrelation::sum(MatrixXd &resultData, const MatrixXd &data)
-{
-    if(resultData.rows() != data.rows() || resultData.cols() != data.cols()) {
-        resultData.resize(data.rows(), data.cols());
-        resultData.setZero();
-    }
-
-    resultData += data;
-}
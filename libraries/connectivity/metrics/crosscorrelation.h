@@ -106,45 +106,46 @@ public:
 
     //=========================================================================================================
     /**
-    * Calculates the cross correlation between the rows of the data matrix.
+    * Calculates the cross correlation between the rows of the data matrix. The edge weight is the maximum of the
+    * cross correlation within the lag window, averaged over epochs.
     *
     * @param[in] matDataList    The input data.
     * @param[in] matVert        The vertices of each network node.
+    * @param[in] iMaxLag        The maximal lag in samples. Negative values use all lags.
     *
     * @return                   The connectivity information in form of a network structure.
     */
-    static Network crossCorrelation(const QList<Eigen::MatrixXd> &matDataList, const Eigen::MatrixX3f& matVert);
+    static Network crossCorrelation(const QList<Eigen::MatrixXd> &matDataList,
+                                    const Eigen::MatrixX3f& matVert,
+                                    int iMaxLag = -1);
 
-protected:
     //=========================================================================================================
     /**
-    * Calculates the actual correlation coefficient between two data vectors.
+    * Calculates the lag of the maximum of the cross correlation between the rows of the data matrix within the
+    * lag window. A positive lag means that row i follows row j, i.e. data(i,n) resembles data(j,n-lag).
     *
-    * @param[in] vecFirst    The first input data row.
-    * @param[in] vecSecond   The second input data row.
+    * @param[in] data       The input data.
+    * @param[in] iMaxLag    The maximal lag in samples. Negative values use all lags.
     *
-    * @return                The cross position where the maximum correlation was computed.
+    * @return               The lags in samples, upper triangle only.
     */
-    static QPair<int,double> calcCrossCorrelation(const Eigen::RowVectorXd &vecFirst, const Eigen::RowVectorXd &vecSecond);
+    static Eigen::MatrixXi crossCorrelationLags(const Eigen::MatrixXd &data,
+                                                int iMaxLag = -1);
 
+protected:
     //=========================================================================================================
     /**
-    * Calculates the connectivity matrix for a given input data matrix based on the cross correlation coefficient.
+    * Calculates the connectivity matrix for a given input data matrix based on the cross correlation. Every row
+    * is transformed once and the pairs are correlated in the frequency domain in parallel. The FFT length only
+    * needs to hold the requested lag window.
     *
     * @param[in] data       The input data.
+    * @param[in] iMaxLag    The maximal lag in samples. Negative values use all lags.
+    * @param[out] pMatLag   If set, the lag of each maximum, upper triangle only.
     *
-    * @return               The connectivity matrix.
-    */
-    static Eigen::MatrixXd calculate(const Eigen::MatrixXd &data);
-
-    //=========================================================================================================
-    /**
-    * Sums up (reduces) the in parallel processed connectivity matrix.
-    *
-    * @param[out] resultData    The result data.
-    * @param[in]  data          The incoming and temporary result data.
+    * @return               The connectivity matrix, upper triangle only.
     */
-    static void sum(Eigen::MatrixXd &resultData, const Eigen::MatrixXd &data);
+    static Eigen::MatrixXd calculate(const Eigen::MatrixXd &data, int iMaxLag = -1, Eigen::MatrixXi* pMatLag = Q_NULLPTR);
 
 };
 
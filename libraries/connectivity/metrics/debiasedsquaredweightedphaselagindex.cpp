@@ -56,7 +56,6 @@
 //=============================================================================================================
 
 #include <QDebug>
-#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -82,6 +81,35 @@ using namespace UTILSLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+// Accumulates the sum of the imaginary CSD (sum 0), of its square (sum 1) and of its absolute value (sum 2)
+void computeDSWPLITrialBlock(TrialBlock<MatrixXd>& block)
+{
+    int iNRows = block.pSpectra->iNRows;
+    int iNFreqs = block.pSpectra->iNFreqs;
+
+    for (int i = block.iFirstTrial; i < block.iLastTrial; ++i) {
+        const QVector<MatrixXcd>& vecTapSpectra = block.pSpectra->vecTapSpectra.at(i);
+
+        for (int j = 0; j < iNRows; ++j) {
+            MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
+            for (int k = 0; k < iNRows; ++k) {
+                matCsd.row(k) = Spectral::csdFromTaperedSpectra(vecTapSpectra.at(j), vecTapSpectra.at(k),
+                                                                block.pSpectra->vecTapWeights, block.pSpectra->vecTapWeights,
+                                                                block.pSpectra->iNfft, 1.0);
+            }
+            MatrixXd matCsdImag = matCsd.imag();
+            block.vecSums[0][j] += matCsdImag;
+            MatrixXd matCsdImag2 = matCsdImag.array().square();
+            block.vecSums[1][j] += matCsdImag2;
+            block.vecSums[2][j] += matCsdImag.cwiseAbs();
+        }
+    }
+}
+
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -99,16 +127,24 @@ Network DebiasedSquaredWeightedPhaseLagIndex::debiasedSquaredWeightedPhaseLagInd
                                                                                    const MatrixX3f& matVert,
                                                                                    int iNfft,
                                                                                    const QString &sWindowType)
+{
+    return DebiasedSquaredWeightedPhaseLagIndex::debiasedSquaredWeightedPhaseLagIndex(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType), matVert);
+}
+
+
+//*************************************************************************************************************
+
+Network DebiasedSquaredWeightedPhaseLagIndex::debiasedSquaredWeightedPhaseLagIndex(const TaperedSpectra& spectra, const MatrixX3f& matVert)
 {
     Network finalNetwork("Debiased Squared Weighted Phase Lag Index");
 
-    if(matDataList.empty()) {
+    if(spectra.vecTapSpectra.isEmpty()) {
         qDebug() << "DebiasedSquaredWeightedPhaseLagIndex::debiasedSquaredWeightedPhaseLagIndex - Input data is empty";
         return finalNetwork;
     }
 
     //Create nodes
-    int rows = matDataList.first().rows();
+    int rows = spectra.iNRows;
     RowVectorXf rowVert = RowVectorXf::Zero(3);
 
     for(int i = 0; i < rows; ++i) {
@@ -122,13 +158,11 @@ Network DebiasedSquaredWeightedPhaseLagIndex::debiasedSquaredWeightedPhaseLagInd
     }
 
     //Calculate all-to-all coherence matrix over epochs
-    QVector<MatrixXd> vecDebiasedSquaredWPLI = DebiasedSquaredWeightedPhaseLagIndex::computeDebiasedSquaredWPLI(matDataList,
-                                                                                                                iNfft,
-                                                                                                                sWindowType);
+    QVector<MatrixXd> vecDebiasedSquaredWPLI = DebiasedSquaredWeightedPhaseLagIndex::computeDebiasedSquaredWPLI(spectra);
 
     //Add edges to network
     for(int i = 0; i < vecDebiasedSquaredWPLI.length(); ++i) {
-        for(int j = 0; j < matDataList.at(0).rows(); ++j) {
+        for(int j = 0; j < spectra.iNRows; ++j) {
             MatrixXd matWeight = vecDebiasedSquaredWPLI.at(i).row(j).transpose();
 
             QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork.getNodes()[i], finalNetwork.getNodes()[j], matWeight));
@@ -148,57 +182,20 @@ QVector<MatrixXd> DebiasedSquaredWeightedPhaseLagIndex::computeDebiasedSquaredWP
                                                                                    int iNfft,
                                                                                    const QString &sWindowType)
 {
-    // Check that iNfft >= signal length
-    int iSignalLength = matDataList.at(0).cols();
-    if (iNfft < iSignalLength) {
-        iNfft = iSignalLength;
-    }
+    return DebiasedSquaredWeightedPhaseLagIndex::computeDebiasedSquaredWPLI(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType));
+}
 
-    // Generate tapers
-    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, sWindowType);
 
-    // Initialize vecPsdAvg and vecCsdAvg
-    int iNRows = matDataList.at(0).rows();
-    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
-    QVector<MatrixXd> vecCsdAvg;
-    QVector<MatrixXd> vecSquaredCsdAvg;
-    QVector<MatrixXd> vecCsdAbsAvg;
-    for (int j = 0; j < iNRows; ++j) {
-        vecCsdAvg.append(MatrixXd::Zero(iNRows, iNFreqs));
-        vecSquaredCsdAvg.append(MatrixXd::Zero(iNRows, iNFreqs));
-        vecCsdAbsAvg.append(MatrixXd::Zero(iNRows, iNFreqs));
-    }
-
-    // Generate tapered spectra and CSD and sum over epoch
-    // This part could be parallelized with QtConcurrent::mappedReduced
-    for (int i = 0; i < matDataList.length(); ++i) {
-        //Remove mean
-        MatrixXd matInputData = matDataList.at(i);
-        for (int i = 0; i < matInputData.rows(); ++i) {
-            matInputData.row(i).array() -= matInputData.row(i).mean();
-        }
+//*************************************************************************************************************
 
-        // This part could be parallelized with QtConcurrent::mapped
-        QVector<MatrixXcd> vecTapSpectra;
-        for (int j = 0; j < iNRows; ++j) {
-            MatrixXcd matTmpSpectra = Spectral::computeTaperedSpectra(matInputData.row(j), tapers.first, iNfft);
-            vecTapSpectra.append(matTmpSpectra);
-        }
+QVector<MatrixXd> DebiasedSquaredWeightedPhaseLagIndex::computeDebiasedSquaredWPLI(const TaperedSpectra& spectra)
+{
+    int iNRows = spectra.iNRows;
 
-        // This part could be parallelized with QtConcurrent::mappedReduced
-        for (int j = 0; j < iNRows; ++j) {
-            MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
-            for (int k = 0; k < iNRows; ++k) {
-                matCsd.row(k) = Spectral::csdFromTaperedSpectra(vecTapSpectra.at(j), vecTapSpectra.at(k),
-                                                                tapers.second, tapers.second, iNfft, 1.0);
-            }
-            MatrixXd matCsdImag = matCsd.imag();
-            vecCsdAvg.replace(j, vecCsdAvg.at(j) + matCsdImag);
-            MatrixXd matCsdImag2 = matCsdImag.array().square();
-            vecSquaredCsdAvg.replace(j, vecSquaredCsdAvg.at(j) + matCsdImag2);
-            vecCsdAbsAvg.replace(j, vecCsdAbsAvg.at(j) + matCsdImag.cwiseAbs());
-        }
-    }
+    QVector<QVector<MatrixXd> > vecSums = AbstractMetric::accumulateTrialBlocks<MatrixXd>(spectra, 3, computeDSWPLITrialBlock);
+    const QVector<MatrixXd>& vecCsdAvg = vecSums.at(0);
+    const QVector<MatrixXd>& vecSquaredCsdAvg = vecSums.at(1);
+    const QVector<MatrixXd>& vecCsdAbsAvg = vecSums.at(2);
 
     QVector<MatrixXd> vecDebiasedSquaredWPLI;
     for (int j = 0; j < iNRows; ++j) {
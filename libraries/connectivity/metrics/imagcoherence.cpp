@@ -94,16 +94,24 @@ ImagCoherence::ImagCoherence()
 
 Network ImagCoherence::imagCoherence(const QList<MatrixXd> &matDataList, const MatrixX3f& matVert, int iNfft,
                                      const QString &sWindowType)
+{
+    return ImagCoherence::imagCoherence(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType), matVert);
+}
+
+
+//*************************************************************************************************************
+
+Network ImagCoherence::imagCoherence(const TaperedSpectra& spectra, const MatrixX3f& matVert)
 {
     Network finalNetwork("ImagCoherence");
 
-    if(matDataList.empty()) {
+    if(spectra.vecTapSpectra.isEmpty()) {
         qDebug() << "ImagCoherence::imagcoherence - Input data is empty";
         return finalNetwork;
     }
 
     //Create nodes
-    int rows = matDataList.first().rows();
+    int rows = spectra.iNRows;
     RowVectorXf rowVert = RowVectorXf::Zero(3);
 
     for(int i = 0; i < rows; ++i) {
@@ -117,11 +125,11 @@ Network ImagCoherence::imagCoherence(const QList<MatrixXd> &matDataList, const M
     }
 
     //Calculate all-to-all imaginary coherence matrix over epochs
-    QVector<MatrixXd> vecCoh = ImagCoherence::computeImagCoherence(matDataList, iNfft, sWindowType);
+    QVector<MatrixXd> vecCoh = ImagCoherence::computeImagCoherence(spectra);
 
     //Add edges to network
     for(int i = 0; i < vecCoh.length(); ++i) {
-        for(int j = 0; j < matDataList.at(0).rows(); ++j) {
+        for(int j = 0; j < spectra.iNRows; ++j) {
             MatrixXd matWeight = vecCoh.at(i).row(j).transpose();
 
             QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork.getNodes()[i], finalNetwork.getNodes()[j], matWeight));
@@ -140,7 +148,15 @@ Network ImagCoherence::imagCoherence(const QList<MatrixXd> &matDataList, const M
 QVector<MatrixXd> ImagCoherence::computeImagCoherence(const QList<MatrixXd> &matDataList,
                                                              int iNfft, const QString &sWindowType)
 {
-    QVector<MatrixXcd> vecCoherency = Coherency::computeCoherency(matDataList, iNfft, sWindowType);
+    return ImagCoherence::computeImagCoherence(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType));
+}
+
+
+//*************************************************************************************************************
+
+QVector<MatrixXd> ImagCoherence::computeImagCoherence(const TaperedSpectra& spectra)
+{
+    QVector<MatrixXcd> vecCoherency = Coherency::computeCoherency(spectra);
     QVector<MatrixXd> vecImagCoherence;
     for(int i = 0; i < vecCoherency.length(); ++i) {
         vecImagCoherence.append(vecCoherency.at(i).imag());
@@ -121,6 +121,17 @@ public:
     static Network imagCoherence(const QList<Eigen::MatrixXd> &matDataList, const Eigen::MatrixX3f& matVert,
                                  int iNfft=-1, const QString &sWindowType="hanning");
 
+    //=========================================================================================================
+    /**
+    * Calculates the imaginary coherence between the rows of the data matrix from precomputed tapered spectra.
+    *
+    * @param[in] spectra        The tapered spectra of all trials, see AbstractMetric::computeTaperedSpectra.
+    * @param[in] matVert        The vertices of each network node.
+    *
+    * @return                   The connectivity information in form of a network structure.
+    */
+    static Network imagCoherence(const TaperedSpectra& spectra, const Eigen::MatrixX3f& matVert);
+
     //=========================================================================================================
     /**
     * Calculates the imaginary coherence of the rows of the data matrix.
@@ -133,6 +144,16 @@ public:
     */
     static QVector<Eigen::MatrixXd> computeImagCoherence(const QList<Eigen::MatrixXd> &matDataList,
                                                          int iNfft, const QString &sWindowType);
+
+    //=========================================================================================================
+    /**
+    * Calculates the imaginary coherence of the rows of the data matrix from precomputed tapered spectra.
+    *
+    * @param[in] spectra        The tapered spectra of all trials, see AbstractMetric::computeTaperedSpectra.
+    *
+    * @return                   The connectivity information in form of a QVector of matrices.
+    */
+    static QVector<Eigen::MatrixXd> computeImagCoherence(const TaperedSpectra& spectra);
 };
 
 
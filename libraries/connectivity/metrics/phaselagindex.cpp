@@ -56,7 +56,6 @@
 //=============================================================================================================
 
 #include <QDebug>
-#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -82,6 +81,31 @@ using namespace UTILSLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+// Accumulates the sum of the signs of the imaginary CSD
+void computePLITrialBlock(TrialBlock<MatrixXd>& block)
+{
+    int iNRows = block.pSpectra->iNRows;
+    int iNFreqs = block.pSpectra->iNFreqs;
+
+    for (int i = block.iFirstTrial; i < block.iLastTrial; ++i) {
+        const QVector<MatrixXcd>& vecTapSpectra = block.pSpectra->vecTapSpectra.at(i);
+
+        for (int j = 0; j < iNRows; ++j) {
+            MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
+            for (int k = 0; k < iNRows; ++k) {
+                matCsd.row(k) = Spectral::csdFromTaperedSpectra(vecTapSpectra.at(j), vecTapSpectra.at(k),
+                                                                block.pSpectra->vecTapWeights, block.pSpectra->vecTapWeights,
+                                                                block.pSpectra->iNfft, 1.0);
+            }
+            block.vecSums[0][j] += matCsd.imag().cwiseSign();
+        }
+    }
+}
+
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -97,16 +121,24 @@ PhaseLagIndex::PhaseLagIndex()
 
 Network PhaseLagIndex::phaseLagIndex(const QList<MatrixXd> &matDataList, const MatrixX3f& matVert,
                                      int iNfft, const QString &sWindowType)
+{
+    return PhaseLagIndex::phaseLagIndex(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType), matVert);
+}
+
+
+//*************************************************************************************************************
+
+Network PhaseLagIndex::phaseLagIndex(const TaperedSpectra& spectra, const MatrixX3f& matVert)
 {
     Network finalNetwork("Phase Lag Index");
 
-    if(matDataList.empty()) {
+    if(spectra.vecTapSpectra.isEmpty()) {
         qDebug() << "PhaseLagIndex::phaseLagIndex - Input data is empty";
         return finalNetwork;
     }
 
     //Create nodes
-    int rows = matDataList.first().rows();
+    int rows = spectra.iNRows;
     RowVectorXf rowVert = RowVectorXf::Zero(3);
 
     for(int i = 0; i < rows; ++i) {
@@ -120,11 +152,11 @@ Network PhaseLagIndex::phaseLagIndex(const QList<MatrixXd> &matDataList, const M
     }
 
     //Calculate all-to-all coherence matrix over epochs
-    QVector<MatrixXd> vecPLI = PhaseLagIndex::computePLI(matDataList, iNfft, sWindowType);
+    QVector<MatrixXd> vecPLI = PhaseLagIndex::computePLI(spectra);
 
     //Add edges to network
     for(int i = 0; i < vecPLI.length(); ++i) {
-        for(int j = 0; j < matDataList.at(0).rows(); ++j) {
+        for(int j = 0; j < spectra.iNRows; ++j) {
             MatrixXd matWeight = vecPLI.at(i).row(j).transpose();
 
             QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork.getNodes()[i], finalNetwork.getNodes()[j], matWeight));
@@ -143,53 +175,21 @@ Network PhaseLagIndex::phaseLagIndex(const QList<MatrixXd> &matDataList, const M
 QVector<MatrixXd> PhaseLagIndex::computePLI(const QList<MatrixXd> &matDataList, int iNfft,
                                             const QString &sWindowType)
 {
-    // Check that iNfft >= signal length
-    int iSignalLength = matDataList.at(0).cols();
-    if (iNfft < iSignalLength) {
-        iNfft = iSignalLength;
-    }
+    return PhaseLagIndex::computePLI(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType));
+}
 
-    // Generate tapers
-    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, sWindowType);
 
-    // Initialize vecPsdAvg and vecCsdAvg
-    int iNRows = matDataList.at(0).rows();
-    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
-    QVector<MatrixXd> vecCsdAvg;
-    for (int j = 0; j < iNRows; ++j) {
-        vecCsdAvg.append(MatrixXd::Zero(iNRows, iNFreqs));
-    }
-
-    // Generate tapered spectra and CSD and sum over epoch
-    // This part could be parallelized with QtConcurrent::mappedReduced
-    for (int i = 0; i < matDataList.length(); ++i) {
-        //Remove mean
-        MatrixXd matInputData = matDataList.at(i);
-        for (int i = 0; i < matInputData.rows(); ++i) {
-            matInputData.row(i).array() -= matInputData.row(i).mean();
-        }
+//*************************************************************************************************************
 
-        // This part could be parallelized with QtConcurrent::mapped
-        QVector<MatrixXcd> vecTapSpectra;
-        for (int j = 0; j < iNRows; ++j) {
-            MatrixXcd matTmpSpectra = Spectral::computeTaperedSpectra(matInputData.row(j), tapers.first, iNfft);
-            vecTapSpectra.append(matTmpSpectra);
-        }
+QVector<MatrixXd> PhaseLagIndex::computePLI(const TaperedSpectra& spectra)
+{
+    int iNRows = spectra.iNRows;
 
-        // This part could be parallelized with QtConcurrent::mappedReduced
-        for (int j = 0; j < iNRows; ++j) {
-            MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
-            for (int k = 0; k < iNRows; ++k) {
-                matCsd.row(k) = Spectral::csdFromTaperedSpectra(vecTapSpectra.at(j), vecTapSpectra.at(k),
-                                                                tapers.second, tapers.second, iNfft, 1.0);
-            }
-            vecCsdAvg.replace(j, vecCsdAvg.at(j) + matCsd.imag().cwiseSign());
-        }
-    }
+    QVector<MatrixXd> vecCsdAvg = AbstractMetric::accumulateTrialBlocks<MatrixXd>(spectra, 1, computePLITrialBlock).at(0);
 
     QVector<MatrixXd> vecPLI;
     for (int i = 0; i < iNRows; ++i) {
-        vecPLI.append(vecCsdAvg.at(i).cwiseAbs() / matDataList.length());
+        vecPLI.append(vecCsdAvg.at(i).cwiseAbs() / spectra.vecTapSpectra.length());
     }
     return vecPLI;
 }
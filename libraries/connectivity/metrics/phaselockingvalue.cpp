@@ -56,7 +56,6 @@
 //=============================================================================================================
 
 #include <QDebug>
-#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -82,6 +81,31 @@ using namespace UTILSLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+// Accumulates the sum of the CSD phase factors
+void computePLVTrialBlock(TrialBlock<MatrixXcd>& block)
+{
+    int iNRows = block.pSpectra->iNRows;
+    int iNFreqs = block.pSpectra->iNFreqs;
+
+    for (int i = block.iFirstTrial; i < block.iLastTrial; ++i) {
+        const QVector<MatrixXcd>& vecTapSpectra = block.pSpectra->vecTapSpectra.at(i);
+
+        for (int j = 0; j < iNRows; ++j) {
+            MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
+            for (int k = 0; k < iNRows; ++k) {
+                matCsd.row(k) = Spectral::csdFromTaperedSpectra(vecTapSpectra.at(j), vecTapSpectra.at(k),
+                                                                block.pSpectra->vecTapWeights, block.pSpectra->vecTapWeights,
+                                                                block.pSpectra->iNfft, 1.0);
+            }
+            block.vecSums[0][j] += matCsd.cwiseQuotient(matCsd.cwiseAbs());
+        }
+    }
+}
+
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -97,16 +121,24 @@ PhaseLockingValue::PhaseLockingValue()
 
 Network PhaseLockingValue::phaseLockingValue(const QList<MatrixXd> &matDataList, const MatrixX3f& matVert,
                                            int iNfft, const QString &sWindowType)
+{
+    return PhaseLockingValue::phaseLockingValue(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType), matVert);
+}
+
+
+//*************************************************************************************************************
+
+Network PhaseLockingValue::phaseLockingValue(const TaperedSpectra& spectra, const MatrixX3f& matVert)
 {
     Network finalNetwork("New Phase Locking Value");
 
-    if(matDataList.empty()) {
+    if(spectra.vecTapSpectra.isEmpty()) {
         qDebug() << "PhaseLockingValue::phaseLockingValue - Input data is empty";
         return finalNetwork;
     }
 
     //Create nodes
-    int rows = matDataList.first().rows();
+    int rows = spectra.iNRows;
     RowVectorXf rowVert = RowVectorXf::Zero(3);
 
     for(int i = 0; i < rows; ++i) {
@@ -120,11 +152,11 @@ Network PhaseLockingValue::phaseLockingValue(const QList<MatrixXd> &matDataList,
     }
 
     //Calculate all-to-all coherence matrix over epochs
-    QVector<MatrixXd> vecPLV = PhaseLockingValue::computePLV(matDataList, iNfft, sWindowType);
+    QVector<MatrixXd> vecPLV = PhaseLockingValue::computePLV(spectra);
 
     //Add edges to network
     for(int i = 0; i < vecPLV.length(); ++i) {
-        for(int j = 0; j < matDataList.at(0).rows(); ++j) {
+        for(int j = 0; j < spectra.iNRows; ++j) {
             MatrixXd matWeight = vecPLV.at(i).row(j).transpose();
 
             QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork.getNodes()[i], finalNetwork.getNodes()[j], matWeight));
@@ -143,53 +175,21 @@ Network PhaseLockingValue::phaseLockingValue(const QList<MatrixXd> &matDataList,
 QVector<MatrixXd> PhaseLockingValue::computePLV(const QList<MatrixXd> &matDataList, int iNfft,
                                                 const QString &sWindowType)
 {
-    // Check that iNfft >= signal length
-    int iSignalLength = matDataList.at(0).cols();
-    if (iNfft < iSignalLength) {
-        iNfft = iSignalLength;
-    }
+    return PhaseLockingValue::computePLV(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType));
+}
 
-    // Generate tapers
-    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, sWindowType);
 
-    // Initialize vecPsdAvg and vecCsdAvg
-    int iNRows = matDataList.at(0).rows();
-    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
-    QVector<MatrixXcd> vecCsdAvg;
-    for (int j = 0; j < iNRows; ++j) {
-        vecCsdAvg.append(MatrixXcd::Zero(iNRows, iNFreqs));
-    }
-
-    // Generate tapered spectra and CSD and sum over epoch
-    // This part could be parallelized with QtConcurrent::mappedReduced
-    for (int i = 0; i < matDataList.length(); ++i) {
-        //Remove mean
-        MatrixXd matInputData = matDataList.at(i);
-        for (int i = 0; i < matInputData.rows(); ++i) {
-            matInputData.row(i).array() -= matInputData.row(i).mean();
-        }
+//*************************************************************************************************************
 
-        // This part could be parallelized with QtConcurrent::mapped
-        QVector<MatrixXcd> vecTapSpectra;
-        for (int j = 0; j < iNRows; ++j) {
-            MatrixXcd matTmpSpectra = Spectral::computeTaperedSpectra(matInputData.row(j), tapers.first, iNfft);
-            vecTapSpectra.append(matTmpSpectra);
-        }
+QVector<MatrixXd> PhaseLockingValue::computePLV(const TaperedSpectra& spectra)
+{
+    int iNRows = spectra.iNRows;
 
-        // This part could be parallelized with QtConcurrent::mappedReduced
-        for (int j = 0; j < iNRows; ++j) {
-            MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
-            for (int k = 0; k < iNRows; ++k) {
-                matCsd.row(k) = Spectral::csdFromTaperedSpectra(vecTapSpectra.at(j), vecTapSpectra.at(k),
-                                                                tapers.second, tapers.second, iNfft, 1.0);
-            }
-            vecCsdAvg.replace(j, vecCsdAvg.at(j) + matCsd.cwiseQuotient(matCsd.cwiseAbs()));
-        }
-    }
+    QVector<MatrixXcd> vecCsdAvg = AbstractMetric::accumulateTrialBlocks<MatrixXcd>(spectra, 1, computePLVTrialBlock).at(0);
 
     QVector<MatrixXd> vecPLV;
     for (int i = 0; i < iNRows; ++i) {
-        vecPLV.append(vecCsdAvg.at(i).cwiseAbs() / matDataList.length());
+        vecPLV.append(vecCsdAvg.at(i).cwiseAbs() / spectra.vecTapSpectra.length());
     }
     return vecPLV;
 }
@@ -121,6 +121,17 @@ public:
     static Network phaseLockingValue(const QList<Eigen::MatrixXd> &matDataList, const Eigen::MatrixX3f& matVert,
                                      int iNfft=-1, const QString &sWindowType="hanning");
 
+    //=========================================================================================================
+    /**
+    * Calculates the phase locking value between the rows of the data matrix from precomputed tapered spectra.
+    *
+    * @param[in] spectra        The tapered spectra of all trials, see AbstractMetric::computeTaperedSpectra.
+    * @param[in] matVert        The vertices of each network node.
+    *
+    * @return                   The connectivity information in form of a network structure.
+    */
+    static Network phaseLockingValue(const TaperedSpectra& spectra, const Eigen::MatrixX3f& matVert);
+
     //==========================================================================================================
     /**
     * Calculates the actual phase locking value between two data vectors.
@@ -133,6 +144,16 @@ public:
     */
     static QVector<Eigen::MatrixXd> computePLV(const QList<Eigen::MatrixXd> &matDataList,
                                                int iNfft, const QString &sWindowType);
+
+    //=========================================================================================================
+    /**
+    * Calculates the actual phase locking value between two data vectors from precomputed tapered spectra.
+    *
+    * @param[in] spectra        The tapered spectra of all trials, see AbstractMetric::computeTaperedSpectra.
+    *
+    * @return                   The PLV value.
+    */
+    static QVector<Eigen::MatrixXd> computePLV(const TaperedSpectra& spectra);
 };
 
 
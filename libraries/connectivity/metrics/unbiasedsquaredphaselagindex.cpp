@@ -93,16 +93,24 @@ UnbiasedSquaredPhaseLagIndex::UnbiasedSquaredPhaseLagIndex()
 Network UnbiasedSquaredPhaseLagIndex::unbiasedSquaredPhaseLagIndex(const QList<MatrixXd> &matDataList,
                                                                    const MatrixX3f& matVert,
                                                                    int iNfft, const QString &sWindowType)
+{
+    return UnbiasedSquaredPhaseLagIndex::unbiasedSquaredPhaseLagIndex(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType), matVert);
+}
+
+
+//*************************************************************************************************************
+
+Network UnbiasedSquaredPhaseLagIndex::unbiasedSquaredPhaseLagIndex(const TaperedSpectra& spectra, const MatrixX3f& matVert)
 {
     Network finalNetwork("Unbiased Squared Phase Lag Index");
 
-    if(matDataList.empty()) {
+    if(spectra.vecTapSpectra.isEmpty()) {
         qDebug() << "UnbiasedSquaredPhaseLagIndex::unbiasedSquaredPhaseLagIndex - Input data is empty";
         return finalNetwork;
     }
 
     //Create nodes
-    int rows = matDataList.first().rows();
+    int rows = spectra.iNRows;
     RowVectorXf rowVert = RowVectorXf::Zero(3);
 
     for(int i = 0; i < rows; ++i) {
@@ -116,11 +124,11 @@ Network UnbiasedSquaredPhaseLagIndex::unbiasedSquaredPhaseLagIndex(const QList<M
     }
 
     //Calculate all-to-all coherence matrix over epochs
-    QVector<MatrixXd> vecUnbiasedSquaredPLI = UnbiasedSquaredPhaseLagIndex::computeUnbiasedSquaredPLI(matDataList, iNfft, sWindowType);
+    QVector<MatrixXd> vecUnbiasedSquaredPLI = UnbiasedSquaredPhaseLagIndex::computeUnbiasedSquaredPLI(spectra);
 
     //Add edges to network
     for(int i = 0; i < vecUnbiasedSquaredPLI.length(); ++i) {
-        for(int j = 0; j < matDataList.at(0).rows(); ++j) {
+        for(int j = 0; j < spectra.iNRows; ++j) {
             MatrixXd matWeight = vecUnbiasedSquaredPLI.at(i).row(j).transpose();
 
             QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork.getNodes()[i], finalNetwork.getNodes()[j], matWeight));
@@ -139,11 +147,19 @@ Network UnbiasedSquaredPhaseLagIndex::unbiasedSquaredPhaseLagIndex(const QList<M
 QVector<MatrixXd> UnbiasedSquaredPhaseLagIndex::computeUnbiasedSquaredPLI(const QList<MatrixXd> &matDataList,
                                                                           int iNfft, const QString &sWindowType)
 {
-    int iNRows = matDataList.at(0).rows();
-    int iNTrials = matDataList.length();
+    return UnbiasedSquaredPhaseLagIndex::computeUnbiasedSquaredPLI(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType));
+}
+
+
+//*************************************************************************************************************
+
+QVector<MatrixXd> UnbiasedSquaredPhaseLagIndex::computeUnbiasedSquaredPLI(const TaperedSpectra& spectra)
+{
+    int iNRows = spectra.iNRows;
+    int iNTrials = spectra.vecTapSpectra.length();
 
     // Compute standard PLI
-    QVector<MatrixXd> vecUnbiasedSquaredPLI = PhaseLagIndex::computePLI(matDataList, iNfft, sWindowType);
+    QVector<MatrixXd> vecUnbiasedSquaredPLI = PhaseLagIndex::computePLI(spectra);
 
     // Compute unbiased estimator according to Vinck et al., NeuroImage 55, pp. 1548-65, 2011
     for (int j = 0; j < iNRows; ++j) {
@@ -122,6 +122,17 @@ public:
                                                 const Eigen::MatrixX3f& matVert,
                                                 int iNfft=-1, const QString &sWindowType="hanning");
 
+    //=========================================================================================================
+    /**
+    * Calculates the phase lag index between the rows of the data matrix from precomputed tapered spectra.
+    *
+    * @param[in] spectra        The tapered spectra of all trials, see AbstractMetric::computeTaperedSpectra.
+    * @param[in] matVert        The vertices of each network node.
+    *
+    * @return                   The connectivity information in form of a network structure.
+    */
+    static Network unbiasedSquaredPhaseLagIndex(const TaperedSpectra& spectra, const Eigen::MatrixX3f& matVert);
+
     //==========================================================================================================
     /**
     * Calculates the actual phase lag index between two data vectors.
@@ -134,6 +145,16 @@ public:
     */
     static QVector<Eigen::MatrixXd> computeUnbiasedSquaredPLI(const QList<Eigen::MatrixXd> &matDataList,
                                                               int iNfft, const QString &sWindowType);
+
+    //=========================================================================================================
+    /**
+    * Calculates the actual phase lag index between two data vectors from precomputed tapered spectra.
+    *
+    * @param[in] spectra        The tapered spectra of all trials, see AbstractMetric::computeTaperedSpectra.
+    *
+    * @return                   The PLI value.
+    */
+    static QVector<Eigen::MatrixXd> computeUnbiasedSquaredPLI(const TaperedSpectra& spectra);
 };
 
 
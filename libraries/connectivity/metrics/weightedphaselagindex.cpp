@@ -56,7 +56,6 @@
 //=============================================================================================================
 
 #include <QDebug>
-#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -82,6 +81,32 @@ using namespace UTILSLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+// Accumulates the sum of the imaginary CSD (sum 0) and of its absolute value (sum 1)
+void computeWPLITrialBlock(TrialBlock<MatrixXd>& block)
+{
+    int iNRows = block.pSpectra->iNRows;
+    int iNFreqs = block.pSpectra->iNFreqs;
+
+    for (int i = block.iFirstTrial; i < block.iLastTrial; ++i) {
+        const QVector<MatrixXcd>& vecTapSpectra = block.pSpectra->vecTapSpectra.at(i);
+
+        for (int j = 0; j < iNRows; ++j) {
+            MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
+            for (int k = 0; k < iNRows; ++k) {
+                matCsd.row(k) = Spectral::csdFromTaperedSpectra(vecTapSpectra.at(j), vecTapSpectra.at(k),
+                                                                block.pSpectra->vecTapWeights, block.pSpectra->vecTapWeights,
+                                                                block.pSpectra->iNfft, 1.0);
+            }
+            block.vecSums[0][j] += matCsd.imag();
+            block.vecSums[1][j] += matCsd.imag().cwiseAbs();
+        }
+    }
+}
+
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -98,16 +123,24 @@ WeightedPhaseLagIndex::WeightedPhaseLagIndex()
 Network WeightedPhaseLagIndex::weightedPhaseLagIndex(const QList<MatrixXd> &matDataList,
                                                      const MatrixX3f& matVert,
                                                      int iNfft, const QString &sWindowType)
+{
+    return WeightedPhaseLagIndex::weightedPhaseLagIndex(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType), matVert);
+}
+
+
+//*************************************************************************************************************
+
+Network WeightedPhaseLagIndex::weightedPhaseLagIndex(const TaperedSpectra& spectra, const MatrixX3f& matVert)
 {
     Network finalNetwork("Weighted Phase Lag Index");
 
-    if(matDataList.empty()) {
+    if(spectra.vecTapSpectra.isEmpty()) {
         qDebug() << "WeightedPhaseLagIndex::weightedPhaseLagIndex - Input data is empty";
         return finalNetwork;
     }
 
     //Create nodes
-    int rows = matDataList.first().rows();
+    int rows = spectra.iNRows;
     RowVectorXf rowVert = RowVectorXf::Zero(3);
 
     for(int i = 0; i < rows; ++i) {
@@ -121,11 +154,11 @@ Network WeightedPhaseLagIndex::weightedPhaseLagIndex(const QList<MatrixXd> &matD
     }
 
     //Calculate all-to-all coherence matrix over epochs
-    QVector<MatrixXd> vecWPLI = WeightedPhaseLagIndex::computeWPLI(matDataList, iNfft, sWindowType);
+    QVector<MatrixXd> vecWPLI = WeightedPhaseLagIndex::computeWPLI(spectra);
 
     //Add edges to network
     for(int i = 0; i < vecWPLI.length(); ++i) {
-        for(int j = 0; j < matDataList.at(0).rows(); ++j) {
+        for(int j = 0; j < spectra.iNRows; ++j) {
             MatrixXd matWeight = vecWPLI.at(i).row(j).transpose();
 
             QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork.getNodes()[i], finalNetwork.getNodes()[j], matWeight));
@@ -144,52 +177,19 @@ Network WeightedPhaseLagIndex::weightedPhaseLagIndex(const QList<MatrixXd> &matD
 QVector<MatrixXd> WeightedPhaseLagIndex::computeWPLI(const QList<MatrixXd> &matDataList, int iNfft,
                                                      const QString &sWindowType)
 {
-    // Check that iNfft >= signal length
-    int iSignalLength = matDataList.at(0).cols();
-    if (iNfft < iSignalLength) {
-        iNfft = iSignalLength;
-    }
+    return WeightedPhaseLagIndex::computeWPLI(AbstractMetric::computeTaperedSpectra(matDataList, iNfft, sWindowType));
+}
 
-    // Generate tapers
-    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, sWindowType);
-
-    // Initialize vecPsdAvg and vecCsdAvg
-    int iNRows = matDataList.at(0).rows();
-    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
-    QVector<MatrixXd> vecCsdAvg;
-    QVector<MatrixXd> vecCsdAbsAvg;
-    for (int j = 0; j < iNRows; ++j) {
-        vecCsdAvg.append(MatrixXd::Zero(iNRows, iNFreqs));
-        vecCsdAbsAvg.append(MatrixXd::Zero(iNRows, iNFreqs));
-    }
 
-    // Generate tapered spectra and CSD and sum over epoch
-    // This part could be parallelized with QtConcurrent::mappedReduced
-    for (int i = 0; i < matDataList.length(); ++i) {
-        //Remove mean
-        MatrixXd matInputData = matDataList.at(i);
-        for (int i = 0; i < matInputData.rows(); ++i) {
-            matInputData.row(i).array() -= matInputData.row(i).mean();
-        }
+//*************************************************************************************************************
 
-        // This part could be parallelized with QtConcurrent::mapped
-        QVector<MatrixXcd> vecTapSpectra;
-        for (int j = 0; j < iNRows; ++j) {
-            MatrixXcd matTmpSpectra = Spectral::computeTaperedSpectra(matInputData.row(j), tapers.first, iNfft);
-            vecTapSpectra.append(matTmpSpectra);
-        }
+QVector<MatrixXd> WeightedPhaseLagIndex::computeWPLI(const TaperedSpectra& spectra)
+{
+    int iNRows = spectra.iNRows;
 
-        // This part could be parallelized with QtConcurrent::mappedReduced
-        for (int j = 0; j < iNRows; ++j) {
-            MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
-            for (int k = 0; k < iNRows; ++k) {
-                matCsd.row(k) = Spectral::csdFromTaperedSpectra(vecTapSpectra.at(j), vecTapSpectra.at(k),
-                                                                tapers.second, tapers.second, iNfft, 1.0);
-            }
-            vecCsdAvg.replace(j, vecCsdAvg.at(j) + matCsd.imag());
-            vecCsdAbsAvg.replace(j, vecCsdAbsAvg.at(j) + matCsd.imag().cwiseAbs());
-        }
-    }
+    QVector<QVector<MatrixXd> > vecSums = AbstractMetric::accumulateTrialBlocks<MatrixXd>(spectra, 2, computeWPLITrialBlock);
+    const QVector<MatrixXd>& vecCsdAvg = vecSums.at(0);
+    const QVector<MatrixXd>& vecCsdAbsAvg = vecSums.at(1);
 
     QVector<MatrixXd> vecWPLI;
     for (int i = 0; i < iNRows; ++i) {
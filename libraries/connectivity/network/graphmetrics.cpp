@@ -0,0 +1,396 @@
+//=============================================================================================================
+/**
+* @file     graphmetrics.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     GraphMetrics class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "graphmetrics.h"
+
+#include "network.h"
+
+#include <limits>
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QList>
+#include <QVector>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Eigenvalues>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace CONNECTIVITYLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+struct ShortestPathJob {
+    const MatrixXd*     pLengths;       /**< The edge lengths, infinite where there is no edge. */
+    int                 iSource;        /**< The source node. */
+    VectorXd            vecDistances;   /**< The resulting distances from the source node. */
+};
+
+void computeShortestPaths(ShortestPathJob& job)
+{
+    // Dijkstra on the dense length matrix, O(n^2) per source without a priority queue
+    const MatrixXd& matLengths = *job.pLengths;
+    int iNNodes = matLengths.rows();
+
+    job.vecDistances = VectorXd::Constant(iNNodes, std::numeric_limits<double>::infinity());
+    job.vecDistances(job.iSource) = 0.0;
+
+    QVector<bool> vecVisited(iNNodes, false);
+
+    for(int n = 0; n < iNNodes; ++n) {
+        int iCurrent = -1;
+        double dMin = std::numeric_limits<double>::infinity();
+
+        for(int i = 0; i < iNNodes; ++i) {
+            if(!vecVisited[i] && job.vecDistances(i) < dMin) {
+                dMin = job.vecDistances(i);
+                iCurrent = i;
+            }
+        }
+
+        // The remaining nodes are unreachable
+        if(iCurrent < 0) {
+            break;
+        }
+
+        vecVisited[iCurrent] = true;
+
+        // The length matrix is symmetric, so the column is a contiguous copy of the row
+        job.vecDistances = job.vecDistances.cwiseMin((matLengths.col(iCurrent).array() + dMin).matrix());
+    }
+}
+
+//*************************************************************************************************************
+
+double groupModularityGain(const MatrixXd& matModularity,
+                           const QVector<int>& vecGroup,
+                           VectorXd& vecSplit)
+{
+    int iNGroup = vecGroup.size();
+
+    // Modularity matrix of the group, the row sums of the group are removed from the diagonal
+    MatrixXd matGroup(iNGroup, iNGroup);
+    for(int i = 0; i < iNGroup; ++i) {
+        for(int j = 0; j < iNGroup; ++j) {
+            matGroup(i,j) = matModularity(vecGroup[i], vecGroup[j]);
+        }
+    }
+    matGroup.diagonal() -= matGroup.rowwise().sum();
+
+    SelfAdjointEigenSolver<MatrixXd> eig(matGroup);
+    if(eig.info() != Success || eig.eigenvalues()(iNGroup - 1) <= 1e-10) {
+        return 0.0;
+    }
+
+    const VectorXd vecLeading = eig.eigenvectors().col(iNGroup - 1);
+    vecSplit.resize(iNGroup);
+    for(int i = 0; i < iNGroup; ++i) {
+        vecSplit(i) = vecLeading(i) >= 0.0 ? 1.0 : -1.0;
+    }
+
+    return vecSplit.dot(matGroup * vecSplit);
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+GraphMetrics::GraphMetrics()
+{
+}
+
+
+//*************************************************************************************************************
+
+GraphMeasures GraphMetrics::computeMeasures(const Network& network)
+{
+    GraphMeasures measures;
+
+    MatrixXd matWeights = weightMatrix(network.getConnectivityMatrix());
+
+    measures.vecDegree = degree(matWeights);
+    measures.vecStrength = strength(matWeights);
+    measures.vecClustering = clusteringCoefficient(matWeights);
+    measures.matDistances = shortestPathLengths(matWeights);
+    measures.dCharacteristicPathLength = characteristicPathLength(measures.matDistances);
+    measures.dGlobalEfficiency = globalEfficiency(measures.matDistances);
+    measures.vecCommunities = communities(matWeights);
+    measures.dModularity = modularity(matWeights, measures.vecCommunities);
+
+    return measures;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd GraphMetrics::weightMatrix(const MatrixXd& matConnectivity)
+{
+    if(matConnectivity.rows() != matConnectivity.cols()) {
+        qWarning() << "GraphMetrics::weightMatrix - Connectivity matrix is not square. Returning.";
+        return MatrixXd();
+    }
+
+    MatrixXd matWeights = matConnectivity.cwiseAbs();
+    matWeights = matWeights.cwiseMax(matWeights.transpose()).eval();
+    matWeights.diagonal().setZero();
+
+    return matWeights;
+}
+
+
+//*************************************************************************************************************
+
+VectorXi GraphMetrics::degree(const MatrixXd& matWeights, double dThreshold)
+{
+    return (matWeights.array() > dThreshold).cast<int>().rowwise().sum();
+}
+
+
+//*************************************************************************************************************
+
+VectorXd GraphMetrics::strength(const MatrixXd& matWeights)
+{
+    return matWeights.rowwise().sum();
+}
+
+
+//*************************************************************************************************************
+
+VectorXd GraphMetrics::clusteringCoefficient(const MatrixXd& matWeights)
+{
+    VectorXd vecClustering = VectorXd::Zero(matWeights.rows());
+
+    double dMax = matWeights.maxCoeff();
+    if(matWeights.size() == 0 || dMax <= 0.0) {
+        return vecClustering;
+    }
+
+    MatrixXd matRoot = (matWeights / dMax).array().pow(1.0 / 3.0).matrix();
+
+    // diag(M^3) of the symmetric M without forming the third power
+    VectorXd vecCycles = (matRoot * matRoot).cwiseProduct(matRoot).rowwise().sum();
+    VectorXi vecDegree = degree(matWeights);
+
+    for(int i = 0; i < vecClustering.size(); ++i) {
+        if(vecDegree(i) > 1) {
+            vecClustering(i) = vecCycles(i) / (double(vecDegree(i)) * (vecDegree(i) - 1));
+        }
+    }
+
+    return vecClustering;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd GraphMetrics::shortestPathLengths(const MatrixXd& matWeights)
+{
+    int iNNodes = matWeights.rows();
+
+    // Strong connections are short
+    MatrixXd matLengths = (matWeights.array() > 0.0).select(matWeights.cwiseInverse(),
+                                                           std::numeric_limits<double>::infinity());
+
+    QList<ShortestPathJob> lJobs;
+    for(int i = 0; i < iNNodes; ++i) {
+        ShortestPathJob job;
+        job.pLengths = &matLengths;
+        job.iSource = i;
+        lJobs.append(job);
+    }
+
+    QtConcurrent::blockingMap(lJobs, computeShortestPaths);
+
+    MatrixXd matDistances(iNNodes, iNNodes);
+    for(int i = 0; i < iNNodes; ++i) {
+        matDistances.row(i) = lJobs.at(i).vecDistances.transpose();
+    }
+
+    return matDistances;
+}
+
+
+//*************************************************************************************************************
+
+double GraphMetrics::characteristicPathLength(const MatrixXd& matDistances)
+{
+    double dSum = 0.0;
+    int iCount = 0;
+
+    for(int i = 0; i < matDistances.rows(); ++i) {
+        for(int j = 0; j < matDistances.cols(); ++j) {
+            if(i != j && std::isfinite(matDistances(i,j))) {
+                dSum += matDistances(i,j);
+                ++iCount;
+            }
+        }
+    }
+
+    return iCount > 0 ? dSum / iCount : 0.0;
+}
+
+
+//*************************************************************************************************************
+
+double GraphMetrics::globalEfficiency(const MatrixXd& matDistances)
+{
+    int iNNodes = matDistances.rows();
+    if(iNNodes < 2) {
+        return 0.0;
+    }
+
+    // Unreachable pairs have an infinite distance and contribute 0, the diagonal is excluded
+    MatrixXd matEfficiency = (matDistances.array() > 0.0).select(matDistances.cwiseInverse(), 0.0);
+    matEfficiency.diagonal().setZero();
+
+    return matEfficiency.sum() / (double(iNNodes) * (iNNodes - 1));
+}
+
+
+//*************************************************************************************************************
+
+double GraphMetrics::modularity(const MatrixXd& matWeights, const VectorXi& vecCommunities)
+{
+    if(vecCommunities.size() != matWeights.rows() || matWeights.rows() == 0) {
+        qWarning() << "GraphMetrics::modularity - Number of communities does not match the number of nodes. Returning.";
+        return 0.0;
+    }
+
+    double dTotal = matWeights.sum();
+    if(dTotal <= 0.0) {
+        return 0.0;
+    }
+
+    // Membership matrix, Q = (tr(S'WS) - |S'k|^2 / 2m) / 2m
+    MatrixXd matMembership = MatrixXd::Zero(matWeights.rows(), vecCommunities.maxCoeff() + 1);
+    for(int i = 0; i < vecCommunities.size(); ++i) {
+        matMembership(i, vecCommunities(i)) = 1.0;
+    }
+
+    VectorXd vecCommunityStrength = matMembership.transpose() * strength(matWeights);
+    double dWithin = (matMembership.transpose() * matWeights * matMembership).trace();
+
+    return (dWithin - vecCommunityStrength.squaredNorm() / dTotal) / dTotal;
+}
+
+
+//*************************************************************************************************************
+
+VectorXi GraphMetrics::communities(const MatrixXd& matWeights)
+{
+    int iNNodes = matWeights.rows();
+    VectorXi vecCommunities = VectorXi::Zero(iNNodes);
+
+    double dTotal = matWeights.sum();
+    if(iNNodes < 2 || dTotal <= 0.0) {
+        return vecCommunities;
+    }
+
+    VectorXd vecStrength = strength(matWeights);
+    MatrixXd matModularity = matWeights - vecStrength * vecStrength.transpose() / dTotal;
+
+    QList<QVector<int> > lGroups;
+    QVector<int> vecAll;
+    for(int i = 0; i < iNNodes; ++i) {
+        vecAll.append(i);
+    }
+    lGroups.append(vecAll);
+
+    int iNCommunities = 0;
+
+    // Split the groups until no split increases the modularity
+    while(!lGroups.isEmpty()) {
+        QVector<int> vecGroup = lGroups.takeFirst();
+        VectorXd vecSplit;
+
+        if(vecGroup.size() > 1 && groupModularityGain(matModularity, vecGroup, vecSplit) > 1e-10) {
+            QVector<int> vecFirst, vecSecond;
+            for(int i = 0; i < vecGroup.size(); ++i) {
+                if(vecSplit(i) > 0.0) {
+                    vecFirst.append(vecGroup[i]);
+                } else {
+                    vecSecond.append(vecGroup[i]);
+                }
+            }
+
+            if(!vecFirst.isEmpty() && !vecSecond.isEmpty()) {
+                lGroups.append(vecFirst);
+                lGroups.append(vecSecond);
+                continue;
+            }
+        }
+
+        for(int i = 0; i < vecGroup.size(); ++i) {
+            vecCommunities(vecGroup[i]) = iNCommunities;
+        }
+        ++iNCommunities;
+    }
+
+    return vecCommunities;
+}
@@ -0,0 +1,244 @@
+//=============================================================================================================
+/**
+* @file     graphmetrics.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     GraphMetrics class declaration.
+*
+*/
+
+#ifndef GRAPHMETRICS_H
+#define GRAPHMETRICS_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../connectivity_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE CONNECTIVITYLIB
+//=============================================================================================================
+
+namespace CONNECTIVITYLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// CONNECTIVITYLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+class Network;
+
+
+//=============================================================================================================
+/**
+* The graph measures of a network. See GraphMetrics for their definitions.
+*/
+struct GraphMeasures {
+    Eigen::VectorXi     vecDegree;                      /**< The node degrees. */
+    Eigen::VectorXd     vecStrength;                    /**< The node strengths. */
+    Eigen::VectorXd     vecClustering;                  /**< The weighted clustering coefficient of each node. */
+    Eigen::MatrixXd     matDistances;                   /**< The weighted shortest path lengths between all nodes. */
+    double              dCharacteristicPathLength;      /**< The mean shortest path length. */
+    double              dGlobalEfficiency;              /**< The mean inverse shortest path length. */
+    Eigen::VectorXi     vecCommunities;                 /**< The community of each node. */
+    double              dModularity;                    /**< The modularity of the communities. */
+
+    GraphMeasures() : dCharacteristicPathLength(0.0), dGlobalEfficiency(0.0), dModularity(0.0) {}
+};
+
+
+//=============================================================================================================
+/**
+* Computes graph measures on connectivity matrices. The graph is treated as undirected and weighted: the absolute
+* weights are used, the diagonal is ignored and the matrix is symmetrized by the maximum of both directions, which
+* also covers metrics that only fill the upper triangle. All functions expect such a prepared weight matrix, see
+* weightMatrix(...).
+*
+* @brief Graph measures of connectivity networks.
+*/
+class CONNECTIVITYSHARED_EXPORT GraphMetrics
+{
+
+public:
+    typedef QSharedPointer<GraphMetrics> SPtr;            /**< Shared pointer type for GraphMetrics. */
+    typedef QSharedPointer<const GraphMetrics> ConstSPtr; /**< Const shared pointer type for GraphMetrics. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a GraphMetrics object.
+    */
+    explicit GraphMetrics();
+
+    //=========================================================================================================
+    /**
+    * Computes all graph measures of a network, e.g. the result of Connectivity::calculateConnectivity().
+    *
+    * @param[in] network        The network.
+    *
+    * @return The graph measures.
+    */
+    static GraphMeasures computeMeasures(const Network& network);
+
+    //=========================================================================================================
+    /**
+    * Prepares the weight matrix of a connectivity matrix: absolute values, zero diagonal, symmetrized by the
+    * maximum of both directions.
+    *
+    * @param[in] matConnectivity    The connectivity matrix.
+    *
+    * @return The weight matrix.
+    */
+    static Eigen::MatrixXd weightMatrix(const Eigen::MatrixXd& matConnectivity);
+
+    //=========================================================================================================
+    /**
+    * Computes the degree, the number of edges with a weight above the threshold, for each node.
+    *
+    * @param[in] matWeights     The weight matrix.
+    * @param[in] dThreshold     Edges with a weight of at most this threshold are not counted.
+    *
+    * @return The node degrees.
+    */
+    static Eigen::VectorXi degree(const Eigen::MatrixXd& matWeights, double dThreshold = 0.0);
+
+    //=========================================================================================================
+    /**
+    * Computes the strength, the sum of the edge weights, for each node.
+    *
+    * @param[in] matWeights     The weight matrix.
+    *
+    * @return The node strengths.
+    */
+    static Eigen::VectorXd strength(const Eigen::MatrixXd& matWeights);
+
+    //=========================================================================================================
+    /**
+    * Computes the weighted clustering coefficient according to Onnela et al., Phys. Rev. E 71, 065103, 2005. The
+    * triangle intensities are the diagonal of the cube of the cube root of the normalized weights, computed with
+    * a single matrix product.
+    *
+    * @param[in] matWeights     The weight matrix.
+    *
+    * @return The clustering coefficient of each node. Nodes with less than two neighbours get 0.
+    */
+    static Eigen::VectorXd clusteringCoefficient(const Eigen::MatrixXd& matWeights);
+
+    //=========================================================================================================
+    /**
+    * Computes the weighted shortest path lengths between all nodes. The length of an edge is the inverse of its
+    * weight. Dijkstra's algorithm is run from every node in parallel.
+    *
+    * @param[in] matWeights     The weight matrix.
+    *
+    * @return The shortest path lengths. Unreachable nodes have an infinite distance.
+    */
+    static Eigen::MatrixXd shortestPathLengths(const Eigen::MatrixXd& matWeights);
+
+    //=========================================================================================================
+    /**
+    * Computes the characteristic path length, the mean of the finite shortest path lengths between different
+    * nodes.
+    *
+    * @param[in] matDistances   The shortest path lengths.
+    *
+    * @return The characteristic path length.
+    */
+    static double characteristicPathLength(const Eigen::MatrixXd& matDistances);
+
+    //=========================================================================================================
+    /**
+    * Computes the global efficiency, the mean inverse shortest path length between different nodes.
+    *
+    * @param[in] matDistances   The shortest path lengths.
+    *
+    * @return The global efficiency.
+    */
+    static double globalEfficiency(const Eigen::MatrixXd& matDistances);
+
+    //=========================================================================================================
+    /**
+    * Computes the weighted modularity Q of a partition (Newman, PNAS 103, pp. 8577-82, 2006).
+    *
+    * @param[in] matWeights         The weight matrix.
+    * @param[in] vecCommunities     The community of each node.
+    *
+    * @return The modularity.
+    */
+    static double modularity(const Eigen::MatrixXd& matWeights, const Eigen::VectorXi& vecCommunities);
+
+    //=========================================================================================================
+    /**
+    * Detects communities by repeated bisection along the leading eigenvector of the modularity matrix
+    * (Newman, PNAS 103, pp. 8577-82, 2006). A group is only split if this increases the modularity.
+    *
+    * @param[in] matWeights     The weight matrix.
+    *
+    * @return The community of each node, numbered from 0.
+    */
+    static Eigen::VectorXi communities(const Eigen::MatrixXd& matWeights);
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+
+} // namespace CONNECTIVITYLIB
+
+#endif // GRAPHMETRICS_H
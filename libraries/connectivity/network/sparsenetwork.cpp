@@ -0,0 +1,381 @@
+//=============================================================================================================
+/**
+* @file     sparsenetwork.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     SparseNetwork class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "sparsenetwork.h"
+
+#include "network.h"
+#include "networkedge.h"
+#include "networknode.h"
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace CONNECTIVITYLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+bool strongerEdge(const QPair<int,float>& a, const QPair<int,float>& b)
+{
+    float fA = std::fabs(a.second);
+    float fB = std::fabs(b.second);
+    return fA > fB || (fA == fB && a.first < b.first);
+}
+
+bool lowerEndNode(const QPair<int,float>& a, const QPair<int,float>& b)
+{
+    return a.first < b.first;
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+SparseNetwork::SparseNetwork(const QString& sConnectivityMethod, float fThreshold, int iTopK)
+: m_sConnectivityMethod(sConnectivityMethod)
+, m_fThreshold(fThreshold)
+, m_iTopK(iTopK)
+{
+    m_vecRowPtr.append(0);
+}
+
+
+//*************************************************************************************************************
+
+SparseNetwork SparseNetwork::fromNetwork(const Network& network, float fThreshold, int iTopK, int idxRow, int idxCol)
+{
+    SparseNetwork sparseNetwork(network.getConnectivityMethod(), fThreshold, iTopK);
+
+    const QList<NetworkNode::SPtr>& lNodes = network.getNodes();
+    const QList<NetworkEdge::SPtr>& lEdges = network.getEdges();
+
+    sparseNetwork.reserve(lNodes.size(), lEdges.size());
+
+    // Group the edges by their start node
+    QVector<QVector<QPair<int,float> > > vecNodeEdges(lNodes.size());
+    for(int i = 0; i < lEdges.size(); ++i) {
+        int iStart = lEdges.at(i)->getStartNode()->getId();
+        int iEnd = lEdges.at(i)->getEndNode()->getId();
+        MatrixXd matWeight = lEdges.at(i)->getWeight();
+
+        if(iStart < lNodes.size() && idxRow < matWeight.rows() && idxCol < matWeight.cols()) {
+            vecNodeEdges[iStart].append(QPair<int,float>(iEnd, float(matWeight(idxRow, idxCol))));
+        }
+    }
+
+    for(int i = 0; i < lNodes.size(); ++i) {
+        const RowVectorXf& vecNodeVert = lNodes.at(i)->getVert();
+        for(int k = 0; k < 3 && k < vecNodeVert.size(); ++k) {
+            sparseNetwork.m_matNodePositions(i,k) = vecNodeVert(k);
+        }
+
+        sparseNetwork.appendEdges(vecNodeEdges.at(i));
+    }
+
+    return sparseNetwork;
+}
+
+
+//*************************************************************************************************************
+
+SparseNetwork SparseNetwork::fromConnectivity(const QVector<MatrixXd>& vecConnectivity,
+                                              const MatrixX3f& matVert,
+                                              const QString& sConnectivityMethod,
+                                              float fThreshold,
+                                              int iTopK,
+                                              int iFreq)
+{
+    SparseNetwork sparseNetwork(sConnectivityMethod, fThreshold, iTopK);
+
+    int iNNodes = vecConnectivity.size();
+    sparseNetwork.reserve(iNNodes, iTopK > 0 ? iNNodes * iTopK : 0);
+
+    for(int i = 0; i < iNNodes; ++i) {
+        if(i < matVert.rows()) {
+            sparseNetwork.m_matNodePositions.row(i) = matVert.row(i);
+        }
+
+        if(iFreq < vecConnectivity.at(i).cols()) {
+            sparseNetwork.appendEdges(vecConnectivity.at(i).col(iFreq));
+        } else {
+            qDebug() << "SparseNetwork::fromConnectivity - Frequency column" << iFreq << "out of range";
+            sparseNetwork.appendEdges(QVector<QPair<int,float> >());
+        }
+    }
+
+    return sparseNetwork;
+}
+
+
+//*************************************************************************************************************
+
+void SparseNetwork::appendNode(const RowVector3f& vecVert, const VectorXd& vecWeights)
+{
+    appendPosition(vecVert);
+    appendEdges(vecWeights);
+}
+
+
+//*************************************************************************************************************
+
+void SparseNetwork::appendNode(const RowVector3f& vecVert, QVector<QPair<int,float> > lEdges)
+{
+    appendPosition(vecVert);
+    appendEdges(lEdges);
+}
+
+
+//*************************************************************************************************************
+
+void SparseNetwork::reserve(int iNNodes, int iNEdges)
+{
+    int iNOld = getNumberNodes();
+    if(iNNodes > iNOld) {
+        m_matNodePositions.conservativeResize(iNNodes, 3);
+        m_matNodePositions.bottomRows(iNNodes - iNOld).setZero();
+    }
+
+    m_vecRowPtr.reserve(iNNodes + 1);
+    m_vecEndNodes.reserve(iNEdges);
+    m_vecWeights.reserve(iNEdges);
+}
+
+
+//*************************************************************************************************************
+
+void SparseNetwork::appendPosition(const RowVector3f& vecVert)
+{
+    int iNode = getNumberNodes();
+    if(iNode >= m_matNodePositions.rows()) {
+        m_matNodePositions.conservativeResize(iNode + 1, 3);
+    }
+    m_matNodePositions.row(iNode) = vecVert;
+}
+
+
+//*************************************************************************************************************
+
+void SparseNetwork::appendEdges(const VectorXd& vecWeights)
+{
+    int iNode = getNumberNodes();
+
+    QVector<QPair<int,float> > lEdges;
+    for(int k = 0; k < vecWeights.size(); ++k) {
+        if(k != iNode && std::fabs(vecWeights(k)) >= m_fThreshold) {
+            lEdges.append(QPair<int,float>(k, float(vecWeights(k))));
+        }
+    }
+
+    appendEdges(lEdges);
+}
+
+
+//*************************************************************************************************************
+
+void SparseNetwork::appendEdges(QVector<QPair<int,float> > lEdges)
+{
+    int iNode = getNumberNodes();
+
+    // Threshold and drop self loops before the top-k selection, so they do not take the place of a real edge
+    int iNKept = 0;
+    for(int k = 0; k < lEdges.size(); ++k) {
+        if(lEdges.at(k).first != iNode && std::fabs(lEdges.at(k).second) >= m_fThreshold) {
+            lEdges[iNKept++] = lEdges.at(k);
+        }
+    }
+    lEdges.resize(iNKept);
+
+    // Keep the k strongest edges
+    if(m_iTopK > 0 && lEdges.size() > m_iTopK) {
+        std::partial_sort(lEdges.begin(), lEdges.begin() + m_iTopK, lEdges.end(), strongerEdge);
+        lEdges.resize(m_iTopK);
+    }
+
+    std::sort(lEdges.begin(), lEdges.end(), lowerEndNode);
+
+    for(int k = 0; k < lEdges.size(); ++k) {
+        m_vecEndNodes.append(lEdges.at(k).first);
+        m_vecWeights.append(lEdges.at(k).second);
+    }
+    m_vecRowPtr.append(m_vecEndNodes.size());
+}
+
+
+//*************************************************************************************************************
+
+QString SparseNetwork::getConnectivityMethod() const
+{
+    return m_sConnectivityMethod;
+}
+
+
+//*************************************************************************************************************
+
+int SparseNetwork::getNumberNodes() const
+{
+    return m_vecRowPtr.size() - 1;
+}
+
+
+//*************************************************************************************************************
+
+int SparseNetwork::getNumberEdges() const
+{
+    return m_vecEndNodes.size();
+}
+
+
+//*************************************************************************************************************
+
+const MatrixX3f& SparseNetwork::getNodePositions() const
+{
+    return m_matNodePositions;
+}
+
+
+//*************************************************************************************************************
+
+const QVector<int>& SparseNetwork::getRowPointers() const
+{
+    return m_vecRowPtr;
+}
+
+
+//*************************************************************************************************************
+
+const QVector<int>& SparseNetwork::getEndNodes() const
+{
+    return m_vecEndNodes;
+}
+
+
+//*************************************************************************************************************
+
+const QVector<float>& SparseNetwork::getWeights() const
+{
+    return m_vecWeights;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXi SparseNetwork::getEdgeIndices(float fThreshold) const
+{
+    int iNNodes = getNumberNodes();
+
+    // Count first, so the index matrix is allocated once
+    int iNLines = 0;
+    for(int i = 0; i < iNNodes; ++i) {
+        for(int e = m_vecRowPtr.at(i); e < m_vecRowPtr.at(i+1); ++e) {
+            if(m_vecEndNodes.at(e) != i && std::fabs(m_vecWeights.at(e)) >= fThreshold) {
+                ++iNLines;
+            }
+        }
+    }
+
+    MatrixXi matLines(iNLines, 2);
+    int iLine = 0;
+    for(int i = 0; i < iNNodes; ++i) {
+        for(int e = m_vecRowPtr.at(i); e < m_vecRowPtr.at(i+1); ++e) {
+            if(m_vecEndNodes.at(e) != i && std::fabs(m_vecWeights.at(e)) >= fThreshold) {
+                matLines(iLine,0) = i;
+                matLines(iLine,1) = m_vecEndNodes.at(e);
+                ++iLine;
+            }
+        }
+    }
+
+    return matLines;
+}
+
+
+//*************************************************************************************************************
+
+SparseMatrix<float, RowMajor> SparseNetwork::getConnectivityMatrix() const
+{
+    int iNNodes = getNumberNodes();
+
+    std::vector<Triplet<float> > tripletList;
+    tripletList.reserve(getNumberEdges());
+    for(int i = 0; i < iNNodes; ++i) {
+        for(int e = m_vecRowPtr.at(i); e < m_vecRowPtr.at(i+1); ++e) {
+            if(m_vecEndNodes.at(e) < iNNodes) {
+                tripletList.push_back(Triplet<float>(i, m_vecEndNodes.at(e), m_vecWeights.at(e)));
+            }
+        }
+    }
+
+    SparseMatrix<float, RowMajor> matConnectivity(iNNodes, iNNodes);
+    matConnectivity.setFromTriplets(tripletList.begin(), tripletList.end());
+
+    return matConnectivity;
+}
@@ -0,0 +1,312 @@
+//=============================================================================================================
+/**
+* @file     sparsenetwork.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     SparseNetwork class declaration.
+*
+*/
+
+#ifndef SPARSENETWORK_H
+#define SPARSENETWORK_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../connectivity_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+#include <QPair>
+#include <QString>
+#include <QMetaType>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE CONNECTIVITYLIB
+//=============================================================================================================
+
+namespace CONNECTIVITYLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// CONNECTIVITYLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+class Network;
+
+
+//=============================================================================================================
+/**
+* Compact network representation for large (e.g. source level) networks. The node positions are kept in one matrix
+* and the edges of one frequency bin/time instance in compressed sparse row (CSR) form with float weights. Edges are
+* pruned while they are appended: only edges with an absolute weight of at least the threshold are kept and, if set,
+* only the k strongest edges per start node. The outgoing edges of a node are sorted by their end node.
+*
+* @brief Compact CSR network with threshold and top-k pruning.
+*/
+class CONNECTIVITYSHARED_EXPORT SparseNetwork
+{
+
+public:
+    typedef QSharedPointer<SparseNetwork> SPtr;            /**< Shared pointer type for SparseNetwork. */
+    typedef QSharedPointer<const SparseNetwork> ConstSPtr; /**< Const shared pointer type for SparseNetwork. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a SparseNetwork object.
+    *
+    * @param[in] sConnectivityMethod    The connectivity measure method used to create the data of this network structure.
+    * @param[in] fThreshold             Edges with an absolute weight below this threshold are dropped.
+    * @param[in] iTopK                  Keep only the iTopK strongest edges per start node. Values below 1 keep all edges.
+    */
+    explicit SparseNetwork(const QString& sConnectivityMethod = "Unknown",
+                           float fThreshold = 0.0f,
+                           int iTopK = -1);
+
+    //=========================================================================================================
+    /**
+    * Creates a sparse network from a network.
+    *
+    * @param[in] network        The network.
+    * @param[in] fThreshold     Edges with an absolute weight below this threshold are dropped.
+    * @param[in] iTopK          Keep only the iTopK strongest edges per start node. Values below 1 keep all edges.
+    * @param[in] idxRow         The row of the edge weights to use, e.g. the frequency bin. Default is 0.
+    * @param[in] idxCol         The column of the edge weights to use, e.g. the instance in time. Default is 0.
+    *
+    * @return The sparse network.
+    */
+    static SparseNetwork fromNetwork(const Network& network,
+                                     float fThreshold = 0.0f,
+                                     int iTopK = -1,
+                                     int idxRow = 0,
+                                     int idxCol = 0);
+
+    //=========================================================================================================
+    /**
+    * Creates a sparse network directly from the output of a metric's compute function, e.g.
+    * PhaseLagIndex::computePLI, without creating any NetworkNode or NetworkEdge objects.
+    *
+    * @param[in] vecConnectivity        The connectivity per seed, targets x frequencies.
+    * @param[in] matVert                The node positions.
+    * @param[in] sConnectivityMethod    The connectivity measure method.
+    * @param[in] fThreshold             Edges with an absolute weight below this threshold are dropped.
+    * @param[in] iTopK                  Keep only the iTopK strongest edges per start node. Values below 1 keep all edges.
+    * @param[in] iFreq                  The frequency column to use. Default is 0.
+    *
+    * @return The sparse network.
+    */
+    static SparseNetwork fromConnectivity(const QVector<Eigen::MatrixXd>& vecConnectivity,
+                                          const Eigen::MatrixX3f& matVert,
+                                          const QString& sConnectivityMethod,
+                                          float fThreshold = 0.0f,
+                                          int iTopK = -1,
+                                          int iFreq = 0);
+
+    //=========================================================================================================
+    /**
+    * Appends a node and its outgoing edges. The node gets the next free id. The edges are pruned before they are
+    * stored, self loops are dropped.
+    *
+    * @param[in] vecVert        The node position.
+    * @param[in] vecWeights     The weights of the edges to all end nodes, indexed by the end node id.
+    */
+    void appendNode(const Eigen::RowVector3f& vecVert, const Eigen::VectorXd& vecWeights);
+
+    //=========================================================================================================
+    /**
+    * Appends a node and its outgoing edges. The node gets the next free id. The edges are pruned before they are
+    * stored, self loops are dropped.
+    *
+    * @param[in] vecVert        The node position.
+    * @param[in] lEdges         The end node id and the weight of each outgoing edge.
+    */
+    void appendNode(const Eigen::RowVector3f& vecVert, QVector<QPair<int,float> > lEdges);
+
+    //=========================================================================================================
+    /**
+    * Returns the connectivity measure method used to create the data of this network structure.
+    *
+    * @return   The connectivity measure method used to create the data of this network structure.
+    */
+    QString getConnectivityMethod() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of nodes.
+    *
+    * @return The number of nodes.
+    */
+    int getNumberNodes() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of stored edges.
+    *
+    * @return The number of edges.
+    */
+    int getNumberEdges() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the node positions, one row per node.
+    *
+    * @return The node positions.
+    */
+    const Eigen::MatrixX3f& getNodePositions() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the CSR row pointers. The outgoing edges of node i are stored at [ptr(i), ptr(i+1)).
+    *
+    * @return The row pointers, one more than the number of nodes.
+    */
+    const QVector<int>& getRowPointers() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the end node of each edge.
+    *
+    * @return The end node ids.
+    */
+    const QVector<int>& getEndNodes() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the weight of each edge.
+    *
+    * @return The edge weights.
+    */
+    const QVector<float>& getWeights() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the start and end node of all edges between different nodes with an absolute weight of at least
+    * fThreshold, one edge per row. This is directly usable as line indices for rendering.
+    *
+    * @param[in] fThreshold     The threshold applied on top of the construction pruning.
+    *
+    * @return The start (first column) and end node (second column) of the edges.
+    */
+    Eigen::MatrixXi getEdgeIndices(float fThreshold = 0.0f) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the connectivity matrix for this network structure.
+    *
+    * @return    The sparse connectivity matrix, start nodes in rows.
+    */
+    Eigen::SparseMatrix<float, Eigen::RowMajor> getConnectivityMatrix() const;
+
+protected:
+    //=========================================================================================================
+    /**
+    * Allocates the node positions and the edge storage once. The positions of the reserved nodes are zero until
+    * they are set, so all reserved nodes have to be appended.
+    *
+    * @param[in] iNNodes        The number of nodes.
+    * @param[in] iNEdges        The expected number of edges.
+    */
+    void reserve(int iNNodes, int iNEdges);
+
+    //=========================================================================================================
+    /**
+    * Sets the position of the next node, growing the positions if they were not reserved.
+    *
+    * @param[in] vecVert        The node position.
+    */
+    void appendPosition(const Eigen::RowVector3f& vecVert);
+
+    //=========================================================================================================
+    /**
+    * Prunes and appends the outgoing edges of the next node without touching its position.
+    *
+    * @param[in] vecWeights     The weights of the edges to all end nodes, indexed by the end node id.
+    */
+    void appendEdges(const Eigen::VectorXd& vecWeights);
+
+    //=========================================================================================================
+    /**
+    * Prunes and appends the outgoing edges of the next node without touching its position.
+    *
+    * @param[in] lEdges         The end node id and the weight of each outgoing edge.
+    */
+    void appendEdges(QVector<QPair<int,float> > lEdges);
+
+    QString                 m_sConnectivityMethod;      /**< The connectivity measure method used to create the data of this network structure.*/
+    float                   m_fThreshold;               /**< The threshold for the absolute edge weights.*/
+    int                     m_iTopK;                    /**< The maximum number of edges per start node.*/
+
+    Eigen::MatrixX3f        m_matNodePositions;         /**< The node positions.*/
+    QVector<int>            m_vecRowPtr;                /**< The CSR row pointers.*/
+    QVector<int>            m_vecEndNodes;              /**< The end node of each edge.*/
+    QVector<float>          m_vecWeights;               /**< The weight of each edge.*/
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+
+} // namespace CONNECTIVITYLIB
+
+#ifndef metatype_sparsenetworks
+#define metatype_sparsenetworks
+Q_DECLARE_METATYPE(CONNECTIVITYLIB::SparseNetwork);
+#endif
+
+#endif // SPARSENETWORK_H
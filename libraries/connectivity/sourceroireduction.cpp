@@ -0,0 +1,328 @@
+//=============================================================================================================
+/**
+* @file     sourceroireduction.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     SourceRoiReduction class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "sourceroireduction.h"
+
+#include "connectivitysettings.h"
+
+#include <fs/annotationset.h>
+#include <fs/surfaceset.h>
+
+#include <mne/mne_sourcespace.h>
+#include <mne/mne_sourceestimate.h>
+
+#include <vector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QSet>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/SVD>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace CONNECTIVITYLIB;
+using namespace Eigen;
+using namespace FSLIB;
+using namespace MNELIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+struct RoiReductionJob {
+    const SparseMatrix<double, RowMajor>*   pReduction;     /**< The reduction matrix. */
+    const MatrixXd*                         pSourceData;    /**< The source data of the trial. */
+    MatrixXd                                matRoiData;     /**< The resulting ROI data. */
+};
+
+void computeRoiReduction(RoiReductionJob& job)
+{
+    job.matRoiData = (*job.pReduction) * (*job.pSourceData);
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+SourceRoiReduction::SourceRoiReduction()
+{
+}
+
+
+//*************************************************************************************************************
+
+bool SourceRoiReduction::init(const MNESourceSpace& sourceSpace,
+                              const QList<Label>& lLabels,
+                              ReductionMode mode,
+                              const MatrixXd& matCalibration)
+{
+    m_lLabels.clear();
+    m_matRoiPositions.resize(0,3);
+
+    if(sourceSpace.size() < 2) {
+        qWarning() << "SourceRoiReduction::init - Source space needs two hemispheres";
+        m_matReduction.resize(0,0);
+        return false;
+    }
+
+    int iNSources = sourceSpace[0].vertno.size() + sourceSpace[1].vertno.size();
+
+    if(mode == PcaFlip && matCalibration.rows() != iNSources) {
+        qWarning() << "SourceRoiReduction::init - PcaFlip needs calibration data with" << iNSources << "rows";
+        m_matReduction.resize(0,0);
+        return false;
+    }
+
+    std::vector<Triplet<double> > tripletList;
+    QList<RowVector3f> lPositions;
+
+    for(int l = 0; l < lLabels.size(); ++l) {
+        const Label& label = lLabels.at(l);
+        if(label.hemi != 0 && label.hemi != 1) {
+            qWarning() << "SourceRoiReduction::init - Unknown hemisphere of label" << label.name;
+            continue;
+        }
+
+        const MNEHemisphere& hemisphere = sourceSpace[label.hemi];
+        int iOffset = label.hemi == 0 ? 0 : sourceSpace[0].vertno.size();
+
+        // The sources of the label, as rows of the source data
+        QSet<int> setLabelVertices;
+        for(int i = 0; i < label.vertices.size(); ++i) {
+            setLabelVertices.insert(label.vertices(i));
+        }
+
+        QList<int> lSourceIdx;
+        for(int i = 0; i < hemisphere.vertno.size(); ++i) {
+            if(setLabelVertices.contains(hemisphere.vertno(i))) {
+                lSourceIdx.append(i);
+            }
+        }
+
+        if(lSourceIdx.isEmpty()) {
+            qDebug() << "SourceRoiReduction::init - Label" << label.name << "contains no sources, skipping";
+            continue;
+        }
+
+        int iN = lSourceIdx.size();
+
+        // Align the source normals to the dominant direction of the label
+        MatrixX3d matNormals(iN, 3);
+        RowVector3f vecPosition = RowVector3f::Zero();
+        for(int i = 0; i < iN; ++i) {
+            int iVertex = hemisphere.vertno(lSourceIdx.at(i));
+            matNormals.row(i) = hemisphere.nn.row(iVertex).cast<double>();
+            vecPosition += hemisphere.rr.row(iVertex);
+        }
+        vecPosition /= iN;
+
+        VectorXd vecFlip = VectorXd::Ones(iN);
+        if(mode != Mean) {
+            JacobiSVD<MatrixX3d> svd(matNormals, ComputeFullV);
+            VectorXd vecDots = matNormals * svd.matrixV().col(0);
+            if(vecDots.mean() < 0) {
+                vecDots *= -1.0;
+            }
+            vecFlip = vecDots.cwiseSign();
+        }
+
+        VectorXd vecWeights;
+        if(mode == PcaFlip) {
+            // The first left singular vector of the label data, from the eigen decomposition of data * data'
+            MatrixXd matLabelData(iN, matCalibration.cols());
+            for(int i = 0; i < iN; ++i) {
+                matLabelData.row(i) = matCalibration.row(iOffset + lSourceIdx.at(i));
+            }
+
+            SelfAdjointEigenSolver<MatrixXd> eig(matLabelData * matLabelData.transpose());
+            VectorXd vecEigenValues = eig.eigenvalues().cwiseMax(0.0);
+            double dS0 = std::sqrt(vecEigenValues(iN - 1));
+            VectorXd vecU0 = eig.eigenvectors().col(iN - 1);
+
+            if(dS0 > 0.0) {
+                // tc = sign * norm(s) / sqrt(n) * V0, with V0 = U0' * data / s0
+                double dSign = vecU0.dot(vecFlip) < 0.0 ? -1.0 : 1.0;
+                double dScale = std::sqrt(vecEigenValues.sum()) / std::sqrt(double(iN));
+                vecWeights = (dSign * dScale / dS0) * vecU0;
+            } else {
+                vecWeights = VectorXd::Zero(iN);
+            }
+        } else {
+            vecWeights = vecFlip / double(iN);
+        }
+
+        int iRoi = m_lLabels.size();
+        for(int i = 0; i < iN; ++i) {
+            tripletList.push_back(Triplet<double>(iRoi, iOffset + lSourceIdx.at(i), vecWeights(i)));
+        }
+
+        m_lLabels.append(label);
+        lPositions.append(vecPosition);
+    }
+
+    m_matReduction.resize(m_lLabels.size(), iNSources);
+    m_matReduction.setFromTriplets(tripletList.begin(), tripletList.end());
+
+    m_matRoiPositions.resize(lPositions.size(), 3);
+    for(int i = 0; i < lPositions.size(); ++i) {
+        m_matRoiPositions.row(i) = lPositions.at(i);
+    }
+
+    return !m_lLabels.isEmpty();
+}
+
+
+//*************************************************************************************************************
+
+bool SourceRoiReduction::init(const MNESourceSpace& sourceSpace,
+                              const AnnotationSet& annotationSet,
+                              const SurfaceSet& surfaceSet,
+                              ReductionMode mode,
+                              const MatrixXd& matCalibration)
+{
+    QList<Label> lLabels;
+    QList<RowVector4i> lLabelRGBAs;
+
+    if(!annotationSet.toLabels(surfaceSet, lLabels, lLabelRGBAs)) {
+        qWarning() << "SourceRoiReduction::init - Could not generate labels from the annotation set";
+        return false;
+    }
+
+    return init(sourceSpace, lLabels, mode, matCalibration);
+}
+
+
+//*************************************************************************************************************
+
+const SparseMatrix<double, RowMajor>& SourceRoiReduction::getReductionMatrix() const
+{
+    return m_matReduction;
+}
+
+
+//*************************************************************************************************************
+
+const QList<Label>& SourceRoiReduction::getLabels() const
+{
+    return m_lLabels;
+}
+
+
+//*************************************************************************************************************
+
+const MatrixX3f& SourceRoiReduction::getRoiPositions() const
+{
+    return m_matRoiPositions;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd SourceRoiReduction::reduce(const MatrixXd& matSourceData) const
+{
+    if(matSourceData.rows() != m_matReduction.cols()) {
+        qWarning() << "SourceRoiReduction::reduce - Expected" << m_matReduction.cols() << "sources, got" << matSourceData.rows();
+        return MatrixXd();
+    }
+
+    return m_matReduction * matSourceData;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd SourceRoiReduction::reduce(const MNESourceEstimate& sourceEstimate) const
+{
+    return reduce(sourceEstimate.data);
+}
+
+
+//*************************************************************************************************************
+
+void SourceRoiReduction::reduce(const QList<MatrixXd>& lSourceTrials, ConnectivitySettings& settings) const
+{
+    QList<RoiReductionJob> lJobs;
+    for(int i = 0; i < lSourceTrials.size(); ++i) {
+        if(lSourceTrials.at(i).rows() != m_matReduction.cols()) {
+            qWarning() << "SourceRoiReduction::reduce - Trial" << i << "has" << lSourceTrials.at(i).rows() << "instead of" << m_matReduction.cols() << "sources, skipping";
+            continue;
+        }
+
+        RoiReductionJob job;
+        job.pReduction = &m_matReduction;
+        job.pSourceData = &lSourceTrials.at(i);
+        lJobs.append(job);
+    }
+
+    QtConcurrent::blockingMap(lJobs, computeRoiReduction);
+
+    settings.m_matDataList.clear();
+    for(int i = 0; i < lJobs.size(); ++i) {
+        settings.m_matDataList.append(lJobs.at(i).matRoiData);
+    }
+    settings.m_matNodePositions = m_matRoiPositions;
+}
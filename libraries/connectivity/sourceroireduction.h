@@ -0,0 +1,237 @@
+//=============================================================================================================
+/**
+* @file     sourceroireduction.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     SourceRoiReduction class declaration.
+*
+*/
+
+#ifndef SOURCEROIREDUCTION_H
+#define SOURCEROIREDUCTION_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "connectivity_global.h"
+
+#include <fs/label.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+namespace FSLIB {
+    class AnnotationSet;
+    class SurfaceSet;
+}
+
+namespace MNELIB {
+    class MNESourceSpace;
+    class MNESourceEstimate;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE CONNECTIVITYLIB
+//=============================================================================================================
+
+namespace CONNECTIVITYLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// CONNECTIVITYLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+class ConnectivitySettings;
+
+
+//=============================================================================================================
+/**
+* Reduces source time courses to one signal per label (ROI) before the connectivity estimation. The reduction is
+* linear, so it is set up once as a sparse ROIs x sources matrix and applied to every trial as a single sparse
+* product. The supported modes follow mne-python's extract_label_time_course:
+*
+* - Mean: The mean over the label sources.
+* - MeanFlip: The mean after flipping the sign of sources whose normal points against the dominant label direction.
+* - PcaFlip: The first principal component of the label sources, scaled by the RMS of the singular values and
+*   signed to match the flip vector. The component is estimated once from calibration data.
+*
+* @brief Label/ROI reduction of source time courses for connectivity estimation.
+*/
+class CONNECTIVITYSHARED_EXPORT SourceRoiReduction
+{
+
+public:
+    typedef QSharedPointer<SourceRoiReduction> SPtr;            /**< Shared pointer type for SourceRoiReduction. */
+    typedef QSharedPointer<const SourceRoiReduction> ConstSPtr; /**< Const shared pointer type for SourceRoiReduction. */
+
+    enum ReductionMode {
+        Mean,
+        MeanFlip,
+        PcaFlip
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a SourceRoiReduction object. Call init(...) before reducing data.
+    */
+    explicit SourceRoiReduction();
+
+    //=========================================================================================================
+    /**
+    * Sets up the reduction matrix for the given labels. Labels which do not contain any source are skipped.
+    *
+    * @param[in] sourceSpace        The source space of the source estimates. Rows are ordered lh vertno, rh vertno.
+    * @param[in] lLabels            The labels.
+    * @param[in] mode               The reduction mode.
+    * @param[in] matCalibration     Source data (sources x samples) to estimate the principal components. Only
+    *                               needed for PcaFlip.
+    *
+    * @return True if at least one label contains sources, false otherwise.
+    */
+    bool init(const MNELIB::MNESourceSpace& sourceSpace,
+              const QList<FSLIB::Label>& lLabels,
+              ReductionMode mode = MeanFlip,
+              const Eigen::MatrixXd& matCalibration = Eigen::MatrixXd());
+
+    //=========================================================================================================
+    /**
+    * Sets up the reduction matrix for the labels of an annotation set.
+    *
+    * @param[in] sourceSpace        The source space of the source estimates.
+    * @param[in] annotationSet      The annotation set providing the labels.
+    * @param[in] surfaceSet         The surfaces the annotation set refers to.
+    * @param[in] mode               The reduction mode.
+    * @param[in] matCalibration     Source data (sources x samples) to estimate the principal components. Only
+    *                               needed for PcaFlip.
+    *
+    * @return True if at least one label contains sources, false otherwise.
+    */
+    bool init(const MNELIB::MNESourceSpace& sourceSpace,
+              const FSLIB::AnnotationSet& annotationSet,
+              const FSLIB::SurfaceSet& surfaceSet,
+              ReductionMode mode = MeanFlip,
+              const Eigen::MatrixXd& matCalibration = Eigen::MatrixXd());
+
+    //=========================================================================================================
+    /**
+    * Returns the reduction matrix.
+    *
+    * @return The ROIs x sources reduction matrix.
+    */
+    const Eigen::SparseMatrix<double, Eigen::RowMajor>& getReductionMatrix() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the labels which are represented by the rows of the reduction matrix.
+    *
+    * @return The used labels.
+    */
+    const QList<FSLIB::Label>& getLabels() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the ROI positions, the mean position of the label sources.
+    *
+    * @return The ROI positions.
+    */
+    const Eigen::MatrixX3f& getRoiPositions() const;
+
+    //=========================================================================================================
+    /**
+    * Reduces source data of one trial.
+    *
+    * @param[in] matSourceData      The source data, sources x samples.
+    *
+    * @return The ROI data, ROIs x samples.
+    */
+    Eigen::MatrixXd reduce(const Eigen::MatrixXd& matSourceData) const;
+
+    //=========================================================================================================
+    /**
+    * Reduces a source estimate.
+    *
+    * @param[in] sourceEstimate     The source estimate.
+    *
+    * @return The ROI data, ROIs x samples.
+    */
+    Eigen::MatrixXd reduce(const MNELIB::MNESourceEstimate& sourceEstimate) const;
+
+    //=========================================================================================================
+    /**
+    * Reduces all trials in parallel and hands them to the connectivity settings together with the ROI positions,
+    * so the existing metrics run on ROI level.
+    *
+    * @param[in] lSourceTrials      The source data of all trials, sources x samples each.
+    * @param[out] settings          The connectivity settings whose data and node positions are set.
+    */
+    void reduce(const QList<Eigen::MatrixXd>& lSourceTrials, ConnectivitySettings& settings) const;
+
+protected:
+    Eigen::SparseMatrix<double, Eigen::RowMajor>    m_matReduction;         /**< The ROIs x sources reduction matrix. */
+    QList<FSLIB::Label>                             m_lLabels;              /**< The labels of the ROIs. */
+    Eigen::MatrixX3f                                m_matRoiPositions;      /**< The ROI positions. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+
+} // namespace CONNECTIVITYLIB
+
+#endif // SOURCEROIREDUCTION_H
@@ -49,6 +49,9 @@
 //=============================================================================================================
 
 #include <iostream>
+#include <functional>
+#include <algorithm>
+#include <random>
 
 
 //*************************************************************************************************************
@@ -58,6 +61,9 @@
 
 #include <QFile>
 #include <QDebug>
+#include <QFuture>
+#include <QtConcurrent>
+#include <QElapsedTimer>
 
 
 //*************************************************************************************************************
@@ -77,6 +83,9 @@ using namespace Eigen;
 
 Deep::Deep(QObject *parent)
 : QObject(parent)
+, m_iCancelTraining(0)
+, m_bTrainingShuffle(false)
+, m_bTrainingNormalization(false)
 {
 }
 
@@ -273,6 +282,7 @@ FunctionPtr Deep::getModel()
 void Deep::setModel(FunctionPtr &model)
 {
     m_pModel = model;
+    clearEvalContexts();
 }
 
 
@@ -289,6 +299,7 @@ bool Deep::loadModel(const QString& modelFileName, const DeviceDescriptor &devic
     fprintf(stderr, "Loading model %s.\n",modelFileName.toUtf8().constData());
 
     m_pModel = Function::Load(modelFileName.toStdWString(), device);
+    clearEvalContexts();
 
     return true;
 }
@@ -315,120 +326,244 @@ bool Deep::evalModel(const MatrixXf& input, MatrixXf& output, const DeviceDescri
 
     fprintf(stderr, "Evaluate model on device=%d\n", device.Id());
 
-    // Run evaluation in parallel.
-//    std::vector<std::thread> threadList(threadCount);
-//    for (int th = 0; th < threadCount; ++th)
-//    {
-//        threadList[th] = std::thread(runEvaluation, m_pModelFunction_v2->Clone(), device,inputVar,inputValue,outputVar,outputValue);
-//    }
-
-//    for (int th = 0; th < threadCount; ++th)
-//    {
-//        threadList[th].join();
-//        fprintf(stderr, "thread %d joined.\n", th);
-//        fflush(stderr);
-//    }
-
-    //
-    // Input
-    //
-    const std::wstring inputNodeName = L"features";
-
-    Variable inputVar;
-    if (!getInputVariableByName(m_pModel, inputNodeName, inputVar)) {
-        fprintf(stderr, "Input variable %S is not available.\n", inputNodeName.c_str());
-        throw("Input variable not found error.");
+    if(!prepareEvalContexts(1)) {
+        throw("Input or output variable not found error.");
     }
 
+    EvalContext& context = m_vecEvalContexts[0];
+
     //Check if input data size matches the number of features
-    if (inputVar.Shape().TotalSize() != static_cast<size_t>(input.cols())) {
-            fprintf(stderr, "Input data size: %d, do not match feature size: %d.\n", static_cast<int>(input.rows()), static_cast<int>(inputVar.Shape().TotalSize()));
+    if (context.inputVar.Shape().TotalSize() != static_cast<size_t>(input.cols())) {
+            fprintf(stderr, "Input data size: %d, do not match feature size: %d.\n", static_cast<int>(input.cols()), static_cast<int>(context.inputVar.Shape().TotalSize()));
             throw("Input data size do not match input feature size.");
     }
 
-    // Evaluate the network in several runs
-    size_t numSamples = static_cast<size_t>(input.rows());
-    size_t numFeatures = static_cast<size_t>(input.cols());
+    output.resize(input.rows(), context.outputVar.Shape().TotalSize());
 
-    std::vector<float> inputData(numFeatures * numSamples);
-    size_t dataIndex = 0;
-    for (int m = 0; m < numSamples; ++m) {
-        for (int n = 0; n < numFeatures; ++n) {
-//            printf("%d: %f =? %f\n",dataIndex,input(m,n),static_cast<float>(dataIndex % 255));
-            inputData[dataIndex++] = input(m,n);
-        }
+    // Evaluate all samples in one minibatch
+    evalRows(context, input, 0, static_cast<int>(input.rows()), output, device);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool Deep::evalModelBatch(const QList<MatrixXf>& inputs, QList<MatrixXf>& outputs, const DeviceDescriptor& device)
+{
+    outputs.clear();
+
+    if(!prepareEvalContexts(1)) {
+        return false;
     }
 
-//    NDShape inputShape = inputVar.Shape().AppendShape({1, numSamples});
-//    ValuePtr inputValue = MakeSharedObject<Value>(MakeSharedObject<NDArrayView>(inputShape, inputData, true));
-    ValuePtr inputValue = Value::CreateBatch(inputVar.Shape(), inputData, device);
+    EvalContext& context = m_vecEvalContexts[0];
+    size_t numFeatures = context.inputVar.Shape().TotalSize();
 
+    int numSamples = 0;
+    for(int i = 0; i < inputs.size(); ++i) {
+        if(static_cast<size_t>(inputs[i].cols()) != numFeatures) {
+            fprintf(stderr, "Input %d with data size %d does not match feature size %d.\n", i, static_cast<int>(inputs[i].cols()), static_cast<int>(numFeatures));
+            return false;
+        }
+        numSamples += inputs[i].rows();
+    }
 
+    if(numSamples == 0) {
+        for(int i = 0; i < inputs.size(); ++i) {
+            outputs.append(MatrixXf(0, context.outputVar.Shape().TotalSize()));
+        }
+        return true;
+    }
 
     //
-    // Output
+    // Stack the inputs into one minibatch
     //
-    const std::wstring outputNodeName = L"labels";//L"out.z";
-
-    Variable outputVar;
-    if (!getOutputVaraiableByName(m_pModel, outputNodeName, outputVar)) {
-        fprintf(stderr, "Output variable %S is not available.\n", outputNodeName.c_str());
-        throw("Output variable not found error.");
+    MatrixXf input(numSamples, numFeatures);
+    int startRow = 0;
+    for(int i = 0; i < inputs.size(); ++i) {
+        input.middleRows(startRow, inputs[i].rows()) = inputs[i];
+        startRow += inputs[i].rows();
     }
 
-    ValuePtr outputValue;
+    MatrixXf output(numSamples, context.outputVar.Shape().TotalSize());
+    evalRows(context, input, 0, numSamples, output, device);
 
     //
-    // Evaluate
+    // Split the minibatch output
     //
-    runEvaluation(m_pModel,inputVar,inputValue,outputVar,outputValue,device);
+    startRow = 0;
+    for(int i = 0; i < inputs.size(); ++i) {
+        outputs.append(output.middleRows(startRow, inputs[i].rows()));
+        startRow += inputs[i].rows();
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool Deep::evalModelParallel(const MatrixXf& input, MatrixXf& output, int threadCount)
+{
+    int numSamples = static_cast<int>(input.rows());
+    threadCount = qBound(1, threadCount, qMax(1, numSamples));
+
+    if(!prepareEvalContexts(threadCount)) {
+        return false;
+    }
+
+    if (m_vecEvalContexts[0].inputVar.Shape().TotalSize() != static_cast<size_t>(input.cols())) {
+        fprintf(stderr, "Input data size: %d, do not match feature size: %d.\n", static_cast<int>(input.cols()), static_cast<int>(m_vecEvalContexts[0].inputVar.Shape().TotalSize()));
+        return false;
+    }
+
+    output.resize(numSamples, m_vecEvalContexts[0].outputVar.Shape().TotalSize());
+
+    if(numSamples == 0) {
+        return true;
+    }
 
     //
-    // Put the output together
+    // Evaluate one block of samples per thread, each with its own model clone
     //
-    NDShape outputShape = outputVar.Shape().AppendShape({1, numSamples});
-    std::vector<float> outputData(outputShape.TotalSize());
-    NDArrayViewPtr cpuArrayOutput = MakeSharedObject<NDArrayView>(outputShape, outputData, false);
-    cpuArrayOutput->CopyFrom(*outputValue->Data());
+    int blockSize = (numSamples + threadCount - 1) / threadCount;
+    QList<QFuture<void> > futures;
+
+    for(int i = 0; i < threadCount; ++i) {
+        int startRow = i * blockSize;
+        int numRows = qMin(blockSize, numSamples - startRow);
+        if(numRows <= 0) {
+            break;
+        }
 
-    // consistency check
-    assert(outputData.size() == outputVar.Shape()[0] * numSamples);
+        futures.append(QtConcurrent::run(std::bind(evalRows,
+                                                   std::ref(m_vecEvalContexts[i]),
+                                                   std::cref(input),
+                                                   startRow,
+                                                   numRows,
+                                                   std::ref(output),
+                                                   DeviceDescriptor::CPUDevice())));
+    }
 
-    dataIndex = 0;
-    size_t outputDim = outputVar.Shape()[0];
-    output.resize(numSamples, outputDim);
-    for (size_t i = 0; i < numSamples; i++)
-    {
-        for (size_t j = 0; j < outputDim; j++)
-        {
-//            fprintf(stderr, "%f ", output(i,j));
-            output(i,j) = outputData[dataIndex++];
-        }
+    for(int i = 0; i < futures.size(); ++i) {
+        futures[i].waitForFinished();
     }
+
     return true;
 }
 
 
+//*************************************************************************************************************
+
+DeviceDescriptor Deep::selectDevice(int gpuId)
+{
+    if(gpuId < 0) {
+        return DeviceDescriptor::CPUDevice();
+    }
+
+    const std::vector<DeviceDescriptor>& devices = DeviceDescriptor::AllDevices();
+    for(size_t i = 0; i < devices.size(); ++i) {
+        if(devices[i].Type() == DeviceKind::GPU && devices[i].Id() == static_cast<unsigned int>(gpuId)) {
+            return devices[i];
+        }
+    }
+
+    fprintf(stderr, "GPU %d is not available, using the CPU.\n", gpuId);
+
+    return DeviceDescriptor::CPUDevice();
+}
+
+
+
 //*************************************************************************************************************
 
 bool Deep::trainModel(const MatrixXf &input, const MatrixXf &targets, QVector<double> &loss, QVector<double> &error, int minibatch_size, const DeviceDescriptor &device)
 {
+    m_iCancelTraining = 0;
+
+    if(minibatch_size <= 0 || input.rows() != targets.rows()) {
+        fprintf(stderr, "Minibatch size (%d) is invalid or sample size of features (%d) and targets (%d) do not match.\n", minibatch_size, static_cast<int>(input.rows()), static_cast<int>(targets.rows()));
+        return false;
+    }
+
+    TrainingContext context;
+    if(!initTrainingContext(context)) {
+        return false;
+    }
+
+    if(static_cast<size_t>(input.cols()) != context.inputFeatures.Shape().TotalSize()
+            || static_cast<size_t>(targets.cols()) != context.outputLabels.Shape().TotalSize()) {
+        fprintf(stderr, "Input (%d) or target size (%d) do not match model feature (%d) or label size (%d).\n", static_cast<int>(input.cols()), static_cast<int>(targets.cols()), static_cast<int>(context.inputFeatures.Shape().TotalSize()), static_cast<int>(context.outputLabels.Shape().TotalSize()));
+        return false;
+    }
+
     int num_samples = input.rows();
     int num_minibatches_to_train = floor(num_samples / minibatch_size);
 
+    //
+    // Sample order and normalization
+    //
+    std::vector<int> order(num_samples);
+    for(int i = 0; i < num_samples; ++i) {
+        order[i] = i;
+    }
+
+    if(m_bTrainingShuffle) {
+        std::mt19937 generator(std::random_device{}());
+        std::shuffle(order.begin(), order.end(), generator);
+    }
+
+    RowVectorXf mean, invStd;
+    if(m_bTrainingNormalization && num_samples > 0) {
+        mean = input.colwise().mean();
+        invStd = ((input.rowwise() - mean).array().square().colwise().sum() / static_cast<float>(num_samples)).sqrt().matrix();
+        for(int i = 0; i < invStd.size(); ++i) {
+            invStd[i] = invStd[i] > 0.0f ? 1.0f / invStd[i] : 1.0f;
+        }
+    }
+
+    //
+    // Train, while the next minibatch is prepared in the background
+    //
+    Minibatch minibatches[2];
+    QFuture<void> nextMinibatch;
+
+    if(num_minibatches_to_train > 0) {
+        nextMinibatch = QtConcurrent::run(std::bind(prepareMinibatch, std::cref(input), std::cref(targets), std::cref(order),
+                                                    0, minibatch_size, std::cref(mean), std::cref(invStd), std::ref(minibatches[0])));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
     double loss_val, error_val;
 
     for(int i = 0; i < num_minibatches_to_train; ++i) {
+        nextMinibatch.waitForFinished();
 
-        trainMinibatch(input.block(i * minibatch_size, 0, minibatch_size, input.cols()),
-                       targets.block(i * minibatch_size, 0, minibatch_size, targets.cols()),
-                       loss_val, error_val,device);
+        if(i + 1 < num_minibatches_to_train) {
+            nextMinibatch = QtConcurrent::run(std::bind(prepareMinibatch, std::cref(input), std::cref(targets), std::cref(order),
+                                                        (i + 1) * minibatch_size, minibatch_size, std::cref(mean), std::cref(invStd), std::ref(minibatches[(i + 1) % 2])));
+        }
+
+        trainPreparedMinibatch(context, minibatches[i % 2], loss_val, error_val, device);
+
+        double samplesPerSecond = timer.elapsed() > 0 ? 1000.0 * (i + 1) * minibatch_size / timer.elapsed() : 0.0;
 
         if(i % 9 == 0)
-            qDebug() << "Iteration:" << i+1 << "; loss" << loss_val << "; error" << error_val;
+            qDebug() << "Iteration:" << i+1 << "; loss" << loss_val << "; error" << error_val << "; samples/s" << samplesPerSecond;
 
         loss.append(loss_val);
         error.append(error_val);
+
+        emit trainingProgress(i + 1, num_minibatches_to_train, loss_val, error_val, samplesPerSecond);
+
+        if(m_iCancelTraining.load()) {
+            nextMinibatch.waitForFinished();
+            qDebug() << "Training canceled after" << i+1 << "of" << num_minibatches_to_train << "minibatches.";
+            return false;
+        }
     }
 
     return true;
@@ -439,37 +574,11 @@ bool Deep::trainModel(const MatrixXf &input, const MatrixXf &targets, QVector<do
 
 bool Deep::trainMinibatch(const Eigen::MatrixXf& input, const Eigen::MatrixXf& targets, double& loss, double& error, const CNTK::DeviceDescriptor& device)
 {
-
-    if(!m_pModel) {
+    TrainingContext context;
+    if(!initTrainingContext(context)) {
         return false;
     }
 
-    FunctionPtr z = m_pModel;
-
-    //
-    // Input
-    //
-    const std::wstring inputNodeName = L"features";
-    Variable inputFeatures;
-    if (!getInputVariableByName(z, inputNodeName, inputFeatures)) {
-        fprintf(stderr, "Input variable %S is not available.\n", inputNodeName.c_str());
-        throw("Input variable not found error.");
-    }
-
-    //
-    // Output
-    //
-    Variable outputLabels = InputVariable({z->Output().Shape().TotalSize()}, DataType::Float, L"labels"); //z->Output();
-
-    FunctionPtr fctLoss = CrossEntropyWithSoftmax(z,outputLabels);
-    FunctionPtr fctEvalError = ClassificationError(z, outputLabels);
-
-    double learning_rate = 0.5;
-    LearningRateSchedule lr_schedule = LearningRateSchedule(learning_rate, LearningRateSchedule::UnitType::Minibatch);
-    std::vector<LearnerPtr> learner; learner.push_back(SGDLearner(z->Parameters(),lr_schedule));
-
-    TrainerPtr trainer = CreateTrainer(z,fctLoss,fctEvalError,learner);
-
     //
     // Consistency Checks
     //
@@ -483,58 +592,32 @@ bool Deep::trainMinibatch(const Eigen::MatrixXf& input, const Eigen::MatrixXf& t
         throw("Sample size do not match.");
     }
 
-    if(input.cols() != inputFeatures.Shape().TotalSize()) {
-        fprintf(stderr, "Input feature size (%d) do not match model feature size (%d).\n", static_cast<int>(input.cols()), static_cast<int>(inputFeatures.Shape().TotalSize()));
+    if(input.cols() != context.inputFeatures.Shape().TotalSize()) {
+        fprintf(stderr, "Input feature size (%d) do not match model feature size (%d).\n", static_cast<int>(input.cols()), static_cast<int>(context.inputFeatures.Shape().TotalSize()));
         throw("Sample size do not match.");
     }
 
-    if(targets.cols() != outputLabels.Shape().TotalSize()) {
-        fprintf(stderr, "Target size (%d) do not match model label size (%d).\n", static_cast<int>(targets.cols()), static_cast<int>(outputLabels.Shape().TotalSize()));
+    if(targets.cols() != context.outputLabels.Shape().TotalSize()) {
+        fprintf(stderr, "Target size (%d) do not match model label size (%d).\n", static_cast<int>(targets.cols()), static_cast<int>(context.outputLabels.Shape().TotalSize()));
         throw("Target size do not match.");
     }
 
     //
     // Prepare data
     //
-//    qDebug() << "inputFeatures.IsInput()" << inputFeatures.IsInput() << "inputFeatures.Shape().TotalSize()" << inputFeatures.Shape().TotalSize();
-//    qDebug() << "outputLabels.IsOutput()" << outputLabels.IsOutput() << "outputLabels.Shape().TotalSize()" << outputLabels.Shape().TotalSize();
-
-    size_t inputDim = inputFeatures.Shape().TotalSize();
-    size_t numOutputClasses = outputLabels.Shape().TotalSize();
-
-    std::vector<float> inputData(inputDim * batchSize);
-    //    for (size_t i = 0; i < inputData.size(); ++i)
-    //        inputData[i] = (float)rand() / RAND_MAX;
-    size_t dataIndex = 0;
-    for (int m = 0; m < batchSize; ++m) {
-        for (int n = 0; n < inputDim; ++n) {
-            inputData[dataIndex++] = input(m,n);
-        }
+    std::vector<int> order(batchSize);
+    for (size_t i = 0; i < batchSize; ++i) {
+        order[i] = static_cast<int>(i);
     }
-    ValuePtr inputDataValue = Value::CreateBatch(inputFeatures.Shape(), inputData, device);
-    //    std::unordered_map<Variable, ValuePtr> inputValues = { { inputVar, inputDataValue } };
 
-    std::vector<float> outputData(numOutputClasses * batchSize);
-    //    for (size_t i = 0; i < outputData.size(); ++i)
-    //        outputData[i] = (float)rand() / RAND_MAX;
-    dataIndex = 0;
-    for (int m = 0; m < batchSize; ++m) {
-        for (int n = 0; n < numOutputClasses; ++n) {
-            outputData[dataIndex++] = targets(m,n);
-        }
-    }
-    ValuePtr outputDataValue = Value::CreateBatch(outputLabels.Shape(), outputData, device);//    z->Output().Shape()
-    //    std::unordered_map<Variable, ValuePtr> outputValues = { { outputLabels, outputDataValue } };
-
-    std::unordered_map<Variable, ValuePtr> inOutValues = { { inputFeatures, inputDataValue }, { outputLabels, outputDataValue } };
+    Minibatch minibatch;
+    prepareMinibatch(input, targets, order, 0, static_cast<int>(batchSize), RowVectorXf(), RowVectorXf(), minibatch);
 
     //
     // Train the minibatch
     //
-    trainer->TrainMinibatch(inOutValues,device);
+    trainPreparedMinibatch(context, minibatch, loss, error, device);
 
-    loss = trainer->PreviousMinibatchLossAverage();
-    error = trainer->PreviousMinibatchEvaluationAverage();
 //    size_t minibatch_samples = trainer->PreviousMinibatchSampleCount();
 //    qDebug() << "Finished minibatch training: loss" << loss << "; error" << error << "; samples" << minibatch_samples;
 
@@ -547,9 +630,27 @@ bool Deep::trainMinibatch(const Eigen::MatrixXf& input, const Eigen::MatrixXf& t
 void Deep::cancelTraining()
 {
     qDebug() << "cancelTraining()";
+    m_iCancelTraining = 1;
+}
+
+
+//*************************************************************************************************************
+
+void Deep::setTrainingShuffle(bool shuffle)
+{
+    m_bTrainingShuffle = shuffle;
 }
 
 
+//*************************************************************************************************************
+
+void Deep::setTrainingNormalization(bool normalize)
+{
+    m_bTrainingNormalization = normalize;
+}
+
+
+
 //*************************************************************************************************************
 
 void Deep::print()
@@ -622,3 +723,186 @@ bool Deep::getOutputVaraiableByName(FunctionPtr model, std::wstring varName, Var
 {
     return getVariableByName(model->Outputs(), varName, var);
 }
+
+
+//*************************************************************************************************************
+
+bool Deep::initEvalContext(FunctionPtr model, EvalContext& context)
+{
+    context.model = model;
+
+    const std::wstring inputNodeName = L"features";
+    if (!getInputVariableByName(model, inputNodeName, context.inputVar)) {
+        fprintf(stderr, "Input variable %S is not available.\n", inputNodeName.c_str());
+        return false;
+    }
+
+    const std::wstring outputNodeName = L"labels";//L"out.z";
+    if (!getOutputVaraiableByName(model, outputNodeName, context.outputVar)) {
+        fprintf(stderr, "Output variable %S is not available.\n", outputNodeName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void Deep::evalRows(EvalContext& context, const MatrixXf& input, int startRow, int numRows, MatrixXf& output, const DeviceDescriptor& device)
+{
+    size_t numSamples = static_cast<size_t>(numRows);
+    size_t numFeatures = context.inputVar.Shape().TotalSize();
+    size_t outputDim = context.outputVar.Shape().TotalSize();
+
+    //
+    // Input, CNTK expects the features of one sample after another
+    //
+    if(context.inputData.size() < numFeatures * numSamples) {
+        context.inputData.resize(numFeatures * numSamples);
+    }
+
+    Map<Matrix<float, Dynamic, Dynamic, RowMajor> >(context.inputData.data(), numSamples, numFeatures) = input.middleRows(startRow, numRows);
+
+    NDArrayViewPtr inputView = MakeSharedObject<NDArrayView>(context.inputVar.Shape().AppendShape({numSamples}),
+                                                              context.inputData.data(),
+                                                              numFeatures * numSamples,
+                                                              DeviceDescriptor::CPUDevice(),
+                                                              true);
+    ValuePtr inputValue = Value::CreateBatch(context.inputVar.Shape(), inputView, device, true);
+
+    //
+    // Evaluate
+    //
+    ValuePtr outputValue;
+    runEvaluation(context.model, context.inputVar, inputValue, context.outputVar, outputValue, device);
+
+    //
+    // Output
+    //
+    if(context.outputData.size() < outputDim * numSamples) {
+        context.outputData.resize(outputDim * numSamples);
+    }
+
+    NDShape outputShape = context.outputVar.Shape().AppendShape({1, numSamples});
+    NDArrayViewPtr cpuArrayOutput = MakeSharedObject<NDArrayView>(outputShape,
+                                                                  context.outputData.data(),
+                                                                  outputDim * numSamples,
+                                                                  DeviceDescriptor::CPUDevice(),
+                                                                  false);
+    cpuArrayOutput->CopyFrom(*outputValue->Data());
+
+    output.middleRows(startRow, numRows) = Map<Matrix<float, Dynamic, Dynamic, RowMajor> >(context.outputData.data(), numSamples, outputDim);
+}
+
+
+//*************************************************************************************************************
+
+bool Deep::prepareEvalContexts(int count)
+{
+    if(!m_pModel) {
+        fprintf(stderr, "No model defined.\n");
+        return false;
+    }
+
+    while(m_vecEvalContexts.size() < static_cast<size_t>(count)) {
+        // Clones share the parameters of the model, which is safe for evaluation
+        FunctionPtr model = m_vecEvalContexts.empty() ? m_pModel : m_pModel->Clone(ParameterCloningMethod::Share);
+
+        EvalContext context;
+        if(!initEvalContext(model, context)) {
+            return false;
+        }
+
+        m_vecEvalContexts.push_back(context);
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void Deep::clearEvalContexts()
+{
+    m_vecEvalContexts.clear();
+}
+
+
+//*************************************************************************************************************
+
+bool Deep::initTrainingContext(TrainingContext& context)
+{
+    if(!m_pModel) {
+        return false;
+    }
+
+    FunctionPtr z = m_pModel;
+
+    //
+    // Input
+    //
+    const std::wstring inputNodeName = L"features";
+    if (!getInputVariableByName(z, inputNodeName, context.inputFeatures)) {
+        fprintf(stderr, "Input variable %S is not available.\n", inputNodeName.c_str());
+        throw("Input variable not found error.");
+    }
+
+    //
+    // Output
+    //
+    context.outputLabels = InputVariable({z->Output().Shape().TotalSize()}, DataType::Float, L"labels"); //z->Output();
+
+    FunctionPtr fctLoss = CrossEntropyWithSoftmax(z,context.outputLabels);
+    FunctionPtr fctEvalError = ClassificationError(z, context.outputLabels);
+
+    double learning_rate = 0.5;
+    LearningRateSchedule lr_schedule = LearningRateSchedule(learning_rate, LearningRateSchedule::UnitType::Minibatch);
+    std::vector<LearnerPtr> learner; learner.push_back(SGDLearner(z->Parameters(),lr_schedule));
+
+    context.trainer = CreateTrainer(z,fctLoss,fctEvalError,learner);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void Deep::trainPreparedMinibatch(TrainingContext& context, const Minibatch& minibatch, double& loss, double& error, const DeviceDescriptor& device)
+{
+    ValuePtr inputDataValue = Value::CreateBatch(context.inputFeatures.Shape(), minibatch.inputData, device);
+    ValuePtr outputDataValue = Value::CreateBatch(context.outputLabels.Shape(), minibatch.targetData, device);
+
+    std::unordered_map<Variable, ValuePtr> inOutValues = { { context.inputFeatures, inputDataValue }, { context.outputLabels, outputDataValue } };
+
+    context.trainer->TrainMinibatch(inOutValues,device);
+
+    loss = context.trainer->PreviousMinibatchLossAverage();
+    error = context.trainer->PreviousMinibatchEvaluationAverage();
+}
+
+
+//*************************************************************************************************************
+
+void Deep::prepareMinibatch(const MatrixXf& input, const MatrixXf& targets, const std::vector<int>& order, int start, int batchSize, const RowVectorXf& mean, const RowVectorXf& invStd, Minibatch& minibatch)
+{
+    int inputDim = input.cols();
+    int targetDim = targets.cols();
+
+    minibatch.batchSize = static_cast<size_t>(batchSize);
+    minibatch.inputData.resize(static_cast<size_t>(inputDim) * batchSize);
+    minibatch.targetData.resize(static_cast<size_t>(targetDim) * batchSize);
+
+    for (int m = 0; m < batchSize; ++m) {
+        int row = order[start + m];
+
+        Map<RowVectorXf> inputSample(minibatch.inputData.data() + m * inputDim, inputDim);
+        if(mean.size() == inputDim) {
+            inputSample = (input.row(row) - mean).cwiseProduct(invStd);
+        } else {
+            inputSample = input.row(row);
+        }
+
+        Map<RowVectorXf>(minibatch.targetData.data() + m * targetDim, targetDim) = targets.row(row);
+    }
+}
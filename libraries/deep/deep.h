@@ -67,6 +67,18 @@
 
 #include <QSharedPointer>
 #include <QObject>
+#include <QList>
+#include <QThread>
+#include <QAtomicInt>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <vector>
 
 
 //*************************************************************************************************************
@@ -221,7 +233,46 @@ public:
 
     //=========================================================================================================
     /**
-    * Train the CNTK Model with one Minibatch
+    * Evaluate the CNTK Model for several inputs, e.g. the feature matrices of several epochs. All inputs are
+    * stacked into one minibatch, which is evaluated at once.
+    *
+    * @param [in] inputs    The inputs (rows = samples, cols = feature inputs). All inputs need the same number of features.
+    * @param [out] outputs  The outputs, one per input (rows = samples, cols = output results)
+    * @param [in] device    Device to use for evaluation
+    *
+    * @return true when successfully evaluated, false otherwise.
+    */
+    bool evalModelBatch(const QList<Eigen::MatrixXf>& inputs, QList<Eigen::MatrixXf>& outputs, const CNTK::DeviceDescriptor& device = CNTK::DeviceDescriptor::UseDefaultDevice());
+
+    //=========================================================================================================
+    /**
+    * Evaluate the CNTK Model on several CPU threads. The samples are split into one block per thread. Each thread
+    * evaluates its block with its own clone of the model, the clones share the model parameters. The clones and
+    * their buffers are kept for the next call until the model changes.
+    *
+    * @param [in] input         The inputs (rows = samples, cols = feature inputs)
+    * @param [out] output       The ouptuts (rows = samples, cols = output results)
+    * @param [in] threadCount   Number of threads to use
+    *
+    * @return true when successfully evaluated, false otherwise.
+    */
+    bool evalModelParallel(const Eigen::MatrixXf& input, Eigen::MatrixXf& output, int threadCount = QThread::idealThreadCount());
+
+    //=========================================================================================================
+    /**
+    * Returns the device to evaluate and train on. Falls back to the CPU if the requested GPU is not available.
+    *
+    * @param [in] gpuId     Id of the GPU to use, -1 selects the CPU
+    *
+    * @return the selected device
+    */
+    static CNTK::DeviceDescriptor selectDevice(int gpuId = -1);
+
+    //=========================================================================================================
+    /**
+    * Train the CNTK Model with all samples, one minibatch after another. The next minibatch is prepared, i.e.
+    * shuffled and normalized if enabled, on a worker thread while the current one is trained. trainingProgress is
+    * emitted after each minibatch.
     *
     * @param [in] input             The inputs (rows = samples (batchsize), cols = feature inputs)
     * @param [in] targets           The targets (rows = samples (batchsize), cols = output results)
@@ -230,7 +281,7 @@ public:
     * @param [in] minibatch_size    The size of one minibatch (Default 25)
     * @param [in] device            Device to use for evaluation
     *
-    * @return true when successfully evaluated, false otherwise.
+    * @return true when successfully trained, false if the training failed or was canceled.
     */
     bool trainModel(const Eigen::MatrixXf& input, const Eigen::MatrixXf& targets, QVector<double>& loss, QVector<double>& error, int minibatch_size = 25, const CNTK::DeviceDescriptor& device = CNTK::DeviceDescriptor::UseDefaultDevice());
 
@@ -254,6 +305,23 @@ public:
     */
     void cancelTraining();
 
+    //=========================================================================================================
+    /**
+    * Sets whether trainModel draws the samples of the minibatches in random order. Default is false.
+    *
+    * @param [in] shuffle   Whether to shuffle the samples
+    */
+    void setTrainingShuffle(bool shuffle);
+
+    //=========================================================================================================
+    /**
+    * Sets whether trainModel normalizes each feature to zero mean and unit variance over all samples. Default is
+    * false.
+    *
+    * @param [in] normalize     Whether to normalize the features
+    */
+    void setTrainingNormalization(bool normalize);
+
     //=========================================================================================================
     /**
     * Print the model structure
@@ -261,7 +329,17 @@ public:
     void print();
 
 signals:
-
+    //=========================================================================================================
+    /**
+    * Emitted by trainModel after each minibatch.
+    *
+    * @param [in] iteration         Number of trained minibatches
+    * @param [in] numIterations     Number of minibatches to train
+    * @param [in] loss              Loss of the minibatch
+    * @param [in] error             Error of the minibatch
+    * @param [in] samplesPerSecond  Training throughput so far
+    */
+    void trainingProgress(int iteration, int numIterations, double loss, double error, double samplesPerSecond);
 
 protected:
     //=========================================================================================================
@@ -309,8 +387,124 @@ protected:
     inline static bool getOutputVaraiableByName(CNTK::FunctionPtr model, std::wstring varName, CNTK::Variable& var);
 
 private:
+    //=========================================================================================================
+    /**
+    * The trainer and variables reused by all minibatches of a training session.
+    */
+    struct TrainingContext {
+        CNTK::Variable inputFeatures;   /**< The input variable of the model */
+        CNTK::Variable outputLabels;    /**< The label variable the loss is computed with */
+        CNTK::TrainerPtr trainer;       /**< The trainer of the model */
+    };
+
+    //=========================================================================================================
+    /**
+    * A minibatch prepared for training, samples are stored one after another.
+    */
+    struct Minibatch {
+        std::vector<float> inputData;   /**< Input features */
+        std::vector<float> targetData;  /**< Targets */
+        size_t batchSize;               /**< Number of samples */
+    };
+
+    //=========================================================================================================
+    /**
+    * A model ready for evaluation together with its reusable host buffers. The buffers grow to the largest
+    * minibatch seen and are not reallocated afterwards.
+    */
+    struct EvalContext {
+        CNTK::FunctionPtr model;        /**< The model or a clone sharing its parameters */
+        CNTK::Variable inputVar;        /**< The input variable of the model */
+        CNTK::Variable outputVar;       /**< The output variable of the model */
+        std::vector<float> inputData;   /**< Input buffer, samples are stored one after another */
+        std::vector<float> outputData;  /**< Output buffer, samples are stored one after another */
+    };
+
+    //=========================================================================================================
+    /**
+    * Creates the loss, the evaluation error and the trainer for the model.
+    *
+    * @param [out] context      The initialized context
+    *
+    * @return true when the trainer was created, false otherwise.
+    */
+    bool initTrainingContext(TrainingContext& context);
+
+    //=========================================================================================================
+    /**
+    * Trains one prepared minibatch.
+    *
+    * @param [in, out] context  The trainer and its variables
+    * @param [in] minibatch     The minibatch to train
+    * @param [out] loss         The training loss
+    * @param [out] error        The training error
+    * @param [in] device        Device to use for training
+    */
+    static void trainPreparedMinibatch(TrainingContext& context, const Minibatch& minibatch, double& loss, double& error, const CNTK::DeviceDescriptor& device);
+
+    //=========================================================================================================
+    /**
+    * Copies samples into a minibatch, optionally normalizing the features.
+    *
+    * @param [in] input         The inputs (rows = samples, cols = feature inputs)
+    * @param [in] targets       The targets (rows = samples, cols = output results)
+    * @param [in] order         The order in which the samples are drawn
+    * @param [in] start         Position in order of the first sample of the minibatch
+    * @param [in] batchSize     Number of samples of the minibatch
+    * @param [in] mean          Feature means to subtract, empty to skip the normalization
+    * @param [in] invStd        Inverse feature standard deviations to scale with
+    * @param [out] minibatch    The prepared minibatch
+    */
+    static void prepareMinibatch(const Eigen::MatrixXf& input, const Eigen::MatrixXf& targets, const std::vector<int>& order, int start, int batchSize, const Eigen::RowVectorXf& mean, const Eigen::RowVectorXf& invStd, Minibatch& minibatch);
+
+    //=========================================================================================================
+    /**
+    * Looks up the input and output variables of a model.
+    *
+    * @param [in] model         The model to evaluate
+    * @param [out] context      The initialized context
+    *
+    * @return true when the model has the input and output variables, false otherwise.
+    */
+    static bool initEvalContext(CNTK::FunctionPtr model, EvalContext& context);
+
+    //=========================================================================================================
+    /**
+    * Evaluates a block of samples with a context and writes the results to the same rows of the output.
+    *
+    * @param [in, out] context  The model and its buffers
+    * @param [in] input         The inputs (rows = samples, cols = feature inputs)
+    * @param [in] startRow      First sample to evaluate
+    * @param [in] numRows       Number of samples to evaluate
+    * @param [out] output       The outputs, already sized to (input.rows() x output dimension)
+    * @param [in] device        Device to use for evaluation
+    */
+    static void evalRows(EvalContext& context, const Eigen::MatrixXf& input, int startRow, int numRows, Eigen::MatrixXf& output, const CNTK::DeviceDescriptor& device);
+
+    //=========================================================================================================
+    /**
+    * Makes sure that there are at least count evaluation contexts, the first one for the model itself and the
+    * others for clones of it.
+    *
+    * @param [in] count     Number of contexts needed
+    *
+    * @return true when the contexts are ready, false otherwise.
+    */
+    bool prepareEvalContexts(int count);
+
+    //=========================================================================================================
+    /**
+    * Drops the evaluation contexts and model clones after the model changed.
+    */
+    void clearEvalContexts();
+
+    CNTK::FunctionPtr m_pModel;                 /**< The CNTK model v2 */
+
+    std::vector<EvalContext> m_vecEvalContexts; /**< The model followed by its clones for the parallel evaluation */
 
-    CNTK::FunctionPtr m_pModel;  /**< The CNTK model v2 */
+    QAtomicInt m_iCancelTraining;               /**< Set by cancelTraining, checked by trainModel after each minibatch */
+    bool m_bTrainingShuffle;                    /**< Whether trainModel shuffles the samples */
+    bool m_bTrainingNormalization;              /**< Whether trainModel normalizes the features */
 
 };
 
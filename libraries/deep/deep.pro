@@ -38,7 +38,7 @@ include(../../mne-cpp.pri)
 TEMPLATE = lib
 
 #QT       -= gui
-QT += widgets
+QT += widgets concurrent
 
 DEFINES += DEEP_LIBRARY
 
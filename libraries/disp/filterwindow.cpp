@@ -78,6 +78,9 @@ FilterWindow::FilterWindow(QWidget *parent, Qt::WindowFlags type)
 , ui(new Ui::FilterWindowWidget)
 , m_iWindowSize(4016)
 , m_iFilterTaps(512)
+, m_iMaxFilterTaps(256)
+, m_iFIRFilterTaps(128)
+, m_bIIRDesign(false)
 , m_dSFreq(600)
 {
     ui->setupUi(this);
@@ -153,8 +156,12 @@ void FilterWindow::setMaxFilterTaps(int iMaxNumberFilterTaps)
     if(iMaxNumberFilterTaps>512)
         iMaxNumberFilterTaps = 512;
 
-    ui->m_spinBox_filterTaps->setMaximum(iMaxNumberFilterTaps);
-    ui->m_spinBox_filterTaps->setMinimum(16);
+    m_iMaxFilterTaps = iMaxNumberFilterTaps;
+
+    if(!m_bIIRDesign) {
+        ui->m_spinBox_filterTaps->setMaximum(iMaxNumberFilterTaps);
+        ui->m_spinBox_filterTaps->setMinimum(16);
+    }
 
     //Update filter depending on new window size
     filterParametersChanged();
@@ -183,7 +190,6 @@ void FilterWindow::setFilterParameters(double hp, double lp, int order, int type
 {
     ui->m_doubleSpinBox_highpass->setValue(lp);
     ui->m_doubleSpinBox_lowpass->setValue(hp);
-    ui->m_spinBox_filterTaps->setValue(order);
 
     if(type == 0)
         ui->m_comboBox_filterType->setCurrentText("Lowpass");
@@ -198,6 +204,13 @@ void FilterWindow::setFilterParameters(double hp, double lp, int order, int type
         ui->m_comboBox_designMethod->setCurrentText("Tschebyscheff");
     if(designMethod == 1)
         ui->m_comboBox_designMethod->setCurrentText("Cosine");
+    if(designMethod == 3)
+        ui->m_comboBox_designMethod->setCurrentText("Butterworth");
+    if(designMethod == 4)
+        ui->m_comboBox_designMethod->setCurrentText("Chebyshev");
+
+    //Set after the design method, which decides whether the spin box holds taps or the IIR order
+    ui->m_spinBox_filterTaps->setValue(order);
 
     ui->m_doubleSpinBox_transitionband->setValue(transition);
 
@@ -561,6 +574,28 @@ void FilterWindow::changeStateSpinBoxes(int currentIndex)
             break;
     }
 
+    //IIR designs are parametrized by their order instead of the number of taps
+    bool bIIRDesign = ui->m_comboBox_designMethod->currentText() == "Butterworth" || ui->m_comboBox_designMethod->currentText() == "Chebyshev";
+
+    if(bIIRDesign != m_bIIRDesign) {
+        m_bIIRDesign = bIIRDesign;
+
+        ui->m_spinBox_filterTaps->blockSignals(true);
+        if(m_bIIRDesign) {
+            m_iFIRFilterTaps = ui->m_spinBox_filterTaps->value();
+            ui->m_spinBox_filterTaps->setRange(1, 10);
+            ui->m_spinBox_filterTaps->setSingleStep(1);
+            ui->m_spinBox_filterTaps->setValue(4);
+            ui->m_label_filterTaps->setText("Filter order:");
+        } else {
+            ui->m_spinBox_filterTaps->setRange(16, m_iMaxFilterTaps);
+            ui->m_spinBox_filterTaps->setSingleStep(2);
+            ui->m_spinBox_filterTaps->setValue(m_iFIRFilterTaps);
+            ui->m_label_filterTaps->setText("Filter taps:");
+        }
+        ui->m_spinBox_filterTaps->blockSignals(false);
+    }
+
     //Change visibility of spin boxes depending on filter type
     switch(ui->m_comboBox_filterType->currentIndex()) {
         case 0: //Bandpass
@@ -618,7 +653,7 @@ void FilterWindow::filterParametersChanged()
 
     //Calculate the needed fft length
     m_iFilterTaps = ui->m_spinBox_filterTaps->value();
-    if(ui->m_spinBox_filterTaps->value()%2 != 0)
+    if(!m_bIIRDesign && ui->m_spinBox_filterTaps->value()%2 != 0)
         m_iFilterTaps--;
 
     int fftLength = m_iWindowSize + ui->m_spinBox_filterTaps->value() * 4; // *2 to take into account the overlap in front and back after the convolution. Another *2 to take into account the appended and prepended data.
@@ -651,6 +686,12 @@ void FilterWindow::filterParametersChanged()
     if(ui->m_comboBox_designMethod->currentText() == "Cosine")
         dMethod = FilterData::Cosine;
 
+    if(ui->m_comboBox_designMethod->currentText() == "Butterworth")
+        dMethod = FilterData::Butterworth;
+
+    if(ui->m_comboBox_designMethod->currentText() == "Chebyshev")
+        dMethod = FilterData::Chebyshev;
+
     //Generate filters
     QSharedPointer<FilterData> userDefinedFilterOperator;
 
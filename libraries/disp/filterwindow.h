@@ -273,6 +273,9 @@ private:
 
     int                         m_iWindowSize;              /**< The current window size of the loaded fiff data in the DataWindow class.*/
     int                         m_iFilterTaps;              /**< The current number of filter taps.*/
+    int                         m_iMaxFilterTaps;           /**< The maximal number of filter taps.*/
+    int                         m_iFIRFilterTaps;           /**< The number of filter taps to restore when switching back from an IIR design.*/
+    bool                        m_bIIRDesign;               /**< Whether an IIR design method is selected, i.e. the spin box holds the filter order.*/
     double                      m_dSFreq;                   /**< The current sampling frequency.*/
 
     QSettings                   m_qSettings;                /**< QSettings variable used to write or read from independent application sessions.*/
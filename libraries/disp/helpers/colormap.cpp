@@ -48,6 +48,7 @@
 //=============================================================================================================
 
 using namespace DISPLIB;
+using namespace Eigen;
 
 
 //*************************************************************************************************************
@@ -67,6 +68,52 @@ ColorMap::~ColorMap()
 }
 
 
+//*************************************************************************************************************
+
+QVector<QRgb> ColorMap::lookupTable(QRgb (*p_pColorMapper)(double), qint32 p_iSize)
+{
+    if(p_iSize < 2)
+        p_iSize = 2;
+
+    QVector<QRgb> t_vecLut(p_iSize);
+    double t_dStep = 1.0/((double)p_iSize-1);
+    for(qint32 i = 0; i < p_iSize; ++i)
+        t_vecLut[i] = p_pColorMapper(t_dStep*(double)i);
+
+    return t_vecLut;
+}
+
+
+//*************************************************************************************************************
+
+QImage ColorMap::matrixToImage(const MatrixXd& p_matValues, const QVector<QRgb>& p_vecLut, double p_dMin, double p_dMax, bool p_bFlipVertical)
+{
+    qint32 rows = p_matValues.rows();
+    qint32 cols = p_matValues.cols();
+
+    if(rows == 0 || cols == 0 || p_vecLut.isEmpty())
+        return QImage();
+
+    QImage t_qImage(cols, rows, QImage::Format_RGB32);
+
+    //Normalize all values to table indices at once, row major so that every image line is contiguous
+    qint32 t_iLast = p_vecLut.size()-1;
+    double t_dScale = p_dMax > p_dMin ? (double)t_iLast/(p_dMax-p_dMin) : 0.0;
+    Matrix<qint32, Dynamic, Dynamic, RowMajor> t_matIdx = ((p_matValues.array() - p_dMin) * t_dScale + 0.5).max(0.0).min((double)t_iLast).cast<qint32>().matrix();
+
+    const QRgb* t_pLut = p_vecLut.constData();
+    for(qint32 y = 0; y < rows; ++y)
+    {
+        QRgb* t_pLine = reinterpret_cast<QRgb*>(t_qImage.scanLine(p_bFlipVertical ? rows-1-y : y));
+        const qint32* t_pIdx = t_matIdx.data() + (qint64)y*cols;
+        for(qint32 x = 0; x < cols; ++x)
+            t_pLine[x] = t_pLut[t_pIdx[x]];
+    }
+
+    return t_qImage;
+}
+
+
 //*************************************************************************************************************
 
 double ColorMap::linearSlope(double x, double m, double n)
@@ -51,6 +51,16 @@
 
 #include <QSharedPointer>
 #include <QColor>
+#include <QImage>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
 
 
 //*************************************************************************************************************
@@ -156,7 +166,39 @@ public:
     * @return the corresponding Bone RGB
     */
     static inline QRgb valueToRedBlue(double v);
-    
+
+    //=========================================================================================================
+    /**
+    * Samples a color map at p_iSize equidistant values of [0,1], so images can be colored by table lookups
+    * instead of evaluating the fuzzy sets per pixel.
+    *
+    * @param[in] p_pColorMapper     the color map function, e.g. ColorMap::valueToJet
+    * @param[in] p_iSize            number of table entries (>= 2)
+    *
+    * @return the color lookup table
+    */
+    static QVector<QRgb> lookupTable(QRgb (*p_pColorMapper)(double), qint32 p_iSize = 1024);
+
+    //=========================================================================================================
+    /**
+    * Converts a matrix to an RGB32 image of the same size (columns x rows). The values are normalized from
+    * [p_dMin,p_dMax] to lookup table indices in one pass and written directly into the scanlines of the image.
+    * Values outside the range are clamped. The conversion does not touch any widget and can run in a worker thread.
+    *
+    * @param[in] p_matValues        the values to display, row i is drawn as image line i
+    * @param[in] p_vecLut           the color lookup table, see lookupTable
+    * @param[in] p_dMin             value mapped to the first table entry
+    * @param[in] p_dMax             value mapped to the last table entry
+    * @param[in] p_bFlipVertical    whether row 0 is drawn as the bottom line of the image
+    *
+    * @return the colored image
+    */
+    static QImage matrixToImage(const Eigen::MatrixXd& p_matValues,
+                                const QVector<QRgb>& p_vecLut,
+                                double p_dMin = 0.0,
+                                double p_dMax = 1.0,
+                                bool p_bFlipVertical = false);
+
 protected:
     //=========================================================================================================
     /**
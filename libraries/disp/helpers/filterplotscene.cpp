@@ -78,7 +78,7 @@ FilterPlotScene::FilterPlotScene(QGraphicsView *view, QObject *parent)
 
 void FilterPlotScene::updateFilter(const FilterData& operatorFilter, int samplingFreq, int cutOffLow, int cutOffHigh)
 {
-    if(operatorFilter.m_dCoeffA.cols() == 0)
+    if(operatorFilter.m_dCoeffA.cols() == 0 && !operatorFilter.isIIR())
         return;
 
     m_pCurrentFilter = operatorFilter;
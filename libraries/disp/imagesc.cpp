@@ -49,6 +49,7 @@
 //=============================================================================================================
 
 #include <QPainter>
+#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -113,6 +114,9 @@ ImageSc::ImageSc(MatrixXi &p_iMat, QWidget *parent)
 
 ImageSc::~ImageSc()
 {
+    m_dataImageWatcher.disconnect();
+    m_dataImageWatcher.waitForFinished();
+
     if(m_pPixmapData)
         delete m_pPixmapData;
     if(m_pPixmapColorbar)
@@ -129,6 +133,12 @@ void ImageSc::init()
 
     //Colormap
     pColorMapper = ColorMap::valueToJet;
+    m_vecColorLut = ColorMap::lookupTable(pColorMapper);
+
+    //Data image rendering
+    m_bRenderPending = false;
+    connect(&m_dataImageWatcher, &QFutureWatcher<QImage>::finished,
+            this, &ImageSc::onDataRendered);
 
     //Colorbar
     m_bColorbar = true;
@@ -151,11 +161,7 @@ void ImageSc::updateData(MatrixXd &p_dMat)
         m_dMaxValue = p_dMat.maxCoeff();
 
         // -- data --
-        m_matCentNormData = p_dMat;
-        double minValue = m_matCentNormData.minCoeff();
-        m_matCentNormData.array() -= minValue;
-        double maxValue = m_matCentNormData.maxCoeff();
-        m_matCentNormData.array() /= maxValue;
+        m_matData = p_dMat;
 
         updateMaps();
     }
@@ -184,33 +190,21 @@ void ImageSc::updateData(MatrixXi &p_iMat)
 
 void ImageSc::updateMaps()
 {
-    if(m_pPixmapData)
-    {
-        delete m_pPixmapData;
-        m_pPixmapData = NULL;
-    }
     if(m_pPixmapColorbar)
     {
         delete m_pPixmapColorbar;
         m_pPixmapColorbar = NULL;
     }
 
-    if(m_matCentNormData.rows() > 0 && m_matCentNormData.cols() > 0)
+    if(m_matData.rows() > 0 && m_matData.cols() > 0)
     {
         // --Data--
-        qint32 x = m_matCentNormData.cols();
-        qint32 y = m_matCentNormData.rows();
-        qint32 i, j;
-        QImage t_qImageData(x, y, QImage::Format_RGB32);
-        for(i = 0; i < x; ++i)
-            for(j = 0; j < y; ++j)
-                t_qImageData.setPixel(i, j, pColorMapper(m_matCentNormData(j,i)));
-
-        m_pPixmapData = new QPixmap(QPixmap::fromImage(t_qImageData));
+        renderData();
 
         // --Colorbar--
         QImage t_qImageColorbar(1, m_iColorbarGradSteps, QImage::Format_RGB32);
 
+        qint32 j;
         double t_dQuantile = 1.0/((double)m_iColorbarGradSteps-1);
         for(j = 0; j < m_iColorbarGradSteps; ++j)
         {
@@ -253,6 +247,44 @@ void ImageSc::updateMaps()
 }
 
 
+//*************************************************************************************************************
+
+void ImageSc::renderData()
+{
+    if(m_dataImageWatcher.isRunning())
+    {
+        m_bRenderPending = true;
+        return;
+    }
+    m_bRenderPending = false;
+
+    //The worker thread gets its own copies, the widget may be updated meanwhile
+    MatrixXd t_matData = m_matData;
+    QVector<QRgb> t_vecLut = m_vecColorLut;
+    double t_dMin = m_dMinValue;
+    double t_dMax = m_dMaxValue;
+
+    m_dataImageWatcher.setFuture(QtConcurrent::run([t_matData, t_vecLut, t_dMin, t_dMax]() {
+        return ColorMap::matrixToImage(t_matData, t_vecLut, t_dMin, t_dMax);
+    }));
+}
+
+
+//*************************************************************************************************************
+
+void ImageSc::onDataRendered()
+{
+    if(m_pPixmapData)
+        delete m_pPixmapData;
+    m_pPixmapData = new QPixmap(QPixmap::fromImage(m_dataImageWatcher.result()));
+
+    if(m_bRenderPending)
+        renderData();
+
+    update();
+}
+
+
 //*************************************************************************************************************
 
 void ImageSc::setColorMap(const QString &p_sColorMap)
@@ -272,6 +304,8 @@ void ImageSc::setColorMap(const QString &p_sColorMap)
     else
         pColorMapper = ColorMap::valueToJet;
 
+    m_vecColorLut = ColorMap::lookupTable(pColorMapper);
+
     updateMaps();
 }
 
@@ -55,6 +55,8 @@
 #include <QString>
 #include <QPen>
 #include <QSharedPointer>
+#include <QVector>
+#include <QFutureWatcher>
 
 
 //*************************************************************************************************************
@@ -184,17 +186,34 @@ protected:
     */
     void updateMaps();
 
+    //=========================================================================================================
+    /**
+    * Starts coloring the data image in a worker thread. If a rendering is still running, a new one is started
+    * when it has finished, so intermediate updates are dropped.
+    */
+    void renderData();
+
+    //=========================================================================================================
+    /**
+    * Swaps in the data pixmap when the worker thread has finished the image and starts a pending rendering.
+    */
+    void onDataRendered();
+
     void paintEvent(QPaintEvent*);
 
     QPixmap* m_pPixmapData;         /**< data pixmap */
     QPixmap* m_pPixmapColorbar;     /**< colorbar pixmap */
 
-    MatrixXd m_matCentNormData;     /**< centralized and normalized data */
+    MatrixXd m_matData;             /**< data to visualize, normalized by the lookup while rendering */
 
     double m_dMinValue;             /**< Minimal data value */
     double m_dMaxValue;             /**< Maximal data value */
 
     QRgb (*pColorMapper)(double);   /**< Function pointer to current colormap */
+    QVector<QRgb> m_vecColorLut;    /**< Lookup table of the current colormap */
+
+    QFutureWatcher<QImage> m_dataImageWatcher;  /**< Watches the worker thread which colors the data image */
+    bool m_bRenderPending;                      /**< If the data changed while the image was rendered */
 
     bool m_bColorbar;                   /**< If colorbar is visible */
     QVector<double> m_qVecScaleValues;  /**< Scale values */
@@ -51,6 +51,45 @@
 using namespace DISPLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Returns the color map function of a ColorMaps value.
+*
+* @param[in] cmap   the color map
+*
+* @return the function pointer of the color map
+*/
+QRgb (*colorMapper(ColorMaps cmap))(double)
+{
+    switch(cmap)
+    {
+        case Hot:
+            return ColorMap::valueToHot;
+        case HotNeg1:
+            return ColorMap::valueToHotNegative1;
+        case HotNeg2:
+            return ColorMap::valueToHotNegative2;
+        case Bone:
+            return ColorMap::valueToBone;
+        case RedBlue:
+            return ColorMap::valueToRedBlue;
+        case Jet:
+        default:
+            return ColorMap::valueToJet;
+    }
+}
+
+} //NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -109,37 +148,9 @@ void TFplot::calc_plot(MatrixXd tf_matrix, qreal sample_rate, ColorMaps cmap, qr
     if(std::fabs(mnorm) > norm1) norm1 = mnorm;
     tf_matrix /= norm1;
 
-    //setup image
-    QImage * image_to_tf_plot = new QImage(tf_matrix.cols(), tf_matrix.rows(), QImage::Format_RGB32);
-
-    //setup pixelcolors in image
-    QColor color;
-    for ( qint32 y = 0; y < tf_matrix.rows(); y++ )
-        for ( qint32 x = 0; x < tf_matrix.cols(); x++ )
-        {
-            switch  (cmap)
-            {
-                case Jet:
-                    color.setRgb(ColorMap::valueToJet(std::fabs(tf_matrix(y, x))));
-                    break;
-                case Hot:
-                    color.setRgb(ColorMap::valueToHot(std::fabs(tf_matrix(y, x))));
-                    break;
-                case HotNeg1:
-                    color.setRgb(ColorMap::valueToHotNegative1(std::fabs(tf_matrix(y, x))));
-                    break;
-                case HotNeg2:
-                    color.setRgb(ColorMap::valueToHotNegative2(std::fabs(tf_matrix(y, x))));
-                    break;
-                case Bone:
-                    color.setRgb(ColorMap::valueToBone(std::fabs(tf_matrix(y, x))));
-                    break;
-                case RedBlue:
-                    color.setRgb(ColorMap::valueToRedBlue(std::fabs(tf_matrix(y, x))));
-                    break;
-            }
-            image_to_tf_plot->setPixel(x, tf_matrix.rows() - 1 -  y,  color.rgb());
-        }
+    //setup image, the pixelcolors are looked up and written directly into the scanlines (lowest frequency at the bottom)
+    QVector<QRgb> color_lut = ColorMap::lookupTable(colorMapper(cmap));
+    QImage * image_to_tf_plot = new QImage(ColorMap::matrixToImage(tf_matrix.cwiseAbs(), color_lut, 0.0, 1.0, true));
 
     *image_to_tf_plot = image_to_tf_plot->scaled(tf_matrix.cols(), tf_matrix.cols()/2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
     *image_to_tf_plot = image_to_tf_plot->scaledToWidth(/*0.9 **/ 1026, Qt::SmoothTransformation);
@@ -149,36 +160,9 @@ void TFplot::calc_plot(MatrixXd tf_matrix, qreal sample_rate, ColorMaps cmap, qr
     QGraphicsScene *tf_scene = new QGraphicsScene();
     tf_scene->addItem(tf_pixmap);
 
-    QImage * coeffs_image = new QImage(10, tf_matrix.rows(), QImage::Format_RGB32);
     qreal norm = tf_matrix.maxCoeff();
-    for(qint32 it = 0; it < tf_matrix.rows(); it++)
-    {
-        for ( qint32 x = 0; x < 10; x++ )
-        {
-            switch  (cmap)
-            {
-                case Jet:
-                    color.setRgb(ColorMap::valueToJet(it*norm/tf_matrix.rows()));
-                    break;
-                case Hot:
-                    color.setRgb(ColorMap::valueToHot(it*norm/tf_matrix.rows()));
-                    break;
-                case HotNeg1:
-                    color.setRgb(ColorMap::valueToHotNegative1(it*norm/tf_matrix.rows()));
-                    break;
-                case HotNeg2:
-                    color.setRgb(ColorMap::valueToHotNegative2(it*norm/tf_matrix.rows()));
-                    break;
-                case Bone:
-                    color.setRgb(ColorMap::valueToBone(it*norm/tf_matrix.rows()));
-                    break;
-                case RedBlue:
-                    color.setRgb(ColorMap::valueToRedBlue(it*norm/tf_matrix.rows()));
-                    break;
-              }
-              coeffs_image->setPixel(x, tf_matrix.rows() - 1 -  it,  color.rgb());
-        }
-    }
+    MatrixXd coeffs = VectorXd::LinSpaced(tf_matrix.rows(), 0, tf_matrix.rows()-1) * (norm/tf_matrix.rows()) * RowVectorXd::Ones(10);
+    QImage * coeffs_image = new QImage(ColorMap::matrixToImage(coeffs, color_lut, 0.0, 1.0, true));
 
     *coeffs_image = coeffs_image->scaled(10, tf_matrix.cols()/2, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
     *coeffs_image = coeffs_image->scaledToHeight(image_to_tf_plot->height(), Qt::SmoothTransformation);
@@ -37,7 +37,7 @@ include(../../mne-cpp.pri)
 
 TEMPLATE = lib
 
-QT       += widgets 3dcore 3drender 3dinput 3dextras charts concurrent opengl
+QT       += widgets 3dcore 3drender 3dinput 3dlogic 3dextras charts concurrent opengl
 
 DEFINES += DISP3D_LIBRARY
 
@@ -102,6 +102,7 @@ SOURCES += \
     engine/model/items/digitizer/digitizertreeitem.cpp \
     engine/model/items/digitizer/digitizersettreeitem.cpp \
     engine/model/items/mri/mritreeitem.cpp \
+    engine/model/items/mri/mrivolumetreeitem.cpp \
     engine/model/items/common/abstracttreeitem.cpp \
     engine/model/items/common/abstract3Dtreeitem.cpp \
     engine/model/items/common/metatreeitem.cpp \
@@ -126,10 +127,16 @@ SOURCES += \
     engine/model/items/sensordata/sensordatatreeitem.cpp \
     helpers/interpolation/interpolation.cpp \
     helpers/geometryinfo/geometryinfo.cpp \
+    helpers/meshdecimation/meshdecimation.cpp \
     engine/model/3dhelpers/geometrymultiplier.cpp \
+    engine/model/3dhelpers/edgemultiplier.cpp \
+    engine/model/3dhelpers/geometryregistry.cpp \
+    engine/model/3dhelpers/framescheduler.cpp \
+    engine/model/3dhelpers/volumetextureimage.cpp \
     engine/model/materials/geometrymultipliermaterial.cpp \
     engine/view/customframegraph.cpp \
     engine/model/materials/gpuinterpolationmaterial.cpp \
+    engine/model/materials/volumematerial.cpp \
     engine/model/materials/abstractphongalphamaterial.cpp \
     engine/view/orbitalcameracontroller.cpp
 
@@ -154,6 +161,7 @@ HEADERS += \
     engine/model/items/digitizer/digitizertreeitem.h \
     engine/model/items/digitizer/digitizersettreeitem.h \
     engine/model/items/mri/mritreeitem.h \
+    engine/model/items/mri/mrivolumetreeitem.h \
     engine/model/items/common/abstracttreeitem.h \
     engine/model/items/common/abstract3Dtreeitem.h \
     engine/model/items/common/metatreeitem.h \
@@ -181,10 +189,16 @@ HEADERS += \
     engine/model/items/sensordata/sensordatatreeitem.h \
     helpers/interpolation/interpolation.h \
     helpers/geometryinfo/geometryinfo.h \
+    helpers/meshdecimation/meshdecimation.h \
     engine/model/3dhelpers/geometrymultiplier.h \
+    engine/model/3dhelpers/edgemultiplier.h \
+    engine/model/3dhelpers/geometryregistry.h \
+    engine/model/3dhelpers/framescheduler.h \
+    engine/model/3dhelpers/volumetextureimage.h \
     engine/model/materials/geometrymultipliermaterial.h \
     engine/view/customframegraph.h \
     engine/model/materials/gpuinterpolationmaterial.h \
+    engine/model/materials/volumematerial.h \
     engine/model/materials/abstractphongalphamaterial.h \
     engine/view/orbitalcameracontroller.h
 
@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "custommesh.h"
+#include "geometryregistry.h"
 
 
 //*************************************************************************************************************
@@ -48,6 +49,7 @@
 
 #include <QSharedPointer>
 #include <QVector3D>
+#include <QDebug>
 
 #include <Qt3DRender/QGeometry>
 #include <Qt3DRender/QAttribute>
@@ -69,6 +71,33 @@ using namespace DISP3DLIB;
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+template<typename T>
+T selectRows(const T& matData, const VectorXi& vecRows)
+{
+    //Data which does not cover all original vertices is passed on as it is
+    if(vecRows.rows() > 0 && vecRows.maxCoeff() >= matData.rows()) {
+        return matData;
+    }
+
+    T matSelected(vecRows.rows(), matData.cols());
+
+    for(int i = 0; i < vecRows.rows(); ++i) {
+        matSelected.row(i) = matData.row(vecRows(i));
+    }
+
+    return matSelected;
+}
+
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -77,6 +106,7 @@ using namespace Eigen;
 CustomMesh::CustomMesh()
 : Qt3DRender::QGeometryRenderer()
 , m_iNumVert(0)
+, m_iLevelOfDetail(0)
 {
     init();
 }
@@ -91,6 +121,7 @@ CustomMesh::CustomMesh(const MatrixX3f& tMatVert,
                        Qt3DRender::QGeometryRenderer::PrimitiveType primitiveType)
 : Qt3DRender::QGeometryRenderer()
 , m_iNumVert(tMatVert.rows())
+, m_iLevelOfDetail(0)
 {
     init();
 
@@ -110,16 +141,13 @@ void CustomMesh::init()
 
     this->setGeometry(m_pCustomGeometry);
 
-    m_pVertexDataBuffer = new Qt3DRender::QBuffer(Qt3DRender::QBuffer::VertexBuffer);
-    m_pNormalDataBuffer = new Qt3DRender::QBuffer(Qt3DRender::QBuffer::VertexBuffer);
+    //Vertex, normal and index buffers are acquired from the GeometryRegistry once data is set
     m_pColorDataBuffer = new Qt3DRender::QBuffer(Qt3DRender::QBuffer::VertexBuffer);
-    m_pIndexDataBuffer = new Qt3DRender::QBuffer(Qt3DRender::QBuffer::IndexBuffer);
 
     m_pIndexAttribute = new Qt3DRender::QAttribute();
     m_pIndexAttribute->setAttributeType(Qt3DRender::QAttribute::IndexAttribute);
     m_pIndexAttribute->setDataType(Qt3DRender::QAttribute::UnsignedInt);
     m_pIndexAttribute->setByteOffset(0);
-    m_pIndexAttribute->setBuffer(m_pIndexDataBuffer);
 
     m_pVertexAttribute = new Qt3DRender::QAttribute();
     m_pVertexAttribute->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
@@ -128,7 +156,6 @@ void CustomMesh::init()
     m_pVertexAttribute->setByteOffset(0);
     m_pVertexAttribute->setByteStride(3 * sizeof(float));
     m_pVertexAttribute->setName(Qt3DRender::QAttribute::defaultPositionAttributeName());
-    m_pVertexAttribute->setBuffer(m_pVertexDataBuffer);
 
     m_pNormalAttribute = new Qt3DRender::QAttribute();
     m_pNormalAttribute->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
@@ -137,7 +164,6 @@ void CustomMesh::init()
     m_pNormalAttribute->setByteOffset(0);
     m_pNormalAttribute->setByteStride(3 * sizeof(float));
     m_pNormalAttribute->setName(Qt3DRender::QAttribute::defaultNormalAttributeName());
-    m_pNormalAttribute->setBuffer(m_pNormalDataBuffer);
 
     m_pColorAttribute = new Qt3DRender::QAttribute();
     m_pColorAttribute->setAttributeType(Qt3DRender::QAttribute::VertexAttribute);
@@ -159,10 +185,10 @@ void CustomMesh::init()
 
 CustomMesh::~CustomMesh()
 {
-    m_pVertexDataBuffer->deleteLater();
-    m_pNormalDataBuffer->deleteLater();
+    GeometryRegistry::releaseBuffer(m_pVertexDataBuffer, m_pCustomGeometry);
+    GeometryRegistry::releaseBuffer(m_pNormalDataBuffer, m_pCustomGeometry);
+    GeometryRegistry::releaseBuffer(m_pIndexDataBuffer, m_pCustomGeometry);
     m_pColorDataBuffer->deleteLater();
-    m_pIndexDataBuffer->deleteLater();
     m_pCustomGeometry->deleteLater();
     m_pIndexAttribute->deleteLater();
     m_pVertexAttribute->deleteLater();
@@ -174,6 +200,26 @@ CustomMesh::~CustomMesh()
 //*************************************************************************************************************
 
 void CustomMesh::setColor(const Eigen::MatrixX3f& tMatColors)
+{
+    if(m_vecLevelsOfDetail.isEmpty() || tMatColors.rows() != m_iNumVert) {
+        setColorBuffer(tMatColors);
+        return;
+    }
+
+    //Keep the full resolution colors so that they can be remapped when the level of detail changes
+    m_matColors = tMatColors;
+
+    if(m_iLevelOfDetail == 0) {
+        setColorBuffer(m_matColors);
+    } else {
+        setColorBuffer(selectRows(m_matColors, m_vecLevelsOfDetail.at(m_iLevelOfDetail - 1).vecVertexIds));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void CustomMesh::setColorBuffer(const Eigen::MatrixX3f& tMatColors)
 {
     QByteArray colorBufferData;
     colorBufferData.resize(tMatColors.rows() * 3 * (int)sizeof(float));
@@ -211,9 +257,8 @@ void CustomMesh::setNormals(const Eigen::MatrixX3f& tMatNorm)
         rawNormalArray[idxNorm++] = tMatNorm(i,2);
     }
 
-    m_pNormalDataBuffer->setData(normalBufferData);
+    setSharedBuffer(m_pNormalDataBuffer, m_pNormalAttribute, normalBufferData, Qt3DRender::QBuffer::VertexBuffer);
 
-    //m_pNormalAttribute->setBuffer(m_pNormalDataBuffer);
     m_pNormalAttribute->setCount(tMatNorm.rows());
 }
 
@@ -233,9 +278,8 @@ void CustomMesh::setVertex(const Eigen::MatrixX3f& tMatVert)
         rawVertexArray[idxVert++] = (tMatVert(i,2));
     }
 
-    m_pVertexDataBuffer->setData(vertexBufferData);
+    setSharedBuffer(m_pVertexDataBuffer, m_pVertexAttribute, vertexBufferData, Qt3DRender::QBuffer::VertexBuffer);
 
-    //m_pVertexAttribute->setBuffer(m_pVertexDataBuffer);
     m_pVertexAttribute->setCount(tMatVert.rows());
 }
 
@@ -256,9 +300,8 @@ void CustomMesh::setIndex(const Eigen::MatrixXi& tMatTris)
         }
     }
 
-    m_pIndexDataBuffer->setData(indexBufferData);
+    setSharedBuffer(m_pIndexDataBuffer, m_pIndexAttribute, indexBufferData, Qt3DRender::QBuffer::IndexBuffer);
 
-    //m_pIndexAttribute->setBuffer(m_pIndexDataBuffer);
     m_pIndexAttribute->setByteStride(tMatTris.cols() * sizeof(uint));
     m_pIndexAttribute->setCount(tMatTris.rows());
     m_pIndexAttribute->setDataSize(tMatTris.cols());
@@ -269,6 +312,23 @@ void CustomMesh::setIndex(const Eigen::MatrixXi& tMatTris)
 }
 
 
+//*************************************************************************************************************
+
+void CustomMesh::setSharedBuffer(QPointer<Qt3DRender::QBuffer>& pBuffer,
+                                 Qt3DRender::QAttribute* pAttribute,
+                                 const QByteArray& data,
+                                 Qt3DRender::QBuffer::BufferType type)
+{
+    //Acquire before releasing, so that setting the same data again does not recreate the buffer
+    Qt3DRender::QBuffer* pOldBuffer = pBuffer;
+
+    pBuffer = GeometryRegistry::acquireBuffer(data, type, m_pCustomGeometry);
+    pAttribute->setBuffer(pBuffer);
+
+    GeometryRegistry::releaseBuffer(pOldBuffer, m_pCustomGeometry);
+}
+
+
 //*************************************************************************************************************
 
 void CustomMesh::setMeshData(const MatrixX3f& tMatVert,
@@ -278,6 +338,13 @@ void CustomMesh::setMeshData(const MatrixX3f& tMatVert,
                              Qt3DRender::QGeometryRenderer::PrimitiveType primitiveType)
 {
     m_iNumVert = tMatVert.rows();
+    m_iLevelOfDetail = 0;
+    m_vecLevelsOfDetail.clear();
+
+    m_matVert = tMatVert;
+    m_matNorm = tMatNorm;
+    m_matTris = tMatTris;
+    m_matColors = tMatColors;
 
     setVertex(tMatVert);
     setNormals(tMatNorm);
@@ -299,3 +366,64 @@ void CustomMesh::addAttribute(Qt3DRender::QAttribute *pAttribute)
 {
     m_pCustomGeometry->addAttribute(pAttribute);
 }
+
+
+//*************************************************************************************************************
+
+void CustomMesh::createLevelsOfDetail(int iNumLevels)
+{
+    if(m_matTris.cols() != 3) {
+        qDebug() << "CustomMesh::createLevelsOfDetail - Levels of detail can only be created for triangle meshes. Returning...";
+        return;
+    }
+
+    m_vecLevelsOfDetail = MeshDecimation::createLevelsOfDetail(m_matVert, m_matTris, iNumLevels);
+    m_iLevelOfDetail = qMin(m_iLevelOfDetail, m_vecLevelsOfDetail.size());
+
+    updateLevelOfDetail();
+}
+
+
+//*************************************************************************************************************
+
+int CustomMesh::getNumberLevelsOfDetail() const
+{
+    return m_vecLevelsOfDetail.size() + 1;
+}
+
+
+//*************************************************************************************************************
+
+void CustomMesh::setLevelOfDetail(int iLevel)
+{
+    iLevel = qBound(0, iLevel, m_vecLevelsOfDetail.size());
+
+    if(iLevel == m_iLevelOfDetail) {
+        return;
+    }
+
+    m_iLevelOfDetail = iLevel;
+
+    updateLevelOfDetail();
+}
+
+
+//*************************************************************************************************************
+
+void CustomMesh::updateLevelOfDetail()
+{
+    if(m_iLevelOfDetail == 0) {
+        setVertex(m_matVert);
+        setNormals(m_matNorm);
+        setIndex(m_matTris);
+        setColorBuffer(m_matColors);
+        return;
+    }
+
+    const DecimatedMesh& decimatedMesh = m_vecLevelsOfDetail.at(m_iLevelOfDetail - 1);
+
+    setVertex(selectRows(m_matVert, decimatedMesh.vecVertexIds));
+    setNormals(selectRows(m_matNorm, decimatedMesh.vecVertexIds));
+    setIndex(decimatedMesh.matTris);
+    setColorBuffer(selectRows(m_matColors, decimatedMesh.vecVertexIds));
+}
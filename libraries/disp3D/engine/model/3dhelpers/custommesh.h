@@ -42,6 +42,7 @@
 //=============================================================================================================
 
 #include "../../../disp3D_global.h"
+#include "../../../helpers/meshdecimation/meshdecimation.h"
 
 
 //*************************************************************************************************************
@@ -50,7 +51,9 @@
 //=============================================================================================================
 
 #include <Qt3DRender/QGeometryRenderer>
+#include <Qt3DRender/QBuffer>
 #include <QPointer>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -67,7 +70,7 @@
 //=============================================================================================================
 
 namespace Qt3DRender {
-    class QBuffer;
+    class QAttribute;
 }
 
 
@@ -130,7 +133,7 @@ public:
 
     //=========================================================================================================
     /**
-    * Set the vertices colors of the mesh.
+    * Set the vertices colors of the mesh. Colors for all original vertices are remapped to the active level of detail.
     *
     * @param[in] tMatColors     New color information for the vertices.
     */
@@ -184,6 +187,32 @@ public:
     */
     void addAttribute(Qt3DRender::QAttribute *pAttribute);
 
+    //=========================================================================================================
+    /**
+    * Creates decimated versions of the mesh data which was last set via setMeshData. Use this only for meshes
+    * whose per-vertex data is set through setColor, since other attributes are not remapped.
+    *
+    * @param[in] iNumLevels     The maximum number of decimated levels to create.
+    */
+    void createLevelsOfDetail(int iNumLevels = 3);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of available levels of detail, including the full resolution mesh.
+    *
+    * @return The number of levels of detail.
+    */
+    int getNumberLevelsOfDetail() const;
+
+    //=========================================================================================================
+    /**
+    * Switches the uploaded geometry to a level of detail. Level 0 is the full resolution mesh. Levels beyond the
+    * coarsest available one select the coarsest one.
+    *
+    * @param[in] iLevel         The new level of detail.
+    */
+    void setLevelOfDetail(int iLevel);
+
 protected:
     //=========================================================================================================
     /**
@@ -191,10 +220,39 @@ protected:
     */
     void init();
 
-    QPointer<Qt3DRender::QBuffer>       m_pVertexDataBuffer;       /**< The vertex buffer. */
-    QPointer<Qt3DRender::QBuffer>       m_pNormalDataBuffer;       /**< The normal buffer. */
+    //=========================================================================================================
+    /**
+    * Uploads the colors to the color buffer as they are.
+    *
+    * @param[in] tMatColors     The colors, one row per uploaded vertex.
+    */
+    void setColorBuffer(const Eigen::MatrixX3f &tMatColors);
+
+    //=========================================================================================================
+    /**
+    * Uploads vertices, normals, triangles and colors of the current level of detail.
+    */
+    void updateLevelOfDetail();
+
+    //=========================================================================================================
+    /**
+    * Replaces one of the immutable buffers by a buffer from the GeometryRegistry, which is shared with all other
+    * meshes holding the same data.
+    *
+    * @param[in,out] pBuffer    The buffer member to replace.
+    * @param[in] pAttribute     The attribute reading from the buffer.
+    * @param[in] data           The new buffer content.
+    * @param[in] type           The buffer type.
+    */
+    void setSharedBuffer(QPointer<Qt3DRender::QBuffer>& pBuffer,
+                         Qt3DRender::QAttribute* pAttribute,
+                         const QByteArray& data,
+                         Qt3DRender::QBuffer::BufferType type);
+
+    QPointer<Qt3DRender::QBuffer>       m_pVertexDataBuffer;       /**< The vertex buffer, shared via the GeometryRegistry. */
+    QPointer<Qt3DRender::QBuffer>       m_pNormalDataBuffer;       /**< The normal buffer, shared via the GeometryRegistry. */
     QPointer<Qt3DRender::QBuffer>       m_pColorDataBuffer;        /**< The color buffer. */
-    QPointer<Qt3DRender::QBuffer>       m_pIndexDataBuffer;        /**< The index buffer. */
+    QPointer<Qt3DRender::QBuffer>       m_pIndexDataBuffer;        /**< The index buffer, shared via the GeometryRegistry. */
 
     QPointer<Qt3DRender::QGeometry>     m_pCustomGeometry;         /**< The custom geometry. */
 
@@ -204,6 +262,14 @@ protected:
     QPointer<Qt3DRender::QAttribute>    m_pColorAttribute;         /**< The color attribute. */
 
     int                                 m_iNumVert;                 /**< The total number of set vertices. */
+    int                                 m_iLevelOfDetail;           /**< The currently uploaded level of detail. 0 is the full resolution. */
+
+    Eigen::MatrixX3f                    m_matVert;                  /**< The full resolution vertices. */
+    Eigen::MatrixX3f                    m_matNorm;                  /**< The full resolution normals. */
+    Eigen::MatrixXi                     m_matTris;                  /**< The full resolution triangles. */
+    Eigen::MatrixX3f                    m_matColors;                /**< The full resolution colors. */
+
+    QVector<DecimatedMesh>              m_vecLevelsOfDetail;        /**< The decimated levels, from fine to coarse. */
 };
 
 } // NAMESPACE
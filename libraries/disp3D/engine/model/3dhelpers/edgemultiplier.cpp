@@ -0,0 +1,237 @@
+//=============================================================================================================
+/**
+* @file     edgemultiplier.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    EdgeMultiplier class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "edgemultiplier.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <Qt3DRender/QGeometry>
+#include <Qt3DRender/QBuffer>
+#include <Qt3DRender/QAttribute>
+
+#include <Qt3DCore/QNode>
+
+#include <algorithm>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace Qt3DRender;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define EDGE_STRIDE 7   /**< Floats per edge: start xyz, end xyz and weight. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+EdgeMultiplier::EdgeMultiplier(Qt3DCore::QNode *tParent)
+    : QGeometryRenderer(tParent)
+    , m_pGeometry(new QGeometry(this))
+    , m_pVertexBuffer(new Qt3DRender::QBuffer(Qt3DRender::QBuffer::VertexBuffer))
+    , m_pEdgeBuffer(new Qt3DRender::QBuffer(Qt3DRender::QBuffer::VertexBuffer))
+    , m_pVertexAttribute(new QAttribute())
+    , m_pStartAttribute(new QAttribute())
+    , m_pEndAttribute(new QAttribute())
+    , m_pWeightAttribute(new QAttribute())
+{
+    init();
+}
+
+
+//*************************************************************************************************************
+
+EdgeMultiplier::~EdgeMultiplier()
+{
+    m_pVertexBuffer->deleteLater();
+    m_pEdgeBuffer->deleteLater();
+    m_pVertexAttribute->deleteLater();
+    m_pStartAttribute->deleteLater();
+    m_pEndAttribute->deleteLater();
+    m_pWeightAttribute->deleteLater();
+}
+
+
+//*************************************************************************************************************
+
+void EdgeMultiplier::setEdges(const Eigen::MatrixX3f &tMatVert,
+                              const Eigen::MatrixXi &tMatLines,
+                              const Eigen::VectorXf &tVecWeights)
+{
+    if(tMatLines.rows() != tVecWeights.rows())
+    {
+        qDebug ("ERROR!: EdgeMultiplier::setEdges: Number of weights does not match the number of edges!");
+        return;
+    }
+
+    if(tMatLines.rows() != 0 && (tMatLines.cols() != 2 || tMatLines.minCoeff() < 0 || tMatLines.maxCoeff() >= tMatVert.rows()))
+    {
+        qDebug ("ERROR!: EdgeMultiplier::setEdges: Edge indices do not match the node positions!");
+        return;
+    }
+
+    //Update buffer content, a zero instance count is not supported by all back ends, so disable instead
+    if(tMatLines.rows() != 0)
+    {
+        m_pEdgeBuffer->setData(buildEdgeBuffer(tMatVert, tMatLines, tVecWeights));
+        this->setInstanceCount(tMatLines.rows());
+    }
+
+    this->setEnabled(tMatLines.rows() != 0);
+}
+
+
+//*************************************************************************************************************
+
+void EdgeMultiplier::init()
+{
+    //The segment runs from 0 to 1 along x, the shader blends start and end position with it
+    QByteArray vertexData;
+    vertexData.resize(2 * 3 * (int)sizeof(float));
+    float *rawVertexArray = reinterpret_cast<float *>(vertexData.data());
+    std::fill(rawVertexArray, rawVertexArray + 6, 0.0f);
+    rawVertexArray[3] = 1.0f;
+    m_pVertexBuffer->setData(vertexData);
+
+    m_pVertexAttribute->setName(QAttribute::defaultPositionAttributeName());
+    m_pVertexAttribute->setAttributeType(QAttribute::VertexAttribute);
+    m_pVertexAttribute->setVertexBaseType(QAttribute::Float);
+    m_pVertexAttribute->setVertexSize(3);
+    m_pVertexAttribute->setByteOffset(0);
+    m_pVertexAttribute->setByteStride(3 * sizeof(float));
+    m_pVertexAttribute->setCount(2);
+    m_pVertexAttribute->setBuffer(m_pVertexBuffer);
+
+    //Set per edge attribute parameters, all of them live interleaved in one buffer
+    m_pStartAttribute->setName(QStringLiteral("instanceStart"));
+    m_pStartAttribute->setAttributeType(QAttribute::VertexAttribute);
+    m_pStartAttribute->setVertexBaseType(QAttribute::Float);
+    m_pStartAttribute->setVertexSize(3);
+    m_pStartAttribute->setDivisor(1);
+    m_pStartAttribute->setByteOffset(0);
+    m_pStartAttribute->setByteStride(EDGE_STRIDE * sizeof(float));
+    m_pStartAttribute->setBuffer(m_pEdgeBuffer);
+
+    m_pEndAttribute->setName(QStringLiteral("instanceEnd"));
+    m_pEndAttribute->setAttributeType(QAttribute::VertexAttribute);
+    m_pEndAttribute->setVertexBaseType(QAttribute::Float);
+    m_pEndAttribute->setVertexSize(3);
+    m_pEndAttribute->setDivisor(1);
+    m_pEndAttribute->setByteOffset(3 * sizeof(float));
+    m_pEndAttribute->setByteStride(EDGE_STRIDE * sizeof(float));
+    m_pEndAttribute->setBuffer(m_pEdgeBuffer);
+
+    m_pWeightAttribute->setName(QStringLiteral("instanceWeight"));
+    m_pWeightAttribute->setAttributeType(QAttribute::VertexAttribute);
+    m_pWeightAttribute->setVertexBaseType(QAttribute::Float);
+    m_pWeightAttribute->setVertexSize(1);
+    m_pWeightAttribute->setDivisor(1);
+    m_pWeightAttribute->setByteOffset(6 * sizeof(float));
+    m_pWeightAttribute->setByteStride(EDGE_STRIDE * sizeof(float));
+    m_pWeightAttribute->setBuffer(m_pEdgeBuffer);
+
+    //Add Attibutes to Geometry
+    m_pGeometry->addAttribute(m_pVertexAttribute);
+    m_pGeometry->addAttribute(m_pStartAttribute);
+    m_pGeometry->addAttribute(m_pEndAttribute);
+    m_pGeometry->addAttribute(m_pWeightAttribute);
+
+    //configure geometry renderer
+    this->setPrimitiveType(Qt3DRender::QGeometryRenderer::Lines);
+    this->setVertexCount(2);
+    this->setIndexOffset(0);
+    this->setFirstInstance(0);
+    this->setGeometry(m_pGeometry.data());
+    this->setEnabled(false);
+}
+
+
+//*************************************************************************************************************
+
+QByteArray EdgeMultiplier::buildEdgeBuffer(const Eigen::MatrixX3f &tMatVert,
+                                           const Eigen::MatrixXi &tMatLines,
+                                           const Eigen::VectorXf &tVecWeights)
+{
+    const uint iEdgeNum = tMatLines.rows();
+    //create byte array
+    QByteArray bufferData;
+    bufferData.resize(iEdgeNum * EDGE_STRIDE * (int)sizeof(float));
+    float *rawEdgeArray = reinterpret_cast<float *>(bufferData.data());
+
+    //copy edges into buffer
+    for(uint i = 0; i < iEdgeNum; i++)
+    {
+        float *rawEdge = rawEdgeArray + EDGE_STRIDE * i;
+        const int iStart = tMatLines(i, 0);
+        const int iEnd = tMatLines(i, 1);
+
+        rawEdge[0] = tMatVert(iStart, 0);
+        rawEdge[1] = tMatVert(iStart, 1);
+        rawEdge[2] = tMatVert(iStart, 2);
+        rawEdge[3] = tMatVert(iEnd, 0);
+        rawEdge[4] = tMatVert(iEnd, 1);
+        rawEdge[5] = tMatVert(iEnd, 2);
+        rawEdge[6] = tVecWeights(i);
+    }
+
+    return bufferData;
+}
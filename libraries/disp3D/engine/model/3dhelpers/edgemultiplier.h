@@ -0,0 +1,188 @@
+//=============================================================================================================
+/**
+* @file     edgemultiplier.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    EdgeMultiplier class declaration.
+*
+*/
+
+#ifndef DISP3DLIB_EDGEMULTIPLIER_H
+#define DISP3DLIB_EDGEMULTIPLIER_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <disp3D_global.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QPointer>
+#include <Qt3DRender/QGeometryRenderer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+namespace Qt3DRender {
+        class QGeometry;
+        class QBuffer;
+        class QAttribute;
+}
+
+namespace Qt3DCore {
+        class QNode;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DISP3DLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//=============================================================================================================
+/**
+* This class uses instanced rendering to draw a line segment once per edge. The start, end and weight of each edge
+* are uploaded once as per instance attributes, so thresholding and coloring can be done in the shader.
+*
+* @brief Instance based edge renderer.
+*/
+class DISP3DSHARED_EXPORT EdgeMultiplier : public Qt3DRender::QGeometryRenderer
+{
+    Q_OBJECT
+
+public:
+    typedef QSharedPointer<EdgeMultiplier> SPtr;            /**< Shared pointer type for EdgeMultiplier. */
+    typedef QSharedPointer<const EdgeMultiplier> ConstSPtr; /**< Const shared pointer type for EdgeMultiplier. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a EdgeMultiplier object.
+    *
+    * @param[in] tParent            The parent node.
+    */
+    explicit EdgeMultiplier(Qt3DCore::QNode *tParent = nullptr);
+
+    //=========================================================================================================
+    /**
+    * Copy Constructor disabled
+    */
+    EdgeMultiplier(const EdgeMultiplier& other) = delete;
+
+    //=========================================================================================================
+    /**
+    * Copy operator disabled
+    */
+    EdgeMultiplier& operator =(const EdgeMultiplier& other) = delete;
+
+    //=========================================================================================================
+    /**
+    * Destructor
+    */
+    ~EdgeMultiplier();
+
+    //=========================================================================================================
+    /**
+     * Uploads all edges in one go. The renderer is disabled while there are no edges.
+     *
+     * @param tMatVert                  The node positions, one row per node.
+     * @param tMatLines                 The start (first column) and end node (second column) of each edge.
+     * @param tVecWeights               The weight of each edge.
+     */
+    void setEdges(const Eigen::MatrixX3f &tMatVert,
+                  const Eigen::MatrixXi &tMatLines,
+                  const Eigen::VectorXf &tVecWeights);
+
+protected:
+
+private:
+    //=========================================================================================================
+    /**
+     * Initialize EdgeMultiplier object.
+     */
+    void init();
+
+    //=========================================================================================================
+    /**
+     * Builds the interleaved instance buffer content, start position, end position and weight per edge.
+     *
+     * @param tMatVert                  The node positions.
+     * @param tMatLines                 The start and end node of each edge.
+     * @param tVecWeights               The weight of each edge.
+     * @return                          buffer content.
+     */
+    QByteArray buildEdgeBuffer(const Eigen::MatrixX3f &tMatVert,
+                               const Eigen::MatrixXi &tMatLines,
+                               const Eigen::VectorXf &tVecWeights);
+
+    QPointer<Qt3DRender::QGeometry>                 m_pGeometry;                /**< The line segment which is instanced. */
+    QPointer<Qt3DRender::QBuffer>                   m_pVertexBuffer;            /**< The two vertices of the line segment. */
+    QPointer<Qt3DRender::QBuffer>                   m_pEdgeBuffer;              /**< The interleaved per edge data. */
+    QPointer<Qt3DRender::QAttribute>                m_pVertexAttribute;         /**< The segment parameter, 0 at the start and 1 at the end. */
+    QPointer<Qt3DRender::QAttribute>                m_pStartAttribute;          /**< The start position of each edge. */
+    QPointer<Qt3DRender::QAttribute>                m_pEndAttribute;            /**< The end position of each edge. */
+    QPointer<Qt3DRender::QAttribute>                m_pWeightAttribute;         /**< The weight of each edge. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+} // namespace DISP3DLIB
+
+#endif // DISP3DLIB_EDGEMULTIPLIER_H
@@ -0,0 +1,189 @@
+//=============================================================================================================
+/**
+* @file     framescheduler.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     FrameScheduler class definition.
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "framescheduler.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <Qt3DCore/QEntity>
+#include <Qt3DLogic/QFrameAction>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FrameScheduler::FrameScheduler(Qt3DCore::QEntity* pSceneEntity,
+                               QObject* parent)
+: QObject(parent)
+, m_pFrameAction(new Qt3DLogic::QFrameAction(pSceneEntity))
+, m_iUpdatedFrames(0)
+, m_iAppliedUpdates(0)
+, m_iMergedUpdates(0)
+, m_iDroppedUpdates(0)
+{
+    pSceneEntity->addComponent(m_pFrameAction);
+
+    connect(m_pFrameAction.data(), &Qt3DLogic::QFrameAction::triggered,
+            this, &FrameScheduler::onFrame);
+}
+
+
+//*************************************************************************************************************
+
+void FrameScheduler::scheduleUpdate(QObject* pReceiver,
+                                    const std::function<void()>& funcUpdate)
+{
+    QHash<QObject*, PendingUpdate>::iterator it = m_hashPendingUpdates.find(pReceiver);
+
+    if(it != m_hashPendingUpdates.end()) {
+        if(it->pReceiver) {
+            m_iMergedUpdates++;
+        } else {
+            //The address was reused by a new object after the old receiver was destroyed
+            m_iDroppedUpdates++;
+            it->pReceiver = pReceiver;
+        }
+
+        it->funcUpdate = funcUpdate;
+        return;
+    }
+
+    PendingUpdate update;
+    update.pReceiver = pReceiver;
+    update.funcUpdate = funcUpdate;
+
+    m_hashPendingUpdates.insert(pReceiver, update);
+}
+
+
+//*************************************************************************************************************
+
+int FrameScheduler::getNumberUpdatedFrames() const
+{
+    return m_iUpdatedFrames;
+}
+
+
+//*************************************************************************************************************
+
+int FrameScheduler::getNumberAppliedUpdates() const
+{
+    return m_iAppliedUpdates;
+}
+
+
+//*************************************************************************************************************
+
+int FrameScheduler::getNumberMergedUpdates() const
+{
+    return m_iMergedUpdates;
+}
+
+
+//*************************************************************************************************************
+
+int FrameScheduler::getNumberDroppedUpdates() const
+{
+    return m_iDroppedUpdates;
+}
+
+
+//*************************************************************************************************************
+
+void FrameScheduler::resetStatistics()
+{
+    m_iUpdatedFrames = 0;
+    m_iAppliedUpdates = 0;
+    m_iMergedUpdates = 0;
+    m_iDroppedUpdates = 0;
+}
+
+
+//*************************************************************************************************************
+
+void FrameScheduler::onFrame()
+{
+    if(m_hashPendingUpdates.isEmpty()) {
+        return;
+    }
+
+    //Swap first, updates may schedule new updates for the next frame
+    QHash<QObject*, PendingUpdate> hashUpdates;
+    hashUpdates.swap(m_hashPendingUpdates);
+
+    int iAppliedUpdates = 0;
+
+    for(const PendingUpdate& update : hashUpdates) {
+        if(!update.pReceiver) {
+            m_iDroppedUpdates++;
+            continue;
+        }
+
+        update.funcUpdate();
+        iAppliedUpdates++;
+    }
+
+    m_iAppliedUpdates += iAppliedUpdates;
+    m_iUpdatedFrames++;
+
+    emit frameUpdated(iAppliedUpdates, m_iMergedUpdates, m_iDroppedUpdates);
+}
@@ -0,0 +1,205 @@
+//=============================================================================================================
+/**
+* @file     framescheduler.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     FrameScheduler class declaration.
+*
+*/
+
+
+
+#ifndef DISP3DLIB_FRAMESCHEDULER_H
+#define DISP3DLIB_FRAMESCHEDULER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../../../disp3D_global.h"
+
+#include <functional>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QObject>
+#include <QPointer>
+#include <QHash>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+namespace Qt3DCore {
+    class QEntity;
+}
+
+namespace Qt3DLogic {
+    class QFrameAction;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DISP3DLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//=============================================================================================================
+/**
+* Paces the real-time updates of the tree items to the Qt3D frame loop. The workers deliver new colors or
+* signal data at their own rate. Instead of uploading every result right away, the items schedule their upload
+* here. Only the latest update per item is kept, and all pending updates are applied once per rendered frame.
+* Items which did not change since the last frame are not touched.
+*
+* @brief Coalesces real-time item updates to one upload per item and frame.
+*/
+class DISP3DSHARED_EXPORT FrameScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a FrameScheduler which is triggered by the frames of the scene the entity belongs to.
+    *
+    * @param[in] pSceneEntity       The entity to attach the frame action to.
+    * @param[in] parent             The parent of this object.
+    */
+    explicit FrameScheduler(Qt3DCore::QEntity* pSceneEntity,
+                            QObject* parent = Q_NULLPTR);
+
+    //=========================================================================================================
+    /**
+    * Schedules an update for the next frame. A still pending update of the same receiver is replaced and
+    * counted as merged. The update is dropped if the receiver is destroyed before the frame.
+    *
+    * @param[in] pReceiver          The object the update belongs to.
+    * @param[in] funcUpdate         The update, e.g. uploading a new color buffer.
+    */
+    void scheduleUpdate(QObject* pReceiver,
+                        const std::function<void()>& funcUpdate);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of frames in which at least one update was applied since the last reset.
+    *
+    * @return   The number of frames with updates.
+    */
+    int getNumberUpdatedFrames() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of applied updates since the last reset.
+    *
+    * @return   The number of applied updates.
+    */
+    int getNumberAppliedUpdates() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of updates which were replaced by a newer update before being applied.
+    *
+    * @return   The number of merged updates.
+    */
+    int getNumberMergedUpdates() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of updates which were dropped because their receiver was destroyed.
+    *
+    * @return   The number of dropped updates.
+    */
+    int getNumberDroppedUpdates() const;
+
+    //=========================================================================================================
+    /**
+    * Resets all statistics.
+    */
+    void resetStatistics();
+
+protected:
+    //=========================================================================================================
+    /**
+    * Applies all pending updates. This is called once per frame.
+    */
+    void onFrame();
+
+    struct PendingUpdate {
+        QPointer<QObject>           pReceiver;          /**< The receiver of the update. */
+        std::function<void()>       funcUpdate;         /**< The update. */
+    };
+
+    QPointer<Qt3DLogic::QFrameAction>       m_pFrameAction;         /**< Triggered once per frame by the logic aspect. */
+
+    QHash<QObject*, PendingUpdate>          m_hashPendingUpdates;   /**< The latest pending update per receiver. */
+
+    int                                     m_iUpdatedFrames;       /**< The number of frames with updates. */
+    int                                     m_iAppliedUpdates;      /**< The number of applied updates. */
+    int                                     m_iMergedUpdates;       /**< The number of merged updates. */
+    int                                     m_iDroppedUpdates;      /**< The number of dropped updates. */
+
+signals:
+    //=========================================================================================================
+    /**
+    * Emitted after the pending updates of a frame were applied.
+    *
+    * @param[in] iAppliedUpdates    The number of updates applied in this frame.
+    * @param[in] iMergedUpdates     The total number of merged updates since the last reset.
+    * @param[in] iDroppedUpdates    The total number of dropped updates since the last reset.
+    */
+    void frameUpdated(int iAppliedUpdates,
+                      int iMergedUpdates,
+                      int iDroppedUpdates);
+};
+
+} // namespace DISP3DLIB
+
+#endif // DISP3DLIB_FRAMESCHEDULER_H
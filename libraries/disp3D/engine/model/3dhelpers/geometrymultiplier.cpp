@@ -56,6 +56,8 @@
 #include <QMatrix4x4>
 #include <QColor>
 
+#include <algorithm>
+
 //*************************************************************************************************************
 //=============================================================================================================
 // Eigen INCLUDES
@@ -134,20 +136,51 @@ void GeometryMultiplier::setColors(const QVector<QColor> &tInstanceColors)
         return;
     }
 
-    //Update buffer content
-    m_pColorBuffer->setData(buildColorBuffer(tInstanceColors));
+    updateColorBuffer(buildColorBuffer(tInstanceColors), tInstanceColors.size());
+}
+
 
-    if(tInstanceColors.size() > 1)
+//*************************************************************************************************************
+
+void GeometryMultiplier::setColors(const Eigen::MatrixX3f &tMatColors)
+{
+    if(tMatColors.rows() == 0)
     {
-        m_pColorAttribute->setDivisor(1);
+        qDebug ("ERROR!: GeometryMultiplier::setColors: Color matrix is empty!");
+        return;
     }
-    else
+
+    QByteArray bufferData;
+    bufferData.resize(tMatColors.rows() * 3 * (int)sizeof(float));
+
+    //Row major copy, so that the colors of one instance are contiguous
+    Eigen::Map<Eigen::Matrix<float, Eigen::Dynamic, 3, Eigen::RowMajor> >(reinterpret_cast<float *>(bufferData.data()), tMatColors.rows(), 3) = tMatColors;
+
+    updateColorBuffer(bufferData, tMatColors.rows());
+}
+
+
+//*************************************************************************************************************
+
+void GeometryMultiplier::setPositions(const Eigen::MatrixX3f &tMatPositions,
+                                      const Eigen::VectorXf &tVecScales)
+{
+    if(tMatPositions.rows() == 0)
     {
-        //enable 1 color for x transforms
-        m_pColorAttribute->setDivisor(0);
+        qDebug ("ERROR!: GeometryMultiplier::setPositions: Position matrix is empty!");
+        return;
     }
 
-    updateInstanceCount(tInstanceColors.size());
+    if(tVecScales.rows() != 0 && tVecScales.rows() != tMatPositions.rows())
+    {
+        qDebug ("ERROR!: GeometryMultiplier::setPositions: Number of scales does not match the number of positions!");
+        return;
+    }
+
+    //Update buffer content
+    m_pTransformBuffer->setData(buildTransformBuffer(tMatPositions, tVecScales));
+
+    updateInstanceCount(tMatPositions.rows());
 }
 
 
@@ -243,6 +276,57 @@ QByteArray GeometryMultiplier::buildColorBuffer(const QVector<QColor> &tInstance
 }
 
 
+//*************************************************************************************************************
+
+QByteArray GeometryMultiplier::buildTransformBuffer(const Eigen::MatrixX3f &tMatPositions,
+                                                    const Eigen::VectorXf &tVecScales)
+{
+    const uint iVertNum = tMatPositions.rows();
+    const uint iMatrixSize = 16;
+    //create byte array, the matrices are stored column major like QMatrix4x4
+    QByteArray bufferData;
+    bufferData.resize(iVertNum * iMatrixSize * (int)sizeof(float));
+    float *rawVertexArray = reinterpret_cast<float *>(bufferData.data());
+    std::fill(rawVertexArray, rawVertexArray + iVertNum * iMatrixSize, 0.0f);
+
+    for(uint i = 0 ; i < iVertNum; i++)
+    {
+        float *rawMatrix = rawVertexArray + iMatrixSize * i;
+        const float fScale = tVecScales.rows() == 0 ? 1.0f : tVecScales(i);
+
+        rawMatrix[0] = fScale;
+        rawMatrix[5] = fScale;
+        rawMatrix[10] = fScale;
+        rawMatrix[12] = tMatPositions(i, 0);
+        rawMatrix[13] = tMatPositions(i, 1);
+        rawMatrix[14] = tMatPositions(i, 2);
+        rawMatrix[15] = 1.0f;
+    }
+
+    return bufferData;
+}
+
+
+//*************************************************************************************************************
+
+void GeometryMultiplier::updateColorBuffer(const QByteArray &tBufferData, const uint tCount)
+{
+    //Update buffer content
+    m_pColorBuffer->setData(tBufferData);
+
+    if(tCount > 1)
+    {
+        m_pColorAttribute->setDivisor(1);
+        updateInstanceCount(tCount);
+    }
+    else
+    {
+        //enable 1 color for x transforms, the instance count is defined by the transforms
+        m_pColorAttribute->setDivisor(0);
+    }
+}
+
+
 //*************************************************************************************************************
 
 void GeometryMultiplier::updateInstanceCount(const uint tCount)
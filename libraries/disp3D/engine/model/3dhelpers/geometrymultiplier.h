@@ -59,6 +59,8 @@
 // Eigen INCLUDES
 //=============================================================================================================
 
+#include <Eigen/Core>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -152,6 +154,25 @@ public:
      */
     void setColors(const QVector<QColor> &tInstanceColors);
 
+    //=========================================================================================================
+    /**
+     * Sets the color for each instance of the geometry in one go.
+     *
+     * @param tMatColors                RGB color of each instance in the range of 0 to 1, one row per instance.
+     */
+    void setColors(const Eigen::MatrixX3f &tMatColors);
+
+    //=========================================================================================================
+    /**
+     * Sets position and uniform scale for each instance of the geometry in one go.
+     * This avoids building a transformation matrix per instance for point-like glyphs.
+     *
+     * @param tMatPositions             Position of each instance, one row per instance.
+     * @param tVecScales                Scale of each instance. If empty, all instances keep their original size.
+     */
+    void setPositions(const Eigen::MatrixX3f &tMatPositions,
+                      const Eigen::VectorXf &tVecScales = Eigen::VectorXf());
+
 protected:
 
 private:
@@ -171,6 +192,17 @@ private:
      */
     QByteArray buildTransformBuffer(const QVector<QMatrix4x4> &tInstanceTransform);
 
+    //=========================================================================================================
+    /**
+     * Builds the transform matrix buffer content from positions and scales.
+     *
+     * @param tMatPositions             Position of each instance.
+     * @param tVecScales                Scale of each instance or empty for no scaling.
+     * @return                          buffer content.
+     */
+    QByteArray buildTransformBuffer(const Eigen::MatrixX3f &tMatPositions,
+                                    const Eigen::VectorXf &tVecScales);
+
     //=========================================================================================================
     /**
      * Builds color buffer content.
@@ -180,6 +212,15 @@ private:
      */
     QByteArray buildColorBuffer(const QVector<QColor> &tInstanceColor);
 
+    //=========================================================================================================
+    /**
+     * Uploads color buffer content and sets up the color divisor.
+     *
+     * @param tBufferData               The color buffer content.
+     * @param tCount                    The number of colors in the buffer.
+     */
+    void updateColorBuffer(const QByteArray &tBufferData, const uint tCount);
+
     //=========================================================================================================
     /**
      * Updates the instance count and warns about instance count mismatch.
@@ -0,0 +1,180 @@
+//=============================================================================================================
+/**
+* @file     geometryregistry.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     GeometryRegistry class definition.
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "geometryregistry.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <Qt3DRender/QGeometry>
+#include <QCryptographicHash>
+#include <QHash>
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+struct RegistryEntry {
+    Qt3DRender::QBuffer*                pBuffer;
+    QList<Qt3DRender::QGeometry*>       lUsers;
+};
+
+struct Registry {
+    QHash<QByteArray, RegistryEntry>                hashEntries;
+    QHash<Qt3DRender::QBuffer*, QByteArray>         hashKeys;
+};
+
+Registry& registry()
+{
+    static Registry s_registry;
+    return s_registry;
+}
+
+QByteArray createKey(const QByteArray& data, Qt3DRender::QBuffer::BufferType type)
+{
+    return QByteArray::number(static_cast<int>(type)) + ':' + QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+Qt3DRender::QBuffer* GeometryRegistry::acquireBuffer(const QByteArray& data,
+                                                     Qt3DRender::QBuffer::BufferType type,
+                                                     Qt3DRender::QGeometry* pGeometry)
+{
+    Registry& reg = registry();
+    const QByteArray key = createKey(data, type);
+
+    QHash<QByteArray, RegistryEntry>::iterator it = reg.hashEntries.find(key);
+
+    if(it != reg.hashEntries.end()) {
+        //Compare the content as well, since QByteArray shares its data this is cheap for identical copies
+        if(it->pBuffer->data() == data) {
+            it->lUsers.append(pGeometry);
+            return it->pBuffer;
+        }
+
+        //Hash collision, use an unregistered buffer which is deleted on release
+        Qt3DRender::QBuffer* pBuffer = new Qt3DRender::QBuffer(type, pGeometry);
+        pBuffer->setData(data);
+        return pBuffer;
+    }
+
+    RegistryEntry entry;
+    entry.pBuffer = new Qt3DRender::QBuffer(type, pGeometry);
+    entry.pBuffer->setData(data);
+    entry.lUsers.append(pGeometry);
+
+    reg.hashEntries.insert(key, entry);
+    reg.hashKeys.insert(entry.pBuffer, key);
+
+    return entry.pBuffer;
+}
+
+
+//*************************************************************************************************************
+
+void GeometryRegistry::releaseBuffer(Qt3DRender::QBuffer* pBuffer,
+                                     Qt3DRender::QGeometry* pGeometry)
+{
+    if(!pBuffer) {
+        return;
+    }
+
+    Registry& reg = registry();
+    QHash<Qt3DRender::QBuffer*, QByteArray>::iterator itKey = reg.hashKeys.find(pBuffer);
+
+    if(itKey == reg.hashKeys.end()) {
+        pBuffer->deleteLater();
+        return;
+    }
+
+    QHash<QByteArray, RegistryEntry>::iterator it = reg.hashEntries.find(itKey.value());
+    it->lUsers.removeOne(pGeometry);
+
+    if(it->lUsers.isEmpty()) {
+        reg.hashEntries.erase(it);
+        reg.hashKeys.erase(itKey);
+        pBuffer->deleteLater();
+        return;
+    }
+
+    //Hand the buffer over so that it survives the releasing geometry
+    if(pBuffer->parent() == pGeometry) {
+        pBuffer->setParent(it->lUsers.first());
+    }
+}
+
+
+//*************************************************************************************************************
+
+int GeometryRegistry::getNumberBuffers()
+{
+    return registry().hashEntries.size();
+}
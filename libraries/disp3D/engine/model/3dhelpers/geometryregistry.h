@@ -0,0 +1,149 @@
+//=============================================================================================================
+/**
+* @file     geometryregistry.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     GeometryRegistry class declaration.
+*
+*/
+
+
+
+#ifndef DISP3DLIB_GEOMETRYREGISTRY_H
+#define DISP3DLIB_GEOMETRYREGISTRY_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../../../disp3D_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <Qt3DRender/QBuffer>
+#include <QByteArray>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+namespace Qt3DRender {
+    class QGeometry;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DISP3DLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//=============================================================================================================
+/**
+* Keeps track of immutable vertex, normal and index buffers so that geometries with identical content share
+* one buffer instead of each uploading their own copy. This is the case if the same surface is shown by several
+* tree items, e.g. a FreeSurfer surface and the source estimate overlays on top of it. Per-item attributes such
+* as colors are not registered.
+*
+* A shared buffer is a child of one of the geometries using it and is handed over to another user when that
+* geometry releases it. It is deleted once the last user released it. Shared buffers must never be modified,
+* new data has to be acquired as a new buffer. All methods must be called from the GUI thread.
+*
+* @brief Registry for shared geometry buffers.
+*/
+class DISP3DSHARED_EXPORT GeometryRegistry
+{
+
+public:
+    //=========================================================================================================
+    /**
+    * deleted default constructor (static class).
+    */
+    GeometryRegistry() = delete;
+
+    //=========================================================================================================
+    /**
+    * @brief acquireBuffer          Returns a buffer holding the given data. If a buffer with the same type and
+    *                               content is already registered it is reused, otherwise a new one is created.
+    *                               Every call must be matched by a call to releaseBuffer.
+    *
+    * @param[in] data               The buffer content.
+    * @param[in] type               The buffer type.
+    * @param[in] pGeometry          The geometry which is going to use the buffer.
+    *
+    * @return                       The shared buffer.
+    */
+    static Qt3DRender::QBuffer* acquireBuffer(const QByteArray& data,
+                                              Qt3DRender::QBuffer::BufferType type,
+                                              Qt3DRender::QGeometry* pGeometry);
+
+    //=========================================================================================================
+    /**
+    * @brief releaseBuffer          Releases a buffer previously acquired by the geometry. Null pointers are
+    *                               ignored.
+    *
+    * @param[in] pBuffer            The buffer to release.
+    * @param[in] pGeometry          The geometry which used the buffer.
+    */
+    static void releaseBuffer(Qt3DRender::QBuffer* pBuffer,
+                              Qt3DRender::QGeometry* pGeometry);
+
+    //=========================================================================================================
+    /**
+    * @brief getNumberBuffers       Returns the number of currently registered buffers.
+    *
+    * @return                       The number of registered buffers.
+    */
+    static int getNumberBuffers();
+};
+
+} // namespace DISP3DLIB
+
+#endif // DISP3DLIB_GEOMETRYREGISTRY_H
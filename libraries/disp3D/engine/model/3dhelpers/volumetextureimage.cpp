@@ -0,0 +1,173 @@
+//=============================================================================================================
+/**
+* @file     volumetextureimage.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the VolumeTextureImage class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "volumetextureimage.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <Qt3DRender/QTextureImageData>
+#include <Qt3DRender/QTextureImageDataGenerator>
+#include <QOpenGLTexture>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace Qt3DRender;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+//=============================================================================================================
+/**
+* Creates the texture image data of a volume on the Qt3D aspect thread.
+*/
+class VolumeTextureDataGenerator : public QTextureImageDataGenerator
+{
+public:
+    VolumeTextureDataGenerator(const QByteArray &data, int iWidth, int iHeight, int iDepth, quint64 iGeneration)
+    : m_data(data)
+    , m_iWidth(iWidth)
+    , m_iHeight(iHeight)
+    , m_iDepth(iDepth)
+    , m_iGeneration(iGeneration)
+    {
+    }
+
+    QTextureImageDataPtr operator ()() Q_DECL_OVERRIDE
+    {
+        QTextureImageDataPtr pImageData = QTextureImageDataPtr::create();
+
+        pImageData->setTarget(QOpenGLTexture::Target3D);
+        pImageData->setFormat(QOpenGLTexture::R16_UNorm);
+        pImageData->setPixelFormat(QOpenGLTexture::Red);
+        pImageData->setPixelType(QOpenGLTexture::UInt16);
+        pImageData->setWidth(m_iWidth);
+        pImageData->setHeight(m_iHeight);
+        pImageData->setDepth(m_iDepth);
+        pImageData->setLayers(1);
+        pImageData->setFaces(1);
+        pImageData->setMipLevels(1);
+        pImageData->setData(m_data, sizeof(quint16));
+
+        return pImageData;
+    }
+
+    bool operator ==(const QTextureImageDataGenerator &other) const Q_DECL_OVERRIDE
+    {
+        const VolumeTextureDataGenerator *pOther = functor_cast<VolumeTextureDataGenerator>(&other);
+        return pOther && pOther->m_iGeneration == m_iGeneration;
+    }
+
+    QT3D_FUNCTOR(VolumeTextureDataGenerator)
+
+private:
+    QByteArray      m_data;
+    int             m_iWidth;
+    int             m_iHeight;
+    int             m_iDepth;
+    quint64         m_iGeneration;
+};
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+VolumeTextureImage::VolumeTextureImage(Qt3DCore::QNode *parent)
+: QAbstractTextureImage(parent)
+, m_iWidth(0)
+, m_iHeight(0)
+, m_iDepth(0)
+, m_iGeneration(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void VolumeTextureImage::setVolume(const QByteArray &data,
+                                   int iWidth,
+                                   int iHeight,
+                                   int iDepth)
+{
+    if(data.size() != iWidth * iHeight * iDepth * (int)sizeof(quint16)) {
+        qDebug("VolumeTextureImage::setVolume - data size does not match the dimensions!");
+        return;
+    }
+
+    m_data = data;
+    m_iWidth = iWidth;
+    m_iHeight = iHeight;
+    m_iDepth = iDepth;
+    m_iGeneration++;
+
+    notifyDataGeneratorChanged();
+}
+
+
+//*************************************************************************************************************
+
+QTextureImageDataGeneratorPtr VolumeTextureImage::dataGenerator() const
+{
+    return QTextureImageDataGeneratorPtr(new VolumeTextureDataGenerator(m_data, m_iWidth, m_iHeight, m_iDepth, m_iGeneration));
+}
@@ -0,0 +1,141 @@
+//=============================================================================================================
+/**
+* @file     volumetextureimage.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the VolumeTextureImage class.
+*
+*/
+
+#ifndef DISP3DLIB_VOLUMETEXTUREIMAGE_H
+#define DISP3DLIB_VOLUMETEXTUREIMAGE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../../../disp3D_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <Qt3DRender/QAbstractTextureImage>
+#include <QByteArray>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DISP3DLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//=============================================================================================================
+/**
+* This texture image provides the voxels of a volume as 16 bit normalized red values for a QTexture3D. The voxels
+* are handed to Qt3D through a data generator, so they are uploaded once and not copied per frame.
+*
+* @brief Texture image holding volume data.
+*/
+
+class DISP3DSHARED_EXPORT VolumeTextureImage : public Qt3DRender::QAbstractTextureImage
+{
+    Q_OBJECT
+
+public:
+    //=========================================================================================================
+    /**
+    * Default constructs a VolumeTextureImage object.
+    *
+    * @param[in] parent         The parent of this object.
+    */
+    explicit VolumeTextureImage(Qt3DCore::QNode *parent = Q_NULLPTR);
+
+    //=========================================================================================================
+    /**
+    * Sets the voxels of the volume. The voxels are ordered x fastest, then y and z. Every row must have an even
+    * number of voxels, so the rows stay aligned to four bytes.
+    *
+    * @param[in] data           The voxels as quint16.
+    * @param[in] iWidth         The number of voxels in x direction.
+    * @param[in] iHeight        The number of voxels in y direction.
+    * @param[in] iDepth         The number of voxels in z direction.
+    */
+    void setVolume(const QByteArray &data,
+                   int iWidth,
+                   int iHeight,
+                   int iDepth);
+
+protected:
+    //=========================================================================================================
+    /**
+    * QAbstractTextureImage functions
+    */
+    Qt3DRender::QTextureImageDataGeneratorPtr dataGenerator() const Q_DECL_OVERRIDE;
+
+    QByteArray      m_data;             /**< The voxels as quint16. */
+    int             m_iWidth;           /**< The number of voxels in x direction. */
+    int             m_iHeight;          /**< The number of voxels in y direction. */
+    int             m_iDepth;           /**< The number of voxels in z direction. */
+    quint64         m_iGeneration;      /**< Incremented whenever the voxels change, used to compare generators. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+
+} // namespace DISP3DLIB
+
+#endif // DISP3DLIB_VOLUMETEXTUREIMAGE_H
@@ -46,16 +46,22 @@
 #include "items/sourcespace/sourcespacetreeitem.h"
 #include "items/measurement/measurementtreeitem.h"
 #include "items/mri/mritreeitem.h"
+#include "items/mri/mrivolumetreeitem.h"
 #include "items/digitizer/digitizertreeitem.h"
 #include "items/sensordata/sensordatatreeitem.h"
+#include "items/common/abstracttreeitem.h"
 #include "3dhelpers/renderable3Dentity.h"
+#include "3dhelpers/framescheduler.h"
 
 #include <inverse/dipoleFit/ecd_set.h>
 
 #include <fs/surfaceset.h>
 #include <fs/annotationset.h>
 
+#include <mne/mne_sourcespace.h>
+
 #include <fiff/fiff_dig_point_set.h>
+#include <fiff/fiff_stream.h>
 
 
 //*************************************************************************************************************
@@ -67,6 +73,10 @@
 #include <Qt3DCore/QEntity>
 #include <QSurfaceFormat>
 #include <QGLFormat>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -85,6 +95,67 @@ using namespace MNELIB;
 using namespace DISP3DLIB;
 using namespace INVERSELIB;
 using namespace CONNECTIVITYLIB;
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+struct SurfaceData {
+    bool        bLoaded;
+    Surface     surface;
+    Annotation  annotation;
+};
+
+struct SourceSpaceData {
+    bool            bLoaded;
+    MNESourceSpace  sourceSpace;
+};
+
+struct BemData {
+    bool    bLoaded;
+    MNEBem  bem;
+};
+
+SurfaceData readSurface(const QString& sSurfaceFile, const QString& sAnnotationFile)
+{
+    SurfaceData data;
+    data.bLoaded = Surface::read(sSurfaceFile, data.surface);
+
+    if(data.bLoaded && !sAnnotationFile.isEmpty()) {
+        data.bLoaded = Annotation::read(sAnnotationFile, data.annotation);
+    }
+
+    return data;
+}
+
+SourceSpaceData readSourceSpace(const QString& sSourceSpaceFile)
+{
+    SourceSpaceData data;
+    QFile file(sSourceSpaceFile);
+    FiffStream::SPtr pStream(new FiffStream(&file));
+
+    data.bLoaded = MNESourceSpace::readFromStream(pStream, true, data.sourceSpace);
+
+    return data;
+}
+
+BemData readBem(const QString& sBemFile)
+{
+    BemData data;
+    QFile file(sBemFile);
+
+    data.bem = MNEBem(file);
+    data.bLoaded = !data.bem.isEmpty();
+
+    return data;
+}
+
+}
 
 
 //*************************************************************************************************************
@@ -99,6 +170,8 @@ Data3DTreeModel::Data3DTreeModel(QObject* parent)
     m_pRootItem = this->invisibleRootItem();
     m_pRootItem->setText("Loaded 3D Data");
 
+    m_pFrameScheduler = new FrameScheduler(m_pModelEntity, this);
+
     initMetatypes();
 }
 
@@ -211,6 +284,37 @@ FsSurfaceTreeItem* Data3DTreeModel::addSurface(const QString& subject,
 }
 
 
+//*************************************************************************************************************
+
+MriVolumeTreeItem* Data3DTreeModel::addVolume(const QString& sSubject,
+                                              const QString& sMriSetName,
+                                              const Eigen::VectorXf& vecVoxels,
+                                              int iWidth,
+                                              int iHeight,
+                                              int iDepth,
+                                              const QMatrix4x4& matVoxelToSurface)
+{
+    MriVolumeTreeItem* pReturnItem = Q_NULLPTR;
+
+    //Handle subject item
+    SubjectTreeItem* pSubjectItem = addSubject(sSubject);
+
+    //Find already existing MRI items and add the new data to the first search result
+    QList<QStandardItem*> itemList = pSubjectItem->findChildren(sMriSetName);
+
+    if(!itemList.isEmpty()) {
+        MriTreeItem* pMriItem = dynamic_cast<MriTreeItem*>(itemList.first());
+        pReturnItem = pMriItem->addData(vecVoxels, iWidth, iHeight, iDepth, matVoxelToSurface, m_pModelEntity);
+    } else {
+        MriTreeItem* pMriItem = new MriTreeItem(Data3DTreeModelItemTypes::MriItem, sMriSetName);
+        AbstractTreeItem::addItemWithDescription(pSubjectItem, pMriItem);
+        pReturnItem = pMriItem->addData(vecVoxels, iWidth, iHeight, iDepth, matVoxelToSurface, m_pModelEntity);
+    }
+
+    return pReturnItem;
+}
+
+
 //*************************************************************************************************************
 
 SourceSpaceTreeItem* Data3DTreeModel::addSourceSpace(const QString& sSubject,
@@ -355,6 +459,34 @@ NetworkTreeItem* Data3DTreeModel::addConnectivityData(const QString& sSubject,
 }
 
 
+//*************************************************************************************************************
+
+NetworkTreeItem* Data3DTreeModel::addConnectivityData(const QString& sSubject,
+                                                      const QString& sMeasurementSetName,
+                                                      const SparseNetwork& networkData)
+{
+    NetworkTreeItem* pReturnItem = Q_NULLPTR;
+
+    //Handle subject item
+    SubjectTreeItem* pSubjectItem = addSubject(sSubject);
+
+    //Find already existing surface items and add the new data to the first search result
+    QList<QStandardItem*> itemList = pSubjectItem->findChildren(sMeasurementSetName);
+
+    if(!itemList.isEmpty() && (itemList.first()->type() == Data3DTreeModelItemTypes::MeasurementItem)) {
+        if(MeasurementTreeItem* pMeasurementItem = dynamic_cast<MeasurementTreeItem*>(itemList.first())) {
+            pReturnItem = pMeasurementItem->addData(networkData, m_pModelEntity);
+        }
+    } else {
+        MeasurementTreeItem* pMeasurementItem = new MeasurementTreeItem(Data3DTreeModelItemTypes::MeasurementItem, sMeasurementSetName);
+        AbstractTreeItem::addItemWithDescription(pSubjectItem, pMeasurementItem);
+        pReturnItem = pMeasurementItem->addData(networkData, m_pModelEntity);
+    }
+
+    return pReturnItem;
+}
+
+
 //*************************************************************************************************************
 
 BemTreeItem* Data3DTreeModel::addBemData(const QString& sSubject,
@@ -516,6 +648,105 @@ SensorDataTreeItem* Data3DTreeModel::addSensorData(const QString& sSubject,
 }
 
 
+//*************************************************************************************************************
+
+void Data3DTreeModel::addSurfaceAsync(const QString& sSubject,
+                                      const QString& sMriSetName,
+                                      const QString& sSurfaceFile,
+                                      const QString& sAnnotationFile)
+{
+    QPointer<AbstractTreeItem> pLoadingItem = addLoadingItem(sSubject, sSurfaceFile);
+    QFutureWatcher<SurfaceData>* pWatcher = new QFutureWatcher<SurfaceData>(this);
+
+    connect(pWatcher, &QFutureWatcher<SurfaceData>::finished, this, [=]() {
+        SurfaceData data = pWatcher->result();
+        pWatcher->deleteLater();
+
+        if(!removeLoadingItem(pLoadingItem)) {
+            return;
+        }
+
+        if(!data.bLoaded) {
+            qWarning() << "Data3DTreeModel::addSurfaceAsync - Could not load" << sSurfaceFile << sAnnotationFile;
+            emit loadingFailed(sSurfaceFile);
+            return;
+        }
+
+        emit surfaceAdded(addSurface(sSubject, sMriSetName, data.surface, data.annotation));
+    });
+
+    pWatcher->setFuture(QtConcurrent::run(readSurface, sSurfaceFile, sAnnotationFile));
+}
+
+
+//*************************************************************************************************************
+
+void Data3DTreeModel::addSourceSpaceAsync(const QString& sSubject,
+                                          const QString& sMeasurementSetName,
+                                          const QString& sSourceSpaceFile)
+{
+    QPointer<AbstractTreeItem> pLoadingItem = addLoadingItem(sSubject, sSourceSpaceFile);
+    QFutureWatcher<SourceSpaceData>* pWatcher = new QFutureWatcher<SourceSpaceData>(this);
+
+    connect(pWatcher, &QFutureWatcher<SourceSpaceData>::finished, this, [=]() {
+        SourceSpaceData data = pWatcher->result();
+        pWatcher->deleteLater();
+
+        if(!removeLoadingItem(pLoadingItem)) {
+            return;
+        }
+
+        if(!data.bLoaded) {
+            qWarning() << "Data3DTreeModel::addSourceSpaceAsync - Could not load" << sSourceSpaceFile;
+            emit loadingFailed(sSourceSpaceFile);
+            return;
+        }
+
+        emit sourceSpaceAdded(addSourceSpace(sSubject, sMeasurementSetName, data.sourceSpace));
+    });
+
+    pWatcher->setFuture(QtConcurrent::run(readSourceSpace, sSourceSpaceFile));
+}
+
+
+//*************************************************************************************************************
+
+void Data3DTreeModel::addBemDataAsync(const QString& sSubject,
+                                      const QString& sBemSetName,
+                                      const QString& sBemFile)
+{
+    QPointer<AbstractTreeItem> pLoadingItem = addLoadingItem(sSubject, sBemFile);
+    QFutureWatcher<BemData>* pWatcher = new QFutureWatcher<BemData>(this);
+
+    connect(pWatcher, &QFutureWatcher<BemData>::finished, this, [=]() {
+        BemData data = pWatcher->result();
+        pWatcher->deleteLater();
+
+        if(!removeLoadingItem(pLoadingItem)) {
+            return;
+        }
+
+        if(!data.bLoaded) {
+            qWarning() << "Data3DTreeModel::addBemDataAsync - Could not load" << sBemFile;
+            emit loadingFailed(sBemFile);
+            return;
+        }
+
+        emit bemDataAdded(addBemData(sSubject, sBemSetName, data.bem));
+    });
+
+    pWatcher->setFuture(QtConcurrent::run(readBem, sBemFile));
+}
+
+
+//*************************************************************************************************************
+
+QPointer<FrameScheduler> Data3DTreeModel::getFrameScheduler()
+{
+    return m_pFrameScheduler;
+}
+
+
 //*************************************************************************************************************
 
 QPointer<Qt3DCore::QEntity> Data3DTreeModel::getRootEntity()
@@ -547,6 +778,41 @@ SubjectTreeItem* Data3DTreeModel::addSubject(const QString& sSubject)
 }
 
 
+//*************************************************************************************************************
+
+QPointer<AbstractTreeItem> Data3DTreeModel::addLoadingItem(const QString& sSubject,
+                                                           const QString& sFilePath)
+{
+    SubjectTreeItem* pSubjectItem = addSubject(sSubject);
+
+    AbstractTreeItem* pLoadingItem = new AbstractTreeItem(Data3DTreeModelItemTypes::LoadingItem,
+                                                          QString("Loading %1").arg(QFileInfo(sFilePath).fileName()));
+    pLoadingItem->setEditable(false);
+    pLoadingItem->setToolTip(sFilePath);
+
+    AbstractTreeItem::addItemWithDescription(pSubjectItem, pLoadingItem);
+
+    return pLoadingItem;
+}
+
+
+//*************************************************************************************************************
+
+bool Data3DTreeModel::removeLoadingItem(QPointer<AbstractTreeItem> pLoadingItem)
+{
+    //The placeholder is gone if the user removed it or its subject while loading
+    if(!pLoadingItem) {
+        return false;
+    }
+
+    if(QStandardItem* pParentItem = pLoadingItem->QStandardItem::parent()) {
+        pParentItem->removeRow(pLoadingItem->row());
+    }
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 void Data3DTreeModel::initMetatypes()
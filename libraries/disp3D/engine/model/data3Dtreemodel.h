@@ -47,6 +47,7 @@
 #include <mne/mne_bem.h>
 
 #include <connectivity/network/network.h>
+#include <connectivity/network/sparsenetwork.h>
 
 
 //*************************************************************************************************************
@@ -56,6 +57,7 @@
 
 #include <QStandardItemModel>
 #include <QPointer>
+#include <QMatrix4x4>
 
 
 //*************************************************************************************************************
@@ -118,6 +120,7 @@ class MneEstimateTreeItem;
 class NetworkTreeItem;
 class EcdDataTreeItem;
 class FsSurfaceTreeItem;
+class MriVolumeTreeItem;
 class SourceSpaceTreeItem;
 class BemTreeItem;
 class SensorSetTreeItem;
@@ -125,6 +128,8 @@ class DigitizerSetTreeItem;
 class SubjectTreeItem;
 class MeasurementTreeItem;
 class SensorDataTreeItem;
+class AbstractTreeItem;
+class FrameScheduler;
 
 
 //=============================================================================================================
@@ -192,6 +197,28 @@ public:
                                   const FSLIB::Surface& surface,
                                   const FSLIB::Annotation& annotation = FSLIB::Annotation());
 
+    //=========================================================================================================
+    /**
+    * Adds an MRI volume which is rendered on the GPU.
+    *
+    * @param[in] sSubject               The name of the subject.
+    * @param[in] sMriSetName            The name of the MRI set to which the data is to be added. If it does not exist yet, it will be created.
+    * @param[in] vecVoxels              The voxels, x fastest, then y and z.
+    * @param[in] iWidth                 The number of voxels in x direction.
+    * @param[in] iHeight                The number of voxels in y direction.
+    * @param[in] iDepth                 The number of voxels in z direction.
+    * @param[in] matVoxelToSurface      Maps voxel indices to the coordinates of the surfaces.
+    *
+    * @return                           Returns a pointer to the added tree item.
+    */
+    MriVolumeTreeItem* addVolume(const QString& sSubject,
+                                 const QString& sMriSetName,
+                                 const Eigen::VectorXf& vecVoxels,
+                                 int iWidth,
+                                 int iHeight,
+                                 int iDepth,
+                                 const QMatrix4x4& matVoxelToSurface);
+
     //=========================================================================================================
     /**
     * Adds source space brain data.
@@ -268,6 +295,20 @@ public:
                                          const QString& sMeasurementSetName,
                                          const CONNECTIVITYLIB::Network& networkData);
 
+    //=========================================================================================================
+    /**
+    * Adds connectivity estimation data.
+    *
+    * @param[in] sSubject               The name of the subject.
+    * @param[in] sMeasurementSetName    The name of the measurement set to which the data is to be added. If it does not exist yet, it will be created.
+    * @param[in] networkData            The sparse connectivity data.
+    *
+    * @return                           Returns a pointer to the added tree item. Default is a NULL pointer if no item was added.
+    */
+    NetworkTreeItem* addConnectivityData(const QString& sSubject,
+                                         const QString& sMeasurementSetName,
+                                         const CONNECTIVITYLIB::SparseNetwork& networkData);
+
     //=========================================================================================================
     /**
     * Adds BEM data.
@@ -347,6 +388,45 @@ public:
                                       const FIFFLIB::FiffInfo &fiffInfo,
                                       const QString &sDataType);
 
+    //=========================================================================================================
+    /**
+    * Reads a FreeSurfer surface and its annotation on a worker thread. A placeholder item is added to the subject
+    * right away and replaced by the surface item once loading finished. Removing the placeholder cancels the insert.
+    *
+    * @param[in] sSubject           The name of the subject.
+    * @param[in] sMriSetName        The name of the MRI set to which the data is to be added. If it does not exist yet, it will be created.
+    * @param[in] sSurfaceFile       The path to the FreeSurfer surface file.
+    * @param[in] sAnnotationFile    The path to the FreeSurfer annotation file. No annotation is loaded if empty.
+    */
+    void addSurfaceAsync(const QString& sSubject,
+                         const QString& sMriSetName,
+                         const QString& sSurfaceFile,
+                         const QString& sAnnotationFile = QString());
+
+    //=========================================================================================================
+    /**
+    * Reads a source space on a worker thread. See addSurfaceAsync for the placeholder handling.
+    *
+    * @param[in] sSubject               The name of the subject.
+    * @param[in] sMeasurementSetName    The name of the measurement set to which the data is to be added. If it does not exist yet, it will be created.
+    * @param[in] sSourceSpaceFile       The path to the fiff file holding the source space.
+    */
+    void addSourceSpaceAsync(const QString& sSubject,
+                             const QString& sMeasurementSetName,
+                             const QString& sSourceSpaceFile);
+
+    //=========================================================================================================
+    /**
+    * Reads BEM data on a worker thread. See addSurfaceAsync for the placeholder handling.
+    *
+    * @param[in] sSubject           The name of the subject.
+    * @param[in] sBemSetName        The name of the BEM set to which the data is to be added. If it does not exist yet, it will be created.
+    * @param[in] sBemFile           The path to the fiff file holding the BEM.
+    */
+    void addBemDataAsync(const QString& sSubject,
+                         const QString& sBemSetName,
+                         const QString& sBemFile);
+
     //=========================================================================================================
     /**
     * Returns the 3D model root entity.
@@ -355,6 +435,14 @@ public:
     */
     QPointer<Qt3DCore::QEntity> getRootEntity();
 
+    //=========================================================================================================
+    /**
+    * Returns the frame scheduler which paces the real-time updates of the items to the frames of the scene.
+    *
+    * @return   The frame scheduler of this model.
+    */
+    QPointer<FrameScheduler> getFrameScheduler();
+
 protected:
     //=========================================================================================================
     /**
@@ -366,6 +454,28 @@ protected:
     */
     SubjectTreeItem* addSubject(const QString& sSubject);
 
+    //=========================================================================================================
+    /**
+    * Adds a placeholder item to the subject which is shown while data is loaded in the background.
+    *
+    * @param[in] sSubject           The name of the subject.
+    * @param[in] sFilePath          The file which is loaded.
+    *
+    * @return                       Returns a pointer to the placeholder item. The pointer becomes NULL if the item was removed.
+    */
+    QPointer<AbstractTreeItem> addLoadingItem(const QString& sSubject,
+                                              const QString& sFilePath);
+
+    //=========================================================================================================
+    /**
+    * Removes a placeholder item once loading in the background finished.
+    *
+    * @param[in] pLoadingItem       The placeholder item.
+    *
+    * @return                       Returns false if the placeholder was removed in the meantime, i.e. loading was cancelled.
+    */
+    bool removeLoadingItem(QPointer<AbstractTreeItem> pLoadingItem);
+
     //=========================================================================================================
     /**
     * Adds live sensor data for interpolation with the cpu.
@@ -422,6 +532,40 @@ protected:
 
     QStandardItem*                   m_pRootItem;            /**< The root item of the tree model. */
     QPointer<Qt3DCore::QEntity>      m_pModelEntity;         /**< The parent 3D entity for this model. */
+    QPointer<FrameScheduler>         m_pFrameScheduler;      /**< Applies the real-time item updates once per frame. */
+
+signals:
+    //=========================================================================================================
+    /**
+    * Emitted when a surface which was loaded in the background was added to the model.
+    *
+    * @param[in] pItem              The added surface item.
+    */
+    void surfaceAdded(FsSurfaceTreeItem* pItem);
+
+    //=========================================================================================================
+    /**
+    * Emitted when a source space which was loaded in the background was added to the model.
+    *
+    * @param[in] pItem              The added source space item.
+    */
+    void sourceSpaceAdded(SourceSpaceTreeItem* pItem);
+
+    //=========================================================================================================
+    /**
+    * Emitted when BEM data which was loaded in the background was added to the model.
+    *
+    * @param[in] pItem              The added BEM item.
+    */
+    void bemDataAdded(BemTreeItem* pItem);
+
+    //=========================================================================================================
+    /**
+    * Emitted when a file could not be loaded in the background.
+    *
+    * @param[in] sFilePath          The file which could not be loaded.
+    */
+    void loadingFailed(const QString& sFilePath);
 };
 
 } // NAMESPACE
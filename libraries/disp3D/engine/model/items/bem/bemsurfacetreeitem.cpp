@@ -104,6 +104,7 @@ void BemSurfaceTreeItem::addData(const MNEBemSurface& tBemSurface)
                                 tBemSurface.tris,
                                 matVertColor,
                                 Qt3DRender::QGeometryRenderer::Triangles);
+    m_pCustomMesh->createLevelsOfDetail();
 
     //Find out BEM layer type and change items name
     this->setText(MNEBemSurface::id_name(tBemSurface.id));
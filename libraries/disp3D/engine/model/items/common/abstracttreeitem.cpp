@@ -38,6 +38,8 @@
 //=============================================================================================================
 
 #include "abstracttreeitem.h"
+#include "../../data3Dtreemodel.h"
+#include "../../3dhelpers/framescheduler.h"
 
 
 //*************************************************************************************************************
@@ -195,3 +197,18 @@ void AbstractTreeItem::onCheckStateChanged(const Qt::CheckState& checkState)
         }
     }
 }
+
+
+//*************************************************************************************************************
+
+void AbstractTreeItem::scheduleFrameUpdate(const std::function<void()>& funcUpdate)
+{
+    if(Data3DTreeModel* pModel = qobject_cast<Data3DTreeModel*>(this->model())) {
+        if(QPointer<FrameScheduler> pScheduler = pModel->getFrameScheduler()) {
+            pScheduler->scheduleUpdate(this, funcUpdate);
+            return;
+        }
+    }
+
+    funcUpdate();
+}
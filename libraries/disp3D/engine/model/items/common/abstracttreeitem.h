@@ -44,6 +44,8 @@
 #include "../../../../disp3D_global.h"
 #include "types.h"
 
+#include <functional>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -167,6 +169,15 @@ protected:
     */
     virtual void onCheckStateChanged(const Qt::CheckState& checkState);
 
+    //=========================================================================================================
+    /**
+    * Schedules a real-time update of this item for the next frame of the model's FrameScheduler. A pending update
+    * of this item is replaced. If the item is not part of a Data3DTreeModel the update is applied right away.
+    *
+    * @param[in] funcUpdate        The update, e.g. uploading new vertex colors.
+    */
+    void scheduleFrameUpdate(const std::function<void()>& funcUpdate);
+
     int             m_iType;            /**< This item's type. */
     Qt::CheckState  m_checkStateOld;    /**< This item's old check state. */
 
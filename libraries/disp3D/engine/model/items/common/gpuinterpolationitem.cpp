@@ -43,6 +43,8 @@
 #include "../../materials/gpuinterpolationmaterial.h"
 #include "../../3dhelpers/custommesh.h"
 
+#include <cstring>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -88,11 +90,15 @@ using namespace Eigen;
 GpuInterpolationItem::GpuInterpolationItem(Qt3DCore::QEntity *p3DEntityParent, int iType, const QString &text)
 : Abstract3DTreeItem(p3DEntityParent, iType, text)
 , m_bIsDataInit(false)
+, m_iTimeSeriesSamples(0)
 , m_pGPUMaterial(new GpuInterpolationMaterial())
 , m_pCustomMesh(new CustomMesh)
 , m_pInterpolationMatBuffer(new Qt3DRender::QBuffer())
+, m_pInterpolationRowPtrBuffer(new Qt3DRender::QBuffer())
+, m_pInterpolationColIdxBuffer(new Qt3DRender::QBuffer())
 , m_pOutputColorBuffer(new Qt3DRender::QBuffer())
 , m_pSignalDataBuffer(new Qt3DRender::QBuffer())
+, m_pSignalSeriesBuffer(new Qt3DRender::QBuffer())
 {
 }
 
@@ -102,8 +108,11 @@ GpuInterpolationItem::GpuInterpolationItem(Qt3DCore::QEntity *p3DEntityParent, i
 GpuInterpolationItem::~GpuInterpolationItem()
 {
     delete m_pInterpolationMatBuffer;
+    delete m_pInterpolationRowPtrBuffer;
+    delete m_pInterpolationColIdxBuffer;
     delete m_pOutputColorBuffer;
     delete m_pSignalDataBuffer;
+    delete m_pSignalSeriesBuffer;
 }
 
 
@@ -137,10 +146,16 @@ void GpuInterpolationItem::initData(const MatrixX3f &matVertices,
 
     m_pInterpolationMatBuffer->setData(buildZeroBuffer(1));
     this->setMaterialParameter(QVariant::fromValue(m_pInterpolationMatBuffer.data()), QStringLiteral("InterpolationMat"));
+    m_pInterpolationRowPtrBuffer->setData(buildZeroBuffer(2));
+    this->setMaterialParameter(QVariant::fromValue(m_pInterpolationRowPtrBuffer.data()), QStringLiteral("InterpolationRowPtr"));
+    m_pInterpolationColIdxBuffer->setData(buildZeroBuffer(1));
+    this->setMaterialParameter(QVariant::fromValue(m_pInterpolationColIdxBuffer.data()), QStringLiteral("InterpolationColIdx"));
     m_pOutputColorBuffer->setData(buildZeroBuffer(4));
     this->setMaterialParameter(QVariant::fromValue(m_pOutputColorBuffer.data()), QStringLiteral("OutputColor"));
     m_pSignalDataBuffer->setData(buildZeroBuffer(1));
     this->setMaterialParameter(QVariant::fromValue(m_pSignalDataBuffer.data()), QStringLiteral("InputVec"));
+    m_pSignalSeriesBuffer->setData(buildZeroBuffer(1));
+    this->setMaterialParameter(QVariant::fromValue(m_pSignalSeriesBuffer.data()), QStringLiteral("InputSeries"));
 
     //Set custom mesh data
     //generate mesh base color
@@ -167,11 +182,14 @@ void GpuInterpolationItem::setInterpolationMatrix(QSharedPointer<Eigen::SparseMa
         return;
     }
 
-    //qDebug("GpuInterpolationItem::setInterpolationMatrix - buildInterpolationMatrixBuffer");
-    QByteArray interpolationBufferData = buildInterpolationMatrixBuffer(pMatInterpolationMatrix);
+    QByteArray rowPtrData, colIdxData, valueData;
+    buildInterpolationMatrixBuffers(pMatInterpolationMatrix, rowPtrData, colIdxData, valueData);
+
+    //Init output and signal buffers if the dimensions changed
+    const int iColorBufferSize = 4 * pMatInterpolationMatrix->rows() * (int)sizeof(float);
+    const int iSignalBufferSize = pMatInterpolationMatrix->cols() * (int)sizeof(float);
 
-    //Init and set interpolation buffer
-    if(m_pInterpolationMatBuffer->data().size() != interpolationBufferData.size()) {
+    if(!m_pComputeCommand || m_pOutputColorBuffer->data().size() != iColorBufferSize || m_pSignalDataBuffer->data().size() != iSignalBufferSize) {
 
         //Set Rows and Cols
         this->setMaterialParameter(QVariant::fromValue(pMatInterpolationMatrix->cols()), QStringLiteral("cols"));
@@ -189,58 +207,78 @@ void GpuInterpolationItem::setInterpolationMatrix(QSharedPointer<Eigen::SparseMa
         m_pComputeCommand->setWorkGroupX(iWorkGroupsSize);
         m_pComputeCommand->setWorkGroupY(iWorkGroupsSize);
         m_pComputeCommand->setWorkGroupZ(1);
-
-        //qDebug() << "4 * pMatInterpolationMatrix->rows()"<<4 * pMatInterpolationMatrix->rows();
-        //qDebug() << "pMatInterpolationMatrix->rows()*pMatInterpolationMatrix->cols()"<<pMatInterpolationMatrix->rows()*pMatInterpolationMatrix->cols();
     }
 
-    m_pInterpolationMatBuffer->setData(interpolationBufferData);
+    //Only the non-zero weights are uploaded, their number changes with the cancel distance
+    m_pInterpolationRowPtrBuffer->setData(rowPtrData);
+    m_pInterpolationColIdxBuffer->setData(colIdxData);
+    m_pInterpolationMatBuffer->setData(valueData);
 
-//        QByteArray updateData;
-//        updateData.resize(pMatInterpolationMatrix->cols() * sizeof(float));
-//        float *rawVertexArray = reinterpret_cast<float *>(updateData.data());
+    qDebug("GpuInterpolationItem::setInterpolationMatrix - finished");
+}
 
-//        int pos = 0; //matrix element offset
 
-//        for(uint i = 0; i < pMatInterpolationMatrix->rows(); ++i) {
-//            //qDebug()<<"row "<<i;
+//*************************************************************************************************************
 
-//            //Extract row
-//            int itr = 0;
-//            for(uint j = 0; j < pMatInterpolationMatrix->cols(); ++j) {
-//                rawVertexArray[itr] = pMatInterpolationMatrix->coeff(i,j);
-//                itr++;
-//            }
+void GpuInterpolationItem::addNewRtData(const VectorXf &tSignalVec)
+{
+    if(m_bIsDataInit == false)
+    {
+        qDebug("GpuInterpolationItem::addNewRtData - item data is not initialized!");
+        return;
+    }
 
-//            m_pInterpolationMatBuffer->updateData(pos, updateData);
-//            pos += pMatInterpolationMatrix->cols() * sizeof(float); //stride
-//        }
+    //Upload the raw signal only, interpolation and color mapping run in the compute shader
+    QByteArray bufferData(reinterpret_cast<const char*>(tSignalVec.data()), tSignalVec.rows() * (int)sizeof(float));
 
-    qDebug("GpuInterpolationItem::setInterpolationMatrix - finished");
+    m_pSignalDataBuffer->setData(bufferData);
 }
 
 
 //*************************************************************************************************************
 
-void GpuInterpolationItem::addNewRtData(const VectorXf &tSignalVec)
+void GpuInterpolationItem::setTimeSeries(const MatrixXf &matSignal)
 {
     if(m_bIsDataInit == false)
     {
-        qDebug("GpuInterpolationItem::addNewRtData - item data is not initialized!");
+        qDebug("GpuInterpolationItem::setTimeSeries - item data is not initialized!");
         return;
     }
 
-    const uint iSignalSize = tSignalVec.rows();
+    if(matSignal.cols() == 0 || matSignal.rows() * (int)sizeof(float) != m_pSignalDataBuffer->data().size()) {
+        qDebug("GpuInterpolationItem::setTimeSeries - number of rows (%d) does not match the interpolation matrix!", (int)matSignal.rows());
+        return;
+    }
 
-    QByteArray bufferData (iSignalSize * (int)sizeof(float), '0');
-    float *rawVertexArray = reinterpret_cast<float *>(bufferData.data());
+    //Eigen stores column major, so the samples already follow each other as the shader expects
+    QByteArray bufferData(reinterpret_cast<const char*>(matSignal.data()), matSignal.size() * (int)sizeof(float));
+    m_pSignalSeriesBuffer->setData(bufferData);
 
-    for(uint i = 0; i < iSignalSize; ++i)
-    {
-        rawVertexArray[i] = static_cast<float>(tSignalVec[i]);
+    m_iTimeSeriesSamples = matSignal.cols();
+    this->setMaterialParameter(QVariant::fromValue(m_iTimeSeriesSamples), QStringLiteral("samples"));
+    this->setMaterialParameter(QVariant::fromValue(1), QStringLiteral("TimeSeriesMode"));
+}
+
+
+//*************************************************************************************************************
+
+void GpuInterpolationItem::setCurrentSample(float fSample)
+{
+    this->setMaterialParameter(QVariant::fromValue(fSample), QStringLiteral("fCurrentSample"));
+}
+
+
+//*************************************************************************************************************
+
+void GpuInterpolationItem::clearTimeSeries()
+{
+    if(m_iTimeSeriesSamples == 0) {
+        return;
     }
 
-    m_pSignalDataBuffer->setData(bufferData);
+    this->setMaterialParameter(QVariant::fromValue(0), QStringLiteral("TimeSeriesMode"));
+    m_pSignalSeriesBuffer->setData(buildZeroBuffer(1));
+    m_iTimeSeriesSamples = 0;
 }
 
 
@@ -274,34 +312,35 @@ void GpuInterpolationItem::setColormapType(const QString &tColormapType)
 
 //*************************************************************************************************************
 
-QByteArray GpuInterpolationItem::buildInterpolationMatrixBuffer(QSharedPointer<Eigen::SparseMatrix<float> > pMatInterpolationMatrix)
+void GpuInterpolationItem::buildInterpolationMatrixBuffers(QSharedPointer<Eigen::SparseMatrix<float> > pMatInterpolationMatrix,
+                                                           QByteArray& rowPtrData,
+                                                           QByteArray& colIdxData,
+                                                           QByteArray& valueData)
 {
-    const uint iRows = pMatInterpolationMatrix->rows();
-    const uint iCols = pMatInterpolationMatrix->cols();
-
-//    qDebug() << "(int)sizeof(float)" << (int)sizeof(float);
-//    qDebug() << "GpuInterpolationItem::buildInterpolationMatrixBuffer - iRows" << iRows ;
-//    qDebug() << "GpuInterpolationItem::buildInterpolationMatrixBuffer - iCols" << iCols;
-//    qDebug() << "GpuInterpolationItem::buildInterpolationMatrixBuffer - iRows * iCols " << iRows * iCols;
-//    qDebug() << "GpuInterpolationItem::buildInterpolationMatrixBuffer - iRows * iCols * (int)sizeof(float) " << iRows * iCols * (int)sizeof(float);
-
-    QByteArray bufferData (iRows * iCols * (int)sizeof(float), '0');
+    //The shader reads one row per vertex, so store the matrix row major
+    SparseMatrix<float, RowMajor> matCsr = *pMatInterpolationMatrix;
+    matCsr.makeCompressed();
 
-    // We do not need to use the buildZeroBuffer because we need to go through the non-zero entries again
-    //qDebug() << "GpuInterpolationItem::buildInterpolationMatrixBuffer - Fill Byte Array";
-    float *rawVertexArray = reinterpret_cast<float *>(bufferData.data());
+    const int iRows = matCsr.rows();
+    const int iNonZeros = matCsr.nonZeros();
 
-    unsigned int iCtr = 0;
-    for(uint i = 0; i < iRows; ++i) {
-        for(uint j = 0; j < iCols; ++j) {
-            rawVertexArray[iCtr] = static_cast<float>(pMatInterpolationMatrix->coeff(i, j));
-            iCtr++;
-        }
+    rowPtrData.resize((iRows + 1) * (int)sizeof(quint32));
+    quint32 *rawRowPtr = reinterpret_cast<quint32 *>(rowPtrData.data());
+    for(int i = 0; i <= iRows; ++i) {
+        rawRowPtr[i] = static_cast<quint32>(matCsr.outerIndexPtr()[i]);
     }
 
-    //qDebug() << "GpuInterpolationItem::buildInterpolationMatrixBuffer - Finished";
+    //Keep at least one element, empty buffers can not be bound
+    colIdxData.fill(0, qMax(iNonZeros, 1) * (int)sizeof(quint32));
+    quint32 *rawColIdx = reinterpret_cast<quint32 *>(colIdxData.data());
+    for(int i = 0; i < iNonZeros; ++i) {
+        rawColIdx[i] = static_cast<quint32>(matCsr.innerIndexPtr()[i]);
+    }
 
-    return bufferData;
+    valueData = buildZeroBuffer(qMax(iNonZeros, 1));
+    if(iNonZeros > 0) {
+        memcpy(valueData.data(), matCsr.valuePtr(), iNonZeros * sizeof(float));
+    }
 }
 
 
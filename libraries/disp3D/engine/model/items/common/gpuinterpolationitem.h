@@ -153,6 +153,38 @@ public:
     */
     virtual void addNewRtData(const Eigen::VectorXf &tSignalVec);
 
+    //=========================================================================================================
+    /**
+    * Uploads a whole time series once and switches to time series playback. Afterwards only the displayed sample is
+    * sent per frame via setCurrentSample, the interpolation between samples, the thresholding and the color mapping
+    * run in the compute shader. Call clearTimeSeries to switch back to addNewRtData.
+    *
+    * @param[in] matSignal              The time series with one row per sensor and one column per sample.
+    */
+    virtual void setTimeSeries(const Eigen::MatrixXf &matSignal);
+
+    //=========================================================================================================
+    /**
+    * Sets the displayed sample of the uploaded time series. Fractional samples are interpolated linearly.
+    *
+    * @param[in] fSample                The sample relative to the first uploaded sample.
+    */
+    virtual void setCurrentSample(float fSample);
+
+    //=========================================================================================================
+    /**
+    * Releases the uploaded time series and switches back to the data passed to addNewRtData.
+    */
+    virtual void clearTimeSeries();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples of the uploaded time series.
+    *
+    * @return                           The number of samples, 0 if no time series is uploaded.
+    */
+    inline int timeSeriesSamples() const;
+
     //=========================================================================================================
     /**
     * This function set the normalization value.
@@ -172,13 +204,18 @@ public:
 protected:
     //=========================================================================================================
     /**
-    * Build the content of the Interpolation matrix buffer.
+    * Build the content of the Interpolation matrix buffers in compressed sparse row form, so the compute shader only
+    * visits the non-zero weights of each vertex.
     *
     * @param[in] pMatInterpolationMatrix    The Interpolation matrix.
-    *
-    * @return                          Interpolation matrix is byte array form.
+    * @param[out] rowPtrData                The offset of the first non-zero weight of each row, plus the total number of non-zeros (uint).
+    * @param[out] colIdxData                The column of each non-zero weight (uint).
+    * @param[out] valueData                 The non-zero weights (float).
     */
-    virtual QByteArray buildInterpolationMatrixBuffer(QSharedPointer<Eigen::SparseMatrix<float> > pMatInterpolationMatrix);
+    virtual void buildInterpolationMatrixBuffers(QSharedPointer<Eigen::SparseMatrix<float> > pMatInterpolationMatrix,
+                                                 QByteArray& rowPtrData,
+                                                 QByteArray& colIdxData,
+                                                 QByteArray& valueData);
 
     //=========================================================================================================
     /**
@@ -191,15 +228,19 @@ protected:
     virtual QByteArray buildZeroBuffer(const uint tSize);
 
     bool                                    m_bIsDataInit;                  /**< The data initialization flag. */
+    int                                     m_iTimeSeriesSamples;           /**< The number of samples in the time series buffer, 0 if not in time series playback. */
 
     QPointer<GpuInterpolationMaterial>      m_pGPUMaterial;                 /**< Compute material used for the process. */
 
     QPointer<CustomMesh>                    m_pCustomMesh;                  /**< The actual mesh information (vertices, normals, colors). */
     QPointer<Qt3DRender::QComputeCommand>   m_pComputeCommand;              /**< The compute command defines the work group size for the compute shader code execution . */
 
-    QPointer<Qt3DRender::QBuffer>           m_pInterpolationMatBuffer;      /**< The QBuffer/GLBuffer holding the interpolation matrix data. */
+    QPointer<Qt3DRender::QBuffer>           m_pInterpolationMatBuffer;      /**< The QBuffer/GLBuffer holding the non-zero interpolation weights. */
+    QPointer<Qt3DRender::QBuffer>           m_pInterpolationRowPtrBuffer;   /**< The QBuffer/GLBuffer holding the row offsets of the interpolation weights. */
+    QPointer<Qt3DRender::QBuffer>           m_pInterpolationColIdxBuffer;   /**< The QBuffer/GLBuffer holding the columns of the interpolation weights. */
     QPointer<Qt3DRender::QBuffer>           m_pOutputColorBuffer;           /**< The QBuffer/GLBuffer holding the output color (interpolated) data. */
     QPointer<Qt3DRender::QBuffer>           m_pSignalDataBuffer;            /**< The QBuffer/GLBuffer holding the signal data. */
+    QPointer<Qt3DRender::QBuffer>           m_pSignalSeriesBuffer;          /**< The QBuffer/GLBuffer holding the time series, sample after sample. */
 };
 
 
@@ -208,6 +249,11 @@ protected:
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+inline int GpuInterpolationItem::timeSeriesSamples() const
+{
+    return m_iTimeSeriesSamples;
+}
+
 
 } // namespace DISP3DLIB
 
@@ -103,7 +103,9 @@ namespace Data3DTreeModelItemTypes
                     SensorPositionItem = QStandardItem::UserType + 17,
                     AbstractMeshItem = QStandardItem::UserType + 18,
                     SensorDataItem = QStandardItem::UserType + 19,
-                    GpuInterpolationItem = QStandardItem::UserType + 21};
+                    GpuInterpolationItem = QStandardItem::UserType + 21,
+                    LoadingItem = QStandardItem::UserType + 22,
+                    MriVolumeItem = QStandardItem::UserType + 23};
 }
 
 namespace MetaTreeItemTypes
@@ -62,6 +62,8 @@
 // Eigen INCLUDES
 //============================================================================= ================================
 
+#include <Eigen/Core>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -69,6 +71,7 @@
 //=============================================================================================================
 
 using namespace DISP3DLIB;
+using namespace Eigen;
 
 
 //*************************************************************************************************************
@@ -118,24 +121,16 @@ void DigitizerTreeItem::addData(const QList<FIFFLIB::FiffDigPoint>& tDigitizer,
     //Set transforms
     if(!tDigitizer.isEmpty())
     {
-        QVector<QMatrix4x4> vTransforms;
-        vTransforms.reserve(tDigitizer.size());
-
-        QVector3D tempPos;
+        MatrixX3f matPositions(tDigitizer.size(), 3);
 
         for(int i = 0; i < tDigitizer.size(); ++i) {
-            QMatrix4x4 tempTransform;
-
-            tempPos.setX(tDigitizer[i].r[0]);
-            tempPos.setY(tDigitizer[i].r[1]);
-            tempPos.setZ(tDigitizer[i].r[2]);
-
-            tempTransform.translate(tempPos);
-            vTransforms.push_back(tempTransform);
+            matPositions(i, 0) = tDigitizer[i].r[0];
+            matPositions(i, 1) = tDigitizer[i].r[1];
+            matPositions(i, 2) = tDigitizer[i].r[2];
         }
 
-        //Set instance Transform
-        m_pSphereMesh->setTransforms(vTransforms);
+        //Set instance positions
+        m_pSphereMesh->setPositions(matPositions);
     }
 
     //Update alpha
@@ -144,6 +144,7 @@ void FsSurfaceTreeItem::addData(const Surface& tSurface)
                                 tSurface.tris(),
                                 matCurvatureColor,
                                 Qt3DRender::QGeometryRenderer::Triangles);
+    m_pCustomMesh->createLevelsOfDetail();
     this->setPosition(QVector3D(-tSurface.offset()(0), -tSurface.offset()(1), -tSurface.offset()(2)));
 
     //Add data which is held by this FsSurfaceTreeItem
@@ -375,3 +375,37 @@ NetworkTreeItem* MeasurementTreeItem::addData(const Network& tNetworkData,
 
     return Q_NULLPTR;
 }
+
+
+//*************************************************************************************************************
+
+NetworkTreeItem* MeasurementTreeItem::addData(const SparseNetwork& tNetworkData,
+                                              Qt3DCore::QEntity* p3DEntityParent)
+{
+    if(tNetworkData.getNumberNodes() > 0) {
+        //Add source estimation data as child
+        if(this->findChildren(Data3DTreeModelItemTypes::NetworkItem).size() == 0) {
+            //If rt data item does not exists yet, create it here!
+            if(!m_pNetworkTreeItem) {
+                m_pNetworkTreeItem = new NetworkTreeItem(p3DEntityParent);
+            }
+
+            QList<QStandardItem*> list;
+            list << m_pNetworkTreeItem;
+            list << new QStandardItem(m_pNetworkTreeItem->toolTip());
+            this->appendRow(list);
+
+            m_pNetworkTreeItem->addData(tNetworkData);
+        } else {
+            if(m_pNetworkTreeItem) {
+                m_pNetworkTreeItem->addData(tNetworkData);
+            }
+        }
+
+        return m_pNetworkTreeItem;
+    } else {
+        qDebug() << "MeasurementTreeItem::addData - network data is empty";
+    }
+
+    return Q_NULLPTR;
+}
@@ -46,6 +46,7 @@
 
 #include <mne/mne_forwardsolution.h>
 #include <connectivity/network/network.h>
+#include <connectivity/network/sparsenetwork.h>
 
 
 //*************************************************************************************************************
@@ -227,6 +228,17 @@ public:
     NetworkTreeItem* addData(const CONNECTIVITYLIB::Network& tNetworkData,
                              Qt3DCore::QEntity* p3DEntityParent = 0);
 
+    //=========================================================================================================
+    /**
+    * Adds connectivity estimation data.
+    *
+    * @param[in] tNetworkData       The sparse connectivity data.
+    *
+    * @return                       Returns a pointer to the added tree item. Default is a NULL pointer if no item was added.
+    */
+    NetworkTreeItem* addData(const CONNECTIVITYLIB::SparseNetwork& tNetworkData,
+                             Qt3DCore::QEntity* p3DEntityParent = 0);
+
 protected:
     //=========================================================================================================
     /**
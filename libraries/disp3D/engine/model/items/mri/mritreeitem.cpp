@@ -42,6 +42,7 @@
 #include "../freesurfer/fsannotationtreeitem.h"
 #include "../freesurfer/fssurfacetreeitem.h"
 #include "../hemisphere/hemispheretreeitem.h"
+#include "mrivolumetreeitem.h"
 
 #include <fs/annotationset.h>
 #include <fs/surfaceset.h>
@@ -66,6 +67,7 @@
 
 using namespace FSLIB;
 using namespace DISP3DLIB;
+using namespace Eigen;
 
 
 //*************************************************************************************************************
@@ -156,3 +158,23 @@ FsSurfaceTreeItem* MriTreeItem::addData(const Surface& tSurface, const Annotatio
     return pReturnItem;
 }
 
+
+//*************************************************************************************************************
+
+MriVolumeTreeItem* MriTreeItem::addData(const VectorXf& vecVoxels,
+                                        int iWidth,
+                                        int iHeight,
+                                        int iDepth,
+                                        const QMatrix4x4& matVoxelToSurface,
+                                        Qt3DCore::QEntity* p3DEntityParent)
+{
+    MriVolumeTreeItem* pVolumeItem = new MriVolumeTreeItem(p3DEntityParent);
+    pVolumeItem->initData(vecVoxels, iWidth, iHeight, iDepth, matVoxelToSurface);
+
+    QList<QStandardItem*> list;
+    list << pVolumeItem;
+    list << new QStandardItem(pVolumeItem->toolTip());
+    this->appendRow(list);
+
+    return pVolumeItem;
+}
@@ -54,6 +54,7 @@
 //=============================================================================================================
 
 #include <QPointer>
+#include <QMatrix4x4>
 
 
 //*************************************************************************************************************
@@ -61,6 +62,8 @@
 // Eigen INCLUDES
 //=============================================================================================================
 
+#include <Eigen/Core>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -93,6 +96,7 @@ namespace DISP3DLIB
 //=============================================================================================================
 
 class FsSurfaceTreeItem;
+class MriVolumeTreeItem;
 
 
 //=============================================================================================================
@@ -146,6 +150,26 @@ public:
     */
     FsSurfaceTreeItem* addData(const FSLIB::Surface& tSurface, const FSLIB::Annotation& tAnnotation, Qt3DCore::QEntity* p3DEntityParent = 0);
 
+    //=========================================================================================================
+    /**
+    * Adds an MRI volume to this item, which is rendered on the GPU. See MriVolumeTreeItem::initData.
+    *
+    * @param[in] vecVoxels              The voxels, x fastest, then y and z.
+    * @param[in] iWidth                 The number of voxels in x direction.
+    * @param[in] iHeight                The number of voxels in y direction.
+    * @param[in] iDepth                 The number of voxels in z direction.
+    * @param[in] matVoxelToSurface      Maps voxel indices to the coordinates of the surfaces.
+    * @param[in] p3DEntityParent        The Qt3D entity parent of the new item.
+    *
+    * @return                           Returns a pointer to the added tree item.
+    */
+    MriVolumeTreeItem* addData(const Eigen::VectorXf& vecVoxels,
+                               int iWidth,
+                               int iHeight,
+                               int iDepth,
+                               const QMatrix4x4& matVoxelToSurface,
+                               Qt3DCore::QEntity* p3DEntityParent = 0);
+
 protected:
     //=========================================================================================================
     /**
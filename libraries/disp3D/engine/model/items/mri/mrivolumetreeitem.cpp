@@ -0,0 +1,261 @@
+//=============================================================================================================
+/**
+* @file     mrivolumetreeitem.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the MriVolumeTreeItem class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mrivolumetreeitem.h"
+#include "../../materials/volumematerial.h"
+#include "../../3dhelpers/custommesh.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <Qt3DCore/QEntity>
+#include <Qt3DRender/QGeometryRenderer>
+#include <QVector3D>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MriVolumeTreeItem::MriVolumeTreeItem(Qt3DCore::QEntity *p3DEntityParent, int iType, const QString &text)
+: Abstract3DTreeItem(p3DEntityParent, iType, text)
+, m_pVolumeMaterial(new VolumeMaterial())
+, m_pCustomMesh(new CustomMesh)
+, m_vecDims(Vector3i::Ones())
+, m_fDataMin(0.0f)
+, m_fDataMax(1.0f)
+{
+    initItem();
+}
+
+
+//*************************************************************************************************************
+
+void MriVolumeTreeItem::initItem()
+{
+    this->setEditable(false);
+    this->setCheckable(true);
+    this->setCheckState(Qt::Checked);
+    this->setToolTip("MRI volume item");
+
+    this->addComponent(m_pVolumeMaterial);
+    this->addComponent(m_pCustomMesh);
+}
+
+
+//*************************************************************************************************************
+
+void MriVolumeTreeItem::initData(const VectorXf &vecVoxels,
+                                 int iWidth,
+                                 int iHeight,
+                                 int iDepth,
+                                 const QMatrix4x4 &matVoxelToSurface)
+{
+    if(iWidth <= 0 || iHeight <= 0 || iDepth <= 0 || vecVoxels.rows() != iWidth * iHeight * iDepth) {
+        qDebug("MriVolumeTreeItem::initData - number of voxels does not match the dimensions!");
+        return;
+    }
+
+    m_vecDims = Vector3i(iWidth, iHeight, iDepth);
+    m_fDataMin = vecVoxels.minCoeff();
+    m_fDataMax = vecVoxels.maxCoeff();
+
+    //Scale to 16 bit, rows are padded to an even number of voxels to keep them four byte aligned
+    const int iTextureWidth = iWidth + iWidth % 2;
+    const float fScale = m_fDataMax > m_fDataMin ? 65535.0f / (m_fDataMax - m_fDataMin) : 0.0f;
+
+    QByteArray data(iTextureWidth * iHeight * iDepth * (int)sizeof(quint16), 0);
+    quint16 *rawVoxels = reinterpret_cast<quint16 *>(data.data());
+
+    for(int z = 0; z < iDepth; ++z) {
+        for(int y = 0; y < iHeight; ++y) {
+            const float *pRow = vecVoxels.data() + (z * iHeight + y) * iWidth;
+            quint16 *pTextureRow = rawVoxels + (z * iHeight + y) * iTextureWidth;
+
+            for(int x = 0; x < iWidth; ++x) {
+                pTextureRow[x] = static_cast<quint16>((pRow[x] - m_fDataMin) * fScale + 0.5f);
+            }
+        }
+    }
+
+    m_pVolumeMaterial->setVolume(data, iTextureWidth, iHeight, iDepth);
+
+    //Map the model coordinates to texture coordinates, the voxel centers lie at (i + 0.5) / dim
+    QMatrix4x4 matModelToTexture;
+    matModelToTexture.scale(1.0f / iWidth, 1.0f / iHeight, 1.0f / iDepth);
+    matModelToTexture.translate(0.5f, 0.5f, 0.5f);
+    matModelToTexture *= matVoxelToSurface.inverted();
+
+    this->setMaterialParameter(QVariant::fromValue(matModelToTexture), QStringLiteral("matModelToTexture"));
+    this->setMaterialParameter(QVariant::fromValue(float(iWidth) / float(iTextureWidth)), QStringLiteral("fTextureScaleX"));
+
+    //Create the bounding box of the voxels in model coordinates
+    MatrixX3f matVertices(8, 3);
+    MatrixX3f matNormals(8, 3);
+    QVector3D vecCenter = matVoxelToSurface.map(QVector3D(0.5f * (iWidth - 1), 0.5f * (iHeight - 1), 0.5f * (iDepth - 1)));
+
+    for(int i = 0; i < 8; ++i) {
+        QVector3D vecCorner = matVoxelToSurface.map(QVector3D((i & 1) ? iWidth - 0.5f : -0.5f,
+                                                              (i & 2) ? iHeight - 0.5f : -0.5f,
+                                                              (i & 4) ? iDepth - 0.5f : -0.5f));
+        QVector3D vecNormal = (vecCorner - vecCenter).normalized();
+
+        matVertices.row(i) = RowVector3f(vecCorner.x(), vecCorner.y(), vecCorner.z());
+        matNormals.row(i) = RowVector3f(vecNormal.x(), vecNormal.y(), vecNormal.z());
+    }
+
+    MatrixX3i matTriangles(12, 3);
+    matTriangles << 0, 2, 3,   0, 3, 1,     //z = 0
+                    4, 5, 7,   4, 7, 6,     //z = depth
+                    0, 1, 5,   0, 5, 4,     //y = 0
+                    2, 6, 7,   2, 7, 3,     //y = height
+                    0, 4, 6,   0, 6, 2,     //x = 0
+                    1, 3, 7,   1, 7, 5;     //x = width
+
+    //The voxel to surface transform may mirror, make all triangles face outwards in model coordinates
+    for(int i = 0; i < matTriangles.rows(); ++i) {
+        Vector3f a = matVertices.row(matTriangles(i,0)).transpose();
+        Vector3f b = matVertices.row(matTriangles(i,1)).transpose();
+        Vector3f c = matVertices.row(matTriangles(i,2)).transpose();
+        Vector3f vecOutwards = (a + b + c) / 3.0f - Vector3f(vecCenter.x(), vecCenter.y(), vecCenter.z());
+
+        if((b - a).cross(c - a).dot(vecOutwards) < 0.0f) {
+            std::swap(matTriangles(i,1), matTriangles(i,2));
+        }
+    }
+
+    m_pCustomMesh->setMeshData(matVertices,
+                               matNormals,
+                               matTriangles,
+                               createVertColor(matVertices.rows()),
+                               Qt3DRender::QGeometryRenderer::Triangles);
+}
+
+
+//*************************************************************************************************************
+
+void MriVolumeTreeItem::setRenderMode(const QString &sRenderMode)
+{
+    int iRenderMode = 0;
+    if(sRenderMode == QStringLiteral("Composite")) {
+        iRenderMode = 0;
+    } else if(sRenderMode == QStringLiteral("Maximum intensity")) {
+        iRenderMode = 1;
+    } else if(sRenderMode == QStringLiteral("Slices")) {
+        iRenderMode = 2;
+    }
+
+    this->setMaterialParameter(QVariant::fromValue(iRenderMode), QStringLiteral("RenderMode"));
+}
+
+
+//*************************************************************************************************************
+
+void MriVolumeTreeItem::setIntensityWindow(float fMin,
+                                           float fMax)
+{
+    //The texture holds the intensities normalized to the data range
+    const float fRange = m_fDataMax > m_fDataMin ? m_fDataMax - m_fDataMin : 1.0f;
+
+    this->setMaterialParameter(QVariant::fromValue((fMin - m_fDataMin) / fRange), QStringLiteral("fWindowMin"));
+    this->setMaterialParameter(QVariant::fromValue((fMax - m_fDataMin) / fRange), QStringLiteral("fWindowMax"));
+}
+
+
+//*************************************************************************************************************
+
+void MriVolumeTreeItem::setDensity(float fDensity)
+{
+    this->setMaterialParameter(QVariant::fromValue(fDensity), QStringLiteral("fDensity"));
+}
+
+
+//*************************************************************************************************************
+
+void MriVolumeTreeItem::setSlicePosition(const QVector3D &vecVoxel)
+{
+    QVector3D vecTexture((vecVoxel.x() + 0.5f) / m_vecDims(0),
+                         (vecVoxel.y() + 0.5f) / m_vecDims(1),
+                         (vecVoxel.z() + 0.5f) / m_vecDims(2));
+
+    this->setMaterialParameter(QVariant::fromValue(vecTexture), QStringLiteral("slicePosition"));
+}
+
+
+//*************************************************************************************************************
+
+void MriVolumeTreeItem::setStepCount(int iSteps)
+{
+    this->setMaterialParameter(QVariant::fromValue(qMax(iSteps, 1)), QStringLiteral("iSteps"));
+}
+
+
+//*************************************************************************************************************
+
+void MriVolumeTreeItem::setLevelOfDetail(float fLevelOfDetail)
+{
+    this->setMaterialParameter(QVariant::fromValue(qMax(fLevelOfDetail, 0.0f)), QStringLiteral("fLevelOfDetail"));
+}
@@ -0,0 +1,210 @@
+//=============================================================================================================
+/**
+* @file     mrivolumetreeitem.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the MriVolumeTreeItem class.
+*
+*/
+
+#ifndef DISP3DLIB_MRIVOLUMETREEITEM_H
+#define DISP3DLIB_MRIVOLUMETREEITEM_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../../../../disp3D_global.h"
+#include "../common/abstract3Dtreeitem.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QPointer>
+#include <QMatrix4x4>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DISP3DLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+class CustomMesh;
+class VolumeMaterial;
+
+
+//=============================================================================================================
+/**
+* This item renders an MRI volume on the GPU. The volume is uploaded once as a mipmapped 3D texture, the
+* compositing, the maximum intensity projection and the extraction of three orthogonal slices are computed by
+* ray marching in the fragment shader. Changing the window, the slices or the render mode only changes uniforms.
+*
+* @brief This item renders an MRI volume with GPU ray marching.
+*/
+
+class DISP3DSHARED_EXPORT MriVolumeTreeItem : public Abstract3DTreeItem
+{
+    Q_OBJECT
+
+public:
+    typedef QSharedPointer<MriVolumeTreeItem> SPtr;            /**< Shared pointer type for MriVolumeTreeItem. */
+    typedef QSharedPointer<const MriVolumeTreeItem> ConstSPtr; /**< Const shared pointer type for MriVolumeTreeItem. */
+
+    //=========================================================================================================
+    /**
+    * Default constructor.
+    *
+    * @param[in] p3DEntityParent    The parent 3D entity.
+    * @param[in] iType              The type of the item. See types.h for declaration and definition.
+    * @param[in] text               The text of this item. This is also by default the displayed name of the item in a view.
+    */
+    explicit MriVolumeTreeItem(Qt3DCore::QEntity* p3DEntityParent = Q_NULLPTR,
+                               int iType = Data3DTreeModelItemTypes::MriVolumeItem,
+                               const QString& text = "MRI Volume");
+
+    //=========================================================================================================
+    /**
+    * Uploads the volume. The intensities are scaled to 16 bit between their minimum and maximum.
+    *
+    * @param[in] vecVoxels              The voxels, x fastest, then y and z.
+    * @param[in] iWidth                 The number of voxels in x direction.
+    * @param[in] iHeight                The number of voxels in y direction.
+    * @param[in] iDepth                 The number of voxels in z direction.
+    * @param[in] matVoxelToSurface      Maps voxel indices to the coordinates of the surfaces, e.g. the scaled
+    *                                   tkr vox2ras matrix of a FreeSurfer volume.
+    */
+    void initData(const Eigen::VectorXf &vecVoxels,
+                  int iWidth,
+                  int iHeight,
+                  int iDepth,
+                  const QMatrix4x4 &matVoxelToSurface);
+
+    //=========================================================================================================
+    /**
+    * Sets the render mode.
+    *
+    * @param[in] sRenderMode            "Composite", "Maximum intensity" or "Slices".
+    */
+    void setRenderMode(const QString &sRenderMode);
+
+    //=========================================================================================================
+    /**
+    * Sets the intensity window. Intensities below are transparent, intensities above are white.
+    *
+    * @param[in] fMin                   The lower end of the window in data units.
+    * @param[in] fMax                   The upper end of the window in data units.
+    */
+    void setIntensityWindow(float fMin,
+                            float fMax);
+
+    //=========================================================================================================
+    /**
+    * Sets the opacity which a voxel at the upper window end adds per step of the composite rendering.
+    *
+    * @param[in] fDensity               The opacity per step.
+    */
+    void setDensity(float fDensity);
+
+    //=========================================================================================================
+    /**
+    * Sets the position of the three orthogonal slices of the slice rendering.
+    *
+    * @param[in] vecVoxel               The voxel in which the slices cross.
+    */
+    void setSlicePosition(const QVector3D &vecVoxel);
+
+    //=========================================================================================================
+    /**
+    * Sets the number of steps of the ray marching across the volume.
+    *
+    * @param[in] iSteps                 The number of steps.
+    */
+    void setStepCount(int iSteps);
+
+    //=========================================================================================================
+    /**
+    * Sets the mipmap level which is sampled, e.g. a coarser level while browsing large volumes.
+    *
+    * @param[in] fLevelOfDetail         The mipmap level, 0 for full resolution.
+    */
+    void setLevelOfDetail(float fLevelOfDetail);
+
+protected:
+    //=========================================================================================================
+    /**
+    * AbstractTreeItem functions
+    */
+    void initItem() override;
+
+    QPointer<VolumeMaterial>        m_pVolumeMaterial;      /**< The ray marching material. */
+    QPointer<CustomMesh>            m_pCustomMesh;          /**< The bounding box of the volume. */
+
+    Eigen::Vector3i                 m_vecDims;              /**< The number of voxels in x, y and z direction. */
+    float                           m_fDataMin;             /**< The intensity which is mapped to 0. */
+    float                           m_fDataMax;             /**< The intensity which is mapped to 1. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+
+} // namespace DISP3DLIB
+
+#endif // DISP3DLIB_MRIVOLUMETREEITEM_H
@@ -44,10 +44,12 @@
 #include "../../materials/networkmaterial.h"
 #include "../../3dhelpers/custommesh.h"
 #include "../../3dhelpers/geometrymultiplier.h"
+#include "../../3dhelpers/edgemultiplier.h"
 #include "../../materials/geometrymultipliermaterial.h"
 
 #include <connectivity/network/networknode.h>
 #include <connectivity/network/networkedge.h>
+#include <connectivity/network/sparsenetwork.h>
 
 #include <fiff/fiff_types.h>
 
@@ -91,6 +93,7 @@ using namespace CONNECTIVITYLIB;
 NetworkTreeItem::NetworkTreeItem(Qt3DCore::QEntity *p3DEntityParent, int iType, const QString &text)
 : AbstractMeshTreeItem(p3DEntityParent, iType, text)
 , m_bNodesPlotted(false)
+, m_pEdgeMultiplier(new EdgeMultiplier())
 {
     initItem();
 }
@@ -123,6 +126,16 @@ void NetworkTreeItem::initItem()
     connect(m_pItemNetworkThreshold.data(), &MetaTreeItem::dataChanged,
             this, &NetworkTreeItem::onNetworkThresholdChanged);
 
+    list.clear();
+    MetaTreeItem* pItemColormapType = new MetaTreeItem(MetaTreeItemTypes::ColormapType, "Jet");
+    list << pItemColormapType;
+    list << new QStandardItem(pItemColormapType->toolTip());
+    this->appendRow(list);
+    data.setValue(QString("Jet"));
+    pItemColormapType->setData(data, MetaTreeItemRoles::ColormapType);
+    connect(pItemColormapType, &MetaTreeItem::dataChanged,
+            this, &NetworkTreeItem::onColormapTypeChanged);
+
     list.clear();
     MetaTreeItem* pItemNetworkMatrix = new MetaTreeItem(MetaTreeItemTypes::NetworkMatrix, "Show network matrix");
     list << pItemNetworkMatrix;
@@ -132,6 +145,11 @@ void NetworkTreeItem::initItem()
     //Set material
     NetworkMaterial* pNetworkMaterial = new NetworkMaterial();
     this->setMaterial(pNetworkMaterial);
+    onNetworkThresholdChanged(QVariant::fromValue(vecEdgeTrehshold));
+
+    //The edges are drawn instanced, so the line mesh is not needed
+    this->removeComponent(m_pCustomMesh);
+    this->addComponent(m_pEdgeMultiplier);
 }
 
 
@@ -150,10 +168,23 @@ void NetworkTreeItem::addData(const Network& tNetworkData)
     this->setData(data, Data3DTreeModelItemRoles::NetworkDataMatrix);
 
     //Plot network
-    if(m_pItemNetworkThreshold) {
-        plotNetwork(tNetworkData,
-                    m_pItemNetworkThreshold->data(MetaTreeItemRoles::DataThreshold).value<QVector3D>());
-    }
+    plotNetwork(tNetworkData);
+}
+
+
+//*************************************************************************************************************
+
+void NetworkTreeItem::addData(const SparseNetwork& tNetworkData)
+{
+    //Add data which is held by this NetworkTreeItem. The dense network matrix is not generated for sparse networks
+    //since they are meant for node counts where it would not fit into memory.
+    QVariant data;
+
+    data.setValue(tNetworkData);
+    this->setData(data, Data3DTreeModelItemRoles::Data);
+
+    //Plot network
+    plotNetwork(tNetworkData);
 }
 
 
@@ -162,16 +193,37 @@ void NetworkTreeItem::addData(const Network& tNetworkData)
 void NetworkTreeItem::onNetworkThresholdChanged(const QVariant& vecThresholds)
 {
     if(vecThresholds.canConvert<QVector3D>()) {
-        Network tNetwork = this->data(Data3DTreeModelItemRoles::Data).value<Network>();
+        QVector3D vecThreshold = vecThresholds.value<QVector3D>();
+
+        //The edges are thresholded in the shader, no geometry needs to be rebuilt
+        this->setMaterialParameter(QVariant::fromValue(vecThreshold.x()), QStringLiteral("fThresholdX"));
+        this->setMaterialParameter(QVariant::fromValue(vecThreshold.z()), QStringLiteral("fThresholdZ"));
+    }
+}
 
-        plotNetwork(tNetwork, vecThresholds.value<QVector3D>());
+
+//*************************************************************************************************************
+
+void NetworkTreeItem::onColormapTypeChanged(const QVariant& sColormapType)
+{
+    if(sColormapType.canConvert<QString>()) {
+        int colorMapId = 3;
+        if(sColormapType.toString() == QStringLiteral("Hot")) {
+            colorMapId = 0;
+        } else if(sColormapType.toString() == QStringLiteral("Hot Negative 1")) {
+            colorMapId = 1;
+        } else if(sColormapType.toString() == QStringLiteral("Hot Negative 2")) {
+            colorMapId = 2;
+        }
+
+        this->setMaterialParameter(QVariant::fromValue(colorMapId), QStringLiteral("ColormapType"));
     }
 }
 
 
 //*************************************************************************************************************
 
-void NetworkTreeItem::plotNetwork(const Network& tNetworkData, const QVector3D& vecThreshold)
+void NetworkTreeItem::plotNetwork(const Network& tNetworkData)
 {
     //Create network vertices and normals
     QList<NetworkNode::SPtr> lNetworkNodes = tNetworkData.getNodes();
@@ -184,9 +236,68 @@ void NetworkTreeItem::plotNetwork(const Network& tNetworkData, const QVector3D&
         tMatVert(i,2) = lNetworkNodes.at(i)->getVert()(2);
     }
 
-    MatrixX3f tMatNorm(lNetworkNodes.size(), 3);
-    tMatNorm.setZero();
+    plotNodes(tMatVert);
+
+    //Generate connection indices and weights for Qt3D buffer. Every edge is uploaded once, the threshold is applied in the shader
+    const QList<NetworkEdge::SPtr>& lNetworkEdges = tNetworkData.getEdges();
+
+    MatrixXi tMatLines(lNetworkEdges.size(), 2);
+    VectorXf tVecWeights(lNetworkEdges.size());
+    int count = 0;
+    int start, end;
+
+    for(int i = 0; i < lNetworkEdges.size(); ++i) {
+        start = lNetworkEdges.at(i)->getStartNode()->getId();
+        end = lNetworkEdges.at(i)->getEndNode()->getId();
+
+        if(start != end) {
+            tMatLines(count,0) = start;
+            tMatLines(count,1) = end;
+            tVecWeights(count) = lNetworkEdges.at(i)->getWeight()(0,0);
+            ++count;
+        }
+    }
+
+    plotLines(tMatVert, tMatLines.topRows(count), tVecWeights.head(count));
+}
+
 
+//*************************************************************************************************************
+
+void NetworkTreeItem::plotNetwork(const SparseNetwork& tNetworkData)
+{
+    const MatrixX3f& tMatVert = tNetworkData.getNodePositions();
+
+    plotNodes(tMatVert);
+
+    //The CSR storage provides the connection indices and weights for the Qt3D buffer directly
+    const QVector<int>& vecRowPtr = tNetworkData.getRowPointers();
+    const QVector<int>& vecEndNodes = tNetworkData.getEndNodes();
+    const QVector<float>& vecWeights = tNetworkData.getWeights();
+
+    MatrixXi tMatLines(vecEndNodes.size(), 2);
+    VectorXf tVecWeights(vecEndNodes.size());
+    int count = 0;
+
+    for(int i = 0; i < tNetworkData.getNumberNodes(); ++i) {
+        for(int e = vecRowPtr.at(i); e < vecRowPtr.at(i+1); ++e) {
+            if(vecEndNodes.at(e) != i) {
+                tMatLines(count,0) = i;
+                tMatLines(count,1) = vecEndNodes.at(e);
+                tVecWeights(count) = vecWeights.at(e);
+                ++count;
+            }
+        }
+    }
+
+    plotLines(tMatVert, tMatLines.topRows(count), tVecWeights.head(count));
+}
+
+
+//*************************************************************************************************************
+
+void NetworkTreeItem::plotNodes(const MatrixX3f& tMatVert)
+{
     //Draw network nodes
     //TODO: Dirty hack using m_bNodesPlotted flag to get rid of memory leakage problem when putting parent to the nodes entities. Internal Qt3D problem?
     if(!m_bNodesPlotted) {
@@ -200,24 +311,8 @@ void NetworkTreeItem::plotNetwork(const Network& tNetworkData, const QVector3D&
         //create instanced renderer
         GeometryMultiplier *pSphereMesh = new GeometryMultiplier(pSourceSphereGeometry);
 
-        //Create transform matrix for each sphere instance
-        QVector<QMatrix4x4> vTransforms;
-        vTransforms.reserve(tMatVert.rows());
-        QVector3D tempPos;
-
-        for(int i = 0; i < tMatVert.rows(); ++i) {
-            QMatrix4x4 tempTransform;
-
-            tempPos.setX(tMatVert(i, 0));
-            tempPos.setY(tMatVert(i, 1));
-            tempPos.setZ(tMatVert(i, 2));
-            //Set position
-            tempTransform.translate(tempPos);
-            vTransforms.push_back(tempTransform);
-        }
-
-        //Set instance Transform
-        pSphereMesh->setTransforms(vTransforms);
+        //Set instance positions
+        pSphereMesh->setPositions(tMatVert);
 
         pSourceSphereEntity->addComponent(pSphereMesh);
 
@@ -229,56 +324,17 @@ void NetworkTreeItem::plotNetwork(const Network& tNetworkData, const QVector3D&
 
         m_bNodesPlotted = true;
     }
+}
 
-    //Generate connection indices for Qt3D buffer
-    MatrixXi tMatLines;
-    int count = 0;
-    int start, end;
-
-    for(int i = 0; i < lNetworkNodes.size(); ++i) {
-        //Plot in edges
-        for(int j = 0; j < lNetworkNodes.at(i)->getEdgesIn().size(); ++j) {
-            start = lNetworkNodes.at(i)->getEdgesIn().at(j)->getStartNode()->getId();
-            end = lNetworkNodes.at(i)->getEdgesIn().at(j)->getEndNode()->getId();
-
-            if(std::fabs(lNetworkNodes.at(i)->getEdgesIn().at(j)->getWeight()(0,0)) >= vecThreshold.x() &&
-                    start != end) {
-                tMatLines.conservativeResize(count+1,2);
-                tMatLines(count,0) = start;
-                tMatLines(count,1) = end;
-                ++count;
-            }
-        }
-
-        //Plot out edges
-        for(int j = 0; j < lNetworkNodes.at(i)->getEdgesOut().size(); ++j) {
-            start = lNetworkNodes.at(i)->getEdgesOut().at(j)->getStartNode()->getId();
-            end = lNetworkNodes.at(i)->getEdgesOut().at(j)->getEndNode()->getId();
 
-            if(std::fabs(lNetworkNodes.at(i)->getEdgesOut().at(j)->getWeight()(0,0)) >= vecThreshold.x() &&
-                    start != end) {
-                tMatLines.conservativeResize(count+1,2);
-                tMatLines(count,0) = start;
-                tMatLines(count,1) = end;
-                ++count;
-            }
-        }
-    }
-
-    //Generate colors for Qt3D buffer
-    MatrixX3f matLineColor(tMatVert.rows(),3);
+//*************************************************************************************************************
 
-    for(int i = 0; i < matLineColor.rows(); ++i) {
-        matLineColor(i,0) = 0.0f;
-        matLineColor(i,1) = 0.0f;
-        matLineColor(i,2) = 1.0f;
+void NetworkTreeItem::plotLines(const MatrixX3f& tMatVert, const MatrixXi& tMatLines, const VectorXf& tVecWeights)
+{
+    //Upload all edges once, colors are generated from the weights in the shader
+    if(m_pEdgeMultiplier) {
+        m_pEdgeMultiplier->setEdges(tMatVert,
+                                    tMatLines,
+                                    tVecWeights);
     }
-
-    m_pCustomMesh->setMeshData(tMatVert,
-                                tMatNorm,
-                                tMatLines,
-                                matLineColor,
-                                Qt3DRender::QGeometryRenderer::Lines);
 }
-
-
@@ -47,6 +47,7 @@
 #include "../common/types.h"
 
 #include <connectivity/network/network.h>
+#include <connectivity/network/sparsenetwork.h>
 
 
 //*************************************************************************************************************
@@ -96,6 +97,7 @@ namespace DISP3DLIB
 //=============================================================================================================
 
 class MetaTreeItem;
+class EdgeMultiplier;
 
 
 //=============================================================================================================
@@ -132,6 +134,14 @@ public:
     */
     void addData(const CONNECTIVITYLIB::Network& tNetworkData);
 
+    //=========================================================================================================
+    /**
+    * Adds sparse connectivity data. The edges are rendered straight from the CSR storage.
+    *
+    * @param[in] tNetworkData       The new sparse connectivity data.
+    */
+    void addData(const CONNECTIVITYLIB::SparseNetwork& tNetworkData);
+
 private:
     //=========================================================================================================
     /**
@@ -141,7 +151,8 @@ private:
 
     //=========================================================================================================
     /**
-    * This function gets called whenever the network threshold changes.
+    * This function gets called whenever the network threshold changes. Only the shader uniforms are updated,
+    * the uploaded edges are kept.
     *
     * @param[in] vecThresholds     The new threshold values used for threshold the network.
     */
@@ -149,17 +160,52 @@ private:
 
     //=========================================================================================================
     /**
-    * Call this function whenever you want to calculate the indices/tris for a network.
+    * This function gets called whenever the colormap type of the edges changes.
+    *
+    * @param[in] sColormapType     The new colormap type.
+    */
+    void onColormapTypeChanged(const QVariant &sColormapType);
+
+    //=========================================================================================================
+    /**
+    * Call this function whenever you want to upload all edges of a network. Thresholding is done in the shader.
     *
     * @param[in] tNetworkData     The network data.
-    * @param[in] vecThreshold     The threshold data.
     */
-    void plotNetwork(const CONNECTIVITYLIB::Network& tNetworkData, const QVector3D& vecThreshold);
+    void plotNetwork(const CONNECTIVITYLIB::Network& tNetworkData);
+
+    //=========================================================================================================
+    /**
+    * Call this function whenever you want to upload all edges of a sparse network. Thresholding is done in the shader.
+    *
+    * @param[in] tNetworkData     The sparse network data.
+    */
+    void plotNetwork(const CONNECTIVITYLIB::SparseNetwork& tNetworkData);
+
+    //=========================================================================================================
+    /**
+    * Plots the network nodes as instanced spheres. This is only done once per item.
+    *
+    * @param[in] tMatVert         The node positions.
+    */
+    void plotNodes(const Eigen::MatrixX3f& tMatVert);
+
+    //=========================================================================================================
+    /**
+    * Uploads the network edges as instances of one line segment.
+    *
+    * @param[in] tMatVert         The node positions.
+    * @param[in] tMatLines        The start and end node of each line.
+    * @param[in] tVecWeights      The weight of each line.
+    */
+    void plotLines(const Eigen::MatrixX3f& tMatVert, const Eigen::MatrixXi& tMatLines, const Eigen::VectorXf& tVecWeights);
 
     bool                                        m_bNodesPlotted;                /**< Flag whether nodes were plotted. */
 
     QPointer<MetaTreeItem>                      m_pItemNetworkThreshold;        /**< The item to access the threshold values. */
 
+    QPointer<EdgeMultiplier>                    m_pEdgeMultiplier;              /**< The instanced edge renderer which replaces the line mesh. */
+
 };
 
 //*************************************************************************************************************
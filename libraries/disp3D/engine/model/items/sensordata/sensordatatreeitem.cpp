@@ -191,6 +191,7 @@ void SensorDataTreeItem::initData(const MNEBemSurface &bemSurface,
                                                                   bemSurface.tris,
                                                                   matVertColor,
                                                                   Qt3DRender::QGeometryRenderer::Triangles);
+            m_pInterpolationItemCPU->getCustomMesh()->createLevelsOfDetail();
 
             QList<QStandardItem*> list;
             list << m_pInterpolationItemCPU;
@@ -546,7 +547,13 @@ void SensorDataTreeItem::onNewRtRawDataAvailable(const VectorXd &vecDataVector)
 {
     if(m_pInterpolationItemGPU)
     {
-        m_pInterpolationItemGPU->addNewRtData(vecDataVector.cast<float>());
+        const VectorXf vecData = vecDataVector.cast<float>();
+
+        scheduleFrameUpdate([this, vecData]() {
+            if(m_pInterpolationItemGPU) {
+                m_pInterpolationItemGPU->addNewRtData(vecData);
+            }
+        });
     }
 }
 
@@ -557,9 +564,13 @@ void SensorDataTreeItem::onNewRtSmoothedDataAvailable(const MatrixX3f &matColorM
 {
     if(m_pInterpolationItemCPU)
     {
-        QVariant data;
-        data.setValue(matColorMatrix);
-        m_pInterpolationItemCPU->setVertColor(data);
+        scheduleFrameUpdate([this, matColorMatrix]() {
+            if(m_pInterpolationItemCPU) {
+                QVariant data;
+                data.setValue(matColorMatrix);
+                m_pInterpolationItemCPU->setVertColor(data);
+            }
+        });
     }
 }
 
@@ -72,6 +72,7 @@
 //=============================================================================================================
 
 using namespace DISP3DLIB;
+using namespace Eigen;
 
 
 //*************************************************************************************************************
@@ -158,25 +159,15 @@ void SensorPositionTreeItem::plotSensors(const QList<FIFFLIB::FiffChInfo>& lChIn
 
         pMesh = new GeometryMultiplier(pSourceSphere);
 
-        //Create transform matrix for each cuboid instance
-        QVector<QMatrix4x4> vTransforms;
-        vTransforms.reserve(lChInfo.size());
-        QVector3D tempPos;
+        //Create position for each sphere instance
+        MatrixX3f matPositions(lChInfo.size(), 3);
 
         for(int i = 0; i < lChInfo.size(); ++i) {
-            QMatrix4x4 tempTransform;
-
-            tempPos.setX(lChInfo[i].chpos.r0(0));
-            tempPos.setY(lChInfo[i].chpos.r0(1));
-            tempPos.setZ(lChInfo[i].chpos.r0(2));
-            //Set position
-            tempTransform.translate(tempPos);
-
-            vTransforms.push_back(tempTransform);
+            matPositions.row(i) = lChInfo[i].chpos.r0.transpose();
         }
 
-        //Set instance Transform
-        pMesh->setTransforms(vTransforms);
+        //Set instance positions
+        pMesh->setPositions(matPositions);
     }
 
     this->addComponent(pMesh);
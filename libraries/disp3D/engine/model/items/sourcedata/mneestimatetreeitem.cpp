@@ -67,6 +67,8 @@
 
 #include <Eigen/Core>
 
+#include <cmath>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -89,8 +91,22 @@ MneEstimateTreeItem::MneEstimateTreeItem(int iType,
 : AbstractTreeItem(iType, text)
 , m_bIsDataInit(false)
 , m_bUseGPU(bUseGPU)
+, m_bTimeSeriesPlayback(false)
+, m_bIsStreaming(false)
+, m_bIsLooping(true)
+, m_iNumSourcesLeft(0)
+, m_iNumSourcesRight(0)
+, m_iMSecInterval(17)
+, m_iTimeSeriesWindow(0)
+, m_iWindowFirstSample(0)
+, m_dCurrentSample(0.0)
 {
     initItem();
+
+    //Advance the playback once per frame, the sample rate is given by the streaming time interval
+    m_playbackTimer.setInterval(16);
+    connect(&m_playbackTimer, &QTimer::timeout,
+            this, &MneEstimateTreeItem::onPlaybackTimeout);
 }
 
 
@@ -345,6 +361,7 @@ void MneEstimateTreeItem::initData(const MNEForwardSolution& tForwardSolution,
                                                                       tSurfSet[0].tris(),
                                                                       matVertColor,
                                                                       Qt3DRender::QGeometryRenderer::Triangles);
+            m_pInterpolationItemLeftCPU->getCustomMesh()->createLevelsOfDetail();
 
             m_pInterpolationItemLeftCPU->setPosition(QVector3D(-tSurfSet[0].offset()(0),
                                                                -tSurfSet[0].offset()(1),
@@ -372,6 +389,7 @@ void MneEstimateTreeItem::initData(const MNEForwardSolution& tForwardSolution,
                                                                     tSurfSet[1].tris(),
                                                                     matVertColor,
                                                                     Qt3DRender::QGeometryRenderer::Triangles);
+            m_pInterpolationItemRightCPU->getCustomMesh()->createLevelsOfDetail();
 
             m_pInterpolationItemRightCPU->setPosition(QVector3D(-tSurfSet[1].offset()(0),
                                                                -tSurfSet[1].offset()(1),
@@ -389,6 +407,9 @@ void MneEstimateTreeItem::initData(const MNEForwardSolution& tForwardSolution,
                 this, &MneEstimateTreeItem::onNewRtSmoothedDataAvailable);
     }
 
+    m_iNumSourcesLeft = clustVertNoLeft.rows();
+    m_iNumSourcesRight = clustVertNoRight.rows();
+
     m_pRtSourceDataController->setInterpolationInfo(tForwardSolution.src[0].rr,
                                                     tForwardSolution.src[1].rr,
                                                     tForwardSolution.src[0].neighbor_vert,
@@ -421,6 +442,20 @@ void MneEstimateTreeItem::addData(const MNESourceEstimate& tSourceEstimate)
     data.setValue(tSourceEstimate.data);
     this->setData(data, Data3DTreeModelItemRoles::Data);
 
+    if(m_bTimeSeriesPlayback) {
+        //Upload once, the playback only moves the displayed sample from now on
+        m_matTimeSeries = tSourceEstimate.data.cast<float>();
+        m_dCurrentSample = 0.0;
+        uploadTimeSeriesWindow(0);
+        setCurrentSample(0.0);
+
+        if(m_bIsStreaming) {
+            m_playbackClock.start();
+            m_playbackTimer.start();
+        }
+        return;
+    }
+
     if(m_pRtSourceDataController) {
         m_pRtSourceDataController->addData(tSourceEstimate.data);
     }
@@ -593,10 +628,109 @@ void MneEstimateTreeItem::setSFreq(const double dSFreq)
 }
 
 
+//*************************************************************************************************************
+
+void MneEstimateTreeItem::setTimeSeriesPlayback(bool bState)
+{
+    if(!m_bUseGPU) {
+        qDebug() << "MneEstimateTreeItem::setTimeSeriesPlayback - Time series playback is only available with GPU usage.";
+        return;
+    }
+
+    if(m_bTimeSeriesPlayback == bState) {
+        return;
+    }
+
+    m_bTimeSeriesPlayback = bState;
+
+    if(!bState) {
+        m_playbackTimer.stop();
+        m_matTimeSeries.resize(0,0);
+
+        if(m_pInterpolationItemLeftGPU) {
+            m_pInterpolationItemLeftGPU->clearTimeSeries();
+        }
+
+        if(m_pInterpolationItemRightGPU) {
+            m_pInterpolationItemRightGPU->clearTimeSeries();
+        }
+    }
+
+    //Only one of both drives the display
+    if(m_pRtSourceDataController) {
+        m_pRtSourceDataController->setStreamingState(m_bIsStreaming && !bState);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MneEstimateTreeItem::setTimeSeriesWindow(int iSamples)
+{
+    m_iTimeSeriesWindow = qMax(iSamples, 0);
+
+    if(m_matTimeSeries.cols() > 0) {
+        uploadTimeSeriesWindow(static_cast<int>(m_dCurrentSample));
+        setCurrentSample(m_dCurrentSample);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MneEstimateTreeItem::setCurrentSample(double dSample)
+{
+    const int iSamples = m_matTimeSeries.cols();
+
+    if(iSamples == 0) {
+        return;
+    }
+
+    m_dCurrentSample = qBound(0.0, dSample, double(iSamples - 1));
+
+    //Upload the next window only if the two samples which are blended are not part of the current one
+    const int iWindow = m_iTimeSeriesWindow > 0 ? qMin(m_iTimeSeriesWindow, iSamples) : iSamples;
+    const int iFirst = static_cast<int>(m_dCurrentSample);
+    const int iSecond = qMin(iFirst + 1, iSamples - 1);
+
+    if(iFirst < m_iWindowFirstSample || iSecond >= m_iWindowFirstSample + iWindow) {
+        uploadTimeSeriesWindow(iFirst);
+    }
+
+    const float fSample = static_cast<float>(m_dCurrentSample - m_iWindowFirstSample);
+
+    scheduleFrameUpdate([this, fSample]() {
+        if(m_pInterpolationItemLeftGPU) {
+            m_pInterpolationItemLeftGPU->setCurrentSample(fSample);
+        }
+
+        if(m_pInterpolationItemRightGPU) {
+            m_pInterpolationItemRightGPU->setCurrentSample(fSample);
+        }
+    });
+}
+
+
 //*************************************************************************************************************
 
 void MneEstimateTreeItem::onCheckStateWorkerChanged(const Qt::CheckState& checkState)
 {
+    if(checkState == Qt::Checked) {
+        m_bIsStreaming = true;
+    } else if(checkState == Qt::Unchecked) {
+        m_bIsStreaming = false;
+    }
+
+    if(m_bTimeSeriesPlayback) {
+        if(m_bIsStreaming && m_matTimeSeries.cols() > 0) {
+            m_playbackClock.start();
+            m_playbackTimer.start();
+        } else {
+            m_playbackTimer.stop();
+        }
+        return;
+    }
+
     if(m_pRtSourceDataController) {
         if(checkState == Qt::Checked) {
             m_pRtSourceDataController->setStreamingState(true);
@@ -611,18 +745,20 @@ void MneEstimateTreeItem::onCheckStateWorkerChanged(const Qt::CheckState& checkS
 
 void MneEstimateTreeItem::onNewRtSmoothedDataAvailable(const Eigen::MatrixX3f &matColorMatrixLeftHemi,
                                                        const Eigen::MatrixX3f &matColorMatrixRightHemi)
-{    
-    QVariant data;
+{
+    scheduleFrameUpdate([this, matColorMatrixLeftHemi, matColorMatrixRightHemi]() {
+        QVariant data;
 
-    if(m_pInterpolationItemLeftCPU) {
-        data.setValue(matColorMatrixLeftHemi);
-        m_pInterpolationItemLeftCPU->setVertColor(data);
-    }
+        if(m_pInterpolationItemLeftCPU) {
+            data.setValue(matColorMatrixLeftHemi);
+            m_pInterpolationItemLeftCPU->setVertColor(data);
+        }
 
-    if(m_pInterpolationItemRightCPU) {
-        data.setValue(matColorMatrixRightHemi);
-        m_pInterpolationItemRightCPU->setVertColor(data);
-    }
+        if(m_pInterpolationItemRightCPU) {
+            data.setValue(matColorMatrixRightHemi);
+            m_pInterpolationItemRightCPU->setVertColor(data);
+        }
+    });
 }
 
 
@@ -633,6 +769,11 @@ void MneEstimateTreeItem::onNewInterpolationMatrixLeftAvailable(QSharedPointer<E
     //qDebug()<<"MneEstimateTreeItem::onNewInterpolationMatrixLeftAvailable";
     if(m_pInterpolationItemLeftGPU) {
         m_pInterpolationItemLeftGPU->setInterpolationMatrix(pMatInterpolationMatrixLeftHemi);
+
+        //The time series buffer is only accepted once the matrix dimensions are known
+        if(m_matTimeSeries.cols() > 0) {
+            uploadTimeSeriesWindow(m_iWindowFirstSample);
+        }
     }
 }
 
@@ -644,6 +785,11 @@ void MneEstimateTreeItem::onNewInterpolationMatrixRightAvailable(QSharedPointer<
     //qDebug()<<"MneEstimateTreeItem::onNewInterpolationMatrixRightAvailable";
     if(m_pInterpolationItemRightGPU) {
         m_pInterpolationItemRightGPU->setInterpolationMatrix(pMatInterpolationMatrixRightHemi);
+
+        //The time series buffer is only accepted once the matrix dimensions are known
+        if(m_matTimeSeries.cols() > 0) {
+            uploadTimeSeriesWindow(m_iWindowFirstSample);
+        }
     }
 }
 
@@ -653,13 +799,18 @@ void MneEstimateTreeItem::onNewInterpolationMatrixRightAvailable(QSharedPointer<
 void MneEstimateTreeItem::onNewRtRawData(const Eigen::VectorXd &vecDataVectorLeftHemi,
                                          const Eigen::VectorXd &vecDataVectorRightHemi)
 {
-    if(m_pInterpolationItemLeftGPU) {
-        m_pInterpolationItemLeftGPU->addNewRtData(vecDataVectorLeftHemi.cast<float>());
-    }
+    const VectorXf vecDataLeftHemi = vecDataVectorLeftHemi.cast<float>();
+    const VectorXf vecDataRightHemi = vecDataVectorRightHemi.cast<float>();
 
-    if(m_pInterpolationItemRightGPU) {
-        m_pInterpolationItemRightGPU->addNewRtData(vecDataVectorRightHemi.cast<float>());
-    }
+    scheduleFrameUpdate([this, vecDataLeftHemi, vecDataRightHemi]() {
+        if(m_pInterpolationItemLeftGPU) {
+            m_pInterpolationItemLeftGPU->addNewRtData(vecDataLeftHemi);
+        }
+
+        if(m_pInterpolationItemRightGPU) {
+            m_pInterpolationItemRightGPU->addNewRtData(vecDataRightHemi);
+        }
+    });
 }
 
 
@@ -690,6 +841,8 @@ void MneEstimateTreeItem::onColormapTypeChanged(const QVariant& sColormapType)
 void MneEstimateTreeItem::onTimeIntervalChanged(const QVariant& iMSec)
 {
     if(iMSec.canConvert<int>()) {
+        m_iMSecInterval = iMSec.toInt();
+
         if(m_pRtSourceDataController) {
             m_pRtSourceDataController->setTimeInterval(iMSec.toInt());
         }
@@ -741,6 +894,12 @@ void MneEstimateTreeItem::onVisualizationTypeChanged(const QVariant& sVisType)
 
 void MneEstimateTreeItem::onCheckStateLoopedStateChanged(const Qt::CheckState& checkState)
 {
+    if(checkState == Qt::Checked) {
+        m_bIsLooping = true;
+    } else if(checkState == Qt::Unchecked) {
+        m_bIsLooping = false;
+    }
+
     if(m_pRtSourceDataController) {
         if(checkState == Qt::Checked) {
             m_pRtSourceDataController->setLoopState(true);
@@ -786,3 +945,54 @@ void MneEstimateTreeItem::onInterpolationFunctionChanged(const QVariant &sInterp
         }
     }
 }
+
+
+//*************************************************************************************************************
+
+void MneEstimateTreeItem::onPlaybackTimeout()
+{
+    const int iSamples = m_matTimeSeries.cols();
+
+    if(iSamples == 0) {
+        m_playbackTimer.stop();
+        return;
+    }
+
+    //Advance by the elapsed time, so dropped frames do not slow the playback down
+    double dSample = m_dCurrentSample + m_playbackClock.restart() / double(qMax(m_iMSecInterval, 1));
+
+    if(dSample > iSamples - 1) {
+        if(m_bIsLooping) {
+            dSample = std::fmod(dSample, double(iSamples));
+        } else {
+            dSample = iSamples - 1;
+            m_playbackTimer.stop();
+        }
+    }
+
+    setCurrentSample(dSample);
+}
+
+
+//*************************************************************************************************************
+
+void MneEstimateTreeItem::uploadTimeSeriesWindow(int iFirstSample)
+{
+    if(m_matTimeSeries.rows() != m_iNumSourcesLeft + m_iNumSourcesRight) {
+        qDebug() << "MneEstimateTreeItem::uploadTimeSeriesWindow - Number of sources (" << m_matTimeSeries.rows() << ") does not match the source space. Returning...";
+        return;
+    }
+
+    const int iSamples = m_matTimeSeries.cols();
+    const int iWindow = m_iTimeSeriesWindow > 0 ? qMin(m_iTimeSeriesWindow, iSamples) : iSamples;
+
+    m_iWindowFirstSample = qBound(0, iFirstSample, iSamples - iWindow);
+
+    if(m_pInterpolationItemLeftGPU) {
+        m_pInterpolationItemLeftGPU->setTimeSeries(m_matTimeSeries.block(0, m_iWindowFirstSample, m_iNumSourcesLeft, iWindow));
+    }
+
+    if(m_pInterpolationItemRightGPU) {
+        m_pInterpolationItemRightGPU->setTimeSeries(m_matTimeSeries.block(m_iNumSourcesLeft, m_iWindowFirstSample, m_iNumSourcesRight, iWindow));
+    }
+}
@@ -53,6 +53,8 @@
 //=============================================================================================================
 
 #include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
 
 
 //*************************************************************************************************************
@@ -60,6 +62,8 @@
 // Eigen INCLUDES
 //=============================================================================================================
 
+#include <Eigen/Core>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -243,6 +247,34 @@ public:
     */
     void setSFreq(const double dSFreq);
 
+    //=========================================================================================================
+    /**
+    * Switches the GPU time series playback on or off. In playback mode the data passed to addData is uploaded
+    * to the GPU once and the displayed (fractional) sample is advanced per frame with the streaming time interval,
+    * so scrubbing and playback speed do not depend on the CPU load or on the number of vertices. Averaging is not
+    * applied in this mode. Only available if the item uses the GPU.
+    *
+    * @param[in] bState                 Whether to use the time series playback.
+    */
+    void setTimeSeriesPlayback(bool bState);
+
+    //=========================================================================================================
+    /**
+    * Sets the maximum number of samples which are uploaded to the GPU in time series playback. A new window is
+    * uploaded whenever the playback leaves the current one.
+    *
+    * @param[in] iSamples               The window length in samples, 0 to upload the whole time series.
+    */
+    void setTimeSeriesWindow(int iSamples);
+
+    //=========================================================================================================
+    /**
+    * Scrubs the time series playback to a sample. Fractional samples are interpolated on the GPU.
+    *
+    * @param[in] dSample                The sample relative to the first sample passed to addData.
+    */
+    void setCurrentSample(double dSample);
+
 protected:
     //=========================================================================================================
     /**
@@ -358,8 +390,37 @@ protected:
     */
     virtual void onInterpolationFunctionChanged(const QVariant& sInterpolationFunction);
 
+    //=========================================================================================================
+    /**
+    * Advances the time series playback by the time elapsed since the last call.
+    */
+    void onPlaybackTimeout();
+
+    //=========================================================================================================
+    /**
+    * Uploads the window of the time series which starts at a sample to both hemispheres.
+    *
+    * @param[in] iFirstSample           The first sample of the window.
+    */
+    void uploadTimeSeriesWindow(int iFirstSample);
+
     bool                                m_bIsDataInit;                      /**< The init flag. */
     bool                                m_bUseGPU;                          /**< The use GPU flag. */
+    bool                                m_bTimeSeriesPlayback;              /**< Whether the GPU time series playback is used. */
+    bool                                m_bIsStreaming;                     /**< The streaming state. */
+    bool                                m_bIsLooping;                       /**< The loop state. */
+
+    int                                 m_iNumSourcesLeft;                  /**< The number of sources of the left hemisphere. */
+    int                                 m_iNumSourcesRight;                 /**< The number of sources of the right hemisphere. */
+    int                                 m_iMSecInterval;                    /**< The time in milliseconds in between two samples. */
+    int                                 m_iTimeSeriesWindow;                /**< The maximum number of uploaded samples, 0 for all. */
+    int                                 m_iWindowFirstSample;               /**< The first sample of the uploaded window. */
+    double                              m_dCurrentSample;                   /**< The displayed (fractional) sample of the time series. */
+
+    Eigen::MatrixXf                     m_matTimeSeries;                    /**< The time series of the playback (sources x samples). */
+
+    QTimer                              m_playbackTimer;                    /**< The timer which advances the time series playback once per frame. */
+    QElapsedTimer                       m_playbackClock;                    /**< Measures the time in between two playback steps. */
 
     QPointer<RtSourceDataController>    m_pRtSourceDataController;          /**< The source data worker. This worker streams the rt data to this item.*/
 
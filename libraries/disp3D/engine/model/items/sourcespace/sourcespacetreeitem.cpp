@@ -136,48 +136,29 @@ void SourceSpaceTreeItem::plotSources(const MNEHemisphere& tHemisphere)
     //create instanced renderer
     GeometryMultiplier *pSphereMesh = new GeometryMultiplier(pSourceSphereGeometry);
 
-    //Create transform matrix for each sphere instance
-    QVector<QMatrix4x4> vTransforms;
-    QVector3D tempPos;
+    //Collect the position of each sphere instance
+    MatrixX3f matPositions;
 
     if(tHemisphere.isClustered())
     {
-        vTransforms.reserve(tHemisphere.cluster_info.centroidVertno.size());
+        matPositions.resize(tHemisphere.cluster_info.centroidVertno.size(), 3);
 
         for(int i = 0; i < tHemisphere.cluster_info.centroidVertno.size(); i++)
         {
-            QMatrix4x4 tempTransform;
-            const RowVector3f& sourcePos = tHemisphere.rr.row(tHemisphere.cluster_info.centroidVertno.at(i));
-
-            tempPos.setX(sourcePos(0));
-            tempPos.setY(sourcePos(1));
-            tempPos.setZ(sourcePos(2));
-
-            //Set position
-            tempTransform.translate(tempPos);
-            vTransforms.push_back(tempTransform);
+            matPositions.row(i) = tHemisphere.rr.row(tHemisphere.cluster_info.centroidVertno.at(i));
         }
     }
     else
     {
-        vTransforms.reserve(tHemisphere.vertno.rows());
+        matPositions.resize(tHemisphere.vertno.rows(), 3);
 
         for(int i = 0; i < tHemisphere.vertno.rows(); i++)
         {
-            QMatrix4x4 tempTransform;
-            const RowVector3f& sourcePos = tHemisphere.rr.row(tHemisphere.vertno(i));
-
-            tempPos.setX(sourcePos(0));
-            tempPos.setY(sourcePos(1));
-            tempPos.setZ(sourcePos(2));
-
-            //Set position
-            tempTransform.translate(tempPos);
-            vTransforms.push_back(tempTransform);
+            matPositions.row(i) = tHemisphere.rr.row(tHemisphere.vertno(i));
         }
     }
-    //Set instance Transform
-    pSphereMesh->setTransforms(vTransforms);
+    //Set instance positions
+    pSphereMesh->setPositions(matPositions);
 
     pSourceSphereEntity->addComponent(pSphereMesh);
 
@@ -93,9 +93,15 @@ GpuInterpolationMaterial::GpuInterpolationMaterial(bool bUseSortPolicy, Qt3DCore
     , m_pDrawRenderPass(new QRenderPass)
     , m_pDrawTechnique(new QTechnique)
     , m_pSignalDataParameter(new QParameter)
+    , m_pSignalSeriesParameter(new QParameter)
+    , m_pSamplesParameter(new QParameter(QStringLiteral("samples"), 1))
+    , m_pCurrentSampleParameter(new QParameter(QStringLiteral("fCurrentSample"), 0.0f))
+    , m_pTimeSeriesModeParameter(new QParameter(QStringLiteral("TimeSeriesMode"), 0))
     , m_pColsParameter(new QParameter)
     , m_pRowsParameter(new QParameter)
     , m_pInterpolationMatParameter(new QParameter)
+    , m_pInterpolationRowPtrParameter(new QParameter)
+    , m_pInterpolationColIdxParameter(new QParameter)
     , m_pOutputColorParameter(new QParameter)
     , m_pThresholdXParameter(new QParameter(QStringLiteral("fThresholdX"), 1e-10f))
     , m_pThresholdZParameter(new QParameter(QStringLiteral("fThresholdZ"), 6e-6f))
@@ -131,20 +137,31 @@ void GpuInterpolationMaterial::init()
     m_pRowsParameter->setName(QStringLiteral("rows"));
     m_pRowsParameter->setValue(1);
     m_pInterpolationMatParameter->setName(QStringLiteral("InterpolationMat"));
+    m_pInterpolationRowPtrParameter->setName(QStringLiteral("InterpolationRowPtr"));
+    m_pInterpolationColIdxParameter->setName(QStringLiteral("InterpolationColIdx"));
 
     //Set default output
     m_pOutputColorParameter->setName(QStringLiteral("OutputColor"));
 
     //Set default input
     m_pSignalDataParameter->setName(QStringLiteral("InputVec"));
+    m_pSignalSeriesParameter->setName(QStringLiteral("InputSeries"));
 
     //Add compute Parameter
     m_pComputeRenderPass->addParameter(m_pColsParameter);
     m_pComputeRenderPass->addParameter(m_pRowsParameter);
     m_pComputeRenderPass->addParameter(m_pOutputColorParameter);
     m_pComputeRenderPass->addParameter(m_pInterpolationMatParameter);
+    m_pComputeRenderPass->addParameter(m_pInterpolationRowPtrParameter);
+    m_pComputeRenderPass->addParameter(m_pInterpolationColIdxParameter);
     m_pComputeRenderPass->addParameter(m_pSignalDataParameter);
 
+    //Add time series parameter
+    m_pComputeRenderPass->addParameter(m_pSignalSeriesParameter);
+    m_pComputeRenderPass->addParameter(m_pSamplesParameter);
+    m_pComputeRenderPass->addParameter(m_pCurrentSampleParameter);
+    m_pComputeRenderPass->addParameter(m_pTimeSeriesModeParameter);
+
     //Add Threshold parameter
     m_pComputeRenderPass->addParameter(m_pThresholdXParameter);
     m_pComputeRenderPass->addParameter(m_pThresholdZParameter);
@@ -150,10 +150,18 @@ protected:
     //Measurement signal
     QPointer<Qt3DRender::QParameter>                    m_pSignalDataParameter;     /**< This parameter holds the signal data buffer. */
 
+    //Time series playback
+    QPointer<Qt3DRender::QParameter>                    m_pSignalSeriesParameter;   /**< This parameter holds the buffer with the uploaded time series (sample after sample). */
+    QPointer<Qt3DRender::QParameter>                    m_pSamplesParameter;        /**< This parameter holds the number of samples in the time series buffer. */
+    QPointer<Qt3DRender::QParameter>                    m_pCurrentSampleParameter;  /**< This parameter holds the (fractional) sample of the time series which is displayed. */
+    QPointer<Qt3DRender::QParameter>                    m_pTimeSeriesModeParameter; /**< This parameter holds whether the time series (1) or the signal data buffer (0) is interpolated. */
+
     //Interpolation matrix parameter
     QPointer<Qt3DRender::QParameter>                    m_pColsParameter;           /**< This parameter holds the number of columns in the Interpolation matrix. */
     QPointer<Qt3DRender::QParameter>                    m_pRowsParameter;           /**< This parameter holds the number of rows in the Interpolation matrix. */
-    QPointer<Qt3DRender::QParameter>                    m_pInterpolationMatParameter;/**< This parameter holds the Interpolation matrix buffer. */
+    QPointer<Qt3DRender::QParameter>                    m_pInterpolationMatParameter;/**< This parameter holds the buffer with the non-zero Interpolation matrix weights. */
+    QPointer<Qt3DRender::QParameter>                    m_pInterpolationRowPtrParameter;/**< This parameter holds the buffer with the row offsets of the Interpolation matrix. */
+    QPointer<Qt3DRender::QParameter>                    m_pInterpolationColIdxParameter;/**< This parameter holds the buffer with the column indices of the Interpolation matrix. */
 
     //Output parameter
     QPointer<Qt3DRender::QParameter>                    m_pOutputColorParameter;    /**< This parameter holds the output color buffer. */
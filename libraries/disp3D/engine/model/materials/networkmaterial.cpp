@@ -47,6 +47,8 @@
 //=============================================================================================================
 
 #include <Qt3DRender/qshaderprogram.h>
+#include <Qt3DRender/QParameter>
+#include <Qt3DRender/QEffect>
 #include <QFilterKey>
 
 #include <QUrl>
@@ -72,9 +74,16 @@ NetworkMaterial::NetworkMaterial(bool bUseSortPolicy, QNode *parent)
 : AbstractPhongAlphaMaterial(bUseSortPolicy, parent)
 , m_pVertexGL3Shader(new QShaderProgram())
 , m_pVertexES2Shader(new QShaderProgram())
+, m_pThresholdXParameter(new QParameter(QStringLiteral("fThresholdX"), 0.0f))
+, m_pThresholdZParameter(new QParameter(QStringLiteral("fThresholdZ"), 10.0f))
+, m_pColormapParameter(new QParameter(QStringLiteral("ColormapType"), 3))
 {
     init();
     setShaderCode();
+
+    m_pEffect->addParameter(m_pThresholdXParameter);
+    m_pEffect->addParameter(m_pThresholdZParameter);
+    m_pEffect->addParameter(m_pColormapParameter);
 }
 
 
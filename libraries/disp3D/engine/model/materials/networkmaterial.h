@@ -66,6 +66,7 @@
 
 namespace Qt3DRender {
     class QShaderProgram;
+    class QParameter;
 }
 
 
@@ -86,7 +87,8 @@ namespace DISP3DLIB
 
 //=============================================================================================================
 /**
-* NetworkMaterial is provides a Qt3D material with own shader support.
+* NetworkMaterial is provides a Qt3D material with own shader support. The edges are thresholded and colored in the
+* vertex shader from the per edge weights of the EdgeMultiplier, so a threshold change only updates the uniforms.
 *
 * @brief NetworkMaterial is provides a Qt3D material with own shader support.
 */
@@ -120,6 +122,10 @@ private:
 
     QPointer<Qt3DRender::QShaderProgram>    m_pVertexES2Shader;         /**< Shader program for OpenGL version ES2.0. */
     QPointer<Qt3DRender::QShaderProgram>    m_pVertexGL3Shader;         /**< Shader program for OpenGL version 3. */
+
+    QPointer<Qt3DRender::QParameter>        m_pThresholdXParameter;     /**< This parameter holds the lower threshold value. */
+    QPointer<Qt3DRender::QParameter>        m_pThresholdZParameter;     /**< This parameter holds the upper threshold value. */
+    QPointer<Qt3DRender::QParameter>        m_pColormapParameter;       /**< This parameter stores the colormap type. */
 };
 
 } // namespace DISP3DLIB
@@ -1,20 +1,221 @@
-attribute vec3 vertexPosition;
-attribute vec3 vertexNormal;
-attribute vec3 vertexColor;
+attribute vec3 vertexPosition;     //from EdgeMultiplier, x runs from 0 at the start to 1 at the end of the edge
+
+attribute vec3 instanceStart;      //from EdgeMultiplier
+attribute vec3 instanceEnd;        //from EdgeMultiplier
+attribute float instanceWeight;    //from EdgeMultiplier
 
-varying vec3 worldPosition;
-varying vec3 worldNormal;
 varying vec3 color;
 
-uniform mat4 modelMatrix;
-uniform mat3 modelNormalMatrix;
 uniform mat4 mvp;
 
+//Lower threshold, weaker edges are not drawn
+uniform float fThresholdX;
+
+//Upper threshold, stronger edges get the last color of the color map
+uniform float fThresholdZ;
+
+//color map type
+uniform int ColormapType;
+
+
+//FORWARD DECLARATIONS
+float linearSlope(float x, float m, float n);
+vec3 colorMapHot(float x);
+vec3 colorMapHotNeg1(float x);
+vec3 colorMapHotNeg2(float x);
+vec3 colorMapJet(float x);
+
 void main()
 {
-    worldNormal = normalize( modelNormalMatrix * vertexNormal );
-    worldPosition = vec3( modelMatrix * vec4( vertexPosition, 1.0 ) );
-	color = vertexColor;
-	
-    gl_Position = mvp * vec4( vertexPosition, 1.0 );
+    float fSample = abs(instanceWeight);
+
+    //Move edges below the threshold behind the far plane, so they are clipped before rasterization
+    if(fSample < fThresholdX)
+    {
+        color = vec3(0.0, 0.0, 0.0);
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        return;
+    }
+
+    //Normalize between the lower and upper threshold
+    float fTresholdDiff = fThresholdZ - fThresholdX;
+    if(fSample >= fThresholdZ || fTresholdDiff <= 0.0) {
+        fSample = 1.0;
+    } else {
+        fSample = (fSample - fThresholdX) / fTresholdDiff;
+    }
+
+    if(ColormapType == 0)
+    {
+        color = colorMapHot(fSample);
+    }
+    else if(ColormapType == 1)
+    {
+        color = colorMapHotNeg1(fSample);
+    }
+    else if(ColormapType == 2)
+    {
+        color = colorMapHotNeg2(fSample);
+    }
+    else
+    {
+        color = colorMapJet(fSample);
+    }
+
+    vec3 pos = mix(instanceStart, instanceEnd, vertexPosition.x);
+
+    gl_Position = mvp * vec4(pos, 1.0);
+}
+
+
+//*************************************************************************
+
+float linearSlope(float x, float m, float n)
+{
+    return m * x + n;
+}
+
+
+//*************************************************************************
+
+//color maps
+vec3 colorMapJet(float x)
+{
+    vec3 outColor = vec3(0.0, 0.0, 0.0);
+
+    if(x < 0.125)
+    {
+        //blue
+        outColor.z = linearSlope(x, 4.0, 0.5);
+    }
+    else if(x >= 0.125 && x < 0.375)
+    {
+        //green
+        outColor.y = linearSlope(x, 4.0, -0.5);
+        //blue
+        outColor.z = 1.0;
+    }
+    else if(x >= 0.375 && x < 0.625)
+    {
+        //red
+        outColor.x = linearSlope(x, 4.0, -1.5);
+        //green
+        outColor.y = 1.0;
+        //blue
+        outColor.z = linearSlope(x, -4.0, 2.5);
+    }
+    else if(x >= 0.625 && x < 0.875)
+    {
+        //red
+        outColor.x = 1.0;
+        //green
+        outColor.y = linearSlope(x, -4.0, 3.5);
+    }
+    else
+    {
+        //red
+        outColor.x = linearSlope(x, -4.0, 4.5);
+    }
+
+    return outColor;
+}
+
+
+//*************************************************************************
+
+vec3 colorMapHot(float x)
+{
+    vec3 outColor = vec3(0.0, 0.0, 0.0);
+
+    if(x < 0.375)
+    {
+        //red
+        outColor.x = linearSlope(x, 2.5621, 0.0392);
+    }
+    else if(x >= 0.375 && x < 0.75)
+    {
+        //red
+        outColor.x = 1.0;
+        //green
+        outColor.y = linearSlope(x, 2.6667, -1.0);
+    }
+    else
+    {
+        //red
+        outColor.x = 1.0;
+        //green
+        outColor.y = 1.0;
+        //blue
+        outColor.z = linearSlope(x,4.0,-3.0);
+    }
+
+    return outColor;
+}
+
+
+//*************************************************************************
+
+vec3 colorMapHotNeg1(float x)
+{
+    vec3 outColor = vec3(0.0, 0.0, 0.0);
+
+    if(x >= 0.2188 && x < 0.5781)
+    {
+        //red
+        outColor.x = linearSlope(x, 2.7832, -0.6090);
+    }
+    else if( x >= 0.5781 && x < 0.8125)
+    {
+        //red
+        outColor.x = 1.0;
+        //green
+        outColor.y = linearSlope(x, 4.2662, -2.4663);
+    }
+    else if( x >= 0.8125)
+    {
+        //red
+        outColor.x = 1.0;
+        //green
+        outColor.y = 1.0;
+        //blue
+        outColor.z = linearSlope(x,5.3333,-4.3333);
+    }
+
+    return outColor;
+}
+
+
+//*************************************************************************
+
+vec3 colorMapHotNeg2(float x)
+{
+    vec3 outColor = vec3(0.0, 0.0, 0.0);
+
+    if( x >= 0.5625 && x < 0.8438)
+    {
+        //red
+        outColor.x = linearSlope(x, 3.5549, -1.9996);
+        //green
+        outColor.y = 0.0;
+        //blue
+        outColor.z = 0.0;
+    }
+    else if(x >= 0.8438 && x < 0.9531)
+    {
+        //red
+        outColor.x = 1.0;
+        //green
+        outColor.y = linearSlope(x, 9.1491, -7.72);
+    }
+    else if( x >= 0.9531)
+    {
+        //red
+        outColor.x = 1.0;
+        //green
+        outColor.y = 1.0;
+        //blue
+        outColor.z = linearSlope(x,21.3220,-20.3220);
+    }
+
+    return outColor;
 }
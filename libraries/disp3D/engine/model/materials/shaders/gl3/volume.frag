@@ -0,0 +1,155 @@
+#version 150 core
+
+//volume, 16 bit normalized intensities
+uniform sampler3D volumeTexture;
+
+//maps model coordinates to texture coordinates, the volume covers [0,1]^3
+uniform mat4 matModelToTexture;
+
+//fraction of the texture width covered by voxels
+uniform float fTextureScaleX;
+
+//render mode: 0 composite, 1 maximum intensity, 2 slices
+uniform int RenderMode;
+
+//intensity window
+uniform float fWindowMin;
+uniform float fWindowMax;
+
+//opacity per step of a voxel at the upper window end, composite rendering only
+uniform float fDensity;
+
+//alpha of maximum intensity and slice rendering
+uniform float alpha;
+
+//slice positions in texture coordinates
+uniform vec3 slicePosition;
+
+//number of steps across the volume
+uniform int iSteps;
+
+//sampled mipmap level
+uniform float fLevelOfDetail;
+
+uniform mat4 inverseModelMatrix;
+uniform vec3 eyePosition;
+
+in vec3 texturePosition;
+
+out vec4 fragColor;
+
+
+//FORWARD DECLARATIONS
+float sampleVolume(vec3 p);
+float windowed(float fValue);
+
+
+void main()
+{
+    //The ray from the eye ends at the back face (t = 1), the entry is the intersection with the volume box
+    vec3 eye = vec3( matModelToTexture * inverseModelMatrix * vec4( eyePosition, 1.0 ) );
+    vec3 dir = texturePosition - eye;
+
+    //avoid divisions by zero for rays parallel to a face
+    vec3 safeDir = mix( dir, vec3( 1e-6 ), lessThan( abs( dir ), vec3( 1e-6 ) ) );
+    vec3 t0 = ( vec3( 0.0 ) - eye ) / safeDir;
+    vec3 t1 = ( vec3( 1.0 ) - eye ) / safeDir;
+    vec3 tMin = min( t0, t1 );
+    float tNear = max( max( tMin.x, tMin.y ), max( tMin.z, 0.0 ) );
+    float tFar = 1.0;
+
+    if(tNear >= tFar)
+    {
+        discard;
+    }
+
+    if(RenderMode == 2)
+    {
+        //slices: take the closest of the three orthogonal planes which the ray hits inside of the volume
+        float tHit = tFar + 1.0;
+        float fValue = 0.0;
+
+        for(int i = 0; i < 3; i++)
+        {
+            if(abs( dir[i] ) > 1e-6)
+            {
+                float t = ( slicePosition[i] - eye[i] ) / dir[i];
+                vec3 p = eye + t * dir;
+
+                if(t >= tNear && t <= tFar && t < tHit && all( greaterThanEqual( p, vec3( 0.0 ) ) ) && all( lessThanEqual( p, vec3( 1.0 ) ) ))
+                {
+                    tHit = t;
+                    fValue = sampleVolume( p );
+                }
+            }
+        }
+
+        if(tHit > tFar)
+        {
+            discard;
+        }
+
+        fragColor = vec4( vec3( windowed( fValue ) ), alpha );
+        return;
+    }
+
+    //march with steps of about 1 / iSteps, sampling in the middle of each step
+    vec3 segment = ( tFar - tNear ) * dir;
+    int iNumSteps = int( clamp( length( segment ) * float( iSteps ), 1.0, 4096.0 ) );
+    vec3 delta = segment / float( iNumSteps );
+    vec3 p = eye + tNear * dir + 0.5 * delta;
+
+    if(RenderMode == 1)
+    {
+        float fMax = 0.0;
+        for(int i = 0; i < iNumSteps; i++)
+        {
+            fMax = max( fMax, sampleVolume( p ) );
+            p += delta;
+        }
+
+        float fIntensity = windowed( fMax );
+        if(fIntensity <= 0.0)
+        {
+            discard;
+        }
+
+        fragColor = vec4( vec3( fIntensity ), alpha );
+        return;
+    }
+
+    //composite front to back and stop once the ray is opaque
+    vec4 accum = vec4( 0.0 );
+    for(int i = 0; i < iNumSteps && accum.a < 0.99; i++)
+    {
+        float fIntensity = windowed( sampleVolume( p ) );
+        float fAlpha = fIntensity * fDensity;
+
+        accum.rgb += ( 1.0 - accum.a ) * fAlpha * vec3( fIntensity );
+        accum.a += ( 1.0 - accum.a ) * fAlpha;
+        p += delta;
+    }
+
+    if(accum.a <= 0.0)
+    {
+        discard;
+    }
+
+    fragColor = vec4( accum.rgb / accum.a, accum.a );
+}
+
+
+//*************************************************************************
+
+float sampleVolume(vec3 p)
+{
+    return textureLod( volumeTexture, vec3( p.x * fTextureScaleX, p.y, p.z ), fLevelOfDetail ).r;
+}
+
+
+//*************************************************************************
+
+float windowed(float fValue)
+{
+    return clamp( ( fValue - fWindowMin ) / max( fWindowMax - fWindowMin, 1e-6 ), 0.0, 1.0 );
+}
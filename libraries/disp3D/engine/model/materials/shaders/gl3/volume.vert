@@ -0,0 +1,15 @@
+#version 150 core
+
+in vec3 vertexPosition;
+
+out vec3 texturePosition;
+
+uniform mat4 matModelToTexture;
+uniform mat4 mvp;
+
+void main()
+{
+    texturePosition = vec3( matModelToTexture * vec4( vertexPosition, 1.0 ) );
+
+    gl_Position = mvp * vec4( vertexPosition, 1.0 );
+}
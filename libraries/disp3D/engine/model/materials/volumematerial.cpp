@@ -0,0 +1,172 @@
+//=============================================================================================================
+/**
+* @file     volumematerial.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the VolumeMaterial class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "volumematerial.h"
+#include "../3dhelpers/volumetextureimage.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <Qt3DRender/qeffect.h>
+#include <Qt3DRender/qtechnique.h>
+#include <Qt3DRender/qshaderprogram.h>
+#include <Qt3DRender/qparameter.h>
+#include <Qt3DRender/qrenderpass.h>
+#include <Qt3DRender/qgraphicsapifilter.h>
+#include <Qt3DRender/QCullFace>
+#include <Qt3DRender/QTexture>
+#include <QFilterKey>
+
+#include <QUrl>
+#include <QVector3D>
+#include <QMatrix4x4>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace Qt3DRender;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+VolumeMaterial::VolumeMaterial(QNode *parent)
+: QMaterial(parent)
+, m_pVolumeEffect(new QEffect())
+, m_pFilterKey(new QFilterKey)
+, m_pVolumeGL3Technique(new QTechnique())
+, m_pVolumeGL3RenderPass(new QRenderPass())
+, m_pVolumeGL3Shader(new QShaderProgram())
+, m_pCullFace(new QCullFace())
+, m_pVolumeTexture(new QTexture3D())
+, m_pVolumeTextureImage(new VolumeTextureImage())
+, m_pVolumeTextureParameter(new QParameter())
+, m_pModelToTextureParameter(new QParameter(QStringLiteral("matModelToTexture"), QMatrix4x4()))
+, m_pTextureScaleXParameter(new QParameter(QStringLiteral("fTextureScaleX"), 1.0f))
+, m_pRenderModeParameter(new QParameter(QStringLiteral("RenderMode"), 0))
+, m_pWindowMinParameter(new QParameter(QStringLiteral("fWindowMin"), 0.0f))
+, m_pWindowMaxParameter(new QParameter(QStringLiteral("fWindowMax"), 1.0f))
+, m_pDensityParameter(new QParameter(QStringLiteral("fDensity"), 0.05f))
+, m_pAlphaParameter(new QParameter(QStringLiteral("alpha"), 1.0f))
+, m_pSlicePositionParameter(new QParameter(QStringLiteral("slicePosition"), QVector3D(0.5f, 0.5f, 0.5f)))
+, m_pStepsParameter(new QParameter(QStringLiteral("iSteps"), 256))
+, m_pLevelOfDetailParameter(new QParameter(QStringLiteral("fLevelOfDetail"), 0.0f))
+{
+    this->init();
+}
+
+
+//*************************************************************************************************************
+
+void VolumeMaterial::setVolume(const QByteArray &data,
+                               int iWidth,
+                               int iHeight,
+                               int iDepth)
+{
+    m_pVolumeTexture->setSize(iWidth, iHeight, iDepth);
+    m_pVolumeTextureImage->setVolume(data, iWidth, iHeight, iDepth);
+}
+
+
+//*************************************************************************************************************
+
+void VolumeMaterial::init()
+{
+    //Set texture, the mipmaps are generated on the GPU and used for coarser sampling while browsing
+    m_pVolumeTexture->setFormat(QAbstractTexture::R16_UNorm);
+    m_pVolumeTexture->setGenerateMipMaps(true);
+    m_pVolumeTexture->setMinificationFilter(QAbstractTexture::LinearMipMapLinear);
+    m_pVolumeTexture->setMagnificationFilter(QAbstractTexture::Linear);
+    m_pVolumeTexture->wrapMode()->setX(QTextureWrapMode::ClampToEdge);
+    m_pVolumeTexture->wrapMode()->setY(QTextureWrapMode::ClampToEdge);
+    m_pVolumeTexture->wrapMode()->setZ(QTextureWrapMode::ClampToEdge);
+    m_pVolumeTexture->addTextureImage(m_pVolumeTextureImage);
+
+    m_pVolumeTextureParameter->setName(QStringLiteral("volumeTexture"));
+    m_pVolumeTextureParameter->setValue(QVariant::fromValue(m_pVolumeTexture.data()));
+
+    //Set shader
+    m_pVolumeGL3Shader->setVertexShaderCode(QShaderProgram::loadSource(QUrl(QStringLiteral("qrc:/engine/model/materials/shaders/gl3/volume.vert"))));
+    m_pVolumeGL3Shader->setFragmentShaderCode(QShaderProgram::loadSource(QUrl(QStringLiteral("qrc:/engine/model/materials/shaders/gl3/volume.frag"))));
+    m_pVolumeGL3RenderPass->setShaderProgram(m_pVolumeGL3Shader);
+
+    //Draw the back faces, each fragment marches from the entry point of its ray up to the back face
+    m_pCullFace->setMode(QCullFace::Front);
+    m_pVolumeGL3RenderPass->addRenderState(m_pCullFace);
+
+    //Set OpenGL version - Sampling 3D textures with explicit level of detail needs OpenGL 3.2 or higher
+    m_pVolumeGL3Technique->graphicsApiFilter()->setApi(QGraphicsApiFilter::OpenGL);
+    m_pVolumeGL3Technique->graphicsApiFilter()->setMajorVersion(3);
+    m_pVolumeGL3Technique->graphicsApiFilter()->setMinorVersion(2);
+    m_pVolumeGL3Technique->graphicsApiFilter()->setProfile(QGraphicsApiFilter::CoreProfile);
+
+    m_pFilterKey->setName(QStringLiteral("renderingStyle"));
+    m_pFilterKey->setValue(QStringLiteral("forwardTransparent"));
+    m_pVolumeGL3Technique->addFilterKey(m_pFilterKey);
+
+    m_pVolumeGL3Technique->addRenderPass(m_pVolumeGL3RenderPass);
+
+    //Add parameters
+    m_pVolumeEffect->addParameter(m_pVolumeTextureParameter);
+    m_pVolumeEffect->addParameter(m_pModelToTextureParameter);
+    m_pVolumeEffect->addParameter(m_pTextureScaleXParameter);
+    m_pVolumeEffect->addParameter(m_pRenderModeParameter);
+    m_pVolumeEffect->addParameter(m_pWindowMinParameter);
+    m_pVolumeEffect->addParameter(m_pWindowMaxParameter);
+    m_pVolumeEffect->addParameter(m_pDensityParameter);
+    m_pVolumeEffect->addParameter(m_pAlphaParameter);
+    m_pVolumeEffect->addParameter(m_pSlicePositionParameter);
+    m_pVolumeEffect->addParameter(m_pStepsParameter);
+    m_pVolumeEffect->addParameter(m_pLevelOfDetailParameter);
+
+    m_pVolumeEffect->addTechnique(m_pVolumeGL3Technique);
+
+    this->setEffect(m_pVolumeEffect);
+}
@@ -0,0 +1,172 @@
+//=============================================================================================================
+/**
+* @file     volumematerial.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the VolumeMaterial class.
+*
+*/
+
+#ifndef DISP3DLIB_VOLUMEMATERIAL_H
+#define DISP3DLIB_VOLUMEMATERIAL_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../../../disp3D_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <Qt3DRender/qmaterial.h>
+#include <QPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+namespace Qt3DRender {
+    class QEffect;
+    class QParameter;
+    class QShaderProgram;
+    class QFilterKey;
+    class QTechnique;
+    class QRenderPass;
+    class QCullFace;
+    class QTexture3D;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DISP3DLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+class VolumeTextureImage;
+
+
+//=============================================================================================================
+/**
+* VolumeMaterial renders a volume which is uploaded once as a mipmapped 3D texture. The fragment shader marches
+* along the view ray through the bounding box of the volume and either composites the windowed intensities, shows
+* their maximum or samples three orthogonal slices. The material draws the back faces of the box, so the volume
+* stays visible while the camera is inside of it.
+*
+* @brief VolumeMaterial provides ray marched volume rendering of 3D textures.
+*/
+class DISP3DSHARED_EXPORT VolumeMaterial : public Qt3DRender::QMaterial
+{
+    Q_OBJECT
+
+public:
+    //=========================================================================================================
+    /**
+    * Default constructor.
+    *
+    * @param[in] parent         The parent of this class.
+    */
+    explicit VolumeMaterial(Qt3DCore::QNode *parent = 0);
+
+    //=========================================================================================================
+    /**
+    * Default destructor.
+    */
+    ~VolumeMaterial() = default;
+
+    //=========================================================================================================
+    /**
+    * Uploads the voxels of the volume. See VolumeTextureImage::setVolume for the layout.
+    *
+    * @param[in] data           The voxels as quint16.
+    * @param[in] iWidth         The number of voxels in x direction, must be even.
+    * @param[in] iHeight        The number of voxels in y direction.
+    * @param[in] iDepth         The number of voxels in z direction.
+    */
+    void setVolume(const QByteArray &data,
+                   int iWidth,
+                   int iHeight,
+                   int iDepth);
+
+private:
+    //=========================================================================================================
+    /**
+    * Init the VolumeMaterial class.
+    */
+    void init();
+
+    QPointer<Qt3DRender::QEffect>                   m_pVolumeEffect;            /**< The material effect. */
+
+    QPointer<Qt3DRender::QFilterKey>                m_pFilterKey;               /**< Filter key for navigating in the frame graph. */
+
+    QPointer<Qt3DRender::QTechnique>                m_pVolumeGL3Technique;      /**< The OpenGL 3.2 technique. */
+    QPointer<Qt3DRender::QRenderPass>               m_pVolumeGL3RenderPass;     /**< The render pass of the ray marching. */
+    QPointer<Qt3DRender::QShaderProgram>            m_pVolumeGL3Shader;         /**< The ray marching shader. */
+    QPointer<Qt3DRender::QCullFace>                 m_pCullFace;                /**< Culls the front faces of the box. */
+
+    QPointer<Qt3DRender::QTexture3D>                m_pVolumeTexture;           /**< The 3D texture holding the volume. */
+    QPointer<VolumeTextureImage>                    m_pVolumeTextureImage;      /**< The texture image providing the voxels. */
+
+    QPointer<Qt3DRender::QParameter>                m_pVolumeTextureParameter;  /**< This parameter holds the 3D texture. */
+    QPointer<Qt3DRender::QParameter>                m_pModelToTextureParameter; /**< This parameter holds the mapping from model to texture coordinates. */
+    QPointer<Qt3DRender::QParameter>                m_pTextureScaleXParameter;  /**< This parameter holds the fraction of the texture width covered by voxels. */
+    QPointer<Qt3DRender::QParameter>                m_pRenderModeParameter;     /**< This parameter holds the render mode (0 composite, 1 maximum intensity, 2 slices). */
+    QPointer<Qt3DRender::QParameter>                m_pWindowMinParameter;      /**< This parameter holds the lower end of the intensity window. */
+    QPointer<Qt3DRender::QParameter>                m_pWindowMaxParameter;      /**< This parameter holds the upper end of the intensity window. */
+    QPointer<Qt3DRender::QParameter>                m_pDensityParameter;        /**< This parameter holds the opacity per step of a voxel at the upper window end. */
+    QPointer<Qt3DRender::QParameter>                m_pAlphaParameter;          /**< This parameter holds the alpha value of maximum intensity and slice rendering. */
+    QPointer<Qt3DRender::QParameter>                m_pSlicePositionParameter;  /**< This parameter holds the position of the slices in texture coordinates. */
+    QPointer<Qt3DRender::QParameter>                m_pStepsParameter;          /**< This parameter holds the number of steps across the volume. */
+    QPointer<Qt3DRender::QParameter>                m_pLevelOfDetailParameter;  /**< This parameter holds the mipmap level which is sampled. */
+};
+
+} // namespace DISP3DLIB
+
+#endif // DISP3DLIB_VOLUMEMATERIAL_H
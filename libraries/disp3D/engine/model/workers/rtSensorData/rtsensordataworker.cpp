@@ -82,7 +82,9 @@ RtSensorDataWorker::RtSensorDataWorker()
 , m_iAverageSamples(1)
 , m_dSFreq(1000.0)
 , m_bStreamSmoothedData(true)
-, m_itCurrentSample(0)
+, m_iDataQFirst(0)
+, m_iDataQSize(0)
+, m_iCurrentSample(0)
 , m_iSampleCtr(0)
 , m_pMatInterpolationMatrix(QSharedPointer<SparseMatrix<float> >(new SparseMatrix<float>()))
 {
@@ -98,14 +100,28 @@ void RtSensorDataWorker::addData(const MatrixXd& data)
         return;
     }
 
-    //Transform from matrix to list for easier handling in non loop mode
-    for(int i = 0; i<data.cols(); i++) {
-        if(m_lDataQ.size() < m_dSFreq) {
-            m_lDataQ.push_back(data.col(i));
-        } else {
-            qDebug() <<"RtSensorDataWorker::addData - worker is full!";
-            break;
-        }
+    //Keep the samples in a preallocated ring buffer holding up to one second of data
+    int iCapacity = qMax(1, (int)m_dSFreq);
+    if(m_matDataQ.rows() != data.rows() || m_matDataQ.cols() != iCapacity) {
+        m_matDataQ.resize(data.rows(), iCapacity);
+        m_iDataQFirst = 0;
+        m_iDataQSize = 0;
+        m_iCurrentSample = 0;
+    }
+
+    int iNumCopy = qMin((int)data.cols(), iCapacity - m_iDataQSize);
+
+    //Copy in contiguous blocks, splitting where the buffer wraps around
+    for(int iCol = 0; iCol < iNumCopy;) {
+        int iWrite = (m_iDataQFirst + m_iDataQSize) % iCapacity;
+        int iBlock = qMin(iNumCopy - iCol, iCapacity - iWrite);
+        m_matDataQ.middleCols(iWrite, iBlock) = data.middleCols(iCol, iBlock);
+        m_iDataQSize += iBlock;
+        iCol += iBlock;
+    }
+
+    if(iNumCopy < data.cols()) {
+        qDebug() <<"RtSensorDataWorker::addData - worker is full!";
     }
 }
 
@@ -123,7 +139,11 @@ void RtSensorDataWorker::setNumberVertices(int iNumberVerts)
 
 void RtSensorDataWorker::setNumberAverages(int iNumAvr)
 {
-    m_iAverageSamples = iNumAvr;
+    m_iAverageSamples = qMax(1, iNumAvr);
+
+    //Restart the running sum with the new window length
+    m_iSampleCtr = 0;
+    m_vecAverage.setZero(m_vecAverage.rows());
 }
 
 
@@ -188,40 +208,37 @@ void RtSensorDataWorker::setInterpolationMatrix(QSharedPointer<SparseMatrix<floa
 
 void RtSensorDataWorker::streamData()
 {
-    if(m_lDataQ.size() > 0) {
-        if(m_itCurrentSample == 0) {
-            m_itCurrentSample = m_lDataQ.cbegin();
-        }
+    if(m_iDataQSize > 0) {
+        int iIndex;
 
         if(m_bIsLooping) {
             //Down sampling in loop mode
-            if(m_vecAverage.rows() != m_lDataQ.front().rows()) {
-                m_vecAverage = *m_itCurrentSample;
-            } else {
-                m_vecAverage += *m_itCurrentSample;
+            if(m_iCurrentSample >= m_iDataQSize) {
+                m_iCurrentSample = 0;
             }
+
+            iIndex = (m_iDataQFirst + m_iCurrentSample) % m_matDataQ.cols();
+            m_iCurrentSample = (m_iCurrentSample + 1) % m_iDataQSize;
         } else {
             //Down sampling in stream mode
-            if(m_vecAverage.rows() != m_lDataQ.front().rows()) {
-                m_vecAverage = m_lDataQ.front();
-            } else {
-                m_vecAverage += m_lDataQ.front();
-            }
+            iIndex = m_iDataQFirst;
+            m_iDataQFirst = (m_iDataQFirst + 1) % m_matDataQ.cols();
+            m_iDataQSize--;
+            m_iCurrentSample = 0;
+        }
 
-            m_lDataQ.pop_front();
+        //Add the sample to the running sum of the current averaging window
+        if(m_vecAverage.rows() != m_matDataQ.rows()) {
+            m_vecAverage = m_matDataQ.col(iIndex);
+        } else {
+            m_vecAverage += m_matDataQ.col(iIndex);
         }
 
-        m_itCurrentSample++;
         m_iSampleCtr++;
 
-        //Set iterator back to the front if needed
-        if(m_itCurrentSample == m_lDataQ.cend()) {
-            m_itCurrentSample = m_lDataQ.cbegin();
-        }
-
-        if(m_iSampleCtr % m_iAverageSamples == 0) {
+        if(m_iSampleCtr >= m_iAverageSamples) {
             //Perform the actual interpolation and send signal
-            m_vecAverage /= (double)m_iAverageSamples;
+            m_vecAverage /= (double)m_iSampleCtr;
             if(m_bStreamSmoothedData) {
                 emit newRtSmoothedData(generateColorsFromSensorValues(m_vecAverage));
             } else {
@@ -233,7 +250,6 @@ void RtSensorDataWorker::streamData()
             m_iSampleCtr = 0;
         }
         //qDebug()<<"RtSensorDataWorker::streamData - this->thread() "<< this->thread();
-        //qDebug()<<"RtSensorDataWorker::streamData - m_lDataQ.size()"<<m_lDataQ.size();
     }
 }
 
@@ -77,6 +77,7 @@ RtSensorInterpolationMatWorker::RtSensorInterpolationMatWorker()
     m_lInterpolationData.dCancelDistance = 0.05;
     m_lInterpolationData.interpolationFunction = DISP3DLIB::Interpolation::cubic;
     m_lInterpolationData.matDistanceMatrix = QSharedPointer<MatrixXd>(new MatrixXd());
+    m_lInterpolationData.matUnfilteredDistanceMatrix = QSharedPointer<MatrixXd>(new MatrixXd());
 }
 
 
@@ -168,10 +169,11 @@ void RtSensorInterpolationMatWorker::setBadChannels(const FiffInfo& info)
 
     m_lInterpolationData.fiffInfo = info;
 
-    //filtering of bad channels out of the distance table
+    //filtering of bad channels out of the unfiltered distance table, so channels which are no longer bad are restored
+    m_lInterpolationData.matDistanceMatrix = QSharedPointer<MatrixXd>::create(*m_lInterpolationData.matUnfilteredDistanceMatrix);
     GeometryInfo::filterBadChannels(m_lInterpolationData.matDistanceMatrix,
                                     m_lInterpolationData.fiffInfo,
-                                    m_lInterpolationData.iSensorType);    
+                                    m_lInterpolationData.iSensorType);
 
     //set vecExcludeIndex
     m_lInterpolationData.vecExcludeIndex.clear();
@@ -199,13 +201,14 @@ void RtSensorInterpolationMatWorker::calculateInterpolationOperator()
         return;
     }
 
-    //SCDC with cancel distance
-    m_lInterpolationData.matDistanceMatrix = GeometryInfo::scdc(m_lInterpolationData.matVertices,
-                                                                m_lInterpolationData.vecNeighborVertices,
-                                                                m_lInterpolationData.vecMappedSubset,
-                                                                m_lInterpolationData.dCancelDistance);
+    //SCDC with cancel distance, reused from the cache if the surface and sensors were seen before
+    m_lInterpolationData.matUnfilteredDistanceMatrix = GeometryInfo::scdcCached(m_lInterpolationData.matVertices,
+                                                                                 m_lInterpolationData.vecNeighborVertices,
+                                                                                 m_lInterpolationData.vecMappedSubset,
+                                                                                 m_lInterpolationData.dCancelDistance);
 
     //filtering of bad channels out of the distance table
+    m_lInterpolationData.matDistanceMatrix = QSharedPointer<MatrixXd>::create(*m_lInterpolationData.matUnfilteredDistanceMatrix);
     GeometryInfo::filterBadChannels(m_lInterpolationData.matDistanceMatrix,
                                     m_lInterpolationData.fiffInfo,
                                     m_lInterpolationData.iSensorType);
@@ -169,6 +169,7 @@ protected:
         double                                          dCancelDistance;                /**< Cancel distance for the interpolaion in meters. */
 
         QSharedPointer<Eigen::MatrixXd>                 matDistanceMatrix;              /**< Distance matrix that holds distances from sensors positions to the near vertices in meters. */
+        QSharedPointer<Eigen::MatrixXd>                 matUnfilteredDistanceMatrix;    /**< Distance matrix before bad channel filtering, reused when only the bad channels change. */
         Eigen::MatrixX3f                                matVertices;                    /**< Holds all vertex information. */
 
         QVector<qint32>                                 vecMappedSubset;                /**< Vector index position represents the id of the sensor and the qint in each cell is the vertex it is mapped to. */
@@ -53,7 +53,6 @@
 
 #include <QRgb>
 #include <QSharedPointer>
-#include <QLinkedList>
 
 
 //*************************************************************************************************************
@@ -244,8 +243,10 @@ protected:
     Eigen::MatrixX3f generateColorsFromSensorValues(const Eigen::VectorXd &vecSensorValues,
                                                     VisualizationInfo &visualizationInfoHemi);
 
-    QLinkedList<Eigen::VectorXd>                        m_lDataQ;                           /**< List that holds the fiff matrix data <n_channels x n_samples>. */
-    QLinkedList<Eigen::VectorXd>::const_iterator        m_itCurrentSample;                  /**< Iterator to current sample which is/was streamed. */
+    Eigen::MatrixXd                                     m_matDataQ;                         /**< Ring buffer that holds the fiff matrix data <n_channels x n_samples>. */
+    int                                                 m_iDataQFirst;                      /**< Column of the oldest sample in the ring buffer. */
+    int                                                 m_iDataQSize;                       /**< Number of samples currently held in the ring buffer. */
+    int                                                 m_iCurrentSample;                   /**< Offset from the oldest sample to the sample which is streamed next in loop mode. */
     Eigen::VectorXd                                     m_vecAverage;                       /**< The averaged data to be streamed. */
 
     bool                                                m_bIsLooping;                       /**< Flag if this thread should repeat sending the same data over and over again. */
@@ -43,6 +43,7 @@
 #include "../model/items/common/types.h"
 #include "../model/data3Dtreemodel.h"
 #include "../model/3dhelpers/renderable3Dentity.h"
+#include "../model/3dhelpers/custommesh.h"
 #include "customframegraph.h"
 #include "../model/3dhelpers/geometrymultiplier.h"
 #include "../model/materials/geometrymultipliermaterial.h"
@@ -65,6 +66,7 @@
 #include <Qt3DExtras/QCylinderGeometry>
 #include <Qt3DExtras/QSphereMesh>
 #include <Qt3DRender/QRenderSettings>
+#include <Qt3DRender/QLevelOfDetail>
 
 
 //*************************************************************************************************************
@@ -90,6 +92,8 @@ View3D::View3D()
 , m_pLightEntity(new Qt3DCore::QEntity(m_pRootEntity))
 , m_pCamera(this->camera())
 {
+    m_vecLevelOfDetailThresholds << 600.0 << 300.0 << 150.0 << 0.0;
+
     m_pFrameGraph = new CustomFrameGraph();
     init();
 }
@@ -169,6 +173,12 @@ void View3D::initLight()
 void View3D::setModel(QSharedPointer<Data3DTreeModel> pModel)
 {
     pModel->getRootEntity()->setParent(m_p3DObjectsEntity);
+
+    //Items usually receive their mesh after they were inserted, so check for new meshes whenever rows were added
+    connect(pModel.data(), &Data3DTreeModel::rowsInserted,
+            this, &View3D::updateLevelOfDetailComponents);
+
+    updateLevelOfDetailComponents();
 }
 
 
@@ -262,6 +272,51 @@ void View3D::setLightIntensity(double value)
 }
 
 
+//*************************************************************************************************************
+
+void View3D::setLevelOfDetailThresholds(const QVector<qreal>& vecThresholds)
+{
+    m_vecLevelOfDetailThresholds = vecThresholds;
+
+    QList<Qt3DRender::QLevelOfDetail*> lLevelOfDetails = m_p3DObjectsEntity->findChildren<Qt3DRender::QLevelOfDetail*>();
+    for(int i = 0; i < lLevelOfDetails.size(); ++i) {
+        lLevelOfDetails.at(i)->setThresholds(m_vecLevelOfDetailThresholds);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void View3D::updateLevelOfDetailComponents()
+{
+    QList<CustomMesh*> lMeshes = m_p3DObjectsEntity->findChildren<CustomMesh*>();
+
+    for(int i = 0; i < lMeshes.size(); ++i) {
+        CustomMesh* pMesh = lMeshes.at(i);
+        QVector<Qt3DCore::QEntity*> vecEntities = pMesh->entities();
+
+        for(int j = 0; j < vecEntities.size(); ++j) {
+            Qt3DCore::QEntity* pEntity = vecEntities.at(j);
+
+            if(pEntity->findChild<Qt3DRender::QLevelOfDetail*>(QString(), Qt::FindDirectChildrenOnly)) {
+                continue;
+            }
+
+            //Meshes without decimated levels simply stay at level 0
+            Qt3DRender::QLevelOfDetail* pLevelOfDetail = new Qt3DRender::QLevelOfDetail(pEntity);
+            pLevelOfDetail->setCamera(m_pCamera);
+            pLevelOfDetail->setThresholdType(Qt3DRender::QLevelOfDetail::ProjectedScreenPixelSizeThreshold);
+            pLevelOfDetail->setThresholds(m_vecLevelOfDetailThresholds);
+
+            connect(pLevelOfDetail, &Qt3DRender::QLevelOfDetail::currentIndexChanged,
+                    pMesh, &CustomMesh::setLevelOfDetail);
+
+            pEntity->addComponent(pLevelOfDetail);
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 void View3D::keyPressEvent(QKeyEvent* e)
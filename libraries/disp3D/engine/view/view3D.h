@@ -52,6 +52,7 @@
 
 #include <Qt3DExtras/Qt3DWindow>
 #include <QVector3D>
+#include <QVector>
 #include <QPointer>
 
 
@@ -157,6 +158,14 @@ public:
     */
     void setLightIntensity(double value);
 
+    //=========================================================================================================
+    /**
+    * Set the projected screen sizes in pixels below which the meshes switch to their next coarser level of detail.
+    *
+    * @param[in] vecThresholds      The thresholds in decreasing order, one per level of detail.
+    */
+    void setLevelOfDetailThresholds(const QVector<qreal>& vecThresholds);
+
 protected:
 
     //=========================================================================================================
@@ -193,6 +202,13 @@ protected:
     */
     void startModelRotationRecursive(QObject* pObject);
 
+    //=========================================================================================================
+    /**
+    * Adds a level of detail component to all entities holding a mesh which do not have one yet. The component
+    * watches the projected screen size of the entity and switches the level of detail of the mesh accordingly.
+    */
+    void updateLevelOfDetailComponents();
+
 
     QPointer<Qt3DCore::QEntity>         m_pRootEntity;                  /**< The root/most top level entity buffer. */
     QPointer<Qt3DCore::QEntity>         m_p3DObjectsEntity;             /**< The root/most top level entity buffer. */
@@ -205,6 +221,8 @@ protected:
     QList<QPointer<QPropertyAnimation> >  m_lPropertyAnimations;         /**< The animations for each 3D object. */
     QList<QPointer<Qt3DRender::QPointLight> >  m_lLightSources;          /**< The light sources. */
 
+    QVector<qreal>                      m_vecLevelOfDetailThresholds;   /**< The projected screen sizes in pixels at which the level of detail switches. */
+
 };
 
 } // NAMESPACE
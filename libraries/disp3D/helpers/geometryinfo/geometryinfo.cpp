@@ -42,6 +42,7 @@
 #include "geometryinfo.h"
 
 #include <fiff/fiff_info.h>
+#include <utils/executionconfig.h>
 
 
 //*************************************************************************************************************
@@ -51,7 +52,11 @@
 
 #include <cmath>
 #include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
 #include <set>
+#include <vector>
 
 
 //*************************************************************************************************************
@@ -60,6 +65,15 @@
 //=============================================================================================================
 
 #include <QtConcurrent/QtConcurrent>
+#include <QCache>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
 
 
 //*************************************************************************************************************
@@ -83,6 +97,61 @@ using namespace FIFFLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+const quint32 DISTANCE_TABLE_MAGIC = 0x53434443;    // "SCDC"
+const quint32 DISTANCE_TABLE_VERSION = 1;
+const int MEMORY_CACHE_SIZE_MB = 512;
+const qint64 RAW_DATA_CHUNK_SIZE = 1 << 30;         // QDataStream and QCryptographicHash take int lengths
+
+struct DistanceTableCache {
+    QMutex                      mutex;          /**< Guards the cache, the workers run on different threads. */
+    QCache<QByteArray, MatrixXd> cache;         /**< The distance tables, the cost is the size in MB. */
+    QString                     sDirectory;     /**< The disk cache directory, empty (default) if disabled. */
+
+    DistanceTableCache()
+    : cache(MEMORY_CACHE_SIZE_MB)
+    {
+    }
+};
+
+DistanceTableCache& distanceTableCache()
+{
+    static DistanceTableCache instance;
+    return instance;
+}
+
+void addHashData(QCryptographicHash &hash, const char* pData, qint64 iBytes)
+{
+    for(qint64 iPos = 0; iPos < iBytes; iPos += RAW_DATA_CHUNK_SIZE) {
+        hash.addData(pData + iPos, int(qMin(RAW_DATA_CHUNK_SIZE, iBytes - iPos)));
+    }
+}
+
+bool readRawData(QDataStream &stream, char* pData, qint64 iBytes)
+{
+    for(qint64 iPos = 0; iPos < iBytes; iPos += RAW_DATA_CHUNK_SIZE) {
+        int iChunk = int(qMin(RAW_DATA_CHUNK_SIZE, iBytes - iPos));
+        if(stream.readRawData(pData + iPos, iChunk) != iChunk) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool writeRawData(QDataStream &stream, const char* pData, qint64 iBytes)
+{
+    for(qint64 iPos = 0; iPos < iBytes; iPos += RAW_DATA_CHUNK_SIZE) {
+        int iChunk = int(qMin(RAW_DATA_CHUNK_SIZE, iBytes - iPos));
+        if(stream.writeRawData(pData + iPos, iChunk) != iChunk) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -110,7 +179,7 @@ QSharedPointer<MatrixXd> GeometryInfo::scdc(const MatrixX3f &matVertices,
     QSharedPointer<MatrixXd> returnMat = QSharedPointer<MatrixXd>::create(matVertices.rows(), iCols);
 
     // distribute calculation on cores
-    int iCores = QThread::idealThreadCount();
+    int iCores = UTILSLIB::ExecutionConfig::threadCount();
     if (iCores <= 0) {
         // assume that we have at least two available cores
         iCores = 2;
@@ -153,6 +222,148 @@ QSharedPointer<MatrixXd> GeometryInfo::scdc(const MatrixX3f &matVertices,
 }
 
 
+//*************************************************************************************************************
+
+QSharedPointer<SparseMatrix<float> > GeometryInfo::scdcSparse(const MatrixX3f &matVertices,
+                                                              const QVector<QVector<int> > &vecNeighborVertices,
+                                                              QVector<qint32> &vecVertSubset,
+                                                              double dCancelDist)
+{
+    if(vecVertSubset.empty()) {
+        // caller passed an empty subset, need to fill in all vertex IDs
+        vecVertSubset.reserve(matVertices.rows());
+        for(qint32 id = 0; id < matVertices.rows(); ++id) {
+            vecVertSubset.push_back(id);
+        }
+    }
+
+    // distribute calculation on cores
+    int iCores = UTILSLIB::ExecutionConfig::threadCount();
+    if (iCores <= 0) {
+        // assume that we have at least two available cores
+        iCores = 2;
+    }
+
+    const qint32 iSubArraySize = (vecVertSubset.size() + iCores - 1) / iCores;
+    QVector<QFuture<QVector<Triplet<float> > > > vecThreads;
+
+    for(qint32 iBegin = iSubArraySize; iBegin < vecVertSubset.size(); iBegin += iSubArraySize) {
+        vecThreads.append(QtConcurrent::run(std::bind(boundedDijkstra,
+                                                      std::cref(matVertices),
+                                                      std::cref(vecNeighborVertices),
+                                                      std::cref(vecVertSubset),
+                                                      iBegin,
+                                                      qMin(iBegin + iSubArraySize, vecVertSubset.size()),
+                                                      dCancelDist)));
+    }
+
+    // use main thread to calculate the first part of the subset
+    QVector<Triplet<float> > vecEntries = boundedDijkstra(matVertices,
+                                                          vecNeighborVertices,
+                                                          vecVertSubset,
+                                                          0,
+                                                          qMin(iSubArraySize, vecVertSubset.size()),
+                                                          dCancelDist);
+
+    for (QFuture<QVector<Triplet<float> > >& f : vecThreads) {
+        vecEntries += f.result();
+    }
+
+    QSharedPointer<SparseMatrix<float> > returnMat = QSharedPointer<SparseMatrix<float> >::create(matVertices.rows(), vecVertSubset.size());
+    returnMat->setFromTriplets(vecEntries.begin(), vecEntries.end());
+
+    return returnMat;
+}
+
+
+//*************************************************************************************************************
+
+QSharedPointer<MatrixXd> GeometryInfo::scdcCached(const MatrixX3f &matVertices,
+                                                  const QVector<QVector<int> > &vecNeighborVertices,
+                                                  QVector<qint32> &vecVertSubset,
+                                                  double dCancelDist)
+{
+    // fill an empty subset here already, the filled subset is part of the key
+    if(vecVertSubset.empty()) {
+        vecVertSubset.reserve(matVertices.rows());
+        for(qint32 id = 0; id < matVertices.rows(); ++id) {
+            vecVertSubset.push_back(id);
+        }
+    }
+
+    const QByteArray key = cacheKey(matVertices, vecNeighborVertices, vecVertSubset, dCancelDist);
+    DistanceTableCache& cache = distanceTableCache();
+
+    QString sFilePath;
+    {
+        QMutexLocker locker(&cache.mutex);
+        if(MatrixXd* pMatCached = cache.cache.object(key)) {
+            return QSharedPointer<MatrixXd>::create(*pMatCached);
+        }
+        if(!cache.sDirectory.isEmpty()) {
+            sFilePath = cache.sDirectory + "/" + QString::fromLatin1(key) + ".scdc";
+        }
+    }
+
+    QSharedPointer<MatrixXd> returnMat = QSharedPointer<MatrixXd>::create();
+
+    // the table on disk must match the requested dimensions, otherwise it is recomputed
+    if(sFilePath.isEmpty()
+       || !readDistanceTable(sFilePath, *returnMat)
+       || returnMat->rows() != matVertices.rows()
+       || returnMat->cols() != vecVertSubset.size()) {
+        returnMat = scdc(matVertices, vecNeighborVertices, vecVertSubset, dCancelDist);
+
+        if(!sFilePath.isEmpty() && QDir().mkpath(QFileInfo(sFilePath).absolutePath())) {
+            if(writeDistanceTable(sFilePath, *returnMat)) {
+                qDebug() << "GeometryInfo::scdcCached - Wrote distance table to" << sFilePath;
+            } else {
+                qDebug() << "[WARNING] GeometryInfo::scdcCached - Could not write distance table to" << sFilePath;
+            }
+        }
+    }
+
+    {
+        QMutexLocker locker(&cache.mutex);
+        qint64 iBytes = qint64(returnMat->size()) * qint64(sizeof(double));
+        int iCost = int(qBound(qint64(1), iBytes / (1024 * 1024), qint64(MEMORY_CACHE_SIZE_MB) + 1));
+        cache.cache.insert(key, new MatrixXd(*returnMat), iCost);
+    }
+
+    return returnMat;
+}
+
+
+//*************************************************************************************************************
+
+void GeometryInfo::setCacheDirectory(const QString &sDirectory)
+{
+    DistanceTableCache& cache = distanceTableCache();
+    QMutexLocker locker(&cache.mutex);
+    cache.sDirectory = sDirectory;
+}
+
+
+//*************************************************************************************************************
+
+QString GeometryInfo::cacheDirectory()
+{
+    DistanceTableCache& cache = distanceTableCache();
+    QMutexLocker locker(&cache.mutex);
+    return cache.sDirectory;
+}
+
+
+//*************************************************************************************************************
+
+void GeometryInfo::clearCache()
+{
+    DistanceTableCache& cache = distanceTableCache();
+    QMutexLocker locker(&cache.mutex);
+    cache.cache.clear();
+}
+
+
 //*************************************************************************************************************
 
 QVector<qint32> GeometryInfo::projectSensors(const MatrixX3f &matVertices,
@@ -160,7 +371,7 @@ QVector<qint32> GeometryInfo::projectSensors(const MatrixX3f &matVertices,
 {
     QVector<qint32> vecOutputArray;
 
-    qint32 iCores = QThread::idealThreadCount();
+    qint32 iCores = UTILSLIB::ExecutionConfig::threadCount();
     if (iCores <= 0)
     {
         // assume that we have at least two available cores
@@ -324,6 +535,48 @@ void GeometryInfo::iterativeDijkstra(QSharedPointer<MatrixXd> matOutputDistMatri
 QVector<qint32> GeometryInfo::filterBadChannels(QSharedPointer<Eigen::MatrixXd> matDistanceTable,
                                                 const FIFFLIB::FiffInfo& fiffInfo,
                                                 qint32 iSensorType) {
+    QVector<qint32> vecBadColumns = badChannelColumns(fiffInfo, iSensorType);
+
+    // set whole columns to infinity
+    for(qint32 col : vecBadColumns) {
+        if(col < matDistanceTable->cols()) {
+            matDistanceTable->col(col).setConstant(FLOAT_INFINITY);
+        }
+    }
+
+    return vecBadColumns;
+}
+
+
+//*************************************************************************************************************
+
+QVector<qint32> GeometryInfo::filterBadChannels(QSharedPointer<SparseMatrix<float> > matDistanceTable,
+                                                const FIFFLIB::FiffInfo& fiffInfo,
+                                                qint32 iSensorType) {
+    QVector<qint32> vecBadColumns = badChannelColumns(fiffInfo, iSensorType);
+
+    if(!vecBadColumns.isEmpty()) {
+        QVector<bool> vecIsBad(matDistanceTable->cols(), false);
+        for(qint32 col : vecBadColumns) {
+            if(col < vecIsBad.size()) {
+                vecIsBad[col] = true;
+            }
+        }
+
+        // missing entries are infinite distances
+        matDistanceTable->prune([&vecIsBad](const Index&, const Index& col, const float&) {
+            return !vecIsBad[col];
+        });
+    }
+
+    return vecBadColumns;
+}
+
+
+//*************************************************************************************************************
+
+QVector<qint32> GeometryInfo::badChannelColumns(const FIFFLIB::FiffInfo& fiffInfo,
+                                                qint32 iSensorType) {
     // use pointer to avoid copying of FiffChInfo objects
     QVector<qint32> vecBadColumns;
     QVector<const FiffChInfo*> vecSensors;
@@ -338,14 +591,161 @@ QVector<qint32> GeometryInfo::filterBadChannels(QSharedPointer<Eigen::MatrixXd>
     for(const QString& b : fiffInfo.bads){
         for(int col = 0; col < vecSensors.size(); ++col){
             if(vecSensors[col]->ch_name == b){
-                // found index of our bad channel, set whole column to infinity
+                // found index of our bad channel
                 vecBadColumns.push_back(col);
-                for(int row = 0; row < matDistanceTable->rows(); ++row){
-                    matDistanceTable->coeffRef(row, col) = FLOAT_INFINITY;
-                }
                 break;
             }
         }
     }
     return vecBadColumns;
 }
+
+
+//*************************************************************************************************************
+
+QVector<Triplet<float> > GeometryInfo::boundedDijkstra(const MatrixX3f &matVertices,
+                                                       const QVector<QVector<int> > &vecNeighborVertices,
+                                                       const QVector<qint32> &vecVertSubset,
+                                                       qint32 iBegin,
+                                                       qint32 iEnd,
+                                                       double dCancelDistance)
+{
+    typedef std::pair<double, qint32> QueueEntry;
+
+    QVector<Triplet<float> > vecEntries;
+    QVector<double> vecMinDists(vecNeighborVertices.size(), FLOAT_INFINITY);
+    QVector<qint32> vecTouched;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > vertexQ;
+
+    for (qint32 i = iBegin; i < iEnd; ++i) {
+        qint32 iRoot = vecVertSubset.at(i);
+        vecMinDists[iRoot] = 0.0;
+        vecTouched.push_back(iRoot);
+        vertexQ.push(std::make_pair(0.0, iRoot));
+
+        while (!vertexQ.empty()) {
+            const double dDist = vertexQ.top().first;
+            const qint32 u = vertexQ.top().second;
+            vertexQ.pop();
+
+            // outdated queue entry, u was already settled with a shorter distance
+            if (dDist > vecMinDists[u]) {
+                continue;
+            }
+
+            vecEntries.push_back(Triplet<float>(u, i, float(dDist)));
+
+            const QVector<int>& vecNeighbours = vecNeighborVertices[u];
+            for (qint32 ne = 0; ne < vecNeighbours.length(); ++ne) {
+                qint32 v = vecNeighbours[ne];
+
+                const double dDistX = matVertices(u, 0) - matVertices(v, 0);
+                const double dDistY = matVertices(u, 1) - matVertices(v, 1);
+                const double dDistZ = matVertices(u, 2) - matVertices(v, 2);
+                const double dDistWithU = dDist + sqrt(dDistX * dDistX + dDistY * dDistY + dDistZ * dDistZ);
+
+                // vertices beyond the cancel distance are never queued, this bounds the search
+                if (dDistWithU <= dCancelDistance && dDistWithU < vecMinDists[v]) {
+                    if (vecMinDists[v] == FLOAT_INFINITY) {
+                        vecTouched.push_back(v);
+                    }
+                    vecMinDists[v] = dDistWithU;
+                    vertexQ.push(std::make_pair(dDistWithU, v));
+                }
+            }
+        }
+
+        // only reset what this search touched
+        for (qint32 v : vecTouched) {
+            vecMinDists[v] = FLOAT_INFINITY;
+        }
+        vecTouched.clear();
+    }
+
+    return vecEntries;
+}
+
+
+//*************************************************************************************************************
+
+QByteArray GeometryInfo::cacheKey(const MatrixX3f &matVertices,
+                                  const QVector<QVector<int> > &vecNeighborVertices,
+                                  const QVector<qint32> &vecVertSubset,
+                                  double dCancelDist)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    qint64 iRows = matVertices.rows();
+    hash.addData(reinterpret_cast<const char*>(&iRows), sizeof(iRows));
+    addHashData(hash, reinterpret_cast<const char*>(matVertices.data()), qint64(matVertices.size()) * qint64(sizeof(float)));
+
+    // the sizes separate the neighbor lists, otherwise different adjacencies could give the same byte stream
+    for(const QVector<int>& vecNeighbors : vecNeighborVertices) {
+        qint32 iSize = vecNeighbors.size();
+        hash.addData(reinterpret_cast<const char*>(&iSize), sizeof(iSize));
+        addHashData(hash, reinterpret_cast<const char*>(vecNeighbors.constData()), qint64(iSize) * qint64(sizeof(int)));
+    }
+
+    qint32 iSubsetSize = vecVertSubset.size();
+    hash.addData(reinterpret_cast<const char*>(&iSubsetSize), sizeof(iSubsetSize));
+    addHashData(hash, reinterpret_cast<const char*>(vecVertSubset.constData()), qint64(iSubsetSize) * qint64(sizeof(qint32)));
+    hash.addData(reinterpret_cast<const char*>(&dCancelDist), sizeof(dCancelDist));
+
+    return hash.result().toHex();
+}
+
+
+//*************************************************************************************************************
+
+bool GeometryInfo::readDistanceTable(const QString &sFilePath,
+                                     MatrixXd &matDistanceTable)
+{
+    QFile file(sFilePath);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 iMagic, iVersion;
+    qint64 iRows, iCols;
+    stream >> iMagic >> iVersion >> iRows >> iCols;
+
+    if(stream.status() != QDataStream::Ok
+       || iMagic != DISTANCE_TABLE_MAGIC
+       || iVersion != DISTANCE_TABLE_VERSION
+       || iRows < 0 || iCols < 0
+       || (iRows > 0 && iCols > std::numeric_limits<qint64>::max() / qint64(sizeof(double)) / iRows)
+       || file.size() - file.pos() != iRows * iCols * qint64(sizeof(double))) {
+        qDebug() << "[WARNING] GeometryInfo::readDistanceTable - Ignoring invalid distance table" << sFilePath;
+        return false;
+    }
+
+    matDistanceTable.resize(iRows, iCols);
+    qint64 iBytes = qint64(matDistanceTable.size()) * qint64(sizeof(double));
+
+    return readRawData(stream, reinterpret_cast<char*>(matDistanceTable.data()), iBytes);
+}
+
+
+//*************************************************************************************************************
+
+bool GeometryInfo::writeDistanceTable(const QString &sFilePath,
+                                      const MatrixXd &matDistanceTable)
+{
+    QSaveFile file(sFilePath);
+    if(!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << DISTANCE_TABLE_MAGIC << DISTANCE_TABLE_VERSION
+           << qint64(matDistanceTable.rows()) << qint64(matDistanceTable.cols());
+
+    qint64 iBytes = qint64(matDistanceTable.size()) * qint64(sizeof(double));
+    if(!writeRawData(stream, reinterpret_cast<const char*>(matDistanceTable.data()), iBytes)) {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
@@ -60,6 +60,8 @@
 
 #include <QSharedPointer>
 #include <QVector>
+#include <QString>
+#include <QByteArray>
 
 
 //*************************************************************************************************************
@@ -68,6 +70,7 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 
 //*************************************************************************************************************
@@ -136,6 +139,69 @@ public:
                                                 QVector<qint32> &pVecVertSubset,
                                                 double dCancelDist = FLOAT_INFINITY);
 
+    //=========================================================================================================
+    /**
+    * @brief scdcSparse                     Calculates surface constrained distances on a mesh, storing only the distances up to the cancel distance.
+    *                                       The search from each vertex of the subset stops at the cancel distance, so time and memory scale with
+    *                                       the size of the neighborhoods instead of the size of the mesh.
+    *
+    * @param[in] matVertices                The surface on which distances should be calculated.
+    * @param[in] vecNeighborVertices        The neighbor vertex information.
+    * @param[in/out] pVecVertSubset         The subset of IDs for which the distances should be calculated.
+    * @param[in] dCancelDist                Distances higher than this are not stored.
+    *
+    * @return                               A sparse float matrix laid out like the result of scdc. Missing entries are infinite distances, the
+    *                                       zero distance of each subset vertex to itself is stored explicitly.
+    */
+    static QSharedPointer<Eigen::SparseMatrix<float> > scdcSparse(const Eigen::MatrixX3f &matVertices,
+                                                                  const QVector<QVector<int> > &vecNeighborVertices,
+                                                                  QVector<qint32> &pVecVertSubset,
+                                                                  double dCancelDist = FLOAT_INFINITY);
+
+    //=========================================================================================================
+    /**
+    * @brief scdcCached                     Same as scdc, but the distance table is looked up in a cache first.
+    *                                       The cache is keyed by a hash of the surface, the neighbor information, the
+    *                                       subset and the cancel distance. Tables are kept in memory and, only if a
+    *                                       cache directory was set with setCacheDirectory, on disk so they survive
+    *                                       restarts.
+    *
+    * @param[in] matVertices                The surface on which distances should be calculated.
+    * @param[in] vecNeighborVertices        The neighbor vertex information.
+    * @param[in/out] pVecVertSubset         The subset of IDs for which the distances should be calculated.
+    * @param[in] dCancelDist                Distances higher than this are ignored, i.e. set to infinity.
+    *
+    * @return                               A copy of the cached distance table, which can be modified by the caller (e.g. by filterBadChannels).
+    */
+    static QSharedPointer<Eigen::MatrixXd> scdcCached(const Eigen::MatrixX3f &matVertices,
+                                                      const QVector<QVector<int> > &vecNeighborVertices,
+                                                      QVector<qint32> &pVecVertSubset,
+                                                      double dCancelDist = FLOAT_INFINITY);
+
+    //=========================================================================================================
+    /**
+    * @brief setCacheDirectory              Sets the directory in which scdcCached stores distance tables. The disk
+    *                                       cache is off by default, since the tables are not evicted from disk. A
+    *                                       typical choice is the scdc folder in QStandardPaths::CacheLocation.
+    *
+    * @param[in] sDirectory                 The cache directory. An empty string disables the disk cache.
+    */
+    static void setCacheDirectory(const QString &sDirectory);
+
+    //=========================================================================================================
+    /**
+    * @brief cacheDirectory                 Returns the directory in which scdcCached stores distance tables.
+    *
+    * @return                               The cache directory, empty (default) if the disk cache is disabled.
+    */
+    static QString cacheDirectory();
+
+    //=========================================================================================================
+    /**
+    * @brief clearCache                     Removes all distance tables from the memory cache. Files on disk are kept.
+    */
+    static void clearCache();
+
     //=========================================================================================================
     /**
     * @brief                            Calculates the nearest neighbor (euclidian distance) vertex to each sensor
@@ -162,6 +228,20 @@ public:
                                              const FIFFLIB::FiffInfo& fiffInfo,
                                              qint32 iSensorType);
 
+    //=========================================================================================================
+    /**
+    * @brief filterBadChannels          Filters bad channels from a sparse distance table by removing their columns' entries
+    *
+    * @param[out] matDistanceTable      Result of scdcSparse.
+    * @param[in] fiffInfo               Container for sensors.
+    * @param[in] iSensorType            Sensor type to be filtered out, use fiff constants.
+    *
+    * @return Vector of bad channel indices.
+    */
+    static QVector<qint32> filterBadChannels(QSharedPointer<Eigen::SparseMatrix<float> > matDistanceTable,
+                                             const FIFFLIB::FiffInfo& fiffInfo,
+                                             qint32 iSensorType);
+
 protected:
     //=========================================================================================================
     /**
@@ -206,6 +286,79 @@ protected:
                                   qint32 iBegin,
                                   qint32 iEnd,
                                   double dCancelDistance);
+
+    //=========================================================================================================
+    /**
+    * @brief boundedDijkstra           Calculates shortest distances up to the cancel distance for each vertex of the passed vector that lies between the two indices.
+    *                                  Uses a binary heap and only resets the vertices touched by the previous search.
+    *
+    * @param[in] matVertices           The surface on which distances should be calculated
+    * @param[in] vecNeighborVertices   The neighbor vertex information.
+    * @param[in] vecVertSubset         The subset of vertices
+    * @param[in] iBegin                Start index of distance calculation
+    * @param[in] iEnd                  End index of distance calculation, exclusive
+    * @param[in] dCancelDistance       Distance threshold: the search stops at this distance
+    *
+    * @return                          The (vertex, subset index, distance) entries of all reached vertices
+    */
+    static QVector<Eigen::Triplet<float> > boundedDijkstra(const Eigen::MatrixX3f &matVertices,
+                                                           const QVector<QVector<int> > &vecNeighborVertices,
+                                                           const QVector<qint32> &vecVertSubset,
+                                                           qint32 iBegin,
+                                                           qint32 iEnd,
+                                                           double dCancelDistance);
+
+    //=========================================================================================================
+    /**
+    * @brief badChannelColumns         Finds the distance table columns of the bad channels.
+    *
+    * @param[in] fiffInfo              Container for sensors.
+    * @param[in] iSensorType           Sensor type to be filtered out, use fiff constants.
+    *
+    * @return                          The column indices of the bad channels.
+    */
+    static QVector<qint32> badChannelColumns(const FIFFLIB::FiffInfo& fiffInfo,
+                                             qint32 iSensorType);
+
+    //=========================================================================================================
+    /**
+    * @brief cacheKey                  Hashes all inputs of scdc which determine the distance table.
+    *
+    * @param[in] matVertices           The surface on which distances should be calculated.
+    * @param[in] vecNeighborVertices   The neighbor vertex information.
+    * @param[in] vecVertSubset         The subset of vertices.
+    * @param[in] dCancelDist           The cancel distance.
+    *
+    * @return                          The hash as hex string.
+    */
+    static QByteArray cacheKey(const Eigen::MatrixX3f &matVertices,
+                               const QVector<QVector<int> > &vecNeighborVertices,
+                               const QVector<qint32> &vecVertSubset,
+                               double dCancelDist);
+
+    //=========================================================================================================
+    /**
+    * @brief readDistanceTable         Reads a distance table written by writeDistanceTable.
+    *
+    * @param[in] sFilePath             The file path.
+    * @param[out] matDistanceTable     The distance table.
+    *
+    * @return                          True if the file exists and is a valid distance table.
+    */
+    static bool readDistanceTable(const QString &sFilePath,
+                                  Eigen::MatrixXd &matDistanceTable);
+
+    //=========================================================================================================
+    /**
+    * @brief writeDistanceTable        Writes a distance table in binary form. The file is replaced atomically.
+    *
+    * @param[in] sFilePath             The file path.
+    * @param[in] matDistanceTable      The distance table.
+    *
+    * @return                          True if the file was written.
+    */
+    static bool writeDistanceTable(const QString &sFilePath,
+                                   const Eigen::MatrixXd &matDistanceTable);
 };
 
 
@@ -40,14 +40,19 @@
 
 #include "interpolation.h"
 
+#include <utils/executionconfig.h>
+
+#include <functional>
+#include <algorithm>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
-#include <QSet>
 #include <QDebug>
+#include <QtConcurrent/QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -70,6 +75,209 @@ using namespace Eigen;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+// the built-in weight functions as functors, so that they are inlined into the row loop
+struct LinearWeight {
+    inline double operator()(double dIn) const { return Interpolation::linear(dIn); }
+};
+
+struct GaussianWeight {
+    inline double operator()(double dIn) const { return Interpolation::gaussian(dIn); }
+};
+
+struct SquareWeight {
+    inline double operator()(double dIn) const { return Interpolation::square(dIn); }
+};
+
+struct CubicWeight {
+    inline double operator()(double dIn) const { return Interpolation::cubic(dIn); }
+};
+
+struct FunctionWeight {
+    double (*interpolationFunction) (double);
+    inline double operator()(double dIn) const { return interpolationFunction(dIn); }
+};
+
+// the rows [iBegin, iEnd) of the interpolation matrix in compressed row form
+struct RowBlock {
+    QVector<int>    vecRowNonZeros;
+    QVector<int>    vecCols;
+    QVector<float>  vecValues;
+};
+
+template<typename Function>
+inline void visitDistances(const MatrixXd& matDistanceTable, qint32 r, qint32 iCols, Function f)
+{
+    for (qint32 c = 0; c < iCols; ++c) {
+        f(c, static_cast<float>(matDistanceTable(r, c)));
+    }
+}
+
+template<typename Function>
+inline void visitDistances(const SparseMatrix<float, RowMajor>& matDistanceTable, qint32 r, qint32 iCols, Function f)
+{
+    for (SparseMatrix<float, RowMajor>::InnerIterator it(matDistanceTable, r); it; ++it) {
+        if (it.col() < iCols) {
+            f(static_cast<qint32>(it.col()), it.value());
+        }
+    }
+}
+
+// For every row the column of the sensor assigned to it, -1 for "normal" nodes. Bad channels are not assigned.
+QVector<qint32> createSensorColumns(const QVector<qint32> &vecProjectedSensors,
+                                    const QVector<qint32> &vecExcludeIndex,
+                                    qint32 iRows)
+{
+    QVector<qint32> vecSensorColumns(iRows, -1);
+
+    for (qint32 idx = 0; idx < vecProjectedSensors.size(); ++idx) {
+        const qint32 s = vecProjectedSensors.at(idx);
+
+        if (s >= 0 && s < iRows && vecSensorColumns.at(s) < 0 && !vecExcludeIndex.contains(idx)) {
+            vecSensorColumns[s] = vecProjectedSensors.indexOf(s);
+        }
+    }
+
+    return vecSensorColumns;
+}
+
+template<typename DistanceTable, typename Weight>
+RowBlock computeRows(const DistanceTable& matDistanceTable,
+                     const QVector<qint32>& vecSensorColumns,
+                     qint32 iCols,
+                     double dCancelDist,
+                     Weight weight,
+                     qint32 iBegin,
+                     qint32 iEnd)
+{
+    RowBlock block;
+    block.vecRowNonZeros.resize(iEnd - iBegin);
+
+    for (qint32 r = iBegin; r < iEnd; ++r) {
+        const qint32 iSensorColumn = vecSensorColumns.at(r);
+
+        if (iSensorColumn >= 0) {
+            // a sensor has been assigned to this node, we do not need to interpolate anything
+            //(final vertex signal is equal to sensor input signal, thus factor 1)
+            block.vecCols.append(iSensorColumn);
+            block.vecValues.append(1.0f);
+            block.vecRowNonZeros[r - iBegin] = 1;
+            continue;
+        }
+
+        // "normal" node, i.e. one which was not assigned a sensor. Only distances below the passed threshold (dCancelDist) contribute.
+        const int iRowStart = block.vecValues.size();
+        float dWeightsSum = 0.0;
+
+        visitDistances(matDistanceTable, r, iCols, [&](qint32 c, float dDist) {
+            if (dDist < dCancelDist) {
+                const float dValueWeight = std::fabs(1.0 / weight(dDist));
+                dWeightsSum += dValueWeight;
+                block.vecCols.append(c);
+                block.vecValues.append(dValueWeight);
+            }
+        });
+
+        for (int i = iRowStart; i < block.vecValues.size(); ++i) {
+            block.vecValues[i] /= dWeightsSum;
+        }
+
+        block.vecRowNonZeros[r - iBegin] = block.vecValues.size() - iRowStart;
+    }
+
+    return block;
+}
+
+template<typename DistanceTable, typename Weight>
+QSharedPointer<SparseMatrix<float> > buildInterpolationMat(const DistanceTable& matDistanceTable,
+                                                           const QVector<qint32>& vecSensorColumns,
+                                                           qint32 iCols,
+                                                           double dCancelDist,
+                                                           Weight weight)
+{
+    const qint32 iRows = vecSensorColumns.size();
+
+    // distribute calculation on cores
+    int iCores = UTILSLIB::ExecutionConfig::threadCount();
+    if (iCores <= 0) {
+        // assume that we have at least two available cores
+        iCores = 2;
+    }
+
+    const qint32 iSubArraySize = qMax(1, (iRows + iCores - 1) / iCores);
+    QVector<QFuture<RowBlock> > vecThreads;
+
+    for (qint32 iBegin = iSubArraySize; iBegin < iRows; iBegin += iSubArraySize) {
+        vecThreads.append(QtConcurrent::run(std::bind(computeRows<DistanceTable, Weight>,
+                                                      std::cref(matDistanceTable),
+                                                      std::cref(vecSensorColumns),
+                                                      iCols,
+                                                      dCancelDist,
+                                                      weight,
+                                                      iBegin,
+                                                      qMin(iBegin + iSubArraySize, iRows))));
+    }
+
+    // use main thread to calculate the first block
+    QVector<RowBlock> vecBlocks;
+    vecBlocks.append(computeRows(matDistanceTable, vecSensorColumns, iCols, dCancelDist, weight, 0, qMin(iSubArraySize, iRows)));
+
+    for (QFuture<RowBlock>& f : vecThreads) {
+        vecBlocks.append(f.result());
+    }
+
+    // the blocks are ordered by row and each row by column, so they can be copied into a compressed row matrix as they are
+    int iNonZeros = 0;
+    for (const RowBlock& block : vecBlocks) {
+        iNonZeros += block.vecValues.size();
+    }
+
+    SparseMatrix<float, RowMajor> matInterpolationMatrix(iRows, iCols);
+    matInterpolationMatrix.resizeNonZeros(iNonZeros);
+
+    int* pOuterIndex = matInterpolationMatrix.outerIndexPtr();
+    int* pInnerIndex = matInterpolationMatrix.innerIndexPtr();
+    float* pValues = matInterpolationMatrix.valuePtr();
+
+    qint32 r = 0;
+    pOuterIndex[0] = 0;
+
+    for (const RowBlock& block : vecBlocks) {
+        std::copy(block.vecCols.constBegin(), block.vecCols.constEnd(), pInnerIndex + pOuterIndex[r]);
+        std::copy(block.vecValues.constBegin(), block.vecValues.constEnd(), pValues + pOuterIndex[r]);
+
+        for (const int iRowNonZeros : block.vecRowNonZeros) {
+            pOuterIndex[r + 1] = pOuterIndex[r] + iRowNonZeros;
+            ++r;
+        }
+    }
+
+    return QSharedPointer<SparseMatrix<float> >::create(matInterpolationMatrix);
+}
+
+template<typename DistanceTable>
+QSharedPointer<SparseMatrix<float> > buildInterpolationMat(const DistanceTable& matDistanceTable,
+                                                           const QVector<qint32>& vecSensorColumns,
+                                                           qint32 iCols,
+                                                           double dCancelDist,
+                                                           double (*interpolationFunction) (double))
+{
+    if (interpolationFunction == &Interpolation::linear) {
+        return buildInterpolationMat(matDistanceTable, vecSensorColumns, iCols, dCancelDist, LinearWeight());
+    } else if (interpolationFunction == &Interpolation::gaussian) {
+        return buildInterpolationMat(matDistanceTable, vecSensorColumns, iCols, dCancelDist, GaussianWeight());
+    } else if (interpolationFunction == &Interpolation::square) {
+        return buildInterpolationMat(matDistanceTable, vecSensorColumns, iCols, dCancelDist, SquareWeight());
+    } else if (interpolationFunction == &Interpolation::cubic) {
+        return buildInterpolationMat(matDistanceTable, vecSensorColumns, iCols, dCancelDist, CubicWeight());
+    }
+
+    return buildInterpolationMat(matDistanceTable, vecSensorColumns, iCols, dCancelDist, FunctionWeight{interpolationFunction});
+}
+
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -94,59 +302,35 @@ QSharedPointer<SparseMatrix<float> > Interpolation::createInterpolationMat(const
         return QSharedPointer<SparseMatrix<float> >::create();
     }
 
-    // initialization
-    QSharedPointer<Eigen::SparseMatrix<float> > matInterpolationMatrix = QSharedPointer<SparseMatrix<float> >::create(matDistanceTable->rows(), vecProjectedSensors.size());
-
-    // temporary helper structure for filling sparse matrix
-    QVector<Triplet<float> > vecNonZeroEntries;
-    const qint32 iRows = matInterpolationMatrix->rows();
-    const qint32 iCols = matInterpolationMatrix->cols();
-
-    // insert all sensor nodes into set for faster lookup during later computation. Also consider bad channels here.
-    QSet<qint32> sensorLookup;
-    int idx = 0;
-
-    for(const qint32& s : vecProjectedSensors){
-        if(!vecExcludeIndex.contains(idx)){
-            sensorLookup.insert(s);
-        }
-        idx++;
-    }
+    return buildInterpolationMat(*matDistanceTable,
+                                 createSensorColumns(vecProjectedSensors, vecExcludeIndex, matDistanceTable->rows()),
+                                 vecProjectedSensors.size(),
+                                 dCancelDist,
+                                 interpolationFunction);
+}
 
-    // main loop: go through all rows of distance table and calculate weights
-    for (qint32 r = 0; r < iRows; ++r) {
-        if (sensorLookup.contains(r) == false) {
-            // "normal" node, i.e. one which was not assigned a sensor
-            // bLoThreshold: stores the indizes that point to distances which are below the passed distance threshold (dCancelDist)
-            QVector<QPair<qint32, float> > vecBelowThresh;
-            float dWeightsSum = 0.0;
-            const RowVectorXd& rowVec = matDistanceTable->row(r);
-
-            for (qint32 c = 0; c < iCols; ++c) {
-                const float dDist = rowVec[c];
-
-                if (dDist < dCancelDist) {
-                    const float dValueWeight = std::fabs(1.0 / interpolationFunction(dDist));
-                    dWeightsSum += dValueWeight;
-                    vecBelowThresh.push_back(qMakePair<qint32, float> (c, dValueWeight));
-                }
-            }
 
-            for (const QPair<qint32, float> &qp : vecBelowThresh) {
-                vecNonZeroEntries.push_back(Eigen::Triplet<float> (r, qp.first, qp.second / dWeightsSum));
-            }
-        } else {
-            // a sensor has been assigned to this node, we do not need to interpolate anything
-            //(final vertex signal is equal to sensor input signal, thus factor 1)
-            const int iIndexInSubset = vecProjectedSensors.indexOf(r);
+//*************************************************************************************************************
 
-            vecNonZeroEntries.push_back(Eigen::Triplet<float> (r, iIndexInSubset, 1));
-        }
+QSharedPointer<SparseMatrix<float> > Interpolation::createInterpolationMat(const QVector<qint32> &vecProjectedSensors,
+                                                                           const QSharedPointer<SparseMatrix<float> > matDistanceTable,
+                                                                           double (*interpolationFunction) (double),
+                                                                           const double dCancelDist,
+                                                                           const QVector<qint32> &vecExcludeIndex)
+{
+    if(matDistanceTable->rows() == 0 && matDistanceTable->cols() == 0) {
+        qDebug() << "[WARNING] Interpolation::createInterpolationMat - received an empty distance table.";
+        return QSharedPointer<SparseMatrix<float> >::create();
     }
 
-    matInterpolationMatrix->setFromTriplets(vecNonZeroEntries.begin(), vecNonZeroEntries.end());
+    // the weights are normalized per vertex, so visit the distance table row by row
+    const SparseMatrix<float, RowMajor> matRowDistances = *matDistanceTable;
 
-    return matInterpolationMatrix;
+    return buildInterpolationMat(matRowDistances,
+                                 createSensorColumns(vecProjectedSensors, vecExcludeIndex, matDistanceTable->rows()),
+                                 vecProjectedSensors.size(),
+                                 dCancelDist,
+                                 interpolationFunction);
 }
 
 
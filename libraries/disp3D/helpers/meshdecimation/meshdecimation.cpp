@@ -0,0 +1,238 @@
+//=============================================================================================================
+/**
+* @file     meshdecimation.cpp
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     MeshDecimation class definition.
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "meshdecimation.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QHash>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+DecimatedMesh MeshDecimation::clusterVertices(const MatrixX3f &matVertices,
+                                              const MatrixXi &matTris,
+                                              double dCellSize)
+{
+    DecimatedMesh decimatedMesh;
+    const int iNumVert = matVertices.rows();
+
+    if(iNumVert == 0 || dCellSize <= 0.0) {
+        qDebug() << "MeshDecimation::clusterVertices - Empty mesh or invalid cell size" << dCellSize << ". Returning the mesh unchanged.";
+        decimatedMesh.vecVertexIds = VectorXi::LinSpaced(iNumVert, 0, iNumVert - 1);
+        decimatedMesh.vecVertexMap = decimatedMesh.vecVertexIds;
+        decimatedMesh.matTris = matTris;
+        return decimatedMesh;
+    }
+
+    //Assign each vertex to a cell of a regular grid spanning the bounding box
+    const Vector3d vecMin = matVertices.colwise().minCoeff().transpose().cast<double>();
+    const Vector3d vecExtent = matVertices.colwise().maxCoeff().transpose().cast<double>() - vecMin;
+    const qint64 iNumCellsX = (qint64)std::floor(vecExtent(0) / dCellSize) + 1;
+    const qint64 iNumCellsY = (qint64)std::floor(vecExtent(1) / dCellSize) + 1;
+
+    QHash<qint64, int> hashCellToCluster;
+    hashCellToCluster.reserve(iNumVert);
+    std::vector<Vector3d> vecCentroids;
+    std::vector<int> vecCounts;
+
+    decimatedMesh.vecVertexMap.resize(iNumVert);
+
+    for(int i = 0; i < iNumVert; ++i) {
+        Vector3d vecCell = ((matVertices.row(i).transpose().cast<double>() - vecMin) / dCellSize).array().floor();
+        qint64 iKey = (qint64)vecCell(0) + iNumCellsX * ((qint64)vecCell(1) + iNumCellsY * (qint64)vecCell(2));
+
+        QHash<qint64, int>::const_iterator itCluster = hashCellToCluster.constFind(iKey);
+        int iCluster;
+
+        if(itCluster == hashCellToCluster.constEnd()) {
+            iCluster = (int)vecCentroids.size();
+            hashCellToCluster.insert(iKey, iCluster);
+            vecCentroids.push_back(Vector3d::Zero());
+            vecCounts.push_back(0);
+        } else {
+            iCluster = itCluster.value();
+        }
+
+        vecCentroids[iCluster] += matVertices.row(i).transpose().cast<double>();
+        vecCounts[iCluster]++;
+        decimatedMesh.vecVertexMap(i) = iCluster;
+    }
+
+    //Represent each cluster by the original vertex closest to its centroid, so that it stays on the surface
+    const int iNumClusters = (int)vecCentroids.size();
+    std::vector<double> vecBestDist(iNumClusters, std::numeric_limits<double>::max());
+    decimatedMesh.vecVertexIds.resize(iNumClusters);
+
+    for(int i = 0; i < iNumClusters; ++i) {
+        vecCentroids[i] /= (double)vecCounts[i];
+    }
+
+    for(int i = 0; i < iNumVert; ++i) {
+        int iCluster = decimatedMesh.vecVertexMap(i);
+        double dDist = (matVertices.row(i).transpose().cast<double>() - vecCentroids[iCluster]).squaredNorm();
+
+        if(dDist < vecBestDist[iCluster]) {
+            vecBestDist[iCluster] = dDist;
+            decimatedMesh.vecVertexIds(iCluster) = i;
+        }
+    }
+
+    //Remap the triangles and drop the ones which collapsed to an edge or a point
+    MatrixXi matTrisDecimated(matTris.rows(), matTris.cols());
+    int iNumTris = 0;
+
+    for(int i = 0; i < matTris.rows(); ++i) {
+        bool bDegenerated = false;
+
+        for(int j = 0; j < matTris.cols(); ++j) {
+            matTrisDecimated(iNumTris, j) = decimatedMesh.vecVertexMap(matTris(i,j));
+
+            for(int k = 0; k < j; ++k) {
+                if(matTrisDecimated(iNumTris, k) == matTrisDecimated(iNumTris, j)) {
+                    bDegenerated = true;
+                }
+            }
+        }
+
+        if(!bDegenerated) {
+            iNumTris++;
+        }
+    }
+
+    decimatedMesh.matTris = matTrisDecimated.topRows(iNumTris);
+
+    return decimatedMesh;
+}
+
+
+//*************************************************************************************************************
+
+QVector<DecimatedMesh> MeshDecimation::createLevelsOfDetail(const MatrixX3f &matVertices,
+                                                            const MatrixXi &matTris,
+                                                            int iNumLevels)
+{
+    QVector<DecimatedMesh> vecLevels;
+
+    double dCellSize = 2.0 * meanEdgeLength(matVertices, matTris);
+    if(dCellSize <= 0.0) {
+        return vecLevels;
+    }
+
+    int iNumVertPrevious = matVertices.rows();
+
+    //Always cluster the original mesh, so that every level maps directly onto the original vertices
+    for(int i = 0; i < iNumLevels; ++i) {
+        DecimatedMesh decimatedMesh = clusterVertices(matVertices, matTris, dCellSize);
+
+        if(decimatedMesh.vecVertexIds.rows() >= iNumVertPrevious || decimatedMesh.matTris.rows() == 0) {
+            break;
+        }
+
+        iNumVertPrevious = decimatedMesh.vecVertexIds.rows();
+        vecLevels.append(decimatedMesh);
+        dCellSize *= 2.0;
+    }
+
+    return vecLevels;
+}
+
+
+//*************************************************************************************************************
+
+double MeshDecimation::meanEdgeLength(const MatrixX3f &matVertices,
+                                      const MatrixXi &matTris)
+{
+    if(matTris.rows() == 0 || matTris.cols() < 2) {
+        return 0.0;
+    }
+
+    double dSum = 0.0;
+
+    for(int i = 0; i < matTris.rows(); ++i) {
+        for(int j = 0; j < matTris.cols(); ++j) {
+            int iNext = (j + 1) % matTris.cols();
+            dSum += (matVertices.row(matTris(i,j)) - matVertices.row(matTris(i,iNext))).norm();
+        }
+    }
+
+    return dSum / (double)(matTris.rows() * matTris.cols());
+}
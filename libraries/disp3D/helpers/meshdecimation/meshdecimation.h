@@ -0,0 +1,170 @@
+//=============================================================================================================
+/**
+* @file     meshdecimation.h
+* @author   Lorenz Esch <Lorenz.Esch@tu-ilmenau.de>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Lorenz Esch and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     MeshDecimation class declaration.
+*
+*/
+
+
+#ifndef DISP3DLIB_MESHDECIMATION_H
+#define DISP3DLIB_MESHDECIMATION_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../../disp3D_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE DISP3DLIB
+//=============================================================================================================
+
+namespace DISP3DLIB {
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DISP3DLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+
+//=============================================================================================================
+/**
+* One decimated version of a mesh. The decimated vertices are a subset of the original vertices, so that
+* per-vertex data (colors, normals, activation) can be remapped by picking rows with vecVertexIds.
+*/
+struct DecimatedMesh {
+    Eigen::VectorXi vecVertexIds;       /**< Original vertex index for each decimated vertex. */
+    Eigen::VectorXi vecVertexMap;       /**< Decimated vertex index for each original vertex. */
+    Eigen::MatrixXi matTris;            /**< The triangles, indexing the decimated vertices. */
+};
+
+
+//=============================================================================================================
+/**
+* This class reduces triangle meshes by vertex clustering. All vertices falling into the same cell of a regular
+* grid are merged into the vertex closest to their centroid, and triangles which collapse are dropped.
+* It is used to generate levels of detail for large surfaces such as FreeSurfer or BEM meshes.
+*
+* @brief This class holds static methods for mesh decimation
+*/
+class DISP3DSHARED_EXPORT MeshDecimation
+{
+
+public:
+    typedef QSharedPointer<MeshDecimation> SPtr;            /**< Shared pointer type for MeshDecimation. */
+    typedef QSharedPointer<const MeshDecimation> ConstSPtr; /**< Const shared pointer type for MeshDecimation. */
+
+    //=========================================================================================================
+    /**
+    * deleted default constructor (static class).
+    */
+    MeshDecimation() = delete;
+
+    //=========================================================================================================
+    /**
+    * @brief clusterVertices                Decimates a mesh by merging all vertices inside the same grid cell.
+    *
+    * @param[in] matVertices                The vertices of the mesh.
+    * @param[in] matTris                    The triangles of the mesh.
+    * @param[in] dCellSize                  The edge length of a grid cell.
+    *
+    * @return                               The decimated mesh.
+    */
+    static DecimatedMesh clusterVertices(const Eigen::MatrixX3f &matVertices,
+                                         const Eigen::MatrixXi &matTris,
+                                         double dCellSize);
+
+    //=========================================================================================================
+    /**
+    * @brief createLevelsOfDetail           Creates a series of increasingly coarse meshes. The grid cell size
+    *                                       doubles from level to level, starting at twice the mean edge length.
+    *                                       Levels which would not reduce the vertex count any further are omitted.
+    *
+    * @param[in] matVertices                The vertices of the mesh.
+    * @param[in] matTris                    The triangles of the mesh.
+    * @param[in] iNumLevels                 The maximum number of decimated levels to create.
+    *
+    * @return                               The decimated levels, from fine to coarse.
+    */
+    static QVector<DecimatedMesh> createLevelsOfDetail(const Eigen::MatrixX3f &matVertices,
+                                                       const Eigen::MatrixXi &matTris,
+                                                       int iNumLevels = 3);
+
+    //=========================================================================================================
+    /**
+    * @brief meanEdgeLength                 Calculates the mean edge length of a triangle mesh.
+    *
+    * @param[in] matVertices                The vertices of the mesh.
+    * @param[in] matTris                    The triangles of the mesh.
+    *
+    * @return                               The mean edge length over all triangle edges.
+    */
+    static double meanEdgeLength(const Eigen::MatrixX3f &matVertices,
+                                 const Eigen::MatrixXi &matTris);
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+
+} // namespace DISP3DLIB
+
+#endif // DISP3DLIB_MESHDECIMATION_H
@@ -360,6 +360,30 @@ static int get_fval_20(FILE *in, float *fval)
 }
 
 
+/*
+ * Transform points in place. The points are rows of three interleaved floats, strided vector loads of them are
+ * slower than a scalar loop, which keeps the rotation and the translation in registers for all points.
+ */
+static void transform_points(const Matrix3f& rot, const Vector3f& move, float **r, int np, int do_move)
+{
+    const float r00 = rot(0,0), r01 = rot(0,1), r02 = rot(0,2);
+    const float r10 = rot(1,0), r11 = rot(1,1), r12 = rot(1,2);
+    const float r20 = rot(2,0), r21 = rot(2,1), r22 = rot(2,2);
+    const float mx = do_move ? move[0] : 0.0f;
+    const float my = do_move ? move[1] : 0.0f;
+    const float mz = do_move ? move[2] : 0.0f;
+
+    for (int k = 0; k < np; k++) {
+        float *p = r[k];
+        const float x = p[0], y = p[1], z = p[2];
+
+        p[0] = r00*x + r01*y + r02*z + mx;
+        p[1] = r10*x + r11*y + r12*z + my;
+        p[2] = r20*x + r21*y + r22*z + mz;
+    }
+}
+
+
 
 
 //*************************************************************************************************************
@@ -593,6 +617,22 @@ void FiffCoordTransOld::fiff_coord_trans_inv(float r[], FiffCoordTransOld *t, in
 }
 
 
+//*************************************************************************************************************
+
+void FiffCoordTransOld::fiff_coord_trans_points(float **r, int np, const FiffCoordTransOld *t, int do_move)
+{
+    transform_points(t->rot, t->move, r, np, do_move);
+}
+
+
+//*************************************************************************************************************
+
+void FiffCoordTransOld::fiff_coord_trans_inv_points(float **r, int np, const FiffCoordTransOld *t, int do_move)
+{
+    transform_points(t->invrot, t->invmove, r, np, do_move);
+}
+
+
 //*************************************************************************************************************
 
 typedef struct {
@@ -153,6 +153,29 @@ public:
 
     static void fiff_coord_trans_inv (float r[3],FiffCoordTransOld* t,int do_move);
 
+    //=========================================================================================================
+    /**
+    * Applies the coordinate transformation to np points in place. The transformation is loaded once for all
+    * points instead of once per point as with fiff_coord_trans.
+    *
+    * @param[in, out] r     The points
+    * @param[in] np         Number of points
+    * @param[in] t          The transformation
+    * @param[in] do_move    Perform translation next to rotation yes/no
+    */
+    static void fiff_coord_trans_points (float **r, int np, const FiffCoordTransOld* t, int do_move);
+
+    //=========================================================================================================
+    /**
+    * Applies the inverse coordinate transformation to np points in place, see fiff_coord_trans_points.
+    *
+    * @param[in, out] r     The points
+    * @param[in] np         Number of points
+    * @param[in] t          The transformation
+    * @param[in] do_move    Perform translation next to rotation yes/no
+    */
+    static void fiff_coord_trans_inv_points (float **r, int np, const FiffCoordTransOld* t, int do_move);
+
 
     //============================= mne_coord_transforms.c =============================
 
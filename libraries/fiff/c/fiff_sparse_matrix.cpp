@@ -444,3 +444,90 @@ out : {
         return res;
     }
 }
+
+
+//*************************************************************************************************************
+
+static const int s_iNoPtrs = 0;     /**< Outer index of the empty views. */
+
+FiffSparseMatrix::ConstRcsMap FiffSparseMatrix::eigen_rcs() const
+{
+    if(coding != FIFFTS_MC_RCS || !data)
+        return ConstRcsMap(0, 0, 0, &s_iNoPtrs, Q_NULLPTR, Q_NULLPTR);
+
+    return ConstRcsMap(m, n, nz, ptrs, inds, data);
+}
+
+
+//*************************************************************************************************************
+
+FiffSparseMatrix::ConstCcsMap FiffSparseMatrix::eigen_ccs() const
+{
+    if(coding != FIFFTS_MC_CCS || !data)
+        return ConstCcsMap(0, 0, 0, &s_iNoPtrs, Q_NULLPTR, Q_NULLPTR);
+
+    return ConstCcsMap(m, n, nz, ptrs, inds, data);
+}
+
+
+//*************************************************************************************************************
+
+SparseMatrix<double> FiffSparseMatrix::toEigenSparse() const
+{
+    if(coding == FIFFTS_MC_RCS)
+        return eigen_rcs().cast<double>();
+    else if(coding == FIFFTS_MC_CCS)
+        return eigen_ccs().cast<double>();
+
+    return SparseMatrix<double>();
+}
+
+
+//*************************************************************************************************************
+
+int FiffSparseMatrix::mult_mat(float **mult, int ncol, float **res) const
+{
+    int i,j;
+
+    if (coding == FIFFTS_MC_RCS) {
+        //
+        //   Each result row is a combination of the rows of mult picked by the nonzeros
+        //
+        for (i = 0; i < m; i++) {
+            Map<RowVectorXf> t_res(res[i],ncol);
+            t_res.setZero();
+            for (j = ptrs[i]; j < ptrs[i+1]; j++)
+                t_res += data[j]*Map<const RowVectorXf>(mult[inds[j]],ncol);
+        }
+    }
+    else if (coding == FIFFTS_MC_CCS) {
+        for (i = 0; i < m; i++)
+            Map<RowVectorXf>(res[i],ncol).setZero();
+        for (i = 0; i < n; i++) {
+            Map<const RowVectorXf> t_mult(mult[i],ncol);
+            for (j = ptrs[i]; j < ptrs[i+1]; j++)
+                Map<RowVectorXf>(res[inds[j]],ncol) += data[j]*t_mult;
+        }
+    }
+    else {
+        printf("mne_sparse_mat_mult2: unknown sparse matrix storage type: %d",coding);
+        return -1;
+    }
+    return 0;
+}
+
+
+//*************************************************************************************************************
+
+int FiffSparseMatrix::mult_vec(const float *vector, float *res) const
+{
+    if (coding == FIFFTS_MC_RCS)
+        Map<VectorXf>(res,m).noalias() = eigen_rcs()*Map<const VectorXf>(vector,n);
+    else if (coding == FIFFTS_MC_CCS)
+        Map<VectorXf>(res,m).noalias() = eigen_ccs()*Map<const VectorXf>(vector,n);
+    else {
+        printf("mne_sparse_vec_mult2: unknown sparse matrix storage type: %d",coding);
+        return -1;
+    }
+    return 0;
+}
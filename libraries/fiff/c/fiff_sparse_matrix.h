@@ -52,6 +52,7 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 
 //*************************************************************************************************************
@@ -84,6 +85,9 @@ public:
     typedef QSharedPointer<FiffSparseMatrix> SPtr;              /**< Shared pointer type for FiffSparseMatrix. */
     typedef QSharedPointer<const FiffSparseMatrix> ConstSPtr;   /**< Const shared pointer type for FiffSparseMatrix. */
 
+    typedef Eigen::Map<const Eigen::SparseMatrix<float, Eigen::RowMajor, int> > ConstRcsMap;   /**< View of a matrix in RCS coding. */
+    typedef Eigen::Map<const Eigen::SparseMatrix<float, Eigen::ColMajor, int> > ConstCcsMap;   /**< View of a matrix in CCS coding. */
+
     //=========================================================================================================
     /**
     * Constructs the FiffSparseMatrix
@@ -131,6 +135,58 @@ public:
 
     FIFFLIB::FiffSparseMatrix* mne_add_upper_triangle_rcs();
 
+    //=========================================================================================================
+    /**
+    * Returns an Eigen view of a matrix in RCS coding which shares the data, inds and ptrs arrays.
+    * The view is valid as long as this matrix is.
+    *
+    * @return the view, an empty view if the matrix is not in RCS coding
+    */
+    ConstRcsMap eigen_rcs() const;
+
+    //=========================================================================================================
+    /**
+    * Returns an Eigen view of a matrix in CCS coding which shares the data, inds and ptrs arrays.
+    * The view is valid as long as this matrix is.
+    *
+    * @return the view, an empty view if the matrix is not in CCS coding
+    */
+    ConstCcsMap eigen_ccs() const;
+
+    //=========================================================================================================
+    /**
+    * Converts the matrix to an Eigen sparse matrix in one pass over the compressed arrays.
+    *
+    * @return the matrix, empty if the coding is unknown
+    */
+    Eigen::SparseMatrix<double> toEigenSparse() const;
+
+    //=========================================================================================================
+    /**
+    * Multiplies a dense matrix by this matrix. The rows of the dense matrices are accessed
+    * through their row pointers and processed as contiguous vectors.
+    * Refactored: mne_sparse_mat_mult2 (mne_sparse_matop.c)
+    *
+    * @param[in] mult       Matrix to be multiplied (n x ncol)
+    * @param[in] ncol       How many columns in the above
+    * @param[out] res       Result of the multiplication (m x ncol)
+    *
+    * @return 0 if succeeded, -1 if the coding is unknown
+    */
+    int mult_mat(float **mult, int ncol, float **res) const;
+
+    //=========================================================================================================
+    /**
+    * Multiplies a vector by this matrix.
+    * Refactored: mne_sparse_vec_mult2 (mne_sparse_matop.c)
+    *
+    * @param[in] vector     Vector to be multiplied (n)
+    * @param[out] res       Result of the multiplication (m)
+    *
+    * @return 0 if succeeded, -1 if the coding is unknown
+    */
+    int mult_vec(const float *vector, float *res) const;
+
 
 
 
@@ -38,7 +38,7 @@ include(../../mne-cpp.pri)
 
 TEMPLATE = lib
 
-QT += network
+QT += network concurrent
 QT -= gui
 
 DEFINES += FIFF_LIBRARY
@@ -89,6 +89,12 @@ SOURCES += fiff.cpp \
     fiff_io.cpp \
     fiff_dig_point_set.cpp \
     fiff_dir_node.cpp \
+    fiff_async_writer.cpp \
+    fiff_raw_kernels.cpp \
+    fiff_raw_compression.cpp \
+    fiff_raw_prefetcher.cpp \
+    fiff_raw_splitter.cpp \
+    fiff_event_scanner.cpp \
     c/fiff_coord_trans_old.cpp \
     c/fiff_sparse_matrix.cpp \
     c/fiff_digitizer_data.cpp \
@@ -121,6 +127,12 @@ HEADERS += fiff.h \
     fiff_io.h \
     fiff_dig_point_set.h \
     fiff_dir_node.h \
+    fiff_async_writer.h \
+    fiff_raw_kernels.h \
+    fiff_raw_compression.h \
+    fiff_raw_prefetcher.h \
+    fiff_raw_splitter.h \
+    fiff_event_scanner.h \
     c/fiff_coord_trans_old.h \
     c/fiff_sparse_matrix.h \
     c/fiff_types_mne-c.h \
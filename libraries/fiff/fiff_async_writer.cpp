@@ -0,0 +1,291 @@
+//=============================================================================================================
+/**
+* @file     fiff_async_writer.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FiffAsyncWriter Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_async_writer.h"
+#include "fiff_stream.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffAsyncWriter::FiffAsyncWriter(FiffStream* p_pStream, qint32 p_iQueueSize, bool p_bDropWhenFull)
+: m_pStream(p_pStream)
+, m_vecSlots(qMax(1, p_iQueueSize))
+, m_iHead(0)
+, m_iCount(0)
+, m_bDropWhenFull(p_bDropWhenFull)
+, m_bStop(false)
+, m_iSkip(0)
+{
+    m_stats.queued = 0;
+    m_stats.written = 0;
+    m_stats.dropped = 0;
+    m_stats.waits = 0;
+    m_stats.maxFill = 0;
+
+    start();
+}
+
+
+//*************************************************************************************************************
+
+FiffAsyncWriter::~FiffAsyncWriter()
+{
+    stop();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffAsyncWriter::enqueue(const MatrixXd& buf, const RowVectorXd& cals)
+{
+    if (buf.rows() != cals.cols()) {
+        printf("buffer and calibration sizes do not match\n");
+        return false;
+    }
+
+    Slot* pSlot = acquire();
+    if(!pSlot)
+        return false;
+
+    pSlot->buf = buf;
+    pSlot->cals = cals;
+    pSlot->mode = ScaleCals;
+    commit();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffAsyncWriter::enqueue(const MatrixXd& buf, const SparseMatrix<double>& mult)
+{
+    if (buf.rows() != mult.cols()) {
+        printf("buffer and mult sizes do not match\n");
+        return false;
+    }
+
+    Slot* pSlot = acquire();
+    if(!pSlot)
+        return false;
+
+    pSlot->buf = buf;
+    pSlot->mult = mult;
+    pSlot->mode = ScaleMult;
+    commit();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffAsyncWriter::enqueue(const MatrixXd& buf)
+{
+    Slot* pSlot = acquire();
+    if(!pSlot)
+        return false;
+
+    pSlot->buf = buf;
+    pSlot->mode = ScaleNone;
+    commit();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffAsyncWriter::flush()
+{
+    QMutexLocker locker(&m_mutex);
+    while(m_iCount > 0 && isRunning())
+        m_condNotFull.wait(&m_mutex);
+}
+
+
+//*************************************************************************************************************
+
+void FiffAsyncWriter::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bStop = true;
+        m_condNotEmpty.wakeAll();
+    }
+
+    wait();
+}
+
+
+//*************************************************************************************************************
+
+FiffAsyncWriterStats FiffAsyncWriter::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+
+//*************************************************************************************************************
+
+void FiffAsyncWriter::run()
+{
+    forever {
+        Slot* pSlot = Q_NULLPTR;
+        {
+            QMutexLocker locker(&m_mutex);
+            while(m_iCount == 0 && !m_bStop)
+                m_condNotEmpty.wait(&m_mutex);
+
+            //
+            //   Pending buffers are written before the thread ends, as well as the drops after the last one
+            //
+            if(m_iCount == 0) {
+                fiff_int_t skip = m_iSkip;
+                m_iSkip = 0;
+                locker.unlock();
+
+                if(skip > 0)
+                    m_pStream->write_int(FIFF_DATA_SKIP, &skip);
+                return;
+            }
+
+            pSlot = &m_vecSlots[m_iHead];
+        }
+
+        //
+        //   The slot is owned by this thread until it is released below
+        //
+        if(pSlot->skip > 0)
+            m_pStream->write_int(FIFF_DATA_SKIP, &pSlot->skip);
+
+        switch(pSlot->mode) {
+            case ScaleCals:
+                m_matOut = (pSlot->cals.transpose().cwiseInverse().asDiagonal()*pSlot->buf).cast<float>();
+                break;
+            case ScaleMult: {
+                SparseMatrix<double> inv_mult(pSlot->mult.rows(), pSlot->mult.cols());
+                for (int k=0; k<inv_mult.outerSize(); ++k)
+                    for (SparseMatrix<double>::InnerIterator it(pSlot->mult,k); it; ++it)
+                        inv_mult.coeffRef(it.row(),it.col()) = 1/it.value();
+                m_matOut = (inv_mult*pSlot->buf).cast<float>();
+                break;
+            }
+            default:
+                m_matOut = pSlot->buf.cast<float>();
+                break;
+        }
+
+        m_pStream->write_float_buffer(m_matOut);
+
+        {
+            QMutexLocker locker(&m_mutex);
+            m_iHead = (m_iHead + 1) % m_vecSlots.size();
+            --m_iCount;
+            ++m_stats.written;
+            m_condNotFull.wakeAll();
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+FiffAsyncWriter::Slot* FiffAsyncWriter::acquire()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if(m_iCount == m_vecSlots.size()) {
+        if(m_bDropWhenFull) {
+            ++m_stats.dropped;
+            ++m_iSkip;
+            return Q_NULLPTR;
+        }
+
+        ++m_stats.waits;
+        while(m_iCount == m_vecSlots.size())
+            m_condNotFull.wait(&m_mutex);
+    }
+
+    //
+    //   Only the producer appends, so the tail slot stays free until commit
+    //
+    return &m_vecSlots[(m_iHead + m_iCount) % m_vecSlots.size()];
+}
+
+
+//*************************************************************************************************************
+
+void FiffAsyncWriter::commit()
+{
+    QMutexLocker locker(&m_mutex);
+
+    //
+    //   The drops since the last queued buffer are written right before this one
+    //
+    m_vecSlots[(m_iHead + m_iCount) % m_vecSlots.size()].skip = m_iSkip;
+    m_iSkip = 0;
+
+    ++m_iCount;
+    ++m_stats.queued;
+    m_stats.maxFill = qMax(m_stats.maxFill, m_iCount);
+    m_condNotEmpty.wakeOne();
+}
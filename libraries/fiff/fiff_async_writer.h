@@ -0,0 +1,238 @@
+//=============================================================================================================
+/**
+* @file     fiff_async_writer.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffAsyncWriter class declaration.
+*
+*/
+
+#ifndef FIFF_ASYNC_WRITER_H
+#define FIFF_ASYNC_WRITER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FiffStream;
+
+
+//=============================================================================================================
+/**
+* Statistics of an asynchronous raw data writer.
+*
+* @brief Writer statistics
+*/
+struct FiffAsyncWriterStats {
+    qint64  queued;         /**< Number of buffers accepted into the queue. */
+    qint64  written;        /**< Number of buffers written to the device. */
+    qint64  dropped;        /**< Number of buffers dropped because the queue was full, each gap is marked by a FIFF_DATA_SKIP tag. */
+    qint64  waits;          /**< Number of times the producer had to wait for a free slot. */
+    qint32  maxFill;        /**< Highest number of buffers waiting in the queue. */
+};
+
+
+//=============================================================================================================
+/**
+* Writes raw data buffers of a FiffStream on a dedicated thread. The buffers are copied into a bounded queue
+* of pre-allocated slots, the calibration scaling, float conversion and the device write are done by the
+* writer thread. When the queue is full the producer either waits (back-pressure) or the buffer is dropped.
+* Dropped buffers are recorded in the file by a FIFF_DATA_SKIP tag, so the following buffers keep their time.
+*
+* @brief Asynchronous FIFF raw data writer
+*/
+class FIFFSHARED_EXPORT FiffAsyncWriter : public QThread
+{
+public:
+    typedef QSharedPointer<FiffAsyncWriter> SPtr;            /**< Shared pointer type for FiffAsyncWriter. */
+    typedef QSharedPointer<const FiffAsyncWriter> ConstSPtr; /**< Const shared pointer type for FiffAsyncWriter. */
+
+    //=========================================================================================================
+    /**
+    * Constructs the writer and starts the writer thread.
+    *
+    * @param[in] p_pStream          The stream to write to
+    * @param[in] p_iQueueSize       Number of buffers which can be queued
+    * @param[in] p_bDropWhenFull    Drop buffers when the queue is full instead of waiting for a free slot
+    */
+    FiffAsyncWriter(FiffStream* p_pStream, qint32 p_iQueueSize, bool p_bDropWhenFull);
+
+    //=========================================================================================================
+    /**
+    * Writes the pending buffers and stops the writer thread.
+    */
+    ~FiffAsyncWriter();
+
+    //=========================================================================================================
+    /**
+    * Queues a buffer which is divided by the calibration factors when written.
+    *
+    * @param[in] buf    the buffer to write
+    * @param[in] cals   calibration factors
+    *
+    * @return true if the buffer was queued, false if it was dropped
+    */
+    bool enqueue(const Eigen::MatrixXd& buf, const Eigen::RowVectorXd& cals);
+
+    //=========================================================================================================
+    /**
+    * Queues a buffer which is divided element wise by the multiplication matrix when written.
+    *
+    * @param[in] buf    the buffer to write
+    * @param[in] mult   multiplication matrix (compensator, projection, calibration)
+    *
+    * @return true if the buffer was queued, false if it was dropped
+    */
+    bool enqueue(const Eigen::MatrixXd& buf, const Eigen::SparseMatrix<double>& mult);
+
+    //=========================================================================================================
+    /**
+    * Queues a buffer which is written as it is.
+    *
+    * @param[in] buf    the buffer to write
+    *
+    * @return true if the buffer was queued, false if it was dropped
+    */
+    bool enqueue(const Eigen::MatrixXd& buf);
+
+    //=========================================================================================================
+    /**
+    * Blocks until all queued buffers are written.
+    */
+    void flush();
+
+    //=========================================================================================================
+    /**
+    * Writes the pending buffers and stops the writer thread.
+    */
+    void stop();
+
+    //=========================================================================================================
+    /**
+    * Returns the current statistics.
+    *
+    * @return the writer statistics
+    */
+    FiffAsyncWriterStats stats() const;
+
+protected:
+    //=========================================================================================================
+    /**
+    * The writer loop.
+    */
+    virtual void run();
+
+private:
+    enum ScaleMode {
+        ScaleNone,
+        ScaleCals,
+        ScaleMult
+    };
+
+    struct Slot {
+        Eigen::MatrixXd             buf;        /**< Copy of the buffer, keeps its storage between uses. */
+        Eigen::RowVectorXd          cals;       /**< Calibration factors for ScaleCals. */
+        Eigen::SparseMatrix<double> mult;       /**< Multiplication matrix for ScaleMult. */
+        ScaleMode                   mode;       /**< How to scale the buffer. */
+        fiff_int_t                  skip;       /**< Number of buffers dropped right before this one. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Waits for a free slot and returns it. The slot is committed to the queue with commit().
+    *
+    * @return the free slot, NULL if the buffer has to be dropped
+    */
+    Slot* acquire();
+
+    //=========================================================================================================
+    /**
+    * Hands the slot returned by acquire() to the writer thread.
+    */
+    void commit();
+
+    FiffStream*         m_pStream;          /**< The stream to write to. */
+    QVector<Slot>       m_vecSlots;         /**< The ring of pre-allocated slots. */
+    qint32              m_iHead;            /**< Next slot to write. */
+    qint32              m_iCount;           /**< Number of queued slots. */
+    bool                m_bDropWhenFull;    /**< Drop instead of waiting if the queue is full. */
+    bool                m_bStop;            /**< Stop request for the writer thread. */
+    fiff_int_t          m_iSkip;            /**< Number of buffers dropped since the last queued one. */
+
+    Eigen::MatrixXf     m_matOut;           /**< Scaled single precision buffer, reused by the writer thread. */
+
+    mutable QMutex      m_mutex;            /**< Guards the queue and the statistics. */
+    QWaitCondition      m_condNotEmpty;     /**< Signaled when a buffer was queued or stop was requested. */
+    QWaitCondition      m_condNotFull;      /**< Signaled when a slot became free. */
+
+    FiffAsyncWriterStats m_stats;           /**< The statistics. */
+};
+
+} // NAMESPACE
+
+#endif // FIFF_ASYNC_WRITER_H
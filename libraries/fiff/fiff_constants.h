@@ -366,6 +366,8 @@ namespace FIFFLIB
 #define FIFF_MNE_SOURCE_ORIENTATION     3521    /**< Fixed or free*/
 #define FIFF_MNE_INCLUDED_METHODS       3522
 #define FIFF_MNE_FORWARD_SOLUTION_GRAD  3523
+#define FIFF_MNE_FORWARD_PARTIAL_FIRST  3524    /**< First source of a partial forward solution*/
+#define FIFF_MNE_FORWARD_PARTIAL_LAST   3525    /**< Last source of a partial forward solution*/
     //
     // 3530... Covariance matrix
     //
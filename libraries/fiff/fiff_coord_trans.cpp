@@ -70,6 +70,42 @@ using namespace FIFFLIB;
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE STATIC HELPERS
+//=============================================================================================================
+
+/**
+* Transforms the rows of rr in place. The columns are processed in blocks which fit into the cache, each block
+* of the x and y column is saved before the new x, y and z are formed coefficient wise.
+*/
+static void transformColumns(const Matrix<float, 4,4, DontAlign>& t, MatrixX3f& rr, bool do_move)
+{
+    const int iBlock = 256;
+    const float mx = do_move ? t(0,3) : 0.0f;
+    const float my = do_move ? t(1,3) : 0.0f;
+    const float mz = do_move ? t(2,3) : 0.0f;
+
+    const int np = rr.rows();
+    float *px = rr.data();
+    float *py = px + np;
+    float *pz = py + np;
+
+    Array<float, Dynamic, 1, 0, iBlock, 1> x, y;
+
+    for(int i = 0; i < np; i += iBlock) {
+        const int n = std::min(iBlock, np - i);
+        Map<ArrayXf> cx(px + i, n), cy(py + i, n), cz(pz + i, n);
+
+        x = cx;
+        y = cy;
+        cx = t(0,0)*x + t(0,1)*y + t(0,2)*cz + mx;
+        cy = t(1,0)*x + t(1,1)*y + t(1,2)*cz + my;
+        cz = t(2,0)*x + t(2,1)*y + t(2,2)*cz + mz;
+    }
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -180,9 +216,9 @@ bool FiffCoordTrans::read(QIODevice& p_IODevice, FiffCoordTrans& p_Trans)
 
 MatrixX3f FiffCoordTrans::apply_trans(const MatrixX3f& rr, bool do_move) const
 {
-    MatrixX4f rr_ones = do_move ? MatrixX4f::Ones(rr.rows(),4) : MatrixX4f::Zero(rr.rows(),4);
-    rr_ones.block(0,0,rr.rows(),3) = rr;
-    return rr_ones*trans.block<3,4>(0,0).transpose();
+    MatrixX3f rr_trans = rr;
+    transformColumns(trans, rr_trans, do_move);
+    return rr_trans;
 }
 
 
@@ -190,9 +226,25 @@ MatrixX3f FiffCoordTrans::apply_trans(const MatrixX3f& rr, bool do_move) const
 
 MatrixX3f FiffCoordTrans::apply_inverse_trans(const MatrixX3f& rr, bool do_move) const
 {
-    MatrixX4f rr_ones = do_move ? MatrixX4f::Ones(rr.rows(),4) : MatrixX4f::Zero(rr.rows(),4);
-    rr_ones.block(0,0,rr.rows(),3) = rr;
-    return rr_ones*invtrans.block<3,4>(0,0).transpose();
+    MatrixX3f rr_trans = rr;
+    transformColumns(invtrans, rr_trans, do_move);
+    return rr_trans;
+}
+
+
+//*************************************************************************************************************
+
+void FiffCoordTrans::apply_trans_inplace(MatrixX3f& rr, bool do_move) const
+{
+    transformColumns(trans, rr, do_move);
+}
+
+
+//*************************************************************************************************************
+
+void FiffCoordTrans::apply_inverse_trans_inplace(MatrixX3f& rr, bool do_move) const
+{
+    transformColumns(invtrans, rr, do_move);
 }
 
 
@@ -185,6 +185,25 @@ public:
     */
     MatrixX3f apply_inverse_trans(const MatrixX3f& rr, bool do_move = true) const;
 
+    //=========================================================================================================
+    /**
+    * Applies the coordinate transform in place. The x, y and z columns of rr are contiguous arrays, they are
+    * transformed block wise with vectorized coefficient wise operations and without a homogeneous copy.
+    *
+    * @param[in, out] rr    The coordinates, replaced by the transformed coordinates
+    * @param[in] do_move    Perform translation next to rotation yes/no
+    */
+    void apply_trans_inplace(MatrixX3f& rr, bool do_move = true) const;
+
+    //=========================================================================================================
+    /**
+    * Applies the inverse coordinate transform in place, see apply_trans_inplace.
+    *
+    * @param[in, out] rr    The coordinates, replaced by the transformed coordinates
+    * @param[in] do_move    Perform translation next to rotation yes/no
+    */
+    void apply_inverse_trans_inplace(MatrixX3f& rr, bool do_move = true) const;
+
     //=========================================================================================================
     /**
     * ### MNE C root function ###: Definition of the mne_coord_frame_name function
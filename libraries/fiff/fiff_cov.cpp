@@ -42,8 +42,10 @@
 #include "fiff_stream.h"
 #include "fiff_info_base.h"
 #include "fiff_dir_node.h"
+#include "fiff_raw_data.h"
 
 #include <utils/mnemath.h>
+#include <utils/executionconfig.h>
 
 
 //*************************************************************************************************************
@@ -52,6 +54,9 @@
 //=============================================================================================================
 
 #include <QPair>
+#include <QVector>
+#include <QThread>
+#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -72,6 +77,38 @@ using namespace UTILSLIB;
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define COV_SEGMENTS_PER_THREAD 8   /**< Raw segments which are read for each thread before they are accumulated. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Sums of the accepted segments of one thread.
+*/
+struct CovAccumulator
+{
+    MatrixXd matXXt;        /**< Lower triangle of the sum of x*x'. */
+    MatrixXd matX2X2t;      /**< Lower triangle of the sum of (x.^2)*(x.^2)' of the scaled data, for Ledoit-Wolf only. */
+    qint64 iSamples;        /**< Number of accepted samples. */
+    qint32 iSegments;       /**< Number of accepted segments. */
+    qint32 iRejected;       /**< Number of rejected segments. */
+};
+
+} //NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -461,6 +498,231 @@ FiffCov FiffCov::regularize(const FiffInfo& p_info, double p_fRegMag, double p_f
 }
 
 
+//*************************************************************************************************************
+
+FiffCov FiffCov::compute_from_raw(FiffRawData& p_raw, const RowVectorXi& p_picks, float p_fTStep, const QMap<QString,double>& p_mapReject, Shrinkage p_shrinkage)
+{
+    FiffCov cov;
+    const FiffInfo& info = p_raw.info;
+
+    RowVectorXi picks = p_picks.size() > 0 ? p_picks : info.pick_types(true, true, false, defaultQStringList, info.bads);
+    qint32 nPicks = picks.size();
+    if(nPicks == 0)
+    {
+        printf("Error in FiffCov::compute_from_raw: No channels picked.\n");
+        return cov;
+    }
+
+    //
+    // The EOG channels are read for the rejection only
+    //
+    QList<qint32> t_qListSel;
+    for(qint32 i = 0; i < nPicks; ++i)
+        t_qListSel.append(picks[i]);
+    if(p_mapReject.value("eog", 0.0) > 0.0)
+        for(qint32 i = 0; i < info.chs.size(); ++i)
+            if(info.chs[i].kind == FIFFV_EOG_CH && !info.bads.contains(info.chs[i].ch_name) && !t_qListSel.contains(i))
+                t_qListSel.append(i);
+
+    qint32 nSel = t_qListSel.size();
+    RowVectorXi sel(nSel);
+    VectorXd vecLimit(nSel);
+    VectorXd vecScale(nPicks);
+    for(qint32 k = 0; k < nSel; ++k)
+    {
+        sel[k] = t_qListSel[k];
+
+        const FiffChInfo& ch = info.chs[sel[k]];
+        QString type;
+        double scale = 1.0;
+        if(ch.kind == FIFFV_MEG_CH && ch.unit == FIFF_UNIT_T_M) {
+            type = "grad";
+            scale = 1e13;
+        } else if(ch.kind == FIFFV_MEG_CH) {
+            type = "mag";
+            scale = 1e15;
+        } else if(ch.kind == FIFFV_EEG_CH) {
+            type = "eeg";
+            scale = 1e6;
+        } else if(ch.kind == FIFFV_EOG_CH) {
+            type = "eog";
+        }
+
+        vecLimit[k] = p_mapReject.value(type, 0.0);
+        if(k < nPicks)
+            vecScale[k] = scale;
+    }
+
+    qint32 iStep = qRound(p_fTStep * info.sfreq);
+    qint32 nSegments = iStep > 1 ? (p_raw.last_samp - p_raw.first_samp + 1) / iStep : 0;
+    if(nSegments == 0)
+    {
+        printf("Error in FiffCov::compute_from_raw: The raw data is shorter than one segment of %f s.\n", p_fTStep);
+        return cov;
+    }
+
+    bool bFourth = p_shrinkage == LedoitWolf;
+    qint32 nThreads = ExecutionConfig::threadCount();
+
+    QVector<CovAccumulator> vecAcc(nThreads);
+    for(qint32 t = 0; t < nThreads; ++t)
+    {
+        vecAcc[t].matXXt = MatrixXd::Zero(nPicks, nPicks);
+        if(bFourth)
+            vecAcc[t].matX2X2t = MatrixXd::Zero(nPicks, nPicks);
+        vecAcc[t].iSamples = 0;
+        vecAcc[t].iSegments = 0;
+        vecAcc[t].iRejected = 0;
+    }
+
+    CovAccumulator* pAcc = vecAcc.data();
+
+    QVector<MatrixXd> vecSegments(nThreads * COV_SEGMENTS_PER_THREAD);
+
+    //
+    // Each block of segments belongs to one thread and is added to its own sums
+    //
+    auto accumulateBlock = [&](const QPair<int,int>& block) {
+        CovAccumulator& acc = pAcc[block.first / COV_SEGMENTS_PER_THREAD];
+
+        for(int i = block.first; i < block.second; ++i)
+        {
+            const MatrixXd& seg = vecSegments.at(i);
+
+            bool bReject = false;
+            for(qint32 k = 0; k < nSel && !bReject; ++k)
+                bReject = vecLimit[k] > 0.0 && seg.row(k).maxCoeff() - seg.row(k).minCoeff() > vecLimit[k];
+
+            if(bReject)
+            {
+                ++acc.iRejected;
+                continue;
+            }
+
+            MatrixXd X = seg.topRows(nPicks);
+            X.colwise() -= X.rowwise().mean();
+
+            acc.matXXt.selfadjointView<Lower>().rankUpdate(X);
+            if(bFourth)
+            {
+                MatrixXd X2 = (vecScale.asDiagonal() * X).array().square().matrix();
+                acc.matX2X2t.selfadjointView<Lower>().rankUpdate(X2);
+            }
+
+            acc.iSamples += X.cols();
+            ++acc.iSegments;
+        }
+    };
+
+    MatrixXd times;
+    for(qint32 s = 0; s < nSegments; s += vecSegments.size())
+    {
+        qint32 nBatch = qMin(vecSegments.size(), nSegments - s);
+
+        for(qint32 i = 0; i < nBatch; ++i)
+        {
+            fiff_int_t from = p_raw.first_samp + (s + i) * iStep;
+            if(!p_raw.read_raw_segment(vecSegments[i], times, from, from + iStep - 1, sel))
+            {
+                printf("Error in FiffCov::compute_from_raw: Could not read samples %d to %d.\n", from, from + iStep - 1);
+                return cov;
+            }
+        }
+
+        QList<QPair<int,int> > blocks;
+        for(qint32 b = 0; b < nBatch; b += COV_SEGMENTS_PER_THREAD)
+            blocks.append(qMakePair(b, qMin(b + COV_SEGMENTS_PER_THREAD, nBatch)));
+
+        if(blocks.size() == 1)
+            accumulateBlock(blocks[0]);
+        else
+            QtConcurrent::blockingMap(blocks, accumulateBlock);
+    }
+
+    //
+    // Reduce in thread order
+    //
+    MatrixXd matXXt = MatrixXd::Zero(nPicks, nPicks);
+    MatrixXd matX2X2t;
+    if(bFourth)
+        matX2X2t = MatrixXd::Zero(nPicks, nPicks);
+    qint64 n = 0;
+    qint32 nAccepted = 0, nRejected = 0;
+    for(qint32 t = 0; t < nThreads; ++t)
+    {
+        matXXt += vecAcc[t].matXXt;
+        if(bFourth)
+            matX2X2t += vecAcc[t].matX2X2t;
+        n += vecAcc[t].iSamples;
+        nAccepted += vecAcc[t].iSegments;
+        nRejected += vecAcc[t].iRejected;
+    }
+
+    printf("\t%d of %d segments accepted, %d rejected.\n", nAccepted, nSegments, nRejected);
+
+    if(nAccepted == 0 || n - nAccepted < 1)
+    {
+        printf("Error in FiffCov::compute_from_raw: No segments left to compute the covariance.\n");
+        return cov;
+    }
+
+    qint64 nfree = n - nAccepted;
+    MatrixXd C = matXXt.selfadjointView<Lower>();
+    C /= (double)nfree;
+
+    //
+    // Shrink the scaled covariance towards mu*I
+    //
+    if(p_shrinkage != NoShrinkage)
+    {
+        double p = nPicks;
+        MatrixXd emp = vecScale.asDiagonal() * matXXt.selfadjointView<Lower>() * vecScale.asDiagonal();
+        emp /= (double)n;
+        double mu = emp.trace() / p;
+        double shrinkage = 0.0;
+
+        if(p_shrinkage == LedoitWolf)
+        {
+            double beta_ = MatrixXd(matX2X2t.selfadjointView<Lower>()).sum();
+            double delta_ = emp.squaredNorm();
+            double beta = (beta_ / n - delta_) / (p * n);
+            double delta = (delta_ - 2.0 * mu * emp.trace() + p * mu * mu) / p;
+            beta = qMin(beta, delta);
+            shrinkage = beta == 0.0 ? 0.0 : beta / delta;
+        }
+        else
+        {
+            double alpha = emp.squaredNorm() / (p * p);
+            double num = alpha + mu * mu;
+            double den = (n + 1.0) * (alpha - mu * mu / p);
+            shrinkage = den == 0.0 ? 1.0 : qMin(num / den, 1.0);
+        }
+
+        printf("\tShrinkage %f (%s).\n", shrinkage, p_shrinkage == LedoitWolf ? "Ledoit-Wolf" : "OAS");
+
+        MatrixXd Cs = vecScale.asDiagonal() * C * vecScale.asDiagonal();
+        double muC = Cs.trace() / p;
+        Cs *= 1.0 - shrinkage;
+        Cs.diagonal().array() += shrinkage * muC;
+
+        VectorXd vecInvScale = vecScale.cwiseInverse();
+        C = vecInvScale.asDiagonal() * Cs * vecInvScale.asDiagonal();
+    }
+
+    cov.kind = FIFFV_MNE_NOISE_COV;
+    cov.diag = false;
+    cov.dim = nPicks;
+    for(qint32 i = 0; i < nPicks; ++i)
+        cov.names << info.ch_names[picks[i]];
+    cov.data = C;
+    cov.projs = info.projs;
+    cov.bads = info.bads;
+    cov.nfree = nfree;
+
+    return cov;
+}
+
+
 //*************************************************************************************************************
 
 FiffCov& FiffCov::operator= (const FiffCov &rhs)
@@ -56,6 +56,7 @@
 #include <QSharedPointer>
 #include <QString>
 #include <QStringList>
+#include <QMap>
 
 
 
@@ -83,6 +84,14 @@ namespace FIFFLIB
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FiffRawData;
+
+
 //=============================================================================================================
 /**
 * Fiff cov data, which corresponds to a covariance data matrix
@@ -96,6 +105,13 @@ public:
     typedef QSharedPointer<const FiffCov> ConstSPtr;    /**< Const shared pointer type for FiffCov. */
     typedef QSharedDataPointer<FiffCov> SDPtr;       /**< Shared data pointer type for FiffCov. */
 
+    /** Shrinkage of the covariance estimated by compute_from_raw towards a scaled identity. */
+    enum Shrinkage {
+        NoShrinkage,        /**< The empirical covariance. */
+        LedoitWolf,         /**< Ledoit-Wolf shrinkage. */
+        OAS                 /**< Oracle approximating shrinkage. */
+    };
+
     //=========================================================================================================
     /**
     * Constructs the covariance data matrix.
@@ -180,6 +196,28 @@ public:
     */
     FiffCov regularize(const FiffInfo& p_info, double p_fMag = 0.1, double p_fGrad = 0.1, double p_fEeg = 0.1, bool p_bProj = true, QStringList p_exclude = defaultQStringList) const;
 
+    //=========================================================================================================
+    /**
+    * python compute_raw_covariance
+    *
+    * Estimates the noise covariance from raw data. The data is cut into segments of p_fTStep seconds, which
+    * are read in batches and accumulated in parallel as symmetric rank-k updates, each thread into its own
+    * sums. A segment is rejected if the peak-to-peak amplitude of a channel exceeds the limit for its type.
+    * Each segment is demeaned, the degrees of freedom are the number of samples minus the number of segments.
+    *
+    * For the shrinkage the channels are scaled to comparable units first (mag 1e15, grad 1e13, eeg 1e6).
+    *
+    * @param[in] p_raw          The raw data, projectors and compensators set in it are applied.
+    * @param[in] p_picks        Channels to use. If empty, all good MEG and EEG channels are used.
+    * @param[in] p_fTStep       Length of the segments in seconds.
+    * @param[in] p_mapReject    Peak-to-peak rejection limits of "mag", "grad", "eeg" and "eog" channels. EOG
+    *                           channels are read for the rejection only, if they are not picked.
+    * @param[in] p_shrinkage    The shrinkage which is applied to the estimate.
+    *
+    * @return the noise covariance, empty if no segment was accepted.
+    */
+    static FiffCov compute_from_raw(FiffRawData& p_raw, const RowVectorXi& p_picks = defaultRowVectorXi, float p_fTStep = 0.2f, const QMap<QString,double>& p_mapReject = QMap<QString,double>(), Shrinkage p_shrinkage = NoShrinkage);
+
     //=========================================================================================================
     /**
     * Assignment Operator
@@ -0,0 +1,434 @@
+//=============================================================================================================
+/**
+* @file     fiff_event_scanner.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the definition of the FiffEventScanner class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_event_scanner.h"
+#include "fiff_raw_data.h"
+#include "fiff_stream.h"
+
+#include <utils/cachelocation.h>
+#include <utils/executionconfig.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QVector>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define EVENT_CACHE_MAGIC       0x46455658  /**< 'FEVX' */
+#define EVENT_CACHE_VERSION     1
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+/**
+* A chunk of the raw data and the events found in it.
+*/
+struct EventChunk
+{
+    qint32                          iPart;          /**< The part of the recording which holds the chunk. */
+    qint32                          iPrevPart;      /**< The part which holds the sample in front of the chunk, -1 for the first chunk. */
+    fiff_int_t                      iFrom;          /**< First sample of the chunk. */
+    fiff_int_t                      iTo;            /**< Last sample of the chunk. */
+    bool                            bOk;            /**< Whether the chunk was read. */
+    QVector<TriggerDetector::Event> vecEvents;      /**< The events, iSample counts from first_samp of the file. */
+};
+
+
+//*************************************************************************************************************
+
+/**
+* Reads the selected channels of a segment of one part through a file handle of its own, without projection and
+* compensation.
+*/
+bool readPart(const FiffRawData& p_part, fiff_int_t p_iFrom, fiff_int_t p_iTo, const RowVectorXi& p_sel, MatrixXd& p_data)
+{
+    FiffRawData t_raw(p_part);
+    t_raw.splits.clear();
+    t_raw.proj = MatrixXd();
+    t_raw.comp = FiffCtfComp();
+
+    QFile t_file(t_raw.info.filename);
+    t_raw.file = FiffStream::SPtr(new FiffStream(&t_file));
+    t_raw.file->map_file();
+
+    MatrixXd t_times;
+    bool t_bOk = t_raw.read_raw_segment(p_data, t_times, p_iFrom, p_iTo, p_sel);
+
+    t_raw.file->close();
+    t_raw.file = FiffStream::SPtr();
+
+    return t_bOk;
+}
+
+} // namespace
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffEventScanner::FiffEventScanner(const QStringList& p_lTriggerChannels,
+                                   double p_dThreshold,
+                                   TriggerDetector::DetectionMode p_mode,
+                                   bool p_bRemoveOffset,
+                                   int p_iBurstLengthSamp)
+: m_lTriggerChannels(p_lTriggerChannels)
+, m_dThreshold(p_dThreshold)
+, m_mode(p_mode)
+, m_bRemoveOffset(p_bRemoveOffset)
+, m_iBurstLengthSamp(qMax(0, p_iBurstLengthSamp))
+, m_dChunkLength(10.0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void FiffEventScanner::setChunkLength(double p_dSeconds)
+{
+    m_dChunkLength = p_dSeconds;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffEventScanner::scan(const FiffRawData& p_raw, MatrixXi& p_events) const
+{
+    p_events.resize(0, 3);
+
+    if (p_raw.isEmpty() || p_raw.first_samp > p_raw.last_samp)
+        return false;
+
+    //
+    //   Pick the trigger channels, the rows of the chunks follow the channel list of the scanner
+    //
+    QList<int> t_lScannerIdx;
+    RowVectorXi t_sel(m_lTriggerChannels.size());
+    qint32 nPicked = 0;
+    for (qint32 i = 0; i < m_lTriggerChannels.size(); ++i)
+    {
+        qint32 idx = p_raw.info.ch_names.indexOf(m_lTriggerChannels[i]);
+        if (idx < 0)
+        {
+            qWarning("FiffEventScanner::scan - Trigger channel %s not found.", m_lTriggerChannels[i].toUtf8().constData());
+            continue;
+        }
+        t_sel[nPicked++] = idx;
+        t_lScannerIdx.append(i);
+    }
+    t_sel.conservativeResize(nPicked);
+
+    if (nPicked == 0)
+        return false;
+
+    //
+    //   The parts of a split recording are read on their own, chunks do not cross them
+    //
+    QList<FiffRawData::SPtr> t_lParts;
+    FiffRawData::SPtr t_pFirst(new FiffRawData(p_raw));
+    t_pFirst->splits.clear();
+    if (!p_raw.splits.isEmpty())
+        t_pFirst->last_samp = p_raw.splits.first()->first_samp - 1;
+    t_lParts << t_pFirst << p_raw.splits;
+
+    fiff_int_t t_iChunk = qMax(1, (int)(m_dChunkLength * p_raw.info.sfreq));
+
+    QVector<EventChunk> t_vecChunks;
+    for (qint32 p = 0; p < t_lParts.size(); ++p)
+    {
+        for (fiff_int_t from = t_lParts[p]->first_samp; from <= t_lParts[p]->last_samp; from += t_iChunk)
+        {
+            EventChunk t_chunk;
+            t_chunk.iPart = p;
+            t_chunk.iPrevPart = t_vecChunks.isEmpty() ? -1 : t_vecChunks.last().iPart;
+            t_chunk.iFrom = from;
+            t_chunk.iTo = qMin(from + t_iChunk - 1, t_lParts[p]->last_samp);
+            t_chunk.bOk = false;
+            t_vecChunks.append(t_chunk);
+        }
+    }
+
+    //
+    //   The offset is the first sample of the file
+    //
+    VectorXd t_vecOffset = VectorXd::Zero(nPicked);
+    if (m_bRemoveOffset && m_mode == TriggerDetector::LevelMode)
+    {
+        MatrixXd t_first;
+        if (!readPart(*t_lParts.first(), p_raw.first_samp, p_raw.first_samp, t_sel, t_first))
+            return false;
+        t_vecOffset = t_first.col(0);
+    }
+
+    QList<int> t_lRows;
+    for (qint32 i = 0; i < nPicked; ++i)
+        t_lRows.append(i);
+
+    //
+    //   Scan the chunks concurrently, each one behind the last sample of the previous chunk
+    //
+    auto scanChunk = [&](EventChunk& chunk) {
+        MatrixXd t_data;
+        bool bOverlap = chunk.iPrevPart >= 0;
+
+        if (bOverlap && chunk.iPrevPart != chunk.iPart)
+        {
+            MatrixXd t_prev, t_part;
+            if (!readPart(*t_lParts[chunk.iPrevPart], chunk.iFrom - 1, chunk.iFrom - 1, t_sel, t_prev)
+                    || !readPart(*t_lParts[chunk.iPart], chunk.iFrom, chunk.iTo, t_sel, t_part))
+                return;
+            t_data.resize(nPicked, t_part.cols() + 1);
+            t_data << t_prev.col(0), t_part;
+        }
+        else if (!readPart(*t_lParts[chunk.iPart], bOverlap ? chunk.iFrom - 1 : chunk.iFrom, chunk.iTo, t_sel, t_data))
+            return;
+
+        t_data.colwise() -= t_vecOffset;
+
+        //A crossing needs a sample below the threshold in front of it
+        int iMaxEvents = nPicked * (t_data.cols() / 2 + 1);
+        TriggerDetector t_detector(t_lRows, m_dThreshold, m_mode, false, 0, iMaxEvents);
+        int nEvents = t_detector.detect(t_data);
+
+        fiff_int_t iStart = (bOverlap ? chunk.iFrom - 1 : chunk.iFrom) - p_raw.first_samp;
+        chunk.vecEvents.reserve(nEvents);
+        for (int i = 0; i < nEvents; ++i)
+        {
+            TriggerDetector::Event t_event = t_detector.event(i);
+
+            //The sample in front belongs to the previous chunk
+            if (bOverlap && t_event.iSample == 0)
+                continue;
+
+            t_event.iSample += iStart;
+            chunk.vecEvents.append(t_event);
+        }
+        chunk.bOk = true;
+    };
+
+    QtConcurrent::blockingMap(t_vecChunks, scanChunk);
+
+    //
+    //   Merge the chunks and apply the burst hold-off in the order of the samples
+    //
+    QVector<qint64> t_vecNextAllowed(nPicked, 0);
+    QVector<TriggerDetector::Event> t_vecEvents;
+    for (qint32 k = 0; k < t_vecChunks.size(); ++k)
+    {
+        const EventChunk& t_chunk = t_vecChunks[k];
+        if (!t_chunk.bOk)
+        {
+            qWarning("FiffEventScanner::scan - Could not read samples %d ... %d.", t_chunk.iFrom, t_chunk.iTo);
+            return false;
+        }
+
+        for (qint32 i = 0; i < t_chunk.vecEvents.size(); ++i)
+        {
+            const TriggerDetector::Event& t_event = t_chunk.vecEvents[i];
+            if (t_event.iSample < t_vecNextAllowed[t_event.iChannel])
+                continue;
+            t_vecNextAllowed[t_event.iChannel] = t_event.iSample + m_iBurstLengthSamp + 1;
+            t_vecEvents.append(t_event);
+        }
+    }
+
+    p_events.resize(t_vecEvents.size(), 3);
+    for (qint32 i = 0; i < t_vecEvents.size(); ++i)
+    {
+        p_events(i, 0) = p_raw.first_samp + (fiff_int_t)t_vecEvents[i].iSample;
+        p_events(i, 1) = t_lScannerIdx[t_vecEvents[i].iChannel];
+        p_events(i, 2) = qRound(t_vecEvents[i].dValue);
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffEventScanner::scanFile(const QString& p_sFileName, MatrixXi& p_events, bool p_bUseCache) const
+{
+    QFile t_file(p_sFileName);
+    FiffRawData t_raw;
+    if (!FiffStream::setup_read_raw(t_file, t_raw, false, p_bUseCache))
+        return false;
+
+    FiffId t_id = t_raw.file->id();
+    if (p_bUseCache && readCache(p_sFileName, t_id, p_events))
+    {
+        printf("\tEvents read from %s\n", cacheName(p_sFileName).toUtf8().constData());
+        return true;
+    }
+
+    if (!scan(t_raw, p_events))
+        return false;
+
+    if (p_bUseCache)
+    {
+        if (writeCache(p_sFileName, t_id, p_events))
+            printf("\tEvents written to %s\n", cacheName(p_sFileName).toUtf8().constData());
+        else
+            printf("\tCould not write event cache %s\n", cacheName(p_sFileName).toUtf8().constData());
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffEventScanner::writeCache(const QString& p_sFileName, const FiffId& p_id, const MatrixXi& p_events) const
+{
+    QFileInfo t_fileInfo(p_sFileName);
+    QFile t_file(cacheName(p_sFileName));
+    if (!t_fileInfo.exists() || !t_file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream t_stream(&t_file);
+    t_stream.setVersion(QDataStream::Qt_5_0);
+    t_stream << (quint32)EVENT_CACHE_MAGIC << (qint32)EVENT_CACHE_VERSION;
+    t_stream << (qint64)t_fileInfo.size() << (qint64)t_fileInfo.lastModified().toMSecsSinceEpoch();
+    t_stream << p_id.version << p_id.machid[0] << p_id.machid[1] << p_id.time.secs << p_id.time.usecs;
+    t_stream << m_lTriggerChannels << m_dThreshold << (qint32)m_mode << m_bRemoveOffset << (qint32)m_iBurstLengthSamp;
+    t_stream << (qint32)p_events.rows();
+
+    for (qint32 i = 0; i < p_events.rows(); ++i)
+        t_stream << (qint32)p_events(i, 0) << (qint32)p_events(i, 1) << (qint32)p_events(i, 2);
+
+    return t_stream.status() == QDataStream::Ok;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffEventScanner::readCache(const QString& p_sFileName, const FiffId& p_id, MatrixXi& p_events) const
+{
+    QFileInfo t_fileInfo(p_sFileName);
+    QFile t_file(cacheName(p_sFileName));
+    if (!t_fileInfo.exists() || !t_file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream t_stream(&t_file);
+    t_stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic;
+    qint32 version;
+    t_stream >> magic >> version;
+    if (magic != EVENT_CACHE_MAGIC || version != EVENT_CACHE_VERSION)
+        return false;
+
+    qint64 size, modified;
+    t_stream >> size >> modified;
+    if (size != t_fileInfo.size() || modified != t_fileInfo.lastModified().toMSecsSinceEpoch())
+        return false;
+
+    FiffId t_id;
+    t_stream >> t_id.version >> t_id.machid[0] >> t_id.machid[1] >> t_id.time.secs >> t_id.time.usecs;
+    if (t_id.version != p_id.version || t_id.machid[0] != p_id.machid[0] || t_id.machid[1] != p_id.machid[1]
+            || t_id.time.secs != p_id.time.secs || t_id.time.usecs != p_id.time.usecs)
+        return false;
+
+    //
+    //   Events found with other parameters do not count
+    //
+    QStringList t_lTriggerChannels;
+    double t_dThreshold;
+    qint32 t_iMode, t_iBurstLengthSamp;
+    bool t_bRemoveOffset;
+    t_stream >> t_lTriggerChannels >> t_dThreshold >> t_iMode >> t_bRemoveOffset >> t_iBurstLengthSamp;
+    if (t_lTriggerChannels != m_lTriggerChannels || t_dThreshold != m_dThreshold || t_iMode != (qint32)m_mode
+            || t_bRemoveOffset != m_bRemoveOffset || t_iBurstLengthSamp != m_iBurstLengthSamp)
+        return false;
+
+    qint32 nEvents;
+    t_stream >> nEvents;
+    if (t_stream.status() != QDataStream::Ok || nEvents < 0)
+        return false;
+
+    MatrixXi t_events(nEvents, 3);
+    for (qint32 i = 0; i < nEvents; ++i)
+        t_stream >> t_events(i, 0) >> t_events(i, 1) >> t_events(i, 2);
+
+    if (t_stream.status() != QDataStream::Ok)
+        return false;
+
+    p_events = t_events;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+QString FiffEventScanner::cacheName(const QString& p_sFileName)
+{
+    return CacheLocation::filePath(p_sFileName, QString(".events"));
+}
@@ -0,0 +1,202 @@
+//=============================================================================================================
+/**
+* @file     fiff_event_scanner.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the FiffEventScanner class.
+*
+*/
+
+#ifndef FIFF_EVENT_SCANNER_H
+#define FIFF_EVENT_SCANNER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+
+#include <utils/triggerdetector.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QStringList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FiffRawData;
+class FiffId;
+
+
+//=============================================================================================================
+/**
+* Finds the trigger flanks of a whole raw file, e.g. for offline averaging or the event list of a browser. The
+* file is cut into chunks which are scanned concurrently, each with its own file handle, so neither the stream
+* of the caller nor its projection is touched. Only the trigger channels are read: the chunks are read without
+* projection and compensation, which lets memory mapped buffers be dequantized for the picked channels only.
+*
+* Each chunk is read with the last sample of the previous chunk in front of it, so a flank at a chunk boundary
+* is found exactly once. The burst hold-off is applied after the chunks are merged, the result is the one of a
+* single TriggerDetector running over the whole file. The event list can be cached in the cache directory, tagged
+* with the file and the scan parameters, and is reloaded from there as long as both match.
+*
+* @brief Chunked parallel event detection on raw files
+*/
+class FIFFSHARED_EXPORT FiffEventScanner
+{
+public:
+    typedef QSharedPointer<FiffEventScanner> SPtr;             /**< Shared pointer type for FiffEventScanner. */
+    typedef QSharedPointer<const FiffEventScanner> ConstSPtr;  /**< Const shared pointer type for FiffEventScanner. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an event scanner.
+    *
+    * @param[in] p_lTriggerChannels The names of the trigger channels.
+    * @param[in] p_dThreshold       The threshold a flank has to reach.
+    * @param[in] p_mode             The signal which is compared with the threshold.
+    * @param[in] p_bRemoveOffset    In the level mode, subtract the first sample of the file of each channel.
+    * @param[in] p_iBurstLengthSamp The number of samples after a flank in which a channel does not trigger again.
+    */
+    explicit FiffEventScanner(const QStringList& p_lTriggerChannels = QStringList() << "STI 014",
+                              double p_dThreshold = 0.5,
+                              UTILSLIB::TriggerDetector::DetectionMode p_mode = UTILSLIB::TriggerDetector::LevelMode,
+                              bool p_bRemoveOffset = false,
+                              int p_iBurstLengthSamp = 0);
+
+    //=========================================================================================================
+    /**
+    * Sets the length of the chunks which are scanned concurrently.
+    *
+    * @param[in] p_dSeconds     The chunk length in seconds. Default is 10 s.
+    */
+    void setChunkLength(double p_dSeconds);
+
+    //=========================================================================================================
+    /**
+    * Scans a raw data set. The raw data is not changed, the chunks are read through their own file handles.
+    *
+    * @param[in] p_raw          The raw data set up by FiffStream::setup_read_raw.
+    * @param[out] p_events      The events (events x 3), the columns are the sample including first_samp, the
+    *                           index of the trigger channel in the channel list of the scanner and the value of
+    *                           the trigger channel rounded to an integer (the gradient in the gradient modes).
+    *                           Events are ordered by sample and channel.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool scan(const FiffRawData& p_raw, Eigen::MatrixXi& p_events) const;
+
+    //=========================================================================================================
+    /**
+    * Scans a raw file, or reloads its events from its cache.
+    *
+    * @param[in] p_sFileName    The raw file.
+    * @param[out] p_events      The events, see scan.
+    * @param[in] p_bUseCache    Read the events from the cache if it is valid, write the cache otherwise.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool scanFile(const QString& p_sFileName, Eigen::MatrixXi& p_events, bool p_bUseCache = true) const;
+
+    //=========================================================================================================
+    /**
+    * Writes an event list to the cache of a raw file. The cache is tagged with the file id, size and
+    * modification time of the raw file and with the scan parameters.
+    *
+    * @param[in] p_sFileName    The raw file.
+    * @param[in] p_id           The file id of the raw file.
+    * @param[in] p_events       The events.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool writeCache(const QString& p_sFileName, const FiffId& p_id, const Eigen::MatrixXi& p_events) const;
+
+    //=========================================================================================================
+    /**
+    * Reads an event list from the cache of a raw file. Fails if the cache does not exist or does not match
+    * the file or the scan parameters anymore.
+    *
+    * @param[in] p_sFileName    The raw file.
+    * @param[in] p_id           The file id of the raw file.
+    * @param[out] p_events      The events.
+    *
+    * @return true if the cache was valid and loaded, false otherwise
+    */
+    bool readCache(const QString& p_sFileName, const FiffId& p_id, Eigen::MatrixXi& p_events) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the name of the event cache which belongs to a raw file. The cache is located in the directory of
+    * UTILSLIB::CacheLocation.
+    *
+    * @param[in] p_sFileName    The raw file.
+    *
+    * @return the name of the cache file
+    */
+    static QString cacheName(const QString& p_sFileName);
+
+private:
+    QStringList                                 m_lTriggerChannels;     /**< The names of the trigger channels. */
+    double                                      m_dThreshold;           /**< The threshold. */
+    UTILSLIB::TriggerDetector::DetectionMode    m_mode;                 /**< The detection mode. */
+    bool                                        m_bRemoveOffset;        /**< Whether the first sample is subtracted in the level mode. */
+    int                                         m_iBurstLengthSamp;     /**< The hold-off after a flank in samples. */
+    double                                      m_dChunkLength;         /**< The chunk length in seconds. */
+};
+
+} // NAMESPACE
+
+#endif // FIFF_EVENT_SCANNER_H
@@ -56,6 +56,102 @@ using namespace FIFFLIB;
 using namespace UTILSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Converts the requested channel rows of the FIFF_EPOCH tags of one aspect to double. Each tag holds a
+* column-major (samples x channels) float matrix, so every channel is one contiguous run of samples. Old style
+* files split the channels across several tags, which are concatenated here.
+*
+* @param[in] p_epochs   The FIFF_EPOCH tags of the aspect
+* @param[in] p_iNChan   Number of channels in the evoked data set
+* @param[in] p_rows     Channel indices to convert
+* @param[out] p_data    The converted rows [p_rows.size() x samples]
+*
+* @return true if successful, false otherwise
+*/
+bool readEpochRows(const QList<FiffTag>& p_epochs, qint32 p_iNChan, const RowVectorXi& p_rows, MatrixXd& p_data)
+{
+    QList<qint32> t_offsets;
+    QList<qint32> t_nchans;
+    qint32 t_iNSamp = -1;
+    qint32 t_iTotal = 0;
+    qint32 k;
+
+    for(k = 0; k < p_epochs.size(); ++k)
+    {
+        const FiffTag& t_tag = p_epochs[k];
+        if(!t_tag.isMatrix() || t_tag.getType() != FIFFT_FLOAT || t_tag.data() == NULL
+                || FiffTag::fiff_type_matrix_coding(t_tag.type) != FIFFTS_MC_DENSE)
+        {
+            printf("Error in FiffEvoked::read_evoked_node: Evoked data is not a dense float matrix.\n");
+            return false;
+        }
+
+        qint32 ndim;
+        QVector<qint32> dims;
+        t_tag.getMatrixDimensions(ndim, dims);
+        if(ndim != 2)
+        {
+            printf("Error in FiffEvoked::read_evoked_node: Only two-dimensional matrices are supported at this time.\n");
+            return false;
+        }
+
+        qint32 t_iSamp = dims[0];
+        qint32 t_iChan = dims[1];
+        //
+        //   May need a transpose if the number of channels is one
+        //
+        if(p_epochs.size() == 1 && p_iNChan == 1 && t_iSamp == 1)
+        {
+            t_iSamp = dims[1];
+            t_iChan = 1;
+        }
+
+        if(t_iNSamp < 0)
+            t_iNSamp = t_iSamp;
+        else if(t_iNSamp != t_iSamp)
+        {
+            printf("Error in FiffEvoked::read_evoked_node: Epochs differ in their number of samples.\n");
+            return false;
+        }
+
+        t_offsets.append(t_iTotal);
+        t_nchans.append(t_iChan);
+        t_iTotal += t_iChan;
+    }
+
+    p_data.resize(p_rows.size(), t_iNSamp);
+    for(k = 0; k < p_rows.size(); ++k)
+    {
+        qint32 t_iRow = p_rows[k];
+        if(t_iRow < 0 || t_iRow >= t_iTotal)
+        {
+            printf("Error in FiffEvoked::read_evoked_node: Channel %d is not stored in the evoked data.\n", t_iRow);
+            return false;
+        }
+
+        qint32 e = 0;
+        while(t_iRow >= t_offsets[e] + t_nchans[e])
+            ++e;
+
+        const float* t_pSamples = reinterpret_cast<const float*>(p_epochs[e].data()) + (qint64)(t_iRow - t_offsets[e]) * t_iNSamp;
+        p_data.row(k) = Map<const RowVectorXf>(t_pSamples, t_iNSamp).cast<double>();
+    }
+
+    return true;
+}
+
+} //NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -264,13 +360,36 @@ bool FiffEvoked::read(QIODevice& p_IODevice, FiffEvoked& p_FiffEvoked, QVariant
         return false;
     }
 
-    FiffDirNode::SPtr my_evoked = evoked_node[setno.toInt()];
+    return read_evoked_node(t_pStream, info, evoked_node[setno.toInt()], p_FiffEvoked, defaultQStringList, defaultQStringList, t_baseline, proj);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffEvoked::read_evoked_node(FiffStream::SPtr& p_pStream,
+                                  const FiffInfo& p_info,
+                                  const FiffDirNode::SPtr& p_pEvokedNode,
+                                  FiffEvoked& p_FiffEvoked,
+                                  const QStringList& include,
+                                  const QStringList& exclude,
+                                  QPair<QVariant,QVariant> t_baseline,
+                                  bool proj)
+{
+    p_FiffEvoked.clear();
+
+    FiffInfo info = p_info;
+    FiffDirNode::SPtr my_evoked = p_pEvokedNode;
 
     //
     //   Identify the aspects
     //
     QList<FiffDirNode::SPtr> aspects = my_evoked->dir_tree_find(FIFFB_ASPECT);
 
+    if(aspects.size() == 0)
+    {
+        qWarning("Could not find an aspect in the evoked data set");
+        return false;
+    }
     if(aspects.size() > 1)
         printf("\tMultiple (%d) aspects found. Taking first one.\n", aspects.size());
 
@@ -293,27 +412,27 @@ bool FiffEvoked::read(QIODevice& p_IODevice, FiffEvoked& p_FiffEvoked, QVariant
         switch (kind)
         {
             case FIFF_COMMENT:
-                t_pStream->read_tag(t_pTag,pos);
+                p_pStream->read_tag(t_pTag,pos);
                 comment = t_pTag->toString();
                 break;
             case FIFF_FIRST_SAMPLE:
-                t_pStream->read_tag(t_pTag,pos);
+                p_pStream->read_tag(t_pTag,pos);
                 first = *t_pTag->toInt();
                 break;
             case FIFF_LAST_SAMPLE:
-                t_pStream->read_tag(t_pTag,pos);
+                p_pStream->read_tag(t_pTag,pos);
                 last = *t_pTag->toInt();
                 break;
             case FIFF_NCHAN:
-                t_pStream->read_tag(t_pTag,pos);
+                p_pStream->read_tag(t_pTag,pos);
                 nchan = *t_pTag->toInt();
                 break;
             case FIFF_SFREQ:
-                t_pStream->read_tag(t_pTag,pos);
+                p_pStream->read_tag(t_pTag,pos);
                 sfreq = *t_pTag->toFloat();
                 break;
             case FIFF_CH_INFO:
-                t_pStream->read_tag(t_pTag, pos);
+                p_pStream->read_tag(t_pTag, pos);
                 chs.append( t_pTag->toChInfo() );
                 break;
         }
@@ -362,19 +481,19 @@ bool FiffEvoked::read(QIODevice& p_IODevice, FiffEvoked& p_FiffEvoked, QVariant
         switch (kind)
         {
             case FIFF_COMMENT:
-                t_pStream->read_tag(t_pTag, pos);
+                p_pStream->read_tag(t_pTag, pos);
                 comment = t_pTag->toString();
                 break;
             case FIFF_ASPECT_KIND:
-                t_pStream->read_tag(t_pTag, pos);
+                p_pStream->read_tag(t_pTag, pos);
                 aspect_kind = *t_pTag->toInt();
                 break;
             case FIFF_NAVE:
-                t_pStream->read_tag(t_pTag, pos);
+                p_pStream->read_tag(t_pTag, pos);
                 nave = *t_pTag->toInt();
                 break;
             case FIFF_EPOCH:
-                t_pStream->read_tag(t_pTag, pos);
+                p_pStream->read_tag(t_pTag, pos);
                 epoch.append(FiffTag(t_pTag.data()));
                 break;
         }
@@ -383,63 +502,23 @@ bool FiffEvoked::read(QIODevice& p_IODevice, FiffEvoked& p_FiffEvoked, QVariant
         nave = 1;
     printf("\t\tnave = %d - aspect type = %d\n", nave, aspect_kind);
 
-    qint32 nepoch = epoch.size();
-    MatrixXd all_data;
-    if (nepoch == 1)
-    {
-        //
-        //   Only one epoch
-        //
-        all_data = epoch[0].toFloatMatrix().cast<double>();
-        all_data.transposeInPlace();
-        //
-        //   May need a transpose if the number of channels is one
-        //
-        if (all_data.cols() == 1 && info.nchan == 1)
-            all_data.transposeInPlace();
-    }
-    else
-    {
-        //
-        //   Put the old style epochs together
-        //
-        all_data = epoch[0].toFloatMatrix().cast<double>();
-        all_data.transposeInPlace();
-        qint32 oldsize;
-        for (k = 1; k < nepoch; ++k)
-        {
-            oldsize = all_data.rows();
-            MatrixXd tmp = epoch[k].toFloatMatrix().cast<double>();
-            tmp.transposeInPlace();
-            all_data.conservativeResize(oldsize+tmp.rows(), all_data.cols());
-            all_data.block(oldsize, 0, tmp.rows(), tmp.cols()) = tmp;
-        }
-    }
-    if (all_data.cols() != nsamp)
+    if (epoch.size() == 0)
     {
-        qWarning("Incorrect number of samples (%d instead of %d)", (int) all_data.cols(), nsamp);
+        qWarning("Could not find the evoked data in the aspect block");
         return false;
     }
 
     //
-    //   Calibrate
+    //   Channel selection
     //
-    printf("\n\tPreprocessing...\n");
-    printf("\t%d channels remain after picking\n",info.nchan);
-
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(info.nchan);
-    for(k = 0; k < info.nchan; ++k)
-        tripletList.push_back(T(k, k, info.chs[k].cal));
-    SparseMatrix<double> cals(info.nchan, info.nchan);
-    cals.setFromTriplets(tripletList.begin(), tripletList.end());
-
-    all_data = cals * all_data;
-
-    RowVectorXf times = RowVectorXf(last-first+1);
-    for (k = 0; k < times.size(); ++k)
-        times[k] = ((float)(first+k)) / info.sfreq;
+    RowVectorXi sel;
+    if(include.size() > 0 || exclude.size() > 0)
+    {
+        sel = FiffInfo::pick_channels(info.ch_names, include, exclude);
+        if (sel.cols() == 0)
+            qWarning("Warning : No channels match the selection.\n");
+    }
+    bool t_bPick = sel.cols() > 0;
 
     //
     // Set up projection
@@ -468,15 +547,57 @@ bool FiffEvoked::read(QIODevice& p_IODevice, FiffEvoked& p_FiffEvoked, QVariant
         //   The projection items have been activated
         FiffProj::activate_projs(info.projs);
     }
+    bool t_bProject = p_FiffEvoked.proj.rows() > 0;
+
+    //
+    //   Read and calibrate the rows required: the selection only, or all channels when the projector mixes them
+    //
+    RowVectorXi rows;
+    if(t_bPick && !t_bProject)
+        rows = sel;
+    else
+    {
+        rows.resize(info.nchan);
+        for(k = 0; k < info.nchan; ++k)
+            rows[k] = k;
+    }
+
+    MatrixXd all_data;
+    if(!readEpochRows(epoch, info.nchan, rows, all_data))
+        return false;
 
-    if(p_FiffEvoked.proj.rows() > 0)
+    if (all_data.cols() != nsamp)
     {
-        all_data = p_FiffEvoked.proj * all_data;
+        qWarning("Incorrect number of samples (%d instead of %d)", (int) all_data.cols(), nsamp);
+        return false;
+    }
+
+    printf("\n\tPreprocessing...\n");
+    printf("\t%d channels remain after picking\n", t_bPick ? (int) sel.cols() : info.nchan);
+
+    for(k = 0; k < rows.size(); ++k)
+        all_data.row(k) *= (double) info.chs[rows[k]].cal;
+
+    if(t_bProject)
+    {
+        if(t_bPick)
+        {
+            MatrixXd t_projSel(sel.cols(), p_FiffEvoked.proj.cols());
+            for(k = 0; k < sel.cols(); ++k)
+                t_projSel.row(k) = p_FiffEvoked.proj.row(sel[k]);
+            all_data = t_projSel * all_data;
+        }
+        else
+            all_data = p_FiffEvoked.proj * all_data;
         printf("\tSSP projectors applied to the evoked data\n");
     }
 
+    RowVectorXf times = RowVectorXf(last-first+1);
+    for (k = 0; k < times.size(); ++k)
+        times[k] = ((float)(first+k)) / info.sfreq;
+
     // Put it all together
-    p_FiffEvoked.info = info;
+    p_FiffEvoked.info = t_bPick ? FiffInfo(info.pick_info(sel)) : info;
     p_FiffEvoked.nave = nave;
     p_FiffEvoked.aspect_kind = aspect_kind;
     p_FiffEvoked.first = first;
@@ -561,6 +682,8 @@ void FiffEvoked::applyBaselineCorrection(QPair<QVariant, QVariant>& p_baseline)
 {
     // Run baseline correction
     printf("Applying baseline correction ... (mode: mean)\n");
-    this->data = MNEMath::rescale(this->data, this->times, p_baseline, QString("mean"));
+    qint32 t_iFirst, t_iLast;
+    MNEMath::baselineRange(this->times, p_baseline, t_iFirst, t_iLast);
+    MNEMath::rescaleMean(this->data, t_iFirst, t_iLast);
     this->baseline = p_baseline;
 }
@@ -84,6 +84,15 @@ namespace FIFFLIB
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FiffStream;
+class FiffDirNode;
+
+
 //=============================================================================================================
 /**
 * NEW PYTHON LIKE Fiff evoked
@@ -199,6 +208,33 @@ public:
     */
     static bool read(QIODevice& p_IODevice, FiffEvoked& p_FiffEvoked, QVariant setno = 0, QPair<QVariant,QVariant> t_baseline = defaultVariantPair, bool proj = true, fiff_int_t p_aspect_kind = FIFFV_ASPECT_AVERAGE);
 
+    //=========================================================================================================
+    /**
+    * Reads the evoked data of a single FIFFB_EVOKED block from an already opened stream. Only the channels
+    * matching include/exclude are converted from the stored epoch tags, so the result equals read() followed by
+    * pick_channels() without materializing the full data matrix. When SSP projectors are applied, the selected
+    * rows are projected from the full calibrated data.
+    *
+    * @param[in] p_pStream      The opened fiff stream holding the evoked block
+    * @param[in] p_info         The measurement info read from the stream
+    * @param[in] p_pEvokedNode  The FIFFB_EVOKED directory node to read
+    * @param[out] p_FiffEvoked  The read evoked data
+    * @param[in] include        Channels to include (if empty, include all available)
+    * @param[in] exclude        Channels to exclude (if empty, do not exclude any)
+    * @param[in] t_baseline     The time interval to apply rescaling / baseline correction (see read())
+    * @param[in] proj           Apply SSP projection vectors (optional, default = true)
+    *
+    * @return true if successful, false otherwise
+    */
+    static bool read_evoked_node(QSharedPointer<FiffStream>& p_pStream,
+                                 const FiffInfo& p_info,
+                                 const QSharedPointer<FiffDirNode>& p_pEvokedNode,
+                                 FiffEvoked& p_FiffEvoked,
+                                 const QStringList& include = defaultQStringList,
+                                 const QStringList& exclude = defaultQStringList,
+                                 QPair<QVariant,QVariant> t_baseline = defaultVariantPair,
+                                 bool proj = true);
+
     //=========================================================================================================
     /**
     * Set a new fiff measurement info
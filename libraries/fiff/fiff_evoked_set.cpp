@@ -98,6 +98,10 @@ FiffEvokedSet::FiffEvokedSet(QIODevice& p_IODevice)
 FiffEvokedSet::FiffEvokedSet(const FiffEvokedSet& p_FiffEvokedSet)
 : info(p_FiffEvokedSet.info)
 , evoked(p_FiffEvokedSet.evoked)
+, file(p_FiffEvokedSet.file)
+, evoked_nodes(p_FiffEvokedSet.evoked_nodes)
+, comments(p_FiffEvokedSet.comments)
+, aspect_kinds(p_FiffEvokedSet.aspect_kinds)
 {
 
 }
@@ -117,6 +121,10 @@ void FiffEvokedSet::clear()
 {
     info.clear();
     evoked.clear();
+    file.clear();
+    evoked_nodes.clear();
+    comments.clear();
+    aspect_kinds.clear();
 }
 
 
@@ -221,58 +229,21 @@ bool FiffEvokedSet::find_evoked(const FiffEvokedSet& p_FiffEvokedSet) const
 
 bool FiffEvokedSet::read(QIODevice& p_IODevice, FiffEvokedSet& p_FiffEvokedSet, QPair<QVariant,QVariant> baseline, bool proj)
 {
-    p_FiffEvokedSet.clear();
-
-    //
-    //   Open the file
-    //
-    FiffStream::SPtr t_pStream(new FiffStream(&p_IODevice));
-    QString t_sFileName = t_pStream->streamName();
-
-    printf("Exploring %s ...\n",t_sFileName.toUtf8().constData());
-
-    if(!t_pStream->open())
-        return false;
-    //
-    //   Read the measurement info
-    //
-    FiffDirNode::SPtr meas;
-    if(!t_pStream->read_meas_info(t_pStream->dirtree(), p_FiffEvokedSet.info, meas))
-        return false;
-    p_FiffEvokedSet.info.filename = t_sFileName; //move fname storage to read_meas_info member function
-    //
-    //   Locate the data of interest
-    //
-    QList<FiffDirNode::SPtr> processed = meas->dir_tree_find(FIFFB_PROCESSED_DATA);
-    if (processed.size() == 0)
-    {
-        qWarning("Could not find processed data");
-        return false;
-    }
-    //
-    QList<FiffDirNode::SPtr> evoked_node = meas->dir_tree_find(FIFFB_EVOKED);
-    if (evoked_node.size() == 0)
-    {
-        qWarning("Could not find evoked data");
+    if(!FiffEvokedSet::read_entries(p_IODevice, p_FiffEvokedSet))
         return false;
-    }
 
-    QStringList comments;
-    QList<fiff_int_t> aspect_kinds;
-    QString t;
-    if(!t_pStream->get_evoked_entries(evoked_node, comments, aspect_kinds, t))
-        t = QString("None found, must use integer");
-    printf("\tFound %d datasets\n", evoked_node.size());
-
-    for(qint32 i = 0; i < comments.size(); ++i)
+    for(qint32 i = 0; i < p_FiffEvokedSet.evoked_nodes.size(); ++i)
     {
-        QFile t_file(p_FiffEvokedSet.info.filename);
-        printf(">> Processing %s <<\n", comments[i].toUtf8().constData());
+        if(i < p_FiffEvokedSet.comments.size())
+            printf(">> Processing %s <<\n", p_FiffEvokedSet.comments[i].toUtf8().constData());
         FiffEvoked t_FiffEvoked;
-        if(FiffEvoked::read(t_file, t_FiffEvoked, i, baseline, proj))
+        if(p_FiffEvokedSet.read_evoked(i, t_FiffEvoked, defaultQStringList, defaultQStringList, baseline, proj))
             p_FiffEvokedSet.evoked.push_back(t_FiffEvoked);
     }
 
+    //   Everything is materialized, the device does not need to outlive the set
+    p_FiffEvokedSet.file.clear();
+
     return true;
 
     //### OLD MATLAB oriented implementation ###
@@ -614,3 +585,93 @@ bool FiffEvokedSet::read(QIODevice& p_IODevice, FiffEvokedSet& p_FiffEvokedSet,
 
 //    return true;
 }
+
+
+//*************************************************************************************************************
+
+bool FiffEvokedSet::read_entries(QIODevice& p_IODevice, FiffEvokedSet& p_FiffEvokedSet)
+{
+    p_FiffEvokedSet.clear();
+
+    //
+    //   Open the file
+    //
+    FiffStream::SPtr t_pStream(new FiffStream(&p_IODevice));
+    QString t_sFileName = t_pStream->streamName();
+
+    printf("Exploring %s ...\n",t_sFileName.toUtf8().constData());
+
+    if(!t_pStream->open())
+        return false;
+    //
+    //   Read the measurement info
+    //
+    FiffDirNode::SPtr meas;
+    if(!t_pStream->read_meas_info(t_pStream->dirtree(), p_FiffEvokedSet.info, meas))
+        return false;
+    p_FiffEvokedSet.info.filename = t_sFileName; //move fname storage to read_meas_info member function
+    //
+    //   Locate the data of interest
+    //
+    QList<FiffDirNode::SPtr> processed = meas->dir_tree_find(FIFFB_PROCESSED_DATA);
+    if (processed.size() == 0)
+    {
+        qWarning("Could not find processed data");
+        return false;
+    }
+    //
+    QList<FiffDirNode::SPtr> evoked_node = meas->dir_tree_find(FIFFB_EVOKED);
+    if (evoked_node.size() == 0)
+    {
+        qWarning("Could not find evoked data");
+        return false;
+    }
+
+    QString t;
+    if(!t_pStream->get_evoked_entries(evoked_node, p_FiffEvokedSet.comments, p_FiffEvokedSet.aspect_kinds, t))
+        t = QString("None found, must use integer");
+    printf("\tFound %d datasets\n", evoked_node.size());
+
+    p_FiffEvokedSet.file = t_pStream;
+    p_FiffEvokedSet.evoked_nodes = evoked_node;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+qint32 FiffEvokedSet::find_entry(const QString& p_sComment, fiff_int_t p_aspect_kind) const
+{
+    for(qint32 i = 0; i < comments.size() && i < aspect_kinds.size(); ++i)
+        if(comments[i].compare(p_sComment) == 0 && aspect_kinds[i] == p_aspect_kind)
+            return i;
+
+    return -1;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffEvokedSet::read_evoked(qint32 setno,
+                                FiffEvoked& p_FiffEvoked,
+                                const QStringList& include,
+                                const QStringList& exclude,
+                                QPair<QVariant,QVariant> baseline,
+                                bool proj) const
+{
+    if(!file)
+    {
+        printf("Error in FiffEvokedSet::read_evoked: No stream available, use read_entries first.\n");
+        return false;
+    }
+
+    if(setno < 0 || setno >= evoked_nodes.size())
+    {
+        printf("Error in FiffEvokedSet::read_evoked: Data set selector %d out of range.\n", setno);
+        return false;
+    }
+
+    FiffStream::SPtr t_pStream = file;
+    return FiffEvoked::read_evoked_node(t_pStream, info, evoked_nodes[setno], p_FiffEvoked, include, exclude, baseline, proj);
+}
@@ -45,6 +45,8 @@
 #include "fiff_info.h"
 #include "fiff_evoked.h"
 #include "fiff_global.h"
+#include "fiff_stream.h"
+#include "fiff_dir_node.h"
 
 
 //*************************************************************************************************************
@@ -195,9 +197,58 @@ public:
     */
     static bool read(QIODevice& p_IODevice, FiffEvokedSet& p_FiffEvokedSet, QPair<QVariant,QVariant> baseline = defaultVariantPair, bool proj = true);
 
+    //=========================================================================================================
+    /**
+    * Opens an evoked data set lazily: only the measurement info and the directory of the evoked data sets
+    * (comments and aspect kinds) are read, the evoked list stays empty. Individual data sets are materialized
+    * with read_evoked. The stream is held by the set, so p_IODevice has to outlive it.
+    *
+    * @param[in] p_IODevice         An fiff IO device like a fiff QFile or QTCPSocket
+    * @param[out] p_FiffEvokedSet   The evoked data set directory
+    *
+    * @return true when successful, false otherwise
+    */
+    static bool read_entries(QIODevice& p_IODevice, FiffEvokedSet& p_FiffEvokedSet);
+
+    //=========================================================================================================
+    /**
+    * Looks up a data set in the directory read by read_entries.
+    *
+    * @param[in] p_sComment     Comment/name of the data set, i.e. the condition
+    * @param[in] p_aspect_kind  Either FIFFV_ASPECT_AVERAGE or FIFFV_ASPECT_STD_ERR
+    *
+    * @return the data set number, -1 if not found
+    */
+    qint32 find_entry(const QString& p_sComment, fiff_int_t p_aspect_kind = FIFFV_ASPECT_AVERAGE) const;
+
+    //=========================================================================================================
+    /**
+    * Reads a single data set from the stream held by the set. Only the selected channels are converted.
+    *
+    * @param[in] setno          The data set number, see find_entry
+    * @param[out] p_FiffEvoked  The read evoked data
+    * @param[in] include        Channels to include (if empty, include all available)
+    * @param[in] exclude        Channels to exclude (if empty, do not exclude any)
+    * @param[in] baseline       The time interval to apply rescaling / baseline correction (see read())
+    * @param[in] proj           Apply SSP projection vectors (optional, default = true)
+    *
+    * @return true when successful, false otherwise
+    */
+    bool read_evoked(qint32 setno,
+                     FiffEvoked& p_FiffEvoked,
+                     const QStringList& include = defaultQStringList,
+                     const QStringList& exclude = defaultQStringList,
+                     QPair<QVariant,QVariant> baseline = defaultVariantPair,
+                     bool proj = true) const;
+
 public:
     FiffInfo             info;   /**< FIFF measurement information */
     QList<FiffEvoked>    evoked; /**< List of Fiff Evoked Data */
+
+    FiffStream::SPtr            file;           /**< Stream the data sets are read from on demand. */
+    QList<FiffDirNode::SPtr>    evoked_nodes;   /**< Directory nodes of the data sets in the stream. */
+    QStringList                 comments;       /**< Comments of the data sets. */
+    QList<fiff_int_t>           aspect_kinds;   /**< Aspect kinds of the data sets. */
 };
 
 } // NAMESPACE
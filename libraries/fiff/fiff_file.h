@@ -254,6 +254,7 @@ namespace FIFFLIB
 #define FIFFT_DIG_STRING_STRUCT    36
 #define FIFFT_STREAM_SEGMENT_STRUCT 37
 #define FIFFT_DATA_REF_STRUCT       38
+#define FIFFT_COMPRESSED_RAW       128  /**< MNE-CPP extension: losslessly compressed raw data buffer, see FiffRawCompression */
 /*
 * These are for matrices of any of the above 
 */
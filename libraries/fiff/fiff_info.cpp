@@ -45,6 +45,16 @@
 #include <utils/ioutils.h>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QByteArray>
+#include <QMutex>
+#include <QMutexLocker>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -54,6 +64,99 @@ using namespace FIFFLIB;
 using namespace UTILSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define FIFF_INFO_OPERATOR_CACHE_SIZE 8     /**< Projectors and compensators which are kept each. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//=============================================================================================================
+/**
+* Projectors and compensators made by a FiffInfo and its copies, most recently used first. The keys hold all
+* inputs of the operators, so changing the info never returns a stale operator.
+*/
+struct FiffInfoOperatorCache
+{
+    struct Entry
+    {
+        QByteArray key;     /**< All inputs of the operator. */
+        MatrixXd op;        /**< The operator. */
+        qint32 n;           /**< Number of projection items, unused for compensators. */
+    };
+
+    QMutex lock;                /**< Guards the lists. */
+    QList<Entry> projectors;    /**< The SSP operators. */
+    QList<Entry> compensators;  /**< The compensators. */
+
+    bool find(QList<Entry>& list, const QByteArray& key, MatrixXd& op, qint32& n)
+    {
+        QMutexLocker locker(&lock);
+        for(qint32 i = 0; i < list.size(); ++i)
+        {
+            if(list[i].key == key)
+            {
+                list.move(i, 0);
+                op = list[0].op;
+                n = list[0].n;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void insert(QList<Entry>& list, const QByteArray& key, const MatrixXd& op, qint32 n)
+    {
+        QMutexLocker locker(&lock);
+        Entry entry;
+        entry.key = key;
+        entry.op = op;
+        entry.n = n;
+        list.prepend(entry);
+        while(list.size() > FIFF_INFO_OPERATOR_CACHE_SIZE)
+            list.removeLast();
+    }
+};
+
+} //NAMESPACE
+
+namespace
+{
+
+void appendKey(QByteArray& key, qint32 value)
+{
+    key.append(reinterpret_cast<const char*>(&value), sizeof(qint32));
+}
+
+void appendKey(QByteArray& key, const QStringList& list)
+{
+    appendKey(key, list.size());
+    for(qint32 i = 0; i < list.size(); ++i)
+    {
+        key.append(list[i].toUtf8());
+        key.append('\0');
+    }
+}
+
+void appendKey(QByteArray& key, const MatrixXd& mat)
+{
+    appendKey(key, (qint32)mat.rows());
+    appendKey(key, (qint32)mat.cols());
+    key.append(reinterpret_cast<const char*>(mat.data()), mat.size()*sizeof(double));
+}
+
+} //NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -66,6 +169,7 @@ FiffInfo::FiffInfo()
 , lowpass(-1.0)
 , acq_pars("")
 , acq_stim("")
+, m_pOperatorCache(new FiffInfoOperatorCache)
 {
     meas_date[0] = -1;
 }
@@ -83,6 +187,7 @@ FiffInfo::FiffInfo(const FiffInfo& p_FiffInfo)
 , dig_trans(p_FiffInfo.dig_trans)
 , acq_pars(p_FiffInfo.acq_pars)
 , acq_stim(p_FiffInfo.acq_stim)
+, m_pOperatorCache(p_FiffInfo.m_pOperatorCache)
 {
     meas_date[0] = p_FiffInfo.meas_date[0];
     meas_date[1] = p_FiffInfo.meas_date[1];
@@ -150,6 +255,41 @@ qint32 FiffInfo::get_current_comp()
 }
 
 
+//*************************************************************************************************************
+
+qint32 FiffInfo::make_projector(MatrixXd& proj) const
+{
+    return make_projector(proj, this->ch_names);
+}
+
+
+//*************************************************************************************************************
+
+qint32 FiffInfo::make_projector(MatrixXd& proj, const QStringList& p_chNames) const
+{
+    QByteArray key;
+    appendKey(key, p_chNames);
+    appendKey(key, this->bads);
+    for(qint32 k = 0; k < this->projs.size(); ++k)
+    {
+        if(this->projs[k].active)
+        {
+            appendKey(key, this->projs[k].data->col_names);
+            appendKey(key, this->projs[k].data->data);
+        }
+    }
+
+    qint32 nproj;
+    if(m_pOperatorCache->find(m_pOperatorCache->projectors, key, proj, nproj))
+        return nproj;
+
+    nproj = FiffProj::make_projector(this->projs, p_chNames, proj, this->bads);
+    m_pOperatorCache->insert(m_pOperatorCache->projectors, key, proj, nproj);
+
+    return nproj;
+}
+
+
 //*************************************************************************************************************
 
 bool FiffInfo::make_compensator(fiff_int_t from, fiff_int_t to, FiffCtfComp& ctf_comp, bool exclude_comp_chs) const
@@ -166,6 +306,33 @@ bool FiffInfo::make_compensator(fiff_int_t from, fiff_int_t to, FiffCtfComp& ctf
         return false;
     }
 
+    //
+    //   Look for the compensator made from the same inputs
+    //
+    QByteArray key;
+    appendKey(key, from);
+    appendKey(key, to);
+    appendKey(key, exclude_comp_chs ? 1 : 0);
+    appendKey(key, this->nchan);
+    appendKey(key, this->ch_names);
+    if (exclude_comp_chs)
+        for (qint32 k = 0; k < this->nchan; ++k)
+            appendKey(key, this->chs[k].kind == FIFFV_REF_MEG_CH ? 1 : 0);
+    for (qint32 k = 0; k < this->comps.size(); ++k)
+    {
+        if (this->comps[k].kind == from || this->comps[k].kind == to)
+        {
+            appendKey(key, this->comps[k].kind);
+            appendKey(key, this->comps[k].data->row_names);
+            appendKey(key, this->comps[k].data->col_names);
+            appendKey(key, this->comps[k].data->data);
+        }
+    }
+
+    qint32 unused;
+    if (m_pOperatorCache->find(m_pOperatorCache->compensators, key, ctf_comp.data->data, unused))
+        return true;
+
     if (from == 0)
         C1 = MatrixXd::Zero(this->nchan,this->nchan);
     else
@@ -222,6 +389,8 @@ bool FiffInfo::make_compensator(fiff_int_t from, fiff_int_t to, FiffCtfComp& ctf
         ctf_comp.data->data = comp_tmp;
     }
 
+    m_pOperatorCache->insert(m_pOperatorCache->compensators, key, ctf_comp.data->data, 0);
+
     return true;
 }
 
@@ -85,6 +85,7 @@ namespace FIFFLIB
 //=============================================================================================================
 
 class FiffStream;
+struct FiffInfoOperatorCache;
 
 
 //=============================================================================================================
@@ -138,6 +139,9 @@ public:
     * @param[out] ctf_comp          Compensation Matrix
     * @param[in] exclude_comp_chs   exclude compensation channels from the output (optional)
     *
+    * The compensators are cached like the projectors, keyed by the states, the channels and the used
+    * compensation data.
+    *
     * @return true if succeeded, false otherwise
     */
     bool make_compensator(fiff_int_t from, fiff_int_t to, FiffCtfComp& ctf_comp, bool exclude_comp_chs = false) const;
@@ -166,7 +170,7 @@ public:
     *
     * @return nproj - How many items in the projector
     */
-    inline qint32 make_projector(MatrixXd& proj) const;
+    qint32 make_projector(MatrixXd& proj) const;
 
     //=========================================================================================================
     /**
@@ -179,9 +183,12 @@ public:
     * @param[out] proj      The projection operator to apply to the data
     * @param[in] p_chNames   List of channels to include in the projection matrix
     *
+    * The operators are cached, keyed by the active projectors, the bad channels and the channel selection.
+    * A change of any of them makes a new operator, the cache is shared by copies of this info.
+    *
     * @return nproj - How many items in the projector
     */
-    inline qint32 make_projector(MatrixXd& proj, const QStringList& p_chNames) const;
+    qint32 make_projector(MatrixXd& proj, const QStringList& p_chNames) const;
 
     //=========================================================================================================
     /**
@@ -267,6 +274,9 @@ public: //Public because it's a mne struct
     QList<FiffCtfComp> comps;   /**< List of available CTF software compensators. */
     QString acq_pars;           /**< Acquisition information ToDo... */
     QString acq_stim;           /**< Acquisition information ToDo... */
+
+private:
+    QSharedPointer<FiffInfoOperatorCache> m_pOperatorCache;  /**< Cached projectors and compensators, shared by copies. */
 };
 
 //*************************************************************************************************************
@@ -274,22 +284,6 @@ public: //Public because it's a mne struct
 // INLINE DEFINITIONS
 //=============================================================================================================
 
-inline qint32 FiffInfo::make_projector(MatrixXd& proj) const
-{
-    return FiffProj::make_projector(this->projs,this->ch_names, proj, this->bads);
-}
-
-
-//*************************************************************************************************************
-
-inline qint32 FiffInfo::make_projector(MatrixXd& proj, const QStringList& p_chNames) const
-{
-    return FiffProj::make_projector(this->projs, p_chNames, proj, this->bads);
-}
-
-
-//*************************************************************************************************************
-
 inline void FiffInfo::set_current_comp(fiff_int_t value)
 {
     this->chs = set_current_comp(this->chs, value);
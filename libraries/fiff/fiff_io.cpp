@@ -87,7 +87,7 @@ FiffIO::FiffIO(QList<QIODevice*>& p_qlistIODevices)
 
 //*************************************************************************************************************
 
-bool FiffIO::setup_read(QIODevice& p_IODevice, FiffInfo& info, FiffDirNode::SPtr& dirTree)
+bool FiffIO::setup_read(QIODevice& p_IODevice, FiffInfo& info, FiffDirNode::SPtr& dirTree, int fields)
 {
     //Open the file
     FiffStream::SPtr p_pStream(new FiffStream(&p_IODevice));
@@ -99,7 +99,7 @@ bool FiffIO::setup_read(QIODevice& p_IODevice, FiffInfo& info, FiffDirNode::SPtr
         return false;
 
     //Read the measurement info
-    if(!p_pStream->read_meas_info(p_pStream->dirtree(), info, dirTree))
+    if(!p_pStream->read_meas_info(p_pStream->dirtree(), info, dirTree, fields))
         return false;
 
     return true;
@@ -113,7 +113,8 @@ bool FiffIO::read(QIODevice& p_IODevice)
     FiffDirNode::SPtr t_dirTree;
     bool hasRaw=false,hasEvoked=false; // hasFwds=false;
 
-    FiffIO::setup_read(p_IODevice,t_fiffInfo,t_dirTree);
+    //The info is only used to find the data types, the full info is read again by the readers below
+    FiffIO::setup_read(p_IODevice,t_fiffInfo,t_dirTree,FiffStream::MeasInfoBasic);
     p_IODevice.close(); //file can be closed, since IODevice is already read
 
     //Search dirTree for specific data types
@@ -136,11 +136,12 @@ public:
     * @param[in] p_IODevice     An fiff IO device like a fiff QFile or QTCPSocket
     * @param[in] info           Overall info for fiff IO device
     * @param[out] dirTree       Node directory structure
+    * @param[in] fields         Parts of the measurement info to read, see FiffStream::MeasInfoField
     *
     * @return true if succeeded, false otherwise
     */
 
-    static bool setup_read(QIODevice& p_IODevice, FiffInfo& info, FiffDirNode::SPtr& dirTree);
+    static bool setup_read(QIODevice& p_IODevice, FiffInfo& info, FiffDirNode::SPtr& dirTree, int fields = FiffStream::MeasInfoAll);
 
     //=========================================================================================================
     /**
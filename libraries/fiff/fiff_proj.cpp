@@ -39,10 +39,22 @@
 //=============================================================================================================
 
 #include "fiff_proj.h"
+#include "fiff_info.h"
+#include "fiff_raw_data.h"
 #include <stdio.h>
 #include <utils/mnemath.h>
+#include <utils/executionconfig.h>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QPair>
+#include <QVector>
+#include <QtConcurrent>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -50,6 +62,16 @@
 //=============================================================================================================
 
 #include <Eigen/SVD>
+#include <Eigen/Eigenvalues>
+#include <Eigen/QR>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <random>
 
 
 //*************************************************************************************************************
@@ -62,6 +84,338 @@ using namespace FIFFLIB;
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define SSP_SEGMENTS_PER_THREAD 8   /**< Segments which are read for each thread before they are accumulated. */
+#define SSP_OVERSAMPLING 10         /**< Additional sketch columns of the randomized decomposition. */
+#define SSP_POWER_ITERATIONS 2      /**< Power iterations of the randomized decomposition. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* The channels of one type, they are stored as consecutive rows of the read blocks.
+*/
+struct SspGroup
+{
+    QString sKind;          /**< "planar", "axial" or "eeg", the first part of the description. */
+    qint32 iNVectors;       /**< Number of vectors to compute. */
+    qint32 iOffset;         /**< First row in the read blocks. */
+    qint32 iRows;           /**< Number of channels. */
+    QStringList names;      /**< Channel names. */
+    MatrixXd matQ;          /**< Orthonormal basis which is multiplied in the current pass, randomized only. */
+};
+
+
+//=============================================================================================================
+/**
+* Sums of the accepted segments of one thread.
+*/
+struct SspAccumulator
+{
+    QVector<MatrixXd> vecSums;  /**< Per group the lower triangle of the sum of x*x', or the sketch of the pass. */
+    QVector<double> vecPower;   /**< Per group the sum of squares, i.e. the trace of the covariance. */
+    qint32 iSegments;           /**< Number of accepted segments. */
+    qint32 iRejected;           /**< Number of rejected segments. */
+};
+
+
+//=============================================================================================================
+/**
+* Adds the channel types of p_info which are requested to p_groups, bad channels are skipped.
+*
+* @param[in] p_info         The measurement info.
+* @param[in] p_lChannels    The candidate channels, indices into p_info.chs.
+* @param[in] p_iNGrad       Number of vectors for the gradiometers.
+* @param[in] p_iNMag        Number of vectors for the magnetometers.
+* @param[in] p_iNEeg        Number of vectors for the EEG channels.
+* @param[out] p_groups      The channel groups.
+* @param[out] p_lSel        The channels in the row order of the groups.
+*/
+void makeSspGroups(const FiffInfo& p_info, const QList<qint32>& p_lChannels, qint32 p_iNGrad, qint32 p_iNMag, qint32 p_iNEeg, QVector<SspGroup>& p_groups, QList<qint32>& p_lSel)
+{
+    const char* kinds[3] = { "planar", "axial", "eeg" };
+    const qint32 nVectors[3] = { p_iNGrad, p_iNMag, p_iNEeg };
+
+    for(qint32 t = 0; t < 3; ++t)
+    {
+        if(nVectors[t] <= 0)
+            continue;
+
+        SspGroup group;
+        group.sKind = kinds[t];
+        group.iOffset = p_lSel.size();
+
+        for(qint32 i = 0; i < p_lChannels.size(); ++i)
+        {
+            const FiffChInfo& ch = p_info.chs[p_lChannels[i]];
+            if(p_info.bads.contains(ch.ch_name))
+                continue;
+
+            qint32 type = -1;
+            if(ch.kind == FIFFV_MEG_CH && ch.unit == FIFF_UNIT_T_M)
+                type = 0;
+            else if(ch.kind == FIFFV_MEG_CH)
+                type = 1;
+            else if(ch.kind == FIFFV_EEG_CH)
+                type = 2;
+
+            if(type == t)
+            {
+                p_lSel.append(p_lChannels[i]);
+                group.names << ch.ch_name;
+            }
+        }
+
+        group.iRows = p_lSel.size() - group.iOffset;
+        group.iNVectors = qMin(nVectors[t], group.iRows);
+        if(group.iRows > 0)
+            p_groups.append(group);
+    }
+}
+
+
+//=============================================================================================================
+/**
+* Accumulates the blocks and computes the projection items of each group. The blocks are read in batches by the
+* calling thread and added in parallel, each thread into its own sums, which are reduced in thread order.
+*
+* @param[in] nBlocks        Number of blocks.
+* @param[in] readBlock      Reads block i into a matrix with the rows of the groups first: bool(qint32, MatrixXd&).
+* @param[in] vecLimit       Peak-to-peak limit of each block row, 0 for no check.
+* @param[in] groups         The channel groups.
+* @param[in] decomposition  The decomposition used to find the vectors.
+* @param[in] sDesc          The description prefix of the projection items.
+* @param[in] sCaller        The name of the calling function for error messages.
+*
+* @return the inactive projection items, empty if no block was accepted.
+*/
+template<typename ReadBlock>
+QList<FiffProj> computeSsp(qint32 nBlocks, ReadBlock readBlock, const VectorXd& vecLimit, QVector<SspGroup>& groups, FiffProj::Decomposition decomposition, const QString& sDesc, const char* sCaller)
+{
+    QList<FiffProj> projs;
+
+    const bool bRandomized = decomposition == FiffProj::RandomizedDecomposition;
+    const qint32 nPasses = bRandomized ? 2 + SSP_POWER_ITERATIONS : 1;
+    const qint32 nGroups = groups.size();
+    const qint32 nThreads = ExecutionConfig::threadCount();
+
+    QVector<qint32> vecSketch(nGroups);
+    for(qint32 g = 0; g < nGroups; ++g)
+        vecSketch[g] = bRandomized ? qMin(groups[g].iNVectors + SSP_OVERSAMPLING, groups[g].iRows) : groups[g].iRows;
+
+    QVector<char> vecAccepted(nBlocks, 1);
+    QVector<MatrixXd> vecBlocks(nThreads * SSP_SEGMENTS_PER_THREAD);
+    QVector<SspAccumulator> vecAcc(nThreads);
+    QVector<MatrixXd> vecSums(nGroups);
+    QVector<double> vecPower(nGroups, 0.0);
+    qint32 nAccepted = 0, nRejected = 0;
+
+    for(qint32 pass = 0; pass < nPasses; ++pass)
+    {
+        for(qint32 t = 0; t < nThreads; ++t)
+        {
+            vecAcc[t].vecSums.resize(nGroups);
+            vecAcc[t].vecPower.fill(0.0, nGroups);
+            for(qint32 g = 0; g < nGroups; ++g)
+                vecAcc[t].vecSums[g] = MatrixXd::Zero(groups[g].iRows, vecSketch[g]);
+            vecAcc[t].iSegments = 0;
+            vecAcc[t].iRejected = 0;
+        }
+
+        //
+        // The rejection is done in the first pass, the following passes read the accepted blocks only
+        //
+        QVector<qint32> vecIdx;
+        for(qint32 b = 0; b < nBlocks; ++b)
+            if(vecAccepted[b])
+                vecIdx.append(b);
+
+        SspAccumulator* pAcc = vecAcc.data();
+        char* pAccepted = vecAccepted.data();
+        const SspGroup* pGroups = groups.constData();
+        qint32 iBatchStart = 0;
+
+        //
+        // Each block of segments belongs to one thread and is added to its own sums
+        //
+        auto accumulateBlock = [&](const QPair<int,int>& block) {
+            SspAccumulator& acc = pAcc[block.first / SSP_SEGMENTS_PER_THREAD];
+
+            for(int i = block.first; i < block.second; ++i)
+            {
+                const MatrixXd& seg = vecBlocks.at(i);
+                const qint32 b = vecIdx.at(iBatchStart + i);
+
+                if(pass == 0)
+                {
+                    bool bReject = false;
+                    for(qint32 k = 0; k < vecLimit.size() && !bReject; ++k)
+                        bReject = vecLimit[k] > 0.0 && seg.row(k).maxCoeff() - seg.row(k).minCoeff() > vecLimit[k];
+
+                    if(bReject)
+                    {
+                        pAccepted[b] = 0;
+                        ++acc.iRejected;
+                        continue;
+                    }
+                    ++acc.iSegments;
+                }
+
+                for(qint32 g = 0; g < nGroups; ++g)
+                {
+                    const SspGroup& group = pGroups[g];
+                    MatrixXd X = seg.middleRows(group.iOffset, group.iRows);
+
+                    if(pass == 0)
+                        acc.vecPower[g] += X.squaredNorm();
+
+                    if(!bRandomized)
+                    {
+                        acc.vecSums[g].selfadjointView<Lower>().rankUpdate(X);
+                    }
+                    else if(pass == 0)
+                    {
+                        //The gaussian test matrix of a block only depends on the block, not on the thread
+                        std::mt19937 generator(b * nGroups + g + 1);
+                        std::normal_distribution<double> normal(0.0, 1.0);
+                        MatrixXd matOmega(X.cols(), acc.vecSums[g].cols());
+                        for(qint32 c = 0; c < matOmega.cols(); ++c)
+                            for(qint32 r = 0; r < matOmega.rows(); ++r)
+                                matOmega(r, c) = normal(generator);
+
+                        acc.vecSums[g].noalias() += X * matOmega;
+                    }
+                    else
+                    {
+                        MatrixXd XtQ = X.transpose() * group.matQ;
+                        acc.vecSums[g].noalias() += X * XtQ;
+                    }
+                }
+            }
+        };
+
+        for(iBatchStart = 0; iBatchStart < vecIdx.size(); iBatchStart += vecBlocks.size())
+        {
+            qint32 nBatch = qMin(vecBlocks.size(), vecIdx.size() - iBatchStart);
+
+            for(qint32 i = 0; i < nBatch; ++i)
+            {
+                if(!readBlock(vecIdx[iBatchStart + i], vecBlocks[i]))
+                {
+                    printf("Error in FiffProj::%s: Could not read segment %d.\n", sCaller, vecIdx[iBatchStart + i]);
+                    return projs;
+                }
+            }
+
+            QList<QPair<int,int> > blocks;
+            for(qint32 b = 0; b < nBatch; b += SSP_SEGMENTS_PER_THREAD)
+                blocks.append(qMakePair(b, qMin(b + SSP_SEGMENTS_PER_THREAD, nBatch)));
+
+            if(blocks.size() == 1)
+                accumulateBlock(blocks[0]);
+            else
+                QtConcurrent::blockingMap(blocks, accumulateBlock);
+        }
+
+        //
+        // Reduce in thread order
+        //
+        for(qint32 g = 0; g < nGroups; ++g)
+        {
+            vecSums[g] = MatrixXd::Zero(groups[g].iRows, vecSketch[g]);
+            for(qint32 t = 0; t < nThreads; ++t)
+            {
+                vecSums[g] += vecAcc[t].vecSums[g];
+                if(pass == 0)
+                    vecPower[g] += vecAcc[t].vecPower[g];
+            }
+        }
+
+        if(pass == 0)
+        {
+            for(qint32 t = 0; t < nThreads; ++t)
+            {
+                nAccepted += vecAcc[t].iSegments;
+                nRejected += vecAcc[t].iRejected;
+            }
+
+            printf("\t%d of %d segments accepted, %d rejected.\n", nAccepted, nBlocks, nRejected);
+
+            if(nAccepted == 0)
+            {
+                printf("Error in FiffProj::%s: No segments left to compute the projectors.\n", sCaller);
+                return projs;
+            }
+        }
+
+        //
+        // The basis of the next pass, the last pass keeps the basis for the Rayleigh-Ritz step
+        //
+        if(bRandomized && pass < nPasses - 1)
+            for(qint32 g = 0; g < nGroups; ++g)
+                groups[g].matQ = HouseholderQR<MatrixXd>(vecSums[g]).householderQ() * MatrixXd::Identity(groups[g].iRows, vecSketch[g]);
+    }
+
+    //
+    // Leading eigenvectors of the covariance, or of its projection onto the basis of the last pass
+    //
+    for(qint32 g = 0; g < nGroups; ++g)
+    {
+        const SspGroup& group = groups[g];
+
+        MatrixXd matEig;
+        if(bRandomized)
+        {
+            MatrixXd G = group.matQ.transpose() * vecSums[g];
+            matEig = 0.5 * (G + G.transpose());
+        }
+        else
+        {
+            matEig = vecSums[g].selfadjointView<Lower>();
+        }
+
+        SelfAdjointEigenSolver<MatrixXd> es(matEig);
+        MatrixXd matVectors = bRandomized ? MatrixXd(group.matQ * es.eigenvectors()) : es.eigenvectors();
+        qint32 nEig = es.eigenvalues().size();
+
+        for(qint32 k = 0; k < group.iNVectors; ++k)
+        {
+            VectorXd u = matVectors.col(nEig - 1 - k);
+            u.normalize();
+
+            //Fix the sign, the largest entry is positive
+            qint32 iMax;
+            u.cwiseAbs().maxCoeff(&iMax);
+            if(u[iMax] < 0.0)
+                u = -u;
+
+            double dExplained = vecPower[g] > 0.0 ? es.eigenvalues()[nEig - 1 - k] / vecPower[g] : 0.0;
+
+            QString desc = QString("%1-%2-PCA-%3").arg(group.sKind).arg(sDesc).arg(k + 1, 2, 10, QChar('0'));
+            printf("\tAdding projection: %s (exp var=%0.1f%%)\n", desc.toUtf8().constData(), 100.0 * dExplained);
+
+            FiffNamedMatrix t_namedData(1, group.iRows, QStringList(), group.names, u.transpose());
+            projs.append(FiffProj(FIFFV_PROJ_ITEM_FIELD, false, desc, t_namedData));
+        }
+    }
+
+    return projs;
+}
+
+} //NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -279,3 +633,118 @@ fiff_int_t FiffProj::make_projector(const QList<FiffProj>& projs, const QStringL
 
     return nproj;
 }
+
+
+//*************************************************************************************************************
+
+QList<FiffProj> FiffProj::compute_from_raw(FiffRawData& p_raw, float p_fDuration, qint32 p_iNGrad, qint32 p_iNMag, qint32 p_iNEeg, const QMap<QString,double>& p_mapReject, Decomposition p_decomposition)
+{
+    const FiffInfo& info = p_raw.info;
+
+    QList<qint32> t_qListChannels;
+    for(qint32 i = 0; i < info.chs.size(); ++i)
+        t_qListChannels.append(i);
+
+    QVector<SspGroup> groups;
+    QList<qint32> t_qListSel;
+    makeSspGroups(info, t_qListChannels, p_iNGrad, p_iNMag, p_iNEeg, groups, t_qListSel);
+    if(groups.isEmpty())
+    {
+        printf("Error in FiffProj::compute_from_raw: No channels for the requested vectors.\n");
+        return QList<FiffProj>();
+    }
+
+    //
+    // The EOG channels are read for the rejection only
+    //
+    if(p_mapReject.value("eog", 0.0) > 0.0)
+        for(qint32 i = 0; i < info.chs.size(); ++i)
+            if(info.chs[i].kind == FIFFV_EOG_CH && !info.bads.contains(info.chs[i].ch_name))
+                t_qListSel.append(i);
+
+    qint32 nSel = t_qListSel.size();
+    RowVectorXi sel(nSel);
+    VectorXd vecLimit(nSel);
+    for(qint32 k = 0; k < nSel; ++k)
+    {
+        sel[k] = t_qListSel[k];
+
+        const FiffChInfo& ch = info.chs[sel[k]];
+        QString type;
+        if(ch.kind == FIFFV_MEG_CH && ch.unit == FIFF_UNIT_T_M)
+            type = "grad";
+        else if(ch.kind == FIFFV_MEG_CH)
+            type = "mag";
+        else if(ch.kind == FIFFV_EEG_CH)
+            type = "eeg";
+        else if(ch.kind == FIFFV_EOG_CH)
+            type = "eog";
+
+        vecLimit[k] = p_mapReject.value(type, 0.0);
+    }
+
+    qint32 iStep = qRound(p_fDuration * info.sfreq);
+    qint32 nSegments = iStep > 1 ? (p_raw.last_samp - p_raw.first_samp + 1) / iStep : 0;
+    if(nSegments == 0)
+    {
+        printf("Error in FiffProj::compute_from_raw: The raw data is shorter than one segment of %f s.\n", p_fDuration);
+        return QList<FiffProj>();
+    }
+
+    auto readSegment = [&](qint32 iSegment, MatrixXd& matSegment) {
+        fiff_int_t from = p_raw.first_samp + iSegment * iStep;
+        MatrixXd times;
+        return p_raw.read_raw_segment(matSegment, times, from, from + iStep - 1, sel);
+    };
+
+    QString sDesc = QString("Raw-%1-%2").arg(0.0, 0, 'f', 3).arg((p_raw.last_samp - p_raw.first_samp) / info.sfreq, 0, 'f', 3);
+
+    return computeSsp(nSegments, readSegment, vecLimit, groups, p_decomposition, sDesc, "compute_from_raw");
+}
+
+
+//*************************************************************************************************************
+
+QList<FiffProj> FiffProj::compute_from_epochs(const FiffInfo& p_info, const QList<MatrixXd>& p_lEpochs, const RowVectorXi& p_picks, const QString& p_sDesc, qint32 p_iNGrad, qint32 p_iNMag, qint32 p_iNEeg, Decomposition p_decomposition)
+{
+    if(p_lEpochs.isEmpty())
+    {
+        printf("Error in FiffProj::compute_from_epochs: No epochs given.\n");
+        return QList<FiffProj>();
+    }
+
+    qint32 nRows = p_picks.size() > 0 ? p_picks.size() : p_info.chs.size();
+
+    QList<qint32> t_qListChannels;
+    for(qint32 r = 0; r < nRows; ++r)
+        t_qListChannels.append(p_picks.size() > 0 ? p_picks[r] : r);
+
+    QVector<SspGroup> groups;
+    QList<qint32> t_qListSel;
+    makeSspGroups(p_info, t_qListChannels, p_iNGrad, p_iNMag, p_iNEeg, groups, t_qListSel);
+    if(groups.isEmpty())
+    {
+        printf("Error in FiffProj::compute_from_epochs: No channels for the requested vectors.\n");
+        return QList<FiffProj>();
+    }
+
+    //
+    // Row of each selected channel in the epochs
+    //
+    QVector<qint32> vecRows(t_qListSel.size());
+    for(qint32 k = 0; k < t_qListSel.size(); ++k)
+        vecRows[k] = t_qListChannels.indexOf(t_qListSel[k]);
+
+    auto readEpoch = [&](qint32 iEpoch, MatrixXd& matEpoch) {
+        const MatrixXd& epoch = p_lEpochs.at(iEpoch);
+        if(epoch.rows() != nRows)
+            return false;
+
+        matEpoch.resize(vecRows.size(), epoch.cols());
+        for(qint32 k = 0; k < vecRows.size(); ++k)
+            matEpoch.row(k) = epoch.row(vecRows[k]);
+        return true;
+    };
+
+    return computeSsp(p_lEpochs.size(), readEpoch, VectorXd(), groups, p_decomposition, p_sDesc, "compute_from_epochs");
+}
@@ -54,6 +54,8 @@
 #include <QSharedPointer>
 #include <QString>
 #include <QStringList>
+#include <QList>
+#include <QMap>
 
 
 //*************************************************************************************************************
@@ -80,6 +82,15 @@ namespace FIFFLIB
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FiffInfo;
+class FiffRawData;
+
+
 //=============================================================================================================
 /**
 * Provides SSP projector data.
@@ -92,6 +103,12 @@ public:
     typedef QSharedPointer<FiffProj> SPtr;              /**< Shared pointer type for FiffProj. */
     typedef QSharedPointer<const FiffProj> ConstSPtr;   /**< Const shared pointer type for FiffProj. */
 
+    /** Decomposition which compute_from_raw and compute_from_epochs use to find the projection vectors. */
+    enum Decomposition {
+        CovarianceDecomposition,    /**< Eigenvectors of the accumulated covariance of each channel type. */
+        RandomizedDecomposition     /**< Randomized range finding on the data blocks, the covariance is not formed. */
+    };
+
     //=========================================================================================================
     /**
     * Default constructor.
@@ -149,6 +166,52 @@ public:
     */
     static fiff_int_t make_projector(const QList<FiffProj>& projs, const QStringList& ch_names, MatrixXd& proj, const QStringList& bads = defaultQStringList, MatrixXd& U = defaultMatrixXd);
 
+    //=========================================================================================================
+    /**
+    * python compute_proj_raw
+    *
+    * Computes SSP vectors from raw data, e.g. from an empty room recording. The data is cut into segments of
+    * p_fDuration seconds, which are read in batches and accumulated in parallel, each thread into its own sums.
+    * The memory only depends on the number of channels, not on the length of the recording. A segment is
+    * rejected if the peak-to-peak amplitude of a channel exceeds the limit for its type. The data is not
+    * demeaned, the raw data should be high-pass filtered beforehand.
+    *
+    * The vectors of the gradiometers, magnetometers and EEG channels are computed separately. The
+    * RandomizedDecomposition reads the data 2 + SSP_POWER_ITERATIONS times, but keeps only a channels x
+    * (vectors + SSP_OVERSAMPLING) sketch per type instead of the channels x channels covariance.
+    *
+    * @param[in] p_raw              The raw data, projectors and compensators set in it are applied.
+    * @param[in] p_fDuration        Length of the segments in seconds.
+    * @param[in] p_iNGrad           Number of vectors for the gradiometers.
+    * @param[in] p_iNMag            Number of vectors for the magnetometers.
+    * @param[in] p_iNEeg            Number of vectors for the EEG channels.
+    * @param[in] p_mapReject        Peak-to-peak rejection limits of "mag", "grad", "eeg" and "eog" channels.
+    * @param[in] p_decomposition    The decomposition used to find the vectors.
+    *
+    * @return the inactive projection items, empty if no segment was accepted.
+    */
+    static QList<FiffProj> compute_from_raw(FiffRawData& p_raw, float p_fDuration = 1.0f, qint32 p_iNGrad = 2, qint32 p_iNMag = 2, qint32 p_iNEeg = 0, const QMap<QString,double>& p_mapReject = QMap<QString,double>(), Decomposition p_decomposition = CovarianceDecomposition);
+
+    //=========================================================================================================
+    /**
+    * python compute_proj_epochs
+    *
+    * Computes SSP vectors from epochs, e.g. from epochs around ECG or EOG events. The epochs are accumulated like
+    * the segments of compute_from_raw, they are neither demeaned nor checked for artifacts again.
+    *
+    * @param[in] p_info             The measurement info.
+    * @param[in] p_lEpochs          The epochs, channels x samples.
+    * @param[in] p_picks            The channel of each epoch row. If empty, the epochs hold all channels of p_info.
+    * @param[in] p_sDesc            The description prefix of the projection items.
+    * @param[in] p_iNGrad           Number of vectors for the gradiometers.
+    * @param[in] p_iNMag            Number of vectors for the magnetometers.
+    * @param[in] p_iNEeg            Number of vectors for the EEG channels.
+    * @param[in] p_decomposition    The decomposition used to find the vectors.
+    *
+    * @return the inactive projection items, empty if there were no epochs.
+    */
+    static QList<FiffProj> compute_from_epochs(const FiffInfo& p_info, const QList<MatrixXd>& p_lEpochs, const RowVectorXi& p_picks = defaultRowVectorXi, const QString& p_sDesc = QString("Epochs"), qint32 p_iNGrad = 2, qint32 p_iNMag = 2, qint32 p_iNEeg = 2, Decomposition p_decomposition = CovarianceDecomposition);
+
     //=========================================================================================================
     /**
     * overloading the stream out operator<<
@@ -0,0 +1,314 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_compression.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FiffRawCompression class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_compression.h"
+#include "fiff_file.h"
+#include "fiff_tag.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QVector>
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define COMPRESSED_RAW_HEADER   5   /**< type, nchan, nsamp, block size, number of blocks */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+static qint32 word_size(fiff_int_t type)
+{
+    switch(type)
+    {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            return 2;
+        case FIFFT_INT:
+        case FIFFT_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+
+//*************************************************************************************************************
+
+static inline quint32 load_word(const uchar* src, qint32 word)
+{
+    if (word == 2)
+    {
+        quint16 value;
+        memcpy(&value, src, sizeof(quint16));
+        return value;
+    }
+
+    quint32 value;
+    memcpy(&value, src, sizeof(quint32));
+    return value;
+}
+
+
+//*************************************************************************************************************
+
+static inline void store_word(uchar* dst, qint32 word, quint32 value)
+{
+    if (word == 2)
+    {
+        quint16 value16 = static_cast<quint16>(value);
+        memcpy(dst, &value16, sizeof(quint16));
+    }
+    else
+        memcpy(dst, &value, sizeof(quint32));
+}
+
+
+//*************************************************************************************************************
+
+/*
+* Delta codes the channels [first, first+count) along time and stores the differences byte plane by byte
+* plane, most significant bytes first. Slowly varying signals leave the high planes nearly constant, which
+* deflate compresses well. The differences wrap around, so this is exact for any bit pattern.
+*/
+static QByteArray encode_block(const uchar* data, qint32 word, qint32 nchan, qint32 nsamp, qint32 first, qint32 count)
+{
+    const qint64 nval = static_cast<qint64>(count)*nsamp;
+    QByteArray planes(static_cast<int>(nval*word), 0);
+    uchar* dst = reinterpret_cast<uchar*>(planes.data());
+    const quint32 mask = word == 2 ? 0xFFFF : 0xFFFFFFFF;
+
+    qint64 idx = 0;
+    for(qint32 c = first; c < first + count; ++c)
+    {
+        quint32 previous = 0;
+        for(qint32 s = 0; s < nsamp; ++s, ++idx)
+        {
+            const quint32 value = load_word(data + (static_cast<qint64>(s)*nchan + c)*word, word);
+            const quint32 delta = (value - previous) & mask;
+            previous = value;
+
+            for(qint32 b = 0; b < word; ++b)
+                dst[b*nval + idx] = static_cast<uchar>(delta >> (8*(word - 1 - b)));
+        }
+    }
+
+    return planes;
+}
+
+
+//*************************************************************************************************************
+
+static bool decode_block(const QByteArray& planes, qint32 word, qint32 nchan, qint32 nsamp, qint32 first, qint32 count, uchar* data)
+{
+    const qint64 nval = static_cast<qint64>(count)*nsamp;
+    if (planes.size() != nval*word)
+        return false;
+
+    const uchar* src = reinterpret_cast<const uchar*>(planes.constData());
+    const quint32 mask = word == 2 ? 0xFFFF : 0xFFFFFFFF;
+
+    qint64 idx = 0;
+    for(qint32 c = first; c < first + count; ++c)
+    {
+        quint32 value = 0;
+        for(qint32 s = 0; s < nsamp; ++s, ++idx)
+        {
+            quint32 delta = 0;
+            for(qint32 b = 0; b < word; ++b)
+                delta = (delta << 8) | src[b*nval + idx];
+
+            value = (value + delta) & mask;
+            store_word(data + (static_cast<qint64>(s)*nchan + c)*word, word, value);
+        }
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+QByteArray FiffRawCompression::compress(const MatrixXf& buf, qint32 block_size, int level)
+{
+    return compress(FIFFT_FLOAT, buf.data(), static_cast<qint32>(buf.rows()), static_cast<qint32>(buf.cols()), block_size, level);
+}
+
+
+//*************************************************************************************************************
+
+QByteArray FiffRawCompression::compress(fiff_int_t type, const void* data, qint32 nchan, qint32 nsamp, qint32 block_size, int level)
+{
+    const qint32 word = word_size(type);
+    if (word == 0 || nchan <= 0 || nsamp < 0)
+        return QByteArray();
+
+    if (block_size <= 0 || block_size > nchan)
+        block_size = nchan;
+
+    const qint32 nblock = (nchan + block_size - 1)/block_size;
+    const qint32 index = (COMPRESSED_RAW_HEADER + 2*nblock)*static_cast<qint32>(sizeof(fiff_int_t));
+
+    QByteArray result(index, 0);
+    uchar* head = reinterpret_cast<uchar*>(result.data());
+    qToBigEndian<qint32>(type, head);
+    qToBigEndian<qint32>(nchan, head + 4);
+    qToBigEndian<qint32>(nsamp, head + 8);
+    qToBigEndian<qint32>(block_size, head + 12);
+    qToBigEndian<qint32>(nblock, head + 16);
+
+    for(qint32 k = 0; k < nblock; ++k)
+    {
+        const qint32 first = k*block_size;
+        const qint32 count = qMin(block_size, nchan - first);
+        const QByteArray block = qCompress(encode_block(static_cast<const uchar*>(data), word, nchan, nsamp, first, count), level);
+
+        uchar* entry = reinterpret_cast<uchar*>(result.data()) + (COMPRESSED_RAW_HEADER + 2*k)*sizeof(fiff_int_t);
+        qToBigEndian<qint32>(result.size(), entry);
+        qToBigEndian<qint32>(block.size(), entry + 4);
+        result.append(block);
+    }
+
+    return result;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawCompression::read_header(const uchar* data, fiff_int_t& type, fiff_int_t& nchan, fiff_int_t& nsamp)
+{
+    type = qFromBigEndian<qint32>(data);
+    nchan = qFromBigEndian<qint32>(data + 4);
+    nsamp = qFromBigEndian<qint32>(data + 8);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawCompression::decompress(FiffTag& tag, const RowVectorXi& sel)
+{
+    if (tag.type != FIFFT_COMPRESSED_RAW || tag.size() < COMPRESSED_RAW_HEADER*static_cast<qint32>(sizeof(fiff_int_t)))
+    {
+        printf("Not a compressed raw data buffer\n");
+        return false;
+    }
+
+    const uchar* src = reinterpret_cast<const uchar*>(tag.constData());
+    fiff_int_t type, nchan, nsamp;
+    read_header(src, type, nchan, nsamp);
+    const qint32 block_size = qFromBigEndian<qint32>(src + 12);
+    const qint32 nblock = qFromBigEndian<qint32>(src + 16);
+    const qint32 word = word_size(type);
+
+    if (word == 0 || nchan <= 0 || nsamp < 0 || block_size <= 0 || nblock != (nchan + block_size - 1)/block_size
+            || tag.size() < (COMPRESSED_RAW_HEADER + 2*nblock)*static_cast<qint32>(sizeof(fiff_int_t)))
+    {
+        printf("Corrupt compressed raw data buffer header\n");
+        return false;
+    }
+
+    //
+    //   Only decode the blocks containing selected channels
+    //
+    QVector<bool> needed(nblock, sel.size() == 0);
+    for(qint32 k = 0; k < sel.size(); ++k)
+        if (sel[k] >= 0 && sel[k] < nchan)
+            needed[sel[k]/block_size] = true;
+
+    QByteArray result(static_cast<int>(static_cast<qint64>(nchan)*nsamp*word), 0);
+    for(qint32 k = 0; k < nblock; ++k)
+    {
+        if (!needed[k])
+            continue;
+
+        const uchar* entry = src + (COMPRESSED_RAW_HEADER + 2*k)*sizeof(fiff_int_t);
+        const qint32 offset = qFromBigEndian<qint32>(entry);
+        const qint32 size = qFromBigEndian<qint32>(entry + 4);
+        if (offset < 0 || size < 0 || offset + size > tag.size())
+        {
+            printf("Block %d of the compressed raw data buffer is out of range\n", k);
+            return false;
+        }
+
+        const qint32 first = k*block_size;
+        const qint32 count = qMin(block_size, nchan - first);
+        if (!decode_block(qUncompress(src + offset, size), word, nchan, nsamp, first, count, reinterpret_cast<uchar*>(result.data())))
+        {
+            printf("Block %d of the compressed raw data buffer is corrupt\n", k);
+            return false;
+        }
+    }
+
+    tag.type = type;
+    static_cast<QByteArray&>(tag) = result;
+    return true;
+}
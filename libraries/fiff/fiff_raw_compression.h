@@ -0,0 +1,149 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_compression.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the FiffRawCompression class.
+*
+*/
+
+#ifndef FIFF_RAW_COMPRESSION_H
+#define FIFF_RAW_COMPRESSION_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QByteArray>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FiffTag;
+
+
+//=============================================================================================================
+/**
+* Lossless compression of raw data buffers (FIFFT_COMPRESSED_RAW). The channels are grouped into blocks, each
+* block is delta coded along time, byte shuffled and deflated on its own. All integers are stored big endian:
+*
+*   type, nchan, nsamp, block size, number of blocks,
+*   (offset, size) of every block relative to the start of the data (the chunk index),
+*   the compressed blocks.
+*
+* The chunk index allows to decode only the blocks holding the channels which were asked for.
+*
+* @brief Lossless raw data buffer compression
+*/
+class FIFFSHARED_EXPORT FiffRawCompression
+{
+public:
+    //=========================================================================================================
+    /**
+    * Compresses a float raw data buffer.
+    *
+    * @param[in] buf            the buffer (nchan x nsamp)
+    * @param[in] block_size     number of channels in one compressed block
+    * @param[in] level          deflate level (-1 is the zlib default)
+    *
+    * @return the tag data of the compressed buffer
+    */
+    static QByteArray compress(const Eigen::MatrixXf& buf, qint32 block_size = 32, int level = -1);
+
+    //=========================================================================================================
+    /**
+    * Compresses a native endian raw data buffer of the given type (channel index running fastest).
+    *
+    * @param[in] type           the data type: FIFFT_DAU_PACK16, FIFFT_SHORT, FIFFT_INT or FIFFT_FLOAT
+    * @param[in] data           the samples
+    * @param[in] nchan          number of channels
+    * @param[in] nsamp          number of samples
+    * @param[in] block_size     number of channels in one compressed block
+    * @param[in] level          deflate level (-1 is the zlib default)
+    *
+    * @return the tag data of the compressed buffer, empty if the type is not supported
+    */
+    static QByteArray compress(fiff_int_t type, const void* data, qint32 nchan, qint32 nsamp, qint32 block_size = 32, int level = -1);
+
+    //=========================================================================================================
+    /**
+    * Reads the header of compressed tag data.
+    *
+    * @param[in] data       the first bytes of the tag data (at least 12)
+    * @param[out] type      the data type of the original buffer
+    * @param[out] nchan     number of channels
+    * @param[out] nsamp     number of samples
+    */
+    static void read_header(const uchar* data, fiff_int_t& type, fiff_int_t& nchan, fiff_int_t& nsamp);
+
+    //=========================================================================================================
+    /**
+    * Decompresses a FIFFT_COMPRESSED_RAW tag in place. Afterwards the tag holds the native endian samples and
+    * the type of the original buffer, as if an uncompressed buffer had been read.
+    *
+    * @param[in, out] tag   the tag to decompress
+    * @param[in] sel        channels needed, the blocks without any of them are not decoded and set to zero
+    *
+    * @return true if succeeded, false otherwise
+    */
+    static bool decompress(FiffTag& tag, const Eigen::RowVectorXi& sel = defaultRowVectorXi);
+};
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_COMPRESSION_H
@@ -39,10 +39,38 @@
 //=============================================================================================================
 
 #include "fiff_raw_data.h"
+#include "fiff_raw_kernels.h"
+#include "fiff_raw_compression.h"
 #include "fiff_tag.h"
 #include "fiff_stream.h"
 #include "cstdlib"
 
+#include <utils/tracer.h>
+#include <utils/cachefile.h>
+#include <utils/cachelocation.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -51,6 +79,67 @@
 using namespace FIFFLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+template<typename T>
+static inline T from_big_endian(const uchar* src)
+{
+    return qFromBigEndian<T>(src);
+}
+
+
+//*************************************************************************************************************
+
+template<>
+inline float from_big_endian<float>(const uchar* src)
+{
+    quint32 word = qFromBigEndian<quint32>(src);
+    float value;
+    memcpy(&value, &word, sizeof(float));
+    return value;
+}
+
+
+//*************************************************************************************************************
+
+/*
+* Converts samples [first_pick, first_pick+picksamp) of a big endian raw buffer (nchan x nsamp, channel
+* index running fastest) to double and writes them to the columns starting at dest. The optional scale holds
+* one factor per output row, the optional selection picks the channels. Without selection the FiffRawKernels
+* of the given FIFF type are used.
+*/
+template<typename T>
+static void dequantize_buffer(fiff_int_t type, const uchar* buffer, qint32 nchan, qint32 first_pick, qint32 picksamp, const RowVectorXi& sel, const double* scale, MatrixXd& out, qint32 dest)
+{
+    const qint64 stride = static_cast<qint64>(nchan)*sizeof(T);
+    const qint32 nrow = static_cast<qint32>(sel.size());
+
+    for(qint32 s = 0; s < picksamp; ++s)
+    {
+        const uchar* sample = buffer + (first_pick + s)*stride;
+        double* col = out.data() + static_cast<qint64>(dest + s)*out.rows();
+
+        //
+        //   All channels of a sample are contiguous, this is done by the vectorized kernels
+        //
+        if (sel.size() == 0)
+        {
+            FiffRawKernels::dequantize(type, sample, nchan, scale, col);
+            continue;
+        }
+
+        for(qint32 r = 0; r < nrow; ++r)
+        {
+            const double value = static_cast<double>(from_big_endian<T>(sample + sel[r]*sizeof(T)));
+            col[r] = scale ? scale[r]*value : value;
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -59,6 +148,7 @@ using namespace FIFFLIB;
 FiffRawData::FiffRawData()
 : first_samp(-1)
 , last_samp(-1)
+, rawdir_nsamp(-1)
 {
 
 }
@@ -69,6 +159,7 @@ FiffRawData::FiffRawData()
 FiffRawData::FiffRawData(QIODevice &p_IODevice)
 : first_samp(-1)
 , last_samp(-1)
+, rawdir_nsamp(-1)
 {
     //setup FiffRawData object
     if(!FiffStream::setup_read_raw(p_IODevice, *this))
@@ -83,14 +174,18 @@ FiffRawData::FiffRawData(QIODevice &p_IODevice)
 //*************************************************************************************************************
 
 FiffRawData::FiffRawData(const FiffRawData &p_FiffRawData)
-: file(p_FiffRawData.file)
+: split_device(p_FiffRawData.split_device)
+, file(p_FiffRawData.file)
 , info(p_FiffRawData.info)
 , first_samp(p_FiffRawData.first_samp)
 , last_samp(p_FiffRawData.last_samp)
 , cals(p_FiffRawData.cals)
 , rawdir(p_FiffRawData.rawdir)
+, rawdir_last(p_FiffRawData.rawdir_last)
+, rawdir_nsamp(p_FiffRawData.rawdir_nsamp)
 , proj(p_FiffRawData.proj)
 , comp(p_FiffRawData.comp)
+, splits(copy_splits(p_FiffRawData.splits))
 {
 
 }
@@ -104,6 +199,27 @@ FiffRawData::~FiffRawData()
 }
 
 
+//*************************************************************************************************************
+
+QList<FiffRawData::SPtr> FiffRawData::copy_splits(const QList<FiffRawData::SPtr>& p_splits)
+{
+    //
+    //  The copies read through files of their own, a copy can be used on another thread than the original
+    //
+    QList<FiffRawData::SPtr> t_splits;
+    for (qint32 k = 0; k < p_splits.size(); ++k)
+    {
+        FiffRawData::SPtr t_pPart(new FiffRawData(*p_splits[k]));
+        QSharedPointer<QFile> t_pFile(new QFile(t_pPart->info.filename));
+        t_pPart->file = FiffStream::SPtr(new FiffStream(t_pFile.data()));
+        t_pPart->split_device = t_pFile;
+        t_splits.append(t_pPart);
+    }
+
+    return t_splits;
+}
+
+
 //*************************************************************************************************************
 
 void FiffRawData::clear()
@@ -113,8 +229,11 @@ void FiffRawData::clear()
     last_samp = -1;
     cals = RowVectorXd();
     rawdir.clear();
+    rawdir_last.clear();
+    rawdir_nsamp = -1;
     proj = MatrixXd();
     comp.clear();
+    splits.clear();
 }
 
 
@@ -122,11 +241,26 @@ void FiffRawData::clear()
 
 bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t from, fiff_int_t to, const RowVectorXi& sel, bool do_debug)
 {
-    bool projAvailable = true;
+    MNE_TRACE_SCOPE("FiffRawData::read_raw_segment", "fiff");
 
-    if (this->proj.size() == 0)
-        projAvailable = false;
+    return read_segment(data, times, Q_NULLPTR, from, to, sel, do_debug);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix<double>& multSegment, fiff_int_t from, fiff_int_t to, const RowVectorXi& sel, bool do_debug)
+{
+    MNE_TRACE_SCOPE("FiffRawData::read_raw_segment", "fiff");
+
+    return read_segment(data, times, &multSegment, from, to, sel, do_debug);
+}
+
+
+//*************************************************************************************************************
 
+bool FiffRawData::read_segment(MatrixXd& data, MatrixXd& times, SparseMatrix<double>* multSegment, fiff_int_t from, fiff_int_t to, const RowVectorXi& sel, bool do_debug)
+{
     if(from == -1)
         from = this->first_samp;
     if(to == -1)
@@ -144,6 +278,25 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
         printf("No data in this range\n");
         return false;
     }
+    //
+    //  Segments which reach into the split files are read part by part
+    //
+    if (!this->splits.isEmpty() && to >= this->splits.first()->first_samp)
+        return read_split_segment(data, times, multSegment, from, to, sel, do_debug);
+
+    return read_part_segment(data, times, multSegment, from, to, sel, this->proj, this->comp, do_debug);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawData::read_part_segment(MatrixXd& data, MatrixXd& times, SparseMatrix<double>* multSegment, fiff_int_t from, fiff_int_t to, const RowVectorXi& sel, const MatrixXd& p_proj, const FiffCtfComp& p_comp, bool do_debug)
+{
+    bool projAvailable = true;
+
+    if (p_proj.size() == 0)
+        projAvailable = false;
+
     printf("Reading %d ... %d  =  %9.3f ... %9.3f secs...", from, to, ((float)from)/this->info.sfreq, ((float)to)/this->info.sfreq);
     //
     //  Initialize the data and calibration vector
@@ -166,28 +319,28 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
     //
     if (sel.size() == 0)
     {
-        data = MatrixXd(nchan, to-from+1);
+        data.resize(nchan, to-from+1);
 //            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
+        if (projAvailable || p_comp.kind != -1)
         {
             if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
+                mult_full = p_comp.data->data*cal;
+            else if (p_comp.kind == -1)
+                mult_full = p_proj*cal;
             else
-                mult_full = this->proj*this->comp.data->data*cal;
+                mult_full = p_proj*p_comp.data->data*cal;
         }
     }
     else
     {
-        data = MatrixXd(sel.size(),to-from+1);
+        data.resize(sel.size(),to-from+1);
 //            data->setZero();
 
         MatrixXd selVect(sel.size(), nchan);
 
         selVect.setZero();
 
-        if (!projAvailable && this->comp.kind == -1)
+        if (!projAvailable && p_comp.kind == -1)
         {
             tripletList.clear();
             tripletList.reserve(sel.size());
@@ -202,13 +355,13 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
             {
                 qDebug() << "This has to be debugged! #1";
                 for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
+                    selVect.row(i) = p_comp.data->data.block(sel[i],0,1,nchan);
                 mult_full = selVect*cal;
             }
-            else if (this->comp.kind == -1)
+            else if (p_comp.kind == -1)
             {
                 for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+                    selVect.row(i) = p_proj.block(sel[i],0,1,nchan);
 
                 mult_full = selVect*cal;
             }
@@ -216,9 +369,9 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
             {
                 qDebug() << "This has to be debugged! #3";
                 for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+                    selVect.row(i) = p_proj.block(sel[i],0,1,nchan);
 
-                mult_full = selVect*this->comp.data->data*cal;
+                mult_full = selVect*p_comp.data->data*cal;
             }
         }
     }
@@ -254,9 +407,32 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
         fid = this->file;
     }
 
+    //
+    //  Calibration factors for the direct dequantization from a memory mapped file
+    //
+    bool t_bMapped = fid->is_mapped();
+    VectorXd scale;
+    if (t_bMapped && mult.cols() == 0)
+    {
+        if (sel.size() == 0)
+            scale = this->cals.transpose();
+        else
+        {
+            scale.resize(sel.size());
+            for(i = 0; i < sel.size(); ++i)
+                scale[i] = this->cals[sel[i]];
+        }
+    }
+
+    //
+    //  Start with the buffer containing the first sample instead of walking the whole directory
+    //
+    if (this->rawdir_last.size() != this->rawdir.size())
+        this->build_rawdir_index();
+
     MatrixXd one;
     fiff_int_t first_pick, last_pick, picksamp;
-    for(k = 0; k < this->rawdir.size(); ++k)
+    for(k = this->find_rawdir_entry(from); k < this->rawdir.size(); ++k)
     {
         FiffRawDir thisRawDir = this->rawdir[k];
         //
@@ -264,7 +440,17 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
         //
         if (thisRawDir.last > from)
         {
-            if (thisRawDir.ent->kind == -1)
+            bool t_bSkip = thisRawDir.ent.isNull() || thisRawDir.ent->kind == -1;
+            bool t_bFromMap = t_bMapped && !t_bSkip && thisRawDir.ent->type != FIFFT_COMPRESSED_RAW;
+            if (t_bFromMap)
+            {
+                //
+                //  Nothing to read here, the picked samples are dequantized from the mapping below
+                //
+                if(do_debug)
+                    printf("P");
+            }
+            else if (t_bSkip)
             {
                 //
                 //  Take the easy route: skip is translated to zeros
@@ -283,6 +469,11 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
                 FiffTag::SPtr t_pTag;
                 fid->read_tag(t_pTag, thisRawDir.ent->pos);
                 //
+                //   Compressed buffers are decoded to their original type, only the selected channels are needed
+                //
+                if (t_pTag->type == FIFFT_COMPRESSED_RAW && !FiffRawCompression::decompress(*t_pTag, mult.cols() == 0 ? sel : defaultRowVectorXi))
+                    return false;
+                //
                 //   Depending on the state of the projection and selection
                 //   we proceed a little bit differently
                 //
@@ -415,10 +606,18 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
 
             if (picksamp > 0)
             {
+                if (t_bFromMap)
+                {
+                    if (!this->read_mapped_buffer(thisRawDir, first_pick, picksamp, sel, scale, mult, data, dest, one))
+                        return false;
+                }
+                else
+                {
 //                    for(r = 0; r < data->rows(); ++r)
 //                        for(c = 0; c < picksamp; ++c)
 //                            (*data)(r,dest + c) = one(r,first_pick + c);
-                data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
+                    data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
+                }
 
                 dest += picksamp;
             }
@@ -433,9 +632,16 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
         }
     }
 
+    if(multSegment)
+    {
+        if(mult.cols()==0)
+            *multSegment = cal;
+        else
+            *multSegment = mult;
+    }
 //        fclose(fid);
 
-    times = MatrixXd(1, to-from+1);
+    times.resize(1, to-from+1);
 
     for (i = 0; i < times.cols(); ++i)
         times(0, i) = ((float)(from+i)) / this->info.sfreq;
@@ -446,328 +652,250 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
 
 //*************************************************************************************************************
 
-bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix<double>& multSegment, fiff_int_t from, fiff_int_t to, const RowVectorXi& sel, bool do_debug)
+void FiffRawData::build_rawdir_index()
 {
-    bool projAvailable = true;
-
-    if (this->proj.size() == 0)
-        projAvailable = false;
+    rawdir_last.resize(rawdir.size());
+    rawdir_nsamp = rawdir.isEmpty() ? -1 : rawdir[0].nsamp;
 
-    if(from == -1)
-        from = this->first_samp;
-    if(to == -1)
-        to = this->last_samp;
-    //
-    //  Initial checks
-    //
-    if(from < this->first_samp)
-        from = this->first_samp;
-    if(to > this->last_samp)
-        to = this->last_samp;
-    //
-    if(from > to)
+    for(qint32 k = 0; k < rawdir.size(); ++k)
     {
-        printf("No data in this range\n");
-        return false;
+        rawdir_last[k] = rawdir[k].last;
+
+        //
+        //  Direct arithmetic is only possible without gaps and with equally sized buffers, the last one may be shorter
+        //
+        if (rawdir[k].first != rawdir[0].first + k*rawdir_nsamp || (rawdir[k].nsamp != rawdir_nsamp && k < rawdir.size() - 1))
+            rawdir_nsamp = -1;
     }
-    printf("Reading %d ... %d  =  %9.3f ... %9.3f secs...", from, to, ((float)from)/this->info.sfreq, ((float)to)/this->info.sfreq);
-    //
-    //  Initialize the data and calibration vector
-    //
-    qint32 nchan = this->info.nchan;
-    qint32 dest  = 0;//1;
-    qint32 i, k, r;
+}
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(nchan);
-    for(i = 0; i < nchan; ++i)
-        tripletList.push_back(T(i, i, this->cals[i]));
 
-    SparseMatrix<double> cal(nchan, nchan);
-    cal.setFromTriplets(tripletList.begin(), tripletList.end());
-//    cal.makeCompressed();
+//*************************************************************************************************************
 
-    MatrixXd mult_full;
-    //
-    if (sel.size() == 0)
+qint32 FiffRawData::find_rawdir_entry(fiff_int_t sample) const
+{
+    if (rawdir.isEmpty() || sample <= rawdir[0].last)
+        return 0;
+
+    if (rawdir_nsamp > 0)
     {
-        data = MatrixXd(nchan, to-from+1);
-//            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
-        {
-            if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
-            else
-                mult_full = this->proj*this->comp.data->data*cal;
-        }
+        qint32 k = (sample - rawdir[0].first)/rawdir_nsamp;
+        return k < rawdir.size() ? k : rawdir.size();
     }
-    else
-    {
-        data = MatrixXd(sel.size(),to-from+1);
-//            data->setZero();
 
-        MatrixXd selVect(sel.size(), nchan);
+    QVector<fiff_int_t>::const_iterator it = std::lower_bound(rawdir_last.constBegin(), rawdir_last.constEnd(), sample);
+    return static_cast<qint32>(it - rawdir_last.constBegin());
+}
 
-        selVect.setZero();
 
-        if (!projAvailable && this->comp.kind == -1)
-        {
-            tripletList.clear();
-            tripletList.reserve(sel.size());
-            for(i = 0; i < sel.size(); ++i)
-                tripletList.push_back(T(i, i, this->cals[sel[i]]));
-            cal = SparseMatrix<double>(sel.size(), sel.size());
-            cal.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-        else
-        {
-            if (!projAvailable)
-            {
-                qDebug() << "This has to be debugged! #1";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
-                mult_full = selVect*cal;
-            }
-            else if (this->comp.kind == -1)
-            {
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+//*************************************************************************************************************
 
-                mult_full = selVect*cal;
-            }
-            else
-            {
-                qDebug() << "This has to be debugged! #3";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+QString FiffRawData::rawdir_cache_name(const QString& fileName)
+{
+    return CacheLocation::filePath(fileName, QString(".rawdir"));
+}
 
-                mult_full = selVect*this->comp.data->data*cal;
-            }
-        }
+
+//*************************************************************************************************************
+
+QByteArray FiffRawData::rawdir_cache_key(const QString& fileName, const FiffId& id)
+{
+    QByteArray t_key = CacheFile::sourceKey(fileName);
+    if (t_key.isEmpty())
+        return t_key;
+
+    QDataStream t_stream(&t_key, QIODevice::Append);
+    t_stream.setVersion(QDataStream::Qt_5_0);
+    t_stream << id.version << id.machid[0] << id.machid[1] << id.time.secs << id.time.usecs;
+
+    return t_key;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawData::write_rawdir_cache(const QString& fileName) const
+{
+    QByteArray t_key = rawdir_cache_key(fileName, file ? file->id() : FiffId());
+    if (t_key.isEmpty())
+        return false;
+
+    QByteArray t_payload;
+    QDataStream t_stream(&t_payload, QIODevice::WriteOnly);
+    t_stream.setVersion(QDataStream::Qt_5_0);
+    t_stream << first_samp << last_samp << (qint32)rawdir.size();
+
+    for(qint32 k = 0; k < rawdir.size(); ++k)
+    {
+        const FiffRawDir& t_rawDir = rawdir[k];
+        if (t_rawDir.ent)
+            t_stream << t_rawDir.ent->kind << t_rawDir.ent->type << t_rawDir.ent->size << t_rawDir.ent->pos;
+        else
+            t_stream << (fiff_int_t)-1 << (fiff_int_t)-1 << (fiff_int_t)-1 << (fiff_int_t)-1;
+        t_stream << t_rawDir.first << t_rawDir.last << t_rawDir.nsamp;
     }
 
-    //
-    // Make mult sparse
-    //
-    tripletList.clear();
-    tripletList.reserve(mult_full.rows()*mult_full.cols());
-    for(i = 0; i < mult_full.rows(); ++i)
-        for(k = 0; k < mult_full.cols(); ++k)
-            if(mult_full(i,k) != 0)
-                tripletList.push_back(T(i, k, mult_full(i,k)));
+    return t_stream.status() == QDataStream::Ok && CacheFile::write(rawdir_cache_name(fileName), QString("rawdir"), t_key, t_payload);
+}
 
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
-    if(tripletList.size() > 0)
-        mult.setFromTriplets(tripletList.begin(), tripletList.end());
-//    mult.makeCompressed();
 
-    //
+//*************************************************************************************************************
 
-    FiffStream::SPtr fid;
-    if (!this->file->device()->isOpen())
+bool FiffRawData::read_rawdir_cache(const QString& fileName, const FiffId& id)
+{
+    QByteArray t_key = rawdir_cache_key(fileName, id);
+    QByteArray t_payload;
+    if (t_key.isEmpty() || !CacheFile::read(rawdir_cache_name(fileName), QString("rawdir"), t_key, t_payload))
+        return false;
+
+    QDataStream t_stream(t_payload);
+    t_stream.setVersion(QDataStream::Qt_5_0);
+
+    fiff_int_t t_first, t_last;
+    qint32 nent;
+    t_stream >> t_first >> t_last >> nent;
+    if (t_stream.status() != QDataStream::Ok || nent < 0)
+        return false;
+
+    QList<FiffRawDir> t_rawdir;
+    t_rawdir.reserve(nent);
+    for(qint32 k = 0; k < nent; ++k)
     {
-        if (!this->file->device()->open(QIODevice::ReadOnly))
-        {
-            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
-        }
-        fid = this->file;
+        FiffRawDir t_rawDir;
+        FiffDirEntry::SPtr ent(new FiffDirEntry);
+        t_stream >> ent->kind >> ent->type >> ent->size >> ent->pos;
+        t_stream >> t_rawDir.first >> t_rawDir.last >> t_rawDir.nsamp;
+        t_rawDir.ent = ent;
+        t_rawdir.append(t_rawDir);
     }
-    else
+
+    if (t_stream.status() != QDataStream::Ok)
+        return false;
+
+    first_samp = t_first;
+    last_samp = t_last;
+    rawdir = t_rawdir;
+    build_rawdir_index();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawData::read_mapped_buffer(const FiffRawDir& rawDir, fiff_int_t first_pick, fiff_int_t picksamp, const RowVectorXi& sel, const VectorXd& scale, const SparseMatrix<double>& mult, MatrixXd& data, fiff_int_t dest, MatrixXd& work)
+{
+    qint32 nchan = this->info.nchan;
+    fiff_int_t type = rawDir.ent->type;
+
+    qint32 word;
+    switch(type)
     {
-        fid = this->file;
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            word = 2;
+            break;
+        case FIFFT_INT:
+        case FIFFT_FLOAT:
+            word = 4;
+            break;
+        default:
+            printf("Data Storage Format not known jet [4]!! Type: %d\n", type);
+            return false;
     }
 
-    MatrixXd one;
-    fiff_int_t first_pick, last_pick, picksamp;
-    for(k = 0; k < this->rawdir.size(); ++k)
+    const fiff_long_t nbytes = static_cast<fiff_long_t>(nchan)*rawDir.nsamp*word;
+    const uchar* buffer = this->file->mapped_data(static_cast<fiff_long_t>(rawDir.ent->pos) + FIFFC_DATA_OFFSET, nbytes);
+    if (!buffer || rawDir.ent->size < nbytes)
     {
-        FiffRawDir thisRawDir = this->rawdir[k];
-        //
-        //  Do we need this buffer
-        //
-        if (thisRawDir.last > from)
-        {
-            if (thisRawDir.ent->kind == -1)
-            {
-                //
-                //  Take the easy route: skip is translated to zeros
-                //
-                if(do_debug)
-                    printf("S");
-                if (sel.cols() <= 0)
-                    one.resize(nchan,thisRawDir.nsamp);
-                else
-                    one.resize(sel.cols(),thisRawDir.nsamp);
+        printf("Raw data buffer at %d is outside of the mapped file %s\n", rawDir.ent->pos, this->info.filename.toUtf8().constData());
+        return false;
+    }
 
-                one.setZero();
-            }
-            else
-            {
-                FiffTag::SPtr t_pTag;
-                fid->read_tag(t_pTag, thisRawDir.ent->pos);
-                //
-                //   Depending on the state of the projection and selection
-                //   we proceed a little bit differently
-                //
-                if (mult.cols() == 0)
-                {
-                    if (sel.cols() == 0)
-                    {
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                            one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_INT)
-                            one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                            one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_SHORT)
-                            one = cal*(Map< MatrixShort >( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else
-                            printf("Data Storage Format not known jet [1]!! Type: %d\n", t_pTag->type);
-                    }
-                    else
-                    {
+    //
+    //   Without projection we write the calibrated values straight to the output,
+    //   otherwise the raw values are converted into the workspace first and multiplied afterwards
+    //
+    MatrixXd& out = mult.cols() == 0 ? data : work;
+    const double* factors = mult.cols() == 0 ? scale.data() : Q_NULLPTR;
+    const RowVectorXi& pick = mult.cols() == 0 ? sel : defaultRowVectorXi;
+    fiff_int_t col = dest;
 
-                        //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
-                        MatrixXd newData(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
+    if (mult.cols() != 0)
+    {
+        work.resize(nchan, picksamp);
+        col = 0;
+    }
 
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
+    switch(type)
+    {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            dequantize_buffer<qint16>(type, buffer, nchan, first_pick, picksamp, pick, factors, out, col);
+            break;
+        case FIFFT_INT:
+            dequantize_buffer<qint32>(type, buffer, nchan, first_pick, picksamp, pick, factors, out, col);
+            break;
+        case FIFFT_FLOAT:
+            dequantize_buffer<float>(type, buffer, nchan, first_pick, picksamp, pick, factors, out, col);
+            break;
+    }
 
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_INT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
+    if (mult.cols() != 0)
+        data.block(0, dest, data.rows(), picksamp) = mult*work;
 
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+    return true;
+}
 
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_SHORT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixShort > ( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
 
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else
-                        {
-                            printf("Data Storage Format not known jet [2]!! Type: %d\n", t_pTag->type);
-                        }
+//*************************************************************************************************************
 
-                        one = cal*newData;
-                    }
-                }
-                else
-                {
-                    if (t_pTag->type == FIFFT_DAU_PACK16)
-                        one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_INT)
-                        one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_FLOAT)
-                        one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else
-                        printf("Data Storage Format not known jet [3]!! Type: %d\n", t_pTag->type);
-                }
-            }
-            //
-            //  The picking logic is a bit complicated
-            //
-            if (to >= thisRawDir.last && from <= thisRawDir.first)
-            {
-                //
-                //  We need the whole buffer
-                //
-                first_pick = 0;//1;
-                last_pick  = thisRawDir.nsamp - 1;
-                if (do_debug)
-                    printf("W");
-            }
-            else if (from > thisRawDir.first)
-            {
-                first_pick = from - thisRawDir.first;// + 1;
-                if(to < thisRawDir.last)
-                {
-                    //
-                    //  Something from the middle
-                    //
-//                    qDebug() << "This needs to be debugged!";
-                    last_pick = thisRawDir.nsamp + to - thisRawDir.last - 1;//is this alright?
-                    if (do_debug)
-                        printf("M");
-                }
-                else
-                {
-                    //
-                    //  From the middle to the end
-                    //
-                    last_pick = thisRawDir.nsamp - 1;
-                    if (do_debug)
-                        printf("E");
-                }
-            }
-            else
-            {
-                //
-                //  From the beginning to the middle
-                //
-                first_pick = 0;//1;
-                last_pick  = to - thisRawDir.first;// + 1;
-                if (do_debug)
-                    printf("B");
-            }
-            //
-            //  Now we are ready to pick
-            //
-            picksamp = last_pick - first_pick + 1;
+bool FiffRawData::read_split_segment(MatrixXd& data, MatrixXd& times, SparseMatrix<double>* multSegment, fiff_int_t from, fiff_int_t to, const RowVectorXi& sel, bool do_debug)
+{
+    QList<MatrixXd> t_listData;
+    MatrixXd one, t_times;
+    bool t_bOk = true;
 
-            if(do_debug)
-            {
-                qDebug() << "first_pick: " << first_pick;
-                qDebug() << "last_pick: " << last_pick;
-                qDebug() << "picksamp: " << picksamp;
-            }
+    //
+    //  Every part is read with its own range and the projection and compensator of this object
+    //
+    if (from < this->splits.first()->first_samp)
+    {
+        if (!read_part_segment(one, t_times, multSegment, from, this->splits.first()->first_samp - 1, sel, this->proj, this->comp, do_debug))
+            return false;
+        t_listData.append(one);
+    }
 
-            if (picksamp > 0)
-            {
-//                    for(r = 0; r < data->rows(); ++r)
-//                        for(c = 0; c < picksamp; ++c)
-//                            (*data)(r,dest + c) = one(r,first_pick + c);
-                data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
+    for (qint32 k = 0; k < this->splits.size() && t_bOk; ++k)
+    {
+        FiffRawData::SPtr t_pPart = this->splits[k];
+        if (t_pPart->last_samp < from || t_pPart->first_samp > to)
+            continue;
 
-                dest += picksamp;
-            }
-        }
-        //
-        //  Done?
-        //
-        if (thisRawDir.last >= to)
-        {
-            printf(" [done]\n");
-            break;
-        }
+        fiff_int_t t_iFrom = qMax(from, t_pPart->first_samp);
+        fiff_int_t t_iTo = qMin(to, t_pPart->last_samp);
+
+        t_bOk = t_pPart->read_part_segment(one, t_times, multSegment, t_iFrom, t_iTo, sel, this->proj, this->comp, do_debug);
+        if (t_bOk)
+            t_listData.append(one);
     }
 
-    if(mult.cols()==0)
-        multSegment = cal;
-    else
-        multSegment = mult;
-//        fclose(fid);
+    if (!t_bOk || t_listData.isEmpty())
+        return false;
 
-    times = MatrixXd(1, to-from+1);
+    //
+    //  Concatenate the parts
+    //
+    data.resize(t_listData.first().rows(), to-from+1);
+    qint32 dest = 0;
+    for (qint32 k = 0; k < t_listData.size(); ++k)
+    {
+        data.block(0, dest, data.rows(), t_listData[k].cols()) = t_listData[k];
+        dest += t_listData[k].cols();
+    }
 
-    for (i = 0; i < times.cols(); ++i)
+    times.resize(1, to-from+1);
+    for (qint32 i = 0; i < times.cols(); ++i)
         times(0, i) = ((float)(from+i)) / this->info.sfreq;
 
     return true;
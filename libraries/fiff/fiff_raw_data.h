@@ -61,8 +61,10 @@
 // Qt INCLUDES
 //=============================================================================================================
 
+#include <QIODevice>
 #include <QList>
 #include <QSharedPointer>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -104,7 +106,8 @@ public:
 
     //=========================================================================================================
     /**
-    * Copy constructor.
+    * Copy constructor. The file of the first part is shared, the parts of a split recording are copied with
+    * files of their own.
     *
     * @param[in] p_FiffRawData  FIFF raw measurement which should be copied
     */
@@ -153,6 +156,9 @@ public:
     * @param[in] to         last sample to include. If omitted, defaults to the last sample in data (optional)
     * @param[in] sel        channel selection vector (optional)
     *
+    * If the file stream was memory mapped (see FiffStream::map_file) the samples are dequantized straight
+    * from the mapping into data, without reading the buffers as tags.
+    *
     * @return true if succeeded, false otherwise
     */
     bool read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t from = -1, fiff_int_t to = -1, const RowVectorXi& sel = defaultRowVectorXi, bool do_debug = false);
@@ -190,15 +196,163 @@ public:
     */
     bool read_raw_segment_times(MatrixXd& data, MatrixXd& times, float from, float to, const RowVectorXi& sel = defaultRowVectorXi);
 
+    //=========================================================================================================
+    /**
+    * Builds the sample index of the raw directory. Has to be called after rawdir was changed,
+    * read_raw_segment rebuilds the index on its own if it is out of date.
+    */
+    void build_rawdir_index();
+
+    //=========================================================================================================
+    /**
+    * Looks up the raw directory entry which contains a sample. If all buffers are of equal length the
+    * entry is computed directly, otherwise it is found by a binary search.
+    *
+    * @param[in] sample     The sample of interest
+    *
+    * @return the index into rawdir, rawdir.size() if the sample is beyond the last buffer
+    */
+    qint32 find_rawdir_entry(fiff_int_t sample) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the name of the raw directory cache which belongs to a fiff file, see UTILSLIB::CacheLocation.
+    *
+    * @param[in] fileName   The fiff file name
+    *
+    * @return the name of the cache file
+    */
+    static QString rawdir_cache_name(const QString& fileName);
+
+    //=========================================================================================================
+    /**
+    * Writes first_samp, last_samp and rawdir to the cache file in the directory of UTILSLIB::CacheLocation,
+    * the directory of the fiff file is not written to. The cache is a UTILSLIB::CacheFile, tagged with the
+    * file id, size and modification time of the fiff file.
+    *
+    * @param[in] fileName   The fiff file name
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool write_rawdir_cache(const QString& fileName) const;
+
+    //=========================================================================================================
+    /**
+    * Reads first_samp, last_samp and rawdir from the cache file. Fails if the cache does not exist or does
+    * not match the file anymore.
+    *
+    * @param[in] fileName   The fiff file name
+    * @param[in] id         The file id of the fiff file
+    *
+    * @return true if the cache was valid and loaded, false otherwise
+    */
+    bool read_rawdir_cache(const QString& fileName, const FiffId& id);
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns the key of the raw directory cache: size and modification time and the file id of the fiff file.
+    *
+    * @param[in] fileName   The fiff file name
+    * @param[in] id         The file id of the fiff file
+    *
+    * @return the key, empty if the file does not exist
+    */
+    static QByteArray rawdir_cache_key(const QString& fileName, const FiffId& id);
+
+    //=========================================================================================================
+    /**
+    * Copies the parts of a split recording, each copy reads through a file of its own.
+    *
+    * @param[in] p_splits       The parts to copy
+    *
+    * @return the copied parts
+    */
+    static QList<FiffRawData::SPtr> copy_splits(const QList<FiffRawData::SPtr>& p_splits);
+
+    //=========================================================================================================
+    /**
+    * Checks the range and reads the segment from this part or, if it reaches into the split files, part by part.
+    *
+    * @param[out] data          returns the data matrix (channels x samples)
+    * @param[out] times         returns the time values corresponding to the samples
+    * @param[out] multSegment   used multiplication matrix, NULL if not requested
+    * @param[in] from           first sample to include, -1 for the first sample
+    * @param[in] to             last sample to include, -1 for the last sample
+    * @param[in] sel            channel selection vector
+    * @param[in] do_debug       print the picking details
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_segment(MatrixXd& data, MatrixXd& times, SparseMatrix<double>* multSegment, fiff_int_t from, fiff_int_t to, const RowVectorXi& sel, bool do_debug);
+
+    //=========================================================================================================
+    /**
+    * Reads a segment which lies within the raw directory of this part.
+    *
+    * @param[out] data          returns the data matrix (channels x samples)
+    * @param[out] times         returns the time values corresponding to the samples
+    * @param[out] multSegment   used multiplication matrix, NULL if not requested
+    * @param[in] from           first sample to include
+    * @param[in] to             last sample to include
+    * @param[in] sel            channel selection vector
+    * @param[in] p_proj         SSP operator to apply, empty if none
+    * @param[in] p_comp         Compensator to apply, kind -1 if none
+    * @param[in] do_debug       print the picking details
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_part_segment(MatrixXd& data, MatrixXd& times, SparseMatrix<double>* multSegment, fiff_int_t from, fiff_int_t to, const RowVectorXi& sel, const MatrixXd& p_proj, const FiffCtfComp& p_comp, bool do_debug);
+
+    //=========================================================================================================
+    /**
+    * Dequantizes the picked samples of a raw data buffer straight from the memory mapped file
+    * (see FiffStream::map_file) into the output matrix.
+    *
+    * @param[in] rawDir         The raw directory entry of the buffer
+    * @param[in] first_pick     First sample of the buffer to pick
+    * @param[in] picksamp       Number of samples to pick
+    * @param[in] sel            Channel selection, used if no mult is given
+    * @param[in] scale          Calibration factor per output row, used if no mult is given
+    * @param[in] mult           Combined compensator, projection and calibration, empty if not used
+    * @param[out] data          The output matrix
+    * @param[in] dest           First column of data to write to
+    * @param[in, out] work      Workspace for the raw values when mult is applied
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_mapped_buffer(const FiffRawDir& rawDir, fiff_int_t first_pick, fiff_int_t picksamp, const RowVectorXi& sel, const VectorXd& scale, const SparseMatrix<double>& mult, MatrixXd& data, fiff_int_t dest, MatrixXd& work);
+
+    //=========================================================================================================
+    /**
+    * Reads a segment which reaches into the split files. The samples of every part are read on their own with
+    * the projection and compensator of this object, which are passed to the part, and concatenated.
+    *
+    * @param[out] data          returns the data matrix (channels x samples)
+    * @param[out] times         returns the time values corresponding to the samples
+    * @param[out] multSegment   used multiplication matrix of the last part read, NULL if not requested
+    * @param[in] from           first sample to include
+    * @param[in] to             last sample to include
+    * @param[in] sel            channel selection vector
+    * @param[in] do_debug       print the picking details
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_split_segment(MatrixXd& data, MatrixXd& times, SparseMatrix<double>* multSegment, fiff_int_t from, fiff_int_t to, const RowVectorXi& sel, bool do_debug);
+
 public:
+    QSharedPointer<QIODevice> split_device; /**< The file of a split part, owned by the part, NULL for the first part. */
     FiffStream::SPtr file;      /**< replaces fid */
     FiffInfo info;              /**< Fiff measurement information */
     fiff_int_t first_samp;      /**< Do we have a skip ToDo... */
     fiff_int_t last_samp;       /**< Do we have a skip ToDo... */
     RowVectorXd cals;           /**< Calibration matrix: ToDo Check if RowVectorXd is enough */
     QList<FiffRawDir> rawdir;   /**< Special fiff diretory entry for raw data. */
+    QVector<fiff_int_t> rawdir_last;    /**< Last sample of each rawdir entry, ascending. */
+    fiff_int_t rawdir_nsamp;    /**< Samples per rawdir entry if all entries are equally long, -1 otherwise. */
     MatrixXd proj;              /**< SSP operator to apply to the data. */
     FiffCtfComp comp;           /**< Compensator. */
+    QList<FiffRawData::SPtr> splits;    /**< The following parts of a split recording, last_samp covers all of them. */
 };
 
 } // NAMESPACE
@@ -0,0 +1,506 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_kernels.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FiffRawKernels class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_kernels.h"
+#include "fiff_file.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define FIFF_KERNELS_X86
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define FIFF_KERNELS_NEON
+    #include <arm_neon.h>
+#endif
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInt>
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+//
+//   GCC and Clang only emit vector instructions for functions compiled for the target, MSVC always does
+//
+#if defined(FIFF_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define FIFF_TARGET(x) __attribute__((target(x)))
+#else
+    #define FIFF_TARGET(x)
+#endif
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+typedef void (*DequantizeKernel)(const uchar* src, qint32 n, const double* scale, double* dst);
+
+static QAtomicInt s_iBackend(-1);
+
+
+//*************************************************************************************************************
+
+static inline float float_from_big_endian(const uchar* src)
+{
+    quint32 word = qFromBigEndian<quint32>(src);
+    float value;
+    memcpy(&value, &word, sizeof(float));
+    return value;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+static inline double value_from_big_endian(const uchar* src)
+{
+    return static_cast<double>(qFromBigEndian<T>(src));
+}
+
+
+//*************************************************************************************************************
+
+template<>
+inline double value_from_big_endian<float>(const uchar* src)
+{
+    return static_cast<double>(float_from_big_endian(src));
+}
+
+
+//*************************************************************************************************************
+
+/*
+* Scalar reference, also used for the tails of the vector kernels.
+*/
+template<typename T>
+static void dequantize_scalar(const uchar* src, qint32 n, const double* scale, double* dst)
+{
+    if (scale)
+    {
+        for(qint32 i = 0; i < n; ++i)
+            dst[i] = scale[i]*value_from_big_endian<T>(src + i*sizeof(T));
+    }
+    else
+    {
+        for(qint32 i = 0; i < n; ++i)
+            dst[i] = value_from_big_endian<T>(src + i*sizeof(T));
+    }
+}
+
+
+#if defined(FIFF_KERNELS_X86)
+
+//*************************************************************************************************************
+
+FIFF_TARGET("sse4.1")
+static inline void store_scaled_sse41(__m128d value, const double* scale, double* dst)
+{
+    if (scale)
+        value = _mm_mul_pd(value, _mm_loadu_pd(scale));
+    _mm_storeu_pd(dst, value);
+}
+
+
+//*************************************************************************************************************
+
+FIFF_TARGET("sse4.1")
+static void dequantize_int16_sse41(const uchar* src, qint32 n, const double* scale, double* dst)
+{
+    const __m128i swap = _mm_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+    qint32 i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        const __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2*i)), swap);
+        const __m128i lo = _mm_cvtepi16_epi32(v);
+        const __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(v, 8));
+        store_scaled_sse41(_mm_cvtepi32_pd(lo), scale ? scale + i : Q_NULLPTR, dst + i);
+        store_scaled_sse41(_mm_cvtepi32_pd(_mm_srli_si128(lo, 8)), scale ? scale + i + 2 : Q_NULLPTR, dst + i + 2);
+        store_scaled_sse41(_mm_cvtepi32_pd(hi), scale ? scale + i + 4 : Q_NULLPTR, dst + i + 4);
+        store_scaled_sse41(_mm_cvtepi32_pd(_mm_srli_si128(hi, 8)), scale ? scale + i + 6 : Q_NULLPTR, dst + i + 6);
+    }
+    dequantize_scalar<qint16>(src + 2*i, n - i, scale ? scale + i : Q_NULLPTR, dst + i);
+}
+
+
+//*************************************************************************************************************
+
+FIFF_TARGET("sse4.1")
+static void dequantize_int32_sse41(const uchar* src, qint32 n, const double* scale, double* dst)
+{
+    const __m128i swap = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+    qint32 i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        const __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4*i)), swap);
+        store_scaled_sse41(_mm_cvtepi32_pd(v), scale ? scale + i : Q_NULLPTR, dst + i);
+        store_scaled_sse41(_mm_cvtepi32_pd(_mm_srli_si128(v, 8)), scale ? scale + i + 2 : Q_NULLPTR, dst + i + 2);
+    }
+    dequantize_scalar<qint32>(src + 4*i, n - i, scale ? scale + i : Q_NULLPTR, dst + i);
+}
+
+
+//*************************************************************************************************************
+
+FIFF_TARGET("sse4.1")
+static void dequantize_float_sse41(const uchar* src, qint32 n, const double* scale, double* dst)
+{
+    const __m128i swap = _mm_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+    qint32 i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        const __m128 v = _mm_castsi128_ps(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4*i)), swap));
+        store_scaled_sse41(_mm_cvtps_pd(v), scale ? scale + i : Q_NULLPTR, dst + i);
+        store_scaled_sse41(_mm_cvtps_pd(_mm_movehl_ps(v, v)), scale ? scale + i + 2 : Q_NULLPTR, dst + i + 2);
+    }
+    dequantize_scalar<float>(src + 4*i, n - i, scale ? scale + i : Q_NULLPTR, dst + i);
+}
+
+
+//*************************************************************************************************************
+
+FIFF_TARGET("avx2")
+static inline void store_scaled_avx2(__m256d value, const double* scale, double* dst)
+{
+    if (scale)
+        value = _mm256_mul_pd(value, _mm256_loadu_pd(scale));
+    _mm256_storeu_pd(dst, value);
+}
+
+
+//*************************************************************************************************************
+
+FIFF_TARGET("avx2")
+static void dequantize_int16_avx2(const uchar* src, qint32 n, const double* scale, double* dst)
+{
+    const __m256i swap = _mm256_setr_epi8(1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14,
+                                          1,0,3,2,5,4,7,6,9,8,11,10,13,12,15,14);
+    qint32 i = 0;
+    for(; i + 16 <= n; i += 16)
+    {
+        const __m256i v = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2*i)), swap);
+        const __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(v));
+        const __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1));
+        store_scaled_avx2(_mm256_cvtepi32_pd(_mm256_castsi256_si128(lo)), scale ? scale + i : Q_NULLPTR, dst + i);
+        store_scaled_avx2(_mm256_cvtepi32_pd(_mm256_extracti128_si256(lo, 1)), scale ? scale + i + 4 : Q_NULLPTR, dst + i + 4);
+        store_scaled_avx2(_mm256_cvtepi32_pd(_mm256_castsi256_si128(hi)), scale ? scale + i + 8 : Q_NULLPTR, dst + i + 8);
+        store_scaled_avx2(_mm256_cvtepi32_pd(_mm256_extracti128_si256(hi, 1)), scale ? scale + i + 12 : Q_NULLPTR, dst + i + 12);
+    }
+    dequantize_scalar<qint16>(src + 2*i, n - i, scale ? scale + i : Q_NULLPTR, dst + i);
+}
+
+
+//*************************************************************************************************************
+
+FIFF_TARGET("avx2")
+static void dequantize_int32_avx2(const uchar* src, qint32 n, const double* scale, double* dst)
+{
+    const __m256i swap = _mm256_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12,
+                                          3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+    qint32 i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        const __m256i v = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4*i)), swap);
+        store_scaled_avx2(_mm256_cvtepi32_pd(_mm256_castsi256_si128(v)), scale ? scale + i : Q_NULLPTR, dst + i);
+        store_scaled_avx2(_mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)), scale ? scale + i + 4 : Q_NULLPTR, dst + i + 4);
+    }
+    dequantize_scalar<qint32>(src + 4*i, n - i, scale ? scale + i : Q_NULLPTR, dst + i);
+}
+
+
+//*************************************************************************************************************
+
+FIFF_TARGET("avx2")
+static void dequantize_float_avx2(const uchar* src, qint32 n, const double* scale, double* dst)
+{
+    const __m256i swap = _mm256_setr_epi8(3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12,
+                                          3,2,1,0,7,6,5,4,11,10,9,8,15,14,13,12);
+    qint32 i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        const __m256 v = _mm256_castsi256_ps(_mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4*i)), swap));
+        store_scaled_avx2(_mm256_cvtps_pd(_mm256_castps256_ps128(v)), scale ? scale + i : Q_NULLPTR, dst + i);
+        store_scaled_avx2(_mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)), scale ? scale + i + 4 : Q_NULLPTR, dst + i + 4);
+    }
+    dequantize_scalar<float>(src + 4*i, n - i, scale ? scale + i : Q_NULLPTR, dst + i);
+}
+
+
+//*************************************************************************************************************
+
+static bool cpu_supports(FiffRawKernels::Backend p_backend)
+{
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0);
+    const int maxLeaf = regs[0];
+    __cpuid(regs, 1);
+    if (p_backend == FiffRawKernels::SSE41)
+        return (regs[2] & (1 << 19)) != 0;
+    //
+    //   AVX2 also needs the OS to save the ymm registers
+    //
+    const bool osxsave = (regs[2] & (1 << 27)) != 0 && (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || maxLeaf < 7 || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    if (p_backend == FiffRawKernels::SSE41)
+        return __builtin_cpu_supports("sse4.1");
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // FIFF_KERNELS_X86
+
+
+#if defined(FIFF_KERNELS_NEON)
+
+//*************************************************************************************************************
+
+static inline void store_scaled_neon(float64x2_t value, const double* scale, double* dst)
+{
+    if (scale)
+        value = vmulq_f64(value, vld1q_f64(scale));
+    vst1q_f64(dst, value);
+}
+
+
+//*************************************************************************************************************
+
+static inline void store_int32_neon(int32x4_t v, const double* scale, double* dst)
+{
+    store_scaled_neon(vcvtq_f64_s64(vmovl_s32(vget_low_s32(v))), scale, dst);
+    store_scaled_neon(vcvtq_f64_s64(vmovl_high_s32(v)), scale ? scale + 2 : Q_NULLPTR, dst + 2);
+}
+
+
+//*************************************************************************************************************
+
+static void dequantize_int16_neon(const uchar* src, qint32 n, const double* scale, double* dst)
+{
+    qint32 i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+        const int16x8_t v = vreinterpretq_s16_u8(vrev16q_u8(vld1q_u8(src + 2*i)));
+        store_int32_neon(vmovl_s16(vget_low_s16(v)), scale ? scale + i : Q_NULLPTR, dst + i);
+        store_int32_neon(vmovl_high_s16(v), scale ? scale + i + 4 : Q_NULLPTR, dst + i + 4);
+    }
+    dequantize_scalar<qint16>(src + 2*i, n - i, scale ? scale + i : Q_NULLPTR, dst + i);
+}
+
+
+//*************************************************************************************************************
+
+static void dequantize_int32_neon(const uchar* src, qint32 n, const double* scale, double* dst)
+{
+    qint32 i = 0;
+    for(; i + 4 <= n; i += 4)
+        store_int32_neon(vreinterpretq_s32_u8(vrev32q_u8(vld1q_u8(src + 4*i))), scale ? scale + i : Q_NULLPTR, dst + i);
+    dequantize_scalar<qint32>(src + 4*i, n - i, scale ? scale + i : Q_NULLPTR, dst + i);
+}
+
+
+//*************************************************************************************************************
+
+static void dequantize_float_neon(const uchar* src, qint32 n, const double* scale, double* dst)
+{
+    qint32 i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+        const float32x4_t v = vreinterpretq_f32_u8(vrev32q_u8(vld1q_u8(src + 4*i)));
+        store_scaled_neon(vcvt_f64_f32(vget_low_f32(v)), scale ? scale + i : Q_NULLPTR, dst + i);
+        store_scaled_neon(vcvt_high_f64_f32(v), scale ? scale + i + 2 : Q_NULLPTR, dst + i + 2);
+    }
+    dequantize_scalar<float>(src + 4*i, n - i, scale ? scale + i : Q_NULLPTR, dst + i);
+}
+
+#endif // FIFF_KERNELS_NEON
+
+
+//*************************************************************************************************************
+
+static FiffRawKernels::Backend detect_backend()
+{
+    if (FiffRawKernels::isSupported(FiffRawKernels::AVX2))
+        return FiffRawKernels::AVX2;
+    if (FiffRawKernels::isSupported(FiffRawKernels::SSE41))
+        return FiffRawKernels::SSE41;
+    if (FiffRawKernels::isSupported(FiffRawKernels::NEON))
+        return FiffRawKernels::NEON;
+    return FiffRawKernels::Scalar;
+}
+
+
+//*************************************************************************************************************
+
+static DequantizeKernel select_kernel(FiffRawKernels::Backend p_backend, fiff_int_t type)
+{
+    const bool isShort = type == FIFFT_DAU_PACK16 || type == FIFFT_SHORT;
+
+    switch(p_backend)
+    {
+#if defined(FIFF_KERNELS_X86)
+        case FiffRawKernels::AVX2:
+            return isShort ? dequantize_int16_avx2 : (type == FIFFT_INT ? dequantize_int32_avx2 : dequantize_float_avx2);
+        case FiffRawKernels::SSE41:
+            return isShort ? dequantize_int16_sse41 : (type == FIFFT_INT ? dequantize_int32_sse41 : dequantize_float_sse41);
+#endif
+#if defined(FIFF_KERNELS_NEON)
+        case FiffRawKernels::NEON:
+            return isShort ? dequantize_int16_neon : (type == FIFFT_INT ? dequantize_int32_neon : dequantize_float_neon);
+#endif
+        default:
+            return isShort ? dequantize_scalar<qint16> : (type == FIFFT_INT ? dequantize_scalar<qint32> : dequantize_scalar<float>);
+    }
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawKernels::Backend FiffRawKernels::backend()
+{
+    int t_iBackend = s_iBackend.loadAcquire();
+    if (t_iBackend < 0)
+    {
+        t_iBackend = detect_backend();
+        s_iBackend.testAndSetOrdered(-1, t_iBackend);
+        t_iBackend = s_iBackend.loadAcquire();
+    }
+    return static_cast<Backend>(t_iBackend);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawKernels::setBackend(Backend p_backend)
+{
+    if (!isSupported(p_backend))
+        return false;
+
+    s_iBackend.storeRelease(p_backend);
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawKernels::isSupported(Backend p_backend)
+{
+    switch(p_backend)
+    {
+        case Scalar:
+            return true;
+#if defined(FIFF_KERNELS_X86)
+        case SSE41:
+        case AVX2:
+            return cpu_supports(p_backend);
+#endif
+#if defined(FIFF_KERNELS_NEON)
+        case NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+
+//*************************************************************************************************************
+
+QString FiffRawKernels::backendName(Backend p_backend)
+{
+    switch(p_backend)
+    {
+        case SSE41:
+            return QString("SSE4.1");
+        case AVX2:
+            return QString("AVX2");
+        case NEON:
+            return QString("NEON");
+        default:
+            return QString("Scalar");
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawKernels::dequantize(fiff_int_t type, const uchar* src, qint32 n, const double* scale, double* dst)
+{
+    if (type != FIFFT_DAU_PACK16 && type != FIFFT_SHORT && type != FIFFT_INT && type != FIFFT_FLOAT)
+        return false;
+
+    select_kernel(backend(), type)(src, n, scale, dst);
+    return true;
+}
@@ -0,0 +1,142 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_kernels.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the FiffRawKernels class.
+*
+*/
+
+#ifndef FIFF_RAW_KERNELS_H
+#define FIFF_RAW_KERNELS_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//=============================================================================================================
+/**
+* Fused 'byteswap + widen + scale' kernels which convert big endian raw data samples (FIFFT_DAU_PACK16,
+* FIFFT_SHORT, FIFFT_INT and FIFFT_FLOAT) straight to calibrated doubles. SSE4.1, AVX2 and NEON versions are
+* selected at runtime by CPU detection, the scalar version serves as fallback and reference.
+*
+* @brief Vectorized raw data dequantization kernels
+*/
+class FIFFSHARED_EXPORT FiffRawKernels
+{
+public:
+    //=========================================================================================================
+    /**
+    * Instruction set a kernel is implemented with.
+    */
+    enum Backend {
+        Scalar = 0,     /**< Portable C++ version. */
+        SSE41,          /**< x86 SSE4.1 version. */
+        AVX2,           /**< x86 AVX2 version. */
+        NEON            /**< AArch64 NEON version. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Returns the backend used by dequantize. On first use this is the best backend supported by the CPU.
+    *
+    * @return the active backend
+    */
+    static Backend backend();
+
+    //=========================================================================================================
+    /**
+    * Selects the backend used by dequantize, e.g. to compare the kernels against each other.
+    *
+    * @param[in] p_backend  the backend to use
+    *
+    * @return false if the backend is not supported by the CPU or the build, the active backend is kept then
+    */
+    static bool setBackend(Backend p_backend);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the CPU and the build support the given backend.
+    *
+    * @param[in] p_backend  the backend to check
+    *
+    * @return true if the backend can be used
+    */
+    static bool isSupported(Backend p_backend);
+
+    //=========================================================================================================
+    /**
+    * Returns a printable name of the given backend.
+    *
+    * @param[in] p_backend  the backend
+    *
+    * @return the name of the backend
+    */
+    static QString backendName(Backend p_backend);
+
+    //=========================================================================================================
+    /**
+    * Converts n consecutive big endian values of the given FIFF data type to double and multiplies them with
+    * the corresponding scale factors: dst[i] = scale[i]*value(src, i).
+    *
+    * @param[in] type   the FIFF data type of the source (FIFFT_DAU_PACK16, FIFFT_SHORT, FIFFT_INT or FIFFT_FLOAT)
+    * @param[in] src    the big endian source values
+    * @param[in] n      number of values to convert
+    * @param[in] scale  n scale factors, Q_NULLPTR if the values should not be scaled
+    * @param[out] dst   n converted values
+    *
+    * @return false if the data type is not supported
+    */
+    static bool dequantize(fiff_int_t type, const uchar* src, qint32 n, const double* scale, double* dst);
+};
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_KERNELS_H
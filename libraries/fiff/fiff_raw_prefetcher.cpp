@@ -0,0 +1,254 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_prefetcher.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FiffRawPrefetcher class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_prefetcher.h"
+#include "fiff_stream.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawPrefetcher::FiffRawPrefetcher(const FiffRawData& p_raw, fiff_int_t p_iQuantum, qint32 p_iDepth, const RowVectorXi& p_sel, fiff_int_t p_iFrom)
+: m_raw(p_raw)
+, m_sel(p_sel)
+, m_iQuantum(qMax(1, p_iQuantum))
+, m_iLastSamp(p_raw.last_samp)
+, m_vecSlots(qMax(1, p_iDepth))
+, m_iHead(0)
+, m_iCount(0)
+, m_iNext(p_iFrom < 0 ? p_raw.first_samp : p_iFrom)
+, m_iNextTo(-1)
+, m_iExpected(m_iNext)
+, m_iGeneration(0)
+, m_bStop(false)
+{
+    m_stats.hits = 0;
+    m_stats.misses = 0;
+    m_stats.waits = 0;
+    m_stats.maxFill = 0;
+
+    //
+    //   Allocate the ring once, read_raw_segment keeps the memory while the segment size does not change
+    //
+    const qint32 nrow = p_sel.size() > 0 ? static_cast<qint32>(p_sel.size()) : p_raw.info.nchan;
+    for(qint32 k = 0; k < m_vecSlots.size(); ++k) {
+        m_vecSlots[k].data.resize(nrow, m_iQuantum);
+        m_vecSlots[k].times.resize(1, m_iQuantum);
+        m_vecSlots[k].from = -1;
+        m_vecSlots[k].to = -1;
+        m_vecSlots[k].ok = false;
+    }
+
+    start();
+}
+
+
+//*************************************************************************************************************
+
+FiffRawPrefetcher::~FiffRawPrefetcher()
+{
+    stop();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawPrefetcher::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t from, fiff_int_t to)
+{
+    if (from > to || from > m_iLastSamp)
+        return false;
+
+    QMutexLocker locker(&m_mutex);
+
+    //
+    //   The segment continues the read-ahead if it starts where the last one ended and has the regular size
+    //
+    bool hit = false;
+    if (from == m_iExpected) {
+        if (m_iCount > 0)
+            hit = m_vecSlots[m_iHead].to == to;
+        else
+            hit = to == qMin(from + m_iQuantum - 1, m_iLastSamp);
+    }
+
+    if (hit) {
+        ++m_stats.hits;
+    }
+    else {
+        ++m_stats.misses;
+        restart(from, to);
+    }
+
+    if (m_iCount == 0) {
+        ++m_stats.waits;
+        while(m_iCount == 0 && !m_bStop && isRunning())
+            m_condNotEmpty.wait(&m_mutex);
+    }
+
+    if (m_iCount == 0)
+        return false;
+
+    //
+    //   Hand over the prefetched matrices, the old ones are reused by the reader
+    //
+    Slot& slot = m_vecSlots[m_iHead];
+    data.swap(slot.data);
+    times.swap(slot.times);
+    const bool ok = slot.ok;
+
+    m_iExpected = slot.to + 1;
+    m_iHead = (m_iHead + 1) % m_vecSlots.size();
+    --m_iCount;
+    m_condNotFull.wakeAll();
+
+    return ok;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawPrefetcher::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bStop = true;
+        m_condNotFull.wakeAll();
+        m_condNotEmpty.wakeAll();
+    }
+
+    wait();
+}
+
+
+//*************************************************************************************************************
+
+FiffRawPrefetcherStats FiffRawPrefetcher::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawPrefetcher::run()
+{
+    //
+    //   Reopen the file in this thread, the stream of the consumer is not touched. The parts of a split
+    //   recording got files of their own with the copy.
+    //
+    QFile t_file(m_raw.info.filename);
+    m_raw.file = FiffStream::SPtr(new FiffStream(&t_file));
+
+    forever {
+        qint32 idx, gen;
+        fiff_int_t from, to;
+        {
+            QMutexLocker locker(&m_mutex);
+            while(!m_bStop && (m_iCount == m_vecSlots.size() || m_iNext > m_iLastSamp))
+                m_condNotFull.wait(&m_mutex);
+
+            if (m_bStop)
+                break;
+
+            from = m_iNext;
+            to = m_iNextTo >= 0 ? m_iNextTo : qMin(from + m_iQuantum - 1, m_iLastSamp);
+            m_iNext = to + 1;
+            m_iNextTo = -1;
+            gen = m_iGeneration;
+
+            //
+            //   Only this thread appends, the slot behind the ready ones is free until it is counted below
+            //
+            idx = (m_iHead + m_iCount) % m_vecSlots.size();
+        }
+
+        Slot& slot = m_vecSlots[idx];
+        slot.ok = m_raw.read_raw_segment(slot.data, slot.times, from, to, m_sel);
+        slot.from = from;
+        slot.to = to;
+
+        {
+            QMutexLocker locker(&m_mutex);
+            if (gen == m_iGeneration) {
+                ++m_iCount;
+                m_stats.maxFill = qMax(m_stats.maxFill, m_iCount);
+                m_condNotEmpty.wakeAll();
+            }
+        }
+    }
+
+    m_raw.file->close();
+    m_raw.file = FiffStream::SPtr();
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawPrefetcher::restart(fiff_int_t from, fiff_int_t to)
+{
+    ++m_iGeneration;
+    m_iCount = 0;
+    m_iNext = from;
+    m_iNextTo = to;
+    m_iExpected = from;
+    m_condNotFull.wakeAll();
+}
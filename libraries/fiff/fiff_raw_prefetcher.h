@@ -0,0 +1,202 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_prefetcher.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the FiffRawPrefetcher class.
+*
+*/
+
+#ifndef FIFF_RAW_PREFETCHER_H
+#define FIFF_RAW_PREFETCHER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+#include "fiff_raw_data.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//=============================================================================================================
+/**
+* Statistics of a raw data prefetcher.
+*
+* @brief Prefetcher statistics
+*/
+struct FiffRawPrefetcherStats {
+    qint64  hits;           /**< Number of requests served by the read-ahead. */
+    qint64  misses;         /**< Number of requests which did not match the read-ahead and restarted it. */
+    qint64  waits;          /**< Number of requests which had to wait for the reader thread. */
+    qint32  maxFill;        /**< Highest number of segments waiting in the ring. */
+};
+
+
+//=============================================================================================================
+/**
+* Reads consecutive raw data segments of a fixed number of samples ahead of a sequential consumer. The
+* segments are read on a dedicated thread with its own file handle into a ring of pre-allocated matrices.
+* A request which does not continue the read-ahead is a miss: the ring is discarded and reading restarts
+* at the requested segment.
+*
+* @brief Read-ahead for sequential raw data consumers
+*/
+class FIFFSHARED_EXPORT FiffRawPrefetcher : public QThread
+{
+public:
+    typedef QSharedPointer<FiffRawPrefetcher> SPtr;            /**< Shared pointer type for FiffRawPrefetcher. */
+    typedef QSharedPointer<const FiffRawPrefetcher> ConstSPtr; /**< Const shared pointer type for FiffRawPrefetcher. */
+
+    //=========================================================================================================
+    /**
+    * Constructs the prefetcher and starts reading ahead at p_iFrom.
+    *
+    * @param[in] p_raw      The raw data set up by FiffStream::setup_read_raw, the file is reopened by the reader thread
+    * @param[in] p_iQuantum Number of samples of one segment
+    * @param[in] p_iDepth   Number of segments which are read ahead
+    * @param[in] p_sel      Channel selection passed to read_raw_segment
+    * @param[in] p_iFrom    First sample to read, the first sample of the raw data if < 0
+    */
+    FiffRawPrefetcher(const FiffRawData& p_raw, fiff_int_t p_iQuantum, qint32 p_iDepth = 4, const Eigen::RowVectorXi& p_sel = defaultRowVectorXi, fiff_int_t p_iFrom = -1);
+
+    //=========================================================================================================
+    /**
+    * Stops the reader thread.
+    */
+    ~FiffRawPrefetcher();
+
+    //=========================================================================================================
+    /**
+    * Returns the segment [from, to]. If it continues the read-ahead the prefetched matrices are swapped into
+    * data and times, otherwise reading restarts at from and the call waits for the segment.
+    *
+    * @param[out] data      The data read, the previous memory is handed over to the ring
+    * @param[out] times     The time points of the samples
+    * @param[in] from       First sample to include
+    * @param[in] to         Last sample to include
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_raw_segment(Eigen::MatrixXd& data, Eigen::MatrixXd& times, fiff_int_t from, fiff_int_t to);
+
+    //=========================================================================================================
+    /**
+    * Stops the reader thread. Pending requests return false.
+    */
+    void stop();
+
+    //=========================================================================================================
+    /**
+    * Returns the hit, miss and wait counters.
+    *
+    * @return the statistics
+    */
+    FiffRawPrefetcherStats stats() const;
+
+protected:
+    //=========================================================================================================
+    /**
+    * Reads the segments ahead.
+    */
+    virtual void run();
+
+private:
+    /**
+    * Prefetched segment.
+    */
+    struct Slot {
+        Eigen::MatrixXd data;   /**< The data. */
+        Eigen::MatrixXd times;  /**< The time points. */
+        fiff_int_t      from;   /**< First sample. */
+        fiff_int_t      to;     /**< Last sample. */
+        bool            ok;     /**< Whether read_raw_segment succeeded. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Discards the ring and restarts reading at the segment [from, to]. Must be called with the mutex locked.
+    *
+    * @param[in] from       First sample of the first segment
+    * @param[in] to         Last sample of the first segment
+    */
+    void restart(fiff_int_t from, fiff_int_t to);
+
+    FiffRawData             m_raw;          /**< Raw data copy used by the reader thread. */
+    Eigen::RowVectorXi      m_sel;          /**< Channel selection. */
+    fiff_int_t              m_iQuantum;     /**< Samples per segment. */
+    fiff_int_t              m_iLastSamp;    /**< Last sample of the raw data. */
+
+    QVector<Slot>           m_vecSlots;     /**< Ring of segments. */
+    qint32                  m_iHead;        /**< Index of the oldest segment. */
+    qint32                  m_iCount;       /**< Number of segments ready in the ring. */
+    fiff_int_t              m_iNext;        /**< First sample of the next segment to read. */
+    fiff_int_t              m_iNextTo;      /**< Last sample of the next segment to read, -1 for a full segment. */
+    fiff_int_t              m_iExpected;    /**< First sample of the next segment the consumer gets. */
+    qint32                  m_iGeneration;  /**< Incremented on a restart, segments of older generations are discarded. */
+    bool                    m_bStop;        /**< Whether the thread should stop. */
+
+    FiffRawPrefetcherStats  m_stats;        /**< Hit, miss and wait counters. */
+    mutable QMutex          m_mutex;        /**< Guards the ring state and the statistics. */
+    QWaitCondition          m_condNotFull;  /**< Signals the reader that a slot is free or reading restarted. */
+    QWaitCondition          m_condNotEmpty; /**< Signals the consumer that a segment is ready. */
+};
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_PREFETCHER_H
@@ -0,0 +1,223 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_splitter.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the FiffRawSplitter class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_splitter.h"
+#include "fiff_stream.h"
+#include "fiff_file.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFileInfo>
+#include <QThread>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawSplitter::FiffRawSplitter(const FiffInfo& p_info, const MatrixXi& p_sel, bool p_bResetRange)
+: m_info(p_info)
+, m_sel(p_sel)
+, m_bResetRange(p_bResetRange)
+, m_iSplitSize(0)
+, m_iPart(0)
+, m_iFirstSample(0)
+, m_iSamples(0)
+, m_bNextPending(false)
+{
+}
+
+
+//*************************************************************************************************************
+
+FiffRawSplitter::~FiffRawSplitter()
+{
+    finish();
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawSplitter::start(const QString& p_sFileName, fiff_long_t p_iSplitSize, fiff_int_t p_iFirstSample)
+{
+    if(isActive())
+        return;
+
+    m_sFileName = p_sFileName;
+    m_iSplitSize = p_iSplitSize;
+    m_iFirstSample = p_iFirstSample;
+
+    m_futureNext = QtConcurrent::run(this, &FiffRawSplitter::preparePart, partFileName(m_sFileName, m_iPart + 1));
+    m_bNextPending = true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawSplitter::rollover(FiffStream* p_pStream)
+{
+    if(!m_bNextPending)
+        return false;
+
+    Part next = m_futureNext.result();
+    m_bNextPending = false;
+
+    if(!next.file) {
+        qWarning("FiffRawSplitter::rollover - Could not prepare %s, the recording continues in the current file.", partFileName(m_sFileName, m_iPart + 1).toUtf8().constData());
+        m_iSplitSize = 0;
+        return false;
+    }
+
+    //
+    //   Close the current part with a link to the next one
+    //
+    QString t_sCurrentName = QFileInfo(partFileName(m_sFileName, m_iPart)).fileName();
+    QString t_sNextName = QFileInfo(next.file->fileName()).fileName();
+
+    p_pStream->end_block(FIFFB_RAW_DATA);
+    writeRef(p_pStream, FIFFV_ROLE_NEXT_FILE, t_sNextName, m_iPart + 1);
+    p_pStream->end_block(FIFFB_MEAS);
+    p_pStream->end_file();
+
+    //The finished part is closed by the thread which writes the stream, a part owned by the splitter is
+    //released here as well
+    if(p_pStream->device()->isOpen())
+        p_pStream->device()->close();
+
+    //
+    //   Continue in the next part, its header is already written. The prepared part has no thread affinity,
+    //   the writing thread takes it over.
+    //
+    next.file->moveToThread(QThread::currentThread());
+    p_pStream->setDevice(next.file.data());
+    m_pCurrentFile = next.file;
+    ++m_iPart;
+
+    fiff_int_t t_iFirst = m_iFirstSample + (fiff_int_t)m_iSamples;
+    p_pStream->write_int(FIFF_FIRST_SAMPLE, &t_iFirst);
+    writeRef(p_pStream, FIFFV_ROLE_PREV_FILE, t_sCurrentName, m_iPart - 1);
+
+    m_futureNext = QtConcurrent::run(this, &FiffRawSplitter::preparePart, partFileName(m_sFileName, m_iPart + 1));
+    m_bNextPending = true;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawSplitter::finish()
+{
+    if(m_bNextPending) {
+        Part t_unused = m_futureNext.result();
+        if(t_unused.file) {
+            t_unused.file->moveToThread(QThread::currentThread());
+            t_unused.file->close();
+            t_unused.file->remove();
+        }
+        m_bNextPending = false;
+    }
+
+    m_iSplitSize = 0;
+}
+
+
+//*************************************************************************************************************
+
+QString FiffRawSplitter::partFileName(const QString& p_sFileName, qint32 p_iPart)
+{
+    if(p_iPart == 0)
+        return p_sFileName;
+
+    QFileInfo t_fileInfo(p_sFileName);
+    QString t_sSuffix = t_fileInfo.suffix().isEmpty() ? QString("fif") : t_fileInfo.suffix();
+
+    return QString("%1/%2-%3.%4").arg(t_fileInfo.path()).arg(t_fileInfo.completeBaseName()).arg(p_iPart).arg(t_sSuffix);
+}
+
+
+//*************************************************************************************************************
+
+FiffRawSplitter::Part FiffRawSplitter::preparePart(const QString& p_sFileName) const
+{
+    Part t_part;
+    QSharedPointer<QFile> t_pFile(new QFile(p_sFileName));
+
+    RowVectorXd t_cals;
+    FiffStream::SPtr t_pHeader = FiffStream::start_writing_raw(*t_pFile, m_info, t_cals, m_sel, m_bResetRange);
+
+    if(t_pHeader && t_pFile->isOpen())
+        t_part.file = t_pFile;
+
+    //Hand the part over without thread affinity, the thread which takes it pulls it in
+    t_pFile->moveToThread(Q_NULLPTR);
+
+    return t_part;
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawSplitter::writeRef(FiffStream* p_pStream, fiff_int_t p_iRole, const QString& p_sFileName, qint32 p_iPart) const
+{
+    p_pStream->start_block(FIFFB_REF);
+    p_pStream->write_int(FIFF_REF_ROLE, &p_iRole);
+    p_pStream->write_string(FIFF_REF_FILE_NAME, p_sFileName);
+    if(m_info.meas_id.version != -1)
+        p_pStream->write_id(FIFF_REF_FILE_ID, m_info.meas_id);
+    fiff_int_t t_iPart = p_iPart;
+    p_pStream->write_int(FIFF_REF_FILE_NUM, &t_iPart);
+    p_pStream->end_block(FIFFB_REF);
+}
@@ -0,0 +1,273 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_splitter.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the FiffRawSplitter class.
+*
+*/
+
+#ifndef FIFF_RAW_SPLITTER_H
+#define FIFF_RAW_SPLITTER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+#include "fiff_info.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QFuture>
+#include <QSharedPointer>
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FiffStream;
+
+
+//=============================================================================================================
+/**
+* Continues the raw data of a FiffStream in further files once a file reaches the split size. The parts of
+* rec_raw.fif are named rec_raw-1.fif, rec_raw-2.fif, ..., each part is a complete raw file with its own
+* measurement info and first sample, and the parts are linked with FIFFB_REF blocks like the split files of
+* Neuromag and MNE-Python.
+*
+* The next part is opened and its header is written in the background as soon as a part is started. The
+* rollover itself only writes the closing and the linking tags, closes the finished part and switches the device
+* of the stream, so a continuous recording is neither interrupted nor stalled by it. All of this happens on the
+* thread which writes the stream, which takes over the prepared part from the background thread.
+*
+* @brief Automatic split of raw files
+*/
+class FIFFSHARED_EXPORT FiffRawSplitter
+{
+public:
+    typedef QSharedPointer<FiffRawSplitter> SPtr;            /**< Shared pointer type for FiffRawSplitter. */
+    typedef QSharedPointer<const FiffRawSplitter> ConstSPtr; /**< Const shared pointer type for FiffRawSplitter. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an inactive splitter which keeps the header parameters of FiffStream::start_writing_raw.
+    *
+    * @param[in] p_info         The measurement info
+    * @param[in] p_sel          The selected channels
+    * @param[in] p_bResetRange  Whether the channel ranges are reset to 1
+    */
+    FiffRawSplitter(const FiffInfo& p_info, const Eigen::MatrixXi& p_sel, bool p_bResetRange);
+
+    //=========================================================================================================
+    /**
+    * Waits for the background task and removes a prepared part which was not used.
+    */
+    ~FiffRawSplitter();
+
+    //=========================================================================================================
+    /**
+    * Activates the splitting and starts preparing the second part.
+    *
+    * @param[in] p_sFileName        Name of the first part
+    * @param[in] p_iSplitSize       Maximum size of a part in bytes
+    * @param[in] p_iFirstSample     First sample of the first part
+    */
+    void start(const QString& p_sFileName, fiff_long_t p_iSplitSize, fiff_int_t p_iFirstSample);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the splitting is active.
+    *
+    * @return true if active, false otherwise
+    */
+    inline bool isActive() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether a tag of the given size has to be written to the next part.
+    *
+    * @param[in] p_iPos     Current position in the current part
+    * @param[in] p_iBytes   Size of the tag including its header
+    *
+    * @return true if the stream has to roll over before the tag is written
+    */
+    inline bool needsRollover(fiff_long_t p_iPos, fiff_long_t p_iBytes) const;
+
+    //=========================================================================================================
+    /**
+    * Closes the current part and continues the stream in the prepared next part. Deactivates the splitting
+    * and keeps writing to the current part if the next part could not be prepared.
+    *
+    * @param[in] p_pStream      The stream, its device is switched to the next part
+    *
+    * @return true if the stream continues in the next part, false otherwise
+    */
+    bool rollover(FiffStream* p_pStream);
+
+    //=========================================================================================================
+    /**
+    * Counts the samples written to the current part.
+    *
+    * @param[in] p_iSamples     Number of samples
+    */
+    inline void addSamples(fiff_int_t p_iSamples);
+
+    //=========================================================================================================
+    /**
+    * Waits for the background task and removes a prepared part which was not used. Called after the last part
+    * was closed.
+    */
+    void finish();
+
+    //=========================================================================================================
+    /**
+    * Returns the index of the current part, 0 for the first file.
+    *
+    * @return the current part
+    */
+    inline qint32 part() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the file name of a part.
+    *
+    * @param[in] p_sFileName    Name of the first part, e.g. rec_raw.fif
+    * @param[in] p_iPart        The part
+    *
+    * @return the name of the part, e.g. rec_raw-2.fif
+    */
+    static QString partFileName(const QString& p_sFileName, qint32 p_iPart);
+
+private:
+    struct Part {
+        QSharedPointer<QFile>   file;   /**< The pre-opened file with the header written, NULL if it failed. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Opens a part and writes its header up to the start of the raw data block, runs in the background. The file
+    * is returned without thread affinity.
+    *
+    * @param[in] p_sFileName    Name of the part
+    *
+    * @return the prepared part
+    */
+    Part preparePart(const QString& p_sFileName) const;
+
+    //=========================================================================================================
+    /**
+    * Writes a FIFFB_REF block which links to another part.
+    *
+    * @param[in] p_pStream      The stream
+    * @param[in] p_iRole        FIFFV_ROLE_PREV_FILE or FIFFV_ROLE_NEXT_FILE
+    * @param[in] p_sFileName    Name of the linked part
+    * @param[in] p_iPart        Index of the linked part
+    */
+    void writeRef(FiffStream* p_pStream, fiff_int_t p_iRole, const QString& p_sFileName, qint32 p_iPart) const;
+
+    FiffInfo                m_info;             /**< Measurement info written to every part. */
+    Eigen::MatrixXi         m_sel;              /**< Selected channels. */
+    bool                    m_bResetRange;      /**< Whether the channel ranges are reset to 1. */
+
+    QString                 m_sFileName;        /**< Name of the first part. */
+    fiff_long_t             m_iSplitSize;       /**< Maximum size of a part in bytes, 0 if inactive. */
+    qint32                  m_iPart;            /**< Index of the current part. */
+    fiff_int_t              m_iFirstSample;     /**< First sample of the first part. */
+    qint64                  m_iSamples;         /**< Samples written to all parts so far. */
+
+    QSharedPointer<QFile>   m_pCurrentFile;     /**< The current part, NULL for the first part, which is the device of the caller. */
+    QFuture<Part>           m_futureNext;       /**< The next part, prepared in the background. */
+    bool                    m_bNextPending;     /**< Whether m_futureNext holds a part which was not taken yet. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool FiffRawSplitter::isActive() const
+{
+    return m_iSplitSize > 0;
+}
+
+
+//*************************************************************************************************************
+
+inline bool FiffRawSplitter::needsRollover(fiff_long_t p_iPos, fiff_long_t p_iBytes) const
+{
+    //Leave room for the closing and linking tags
+    return m_iSplitSize > 0 && p_iPos + p_iBytes + 4096 > m_iSplitSize;
+}
+
+
+//*************************************************************************************************************
+
+inline void FiffRawSplitter::addSamples(fiff_int_t p_iSamples)
+{
+    m_iSamples += p_iSamples;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 FiffRawSplitter::part() const
+{
+    return m_iPart;
+}
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_SPLITTER_H
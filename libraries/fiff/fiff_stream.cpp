@@ -45,6 +45,8 @@
 #include "fiff_info.h"
 #include "fiff_info_base.h"
 #include "fiff_raw_data.h"
+#include "fiff_raw_compression.h"
+#include "fiff_raw_splitter.h"
 #include "fiff_cov.h"
 #include "fiff_coord_trans.h"
 #include "fiff_ch_info.h"
@@ -56,6 +58,7 @@
 
 #include <utils/mnemath.h>
 #include <utils/ioutils.h>
+#include <utils/tracer.h>
 
 #define MALLOC_54(x,t) (t *)malloc((x)*sizeof(t))
 
@@ -91,8 +94,11 @@
 // Qt INCLUDES
 //=============================================================================================================
 
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QTcpSocket>
+#include <QThread>
 
 
 //*************************************************************************************************************
@@ -111,6 +117,9 @@ using namespace UTILSLIB;
 
 FiffStream::FiffStream(QIODevice *p_pIODevice)
 : QDataStream(p_pIODevice)
+, m_pMappedData(Q_NULLPTR)
+, m_iMappedSize(0)
+, m_iRawCompressionBlock(0)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -122,6 +131,9 @@ FiffStream::FiffStream(QIODevice *p_pIODevice)
 
 FiffStream::FiffStream(QByteArray * a, QIODevice::OpenMode mode)
 : QDataStream(a, mode)
+, m_pMappedData(Q_NULLPTR)
+, m_iMappedSize(0)
+, m_iRawCompressionBlock(0)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -129,6 +141,15 @@ FiffStream::FiffStream(QByteArray * a, QIODevice::OpenMode mode)
 }
 
 
+//*************************************************************************************************************
+
+FiffStream::~FiffStream()
+{
+    stop_async_writing();
+    unmap_file();
+}
+
+
 //*************************************************************************************************************
 
 QString FiffStream::streamName()
@@ -196,6 +217,8 @@ fiff_long_t FiffStream::end_block(fiff_int_t kind, fiff_int_t next)
 
 void FiffStream::end_file()
 {
+    flush_async_writing();
+
     fiff_int_t datasize = 0;
 
     *this << (qint32)FIFF_NOP;
@@ -209,10 +232,114 @@ void FiffStream::end_file()
 
 void FiffStream::finish_writing_raw()
 {
+    this->stop_async_writing();
+
     this->end_block(FIFFB_RAW_DATA);
     this->end_block(FIFFB_MEAS);
     this->end_file();
     this->close();
+
+    if(m_pRawSplitter)
+        m_pRawSplitter->finish();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::start_async_writing(qint32 queue_size, bool drop_when_full)
+{
+    if(m_pAsyncWriter)
+        return false;
+
+    m_pAsyncWriter = FiffAsyncWriter::SPtr(new FiffAsyncWriter(this, queue_size, drop_when_full));
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStream::stop_async_writing()
+{
+    if(!m_pAsyncWriter)
+        return;
+
+    m_pAsyncWriter->stop();
+
+    FiffAsyncWriterStats stats = m_pAsyncWriter->stats();
+    if(stats.dropped > 0)
+        qWarning("FiffStream::stop_async_writing - %lld of %lld raw buffers were dropped", stats.dropped, stats.dropped + stats.queued);
+
+    m_pAsyncWriter.clear();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::is_async_writing() const
+{
+    return !m_pAsyncWriter.isNull();
+}
+
+
+//*************************************************************************************************************
+
+FiffAsyncWriterStats FiffStream::async_writing_stats() const
+{
+    if(m_pAsyncWriter)
+        return m_pAsyncWriter->stats();
+
+    FiffAsyncWriterStats stats;
+    stats.queued = 0;
+    stats.written = 0;
+    stats.dropped = 0;
+    stats.waits = 0;
+    stats.maxFill = 0;
+
+    return stats;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStream::set_raw_compression(bool enable, qint32 block_size)
+{
+    m_iRawCompressionBlock = enable ? qMax(block_size, 1) : 0;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::raw_compression() const
+{
+    return m_iRawCompressionBlock > 0;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::start_split_writing(fiff_long_t split_size, fiff_int_t first_sample)
+{
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!m_pRawSplitter || !t_pFile || split_size <= 0) {
+        qWarning("FiffStream::start_split_writing - Split writing needs a raw file started with start_writing_raw.");
+        return false;
+    }
+
+    if(m_pRawSplitter->isActive())
+        return false;
+
+    m_pRawSplitter->start(t_pFile->fileName(), split_size, first_sample);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::is_split_writing() const
+{
+    return m_pRawSplitter && m_pRawSplitter->isActive();
 }
 
 
@@ -376,19 +503,101 @@ bool FiffStream::close()
 }
 
 
+//*************************************************************************************************************
+
+bool FiffStream::map_file()
+{
+    if(m_pMappedData)
+        return true;
+
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!t_pFile)
+        return false;
+
+    if(!t_pFile->isOpen() && !t_pFile->open(QIODevice::ReadOnly)) {
+        qWarning("FiffStream::map_file - Cannot open %s", t_pFile->fileName().toUtf8().constData());
+        return false;
+    }
+
+    //
+    //   The mapping stays valid after the file was closed, it is released when the file object is destroyed
+    //
+    qint64 size = t_pFile->size();
+    if(size <= 0)
+        return false;
+
+    m_pMappedData = t_pFile->map(0, size);
+    if(!m_pMappedData) {
+        qWarning("FiffStream::map_file - Cannot map %s (%s)", t_pFile->fileName().toUtf8().constData(), t_pFile->errorString().toUtf8().constData());
+        return false;
+    }
+    m_pMappedFile = t_pFile;
+    m_iMappedSize = size;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void FiffStream::unmap_file()
+{
+    if(!m_pMappedData)
+        return;
+
+    if(m_pMappedFile)
+        m_pMappedFile->unmap(m_pMappedData);
+
+    m_pMappedFile.clear();
+    m_pMappedData = Q_NULLPTR;
+    m_iMappedSize = 0;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::is_mapped() const
+{
+    //
+    //   QFile releases all its mappings on destruction
+    //
+    return m_pMappedData != Q_NULLPTR && !m_pMappedFile.isNull();
+}
+
+
+//*************************************************************************************************************
+
+const uchar* FiffStream::mapped_data(fiff_long_t pos, fiff_long_t size) const
+{
+    if(!is_mapped() || pos < 0 || size < 0 || pos + size > m_iMappedSize)
+        return Q_NULLPTR;
+
+    return m_pMappedData + pos;
+}
+
+
 //*************************************************************************************************************
 
 FiffDirNode::SPtr FiffStream::make_subtree(QList<FiffDirEntry::SPtr> &dentry)
+{
+    return this->make_subtree(dentry, 0, Q_NULLPTR);
+}
+
+
+//*************************************************************************************************************
+
+FiffDirNode::SPtr FiffStream::make_subtree(const QList<FiffDirEntry::SPtr> &dentry, qint32 start, qint32* end)
 {
     FiffDirNode::SPtr defaultNode;
     FiffDirNode::SPtr node = FiffDirNode::SPtr(new FiffDirNode);
     FiffDirNode::SPtr child;
     FiffTag::SPtr t_pTag;
     QList<FiffDirEntry::SPtr> dir;
-    qint32 current = 0;
+    qint32 current = start;
+
+    if (start >= dentry.size())
+        return defaultNode;
 
-    node->dir_tree    = dentry;
-    node->nent_tree   = 1;
     node->parent      = FiffDirNode::SPtr();
     node->type = FIFFB_ROOT;
 
@@ -403,40 +612,49 @@ FiffDirNode::SPtr FiffStream::make_subtree(QList<FiffDirEntry::SPtr> &dentry)
     }
 
     ++current;
-    int level = 0;
     for (; current < dentry.size(); ++current) {
-        ++node->nent_tree;
-        if (dentry[current]->kind == FIFF_BLOCK_START) {
-            level++;
-            if (level == 1) {
-                QList<FiffDirEntry::SPtr> sub_dentry = dentry.mid(current);
-                if (!(child = this->make_subtree(sub_dentry)))
-                    return defaultNode;
-                child->parent = node;
-                node->children.append(child);
-            }
-        }
-        else if (dentry[current]->kind == FIFF_BLOCK_END) {
-            level--;
-            if (level < 0)
+        fiff_int_t kind = dentry[current]->kind;
+        if (kind == FIFF_BLOCK_START) {
+            //
+            //  The child works on the same list and tells where its block ends, no copies of the remaining entries
+            //
+            qint32 child_end;
+            if (!(child = this->make_subtree(dentry, current, &child_end)))
+                return defaultNode;
+            child->parent = node;
+            node->children.append(child);
+            current = child_end;
+            if (dentry[current]->kind == -1)
                 break;
         }
-        else if (dentry[current]->kind == -1)
+        else if (kind == FIFF_BLOCK_END)
+            break;
+        else if (kind == -1)
             break;
-        else if (level == 0) {
+        else {
             /*
             * Take the node id from the parent block id,
             * block id, or file id. Let the block id
             * take precedence over parent block id and file id
             */
-            if (((dentry[current]->kind == FIFF_PARENT_BLOCK_ID || dentry[current]->kind == FIFF_FILE_ID) && node->id.isEmpty()) || dentry[current]->kind == FIFF_BLOCK_ID) {
+            if (((kind == FIFF_PARENT_BLOCK_ID || kind == FIFF_FILE_ID) && node->id.isEmpty()) || kind == FIFF_BLOCK_ID) {
                 if (!this->read_tag(t_pTag,dentry[current]->pos))
                     return defaultNode;
                 node->id = t_pTag->toFiffID();
             }
-            dir.append(FiffDirEntry::SPtr(new FiffDirEntry(*dentry[current])));//Memcopy necessary here - or is a pointer fine?
+            dir.append(dentry[current]);//The entries are shared between the stream directory and the nodes
         }
     }
+
+    //
+    //  The subtree covers the entries up to and including the closing FIFF_BLOCK_END
+    //
+    qint32 last = qMin(current, dentry.size() - 1);
+    node->nent_tree   = last - start + 1;
+    node->dir_tree    = dentry.mid(start, node->nent_tree);
+    if (end)
+        *end = last;
+
     /*
     * Strip unused entries
     */
@@ -974,7 +1192,7 @@ bool FiffStream::read_meas_info_base(const FiffDirNode::SPtr& p_Node, FiffInfoBa
 
 //*************************************************************************************************************
 
-bool FiffStream::read_meas_info(const FiffDirNode::SPtr& p_Node, FiffInfo& info, FiffDirNode::SPtr& p_NodeInfo)
+bool FiffStream::read_meas_info(const FiffDirNode::SPtr& p_Node, FiffInfo& info, FiffDirNode::SPtr& p_NodeInfo, int p_iFields)
 {
 //    if (info)
 //        delete info;
@@ -1052,6 +1270,8 @@ bool FiffStream::read_meas_info(const FiffDirNode::SPtr& p_Node, FiffInfo& info,
                 meas_date[1] = t_pTag->toInt()[1];
                 break;
             case FIFF_COORD_TRANS:
+                if (!(p_iFields & MeasInfoCoordTrans))
+                    break;
                 //ToDo: This has to be debugged!!
                 this->read_tag(t_pTag, pos);
                 cand = t_pTag->toCoordTrans();
@@ -1086,7 +1306,7 @@ bool FiffStream::read_meas_info(const FiffDirNode::SPtr& p_Node, FiffInfo& info,
         return false;
     }
 
-    if (dev_head_t.isEmpty() || ctf_head_t.isEmpty())
+    if ((p_iFields & MeasInfoCoordTrans) && (dev_head_t.isEmpty() || ctf_head_t.isEmpty()))
     {
         QList<FiffDirNode::SPtr> hpi_result = meas_info[0]->dir_tree_find(FIFFB_HPI_RESULT);
         if (hpi_result.size() == 1)
@@ -1110,7 +1330,9 @@ bool FiffStream::read_meas_info(const FiffDirNode::SPtr& p_Node, FiffInfo& info,
     //
     //   Locate the Polhemus data
     //
-    QList<FiffDirNode::SPtr> isotrak = meas_info[0]->dir_tree_find(FIFFB_ISOTRAK);
+    QList<FiffDirNode::SPtr> isotrak;
+    if (p_iFields & MeasInfoDig)
+        isotrak = meas_info[0]->dir_tree_find(FIFFB_ISOTRAK);
 
     QList<FiffDigPoint> dig;
     fiff_int_t coord_frame = FIFFV_COORD_HEAD;
@@ -1155,7 +1377,9 @@ bool FiffStream::read_meas_info(const FiffDirNode::SPtr& p_Node, FiffInfo& info,
     //
     //   Locate the acquisition information
     //
-    QList<FiffDirNode::SPtr> acqpars = meas_info[0]->dir_tree_find(FIFFB_DACQ_PARS);
+    QList<FiffDirNode::SPtr> acqpars;
+    if (p_iFields & MeasInfoAcqPars)
+        acqpars = meas_info[0]->dir_tree_find(FIFFB_DACQ_PARS);
     QString acq_pars;
     QString acq_stim;
     if (acqpars.size() == 1)
@@ -1179,15 +1403,21 @@ bool FiffStream::read_meas_info(const FiffDirNode::SPtr& p_Node, FiffInfo& info,
     //
     //   Load the SSP data
     //
-    QList<FiffProj> projs = this->read_proj(meas_info[0]);//ToDo Member Function
+    QList<FiffProj> projs;
+    if (p_iFields & MeasInfoProjs)
+        projs = this->read_proj(meas_info[0]);//ToDo Member Function
     //
     //   Load the CTF compensation data
     //
-    QList<FiffCtfComp> comps = this->read_ctf_comp(meas_info[0], chs);//ToDo Member Function
+    QList<FiffCtfComp> comps;
+    if (p_iFields & MeasInfoComps)
+        comps = this->read_ctf_comp(meas_info[0], chs);//ToDo Member Function
     //
     //   Load the bad channel list
     //
-    QStringList bads = this->read_bad_channels(p_Node);
+    QStringList bads;
+    if (p_iFields & MeasInfoBads)
+        bads = this->read_bad_channels(p_Node);
     //
     //   Put the data together
     //
@@ -1645,6 +1875,8 @@ bool FiffStream::read_rt_tag(FiffTag::SPtr &p_pTag)
 
 bool FiffStream::read_tag(FiffTag::SPtr &p_pTag, fiff_long_t pos)
 {
+    MNE_TRACE_SCOPE("FiffStream::read_tag", "fiff");
+
     if (pos >= 0) {
         this->device()->seek(pos);
     }
@@ -1681,7 +1913,7 @@ bool FiffStream::read_tag(FiffTag::SPtr &p_pTag, fiff_long_t pos)
 
 //*************************************************************************************************************
 
-bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool allow_maxshield)
+bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool allow_maxshield, bool use_rawdir_cache, int meas_info_fields)
 {
     //
     //   Open the file
@@ -1699,7 +1931,7 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
     //
     FiffInfo info;// = NULL;
     FiffDirNode::SPtr meas;
-    if(!t_pStream->read_meas_info(t_pStream->dirtree(), info, meas))
+    if(!t_pStream->read_meas_info(t_pStream->dirtree(), info, meas, meas_info_fields))
         return false;
 
     //
@@ -1741,115 +1973,149 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
     data.first_samp = 0;
     data.last_samp  = 0;
     //
-    //   Process the directory
+    //   Reuse the raw directory of a previous session if a valid cache exists
     //
+    bool t_bCached = use_rawdir_cache && data.read_rawdir_cache(t_sFileName, t_pStream->id());
+    if (t_bCached)
+        printf("\tRaw directory read from %s\n", FiffRawData::rawdir_cache_name(t_sFileName).toUtf8().constData());
 
-    QList<FiffDirEntry::SPtr> dir = raw[0]->dir;
-    fiff_int_t nent = raw[0]->nent();
-    fiff_int_t nchan = info.nchan;
-    fiff_int_t first = 0;
-    fiff_int_t first_samp = 0;
-    fiff_int_t first_skip = 0;
-    //
-    //  Get first sample tag if it is there
-    //
-    FiffTag::SPtr t_pTag;
-    if (dir[first]->kind == FIFF_FIRST_SAMPLE)
+    if (!t_bCached)
     {
-        t_pStream->read_tag(t_pTag, dir[first]->pos);
-        first_samp = *t_pTag->toInt();
-        ++first;
-    }
+        //
+        //   Process the directory
+        //
 
-    //
-    //  Omit initial skip
-    //
-    if (dir[first]->kind == FIFF_DATA_SKIP)
-    {
+        QList<FiffDirEntry::SPtr> dir = raw[0]->dir;
+        fiff_int_t nent = raw[0]->nent();
+        fiff_int_t nchan = info.nchan;
+        fiff_int_t first = 0;
+        fiff_int_t first_samp = 0;
+        fiff_int_t first_skip = 0;
         //
-        //  This first skip can be applied only after we know the buffer size
+        //  Get first sample tag if it is there
         //
-        t_pStream->read_tag(t_pTag, dir[first]->pos);
-        first_skip = *t_pTag->toInt();
-        ++first;
-    }
-    data.first_samp = first_samp;
-    //
-    //   Go through the remaining tags in the directory
-    //
-    QList<FiffRawDir> rawdir;
-//        rawdir = struct('ent',{},'first',{},'last',{},'nsamp',{});
-    fiff_int_t nskip = 0;
-    fiff_int_t ndir  = 0;
-    fiff_int_t nsamp = 0;
-    for (qint32 k = first; k < nent; ++k)
-    {
-        FiffDirEntry::SPtr ent = dir[k];
-        if (ent->kind == FIFF_DATA_SKIP)
+        FiffTag::SPtr t_pTag;
+        if (dir[first]->kind == FIFF_FIRST_SAMPLE)
         {
-            t_pStream->read_tag(t_pTag, ent->pos);
-            nskip = *t_pTag->toInt();
+            t_pStream->read_tag(t_pTag, dir[first]->pos);
+            first_samp = *t_pTag->toInt();
+            ++first;
         }
-        else if(ent->kind == FIFF_DATA_BUFFER)
+
+        //
+        //  Omit initial skip
+        //
+        if (dir[first]->kind == FIFF_DATA_SKIP)
         {
             //
-            //   Figure out the number of samples in this buffer
+            //  This first skip can be applied only after we know the buffer size
             //
-            switch(ent->type)
-            {
-                case FIFFT_DAU_PACK16:
-                    nsamp = ent->size/(2*nchan);
-                    break;
-                case FIFFT_SHORT:
-                    nsamp = ent->size/(2*nchan);
-                    break;
-                case FIFFT_FLOAT:
-                    nsamp = ent->size/(4*nchan);
-                    break;
-                case FIFFT_INT:
-                    nsamp = ent->size/(4*nchan);
-                    break;
-                default:
-                    printf("Cannot handle data buffers of type %d\n",ent->type);
-                    return false;
-            }
-            //
-            //  Do we have an initial skip pending?
-            //
-            if (first_skip > 0)
+            t_pStream->read_tag(t_pTag, dir[first]->pos);
+            first_skip = *t_pTag->toInt();
+            ++first;
+        }
+        data.first_samp = first_samp;
+        //
+        //   Go through the remaining tags in the directory
+        //
+        QList<FiffRawDir> rawdir;
+    //        rawdir = struct('ent',{},'first',{},'last',{},'nsamp',{});
+        fiff_int_t nskip = 0;
+        fiff_int_t ndir  = 0;
+        fiff_int_t nsamp = 0;
+        for (qint32 k = first; k < nent; ++k)
+        {
+            FiffDirEntry::SPtr ent = dir[k];
+            if (ent->kind == FIFF_DATA_SKIP)
             {
-                first_samp += nsamp*first_skip;
-                data.first_samp = first_samp;
-                first_skip = 0;
+                t_pStream->read_tag(t_pTag, ent->pos);
+                nskip = *t_pTag->toInt();
             }
-            //
-            //  Do we have a skip pending?
-            //
-            if (nskip > 0)
+            else if(ent->kind == FIFF_DATA_BUFFER)
             {
+                //
+                //   Figure out the number of samples in this buffer
+                //
+                switch(ent->type)
+                {
+                    case FIFFT_DAU_PACK16:
+                        nsamp = ent->size/(2*nchan);
+                        break;
+                    case FIFFT_SHORT:
+                        nsamp = ent->size/(2*nchan);
+                        break;
+                    case FIFFT_FLOAT:
+                        nsamp = ent->size/(4*nchan);
+                        break;
+                    case FIFFT_INT:
+                        nsamp = ent->size/(4*nchan);
+                        break;
+                    case FIFFT_COMPRESSED_RAW:
+                    {
+                        //
+                        //  The compressed buffers carry their dimensions in the header
+                        //
+                        fiff_int_t type, nchan_buf;
+                        t_pStream->device()->seek(ent->pos + FIFFC_DATA_OFFSET);
+                        *t_pStream >> type >> nchan_buf >> nsamp;
+                        if (nchan_buf != nchan)
+                        {
+                            printf("Compressed data buffer has %d channels instead of %d\n", nchan_buf, nchan);
+                            return false;
+                        }
+                        break;
+                    }
+                    default:
+                        printf("Cannot handle data buffers of type %d\n",ent->type);
+                        return false;
+                }
+                //
+                //  Do we have an initial skip pending?
+                //
+                if (first_skip > 0)
+                {
+                    first_samp += nsamp*first_skip;
+                    data.first_samp = first_samp;
+                    first_skip = 0;
+                }
+                //
+                //  Do we have a skip pending?
+                //
+                if (nskip > 0)
+                {
+                    //
+                    //  The skip gets an empty entry of kind -1, which the readers translate to zeros
+                    //
+                    FiffRawDir t_RawDir;
+                    t_RawDir.ent   = FiffDirEntry::SPtr(new FiffDirEntry);
+                    t_RawDir.first = first_samp;
+                    t_RawDir.last  = first_samp + nskip*nsamp - 1;//ToDo -1 right or is that MATLAB syntax
+                    t_RawDir.nsamp = nskip*nsamp;
+                    rawdir.append(t_RawDir);
+                    first_samp = first_samp + nskip*nsamp;
+                    nskip = 0;
+                    ++ndir;
+                }
+                //
+                //  Add a data buffer
+                //
                 FiffRawDir t_RawDir;
+                t_RawDir.ent  = ent;
                 t_RawDir.first = first_samp;
-                t_RawDir.last  = first_samp + nskip*nsamp - 1;//ToDo -1 right or is that MATLAB syntax
-                t_RawDir.nsamp = nskip*nsamp;
+                t_RawDir.last  = first_samp + nsamp - 1;//ToDo -1 right or is that MATLAB syntax
+                t_RawDir.nsamp = nsamp;
                 rawdir.append(t_RawDir);
-                first_samp = first_samp + nskip*nsamp;
-                nskip = 0;
+                first_samp += nsamp;
                 ++ndir;
             }
-            //
-            //  Add a data buffer
-            //
-            FiffRawDir t_RawDir;
-            t_RawDir.ent  = ent;
-            t_RawDir.first = first_samp;
-            t_RawDir.last  = first_samp + nsamp - 1;//ToDo -1 right or is that MATLAB syntax
-            t_RawDir.nsamp = nsamp;
-            rawdir.append(t_RawDir);
-            first_samp += nsamp;
-            ++ndir;
         }
+        data.last_samp  = first_samp - 1;//ToDo -1 right or is that MATLAB syntax
+        data.rawdir     = rawdir;
+        data.build_rawdir_index();
+
+        if (use_rawdir_cache && !data.write_rawdir_cache(t_sFileName))
+            printf("\tCould not write raw directory cache %s\n", FiffRawData::rawdir_cache_name(t_sFileName).toUtf8().constData());
     }
-    data.last_samp  = first_samp - 1;//ToDo -1 right or is that MATLAB syntax
     //
     //   Add the calibration factors
     //
@@ -1859,7 +2125,6 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
         cals[k] = data.info.chs[k].range*data.info.chs[k].cal;
     //
     data.cals       = cals;
-    data.rawdir     = rawdir;
     //data->proj       = [];
     //data.comp       = [];
     //
@@ -1868,8 +2133,80 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
            (double)data.first_samp/data.info.sfreq,
            (double)data.last_samp/data.info.sfreq);
     printf("Ready.\n");
+
+    //
+    //   Is the recording continued in a split file?
+    //
+    QString t_sNextFile;
+    QFile* t_pFile = qobject_cast<QFile*>(&p_IODevice);
+    if (t_pFile)
+    {
+        QList<FiffDirNode::SPtr> refs = t_pStream->dirtree()->dir_tree_find(FIFFB_REF);
+        FiffTag::SPtr t_pTag;
+        for (qint32 k = 0; k < refs.size(); ++k)
+        {
+            if (!refs[k]->find_tag(t_pStream, FIFF_REF_ROLE, t_pTag) || *t_pTag->toInt() != FIFFV_ROLE_NEXT_FILE)
+                continue;
+            if (refs[k]->find_tag(t_pStream, FIFF_REF_FILE_NAME, t_pTag))
+                t_sNextFile = QFileInfo(t_sFileName).dir().filePath(t_pTag->toString());
+            break;
+        }
+    }
+
     data.file->close();
 
+    //
+    //   Read the following parts, they are set up on their own and appended to the split list
+    //
+    if (!t_sNextFile.isEmpty())
+    {
+        if (!QFile::exists(t_sNextFile))
+        {
+            printf("\tSplit file %s is missing, the data ends with %s\n", t_sNextFile.toUtf8().constData(), t_sFileName.toUtf8().constData());
+            return true;
+        }
+
+        QSharedPointer<QFile> t_pNextFile(new QFile(t_sNextFile));
+        FiffRawData::SPtr t_pNext(new FiffRawData);
+        if (!setup_read_raw(*t_pNextFile, *t_pNext, allow_maxshield, use_rawdir_cache, meas_info_fields))
+            return false;
+        t_pNext->split_device = t_pNextFile;
+
+        data.splits << t_pNext << t_pNext->splits;
+        t_pNext->splits.clear();
+
+        //
+        //   Each part has to continue where the previous one ended
+        //
+        fiff_int_t t_iLast = data.rawdir.isEmpty() ? data.first_samp - 1 : data.rawdir.last().last;
+        for (qint32 k = 0; k < data.splits.size(); ++k)
+        {
+            FiffRawData::SPtr t_pPart = data.splits[k];
+            t_pPart->last_samp = t_pPart->rawdir.isEmpty() ? t_pPart->first_samp - 1 : t_pPart->rawdir.last().last;
+
+            fiff_int_t shift = t_iLast + 1 - t_pPart->first_samp;
+            if (shift != 0)
+            {
+                t_pPart->first_samp += shift;
+                t_pPart->last_samp += shift;
+                for (qint32 j = 0; j < t_pPart->rawdir.size(); ++j)
+                {
+                    t_pPart->rawdir[j].first += shift;
+                    t_pPart->rawdir[j].last += shift;
+                }
+                t_pPart->build_rawdir_index();
+            }
+            t_iLast = t_pPart->last_samp;
+        }
+        data.last_samp = t_iLast;
+
+        printf("\tRange of the %d split files : %d ... %d  =  %9.3f ... %9.3f secs\n",
+               data.splits.size() + 1,
+               data.first_samp,data.last_samp,
+               (double)data.first_samp/data.info.sfreq,
+               (double)data.last_samp/data.info.sfreq);
+    }
+
     return true;
 }
 
@@ -2013,6 +2350,8 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice, const Fiff
     //  Create the file and save the essentials
     //
     FiffStream::SPtr t_pStream = start_file(p_IODevice);//1, 2, 3
+    if(!t_pStream)
+        return t_pStream;
     t_pStream->start_block(FIFFB_MEAS);//4
     t_pStream->write_id(FIFF_BLOCK_ID);//5
     if(info.meas_id.version != -1)
@@ -2177,6 +2516,8 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice, const Fiff
     //
     t_pStream->start_block(FIFFB_RAW_DATA);
 
+    t_pStream->m_pRawSplitter = QSharedPointer<FiffRawSplitter>(new FiffRawSplitter(info, sel, resetRange));
+
     return t_pStream;
 }
 
@@ -2185,6 +2526,8 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice, const Fiff
 
 fiff_long_t FiffStream::write_tag(const QSharedPointer<FiffTag> &p_pTag, fiff_long_t pos)
 {
+    flush_async_writing();
+
     /*
     * Write tag to specified position
     */
@@ -2223,7 +2566,7 @@ fiff_long_t FiffStream::write_tag(const QSharedPointer<FiffTag> &p_pTag, fiff_lo
 
 fiff_long_t FiffStream::write_ch_info(const FiffChInfo& ch)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     //typedef struct _fiffChPosRec {
     //  fiff_int_t   coil_type;          /*!< What kind of coil. */
@@ -2301,7 +2644,7 @@ fiff_long_t FiffStream::write_ch_info(const FiffChInfo& ch)
 
 fiff_long_t FiffStream::write_ch_pos(const FiffChPos &chpos)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     //
     //   FiffChPos
@@ -2330,7 +2673,7 @@ fiff_long_t FiffStream::write_ch_pos(const FiffChPos &chpos)
 
 fiff_long_t FiffStream::write_coord_trans(const FiffCoordTrans& trans)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     //?typedef struct _fiffCoordTransRec {
     //  fiff_int_t   from;                   /*!< Source coordinate system. */
@@ -2380,7 +2723,7 @@ fiff_long_t FiffStream::write_coord_trans(const FiffCoordTrans& trans)
 
 fiff_long_t FiffStream::write_cov(const FiffCov &p_FiffCov)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     this->start_block(FIFFB_MNE_COV);
 
@@ -2454,7 +2797,7 @@ fiff_long_t FiffStream::write_cov(const FiffCov &p_FiffCov)
 
 fiff_long_t FiffStream::write_ctf_comp(const QList<FiffCtfComp>& comps)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     if (comps.size() <= 0)
         return -1;
@@ -2493,7 +2836,7 @@ fiff_long_t FiffStream::write_ctf_comp(const QList<FiffCtfComp>& comps)
 
 fiff_long_t FiffStream::write_dig_point(const FiffDigPoint& dig)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     //?typedef struct _fiffDigPointRec {
     //  fiff_int_t kind;               /*!< FIFF_POINT_CARDINAL,
@@ -2525,6 +2868,8 @@ fiff_long_t FiffStream::write_dig_point(const FiffDigPoint& dig)
 
 fiff_long_t FiffStream::write_dir_pointer(fiff_int_t dirpos, fiff_long_t pos, fiff_int_t next)
 {
+    flush_async_writing();
+
     /*
     * Write entires to specified position
     */
@@ -2565,6 +2910,8 @@ fiff_long_t FiffStream::write_dir_entries(const QList<FiffDirEntry::SPtr> &dir,
 //                      * FIFFC_DATA_OFFSET *
 //     } fiffDirEntryRec,*fiffDirEntry;/**< Directory is composed of these *
 
+    flush_async_writing();
+
     /*
     * Write entires to specified position
     */
@@ -2606,7 +2953,7 @@ fiff_long_t FiffStream::write_dir_entries(const QList<FiffDirEntry::SPtr> &dir,
 
 fiff_long_t FiffStream::write_double(fiff_int_t kind, const double* data, fiff_int_t nel)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     qint32 datasize = nel * 8;
 
@@ -2628,7 +2975,7 @@ fiff_long_t FiffStream::write_double(fiff_int_t kind, const double* data, fiff_i
 
 fiff_long_t FiffStream::write_float(fiff_int_t kind, const float* data, fiff_int_t nel)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     qint32 datasize = nel * 4;
 
@@ -2650,7 +2997,7 @@ fiff_long_t FiffStream::write_float(fiff_int_t kind, const float* data, fiff_int
 
 fiff_long_t FiffStream::write_float_matrix(fiff_int_t kind, const MatrixXf& mat)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     qint32 numel = mat.rows() * mat.cols();
 
@@ -2683,7 +3030,7 @@ fiff_long_t FiffStream::write_float_matrix(fiff_int_t kind, const MatrixXf& mat)
 
 fiff_long_t FiffStream::write_float_sparse_ccs(fiff_int_t kind, const SparseMatrix<float>& mat)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     //
     //   nnz values
@@ -2777,7 +3124,7 @@ fiff_long_t FiffStream::write_float_sparse_ccs(fiff_int_t kind, const SparseMatr
 
 fiff_long_t FiffStream::write_float_sparse_rcs(fiff_int_t kind, const SparseMatrix<float>& mat)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     //
     //   nnz values
@@ -2877,7 +3224,7 @@ fiff_long_t FiffStream::write_float_sparse_rcs(fiff_int_t kind, const SparseMatr
 
 fiff_long_t FiffStream::write_id(fiff_int_t kind, const FiffId& id)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     FiffId t_id = id;
 
@@ -2917,7 +3264,7 @@ fiff_long_t FiffStream::write_id(fiff_int_t kind, const FiffId& id)
 
 fiff_long_t FiffStream::write_info_base(const FiffInfoBase & p_FiffInfoBase)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     //
     // Information from the MEG file
@@ -2986,7 +3333,7 @@ fiff_long_t FiffStream::write_info_base(const FiffInfoBase & p_FiffInfoBase)
 
 fiff_long_t FiffStream::write_int(fiff_int_t kind, const fiff_int_t* data, fiff_int_t nel, fiff_int_t next)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     fiff_int_t datasize = nel * 4;
 
@@ -3006,7 +3353,7 @@ fiff_long_t FiffStream::write_int(fiff_int_t kind, const fiff_int_t* data, fiff_
 
 fiff_long_t FiffStream::write_int_matrix(fiff_int_t kind, const MatrixXi& mat)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
 //    qint32 FIFFT_MATRIX = 1 << 30;
 //    qint32 FIFFT_MATRIX_INT = FIFFT_INT | FIFFT_MATRIX;
@@ -3051,7 +3398,7 @@ fiff_long_t FiffStream::write_name_list(fiff_int_t kind, const QStringList& data
 
 fiff_long_t FiffStream::write_named_matrix(fiff_int_t kind, const FiffNamedMatrix& mat)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     this->start_block(FIFFB_MNE_NAMED_MATRIX);
     this->write_int(FIFF_MNE_NROW, &mat.nrow);
@@ -3071,7 +3418,7 @@ fiff_long_t FiffStream::write_named_matrix(fiff_int_t kind, const FiffNamedMatri
 
 fiff_long_t FiffStream::write_proj(const QList<FiffProj>& projs)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     if (projs.size() <= 0)
         return -1;
@@ -3107,6 +3454,9 @@ fiff_long_t FiffStream::write_proj(const QList<FiffProj>& projs)
 
 bool FiffStream::write_raw_buffer(const MatrixXd& buf, const RowVectorXd& cals)
 {
+    if (m_pAsyncWriter)
+        return m_pAsyncWriter->enqueue(buf, cals);
+
     if (buf.rows() != cals.cols())
     {
         printf("buffer and calibration sizes do not match\n");
@@ -3122,8 +3472,7 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const RowVectorXd& cals)
     SparseMatrix<double> inv_calsMat(cals.cols(), cals.cols());
     inv_calsMat.setFromTriplets(tripletList.begin(), tripletList.end());
 
-    MatrixXf tmp = (inv_calsMat*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    this->write_float_buffer((inv_calsMat*buf).cast<float>());
     return true;
 }
 
@@ -3132,6 +3481,9 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const RowVectorXd& cals)
 
 bool FiffStream::write_raw_buffer(const MatrixXd& buf, const SparseMatrix<double>& mult)
 {
+    if (m_pAsyncWriter)
+        return m_pAsyncWriter->enqueue(buf, mult);
+
     if (buf.rows() != mult.cols()) {
         printf("buffer and mult sizes do not match\n");
         return false;
@@ -3142,8 +3494,7 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const SparseMatrix<double
       for (SparseMatrix<double>::InnerIterator it(mult,k); it; ++it)
         inv_mult.coeffRef(it.row(),it.col()) = 1/it.value();
 
-    MatrixXf tmp = (inv_mult*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    this->write_float_buffer((inv_mult*buf).cast<float>());
     return true;
 }
 
@@ -3152,8 +3503,10 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const SparseMatrix<double
 
 bool FiffStream::write_raw_buffer(const MatrixXd& buf)
 {
-    MatrixXf tmp = buf.cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    if (m_pAsyncWriter)
+        return m_pAsyncWriter->enqueue(buf);
+
+    this->write_float_buffer(buf.cast<float>());
     return true;
 }
 
@@ -3162,7 +3515,7 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf)
 
 fiff_long_t FiffStream::write_string(fiff_int_t kind, const QString& data)
 {
-    fiff_long_t pos = this->device()->pos();
+    fiff_long_t pos = this->write_position();
 
     fiff_int_t datasize = data.size();
     *this << (qint32)kind;
@@ -3180,6 +3533,8 @@ fiff_long_t FiffStream::write_string(fiff_int_t kind, const QString& data)
 
 void FiffStream::write_rt_command(fiff_int_t command, const QString& data)
 {
+    flush_async_writing();
+
     fiff_int_t datasize = data.size();
     *this << (qint32)FIFF_MNE_RT_COMMAND;
     *this << (qint32)FIFFT_VOID;
@@ -3191,37 +3546,134 @@ void FiffStream::write_rt_command(fiff_int_t command, const QString& data)
 }
 
 
+//*************************************************************************************************************
+
+void FiffStream::flush_async_writing()
+{
+    if(m_pAsyncWriter && QThread::currentThread() != m_pAsyncWriter.data())
+        m_pAsyncWriter->flush();
+}
+
+
+//*************************************************************************************************************
+
+fiff_long_t FiffStream::write_position()
+{
+    flush_async_writing();
+
+    return this->device()->pos();
+}
+
+
+//*************************************************************************************************************
+
+fiff_long_t FiffStream::write_float_buffer(const MatrixXf& buf)
+{
+    fiff_long_t pos;
+
+    if (m_iRawCompressionBlock > 0)
+    {
+        QByteArray compressed = FiffRawCompression::compress(buf, m_iRawCompressionBlock);
+
+        if(m_pRawSplitter && m_pRawSplitter->needsRollover(this->device()->pos(), 16 + compressed.size()))
+            m_pRawSplitter->rollover(this);
+        pos = this->device()->pos();
+
+        *this << (qint32)FIFF_DATA_BUFFER;
+        *this << (qint32)FIFFT_COMPRESSED_RAW;
+        *this << (qint32)compressed.size();
+        *this << (qint32)FIFFV_NEXT_SEQ;
+
+        this->writeRawData(compressed.constData(), compressed.size());
+
+        if(m_pRawSplitter)
+            m_pRawSplitter->addSamples(buf.cols());
+        return pos;
+    }
+
+    qint32 nel = buf.rows()*buf.cols();
+    qint32 datasize = nel * 4;
+
+    if(m_pRawSplitter && m_pRawSplitter->needsRollover(this->device()->pos(), 16 + datasize))
+        m_pRawSplitter->rollover(this);
+    pos = this->device()->pos();
+
+    *this << (qint32)FIFF_DATA_BUFFER;
+    *this << (qint32)FIFFT_FLOAT;
+    *this << (qint32)datasize;
+    *this << (qint32)FIFFV_NEXT_SEQ;
+
+    const float* data = buf.data();
+    for(qint32 i = 0; i < nel; ++i)
+        *this << data[i];
+
+    if(m_pRawSplitter)
+        m_pRawSplitter->addSamples(buf.cols());
+
+    return pos;
+}
+
+
 //*************************************************************************************************************
 
 QList<FiffDirEntry::SPtr> FiffStream::make_dir(bool *ok)
 {
-    FiffTag::SPtr t_pTag;
     QList<FiffDirEntry::SPtr> dir;
     FiffDirEntry::SPtr t_pFiffDirEntry;
     fiff_long_t pos;
+    qint32 kind, type, size, next;
     if(ok) *ok = false;
     /*
     * Start from the very beginning...
     */
     if(!this->device()->seek(SEEK_SET))
         return dir;
-    while ((pos = this->read_tag_info(t_pTag)) != -1) {
+
+    //
+    //  Only the tag headers are read, the data is skipped without allocating a tag for it
+    //
+    QTcpSocket* t_qTcpSocket = qobject_cast<QTcpSocket*>(this->device());
+    while (!this->atEnd()) {
+        pos = this->device()->pos();
+        *this >> kind;
+        *this >> type;
+        *this >> size;
+        *this >> next;
+        if (this->status() != QDataStream::Ok)
+            break;
         /*
         * Check that we haven't run into the directory
         */
-        if (t_pTag->kind == FIFF_DIR)
+        if (kind == FIFF_DIR)
             break;
         /*
         * Put in the new entry
         */
         t_pFiffDirEntry = FiffDirEntry::SPtr(new FiffDirEntry);
-        t_pFiffDirEntry->kind = t_pTag->kind;
-        t_pFiffDirEntry->type = t_pTag->type;
-        t_pFiffDirEntry->size = t_pTag->size();
+        t_pFiffDirEntry->kind = kind;
+        t_pFiffDirEntry->type = type;
+        t_pFiffDirEntry->size = size;
         t_pFiffDirEntry->pos = (fiff_long_t)pos;
         dir.append(t_pFiffDirEntry);
-        if (t_pTag->next < 0)
+        if (next < 0)
             break;
+        /*
+        * Skip the data
+        */
+        if (t_qTcpSocket)
+            this->skipRawData(size);
+        else if (next > 0) {
+            if(!this->device()->seek(next)) {
+                qCritical("fseek");
+                break;
+            }
+        }
+        else if (size > 0 && next == FIFFV_NEXT_SEQ) {
+            if(!this->device()->seek(this->device()->pos()+size)) {
+                qCritical("fseek");
+                break;
+            }
+        }
     }
     /*
     * Put in the new the terminating entry
@@ -47,6 +47,7 @@
 
 #include "fiff_dir_node.h"
 #include "fiff_dir_entry.h"
+#include "fiff_async_writer.h"
 
 
 
@@ -66,8 +67,10 @@
 
 #include <QByteArray>
 #include <QDataStream>
+#include <QFile>
 #include <QIODevice>
 #include <QList>
+#include <QPointer>
 #include <QSharedPointer>
 #include <QString>
 #include <QStringList>
@@ -100,6 +103,8 @@ class FiffChInfo;
 class FiffChPos;
 class FiffCoordTrans;
 class FiffDigitizerData;
+class FiffAsyncWriter;
+class FiffRawSplitter;
 
 static FiffId defaultFiffId;
 
@@ -126,6 +131,22 @@ public:
     typedef QSharedPointer<FiffStream> SPtr;            /**< Shared pointer type for FiffStream. */
     typedef QSharedPointer<const FiffStream> ConstSPtr; /**< Const shared pointer type for FiffStream. */
 
+    //=========================================================================================================
+    /**
+    * Parts of the measurement info read_meas_info can be restricted to. The number of channels, sampling
+    * frequency, filter settings, channel infos, ids and the measurement date are always read.
+    */
+    enum MeasInfoField {
+        MeasInfoBasic       = 0x00,     /**< Only the fields which are always read. */
+        MeasInfoCoordTrans  = 0x01,     /**< dev_head_t, ctf_head_t and dev_ctf_t, including the HPI results. */
+        MeasInfoDig         = 0x02,     /**< Digitizer points and dig_trans. */
+        MeasInfoAcqPars     = 0x04,     /**< Acquisition parameters acq_pars and acq_stim. */
+        MeasInfoProjs       = 0x08,     /**< SSP projectors. */
+        MeasInfoComps       = 0x10,     /**< CTF software compensators. */
+        MeasInfoBads        = 0x20,     /**< Bad channel list. */
+        MeasInfoAll         = 0x3F      /**< Everything. */
+    };
+
     //=========================================================================================================
     /**
     * Constructs a fiff stream that uses the I/O device p_pIODevice.
@@ -143,6 +164,12 @@ public:
     */
     explicit FiffStream(QByteArray * a, QIODevice::OpenMode mode);
 
+    //=========================================================================================================
+    /**
+    * Destroys the fiff stream and releases a memory mapping if one was established.
+    */
+    ~FiffStream();
+
     //=========================================================================================================
     /**
     * Get the stream name
@@ -223,6 +250,86 @@ public:
     */
     void finish_writing_raw();
 
+    //=========================================================================================================
+    /**
+    * Switches the raw data writing to asynchronous mode. Afterwards write_raw_buffer only copies the buffer
+    * into a bounded queue, the scaling and the device write are done on a dedicated writer thread.
+    * All other writers wait for the queued buffers before they write, in order to keep the tag order.
+    * Data streamed with the QDataStream operators directly is not synchronized.
+    * finish_writing_raw writes the pending buffers before it closes the file.
+    *
+    * @param[in] queue_size         Number of buffers which can be queued (Default = 16)
+    * @param[in] drop_when_full     Drop buffers when the queue is full instead of waiting (Default = false)
+    *
+    * @return true if succeeded, false if asynchronous writing is already active
+    */
+    bool start_async_writing(qint32 queue_size = 16, bool drop_when_full = false);
+
+    //=========================================================================================================
+    /**
+    * Writes the pending buffers and switches back to synchronous writing.
+    */
+    void stop_async_writing();
+
+    //=========================================================================================================
+    /**
+    * Returns whether asynchronous writing is active.
+    *
+    * @return true if active, false otherwise
+    */
+    bool is_async_writing() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the queue statistics of the asynchronous writer, i.e. queued, written and dropped buffers and
+    * how often the producer had to wait. All values are zero if asynchronous writing is not active.
+    *
+    * @return the statistics
+    */
+    FiffAsyncWriterStats async_writing_stats() const;
+
+    //=========================================================================================================
+    /**
+    * Switches the raw data writing to lossless compression. Afterwards write_raw_buffer writes
+    * FIFFT_COMPRESSED_RAW buffers (see FiffRawCompression) instead of FIFFT_FLOAT buffers, FiffRawData
+    * decodes them transparently. Call this before the first buffer is written.
+    *
+    * @param[in] enable         Whether to compress the raw buffers
+    * @param[in] block_size     Number of channels compressed together (Default = 32)
+    */
+    void set_raw_compression(bool enable, qint32 block_size = 32);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the raw buffers are written compressed.
+    *
+    * @return true if compression is active, false otherwise
+    */
+    bool raw_compression() const;
+
+    //=========================================================================================================
+    /**
+    * Splits the raw file which was started with start_writing_raw into parts of at most split_size bytes.
+    * The parts of rec_raw.fif are written to rec_raw-1.fif, rec_raw-2.fif, ... and linked with FIFFB_REF
+    * blocks, FiffRawData reads them as one recording. The next part is opened and its header is written in
+    * the background (see FiffRawSplitter), the rollover happens in write_raw_buffer without a gap in the data.
+    * Only available if the device is a QFile.
+    *
+    * @param[in] split_size     Maximum size of a part in bytes (Default = 2000000000)
+    * @param[in] first_sample   First sample of the recording, the first sample of the later parts is counted from it (Default = 0)
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool start_split_writing(fiff_long_t split_size = 2000000000, fiff_int_t first_sample = 0);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the raw file is split.
+    *
+    * @return true if split writing is active, false otherwise
+    */
+    bool is_split_writing() const;
+
     //=========================================================================================================
     /**
     * Helper to get all evoked entries
@@ -265,6 +372,42 @@ public:
     */
     bool close();
 
+    //=========================================================================================================
+    /**
+    * Maps the whole underlying file into memory. Only supported for QFile devices. The device is opened
+    * read only if it is not open yet. As long as the stream is mapped, tag payloads can be accessed via
+    * mapped_data without copying them through the QDataStream.
+    *
+    * @return true if the file is mapped, false otherwise (e.g. for sockets or byte arrays)
+    */
+    bool map_file();
+
+    //=========================================================================================================
+    /**
+    * Releases the memory mapping established by map_file.
+    */
+    void unmap_file();
+
+    //=========================================================================================================
+    /**
+    * Returns whether the stream holds a valid memory mapping of its file.
+    *
+    * @return true if mapped, false otherwise
+    */
+    bool is_mapped() const;
+
+    //=========================================================================================================
+    /**
+    * Returns a pointer into the memory mapping. The data is returned as stored in the file, i.e. in big
+    * endian byte order.
+    *
+    * @param[in] pos    The file position of the first byte
+    * @param[in] size   The number of bytes which are going to be accessed
+    *
+    * @return the pointer to the mapped bytes, NULL if the stream is not mapped or the range is invalid
+    */
+    const uchar* mapped_data(fiff_long_t pos, fiff_long_t size) const;
+
     //=========================================================================================================
     /**
     * Create the directory tree structure
@@ -347,13 +490,18 @@ public:
     * Read the measurement info
     * Source is assumed to be an open fiff file.
     *
+    * Passing a field mask skips the parsing of the blocks which are not needed, e.g. projectors,
+    * compensators and digitizer points when only the channel names and the sampling frequency are of
+    * interest. The skipped fields stay empty; reading again with MeasInfoAll completes the info.
+    *
     * @param[in] p_Node       The node of interest
     * @param[out] p_Info      The read measurement info
     * @param[out] p_NodeInfo  The to measurement corresponding fiff_dir_node.
+    * @param[in] p_iFields    The optional fields to read, a combination of MeasInfoField (Default = MeasInfoAll)
     *
     * @return true if successful.
     */
-    bool read_meas_info(const FiffDirNode::SPtr& p_Node, FiffInfo& p_Info, FiffDirNode::SPtr& p_NodeInfo);
+    bool read_meas_info(const FiffDirNode::SPtr& p_Node, FiffInfo& p_Info, FiffDirNode::SPtr& p_NodeInfo, int p_iFields = MeasInfoAll);
 
     //=========================================================================================================
     /**
@@ -456,10 +604,13 @@ public:
     * @param[in] p_IODevice        An fiff IO device like a fiff QFile or QTCPSocket
     * @param[out] data              The raw data information - contains the opened fiff file
     * @param[in] allow_maxshield    Accept unprocessed MaxShield data
+    * @param[in] use_rawdir_cache   Read the raw directory from its cache file if it is valid, write the cache
+    *                               otherwise (see FiffRawData::write_rawdir_cache)
+    * @param[in] meas_info_fields   Parts of the measurement info to read, see read_meas_info (Default = MeasInfoAll)
     *
     * @return true if succeeded, false otherwise
     */
-    static bool setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool allow_maxshield = false);
+    static bool setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool allow_maxshield = false, bool use_rawdir_cache = false, int meas_info_fields = MeasInfoAll);
 
     //=========================================================================================================
     /**
@@ -867,6 +1018,34 @@ public:
     void write_rt_command(fiff_int_t command, const QString& data);
 
 private:
+    friend class FiffAsyncWriter;
+
+    //=========================================================================================================
+    /**
+    * Waits until the asynchronous writer has written all queued buffers, does nothing in synchronous mode.
+    */
+    void flush_async_writing();
+
+    //=========================================================================================================
+    /**
+    * Returns the position at which the next tag is written. All writers, except the raw buffer writing of the
+    * asynchronous writer itself, obtain their tag position here, so that the pending raw buffers are on the
+    * device before another tag is appended.
+    *
+    * @return the current device position after the queued raw buffers were written
+    */
+    fiff_long_t write_position();
+
+    //=========================================================================================================
+    /**
+    * Writes a FIFF_DATA_BUFFER tag of single precision values, compressed when set_raw_compression is active.
+    *
+    * @param[in] buf    The scaled buffer
+    *
+    * @return the position where the buffer was written to
+    */
+    fiff_long_t write_float_buffer(const MatrixXf& buf);
+
     //=========================================================================================================
     /**
     * Check that the file starts properly.
@@ -878,6 +1057,19 @@ private:
     */
     bool check_beginning(QSharedPointer<FiffTag>& p_pTag);
 
+    //=========================================================================================================
+    /**
+    * Creates the directory tree of the block which starts at dentry[start]. Children are built on the same
+    * entry list, no copies of the remaining entries are made.
+    *
+    * @param[in] dentry     The dir entries of which the tree should be constructed
+    * @param[in] start      Index of the first entry of the block
+    * @param[out] end       Index of the last entry of the block, i.e. its FIFF_BLOCK_END (optional)
+    *
+    * @return The created dir tree
+    */
+    FiffDirNode::SPtr make_subtree(const QList<FiffDirEntry::SPtr>& dentry, qint32 start, qint32* end);
+
     //=========================================================================================================
     /**
     * Scan the tag list to create a directory
@@ -897,6 +1089,14 @@ private:
     QList<FiffDirEntry::SPtr>   m_dir;  /**< This is the directory. If no directory exists, open automatically scans the file to create one. */
 //    int         nent;           /**< How many entries? */ -> Use nent() instead
     FiffDirNode::SPtr           m_dirtree; /**< Directory compiled into a tree */
+
+    QPointer<QFile>             m_pMappedFile;   /**< The file which was mapped, the mapping dies with it */
+    uchar*                      m_pMappedData;   /**< Start of the memory mapped file, NULL if not mapped */
+    fiff_long_t                 m_iMappedSize;   /**< Size of the memory mapped region in bytes */
+
+    QSharedPointer<FiffAsyncWriter> m_pAsyncWriter;  /**< Writer thread for raw buffers, NULL in synchronous mode */
+    qint32                      m_iRawCompressionBlock;  /**< Channels per compressed block, 0 if raw buffers are written uncompressed */
+    QSharedPointer<FiffRawSplitter> m_pRawSplitter;  /**< Split of the raw file, set by start_writing_raw */
 //    char        *ext_file_name; /**< Name of the file holding the external data */
 //    FILE        *ext_fd;        /**< The file descriptor of the above file if open  */
 
@@ -975,12 +975,12 @@ inline SparseMatrix<double> FiffTag::toSparseFloatMatrix() const
     qint32 nrow = dims[1];
     qint32 ncol = dims[2];
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(nnz);
-
-    float *t_pFloat = (float*)this->data();
-    int *t_pInt = (int*)this->data();
+    //
+    //   The values, the inner indices and the outer pointers follow each other in the tag data, they are viewed
+    //   in place and converted in one pass instead of going through triplets
+    //
+    const float *t_pFloat = (const float*)this->data();
+    const int *t_pInt = (const int*)this->data();
     qint32 offset1 = nnz;
     qint32 offset2 = 2*nnz;
     if (fiff_type_matrix_coding(this->type) == FIFFTS_MC_CCS)
@@ -988,44 +988,15 @@ inline SparseMatrix<double> FiffTag::toSparseFloatMatrix() const
         //
         //    CCS
         //
-        qWarning("Warning in FiffTag::toSparseFloatMatrix(): CCS has to be debugged - never done before.");
-        qint32 p = 0;
-        for(qint32 j = 0; j < ncol; ++j)
-        {
-            while( p < t_pInt[offset2+j+1])
-            {
-//                tripletList[p] = T(tripletList[p].row(), j, tripletList[p].value());
-                tripletList.push_back(T(t_pInt[offset1+p], j, (double)(t_pFloat[p])));
-                ++p;
-            }
-        }
+        Map<const SparseMatrix<float, ColMajor, int> > t_view(nrow, ncol, nnz, t_pInt + offset2, t_pInt + offset1, t_pFloat);
+        return t_view.cast<double>();
     }
-    else
-    {
-        //
-        //    RCS
-        //
-        qint32 p = 0;
-        for(qint32 j = 0; j < nrow; ++j)
-        {
-            while( p < t_pInt[offset2+j+1])
-            {
-//                tripletList[p] = T(j, tripletList[p].col(), tripletList[p].value());
-                tripletList.push_back(T(j, t_pInt[offset1+p], (double)(t_pFloat[p])));
-                ++p;
-            }
-        }
-    }
-
-//    std::cout << "Size: " << tripletList.size() << std::endl;
-//    qint32 offsetTest = tripletList.size() - 10;
-//    for(qint32 i = 0; i < 10; ++i)
-//        std::cout << std::endl << tripletList[offsetTest + i].row() << " " << tripletList[offsetTest + i].col() << " " << tripletList[offsetTest + i].value();
 
-    SparseMatrix<double> p_Matrix(nrow, ncol);
-    p_Matrix.setFromTriplets(tripletList.begin(), tripletList.end());
-
-    return p_Matrix;
+    //
+    //    RCS
+    //
+    Map<const SparseMatrix<float, RowMajor, int> > t_view(nrow, ncol, nnz, t_pInt + offset2, t_pInt + offset1, t_pFloat);
+    return t_view.cast<double>();
 }
 
 } // NAMESPACE
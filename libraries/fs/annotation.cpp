@@ -42,6 +42,9 @@
 #include "annotation.h"
 #include "label.h"
 #include "surface.h"
+#include "fscache.h"
+#include <utils/ioutils.h>
+#include <utils/cachefile.h>
 
 
 //*************************************************************************************************************
@@ -61,6 +64,9 @@
 #include <QFile>
 #include <QDataStream>
 #include <QFileInfo>
+#include <QByteArray>
+#include <QHash>
+#include <QSysInfo>
 
 
 //*************************************************************************************************************
@@ -68,9 +74,184 @@
 // USED NAMESPACES
 //=============================================================================================================
 
+using namespace UTILSLIB;
 using namespace FSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+void readAnnotationFile(QFile &t_File, VectorXi &p_vecVertices, VectorXi &p_vecLabelIds, Colortable &p_Colortable)
+{
+    QDataStream t_Stream(&t_File);
+    t_Stream.setByteOrder(QDataStream::BigEndian);
+
+    qint32 numEl;
+    t_Stream >> numEl;
+
+    //vertex and label id pairs are read at once and swapped in place on little endian machines
+    MatrixXi t_matPairs(2, numEl);
+    t_Stream.readRawData((char *)t_matPairs.data(), numEl*2*sizeof(qint32));
+    if(QSysInfo::ByteOrder == QSysInfo::LittleEndian)
+        IOUtils::swap_intp_many(t_matPairs.data(), t_matPairs.size());
+
+    p_vecVertices = t_matPairs.row(0).transpose();
+    p_vecLabelIds = t_matPairs.row(1).transpose();
+
+    qint32 hasColortable;
+    t_Stream >> hasColortable;
+    if (hasColortable)
+    {
+        p_Colortable.clear();
+
+        //Read colortable
+        qint32 numEntries;
+        t_Stream >> numEntries;
+        qint32 len;
+        if(numEntries > 0)
+        {
+
+            printf("\tReading from Original Version\n");
+            p_Colortable.numEntries = numEntries;
+            t_Stream >> len;
+            QByteArray tmp;
+            tmp.resize(len);
+            t_Stream.readRawData(tmp.data(),len);
+            p_Colortable.orig_tab = tmp;
+
+            for(qint32 i = 0; i < numEntries; ++i)
+                p_Colortable.struct_names.append("");
+
+            p_Colortable.table = MatrixXi(numEntries,5);
+
+            for(qint32 i = 0; i < numEntries; ++i)
+            {
+                t_Stream >> len;
+                tmp.resize(len);
+                t_Stream.readRawData(tmp.data(),len);
+
+                p_Colortable.struct_names[i]= tmp;
+
+                for(qint32 j = 0; j < 4; ++j)
+                    t_Stream >> p_Colortable.table(i,j);
+
+                p_Colortable.table(i,4) = p_Colortable.table(i,0)
+                        + p_Colortable.table(i,1) * 256       //(2^8)
+                        + p_Colortable.table(i,2) * 65536     //(2^16)
+                        + p_Colortable.table(i,3) * 16777216; //(2^24);
+            }
+        }
+        else
+        {
+            qint32 version = -numEntries;
+            if(version != 2)
+                printf("\tError! Does not handle version %d\n", version);
+            else
+                printf("\tReading from version %d\n", version);
+
+            t_Stream >> numEntries;
+            p_Colortable.numEntries = numEntries;
+
+            t_Stream >> len;
+            QByteArray tmp;
+            tmp.resize(len);
+            t_Stream.readRawData(tmp.data(),len);
+            p_Colortable.orig_tab = tmp;
+
+            for(qint32 i = 0; i < numEntries; ++i)
+                p_Colortable.struct_names.append("");
+
+            p_Colortable.table = MatrixXi(numEntries,5);
+
+            qint32 numEntriesToRead;
+            t_Stream >> numEntriesToRead;
+
+            qint32 structure;
+            for(qint32 i = 0; i < numEntriesToRead; ++i)
+            {
+
+                t_Stream >> structure;
+                if (structure < 0)
+                    printf("\tError! Read entry, index %d\n", structure);
+
+                if(!p_Colortable.struct_names[structure].isEmpty())
+                    printf("Error! Duplicate Structure %d", structure);
+
+                t_Stream >> len;
+                tmp.resize(len);
+                t_Stream.readRawData(tmp.data(),len);
+
+                p_Colortable.struct_names[structure]= tmp;
+
+                for(qint32 j = 0; j < 4; ++j)
+                    t_Stream >> p_Colortable.table(structure,j);
+
+                p_Colortable.table(structure,4) = p_Colortable.table(structure,0)
+                        + p_Colortable.table(structure,1) * 256       //(2^8)
+                        + p_Colortable.table(structure,2) * 65536     //(2^16)
+                        + p_Colortable.table(structure,3) * 16777216; //(2^24);
+            }
+        }
+        printf("\tcolortable with %d entries read\n\t(originally %s)\n", p_Colortable.numEntries, p_Colortable.orig_tab.toUtf8().constData());
+    }
+    else
+    {
+        printf("\tError! No colortable stored\n");
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool readAnnotationCache(const QString &p_sFileName, VectorXi &p_vecVertices, VectorXi &p_vecLabelIds, Colortable &p_Colortable)
+{
+    QByteArray t_baCache;
+    if(!FsCache::read(p_sFileName, QString("annot"), t_baCache))
+        return false;
+
+    QDataStream t_Stream(t_baCache);
+    VectorXi vecVertices, vecLabelIds;
+    Colortable colortable;
+    if(!CacheFile::readMatrix(t_Stream, vecVertices) || !CacheFile::readMatrix(t_Stream, vecLabelIds))
+        return false;
+
+    t_Stream >> colortable.numEntries >> colortable.orig_tab >> colortable.struct_names;
+
+    if(!CacheFile::readMatrix(t_Stream, colortable.table) || t_Stream.status() != QDataStream::Ok)
+        return false;
+
+    p_vecVertices = vecVertices;
+    p_vecLabelIds = vecLabelIds;
+    p_Colortable = colortable;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void writeAnnotationCache(const QString &p_sFileName, const VectorXi &p_vecVertices, const VectorXi &p_vecLabelIds, const Colortable &p_Colortable)
+{
+    if(!FsCache::isEnabled())
+        return;
+
+    QByteArray t_baPayload;
+    QDataStream t_Stream(&t_baPayload, QIODevice::WriteOnly);
+    CacheFile::writeMatrix(t_Stream, p_vecVertices);
+    CacheFile::writeMatrix(t_Stream, p_vecLabelIds);
+    t_Stream << p_Colortable.numEntries << p_Colortable.orig_tab << p_Colortable.struct_names;
+    CacheFile::writeMatrix(t_Stream, p_Colortable.table);
+
+    FsCache::write(p_sFileName, QString("annot"), t_baPayload);
+}
+
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -134,6 +315,7 @@ void Annotation::clear()
     m_Vertices = VectorXi::Zero(0);
     m_LabelIds = VectorXi::Zero(0);
     m_Colortable.clear();
+    invalidateLookup();
 }
 
 
@@ -182,120 +364,14 @@ bool Annotation::read(const QString& p_sFileName, Annotation &p_Annotation)
         return false;
     }
 
-    QDataStream t_Stream(&t_File);
-    t_Stream.setByteOrder(QDataStream::BigEndian);
-
-    qint32 numEl;
-    t_Stream >> numEl;
-
-    p_Annotation.m_Vertices = VectorXi(numEl);
-    p_Annotation.m_LabelIds = VectorXi(numEl);
-
-    for(qint32 i = 0; i < numEl; ++i)
+    if(readAnnotationCache(p_sFileName, p_Annotation.m_Vertices, p_Annotation.m_LabelIds, p_Annotation.m_Colortable))
     {
-        t_Stream >> p_Annotation.m_Vertices[i];
-        t_Stream >> p_Annotation.m_LabelIds[i];
-    }
-
-    qint32 hasColortable;
-    t_Stream >> hasColortable;
-    if (hasColortable)
-    {
-        p_Annotation.m_Colortable.clear();
-
-        //Read colortable
-        qint32 numEntries;
-        t_Stream >> numEntries;
-        qint32 len;
-        if(numEntries > 0)
-        {
-
-            printf("\tReading from Original Version\n");
-            p_Annotation.m_Colortable.numEntries = numEntries;
-            t_Stream >> len;
-            QByteArray tmp;
-            tmp.resize(len);
-            t_Stream.readRawData(tmp.data(),len);
-            p_Annotation.m_Colortable.orig_tab = tmp;
-
-            for(qint32 i = 0; i < numEntries; ++i)
-                p_Annotation.m_Colortable.struct_names.append("");
-
-            p_Annotation.m_Colortable.table = MatrixXi(numEntries,5);
-
-            for(qint32 i = 0; i < numEntries; ++i)
-            {
-                t_Stream >> len;
-                tmp.resize(len);
-                t_Stream.readRawData(tmp.data(),len);
-
-                p_Annotation.m_Colortable.struct_names[i]= tmp;
-
-                for(qint32 j = 0; j < 4; ++j)
-                    t_Stream >> p_Annotation.m_Colortable.table(i,j);
-
-                p_Annotation.m_Colortable.table(i,4) = p_Annotation.m_Colortable.table(i,0)
-                        + p_Annotation.m_Colortable.table(i,1) * 256       //(2^8)
-                        + p_Annotation.m_Colortable.table(i,2) * 65536     //(2^16)
-                        + p_Annotation.m_Colortable.table(i,3) * 16777216; //(2^24);
-            }
-        }
-        else
-        {
-            qint32 version = -numEntries;
-            if(version != 2)
-                printf("\tError! Does not handle version %d\n", version);
-            else
-                printf("\tReading from version %d\n", version);
-
-            t_Stream >> numEntries;
-            p_Annotation.m_Colortable.numEntries = numEntries;
-
-            t_Stream >> len;
-            QByteArray tmp;
-            tmp.resize(len);
-            t_Stream.readRawData(tmp.data(),len);
-            p_Annotation.m_Colortable.orig_tab = tmp;
-
-            for(qint32 i = 0; i < numEntries; ++i)
-                p_Annotation.m_Colortable.struct_names.append("");
-
-            p_Annotation.m_Colortable.table = MatrixXi(numEntries,5);
-
-            qint32 numEntriesToRead;
-            t_Stream >> numEntriesToRead;
-
-            qint32 structure;
-            for(qint32 i = 0; i < numEntriesToRead; ++i)
-            {
-
-                t_Stream >> structure;
-                if (structure < 0)
-                    printf("\tError! Read entry, index %d\n", structure);
-
-                if(!p_Annotation.m_Colortable.struct_names[structure].isEmpty())
-                    printf("Error! Duplicate Structure %d", structure);
-
-                t_Stream >> len;
-                tmp.resize(len);
-                t_Stream.readRawData(tmp.data(),len);
-
-                p_Annotation.m_Colortable.struct_names[structure]= tmp;
-
-                for(qint32 j = 0; j < 4; ++j)
-                    t_Stream >> p_Annotation.m_Colortable.table(structure,j);
-
-                p_Annotation.m_Colortable.table(structure,4) = p_Annotation.m_Colortable.table(structure,0)
-                        + p_Annotation.m_Colortable.table(structure,1) * 256       //(2^8)
-                        + p_Annotation.m_Colortable.table(structure,2) * 65536     //(2^16)
-                        + p_Annotation.m_Colortable.table(structure,3) * 16777216; //(2^24);
-            }
-        }
-        printf("\tcolortable with %d entries read\n\t(originally %s)\n", p_Annotation.m_Colortable.numEntries, p_Annotation.m_Colortable.orig_tab.toUtf8().constData());
+        printf("\tRead from cache (%d vertices, colortable with %d entries)\n", (int)p_Annotation.m_Vertices.size(), p_Annotation.m_Colortable.numEntries);
     }
     else
     {
-        printf("\tError! No colortable stored\n");
+        readAnnotationFile(t_File, p_Annotation.m_Vertices, p_Annotation.m_LabelIds, p_Annotation.m_Colortable);
+        writeAnnotationCache(p_sFileName, p_Annotation.m_Vertices, p_Annotation.m_LabelIds, p_Annotation.m_Colortable);
     }
 
     // hemi info
@@ -328,6 +404,18 @@ bool Annotation::toLabels(const Surface &p_surf, QList<Label> &p_qListLabels, QL
         return false;
     }
 
+    // labels converted for the same surface before are reused
+    QString t_sSurf;
+    if(!p_surf.fileName().isEmpty())
+        t_sSurf = QString("%1%2 %3").arg(p_surf.filePath()).arg(p_surf.fileName()).arg(p_surf.rr().rows());
+
+    if(!t_sSurf.isEmpty() && t_sSurf == m_sLabelsSurf)
+    {
+        p_qListLabels.append(m_qListLabels);
+        p_qListLabelRGBAs.append(m_qListLabelRGBAs);
+        return true;
+    }
+
     printf("Converting labels from annotation...");
 
 //n_read = 0
@@ -337,55 +425,66 @@ bool Annotation::toLabels(const Surface &p_surf, QList<Label> &p_qListLabels, QL
     VectorXi label_ids = m_Colortable.getLabelIds();
     QStringList label_names = m_Colortable.getNames();
     MatrixX4i label_rgbas = m_Colortable.getRGBAs();
+    const VectorXi& label_idx = getLabelIndices();
 
     // load the vertex positions from surface
     MatrixX3f vert_pos = p_surf.rr();
 
-//    qDebug() << label_rgbas.rows() << label_ids.size() << label_names.size();
+    // sort the vertices into their labels in a single pass instead of searching all vertices for each label
+    VectorXi counts = VectorXi::Zero(label_rgbas.rows());
+    for(qint32 j = 0; j < label_idx.size(); ++j)
+        if(label_idx[j] >= 0 && label_idx[j] < counts.size())
+            ++counts[label_idx[j]];
 
-//    std::cout << label_ids;
+    QList<VectorXi> label_vertices;
+    for(qint32 i = 0; i < counts.size(); ++i)
+        label_vertices.append(VectorXi(counts[i]));
+
+    counts.setZero();
+    for(qint32 j = 0; j < label_idx.size(); ++j)
+        if(label_idx[j] >= 0 && label_idx[j] < counts.size())
+            label_vertices[label_idx[j]][counts[label_idx[j]]++] = j;
+
+    QList<Label> t_qListLabels;
+    QList<RowVector4i> t_qListLabelRGBAs;
 
     qint32 label_id, count;
-    RowVector4i label_rgba;
-    VectorXi vertices;
-    VectorXd values;
     MatrixX3f pos;
     QString name;
     for(qint32 i = 0; i < label_rgbas.rows(); ++i)
     {
         label_id = label_ids[i];
-        label_rgba = label_rgbas.row(i);
-        count = 0;
-        vertices.resize(m_LabelIds.size());
-        //Where
-        for(qint32 j = 0; j < m_LabelIds.size(); ++j)
-        {
-            if(m_LabelIds[j] == label_id)
-            {
-                vertices[count] = j;
-                ++count;
-            }
-        }
+        const VectorXi& vertices = label_vertices[i];
+        count = vertices.size();
+
         // check if label is part of cortical surface
         if(count == 0)
             continue;
-        vertices.conservativeResize(count);
 
         pos.resize(count, 3);
         for(qint32 j = 0; j < count; ++j)
             pos.row(j) = vert_pos.row(vertices[j]);
 
-        values = VectorXd::Zero(count);
         name = QString("%1-%2").arg(label_names[i]).arg(this->m_iHemi == 0 ? "lh" : "rh");
 
         // put it all together
         //t_tris
-        p_qListLabels.append(Label(vertices, pos, values, this->m_iHemi, name, label_id));
+        t_qListLabels.append(Label(vertices, pos, VectorXd::Zero(count), this->m_iHemi, name, label_id));
 
         // store the color
-        p_qListLabelRGBAs.append(label_rgba);
+        t_qListLabelRGBAs.append(label_rgbas.row(i));
+    }
+
+    if(!t_sSurf.isEmpty())
+    {
+        m_sLabelsSurf = t_sSurf;
+        m_qListLabels = t_qListLabels;
+        m_qListLabelRGBAs = t_qListLabelRGBAs;
     }
 
+    p_qListLabels.append(t_qListLabels);
+    p_qListLabelRGBAs.append(t_qListLabelRGBAs);
+
 
 //    for label_id, label_name, label_rgba in
 //            zip(label_ids, label_names, label_rgbas):
@@ -419,3 +518,25 @@ bool Annotation::toLabels(const Surface &p_surf, QList<Label> &p_qListLabels, QL
 
     return true;
 }
+
+
+//*************************************************************************************************************
+
+const VectorXi& Annotation::getLabelIndices() const
+{
+    if(m_vecLabelIndices.size() != m_LabelIds.size())
+    {
+        VectorXi label_ids = m_Colortable.getLabelIds();
+
+        QHash<qint32, qint32> t_hashRows;
+        for(qint32 i = 0; i < label_ids.size(); ++i)
+            if(!t_hashRows.contains(label_ids[i]))
+                t_hashRows.insert(label_ids[i], i);
+
+        m_vecLabelIndices.resize(m_LabelIds.size());
+        for(qint32 j = 0; j < m_LabelIds.size(); ++j)
+            m_vecLabelIndices[j] = t_hashRows.value(m_LabelIds[j], -1);
+    }
+
+    return m_vecLabelIndices;
+}
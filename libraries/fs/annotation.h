@@ -44,6 +44,7 @@
 
 #include "fs_global.h"
 #include "colortable.h"
+#include "label.h"
 
 
 //*************************************************************************************************************
@@ -53,6 +54,7 @@
 
 #include <QString>
 #include <QSharedPointer>
+#include <QList>
 
 
 //*************************************************************************************************************
@@ -84,7 +86,6 @@ using namespace Eigen;
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
-class Label;
 class Surface;
 
 
@@ -266,6 +267,17 @@ public:
     */
     bool toLabels(const Surface &p_surf, QList<Label> &p_qListLabels, QList<RowVector4i> &p_qListLabelRGBAs) const;
 
+    //=========================================================================================================
+    /**
+    * Returns the vertex to label lookup table. It holds for each vertex the colortable row of its label, or -1 if
+    * the vertex has no label of the colortable. The table is built on first use and kept until the annotation is
+    * modified. The vertex to label lookup and the labels cached by toLabels are not synchronized, an annotation which
+    * is shared between threads should be converted once before.
+    *
+    * @return the colortable row of each vertex
+    */
+    const VectorXi& getLabelIndices() const;
+
     //=========================================================================================================
     /**
     * annotation file path
@@ -283,6 +295,12 @@ public:
     inline QString fileName() const;
 
 private:
+    //=========================================================================================================
+    /**
+    * Drops the vertex to label lookup table and the cached labels after the annotation is modified.
+    */
+    inline void invalidateLookup();
+
     QString m_sFileName;        /**< Annotation file name */
     QString m_sFilePath;        /**< Annotation file path */
 
@@ -291,6 +309,11 @@ private:
     VectorXi m_LabelIds;        /**< Vertice label ids */
 
     Colortable m_Colortable;    /**< Lookup table label colors & ids */
+
+    mutable VectorXi m_vecLabelIndices;                 /**< Colortable row of each vertex, empty until it is needed */
+    mutable QString m_sLabelsSurf;                      /**< Surface the cached labels were converted for, empty if none are cached */
+    mutable QList<Label> m_qListLabels;                 /**< Labels cached by toLabels */
+    mutable QList<RowVector4i> m_qListLabelRGBAs;       /**< Label RGBAs cached by toLabels */
 };
 
 //*************************************************************************************************************
@@ -314,6 +337,7 @@ inline bool Annotation::isEmpty() const
 
 inline VectorXi& Annotation::getVertices()
 {
+    invalidateLookup();
     return m_Vertices;
 }
 
@@ -330,6 +354,7 @@ inline const VectorXi Annotation::getVertices() const
 
 inline VectorXi& Annotation::getLabelIds()
 {
+    invalidateLookup();
     return m_LabelIds;
 }
 
@@ -346,6 +371,7 @@ inline const VectorXi Annotation::getLabelIds() const
 
 inline Colortable& Annotation::getColortable()
 {
+    invalidateLookup();
     return m_Colortable;
 }
 
@@ -373,6 +399,17 @@ inline QString Annotation::fileName() const
     return m_sFileName;
 }
 
+
+//*************************************************************************************************************
+
+inline void Annotation::invalidateLookup()
+{
+    m_vecLabelIndices.resize(0);
+    m_sLabelsSurf.clear();
+    m_qListLabels.clear();
+    m_qListLabelRGBAs.clear();
+}
+
 } // NAMESPACE
 
 #endif // ANNOTATION_H
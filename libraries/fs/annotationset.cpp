@@ -43,6 +43,8 @@
 
 #include <QFile>
 #include <QDebug>
+#include <QStringList>
+#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -53,6 +55,64 @@
 using namespace FSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+QStringList annotationFiles(const QString &path, qint32 hemi, const QString &atlas)
+{
+    QStringList t_qListFiles;
+    if(hemi == 0 || hemi == 2)
+        t_qListFiles << QString("%1/lh.%2.annot").arg(path).arg(atlas);
+    if(hemi == 1 || hemi == 2)
+        t_qListFiles << QString("%1/rh.%2.annot").arg(path).arg(atlas);
+
+    return t_qListFiles;
+}
+
+
+//*************************************************************************************************************
+
+Annotation readAnnotation(const QString &p_sFileName)
+{
+    Annotation t_Annotation;
+    if(!Annotation::read(p_sFileName, t_Annotation))
+        return Annotation();
+
+    return t_Annotation;
+}
+
+
+//*************************************************************************************************************
+
+QList<Annotation> readAnnotations(const QStringList &p_qListFiles)
+{
+    //Each file is read on its own thread, a failed read results in an empty annotation
+    QList<QFuture<Annotation> > t_qListFutures;
+    for(qint32 i = 0; i < p_qListFiles.size(); ++i)
+        t_qListFutures.append(QtConcurrent::run(readAnnotation, p_qListFiles[i]));
+
+    QList<Annotation> t_qListAnnotations;
+    for(qint32 i = 0; i < t_qListFutures.size(); ++i)
+        t_qListAnnotations.append(t_qListFutures[i].result());
+
+    return t_qListAnnotations;
+}
+
+
+//*************************************************************************************************************
+
+AnnotationSet readAnnotationSet(const QString &subject_id, qint32 hemi, const QString &atlas, const QString &subjects_dir)
+{
+    return AnnotationSet(subject_id, hemi, atlas, subjects_dir);
+}
+
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -68,20 +128,9 @@ AnnotationSet::AnnotationSet()
 
 AnnotationSet::AnnotationSet(const QString &subject_id, qint32 hemi, const QString &atlas, const QString &subjects_dir)
 {
-    Annotation t_Annotation;
-    if(hemi == 0 || hemi == 1)
-    {
-        if(Annotation::read(subject_id, hemi, atlas, subjects_dir, t_Annotation))
-            insert(t_Annotation);
-    }
-    else if(hemi == 2)
-    {
-        if(Annotation::read(subject_id, 0, atlas, subjects_dir, t_Annotation))
-            insert(t_Annotation);
-        if(Annotation::read(subject_id, 1, atlas, subjects_dir, t_Annotation))
-            insert(t_Annotation);
-    }
-
+    QList<Annotation> t_qListAnnotations = readAnnotations(annotationFiles(QString("%1/%2/label").arg(subjects_dir).arg(subject_id), hemi, atlas));
+    for(qint32 i = 0; i < t_qListAnnotations.size(); ++i)
+        insert(t_qListAnnotations[i]);
 }
 
 
@@ -89,19 +138,9 @@ AnnotationSet::AnnotationSet(const QString &subject_id, qint32 hemi, const QStri
 
 AnnotationSet::AnnotationSet(const QString &path, qint32 hemi, const QString &atlas)
 {
-    Annotation t_Annotation;
-    if(hemi == 0 || hemi == 1)
-    {
-        if(Annotation::read(path, hemi, atlas, t_Annotation))
-            insert(t_Annotation);
-    }
-    else if(hemi == 2)
-    {
-        if(Annotation::read(path, 0, atlas, t_Annotation))
-            insert(t_Annotation);
-        if(Annotation::read(path, 1, atlas, t_Annotation))
-            insert(t_Annotation);
-    }
+    QList<Annotation> t_qListAnnotations = readAnnotations(annotationFiles(path, hemi, atlas));
+    for(qint32 i = 0; i < t_qListAnnotations.size(); ++i)
+        insert(t_qListAnnotations[i]);
 }
 
 
@@ -163,15 +202,16 @@ bool AnnotationSet::read(const QString& p_sLHFileName, const QString& p_sRHFileN
     QStringList t_qListFileName;
     t_qListFileName << p_sLHFileName << p_sRHFileName;
 
+    QList<Annotation> t_qListAnnotations = readAnnotations(t_qListFileName);
+
     for(qint32 i = 0; i < t_qListFileName.size(); ++i)
     {
-        Annotation t_Annotation;
-        if(Annotation::read(t_qListFileName[i], t_Annotation))
+        if(!t_qListAnnotations[i].isEmpty())
         {
             if(t_qListFileName[i].contains("lh."))
-                p_AnnotationSet.m_qMapAnnots.insert(0, t_Annotation);
+                p_AnnotationSet.m_qMapAnnots.insert(0, t_qListAnnotations[i]);
             else if(t_qListFileName[i].contains("rh."))
-                p_AnnotationSet.m_qMapAnnots.insert(1, t_Annotation);
+                p_AnnotationSet.m_qMapAnnots.insert(1, t_qListAnnotations[i]);
             else
                 return false;
         }
@@ -181,13 +221,24 @@ bool AnnotationSet::read(const QString& p_sLHFileName, const QString& p_sRHFileN
 }
 
 
+//*************************************************************************************************************
+
+QFuture<AnnotationSet> AnnotationSet::readAsync(const QString &subject_id, qint32 hemi, const QString &atlas, const QString &subjects_dir)
+{
+    return QtConcurrent::run(readAnnotationSet, subject_id, hemi, atlas, subjects_dir);
+}
+
+
 //*************************************************************************************************************
 
 bool AnnotationSet::toLabels(const SurfaceSet &p_surfSet, QList<Label> &p_qListLabels, QList<RowVector4i> &p_qListLabelRGBAs) const
 {
-    if(!m_qMapAnnots[0].toLabels(p_surfSet[0], p_qListLabels, p_qListLabelRGBAs))
+    //Convert the stored annotations, not copies of them, so that their cached labels are kept
+    if(!m_qMapAnnots.contains(0) || !m_qMapAnnots.contains(1))
+        return false;
+    else if(!m_qMapAnnots.find(0).value().toLabels(p_surfSet[0], p_qListLabels, p_qListLabelRGBAs))
         return false;
-    else if(!m_qMapAnnots[1].toLabels(p_surfSet[1], p_qListLabels, p_qListLabelRGBAs))
+    else if(!m_qMapAnnots.find(1).value().toLabels(p_surfSet[1], p_qListLabels, p_qListLabelRGBAs))
         return false;
 
     return true;
@@ -53,6 +53,7 @@
 #include <QString>
 #include <QSharedPointer>
 #include <QMap>
+#include <QFuture>
 
 
 //*************************************************************************************************************
@@ -192,6 +193,20 @@ public:
     */
     static bool read(const QString& p_sLHFileName, const QString& p_sRHFileName, AnnotationSet &p_AnnotationSet);
 
+    //=========================================================================================================
+    /**
+    * Reads an annotation set on a worker thread, e.g. to keep a GUI responsive. The hemispheres are read
+    * concurrently.
+    *
+    * @param[in] subject_id         Name of subject
+    * @param[in] hemi               Which hemisphere to load {0 -> lh, 1 -> rh, 2 -> both}
+    * @param[in] atlas              Name of the atlas to load (eg. aparc.a2009s, aparc, aparc.DKTatlas40, BA, BA.thresh, ...)
+    * @param[in] subjects_dir       Subjects directory
+    *
+    * @return the future annotation set
+    */
+    static QFuture<AnnotationSet> readAsync(const QString &subject_id, qint32 hemi, const QString &atlas, const QString &subjects_dir);
+
     //=========================================================================================================
     /**
     * python labels_from_parc
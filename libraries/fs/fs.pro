@@ -38,6 +38,7 @@ include(../../mne-cpp.pri)
 TEMPLATE = lib
 
 QT       -= gui
+QT       += concurrent
 
 DEFINES += FS_LIBRARY
 
@@ -71,7 +72,8 @@ SOURCES += \
     label.cpp \
     surface.cpp \
     annotationset.cpp \
-    surfaceset.cpp
+    surfaceset.cpp \
+    fscache.cpp
 
 HEADERS += \
     annotation.h\
@@ -80,7 +82,8 @@ HEADERS += \
     label.h \
     surface.h \
     annotationset.h \
-    surfaceset.h
+    surfaceset.h \
+    fscache.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
 INCLUDEPATH += $${MNE_INCLUDE_DIR}
@@ -0,0 +1,138 @@
+//=============================================================================================================
+/**
+* @file     fscache.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FsCache class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fscache.h"
+
+#include <utils/cachefile.h>
+#include <utils/cachelocation.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInt>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FSLIB;
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+QAtomicInt s_iEnabled(1);   /**< Whether the cache is used. */
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+void FsCache::setEnabled(bool p_bEnabled)
+{
+    s_iEnabled.store(p_bEnabled ? 1 : 0);
+}
+
+
+//*************************************************************************************************************
+
+bool FsCache::isEnabled()
+{
+    return s_iEnabled.load() != 0;
+}
+
+
+//*************************************************************************************************************
+
+QString FsCache::cacheFileName(const QString &p_sSourceFile)
+{
+    return CacheLocation::filePath(p_sSourceFile, QString(".fscache"));
+}
+
+
+//*************************************************************************************************************
+
+bool FsCache::read(const QString &p_sSourceFile, const QString &p_sKind, QByteArray &p_baPayload)
+{
+    if(!isEnabled())
+        return false;
+
+    QByteArray t_baKey = CacheFile::sourceKey(p_sSourceFile);
+    if(t_baKey.isEmpty())
+        return false;
+
+    return CacheFile::read(cacheFileName(p_sSourceFile), p_sKind, t_baKey, p_baPayload);
+}
+
+
+//*************************************************************************************************************
+
+bool FsCache::write(const QString &p_sSourceFile, const QString &p_sKind, const QByteArray &p_baPayload)
+{
+    if(!isEnabled())
+        return false;
+
+    QByteArray t_baKey = CacheFile::sourceKey(p_sSourceFile);
+    if(t_baKey.isEmpty())
+        return false;
+
+    QString t_sCacheFile = cacheFileName(p_sSourceFile);
+    if(!CacheFile::write(t_sCacheFile, p_sKind, t_baKey, p_baPayload))
+    {
+        qWarning("FsCache::write - Couldn't write the cache file %s", t_sCacheFile.toUtf8().constData());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,132 @@
+//=============================================================================================================
+/**
+* @file     fscache.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FsCache class declaration.
+*
+*/
+
+#ifndef FSCACHE_H
+#define FSCACHE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fs_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QString>
+#include <QByteArray>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FSLIB
+//=============================================================================================================
+
+namespace FSLIB
+{
+
+//=============================================================================================================
+/**
+* FreeSurfer files are big endian and parsed element wise. FsCache stores the parsed content of a surface,
+* curvature or annotation file in native byte order, so that a subject loads with a few block reads the next
+* time. A cache file is only used while size and modification time of its source file are unchanged.
+*
+* The cache files are UTILSLIB::CacheFile files in the directory of UTILSLIB::CacheLocation, the subject
+* directory is not written to. The cache is enabled by default and can be switched off by setEnabled.
+*
+* @brief Native endian cache for FreeSurfer files
+*/
+class FSSHARED_EXPORT FsCache
+{
+public:
+    //=========================================================================================================
+    /**
+    * Enables or disables the cache.
+    *
+    * @param[in] p_bEnabled     Whether the cache is used.
+    */
+    static void setEnabled(bool p_bEnabled);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the cache is used.
+    *
+    * @return true if the cache is enabled, false otherwise
+    */
+    static bool isEnabled();
+
+    //=========================================================================================================
+    /**
+    * Returns the cache file name of a source file.
+    *
+    * @param[in] p_sSourceFile  The FreeSurfer file.
+    *
+    * @return the cache file name
+    */
+    static QString cacheFileName(const QString &p_sSourceFile);
+
+    //=========================================================================================================
+    /**
+    * Reads the cached content of a source file. Fails if the cache is disabled, no cache file exists, it was
+    * written for another kind of content or a source file of another size or modification time.
+    *
+    * @param[in] p_sSourceFile  The FreeSurfer file.
+    * @param[in] p_sKind        The kind of the cached content, e.g. "surf".
+    * @param[out] p_baPayload   The cached content.
+    *
+    * @return true if the cached content was read, false otherwise
+    */
+    static bool read(const QString &p_sSourceFile, const QString &p_sKind, QByteArray &p_baPayload);
+
+    //=========================================================================================================
+    /**
+    * Writes the parsed content of a source file to the cache. Does nothing if the cache is disabled.
+    *
+    * @param[in] p_sSourceFile  The FreeSurfer file.
+    * @param[in] p_sKind        The kind of the cached content, e.g. "surf".
+    * @param[in] p_baPayload    The content to cache.
+    *
+    * @return true if the cache file was written, false otherwise
+    */
+    static bool write(const QString &p_sSourceFile, const QString &p_sKind, const QByteArray &p_baPayload);
+};
+
+} // NAMESPACE
+
+#endif // FSCACHE_H
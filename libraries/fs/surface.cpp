@@ -39,7 +39,9 @@
 //=============================================================================================================
 
 #include "surface.h"
+#include "fscache.h"
 #include <utils/ioutils.h>
+#include <utils/cachefile.h>
 
 #include <iostream>
 
@@ -52,6 +54,10 @@
 #include <QFile>
 #include <QDataStream>
 #include <QTextStream>
+#include <QByteArray>
+#include <QSysInfo>
+#include <QFuture>
+#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -63,6 +69,183 @@ using namespace UTILSLIB;
 using namespace FSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+bool readSurfaceFile(QFile &t_File, const QString &p_sFile, MatrixX3f &p_matRR, MatrixX3i &p_matTris)
+{
+    QDataStream t_DataStream(&t_File);
+    t_DataStream.setByteOrder(QDataStream::BigEndian);
+
+    //FreeSurfer files are big endian, the blocks read at once are swapped in place on little endian machines
+    const bool t_bSwap = QSysInfo::ByteOrder == QSysInfo::LittleEndian;
+
+    //
+    //   Magic numbers to identify QUAD and TRIANGLE files
+    //
+    //   QUAD_FILE_MAGIC_NUMBER =  (-1 & 0x00ffffff) ;
+    //   NEW_QUAD_FILE_MAGIC_NUMBER =  (-3 & 0x00ffffff) ;
+    //
+    qint32 NEW_QUAD_FILE_MAGIC_NUMBER =  16777213;
+    qint32 TRIANGLE_FILE_MAGIC_NUMBER =  16777214;
+    qint32 QUAD_FILE_MAGIC_NUMBER     =  16777215;
+
+    qint32 magic = IOUtils::fread3(t_DataStream);
+
+    qint32 nvert = 0;
+    qint32 nquad = 0;
+    qint32 nface = 0;
+    MatrixXf verts;
+    MatrixXi faces;
+
+    if(magic == QUAD_FILE_MAGIC_NUMBER || magic == NEW_QUAD_FILE_MAGIC_NUMBER)
+    {
+        nvert = IOUtils::fread3(t_DataStream);
+        nquad = IOUtils::fread3(t_DataStream);
+        if(magic == QUAD_FILE_MAGIC_NUMBER)
+            printf("\t%s is a quad file (nvert = %d nquad = %d)\n", p_sFile.toUtf8().constData(),nvert,nquad);
+        else
+            printf("\t%s is a new quad file (nvert = %d nquad = %d)\n", p_sFile.toUtf8().constData(),nvert,nquad);
+
+        //vertices, stored as x y z per vertex
+        verts.resize(3, nvert);
+        if(magic == QUAD_FILE_MAGIC_NUMBER)
+        {
+            Matrix<qint16, Dynamic, Dynamic> iVals(3, nvert);
+            t_DataStream.readRawData((char *)iVals.data(), nvert*3*sizeof(qint16));
+            if(t_bSwap)
+                IOUtils::swap_shortp_many(iVals.data(), iVals.size());
+            verts = iVals.cast<float>() / 100;
+        }
+        else
+        {
+            t_DataStream.readRawData((char *)verts.data(), nvert*3*sizeof(float));
+            if(t_bSwap)
+                IOUtils::swap_floatp_many(verts.data(), verts.size());
+        }
+
+        //quads, stored as four vertex indices per quad
+        VectorXi quadIdx = IOUtils::fread3_many(t_DataStream, nquad*4);
+        MatrixXi quads = Map<MatrixXi>(quadIdx.data(), 4, nquad).transpose();
+        //
+        //  Face splitting follows
+        //
+        faces = MatrixXi::Zero(2*nquad,3);
+        for(qint32 k = 0; k < nquad; ++k)
+        {
+            RowVectorXi quad = quads.row(k);
+            if ((quad[0] % 2) == 0)
+            {
+                faces(nface,0) = quad[0];
+                faces(nface,1) = quad[1];
+                faces(nface,2) = quad[3];
+                ++nface;
+
+                faces(nface,0) = quad[2];
+                faces(nface,1) = quad[3];
+                faces(nface,2) = quad[1];
+                ++nface;
+            }
+            else
+            {
+                faces(nface,0) = quad(0);
+                faces(nface,1) = quad(1);
+                faces(nface,2) = quad(2);
+                ++nface;
+
+                faces(nface,0) = quad(0);
+                faces(nface,1) = quad(2);
+                faces(nface,2) = quad(3);
+                ++nface;
+            }
+        }
+    }
+    else if(magic == TRIANGLE_FILE_MAGIC_NUMBER)
+    {
+        QString s = t_File.readLine();
+        t_File.readLine();
+
+        t_DataStream >> nvert;
+        t_DataStream >> nface;
+
+        printf("\t%s is a triangle file (nvert = %d ntri = %d)\n", p_sFile.toUtf8().constData(), nvert, nface);
+        printf("\t%s", s.toUtf8().constData());
+
+        //vertices
+        verts.resize(3, nvert);
+        t_DataStream.readRawData((char *)verts.data(), nvert*3*sizeof(float));
+        if(t_bSwap)
+            IOUtils::swap_floatp_many(verts.data(), verts.size());
+
+        //faces
+        MatrixXi tris(3, nface);
+        t_DataStream.readRawData((char *)tris.data(), nface*3*sizeof(qint32));
+        if(t_bSwap)
+            IOUtils::swap_intp_many(tris.data(), tris.size());
+        faces = tris.transpose();
+    }
+    else
+    {
+        qWarning("Bad magic number (%d) in surface file %s",magic,p_sFile.toUtf8().constData());
+        return false;
+    }
+
+    verts.transposeInPlace();
+    verts.array() *= 0.001f;
+
+    p_matRR = verts.block(0,0,verts.rows(),3);
+    p_matTris = faces.block(0,0,faces.rows(),3);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool readSurfaceCache(const QString &p_sFile, MatrixX3f &p_matRR, MatrixX3i &p_matTris, MatrixX3f &p_matNN)
+{
+    QByteArray t_baCache;
+    if(!FsCache::read(p_sFile, QString("surf"), t_baCache))
+        return false;
+
+    QDataStream t_Stream(t_baCache);
+    MatrixXf matRR, matNN;
+    MatrixXi matTris;
+    if(!CacheFile::readMatrix(t_Stream, matRR) || !CacheFile::readMatrix(t_Stream, matTris) || !CacheFile::readMatrix(t_Stream, matNN)
+            || matRR.cols() != 3 || matTris.cols() != 3 || matNN.cols() != 3)
+        return false;
+
+    p_matRR = matRR;
+    p_matTris = matTris;
+    p_matNN = matNN;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void writeSurfaceCache(const QString &p_sFile, const MatrixX3f &p_matRR, const MatrixX3i &p_matTris, const MatrixX3f &p_matNN)
+{
+    if(!FsCache::isEnabled())
+        return;
+
+    QByteArray t_baPayload;
+    QDataStream t_Stream(&t_baPayload, QIODevice::WriteOnly);
+    CacheFile::writeMatrix(t_Stream, p_matRR);
+    CacheFile::writeMatrix(t_Stream, p_matTris);
+    CacheFile::writeMatrix(t_Stream, p_matNN);
+
+    FsCache::write(p_sFile, QString("surf"), t_baPayload);
+}
+
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -245,151 +428,28 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
     p_Surface.m_sFilePath = p_sFile.mid(0,t_NameIdx);
     p_Surface.m_sFileName = p_sFile.mid(t_NameIdx,p_sFile.size()-t_NameIdx);
 
-    QDataStream t_DataStream(&t_File);
-    t_DataStream.setByteOrder(QDataStream::BigEndian);
-
-    //
-    //   Magic numbers to identify QUAD and TRIANGLE files
-    //
-    //   QUAD_FILE_MAGIC_NUMBER =  (-1 & 0x00ffffff) ;
-    //   NEW_QUAD_FILE_MAGIC_NUMBER =  (-3 & 0x00ffffff) ;
-    //
-    qint32 NEW_QUAD_FILE_MAGIC_NUMBER =  16777213;
-    qint32 TRIANGLE_FILE_MAGIC_NUMBER =  16777214;
-    qint32 QUAD_FILE_MAGIC_NUMBER     =  16777215;
-
-    qint32 magic = IOUtils::fread3(t_DataStream);
-
-    qint32 nvert = 0;
-    qint32 nquad = 0;
-    qint32 nface = 0;
-    MatrixXf verts;
-    MatrixXi faces;
-
-    if(magic == QUAD_FILE_MAGIC_NUMBER || magic == NEW_QUAD_FILE_MAGIC_NUMBER)
+    //The curvature is read while the geometry is parsed
+    QFuture<VectorXf> t_futureCurvature;
+    if(p_bLoadCurvature)
     {
-        nvert = IOUtils::fread3(t_DataStream);
-        nquad = IOUtils::fread3(t_DataStream);
-        if(magic == QUAD_FILE_MAGIC_NUMBER)
-            printf("\t%s is a quad file (nvert = %d nquad = %d)\n", p_sFile.toUtf8().constData(),nvert,nquad);
-        else
-            printf("\t%s is a new quad file (nvert = %d nquad = %d)\n", p_sFile.toUtf8().constData(),nvert,nquad);
-
-        //vertices
-        verts.resize(nvert, 3);
-        if(magic == QUAD_FILE_MAGIC_NUMBER)
-        {
-            qint16 iVal;
-            for(qint32 i = 0; i < nvert; ++i)
-            {
-                for(qint32 j = 0; j < 3; ++j)
-                {
-                    t_DataStream >> iVal;
-                    IOUtils::swap_short(iVal);
-                    verts(i,j) = ((float)iVal) / 100;
-                }
-            }
-        }
-        else
-        {
-            t_DataStream.readRawData((char *)verts.data(), nvert*3*sizeof(float));
-            for(qint32 i = 0; i < nvert; ++i)
-                for(qint32 j = 0; j < 3; ++j)
-                    IOUtils::swap_floatp(&verts(i,j));
-        }
-
-        MatrixXi quads = IOUtils::fread3_many(t_DataStream, nquad*4);
-        MatrixXi quads_new(4, nquad);
-        qint32 count = 0;
-        for(qint32 j = 0; j < quads.cols(); ++j)
-        {
-            for(qint32 i = 0; i < quads.rows(); ++i)
-            {
-                quads_new(i,j) = quads(count, 0);
-                ++count;
-            }
-        }
-        quads = quads_new.transpose();
-        //
-        //  Face splitting follows
-        //
-        faces = MatrixXi::Zero(2*nquad,3);
-        for(qint32 k = 0; k < nquad; ++k)
-        {
-            RowVectorXi quad = quads.row(k);
-            if ((quad[0] % 2) == 0)
-            {
-                faces(nface,0) = quad[0];
-                faces(nface,1) = quad[1];
-                faces(nface,2) = quad[3];
-                ++nface;
-
-                faces(nface,0) = quad[2];
-                faces(nface,1) = quad[3];
-                faces(nface,2) = quad[1];
-                ++nface;
-            }
-            else
-            {
-                faces(nface,0) = quad(0);
-                faces(nface,1) = quad(1);
-                faces(nface,2) = quad(2);
-                ++nface;
-
-                faces(nface,0) = quad(0);
-                faces(nface,1) = quad(2);
-                faces(nface,2) = quad(3);
-                ++nface;
-            }
-        }
+        QString t_sCurvatureFile = QString("%1%2.curv").arg(p_Surface.m_sFilePath).arg(p_sFile.mid(t_NameIdx,2));
+        t_futureCurvature = QtConcurrent::run(Surface::read_curv, t_sCurvatureFile);
     }
-    else if(magic == TRIANGLE_FILE_MAGIC_NUMBER)
-    {
-        QString s = t_File.readLine();
-        t_File.readLine();
-
-        t_DataStream >> nvert;
-        t_DataStream >> nface;
-        IOUtils::swap_int(nvert);
-        IOUtils::swap_int(nface);
-
-        printf("\t%s is a triangle file (nvert = %d ntri = %d)\n", p_sFile.toUtf8().constData(), nvert, nface);
-        printf("\t%s", s.toUtf8().constData());
 
-        //vertices
-        verts.resize(3, nvert);
-        t_DataStream.readRawData((char *)verts.data(), nvert*3*sizeof(float));
-        for(qint32 i = 0; i < 3; ++i)
-            for(qint32 j = 0; j < nvert; ++j)
-                IOUtils::swap_floatp(&verts(i,j));
-
-        //faces
-        faces.resize(nface, 3);
-        qint32 iVal;
-        for(qint32 i = 0; i < nface; ++i)
-        {
-            for(qint32 j = 0; j < 3; ++j)
-            {
-                t_DataStream >> iVal;
-                IOUtils::swap_int(iVal);
-                faces(i,j) = iVal;
-            }
-        }
+    if(readSurfaceCache(p_sFile, p_Surface.m_matRR, p_Surface.m_matTris, p_Surface.m_matNN))
+    {
+        printf("\t%s read from cache (nvert = %d ntri = %d)\n", p_sFile.toUtf8().constData(), (int)p_Surface.m_matRR.rows(), (int)p_Surface.m_matTris.rows());
     }
     else
     {
-        qWarning("Bad magic number (%d) in surface file %s",magic,p_sFile.toUtf8().constData());
-        return false;
-    }
-
-    verts.transposeInPlace();
-    verts.array() *= 0.001f;
+        if(!readSurfaceFile(t_File, p_sFile, p_Surface.m_matRR, p_Surface.m_matTris))
+            return false;
 
-    p_Surface.m_matRR = verts.block(0,0,verts.rows(),3);
-    p_Surface.m_matTris = faces.block(0,0,faces.rows(),3);
+        //-> not needed since qglbuilder is doing that for us
+        p_Surface.m_matNN = compute_normals(p_Surface.m_matRR, p_Surface.m_matTris);
 
-    //-> not needed since qglbuilder is doing that for us
-    p_Surface.m_matNN = compute_normals(p_Surface.m_matRR, p_Surface.m_matTris);
+        writeSurfaceCache(p_sFile, p_Surface.m_matRR, p_Surface.m_matTris, p_Surface.m_matNN);
+    }
 
     // hemi info
     if(t_File.fileName().contains("lh."))
@@ -407,19 +467,16 @@ bool Surface::read(const QString &p_sFile, Surface &p_Surface, bool p_bLoadCurva
 
     //Load curvature
     if(p_bLoadCurvature)
-    {
-        QString t_sCurvatureFile = QString("%1%2.curv").arg(p_Surface.m_sFilePath).arg(p_Surface.m_iHemi == 0 ? "lh" : "rh");
-        printf("\t");
-        p_Surface.m_vecCurv = Surface::read_curv(t_sCurvatureFile);
-    }
+        p_Surface.m_vecCurv = t_futureCurvature.result();
 
     t_File.close();
-    printf("\tRead a surface with %d vertices from %s\n[done]\n",nvert,p_sFile.toUtf8().constData());
+    printf("\tRead a surface with %d vertices from %s\n[done]\n",(int)p_Surface.m_matRR.rows(),p_sFile.toUtf8().constData());
 
     return true;
 }
 
 
+
 //*************************************************************************************************************
 
 VectorXf Surface::read_curv(const QString &p_sFileName)
@@ -427,6 +484,18 @@ VectorXf Surface::read_curv(const QString &p_sFileName)
     VectorXf curv;
 
     printf("Reading curvature...");
+
+    QByteArray t_baCache;
+    if(FsCache::read(p_sFileName, QString("curv"), t_baCache))
+    {
+        QDataStream t_CacheStream(t_baCache);
+        if(CacheFile::readMatrix(t_CacheStream, curv))
+        {
+            printf("[done]\n");
+            return curv;
+        }
+    }
+
     QFile t_File(p_sFileName);
 
     if (!t_File.open(QIODevice::ReadOnly))
@@ -451,25 +520,28 @@ VectorXf Surface::read_curv(const QString &p_sFileName)
 
         curv.resize(vnum, 1);
         t_DataStream.readRawData((char *)curv.data(), vnum*sizeof(float));
-        for(qint32 i = 0; i < vnum; ++i)
-           IOUtils::swap_floatp(&curv(i));
+        if(QSysInfo::ByteOrder == QSysInfo::LittleEndian)
+            IOUtils::swap_floatp_many(curv.data(), vnum);
     }
     else
     {
         qint32 fnum = IOUtils::fread3(t_DataStream);
         Q_UNUSED(fnum)
-        qint16 iVal;
-        curv.resize(vnum, 1);
-        for(qint32 i = 0; i < vnum; ++i)
-        {
-            t_DataStream >> iVal;
-            IOUtils::swap_short(iVal);
-            curv(i) = ((float)iVal) / 100;
-        }
+        Matrix<qint16, Dynamic, 1> iVals(vnum);
+        t_DataStream.readRawData((char *)iVals.data(), vnum*sizeof(qint16));
+        if(QSysInfo::ByteOrder == QSysInfo::LittleEndian)
+            IOUtils::swap_shortp_many(iVals.data(), vnum);
+        curv = iVals.cast<float>() / 100;
     }
     t_File.close();
 
+    QByteArray t_baPayload;
+    QDataStream t_PayloadStream(&t_baPayload, QIODevice::WriteOnly);
+    CacheFile::writeMatrix(t_PayloadStream, curv);
+    FsCache::write(p_sFileName, QString("curv"), t_baPayload);
+
     printf("[done]\n");
 
     return curv;
 }
+
@@ -47,6 +47,7 @@
 //=============================================================================================================
 
 #include <QStringList>
+#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -57,6 +58,64 @@
 using namespace FSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+QStringList surfaceFiles(const QString &path, qint32 hemi, const QString &surf)
+{
+    QStringList t_qListFiles;
+    if(hemi == 0 || hemi == 2)
+        t_qListFiles << QString("%1/lh.%2").arg(path).arg(surf);
+    if(hemi == 1 || hemi == 2)
+        t_qListFiles << QString("%1/rh.%2").arg(path).arg(surf);
+
+    return t_qListFiles;
+}
+
+
+//*************************************************************************************************************
+
+Surface readSurface(const QString &p_sFile)
+{
+    Surface t_Surface;
+    if(!Surface::read(p_sFile, t_Surface))
+        return Surface();
+
+    return t_Surface;
+}
+
+
+//*************************************************************************************************************
+
+QList<Surface> readSurfaces(const QStringList &p_qListFiles)
+{
+    //Each file is read on its own thread, a failed read results in an empty surface
+    QList<QFuture<Surface> > t_qListFutures;
+    for(qint32 i = 0; i < p_qListFiles.size(); ++i)
+        t_qListFutures.append(QtConcurrent::run(readSurface, p_qListFiles[i]));
+
+    QList<Surface> t_qListSurfaces;
+    for(qint32 i = 0; i < t_qListFutures.size(); ++i)
+        t_qListSurfaces.append(t_qListFutures[i].result());
+
+    return t_qListSurfaces;
+}
+
+
+//*************************************************************************************************************
+
+SurfaceSet readSurfaceSet(const QString &subject_id, qint32 hemi, const QString &surf, const QString &subjects_dir)
+{
+    return SurfaceSet(subject_id, hemi, surf, subjects_dir);
+}
+
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -72,19 +131,9 @@ SurfaceSet::SurfaceSet()
 
 SurfaceSet::SurfaceSet(const QString &subject_id, qint32 hemi, const QString &surf, const QString &subjects_dir)
 {
-    Surface t_Surface;
-    if(hemi == 0 || hemi == 1)
-    {
-        if(Surface::read(subject_id, hemi, surf, subjects_dir, t_Surface))
-            insert(t_Surface);
-    }
-    else if(hemi == 2)
-    {
-        if(Surface::read(subject_id, 0, surf, subjects_dir, t_Surface))
-            insert(t_Surface);
-        if(Surface::read(subject_id, 1, surf, subjects_dir, t_Surface))
-            insert(t_Surface);
-    }
+    QList<Surface> t_qListSurfaces = readSurfaces(surfaceFiles(QString("%1/%2/surf").arg(subjects_dir).arg(subject_id), hemi, surf));
+    for(qint32 i = 0; i < t_qListSurfaces.size(); ++i)
+        insert(t_qListSurfaces[i]);
 
     calcOffset();
 }
@@ -94,19 +143,9 @@ SurfaceSet::SurfaceSet(const QString &subject_id, qint32 hemi, const QString &su
 
 SurfaceSet::SurfaceSet(const QString &path, qint32 hemi, const QString &surf)
 {
-    Surface t_Surface;
-    if(hemi == 0 || hemi == 1)
-    {
-        if(Surface::read(path, hemi, surf, t_Surface))
-            insert(t_Surface);
-    }
-    else if(hemi == 2)
-    {
-        if(Surface::read(path, 0, surf, t_Surface))
-            insert(t_Surface);
-        if(Surface::read(path, 1, surf, t_Surface))
-            insert(t_Surface);
-    }
+    QList<Surface> t_qListSurfaces = readSurfaces(surfaceFiles(path, hemi, surf));
+    for(qint32 i = 0; i < t_qListSurfaces.size(); ++i)
+        insert(t_qListSurfaces[i]);
 
     calcOffset();
 }
@@ -178,15 +217,16 @@ bool SurfaceSet::read(const QString& p_sLHFileName, const QString& p_sRHFileName
     QStringList t_qListFileName;
     t_qListFileName << p_sLHFileName << p_sRHFileName;
 
+    QList<Surface> t_qListSurfaces = readSurfaces(t_qListFileName);
+
     for(qint32 i = 0; i < t_qListFileName.size(); ++i)
     {
-        Surface t_Surface;
-        if(Surface::read(t_qListFileName[i], t_Surface))
+        if(!t_qListSurfaces[i].isEmpty())
         {
             if(t_qListFileName[i].contains("lh."))
-                p_SurfaceSet.m_qMapSurfs.insert(0, t_Surface);
+                p_SurfaceSet.m_qMapSurfs.insert(0, t_qListSurfaces[i]);
             else if(t_qListFileName[i].contains("rh."))
-                p_SurfaceSet.m_qMapSurfs.insert(1, t_Surface);
+                p_SurfaceSet.m_qMapSurfs.insert(1, t_qListSurfaces[i]);
             else
                 return false;
         }
@@ -198,6 +238,47 @@ bool SurfaceSet::read(const QString& p_sLHFileName, const QString& p_sRHFileName
 }
 
 
+//*************************************************************************************************************
+
+QList<SurfaceSet> SurfaceSet::read(const QString &subject_id, qint32 hemi, const QStringList &surfs, const QString &subjects_dir)
+{
+    QString t_sPath = QString("%1/%2/surf").arg(subjects_dir).arg(subject_id);
+
+    //Read the files of all surfaces at once instead of one surface set after the other
+    QStringList t_qListFiles;
+    QList<qint32> t_qListSurfIdx;
+    for(qint32 i = 0; i < surfs.size(); ++i)
+    {
+        QStringList t_qListSurfFiles = surfaceFiles(t_sPath, hemi, surfs[i]);
+        t_qListFiles << t_qListSurfFiles;
+        for(qint32 j = 0; j < t_qListSurfFiles.size(); ++j)
+            t_qListSurfIdx << i;
+    }
+
+    QList<Surface> t_qListSurfaces = readSurfaces(t_qListFiles);
+
+    QList<SurfaceSet> t_qListSurfaceSets;
+    for(qint32 i = 0; i < surfs.size(); ++i)
+        t_qListSurfaceSets.append(SurfaceSet());
+
+    for(qint32 i = 0; i < t_qListSurfaces.size(); ++i)
+        t_qListSurfaceSets[t_qListSurfIdx[i]].insert(t_qListSurfaces[i]);
+
+    for(qint32 i = 0; i < t_qListSurfaceSets.size(); ++i)
+        t_qListSurfaceSets[i].calcOffset();
+
+    return t_qListSurfaceSets;
+}
+
+
+//*************************************************************************************************************
+
+QFuture<SurfaceSet> SurfaceSet::readAsync(const QString &subject_id, qint32 hemi, const QString &surf, const QString &subjects_dir)
+{
+    return QtConcurrent::run(readSurfaceSet, subject_id, hemi, surf, subjects_dir);
+}
+
+
 //*************************************************************************************************************
 
 const Surface& SurfaceSet::operator[] (qint32 idx) const
@@ -52,6 +52,9 @@
 
 #include <QSharedPointer>
 #include <QMap>
+#include <QList>
+#include <QStringList>
+#include <QFuture>
 
 
 //*************************************************************************************************************
@@ -179,6 +182,33 @@ public:
     */
     static bool read(const QString& p_sLHFileName, const QString& p_sRHFileName, SurfaceSet &p_SurfaceSet);
 
+    //=========================================================================================================
+    /**
+    * Reads several surfaces of a subject at once, e.g. pial, inflated and white of both hemispheres. All surface
+    * files, including their curvatures, are read concurrently.
+    *
+    * @param[in] subject_id         Name of subject
+    * @param[in] hemi               Which hemisphere to load {0 -> lh, 1 -> rh, 2 -> both}
+    * @param[in] surfs              Names of the surfaces to load (eg. inflated, orig ...)
+    * @param[in] subjects_dir       Subjects directory
+    *
+    * @return one surface set per surface name, in the order of surfs
+    */
+    static QList<SurfaceSet> read(const QString &subject_id, qint32 hemi, const QStringList &surfs, const QString &subjects_dir);
+
+    //=========================================================================================================
+    /**
+    * Reads a surface set on a worker thread, e.g. to keep a GUI responsive. The hemispheres are read concurrently.
+    *
+    * @param[in] subject_id         Name of subject
+    * @param[in] hemi               Which hemisphere to load {0 -> lh, 1 -> rh, 2 -> both}
+    * @param[in] surf               Name of the surface to load (eg. inflated, orig ...)
+    * @param[in] subjects_dir       Subjects directory
+    *
+    * @return the future surface set
+    */
+    static QFuture<SurfaceSet> readAsync(const QString &subject_id, qint32 hemi, const QString &surf, const QString &subjects_dir);
+
     //=========================================================================================================
     /**
     * The kind of Surfaces which are held by the SurfaceSet (eg. inflated, orig ...)
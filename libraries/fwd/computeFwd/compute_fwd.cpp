@@ -10,16 +10,26 @@
 #include <mne/c/mne_named_matrix.h>
 #include <mne/c/mne_nearest.h>
 #include <mne/c/mne_source_space_old.h>
+#include <mne/mne_forwardsolution.h>
 
 #include <fiff/c/fiff_sparse_matrix.h>
 
 #include <fiff/fiff_types.h>
 
+#include <utils/tracer.h>
+
 #include <time.h>
+#include <string.h>
 
 #include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QFile>
+#include <QFileInfo>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QtAlgorithms>
 
 using namespace Eigen;
 using namespace FWDLIB;
@@ -1865,12 +1875,629 @@ bool mne_attach_env(const QString& name, const QString& command)
     return true;
 }
 
+//*************************************************************************************************************
+/*
+ * The forward solution cache
+ */
+
+#define FWD_CACHE_SUFFIX "-fwd.fif"
+
+static void fwd_cache_hash_ints(QCryptographicHash& hash, const int *vals, int nval)
+{
+    hash.addData((const char *)vals,nval*sizeof(int));
+}
+
+
+static void fwd_cache_hash_floats(QCryptographicHash& hash, const float *vals, int nval)
+{
+    hash.addData((const char *)vals,nval*sizeof(float));
+}
+
+
+static void fwd_cache_hash_ch(QCryptographicHash& hash, const fiffChInfoRec& ch)
+{
+    int vals[2];
+
+    vals[0] = ch.kind;
+    vals[1] = ch.chpos.coil_type;
+    fwd_cache_hash_ints(hash,vals,2);
+    fwd_cache_hash_floats(hash,ch.chpos.r0,3);
+    fwd_cache_hash_floats(hash,ch.chpos.ex,3);
+    fwd_cache_hash_floats(hash,ch.chpos.ey,3);
+    fwd_cache_hash_floats(hash,ch.chpos.ez,3);
+    hash.addData(ch.ch_name,(int)qstrnlen(ch.ch_name,sizeof(ch.ch_name)));
+}
+
+
+static void fwd_cache_hash_selection(QCryptographicHash& hash, const fiffChInfo chs, int nch)
+/*
+ * The channel selection: the names and coil types in the order of computation
+ */
+{
+    int k;
+
+    fwd_cache_hash_ints(hash,&nch,1);
+    for (k = 0; k < nch; k++) {
+        hash.addData(chs[k].ch_name,(int)qstrnlen(chs[k].ch_name,sizeof(chs[k].ch_name)) + 1);
+        fwd_cache_hash_ints(hash,&chs[k].chpos.coil_type,1);
+    }
+}
+
+
+static void fwd_cache_hash_trans(QCryptographicHash& hash, const FiffCoordTransOld* t)
+{
+    int vals[2];
+
+    if (!t)
+        return;
+    vals[0] = t->from;
+    vals[1] = t->to;
+    fwd_cache_hash_ints(hash,vals,2);
+    fwd_cache_hash_floats(hash,t->rot.data(),9);
+    fwd_cache_hash_floats(hash,t->move.data(),3);
+}
+
+
+static QString make_fwd_cache_name(const ComputeFwdSettings* settings,
+                                   MneSourceSpaceOld*        *spaces,
+                                   int                       nspace,
+                                   FiffCoordTransOld*        mri_head_t,
+                                   FiffCoordTransOld*        meg_head_t,
+                                   FwdBemModel*              bem_model,
+                                   fiffChInfo                megchs,
+                                   int                       nmeg,
+                                   fiffChInfo                eegchs,
+                                   int                       neeg,
+                                   fiffChInfo                compchs,
+                                   int                       ncomp,
+                                   MneCTFCompDataSet*        comp_data)
+/*
+ * Name of the cache file, which carries a hash of everything the solution depends on:
+ * the settings, the transforms, the source points in use, the conductor model, the
+ * selected channels, and the compensation channels. A different channel selection
+ * thus misses the cache. The sensor positions are checked one by one on a hit.
+ */
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    int vals[6];
+    int k,p;
+
+    vals[0] = settings->accurate;
+    vals[1] = settings->fixed_ori;
+    vals[2] = settings->coord_frame;
+    vals[3] = settings->use_equiv_eeg;
+    vals[4] = settings->scale_eeg_pos;
+    vals[5] = nspace;
+    fwd_cache_hash_ints(hash,vals,6);
+    vals[0] = settings->use_eeg_table;
+    fwd_cache_hash_ints(hash,vals,1);
+    /*
+     * Coordinate transformations
+     */
+    fwd_cache_hash_trans(hash,mri_head_t);
+    fwd_cache_hash_trans(hash,meg_head_t);
+    /*
+     * The source points actually in use
+     */
+    for (k = 0; k < nspace; k++) {
+        MneSourceSpaceOld* s = spaces[k];
+
+        vals[0] = s->np;
+        vals[1] = s->nuse;
+        fwd_cache_hash_ints(hash,vals,2);
+        for (p = 0; p < s->np; p++) {
+            if (!s->inuse[p])
+                continue;
+            fwd_cache_hash_ints(hash,&p,1);
+            fwd_cache_hash_floats(hash,s->rr[p],3);
+            fwd_cache_hash_floats(hash,s->nn[p],3);
+        }
+    }
+    /*
+     * The conductor model
+     */
+    if (bem_model)
+        hash.addData(FwdBemModel::fwd_bem_make_bem_sol_cache_name(QString(),bem_model->bem_method,bem_model).toUtf8());
+    else {
+        fwd_cache_hash_floats(hash,settings->r0.data(),3);
+        fwd_cache_hash_floats(hash,&settings->eeg_sphere_rad,1);
+        hash.addData(settings->eeg_model_file.toUtf8());
+        hash.addData(settings->eeg_model_name.toUtf8());
+    }
+    /*
+     * The selected channels
+     */
+    fwd_cache_hash_selection(hash,megchs,nmeg);
+    fwd_cache_hash_selection(hash,eegchs,neeg);
+    /*
+     * Compensation
+     */
+    for (k = 0; k < ncomp; k++)
+        fwd_cache_hash_ch(hash,compchs[k]);
+    if (comp_data) {
+        for (k = 0; k < comp_data->ncomp; k++)
+            fwd_cache_hash_ints(hash,&comp_data->comps[k]->kind,1);
+    }
+    return QDir(settings->cachedir).filePath(QString(hash.result().left(8).toHex()) + FWD_CACHE_SUFFIX);
+}
+
+
+static bool fwd_cache_ch_matches(const FiffChInfo& cached, const fiffChInfoRec& ch)
+/*
+ * Is the cached channel the same sensor as the one requested?
+ */
+{
+    int c;
+
+    if (cached.kind != ch.kind || cached.chpos.coil_type != ch.chpos.coil_type)
+        return false;
+    for (c = 0; c < 3; c++) {
+        if (cached.chpos.r0[c] != ch.chpos.r0[c] || cached.chpos.ex[c] != ch.chpos.ex[c] ||
+                cached.chpos.ey[c] != ch.chpos.ey[c] || cached.chpos.ez[c] != ch.chpos.ez[c])
+            return false;
+    }
+    return true;
+}
+
+
+static MneNamedMatrix* fwd_cache_pick(const MNEForwardSolution& fwd,
+                                      fiffChInfo                chs,
+                                      int                       nch)
+/*
+ * Assemble the named matrix of the computation for these channels from the picked cache
+ */
+{
+    QStringList emptyList;
+    QStringList names;
+    float **res = NULL;
+    int ncol = fwd.sol->data.cols();
+    int j,k,row;
+
+    for (k = 0; k < nch; k++) {
+        row = fwd.sol->row_names.indexOf(chs[k].ch_name);
+        if (row < 0 || !fwd_cache_ch_matches(fwd.info.chs[row],chs[k])) {
+            FREE_CMATRIX_41(res);
+            return NULL;
+        }
+        if (!res)
+            res = ALLOC_CMATRIX_41(ncol,nch);
+        for (j = 0; j < ncol; j++)
+            res[j][k] = fwd.sol->data(row,j);
+        names.append(chs[k].ch_name);
+    }
+    return MneNamedMatrix::build_named_matrix(ncol,nch,emptyList,names,res);
+}
+
+
+static bool read_fwd_cache(const QString&  name,
+                           fiffChInfo      megchs,
+                           int             nmeg,
+                           fiffChInfo      eegchs,
+                           int             neeg,
+                           bool            fixed_ori,
+                           int             coord_frame,
+                           MneNamedMatrix* *meg_forward,
+                           MneNamedMatrix* *eeg_forward)
+/*
+ * Satisfy the computation from a cached full-channel forward solution
+ */
+{
+    MNEForwardSolution fwd;
+    QStringList names;
+    int k;
+
+    if (!QFile::exists(name))
+        return false;
+    QFile file(name);
+    if (!MNEForwardSolution::read(file,fwd,false,false,defaultQStringList,defaultQStringList,false))
+        return false;
+    if (fwd.source_ori != (fixed_ori ? FIFFV_MNE_FIXED_ORI : FIFFV_MNE_FREE_ORI) || fwd.coord_frame != coord_frame)
+        return false;
+
+    for (k = 0; k < nmeg; k++)
+        names.append(megchs[k].ch_name);
+    for (k = 0; k < neeg; k++)
+        names.append(eegchs[k].ch_name);
+    MNEForwardSolution picked = fwd.pick_channels(names);
+    if (picked.nchan != nmeg+neeg)
+        return false;
+
+    if (nmeg > 0 && (*meg_forward = fwd_cache_pick(picked,megchs,nmeg)) == NULL)
+        return false;
+    if (neeg > 0 && (*eeg_forward = fwd_cache_pick(picked,eegchs,neeg)) == NULL) {
+        delete *meg_forward;
+        *meg_forward = NULL;
+        return false;
+    }
+    return true;
+}
+
+
+static bool write_fwd_cache(const QString& name,
+                            const QString& solname)
+/*
+ * Keep a copy of the solution we just wrote
+ */
+{
+    QDir().mkpath(QFileInfo(name).absolutePath());
+    if (QFile::exists(name))
+        QFile::remove(name);
+    return QFile::copy(solname,name);
+}
+
+
+/*
+ * Partial forward solutions for distributing the computation over several processes or nodes.
+ * A partial solution holds the rows of the MEG and EEG gain matrices for the active sources
+ * first...last, numbered over all source spaces after the source space checks.
+ */
+#define FWD_PARTIAL_FIRST FIFF_MNE_FORWARD_PARTIAL_FIRST    /* First source of a partial solution */
+#define FWD_PARTIAL_LAST  FIFF_MNE_FORWARD_PARTIAL_LAST     /* Last source of a partial solution */
+
+typedef struct {
+    QString        name;        /* Source file */
+    int            first;       /* First source */
+    int            last;        /* Last source */
+    MneNamedMatrix *sol;        /* The gain rows of these sources */
+    MneNamedMatrix *sol_grad;   /* The gradient rows of these sources, NULL if not available */
+} FwdPartialRec;
+
+
+static int restrict_sources_to_range(MneSourceSpaceOld* *spaces,
+                                     int            nspace,
+                                     int            first,
+                                     int            last)
+/*
+ * Keep only the active sources first...last
+ */
+{
+    int *inuse;
+    int k,p,j,nuse;
+
+    for (k = 0, j = 0, nuse = 0; k < nspace; k++) {
+        inuse = MALLOC_41(spaces[k]->np,int);
+        for (p = 0; p < spaces[k]->np; p++) {
+            inuse[p] = FALSE;
+            if (spaces[k]->inuse[p]) {
+                if (j >= first && j <= last) {
+                    inuse[p] = TRUE;
+                    nuse++;
+                }
+                j++;
+            }
+        }
+        MneSurfaceOrVolume::mne_source_space_update_inuse(spaces[k],inuse);
+    }
+    return nuse;
+}
+
+
+static void write_partial_block(FiffStream::SPtr& t_pStream,
+                                int            method,
+                                int            first,
+                                int            last,
+                                int            nsource,
+                                int            fixed_ori,
+                                int            coord_frame,
+                                MneNamedMatrix* solution,
+                                MneNamedMatrix* solution_grad)
+{
+    int val;
+
+    t_pStream->start_block(FIFFB_MNE_FORWARD_SOLUTION);
+
+    t_pStream->write_int(FIFF_MNE_INCLUDED_METHODS,&method);
+    t_pStream->write_int(FIFF_MNE_COORD_FRAME,&coord_frame);
+    val = fixed_ori ? FIFFV_MNE_FIXED_ORI : FIFFV_MNE_FREE_ORI;
+    t_pStream->write_int(FIFF_MNE_SOURCE_ORIENTATION,&val);
+    t_pStream->write_int(FIFF_MNE_SOURCE_SPACE_NPOINTS,&nsource);
+    t_pStream->write_int(FWD_PARTIAL_FIRST,&first);
+    t_pStream->write_int(FWD_PARTIAL_LAST,&last);
+    t_pStream->write_int(FIFF_NCHAN,&solution->ncol);
+    mne_write_named_matrix(t_pStream,FIFF_MNE_FORWARD_SOLUTION,solution);
+    if (solution_grad)
+        mne_write_named_matrix(t_pStream,FIFF_MNE_FORWARD_SOLUTION_GRAD,solution_grad);
+
+    t_pStream->end_block(FIFFB_MNE_FORWARD_SOLUTION);
+}
+
+
+static bool write_partial_solution(const QString&  name,
+                                   int             first,
+                                   int             last,
+                                   int             nsource,
+                                   int             fixed_ori,
+                                   int             coord_frame,
+                                   MneNamedMatrix* meg_solution,
+                                   MneNamedMatrix* eeg_solution,
+                                   MneNamedMatrix* meg_solution_grad,
+                                   MneNamedMatrix* eeg_solution_grad)
+/*
+ * Save the gain rows of the sources first...last to be merged later with --merge
+ */
+{
+    QFile file(name);
+    FiffStream::SPtr t_pStream = FiffStream::start_file(file);
+
+    if (!t_pStream)
+        return false;
+
+    t_pStream->start_block(FIFFB_MNE);
+    if (meg_solution)
+        write_partial_block(t_pStream,FIFFV_MNE_MEG,first,last,nsource,fixed_ori,coord_frame,meg_solution,meg_solution_grad);
+    if (eeg_solution)
+        write_partial_block(t_pStream,FIFFV_MNE_EEG,first,last,nsource,fixed_ori,coord_frame,eeg_solution,eeg_solution_grad);
+    t_pStream->end_block(FIFFB_MNE);
+
+    t_pStream->end_file();
+    t_pStream->close();
+    return true;
+}
+
+
+static bool read_partial_solution(const QString&  name,
+                                  int             method,
+                                  int             nsource,
+                                  int             fixed_ori,
+                                  int             coord_frame,
+                                  fiffChInfo      chs,
+                                  int             nch,
+                                  FwdPartialRec&  part)
+/*
+ * Read the MEG or EEG part of a partial solution and check that it matches this computation
+ */
+{
+    QFile file(name);
+    FiffStream::SPtr t_pStream(new FiffStream(&file));
+    FiffTag::SPtr t_pTag;
+    QList<FiffDirNode::SPtr> fwds;
+    FiffDirNode::SPtr node;
+    int k,ncomp;
+
+    part.name     = name;
+    part.sol      = NULL;
+    part.sol_grad = NULL;
+
+    if (!t_pStream->open()) {
+        qCritical("Could not open the partial solution %s.",name.toUtf8().constData());
+        return false;
+    }
+    fwds = t_pStream->dirtree()->dir_tree_find(FIFFB_MNE_FORWARD_SOLUTION);
+    for (k = 0; k < fwds.size() && !node; k++)
+        if (fwds[k]->find_tag(t_pStream,FIFF_MNE_INCLUDED_METHODS,t_pTag) && *t_pTag->toInt() == method)
+            node = fwds[k];
+    if (!node) {
+        qCritical("No %s solution in the partial solution %s.",method == FIFFV_MNE_MEG ? "MEG" : "EEG",name.toUtf8().constData());
+        goto bad;
+    }
+    if (!node->find_tag(t_pStream,FWD_PARTIAL_FIRST,t_pTag))
+        goto notpartial;
+    part.first = *t_pTag->toInt();
+    if (!node->find_tag(t_pStream,FWD_PARTIAL_LAST,t_pTag))
+        goto notpartial;
+    part.last = *t_pTag->toInt();
+    if (!node->find_tag(t_pStream,FIFF_MNE_SOURCE_SPACE_NPOINTS,t_pTag) || *t_pTag->toInt() != nsource) {
+        qCritical("The partial solution %s was computed for a different number of sources.",name.toUtf8().constData());
+        goto bad;
+    }
+    if (!node->find_tag(t_pStream,FIFF_MNE_SOURCE_ORIENTATION,t_pTag) ||
+            *t_pTag->toInt() != (fixed_ori ? FIFFV_MNE_FIXED_ORI : FIFFV_MNE_FREE_ORI)) {
+        qCritical("The source orientations of the partial solution %s do not match.",name.toUtf8().constData());
+        goto bad;
+    }
+    if (!node->find_tag(t_pStream,FIFF_MNE_COORD_FRAME,t_pTag) || *t_pTag->toInt() != coord_frame) {
+        qCritical("The coordinate frame of the partial solution %s does not match.",name.toUtf8().constData());
+        goto bad;
+    }
+    if ((part.sol = MneNamedMatrix::read_named_matrix(t_pStream,node,FIFF_MNE_FORWARD_SOLUTION)) == NULL)
+        goto bad;
+    for (k = 0; k < node->children.size(); k++)
+        if (node->children[k]->type == FIFFB_MNE_NAMED_MATRIX && node->children[k]->has_tag(FIFF_MNE_FORWARD_SOLUTION_GRAD))
+            if ((part.sol_grad = MneNamedMatrix::read_named_matrix(t_pStream,node->children[k],FIFF_MNE_FORWARD_SOLUTION_GRAD)) == NULL)
+                goto bad;
+    t_pStream->close();
+    /*
+     * The rows are the source components, the columns the channels
+     */
+    ncomp = fixed_ori ? 1 : 3;
+    if (part.first < 0 || part.last < part.first || part.last >= nsource ||
+            part.sol->nrow != ncomp*(part.last-part.first+1) ||
+            (part.sol_grad && part.sol_grad->nrow != 3*part.sol->nrow)) {
+        qCritical("The partial solution %s is inconsistent.",name.toUtf8().constData());
+        goto bad;
+    }
+    if (part.sol->ncol != nch) {
+        qCritical("The channels of the partial solution %s do not match.",name.toUtf8().constData());
+        goto bad;
+    }
+    for (k = 0; k < nch; k++)
+        if (part.sol->collist.size() != nch || part.sol->collist[k] != QString(chs[k].ch_name)) {
+            qCritical("The channels of the partial solution %s do not match.",name.toUtf8().constData());
+            goto bad;
+        }
+    return true;
+
+notpartial :
+    qCritical("%s is not a partial solution.",name.toUtf8().constData());
+
+bad : {
+        t_pStream->close();
+        if (part.sol)
+            delete part.sol;
+        if (part.sol_grad)
+            delete part.sol_grad;
+        part.sol = part.sol_grad = NULL;
+        return false;
+    }
+}
+
+
+static bool partial_less_than(const FwdPartialRec& a, const FwdPartialRec& b)
+{
+    return a.first < b.first;
+}
+
+
+static bool merge_partial_solutions(const QStringList& names,
+                                    int             method,
+                                    int             nsource,
+                                    int             fixed_ori,
+                                    int             coord_frame,
+                                    fiffChInfo      chs,
+                                    int             nch,
+                                    MneNamedMatrix* *solution,
+                                    MneNamedMatrix* *solution_grad)
+/*
+ * Assemble the MEG or EEG gain matrices of all sources from partial solutions
+ */
+{
+    QList<FwdPartialRec> parts;
+    FwdPartialRec part;
+    QStringList emptyList;
+    QStringList chnames;
+    float **res = NULL;
+    float **res_grad = NULL;
+    bool has_grad = solution_grad != NULL;
+    bool ok = false;
+    int k,j,next,ncomp;
+
+    for (k = 0; k < names.size(); k++) {
+        if (!read_partial_solution(names[k],method,nsource,fixed_ori,coord_frame,chs,nch,part))
+            goto out;
+        parts.append(part);
+        has_grad = has_grad && part.sol_grad != NULL;
+    }
+    /*
+     * The partial solutions must cover all sources exactly once
+     */
+    qSort(parts.begin(),parts.end(),partial_less_than);
+    for (k = 0, next = 0; k < parts.size(); k++) {
+        if (parts[k].first != next) {
+            if (parts[k].first < next)
+                qCritical("The partial solution %s overlaps with %s.",parts[k].name.toUtf8().constData(),parts[k-1].name.toUtf8().constData());
+            else
+                qCritical("The sources %d...%d are missing from the partial solutions.",next,parts[k].first-1);
+            goto out;
+        }
+        next = parts[k].last+1;
+    }
+    if (next != nsource) {
+        qCritical("The sources %d...%d are missing from the partial solutions.",next,nsource-1);
+        goto out;
+    }
+    ncomp = fixed_ori ? 1 : 3;
+    res = ALLOC_CMATRIX_41(ncomp*nsource,nch);
+    if (has_grad)
+        res_grad = ALLOC_CMATRIX_41(3*ncomp*nsource,nch);
+    for (k = 0; k < parts.size(); k++) {
+        for (j = 0; j < parts[k].sol->nrow; j++)
+            memcpy(res[ncomp*parts[k].first+j],parts[k].sol->data[j],nch*sizeof(float));
+        if (has_grad)
+            for (j = 0; j < parts[k].sol_grad->nrow; j++)
+                memcpy(res_grad[3*ncomp*parts[k].first+j],parts[k].sol_grad->data[j],nch*sizeof(float));
+    }
+    for (k = 0; k < nch; k++)
+        chnames.append(chs[k].ch_name);
+    *solution = MneNamedMatrix::build_named_matrix(ncomp*nsource,nch,emptyList,chnames,res);
+    if (has_grad)
+        *solution_grad = MneNamedMatrix::build_named_matrix(3*ncomp*nsource,nch,emptyList,chnames,res_grad);
+    printf("Merged the %s solution from %d partial solutions%s.\n",method == FIFFV_MNE_MEG ? "MEG" : "EEG",
+           parts.size(),has_grad ? " with gradients" : "");
+    ok = true;
+
+out : {
+        for (k = 0; k < parts.size(); k++) {
+            delete parts[k].sol;
+            if (parts[k].sol_grad)
+                delete parts[k].sol_grad;
+        }
+        return ok;
+    }
+}
+
+
+static QString fwd_coil_def_name()
+/*
+ * Where to find the coil definitions
+ */
+{
+    QString qPath = QString("./resources/general/coilDefinitions/coil_def.dat");
+    QFile file(qPath);
+    if ( !QCoreApplication::startingUp() )
+        qPath = QCoreApplication::applicationDirPath() + QString("/resources/general/resources/coilDefinitions/coil_def.dat");
+    else if (!file.exists())
+        qPath = "./bin/resources/general/coilDefinitions/coil_def.dat";
+    return qPath;
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
 // STATIC DEFINITIONS
 //=============================================================================================================
 
+static QMutex               s_cacheMutex;
+static ComputeFwdCacheStats s_cacheStats = {0, 0, 0};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE PRIVATE TYPES
+//=============================================================================================================
+
+/**
+* The one-time setup of initHeadPositionUpdate, released with the object
+*/
+struct ComputeFwd::HeadPositionUpdate
+{
+    HeadPositionUpdate()
+    : spaces(NULL)
+    , nspace(0)
+    , mri_head_t(NULL)
+    , megchs(NULL)
+    , nmeg(0)
+    , compchs(NULL)
+    , ncomp(0)
+    , templates(NULL)
+    , comp_data(NULL)
+    , bem_model(NULL)
+    {
+    }
+
+    ~HeadPositionUpdate()
+    {
+        for (int k = 0; k < nspace; k++)
+            if(spaces[k])
+                delete spaces[k];
+        FREE_41(spaces);
+        if(mri_head_t)
+            delete mri_head_t;
+        FREE_41(megchs);
+        FREE_41(compchs);
+        if(templates)
+            delete templates;
+        if(comp_data)
+            delete comp_data;
+        if(bem_model)
+            delete bem_model;
+    }
+
+    MneSourceSpaceOld**  spaces;        /**< Source spaces in the computation coordinate frame */
+    int                  nspace;        /**< Number of source spaces */
+    FiffCoordTransOld*   mri_head_t;    /**< MRI <-> head coordinate transformation */
+    fiffChInfo           megchs;        /**< The MEG channel information */
+    int                  nmeg;          /**< Number of MEG channels */
+    fiffChInfo           compchs;       /**< The MEG compensation channel information */
+    int                  ncomp;         /**< Number of compensation channels */
+    FwdCoilSet*          templates;     /**< Coil definition templates */
+    MneCTFCompDataSet*   comp_data;     /**< Compensation data */
+    FwdBemModel*         bem_model;     /**< BEM model with the solution loaded, NULL for the sphere model */
+
+private:
+    Q_DISABLE_COPY(HeadPositionUpdate)
+};
+
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -1887,7 +2514,24 @@ ComputeFwd::ComputeFwd(ComputeFwdSettings* p_settings)
 
 ComputeFwd::~ComputeFwd()
 {
-    //ToDo Garbage collection
+}
+
+
+//*************************************************************************************************************
+
+ComputeFwdCacheStats ComputeFwd::cacheStats()
+{
+    QMutexLocker locker(&s_cacheMutex);
+    return s_cacheStats;
+}
+
+
+//*************************************************************************************************************
+
+void ComputeFwd::resetCacheStats()
+{
+    QMutexLocker locker(&s_cacheMutex);
+    s_cacheStats.hits = s_cacheStats.misses = s_cacheStats.stores = 0;
 }
 
 
@@ -1895,10 +2539,13 @@ ComputeFwd::~ComputeFwd()
 
 void ComputeFwd::calculateFwd() const
 {
+    MNE_TRACE_SCOPE("ComputeFwd::calculateFwd", "fwd");
+
     bool                res = false;
     MneSourceSpaceOld*  *spaces = NULL;  /* The source spaces */
     int                 nspace  = 0;
     int                 nsource = 0;     /* Number of source space points */
+    int                 src_last = -1;   /* Last source of a partial computation */
 
     FiffCoordTransOld* mri_head_t = NULL;   /* MRI <-> head coordinate transformation */
     FiffCoordTransOld* meg_head_t = NULL;   /* MEG <-> head coordinate transformation */
@@ -1930,7 +2577,9 @@ void ComputeFwd::calculateFwd() const
     FwdBemModel*       bem_model = NULL;
 
     QString qPath;
-    QFile file;
+
+    QString cachename;              /* Forward solution cache file */
+    bool    cached = false;
 
 
     /*
@@ -1967,6 +2616,8 @@ void ComputeFwd::calculateFwd() const
 
             if (!eeg_model->fwd_setup_eeg_sphere_model(settings->eeg_sphere_rad,settings->use_equiv_eeg,3))
                 goto out;
+            if (settings->use_eeg_table && !eeg_model->fwd_eeg_make_pot_table())
+                goto out;
 
             printf("Using EEG sphere model \"%s\" with scalp radius %7.1f mm\n",
                    settings->eeg_model_name.toUtf8().constData(),1000*settings->eeg_sphere_rad);
@@ -1988,6 +2639,10 @@ void ComputeFwd::calculateFwd() const
         printf("Calculate solution for all source locations.\n");
     if (settings->nlabel > 0)
         printf("Source space will be restricted to sources in %d labels\n",settings->nlabel);
+    if (settings->src_first >= 0)
+        printf("Calculate a partial solution for the sources %d...%d\n",settings->src_first,settings->src_last);
+    if (!settings->mergenames.isEmpty())
+        printf("Merge %d partial solutions instead of computing\n",settings->mergenames.size());
     /*
      * Read the source locations
      */
@@ -2070,12 +2725,7 @@ void ComputeFwd::calculateFwd() const
         //#else
         //        char *coilfile = mne_compose_mne_name("setup/mne","coil_def.dat");
 
-        qPath = QString("./resources/general/coilDefinitions/coil_def.dat");
-        file.setFileName(qPath);
-        if ( !QCoreApplication::startingUp() )
-            qPath = QCoreApplication::applicationDirPath() + QString("/resources/general/resources/coilDefinitions/coil_def.dat");
-        else if (!file.exists())
-            qPath = "./bin/resources/general/coilDefinitions/coil_def.dat";
+        qPath = fwd_coil_def_name();
 
         char *coilfile = MALLOC_41(strlen(qPath.toUtf8().data())+1,char);
         strcpy(coilfile,qPath.toUtf8().data());
@@ -2146,7 +2796,11 @@ void ComputeFwd::calculateFwd() const
     /*
     * Prepare the BEM model if necessary
     */
-    if (!settings->bemname.isEmpty()) {
+    if (!settings->bemname.isEmpty() && !settings->mergenames.isEmpty()) {
+        settings->bemname = FwdBemModel::fwd_bem_make_bem_sol_name(settings->bemname);
+        printf("\nThe BEM solution is not needed to merge partial solutions.\n");
+    }
+    else if (!settings->bemname.isEmpty()) {
         QString bemsolname = FwdBemModel::fwd_bem_make_bem_sol_name(settings->bemname);
         //        FREE(bemname);
         settings->bemname = bemsolname;
@@ -2204,18 +2858,56 @@ void ComputeFwd::calculateFwd() const
         }
     }
     /*
+    * Partial computations and merges number the sources remaining after the checks
+    */
+    for (k = 0, nsource = 0; k < nspace; k++)
+        nsource += spaces[k]->nuse;
+    if (settings->src_first >= 0) {
+        if (settings->src_first >= nsource) {
+            qCritical("The source range starts beyond the %d active sources.",nsource);
+            goto out;
+        }
+        src_last = qMin(settings->src_last,nsource-1);
+        restrict_sources_to_range(spaces,nspace,settings->src_first,src_last);
+        printf("Partial solution for the sources %d...%d of %d.\n",settings->src_first,src_last,nsource);
+    }
+    /*
+    * Is the solution already in the cache? The gradients and partial solutions are not kept there.
+    */
+    if (!settings->cachedir.isEmpty() && !settings->compute_grad && settings->src_first < 0 && settings->mergenames.isEmpty()) {
+        cachename = make_fwd_cache_name(settings,spaces,nspace,mri_head_t,meg_head_t,bem_model,megchs,nmeg,eegchs,neeg,compchs,ncomp,comp_data);
+        cached = read_fwd_cache(cachename,megchs,nmeg,eegchs,neeg,settings->fixed_ori,settings->coord_frame,&meg_forward,&eeg_forward);
+        {
+            QMutexLocker locker(&s_cacheMutex);
+            if (cached)
+                s_cacheStats.hits++;
+            else
+                s_cacheStats.misses++;
+            printf("Forward solution cache %s : %s (%lld hits, %lld misses)\n",cached ? "hit" : "miss",
+                   cachename.toUtf8().constData(),s_cacheStats.hits,s_cacheStats.misses);
+        }
+    }
+    /*
     * Do the actual computation
     */
     if (!bem_model)
         settings->use_threads = false;
-    if (nmeg > 0)
+    if (!settings->mergenames.isEmpty()) {
+        if (nmeg > 0 && !merge_partial_solutions(settings->mergenames,FIFFV_MNE_MEG,nsource,settings->fixed_ori,settings->coord_frame,
+                                                 megchs,nmeg,&meg_forward,settings->compute_grad ? &meg_forward_grad : NULL))
+            goto out;
+        if (neeg > 0 && !merge_partial_solutions(settings->mergenames,FIFFV_MNE_EEG,nsource,settings->fixed_ori,settings->coord_frame,
+                                                 eegchs,neeg,&eeg_forward,settings->compute_grad ? &eeg_forward_grad : NULL))
+            goto out;
+    }
+    if (nmeg > 0 && !cached && settings->mergenames.isEmpty())
         if ((FwdBemModel::compute_forward_meg(spaces,nspace,megcoils,compcoils,comp_data,
-                                              settings->fixed_ori,bem_model,&settings->r0,settings->use_threads,&meg_forward,
+                                              settings->fixed_ori,bem_model,&settings->r0,settings->use_threads,settings->nthread,&meg_forward,
                                               settings->compute_grad ? &meg_forward_grad : NULL)) == FAIL)
             goto out;
-    if (neeg > 0)
+    if (neeg > 0 && !cached && settings->mergenames.isEmpty())
         if ((FwdBemModel::compute_forward_eeg(spaces,nspace,eegels,
-                                              settings->fixed_ori,bem_model,eeg_model,settings->use_threads,&eeg_forward,
+                                              settings->fixed_ori,bem_model,eeg_model,settings->use_threads,settings->nthread,&eeg_forward,
                                               settings->compute_grad ? &eeg_forward_grad : NULL)) == FAIL)
             goto out;
     /*
@@ -2227,7 +2919,13 @@ void ComputeFwd::calculateFwd() const
     * We are ready to spill it out
     */
     printf("\nwriting %s...",settings->solname.toUtf8().constData());
-    if (!write_solution(settings->solname,               /* Destination file */
+    if (settings->src_first >= 0) {
+        if (!write_partial_solution(settings->solname,settings->src_first,src_last,nsource,
+                                    settings->fixed_ori,settings->coord_frame,
+                                    meg_forward,eeg_forward,meg_forward_grad,eeg_forward_grad))
+            goto out;
+    }
+    else if (!write_solution(settings->solname,               /* Destination file */
                        spaces,                          /* The source spaces */
                        nspace,
                        settings->mriname,mri_id,        /* MRI file and data obtained from there */
@@ -2244,6 +2942,15 @@ void ComputeFwd::calculateFwd() const
     if (!mne_attach_env(settings->solname,settings->command))
         goto out;
     printf("done\n");
+    if (!cachename.isEmpty() && !cached) {
+        if (write_fwd_cache(cachename,settings->solname)) {
+            QMutexLocker locker(&s_cacheMutex);
+            s_cacheStats.stores++;
+            printf("Forward solution stored in the cache as %s\n",cachename.toUtf8().constData());
+        }
+        else
+            printf("Could not store the forward solution in the cache as %s\n",cachename.toUtf8().constData());
+    }
     res = true;
     printf("\nFinished.\n");
 
@@ -2278,3 +2985,234 @@ out : {
     }
 }
 
+
+
+//*************************************************************************************************************
+
+bool ComputeFwd::initHeadPositionUpdate()
+{
+    QSharedPointer<HeadPositionUpdate> pUpdate = QSharedPointer<HeadPositionUpdate>::create();
+    HeadPositionUpdate* u = pUpdate.data();
+    QString            bemsolname;
+    int                k;
+
+    clearHeadPositionUpdate();
+
+    printf("\nSetting up the MEG forward update for head movements...\n");
+    if (!settings->include_meg) {
+        qCritical("MEG must be included to update the forward solution for head movements.");
+        goto bad;
+    }
+    /*
+     * Source locations, as in calculateFwd
+     */
+    if (MneSurfaceOrVolume::mne_read_source_spaces(settings->srcname,&u->spaces,&u->nspace) != OK)
+        goto bad;
+    if (settings->do_all)
+        for (k = 0; k < u->nspace; k++)
+            MneSurfaceOrVolume::enable_all_sources(u->spaces[k]);
+    if (MneSurfaceOrVolume::restrict_sources_to_labels(u->spaces,u->nspace,settings->labels,settings->nlabel) == FAIL)
+        goto bad;
+    /*
+     * MRI -> head coordinate transformation
+     */
+    if (!settings->mriname.isEmpty()) {
+        if ((u->mri_head_t = FiffCoordTransOld::mne_read_mri_transform(settings->mriname)) == NULL)
+            goto bad;
+    }
+    else if (!settings->transname.isEmpty()) {
+        FiffCoordTransOld* t;
+        if ((t = FiffCoordTransOld::mne_read_FShead2mri_transform(settings->transname.toUtf8().data())) == NULL)
+            goto bad;
+        u->mri_head_t = t->fiff_invert_transform();
+        delete t;
+    }
+    else
+        u->mri_head_t = FiffCoordTransOld::mne_identity_transform(FIFFV_COORD_MRI,FIFFV_COORD_HEAD);
+    /*
+     * MEG and compensation channels, the device -> head transform comes with each update
+     */
+    if (mne_read_meg_comp_eeg_ch_info_41(settings->measname,&u->megchs,&u->nmeg,&u->compchs,&u->ncomp,NULL,NULL,NULL,NULL) != OK)
+        goto bad;
+    if (u->nmeg == 0) {
+        qCritical("No MEG channels in %s.",settings->measname.toUtf8().constData());
+        goto bad;
+    }
+    if ((u->templates = FwdCoilSet::read_coil_defs(fwd_coil_def_name())) == NULL)
+        goto bad;
+    if ((u->comp_data = MneCTFCompDataSet::mne_read_ctf_comp_data(settings->measname)) == NULL)
+        goto bad;
+    if (u->comp_data->ncomp == 0) {
+        FREE_41(u->compchs); u->compchs = NULL;
+        u->ncomp = 0;
+        delete u->comp_data;
+        u->comp_data = NULL;
+    }
+    if (MneSurfaceOrVolume::mne_transform_source_spaces_to(settings->coord_frame,u->mri_head_t,u->spaces,u->nspace) != OK)
+        goto bad;
+    /*
+     * The BEM solution is loaded once, only the coil specific part is recomputed with each update
+     */
+    if (!settings->bemname.isEmpty()) {
+        bemsolname = FwdBemModel::fwd_bem_make_bem_sol_name(settings->bemname);
+        if ((u->bem_model = FwdBemModel::fwd_bem_load_three_layer_surfaces(bemsolname)) == NULL)
+            if ((u->bem_model = FwdBemModel::fwd_bem_load_homog_surface(bemsolname)) == NULL)
+                goto bad;
+        if (FwdBemModel::fwd_bem_load_recompute_solution(bemsolname.toUtf8().data(),FWD_BEM_UNKNOWN,FALSE,u->bem_model) == FAIL)
+            goto bad;
+        if (settings->coord_frame == FIFFV_COORD_HEAD)
+            if (FwdBemModel::fwd_bem_set_head_mri_t(u->bem_model,u->mri_head_t) == FAIL)
+                goto bad;
+        printf("BEM model %s is now set up\n",u->bem_model->sol_name.toUtf8().constData());
+    }
+    else
+        printf("Using the sphere model.\n");
+    /*
+     * The same sources as in calculateFwd
+     */
+    if (settings->filter_spaces)
+        if (MneSurfaceOrVolume::filter_source_spaces(settings->mindist,
+                                                     bemsolname.toUtf8().data(),
+                                                     u->mri_head_t,
+                                                     u->spaces,
+                                                     u->nspace,NULL,settings->use_threads) == FAIL)
+            goto bad;
+    printf("MEG forward update is set up for %d channels.\n",u->nmeg);
+    m_pHeadPositionUpdate = pUpdate;
+    return true;
+
+bad : {
+        return false;
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool ComputeFwd::updateHeadPosition(const FiffCoordTrans& transDevHead, MNEForwardSolution& fwd)
+{
+    FiffCoordTransOld*  meg_head_t = NULL;     /* MEG <-> head coordinate transformation */
+    FiffCoordTransOld*  head_mri_t = NULL;
+    FiffCoordTransOld*  meg_mri_t  = NULL;
+    FwdCoilSet*         megcoils   = NULL;     /* The coil descriptions */
+    FwdCoilSet*         compcoils  = NULL;     /* MEG compensation coils */
+    MneNamedMatrix*     meg_forward = NULL;    /* Result of the MEG forward calculation */
+    Matrix<float,4,4,DontAlign> T;
+    QHash<QString,int>  chIndex;
+    QElapsedTimer       timer;
+    float               rot[3][3];
+    float               move[3];
+    bool                res = false;
+    int                 j,k,c,nupdate;
+    const HeadPositionUpdate* u = m_pHeadPositionUpdate.data();
+
+    if (!m_pHeadPositionUpdate) {
+        qCritical("The MEG forward update has not been set up.");
+        return false;
+    }
+    if (!fwd.sol || fwd.sol->data.rows() == 0) {
+        qCritical("The forward solution is empty.");
+        return false;
+    }
+    if (fwd.surf_ori || (fwd.source_ori == FIFFV_MNE_FIXED_ORI) != settings->fixed_ori || fwd.coord_frame != settings->coord_frame) {
+        qCritical("The forward solution was not computed with the current settings.");
+        return false;
+    }
+    if (transDevHead.from == FIFFV_COORD_DEVICE && transDevHead.to == FIFFV_COORD_HEAD)
+        T = transDevHead.trans;
+    else if (transDevHead.from == FIFFV_COORD_HEAD && transDevHead.to == FIFFV_COORD_DEVICE)
+        T = transDevHead.invtrans;
+    else {
+        qCritical("MEG device <-> head coordinate transformation expected.");
+        return false;
+    }
+    timer.start();
+    for (j = 0; j < 3; j++) {
+        for (k = 0; k < 3; k++)
+            rot[j][k] = T(j,k);
+        move[j] = T(j,3);
+    }
+    meg_head_t = new FiffCoordTransOld(FIFFV_COORD_DEVICE,FIFFV_COORD_HEAD,rot,move);
+    /*
+     * Only the coils move
+     */
+    if (settings->coord_frame == FIFFV_COORD_MRI) {
+        head_mri_t = u->mri_head_t->fiff_invert_transform();
+        if ((meg_mri_t = FiffCoordTransOld::fiff_combine_transforms(FIFFV_COORD_DEVICE,FIFFV_COORD_MRI,meg_head_t,head_mri_t)) == NULL)
+            goto out;
+    }
+    if ((megcoils = u->templates->create_meg_coils(u->megchs,u->nmeg,
+                                                settings->accurate ? FWD_COIL_ACCURACY_ACCURATE : FWD_COIL_ACCURACY_NORMAL,
+                                                meg_mri_t ? meg_mri_t : meg_head_t)) == NULL)
+        goto out;
+    if (u->ncomp > 0)
+        if ((compcoils = u->templates->create_meg_coils(u->compchs,u->ncomp,
+                                                     FWD_COIL_ACCURACY_NORMAL,meg_mri_t ? meg_mri_t : meg_head_t)) == NULL)
+            goto out;
+    if ((FwdBemModel::compute_forward_meg(u->spaces,u->nspace,megcoils,compcoils,u->comp_data,
+                                          settings->fixed_ori,u->bem_model,&settings->r0,settings->use_threads && u->bem_model,settings->nthread,&meg_forward,
+                                          NULL)) == FAIL)
+        goto out;
+    if (meg_forward->nrow != fwd.sol->data.cols()) {
+        qCritical("The forward solution has %d source components instead of %d.",(int)fwd.sol->data.cols(),meg_forward->nrow);
+        goto out;
+    }
+    /*
+     * Replace the MEG rows, the channel order is the one of the forward solution
+     */
+    for (c = 0; c < meg_forward->ncol; c++)
+        chIndex.insert(meg_forward->collist[c],c);
+    for (k = 0, nupdate = 0; k < fwd.sol->data.rows() && k < fwd.sol->row_names.size(); k++) {
+        if ((c = chIndex.value(fwd.sol->row_names[k],-1)) < 0)
+            continue;
+        for (j = 0; j < meg_forward->nrow; j++)
+            fwd.sol->data(k,j) = meg_forward->data[j][c];
+        nupdate++;
+    }
+    fwd.info.dev_head_t.from     = FIFFV_COORD_DEVICE;
+    fwd.info.dev_head_t.to       = FIFFV_COORD_HEAD;
+    fwd.info.dev_head_t.trans    = T;
+    fwd.info.dev_head_t.invtrans = T.inverse();
+    printf("Updated %d MEG channels of the forward solution in %lld ms\n",nupdate,timer.elapsed());
+    res = true;
+
+out : {
+        if(meg_head_t)
+            delete meg_head_t;
+        if(head_mri_t)
+            delete head_mri_t;
+        if(meg_mri_t)
+            delete meg_mri_t;
+        if(megcoils)
+            delete megcoils;
+        if(compcoils)
+            delete compcoils;
+        if(meg_forward)
+            delete meg_forward;
+        return res;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void ComputeFwd::clearHeadPositionUpdate()
+{
+    m_pHeadPositionUpdate.clear();
+}
+
+
+//*************************************************************************************************************
+
+bool ComputeFwd::hasHeadPositionUpdate() const
+{
+    return !m_pHeadPositionUpdate.isNull();
+}
+
+
+//*************************************************************************************************************
+
+int ComputeFwd::headPositionUpdateChannels() const
+{
+    return m_pHeadPositionUpdate ? m_pHeadPositionUpdate->nmeg : 0;
+}
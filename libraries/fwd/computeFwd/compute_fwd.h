@@ -44,6 +44,8 @@
 #include "../fwd_global.h"
 #include "compute_fwd_settings.h"
 
+#include <fiff/fiff_types.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -62,6 +64,23 @@
 #include <QString>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+namespace FIFFLIB {
+    class FiffCoordTrans;
+    class FiffCoordTransOld;
+}
+
+namespace MNELIB {
+    class MNEForwardSolution;
+    class MneSourceSpaceOld;
+    class MneCTFCompDataSet;
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE NAMESPACE FWDLIB
@@ -75,6 +94,20 @@ namespace FWDLIB
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
+class FwdCoilSet;
+class FwdBemModel;
+
+
+//=============================================================================================================
+/**
+* Counters of the forward solution cache, see ComputeFwdSettings::cachedir
+*/
+struct ComputeFwdCacheStats {
+    qint64 hits;        /**< Computations satisfied from the cache */
+    qint64 misses;      /**< Computations done from scratch */
+    qint64 stores;      /**< Solutions added to the cache */
+};
+
 
 //=============================================================================================================
 /**
@@ -103,9 +136,74 @@ public:
     //ToDo split this function into init (with settings as parameter) and the actual fit function
     void calculateFwd() const;
 
+    //=========================================================================================================
+    /**
+    * Returns the forward solution cache counters accumulated by calculateFwd
+    *
+    * @return the cache counters
+    */
+    static ComputeFwdCacheStats cacheStats();
+
+    //=========================================================================================================
+    /**
+    * Resets the forward solution cache counters
+    */
+    static void resetCacheStats();
+
+    //=========================================================================================================
+    /**
+    * Does the one-time setup for recomputing the MEG part of a forward solution after head movements:
+    * reads the source spaces, the MRI -> head transform, the MEG and compensation channels and the coil
+    * definitions, and loads the BEM solution. The source spaces are filtered the same way as in
+    * calculateFwd, so the sources match a solution computed earlier with the same settings.
+    *
+    * @return true if the setup succeeded
+    */
+    bool initHeadPositionUpdate();
+
+    //=========================================================================================================
+    /**
+    * Recomputes the MEG rows of a forward solution for a new MEG device <-> head transform, using the setup
+    * of initHeadPositionUpdate. Only the coil locations and the fields are computed again. The gradients
+    * in fwd.sol_grad are not updated.
+    *
+    * @param[in] transDevHead   The new MEG device <-> head transform (either direction).
+    * @param[in, out] fwd       Forward solution computed with the same settings, without surface orientation;
+    *                           the MEG rows of fwd.sol and fwd.info.dev_head_t are replaced.
+    *
+    * @return true if the MEG rows were updated
+    */
+    bool updateHeadPosition(const FIFFLIB::FiffCoordTrans& transDevHead, MNELIB::MNEForwardSolution& fwd);
+
+    //=========================================================================================================
+    /**
+    * Returns whether initHeadPositionUpdate succeeded, so updateHeadPosition can be used
+    *
+    * @return true if the head position update is set up
+    */
+    bool hasHeadPositionUpdate() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of MEG channels updated by updateHeadPosition
+    *
+    * @return the number of MEG channels, 0 if the head position update is not set up
+    */
+    int headPositionUpdateChannels() const;
+
+    //=========================================================================================================
+    /**
+    * Releases the setup of initHeadPositionUpdate
+    */
+    void clearHeadPositionUpdate();
+
 private:
+    struct HeadPositionUpdate;
+
     ComputeFwdSettings* settings;
 
+    QSharedPointer<HeadPositionUpdate>  m_pHeadPositionUpdate;      /**< The setup of initHeadPositionUpdate, NULL if not set up */
+
 };
 
 //*************************************************************************************************************
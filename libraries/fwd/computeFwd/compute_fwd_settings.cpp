@@ -89,6 +89,10 @@ void ComputeFwdSettings::checkIntegrity()
         qCritical("Employ the --meg and --eeg options to select MEG and/or EEG");
         return;
     }
+    if (src_first >= 0 && !mergenames.isEmpty()) {
+        qCritical("The --srcrange and --merge options cannot be used together.");
+        return;
+    }
 }
 
 
@@ -113,7 +117,12 @@ void ComputeFwdSettings::initMembers()
     eeg_sphere_rad = 0.09f;   
     scale_eeg_pos = false;    
     use_equiv_eeg = true;     
+    use_eeg_table = false;
     use_threads = true;       
+    nthread = 0;
+    cachedir = QString();
+    src_first = -1;
+    src_last = -1;
 
 }
 
@@ -140,12 +149,17 @@ void ComputeFwdSettings::usage(char *name)
     fprintf(stderr,"\t--eegscalp        scale the electrode locations to the surface of the scalp when using a sphere model\n");
     fprintf(stderr,"\t--eegmodels name  read EEG sphere model specifications from here.\n");
     fprintf(stderr,"\t--eegmodel  name  name of the EEG sphere model to use (default : Default)\n");
+    fprintf(stderr,"\t--eegtable        tabulate the series expansion of the EEG sphere model instead of using equivalent sources\n");
     fprintf(stderr,"\t--eegrad rad/mm   radius of the scalp surface to use in EEG sphere model (default : %7.1f mm)\n",1000*eeg_sphere_rad);
     fprintf(stderr,"\t--mindist dist/mm minimum allowable distance of the sources from the inner skull surface.\n");
     fprintf(stderr,"\t--mindistout name Output the omitted source space points here.\n");
     fprintf(stderr,"\t--includeall      Omit all source space checks\n");
     fprintf(stderr,"\t--all             calculate forward solution in all nodes instead the selected ones only.\n");
     fprintf(stderr,"\t--fwd  name       save the solution here\n");
+    fprintf(stderr,"\t--threads n       number of threads for the computation (default : all processors)\n");
+    fprintf(stderr,"\t--cachedir dir    reuse forward solutions cached in this directory\n");
+    fprintf(stderr,"\t--srcrange a:b    compute only the active sources a...b (0-based, inclusive) and save a partial solution\n");
+    fprintf(stderr,"\t--merge name      merge this partial solution into the solution instead of computing (can have multiple of these)\n");
     fprintf(stderr,"\t--help            print this info.\n");
     fprintf(stderr,"\t--version         print version info.\n\n");
     exit(1);
@@ -330,6 +344,11 @@ bool ComputeFwdSettings::check_args (int *argc,char **argv)
             found         = 1;
             scale_eeg_pos = true;
         }
+        else if (strcmp(argv[k],"--eegtable") == 0) {
+            found         = 1;
+            use_eeg_table = true;
+            use_equiv_eeg = false;
+        }
         else if (strcmp(argv[k],"--mindist") == 0) {
             found = 2;
             if (k == *argc - 1) {
@@ -344,6 +363,46 @@ bool ComputeFwdSettings::check_args (int *argc,char **argv)
                 mindist = 0.0f;
             mindist = mindist/1000.0f;
         }
+        else if (strcmp(argv[k],"--threads") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical("--threads: argument required.");
+                return false;
+            }
+            if (sscanf(argv[k+1],"%d",&nthread) != 1) {
+                qCritical("Could not interpret the number of threads.");
+                return false;
+            }
+            if (nthread < 0)
+                nthread = 0;
+        }
+        else if (strcmp(argv[k],"--cachedir") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical("--cachedir: argument required.");
+                return false;
+            }
+            cachedir = QString(argv[k+1]);
+        }
+        else if (strcmp(argv[k],"--srcrange") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical("--srcrange: argument required.");
+                return false;
+            }
+            if (sscanf(argv[k+1],"%d:%d",&src_first,&src_last) != 2 || src_first < 0 || src_last < src_first) {
+                qCritical("Could not interpret the source range specification.");
+                return false;
+            }
+        }
+        else if (strcmp(argv[k],"--merge") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical("--merge: argument required.");
+                return false;
+            }
+            mergenames.append(QString(argv[k+1]));
+        }
         else if (strcmp(argv[k],"--includeall") == 0) {
             found = 1;
             filter_spaces = false;
@@ -145,7 +145,13 @@ public:
     float eeg_sphere_rad;   	/**< Scalp radius to use in EEG sphere model */
     bool scale_eeg_pos;     	/**< Scale the electrode locations to scalp in the sphere model */
     bool use_equiv_eeg;      	/**< Use the equivalent source approach for the EEG sphere model */
+    bool use_eeg_table;         /**< Use the tabulated series expansion for the EEG sphere model */
     bool use_threads;        	/**< Parallelize? */
+    int nthread;                /**< Number of threads for the forward computation, 0 for all processors */
+    QString cachedir;           /**< Directory of the forward solution cache, empty for no caching */
+    int src_first;              /**< First active source of a partial computation, -1 for all sources */
+    int src_last;               /**< Last active source of a partial computation (inclusive) */
+    QStringList mergenames;     /**< Partial solutions to merge instead of computing, see --merge */
 
 private:
     void initMembers();
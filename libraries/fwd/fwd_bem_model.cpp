@@ -51,10 +51,16 @@
 #include "fwd_thread_arg.h"
 
 #include <fiff/fiff_stream.h>
+#include <utils/cachelocation.h>
+#include <utils/executionconfig.h>
+#include <utils/linalg.h>
 
+#include <QCryptographicHash>
 #include <QFile>
+#include <QFileInfo>
 #include <QList>
 #include <QThread>
+#include <QThreadPool>
 #include <QtConcurrent>
 
 #define _USE_MATH_DEFINES
@@ -218,9 +224,11 @@ float **mne_lu_invert_40(float **mat,int dim)
       * LAPACK
       */
 {
-    Eigen::MatrixXf eigen_mat = toFloatEigenMatrix_40(mat, dim, dim);
-    Eigen::MatrixXf eigen_mat_inv = eigen_mat.inverse();
-    fromFloatEigenMatrix_40(eigen_mat_inv, mat);
+    /*
+     * Work in place on the contiguous matrix with Eigen's blocked LU
+     */
+    Eigen::Map< Eigen::Matrix<float,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> > eigen_mat(mat[0],dim,dim);
+    eigen_mat = eigen_mat.partialPivLu().inverse();
     return mat;
 }
 
@@ -307,29 +315,12 @@ float **mne_mat_mat_mult_40 (float **m1,float **m2,int d1,int d2,int d3)
       * result(d1 x d3) = m1(d1 x d2) * m2(d2 x d3) */
 
 {
-#ifdef BLAS
+    /*
+     * The rows of ALLOC_CMATRIX are contiguous
+     */
     float **result = ALLOC_CMATRIX_40(d1,d3);
-    char  *transa = "N";
-    char  *transb = "N";
-    float zero = 0.0;
-    float one  = 1.0;
-    sgemm (transa,transb,&d3,&d1,&d2,
-           &one,m2[0],&d3,m1[0],&d2,&zero,result[0],&d3);
+    UTILSLIB::LinAlg::multiply(m1[0],m2[0],result[0],d1,d2,d3);
     return (result);
-#else
-    float **result = ALLOC_CMATRIX_40(d1,d3);
-    int j,k,p;
-    float sum;
-
-    for (j = 0; j < d1; j++)
-        for (k = 0; k < d3; k++) {
-            sum = 0.0;
-            for (p = 0; p < d2; p++)
-                sum = sum + m1[j][p]*m2[p][k];
-            result[j][k] = sum;
-        }
-    return (result);
-#endif
 }
 
 
@@ -1031,6 +1022,12 @@ void FwdBemModel::correct_auto_elements(MneSurfaceOld *surf, float **mat)
         row[j] = pi2 - sum;
     }
 #else
+    /*
+     * The rows are independent
+     */
+#ifdef _OPENMP
+#pragma omp parallel for private(row,sum,miss,nmemb,k,tri) schedule(dynamic,16)
+#endif
     for (j = 0; j < nnode; j++) {
         /*
          * How much is missing?
@@ -1087,10 +1084,7 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
     float **sub_mat = NULL;
     int   np1,np2,ntri,np_tot,np_max;
     float **nodes;
-    MneTriangle*   tri;
-    double omega[3];
-    double *row = NULL;
-    int    j,k,p,q,c;
+    int    j,k,p,q;
     int    joff,koff;
     MneSurfaceOld* surf1;
     MneSurfaceOld* surf2;
@@ -1105,7 +1099,6 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
     for (j = 0; j < np_tot; j++)
         for (k = 0; k < np_tot; k++)
             mat[j][k] = 0.0;
-    row        = MALLOC_40(np_max,double);
     sub_mat = MALLOC_40(np_max,float *);
     for (p = 0, joff = 0; p < surfs.size(); p++, joff = joff + np1) {
         surf1 = surfs[p];
@@ -1120,25 +1113,42 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
                     fwd_bem_explain_surface(surf1->id).toUtf8().constData(),np1,
                     fwd_bem_explain_surface(surf2->id).toUtf8().constData(),np2);
 
-            for (j = 0; j < np1; j++) {
-                for (k = 0; k < np2; k++)
-                    row[k] = 0.0;
-                for (k = 0, tri = surf2->tris; k < ntri; k++,tri++) {
-                    /*
-               * No contribution from a triangle that
-               * this vertex belongs to
-               */
-                    if (p == q && (tri->vert[0] == j || tri->vert[1] == j || tri->vert[2] == j))
-                        continue;
-                    /*
-               * Otherwise do the hard job
-               */
-                    lin_pot_coeff (nodes[j],tri,omega);
-                    for (c = 0; c < 3; c++)
-                        row[tri->vert[c]] = row[tri->vert[c]] - omega[c];
+            /*
+             * The rows are independent, each thread accumulates into its own row buffer
+             */
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            {
+                MneTriangle* tri;
+                double omega[3];
+                double *row = MALLOC_40(np2,double);
+                int    jj,k,c;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,16)
+#endif
+                for (jj = 0; jj < np1; jj++) {
+                    for (k = 0; k < np2; k++)
+                        row[k] = 0.0;
+                    for (k = 0, tri = surf2->tris; k < ntri; k++,tri++) {
+                        /*
+                 * No contribution from a triangle that
+                 * this vertex belongs to
+                 */
+                        if (p == q && (tri->vert[0] == jj || tri->vert[1] == jj || tri->vert[2] == jj))
+                            continue;
+                        /*
+                 * Otherwise do the hard job
+                 */
+                        lin_pot_coeff (nodes[jj],tri,omega);
+                        for (c = 0; c < 3; c++)
+                            row[tri->vert[c]] = row[tri->vert[c]] - omega[c];
+                    }
+                    for (k = 0; k < np2; k++)
+                        mat[jj+joff][k+koff] = row[k];
                 }
-                for (k = 0; k < np2; k++)
-                    mat[j+joff][k+koff] = row[k];
+                FREE_40(row);
             }
             if (p == q) {
                 for (j = 0; j < np1; j++)
@@ -1148,7 +1158,6 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
             fprintf(stderr,"[done]\n");
         }
     }
-    FREE_40(row);
     FREE_40(sub_mat);
     return(mat);
 }
@@ -1280,72 +1289,35 @@ void FwdBemModel::fwd_bem_ip_modify_solution(float **solution, float **ip_soluti
           * Modify the solution according to the IP approach
           */
 {
+    typedef Matrix<float,Dynamic,Dynamic,RowMajor> MatrixXfRow;
     int s;
-    int j,k,joff,koff,ntot,nlast;
+    int koff,ntot,nlast;
     float mult;
-    float *row = NULL;
-    float **sub = NULL;
 
     for (s = 0, koff = 0; s < nsurf-1; s++)
         koff = koff + ntri[s];
     nlast = ntri[nsurf-1];
     ntot  = koff + nlast;
 
-    row = MALLOC_40(nlast,float);
-    sub = MALLOC_40(ntot,float *);
+    Map<MatrixXfRow> sol(solution[0],ntot,ntot);
+    Map<MatrixXfRow> ip(ip_solution[0],nlast,nlast);
     mult = (1.0 + ip_mult)/ip_mult;
 
     fprintf(stderr,"\t\tCombining...");
-#ifndef OLD
-    fprintf(stderr,"t ");
-    mne_transpose_square_40(ip_solution,nlast);
-#endif
-    for (s = 0, joff = 0; s < nsurf; s++) {
-        fprintf(stderr,"%d3 ",s+1);
-        /*
-        * Pick the correct submatrix
-        */
-        for (j = 0; j < ntri[s]; j++)
-            sub[j] = solution[j+joff]+koff;
-        /*
-        * Multiply
-        */
-#ifdef OLD
-        for (j = 0; j < ntri[s]; j++) {
-            for (k = 0; k < nlast; k++) {
-                res = mne_dot_vectors_skip_skip(sub[j],1,ip_solution[0]+k,nlast,nlast);
-                row[k] = sub[j][k] - 2.0*res;
-            }
-            for (k = 0; k < nlast; k++)
-                sub[j][k] = row[k];
-        }
-#else
-        for (j = 0; j < ntri[s]; j++) {
-            for (k = 0; k < nlast; k++)
-                row[k] = mne_dot_vectors_40(sub[j],ip_solution[k],nlast);
-            mne_add_scaled_vector_to_40(row,-2.0,sub[j],nlast);
-        }
-#endif
-        joff = joff+ntri[s];
-    }
-#ifndef OLD
-    fprintf(stderr,"t ");
-    mne_transpose_square_40(ip_solution,nlast);
-#endif
-    fprintf(stderr,"33 ");
+    /*
+    * Multiply the columns belonging to the last surface in one blocked product
+    */
+    sol.rightCols(nlast) -= 2.0f*(sol.rightCols(nlast)*ip);
     /*
     * The lower right corner is a special case
     */
-    for (j = 0; j < nlast; j++)
-        for (k = 0; k < nlast; k++)
-            sub[j][k] = sub[j][k] + mult*ip_solution[j][k];
+    sol.bottomRightCorner(nlast,nlast) += mult*ip;
     /*
     * Final scaling
     */
     fprintf(stderr,"done.\n\t\tScaling...");
-    mne_scale_vector_40(ip_mult,solution[0],ntot*ntot);
+    sol *= ip_mult;
     fprintf(stderr,"done.\n");
-    FREE_40(row); FREE_40(sub);
     return;
 }
 
@@ -1416,6 +1388,9 @@ float **FwdBemModel::fwd_bem_solid_angles(const QList<MneSurfaceOld*>& surfs)
             surf2 = surfs[q];
             ntri2 = surf2->ntri;
             fprintf(stderr,"\t\t%s (%d) -> %s (%d) ... ",fwd_bem_explain_surface(surf1->id).toUtf8().constData(),ntri1,fwd_bem_explain_surface(surf2->id).toUtf8().constData(),ntri2);
+#ifdef _OPENMP
+#pragma omp parallel for private(k,tri,result) schedule(dynamic,16)
+#endif
             for (j = 0; j < ntri1; j++)
                 for (k = 0, tri = surf2->tris; k < ntri2; k++, tri++) {
                     if (p == q && j == k)
@@ -1560,7 +1535,92 @@ int FwdBemModel::fwd_bem_load_recompute_solution(const QString& name, int bem_me
     }
     if (bem_method == FWD_BEM_UNKNOWN)
         bem_method = FWD_BEM_LINEAR_COLL;
-    return fwd_bem_compute_solution(m,bem_method);
+    /*
+     * Maybe the solution for identical surfaces and conductivities has been computed before
+     */
+    QString cache_name = fwd_bem_make_bem_sol_cache_name(name,bem_method,m);
+    if (!force_recompute && QFile::exists(cache_name)) {
+        if (fwd_bem_load_solution(cache_name,bem_method,m) == TRUE) {
+            fprintf(stderr,"\nLoaded %s BEM solution from %s\n",fwd_bem_explain_method(m->bem_method).toUtf8().constData(),cache_name.toUtf8().constData());
+            return OK;
+        }
+        m->fwd_bem_free_solution();
+    }
+    if (fwd_bem_compute_solution(m,bem_method) == FAIL)
+        return FAIL;
+    if (fwd_bem_save_solution(cache_name,m) == OK) {
+        fprintf(stderr,"Saved the BEM solution to %s\n",cache_name.toUtf8().constData());
+        m->sol_name = cache_name;
+    }
+    return OK;
+}
+
+
+//*************************************************************************************************************
+
+QString FwdBemModel::fwd_bem_make_bem_sol_cache_name(const QString &name, int bem_method, FwdBemModel *m)
+/*
+* Make the name of the solution file for the cache, which carries a hash
+* of everything the solution depends on: the approximation method,
+* the surfaces, and the conductivities. The file is located in the
+* directory of UTILSLIB::CacheLocation and not next to the BEM file.
+*/
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    int vals[3];
+    int k,p;
+
+    vals[0] = bem_method;
+    vals[1] = m->nsurf;
+    hash.addData((const char *)vals,2*sizeof(int));
+    for (k = 0; k < m->nsurf; k++) {
+        MneSurfaceOld* surf = m->surfs[k];
+
+        vals[0] = surf->id;
+        vals[1] = surf->np;
+        vals[2] = surf->ntri;
+        hash.addData((const char *)vals,3*sizeof(int));
+        for (p = 0; p < surf->np; p++)
+            hash.addData((const char *)surf->rr[p],3*sizeof(float));
+        for (p = 0; p < surf->ntri; p++)
+            hash.addData((const char *)surf->tris[p].vert,3*sizeof(int));
+    }
+    if (m->sigma)
+        hash.addData((const char *)m->sigma,m->nsurf*sizeof(float));
+    hash.addData((const char *)&m->ip_approach_limit,sizeof(float));
+
+    QString s1 = strip_from(name,".fif");
+    QString s2 = strip_from(s1,"-sol");
+    s1 = strip_from(s2,"-bem");
+    return UTILSLIB::CacheLocation::filePath(QString("%1-%2%3").arg(QFileInfo(s1).fileName()).arg(QString(hash.result().left(8).toHex())).arg(BEM_SOL_SUFFIX));
+}
+
+
+//*************************************************************************************************************
+
+int FwdBemModel::fwd_bem_save_solution(const QString &name, FwdBemModel *m)
+/*
+* Save the potential solution matrix in a form fwd_bem_load_solution can read
+*/
+{
+    QFile file(name);
+    FiffStream::SPtr stream;
+    int method;
+
+    if (!m->solution || m->nsol <= 0)
+        return FAIL;
+    if (!(stream = FiffStream::start_file(file))) {
+        printf("Could not write the BEM solution to %s\n",name.toUtf8().constData());
+        return FAIL;
+    }
+    method = (m->bem_method == FWD_BEM_LINEAR_COLL) ? FIFFV_BEM_APPROX_LINEAR : FIFFV_BEM_APPROX_CONST;
+
+    stream->start_block(FIFFB_BEM);
+    stream->write_int(FIFF_BEM_APPROX,&method);
+    stream->write_float_matrix(FIFF_BEM_POT_SOLUTION,Map< Matrix<float,Dynamic,Dynamic,RowMajor> >(m->solution[0],m->nsol,m->nsol));
+    stream->end_block(FIFFB_BEM);
+    stream->end_file();
+    return OK;
 }
 
 
@@ -2548,7 +2608,16 @@ int FwdBemModel::fwd_bem_specify_coils(FwdBemModel *m, FwdCoilSet *coils)
 
     csol->ncoil     = coils->ncoil;
     csol->np        = m->nsol;
-    csol->solution  = mne_mat_mat_mult_40(sol,m->solution,coils->ncoil,m->nsol,m->nsol);//TODO: Suspicion, that this is slow - use Eigen
+    csol->solution  = ALLOC_CMATRIX_40(coils->ncoil,m->nsol);
+    {
+        /*
+         * Blocked and vectorized product of the contiguous coefficient and solution matrices
+         */
+        typedef Matrix<float,Dynamic,Dynamic,RowMajor> MatrixXfRow;
+        Map<MatrixXfRow>(csol->solution[0],coils->ncoil,m->nsol).noalias() =
+                Map<MatrixXfRow>(sol[0],coils->ncoil,m->nsol)*Map<MatrixXfRow>(m->solution[0],m->nsol,m->nsol);
+    }
+    fwd_bem_specify_coils_soa(m,coils,csol);
 
     FREE_CMATRIX_40(sol);
     return OK;
@@ -2687,6 +2756,104 @@ void FwdBemModel::fwd_bem_field_calc(float *rd, float *Q, FwdCoilSet *coils, Fwd
 }
 
 
+//*************************************************************************************************************
+
+void FwdBemModel::fwd_bem_specify_coils_soa(FwdBemModel *m, FwdCoilSet *coils, FwdBemSolution *sol)
+/*
+     * Set up the structure-of-arrays layouts of the potential solution points
+     * and the coil integration points for fwd_bem_field_calc_soa
+     */
+{
+    int s,k,p,q,np;
+
+    sol->pot_rr.resize(m->nsol,3);
+    sol->pot_mult.resize(m->nsol);
+    for (s = 0, p = 0; s < m->nsurf; s++) {
+        np = (m->bem_method == FWD_BEM_LINEAR_COLL) ? m->surfs[s]->np : m->surfs[s]->ntri;
+        for (k = 0; k < np; k++, p++) {
+            float *r = (m->bem_method == FWD_BEM_LINEAR_COLL) ? m->surfs[s]->rr[k] : m->surfs[s]->tris[k].cent;
+            sol->pot_rr(p,X_40) = r[X_40];
+            sol->pot_rr(p,Y_40) = r[Y_40];
+            sol->pot_rr(p,Z_40) = r[Z_40];
+            sol->pot_mult[p]    = m->source_mult[s];
+        }
+    }
+    sol->coil_first.resize(coils->ncoil+1);
+    for (k = 0, np = 0; k < coils->ncoil; k++) {
+        sol->coil_first[k] = np;
+        np += coils->coils[k]->np;
+    }
+    sol->coil_first[coils->ncoil] = np;
+    sol->coil_rmag.resize(np,3);
+    sol->coil_cosmag.resize(np,3);
+    sol->coil_w.resize(np);
+    for (k = 0, q = 0; k < coils->ncoil; k++) {
+        FwdCoil* coil = coils->coils[k];
+        for (p = 0; p < coil->np; p++, q++) {
+            sol->coil_rmag.row(q)   << coil->rmag[p][X_40], coil->rmag[p][Y_40], coil->rmag[p][Z_40];
+            sol->coil_cosmag.row(q) << coil->cosmag[p][X_40], coil->cosmag[p][Y_40], coil->cosmag[p][Z_40];
+            sol->coil_w[q]          = coil->w[p];
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FwdBemModel::fwd_bem_field_calc_soa(float *rd, float *Q, FwdCoilSet *coils, FwdBemModel *m, float *B)
+/*
+     * Calculate the magnetic field in a set of coils
+     * This is the vectorized equivalent of fwd_bem_field_calc and fwd_bem_lin_field_calc,
+     * which process one point at a time and are kept as the reference implementation.
+     * All points are handled at once on the layouts of fwd_bem_specify_coils_soa
+     */
+{
+    FwdBemSolution* sol = (FwdBemSolution*)coils->user_data;
+    float   my_rd[3],my_Q[3];
+    int     k;
+    /*
+       * The dipole location and orientation must be transformed
+       */
+    VEC_COPY_40(my_rd,rd);
+    VEC_COPY_40(my_Q,Q);
+    if (m->head_mri_t) {
+        FiffCoordTransOld::fiff_coord_trans(my_rd,m->head_mri_t,FIFFV_MOVE);
+        FiffCoordTransOld::fiff_coord_trans(my_Q,m->head_mri_t,FIFFV_NO_MOVE);
+    }
+    /*
+       * Infinite-medium potentials at the vertices or triangle centers,
+       * the differences point from the dipole to the field point as in VEC_DIFF_40(rd,rp,diff)
+       */
+    ArrayXf dx = sol->pot_rr.col(X_40).array() - my_rd[X_40];
+    ArrayXf dy = sol->pot_rr.col(Y_40).array() - my_rd[Y_40];
+    ArrayXf dz = sol->pot_rr.col(Z_40).array() - my_rd[Z_40];
+    ArrayXf diff2 = dx.square() + dy.square() + dz.square();
+    VectorXf v0 = (sol->pot_mult.array()*(my_Q[X_40]*dx + my_Q[Y_40]*dy + my_Q[Z_40]*dz)/
+                   (float(4.0*M_PI)*diff2*diff2.sqrt())).matrix();
+    /*
+       * Primary current contribution at the coil integration points
+       * (can be calculated in the coil/dipole coordinates)
+       */
+    dx = sol->coil_rmag.col(X_40).array() - rd[X_40];
+    dy = sol->coil_rmag.col(Y_40).array() - rd[Y_40];
+    dz = sol->coil_rmag.col(Z_40).array() - rd[Z_40];
+    diff2 = dx.square() + dy.square() + dz.square();
+    ArrayXf prim = sol->coil_w.array()*((Q[Y_40]*dz - Q[Z_40]*dy)*sol->coil_cosmag.col(X_40).array() +
+                                        (Q[Z_40]*dx - Q[X_40]*dz)*sol->coil_cosmag.col(Y_40).array() +
+                                        (Q[X_40]*dy - Q[Y_40]*dx)*sol->coil_cosmag.col(Z_40).array())/(diff2*diff2.sqrt());
+    /*
+       * Volume current contribution
+       */
+    Map<VectorXf>(B,coils->ncoil).noalias() = Map<const Matrix<float,Dynamic,Dynamic,RowMajor> >(sol->solution[0],sol->ncoil,sol->np)*v0;
+    /*
+       * Add the primary current contribution and scale correctly
+       */
+    for (k = 0; k < coils->ncoil; k++)
+        B[k] = MAG_FACTOR*(B[k] + prim.segment(sol->coil_first[k],sol->coil_first[k+1]-sol->coil_first[k]).sum());
+    return;
+}
+
+
 //*************************************************************************************************************
 
 void FwdBemModel::fwd_bem_field_grad_calc(float *rd, float *Q, FwdCoilSet* coils, FwdBemModel* m, float *xgrad, float *ygrad, float *zgrad)
@@ -2912,14 +3079,16 @@ int FwdBemModel::fwd_bem_field(float *rd, float *Q, FwdCoilSet *coils, float *B,
         printf("No appropriate coil-specific data available in fwd_bem_field");
         return FAIL;
     }
-    if (m->bem_method == FWD_BEM_CONSTANT_COLL)
-        fwd_bem_field_calc(rd,Q,coils,m,B);
-    else if (m->bem_method == FWD_BEM_LINEAR_COLL)
-        fwd_bem_lin_field_calc(rd,Q,coils,m,B);
-    else {
+    if (m->bem_method != FWD_BEM_CONSTANT_COLL && m->bem_method != FWD_BEM_LINEAR_COLL) {
         printf("Unknown BEM method : %d",m->bem_method);
         return FAIL;
     }
+    if (sol->pot_rr.rows() == sol->np)
+        fwd_bem_field_calc_soa(rd,Q,coils,m,B);
+    else if (m->bem_method == FWD_BEM_CONSTANT_COLL)
+        fwd_bem_field_calc(rd,Q,coils,m,B);
+    else
+        fwd_bem_lin_field_calc(rd,Q,coils,m,B);
     return OK;
 }
 
@@ -2940,12 +3109,16 @@ int FwdBemModel::fwd_bem_field_grad(float *rd, float Q[], FwdCoilSet *coils, flo
         return FAIL;
     }
     if (m->bem_method == FWD_BEM_CONSTANT_COLL) {
-        if (Bval)
+        if (Bval && sol->pot_rr.rows() == sol->np)
+            fwd_bem_field_calc_soa(rd,Q,coils,m,Bval);
+        else if (Bval)
             fwd_bem_field_calc(rd,Q,coils,m,Bval);
         fwd_bem_field_grad_calc(rd,Q,coils,m,xgrad,ygrad,zgrad);
     }
     else if (m->bem_method == FWD_BEM_LINEAR_COLL) {
-        if (Bval)
+        if (Bval && sol->pot_rr.rows() == sol->np)
+            fwd_bem_field_calc_soa(rd,Q,coils,m,Bval);
+        else if (Bval)
             fwd_bem_lin_field_calc(rd,Q,coils,m,Bval);
         fwd_bem_lin_field_grad_calc(rd,Q,coils,m,xgrad,ygrad,zgrad);
     }
@@ -2963,19 +3136,22 @@ int FwdBemModel::fwd_bem_field_grad(float *rd, float Q[], FwdCoilSet *coils, flo
 void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
 /*
 * Compute the MEG or EEG forward solution for one source space
-* and possibly for only one source component
+* and possibly for only one source component.
+* The vertices can be limited to the range a->from ... a->to-1
 */
 {
     FwdThreadArg* a = (FwdThreadArg*)arg;
     MneSourceSpaceOld* s = a->s;
     int            j,p,q;
+    int            from = a->from;
+    int            to   = a->to < 0 ? s->np : a->to;
     float          *xyz[3];
 
     p = a->off;
     q = 3*a->off;
     if (a->fixed_ori) {					  /* The normal source component only */
         if (a->field_pot_grad && a->res_grad) {                   /* Gradient requested? */
-            for (j = 0; j < s->np; j++)
+            for (j = from; j < to; j++)
                 if (s->inuse[j]) {
                     if (a->field_pot_grad(s->rr[j],s->nn[j],a->coils_els,a->res[p],
                                           a->res_grad[q],a->res_grad[q+1],a->res_grad[q+2],
@@ -2986,7 +3162,7 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
                 }
         }
         else {
-            for (j = 0; j < s->np; j++)
+            for (j = from; j < to; j++)
                 if (s->inuse[j])
                     if (a->field_pot(s->rr[j],s->nn[j],a->coils_els,a->res[p++],a->client) != OK)
                         goto bad;
@@ -2994,7 +3170,7 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
     }
     else {						  /* All source components */
         if (a->field_pot_grad && a->res_grad) {               /* Gradient requested? */
-            for (j = 0; j < s->np; j++) {
+            for (j = from; j < to; j++) {
                 if (s->inuse[j]) {
                     if (a->comp < 0) {				  /* Compute all components */
                         if (a->field_pot_grad(s->rr[j],Qx,a->coils_els,a->res[p],
@@ -3044,7 +3220,7 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
             }
         }
         else {
-            for (j = 0; j < s->np; j++) {
+            for (j = from; j < to; j++) {
                 if (s->inuse[j]) {
                     if (a->vec_field_pot) {
                         xyz[0] = a->res[p++];
@@ -3095,7 +3271,116 @@ bad : {
 
 //*************************************************************************************************************
 
-int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, FwdCoilSet *coils, FwdCoilSet *comp_coils, MneCTFCompDataSet *comp_data, bool fixed_ori, FwdBemModel *bem_model, Vector3f *r0, bool use_threads, MneNamedMatrix **resp, MneNamedMatrix **resp_grad)
+void *FwdBemModel::meg_eeg_fwd_source_blocks(void *arg)
+/*
+* Keep taking source blocks from the shared work queue
+* until it is empty or one of the blocks fails
+*/
+{
+    FwdThreadArg* a = (FwdThreadArg*)arg;
+    int           b;
+
+    a->stat = OK;
+    while ((b = a->next_block->fetchAndAddOrdered(1)) < a->blocks->size()) {
+        const FwdSourceBlock& block = a->blocks->at(b);
+        a->s    = block.s;
+        a->from = block.from;
+        a->to   = block.to;
+        a->off  = block.off;
+        meg_eeg_fwd_one_source_space(a);
+        if (a->stat != OK) {
+            a->next_block->fetchAndStoreOrdered(a->blocks->size());   /* Make the other threads stop as well */
+            break;
+        }
+    }
+    return NULL;
+}
+
+
+//*************************************************************************************************************
+
+#define FWD_SOURCE_BLOCK 64     /* Sources per block of the forward computation work queue */
+
+int FwdBemModel::meg_eeg_fwd_multi_thread(MneSourceSpaceOld **spaces, int nspace, FwdThreadArg *one_arg, bool meg, bool bem_model, int nthread)
+/*
+* Split the source spaces into blocks of at most FWD_SOURCE_BLOCK sources
+* and let nthread threads work through them, each with its own workspace
+*/
+{
+    QVector<FwdSourceBlock> blocks;
+    QAtomicInt              next_block(0);
+    QList<FwdThreadArg*>    args;
+    QList< QFuture<void*> > futures;
+    QThreadPool             pool;
+    FwdSourceBlock          block;
+    int                     j,k,n,off;
+    int                     stat = OK;
+
+    for (k = 0, off = 0; k < nspace; k++) {
+        block.s    = spaces[k];
+        block.from = 0;
+        block.off  = off;
+        for (j = 0, n = 0; j < spaces[k]->np; j++) {
+            if (!spaces[k]->inuse[j])
+                continue;
+            if (n == FWD_SOURCE_BLOCK) {
+                block.to = j;
+                blocks.append(block);
+                block.from = j;
+                block.off  = off;
+                n = 0;
+            }
+            n++;
+            off = one_arg->fixed_ori ? off + 1 : off + 3;
+        }
+        if (n > 0) {
+            block.to = spaces[k]->np;
+            blocks.append(block);
+        }
+    }
+    if (nthread > blocks.size())
+        nthread = blocks.size();
+    if (nthread < 1)
+        return OK;
+    printf("%d processors. I will use %d threads for %d blocks of at most %d sources.\n",
+           QThread::idealThreadCount(),nthread,blocks.size(),FWD_SOURCE_BLOCK);
+    /*
+    * We need copies to allocate separate workspace for each thread
+    */
+    one_arg->blocks     = &blocks;
+    one_arg->next_block = &next_block;
+    for (k = 0; k < nthread; k++)
+        args.append(meg ? FwdThreadArg::create_meg_multi_thread_duplicate(one_arg,bem_model)
+                        : FwdThreadArg::create_eeg_multi_thread_duplicate(one_arg,bem_model));
+    /*
+    * Ready to start the threads & Wait for them to complete
+    */
+    pool.setMaxThreadCount(nthread);
+    for (k = 0; k < nthread; k++)
+        futures.append(QtConcurrent::run(&pool, meg_eeg_fwd_source_blocks, (void*)args[k]));
+    for (k = 0; k < nthread; k++)
+        futures[k].waitForFinished();
+    /*
+    * Check the results
+    */
+    for (k = 0; k < nthread; k++)
+        if (args[k]->stat != OK)
+            stat = FAIL;
+    for (k = 0; k < nthread; k++) {
+        if (meg)
+            FwdThreadArg::free_meg_multi_thread_duplicate(args[k],bem_model);
+        else
+            FwdThreadArg::free_eeg_multi_thread_duplicate(args[k],bem_model);
+    }
+    one_arg->blocks     = NULL;
+    one_arg->next_block = NULL;
+    return stat;
+}
+
+
+//*************************************************************************************************************
+
+int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, FwdCoilSet *coils, FwdCoilSet *comp_coils, MneCTFCompDataSet *comp_data, bool fixed_ori, FwdBemModel *bem_model, Vector3f *r0, bool use_threads, int nthread, MneNamedMatrix **resp, MneNamedMatrix **resp_grad)
 /*
 * Compute the MEG forward solution
 * Use either the sphere model or BEM in the calculations
@@ -3110,11 +3395,11 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, Fwd
                                              * for one dipole orientation */
     int                 nmeg = coils->ncoil;/* Number of channels */
     int                 nsource;            /* Total number of sources */
-    int                 k,p,q,off;
+    int                 k,off;
     QStringList         names;              /* Channel names */
     void                *client;
     FwdThreadArg*       one_arg = NULL;
-    int                 nproc = QThread::idealThreadCount();
+    int                 nproc = UTILSLIB::ExecutionConfig::threadCount();
     QStringList         emptyList;
 
     if (bem_model) {
@@ -3211,58 +3496,15 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, Fwd
     one_arg->vec_field_pot  = vec_field;
     one_arg->field_pot_grad = field_grad;
 
-    if (nproc < 2)
+    if (nthread <= 0)
+        nthread = nproc;
+    if (nthread < 2)
         use_threads = false;
 
     if (use_threads) {
-        int            nthread  = (fixed_ori || vec_field || nproc < 6) ? nspace : 3*nspace;
-        QList <FwdThreadArg*> args; //fwdThreadArg   *args    = MALLOC_40(nthread,fwdThreadArg);
-        int            stat;
-        /*
-        * We need copies to allocate separate workspace for each thread
-        */
-        if (fixed_ori || vec_field || nproc < 6) {
-            for (k = 0, off = 0; k < nthread; k++) {
-                FwdThreadArg* t_arg = FwdThreadArg::create_meg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                t_arg->s   = spaces[k];
-                t_arg->off = off;
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-                args.append(t_arg);
-            }
-            fprintf(stderr,"%d processors. I will use one thread for each of the %d source spaces.\n",
-                    nproc,nspace);
-        }
-        else {
-            for (k = 0, off = 0, q = 0; k < nspace; k++) {
-                for (p = 0; p < 3; p++,q++) {
-                    FwdThreadArg* t_arg = FwdThreadArg::create_meg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                    t_arg->s    = spaces[k];
-                    t_arg->off  = off;
-                    t_arg->comp = p;
-                    args.append(t_arg);
-                }
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-            }
-            fprintf(stderr,"%d processors. I will use %d threads : %d source spaces x 3 source components.\n",
-                    nproc,nthread,nspace);
-        }
-        fprintf(stderr,"Computing MEG at %d source locations (%s orientations)...",
+        fprintf(stderr,"Computing MEG at %d source locations (%s orientations)...\n",
                 nsource,fixed_ori ? "fixed" : "free");
-        /*
-        * Ready to start the threads & Wait for them to complete
-        */
-        QtConcurrent::blockingMap(args, meg_eeg_fwd_one_source_space);
-        /*
-        * Check the results
-        */
-        for (k = 0, stat = OK; k < nthread; k++)
-            if (args[k]->stat != OK) {
-                stat = FAIL;
-                break;
-            }
-        for (k = 0; k < args.size(); k++)//nthread == args.size()
-            FwdThreadArg::free_meg_multi_thread_duplicate(args[k],bem_model != NULL);
-        if (stat != OK)
+        if (meg_eeg_fwd_multi_thread(spaces,nspace,one_arg,true,bem_model != NULL,nthread) != OK)
             goto bad;
     }
     else {
@@ -3309,7 +3551,7 @@ bad : {
 
 //*************************************************************************************************************
 
-int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, FwdCoilSet *els, bool fixed_ori, FwdBemModel *bem_model, FwdEegSphereModel *m, bool use_threads, MneNamedMatrix **resp, MneNamedMatrix **resp_grad)
+int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, FwdCoilSet *els, bool fixed_ori, FwdBemModel *bem_model, FwdEegSphereModel *m, bool use_threads, int nthread, MneNamedMatrix **resp, MneNamedMatrix **resp_grad)
 /*
     * Compute the EEG forward solution
     * Use either the sphere model or BEM in the calculations
@@ -3323,11 +3565,11 @@ int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, Fwd
                                              * for one dipole orientation */
     int             nsource;                /* Total number of sources */
     int             neeg = els->ncoil;      /* Number of channels */
-    int             k,p,q,off;
+    int             k,off;
     QStringList     names;                  /* Channel names */
     void            *client;
     FwdThreadArg*   one_arg = NULL;
-    int             nproc = QThread::idealThreadCount();
+    int             nproc = UTILSLIB::ExecutionConfig::threadCount();
     QStringList     emptyList;
     /*
        * Count the sources
@@ -3350,10 +3592,13 @@ int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, Fwd
     }
     else {
         if (m->nfit == 0) {
-            fprintf(stderr,"Using the standard series expansion for a multilayer sphere model for EEG\n");
+            if (m->pot_table_vr.size() > 0)
+                fprintf(stderr,"Using the tabulated series expansion for a multilayer sphere model for EEG\n");
+            else
+                fprintf(stderr,"Using the standard series expansion for a multilayer sphere model for EEG\n");
             pot      = FwdEegSphereModel::fwd_eeg_multi_spherepot_coil1;
             vec_pot  = NULL;
-            pot_grad = NULL;
+            pot_grad = FwdEegSphereModel::fwd_eeg_multi_spherepot_grad_coil;
         }
         else {
             fprintf(stderr,"Using the equivalent source approach in the homogeneous sphere for EEG\n");
@@ -3395,56 +3640,15 @@ int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, Fwd
     one_arg->vec_field_pot  = vec_pot;
     one_arg->field_pot_grad = pot_grad;
 
-    if (nproc < 2)
+    if (nthread <= 0)
+        nthread = nproc;
+    if (nthread < 2)
         use_threads = false;
 
     if (use_threads) {
-        int            nthread  = (fixed_ori || vec_pot || nproc < 6) ? nspace : 3*nspace;
-        QList <FwdThreadArg*> args; //FwdThreadArg*   *args    = MALLOC_40(nthread,FwdThreadArg*);
-        int            stat;
-        /*
-        * We need copies to allocate separate workspace for each thread
-        */
-        if (fixed_ori || vec_pot || nproc < 6) {
-            for (k = 0, off = 0; k < nthread; k++) {
-                FwdThreadArg* t_arg = FwdThreadArg::create_eeg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                t_arg->s   = spaces[k];
-                t_arg->off = off;
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-                args.append(t_arg);
-            }
-            printf("%d processors. I will use one thread for each of the %d source spaces.\n",nproc,nspace);
-        }
-        else {
-            for (k = 0, off = 0, q = 0; k < nspace; k++) {
-                for (p = 0; p < 3; p++,q++) {
-                    FwdThreadArg* t_arg = FwdThreadArg::create_eeg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                    t_arg->s    = spaces[k];
-                    t_arg->off  = off;
-                    t_arg->comp = p;
-                    args.append(t_arg);
-                }
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-            }
-            printf("%d processors. I will use %d threads : %d source spaces x 3 source components.\n",nproc,nthread,nspace);
-        }
-        printf("Computing EEG at %d source locations (%s orientations)...",
+        fprintf(stderr,"Computing EEG at %d source locations (%s orientations)...\n",
                 nsource,fixed_ori ? "fixed" : "free");
-        /*
-        * Ready to start the threads & Wait for them to complete
-        */
-        QtConcurrent::blockingMap(args, meg_eeg_fwd_one_source_space);
-        /*
-        * Check the results
-        */
-        for (k = 0, stat = OK; k < nthread; k++)
-            if (args[k]->stat != OK) {
-                stat = FAIL;
-                break;
-            }
-        for (k = 0; k < args.size(); k++)//nthread == args.size()
-            FwdThreadArg::free_eeg_multi_thread_duplicate(args[k],bem_model != NULL);
-        if (stat != OK)
+        if (meg_eeg_fwd_multi_thread(spaces,nspace,one_arg,false,bem_model != NULL,nthread) != OK)
             goto bad;
     }
     else {
@@ -3525,6 +3729,10 @@ int FwdBemModel::fwd_sphere_field(float *rd, float Q[], FwdCoilSet *coils, float
     for (p = 0; p < 3; p++)
         myrd[p] = rd[p] - r0[p];
     rd = myrd;
+    if (coils->is_packed()) {
+        fwd_sphere_field_packed(rd,Q,r0,coils,Bval);
+        return OK;
+    }
     /*
        * Check for a dipole at the origin
        */
@@ -3635,6 +3843,10 @@ int FwdBemModel::fwd_sphere_field_vec(float *rd, FwdCoilSet *coils, float **Bval
     for (p = 0; p < 3; p++)
         myrd[p] = rd[p] - r0[p];
     rd = myrd;
+    if (coils->is_packed()) {
+        fwd_sphere_field_vec_packed(rd,r0,coils,Bval);
+        return OK;
+    }
     /*
        * Check for a dipole at the origin
        */
@@ -3879,7 +4091,10 @@ int FwdBemModel::fwd_mag_dipole_field(float *rm, float M[], FwdCoilSet *coils, f
     FwdCoil* this_coil;
     float   sum,diff[3],dist,dist2,dist5,*dir;
 
-
+    if (coils->is_packed()) {
+        fwd_mag_dipole_field_packed(rm,M,coils,Bval);
+        return OK;
+    }
     for (k = 0; k < coils->ncoil; k++) {
         this_coil = coils->coils[k];
         if (FWD_IS_MEG_COIL(this_coil->type)) {
@@ -3918,7 +4133,10 @@ int FwdBemModel::fwd_mag_dipole_field_vec(float *rm, FwdCoilSet *coils, float **
     FwdCoil* this_coil;
     float   sum[3],diff[3],dist,dist2,dist5,*dir;
 
-
+    if (coils->is_packed()) {
+        fwd_mag_dipole_field_vec_packed(rm,coils,Bval);
+        return OK;
+    }
     for (k = 0; k < coils->ncoil; k++) {
         this_coil = coils->coils[k];
         if (FWD_IS_MEG_COIL(this_coil->type)) {
@@ -3948,3 +4166,219 @@ int FwdBemModel::fwd_mag_dipole_field_vec(float *rm, FwdCoilSet *coils, float **
     }
     return OK;
 }
+
+
+//*************************************************************************************************************
+
+void FwdBemModel::fwd_sphere_field_packed(const float *rd, const float *Q, const float *r0, const FwdCoilSet *coils, float *Bval)
+/*
+ * Same as fwd_sphere_field over the packed points. Everything stays in single
+ * precision and the points of each coil are contiguous.
+ */
+{
+    const Matrix<float,Dynamic,7>& pts = coils->packed_points;
+    const float *x  = pts.col(0).data();
+    const float *y  = pts.col(1).data();
+    const float *z  = pts.col(2).data();
+    const float *cx = pts.col(3).data();
+    const float *cy = pts.col(4).data();
+    const float *cz = pts.col(5).data();
+    const float *w  = pts.col(6).data();
+    float v[3];
+    float px,py,pz,a2,a,r2,r,ar,ar0,F,gr,g0,ve,vr,re,r0e,sum;
+    int   j,k;
+    bool  ok;
+
+    if (VEC_LEN_40(rd) <= EPS) {
+        for (k = 0; k < coils->ncoil; k++)
+            if (FWD_IS_MEG_COIL(coils->coils[k]->coil_class))
+                Bval[k] = 0.0f;
+        return;
+    }
+    CROSS_PRODUCT_40(Q,rd,v);
+
+    for (k = 0; k < coils->ncoil; k++) {
+        if (!FWD_IS_MEG_COIL(coils->coils[k]->coil_class))
+            continue;
+        for (j = coils->packed_first[k], sum = 0.0f; j < coils->packed_first[k+1]; j++) {
+            px = x[j] - r0[X_40];
+            py = y[j] - r0[Y_40];
+            pz = z[j] - r0[Z_40];
+            a2 = (px-rd[X_40])*(px-rd[X_40]) + (py-rd[Y_40])*(py-rd[Y_40]) + (pz-rd[Z_40])*(pz-rd[Z_40]);
+            a  = std::sqrt(a2);
+            r2 = px*px + py*py + pz*pz;
+            r  = std::sqrt(r2);
+            ar = r2 - (px*rd[X_40] + py*rd[Y_40] + pz*rd[Z_40]);
+            /*
+             * There is a problem on the negative 'z' axis if the dipole location
+             * and the field point are on the same line
+             */
+            ok = a > 0.0f && r > 0.0f && std::fabs(ar/(a*r) + 1.0f) > (float)CEPS;
+
+            ar0 = ar/a;
+            F   = a*(r*a + ar);
+            gr  = a2/r + ar0 + 2.0f*(a + r);
+            g0  = a + 2.0f*r + ar0;
+            ve  = v[X_40]*cx[j] + v[Y_40]*cy[j] + v[Z_40]*cz[j];
+            vr  = v[X_40]*px + v[Y_40]*py + v[Z_40]*pz;
+            re  = px*cx[j] + py*cy[j] + pz*cz[j];
+            r0e = rd[X_40]*cx[j] + rd[Y_40]*cy[j] + rd[Z_40]*cz[j];
+
+            sum += ok ? w[j]*(ve*F + vr*(g0*r0e - gr*re))/(F*F) : 0.0f;
+        }
+        Bval[k] = MAG_FACTOR*sum;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FwdBemModel::fwd_sphere_field_vec_packed(const float *rd, const float *r0, const FwdCoilSet *coils, float **Bval)
+/*
+ * Same as fwd_sphere_field_vec over the packed points
+ */
+{
+    const Matrix<float,Dynamic,7>& pts = coils->packed_points;
+    const float *x  = pts.col(0).data();
+    const float *y  = pts.col(1).data();
+    const float *z  = pts.col(2).data();
+    const float *cx = pts.col(3).data();
+    const float *cy = pts.col(4).data();
+    const float *cz = pts.col(5).data();
+    const float *w  = pts.col(6).data();
+    float px,py,pz,a2,a,r2,r,ar,ar0,F,gr,g0,re,r0e,w1,w2,sum[3];
+    int   j,k,p;
+    bool  ok;
+
+    if (VEC_LEN_40(rd) < EPS) {
+        for (k = 0; k < coils->ncoil; k++)
+            if (FWD_IS_MEG_COIL(coils->coils[k]->coil_class))
+                for (p = 0; p < 3; p++)
+                    Bval[p][k] = 0.0f;
+        return;
+    }
+    for (k = 0; k < coils->ncoil; k++) {
+        if (!FWD_IS_MEG_COIL(coils->coils[k]->coil_class))
+            continue;
+        sum[0] = sum[1] = sum[2] = 0.0f;
+        for (j = coils->packed_first[k]; j < coils->packed_first[k+1]; j++) {
+            px = x[j] - r0[X_40];
+            py = y[j] - r0[Y_40];
+            pz = z[j] - r0[Z_40];
+            a2 = (px-rd[X_40])*(px-rd[X_40]) + (py-rd[Y_40])*(py-rd[Y_40]) + (pz-rd[Z_40])*(pz-rd[Z_40]);
+            a  = std::sqrt(a2);
+            r2 = px*px + py*py + pz*pz;
+            r  = std::sqrt(r2);
+            ar = r2 - (px*rd[X_40] + py*rd[Y_40] + pz*rd[Z_40]);
+            ok = a > 0.0f && r > 0.0f && std::fabs(ar/(a*r) + 1.0f) > (float)CEPS;
+
+            ar0 = ar/a;
+            F   = a*(r*a + ar);
+            gr  = a2/r + ar0 + 2.0f*(a + r);
+            g0  = a + 2.0f*r + ar0;
+            re  = px*cx[j] + py*cy[j] + pz*cz[j];
+            r0e = rd[X_40]*cx[j] + rd[Y_40]*cy[j] + rd[Z_40]*cz[j];
+            /*
+             * The weights of rd x dir and rd x pos
+             */
+            w1 = ok ? w[j]/F : 0.0f;
+            w2 = ok ? w[j]*(g0*r0e - gr*re)/(F*F) : 0.0f;
+
+            sum[X_40] += w1*(rd[Y_40]*cz[j] - rd[Z_40]*cy[j]) + w2*(rd[Y_40]*pz - rd[Z_40]*py);
+            sum[Y_40] += w1*(rd[Z_40]*cx[j] - rd[X_40]*cz[j]) + w2*(rd[Z_40]*px - rd[X_40]*pz);
+            sum[Z_40] += w1*(rd[X_40]*cy[j] - rd[Y_40]*cx[j]) + w2*(rd[X_40]*py - rd[Y_40]*px);
+        }
+        for (p = 0; p < 3; p++)
+            Bval[p][k] = MAG_FACTOR*sum[p];
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FwdBemModel::fwd_mag_dipole_field_packed(const float *rm, const float *M, const FwdCoilSet *coils, float *Bval)
+/*
+ * Same as fwd_mag_dipole_field over the packed points
+ */
+{
+    const Matrix<float,Dynamic,7>& pts = coils->packed_points;
+    const float *x  = pts.col(0).data();
+    const float *y  = pts.col(1).data();
+    const float *z  = pts.col(2).data();
+    const float *cx = pts.col(3).data();
+    const float *cy = pts.col(4).data();
+    const float *cz = pts.col(5).data();
+    const float *w  = pts.col(6).data();
+    float dx,dy,dz,dist2,dist,sum;
+    int   j,k;
+
+    for (k = 0; k < coils->ncoil; k++) {
+        if (!FWD_IS_MEG_COIL(coils->coils[k]->coil_class)) {
+            if (coils->coils[k]->coil_class == FWD_COILC_EEG)
+                Bval[k] = 0.0f;
+            continue;
+        }
+        for (j = coils->packed_first[k], sum = 0.0f; j < coils->packed_first[k+1]; j++) {
+            dx = x[j] - rm[X_40];
+            dy = y[j] - rm[Y_40];
+            dz = z[j] - rm[Z_40];
+            dist2 = dx*dx + dy*dy + dz*dz;
+            dist  = std::sqrt(dist2);
+            sum += dist > (float)EPS ?
+                        w[j]*(3.0f*(M[X_40]*dx + M[Y_40]*dy + M[Z_40]*dz)*(dx*cx[j] + dy*cy[j] + dz*cz[j]) -
+                              dist2*(M[X_40]*cx[j] + M[Y_40]*cy[j] + M[Z_40]*cz[j]))/(dist2*dist2*dist) : 0.0f;
+        }
+        Bval[k] = MAG_FACTOR*sum;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FwdBemModel::fwd_mag_dipole_field_vec_packed(const float *rm, const FwdCoilSet *coils, float **Bval)
+/*
+ * Same as fwd_mag_dipole_field_vec over the packed points
+ */
+{
+    const Matrix<float,Dynamic,7>& pts = coils->packed_points;
+    const float *x  = pts.col(0).data();
+    const float *y  = pts.col(1).data();
+    const float *z  = pts.col(2).data();
+    const float *cx = pts.col(3).data();
+    const float *cy = pts.col(4).data();
+    const float *cz = pts.col(5).data();
+    const float *w  = pts.col(6).data();
+    float dx,dy,dz,dist2,dist,dist5,w1,w2,sum[3];
+    int   j,k,p;
+    bool  ok;
+
+    for (k = 0; k < coils->ncoil; k++) {
+        if (!FWD_IS_MEG_COIL(coils->coils[k]->coil_class)) {
+            if (coils->coils[k]->coil_class == FWD_COILC_EEG)
+                for (p = 0; p < 3; p++)
+                    Bval[p][k] = 0.0f;
+            continue;
+        }
+        sum[0] = sum[1] = sum[2] = 0.0f;
+        for (j = coils->packed_first[k]; j < coils->packed_first[k+1]; j++) {
+            dx = x[j] - rm[X_40];
+            dy = y[j] - rm[Y_40];
+            dz = z[j] - rm[Z_40];
+            dist2 = dx*dx + dy*dy + dz*dz;
+            dist  = std::sqrt(dist2);
+            dist5 = dist2*dist2*dist;
+            ok    = dist > (float)EPS;
+            /*
+             * The weights of diff and dir
+             */
+            w1 = ok ? 3.0f*w[j]*(dx*cx[j] + dy*cy[j] + dz*cz[j])/dist5 : 0.0f;
+            w2 = ok ? w[j]*dist2/dist5 : 0.0f;
+
+            sum[X_40] += w1*dx - w2*cx[j];
+            sum[Y_40] += w1*dy - w2*cy[j];
+            sum[Z_40] += w1*dz - w2*cz[j];
+        }
+        for (p = 0; p < 3; p++)
+            Bval[p][k] = MAG_FACTOR*sum[p];
+    }
+}
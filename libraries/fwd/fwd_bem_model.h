@@ -106,6 +106,7 @@ namespace FWDLIB
 //=============================================================================================================
 
 class FwdEegSphereModel;
+class FwdBemSolution;
 
 
 //=============================================================================================================
@@ -261,6 +262,13 @@ public:
                                         int         force_recompute,
                                         FwdBemModel* m);
 
+    static QString fwd_bem_make_bem_sol_cache_name(const QString& name,
+                                                   int          bem_method,
+                                                   FwdBemModel* m);
+
+    static int fwd_bem_save_solution(const QString& name,
+                                     FwdBemModel*   m);
+
     //============================= fwd_bem_pot.c =============================
 
     static float fwd_bem_inf_field(float *rd,      /* Dipole position */
@@ -405,6 +413,16 @@ public:
                                    FwdBemModel* m,
                                    float       *B);
 
+    static void fwd_bem_specify_coils_soa(FwdBemModel*    m,
+                                          FwdCoilSet*     coils,
+                                          FwdBemSolution* sol);
+
+    static void fwd_bem_field_calc_soa(float       *rd,
+                                       float       *Q,
+                                       FwdCoilSet*  coils,
+                                       FwdBemModel* m,
+                                       float       *B);
+
     static void fwd_bem_field_grad_calc(float       *rd,
                         float       *Q,
                         FwdCoilSet  *coils,
@@ -455,6 +473,15 @@ public:
 
     static void *meg_eeg_fwd_one_source_space(void *arg);
 
+    static void *meg_eeg_fwd_source_blocks(void *arg);
+
+    static int meg_eeg_fwd_multi_thread(MNELIB::MneSourceSpaceOld* *spaces,  /* Source spaces */
+                                        int                 nspace,       /* How many? */
+                                        FwdThreadArg*       one_arg,      /* The argument to duplicate for each thread */
+                                        bool                meg,          /* MEG or EEG duplicates? */
+                                        bool                bem_model,    /* Is the client a BEM model? */
+                                        int                 nthread);     /* Number of threads */
+
     // TODO check if this is the correct class or move
     static int compute_forward_meg( MNELIB::MneSourceSpaceOld*    *spaces,     /* Source spaces */
                                     int                 nspace,      /* How many? */
@@ -465,6 +492,7 @@ public:
                                     FwdBemModel*        bem_model,   /* BEM model definition */
                                     Eigen::Vector3f*    r0,         /* Sphere model origin */
                                     bool                use_threads, /* Parallelize with threads? */
+                                    int                 nthread,     /* Number of threads, 0 for all processors */
                                     MNELIB::MneNamedMatrix*     *resp,       /* The results */
                                     MNELIB::MneNamedMatrix*     *resp_grad);
 
@@ -475,6 +503,7 @@ public:
                                     FwdBemModel*        bem_model,   /* BEM model definition */
                                     FwdEegSphereModel*  m,           /* Sphere model definition */
                                     bool                use_threads, /* Parallelize with threads? */
+                                    int                 nthread,     /* Number of threads, 0 for all processors */
                                     MNELIB::MneNamedMatrix*     *resp,       /* The results */
                                     MNELIB::MneNamedMatrix*     *resp_grad);
 
@@ -517,6 +546,30 @@ public:
                                          float        **Bval,       /* Results: rows are the fields of the x,y, and z direction dipoles */
                                          void         *client);
 
+    /*
+     * The field computations above over the packed coil points, see FwdCoilSet::pack_coils.
+     * They are used by the functions above when the coils are packed.
+     */
+    static void fwd_sphere_field_packed(const float      *rd,      /* The dipole location relative to the origin */
+                                        const float      *Q,       /* The dipole components (xyz) */
+                                        const float      *r0,      /* The sphere model origin */
+                                        const FwdCoilSet* coils,   /* The packed coil definitions */
+                                        float            *Bval);   /* Results */
+
+    static void fwd_sphere_field_vec_packed(const float      *rd,      /* The dipole location relative to the origin */
+                                            const float      *r0,      /* The sphere model origin */
+                                            const FwdCoilSet* coils,   /* The packed coil definitions */
+                                            float            **Bval);  /* Results: rows are the fields of the x,y, and z direction dipoles */
+
+    static void fwd_mag_dipole_field_packed(const float      *rm,      /* The dipole location */
+                                            const float      *M,       /* The dipole components (xyz) */
+                                            const FwdCoilSet* coils,   /* The packed coil definitions */
+                                            float            *Bval);   /* Results */
+
+    static void fwd_mag_dipole_field_vec_packed(const float      *rm,      /* The dipole location */
+                                                const FwdCoilSet* coils,   /* The packed coil definitions */
+                                                float            **Bval);  /* Results: rows are the fields of the x,y, and z direction dipoles */
+
 public:
     QString     surf_name;      /* Name of the file where surfaces were loaded from */
     QList<MNELIB::MneSurfaceOld*> surfs;      /* The interface surfaces from outside towards inside */
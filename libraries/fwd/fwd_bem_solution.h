@@ -107,6 +107,13 @@ public:
     int   ncoil;                        /* Number of sensors */
     int   np;                           /* Number of potential solution points */
 
+    Eigen::MatrixX3f pot_rr;            /* Structure-of-arrays copy of the potential solution points, one coordinate per column */
+    Eigen::VectorXf  pot_mult;          /* The source multipliers of these points */
+    Eigen::MatrixX3f coil_rmag;         /* The integration points of all coils, one coil after the other */
+    Eigen::MatrixX3f coil_cosmag;       /* The directions of the integration points */
+    Eigen::VectorXf  coil_w;            /* The weights of the integration points */
+    Eigen::VectorXi  coil_first;        /* The first integration point of each coil, ncoil+1 entries */
+
 // ### OLD STRUCT ###
 //typedef struct {                        /* Space to store a solution matrix */
 //    float **solution;                   /* The solution matrix */
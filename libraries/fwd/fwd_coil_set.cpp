@@ -531,6 +531,36 @@ bad : {
 }
 
 
+//*************************************************************************************************************
+
+void FwdCoilSet::pack_coils()
+{
+    int k,p,c,n;
+
+    for (k = 0, n = 0; k < this->ncoil; k++)
+        if (FWD_IS_MEG_COIL(this->coils[k]->coil_class))
+            n += this->coils[k]->np;
+    this->packed_points.resize(n,7);
+    this->packed_first.resize(this->ncoil+1);
+
+    for (k = 0, n = 0; k < this->ncoil; k++) {
+        FwdCoil* coil = this->coils[k];
+
+        this->packed_first[k] = n;
+        if (!FWD_IS_MEG_COIL(coil->coil_class))
+            continue;
+        for (p = 0; p < coil->np; p++, n++) {
+            for (c = 0; c < 3; c++) {
+                this->packed_points(n,c)   = coil->rmag[p][c];
+                this->packed_points(n,c+3) = coil->cosmag[p][c];
+            }
+            this->packed_points(n,6) = coil->w[p];
+        }
+    }
+    this->packed_first[this->ncoil] = n;
+}
+
+
 //*************************************************************************************************************
 
 FwdCoilSet* FwdCoilSet::dup_coil_set(const FiffCoordTransOld* t) const
@@ -564,10 +594,8 @@ FwdCoilSet* FwdCoilSet::dup_coil_set(const FiffCoordTransOld* t) const
             FiffCoordTransOld::fiff_coord_trans(coil->ey,t,FIFFV_NO_MOVE);
             FiffCoordTransOld::fiff_coord_trans(coil->ez,t,FIFFV_NO_MOVE);
 
-            for (int p = 0; p < coil->np; p++) {
-                FiffCoordTransOld::fiff_coord_trans(coil->rmag[p],t,FIFFV_MOVE);
-                FiffCoordTransOld::fiff_coord_trans(coil->cosmag[p],t,FIFFV_NO_MOVE);
-            }
+            FiffCoordTransOld::fiff_coord_trans_points(coil->rmag,coil->np,t,FIFFV_MOVE);
+            FiffCoordTransOld::fiff_coord_trans_points(coil->cosmag,coil->np,t,FIFFV_NO_MOVE);
             coil->coord_frame = t->to;
         }
     }
@@ -226,6 +226,26 @@ public:
     */
     bool is_eeg_electrode_type(int type) const;
 
+    //=========================================================================================================
+    /**
+    * Pack the integration points of the MEG coils into contiguous single precision columns.
+    * Once packed, the sphere model and magnetic dipole field computations of FwdBemModel run over all
+    * points at once instead of coil by coil. Adding coils afterwards invalidates the packing and the
+    * computations fall back to the coil structures.
+    */
+    void pack_coils();
+
+    //=========================================================================================================
+    /**
+    * Are the integration points packed and up to date?
+    *
+    * @return   True if pack_coils has been called for the present coils
+    */
+    bool is_packed() const
+    {
+        return packed_first.size() == ncoil+1;
+    }
+
 public:
     FwdCoil **coils;                 /* The coil or electrode positions */
     int     ncoil;
@@ -233,6 +253,9 @@ public:
     void    *user_data;             /* We can put whatever in here */
     fwdUserFreeFunc user_data_free;
 
+    Eigen::Matrix<float,Eigen::Dynamic,7> packed_points;   /* Packed MEG integration points: location (xyz), direction cosines (xyz) and weight */
+    Eigen::VectorXi packed_first;   /* First packed point of each coil, ncoil+1 entries; EEG electrodes have no points */
+
 // ### OLD STRUCT ###
 //    typedef struct {
 //      fwdCoil *coils;		/* The coil or electrode positions */
@@ -51,6 +51,9 @@
 #include <qmath.h>
 
 
+#include <algorithm>
+
+
 #include <Eigen/Core>
 #include <Eigen/Dense>
 
@@ -243,6 +246,8 @@ FwdEegSphereModel::FwdEegSphereModel()
 , mu      (NULL)
 , nfit    (0)
 , scale_pos (0)
+, pot_table_beta_max (0.0)
+, pot_table_err (0.0)
 {
     r0[0] = 0.0;
     r0[1] = 0.0;
@@ -279,6 +284,10 @@ FwdEegSphereModel::FwdEegSphereModel(const FwdEegSphereModel& p_FwdEegSphereMode
         }
     }
     this->scale_pos = p_FwdEegSphereModel.scale_pos;
+    this->pot_table_vr = p_FwdEegSphereModel.pot_table_vr;
+    this->pot_table_vt = p_FwdEegSphereModel.pot_table_vt;
+    this->pot_table_beta_max = p_FwdEegSphereModel.pot_table_beta_max;
+    this->pot_table_err = p_FwdEegSphereModel.pot_table_err;
 }
 
 
@@ -647,7 +656,8 @@ int FwdEegSphereModel::fwd_eeg_multi_spherepot(float *rd, float *Q, float **el,
          */
         cos_gamma = VEC_DOT_1(pos,rd)/(rd_len*pos_len);
         beta = rd_len/pos_len;
-        calc_pot_components(beta,cos_gamma,&Vr,&Vt,m->fn,m->nterms);
+        if (!m->table_pot_components(beta,cos_gamma,&Vr,&Vt))
+            calc_pot_components(beta,cos_gamma,&Vr,&Vt,m->fn,m->nterms);
         /*
          * Then compute the combined result
          */
@@ -716,6 +726,175 @@ int FwdEegSphereModel::fwd_eeg_multi_spherepot_coil1(float *rd, float *Q, FwdCoi
 }
 
 
+//*************************************************************************************************************
+
+int FwdEegSphereModel::fwd_eeg_multi_spherepot_grad_coil(float *rd, float Q[], FwdCoilSet *coils, float Vval[], float xgrad[], float ygrad[], float zgrad[], void *client)
+/*
+          * Differences as in fwd_eeg_spherepot_grad_coil
+          *
+          * This version does not use the acceleration with help of equivalent sources
+          * in the homogeneous model
+          */
+{
+    float my_rd[3];
+    float step  = 0.0005;
+    float step2 = 2*step;
+    float *grads[3];
+    float *vval_minus = MALLOC_1(coils->ncoil,float);
+    int   p,q;
+
+    grads[0] = xgrad;
+    grads[1] = ygrad;
+    grads[2] = zgrad;
+
+    for (p = 0; p < 3; p++) {
+        VEC_COPY_1(my_rd,rd);
+        my_rd[p] = my_rd[p] + step;
+        if (fwd_eeg_multi_spherepot_coil1(my_rd,Q,coils,grads[p],client) == FAIL)
+            goto bad;
+        VEC_COPY_1(my_rd,rd);
+        my_rd[p] = my_rd[p] - step;
+        if (fwd_eeg_multi_spherepot_coil1(my_rd,Q,coils,vval_minus,client) == FAIL)
+            goto bad;
+        for (q = 0; q < coils->ncoil; q++)
+            grads[p][q] = (grads[p][q]-vval_minus[q])/step2;
+    }
+    FREE(vval_minus);
+    if (Vval) {
+        if (fwd_eeg_multi_spherepot_coil1(rd,Q,coils,Vval,client) == FAIL)
+            return FAIL;
+    }
+    return OK;
+
+bad : {
+        FREE(vval_minus);
+        return FAIL;
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool FwdEegSphereModel::fwd_eeg_make_pot_table(int nbeta, int ngamma)
+/*
+ * Tabulate the series components on a regular grid in beta and in the angle gamma.
+ * The grid has one extra row and column on each side so that the Catmull-Rom
+ * interpolation in table_pot_components needs no special cases at the edges:
+ * below beta = 0 the values are extrapolated linearly, beyond gamma = 0 and
+ * gamma = pi the radial component is even and the tangential component odd
+ * in the angle, and one row beyond the largest beta is computed from the series.
+ */
+{
+    MatrixXd vr,vt;
+    double   beta_max,dbeta,dgamma;
+    double   Vr,Vt,Vri,Vti,peak,err;
+    int      j,k;
+
+    if (this->nlayer() == 0 || nbeta < 2 || ngamma < 2)
+        return false;
+    beta_max = this->layers[0].rad/this->layers[this->nlayer()-1].rad;
+    dbeta    = beta_max/nbeta;
+    dgamma   = M_PI/ngamma;
+    if (beta_max + dbeta >= 1.0) {
+        printf("Cannot tabulate the EEG sphere model series: the innermost sphere is too large.\n");
+        return false;
+    }
+    /*
+     * Precompute the coefficients
+     */
+    if (this->fn.size() == 0 || this->nterms != MAXTERMS) {
+        this->fn.resize(MAXTERMS);
+        this->nterms = MAXTERMS;
+        for (k = 0; k < MAXTERMS; k++)
+            this->fn[k] = (2*k+3)*this->fwd_eeg_get_multi_sphere_model_coeff(k+1);
+    }
+    vr.resize(nbeta+3,ngamma+3);
+    vt.resize(nbeta+3,ngamma+3);
+    for (j = 0; j <= nbeta+1; j++) {
+        for (k = 0; k <= ngamma; k++) {
+            calc_pot_components(j*dbeta,cos(k*dgamma),&Vr,&Vt,this->fn,this->nterms);
+            vr(j+1,k+1) = Vr;
+            vt(j+1,k+1) = Vt;
+        }
+    }
+    for (j = 1; j <= nbeta+2; j++) {
+        vr(j,0)        = vr(j,2);
+        vt(j,0)        = -vt(j,2);
+        vr(j,ngamma+2) = vr(j,ngamma);
+        vt(j,ngamma+2) = -vt(j,ngamma);
+    }
+    vr.row(0) = 2.0*vr.row(1) - vr.row(2);
+    vt.row(0) = 2.0*vt.row(1) - vt.row(2);
+
+    this->pot_table_vr       = vr;
+    this->pot_table_vt       = vt;
+    this->pot_table_beta_max = beta_max;
+    /*
+     * Check the result in the middle of the cells
+     */
+    for (j = 0, peak = err = 0.0; j < nbeta; j++) {
+        for (k = 0; k < ngamma; k++) {
+            calc_pot_components((j+0.5)*dbeta,cos((k+0.5)*dgamma),&Vr,&Vt,this->fn,this->nterms);
+            table_pot_components((j+0.5)*dbeta,cos((k+0.5)*dgamma),&Vri,&Vti);
+            peak = std::max(peak,std::max(fabs(Vr),fabs(Vt)));
+            err  = std::max(err,std::max(fabs(Vr-Vri),fabs(Vt-Vti)));
+        }
+    }
+    this->pot_table_err = peak > 0.0 ? err/peak : 0.0;
+    fprintf(stderr,"Tabulated the EEG sphere model series on a %d x %d grid (beta < %5.3f) -> max. rel. error = %g\n",
+            nbeta,ngamma,beta_max,this->pot_table_err);
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FwdEegSphereModel::table_pot_components(double beta, double cgamma, double *Vrp, double *Vtp) const
+{
+    double wb[4],wg[4];
+    double x,t,sr,st,Vr,Vt;
+    int    nbeta,ngamma;
+    int    j,k,p,q;
+
+    if (this->pot_table_vr.size() == 0 || beta < 0.0 || beta > this->pot_table_beta_max)
+        return false;
+    nbeta  = this->pot_table_vr.rows()-3;
+    ngamma = this->pot_table_vr.cols()-3;
+    /*
+     * Locate the cell
+     */
+    x = beta/this->pot_table_beta_max*nbeta;
+    j = std::min((int)x,nbeta-1);
+    t = acos(std::max(-1.0,std::min(1.0,cgamma)))/M_PI*ngamma;
+    k = std::min((int)t,ngamma-1);
+    /*
+     * Catmull-Rom weights in both directions
+     */
+    x = x - j;
+    wb[0] = 0.5*((2.0 - x)*x - 1.0)*x;
+    wb[1] = 0.5*((3.0*x - 5.0)*x*x + 2.0);
+    wb[2] = 0.5*(((4.0 - 3.0*x)*x + 1.0)*x);
+    wb[3] = 0.5*(x - 1.0)*x*x;
+    t = t - k;
+    wg[0] = 0.5*((2.0 - t)*t - 1.0)*t;
+    wg[1] = 0.5*((3.0*t - 5.0)*t*t + 2.0);
+    wg[2] = 0.5*(((4.0 - 3.0*t)*t + 1.0)*t);
+    wg[3] = 0.5*(t - 1.0)*t*t;
+
+    for (p = 0, Vr = Vt = 0.0; p < 4; p++) {
+        for (q = 0, sr = st = 0.0; q < 4; q++) {
+            sr += wg[q]*this->pot_table_vr(j+p,k+q);
+            st += wg[q]*this->pot_table_vt(j+p,k+q);
+        }
+        Vr += wb[p]*sr;
+        Vt += wb[p]*st;
+    }
+    *Vrp = Vr;
+    *Vtp = Vt;
+    return true;
+}
+
+
 //*************************************************************************************************************
 // fwd_multi_spherepot.c
 bool FwdEegSphereModel::fwd_eeg_spherepot_vec( float   *rd, float   **el, int neeg, float **Vval_vec, void *client)
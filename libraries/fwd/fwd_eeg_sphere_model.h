@@ -209,6 +209,61 @@ public:
                       void       *client);
 
 
+    //=========================================================================================================
+    /**
+    * Calculate the EEG and its derivatives with respect to the dipole position in the multilayer sphere
+    * model using the fwdCoilSet structure. The derivatives are computed by differences, which is cheap
+    * once the series has been tabulated with fwd_eeg_make_pot_table.
+    *
+    * @param[in] rd         Dipole position
+    * @param[in] Q          Dipole moment
+    * @param[in] coils      Electrode positions
+    * @param[out] Vval      The potential values
+    * @param[out] xgrad     The derivatives with respect to the x coordinate of the dipole position
+    * @param[out] ygrad     The derivatives with respect to the y coordinate of the dipole position
+    * @param[out] zgrad     The derivatives with respect to the z coordinate of the dipole position
+    * @param[in] client     The sphere model definition
+    *
+    * @return OK when successful
+    */
+    static int fwd_eeg_multi_spherepot_grad_coil(float        *rd,
+                                                 float        Q[],
+                                                 FwdCoilSet*  coils,
+                                                 float        Vval[],
+                                                 float        xgrad[],
+                                                 float        ygrad[],
+                                                 float        zgrad[],
+                                                 void         *client);
+
+    //=========================================================================================================
+    /**
+    * Tabulate the radial and tangential components of the multilayer sphere series expansion as a function
+    * of beta = rd/r and of the angle between the source and field points. Once the table exists
+    * fwd_eeg_multi_spherepot interpolates it instead of summing the series whenever beta is inside the
+    * tabulated range, i.e., the source is inside the innermost sphere and the electrode is on the scalp.
+    * The maximum interpolation error relative to the peak of the components is stored in pot_table_err.
+    *
+    * @param[in] nbeta      Number of intervals in beta
+    * @param[in] ngamma     Number of intervals in the angle
+    *
+    * @return true when successful
+    */
+    bool fwd_eeg_make_pot_table(int nbeta = 256, int ngamma = 512);
+
+    //=========================================================================================================
+    /**
+    * Interpolate the tabulated series components, see fwd_eeg_make_pot_table
+    *
+    * @param[in] beta       rd/r
+    * @param[in] cgamma     Cosine of the angle between the source and field points
+    * @param[out] Vrp       Potential component for the radial dipole
+    * @param[out] Vtp       Potential component for the tangential dipole
+    *
+    * @return false if there is no table or beta is outside of it
+    */
+    bool table_pot_components(double beta, double cgamma, double *Vrp, double *Vtp) const;
+
+
 
 
     //=========================================================================================================
@@ -388,6 +443,11 @@ public:
     int             nfit;           /**< How many? */
     int             scale_pos;      /**< Scale the positions to the surface of the sphere? */
 
+    Eigen::MatrixXd pot_table_vr;       /**< Tabulated radial series component, see fwd_eeg_make_pot_table */
+    Eigen::MatrixXd pot_table_vt;       /**< Tabulated tangential series component */
+    double          pot_table_beta_max; /**< Largest tabulated beta */
+    double          pot_table_err;      /**< Maximum interpolation error relative to the peak of the components */
+
 // ### OLD STRUCT ###
 //    typedef struct {
 //      char  *name;                /* Textual identifier */
@@ -106,6 +106,10 @@ FwdThreadArg::FwdThreadArg()
 ,fixed_ori     (FALSE)
 ,stat          (FAIL)
 ,comp          (-1)
+,from          (0)
+,to            (-1)
+,blocks        (NULL)
+,next_block    (NULL)
 {
 
 }
@@ -59,6 +59,8 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QAtomicInt>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -87,6 +89,19 @@ namespace FWDLIB
 class FwdCoilSet;
 
 
+//=============================================================================================================
+/**
+* One block of source space vertices in the work queue of the multi-threaded forward computation
+*/
+struct FwdSourceBlock
+{
+    MNELIB::MneSourceSpaceOld   *s;         /* The source space */
+    int                         from;       /* First vertex of the block */
+    int                         to;         /* One past the last vertex of the block */
+    int                         off;        /* Offset within the result to the first vertex solution of the block */
+};
+
+
 //=============================================================================================================
 /**
 * Implements a Forward Thread Argument (Replaces *fwdThreadArg,fwdThreadArgRec; struct of MNE-C compute_forward.c).
@@ -138,6 +153,10 @@ public:
     MNELIB::MneSourceSpaceOld   *s;                 /* The source space to process */
     int                 fixed_ori;         /* Compute fixed orientation solution? */
     int                 comp;              /* Which component to compute for free orientations */
+    int                 from;              /* First vertex of the source space to process */
+    int                 to;                /* One past the last vertex to process, -1 for all */
+    const QVector<FwdSourceBlock> *blocks; /* Work queue of source blocks shared by the threads */
+    QAtomicInt          *next_block;       /* Next block to take from the work queue */
     int                 stat;
 
 // ### OLD STRUCT ###
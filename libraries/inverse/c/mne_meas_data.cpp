@@ -47,6 +47,8 @@
 
 #include <fiff/fiff_types.h>
 
+#include <utils/mnemath.h>
+
 #include <time.h>
 
 #include <QFile>
@@ -62,6 +64,7 @@ using namespace Eigen;
 using namespace FIFFLIB;
 using namespace MNELIB;
 using namespace INVERSELIB;
+using namespace UTILSLIB;
 
 
 
@@ -942,9 +945,7 @@ static void unpack_data(double offset,
                         int   nsamp,
                         float *orig)
 {
-    int k;
-    for (k = 0; k < nsamp; k++)
-        orig[k] = scale * packed[k] + offset;
+    Map<VectorXf>(orig,nsamp) = ((scale * Map< Matrix<short,Dynamic,1> >(packed,nsamp).cast<double>()).array() + offset).cast<float>();
     return;
 }
 
@@ -1241,7 +1242,7 @@ int mne_read_evoked(const QString& name,        /* Name of the file */
     int             res = FAIL;         /* A little bit of pessimism */
 
     float *epoch;
-    int   j,k;
+    int   k;
 
     if (setno < 0) {
         printf ("Evoked response selector must be positive!");
@@ -1304,8 +1305,7 @@ int mne_read_evoked(const QString& name,        /* Name of the file */
     }
     for (k = 0; k < nchan; k++) {
         epoch = epochs[k];
-        for (j = 0; j < nsamp; j++)
-            epoch[j] = chs[k].cal*epoch[j];
+        Map<VectorXf>(epoch,nsamp) *= chs[k].cal;
         remove_artefacts(epoch,nsamp,artefs,nartef);
     }
     /*
@@ -1703,8 +1703,6 @@ void MneMeasData::adjust_baselines(float bmin, float bmax)
     int b1,b2;
     float sfreq,tmin,tmax;
     float **data;
-    float ave;
-    int s,c;
 
     if (!this->current)
         return;
@@ -1739,14 +1737,11 @@ void MneMeasData::adjust_baselines(float bmin, float bmax)
     }
     data =  this->current->data;
     if (b2 > b1) {
-        for (c = 0; c <  this->nchan; c++) {
-            for (s = b1, ave = 0.0; s < b2; s++)
-                ave += data[s][c];
-            ave = ave/(b2-b1);
-            this->current->baselines[c] += ave;
-            for (s = 0; s <  this->current->np; s++)
-                data[s][c] = data[s][c] - ave;
-        }
+        /*
+         * The sample-major data matrix is a column-major channel x sample matrix
+         */
+        Map<MatrixXf> t_matData(data[0],this->nchan,this->current->np);
+        Map<VectorXf>(this->current->baselines,this->nchan) += MNEMath::rescaleMean(t_matData,b1,b2);
         qDebug() << "TODO: Check comments content";
         fprintf(stderr,"\t%s : using baseline %7.1f ... %7.1f ms\n",
                 this->current->comment.toUtf8().constData() ?  this->current->comment.toUtf8().constData() : "unknown",
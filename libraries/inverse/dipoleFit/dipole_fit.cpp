@@ -4,8 +4,17 @@
 #include "../c/mne_meas_data_set.h"
 #include "guess_data.h"
 
+#include <mne/c/mne_cov_matrix.h>
+
 #include <string.h>
 
+#include <QElapsedTimer>
+#include <QVector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 
 using namespace INVERSELIB;
@@ -54,6 +63,11 @@ using namespace FWDLIB;
 
 #define SEG_LEN 10.0
 
+/*
+ * Number of consecutive time points handed to a thread at once, within a chunk each fit starts from its predecessor
+ */
+#define FIT_CHUNK 16
+
 
 #define EPS_VALUES 0.05
 
@@ -597,33 +611,176 @@ int mne_get_values_from_data_ch (float time,      /* Interesting time point */
 
 
 
-//*************************************************************************************************************
-//=============================================================================================================
-// DEFINE MEMBER METHODS
-//=============================================================================================================
+//============================= fit_dipoles.c =============================
 
-DipoleFit::DipoleFit(DipoleFitSettings* p_settings)
-: settings(p_settings)
+typedef struct {
+    DipoleFit::ProgressFunc func;   /* Progress callback (optional) */
+    void          *user;            /* Client data for the above */
+    int           ntotal;           /* How many time points in total */
+    int           ndone;            /* How many have been fitted so far */
+    QElapsedTimer timer;            /* Started when the fitting began */
+} *fitProgress,fitProgressRec;
+
+
+static int get_fit_threads(int nthreads)
+/*
+ * Resolve the requested number of fitting threads (<= 0 means all available)
+ */
 {
+#ifdef _OPENMP
+    return nthreads > 0 ? nthreads : omp_get_max_threads();
+#else
+    Q_UNUSED(nthreads);
+    return 1;
+#endif
 }
 
 
-//*************************************************************************************************************
-//todo split in initFit where the settings are handed over and the actual fit
-ECDSet DipoleFit::calculateFit() const
+static void report_fit_progress(fitProgress progress, int nfit)
+
+{
+    float elapsed;
+
+    if (!progress)
+        return;
+    progress->ndone += nfit;
+    if (!progress->func)
+        return;
+    elapsed = progress->timer.nsecsElapsed()/1e9;
+    progress->func(progress->ndone,progress->ntotal,elapsed > 0 ? progress->ndone/elapsed : 0.0,progress->user);
+}
+
+
+static void fit_time_points(DipoleFitData* fit,     /* Precomputed fitting data */
+                            GuessData*    guess,    /* The initial guesses */
+                            float         *times,   /* The time points */
+                            float         **B,      /* The data to fit, one row per time point (modified) */
+                            int           ntime,
+                            int           nthreads, /* How many fitting threads */
+                            bool          warm_start, /* Start each fit from the previous one? */
+                            int           verbose,
+                            fitProgress   progress,
+                            ECD           *dips,    /* The fitted dipoles */
+                            int           *ok)      /* Which fits succeeded */
+/*
+ * Fit a single dipole to each of the given time points. The initial guesses are searched for the whole block,
+ * then the time points are distributed over the threads in chunks of consecutive points, every thread works
+ * on its own duplicate of the fitting data. With the warm start only the first point of each chunk is searched
+ * here, the others start from their predecessor and fit_one searches the guesses only if that is rejected.
+ */
+{
+    int nchunk = (ntime + FIT_CHUNK - 1)/FIT_CHUNK;
+    QVector<int>   best(ntime,-1);
+    QVector<float> good(ntime,0.0f);
+    QVector<float*> Bsearch;
+    QVector<int>    bsearch;
+    QVector<float>  gsearch;
+
+    if (ntime <= 0)
+        return;
+    if (nthreads > nchunk)
+        nthreads = nchunk;
+    /*
+     * The initial guesses for all time points in one go
+     */
+    for (int k = 0; k < ntime; k += warm_start ? FIT_CHUNK : 1)
+        Bsearch.append(B[k]);
+    bsearch.resize(Bsearch.size());
+    gsearch.resize(Bsearch.size());
+    if (DipoleFitData::find_best_guesses(fit,guess,Bsearch.data(),Bsearch.size(),bsearch.data(),gsearch.data()) != OK) {
+        for (int k = 0; k < ntime; k++)
+            ok[k] = FALSE;
+        report_fit_progress(progress,ntime);
+        return;
+    }
+    for (int j = 0; j < Bsearch.size(); j++) {
+        int k = warm_start ? j*FIT_CHUNK : j;
+        best[k] = bsearch[j];
+        good[k] = gsearch[j];
+    }
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads)
+#endif
+    {
+        DipoleFitData* one = nthreads > 1 ? DipoleFitData::create_multi_thread_duplicate(fit) : fit;
+
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+#endif
+        for (int c = 0; c < nchunk; c++) {
+            int first = c*FIT_CHUNK;
+            int last  = qMin(first + FIT_CHUNK,ntime);
+
+            for (int k = first; k < last; k++) {
+                const ECD* start = warm_start && k > first && ok[k-1] ? &dips[k-1] : NULL;
+                bool       searched = !warm_start || k == first;
+
+                ok[k] = (!searched || best[k] >= 0) && DipoleFitData::fit_one(one,guess,times[k],B[k],verbose && nthreads == 1,dips[k],start,best[k],good[k]);
+#ifdef _OPENMP
+                #pragma omp critical
+#endif
+                report_fit_progress(progress,1);
+            }
+        }
+        if (one != fit)
+            DipoleFitData::free_multi_thread_duplicate(one,fit);
+    }
+}
+
+
+static void add_fits(float *times, ECD *dips, int *ok, int ntime, int verbose, ECDSet& set)
+/*
+ * Add the successful fits to the set in time order
+ */
+{
+    int report_interval = 10;
+
+    for (int k = 0; k < ntime; k++) {
+        if (!ok[k])
+            printf("t = %7.1f ms : %s\n",1000*times[k],"error (tbd: catch)");
+        else {
+            set.addEcd(dips[k]);
+            if (verbose)
+                dips[k].print(stdout);
+            else {
+                if (set.size() % report_interval == 0)
+                    fprintf(stderr,"%d..",set.size());
+            }
+        }
+    }
+}
+
+
+/*
+ * One data file to fit
+ */
+typedef struct {
+    MneMeasData*   data;    /* Evoked data */
+    MneRawData*    raw;     /* or raw data */
+    mneChSelection sel;     /* Channel selection for the raw data */
+    float          tmin;    /* Time range to fit */
+    float          tmax;
+    float          tstep;
+} *fitInput,fitInputRec;
+
+
+static DipoleFitData* setup_fit_data(DipoleFitSettings* settings)
+/*
+ * Set up the forward model and the noise covariance
+ */
 {
-    GuessData*          guess    = NULL;
-    ECDSet              set;
     FwdEegSphereModel*  eeg_model = NULL;
-    DipoleFitData*      fit_data = NULL;
-    MneMeasData*        data     = NULL;
-    MneRawData*         raw      = NULL;
-    mneChSelection      sel      = NULL;
+    DipoleFitData*      fit_data  = NULL;
 
     printf("---- Setting up...\n\n");
     if (settings->include_eeg) {
         if ((eeg_model = FwdEegSphereModel::setup_eeg_sphere_model(settings->eeg_model_file,settings->eeg_model_name,settings->eeg_sphere_rad)) == NULL)
-            goto out;
+            return NULL;
+        if (settings->use_eeg_table && !eeg_model->fwd_eeg_make_pot_table()) {
+            delete eeg_model;
+            return NULL;
+        }
     }
 
     if ((fit_data = DipoleFitData::setup_dipole_fit_data(   settings->mriname,
@@ -634,93 +791,199 @@ ECDSet DipoleFit::calculateFit() const
                                                             settings->noisename,
                                                             settings->grad_std,settings->mag_std,settings->eeg_std,
                                                             settings->mag_reg,settings->grad_reg,settings->eeg_reg,
-                                                            settings->diagnoise,settings->projnames,settings->include_meg,settings->include_eeg)) == NULL   )
-        goto out;
+                                                            settings->diagnoise,settings->projnames,settings->include_meg,settings->include_eeg,
+                                                            settings->packed_coils)) == NULL   )
+        return NULL;
 
     fit_data->fit_mag_dipoles = settings->fit_mag_dipoles;
+    fit_data->gradient_fit    = settings->gradient_fit;
+    return fit_data;
+}
+
+
+static GuessData* setup_guesses(DipoleFitSettings* settings, DipoleFitData* fit_data)
+{
+    printf("\n---- Computing the forward solution for the guesses...\n\n");
+    return new GuessData(   settings->guessname,
+                            settings->guess_surfname,
+                            settings->guess_mindist, settings->guess_exclude, settings->guess_grid, fit_data,
+                            settings->guess_cachename);
+}
+
+
+static bool open_fit_input(DipoleFitSettings* settings, const QString& name, DipoleFitData* fit_data, fitInputRec& input)
+/*
+ * Open a raw data file or read an evoked data set and limit the time range to the data
+ */
+{
+    input.data  = NULL;
+    input.raw   = NULL;
+    input.sel   = NULL;
+    input.tmin  = settings->tmin;
+    input.tmax  = settings->tmax;
+    input.tstep = settings->tstep;
+
     if (settings->is_raw) {
         int c;
         float t1,t2;
 
         printf("\n---- Opening a raw data file...\n\n");
-        if ((raw = MneRawData::mne_raw_open_file(settings->measname.isEmpty() ? NULL : settings->measname.toUtf8().data(),TRUE,FALSE,&(settings->filter))) == NULL)
-            goto out;
+        if ((input.raw = MneRawData::mne_raw_open_file(name.isEmpty() ? NULL : name.toUtf8().data(),TRUE,FALSE,&(settings->filter))) == NULL)
+            return false;
         /*
         * A channel selection is needed to access the data
         */
-        sel = mne_ch_selection_these("fit",fit_data->ch_names,fit_data->nmeg+fit_data->neeg);
-        mne_ch_selection_assign_chs(sel,raw);
-        for (c = 0; c < sel->nchan; c++)
-            if (sel->pick[c] < 0) {
+        input.sel = mne_ch_selection_these("fit",fit_data->ch_names,fit_data->nmeg+fit_data->neeg);
+        mne_ch_selection_assign_chs(input.sel,input.raw);
+        for (c = 0; c < input.sel->nchan; c++)
+            if (input.sel->pick[c] < 0) {
                 qCritical ("All desired channels were not available");
-                goto out;
+                return false;
             }
         printf("\tChannel selection created.\n");
         /*
         * Let's be a little generous here
         */
-        t1 = raw->first_samp/raw->info->sfreq;
-        t2 = (raw->first_samp+raw->nsamp-1)/raw->info->sfreq;
-        if (settings->tmin < t1 + settings->integ)
-            settings->tmin = t1 + settings->integ;
-        if (settings->tmax > t2 - settings->integ)
-            settings->tmax =  t2 - settings->integ;
-        if (settings->tstep < 0)
-            settings->tstep = 1.0/raw->info->sfreq;
+        t1 = input.raw->first_samp/input.raw->info->sfreq;
+        t2 = (input.raw->first_samp+input.raw->nsamp-1)/input.raw->info->sfreq;
+        if (input.tmin < t1 + settings->integ)
+            input.tmin = t1 + settings->integ;
+        if (input.tmax > t2 - settings->integ)
+            input.tmax =  t2 - settings->integ;
+        if (input.tstep < 0)
+            input.tstep = 1.0/input.raw->info->sfreq;
 
         printf("\tOpened raw data file %s : %d MEG and %d EEG \n",
-               settings->measname.toUtf8().data(),fit_data->nmeg,fit_data->neeg);
+               name.toUtf8().data(),fit_data->nmeg,fit_data->neeg);
     }
     else {
         printf("\n---- Reading data...\n\n");
-        if ((data = MneMeasData::mne_read_meas_data(settings->measname,settings->setno,NULL,NULL,
+        if ((input.data = MneMeasData::mne_read_meas_data(name,settings->setno,NULL,NULL,
                                        fit_data->ch_names,fit_data->nmeg+fit_data->neeg)) == NULL)
-            goto out;
+            return false;
         if (settings->do_baseline)
-            data->adjust_baselines(settings->bmin,settings->bmax);
+            input.data->adjust_baselines(settings->bmin,settings->bmax);
         else
             printf("\tNo baseline setting in effect.\n");
-        if (settings->tmin < data->current->tmin + settings->integ/2.0)
-            settings->tmin = data->current->tmin + settings->integ/2.0;
-        if (settings->tmax > data->current->tmin + (data->current->np-1)*data->current->tstep - settings->integ/2.0)
-            settings->tmax =  data->current->tmin + (data->current->np-1)*data->current->tstep - settings->integ/2.0;
-        if (settings->tstep < 0)
-            settings->tstep = data->current->tstep;
+        if (input.tmin < input.data->current->tmin + settings->integ/2.0)
+            input.tmin = input.data->current->tmin + settings->integ/2.0;
+        if (input.tmax > input.data->current->tmin + (input.data->current->np-1)*input.data->current->tstep - settings->integ/2.0)
+            input.tmax =  input.data->current->tmin + (input.data->current->np-1)*input.data->current->tstep - settings->integ/2.0;
+        if (input.tstep < 0)
+            input.tstep = input.data->current->tstep;
 
         printf("\tRead data set %d from %s : %d MEG and %d EEG \n",
-               settings->setno,settings->measname.toUtf8().data(),fit_data->nmeg,fit_data->neeg);
-        if (!settings->noisename.isEmpty()) {
-            printf("\nScaling the noise covariance...\n");
-            if (DipoleFitData::scale_noise_cov(fit_data,data->current->nave) == FAIL)
-                goto out;
-        }
+               settings->setno,name.toUtf8().data(),fit_data->nmeg,fit_data->neeg);
     }
+    return true;
+}
 
-    /*
-    * Proceed to computing the fits
-    */
-    printf("\n---- Computing the forward solution for the guesses...\n\n");
-    if ((guess = new GuessData( settings->guessname,
-                                settings->guess_surfname,
-                                settings->guess_mindist, settings->guess_exclude, settings->guess_grid, fit_data)) == NULL)
-        goto out;
 
+static void close_fit_input(fitInputRec& input)
+{
+    if (input.data)
+        delete input.data;
+    if (input.raw)
+        delete input.raw;
+    if (input.sel) {
+        FREE(input.sel->pick);
+        FREE(input.sel->pick_deriv);
+        FREE(input.sel->ch_kind);
+        input.sel->name.clear();
+        input.sel->chdef.clear();
+        input.sel->chspick.clear();
+        input.sel->chspick_nospace.clear();
+        FREE(input.sel);
+    }
+    input.data = NULL;
+    input.raw  = NULL;
+    input.sel  = NULL;
+}
+
+
+static int fit_input(DipoleFitSettings*     settings,
+                     const QString&         name,
+                     fitInputRec&           input,
+                     DipoleFitData*         fit,
+                     GuessData*             guess,
+                     int                    nthreads,
+                     DipoleFit::ProgressFunc progress,
+                     void                   *progress_user,
+                     ECDSet&                set)
+{
     fprintf (stderr,"\n---- Fitting : %7.1f ... %7.1f ms (step: %6.1f ms integ: %6.1f ms)\n\n",
-             1000*settings->tmin,1000*settings->tmax,1000*settings->tstep,1000*settings->integ);
+             1000*input.tmin,1000*input.tmax,1000*input.tstep,1000*settings->integ);
 
+    if (input.raw)
+        return DipoleFit::fit_dipoles_raw(name,input.raw,input.sel,fit,guess,input.tmin,input.tmax,input.tstep,settings->integ,settings->verbose,set,
+                                          nthreads,settings->warm_start,progress,progress_user);
+    else
+        return DipoleFit::fit_dipoles(name,input.data,fit,guess,input.tmin,input.tmax,input.tstep,settings->integ,settings->verbose,set,
+                                      nthreads,settings->warm_start,progress,progress_user);
+}
 
-    if (raw) {
-        if (fit_dipoles_raw(settings->measname,raw,sel,fit_data,guess,settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose) == FAIL)
-            goto out;
-    }
-    else {
-        if (fit_dipoles(settings->measname,data,fit_data,guess,settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set) == FAIL)
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+DipoleFit::DipoleFit(DipoleFitSettings* p_settings)
+: settings(p_settings)
+, progress_func(NULL)
+, progress_user(NULL)
+{
+}
+
+
+//*************************************************************************************************************
+
+void DipoleFit::setProgressCallback(ProgressFunc func, void *user)
+{
+    progress_func = func;
+    progress_user = user;
+}
+
+
+//*************************************************************************************************************
+//todo split in initFit where the settings are handed over and the actual fit
+ECDSet DipoleFit::calculateFit() const
+{
+    GuessData*          guess    = NULL;
+    ECDSet              set;
+    DipoleFitData*      fit_data = NULL;
+    fitInputRec         input;
+
+    input.data = NULL;
+    input.raw  = NULL;
+    input.sel  = NULL;
+
+    if ((fit_data = setup_fit_data(settings)) == NULL)
+        goto out;
+    if (!open_fit_input(settings,settings->measname,fit_data,input))
+        goto out;
+    settings->tmin  = input.tmin;
+    settings->tmax  = input.tmax;
+    settings->tstep = input.tstep;
+    if (input.data && !settings->noisename.isEmpty()) {
+        printf("\nScaling the noise covariance...\n");
+        if (DipoleFitData::scale_noise_cov(fit_data,input.data->current->nave) == FAIL)
             goto out;
     }
+
+    /*
+    * Proceed to computing the fits
+    */
+    if ((guess = setup_guesses(settings,fit_data)) == NULL)
+        goto out;
+
+    if (fit_input(settings,settings->measname,input,fit_data,guess,settings->nthreads,progress_func,progress_user,set) == FAIL)
+        goto out;
     printf("%d dipoles fitted\n",set.size());
 
 
 out : {
+        close_fit_input(input);
         return set;
     }
 }
@@ -728,43 +991,123 @@ out : {
 
 //*************************************************************************************************************
 
-int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+QList<ECDSet> DipoleFit::calculateBatchFit() const
 {
-    float *one = MALLOC(data->nchan,float);
+    GuessData*          guess    = NULL;
+    DipoleFitData*      fit_data = NULL;
+    int                 ninput   = settings->batchnames.size();
+    QVector<ECDSet>     sets(ninput);
+    int                 nthreads = get_fit_threads(settings->nthreads);
+    int                 nouter   = qMax(1,qMin(ninput,nthreads));   /* Data files fitted at the same time */
+    int                 ninner   = qMax(1,nthreads/nouter);         /* Threads for each of them */
+    int                 nfitted  = 0;
+
+    /*
+    * The model, the noise covariance and the guesses are set up once for all data files
+    */
+    if ((fit_data = setup_fit_data(settings)) == NULL)
+        goto out;
+    if ((guess = setup_guesses(settings,fit_data)) == NULL)
+        goto out;
+
+    printf("\n---- Fitting %d data files, %d at a time with %d threads each...\n\n",ninput,nouter,ninner);
+#ifdef _OPENMP
+    if (ninner > 1)
+        omp_set_max_active_levels(2);
+    #pragma omp parallel for schedule(dynamic) num_threads(nouter) reduction(+:nfitted)
+#endif
+    for (int k = 0; k < ninput; k++) {
+        DipoleFitData* one = DipoleFitData::create_multi_thread_duplicate(fit_data);
+        fitInputRec    input;
+        bool           ok;
+
+        /*
+        * Read one at a time. Every data file gets its own copy of the noise covariance scaled to its nave.
+        */
+#ifdef _OPENMP
+        #pragma omp critical(dipole_fit_batch_input)
+#endif
+        {
+            ok = open_fit_input(settings,settings->batchnames[k],fit_data,input);
+            if (ok && input.data && !settings->noisename.isEmpty() && fit_data->noise) {
+                one->noise = MneCovMatrix::mne_dup_cov(fit_data->noise);
+                ok = DipoleFitData::scale_noise_cov(one,input.data->current->nave) == OK;
+            }
+        }
+        if (ok)
+            ok = fit_input(settings,settings->batchnames[k],input,one,guess,ninner,NULL,NULL,sets[k]) == OK;
+        if (ok) {
+            printf("%s : %d dipoles fitted\n",settings->batchnames[k].toUtf8().constData(),sets[k].size());
+            nfitted++;
+        }
+        else
+            printf("%s : fitting failed\n",settings->batchnames[k].toUtf8().constData());
+
+        close_fit_input(input);
+        if (one->noise != fit_data->noise)
+            delete one->noise;
+        DipoleFitData::free_multi_thread_duplicate(one,fit_data);
+    }
+    printf("%d of %d data files fitted\n",nfitted,ninput);
+
+out : {
+        if (guess)
+            delete guess;
+        return sets.toList();
+    }
+}
+
+
+//*************************************************************************************************************
+
+int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set,
+                            int nthreads, bool warm_start, ProgressFunc progress, void *progress_user)
+{
+    float **one;
     float time;
     ECDSet set;
-    ECD   dip;
-    int   s;
-    int   report_interval = 10;
+    int   s,ntime,npick;
+    fitProgressRec fit_progress;
 
     set.dataname = dataname;
 
-    fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
-    for (s = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
+    for (ntime = 0, time = tmin; time < tmax; ntime++, time = tmin  + ntime*tstep)
+        ;
+    if (ntime <= 0) {
+        p_set = set;
+        return OK;
+    }
+    one = ALLOC_CMATRIX(ntime,data->nchan);
+    QVector<float> times(ntime);
+    QVector<ECD>   dips(ntime);
+    QVector<int>   ok(ntime);
+
+    for (s = 0, npick = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
         /*
      * Pick the data point
      */
         if (mne_get_values_from_data(time,integ,data->current->data,data->current->np,data->nchan,data->current->tmin,
-                                     1.0/data->current->tstep,FALSE,one) == FAIL) {
+                                     1.0/data->current->tstep,FALSE,one[npick]) == FAIL) {
             fprintf(stderr,"Cannot pick time: %7.1f ms\n",1000*time);
             continue;
         }
-
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
-            printf("t = %7.1f ms : %s\n",1000*time,"error (tbd: catch)");
-        else {
-            set.addEcd(dip);
-            if (verbose)
-                dip.print(stdout);
-            else {
-                if (set.size() % report_interval == 0)
-                    fprintf(stderr,"%d..",set.size());
-            }
-        }
+        times[npick++] = time;
     }
+
+    fit_progress.func   = progress;
+    fit_progress.user   = progress_user;
+    fit_progress.ntotal = npick;
+    fit_progress.ndone  = 0;
+    fit_progress.timer.start();
+
+    fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
+    fit_time_points(fit,guess,times.data(),one,npick,get_fit_threads(nthreads),warm_start,verbose,&fit_progress,dips.data(),ok.data());
+    add_fits(times.data(),dips.data(),ok.data(),npick,verbose,set);
     if (!verbose)
         fprintf(stderr,"[done]\n");
-    FREE(one);
+    printf("%d time points fitted in %.2f s (%.1f fits/s)\n",fit_progress.ndone,fit_progress.timer.elapsed()/1000.0,
+           fit_progress.timer.elapsed() > 0 ? 1000.0*fit_progress.ndone/fit_progress.timer.elapsed() : 0.0);
+    FREE_CMATRIX(one);
     p_set = set;
     return OK;
 }
@@ -772,9 +1115,9 @@ int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFi
 
 //*************************************************************************************************************
 
-int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set,
+                               int nthreads, bool warm_start, ProgressFunc progress, void *progress_user)
 {
-    float *one    = MALLOC(sel->nchan,float);
     float sfreq   = raw->info->sfreq;
     float myinteg = integ > 0.0 ? 2*integ : 0.1;
     int   overlap = ceil(myinteg*sfreq);
@@ -782,15 +1125,29 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
     int   step    = length - overlap;
     int   stepo   = step + overlap/2;
     int   start   = raw->first_samp;
-    int   s,picks;
+    int   maxpick = stepo/(tstep*sfreq) + 2;    /* The most time points one data segment can hold */
+    int   s,picks,npick,ntime;
     float time,stime;
     float **data  = ALLOC_CMATRIX(sel->nchan,length);
-    ECD    dip;
+    float **one   = ALLOC_CMATRIX(maxpick,sel->nchan);
     ECDSet set;
-    int    report_interval = 10;
+    fitProgressRec fit_progress;
+
+    QVector<float> times(maxpick);
+    QVector<ECD>   dips(maxpick);
+    QVector<int>   ok(maxpick);
 
+    nthreads = get_fit_threads(nthreads);
     set.dataname = dataname;
 
+    for (ntime = 0, time = tmin; time < tmax; ntime++, time = tmin  + ntime*tstep)
+        ;
+    fit_progress.func   = progress;
+    fit_progress.user   = progress_user;
+    fit_progress.ntotal = ntime;
+    fit_progress.ndone  = 0;
+    fit_progress.timer.start();
+
     /*
    * Load the initial data segment
    */
@@ -798,8 +1155,16 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
     if (MneRawData::mne_raw_pick_data_filt(raw,sel,start,length,data) == FAIL)
         goto bad;
     fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
-    for (s = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
+    for (s = 0, npick = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
         picks = time*sfreq - start;
+        if (picks > stepo || npick == maxpick) {
+            /*
+       * Fit the time points collected from the current segment
+       */
+            fit_time_points(fit,guess,times.data(),one,npick,nthreads,warm_start,verbose,&fit_progress,dips.data(),ok.data());
+            add_fits(times.data(),dips.data(),ok.data(),npick,verbose,set);
+            npick = 0;
+        }
         if (picks > stepo) {		/* Need a new data segment? */
             start = start + step;
             if (MneRawData::mne_raw_pick_data_filt(raw,sel,start,length,data) == FAIL)
@@ -810,35 +1175,26 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
         /*
      * Get the values
      */
-        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,one) == FAIL) {
+        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,one[npick]) == FAIL) {
             fprintf(stderr,"Cannot pick time: %8.3f s\n",time);
             continue;
         }
-        /*
-     * Fit
-     */
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
-            qWarning() << "Error";
-        else {
-            set.addEcd(dip);
-            if (verbose)
-                dip.print(stdout);
-            else {
-                if (set.size() % report_interval == 0)
-                    fprintf(stderr,"%d..",set.size());
-            }
-        }
+        times[npick++] = time;
     }
+    fit_time_points(fit,guess,times.data(),one,npick,nthreads,warm_start,verbose,&fit_progress,dips.data(),ok.data());
+    add_fits(times.data(),dips.data(),ok.data(),npick,verbose,set);
     if (!verbose)
         fprintf(stderr,"[done]\n");
+    printf("%d time points fitted in %.2f s (%.1f fits/s)\n",fit_progress.ndone,fit_progress.timer.elapsed()/1000.0,
+           fit_progress.timer.elapsed() > 0 ? 1000.0*fit_progress.ndone/fit_progress.timer.elapsed() : 0.0);
     FREE_CMATRIX(data);
-    FREE(one);
+    FREE_CMATRIX(one);
     p_set = set;
     return OK;
 
 bad : {
         FREE_CMATRIX(data);
-        FREE(one);
+        FREE_CMATRIX(one);
         return FAIL;
     }
 }
@@ -55,6 +55,7 @@
 // Qt INCLUDES
 //=============================================================================================================
 
+#include <QList>
 #include <QSharedPointer>
 
 
@@ -88,6 +89,7 @@ class INVERSESHARED_EXPORT DipoleFit
 public:
     typedef QSharedPointer<DipoleFit> SPtr;             /**< Shared pointer type for DipoleFit. */
     typedef QSharedPointer<const DipoleFit> ConstSPtr;  /**< Const shared pointer type for DipoleFit. */
+    typedef void (*ProgressFunc)(int nfit, int ntotal, float fits_per_sec, void *user); /**< Progress callback: fitted and total time points and the throughput so far. */
 
     //=========================================================================================================
     /**
@@ -99,8 +101,28 @@ public:
 
     //ToDo split this function into init (with settings as parameter) and the actual fit function
     ECDSet calculateFit() const;
+
+    //=========================================================================================================
+    /**
+    * Fits all data files of the batch list (DipoleFitSettings::batchnames). The forward model, the noise
+    * covariance and the guesses are set up once from the settings, the data files are fitted in parallel.
+    * The data files must share the sensors and the projections of the setup measurement.
+    *
+    * @return one ECD set for each data file, empty if the file could not be fitted
+    */
+    QList<ECDSet> calculateBatchFit() const;
 //    virtual const char* getName() const;
 
+    //=========================================================================================================
+    /**
+    * Sets a callback which is invoked after each fitted time point. With several fitting threads it is called
+    * from the worker threads, one call at a time.
+    *
+    * @param[in] func   The callback, NULL to switch reporting off
+    * @param[in] user   Client data handed to the callback
+    */
+    void setProgressCallback(ProgressFunc func, void *user = NULL);
+
 public:
 
     //=========================================================================================================
@@ -119,10 +141,15 @@ public:
     * @param[in] integ      Integration time
     * @param[in] verbose    Verbose output?
     * @param[out] p_set     the fitted ECD Set
+    * @param[in] nthreads   Number of fitting threads (<= 0: all available)
+    * @param[in] warm_start Start each fit from the result of the preceding time point
+    * @param[in] progress   Progress callback (optional)
+    * @param[in] progress_user  Client data for the progress callback
     *
     * @return true when successful
     */
-    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+    static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set,
+                            int nthreads = 1, bool warm_start = false, ProgressFunc progress = NULL, void *progress_user = NULL);
 
     //=========================================================================================================
     /**
@@ -141,10 +168,15 @@ public:
     * @param[in] integ      Integration time
     * @param[in] verbose    Verbose output?
     * @param[out] p_set     Return all results here. Warning: for large data files this may take a lot of memory
+    * @param[in] nthreads   Number of fitting threads (<= 0: all available)
+    * @param[in] warm_start Start each fit from the result of the preceding time point
+    * @param[in] progress   Progress callback (optional)
+    * @param[in] progress_user  Client data for the progress callback
     *
     * @return true when successful
     */
-    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+    static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set,
+                               int nthreads = 1, bool warm_start = false, ProgressFunc progress = NULL, void *progress_user = NULL);
 
     //=========================================================================================================
     /**
@@ -169,6 +201,8 @@ public:
 
 private:
     DipoleFitSettings* settings;
+    ProgressFunc       progress_func;   /**< Progress callback (optional) */
+    void               *progress_user;  /**< Client data for the progress callback */
 
 };
 
@@ -14,6 +14,7 @@
 #include <mne/c/mne_surface_old.h>
 
 #include <fwd/fwd_comp_data.h>
+#include <utils/linalg.h>
 
 #include <Eigen/Dense>
 
@@ -318,29 +319,12 @@ float **mne_mat_mat_mult_3 (float **m1,float **m2,int d1,int d2,int d3)
       * result(d1 x d3) = m1(d1 x d2) * m2(d2 x d3) */
 
 {
-#ifdef BLAS
+    /*
+     * The rows of ALLOC_CMATRIX are contiguous
+     */
     float **result = ALLOC_CMATRIX_3(d1,d3);
-    char  *transa = "N";
-    char  *transb = "N";
-    float zero = 0.0;
-    float one  = 1.0;
-    sgemm (transa,transb,&d3,&d1,&d2,
-           &one,m2[0],&d3,m1[0],&d2,&zero,result[0],&d3);
+    UTILSLIB::LinAlg::multiply(m1[0],m2[0],result[0],d1,d2,d3);
     return (result);
-#else
-    float **result = ALLOC_CMATRIX_3(d1,d3);
-    int j,k,p;
-    float sum;
-
-    for (j = 0; j < d1; j++)
-        for (k = 0; k < d3; k++) {
-            sum = 0.0;
-            for (p = 0; p < d2; p++)
-                sum = sum + m1[j][p]*m2[p][k];
-            result[j][k] = sum;
-        }
-    return (result);
-#endif
 }
 
 
@@ -1471,6 +1455,84 @@ static void free_dipole_fit_funcs(dipoleFitFuncs f)
 }
 
 
+static FwdBemModel* dup_bem_workspace(FwdBemModel* orig)
+/*
+ * Duplicate the BEM model header, the surfaces and the solution stay shared
+ */
+{
+    FwdBemModel* bem = new FwdBemModel();
+
+    *bem    = *orig;
+    bem->v0 = NULL;
+    return bem;
+}
+
+
+static void free_bem_workspace(FwdBemModel* bem)
+
+{
+    FREE_3(bem->v0);
+    *bem = FwdBemModel();       /* Forget the shared parts before deleting */
+    delete bem;
+}
+
+
+static dipoleFitFuncs dup_dipole_fit_funcs(dipoleFitFuncs orig, FwdBemModel* bem_model)
+/*
+ * Create a duplicate of the forward functions to make them thread safe.
+ * Do not duplicate read-only parts of the relevant structures
+ */
+{
+    dipoleFitFuncs f;
+
+    if (!orig)
+        return NULL;
+
+    f  = MALLOC_3(1,dipoleFitFuncsRec);
+    *f = *orig;
+    f->meg_client_free = NULL;
+    f->eeg_client_free = NULL;
+
+    if (orig->meg_client) {
+        FwdCompData* comp = new FwdCompData;
+
+        *comp = *(FwdCompData*)orig->meg_client;
+        comp->work        = NULL;
+        comp->vec_work    = NULL;
+        comp->client_free = NULL;
+        comp->set         = comp->set ? new MneCTFCompDataSet(*(comp->set)) : NULL;
+        if (bem_model && comp->client == bem_model)
+            comp->client = dup_bem_workspace(bem_model);
+        f->meg_client = comp;
+    }
+    if (bem_model && orig->eeg_client == bem_model)
+        f->eeg_client = dup_bem_workspace(bem_model);
+    return f;
+}
+
+
+static void free_dipole_fit_funcs_duplicate(dipoleFitFuncs f, dipoleFitFuncs orig)
+
+{
+    if (!f)
+        return;
+
+    if (f->meg_client) {
+        FwdCompData* comp = (FwdCompData*)f->meg_client;
+
+        if (comp->client != ((FwdCompData*)orig->meg_client)->client)
+            free_bem_workspace((FwdBemModel*)comp->client);
+        comp->comp_coils = NULL;    /* Shared with the original */
+        comp->client     = NULL;
+        delete comp;
+    }
+    if (f->eeg_client != orig->eeg_client)
+        free_bem_workspace((FwdBemModel*)f->eeg_client);
+
+    FREE_3(f);
+}
+
+
 
 
 
@@ -1597,6 +1659,8 @@ static dipoleFitFuncs new_dipole_fit_funcs()
     f->eeg_pot       = NULL;
     f->meg_vec_field = NULL;
     f->eeg_vec_pot   = NULL;
+    f->meg_field_grad = NULL;
+    f->eeg_pot_grad   = NULL;
     f->meg_client      = NULL;
     f->meg_client_free = NULL;
     f->eeg_client      = NULL;
@@ -3790,6 +3854,7 @@ DipoleFitData::DipoleFitData()
 , funcs (NULL)
 , column_norm (COLUMN_NORM_NONE)
 , fit_mag_dipoles (FALSE)
+, gradient_fit (FALSE)
 {
     r0[0] = 0.0f;
     r0[1] = 0.0f;
@@ -3838,6 +3903,47 @@ DipoleFitData::~DipoleFitData()
 }
 
 
+//*************************************************************************************************************
+
+DipoleFitData* DipoleFitData::create_multi_thread_duplicate(DipoleFitData* fit)
+{
+    DipoleFitData* res = new DipoleFitData;
+
+    *res = *fit;
+    res->user      = NULL;
+    res->user_free = NULL;
+
+    res->sphere_funcs     = dup_dipole_fit_funcs(fit->sphere_funcs,fit->bem_model);
+    res->bem_funcs        = dup_dipole_fit_funcs(fit->bem_funcs,fit->bem_model);
+    res->mag_dipole_funcs = dup_dipole_fit_funcs(fit->mag_dipole_funcs,fit->bem_model);
+    if (fit->funcs == fit->bem_funcs)
+        res->funcs = res->bem_funcs;
+    else if (fit->funcs == fit->mag_dipole_funcs)
+        res->funcs = res->mag_dipole_funcs;
+    else
+        res->funcs = res->sphere_funcs;
+    return res;
+}
+
+
+//*************************************************************************************************************
+
+void DipoleFitData::free_multi_thread_duplicate(DipoleFitData* one, DipoleFitData* fit)
+{
+    if (!one)
+        return;
+
+    free_dipole_fit_funcs_duplicate(one->sphere_funcs,fit->sphere_funcs);
+    free_dipole_fit_funcs_duplicate(one->bem_funcs,fit->bem_funcs);
+    free_dipole_fit_funcs_duplicate(one->mag_dipole_funcs,fit->mag_dipole_funcs);
+    /*
+     * Forget the shared parts before deleting
+     */
+    *one = DipoleFitData();
+    delete one;
+}
+
+
 //*************************************************************************************************************
 
 int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp_data, FwdCoilSet *comp_coils)
@@ -3904,7 +4010,7 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
            * It works the same way independent of whether or not the compensation is in effect
            */
             comp = FwdCompData::fwd_make_comp_data(comp_data,d->meg_coils,comp_coils,
-                                      FwdBemModel::fwd_bem_field,NULL,NULL,d->bem_model,NULL);
+                                      FwdBemModel::fwd_bem_field,NULL,FwdBemModel::fwd_bem_field_grad,d->bem_model,NULL);
             if (!comp)
                 goto out;
             printf("Compensation setup done.\n");
@@ -3918,6 +4024,7 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
 
             f->meg_field       = FwdCompData::fwd_comp_field;
             f->meg_vec_field   = NULL;
+            f->meg_field_grad  = FwdCompData::fwd_comp_field_grad;
             f->meg_client      = comp;
             f->meg_client_free = FwdCompData::fwd_free_comp_data;
         }
@@ -3928,6 +4035,7 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
             printf("[done]\n");
             f->eeg_pot     = FwdBemModel::fwd_bem_pot_els;
             f->eeg_vec_pot = NULL;
+            f->eeg_pot_grad = FwdBemModel::fwd_bem_pot_grad_els;
             f->eeg_client  = d->bem_model;
         }
     }
@@ -3938,8 +4046,19 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
     d->sphere_funcs = f = new_dipole_fit_funcs();
     if (d->neeg > 0) {
         VEC_COPY_3(d->eeg_model->r0,d->r0);
-        f->eeg_pot     = FwdEegSphereModel::fwd_eeg_spherepot_coil;
-        f->eeg_vec_pot = FwdEegSphereModel::fwd_eeg_spherepot_coil_vec;
+        if (d->eeg_model->pot_table_vr.size() > 0) {
+            /*
+             * The tabulated series replaces the equivalent sources
+             */
+            f->eeg_pot     = FwdEegSphereModel::fwd_eeg_multi_spherepot_coil1;
+            f->eeg_vec_pot = NULL;
+            f->eeg_pot_grad = FwdEegSphereModel::fwd_eeg_multi_spherepot_grad_coil;
+        }
+        else {
+            f->eeg_pot     = FwdEegSphereModel::fwd_eeg_spherepot_coil;
+            f->eeg_vec_pot = FwdEegSphereModel::fwd_eeg_spherepot_coil_vec;
+            f->eeg_pot_grad = FwdEegSphereModel::fwd_eeg_spherepot_grad_coil;
+        }
         f->eeg_client  = d->eeg_model;
     }
     if (d->nmeg > 0) {
@@ -3950,12 +4069,13 @@ int DipoleFitData::setup_forward_model(DipoleFitData *d, MneCTFCompDataSet* comp
         comp = FwdCompData::fwd_make_comp_data(comp_data,d->meg_coils,comp_coils,
                                   FwdBemModel::fwd_sphere_field,
                                   FwdBemModel::fwd_sphere_field_vec,
-                                  NULL,
+                                  FwdBemModel::fwd_sphere_field_grad,
                                   d->r0,NULL);
         if (!comp)
             goto out;
         f->meg_field       = FwdCompData::fwd_comp_field;
         f->meg_vec_field   = FwdCompData::fwd_comp_field_vec;
+        f->meg_field_grad  = FwdCompData::fwd_comp_field_grad;
         f->meg_client      = comp;
         f->meg_client_free = FwdCompData::fwd_free_comp_data;
     }
@@ -4298,7 +4418,7 @@ int DipoleFitData::select_dipole_fit_noise_cov(DipoleFitData *f, mshMegEegData d
 
 //*************************************************************************************************************
 
-DipoleFitData *DipoleFitData::setup_dipole_fit_data(const QString &mriname, const QString &measname, const QString& bemname, Vector3f *r0, FwdEegSphereModel *eeg_model, int accurate_coils, const QString &badname, const QString &noisename, float grad_std, float mag_std, float eeg_std, float mag_reg, float grad_reg, float eeg_reg, int diagnoise, const QList<QString> &projnames, int include_meg, int include_eeg)              /**< Include EEG in the fitting? */
+DipoleFitData *DipoleFitData::setup_dipole_fit_data(const QString &mriname, const QString &measname, const QString& bemname, Vector3f *r0, FwdEegSphereModel *eeg_model, int accurate_coils, const QString &badname, const QString &noisename, float grad_std, float mag_std, float eeg_std, float mag_reg, float grad_reg, float eeg_reg, int diagnoise, const QList<QString> &projnames, int include_meg, int include_eeg, bool packed_coils)
 /*
           * Background work for modelling
           */
@@ -4409,6 +4529,8 @@ DipoleFitData *DipoleFitData::setup_dipole_fit_data(const QString &mriname, cons
                                                           accurate_coils ? FWD_COIL_ACCURACY_ACCURATE : FWD_COIL_ACCURACY_NORMAL,
                                                           res->meg_head_t)) == NULL)
             goto bad;
+        if (packed_coils)
+            res->meg_coils->pack_coils();
         if ((res->eeg_els = FwdCoilSet::create_eeg_els(res->chs+res->nmeg,res->neeg,NULL)) == NULL)
             goto bad;
         printf("Head coordinate coil definitions created.\n");
@@ -4445,6 +4567,8 @@ DipoleFitData *DipoleFitData::setup_dipole_fit_data(const QString &mriname, cons
                 FREE_3(comp_chs);
                 goto bad;
             }
+            if (packed_coils)
+                comp_coils->pack_coils();
             printf("%d compensation channels in %s\n",comp_coils->ncoil,measname.toUtf8().data());
         }
         FREE_3(comp_chs);
@@ -4790,19 +4914,33 @@ static int find_best_guess(float     *B,         /* The whitened data */
     DipoleForward* fwd;
     int    ncomp;
 
-    B2 = mne_dot_vectors_3(B,B,nch);
-    for (k = 0; k < guess->nguess; k++) {
-        fwd = guess->guess_fwd[k];
-        if (fwd->nch == nch) {
-            ncomp = fwd->sing[2]/fwd->sing[0] > limit ? 3 : 2;
-            for (c = 0, Bm2 = 0.0; c < ncomp; c++) {
-                one = mne_dot_vectors_3(fwd->uu[c],B,nch);
-                Bm2 = Bm2 + one*one;
-            }
-            this_good = 1.0 - (B2 - Bm2)/B2;
-            if (this_good > good) {
-                best = k;
-                good = this_good;
+    if (guess->guess_uu.cols() > 0) {
+        /*
+     * Use the contiguous guess field matrix (this is the only option if the fields came from a cache)
+     */
+        Eigen::VectorXi bests;
+        Eigen::VectorXf goods;
+
+        if (!guess->find_best_guesses(Eigen::Map<Eigen::MatrixXf>(B,nch,1),limit,bests,goods))
+            return FAIL;
+        best = bests[0];
+        good = goods[0];
+    }
+    else {
+        B2 = mne_dot_vectors_3(B,B,nch);
+        for (k = 0; k < guess->nguess; k++) {
+            fwd = guess->guess_fwd[k];
+            if (fwd->nch == nch) {
+                ncomp = fwd->sing[2]/fwd->sing[0] > limit ? 3 : 2;
+                for (c = 0, Bm2 = 0.0; c < ncomp; c++) {
+                    one = mne_dot_vectors_3(fwd->uu[c],B,nch);
+                    Bm2 = Bm2 + one*one;
+                }
+                this_good = 1.0 - (B2 - Bm2)/B2;
+                if (this_good > good) {
+                    best = k;
+                    good = this_good;
+                }
             }
         }
     }
@@ -5112,45 +5250,239 @@ int simplex_minimize(float **p,		                              /* The initial si
 
 //*************************************************************************************************************
 // fit_dipoles.c
+#define FIT_RADIAL_LIMIT 0.2        /* (pseudo) radial component omission limit */
+#define WARM_START_ACCEPT 0.95      /* Fraction of the goodness of fit of the neighbour a warm start has to keep */
+
+int DipoleFitData::find_best_guesses(DipoleFitData* fit, GuessData* guess, float **B, int ntime, int *best, float *good)
+{
+    int nchan = fit->nmeg+fit->neeg;
+    int k;
+
+    if (ntime <= 0)
+        return OK;
+    for (k = 0; k < ntime; k++)
+        if (MneProjOp::mne_proj_op_proj_vector(fit->proj,B[k],nchan,TRUE) == FAIL)
+            return FAIL;
+    if (mne_whiten_data(B,B,ntime,nchan,fit->noise) == FAIL)
+        return FAIL;
+
+    Eigen::MatrixXf data(nchan,ntime);
+    Eigen::VectorXi bests;
+    Eigen::VectorXf goods;
+
+    for (k = 0; k < ntime; k++)
+        data.col(k) = Eigen::Map<Eigen::VectorXf>(B[k],nchan);
+    if (!guess->find_best_guesses(data,FIT_RADIAL_LIMIT,bests,goods))
+        return FAIL;
+    for (k = 0; k < ntime; k++) {
+        best[k] = bests[k];
+        good[k] = goods[k];
+    }
+    return OK;
+}
+
+
+//*************************************************************************************************************
+// Levenberg-Marquardt fitting
+
+#define LM_MAX_STEP   2e-2          /* Longest allowed step (m) */
+#define LM_MAX_LAMBDA 1e10          /* Give up improving beyond this damping */
+
+static int has_field_grad(DipoleFitData* fit, dipoleFitFuncs f)
+/*
+ * Can the gradient fit be used with these forward functions?
+ */
+{
+    if (!f)
+        return FALSE;
+    if (fit->nmeg > 0 && !f->meg_field_grad)
+        return FALSE;
+    if (fit->neeg > 0 && !f->eeg_pot_grad)
+        return FALSE;
+    return TRUE;
+}
+
+
+static int lm_jacobian(DipoleFitData* fit,   /* The fit data, fit->user holds the forward solution at rd */
+                       float *rd,            /* Dipole position */
+                       float **fwd,          /* Workspace for the fields (3 x nchan) */
+                       float **grad,         /* Workspace for the field derivatives (9 x nchan) */
+                       float **J,            /* The Jacobian of the residual (3 x nchan) */
+                       float *res)           /* The residual */
+/*
+ * The dipole moment is eliminated by the least-squares fit at each location (variable projection).
+ * The Jacobian of the residual B - GQ is then approximated by -(I - UU^T) dG/drd Q,
+ * where U spans the components of G used in the fit
+ */
+{
+    fitDipUser     user  = (fitDipUser)fit->user;
+    DipoleForward* f     = user->fwd;
+    int            nchan = f->nch;
+    int            ncomp = f->sing[2]/f->sing[0] > user->limit ? 3 : 2;
+    float          Q[3],one;
+    int            c,j,p;
+
+    if (DipoleFitData::compute_dipole_field_grad(fit,rd,TRUE,fwd,grad) == FAIL)
+        return FAIL;
+    /*
+   * The moment (in the column normalized basis) and the residual
+   */
+    Q[0] = Q[1] = Q[2] = 0.0;
+    for (j = 0; j < nchan; j++)
+        res[j] = user->B[j];
+    for (c = 0; c < ncomp; c++) {
+        one = mne_dot_vectors_3(f->uu[c],user->B,nchan);
+        mne_add_scaled_vector_to_3(f->vv[c],one/f->sing[c],Q,3);
+        mne_add_scaled_vector_to_3(f->uu[c],-one,res,nchan);
+    }
+    /*
+   * The derivative of the normalization does not contribute, it stays within the span of U
+   */
+    for (p = 0; p < 3; p++) {
+        for (j = 0; j < nchan; j++)
+            J[p][j] = 0.0;
+        for (c = 0; c < 3; c++)
+            mne_add_scaled_vector_to_3(grad[3*c+p],-f->scales[c]*Q[c],J[p],nchan);
+        for (c = 0; c < ncomp; c++)
+            mne_add_scaled_vector_to_3(f->uu[c],-mne_dot_vectors_3(f->uu[c],J[p],nchan),J[p],nchan);
+    }
+    return OK;
+}
+
+
+static int lm_minimize(DipoleFitData* fit,  /* The fit data */
+                       float *rd,           /* The starting point, replaced by the minimum */
+                       float atol,          /* Converged when the step is shorter than this */
+                       int   max_eval,      /* Maximum number of evaluations, the gradients included */
+                       int   *neval,        /* Number of function evaluations */
+                       int   *ngrad,        /* Number of field gradient evaluations */
+                       float *final_val)    /* Residual sum of squares at the minimum */
+/*
+ * Minimize the residual sum of squares over the dipole location with the Levenberg-Marquardt method.
+ * Each iteration costs one field and gradient evaluation and usually a single trial step.
+ * A gradient evaluation computes the field and its derivatives along all three coordinates.
+ */
+{
+    int    nchan  = fit->nmeg+fit->neeg;
+    float  **fwd  = ALLOC_CMATRIX_3(3,nchan);
+    float  **grad = ALLOC_CMATRIX_3(9,nchan);
+    float  **J    = ALLOC_CMATRIX_3(3,nchan);
+    float  *res   = MALLOC_3(nchan,float);
+    double lambda = 1e-3;
+    float  val,trial_val,step;
+    float  rd_trial[3];
+    int    eval      = 0;
+    int    geval     = 0;
+    int    converged = FALSE;
+    int    result    = FAIL;
+    int    p,q;
+    Eigen::Matrix3d JtJ,A;
+    Eigen::Vector3d Jtr,delta;
+
+    val = fit_eval(rd,3,fit);
+    eval++;
+    while (!converged) {
+        if (eval + geval >= max_eval)
+            goto out;
+        if (lm_jacobian(fit,rd,fwd,grad,J,res) == FAIL)
+            goto out;
+        geval++;
+        for (p = 0; p < 3; p++) {
+            Jtr[p] = mne_dot_vectors_3(J[p],res,nchan);
+            for (q = 0; q <= p; q++)
+                JtJ(p,q) = JtJ(q,p) = mne_dot_vectors_3(J[p],J[q],nchan);
+        }
+        /*
+     * Increase the damping until the step improves the fit.
+     * After a rejected step fit->user holds the trial location but it is not needed before the next acceptance.
+     */
+        for (;;) {
+            A = JtJ;
+            for (p = 0; p < 3; p++)
+                A(p,p) = (1.0 + lambda)*JtJ(p,p);
+            delta = A.ldlt().solve(-Jtr);
+            if (!delta.allFinite())
+                goto out;
+            step = delta.norm();
+            if (step > LM_MAX_STEP) {
+                delta = (LM_MAX_STEP/step)*delta;
+                step  = LM_MAX_STEP;
+            }
+            for (p = 0; p < 3; p++)
+                rd_trial[p] = rd[p] + delta[p];
+            trial_val = fit_eval(rd_trial,3,fit);
+            eval++;
+            if (trial_val < val) {
+                VEC_COPY_3(rd,rd_trial);
+                val       = trial_val;
+                lambda    = qMax(0.1*lambda,1e-7);
+                converged = step < atol;
+                break;
+            }
+            lambda = 10.0*lambda;
+            if (step < atol || lambda > LM_MAX_LAMBDA) {
+                converged = TRUE;
+                break;
+            }
+            if (eval + geval >= max_eval)
+                goto out;
+        }
+    }
+    result = OK;
+
+out : {
+        *neval     = eval;
+        *ngrad     = geval;
+        *final_val = val;
+        FREE_CMATRIX_3(fwd);
+        FREE_CMATRIX_3(grad);
+        FREE_CMATRIX_3(J);
+        FREE_3(res);
+        return result;
+    }
+}
+
+
+//*************************************************************************************************************
+
 bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitting data */
                     GuessData*     guess,	            /* The initial guesses */
                     float         time,              /* Which time is it? */
                     float         *B,	            /* The field to fit */
                     int           verbose,
-                    ECD&          res               /* The fitted dipole */
+                    ECD&          res,              /* The fitted dipole */
+                    const ECD*    start,            /* Neighbouring fit to start from (optional) */
+                    int           best,             /* The best guess if it has been searched already */
+                    float         good              /* Its goodness of fit */
                     )
 {
     float  **simplex       = NULL;	       /* The simplex */
     float  vals[4];			       /* Values at the vertices */
-    float  limit           = 0.2;	               /* (pseudo) radial component omission limit */
+    float  limit           = FIT_RADIAL_LIMIT;    /* (pseudo) radial component omission limit */
     float  size            = 1e-2;	       /* Size of the initial simplex */
     float  ftol[]          = { 1e-2, 1e-2 };     /* Tolerances on the the two passes */
     float  atol[]          = { 0.2e-3, 0.2e-3 }; /* If dipole movement between two iterations is less than this,
                                                   we consider to have converged */
+    float  lm_atol         = 1e-5;             /* Step length tolerance of the gradient fit */
     int    ntol            = 2;
     int    max_eval        = 1000;	       /* Limit for fit function evaluations */
     int    report_interval = verbose ? 1 : -1;   /* How often to report the intermediate result */
 
-    int        best;
-    float      good,rd_guess[3],rd_final[3],Q[3],final_val;
+    float      rd_guess[3],rd_final[3],Q[3],final_val;
     fitDipUserRec user;
-    int        k,p,neval,neval_tot,nchan,ncomp;
-    int        fit_fail;
+    int        k,p,neval,neval_tot,ngrad,ngrad_tot,nchan,ncomp;
+    int        fit_fail,warm;
 
     nchan = fit->nmeg+fit->neeg;
     user.fwd = NULL;
 
-    if (MneProjOp::mne_proj_op_proj_vector(fit->proj,B,nchan,TRUE) == FAIL)
-        goto bad;
-
-    if (mne_whiten_one_data(B,B,nchan,fit->noise) == FAIL)
-        goto bad;
-    /*
-   * Get the initial guess
-   */
-    if (find_best_guess(B,nchan,guess,limit,&best,&good) < 0)
-        goto bad;
+    if (best < 0) {
+        if (MneProjOp::mne_proj_op_proj_vector(fit->proj,B,nchan,TRUE) == FAIL)
+            goto bad;
 
+        if (mne_whiten_one_data(B,B,nchan,fit->noise) == FAIL)
+            goto bad;
+    }
 
     user.limit = limit;
     user.B     = B;
@@ -5159,10 +5491,37 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     user.report_dim = FALSE;
     fit->user  = &user;
 
-    VEC_COPY_3(rd_guess,guess->rr[best]);
-    VEC_COPY_3(rd_final,guess->rr[best]);
-
     neval_tot = 0;
+    /*
+   * Warm start from the neighbouring fit. It is accepted if it explains the data better than the best guess or,
+   * if the guesses have not been searched, if it keeps most of the goodness of fit of the neighbour. The guess
+   * search is skipped then.
+   */
+    warm = FALSE;
+    if (start && start->valid) {
+        float rd_start[3] = { start->rd[0], start->rd[1], start->rd[2] };
+        float warm_good;
+
+        fit->funcs = fit->sphere_funcs;
+        warm_good = 1.0 - fit_eval(rd_start,3,fit)/user.B2;
+        neval_tot++;
+        if (best >= 0 ? warm_good > good : warm_good >= WARM_START_ACCEPT*fabs(start->good)) {
+            VEC_COPY_3(rd_guess,rd_start);
+            VEC_COPY_3(rd_final,rd_start);
+            warm = TRUE;
+        }
+    }
+    if (!warm) {
+        /*
+     * Get the initial guess
+     */
+        if (best < 0 && find_best_guess(B,nchan,guess,limit,&best,&good) < 0)
+            goto bad;
+        VEC_COPY_3(rd_guess,guess->rr[best]);
+        VEC_COPY_3(rd_final,guess->rr[best]);
+    }
+
+    ngrad_tot = 0;
     fit_fail = FALSE;
     for (k = 0; k < ntol; k++) {
         /*
@@ -5173,34 +5532,48 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
         else
             fit->funcs = !fit->bemname.isEmpty() ? fit->bem_funcs : fit->sphere_funcs;
 
-        simplex = make_initial_dipole_simplex(rd_guess,size);
-        for (p = 0; p < 4; p++)
-            vals[p] = fit_eval(simplex[p],3,fit);
-        if (simplex_minimize(simplex,           /* The initial simplex */
-                             vals,              /* Function values at the vertices */
-                             3,                 /* Number of variables */
-                             ftol[k],           /* Relative convergence tolerance for the target function */
-                             atol[k],           /* Absolute tolerance for the change in the parameters */
-                             fit_eval,          /* The function to be evaluated */
-                             fit,               /* Data to be passed to the above function in each evaluation */
-                             max_eval,          /* Maximum number of function evaluations */
-                             &neval,            /* Number of function evaluations */
-                             report_interval,   /* How often to report (-1 = no_reporting) */
-                             report_func) != OK) {
-            if (k == 0)
-                goto bad;
-            else {
-                printf("\nWarning (t = %8.1f ms) : g = %6.1f %% final val = %7.3f rtol = %f\n",
-                       1000*time,100*(1 - vals[0]/user.B2),vals[0],rtol(vals,4));
-                fit_fail = TRUE;
+        if (fit->gradient_fit && has_field_grad(fit,fit->funcs)) {
+            if (lm_minimize(fit,rd_guess,lm_atol,max_eval,&neval,&ngrad,&final_val) != OK) {
+                if (k == 0)
+                    goto bad;
+                else {
+                    printf("\nWarning (t = %8.1f ms) : g = %6.1f %% final val = %7.3f\n",
+                           1000*time,100*(1 - final_val/user.B2),final_val);
+                    fit_fail = TRUE;
+                }
             }
+            VEC_COPY_3(rd_final,rd_guess);
+            ngrad_tot += ngrad;
+        }
+        else {
+            simplex = make_initial_dipole_simplex(rd_guess,size);
+            for (p = 0; p < 4; p++)
+                vals[p] = fit_eval(simplex[p],3,fit);
+            if (simplex_minimize(simplex,           /* The initial simplex */
+                                 vals,              /* Function values at the vertices */
+                                 3,                 /* Number of variables */
+                                 ftol[k],           /* Relative convergence tolerance for the target function */
+                                 atol[k],           /* Absolute tolerance for the change in the parameters */
+                                 fit_eval,          /* The function to be evaluated */
+                                 fit,               /* Data to be passed to the above function in each evaluation */
+                                 max_eval,          /* Maximum number of function evaluations */
+                                 &neval,            /* Number of function evaluations */
+                                 report_interval,   /* How often to report (-1 = no_reporting) */
+                                 report_func) != OK) {
+                if (k == 0)
+                    goto bad;
+                else {
+                    printf("\nWarning (t = %8.1f ms) : g = %6.1f %% final val = %7.3f rtol = %f\n",
+                           1000*time,100*(1 - vals[0]/user.B2),vals[0],rtol(vals,4));
+                    fit_fail = TRUE;
+                }
+            }
+            VEC_COPY_3(rd_final,simplex[0]);
+            VEC_COPY_3(rd_guess,simplex[0]);
+            FREE_CMATRIX_3(simplex); simplex = NULL;
+            final_val = vals[0];
         }
-        VEC_COPY_3(rd_final,simplex[0]);
-        VEC_COPY_3(rd_guess,simplex[0]);
-        FREE_CMATRIX_3(simplex); simplex = NULL;
-
         neval_tot += neval;
-        final_val  = vals[0];
     }
     /*
    * Confidence limits should be computed here
@@ -5224,6 +5597,7 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
         else
             res.nfree = nchan-3-ncomp;
         res.neval = neval_tot;
+        res.ngrad = ngrad_tot;
     }
     else
         goto bad;
@@ -5339,3 +5713,60 @@ int DipoleFitData::compute_dipole_field(DipoleFitData* d, float *rd, int whiten,
 bad :
     return FAIL;
 }
+
+
+//*************************************************************************************************************
+
+int DipoleFitData::compute_dipole_field_grad(DipoleFitData* d, float *rd, int whiten, float **fwd, float **grad)
+/*
+ * Compute the field and its derivatives with respect to the dipole position
+ * and take whitening and projection into account
+ */
+{
+    static float Qx[] = {1.0,0.0,0.0};
+    static float Qy[] = {0.0,1.0,0.0};
+    static float Qz[] = {0.0,0.0,1.0};
+    float *Q[] = { Qx, Qy, Qz };
+    int   nchan = d->nmeg+d->neeg;
+    int   j,k;
+
+    if ((d->nmeg > 0 && !d->funcs->meg_field_grad) || (d->neeg > 0 && !d->funcs->eeg_pot_grad)) {
+        qCritical("Field gradients are not available with these forward functions.");
+        goto bad;
+    }
+    /*
+   * Compute the fields and the gradients
+   */
+    for (j = 0; j < 3; j++) {
+        if (d->nmeg > 0)
+            if (d->funcs->meg_field_grad(rd,Q[j],d->meg_coils,fwd[j],
+                                         grad[3*j+X_3],grad[3*j+Y_3],grad[3*j+Z_3],d->funcs->meg_client) != OK)
+                goto bad;
+        if (d->neeg > 0)
+            if (d->funcs->eeg_pot_grad(rd,Q[j],d->eeg_els,fwd[j]+d->nmeg,
+                                       grad[3*j+X_3]+d->nmeg,grad[3*j+Y_3]+d->nmeg,grad[3*j+Z_3]+d->nmeg,d->funcs->eeg_client) != OK)
+                goto bad;
+    }
+    /*
+   * Apply projection
+   */
+    for (k = 0; k < 3; k++)
+        if (MneProjOp::mne_proj_op_proj_vector(d->proj,fwd[k],nchan,TRUE) == FAIL)
+            goto bad;
+    for (k = 0; k < 9; k++)
+        if (MneProjOp::mne_proj_op_proj_vector(d->proj,grad[k],nchan,TRUE) == FAIL)
+            goto bad;
+    /*
+   * Whiten
+   */
+    if (d->noise && whiten) {
+        if (mne_whiten_data(fwd,fwd,3,nchan,d->noise) == FAIL)
+            goto bad;
+        if (mne_whiten_data(grad,grad,9,nchan,d->noise) == FAIL)
+            goto bad;
+    }
+    return OK;
+
+bad :
+    return FAIL;
+}
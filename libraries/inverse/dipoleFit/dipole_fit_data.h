@@ -82,11 +82,13 @@ typedef void (*fitUserFreeFunc)(void *);
 typedef struct {
   fwdFieldFunc    meg_field;	    /* MEG forward calculation functions */
   fwdVecFieldFunc meg_vec_field;
+  fwdFieldGradFunc meg_field_grad;  /* Field and its gradient with respect to the dipole position (optional) */
   void            *meg_client;	    /* Client data for MEG field computations */
   mneUserFreeFunc meg_client_free;
 
   fwdFieldFunc    eeg_pot;	    /* EEG forward calculation functions */
   fwdVecFieldFunc eeg_vec_pot;
+  fwdFieldGradFunc eeg_pot_grad;
   void            *eeg_client;	    /* Client data for EEG field computations */
   mneUserFreeFunc eeg_client_free;
 } *dipoleFitFuncs,dipoleFitFuncsRec;
@@ -196,7 +198,8 @@ public:
                                             int   diagnoise,                /**< Use only the diagonal elements of the noise-covariance matrix */
                                             const QList<QString>& projnames,/**< SSP file names */
                                             int   include_meg,              /**< Include MEG in the fitting? */
-                                            int   include_eeg);
+                                            int   include_eeg,              /**< Include EEG in the fitting? */
+                                            bool  packed_coils = false);    /**< Pack the coil integration points for the single-precision field kernels? */
 
 
 
@@ -211,8 +214,51 @@ public:
     * @param[in] B          The field to fit
     * @param[in] verbose
     * @param[in] res        The fitted dipole
+    * @param[in] start      Optional fit of a neighbouring time point. The fit starts from it instead of the best
+    *                       guess when it explains the data better (warm start). If the guesses have not been
+    *                       searched yet, it is accepted when it keeps most of the goodness of fit of the neighbour
+    *                       and the guess search is skipped.
+    * @param[in] best       The best guess found by find_best_guesses, B is then already projected and whitened.
+    *                       If negative, fit_one does both and searches the guesses itself.
+    * @param[in] good       The goodness of fit of the best guess
     */
-    static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int verbose, ECD& res);
+    static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int verbose, ECD& res, const ECD* start = NULL, int best = -1, float good = 0.0f);
+
+    //=========================================================================================================
+    /**
+    * Projects and whitens a block of time points in place and finds the best guess for each of them with a
+    * single product against the guess field matrix, ready to be handed to fit_one.
+    *
+    * @param[in] fit        Precomputed fitting data
+    * @param[in] guess      The initial guesses
+    * @param[in,out] B      The fields to fit, one row per time point
+    * @param[in] ntime      Number of time points
+    * @param[out] best      The best guess for each time point (-1 if there is none)
+    * @param[out] good      Its goodness of fit
+    *
+    * @return OK when successful
+    */
+    static int find_best_guesses(DipoleFitData* fit, GuessData* guess, float **B, int ntime, int *best, float *good);
+
+    //=========================================================================================================
+    /**
+    * Create a duplicate to make the fitting data thread safe. The read-only parts are shared with the
+    * original, the forward calculation clients, which hold workspace, are duplicated.
+    *
+    * @param[in] fit    Precomputed fitting data to duplicate
+    *
+    * @return the duplicate, release it with free_multi_thread_duplicate
+    */
+    static DipoleFitData* create_multi_thread_duplicate(DipoleFitData* fit);
+
+    //=========================================================================================================
+    /**
+    * Free a duplicate created by create_multi_thread_duplicate without touching the shared data
+    *
+    * @param[in] one    The duplicate to free
+    * @param[in] fit    The original the duplicate was created from
+    */
+    static void free_multi_thread_duplicate(DipoleFitData* one, DipoleFitData* fit);
 
 
 
@@ -220,6 +266,21 @@ public:
 
     static int compute_dipole_field(DipoleFitData* d, float *rd, int whiten, float **fwd);
 
+    //=========================================================================================================
+    /**
+    * Compute the field of three orthogonal dipoles and its derivatives with respect to the dipole position,
+    * with projection and whitening as in compute_dipole_field
+    *
+    * @param[in] d      Precomputed fitting data
+    * @param[in] rd     Dipole position
+    * @param[in] whiten Apply the whitener?
+    * @param[out] fwd   The fields (3 x nchan)
+    * @param[out] grad  The derivatives (9 x nchan), grad[3*j+p] is the derivative of fwd[j] with respect to rd[p]
+    *
+    * @return OK when successful, FAIL also if the current forward functions do not provide gradients
+    */
+    static int compute_dipole_field_grad(DipoleFitData* d, float *rd, int whiten, float **fwd, float **grad);
+
     //============================= dipole_forward.c
 
     static DipoleForward* dipole_forward_one(DipoleFitData* d,
@@ -261,6 +322,7 @@ public:
       MNELIB::MneProjOp*        proj;               /**< The projection operator to use */
       int               column_norm;        /**< What kind of column normalization to apply to the forward solution */
       int               fit_mag_dipoles;    /**< Fit magnetic dipoles? */
+      int               gradient_fit;       /**< Minimize with Levenberg-Marquardt using the field gradients? */
       void              *user;              /**< User data for anything we need */
       fitUserFreeFunc   user_free;          /**< Function to free the above */
 
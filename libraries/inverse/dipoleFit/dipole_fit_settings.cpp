@@ -2,6 +2,12 @@
 
 #include "dipole_fit_settings.h"
 
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QTextStream>
+
 
 using namespace Eigen;
 using namespace INVERSELIB;
@@ -119,8 +125,13 @@ void DipoleFitSettings::initMembers()
          
     eeg_sphere_rad = 0.09f;      
     scale_eeg_pos  = false;     
+    use_eeg_table  = false;
     mag_reg      = 0.1f;         
     fit_mag_dipoles = false;
+    nthreads     = 1;
+    warm_start   = false;
+    gradient_fit = false;
+    packed_coils = false;
 
     grad_reg     = 0.1f;         
     eeg_reg      = 0.1f;                  
@@ -139,7 +150,7 @@ void DipoleFitSettings::checkIntegrity()
         qCritical ("Data file name missing. Please specify one using the --meas option.");
         return;
     }
-    if (dipname.isEmpty() && bdipname.isEmpty()) {
+    if (dipname.isEmpty() && bdipname.isEmpty() && batchnames.isEmpty()) {
         qCritical ("Output file name missing. Please use the --dip or --bdip options to do this.");
         return;
     }
@@ -206,6 +217,8 @@ void DipoleFitSettings::checkIntegrity()
         printf("dip output      : %s\n",dipname.toUtf8().data());
     if (!bdipname.isEmpty())
         printf("bdip output     : %s\n",bdipname.toUtf8().data());
+    if (!batchnames.isEmpty())
+        printf("Batch           : %d %s data files\n",batchnames.size(),is_raw ? "raw" : "evoked");
     printf("\n");
 }
 
@@ -266,20 +279,30 @@ void DipoleFitSettings::usage(char *name)
     printf("\t--eegmodels name  read EEG sphere model specifications from here.\n");
     printf("\t--eegmodel  name  name of the EEG sphere model to use (default : Default)\n");
     printf("\t--eegrad val      radius of the scalp surface to use in EEG sphere model (default : %7.1f mm)\n",1000*eeg_sphere_rad);
+    printf("\t--eegtable        tabulate the series expansion of the EEG sphere model instead of using equivalent sources\n");
     printf("\t--accurate        use accurate coil definitions in MEG forward computation\n");
 
     printf("\nFitting parameters:\n\n");
     printf("\t--guess name      The source space of initial guesses.\n");
     printf("\t                  If not present, the values below are used to generate the guess grid.\n");
     printf("\t--guesssurf name  Read the inner skull surface from this fif file to generate the guesses.\n");
+    printf("\t--guesscache name Cache the guess fields in this file and reuse them while the model, coils, projection and noise are unchanged.\n");
     printf("\t--guessrad value  Radius of a spherical guess volume if neither of the above is present (default : %.1f mm)\n",1000*guess_rad);
     printf("\t--exclude dist/mm Exclude points which are closer than this distance from the CM of the inner skull surface (default =  %6.1f mm).\n",1000*guess_exclude);
     printf("\t--mindist dist/mm Exclude points which are closer than this distance from the inner skull surface  (default = %6.1f mm).\n",1000*guess_mindist);
     printf("\t--grid    dist/mm Source space grid size (default = %6.1f mm).\n",1000*guess_grid);
     printf("\t--magdip          Fit magnetic dipoles instead of current dipoles.\n");
+    printf("\t--threads n       Number of fitting threads, 0 uses all available cores (default : %d).\n",nthreads);
+    printf("\t--warmstart       Start each fit from the result of the preceding time point.\n");
+    printf("\t--gradfit         Minimize with Levenberg-Marquardt using the analytic field gradients instead of the simplex.\n");
+    printf("\t--packedcoils     Evaluate sphere model and magnetic dipole fields over packed single-precision coil points.\n");
     printf("\nOutput:\n\n");
     printf("\t--dip     name    xfit dip format output file name\n");
     printf("\t--bdip    name    xfit bdip format output file name\n");
+    printf("\nBatch mode:\n\n");
+    printf("\t--batch   name    Fit all data files listed here, one per line as 'data [dip [bdip]]', with the setup\n");
+    printf("\t                  of the --meas or --raw file. The files must share its sensors and projections.\n");
+    printf("\t                  They are of the same kind; the dip output defaults to the data file name with .dip.\n");
     printf("\nGeneral:\n\n");
     printf("\t--gui             Enables the gui.\n");
     printf("\t--help            print this info.\n");
@@ -304,6 +327,39 @@ bool DipoleFitSettings::check_unrecognized_args(int argc, char **argv)
 }
 
 
+//*************************************************************************************************************
+
+bool DipoleFitSettings::read_batch_list(const QString& name)
+{
+    QFile file(name);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qCritical() << "Could not open the batch list" << name;
+        return false;
+    }
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+        QStringList items = line.split(QRegExp("\\s+"));
+        if (items.size() > 3) {
+            qCritical() << "Incomprehensible line in the batch list" << name << ":" << line;
+            return false;
+        }
+        QFileInfo info(items[0]);
+        batchnames.append(items[0]);
+        batchdipnames.append(items.size() > 1 ? items[1] : info.dir().filePath(info.completeBaseName() + ".dip"));
+        batchbdipnames.append(items.size() > 2 ? items[2] : QString());
+    }
+    if (batchnames.isEmpty()) {
+        qCritical() << "No data files in the batch list" << name;
+        return false;
+    }
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 bool DipoleFitSettings::check_args (int *argc,char **argv)
@@ -343,6 +399,14 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             }
             guess_surfname = strdup(argv[k+1]);
         }
+        else if (strcmp(argv[k],"--guesscache") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical ("--guesscache: argument required.");
+                return false;
+            }
+            guess_cachename = QString(argv[k+1]);
+        }
         else if (strcmp(argv[k],"--guesssurf") == 0) {
             found = 2;
             if (k == *argc - 1) {
@@ -489,6 +553,10 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             found         = 1;
             scale_eeg_pos = true;
         }
+        else if (strcmp(argv[k],"--eegtable") == 0) {
+            found         = 1;
+            use_eeg_table = true;
+        }
         else if (strcmp(argv[k],"--meas") == 0) {
             found = 2;
             if (k == *argc - 1) {
@@ -839,10 +907,42 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             }
             bdipname = QString(argv[k+1]);
         }
+        else if (strcmp(argv[k],"--batch") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical ("--batch: argument required.");
+                return false;
+            }
+            if (!read_batch_list(QString(argv[k+1])))
+                return false;
+        }
         else if (strcmp(argv[k],"--verbose") == 0) {
             found = 1;
             verbose = true;
         }
+        else if (strcmp(argv[k],"--threads") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical ("--threads: argument required.");
+                return false;
+            }
+            if (sscanf(argv[k+1],"%d",&nthreads) != 1) {
+                qCritical() << "Incomprehensible number of threads:" << argv[k+1];
+                return false;
+            }
+        }
+        else if (strcmp(argv[k],"--warmstart") == 0) {
+            found = 1;
+            warm_start = true;
+        }
+        else if (strcmp(argv[k],"--gradfit") == 0) {
+            found = 1;
+            gradient_fit = true;
+        }
+        else if (strcmp(argv[k],"--packedcoils") == 0) {
+            found = 1;
+            packed_coils = true;
+        }
         if (found) {
             for (int p = k; p < *argc-found; p++)
                 argv[p] = argv[p+found];
@@ -144,6 +144,7 @@ public:
 
     QString guessname;                  /**< Initial guess grid (if not present, the values below will be employed to generate the grid) */
     QString guess_surfname;             /**< Load the inner skull surface from this BEM file */
+    QString guess_cachename;            /**< Cache the projected and whitened guess fields in this file */
 float guess_rad;       			/**< Radius of spherical guess surface */
     float guess_mindist;       		/**< Minimum allowed distance to the surface */
     float guess_exclude;       		/**< Exclude points closer than this to the origin */
@@ -177,13 +178,21 @@ float guess_rad;       			/**< Radius of spherical guess surface */
     QString eeg_model_name;             /**< Name of the EEG model to use */
 float  eeg_sphere_rad;      		/**< Scalp radius to use in EEG sphere model */
     bool    scale_eeg_pos;     		/**< Scale the electrode locations to scalp in the sphere model */
+    bool    use_eeg_table;              /**< Use the tabulated series expansion for the EEG sphere model */
     float  mag_reg;         		/**< Noise-covariance matrix regularization for MEG (magnetometers and axial gradiometers)  */
     bool   fit_mag_dipoles;
+    int    nthreads;                    /**< Number of fitting threads (<= 0: all available) */
+    bool   warm_start;                  /**< Start each fit from the result of the preceding time point */
+    bool   gradient_fit;                /**< Minimize with Levenberg-Marquardt using the field gradients instead of the simplex */
+    bool   packed_coils;                /**< Evaluate the sphere and magnetic dipole fields over packed single-precision coil points */
 
 float  grad_reg;         		/**< Noise-covariance matrix regularization for EEG (planar gradiometers) */
     float  eeg_reg;         		/**< Noise-covariance matrix regularization for EEG  */
     QString dipname;                    /**< Output file in dip format */
     QString bdipname;                   /**< Output file in bdip format */
+    QStringList batchnames;             /**< Batch mode: data files fitted with the setup of measname */
+    QStringList batchdipnames;          /**< Batch mode: dip output file for each data file */
+    QStringList batchbdipnames;         /**< Batch mode: bdip output file for each data file, empty for none */
 
     bool gui;                		/**< Should the gui been shown? */
 
@@ -192,6 +201,7 @@ private:
     void usage(char *name);
     bool check_unrecognized_args(int argc, char **argv);
     bool check_args (int *argc,char **argv);
+    bool read_batch_list(const QString& name);
 
 };
 
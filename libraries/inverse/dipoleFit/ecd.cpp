@@ -64,6 +64,7 @@ ECD::ECD()
 , khi2(0)
 , nfree(0)
 , neval(-1)
+, ngrad(0)
 {
 
 }
@@ -80,6 +81,7 @@ ECD::ECD(const ECD& p_ECD)
 , khi2(p_ECD.khi2)
 , nfree(p_ECD.nfree)
 , neval(p_ECD.neval)
+, ngrad(p_ECD.ngrad)
 {
 }
 
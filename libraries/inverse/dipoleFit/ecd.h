@@ -119,6 +119,7 @@ public:
     float           khi2;   /**< khi^2 value */
     int             nfree;  /**< Degrees of freedom for the above */
     int             neval;  /**< Number of function evaluations required for this fit */
+    int             ngrad;  /**< Number of field gradient evaluations of a gradient fit, not included in neval */
 
 // ### OLD STRUCT ###
 //    typedef struct {
@@ -44,10 +44,18 @@
 #include <mne/c/mne_surface_old.h>
 #include <mne/c/mne_source_space_old.h>
 
+#include <mne/c/mne_proj_op.h>
+#include <mne/c/mne_cov_matrix.h>
+#include <mne/c/mne_ctf_comp_data.h>
+#include <fwd/fwd_coil_set.h>
+#include <fwd/fwd_comp_data.h>
+
 #include <fiff/fiff_stream.h>
 #include <fiff/fiff_tag.h>
 
 #include <QFile>
+#include <QDataStream>
+#include <QCryptographicHash>
 
 
 //*************************************************************************************************************
@@ -188,6 +196,106 @@ void fromIntEigenMatrix_16(const Eigen::MatrixXi& from_mat, int **&to_mat)
 }
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+#define GUESS_CACHE_MAGIC   0x47554553      /* "GUES" */
+#define GUESS_CACHE_VERSION 1
+
+static void hash_floats(QCryptographicHash& hash, const float *vals, int nval)
+
+{
+    if (vals && nval > 0)
+        hash.addData((const char *)vals,nval*sizeof(float));
+}
+
+
+static void hash_ints(QCryptographicHash& hash, int v1, int v2 = 0, int v3 = 0)
+
+{
+    int vals[] = { v1, v2, v3 };
+    hash.addData((const char *)vals,sizeof(vals));
+}
+
+
+static void hash_coils(QCryptographicHash& hash, FwdCoilSet* coils)
+
+{
+    if (!coils) {
+        hash_ints(hash,0);
+        return;
+    }
+    hash_ints(hash,coils->ncoil);
+    for (int k = 0; k < coils->ncoil; k++) {
+        FwdCoil* coil = coils->coils[k];
+
+        hash_ints(hash,coil->type,coil->coil_class,coil->np);
+        for (int p = 0; p < coil->np; p++) {
+            hash_floats(hash,coil->rmag[p],3);
+            hash_floats(hash,coil->cosmag[p],3);
+        }
+        hash_floats(hash,coil->w,coil->np);
+    }
+}
+
+
+static QByteArray guess_field_key(DipoleFitData* f, float **rr, int nguess)
+/*
+ * Everything the projected and whitened guess fields depend on
+ */
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    /*
+     * The guess locations
+     */
+    hash_ints(hash,nguess);
+    for (int k = 0; k < nguess; k++)
+        hash_floats(hash,rr[k],3);
+    /*
+     * The forward model (the guesses are always computed with the sphere model or as magnetic dipoles)
+     */
+    hash_ints(hash,f->fit_mag_dipoles,f->column_norm,f->coord_frame);
+    hash_floats(hash,f->r0,3);
+    if (f->eeg_model && f->neeg > 0) {
+        hash_ints(hash,f->eeg_model->nlayer());
+        for (int k = 0; k < f->eeg_model->nlayer(); k++) {
+            hash_floats(hash,&f->eeg_model->layers[k].rad,1);
+            hash_floats(hash,&f->eeg_model->layers[k].sigma,1);
+        }
+    }
+    /*
+     * Coils, electrodes and compensation
+     */
+    hash_ints(hash,f->nmeg,f->neeg);
+    hash_coils(hash,f->meg_coils);
+    hash_coils(hash,f->eeg_els);
+    if (f->sphere_funcs && f->sphere_funcs->meg_client) {
+        FwdCompData* comp = (FwdCompData*)f->sphere_funcs->meg_client;
+
+        hash_ints(hash,comp->set && comp->set->current ? comp->set->current->kind : 0);
+    }
+    /*
+     * Projection and whitening
+     */
+    if (f->proj) {
+        hash_ints(hash,f->proj->nch,f->proj->nvec);
+        for (int k = 0; k < f->proj->nvec; k++)
+            hash_floats(hash,f->proj->proj_data[k],f->proj->nch);
+    }
+    if (f->noise) {
+        hash_ints(hash,f->noise->ncov,f->noise->nzero);
+        if (f->noise->inv_lambda)
+            hash.addData((const char *)f->noise->inv_lambda,f->noise->ncov*sizeof(double));
+        if (f->noise->eigen)
+            for (int k = 0; k < f->noise->ncov; k++)
+                hash_floats(hash,f->noise->eigen[k],f->noise->ncov);
+    }
+    return hash.result();
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -211,7 +319,7 @@ GuessData::GuessData()
 
 //*************************************************************************************************************
 
-GuessData::GuessData(const QString &guessname, const QString &guess_surfname, float mindist, float exclude, float grid, DipoleFitData *f)
+GuessData::GuessData(const QString &guessname, const QString &guess_surfname, float mindist, float exclude, float grid, DipoleFitData *f, const QString &cachename)
 {
     MneSourceSpaceOld* *sp = NULL;
     int            nsp = 0;
@@ -272,10 +380,16 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
         }
     delete guesses; guesses = NULL;
 
-    fprintf(stderr,"Go through all guess source locations...");
     this->guess_fwd = MALLOC_16(this->nguess,DipoleForward*);
     for (k = 0; k < this->nguess; k++)
         this->guess_fwd[k] = NULL;
+    /*
+        * Maybe the fields are in the cache already
+        */
+    if (!cachename.isEmpty() && this->load_guess_fields(cachename,f))
+        return;
+
+    fprintf(stderr,"Go through all guess source locations...");
     /*
         * Compute the guesses using the sphere model for speed
         */
@@ -297,6 +411,10 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
 
     fprintf(stderr,"[done %d sources]\n",p);
 
+    this->make_guess_field_matrix();
+    if (!cachename.isEmpty())
+        this->save_guess_fields(cachename,f);
+
     return;
 //    return res;
 
@@ -462,5 +580,131 @@ bool GuessData::compute_guess_fields(DipoleFitData* f)
     f->funcs = orig;
     printf("[done %d sources]\n",this->nguess);
 
+    this->make_guess_field_matrix();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void GuessData::make_guess_field_matrix()
+{
+    if (nguess <= 0 || !guess_fwd || !guess_fwd[0])
+        return;
+
+    int nch = guess_fwd[0]->nch;
+
+    guess_uu.resize(nch,3*nguess);
+    guess_ratio.resize(nguess);
+    for (int k = 0; k < nguess; k++) {
+        DipoleForward* fwd = guess_fwd[k];
+
+        for (int c = 0; c < 3; c++)
+            guess_uu.col(3*k+c) = Map<VectorXf>(fwd->uu[c],nch);
+        guess_ratio[k] = fwd->sing[2]/fwd->sing[0];
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool GuessData::find_best_guesses(const MatrixXf& B, float limit, VectorXi& best, VectorXf& good) const
+{
+    if (guess_uu.cols() != 3*nguess || B.rows() != guess_uu.rows()) {
+        qCritical("Data do not match the guess field matrix in find_best_guesses");
+        return false;
+    }
+    /*
+     * Projections of all time points onto all guess fields at once
+     */
+    MatrixXf proj = guess_uu.transpose()*B;
+    VectorXf B2   = B.colwise().squaredNorm().transpose();
+
+    best.setConstant(B.cols(),-1);
+    good.setZero(B.cols());
+    for (int t = 0; t < B.cols(); t++) {
+        for (int k = 0; k < nguess; k++) {
+            double Bm2 = proj(3*k,t)*proj(3*k,t) + proj(3*k+1,t)*proj(3*k+1,t);
+            if (guess_ratio[k] > limit)
+                Bm2 += proj(3*k+2,t)*proj(3*k+2,t);
+            double this_good = 1.0 - (B2[t] - Bm2)/B2[t];
+            if (this_good > good[t]) {
+                best[t] = k;
+                good[t] = this_good;
+            }
+        }
+    }
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool GuessData::save_guess_fields(const QString& cachename, DipoleFitData* f) const
+{
+    QFile file(cachename);
+
+    if (guess_uu.cols() != 3*nguess || nguess <= 0)
+        return false;
+    if (!file.open(QIODevice::WriteOnly)) {
+        printf("Could not write the guess field cache %s\n",cachename.toUtf8().constData());
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream << (qint32)GUESS_CACHE_MAGIC << (qint32)GUESS_CACHE_VERSION;
+    stream << guess_field_key(f,rr,nguess);
+    stream << (qint32)guess_uu.rows() << (qint32)nguess;
+    for (int k = 0; k < nguess; k++)
+        stream << guess_ratio[k];
+    for (int j = 0; j < guess_uu.cols(); j++)
+        for (int i = 0; i < guess_uu.rows(); i++)
+            stream << guess_uu(i,j);
+
+    printf("Wrote %d guess fields to %s\n",nguess,cachename.toUtf8().constData());
+    return stream.status() == QDataStream::Ok;
+}
+
+
+//*************************************************************************************************************
+
+bool GuessData::load_guess_fields(const QString& cachename, DipoleFitData* f)
+{
+    QFile      file(cachename);
+    qint32     magic,version,nch,ng;
+    QByteArray key;
+
+    if (!file.exists() || !file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream >> magic >> version;
+    if (magic != GUESS_CACHE_MAGIC || version != GUESS_CACHE_VERSION)
+        return false;
+    stream >> key >> nch >> ng;
+    if (key != guess_field_key(f,rr,nguess) || nch != f->nmeg+f->neeg || ng != nguess) {
+        printf("Guess field cache %s does not match the present data, recomputing.\n",cachename.toUtf8().constData());
+        return false;
+    }
+    VectorXf ratio(ng);
+    MatrixXf uu(nch,3*ng);
+    for (int k = 0; k < ng; k++)
+        stream >> ratio[k];
+    for (int j = 0; j < uu.cols(); j++)
+        for (int i = 0; i < uu.rows(); i++)
+            stream >> uu(i,j);
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    guess_ratio = ratio;
+    guess_uu    = uu;
+    printf("Read %d guess fields from %s\n",nguess,cachename.toUtf8().constData());
     return true;
 }
@@ -59,6 +59,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QString>
 
 
 //*************************************************************************************************************
@@ -110,9 +111,12 @@ public:
     * Refactored: make_guess_data (setup.c)
     *
     * @param[in] guessname
+    * @param[in] cachename  Guess field cache file (optional). The fields are read from it when it was written for the
+    *                       same guesses, forward model, coils, projection and noise covariance, otherwise they are
+    *                       computed and the file is (re)written.
     *
     */
-    GuessData( const QString& guessname, const QString& guess_surfname, float mindist, float exclude, float grid, DipoleFitData* f);
+    GuessData( const QString& guessname, const QString& guess_surfname, float mindist, float exclude, float grid, DipoleFitData* f, const QString& cachename = QString());
 
     //=========================================================================================================
     /**
@@ -144,10 +148,57 @@ public:
     */
     bool compute_guess_fields(DipoleFitData* f);
 
+    //=========================================================================================================
+    /**
+    * Collects the left singular vectors of all guess fields into one contiguous matrix, three columns per guess,
+    * so that the goodness of fit of every guess for a whole block of time points follows from a single matrix
+    * product (see find_best_guesses).
+    */
+    void make_guess_field_matrix();
+
+    //=========================================================================================================
+    /**
+    * Finds the best guess for each column of B.
+    *
+    * @param[in] B      The projected and whitened data, one column per time point
+    * @param[in] limit  Pseudoradial component omission limit
+    * @param[out] best  Index of the best guess for each time point (-1 if none explains any of the data)
+    * @param[out] good  The corresponding goodness of fit
+    *
+    * @return true when successful
+    */
+    bool find_best_guesses(const Eigen::MatrixXf& B, float limit, Eigen::VectorXi& best, Eigen::VectorXf& good) const;
+
+    //=========================================================================================================
+    /**
+    * Writes the guess locations and the guess field matrix to a cache file, keyed by everything the fields
+    * depend on
+    *
+    * @param[in] cachename  The cache file
+    * @param[in] f          The fitting data the fields were computed with
+    *
+    * @return true when successful
+    */
+    bool save_guess_fields(const QString& cachename, DipoleFitData* f) const;
+
+    //=========================================================================================================
+    /**
+    * Reads the guess field matrix from a cache file if it was written for the current guess locations and
+    * fitting data. The per guess forward solutions are not restored, the fits use the matrix instead.
+    *
+    * @param[in] cachename  The cache file
+    * @param[in] f          The fitting data
+    *
+    * @return true when the cache matched and was read
+    */
+    bool load_guess_fields(const QString& cachename, DipoleFitData* f);
+
 public:
     float          **rr;            /**< These are the guess dipole locations */
     DipoleForward** guess_fwd;      /**< Forward solutions for the guesses */
     int            nguess;          /**< How many sources */
+    Eigen::MatrixXf guess_uu;       /**< Left singular vectors of the guess fields, three columns per guess (nchan x 3*nguess) */
+    Eigen::VectorXf guess_ratio;    /**< sing[2]/sing[0] of each guess, decides whether the third component is used */
 
 // ### OLD STRUCT ###
 //    typedef struct {
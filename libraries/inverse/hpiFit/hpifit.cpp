@@ -65,6 +65,7 @@
 //=============================================================================================================
 
 #include <QFuture>
+#include <QElapsedTimer>
 #include <QtConcurrent/QtConcurrent>
 
 
@@ -90,8 +91,17 @@ using namespace FIFFLIB;
 //=============================================================================================================
 
 HPIFit::HPIFit()
+: m_bWarmStart(true)
+, m_dMaxWarmStartGof(0.01)
+, m_bLastFitValid(false)
+, m_pSensorFiffInfo(Q_NULLPTR)
+, m_iSignalSamples(0)
+, m_dSignalSFreq(0.0)
 {
-
+    m_timings.prepareUsec = 0;
+    m_timings.dipfitUsec = 0;
+    m_timings.totalUsec = 0;
+    m_timings.warmStarted = false;
 }
 
 
@@ -107,6 +117,51 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
                         bool bDoDebug,
                         const QString& sHPIResourceDir)
 {
+    HPIFit hpiFit;
+    hpiFit.setWarmStart(false);
+    hpiFit.fit(t_mat, t_matProjectors, transDevHead, vFreqs, vGof, fittedPointSet, pFiffInfo, bDoDebug, sHPIResourceDir);
+}
+
+
+//*************************************************************************************************************
+
+void HPIFit::setWarmStart(bool bWarmStart, double dMaxGof)
+{
+    m_bWarmStart = bWarmStart;
+    m_dMaxWarmStartGof = dMaxGof;
+}
+
+
+//*************************************************************************************************************
+
+void HPIFit::reset()
+{
+    m_bLastFitValid = false;
+    m_matLastCoilPos.resize(0,0);
+
+    m_pSensorFiffInfo = Q_NULLPTR;
+    m_vInnerind.clear();
+
+    m_vSignalFreqs.clear();
+    m_iSignalSamples = 0;
+}
+
+
+//*************************************************************************************************************
+
+void HPIFit::fit(const MatrixXd& t_mat,
+                 const Eigen::MatrixXd& t_matProjectors,
+                 FiffCoordTrans& transDevHead,
+                 const QVector<int>& vFreqs,
+                 QVector<double>& vGof,
+                 FiffDigPointSet& fittedPointSet,
+                 FiffInfo::SPtr pFiffInfo,
+                 bool bDoDebug,
+                 const QString& sHPIResourceDir)
+{
+    QElapsedTimer timer;
+    timer.start();
+
     //Check if data was passed
     if(t_mat.rows() == 0 || t_mat.cols() == 0 ) {
         std::cout<<std::endl<< "HPIFit::fitHPI - No data passed. Returning.";
@@ -119,9 +174,7 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
 
     vGof.clear();
 
-    struct SensorInfo sensors;
     struct CoilParam coil;
-    int numCh = pFiffInfo->nchan;
     int samF = pFiffInfo->sfreq;
     int samLoc = t_mat.cols(); // minimum samples required to localize numLoc times in a second
 
@@ -155,19 +208,26 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
     coil.dpfiterror = Eigen::VectorXd::Zero(numCoils);
     coil.dpfitnumitr = Eigen::VectorXd::Zero(numCoils);
 
-    // Generate simulated data
-    Eigen::MatrixXd simsig(samLoc,numCoils*2);
-    Eigen::VectorXd time(samLoc);
+    // Generate simulated data, its pseudo inverse only changes with the coil frequencies and the block size
+    if(m_matSimsigPinvT.rows() == 0 || m_iSignalSamples != samLoc || m_dSignalSFreq != samF || m_vSignalFreqs != vFreqs.mid(0, numCoils)) {
+        Eigen::MatrixXd simsig(samLoc,numCoils*2);
+        Eigen::VectorXd time(samLoc);
 
-    for (int i = 0; i < samLoc; ++i) {
-        time[i] = i*1.0/samF;
-    }
+        for (int i = 0; i < samLoc; ++i) {
+            time[i] = i*1.0/samF;
+        }
 
-    for(int i = 0; i < numCoils; ++i) {
-        for(int j = 0; j < samLoc; ++j) {
-            simsig(j,i) = sin(2*M_PI*coilfreq[i]*time[j]);
-            simsig(j,i+numCoils) = cos(2*M_PI*coilfreq[i]*time[j]);
+        for(int i = 0; i < numCoils; ++i) {
+            for(int j = 0; j < samLoc; ++j) {
+                simsig(j,i) = sin(2*M_PI*coilfreq[i]*time[j]);
+                simsig(j,i+numCoils) = cos(2*M_PI*coilfreq[i]*time[j]);
+            }
         }
+
+        m_matSimsigPinvT = UTILSLIB::MNEMath::pinv(simsig).transpose();
+        m_iSignalSamples = samLoc;
+        m_dSignalSFreq = samF;
+        m_vSignalFreqs = vFreqs.mid(0, numCoils);
     }
 
     // Create digitized HPI coil position matrix
@@ -188,50 +248,9 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
         }
     }
 
-    // Get the indices of inner layer channels and exclude bad channels.
-    //TODO: Only supports babymeg and vectorview gradiometeres for hpi fitting.
-    QVector<int> innerind(0);
-
-    for (int i = 0; i < numCh; ++i) {
-        if(pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_BABY_MAG ||
-                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T1 ||
-                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T2 ||
-                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T3) {
-            // Check if the sensor is bad, if not append to innerind
-            if(!(pFiffInfo->bads.contains(pFiffInfo->ch_names.at(i)))) {
-                innerind.append(i);
-            }
-        }
-    }
-
-    //Create new projector based on the excluded channels, first exclude the rows then the columns
-    MatrixXd matProjectorsRows(innerind.size(),t_matProjectors.cols());
-    MatrixXd matProjectorsInnerind(innerind.size(),innerind.size());
-
-    for (int i = 0; i < matProjectorsRows.rows(); ++i) {
-        matProjectorsRows.row(i) = t_matProjectors.row(innerind.at(i));
-    }
-
-    for (int i = 0; i < matProjectorsInnerind.cols(); ++i) {
-        matProjectorsInnerind.col(i) = matProjectorsRows.col(innerind.at(i));
-    }
+    updateSensors(t_matProjectors, pFiffInfo);
 
-    //UTILSLIB::IOUtils::write_eigen_matrix(matProjectorsInnerind, "matProjectorsInnerind.txt");
-    //UTILSLIB::IOUtils::write_eigen_matrix(t_matProjectors, "t_matProjectors.txt");
-
-    // Initialize inner layer sensors
-    sensors.coilpos = Eigen::MatrixXd::Zero(innerind.size(),3);
-    sensors.coilori = Eigen::MatrixXd::Zero(innerind.size(),3);
-    sensors.tra = Eigen::MatrixXd::Identity(innerind.size(),innerind.size());
-
-    for(int i = 0; i < innerind.size(); i++) {
-        sensors.coilpos(i,0) = pFiffInfo->chs[innerind.at(i)].chpos.r0[0];
-        sensors.coilpos(i,1) = pFiffInfo->chs[innerind.at(i)].chpos.r0[1];
-        sensors.coilpos(i,2) = pFiffInfo->chs[innerind.at(i)].chpos.r0[2];
-        sensors.coilori(i,0) = pFiffInfo->chs[innerind.at(i)].chpos.ez[0];
-        sensors.coilori(i,1) = pFiffInfo->chs[innerind.at(i)].chpos.ez[1];
-        sensors.coilori(i,2) = pFiffInfo->chs[innerind.at(i)].chpos.ez[2];
-    }
+    const QVector<int>& innerind = m_vInnerind;
 
     Eigen::MatrixXd topo(innerind.size(), numCoils*2);
     Eigen::MatrixXd amp(innerind.size(), numCoils);
@@ -245,7 +264,7 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
     }
 
     // Calculate topo
-    topo = innerdata * UTILSLIB::MNEMath::pinv(simsig).transpose(); // topo: # of good inner channel x 8
+    topo = innerdata * m_matSimsigPinvT; // topo: # of good inner channel x 8
 
     // Select sine or cosine component depending on the relative size
     amp  = topo.leftCols(numCoils); // amp: # of good inner channel x 4
@@ -306,9 +325,15 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
         //std::cout << "HPIFit::fitHPI - Coil " << j << " max value index " << chIdx << std::endl;
     }
 
-    coil.pos = coilPos;
+    // Seed with the previous fit if it was good enough
+    m_timings.warmStarted = m_bWarmStart && m_bLastFitValid && m_matLastCoilPos.rows() == numCoils;
+    coil.pos = m_timings.warmStarted ? m_matLastCoilPos : coilPos;
+
+    m_timings.prepareUsec = timer.nsecsElapsed() / 1000;
 
-    coil = dipfit(coil, sensors, amp, numCoils, matProjectorsInnerind);
+    coil = dipfit(coil, m_sensors, amp, numCoils, m_matProjectorsInnerind);
+
+    m_timings.dipfitUsec = timer.nsecsElapsed() / 1000 - m_timings.prepareUsec;
 
     Eigen::Matrix4d trans = computeTransformation(headHPI, coil.pos);
     //Eigen::Matrix4d trans = computeTransformation(coil.pos, headHPI);
@@ -337,9 +362,15 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
     MatrixXd testPos = trans * temp;
     MatrixXd diffPos = testPos.block(0,0,3,numCoils) - headHPI.transpose();
 
+    m_bLastFitValid = diffPos.cols() > 0;
     for(int i = 0; i < diffPos.cols(); ++i) {
         vGof.append(diffPos.col(i).norm());
+
+        if(vGof.last() > m_dMaxWarmStartGof) {
+            m_bLastFitValid = false;
+        }
     }
+    m_matLastCoilPos = coil.pos;
 
     //Generate final fitted points and store in digitizer set
     for(int i = 0; i < coil.pos.rows(); ++i) {
@@ -389,12 +420,87 @@ void HPIFit::fitHPI(const MatrixXd& t_mat,
 
         UTILSLIB::IOUtils::write_eigen_matrix(amp, QString("%1/%2_amp_mat").arg(sHPIResourceDir).arg(sTimeStamp));
     }
+
+    m_timings.totalUsec = timer.nsecsElapsed() / 1000;
+
+    if(bDoDebug) {
+        std::cout << std::endl << "HPIFit::fit - prepare " << m_timings.prepareUsec << " us, dipfit " << m_timings.dipfitUsec << " us, total " << m_timings.totalUsec << " us" << (m_timings.warmStarted ? " (warm start)" : "") << std::endl;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void HPIFit::updateSensors(const MatrixXd& t_matProjectors, FiffInfo::SPtr pFiffInfo)
+{
+    if(m_pSensorFiffInfo == pFiffInfo.data()
+            && m_lSensorBads == pFiffInfo->bads
+            && m_matSensorProjectors.rows() == t_matProjectors.rows()
+            && m_matSensorProjectors.cols() == t_matProjectors.cols()
+            && m_matSensorProjectors == t_matProjectors) {
+        return;
+    }
+
+    int numCh = pFiffInfo->nchan;
+    QVector<int>& innerind = m_vInnerind;
+    innerind.clear();
+
+    // Get the indices of inner layer channels and exclude bad channels.
+    //TODO: Only supports babymeg and vectorview gradiometeres for hpi fitting.
+    for (int i = 0; i < numCh; ++i) {
+        if(pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_BABY_MAG ||
+                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T1 ||
+                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T2 ||
+                pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T3) {
+            // Check if the sensor is bad, if not append to innerind
+            if(!(pFiffInfo->bads.contains(pFiffInfo->ch_names.at(i)))) {
+                innerind.append(i);
+            }
+        }
+    }
+
+    //Create new projector based on the excluded channels, first exclude the rows then the columns
+    MatrixXd matProjectorsRows(innerind.size(),t_matProjectors.cols());
+    MatrixXd& matProjectorsInnerind = m_matProjectorsInnerind;
+    matProjectorsInnerind.resize(innerind.size(),innerind.size());
+
+    for (int i = 0; i < matProjectorsRows.rows(); ++i) {
+        matProjectorsRows.row(i) = t_matProjectors.row(innerind.at(i));
+    }
+
+    for (int i = 0; i < matProjectorsInnerind.cols(); ++i) {
+        matProjectorsInnerind.col(i) = matProjectorsRows.col(innerind.at(i));
+    }
+
+    //UTILSLIB::IOUtils::write_eigen_matrix(matProjectorsInnerind, "matProjectorsInnerind.txt");
+    //UTILSLIB::IOUtils::write_eigen_matrix(t_matProjectors, "t_matProjectors.txt");
+
+    // Initialize inner layer sensors
+    m_sensors.coilpos = Eigen::MatrixXd::Zero(innerind.size(),3);
+    m_sensors.coilori = Eigen::MatrixXd::Zero(innerind.size(),3);
+    m_sensors.tra = Eigen::MatrixXd::Identity(innerind.size(),innerind.size());
+
+    for(int i = 0; i < innerind.size(); i++) {
+        m_sensors.coilpos(i,0) = pFiffInfo->chs[innerind.at(i)].chpos.r0[0];
+        m_sensors.coilpos(i,1) = pFiffInfo->chs[innerind.at(i)].chpos.r0[1];
+        m_sensors.coilpos(i,2) = pFiffInfo->chs[innerind.at(i)].chpos.r0[2];
+        m_sensors.coilori(i,0) = pFiffInfo->chs[innerind.at(i)].chpos.ez[0];
+        m_sensors.coilori(i,1) = pFiffInfo->chs[innerind.at(i)].chpos.ez[1];
+        m_sensors.coilori(i,2) = pFiffInfo->chs[innerind.at(i)].chpos.ez[2];
+    }
+
+    m_pSensorFiffInfo = pFiffInfo.data();
+    m_lSensorBads = pFiffInfo->bads;
+    m_matSensorProjectors = t_matProjectors;
+
+    // The sensor setup changed, the previous fit is no valid seed anymore
+    m_bLastFitValid = false;
 }
 
 
 //*************************************************************************************************************
 
-CoilParam HPIFit::dipfit(struct CoilParam coil, struct SensorInfo sensors, const Eigen::MatrixXd& data, int numCoils, const Eigen::MatrixXd& t_matProjectors)
+CoilParam HPIFit::dipfit(struct CoilParam coil, const struct SensorInfo &sensors, const Eigen::MatrixXd& data, int numCoils, const Eigen::MatrixXd& t_matProjectors)
 {
     //Do this in conncurrent mode
     //Generate QList structure which can be handled by the QConcurrent framework
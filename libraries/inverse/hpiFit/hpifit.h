@@ -42,6 +42,7 @@
 //=============================================================================================================
 
 #include "../inverse_global.h"
+#include "hpifitdata.h"
 
 
 //*************************************************************************************************************
@@ -58,6 +59,8 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QVector>
+#include <QStringList>
 
 
 //*************************************************************************************************************
@@ -95,6 +98,16 @@ struct CoilParam {
     Eigen::VectorXd dpfitnumitr;
 };
 
+/**
+* The struct specifing the timings of the last HPI fit in micro seconds.
+*/
+struct HPIFitTimings {
+    qint64 prepareUsec;     /**< Sensor selection, projector and signal model preparation. */
+    qint64 dipfitUsec;      /**< Dipole fits of all coils. */
+    qint64 totalUsec;       /**< The complete fit. */
+    bool warmStarted;       /**< Whether the coils were seeded with the previous fit. */
+};
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -121,6 +134,56 @@ public:
     */
     explicit HPIFit();
 
+    //=========================================================================================================
+    /**
+    * Perform one HPI fit of a continuous fitting session. The inner layer sensor selection, the projector
+    * restricted to it and the pseudo inverse of the coil signal model are kept until the channels, bad channels or
+    * projectors change. If warm start is enabled, the coils are seeded with the positions of the previous fit
+    * instead of searching the sensor with the largest amplitude.
+    *
+    * @param[in] t_mat           Data to estimate the HPI positions from
+    * @param[in] t_matProjectors The projectors to apply. Bad channels are still included.
+    * @param[out] transDevHead   The final dev head transformation matrix
+    * @param[in] vFreqs          The frequencies for each coil.
+    * @param[out] vGof           The goodness of fit in mm for each fitted HPI coil.
+    * @param[out] fittedPointSet The final fitted positions in form of a digitizer set.
+    * @param[in] p_pFiffInfo     Associated Fiff Information.
+    * @param[in] bDoDebug        Print debug info to cmd line and write debug info to file.
+    * @param[in] sHPIResourceDir The path to the debug file which is to be written.
+    */
+    void fit(const Eigen::MatrixXd& t_mat,
+             const Eigen::MatrixXd& t_matProjectors,
+             FIFFLIB::FiffCoordTrans &transDevHead,
+             const QVector<int>& vFreqs,
+             QVector<double> &vGof,
+             FIFFLIB::FiffDigPointSet& fittedPointSet,
+             QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo,
+             bool bDoDebug = false,
+             const QString& sHPIResourceDir = QString("./HPIFittingDebug"));
+
+    //=========================================================================================================
+    /**
+    * Sets whether consecutive fits start from the previous coil positions.
+    *
+    * @param[in] bWarmStart     Whether to warm start.
+    * @param[in] dMaxGof        The previous fit is only used as seed if none of its coil errors exceeds this value (in m).
+    */
+    void setWarmStart(bool bWarmStart, double dMaxGof = 0.01);
+
+    //=========================================================================================================
+    /**
+    * Clears the cached sensor information and the previous fit.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Returns the timings of the last fit.
+    *
+    * @return the timings of the last fit.
+    */
+    inline const HPIFitTimings& lastTimings() const;
+
     //=========================================================================================================
     /**
     * Perform one single HPI fit.
@@ -158,7 +221,7 @@ protected:
     *
     * @return Returns the coil parameters.
     */
-    static CoilParam dipfit(struct CoilParam coil, struct SensorInfo sensors, const Eigen::MatrixXd &data, int numCoils, const Eigen::MatrixXd &t_matProjectors);
+    static CoilParam dipfit(struct CoilParam coil, const struct SensorInfo &sensors, const Eigen::MatrixXd &data, int numCoils, const Eigen::MatrixXd &t_matProjectors);
 
     //=========================================================================================================
     /**
@@ -171,7 +234,35 @@ protected:
     */
     static Eigen::Matrix4d computeTransformation(Eigen::MatrixXd NH, Eigen::MatrixXd BT);
 
+    //=========================================================================================================
+    /**
+    * Selects the good inner layer sensors and restricts the projectors to them, if not done yet for the given setup.
+    *
+    * @param[in] t_matProjectors The projectors to apply. Bad channels are still included.
+    * @param[in] pFiffInfo       Associated Fiff Information.
+    */
+    void updateSensors(const Eigen::MatrixXd& t_matProjectors, QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo);
+
     static QString         m_sHPIResourceDir;      /**< Hold the resource folder to store the debug information in. */
+
+    bool                m_bWarmStart;               /**< Whether to seed the coils with the previous fit. */
+    double              m_dMaxWarmStartGof;         /**< Maximal coil error (in m) of the previous fit which is still used as seed. */
+    bool                m_bLastFitValid;            /**< Whether the previous fit can be used as seed. */
+    Eigen::MatrixXd     m_matLastCoilPos;           /**< The coil positions of the previous fit. */
+
+    FIFFLIB::FiffInfo*  m_pSensorFiffInfo;          /**< The measurement info the cached sensors were selected from. */
+    QStringList         m_lSensorBads;              /**< The bad channels the cached sensors were selected with. */
+    Eigen::MatrixXd     m_matSensorProjectors;      /**< The projectors the cached sensors were selected with. */
+    QVector<int>        m_vInnerind;                /**< The good inner layer channel indices. */
+    SensorInfo          m_sensors;                  /**< The good inner layer sensors. */
+    Eigen::MatrixXd     m_matProjectorsInnerind;    /**< The projectors restricted to the good inner layer sensors. */
+
+    QVector<int>        m_vSignalFreqs;             /**< The coil frequencies of the cached signal model. */
+    int                 m_iSignalSamples;           /**< The number of samples of the cached signal model. */
+    double              m_dSignalSFreq;             /**< The sampling frequency of the cached signal model. */
+    Eigen::MatrixXd     m_matSimsigPinvT;           /**< The transposed pseudo inverse of the sine/cosine coil signal model. */
+
+    HPIFitTimings       m_timings;                  /**< The timings of the last fit. */
 };
 
 //*************************************************************************************************************
@@ -179,6 +270,11 @@ protected:
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+inline const HPIFitTimings& HPIFit::lastTimings() const
+{
+    return m_timings;
+}
+
 
 } //NAMESPACE
 
@@ -74,6 +74,17 @@ unix:!macx {
     QMAKE_LFLAGS    +=  -fopenmp
 }
 
+# CUDA
+contains(MNECPP_CONFIG, withCuda) {
+    DEFINES += MNE_USE_CUDA
+    CUDA_DIR = $$(CUDA_PATH)
+    isEmpty(CUDA_DIR): CUDA_DIR = /usr/local/cuda
+    INCLUDEPATH += $${CUDA_DIR}/include
+    win32: LIBS += -L$${CUDA_DIR}/lib/x64
+    else: LIBS += -L$${CUDA_DIR}/lib64
+    LIBS += -lcudart -lcublas
+}
+
 DESTDIR = $${MNE_LIBRARY_DIR}
 
 contains(MNECPP_CONFIG, static) {
@@ -86,7 +97,9 @@ else {
 
 SOURCES += \
     minimumNorm/minimumnorm.cpp \
+    minimumNorm/cuda/cudamatrixproduct.cpp \
     rapMusic/rapmusic.cpp \
+    rapMusic/rapmusickernel.cpp \
     rapMusic/pwlrapmusic.cpp \
     rapMusic/dipole.cpp \
     dipoleFit/dipole_fit.cpp \
@@ -107,7 +120,9 @@ HEADERS +=\
     inverse_global.h \
     IInverseAlgorithm.h \
     minimumNorm/minimumnorm.h \
+    minimumNorm/cuda/cudamatrixproduct.h \
     rapMusic/rapmusic.h \
+    rapMusic/rapmusickernel.h \
     rapMusic/pwlrapmusic.h \
     rapMusic/dipole.h \
     dipoleFit/analyze_types.h \
@@ -0,0 +1,282 @@
+//=============================================================================================================
+/**
+* @file     cudamatrixproduct.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    CudaMatrixProduct class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "cudamatrixproduct.h"
+
+#ifdef MNE_USE_CUDA
+#include <cuda_runtime.h>
+#include <cublas_v2.h>
+#endif
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace INVERSELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+#ifdef MNE_USE_CUDA
+namespace
+{
+
+bool reserveDevice(double** p_ppDev, qint64& p_iCapacity, qint64 p_iSize)
+{
+    if(*p_ppDev && p_iCapacity >= p_iSize)
+        return true;
+
+    if(*p_ppDev)
+        cudaFree(*p_ppDev);
+
+    *p_ppDev = NULL;
+    p_iCapacity = 0;
+
+    if(cudaMalloc((void**)p_ppDev, p_iSize * sizeof(double)) != cudaSuccess) {
+        *p_ppDev = NULL;
+        return false;
+    }
+
+    p_iCapacity = p_iSize;
+    return true;
+}
+
+}
+#endif
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+CudaMatrixProduct::CudaMatrixProduct()
+: m_pHandle(NULL)
+, m_pDevA(NULL)
+, m_pDevB(NULL)
+, m_pDevC(NULL)
+, m_iSizeB(0)
+, m_iSizeC(0)
+, m_iRows(0)
+, m_iCols(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+CudaMatrixProduct::~CudaMatrixProduct()
+{
+    release();
+}
+
+
+//*************************************************************************************************************
+
+bool CudaMatrixProduct::isAvailable()
+{
+#ifdef MNE_USE_CUDA
+    static int s_iDeviceCount = -1;
+    if(s_iDeviceCount < 0) {
+        if(cudaGetDeviceCount(&s_iDeviceCount) != cudaSuccess)
+            s_iDeviceCount = 0;
+    }
+
+    return s_iDeviceCount > 0;
+#else
+    return false;
+#endif
+}
+
+
+//*************************************************************************************************************
+
+bool CudaMatrixProduct::setMatrix(const MatrixXd& p_matA)
+{
+    QMutexLocker locker(&m_mutex);
+
+#ifdef MNE_USE_CUDA
+    if(!isAvailable())
+        return false;
+
+    if(!m_pHandle) {
+        cublasHandle_t handle;
+        if(cublasCreate(&handle) != CUBLAS_STATUS_SUCCESS) {
+            qWarning("CudaMatrixProduct::setMatrix - Could not create the cuBLAS handle.");
+            return false;
+        }
+        m_pHandle = handle;
+    }
+
+    if(m_pDevA) {
+        cudaFree(m_pDevA);
+        m_pDevA = NULL;
+    }
+
+    if(cudaMalloc((void**)&m_pDevA, p_matA.size() * sizeof(double)) != cudaSuccess) {
+        qWarning("CudaMatrixProduct::setMatrix - Not enough device memory for a %d x %d matrix.", (int)p_matA.rows(), (int)p_matA.cols());
+        m_pDevA = NULL;
+        return false;
+    }
+
+    if(cublasSetMatrix(p_matA.rows(), p_matA.cols(), sizeof(double), p_matA.data(), p_matA.rows(), m_pDevA, p_matA.rows()) != CUBLAS_STATUS_SUCCESS) {
+        cudaFree(m_pDevA);
+        m_pDevA = NULL;
+        return false;
+    }
+
+    m_iRows = p_matA.rows();
+    m_iCols = p_matA.cols();
+
+    return true;
+#else
+    Q_UNUSED(p_matA);
+    return false;
+#endif
+}
+
+
+//*************************************************************************************************************
+
+bool CudaMatrixProduct::multiply(const MatrixXd& p_matB, MatrixXd& p_matC)
+{
+    return gemm(p_matB, p_matC, false);
+}
+
+
+//*************************************************************************************************************
+
+bool CudaMatrixProduct::multiplyTransposed(const MatrixXd& p_matB, MatrixXd& p_matC)
+{
+    return gemm(p_matB, p_matC, true);
+}
+
+
+//*************************************************************************************************************
+
+void CudaMatrixProduct::release()
+{
+    QMutexLocker locker(&m_mutex);
+
+#ifdef MNE_USE_CUDA
+    if(m_pDevA)
+        cudaFree(m_pDevA);
+    if(m_pDevB)
+        cudaFree(m_pDevB);
+    if(m_pDevC)
+        cudaFree(m_pDevC);
+    if(m_pHandle)
+        cublasDestroy((cublasHandle_t)m_pHandle);
+#endif
+
+    m_pHandle = NULL;
+    m_pDevA = NULL;
+    m_pDevB = NULL;
+    m_pDevC = NULL;
+    m_iSizeB = 0;
+    m_iSizeC = 0;
+    m_iRows = 0;
+    m_iCols = 0;
+}
+
+
+//*************************************************************************************************************
+
+bool CudaMatrixProduct::gemm(const MatrixXd& p_matB, MatrixXd& p_matC, bool p_bTransposed)
+{
+    QMutexLocker locker(&m_mutex);
+
+#ifdef MNE_USE_CUDA
+    if(!m_pDevA)
+        return false;
+
+    //C = A * B (m x n, inner k) or C = B^T * A (m x n, inner k)
+    int k = p_bTransposed ? m_iRows : m_iCols;
+    if(p_matB.rows() != k)
+        return false;
+
+    int m = p_bTransposed ? p_matB.cols() : m_iRows;
+    int n = p_bTransposed ? m_iCols : p_matB.cols();
+
+    if(!reserveDevice(&m_pDevB, m_iSizeB, p_matB.size()) || !reserveDevice(&m_pDevC, m_iSizeC, (qint64)m * n))
+        return false;
+
+    cublasHandle_t handle = (cublasHandle_t)m_pHandle;
+
+    if(cublasSetMatrix(p_matB.rows(), p_matB.cols(), sizeof(double), p_matB.data(), p_matB.rows(), m_pDevB, p_matB.rows()) != CUBLAS_STATUS_SUCCESS)
+        return false;
+
+    const double dAlpha = 1.0;
+    const double dBeta = 0.0;
+    cublasStatus_t status;
+
+    if(p_bTransposed)
+        status = cublasDgemm(handle, CUBLAS_OP_T, CUBLAS_OP_N, m, n, k, &dAlpha, m_pDevB, p_matB.rows(), m_pDevA, m_iRows, &dBeta, m_pDevC, m);
+    else
+        status = cublasDgemm(handle, CUBLAS_OP_N, CUBLAS_OP_N, m, n, k, &dAlpha, m_pDevA, m_iRows, m_pDevB, p_matB.rows(), &dBeta, m_pDevC, m);
+
+    if(status != CUBLAS_STATUS_SUCCESS)
+        return false;
+
+    p_matC.resize(m, n);
+
+    return cublasGetMatrix(m, n, sizeof(double), m_pDevC, m, p_matC.data(), m) == CUBLAS_STATUS_SUCCESS;
+#else
+    Q_UNUSED(p_matB);
+    Q_UNUSED(p_matC);
+    Q_UNUSED(p_bTransposed);
+    return false;
+#endif
+}
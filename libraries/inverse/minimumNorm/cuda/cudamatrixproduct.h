@@ -0,0 +1,187 @@
+//=============================================================================================================
+/**
+* @file     cudamatrixproduct.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    CudaMatrixProduct class declaration.
+*
+*/
+
+#ifndef CUDAMATRIXPRODUCT_H
+#define CUDAMATRIXPRODUCT_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../../inverse_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QMutex>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE INVERSELIB
+//=============================================================================================================
+
+namespace INVERSELIB
+{
+
+//=============================================================================================================
+/**
+* Keeps one matrix A resident in GPU memory and multiplies it with host matrices through cuBLAS. This is the
+* GPU backend of the inverse algorithms: MinimumNorm keeps the imaging kernel on the device, RapMusic the lead
+* field. The backend is only compiled in with qmake MNECPP_CONFIG+=withCuda. Otherwise, or when no CUDA device is
+* present, isAvailable() returns false and all products fail, so callers fall back to their CPU path.
+*
+* @brief GPU matrix product with a device resident operand.
+*/
+class INVERSESHARED_EXPORT CudaMatrixProduct
+{
+public:
+    typedef QSharedPointer<CudaMatrixProduct> SPtr;             /**< Shared pointer type for CudaMatrixProduct. */
+    typedef QSharedPointer<const CudaMatrixProduct> ConstSPtr;  /**< Const shared pointer type for CudaMatrixProduct. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty CudaMatrixProduct.
+    */
+    CudaMatrixProduct();
+
+    //=========================================================================================================
+    /**
+    * Releases the device memory.
+    */
+    ~CudaMatrixProduct();
+
+    //=========================================================================================================
+    /**
+    * Returns whether the library was built with CUDA support and a CUDA device is present.
+    *
+    * @return true if the GPU backend can be used.
+    */
+    static bool isAvailable();
+
+    //=========================================================================================================
+    /**
+    * Uploads the resident matrix A.
+    *
+    * @param[in] p_matA     The matrix to keep on the device.
+    *
+    * @return true if successful, false otherwise.
+    */
+    bool setMatrix(const Eigen::MatrixXd& p_matA);
+
+    //=========================================================================================================
+    /**
+    * Returns whether a resident matrix was uploaded.
+    *
+    * @return true if the products can be computed.
+    */
+    inline bool isReady() const;
+
+    //=========================================================================================================
+    /**
+    * Computes C = A * B.
+    *
+    * @param[in] p_matB     The right operand, A.cols() x n.
+    * @param[out] p_matC    The product, A.rows() x n.
+    *
+    * @return true if successful, false otherwise.
+    */
+    bool multiply(const Eigen::MatrixXd& p_matB, Eigen::MatrixXd& p_matC);
+
+    //=========================================================================================================
+    /**
+    * Computes C = B^T * A.
+    *
+    * @param[in] p_matB     The left operand before transposition, A.rows() x n.
+    * @param[out] p_matC    The product, n x A.cols().
+    *
+    * @return true if successful, false otherwise.
+    */
+    bool multiplyTransposed(const Eigen::MatrixXd& p_matB, Eigen::MatrixXd& p_matC);
+
+    //=========================================================================================================
+    /**
+    * Frees all device memory.
+    */
+    void release();
+
+private:
+    CudaMatrixProduct(const CudaMatrixProduct&);
+    CudaMatrixProduct& operator=(const CudaMatrixProduct&);
+
+    //=========================================================================================================
+    /**
+    * Computes the product with the operand layout given, see multiply and multiplyTransposed.
+    */
+    bool gemm(const Eigen::MatrixXd& p_matB, Eigen::MatrixXd& p_matC, bool p_bTransposed);
+
+    QMutex      m_mutex;        /**< Serializes the use of the device buffers. */
+    void*       m_pHandle;      /**< The cuBLAS handle. */
+    double*     m_pDevA;        /**< The resident matrix on the device. */
+    double*     m_pDevB;        /**< Device buffer of the host operand. */
+    double*     m_pDevC;        /**< Device buffer of the product. */
+    qint64      m_iSizeB;       /**< Capacity of m_pDevB in elements. */
+    qint64      m_iSizeC;       /**< Capacity of m_pDevC in elements. */
+    int         m_iRows;        /**< Rows of the resident matrix. */
+    int         m_iCols;        /**< Columns of the resident matrix. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool CudaMatrixProduct::isReady() const
+{
+    return m_pDevA != NULL;
+}
+
+} //NAMESPACE
+
+#endif // CUDAMATRIXPRODUCT_H
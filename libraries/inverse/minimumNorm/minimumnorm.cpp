@@ -42,6 +42,17 @@
 
 #include <mne/mne_sourceestimate.h>
 #include <fiff/fiff_evoked.h>
+#include <utils/tracer.h>
+#include <utils/linalg.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMap>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -50,6 +61,7 @@
 //=============================================================================================================
 
 #include <iostream>
+#include <cmath>
 
 
 //*************************************************************************************************************
@@ -70,6 +82,59 @@ using namespace MNELIB;
 using namespace INVERSELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Applies the kernel in blocks of sources. Each block of the product is combined over the orientations and
+* scaled by the noise normalization while it is in cache, the result goes directly to the rows of sol.
+*/
+template<typename T>
+void applyKernelFused(const Matrix<T, Dynamic, Dynamic> &matKernel, const Matrix<T, Dynamic, Dynamic> &matData, bool bCombineXyz, const VectorXd &vecNoiseNorm, MatrixXd &sol)
+{
+    const qint32 iBlockSources = 64;
+    const qint32 nOri = bCombineXyz ? 3 : 1;
+    const qint32 nSources = matKernel.rows() / nOri;
+    const qint32 nTimes = matData.cols();
+    const bool bNoiseNorm = vecNoiseNorm.size() == nSources;
+
+    sol.resize(nSources, nTimes);
+
+    Matrix<T, Dynamic, Dynamic> matBlock;
+
+    for(qint32 iStart = 0; iStart < nSources; iStart += iBlockSources) {
+        qint32 nBlock = qMin(iBlockSources, nSources - iStart);
+
+        matBlock.noalias() = matKernel.middleRows(iStart * nOri, nBlock * nOri) * matData;
+
+        for(qint32 t = 0; t < nTimes; ++t) {
+            const T* pBlock = matBlock.col(t).data();
+            double* pSol = sol.col(t).data() + iStart;
+
+            for(qint32 i = 0; i < nBlock; ++i) {
+                double dValue;
+                if(bCombineXyz) {
+                    const T* pXyz = pBlock + 3 * i;
+                    dValue = std::sqrt((double)(pXyz[0] * pXyz[0] + pXyz[1] * pXyz[1] + pXyz[2] * pXyz[2]));
+                } else {
+                    dValue = pBlock[i];
+                }
+
+                pSol[i] = bNoiseNorm ? dValue * vecNoiseNorm[iStart + i] : dValue;
+            }
+        }
+    }
+}
+
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -77,7 +142,13 @@ using namespace INVERSELIB;
 
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, const QString method)
 : m_inverseOperator(p_inverseOperator)
+, m_bFused(false)
+, m_bSinglePrecision(false)
+, m_bFactored(false)
+, m_bUseGpu(false)
 , inverseSetup(false)
+, m_bPickNormal(false)
+, m_iSetupCacheSize(4)
 {
     this->setRegularization(lambda);
     this->setMethod(method);
@@ -87,7 +158,13 @@ MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lamb
 
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, bool dSPM, bool sLORETA)
 : m_inverseOperator(p_inverseOperator)
+, m_bFused(false)
+, m_bSinglePrecision(false)
+, m_bFactored(false)
+, m_bUseGpu(false)
 , inverseSetup(false)
+, m_bPickNormal(false)
+, m_iSetupCacheSize(4)
 {
     this->setRegularization(lambda);
     this->setMethod(dSPM, sLORETA);
@@ -195,43 +272,82 @@ MNESourceEstimate MinimumNorm::calculateInverse(const FiffEvoked &p_fiffEvoked,
 
 MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin, float tstep) const
 {
+    MNE_TRACE_SCOPE("MinimumNorm::calculateInverse", "inverse");
+
     if(!inverseSetup)
     {
         qWarning("Inverse not setup -> call doInverseSetup first!");
         return MNESourceEstimate();
     }
 
-    MatrixXd sol = K * data; //apply imaging kernel
+    //
+    //   With a factored kernel the data are transformed first and the leads take the place of the kernel.
+    //   The GPU holds the dense kernel only, all products with it stay on the device
+    //
+    const bool bGpu = m_pGpuKernel && m_pGpuKernel->isReady();
+    const bool bFactored = !bGpu && useFactoredKernel(data.cols());
+
+    MatrixXd matTransData;
+    if(bFactored)
+        matTransData = m_matTrans * data;
+    else
+        formKernel();
+
+    const MatrixXd& matKernel = bFactored ? m_matLeads : K;
+    const MatrixXd& matData = bFactored ? matTransData : data;
 
-    if (inv.source_ori == FIFFV_MNE_FREE_ORI)
+    if(m_bFused && !bGpu)
     {
-        printf("combining the current components...");
-        MatrixXd sol1(sol.rows()/3,sol.cols());
-        for(qint32 i = 0; i < sol.cols(); ++i)
-        {
-            VectorXd* tmp = MNEMath::combine_xyz(sol.block(0,i,sol.rows(),1));
-            sol1.block(0,i,sol.rows()/3,1) = tmp->cwiseSqrt();
-            delete tmp;
+        MNESourceEstimate stc;
+
+        bool bCombineXyz = inv.source_ori == FIFFV_MNE_FREE_ORI && !m_bPickNormal;
+
+        if(m_bSinglePrecision)
+            applyKernelFused<float>(bFactored ? m_matLeadsFloat : m_matKernelFloat, matData.cast<float>(), bCombineXyz, m_vecNoiseNorm, stc.data);
+        else
+            applyKernelFused<double>(matKernel, matData, bCombineXyz, m_vecNoiseNorm, stc.data);
+
+        stc.vertices = VectorXi(vertno[0].size() + vertno[1].size());
+        stc.vertices << vertno[0], vertno[1];
+        stc.tmin = tmin;
+        stc.tstep = tstep;
+        stc.times = RowVectorXf(stc.data.cols());
+        if(stc.times.size() > 0) {
+            stc.times[0] = tmin;
+            for(qint32 i = 1; i < stc.times.size(); ++i)
+                stc.times[i] = stc.times[i-1] + tstep;
         }
-        sol.resize(sol1.rows(),sol1.cols());
-        sol = sol1;
+
+        return stc;
+    }
+
+    MatrixXd sol;
+    if(!bGpu || !m_pGpuKernel->multiply(matData, sol))
+        UTILSLIB::LinAlg::multiply(matKernel, matData, sol); //apply imaging kernel
+
+    if (inv.source_ori == FIFFV_MNE_FREE_ORI && !m_bPickNormal)
+    {
+        printf("combining the current components...");
+        MatrixXd sol1;
+        MNEMath::combine_xyz(sol, sol1);
+        sol = sol1.cwiseSqrt();
     }
 
     if (m_bdSPM)
     {
         printf("(dSPM)...");
-        sol = inv.noisenorm*sol;
+        sol = noise_norm*sol;
     }
     else if (m_bsLORETA)
     {
         printf("(sLORETA)...");
-        sol = inv.noisenorm*sol;
+        sol = noise_norm*sol;
     }
     printf("[done]\n");
 
     //Results
-    VectorXi p_vecVertices(inv.src[0].vertno.size() + inv.src[1].vertno.size());
-    p_vecVertices << inv.src[0].vertno, inv.src[1].vertno;
+    VectorXi p_vecVertices(vertno[0].size() + vertno[1].size());
+    p_vecVertices << vertno[0], vertno[1];
 
 //    VectorXi p_vecVertices();
 //    for(qint32 h = 0; h < inv.src.size(); ++h)
@@ -242,19 +358,127 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
 }
 
 
+//*************************************************************************************************************
+
+QList<MNESourceEstimate> MinimumNorm::calculateInverse(const FiffEvokedSet &p_fiffEvokedSet, bool pick_normal)
+{
+    const QList<FiffEvoked>& evoked = p_fiffEvokedSet.evoked;
+    QVector<MNESourceEstimate> stcs(evoked.size());
+
+    //
+    //   Group the responses by the number of averages, each group shares one setup
+    //
+    QMap<qint32, QList<qint32> > mapNave;
+    for(qint32 i = 0; i < evoked.size(); ++i)
+    {
+        if(!m_inverseOperator.check_ch_names(evoked[i].info))
+        {
+            qWarning("MinimumNorm::calculateInverse - Channel name check failed for evoked response %d.", i);
+            continue;
+        }
+        mapNave[evoked[i].nave].append(i);
+    }
+
+    QMap<qint32, QList<qint32> >::const_iterator it;
+    for(it = mapNave.constBegin(); it != mapNave.constEnd(); ++it)
+    {
+        doInverseSetup(it.key(), pick_normal);
+
+        const QList<qint32>& idx = it.value();
+        QList<FiffEvoked> picked;
+        for(qint32 i = 0; i < idx.size(); ++i)
+            picked.append(evoked[idx[i]].pick_channels(inv.noise_cov->names));
+
+        printf("Computing %d inverse solutions with nave = %d\n", picked.size(), it.key());
+
+        //
+        //   The kernel has to be formed before the threads share it, the GPU kernel is not shared
+        //
+        for(qint32 i = 0; i < picked.size(); ++i)
+        {
+            if(!useFactoredKernel(picked[i].data.cols()))
+            {
+                formKernel();
+                break;
+            }
+        }
+        const bool bGpu = m_pGpuKernel && m_pGpuKernel->isReady();
+        MNESourceEstimate* pStcs = stcs.data();
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic) if(!bGpu)
+        #endif
+        for(qint32 i = 0; i < picked.size(); ++i)
+        {
+            const FiffEvoked& t_fiffEvoked = picked.at(i);
+            float tmin = ((float)t_fiffEvoked.first) / t_fiffEvoked.info.sfreq;
+            float tstep = 1/t_fiffEvoked.info.sfreq;
+
+            pStcs[idx.at(i)] = calculateInverse(t_fiffEvoked.data, tmin, tstep);
+        }
+    }
+
+    return stcs.toList();
+}
+
+
 //*************************************************************************************************************
 
 void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
 {
+    //
+    //   Reuse a setup prepared before with the same parameters
+    //
+    if(restoreSetup(nave, pick_normal))
+    {
+        printf("Reusing the inverse setup for nave = %d\n", nave);
+        inverseSetup = true;
+        return;
+    }
+
     //
     //   Set up the inverse according to the parameters
     //
     inv = m_inverseOperator.prepare_inverse_operator(nave, m_fLambda, m_bdSPM, m_bsLORETA);
 
     printf("Computing inverse...");
-    inv.assemble_kernel(label, m_sMethod, pick_normal, K, noise_norm, vertno);
+    if(m_bFactored)
+    {
+        inv.assemble_kernel_factored(m_qListLabels, m_sMethod, pick_normal, m_matLeads, m_matTrans, noise_norm, vertno);
+        K.resize(0,0);
+
+        std::cout << "K " << m_matLeads.rows() << " x " << m_matLeads.cols() << " x " << m_matTrans.cols() << " (factored)" << std::endl;
+    }
+    else
+    {
+        inv.assemble_kernel(m_qListLabels, m_sMethod, pick_normal, K, noise_norm, vertno);
+        m_matLeads.resize(0,0);
+        m_matTrans.resize(0,0);
+
+        std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
+    }
+
+    m_bPickNormal = pick_normal;
+
+    //Keep what the fused kernel application needs
+    m_vecNoiseNorm = (m_bdSPM || m_bsLORETA) ? VectorXd(noise_norm.diagonal()) : VectorXd();
+    m_matKernelFloat = m_bSinglePrecision && K.size() > 0 ? MatrixXf(K.cast<float>()) : MatrixXf();
+    m_matLeadsFloat = m_bSinglePrecision ? MatrixXf(m_matLeads.cast<float>()) : MatrixXf();
+
+    m_pGpuKernel.clear();
+    if(m_bUseGpu && CudaMatrixProduct::isAvailable())
+    {
+        formKernel();
 
-    std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
+        m_pGpuKernel = CudaMatrixProduct::SPtr(new CudaMatrixProduct());
+        if(!m_pGpuKernel->setMatrix(K))
+        {
+            qWarning("MinimumNorm::doInverseSetup - Could not upload the kernel to the GPU, using the CPU.");
+            m_pGpuKernel.clear();
+        }
+    }
+
+    storeSetup(nave);
 
     inverseSetup = true;
 }
@@ -327,3 +551,183 @@ void MinimumNorm::setRegularization(float lambda)
 {
     m_fLambda = lambda;
 }
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::setKernelMode(bool bFused, bool bSinglePrecision)
+{
+    m_bFused = bFused;
+    m_bSinglePrecision = bFused && bSinglePrecision;
+
+    if(inverseSetup)
+    {
+        m_matKernelFloat = m_bSinglePrecision && K.size() > 0 ? MatrixXf(K.cast<float>()) : MatrixXf();
+        m_matLeadsFloat = m_bSinglePrecision ? MatrixXf(m_matLeads.cast<float>()) : MatrixXf();
+    }
+
+    //The cached setups hold the float copies of the former mode
+    clearSetupCache();
+}
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::setKernelFactored(bool bFactored)
+{
+    m_bFactored = bFactored;
+    clearSetupCache();
+}
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::setUseGpu(bool bUseGpu)
+{
+    m_bUseGpu = bUseGpu;
+    clearSetupCache();
+}
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::setLabels(const QList<Label>& qListLabels)
+{
+    m_qListLabels = qListLabels;
+    clearSetupCache();
+}
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::setSetupCacheSize(qint32 iSize)
+{
+    m_iSetupCacheSize = iSize > 0 ? iSize : 0;
+
+    while(m_qListSetupCache.size() > m_iSetupCacheSize)
+        m_qListSetupCache.removeLast();
+}
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::clearSetupCache()
+{
+    m_qListSetupCache.clear();
+}
+
+
+//*************************************************************************************************************
+
+bool MinimumNorm::setTfrProjection(UTILSLIB::WaveletTfr &tfr) const
+{
+    if(!inverseSetup)
+    {
+        qWarning("MinimumNorm::setTfrProjection - Inverse not setup -> call doInverseSetup first!");
+        return false;
+    }
+
+    formKernel();
+
+    bool bCombineXyz = inv.source_ori == FIFFV_MNE_FREE_ORI && !m_bPickNormal;
+    tfr.setProjection(K, bCombineXyz ? 3 : 1, m_vecNoiseNorm);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MinimumNorm::useFactoredKernel(qint32 nTimes) const
+{
+    if(m_matLeads.size() == 0)
+        return false;
+
+    //Operation counts of both paths, forming the dense kernel is charged to the block which needs it first
+    double nSources = m_matLeads.rows();
+    double nRank = m_matLeads.cols();
+    double nChannels = m_matTrans.cols();
+
+    double dFactored = nRank * (nChannels + nSources) * nTimes;
+    double dDense = nSources * nChannels * nTimes;
+    if(K.size() == 0)
+        dDense += nSources * nRank * nChannels;
+
+    return dFactored <= dDense;
+}
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::formKernel() const
+{
+    if(K.size() > 0 || m_matLeads.size() == 0)
+        return;
+
+    K = m_matLeads * m_matTrans;
+
+    if(m_bSinglePrecision)
+        m_matKernelFloat = K.cast<float>();
+}
+
+
+//*************************************************************************************************************
+
+bool MinimumNorm::restoreSetup(qint32 nave, bool pick_normal)
+{
+    for(qint32 i = 0; i < m_qListSetupCache.size(); ++i)
+    {
+        const InverseSetup& setup = m_qListSetupCache[i];
+
+        if(setup.nave != nave || setup.method != m_sMethod || setup.lambda != m_fLambda || setup.pickNormal != pick_normal)
+            continue;
+
+        inv = setup.inv;
+        noise_norm = setup.noise_norm;
+        vertno = setup.vertno;
+        K = setup.K;
+        m_matKernelFloat = setup.matKernelFloat;
+        m_matLeads = setup.matLeads;
+        m_matTrans = setup.matTrans;
+        m_matLeadsFloat = setup.matLeadsFloat;
+        m_vecNoiseNorm = setup.vecNoiseNorm;
+        m_pGpuKernel = setup.pGpuKernel;
+        m_bPickNormal = pick_normal;
+
+        m_qListSetupCache.move(i, 0);
+
+        return true;
+    }
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::storeSetup(qint32 nave)
+{
+    if(m_iSetupCacheSize <= 0)
+        return;
+
+    InverseSetup setup;
+    setup.nave = nave;
+    setup.method = m_sMethod;
+    setup.lambda = m_fLambda;
+    setup.pickNormal = m_bPickNormal;
+    setup.inv = inv;
+    setup.noise_norm = noise_norm;
+    setup.vertno = vertno;
+    setup.K = K;
+    setup.matKernelFloat = m_matKernelFloat;
+    setup.matLeads = m_matLeads;
+    setup.matTrans = m_matTrans;
+    setup.matLeadsFloat = m_matLeadsFloat;
+    setup.vecNoiseNorm = m_vecNoiseNorm;
+    setup.pGpuKernel = m_pGpuKernel;
+
+    m_qListSetupCache.prepend(setup);
+
+    while(m_qListSetupCache.size() > m_iSetupCacheSize)
+        m_qListSetupCache.removeLast();
+}
@@ -43,11 +43,15 @@
 
 #include "../inverse_global.h"
 #include "../IInverseAlgorithm.h"
+#include "cuda/cudamatrixproduct.h"
 
 #include <mne/mne_inverse_operator.h>
+#include <fiff/fiff_evoked_set.h>
 #include <fs/label.h>
+#include <utils/wavelettfr.h>
 
 #include <QSharedPointer>
+#include <QList>
 
 
 //*************************************************************************************************************
@@ -127,6 +131,21 @@ public:
 
     virtual MNESourceEstimate calculateInverse(const MatrixXd &data, float tmin, float tstep) const;
 
+    //=========================================================================================================
+    /**
+    * Computes the inverse solutions of all evoked responses of a set. The inverse operator is prepared once per
+    * distinct number of averages (the prepared setups are cached, see setSetupCacheSize) and the kernel is applied
+    * to the responses sharing it in parallel.
+    *
+    * @param[in] p_fiffEvokedSet    Evoked data sets.
+    * @param[in] pick_normal        If True, rather than pooling the orientations by taking the norm, only the
+    *                               radial component is kept. This is only applied when working with loose orientations.
+    *
+    * @return the calculated source estimates in the order of p_fiffEvokedSet.evoked, empty ones for responses
+    *         whose channels do not match the inverse operator
+    */
+    QList<MNESourceEstimate> calculateInverse(const FiffEvokedSet &p_fiffEvokedSet, bool pick_normal = false);
+
     virtual void doInverseSetup(qint32 nave, bool pick_normal = false);
 
 
@@ -167,21 +186,164 @@ public:
     */
     void setRegularization(float lambda);
 
+    //=========================================================================================================
+    /**
+    * Selects how calculateInverse(const MatrixXd&, ...) applies the imaging kernel. The fused mode multiplies the
+    * kernel with the data in blocks of sources and combines the orientations and applies the dSPM/sLORETA noise
+    * normalization while each block is still in cache, writing directly into the source estimate. In single
+    * precision the fused mode uses a float copy of the kernel, which halves the memory traffic of the product.
+    *
+    * @param[in] bFused             Use the fused kernel application. Default is false.
+    * @param[in] bSinglePrecision   Apply a float32 copy of the kernel, only used in fused mode. Default is false.
+    */
+    void setKernelMode(bool bFused, bool bSinglePrecision = false);
+
+    //=========================================================================================================
+    /**
+    * Keeps the imaging kernel factored into the weighted eigen leads and the data transformation, see
+    * MNEInverseOperator::assemble_kernel_factored. calculateInverse then picks per data block whichever of the
+    * factored product and the dense kernel needs fewer operations. The dense kernel is only formed once a block
+    * is long enough to amortize it. Takes effect with the next doInverseSetup.
+    *
+    * @param[in] bFactored  Keep the kernel factored. Default is false.
+    */
+    void setKernelFactored(bool bFactored);
+
+    //=========================================================================================================
+    /**
+    * Applies the imaging kernel on the GPU, see CudaMatrixProduct. The dense kernel is uploaded once by
+    * doInverseSetup and stays resident, so each block only transfers its data and the solution. Without a CUDA
+    * build or device, or if the upload fails, the CPU path is used. Takes effect with the next doInverseSetup.
+    *
+    * @param[in] bUseGpu    Apply the kernel on the GPU. Default is false.
+    */
+    void setUseGpu(bool bUseGpu);
+
+    //=========================================================================================================
+    /**
+    * Restricts the imaging kernel to the sources covered by the labels, see MNEInverseOperator::assemble_kernel.
+    * The regularization stays the one of the whole source space, so the estimates of the selected sources are
+    * unchanged while the cost of each block scales with the number of selected sources. The source estimates
+    * only hold the selected vertices. Takes effect with the next doInverseSetup.
+    *
+    * @param[in] qListLabels    The labels, the whole source space if empty. Default is empty.
+    */
+    void setLabels(const QList<Label>& qListLabels);
+
+    //=========================================================================================================
+    /**
+    * Sets how many prepared setups doInverseSetup keeps. They are keyed by the number of averages, the method,
+    * the regularization and pick_normal, so repeated setups with the same parameters skip the preparation of
+    * the inverse operator and the kernel assembly. Each setup holds its own kernel.
+    *
+    * @param[in] iSize  Maximal number of cached setups, 0 disables the cache. Default is 4.
+    */
+    void setSetupCacheSize(qint32 iSize);
+
+    //=========================================================================================================
+    /**
+    * Drops all cached setups.
+    */
+    void clearSetupCache();
+
+    //=========================================================================================================
+    /**
+    * Sets the imaging kernel of the current setup as the projection of a time-frequency transform, with the
+    * orientations combined and the noise normalization applied as calculateInverse does. The power of the epochs
+    * added to the transform is then the induced power of the sources. Requires doInverseSetup.
+    *
+    * @param[in] tfr    The time-frequency transform.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool setTfrProjection(UTILSLIB::WaveletTfr &tfr) const;
+
     inline MatrixXd& getKernel();
 
 private:
+    //=========================================================================================================
+    /**
+    * Decides whether a data block is applied with the factored kernel.
+    *
+    * @param[in] nTimes     Number of samples of the block.
+    *
+    * @return true if the factored product needs fewer operations.
+    */
+    bool useFactoredKernel(qint32 nTimes) const;
+
+    //=========================================================================================================
+    /**
+    * Forms the dense imaging kernel from its factors, if not done yet.
+    */
+    void formKernel() const;
+
+    //=========================================================================================================
+    /**
+    * A prepared setup as restored by doInverseSetup.
+    */
+    struct InverseSetup
+    {
+        qint32 nave;                            /**< Number of averages */
+        QString method;                         /**< Method */
+        float lambda;                           /**< Regularization parameter */
+        bool pickNormal;                        /**< Whether the kernel was restricted to the normal components */
+        MNEInverseOperator inv;                 /**< The setup inverse operator */
+        SparseMatrix<double> noise_norm;        /**< The noise normalization */
+        QList<VectorXi> vertno;                 /**< The vertices numbers */
+        MatrixXd K;                             /**< Imaging kernel */
+        MatrixXf matKernelFloat;                /**< Float32 copy of the imaging kernel */
+        MatrixXd matLeads;                      /**< Weighted eigen leads of the factored kernel */
+        MatrixXd matTrans;                      /**< Data transformation of the factored kernel */
+        MatrixXf matLeadsFloat;                 /**< Float32 copy of the weighted eigen leads */
+        VectorXd vecNoiseNorm;                  /**< Diagonal of the noise normalization */
+        CudaMatrixProduct::SPtr pGpuKernel;     /**< The imaging kernel resident on the GPU */
+    };
+
+    //=========================================================================================================
+    /**
+    * Restores a cached setup with the current parameters.
+    *
+    * @param[in] nave           Number of averages.
+    * @param[in] pick_normal    Restrict to the normal components?
+    *
+    * @return true if a cached setup was found.
+    */
+    bool restoreSetup(qint32 nave, bool pick_normal);
+
+    //=========================================================================================================
+    /**
+    * Adds the current setup to the cache, dropping the least recently used one if the cache is full.
+    *
+    * @param[in] nave           Number of averages.
+    */
+    void storeSetup(qint32 nave);
+
     MNEInverseOperator m_inverseOperator;   /**< The inverse operator */
     float m_fLambda;                        /**< Regularization parameter */
     QString m_sMethod;                      /**< Selected method */
     bool m_bsLORETA;                        /**< Do sLORETA method */
     bool m_bdSPM;                           /**< Do dSPM method */
+    bool m_bFused;                          /**< Apply the kernel fused with orientation combination and noise normalization */
+    bool m_bSinglePrecision;                /**< Apply the float32 copy of the kernel in fused mode */
+    bool m_bFactored;                       /**< Keep the kernel factored into leads and trans */
+    bool m_bUseGpu;                         /**< Apply the kernel on the GPU */
 
     bool inverseSetup;                      /**< Inverse Setup Calcluated */
     MNEInverseOperator inv;                 /**< The setup inverse operator */
     SparseMatrix<double> noise_norm;        /**< The noise normalization */
     QList<VectorXi> vertno;                 /**< The vertices numbers */
-    Label label;                            /**< The corresponding labels */
-    MatrixXd K;                             /**< Imaging kernel */
+    QList<Label> m_qListLabels;             /**< The labels the kernel is restricted to, all sources if empty */
+    mutable MatrixXd K;                     /**< Imaging kernel, formed on demand in factored mode */
+    mutable MatrixXf m_matKernelFloat;      /**< Float32 copy of the imaging kernel, only set in single precision mode */
+    MatrixXd m_matLeads;                    /**< Weighted eigen leads of the factored kernel */
+    MatrixXd m_matTrans;                    /**< Data transformation of the factored kernel */
+    MatrixXf m_matLeadsFloat;               /**< Float32 copy of the weighted eigen leads, only set in single precision mode */
+    VectorXd m_vecNoiseNorm;                /**< Diagonal of the noise normalization, empty for MNE */
+    bool m_bPickNormal;                     /**< Whether the kernel was restricted to the normal components */
+    CudaMatrixProduct::SPtr m_pGpuKernel;   /**< The imaging kernel resident on the GPU, only set in GPU mode */
+
+    QList<InverseSetup> m_qListSetupCache;  /**< Prepared setups, the most recently used first */
+    qint32 m_iSetupCacheSize;               /**< Maximal number of cached setups */
 
 };
 
@@ -192,6 +354,7 @@ private:
 
 inline MatrixXd& MinimumNorm::getKernel()
 {
+    formKernel();
     return K;
 }
 
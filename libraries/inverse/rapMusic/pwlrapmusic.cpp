@@ -39,6 +39,13 @@
 
 #include "pwlrapmusic.h"
 
+#include <utils/kmeans.h>
+
+#include <cmath>
+
+#include <QVector>
+#include <QPair>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -50,6 +57,8 @@
 //=============================================================================================================
 
 using namespace INVERSELIB;
+using namespace UTILSLIB;
+using namespace Eigen;
 
 
 //*************************************************************************************************************
@@ -59,6 +68,8 @@ using namespace INVERSELIB;
 
 PwlRapMusic::PwlRapMusic()
 : RapMusic()
+, m_iNumCandidates(8)
+, m_iHierarchyGridPoints(0)
 {
 }
 
@@ -67,6 +78,8 @@ PwlRapMusic::PwlRapMusic()
 
 PwlRapMusic::PwlRapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double p_dThr)
 : RapMusic(p_pFwd, p_bSparsed, p_iN, p_dThr)
+, m_iNumCandidates(8)
+, m_iHierarchyGridPoints(0)
 {
     //Init
     init(p_pFwd, p_bSparsed, p_iN, p_dThr);
@@ -181,12 +194,19 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
     //new Version: Calculate projection before
     MatrixXT t_matProj_LeadField(m_ForwardSolution.sol->data.rows(), m_ForwardSolution.sol->data.cols());
 
+    //Blocked search: without the GPU the projected lead field is kept and updated with each found source
+    const bool t_bBlocked = m_bBlockedSearch || m_bUseGpu;
+    const bool t_bIncremental = t_bBlocked && !m_pGpuLeadField;
+    if(t_bIncremental)
+        t_matProj_LeadField = m_ForwardSolution.sol->data;
+
     for(int r = 0; r < t_iMaxSearch ; ++r)
     {
         t_matProj_Phi_s = t_matOrthProj*(*t_pMatPhi_s);
 
         //new Version: Calculating Projection before
-        t_matProj_LeadField = t_matOrthProj * m_ForwardSolution.sol->data;//Subtract the found sources from the current found source
+        if(!t_bBlocked)
+            t_matProj_LeadField = t_matOrthProj * m_ForwardSolution.sol->data;//Subtract the found sources from the current found source
 
         //###First Option###
         //Step 1: lt. Mosher 1998 -> Maybe tmp_Proj_Phi_S is already orthogonal -> so no SVD needed -> U_B = tmp_Proj_Phi_S;
@@ -194,6 +214,14 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
         MatrixXT t_matU_B;
         useFullRank(t_svdProj_Phi_S.matrixU(), t_svdProj_Phi_S.singularValues().asDiagonal(), t_matU_B);
 
+        //Blocked search: gain blocks of all grid points, formed once per iteration
+        MatrixXT t_matStacked;
+        MatrixXT t_matGramDiag;
+        if(t_bIncremental)
+            stackLeadField(t_matProj_LeadField, t_matU_B, t_matStacked, t_matGramDiag);
+        else if(t_bBlocked)
+            projectLeadField(t_matOrthProj, t_matU_B, t_matStacked, t_matGramDiag);
+
         //Inits
         VectorXT t_vecRoh(m_iNumLeadFieldCombinations,1);
         t_vecRoh.setZero();
@@ -221,9 +249,25 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
 
         int t_iNumVecElements = m_iNumGridPoints;
 
+        //Coarse-to-fine search instead of the Powell search
+        if(!m_qListLevelLeadFields.isEmpty() && m_iHierarchyGridPoints == m_iNumGridPoints)
+        {
+            if(!t_bBlocked)
+                stackLeadField(t_matProj_LeadField, t_matU_B, t_matStacked, t_matGramDiag);
+
+            searchCoarseToFine(t_matOrthProj, t_matU_B, t_matStacked, t_matGramDiag, t_iIdx1, t_iIdx2, t_val_roh_k);
+            t_iMaxFound = 1;
+        }
+
         while(t_iMaxFound == 0)
         {
 
+            if(t_bBlocked)
+            {
+                scanPairs(t_matStacked, t_matGramDiag, t_pVecIdxElements.head(t_iNumVecElements), t_vecRoh);
+            }
+            else
+            {
             //Multithreading correlation calculation
             #ifdef _OPENMP
             #pragma omp parallel num_threads(m_iMaxNumThreads)
@@ -247,6 +291,7 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
                     t_vecRoh(k) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
                 }
             }
+            }
 
     //         if(r==0)
     //         {
@@ -333,7 +378,10 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
         RapMusic::calcA_k_1(t_matG_k_1, t_vec_phi_k_1, r, t_matA_k_1);
 
         //Calculate new orthogonal Projector (Pi_k_1)
-        calcOrthProj(t_matA_k_1, t_matOrthProj);
+        if(t_bIncremental)
+            updateOrthProj(t_matA_k_1.col(r), t_matOrthProj, t_matProj_LeadField);
+        else
+            calcOrthProj(t_matA_k_1, t_matOrthProj);
 
         //garbage collecting
         //ToDo
@@ -353,6 +401,177 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
 }
 
 
+//*************************************************************************************************************
+
+bool PwlRapMusic::setHierarchy(int p_iNumLevels, int p_iReduction, int p_iNumCandidates)
+{
+    m_qListLevelLeadFields.clear();
+    m_qListLevelChildren.clear();
+    m_iHierarchyGridPoints = 0;
+
+    if(p_iNumLevels <= 0)
+        return true;
+
+    if(!m_bIsInit || p_iReduction < 2)
+    {
+        std::cout << "PwlRapMusic::setHierarchy - RAP MUSIC wasn't initialized or the reduction is smaller than 2.\n";
+        return false;
+    }
+
+    m_iNumCandidates = p_iNumCandidates > 0 ? p_iNumCandidates : 1;
+
+    MatrixXT t_matLeadField = m_ForwardSolution.sol->data;
+
+    for(int l = 0; l < p_iNumLevels; ++l)
+    {
+        int t_iNumPoints = t_matLeadField.cols()/3;
+        int t_iNumClusters = (int)std::ceil((double)t_iNumPoints/(double)p_iReduction);
+
+        if(t_iNumClusters < 2)
+            break;
+
+        //Reshape -> points rows; sensors(x,y,z) columns, as in the clustering of the forward solution
+        MatrixXd t_matPoints(t_iNumPoints, t_matLeadField.rows()*3);
+        for(int j = 0; j < t_matLeadField.rows(); ++j)
+            for(int k = 0; k < t_iNumPoints; ++k)
+                t_matPoints.block(k, j*3, 1, 3) = t_matLeadField.block(j, k*3, 1, 3);
+
+        KMeans t_kMeans(QString("cityblock"), QString("sample"), 5);
+
+        VectorXi t_vecIdx;
+        MatrixXd t_matCtrs;
+        VectorXd t_vecSumD;
+        MatrixXd t_matD;
+        if(!t_kMeans.calculate(t_matPoints, t_iNumClusters, t_vecIdx, t_matCtrs, t_vecSumD, t_matD))
+        {
+            std::cout << "PwlRapMusic::setHierarchy - Clustering of level " << l+1 << " failed.\n";
+            m_qListLevelLeadFields.clear();
+            m_qListLevelChildren.clear();
+            return false;
+        }
+
+        //Children of each cluster, empty clusters are dropped
+        QList<VectorXi> t_qListChildren;
+        for(int c = 0; c < t_iNumClusters; ++c)
+        {
+            VectorXi t_vecChildren(t_iNumPoints);
+            int t_iCount = 0;
+            for(int k = 0; k < t_vecIdx.size(); ++k)
+                if(t_vecIdx[k] == c)
+                    t_vecChildren[t_iCount++] = k;
+
+            if(t_iCount > 0)
+            {
+                t_vecChildren.conservativeResize(t_iCount);
+                t_qListChildren.append(t_vecChildren);
+            }
+        }
+
+        //The coarse lead field holds the mean gain of the children
+        MatrixXT t_matCoarse = MatrixXT::Zero(t_matLeadField.rows(), 3*t_qListChildren.size());
+        for(int c = 0; c < t_qListChildren.size(); ++c)
+        {
+            for(int k = 0; k < t_qListChildren[c].size(); ++k)
+                t_matCoarse.block(0, 3*c, t_matCoarse.rows(), 3) += t_matLeadField.block(0, 3*t_qListChildren[c][k], t_matLeadField.rows(), 3);
+            t_matCoarse.block(0, 3*c, t_matCoarse.rows(), 3) /= t_qListChildren[c].size();
+        }
+
+        std::cout << "Hierarchy level " << l+1 << ": " << t_qListChildren.size() << " grid points\n";
+
+        m_qListLevelLeadFields.append(t_matCoarse);
+        m_qListLevelChildren.append(t_qListChildren);
+
+        t_matLeadField = t_matCoarse;
+    }
+
+    m_iHierarchyGridPoints = m_iNumGridPoints;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+qint64 PwlRapMusic::searchCoarseToFine(const MatrixXT& p_matOrthProj,
+                                       const MatrixXT& p_matU_B,
+                                       const MatrixXT& p_matStacked,
+                                       const MatrixXT& p_matGramDiag,
+                                       int& p_iIdx1, int& p_iIdx2,
+                                       double& p_dRoh) const
+{
+    qint64 t_iNumPairsScanned = 0;
+
+    //All pairs of the coarsest level
+    int t_iNumTop = m_qListLevelLeadFields.last().cols()/3;
+    QVector< QPair<int,int> > t_qVecPairs;
+    t_qVecPairs.reserve(t_iNumTop*(t_iNumTop+1)/2);
+    for(int i = 0; i < t_iNumTop; ++i)
+        for(int j = i; j < t_iNumTop; ++j)
+            t_qVecPairs.append(qMakePair(i, j));
+
+    for(int l = m_qListLevelLeadFields.size(); l >= 0; --l)
+    {
+        MatrixXT t_matLevelStacked;
+        MatrixXT t_matLevelGramDiag;
+        if(l > 0)
+        {
+            MatrixXT t_matProj = p_matOrthProj * m_qListLevelLeadFields[l-1];
+            stackLeadField(t_matProj, p_matU_B, t_matLevelStacked, t_matLevelGramDiag);
+        }
+
+        const MatrixXT& t_matStacked = l > 0 ? t_matLevelStacked : p_matStacked;
+        const MatrixXT& t_matGramDiag = l > 0 ? t_matLevelGramDiag : p_matGramDiag;
+
+        const int t_iNumPairs = t_qVecPairs.size();
+        VectorXT t_vecRoh(t_iNumPairs);
+
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(m_iMaxNumThreads)
+        #endif
+        {
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 64)
+        #endif
+            for(int i = 0; i < t_iNumPairs; ++i)
+                t_vecRoh(i) = RapMusic::subcorrPair(t_matStacked, t_matGramDiag, m_iNumChannels, t_qVecPairs[i].first, t_qVecPairs[i].second);
+        }
+
+        t_iNumPairsScanned += t_iNumPairs;
+
+        if(l == 0)
+        {
+            VectorXT::Index t_iMaxIdx;
+            p_dRoh = t_vecRoh.maxCoeff(&t_iMaxIdx);
+            p_iIdx1 = t_qVecPairs[t_iMaxIdx].first;
+            p_iIdx2 = t_qVecPairs[t_iMaxIdx].second;
+            break;
+        }
+
+        //Refine the children of the best pairs; children of different coarse points are disjoint, so no pair repeats
+        int t_iNumCandidates = std::min(m_iNumCandidates, t_iNumPairs);
+        QVector< QPair<int,int> > t_qVecRefined;
+        for(int c = 0; c < t_iNumCandidates; ++c)
+        {
+            VectorXT::Index t_iMaxIdx;
+            t_vecRoh.maxCoeff(&t_iMaxIdx);
+            t_vecRoh(t_iMaxIdx) = -1.0;
+
+            const VectorXi& t_vecChildren1 = m_qListLevelChildren[l-1][t_qVecPairs[t_iMaxIdx].first];
+            const VectorXi& t_vecChildren2 = m_qListLevelChildren[l-1][t_qVecPairs[t_iMaxIdx].second];
+            bool t_bSame = t_qVecPairs[t_iMaxIdx].first == t_qVecPairs[t_iMaxIdx].second;
+
+            for(int i = 0; i < t_vecChildren1.size(); ++i)
+                for(int j = t_bSame ? i : 0; j < t_vecChildren2.size(); ++j)
+                    t_qVecRefined.append(qMakePair(std::min(t_vecChildren1[i], t_vecChildren2[j]), std::max(t_vecChildren1[i], t_vecChildren2[j])));
+        }
+
+        t_qVecPairs = t_qVecRefined;
+    }
+
+    return t_iNumPairsScanned;
+}
+
+
 //*************************************************************************************************************
 
 int PwlRapMusic::PowellOffset(int p_iRow, int p_iNumPoints)
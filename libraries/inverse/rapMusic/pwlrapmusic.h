@@ -50,6 +50,7 @@
 #include <time.h>
 
 #include <QVector>
+#include <QList>
 
 
 
@@ -146,12 +147,54 @@ public:
 
     virtual MNESourceEstimate calculateInverse(const MatrixXd& p_matMeasurement, QList< DipolePair<double> > &p_RapDipoles) const;
 
+    //=========================================================================================================
+    /**
+    * Builds a multi-resolution pyramid of the grid for the coarse-to-fine search. Each level clusters the grid
+    * points of the level below with KMeans on their gain vectors, the same way
+    * MNEForwardSolution::cluster_forward_solution clusters the sources of a region, and takes the centroids as
+    * the lead field of the coarse grid points. The pair search then scans all pairs of the coarsest level and
+    * refines only the children of the best p_iNumCandidates pairs on each finer level, instead of the Powell
+    * search over the full grid. Call after init, a new init needs a new hierarchy.
+    *
+    * @param[in] p_iNumLevels       The number of coarse levels (default 2), 0 switches the coarse-to-fine search off.
+    * @param[in] p_iReduction       The number of grid points merged into one coarse point per level (default 8).
+    * @param[in] p_iNumCandidates   The number of best pairs which are refined on the next finer level (default 8).
+    * @return   true if successful, false otherwise.
+    */
+    bool setHierarchy(int p_iNumLevels = 2, int p_iReduction = 8, int p_iNumCandidates = 8);
+
     static int PowellOffset(int p_iRow, int p_iNumPoints);
 
     static void PowellIdxVec(int p_iRow, int p_iNumPoints, Eigen::VectorXi& p_pVecElements);
 
     virtual const char* getName() const;
 
+protected:
+    //=========================================================================================================
+    /**
+    * Coarse-to-fine pair search over the pyramid of setHierarchy.
+    *
+    * @param[in] p_matOrthProj      The orthogonal projector.
+    * @param[in] p_matU_B           The matrix U is the subspace projection of the orthogonal projected Phi_s
+    * @param[in] p_matStacked       The stacked projections of the full grid, see RapMusic::stackLeadField.
+    * @param[in] p_matGramDiag      The gram matrices of the full grid.
+    * @param[out] p_iIdx1           First grid index of the best pair.
+    * @param[out] p_iIdx2           Second grid index of the best pair.
+    * @param[out] p_dRoh            Correlation of the best pair.
+    * @return   The number of evaluated pairs.
+    */
+    qint64 searchCoarseToFine(const MatrixXT& p_matOrthProj,
+                              const MatrixXT& p_matU_B,
+                              const MatrixXT& p_matStacked,
+                              const MatrixXT& p_matGramDiag,
+                              int& p_iIdx1, int& p_iIdx2,
+                              double& p_dRoh) const;
+
+private:
+    QList<MatrixXT> m_qListLevelLeadFields;         /**< Lead fields of the coarse levels, finest first. */
+    QList< QList<Eigen::VectorXi> > m_qListLevelChildren;   /**< Per coarse level and point, the points of the next finer level it contains. */
+    int m_iNumCandidates;                           /**< Number of pairs refined per level. */
+    int m_iHierarchyGridPoints;                     /**< Number of grid points the hierarchy was built for. */
 };
 
 //*************************************************************************************************************
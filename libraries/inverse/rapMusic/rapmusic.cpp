@@ -40,6 +40,15 @@
 #include "rapmusic.h"
 
 #include <utils/mnemath.h>
+#include <utils/tracer.h>
+#include <utils/executionconfig.h>
+#include <utils/linalg.h>
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/QR>
+
+#include <algorithm>
+#include <vector>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -54,6 +63,113 @@
 using namespace INVERSELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Largest singular value of U_A^T * U_B given the gram matrix G^T G and M = G^T U_B U_B^T G of a lead field
+* combination G. The retained components follow RapMusic::getRank (singular value > 10^-5), and components
+* below the numerical resolution of the gram matrix are dropped.
+*/
+template<int N>
+double subcorrGram(const Eigen::Matrix<double, N, N>& p_matGram, const Eigen::Matrix<double, N, N>& p_matM, double p_dScale)
+{
+    Eigen::SelfAdjointEigenSolver< Eigen::Matrix<double, N, N> > t_eigGram(p_matGram);
+    const Eigen::Matrix<double, N, 1>& t_vecLambda = t_eigGram.eigenvalues();
+
+    double t_dSigmaMax = std::sqrt(std::max(t_vecLambda(N-1), 0.0));
+    if(t_dSigmaMax <= 0.0)
+        return 0.0;
+
+    int t_iRank = 0;
+    for(int k = N-1; k >= 0; --k) {
+        double t_dSigma = std::sqrt(std::max(t_vecLambda(k), 0.0));
+        if(t_dSigma * p_dScale > 0.00001 && t_dSigma > 1e-7 * t_dSigmaMax)
+            ++t_iRank;
+        else
+            break;
+    }
+    if(t_iRank == 0)
+        t_iRank = 1;
+
+    //W = V_A / Sigma_A, so that G * W = U_A
+    Eigen::Matrix<double, N, Eigen::Dynamic, 0, N, N> t_matW(N, t_iRank);
+    for(int k = 0; k < t_iRank; ++k)
+        t_matW.col(k) = t_eigGram.eigenvectors().col(N-1-k) / std::sqrt(std::max(t_vecLambda(N-1-k), 0.0));
+
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, N, N> t_matCor = t_matW.transpose() * p_matM * t_matW;
+    Eigen::SelfAdjointEigenSolver< Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, N, N> > t_eigCor(t_matCor, Eigen::EigenvaluesOnly);
+
+    return std::sqrt(std::max(t_eigCor.eigenvalues()(t_iRank-1), 0.0));
+}
+
+
+//=============================================================================================================
+/**
+* Gram matrices of the gain blocks of each grid point within the stacked projections, see
+* RapMusic::stackLeadField.
+*/
+void calcGramDiag(const Eigen::MatrixXd& p_matStacked, int p_iNumChannels, Eigen::MatrixXd& p_matGramDiag)
+{
+    const int t_iNumPoints = p_matStacked.cols() / 3;
+    const int t_iRankU_B = p_matStacked.rows() - p_iNumChannels;
+
+    p_matGramDiag.resize(6, p_matStacked.cols());
+    for(int i = 0; i < t_iNumPoints; ++i)
+    {
+        p_matGramDiag.block(0, 3*i, 3, 3).noalias() = p_matStacked.block(0, 3*i, p_iNumChannels, 3).transpose()
+                                                        * p_matStacked.block(0, 3*i, p_iNumChannels, 3);
+        p_matGramDiag.block(3, 3*i, 3, 3).noalias() = p_matStacked.block(p_iNumChannels, 3*i, t_iRankU_B, 3).transpose()
+                                                        * p_matStacked.block(p_iNumChannels, 3*i, t_iRankU_B, 3);
+    }
+}
+
+
+//=============================================================================================================
+/**
+* Correlations of all pairs with the fixed size kernels of the given precision. Every thread allocates its pair
+* and workspace once, so the loop does not allocate.
+*/
+template<typename T>
+void scanPairsFixed(const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>& p_matProj_LeadField,
+                    const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>& p_matU_B,
+                    Pair** p_ppPairIdxCombinations,
+                    int p_iNumPairs,
+                    int p_iNumThreads,
+                    Eigen::VectorXd& p_vecRoh)
+{
+    #ifndef _OPENMP
+    Q_UNUSED(p_iNumThreads);
+    #endif
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(p_iNumThreads)
+    #endif
+    {
+        typename RapMusicKernel<T>::MatrixX6T t_matProj_G(p_matProj_LeadField.rows(), 6);
+        typename RapMusicKernel<T>::Workspace t_workspace(p_matProj_LeadField.rows(), p_matU_B.cols());
+
+    #ifdef _OPENMP
+    #pragma omp for
+    #endif
+        for(int i = 0; i < p_iNumPairs; i++)
+        {
+            RapMusicKernel<T>::gainMatrixPair(p_matProj_LeadField, p_ppPairIdxCombinations[i]->x1, p_ppPairIdxCombinations[i]->x2, t_matProj_G);
+
+            p_vecRoh(i) = RapMusicKernel<T>::subcorr(t_matProj_G, p_matU_B, t_workspace);//p_vecRoh holds the correlations roh_k
+        }
+    }
+}
+
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -68,15 +184,25 @@ RapMusic::RapMusic()
 , m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
+, m_bSinglePrecision(false)
+, m_bBlockedSearch(false)
+, m_bUseGpu(false)
 , m_iSamplesStcWindow(-1)
 , m_fStcOverlap(-1)
+, m_iStreamWindow(-1)
+, m_iStreamNumNeighbors(8)
+, m_iStreamSubspaceRank(-1)
+, m_iStreamFullSearchInterval(50)
+, m_iStreamWriteIdx(0)
+, m_iStreamNumSamples(0)
+, m_iStreamNumWindows(0)
 {
 }
 
 
 //*************************************************************************************************************
 
-RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double p_dThr)
+RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double p_dThr, bool p_bSinglePrecision)
 : m_iN(0)
 , m_dThreshold(0)
 , m_iNumGridPoints(0)
@@ -85,11 +211,21 @@ RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double
 , m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
+, m_bSinglePrecision(false)
+, m_bBlockedSearch(false)
+, m_bUseGpu(false)
 , m_iSamplesStcWindow(-1)
 , m_fStcOverlap(-1)
+, m_iStreamWindow(-1)
+, m_iStreamNumNeighbors(8)
+, m_iStreamSubspaceRank(-1)
+, m_iStreamFullSearchInterval(50)
+, m_iStreamWriteIdx(0)
+, m_iStreamNumSamples(0)
+, m_iStreamNumWindows(0)
 {
     //Init
-    init(p_pFwd, p_bSparsed, p_iN, p_dThr);
+    init(p_pFwd, p_bSparsed, p_iN, p_dThr, p_bSinglePrecision);
 }
 
 
@@ -104,12 +240,12 @@ RapMusic::~RapMusic()
 
 //*************************************************************************************************************
 
-bool RapMusic::init(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double p_dThr)
+bool RapMusic::init(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double p_dThr, bool p_bSinglePrecision)
 {
     //Get available thread number
     #ifdef _OPENMP
         std::cout << "OpenMP enabled" << std::endl;
-        m_iMaxNumThreads = omp_get_max_threads();
+        m_iMaxNumThreads = UTILSLIB::ExecutionConfig::openMpThreads() > 0 ? UTILSLIB::ExecutionConfig::openMpThreads() : omp_get_max_threads();
     #else
         std::cout << "OpenMP disabled (to enable it: VS2010->Project Properties->C/C++->Language, then modify OpenMP Support)" << std::endl;
         m_iMaxNumThreads = 1;
@@ -153,6 +289,9 @@ bool RapMusic::init(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, doubl
 
     m_ForwardSolution = p_pFwd;
 
+    m_bSinglePrecision = p_bSinglePrecision;
+    m_matLeadFieldFloat = m_bSinglePrecision ? Eigen::MatrixXf(p_pFwd.sol->data.cast<float>()) : Eigen::MatrixXf();
+
     //##### Calc lead field combination #####
 
     std::cout << "Calculate gain matrix combinations. \n";
@@ -175,6 +314,8 @@ bool RapMusic::init(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, doubl
 
     std::cout << "Threshold: " << m_dThreshold << "\n\n";
 
+    std::cout << "Precision: " << (m_bSinglePrecision ? "single" : "double") << "\n\n";
+
     //Init end
 
     std::cout << "##### Initialization RAP MUSIC completed ######\n\n\n";
@@ -183,6 +324,12 @@ bool RapMusic::init(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, doubl
 
     m_bIsInit = true;
 
+    //Upload the new lead field
+    setUseGpu(m_bUseGpu);
+
+    //The window of a stream belongs to the previous model
+    resetStream();
+
     return m_bIsInit;
 }
 
@@ -384,6 +531,8 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd &data, float tmin, f
 
 MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, QList< DipolePair<double> > &p_RapDipoles) const
 {
+    MNE_TRACE_SCOPE("RapMusic::calculateInverse", "inverse");
+
     MNESourceEstimate p_SourceEstimate;
 
     //if not initialized -> break
@@ -456,12 +605,19 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
     //new Version: Calculate projection before
     MatrixXT t_matProj_LeadField(m_ForwardSolution.sol->data.rows(), m_ForwardSolution.sol->data.cols());
 
+    //Blocked search: without the GPU the projected lead field is kept and updated with each found source
+    const bool t_bBlocked = m_bBlockedSearch || m_bUseGpu;
+    const bool t_bIncremental = t_bBlocked && !m_pGpuLeadField;
+    if(t_bIncremental)
+        t_matProj_LeadField = m_ForwardSolution.sol->data;
+
     for(int r = 0; r < t_iMaxSearch ; ++r)
     {
         t_matProj_Phi_s = t_matOrthProj*(*t_pMatPhi_s);
 
         //new Version: Calculating Projection before
-        t_matProj_LeadField = t_matOrthProj * m_ForwardSolution.sol->data;//Subtract the found sources from the current found source
+        if(!t_bBlocked && !m_bSinglePrecision)
+            t_matProj_LeadField = t_matOrthProj * m_ForwardSolution.sol->data;//Subtract the found sources from the current found source
 
         //###First Option###
         //Step 1: lt. Mosher 1998 -> Maybe tmp_Proj_Phi_S is already orthogonal -> so no SVD needed -> U_B = tmp_Proj_Phi_S;
@@ -478,30 +634,32 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         clock_t start_subcorr, end_subcorr;
         start_subcorr = clock();
 
-        //Multithreading correlation calculation
-        #ifdef _OPENMP
-        #pragma omp parallel num_threads(m_iMaxNumThreads)
-        #endif
+        if(t_bBlocked)
         {
-        #ifdef _OPENMP
-        #pragma omp for
-        #endif
-            for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
-            {
-                //new Version: calculate matrix multiplication before
-                //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
+            MatrixXT t_matStacked;
+            MatrixXT t_matGramDiag;
 
-                int idx1 = m_ppPairIdxCombinations[i]->x1;
-                int idx2 = m_ppPairIdxCombinations[i]->x2;
+            if(t_bIncremental)
+                stackLeadField(t_matProj_LeadField, t_matU_B, t_matStacked, t_matGramDiag);
+            else
+                projectLeadField(t_matOrthProj, t_matU_B, t_matStacked, t_matGramDiag);
 
-                RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
+            scanPairs(t_matStacked, t_matGramDiag, Eigen::VectorXi(), t_vecRoh);
+        }
+        else if(m_bSinglePrecision)
+        {
+            Eigen::MatrixXf t_matProj_LeadFieldFloat = t_matOrthProj.cast<float>() * m_matLeadFieldFloat;
+            Eigen::MatrixXf t_matU_BFloat = t_matU_B.cast<float>();
 
-                t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
-            }
+            scanPairsFixed<float>(t_matProj_LeadFieldFloat, t_matU_BFloat, m_ppPairIdxCombinations, m_iNumLeadFieldCombinations, m_iMaxNumThreads, t_vecRoh);
+        }
+        else
+        {
+            scanPairsFixed<double>(t_matProj_LeadField, t_matU_B, m_ppPairIdxCombinations, m_iNumLeadFieldCombinations, m_iMaxNumThreads, t_vecRoh);
         }
 
 
+
 //         if(r==0)
 //         {
 //             std::fstream filestr;
@@ -568,7 +726,10 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         RapMusic::calcA_k_1(t_matG_k_1, t_vec_phi_k_1, r, t_matA_k_1);
 
         //Calculate new orthogonal Projector (Pi_k_1)
-        calcOrthProj(t_matA_k_1, t_matOrthProj);
+        if(t_bIncremental)
+            updateOrthProj(t_matA_k_1.col(r), t_matOrthProj, t_matProj_LeadField);
+        else
+            calcOrthProj(t_matA_k_1, t_matOrthProj);
 
         //garbage collecting
         //ToDo
@@ -588,6 +749,181 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
 }
 
 
+//*************************************************************************************************************
+
+MNESourceEstimate RapMusic::calculateInverseStream(const MatrixXd& p_matData, float tmin, float tstep)
+{
+    MNE_TRACE_SCOPE("RapMusic::calculateInverseStream", "inverse");
+
+    MNESourceEstimate p_sourceEstimate;
+
+    if(!m_bIsInit || m_iStreamWindow <= 0)
+    {
+        std::cout << "RAP MUSIC streaming mode wasn't initialized!" << std::endl;
+        return p_sourceEstimate;
+    }
+
+    if(p_matData.rows() != m_iNumChannels)
+    {
+        std::cout << "Number of data channels (" << p_matData.rows() << ") doesn't match the number of channels (" << m_iNumChannels << ") of the forward solution." << std::endl;
+        return p_sourceEstimate;
+    }
+
+    //Slide the window: rank one update of the covariance for each sample which enters and each which drops out
+    for(qint32 i = 0; i < p_matData.cols(); ++i)
+    {
+        if(m_iStreamNumSamples >= m_iStreamWindow)
+            m_matStreamCov.selfadjointView<Eigen::Lower>().rankUpdate(m_matStreamWindow.col(m_iStreamWriteIdx), -1.0);
+
+        m_matStreamWindow.col(m_iStreamWriteIdx) = p_matData.col(i);
+        m_matStreamCov.selfadjointView<Eigen::Lower>().rankUpdate(m_matStreamWindow.col(m_iStreamWriteIdx), 1.0);
+
+        m_iStreamWriteIdx = (m_iStreamWriteIdx + 1) % m_iStreamWindow;
+        ++m_iStreamNumSamples;
+
+        //Recompute the covariance once per window length, so that the round-off of the downdates does not add up
+        if(m_iStreamWriteIdx == 0 && m_iStreamNumSamples > m_iStreamWindow)
+        {
+            m_matStreamCov.setZero();
+            m_matStreamCov.selfadjointView<Eigen::Lower>().rankUpdate(m_matStreamWindow, 1.0);
+        }
+    }
+
+    if(m_iStreamNumSamples < m_iStreamWindow)
+        return p_sourceEstimate;
+
+    //Track the signal subspace (t_pMatPhi_s of calculateInverse), the first window starts with the eigen decomposition
+    int t_iRank = m_iStreamSubspaceRank > 0 ? m_iStreamSubspaceRank : 2*m_iN;
+    t_iRank = std::max(1, std::min(t_iRank, m_iNumChannels));
+
+    if(m_matStreamPhi_s.cols() != t_iRank)
+    {
+        Eigen::SelfAdjointEigenSolver<MatrixXT> t_eigCov(m_matStreamCov);
+        m_matStreamPhi_s = t_eigCov.eigenvectors().rightCols(t_iRank);
+    }
+    else
+    {
+        MatrixXT t_matZ = m_matStreamCov.selfadjointView<Eigen::Lower>() * m_matStreamPhi_s;
+        Eigen::HouseholderQR<MatrixXT> t_qrZ(t_matZ);
+        m_matStreamPhi_s = t_qrZ.householderQ() * MatrixXT::Identity(m_iNumChannels, t_iRank);
+    }
+
+    int t_iMaxSearch = m_iN < t_iRank ? m_iN : t_iRank;
+
+    //Periodically search the whole grid to pick up new sources
+    bool t_bFullSearch = m_iStreamFullSearchInterval > 0 && (m_iStreamNumWindows % m_iStreamFullSearchInterval) == 0;
+    ++m_iStreamNumWindows;
+
+    if(m_vecStreamRoh.size() != m_iNumLeadFieldCombinations)
+        m_vecStreamRoh = VectorXT::Zero(m_iNumLeadFieldCombinations);
+
+    MatrixXT t_matOrthProj = MatrixXT::Identity(m_iNumChannels, m_iNumChannels);
+    MatrixXT t_matProj_LeadField = m_ForwardSolution.sol->data;
+    MatrixXT t_matA_k_1 = MatrixXT::Zero(m_iNumChannels, t_iMaxSearch);
+
+    QList< DipolePair<double> > t_RapDipoles;
+
+    for(int r = 0; r < t_iMaxSearch; ++r)
+    {
+        MatrixXT t_matProj_Phi_s = t_matOrthProj * m_matStreamPhi_s;
+
+        Eigen::JacobiSVD< MatrixXT > t_svdProj_Phi_S(t_matProj_Phi_s, Eigen::ComputeThinU);
+        MatrixXT t_matU_B;
+        useFullRank(t_svdProj_Phi_S.matrixU(), t_svdProj_Phi_S.singularValues().asDiagonal(), t_matU_B);
+
+        MatrixXT t_matStacked;
+        MatrixXT t_matGramDiag;
+        stackLeadField(t_matProj_LeadField, t_matU_B, t_matStacked, t_matGramDiag);
+
+        //Search around the r-th dipole pair of the previous window
+        Eigen::VectorXi t_vecPairIdx;
+        if(!t_bFullSearch && r < m_qListStreamDipoles.size())
+            t_vecPairIdx = getNeighborPairs(m_qListStreamDipoles[r].m_iIdx1, m_qListStreamDipoles[r].m_iIdx2);
+
+        double t_val_roh_k = -1.0;
+        int t_iMaxIdx = -1;
+
+        if(t_vecPairIdx.size() > 0)
+        {
+            scanPairs(t_matStacked, t_matGramDiag, t_vecPairIdx, m_vecStreamRoh);
+
+            for(qint32 i = 0; i < t_vecPairIdx.size(); ++i)
+            {
+                if(m_vecStreamRoh(t_vecPairIdx(i)) > t_val_roh_k)
+                {
+                    t_val_roh_k = m_vecStreamRoh(t_vecPairIdx(i));
+                    t_iMaxIdx = t_vecPairIdx(i);
+                }
+            }
+        }
+        else
+        {
+            scanPairs(t_matStacked, t_matGramDiag, Eigen::VectorXi(), m_vecStreamRoh);
+
+            VectorXT::Index t_iIdx;
+            t_val_roh_k = m_vecStreamRoh.maxCoeff(&t_iIdx);
+            t_iMaxIdx = (int)t_iIdx;
+        }
+
+        int t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
+        int t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
+
+        MatrixX6T t_matG_k_1(m_ForwardSolution.sol->data.rows(),6);
+        RapMusic::getGainMatrixPair(m_ForwardSolution.sol->data, t_matG_k_1, t_iIdx1, t_iIdx2);
+
+        MatrixX6T t_matProj_G_k_1(t_matOrthProj.rows(), t_matG_k_1.cols());
+        t_matProj_G_k_1 = t_matOrthProj * t_matG_k_1;
+
+        //Calculate source direction
+        Vector6T t_vec_phi_k_1(6);
+        RapMusic::subcorr(t_matProj_G_k_1, t_matU_B, t_vec_phi_k_1);
+
+        RapMusic::insertSource(t_iIdx1, t_iIdx2, t_vec_phi_k_1, t_val_roh_k, t_RapDipoles);
+
+        //Stop Searching when Correlation is smaller then the Threshold
+        if (t_val_roh_k < m_dThreshold)
+            break;
+
+        //Remove the found source from the projector and the projected lead field
+        RapMusic::calcA_k_1(t_matG_k_1, t_vec_phi_k_1, r, t_matA_k_1);
+        updateOrthProj(t_matA_k_1.col(r), t_matOrthProj, t_matProj_LeadField);
+    }
+
+    m_qListStreamDipoles = t_RapDipoles;
+
+    //
+    // Rap MUSIC Source estimate
+    //
+    p_sourceEstimate.data = MatrixXd::Zero(m_ForwardSolution.nsource, p_matData.cols());
+
+    //Results
+    p_sourceEstimate.vertices = VectorXi(m_ForwardSolution.src[0].vertno.size() + m_ForwardSolution.src[1].vertno.size());
+    p_sourceEstimate.vertices << m_ForwardSolution.src[0].vertno, m_ForwardSolution.src[1].vertno;
+
+    p_sourceEstimate.times = RowVectorXf::Zero(p_matData.cols());
+    for(qint32 i = 0; i < p_sourceEstimate.times.size(); ++i)
+        p_sourceEstimate.times[i] = tmin + i*tstep;
+    p_sourceEstimate.tmin = tmin;
+    p_sourceEstimate.tstep = tstep;
+
+    for(qint32 i = 0; i < t_RapDipoles.size(); ++i)
+    {
+        double dip1 = sqrt( pow(t_RapDipoles[i].m_Dipole1.phi_x(),2) +
+                            pow(t_RapDipoles[i].m_Dipole1.phi_y(),2) +
+                            pow(t_RapDipoles[i].m_Dipole1.phi_z(),2) ) * t_RapDipoles[i].m_vCorrelation;
+
+        double dip2 = sqrt( pow(t_RapDipoles[i].m_Dipole2.phi_x(),2) +
+                            pow(t_RapDipoles[i].m_Dipole2.phi_y(),2) +
+                            pow(t_RapDipoles[i].m_Dipole2.phi_z(),2) ) * t_RapDipoles[i].m_vCorrelation;
+
+        p_sourceEstimate.data.row(t_RapDipoles[i].m_iIdx1).setConstant(dip1);
+        p_sourceEstimate.data.row(t_RapDipoles[i].m_iIdx2).setConstant(dip2);
+    }
+
+    return p_sourceEstimate;
+}
+
+
 //*************************************************************************************************************
 
 int RapMusic::calcPhi_s(const MatrixXT& p_matMeasurement, MatrixXT* &p_pMatPhi_s) const
@@ -622,132 +958,125 @@ int RapMusic::calcPhi_s(const MatrixXT& p_matMeasurement, MatrixXT* &p_pMatPhi_s
 
 double RapMusic::subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B)
 {
-    //Orthogonalisierungstest wegen performance weggelassen -> ohne is es viel schneller
-
-    Matrix6T t_matSigma_A(6, 6);
-    Matrix6XT t_matU_A_T(6, p_matProj_G.rows()); //rows and cols are changed, because of CV_SVD_U_T
-
-    Eigen::JacobiSVD<MatrixXT> t_svdProj_G(p_matProj_G, Eigen::ComputeThinU);
+    RapMusicKernel<double>::Workspace t_workspace(p_matProj_G.rows(), p_matU_B.cols());
 
-    t_matSigma_A = t_svdProj_G.singularValues().asDiagonal();
-    t_matU_A_T = t_svdProj_G.matrixU().transpose();
-
-    //lt. Mosher 1998 ToDo: Only Retain those Components of U_A and U_B that correspond to nonzero singular values
-    //for U_A and U_B the number of columns corresponds to their ranks
-    MatrixXT t_matU_A_T_full;
-    //reduce to rank only when directions aren't calculated, otherwise use the full t_matU_A_T
-
-    useFullRank(t_matU_A_T, t_matSigma_A, t_matU_A_T_full, IS_TRANSPOSED);//lt. Mosher 1998: Only Retain those Components of U_A that correspond to nonzero singular values -> for U_A the number of columns corresponds to their ranks
-
-    MatrixXT t_matCor(t_matU_A_T_full.rows(), p_matU_B.cols());
+    return RapMusicKernel<double>::subcorr(p_matProj_G, p_matU_B, t_workspace);
+}
 
-    //Step 2: compute the subspace correlation
-    t_matCor = t_matU_A_T_full*p_matU_B;//lt. Mosher 1998: C = U_A^T * U_B
 
-    VectorXT t_vecSigma_C;
+//*************************************************************************************************************
 
-    if (t_matCor.cols() > t_matCor.rows())
-    {
-        MatrixXT t_matCor_H(t_matCor.cols(), t_matCor.rows());
-        t_matCor_H = t_matCor.adjoint(); //for complex it has to be adjunct
-        //ToDo -> use instead adjointInPlace
+double RapMusic::subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vector6T& p_vec_phi_k_1)
+{
+    RapMusicKernel<double>::Workspace t_workspace(p_matProj_G.rows(), p_matU_B.cols());
 
-        Eigen::JacobiSVD<MatrixXT> t_svdCor_H(t_matCor_H);
+    return RapMusicKernel<double>::subcorr(p_matProj_G, p_matU_B, t_workspace, p_vec_phi_k_1);
+}
 
-        t_vecSigma_C = t_svdCor_H.singularValues();
-    }
-    else
-    {
-        Eigen::JacobiSVD<MatrixXT> t_svdCor(t_matCor);
 
-        t_vecSigma_C = t_svdCor.singularValues();
-    }
+//*************************************************************************************************************
 
-    //Step 3
-    double t_dRetSigma_C;
-    t_dRetSigma_C = t_vecSigma_C(0); //Take only the correlation of the first principal components
+void RapMusic::projectLeadField(const MatrixXT& p_matOrthProj,
+                                const MatrixXT& p_matU_B,
+                                MatrixXT& p_matStacked,
+                                MatrixXT& p_matGramDiag) const
+{
+    //[OrthProj, OrthProj * U_B]^T * G -> the orthogonal projector is symmetric
+    MatrixXT t_matB(m_iNumChannels, m_iNumChannels + p_matU_B.cols());
+    t_matB << p_matOrthProj, p_matOrthProj * p_matU_B;
 
-    //garbage collecting
-    //ToDo
+    if(!m_pGpuLeadField || !m_pGpuLeadField->multiplyTransposed(t_matB, p_matStacked))
+        UTILSLIB::LinAlg::multiply(t_matB, m_ForwardSolution.sol->data, p_matStacked, true);
 
-    return t_dRetSigma_C;
+    calcGramDiag(p_matStacked, m_iNumChannels, p_matGramDiag);
 }
 
 
 //*************************************************************************************************************
 
-double RapMusic::subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vector6T& p_vec_phi_k_1)
+void RapMusic::stackLeadField(const MatrixXT& p_matProj_LeadField,
+                              const MatrixXT& p_matU_B,
+                              MatrixXT& p_matStacked,
+                              MatrixXT& p_matGramDiag)
 {
-    //Orthogonalisierungstest wegen performance weggelassen -> ohne is es viel schneller
-
-    Matrix6T sigma_A(6, 6);
-    Matrix6XT U_A_T(6, p_matProj_G.rows()); //rows and cols are changed, because of CV_SVD_U_T
-    Matrix6T V_A(6, 6);
-
-    Eigen::JacobiSVD<MatrixXT> svdOfProj_G(p_matProj_G, Eigen::ComputeThinU | Eigen::ComputeThinV);
-
-    sigma_A = svdOfProj_G.singularValues().asDiagonal();
-    U_A_T = svdOfProj_G.matrixU().transpose();
-    V_A = svdOfProj_G.matrixV();
-
-    //lt. Mosher 1998 ToDo: Only Retain those Components of U_A and U_B that correspond to nonzero singular values
-    //for U_A and U_B the number of columns corresponds to their ranks
-    //-> reduce to rank only when directions aren't calculated, otherwise use the full U_A_T
+    p_matStacked.resize(p_matProj_LeadField.rows() + p_matU_B.cols(), p_matProj_LeadField.cols());
+    p_matStacked.topRows(p_matProj_LeadField.rows()) = p_matProj_LeadField;
+    p_matStacked.bottomRows(p_matU_B.cols()).noalias() = p_matU_B.transpose() * p_matProj_LeadField;
 
-    Matrix6XT t_matCor(6, p_matU_B.cols());
+    calcGramDiag(p_matStacked, p_matProj_LeadField.rows(), p_matGramDiag);
+}
 
-    //Step 2: compute the subspace correlation
-    t_matCor = U_A_T*p_matU_B;//lt. Mosher 1998: C = U_A^T * U_B
 
+//*************************************************************************************************************
 
-    VectorXT sigma_C;
+void RapMusic::scanPairs(const MatrixXT& p_matStacked,
+                         const MatrixXT& p_matGramDiag,
+                         const Eigen::VectorXi& p_vecPairIdx,
+                         VectorXT& p_vecRoh) const
+{
+    const int t_iNumPairs = p_vecPairIdx.size() > 0 ? (int)p_vecPairIdx.size() : m_iNumLeadFieldCombinations;
 
-    //Step 4
-    Matrix6XT U_C;
+    //Size the tiles so that the gain blocks of their second grid points stay within 256 kB of cache
+    const int t_iBlockBytes = 3 * (int)p_matStacked.rows() * (int)sizeof(double);
+    const int t_iTileSize = std::max(16, (256 * 1024) / std::max(t_iBlockBytes, 1));
+    const int t_iNumTiles = (t_iNumPairs + t_iTileSize - 1) / t_iTileSize;
 
-    if (t_matCor.cols() > t_matCor.rows())
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
+    #endif
     {
-        MatrixX6T Cor_H(t_matCor.cols(), 6);
-        Cor_H = t_matCor.adjoint(); //for complex it has to be adjunct
-
-        Eigen::JacobiSVD<MatrixXT> svdOfCor_H(Cor_H, Eigen::ComputeThinV);
+    #ifdef _OPENMP
+    #pragma omp for schedule(dynamic)
+    #endif
+        for(int t = 0; t < t_iNumTiles; ++t)
+        {
+            const int t_iEnd = std::min(t_iNumPairs, (t + 1) * t_iTileSize);
 
-        U_C = svdOfCor_H.matrixV(); //because t_matCor Hermitesch U and V are exchanged
-        sigma_C = svdOfCor_H.singularValues();
-    }
-    else
-    {
-        Eigen::JacobiSVD<MatrixXT> svdOfCor(t_matCor, Eigen::ComputeThinU);
+            for(int i = t * t_iTileSize; i < t_iEnd; ++i)
+            {
+                int k = p_vecPairIdx.size() > 0 ? p_vecPairIdx(i) : i;
 
-        U_C = svdOfCor.matrixU();
-        sigma_C = svdOfCor.singularValues();
+                p_vecRoh(k) = RapMusic::subcorrPair(p_matStacked, p_matGramDiag, m_iNumChannels,
+                                                    m_ppPairIdxCombinations[k]->x1, m_ppPairIdxCombinations[k]->x2);
+            }
+        }
     }
+}
 
-    Matrix6T sigma_a_inv;
-    sigma_a_inv = sigma_A.inverse();
-
-    Matrix6XT X;
-    X = (V_A*sigma_a_inv)*U_C;//X = V_A*Sigma_A^-1*U_C
 
-    Vector6T X_max;//only for the maximum c - so instead of X->cols use 1
-    X_max = X.col(0);
+//*************************************************************************************************************
 
-    double norm_X = 1/(X_max.norm());
+double RapMusic::subcorrPair(const MatrixXT& p_matStacked,
+                             const MatrixXT& p_matGramDiag,
+                             int p_iNumChannels,
+                             int p_iIdx1, int p_iIdx2)
+{
+    if(p_iIdx1 == p_iIdx2)
+    {
+        //The pair (g, g) has the subspace of g and its singular values times sqrt(2)
+        Eigen::Matrix3d t_matGram = p_matGramDiag.block<3,3>(0, 3*p_iIdx1);
+        Eigen::Matrix3d t_matM = p_matGramDiag.block<3,3>(3, 3*p_iIdx1);
 
-    //Multiply a scalar with an Array -> linear transform
-    p_vec_phi_k_1 = X_max*norm_X;//u1 = x1/||x1|| this is the orientation
+        return subcorrGram<3>(t_matGram, t_matM, std::sqrt(2.0));
+    }
 
-    //garbage collecting
-    //ToDo
+    const int t_iRankU_B = p_matStacked.rows() - p_iNumChannels;
 
-    //Step 3
-    double ret_sigma_C;
-    ret_sigma_C = sigma_C(0); //Take only the correlation of the first principal components
+    Matrix6T t_matGram;
+    t_matGram.block<3,3>(0,0) = p_matGramDiag.block<3,3>(0, 3*p_iIdx1);
+    t_matGram.block<3,3>(3,3) = p_matGramDiag.block<3,3>(0, 3*p_iIdx2);
+    t_matGram.block<3,3>(0,3).noalias() = p_matStacked.block(0, 3*p_iIdx1, p_iNumChannels, 3).transpose()
+                                            * p_matStacked.block(0, 3*p_iIdx2, p_iNumChannels, 3);
+    t_matGram.block<3,3>(3,0) = t_matGram.block<3,3>(0,3).transpose();
 
-    //garbage collecting
-    //ToDo
+    Matrix6T t_matM;
+    t_matM.block<3,3>(0,0) = p_matGramDiag.block<3,3>(3, 3*p_iIdx1);
+    t_matM.block<3,3>(3,3) = p_matGramDiag.block<3,3>(3, 3*p_iIdx2);
+    t_matM.block<3,3>(0,3).noalias() = p_matStacked.block(p_iNumChannels, 3*p_iIdx1, t_iRankU_B, 3).transpose()
+                                        * p_matStacked.block(p_iNumChannels, 3*p_iIdx2, t_iRankU_B, 3);
+    t_matM.block<3,3>(3,0) = t_matM.block<3,3>(0,3).transpose();
 
-    return ret_sigma_C;
+    return subcorrGram<6>(t_matGram, t_matM, 1.0);
 }
 
 
@@ -759,11 +1088,7 @@ void RapMusic::calcA_k_1(   const MatrixX6T& p_matG_k_1,
                             MatrixXT& p_matA_k_1)
 {
     //Calculate A_k_1 = [a_theta_1..a_theta_k_1] matrix for subtraction of found source
-    VectorXT t_vec_a_theta_k_1(p_matG_k_1.rows(),1);
-
-    t_vec_a_theta_k_1 = p_matG_k_1*p_matPhi_k_1; // a_theta_k_1 = G_k_1*phi_k_1   this corresponds to the normalized signal component in subspace r
-
-    p_matA_k_1.block(0,p_iIdxk_1,p_matA_k_1.rows(),1) = t_vec_a_theta_k_1;
+    RapMusicKernel<double>::calcA_k_1(p_matG_k_1, p_matPhi_k_1, p_iIdxk_1, p_matA_k_1);
 }
 
 
@@ -810,6 +1135,76 @@ void RapMusic::calcOrthProj(const MatrixXT& p_matA_k_1, MatrixXT& p_matOrthProj)
 }
 
 
+//*************************************************************************************************************
+
+void RapMusic::updateOrthProj(const VectorXT& p_vec_a_theta_k_1,
+                              MatrixXT& p_matOrthProj,
+                              MatrixXT& p_matProj_LeadField)
+{
+    //Component of a_theta_k_1 which is not yet removed, projected twice to stay orthogonal to the earlier sources
+    VectorXT t_vecU = p_matOrthProj * p_vec_a_theta_k_1;
+    t_vecU = p_matOrthProj * t_vecU;
+
+    double t_dNorm2 = t_vecU.squaredNorm();
+    if(t_dNorm2 <= 1e-24 * p_vec_a_theta_k_1.squaredNorm() || t_dNorm2 == 0.0)
+        return; //a_theta_k_1 lies in the span of the sources found before
+
+    //OrthProj_k = OrthProj_k_1 - u*u^T/(u^T*u) and OrthProj_k * G = OrthProj_k_1 * G - u*(u^T * OrthProj_k_1 * G)/(u^T*u)
+    Eigen::RowVectorXd t_vecW = (t_vecU.transpose() * p_matProj_LeadField) / t_dNorm2;
+    p_matProj_LeadField.noalias() -= t_vecU * t_vecW;
+    p_matOrthProj.noalias() -= t_vecU * (t_vecU.transpose() / t_dNorm2);
+}
+
+
+//*************************************************************************************************************
+
+Eigen::VectorXi RapMusic::getNeighborPairs(int p_iIdx1, int p_iIdx2) const
+{
+    const MatrixX3f& t_matRR = m_ForwardSolution.source_rr;
+    if(t_matRR.rows() != m_iNumGridPoints)
+        return Eigen::VectorXi();
+
+    const int t_iNumNeighbors = std::max(1, std::min(m_iStreamNumNeighbors, m_iNumGridPoints));
+
+    //The t_iNumNeighbors closest grid points of both dipoles, each one is its own closest point
+    std::vector<int> t_vecNeighbors[2];
+    const int t_iIdx[2] = {p_iIdx1, p_iIdx2};
+
+    for(int d = 0; d < 2; ++d)
+    {
+        Eigen::VectorXf t_vecDist = (t_matRR.rowwise() - t_matRR.row(t_iIdx[d])).rowwise().squaredNorm();
+
+        std::vector<int> t_vecOrder(m_iNumGridPoints);
+        for(int i = 0; i < m_iNumGridPoints; ++i)
+            t_vecOrder[i] = i;
+
+        std::partial_sort(t_vecOrder.begin(), t_vecOrder.begin() + t_iNumNeighbors, t_vecOrder.end(),
+                          [&t_vecDist](int a, int b) { return t_vecDist(a) < t_vecDist(b); });
+
+        t_vecNeighbors[d].assign(t_vecOrder.begin(), t_vecOrder.begin() + t_iNumNeighbors);
+    }
+
+    std::vector<int> t_vecPairIdx;
+    t_vecPairIdx.reserve(t_iNumNeighbors*t_iNumNeighbors);
+
+    for(int i = 0; i < t_iNumNeighbors; ++i)
+    {
+        for(int j = 0; j < t_iNumNeighbors; ++j)
+        {
+            int a = t_vecNeighbors[0][i];
+            int b = t_vecNeighbors[1][j];
+            t_vecPairIdx.push_back(a <= b ? getPairIdx(m_iNumGridPoints, a, b) : getPairIdx(m_iNumGridPoints, b, a));
+        }
+    }
+
+    //Sorted, so that the tiles of scanPairs keep the first grid point of their pairs
+    std::sort(t_vecPairIdx.begin(), t_vecPairIdx.end());
+    t_vecPairIdx.erase(std::unique(t_vecPairIdx.begin(), t_vecPairIdx.end()), t_vecPairIdx.end());
+
+    return Eigen::Map<Eigen::VectorXi>(t_vecPairIdx.data(), t_vecPairIdx.size());
+}
+
+
 //*************************************************************************************************************
 
 void RapMusic::calcPairCombinations(    const int p_iNumPoints,
@@ -855,14 +1250,12 @@ void RapMusic::getPointPair(const int p_iPoints, const int p_iCurIdx, int &p_iId
 
 
 //*************************************************************************************************************
-//ToDo don't make a real copy
+
 void RapMusic::getGainMatrixPair(   const MatrixXT& p_matGainMarix,
                                     MatrixX6T& p_matGainMarix_Pair,
                                     int p_iIdx1, int p_iIdx2)
 {
-    p_matGainMarix_Pair.block(0,0,p_matGainMarix.rows(),3) = p_matGainMarix.block(0, p_iIdx1*3, p_matGainMarix.rows(), 3);
-
-    p_matGainMarix_Pair.block(0,3,p_matGainMarix.rows(),3) = p_matGainMarix.block(0, p_iIdx2*3, p_matGainMarix.rows(), 3);
+    RapMusicKernel<double>::gainMatrixPair(p_matGainMarix, p_iIdx1, p_iIdx2, p_matGainMarix_Pair);
 }
 
 
@@ -907,3 +1300,58 @@ void RapMusic::setStcAttr(int p_iSampStcWin, float p_fStcOverlap)
     m_iSamplesStcWindow = p_iSampStcWin;
     m_fStcOverlap = p_fStcOverlap;
 }
+
+
+//*************************************************************************************************************
+
+void RapMusic::setStreamAttr(int p_iSampWindow, int p_iNumNeighbors, int p_iSubspaceRank, int p_iFullSearchInterval)
+{
+    m_iStreamWindow = p_iSampWindow;
+    m_iStreamNumNeighbors = p_iNumNeighbors;
+    m_iStreamSubspaceRank = p_iSubspaceRank;
+    m_iStreamFullSearchInterval = p_iFullSearchInterval;
+
+    resetStream();
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::resetStream()
+{
+    m_iStreamWriteIdx = 0;
+    m_iStreamNumSamples = 0;
+    m_iStreamNumWindows = 0;
+
+    m_matStreamWindow = MatrixXT::Zero(m_iNumChannels, std::max(m_iStreamWindow, 0));
+    m_matStreamCov = MatrixXT::Zero(m_iNumChannels, m_iNumChannels);
+    m_matStreamPhi_s.resize(m_iNumChannels, 0);
+    m_qListStreamDipoles.clear();
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::setBlockedSearch(bool p_bBlockedSearch)
+{
+    m_bBlockedSearch = p_bBlockedSearch;
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::setUseGpu(bool p_bUseGpu)
+{
+    m_bUseGpu = p_bUseGpu;
+    m_pGpuLeadField.clear();
+
+    if(!m_bUseGpu || !m_bIsInit || !CudaMatrixProduct::isAvailable())
+        return;
+
+    m_pGpuLeadField = CudaMatrixProduct::SPtr(new CudaMatrixProduct());
+    if(!m_pGpuLeadField->setMatrix(m_ForwardSolution.sol->data))
+    {
+        qWarning("RapMusic::setUseGpu - Could not upload the lead field to the GPU, using the CPU.");
+        m_pGpuLeadField.clear();
+    }
+}
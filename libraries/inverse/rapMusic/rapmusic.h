@@ -44,6 +44,8 @@
 #include "../IInverseAlgorithm.h"
 
 #include "dipole.h"
+#include "rapmusickernel.h"
+#include "../minimumNorm/cuda/cudamatrixproduct.h"
 
 #include <mne/mne_forwardsolution.h>
 #include <mne/mne_sourceestimate.h>
@@ -146,8 +148,9 @@ public:
     * @param[in] p_iN           The number (default 2) of uncorrelated sources, which should be found. Starting with
     *                           the strongest.
     * @param[in] p_dThr         The correlation threshold (default 0.5) at which the search for sources stops.
+    * @param[in] p_bSinglePrecision Scan the pairs in single precision, see init.
     */
-    RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN = 2, double p_dThr = 0.5);
+    RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN = 2, double p_dThr = 0.5, bool p_bSinglePrecision = false);
 
     virtual ~RapMusic();
 
@@ -160,9 +163,12 @@ public:
     * @param[in] p_iN           The number (default 2) of uncorrelated sources, which should be found. Starting with
     *                           the strongest.
     * @param[in] p_dThr         The correlation threshold (default 0.5) at which the search for sources stops.
+    * @param[in] p_bSinglePrecision Scan the pairs of the (not blocked) search with the float instantiation of
+    *                           RapMusicKernel on a float copy of the lead field. The found pair and its direction
+    *                           are still computed in double precision. Default is false.
     * @return   true if successful initialized, false otherwise.
     */
-    bool init(MNEForwardSolution& p_pFwd, bool p_bSparsed = false, int p_iN = 2, double p_dThr = 0.5);
+    bool init(MNEForwardSolution& p_pFwd, bool p_bSparsed = false, int p_iN = 2, double p_dThr = 0.5, bool p_bSinglePrecision = false);
 
     virtual MNESourceEstimate calculateInverse(const FiffEvoked &p_fiffEvoked, bool pick_normal = false);
 
@@ -183,6 +189,64 @@ public:
     */
     void setStcAttr(int p_iSampStcWin, float p_fStcOverlap);
 
+    //=========================================================================================================
+    /**
+    * Switches the pair scan to the blocked search. The projected gain blocks of all grid points are formed once
+    * per iteration, the pairs are evaluated in cache-sized tiles which the threads pick up dynamically (see
+    * scanPairs), and the orthogonal projector and the projected lead field are updated with each found source
+    * instead of being recomputed (see updateOrthProj). The correlations are the same as with the SVD based
+    * subcorr.
+    *
+    * @param[in] p_bBlockedSearch   Use the blocked search. Default is false.
+    */
+    void setBlockedSearch(bool p_bBlockedSearch);
+
+    //=========================================================================================================
+    /**
+    * Runs the blocked search with the lead field resident on the GPU, which then computes the projections of the
+    * whole lead field as one product per iteration (see projectLeadField). Requires a build with
+    * MNECPP_CONFIG+=withCuda and a CUDA device, otherwise the blocked search runs on the CPU.
+    *
+    * @param[in] p_bUseGpu  Use the GPU backend. Default is false.
+    */
+    void setUseGpu(bool p_bUseGpu);
+
+    //=========================================================================================================
+    /**
+    * Sets the attributes of the streaming mode, see calculateInverseStream, and resets the stream.
+    *
+    * @param[in] p_iSampWindow          Samples of the sliding window.
+    * @param[in] p_iNumNeighbors        Number of grid points around each dipole of the previous window which are
+    *                                   searched in the next window (default 8).
+    * @param[in] p_iSubspaceRank        Dimension of the tracked signal subspace (default - 1 = two per source).
+    * @param[in] p_iFullSearchInterval  Number of windows after which the whole grid is searched again, to pick up
+    *                                   new sources (default 50, 0 = only if no dipole is known).
+    */
+    void setStreamAttr(int p_iSampWindow, int p_iNumNeighbors = 8, int p_iSubspaceRank = -1, int p_iFullSearchInterval = 50);
+
+    //=========================================================================================================
+    /**
+    * Drops the samples of the sliding window and the dipoles of the previous window.
+    */
+    void resetStream();
+
+    //=========================================================================================================
+    /**
+    * Streaming mode: appends a block of raw data to the sliding window and localizes the window. The window
+    * covariance is updated with a rank one update per incoming and outgoing sample, and the signal subspace is
+    * tracked by one subspace iteration started at the subspace of the previous window instead of a full SVD.
+    * The r-th source is only searched among the pairs of the neighbors of the r-th dipole pair of the previous
+    * window, so that the time per window does not depend on the number of pair combinations. The whole grid is
+    * only searched if there is no such dipole pair and every full search interval.
+    * setStreamAttr has to be called first.
+    *
+    * @param[in] p_matData  The new samples (channels x samples), the step size of the sliding window.
+    * @param[in] tmin       Time of the first sample of p_matData.
+    * @param[in] tstep      Time between two samples.
+    * @return   The source estimate of the window for the times of p_matData, empty while the window is filling.
+    */
+    MNESourceEstimate calculateInverseStream(const MatrixXd& p_matData, float tmin, float tstep);
+
 protected:
     //=========================================================================================================
     /**
@@ -228,6 +292,73 @@ protected:
     */
     static double subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vector6T& p_vec_phi_k_1);
 
+    //=========================================================================================================
+    /**
+    * Projects the whole lead field for the blocked search on the GPU, see stackLeadField for the layout of the
+    * results. Falls back to an Eigen product if the lead field is not resident on the GPU.
+    *
+    * @param[in] p_matOrthProj      The orthogonal projector.
+    * @param[in] p_matU_B           The matrix U is the subspace projection of the orthogonal projected Phi_s
+    * @param[out] p_matStacked      The stacked projections, (m + rank of U_B) x 3 grid points.
+    * @param[out] p_matGramDiag     The gram matrices of each grid point, 6 x 3 grid points.
+    */
+    void projectLeadField(const MatrixXT& p_matOrthProj,
+                          const MatrixXT& p_matU_B,
+                          MatrixXT& p_matStacked,
+                          MatrixXT& p_matGramDiag) const;
+
+    //=========================================================================================================
+    /**
+    * Forms the projected gain blocks of the blocked search from the already projected lead field. The first m
+    * rows of the stacked result hold the orthogonal projected lead field, the remaining rows its projection onto
+    * U_B. The first three rows of the gram result hold G_i^T G_i of each grid point i, the last three rows the
+    * same for the projection onto U_B.
+    *
+    * @param[in] p_matProj_LeadField    The orthogonal projected lead field (m x 3 grid points).
+    * @param[in] p_matU_B               The matrix U is the subspace projection of the orthogonal projected Phi_s
+    * @param[out] p_matStacked          The stacked projections, (m + rank of U_B) x 3 grid points.
+    * @param[out] p_matGramDiag         The gram matrices of each grid point, 6 x 3 grid points.
+    */
+    static void stackLeadField(const MatrixXT& p_matProj_LeadField,
+                               const MatrixXT& p_matU_B,
+                               MatrixXT& p_matStacked,
+                               MatrixXT& p_matGramDiag);
+
+    //=========================================================================================================
+    /**
+    * Evaluates the correlations of the given pairs with subcorrPair. Consecutive pairs share their first grid
+    * point and a contiguous range of second grid points, so the pairs are split into tiles whose gain blocks fit
+    * into the cache. The threads take the tiles dynamically.
+    *
+    * @param[in] p_matStacked       The stacked projections of stackLeadField.
+    * @param[in] p_matGramDiag      The gram matrices of stackLeadField.
+    * @param[in] p_vecPairIdx       The pair combination indices to evaluate, all combinations if empty.
+    * @param[out] p_vecRoh          The correlations, indexed by pair combination.
+    */
+    void scanPairs(const MatrixXT& p_matStacked,
+                   const MatrixXT& p_matGramDiag,
+                   const Eigen::VectorXi& p_vecPairIdx,
+                   VectorXT& p_vecRoh) const;
+
+    //=========================================================================================================
+    /**
+    * Computes the same correlation as subcorr(MatrixX6T&, const MatrixXT&) from the outputs of stackLeadField,
+    * without a SVD of the m x 6 pair. The correlation is the largest singular value of U_A^T * U_B, which is the
+    * square root of the largest eigenvalue of W^T * (G^T U_B U_B^T G) * W with W = V_A / Sigma_A taken from the
+    * eigen decomposition of the 6 x 6 gram matrix G^T G over the retained components.
+    *
+    * @param[in] p_matStacked       The stacked projections of stackLeadField.
+    * @param[in] p_matGramDiag      The gram matrices of stackLeadField.
+    * @param[in] p_iNumChannels     The number of channels m.
+    * @param[in] p_iIdx1            First Lead Field index point.
+    * @param[in] p_iIdx2            Second Lead Field index point.
+    * @return   The maximal correlation c_1 of the subspace correlation.
+    */
+    static double subcorrPair(const MatrixXT& p_matStacked,
+                              const MatrixXT& p_matGramDiag,
+                              int p_iNumChannels,
+                              int p_iIdx1, int p_iIdx2);
+
     //=========================================================================================================
     /**
     * Calculates the accumulated manifold vectors A_{k1}
@@ -252,6 +383,43 @@ protected:
     */
     void calcOrthProj(const MatrixXT& p_matA_k_1, MatrixXT& p_matOrthProj) const;
 
+    //=========================================================================================================
+    /**
+    * Removes a newly found manifold vector from the orthogonal projector and the projected lead field. This
+    * gives the same projector as calcOrthProj over all manifold vectors found so far, at the cost of rank one
+    * updates.
+    *
+    * @param[in] p_vec_a_theta_k_1      The manifold vector of the found source.
+    * @param[in, out] p_matOrthProj     The orthogonal projector.
+    * @param[in, out] p_matProj_LeadField   The orthogonal projected lead field.
+    */
+    static void updateOrthProj(const VectorXT& p_vec_a_theta_k_1,
+                               MatrixXT& p_matOrthProj,
+                               MatrixXT& p_matProj_LeadField);
+
+    //=========================================================================================================
+    /**
+    * Returns the pair combination indices of all pairs of the neighbors of two grid points, i.e. the search space
+    * of a dipole pair found in the previous window.
+    *
+    * @param[in] p_iIdx1    First Lead Field index point.
+    * @param[in] p_iIdx2    Second Lead Field index point.
+    * @return   The sorted pair combination indices, empty if the grid has no source locations.
+    */
+    Eigen::VectorXi getNeighborPairs(int p_iIdx1, int p_iIdx2) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the index of the pair (p_iIdx1, p_iIdx2) with p_iIdx1 <= p_iIdx2 in the pair combinations, the
+    * inverse of getPointPair.
+    *
+    * @param[in] p_iPoints  The number of points n which are combined with each other.
+    * @param[in] p_iIdx1    Index 1.
+    * @param[in] p_iIdx2    Index 2.
+    * @return   The combination index.
+    */
+    static inline int getPairIdx(const int p_iPoints, const int p_iIdx1, const int p_iIdx2);
+
     //=========================================================================================================
     /**
     * Pre-Calculates the gain matrix index combinations to search for a two dipole independent topography
@@ -330,10 +498,31 @@ protected:
 
     bool m_bIsInit; /**< Whether the algorithm is initialized. */
 
+    bool m_bSinglePrecision;            /**< Whether the pairs are scanned in single precision. */
+    Eigen::MatrixXf m_matLeadFieldFloat;    /**< Float copy of the lead field, only set in single precision mode. */
+
+    bool m_bBlockedSearch;                      /**< Whether the blocked search is used. */
+    bool m_bUseGpu;                             /**< Whether the blocked search uses the GPU backend. */
+    CudaMatrixProduct::SPtr m_pGpuLeadField;    /**< The lead field resident on the GPU, only set in GPU mode. */
+
     //Stc stuff
     int m_iSamplesStcWindow;    /**< Number of samples per localization window */
     float m_fStcOverlap;        /**< Percentage of localization window overlap */
 
+    //Streaming stuff
+    int m_iStreamWindow;                /**< Samples of the sliding window, - 1 = streaming mode not set */
+    int m_iStreamNumNeighbors;          /**< Number of grid points searched around a dipole of the previous window */
+    int m_iStreamSubspaceRank;          /**< Dimension of the tracked signal subspace, - 1 = two per source */
+    int m_iStreamFullSearchInterval;    /**< Number of windows after which the whole grid is searched again */
+    int m_iStreamWriteIdx;              /**< Column of m_matStreamWindow which is overwritten next */
+    qint64 m_iStreamNumSamples;         /**< Number of samples received since the stream was reset */
+    qint64 m_iStreamNumWindows;         /**< Number of localized windows since the stream was reset */
+    MatrixXT m_matStreamWindow;         /**< The samples of the sliding window as a ring of columns */
+    MatrixXT m_matStreamCov;            /**< Lower triangle of the sum of x*x^T over the sliding window */
+    MatrixXT m_matStreamPhi_s;          /**< The tracked signal subspace */
+    VectorXT m_vecStreamRoh;            /**< Correlations of the pair combinations, only the scanned ones are valid */
+    QList< DipolePair<double> > m_qListStreamDipoles;  /**< The dipole pairs of the previous window */
+
     //=========================================================================================================
     /**
     * Returns the rank r of a singular value matrix based on non-zero singular values
@@ -407,6 +596,15 @@ inline int RapMusic::useFullRank(   const MatrixXT& p_Mat,
 }
 
 
+//*************************************************************************************************************
+
+inline int RapMusic::getPairIdx(const int p_iPoints, const int p_iIdx1, const int p_iIdx2)
+{
+    //Row p_iIdx1 of the combinations starts after the p_iPoints + (p_iPoints-1) + ... pairs of the rows before
+    return p_iIdx1*p_iPoints - p_iIdx1*(p_iIdx1-1)/2 + (p_iIdx2 - p_iIdx1);
+}
+
+
 //*************************************************************************************************************
 
 inline RapMusic::MatrixXT RapMusic::makeSquareMat(const MatrixXT& p_matF)
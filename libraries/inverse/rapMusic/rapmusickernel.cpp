@@ -0,0 +1,180 @@
+//=============================================================================================================
+/**
+* @file     rapmusickernel.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the RapMusicKernel class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rapmusickernel.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Eigenvalues>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace INVERSELIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename T>
+RapMusicKernel<T>::Workspace::Workspace(int p_iNumChannels, int p_iRankU_B)
+: svdG(p_iNumChannels, 6, Eigen::ComputeFullV)
+, matGtU_B(6, p_iRankU_B)
+{
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void RapMusicKernel<T>::gainMatrixPair(const MatrixXT& p_matLeadField, int p_iIdx1, int p_iIdx2, MatrixX6T& p_matPair)
+{
+    p_matPair.template leftCols<3>() = p_matLeadField.template middleCols<3>(3*p_iIdx1);
+    p_matPair.template rightCols<3>() = p_matLeadField.template middleCols<3>(3*p_iIdx2);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+double RapMusicKernel<T>::subcorr(const MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Workspace& p_workspace)
+{
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6> t_matW;
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6> t_matCor;
+    correlation(p_matProj_G, p_matU_B, p_workspace, t_matW, t_matCor);
+
+    Eigen::SelfAdjointEigenSolver< Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6> > t_eigCor(t_matCor, Eigen::EigenvaluesOnly);
+
+    //Take only the correlation of the first principal components
+    return std::sqrt((double)std::max(t_eigCor.eigenvalues()(t_matCor.rows()-1), T(0)));
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+double RapMusicKernel<T>::subcorr(const MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Workspace& p_workspace, Vector6T& p_vecPhi_k_1)
+{
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6> t_matW;
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6> t_matCor;
+    correlation(p_matProj_G, p_matU_B, p_workspace, t_matW, t_matCor);
+
+    //The first left singular vector U_C of C is the leading eigenvector of C * C^T
+    Eigen::SelfAdjointEigenSolver< Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6> > t_eigCor(t_matCor);
+    const int t_iRank = t_matCor.rows();
+
+    //X = V_A*Sigma_A^-1*U_C, u1 = x1/||x1|| this is the orientation
+    Vector6T t_vecX = t_matW * t_eigCor.eigenvectors().col(t_iRank-1);
+    p_vecPhi_k_1 = t_vecX / t_vecX.norm();
+
+    return std::sqrt((double)std::max(t_eigCor.eigenvalues()(t_iRank-1), T(0)));
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void RapMusicKernel<T>::correlation(const MatrixX6T& p_matProj_G,
+                                    const MatrixXT& p_matU_B,
+                                    Workspace& p_workspace,
+                                    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6>& p_matW,
+                                    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6>& p_matCor)
+{
+    p_workspace.svdG.compute(p_matProj_G, Eigen::ComputeFullV);
+    const Vector6T& t_vecSigma = p_workspace.svdG.singularValues();
+
+    //lt. Mosher 1998: Only Retain those Components of U_A that correspond to nonzero singular values
+    int t_iRank = 1;
+    while(t_iRank < 6 && t_vecSigma(t_iRank) > T(0.00001))
+        ++t_iRank;
+
+    //W = V_A / Sigma_A, so that C = W^T * G^T * U_B and C * C^T = W^T * M * W
+    p_matW.resize(6, t_iRank);
+    for(int k = 0; k < t_iRank; ++k)
+        p_matW.col(k) = p_workspace.svdG.matrixV().col(k) / t_vecSigma(k);
+
+    p_workspace.matGtU_B.noalias() = p_matProj_G.transpose() * p_matU_B;
+    Matrix6T t_matM;
+    t_matM.noalias() = p_workspace.matGtU_B * p_workspace.matGtU_B.transpose();
+
+    p_matCor.noalias() = p_matW.transpose() * t_matM * p_matW;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void RapMusicKernel<T>::calcA_k_1(const MatrixX6T& p_matG_k_1, const Vector6T& p_vecPhi_k_1, int p_iIdxk_1, MatrixXT& p_matA_k_1)
+{
+    //a_theta_k_1 = G_k_1*phi_k_1 this corresponds to the normalized signal component in subspace r
+    p_matA_k_1.col(p_iIdxk_1).noalias() = p_matG_k_1 * p_vecPhi_k_1;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EXPLICIT INSTANTIATIONS
+//=============================================================================================================
+
+namespace INVERSELIB
+{
+
+template class INVERSESHARED_EXPORT RapMusicKernel<double>;
+template class INVERSESHARED_EXPORT RapMusicKernel<float>;
+
+}
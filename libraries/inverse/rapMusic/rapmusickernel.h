@@ -0,0 +1,182 @@
+//=============================================================================================================
+/**
+* @file     rapmusickernel.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the RapMusicKernel class.
+*
+*/
+
+#ifndef RAPMUSICKERNEL_H
+#define RAPMUSICKERNEL_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../inverse_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SVD>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE INVERSELIB
+//=============================================================================================================
+
+namespace INVERSELIB
+{
+
+//=============================================================================================================
+/**
+* The per pair kernels of the RAP MUSIC scan with the 6 columns of a dipole pair fixed at compile time, so the
+* SVD of a pair reduces to one QR of the m x 6 pair and a Jacobi SVD of its fixed size 6 x 6 triangle, and every
+* further step works on 6 x 6 matrices on the stack. The dynamically sized buffers live in a Workspace, which
+* every thread allocates once per scan. Explicitly instantiated for double and float.
+*
+* The subspace correlation is the largest singular value of C = U_A^T * U_B with G = U_A * Sigma_A * V_A^T. It
+* is obtained from C = Sigma_A^-1 * V_A^T * (G^T * U_B) without forming U_A.
+*
+* @brief Fixed size RAP MUSIC pair kernels.
+*/
+template<typename T>
+class RapMusicKernel
+{
+public:
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> MatrixXT;     /**< Dynamic matrix of the precision. */
+    typedef Eigen::Matrix<T, Eigen::Dynamic, 6> MatrixX6T;                  /**< Dipole pair, channels x 6. */
+    typedef Eigen::Matrix<T, 6, Eigen::Dynamic> Matrix6XT;                  /**< Projection of a pair, 6 x rank of U_B. */
+    typedef Eigen::Matrix<T, 6, 6> Matrix6T;                                /**< 6 x 6 matrix. */
+    typedef Eigen::Matrix<T, 6, 1> Vector6T;                                /**< 6 vector. */
+
+    //=========================================================================================================
+    /**
+    * The buffers of the kernels which depend on the number of channels or the rank of U_B. A workspace must
+    * only be used by one thread at a time.
+    */
+    struct Workspace
+    {
+        //=====================================================================================================
+        /**
+        * Allocates the buffers.
+        *
+        * @param[in] p_iNumChannels     The number of channels m.
+        * @param[in] p_iRankU_B         The number of columns of U_B.
+        */
+        Workspace(int p_iNumChannels, int p_iRankU_B);
+
+        Eigen::JacobiSVD<MatrixX6T> svdG;   /**< The SVD of the pair, allocated for m x 6. */
+        Matrix6XT matGtU_B;                 /**< G^T * U_B. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Copies the gain blocks of two grid points into a pair.
+    *
+    * @param[in] p_matLeadField     The Lead Field matrix.
+    * @param[in] p_iIdx1            First Lead Field index point.
+    * @param[in] p_iIdx2            Second Lead Field index point.
+    * @param[out] p_matPair         The Lead Field combination (m x 6), has to be allocated.
+    */
+    static void gainMatrixPair(const MatrixXT& p_matLeadField, int p_iIdx1, int p_iIdx2, MatrixX6T& p_matPair);
+
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of a projected pair and U_B. Only the components of U_A with nonzero
+    * singular values are retained, see RapMusic::getRank.
+    *
+    * @param[in] p_matProj_G    The projected Lead Field combination (m x 6).
+    * @param[in] p_matU_B       The matrix U is the subspace projection of the orthogonal projected Phi_s.
+    * @param[in] p_workspace    The workspace of the calling thread.
+    * @return   The maximal correlation c_1.
+    */
+    static double subcorr(const MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Workspace& p_workspace);
+
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of a projected pair and U_B, as well as the resulting direction. As for
+    * the correlation, the components with zero singular values are dropped, so that the pair of a grid point
+    * with itself gets a defined direction.
+    *
+    * @param[in] p_matProj_G    The projected Lead Field combination (m x 6).
+    * @param[in] p_matU_B       The matrix U is the subspace projection of the orthogonal projected Phi_s.
+    * @param[in] p_workspace    The workspace of the calling thread.
+    * @param[out] p_vecPhi_k_1  The orientation of the pair (phi_x1, phi_y1, phi_z1, phi_x2, phi_y2, phi_z2).
+    * @return   The maximal correlation c_1.
+    */
+    static double subcorr(const MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Workspace& p_workspace, Vector6T& p_vecPhi_k_1);
+
+    //=========================================================================================================
+    /**
+    * Writes the manifold vector G_k_1 * phi_k_1 of a found pair into A_k_1.
+    *
+    * @param[in] p_matG_k_1     The Lead Field combination of the found pair.
+    * @param[in] p_vecPhi_k_1   The direction of the found pair.
+    * @param[in] p_iIdxk_1      The column of A_k_1.
+    * @param[out] p_matA_k_1    The array of the manifold vectors.
+    */
+    static void calcA_k_1(const MatrixX6T& p_matG_k_1, const Vector6T& p_vecPhi_k_1, int p_iIdxk_1, MatrixXT& p_matA_k_1);
+
+private:
+    //=========================================================================================================
+    /**
+    * Computes W = V_A / Sigma_A over the retained components and C * C^T = W^T * G^T * U_B * U_B^T * G * W.
+    *
+    * @param[in] p_matProj_G    The projected Lead Field combination (m x 6).
+    * @param[in] p_matU_B       The matrix U is the subspace projection of the orthogonal projected Phi_s.
+    * @param[in] p_workspace    The workspace of the calling thread.
+    * @param[out] p_matW        W (6 x rank of G).
+    * @param[out] p_matCor      C * C^T (rank of G x rank of G).
+    */
+    static void correlation(const MatrixX6T& p_matProj_G,
+                            const MatrixXT& p_matU_B,
+                            Workspace& p_workspace,
+                            Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6>& p_matW,
+                            Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 6, 6>& p_matCor);
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EXPLICIT INSTANTIATIONS
+//=============================================================================================================
+
+extern template class INVERSESHARED_EXPORT RapMusicKernel<double>;
+extern template class INVERSESHARED_EXPORT RapMusicKernel<float>;
+
+} //NAMESPACE
+
+#endif // RAPMUSICKERNEL_H
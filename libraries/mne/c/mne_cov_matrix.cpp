@@ -390,7 +390,7 @@ MneCovMatrix *MneCovMatrix::mne_dup_cov(MneCovMatrix *c)
     res->bads = c->bads;
     res->nbad = c->nbad;
     res->proj = MneProjOp::mne_dup_proj_op(c->proj);
-    res->sss  = new MneSssData(*(c->sss));
+    res->sss  = c->sss ? new MneSssData(*(c->sss)) : NULL;
 
     return res;
 }
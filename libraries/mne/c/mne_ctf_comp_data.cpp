@@ -132,6 +132,10 @@ MneCTFCompData::MneCTFCompData(const MneCTFCompData& comp)
 
     presel     = new FiffSparseMatrix(*comp.presel);
     postsel    = new FiffSparseMatrix(*comp.postsel);
+
+    comp_mat   = comp.comp_mat;
+    comp_pick  = comp.comp_pick;
+    data_pick  = comp.data_pick;
 }
 
 
@@ -135,6 +135,9 @@ public:
     float           *presel_data;           /* These are used for the intermediate results in the calculations */
     float           *comp_data;
     float           *postsel_data;
+    Eigen::MatrixXf comp_mat;               /* The compensation data as a dense matrix (made by mne_make_ctf_comp) */
+    Eigen::VectorXi comp_pick;              /* The compensation input channel for each column of comp_mat (presel as indices) */
+    Eigen::VectorXi data_pick;              /* The compensated channel for each row of comp_mat (postsel as indices) */
 
 //// ### OLD STRUCT ###
 //typedef struct {
@@ -48,6 +48,8 @@
 
 #include <fiff/fiff_types.h>
 
+#include <utils/linalg.h>
+
 
 #include <Eigen/Core>
 
@@ -91,6 +93,9 @@
 #define ALLOC_CMATRIX_32(x,y) mne_cmatrix_32((x),(y))
 
 
+#define MNE_CTF_COMP_BLOCK 256      /* Samples compensated at a time by mne_apply_ctf_comp_t */
+
+
 
 
 
@@ -506,33 +511,7 @@ int  mne_sparse_mat_mult2_32(FiffSparseMatrix* mat,     /* The sparse matrix */
       * Multiply a dense matrix by a sparse matrix.
       */
 {
-    int i,j,k;
-    float val;
-
-    if (mat->coding == FIFFTS_MC_RCS) {
-        for (i = 0; i < mat->m; i++) {
-            for (k = 0; k < ncol; k++) {
-                val = 0.0;
-                for (j = mat->ptrs[i]; j < mat->ptrs[i+1]; j++)
-                    val += mat->data[j]*mult[mat->inds[j]][k];
-                res[i][k] = val;
-            }
-        }
-    }
-    else if (mat->coding == FIFFTS_MC_CCS) {
-        for (k = 0; k < ncol; k++) {
-            for (i = 0; i < mat->m; i++)
-                res[i][k] = 0.0;
-            for (i = 0; i < mat->n; i++)
-                for (j = mat->ptrs[i]; j < mat->ptrs[i+1]; j++)
-                    res[mat->inds[j]][k] += mat->data[j]*mult[i][k];
-        }
-    }
-    else {
-        printf("mne_sparse_mat_mult2: unknown sparse matrix storage type: %d",mat->coding);
-        return -1;
-    }
-    return 0;
+    return mat->mult_mat(mult,ncol,res);
 }
 
 
@@ -545,29 +524,12 @@ float **mne_mat_mat_mult_32 (float **m1,float **m2,int d1,int d2,int d3)
       * result(d1 x d3) = m1(d1 x d2) * m2(d2 x d3) */
 
 {
-#ifdef BLAS
-    float **result = ALLOC_CMATRIX_32(d1,d3);
-    char  *transa = "N";
-    char  *transb = "N";
-    float zero = 0.0;
-    float one  = 1.0;
-    sgemm (transa,transb,&d3,&d1,&d2,
-           &one,m2[0],&d3,m1[0],&d2,&zero,result[0],&d3);
-    return (result);
-#else
+    /*
+     * The rows of ALLOC_CMATRIX are contiguous
+     */
     float **result = ALLOC_CMATRIX_32(d1,d3);
-    int j,k,p;
-    float sum;
-
-    for (j = 0; j < d1; j++)
-        for (k = 0; k < d3; k++) {
-            sum = 0.0;
-            for (p = 0; p < d2; p++)
-                sum = sum + m1[j][p]*m2[p][k];
-            result[j][k] = sum;
-        }
+    UTILSLIB::LinAlg::multiply(m1[0],m2[0],result[0],d1,d2,d3);
     return (result);
-#endif
 }
 
 
@@ -581,28 +543,7 @@ int  mne_sparse_vec_mult2_32(FiffSparseMatrix* mat,     /* The sparse matrix */
       * Multiply a vector by a sparse matrix.
       */
 {
-    int i,j;
-
-    if (mat->coding == FIFFTS_MC_RCS) {
-        for (i = 0; i < mat->m; i++) {
-            res[i] = 0.0;
-            for (j = mat->ptrs[i]; j < mat->ptrs[i+1]; j++)
-                res[i] += mat->data[j]*vector[mat->inds[j]];
-        }
-        return 0;
-    }
-    else if (mat->coding == FIFFTS_MC_CCS) {
-        for (i = 0; i < mat->m; i++)
-            res[i] = 0.0;
-        for (i = 0; i < mat->n; i++)
-            for (j = mat->ptrs[i]; j < mat->ptrs[i+1]; j++)
-                res[mat->inds[j]] += mat->data[j]*vector[i];
-        return 0;
-    }
-    else {
-        printf("mne_sparse_vec_mult2: unknown sparse matrix storage type: %d",mat->coding);
-        return -1;
-    }
+    return mat->mult_vec(vector,res);
 }
 
 
@@ -966,6 +907,17 @@ int MneCTFCompDataSet::mne_make_ctf_comp(MneCTFCompDataSet* set, fiffChInfo chs,
     set->current->data     = data;
     set->current->presel   = presel;
     set->current->postsel  = postsel;
+    /*
+     * The selectors as channel indices and the compensation data as a dense matrix for applying the compensation
+     */
+    set->current->comp_pick = Map<VectorXi>(comp_sel,this_comp->data->ncol);
+    set->current->data_pick.resize(data->nrow);
+    for (j = 0, p = 0; j < nch; j++)
+        if (comps[j] != MNE_CTFV_COMP_NONE)
+            set->current->data_pick[p++] = j;
+    set->current->comp_mat.resize(data->nrow,data->ncol);
+    for (j = 0; j < data->nrow; j++)
+        set->current->comp_mat.row(j) = Map<RowVectorXf>(data->data[j],data->ncol);
 
     fprintf(stderr,"\tCompensation set up.\n");
 
@@ -1056,6 +1008,26 @@ int MneCTFCompDataSet::mne_apply_ctf_comp(MneCTFCompDataSet *set, int do_it, flo
                this_comp->data->nrow,ndata);
         return FAIL;
     }
+    /*
+        * With the channel indices this does not need the shared workspace and can be used from many threads
+        */
+    if (this_comp->comp_pick.size() > 0) {
+        VectorXf ref(this_comp->comp_pick.size());
+        VectorXf res;
+
+        for (k = 0; k < ref.size(); k++)
+            ref[k] = compdata[this_comp->comp_pick[k]];
+        res.noalias() = this_comp->comp_mat*ref;
+        if (do_it) {
+            for (k = 0; k < res.size(); k++)
+                data[this_comp->data_pick[k]] -= res[k];
+        }
+        else {
+            for (k = 0; k < res.size(); k++)
+                data[this_comp->data_pick[k]] += res[k];
+        }
+        return OK;
+    }
     /*
         * Preselection is optional
         */
@@ -1145,6 +1117,32 @@ int MneCTFCompDataSet::mne_apply_ctf_comp_t(MneCTFCompDataSet *set, int do_it, f
                this_comp->data->nrow,ndata);
         return FAIL;
     }
+    /*
+        * With the channel indices, gather the compensation channels of a block of samples, multiply, and
+        * update the compensated channels in place. The reference channels of a block are read before any
+        * channel of it is written
+        */
+    if (this_comp->comp_pick.size() > 0) {
+        MatrixXf ref(this_comp->comp_pick.size(),MNE_CTF_COMP_BLOCK);
+        MatrixXf res;
+        int      p0,nb;
+
+        for (p0 = 0; p0 < ns; p0 += MNE_CTF_COMP_BLOCK) {
+            nb = ns - p0 < MNE_CTF_COMP_BLOCK ? ns - p0 : MNE_CTF_COMP_BLOCK;
+            for (k = 0; k < ref.rows(); k++)
+                ref.row(k).head(nb) = Map<RowVectorXf>(compdata[this_comp->comp_pick[k]]+p0,nb);
+            res.noalias() = this_comp->comp_mat*ref.leftCols(nb);
+            if (do_it) {
+                for (k = 0; k < res.rows(); k++)
+                    Map<RowVectorXf>(data[this_comp->data_pick[k]]+p0,nb) -= res.row(k);
+            }
+            else {
+                for (k = 0; k < res.rows(); k++)
+                    Map<RowVectorXf>(data[this_comp->data_pick[k]]+p0,nb) += res.row(k);
+            }
+        }
+        return OK;
+    }
     /*
         * Preselection is optional
         */
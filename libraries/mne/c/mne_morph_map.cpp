@@ -41,19 +41,182 @@
 
 #include "mne_morph_map.h"
 
+#include <fiff/c/fiff_sparse_matrix.h>
+#include <fiff/fiff_stream.h>
+#include <fiff/fiff_tag.h>
+#include <fs/surface.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <limits>
+
 
 #define FREE_45(x) if ((char *)(x) != NULL) free((char *)(x))
 
 #define SURF_UNKNOWN -1
 
+#define MORPH_MAP_BLOCK_ROWS    4096    /* Vertices per parallel block of make_morph_map */
+#define MORPH_MAP_GRID_MAX      128     /* Maximal number of cells of the sphere index along one axis */
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
 
+using namespace Eigen;
+using namespace FIFFLIB;
+using namespace FSLIB;
 using namespace MNELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Uniform grid over the cube around the unit sphere, the vertices of each cell are stored contiguously
+*/
+struct SphereIndex
+{
+    SphereIndex(const MatrixX3f& rr)
+    : m_rr(rr)
+    {
+        int n = rr.rows();
+
+        //About four vertices in each cell cut by the sphere
+        m_iRes = qBound(1, static_cast<int>(std::ceil(std::sqrt(n/(4.0*M_PI)))), MORPH_MAP_GRID_MAX);
+        m_fCell = 2.0f/m_iRes;
+
+        VectorXi vecCell(n);
+        m_vecStart = VectorXi::Zero(m_iRes*m_iRes*m_iRes + 1);
+        for(int i = 0; i < n; ++i) {
+            vecCell[i] = cell(coord(rr(i,0)), coord(rr(i,1)), coord(rr(i,2)));
+            m_vecStart[vecCell[i] + 1]++;
+        }
+        for(int c = 0; c < m_vecStart.size() - 1; ++c)
+            m_vecStart[c + 1] += m_vecStart[c];
+
+        VectorXi vecFill = m_vecStart.head(m_vecStart.size() - 1);
+        m_vecVerts.resize(n);
+        for(int i = 0; i < n; ++i)
+            m_vecVerts[vecFill[vecCell[i]]++] = i;
+    }
+
+    int coord(float x) const
+    {
+        return qBound(0, static_cast<int>((x + 1.0f)/m_fCell), m_iRes - 1);
+    }
+
+    int cell(int x, int y, int z) const
+    {
+        return (x*m_iRes + y)*m_iRes + z;
+    }
+
+    //Search the shells of cells around the point until no closer vertex can be found
+    int nearest(const Vector3f& p) const
+    {
+        int cx = coord(p[0]), cy = coord(p[1]), cz = coord(p[2]);
+        int iBest = -1;
+        float fBest = std::numeric_limits<float>::max();
+
+        for(int r = 0; r < m_iRes; ++r) {
+            //All cells of shell r are at least (r - 1) cells away from p
+            float fMin = (r - 1)*m_fCell;
+            if(iBest >= 0 && r > 1 && fMin*fMin >= fBest)
+                break;
+            for(int x = qMax(0, cx - r); x <= qMin(m_iRes - 1, cx + r); ++x)
+                for(int y = qMax(0, cy - r); y <= qMin(m_iRes - 1, cy + r); ++y)
+                    for(int z = qMax(0, cz - r); z <= qMin(m_iRes - 1, cz + r); ++z) {
+                        if(qMax(qAbs(x - cx), qMax(qAbs(y - cy), qAbs(z - cz))) != r)
+                            continue;
+                        int c = cell(x, y, z);
+                        for(int j = m_vecStart[c]; j < m_vecStart[c + 1]; ++j) {
+                            float d = (m_rr.row(m_vecVerts[j]).transpose() - p).squaredNorm();
+                            if(d < fBest) {
+                                fBest = d;
+                                iBest = m_vecVerts[j];
+                            }
+                        }
+                    }
+        }
+        return iBest;
+    }
+
+    const MatrixX3f&    m_rr;
+    int                 m_iRes;
+    float               m_fCell;
+    VectorXi            m_vecStart;
+    VectorXi            m_vecVerts;
+};
+
+
+//=============================================================================================================
+/**
+* Closest point of triangle abc to p (Ericson, Real-Time Collision Detection, 5.1.5). Returns the squared
+* distance and the barycentric weights of the closest point in w.
+*/
+float closestOnTriangle(const Vector3f& p, const Vector3f& a, const Vector3f& b, const Vector3f& c, Vector3f& w)
+{
+    Vector3f ab = b - a, ac = c - a, ap = p - a;
+    float d1 = ab.dot(ap), d2 = ac.dot(ap);
+
+    if(d1 <= 0.0f && d2 <= 0.0f) {
+        w << 1.0f, 0.0f, 0.0f;
+    }
+    else {
+        Vector3f bp = p - b;
+        float d3 = ab.dot(bp), d4 = ac.dot(bp);
+        Vector3f cp = p - c;
+        float d5 = ab.dot(cp), d6 = ac.dot(cp);
+        float vc = d1*d4 - d3*d2;
+        float vb = d5*d2 - d1*d6;
+        float va = d3*d6 - d5*d4;
+
+        if(d3 >= 0.0f && d4 <= d3)
+            w << 0.0f, 1.0f, 0.0f;
+        else if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+            w << 1.0f - d1/(d1 - d3), d1/(d1 - d3), 0.0f;
+        else if(d6 >= 0.0f && d5 <= d6)
+            w << 0.0f, 0.0f, 1.0f;
+        else if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+            w << 1.0f - d2/(d2 - d6), 0.0f, d2/(d2 - d6);
+        else if(va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+            w << 0.0f, 1.0f - (d4 - d3)/((d4 - d3) + (d5 - d6)), (d4 - d3)/((d4 - d3) + (d5 - d6));
+        else if(va + vb + vc > 0.0f)
+            w << 1.0f - (vb + vc)/(va + vb + vc), vb/(va + vb + vc), vc/(va + vb + vc);
+        else
+            w << 1.0f, 0.0f, 0.0f;     //Degenerate triangle
+    }
+
+    return (p - (w[0]*a + w[1]*b + w[2]*c)).squaredNorm();
+}
+
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -76,3 +239,256 @@ MneMorphMap::~MneMorphMap()
     delete map;
     FREE_45(best);
 }
+
+
+//*************************************************************************************************************
+
+SparseMatrix<double> MneMorphMap::make_morph_map(const MatrixX3f& matFromRr, const MatrixX3i& matFromTris, const MatrixX3f& matToRr)
+{
+    int nFrom = matFromRr.rows();
+    int nTo = matToRr.rows();
+
+    if(nFrom == 0 || matFromTris.rows() == 0 || matFromTris.minCoeff() < 0 || matFromTris.maxCoeff() >= nFrom) {
+        qWarning() << "MneMorphMap::make_morph_map - Invalid from surface.";
+        return SparseMatrix<double>();
+    }
+
+    SphereIndex index(matFromRr);
+
+    //
+    // Triangles around each from vertex
+    //
+    VectorXi vecTriStart = VectorXi::Zero(nFrom + 1);
+    for(int t = 0; t < matFromTris.rows(); ++t)
+        for(int j = 0; j < 3; ++j)
+            vecTriStart[matFromTris(t,j) + 1]++;
+    for(int i = 0; i < nFrom; ++i)
+        vecTriStart[i + 1] += vecTriStart[i];
+
+    VectorXi vecFill = vecTriStart.head(nFrom);
+    VectorXi vecTris(3*matFromTris.rows());
+    for(int t = 0; t < matFromTris.rows(); ++t)
+        for(int j = 0; j < 3; ++j)
+            vecTris[vecFill[matFromTris(t,j)]++] = t;
+
+    //
+    // Closest triangle of each to vertex among the ones around its nearest from vertex
+    //
+    MatrixX3i matVerts(nTo, 3);
+    MatrixX3f matWeights(nTo, 3);
+
+    auto morphBlock = [&](const QPair<int,int>& block) {
+        Vector3f w, wBest;
+
+        for(int i = block.first; i < block.first + block.second; ++i) {
+            Vector3f p = matToRr.row(i).transpose();
+            int v = index.nearest(p);
+            int iBest = -1;
+            float fBest = std::numeric_limits<float>::max();
+
+            for(int j = vecTriStart[v]; j < vecTriStart[v + 1]; ++j) {
+                int t = vecTris[j];
+                float d = closestOnTriangle(p,
+                                            matFromRr.row(matFromTris(t,0)).transpose(),
+                                            matFromRr.row(matFromTris(t,1)).transpose(),
+                                            matFromRr.row(matFromTris(t,2)).transpose(),
+                                            w);
+                if(d < fBest) {
+                    fBest = d;
+                    iBest = t;
+                    wBest = w;
+                }
+            }
+
+            if(iBest >= 0) {
+                matVerts.row(i) = matFromTris.row(iBest);
+                matWeights.row(i) = wBest.transpose();
+            }
+            else {
+                //Vertex without triangles
+                matVerts.row(i) << v, v, v;
+                matWeights.row(i) << 1.0f, 0.0f, 0.0f;
+            }
+        }
+    };
+
+    QList<QPair<int,int> > blocks;
+    for(int i = 0; i < nTo; i += MORPH_MAP_BLOCK_ROWS)
+        blocks.append(qMakePair(i, qMin(MORPH_MAP_BLOCK_ROWS, nTo - i)));
+
+    if(blocks.size() > 1)
+        QtConcurrent::blockingMap(blocks, morphBlock);
+    else if(blocks.size() == 1)
+        morphBlock(blocks.first());
+
+    typedef Eigen::Triplet<double> T;
+    std::vector<T> tripletList;
+    tripletList.reserve(3*nTo);
+    for(int i = 0; i < nTo; ++i)
+        for(int j = 0; j < 3; ++j)
+            if(matWeights(i,j) > 0.0f)
+                tripletList.push_back(T(i, matVerts(i,j), matWeights(i,j)));
+
+    SparseMatrix<double> matMap(nTo, nFrom);
+    matMap.setFromTriplets(tripletList.begin(), tripletList.end());
+
+    return matMap;
+}
+
+
+//*************************************************************************************************************
+
+bool MneMorphMap::read_morph_maps(const QString& sFileName, const QString& sSubjectFrom, const QString& sSubjectTo, QList<SparseMatrix<double> >& lMaps)
+{
+    lMaps.clear();
+
+    QFile t_file(sFileName);
+    FiffStream::SPtr t_pStream(new FiffStream(&t_file));
+    if(!t_pStream->open())
+        return false;
+
+    SparseMatrix<double> matLeft, matRight;
+    FiffTag::SPtr t_pTag;
+
+    QList<FiffDirNode::SPtr> maps = t_pStream->dirtree()->dir_tree_find(FIFFB_MNE_MORPH_MAP);
+    for(int k = 0; k < maps.size(); ++k) {
+        if(!maps[k]->find_tag(t_pStream, FIFF_MNE_MORPH_MAP_FROM, t_pTag) || t_pTag->toString() != sSubjectFrom)
+            continue;
+        if(!maps[k]->find_tag(t_pStream, FIFF_MNE_MORPH_MAP_TO, t_pTag) || t_pTag->toString() != sSubjectTo)
+            continue;
+        if(!maps[k]->find_tag(t_pStream, FIFF_MNE_HEMI, t_pTag))
+            continue;
+        int hemi = *t_pTag->toInt();
+        if(!maps[k]->find_tag(t_pStream, FIFF_MNE_MORPH_MAP, t_pTag))
+            continue;
+
+        if(hemi == FIFFV_MNE_SURF_LEFT_HEMI)
+            matLeft = t_pTag->toSparseFloatMatrix();
+        else if(hemi == FIFFV_MNE_SURF_RIGHT_HEMI)
+            matRight = t_pTag->toSparseFloatMatrix();
+    }
+    t_pStream->close();
+
+    if(matLeft.size() == 0 || matRight.size() == 0)
+        return false;
+
+    lMaps << matLeft << matRight;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MneMorphMap::write_morph_maps(const QString& sFileName, const QString& sSubjectFrom, const QString& sSubjectTo, const QList<SparseMatrix<double> >& lMaps, const QList<SparseMatrix<double> >& lMapsBack)
+{
+    if(lMaps.size() != 2 || (!lMapsBack.isEmpty() && lMapsBack.size() != 2)) {
+        qWarning() << "MneMorphMap::write_morph_maps - Left and right hemisphere maps are needed.";
+        return false;
+    }
+
+    QFile t_file(sFileName);
+    FiffStream::SPtr t_pStream = FiffStream::start_file(t_file);
+    if(!t_pStream)
+        return false;
+
+    for(int d = 0; d < (lMapsBack.isEmpty() ? 1 : 2); ++d) {
+        const QList<SparseMatrix<double> >& lWrite = d == 0 ? lMaps : lMapsBack;
+        for(int h = 0; h < 2; ++h) {
+            fiff_int_t hemi = h == 0 ? FIFFV_MNE_SURF_LEFT_HEMI : FIFFV_MNE_SURF_RIGHT_HEMI;
+
+            t_pStream->start_block(FIFFB_MNE_MORPH_MAP);
+            t_pStream->write_string(FIFF_MNE_MORPH_MAP_FROM, d == 0 ? sSubjectFrom : sSubjectTo);
+            t_pStream->write_string(FIFF_MNE_MORPH_MAP_TO, d == 0 ? sSubjectTo : sSubjectFrom);
+            t_pStream->write_int(FIFF_MNE_HEMI, &hemi);
+            t_pStream->write_float_sparse_rcs(FIFF_MNE_MORPH_MAP, lWrite[h].cast<float>());
+            t_pStream->end_block(FIFFB_MNE_MORPH_MAP);
+        }
+    }
+    t_pStream->end_file();
+    t_file.close();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MneMorphMap::get_morph_maps(const QString& sSubjectFrom, const QString& sSubjectTo, const QString& sSubjectsDir, QList<SparseMatrix<double> >& lMaps)
+{
+    lMaps.clear();
+
+    QString sMapDir = QString("%1/morph-maps").arg(sSubjectsDir);
+    QString sFileName = QString("%1/%2-%3-morph.fif").arg(sMapDir).arg(sSubjectFrom).arg(sSubjectTo);
+    QString sFileNameBack = QString("%1/%2-%3-morph.fif").arg(sMapDir).arg(sSubjectTo).arg(sSubjectFrom);
+
+    //
+    // Either file may hold both directions
+    //
+    if(QFileInfo(sFileName).exists() && read_morph_maps(sFileName, sSubjectFrom, sSubjectTo, lMaps))
+        return true;
+    if(QFileInfo(sFileNameBack).exists() && read_morph_maps(sFileNameBack, sSubjectFrom, sSubjectTo, lMaps))
+        return true;
+
+    //
+    // Compute them from the spherical registrations
+    //
+    QList<SparseMatrix<double> > lMapsBack;
+    for(int h = 0; h < 2; ++h) {
+        Surface t_surfFrom, t_surfTo;
+        if(!Surface::read(sSubjectFrom, h, "sphere.reg", sSubjectsDir, t_surfFrom, false) ||
+                !Surface::read(sSubjectTo, h, "sphere.reg", sSubjectsDir, t_surfTo, false)) {
+            qWarning() << "MneMorphMap::get_morph_maps - Could not read the sphere.reg surfaces of" << sSubjectFrom << "and" << sSubjectTo;
+            lMaps.clear();
+            return false;
+        }
+
+        MatrixX3f matFromRr = t_surfFrom.rr().rowwise().normalized();
+        MatrixX3f matToRr = t_surfTo.rr().rowwise().normalized();
+
+        lMaps << make_morph_map(matFromRr, t_surfFrom.tris(), matToRr);
+        if(sSubjectFrom != sSubjectTo)
+            lMapsBack << make_morph_map(matToRr, t_surfTo.tris(), matFromRr);
+    }
+
+    if(!QDir().mkpath(sMapDir) || !write_morph_maps(sFileName, sSubjectFrom, sSubjectTo, lMaps, lMapsBack))
+        qWarning() << "MneMorphMap::get_morph_maps - Could not save the morph maps to" << sFileName;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+SparseMatrix<double> MneMorphMap::pick_morph_map(const SparseMatrix<double>& matMap, const VectorXi& vecVertFrom, const VectorXi& vecVertTo)
+{
+    VectorXi vecCol = VectorXi::Constant(matMap.cols(), -1);
+    for(int j = 0; j < vecVertFrom.size(); ++j)
+        if(vecVertFrom[j] >= 0 && vecVertFrom[j] < matMap.cols())
+            vecCol[vecVertFrom[j]] = j;
+
+    SparseMatrix<double, RowMajor> matRows = matMap;
+
+    typedef Eigen::Triplet<double> T;
+    std::vector<T> tripletList;
+    for(int i = 0; i < vecVertTo.size(); ++i) {
+        if(vecVertTo[i] < 0 || vecVertTo[i] >= matRows.rows())
+            continue;
+
+        double dSum = 0.0;
+        size_t iFirst = tripletList.size();
+        for(SparseMatrix<double, RowMajor>::InnerIterator it(matRows, vecVertTo[i]); it; ++it) {
+            if(vecCol[it.col()] >= 0) {
+                tripletList.push_back(T(i, vecCol[it.col()], it.value()));
+                dSum += it.value();
+            }
+        }
+        if(dSum > 0.0)
+            for(size_t k = iFirst; k < tripletList.size(); ++k)
+                tripletList[k] = T(tripletList[k].row(), tripletList[k].col(), tripletList[k].value()/dSum);
+    }
+
+    SparseMatrix<double> matPicked(vecVertTo.size(), vecVertFrom.size());
+    matPicked.setFromTriplets(tripletList.begin(), tripletList.end());
+
+    return matPicked;
+}
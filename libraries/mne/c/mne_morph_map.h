@@ -49,6 +49,9 @@
 // Eigen INCLUDES
 //=============================================================================================================
 
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -56,6 +59,8 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QString>
+#include <QList>
 
 
 //*************************************************************************************************************
@@ -107,6 +112,92 @@ public:
     */
     ~MneMorphMap();
 
+    //=========================================================================================================
+    /**
+    * Computes the morph map from one spherical registration to another. Each vertex of the to surface is
+    * projected onto the closest triangle of the from surface, the weights are its barycentric coordinates.
+    * The nearest from vertex is found with a uniform grid over the sphere and only the triangles around it
+    * are searched. The to vertices are processed in parallel blocks.
+    *
+    * @param[in] matFromRr      Vertices of the from sphere (e.g. lh.sphere.reg), scaled to the unit sphere.
+    * @param[in] matFromTris    Triangles of the from sphere.
+    * @param[in] matToRr        Vertices of the to sphere, scaled to the unit sphere.
+    *
+    * @return the morph map of size matToRr.rows() x matFromRr.rows(), empty if the input is invalid.
+    */
+    static Eigen::SparseMatrix<double> make_morph_map(const Eigen::MatrixX3f& matFromRr,
+                                                      const Eigen::MatrixX3i& matFromTris,
+                                                      const Eigen::MatrixX3f& matToRr);
+
+    //=========================================================================================================
+    /**
+    * Reads the left and right hemisphere maps from sSubjectFrom to sSubjectTo of a morph map file as written by
+    * MNE-Python and MNE-C (morph-maps/<from>-<to>-morph.fif).
+    *
+    * @param[in] sFileName      The morph map file.
+    * @param[in] sSubjectFrom   The subject to morph from.
+    * @param[in] sSubjectTo     The subject to morph to.
+    * @param[out] lMaps         The left and right hemisphere morph maps.
+    *
+    * @return true if both maps were found, false otherwise.
+    */
+    static bool read_morph_maps(const QString& sFileName,
+                                const QString& sSubjectFrom,
+                                const QString& sSubjectTo,
+                                QList<Eigen::SparseMatrix<double> >& lMaps);
+
+    //=========================================================================================================
+    /**
+    * Writes morph maps in the morph map file format. The file holds the maps from sSubjectFrom to sSubjectTo
+    * and, if given, the ones back from sSubjectTo to sSubjectFrom.
+    *
+    * @param[in] sFileName      The morph map file.
+    * @param[in] sSubjectFrom   The subject to morph from.
+    * @param[in] sSubjectTo     The subject to morph to.
+    * @param[in] lMaps          The left and right hemisphere maps from sSubjectFrom to sSubjectTo.
+    * @param[in] lMapsBack      The left and right hemisphere maps from sSubjectTo to sSubjectFrom, may be empty.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    static bool write_morph_maps(const QString& sFileName,
+                                 const QString& sSubjectFrom,
+                                 const QString& sSubjectTo,
+                                 const QList<Eigen::SparseMatrix<double> >& lMaps,
+                                 const QList<Eigen::SparseMatrix<double> >& lMapsBack = QList<Eigen::SparseMatrix<double> >());
+
+    //=========================================================================================================
+    /**
+    * Returns the left and right hemisphere morph maps from sSubjectFrom to sSubjectTo. The maps are read from
+    * sSubjectsDir/morph-maps if they are there, otherwise they are computed from the lh.sphere.reg and
+    * rh.sphere.reg surfaces of both subjects and saved there together with the maps back.
+    *
+    * @param[in] sSubjectFrom   The subject to morph from.
+    * @param[in] sSubjectTo     The subject to morph to.
+    * @param[in] sSubjectsDir   The FreeSurfer subjects directory.
+    * @param[out] lMaps         The left and right hemisphere morph maps.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    static bool get_morph_maps(const QString& sSubjectFrom,
+                               const QString& sSubjectTo,
+                               const QString& sSubjectsDir,
+                               QList<Eigen::SparseMatrix<double> >& lMaps);
+
+    //=========================================================================================================
+    /**
+    * Restricts a morph map to the vertices of two source spaces. The rows are normalized to unit sum again,
+    * to vertices without weight on any of the from vertices get a zero row.
+    *
+    * @param[in] matMap         The morph map of one hemisphere.
+    * @param[in] vecVertFrom    The vertices in use in the from source space.
+    * @param[in] vecVertTo      The vertices in use in the to source space.
+    *
+    * @return the morph map of size vecVertTo.size() x vecVertFrom.size().
+    */
+    static Eigen::SparseMatrix<double> pick_morph_map(const Eigen::SparseMatrix<double>& matMap,
+                                                      const Eigen::VectorXi& vecVertFrom,
+                                                      const Eigen::VectorXi& vecVertTo);
+
 public:
     FIFFLIB::FiffSparseMatrix* map;		/* Multiply the data in the from surface with this to get to
                    * 'this' surface from the 'from' surface */
@@ -0,0 +1,277 @@
+//=============================================================================================================
+/**
+* @file     mne_raw_buf_cache.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the MneRawBufCache Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_raw_buf_cache.h"
+#include "mne_raw_buf_def.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMutexLocker>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MneRawBufCache::MneRawBufCache(qint64 iByteBudget)
+: m_pHead(NULL)
+, m_pTail(NULL)
+{
+    m_stats.iHits = 0;
+    m_stats.iMisses = 0;
+    m_stats.iEvictions = 0;
+    m_stats.iBytes = 0;
+    m_stats.iPeakBytes = 0;
+    m_stats.iBudget = iByteBudget;
+    m_stats.iBuffers = 0;
+}
+
+
+//*************************************************************************************************************
+
+MneRawBufCache::~MneRawBufCache()
+{
+    QMutexLocker locker(&m_qMutex);
+
+    while(m_pHead)
+        release(m_pHead);
+}
+
+
+//*************************************************************************************************************
+
+bool MneRawBufCache::pin(MneRawBufDef* buf)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    Entry* entry = m_qHashEntries.value(buf, NULL);
+    if(!entry)
+        return false;
+
+    entry->iPins++;
+    unlink(entry);
+    pushFront(entry);
+    m_stats.iHits++;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::allocate(MneRawBufDef* buf)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(m_qHashEntries.contains(buf)) {
+        qWarning("MneRawBufCache::allocate - Buffer is already resident.");
+        return;
+    }
+
+    const qint64 iSize = static_cast<qint64>(buf->nchan)*buf->ns;
+
+    Entry* entry = new Entry;
+    entry->owner = buf;
+    entry->iBytes = iSize*static_cast<qint64>(sizeof(float));
+    entry->iPins = 1;
+    entry->prev = NULL;
+    entry->next = NULL;
+
+    //
+    // Make room first, the entry is not yet in the list and cannot be taken back itself
+    //
+    m_stats.iBytes += entry->iBytes;
+    evict();
+
+    entry->data = new float[iSize];
+    entry->rows = new float*[buf->nchan > 0 ? buf->nchan : 1];
+    for(int j = 0; j < buf->nchan; ++j)
+        entry->rows[j] = entry->data + static_cast<qint64>(j)*buf->ns;
+
+    buf->vals = entry->rows;
+
+    pushFront(entry);
+    m_qHashEntries.insert(buf, entry);
+
+    m_stats.iMisses++;
+    m_stats.iBuffers++;
+    if(m_stats.iBytes > m_stats.iPeakBytes)
+        m_stats.iPeakBytes = m_stats.iBytes;
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::unpin(MneRawBufDef* buf)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    Entry* entry = m_qHashEntries.value(buf, NULL);
+    if(!entry || entry->iPins <= 0) {
+        qWarning("MneRawBufCache::unpin - Buffer is not pinned.");
+        return;
+    }
+
+    entry->iPins--;
+
+    //
+    // Budget exceeded by pinned buffers is given back as soon as they are released
+    //
+    if(entry->iPins == 0 && m_stats.iBytes > m_stats.iBudget)
+        evict();
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::remove(MneRawBufDef* bufs, int nbuf)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    for(int k = 0; k < nbuf; ++k) {
+        Entry* entry = m_qHashEntries.value(&bufs[k], NULL);
+        if(entry)
+            release(entry);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::setBudget(qint64 iByteBudget)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    m_stats.iBudget = iByteBudget;
+    evict();
+}
+
+
+//*************************************************************************************************************
+
+MneRawBufCache::Stats MneRawBufCache::stats() const
+{
+    QMutexLocker locker(&m_qMutex);
+
+    return m_stats;
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::unlink(Entry* entry)
+{
+    if(entry->prev)
+        entry->prev->next = entry->next;
+    else
+        m_pHead = entry->next;
+
+    if(entry->next)
+        entry->next->prev = entry->prev;
+    else
+        m_pTail = entry->prev;
+
+    entry->prev = entry->next = NULL;
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::pushFront(Entry* entry)
+{
+    entry->prev = NULL;
+    entry->next = m_pHead;
+
+    if(m_pHead)
+        m_pHead->prev = entry;
+    m_pHead = entry;
+
+    if(!m_pTail)
+        m_pTail = entry;
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::release(Entry* entry)
+{
+    unlink(entry);
+    m_qHashEntries.remove(entry->owner);
+
+    entry->owner->vals = NULL;
+    entry->owner->valid = 0;
+
+    m_stats.iBytes -= entry->iBytes;
+    m_stats.iBuffers--;
+
+    delete[] entry->rows;
+    delete[] entry->data;
+    delete entry;
+}
+
+
+//*************************************************************************************************************
+
+void MneRawBufCache::evict()
+{
+    Entry* entry = m_pTail;
+
+    while(entry && m_stats.iBytes > m_stats.iBudget) {
+        Entry* prev = entry->prev;
+        if(entry->iPins == 0) {
+            release(entry);
+            m_stats.iEvictions++;
+        }
+        entry = prev;
+    }
+}
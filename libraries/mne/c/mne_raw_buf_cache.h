@@ -0,0 +1,195 @@
+//=============================================================================================================
+/**
+* @file     mne_raw_buf_cache.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MneRawBufCache class declaration.
+*
+*/
+
+#ifndef MNERAWBUFCACHE_H
+#define MNERAWBUFCACHE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../mne_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QHash>
+#include <QMutex>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNELIB
+//=============================================================================================================
+
+namespace MNELIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class MneRawBufDef;
+
+
+//=============================================================================================================
+/**
+* Least recently used cache of the sample memory of raw and filtered buffers (Replaces the ring buffers of
+* mne_ringbuffer.c). The cache owns the memory it hands out as MneRawBufDef::vals and takes it back from the least
+* recently used buffer when the byte budget is exceeded, which clears vals of that buffer. Buffers are pinned
+* while they are read or written and are never taken back while pinned, so that several threads can use the
+* cache at the same time. All methods are thread safe.
+*
+* @brief LRU cache of raw data buffers with a byte budget
+*/
+class MNESHARED_EXPORT MneRawBufCache
+{
+public:
+    //=========================================================================================================
+    /**
+    * Cache statistics
+    */
+    struct Stats {
+        qint64 iHits;           /**< Number of pins of resident buffers. */
+        qint64 iMisses;         /**< Number of allocations. */
+        qint64 iEvictions;      /**< Number of buffers whose memory was taken back. */
+        qint64 iBytes;          /**< Bytes currently allocated. */
+        qint64 iPeakBytes;      /**< Maximum number of bytes allocated at once. */
+        qint64 iBudget;         /**< The byte budget. */
+        int    iBuffers;        /**< Number of resident buffers. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs the cache.
+    *
+    * @param[in] iByteBudget    Number of bytes the resident buffers may use.
+    */
+    explicit MneRawBufCache(qint64 iByteBudget);
+
+    //=========================================================================================================
+    /**
+    * Destroys the cache and clears vals of all resident buffers.
+    */
+    ~MneRawBufCache();
+
+    //=========================================================================================================
+    /**
+    * Pins a resident buffer and marks it as most recently used.
+    *
+    * @param[in] buf    The buffer.
+    *
+    * @return true if buf is resident and was pinned, false otherwise.
+    */
+    bool pin(MneRawBufDef* buf);
+
+    //=========================================================================================================
+    /**
+    * Gives a buffer which is not resident memory for buf->nchan x buf->ns samples, sets buf->vals and pins it.
+    * The rows are contiguous, buf->vals[0] points to a row-major buf->nchan x buf->ns matrix. Least recently
+    * used unpinned buffers are taken back while the budget is exceeded.
+    *
+    * @param[in] buf    The buffer.
+    */
+    void allocate(MneRawBufDef* buf);
+
+    //=========================================================================================================
+    /**
+    * Releases a pin of pin or allocate.
+    *
+    * @param[in] buf    The buffer.
+    */
+    void unpin(MneRawBufDef* buf);
+
+    //=========================================================================================================
+    /**
+    * Takes the memory back from buffers which are about to be freed and clears their vals.
+    *
+    * @param[in] bufs   The buffers.
+    * @param[in] nbuf   Number of buffers.
+    */
+    void remove(MneRawBufDef* bufs, int nbuf);
+
+    //=========================================================================================================
+    /**
+    * Sets the byte budget. Unpinned buffers are taken back right away if the cache is larger.
+    *
+    * @param[in] iByteBudget    Number of bytes the resident buffers may use.
+    */
+    void setBudget(qint64 iByteBudget);
+
+    //=========================================================================================================
+    /**
+    * Returns the cache statistics.
+    *
+    * @return the statistics.
+    */
+    Stats stats() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * A resident buffer, the entries form a doubly linked list in the order of use
+    */
+    struct Entry {
+        MneRawBufDef*   owner;      /**< The buffer using the memory. */
+        float**         rows;       /**< Row pointers handed out as vals. */
+        float*          data;       /**< The samples. */
+        qint64          iBytes;     /**< Size of data. */
+        int             iPins;      /**< Number of pins. */
+        Entry*          prev;       /**< More recently used entry. */
+        Entry*          next;       /**< Less recently used entry. */
+    };
+
+    void unlink(Entry* entry);
+    void pushFront(Entry* entry);
+    void release(Entry* entry);
+    void evict();
+
+    mutable QMutex                  m_qMutex;   /**< Guards all members. */
+    QHash<MneRawBufDef*, Entry*>    m_qHashEntries; /**< Resident buffers. */
+    Entry*                          m_pHead;    /**< Most recently used entry. */
+    Entry*                          m_pTail;    /**< Least recently used entry. */
+    Stats                           m_stats;    /**< Statistics and budget. */
+};
+
+} // NAMESPACE MNELIB
+
+#endif // MNERAWBUFCACHE_H
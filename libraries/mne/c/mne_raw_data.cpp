@@ -40,7 +40,14 @@
 
 #include "mne_raw_data.h"
 
+#include <utils/filterTools/fftfilterbatch.h>
+
 #include <QFile>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QVector>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include <Eigen/Core>
 
@@ -60,6 +67,7 @@
 using namespace Eigen;
 using namespace FIFFLIB;
 using namespace MNELIB;
+using namespace UTILSLIB;
 
 
 
@@ -164,37 +172,6 @@ void mne_free_cmatrix_36 (float **m)
 
 
 
-typedef struct {
-    int   size;		        /* Size of this buffer in floats */
-    float *data;			/* The allocated buffer */
-    float ***datap;		/* The matrix which uses this */
-} *ringBufBuf_36,ringBufBufRec_36;
-
-typedef struct {
-    ringBufBuf_36 *bufs;
-    int        nbuf;
-    int        next;
-} *ringBuf_36,ringBufRec_36;
-
-
-
-void mne_free_ring_buffer_36(void *thisp)
-
-{
-    int k;
-    ringBuf_36 this_buf = (ringBuf_36)thisp;
-
-    if (!this_buf)
-        return;
-
-    for (k = 0; k < this_buf->nbuf; k++)
-        FREE_36(this_buf->bufs[k]->data);
-    FREE_36(this_buf->bufs);
-    FREE_36(this_buf);
-    return;
-}
-
-
 void mne_free_event(mneEvent e)
 {
     if (!e)
@@ -329,6 +306,11 @@ typedef struct {
     float *precalc;		/* Precalculated data for FFT */
     int   np;			/* Length */
     float nprec;
+    mneFilterDefRec def;	/* The filter definition this response was created for */
+    float sfreq;		/* ...and the sampling frequency */
+    int   highpass_effective;	/* Was the highpass effective? */
+    FFTFilterBatch *batch;	/* Multi-channel FFT filter with freq_resp, keeps its plans */
+    FFTFilterBatch *eog_batch;	/* The same with eog_freq_resp */
 } *filterData,filterDataRec;
 
 static void filter_data_free(void *datap)
@@ -340,6 +322,8 @@ static void filter_data_free(void *datap)
     FREE_36(data->freq_resp);
     FREE_36(data->eog_freq_resp);
     FREE_36(data->precalc);
+    delete data->batch;
+    delete data->eog_batch;
     FREE_36(data);
     return;
 }
@@ -353,6 +337,9 @@ static filterData new_filter_data()
     data->eog_freq_resp = NULL;
     data->precalc       = NULL;
     data->np            = 0;
+    data->sfreq         = 0.0;
+    data->batch         = NULL;
+    data->eog_batch     = NULL;
     return data;
 }
 
@@ -628,6 +615,16 @@ void mne_create_filter_response(mneFilterDef    filter,
         else
             fprintf(stderr,"NOTE: Filter is presently switched off.\n");
     }
+    /*
+     * The batched filters take the responses as half spectra of the zero-padded buffer length
+     */
+    filter_data->def                = *filter;
+    filter_data->sfreq              = sfreq;
+    filter_data->highpass_effective = *highpass_effective;
+    filter_data->batch     = new FFTFilterBatch(Map<RowVectorXf>(filter_data->freq_resp,resp_size).cast<double>().cast<std::complex<double> >(),
+                                                filter->size + 2*filter->taper_size);
+    filter_data->eog_batch = new FFTFilterBatch(Map<RowVectorXf>(filter_data->eog_freq_resp,resp_size).cast<double>().cast<std::complex<double> >(),
+                                                filter->size + 2*filter->taper_size);
     *filter_datap      = filter_data;
     *filter_data_freep = filter_data_free;
     return;
@@ -637,100 +634,6 @@ void mne_create_filter_response(mneFilterDef    filter,
 
 
 
-//============================= mne_ringbuffer.c =============================
-
-typedef struct {
-    int   size;		        /* Size of this buffer in floats */
-    float *data;			/* The allocated buffer */
-    float ***datap;		/* The matrix which uses this */
-} *ringBufBuf,ringBufBufRec;
-
-typedef struct {
-    ringBufBuf *bufs;
-    int        nbuf;
-    int        next;
-} *ringBuf,ringBufRec;
-
-
-void mne_free_ring_buffer(void *thisp)
-
-{
-    int k;
-    ringBuf this_buf = (ringBuf)thisp;
-
-    if (!this_buf)
-        return;
-
-    for (k = 0; k < this_buf->nbuf; k++)
-        FREE_36(this_buf->bufs[k]->data);
-    FREE_36(this_buf->bufs);
-    FREE_36(this_buf);
-    return;
-}
-
-void *mne_initialize_ring(int nbuf)
-
-{
-    int k;
-    ringBuf ring;
-
-    ring = MALLOC_36(1,ringBufRec);
-    ring->bufs = MALLOC_36(nbuf,ringBufBuf);
-    ring->nbuf = nbuf;
-
-    for (k = 0; k < nbuf; k++) {
-        ring->bufs[k] = MALLOC_36(1,ringBufBufRec);
-        ring->bufs[k]->size  = 0;
-        ring->bufs[k]->data  = NULL;
-        ring->bufs[k]->datap = NULL;
-    }
-    ring->next = 0;
-
-#ifdef DEBUG
-    fprintf(stderr,"Ring buffer structure with %d entries initialized\n",ring->nbuf);
-#endif
-
-    return ring;
-}
-
-void mne_allocate_from_ring(void *ringp, int nrow, int ncol, float ***res)
-/*
- * Get a new buffer
- */
-{
-    float **mat;
-    int   j;
-    ringBufBuf buf;
-    ringBuf    ring = (ringBuf)ringp;
-
-    if (ring->next > ring->nbuf-1)
-        ring->next = 0;
-
-#ifdef DEBUG
-    fprintf(stderr,"Allocating buf # %d\n",ring->next);
-#endif
-
-    buf = ring->bufs[ring->next++];
-
-    if (buf->datap) {		/* Clear the reference */
-        FREE_36(*buf->datap);
-        *buf->datap = NULL;
-    }
-    *res = mat = MALLOC_36(nrow,float *);
-    if (buf->size < nrow*ncol)
-        buf->data = REALLOC_36(buf->data,nrow*ncol,float);
-
-    for (j = 0; j < nrow; j++)
-        mat[j] = buf->data + j*ncol;
-
-    buf->datap = res;
-
-    return;
-}
-
-
-
-
 //============================= mne_raw_routines.c =============================
 
 
@@ -901,28 +804,7 @@ int  mne_sparse_vec_mult2(FiffSparseMatrix* mat,     /* The sparse matrix */
       * Multiply a vector by a sparse matrix.
       */
 {
-    int i,j;
-
-    if (mat->coding == FIFFTS_MC_RCS) {
-        for (i = 0; i < mat->m; i++) {
-            res[i] = 0.0;
-            for (j = mat->ptrs[i]; j < mat->ptrs[i+1]; j++)
-                res[i] += mat->data[j]*vector[mat->inds[j]];
-        }
-        return 0;
-    }
-    else if (mat->coding == FIFFTS_MC_CCS) {
-        for (i = 0; i < mat->m; i++)
-            res[i] = 0.0;
-        for (i = 0; i < mat->n; i++)
-            for (j = mat->ptrs[i]; j < mat->ptrs[i+1]; j++)
-                res[mat->inds[j]] += mat->data[j]*vector[i];
-        return 0;
-    }
-    else {
-        printf("mne_sparse_vec_mult2: unknown sparse matrix storage type: %d",mat->coding);
-        return -1;
-    }
+    return mat->mult_vec(vector,res);
 }
 
 
@@ -937,46 +819,245 @@ int  mne_sparse_mat_mult2(FiffSparseMatrix* mat,     /* The sparse matrix */
       * Multiply a dense matrix by a sparse matrix.
       */
 {
-    int i,j,k;
-    float val;
-
-    if (mat->coding == FIFFTS_MC_RCS) {
-        for (i = 0; i < mat->m; i++) {
-            for (k = 0; k < ncol; k++) {
-                val = 0.0;
-                for (j = mat->ptrs[i]; j < mat->ptrs[i+1]; j++)
-                    val += mat->data[j]*mult[mat->inds[j]][k];
-                res[i][k] = val;
-            }
+    return mat->mult_mat(mult,ncol,res);
+}
+
+
+
+
+
+
+
+
+
+#define MNE_RAW_CACHE_BUDGET (1200*1024*1024LL)     /* Used to be two rings of 600 MB for raw and filtered buffers */
+
+static qint64 raw_cache_budget = MNE_RAW_CACHE_BUDGET;
+
+
+typedef Matrix<float,Dynamic,Dynamic,RowMajor> RowMajorMatrixXf;
+
+namespace MNELIB
+{
+struct MneRawFusedProj {            /* The projector of mne_raw_pick_data_proj for one selection */
+    QMutex                         lock;
+    QSharedPointer<const MatrixXf> op;      /* One row for each output, one column for each channel */
+    MatrixXf                       vecs;    /* The projection vectors op was made of */
+    VectorXi                       pick;    /* Outputs: channel, -2-derivation or -1 if neither */
+    MneDeriv*                      deriv;   /* The derivations used */
+};
+}
+
+
+static QSharedPointer<const MatrixXf> get_fused_proj(MneRawData *data, mneChSelection sel)
+/*
+ * Projection followed by the selection and derivations as one matrix. It is rebuilt only if the projection
+ * vectors, the selection or the derivations changed since the last call
+ */
+{
+    MneRawFusedProj*  fused = data->fused_proj;
+    MneProjOp*        op    = data->proj;
+    MneDeriv*         deriv = NULL;
+    int               nchan = data->info->nchan;
+    int               c,k,j;
+    VectorXi          pick;
+    MatrixXf          vecs;
+    MatrixXf          proj,der;
+    MatrixXf*         res;
+
+    if (sel) {
+        if (sel->nderiv > 0 && data->deriv_matched)
+            deriv = data->deriv_matched;
+        pick = VectorXi::Constant(sel->nchan,-1);
+        for (c = 0; c < sel->nchan; c++) {
+            if (sel->pick[c] >= 0)
+                pick[c] = sel->pick[c];
+            else if (deriv && sel->pick_deriv[c] >= 0)
+                pick[c] = -2 - sel->pick_deriv[c];
         }
     }
-    else if (mat->coding == FIFFTS_MC_CCS) {
-        for (k = 0; k < ncol; k++) {
-            for (i = 0; i < mat->m; i++)
-                res[i][k] = 0.0;
-            for (i = 0; i < mat->n; i++)
-                for (j = mat->ptrs[i]; j < mat->ptrs[i+1]; j++)
-                    res[mat->inds[j]][k] += mat->data[j]*mult[i][k];
+    else
+        pick = VectorXi::LinSpaced(nchan,0,nchan-1);
+    /*
+     * An operator which does not match the data is not applied, see mne_proj_op_proj_vector
+     */
+    if (op && op->nitems > 0 && op->nvec > 0 && op->nch == nchan) {
+        vecs.resize(op->nvec,op->nch);
+        for (k = 0; k < op->nvec; k++)
+            vecs.row(k) = Map<RowVectorXf>(op->proj_data[k],op->nch);
+    }
+    else if (op && op->nitems > 0 && op->nvec > 0)
+        printf("Data vector size does not match projection operator");
+
+    QMutexLocker locker(&fused->lock);
+    if (fused->op && fused->deriv == deriv &&
+            fused->pick.size() == pick.size() && fused->pick == pick &&
+            fused->vecs.rows() == vecs.rows() && fused->vecs.cols() == vecs.cols() && fused->vecs == vecs)
+        return fused->op;
+
+    proj = MatrixXf::Identity(nchan,nchan);
+    if (vecs.rows() > 0)
+        proj -= vecs.transpose()*vecs;
+    /*
+     * The derivations are sparse combinations of the projected channels
+     */
+    if (deriv) {
+        FiffSparseMatrix* mat = deriv->deriv_data->data;
+        der = MatrixXf::Zero(mat->m,mat->n);
+        if (mat->coding == FIFFTS_MC_RCS) {
+            for (k = 0; k < mat->m; k++)
+                for (j = mat->ptrs[k]; j < mat->ptrs[k+1]; j++)
+                    der(k,mat->inds[j]) = mat->data[j];
+        }
+        else if (mat->coding == FIFFTS_MC_CCS) {
+            for (k = 0; k < mat->n; k++)
+                for (j = mat->ptrs[k]; j < mat->ptrs[k+1]; j++)
+                    der(mat->inds[j],k) = mat->data[j];
+        }
+        else {
+            printf("get_fused_proj: unknown sparse matrix storage type: %d",mat->coding);
+            return QSharedPointer<const MatrixXf>();
         }
     }
-    else {
-        printf("mne_sparse_mat_mult2: unknown sparse matrix storage type: %d",mat->coding);
-        return -1;
+    res = new MatrixXf(MatrixXf::Zero(pick.size(),nchan));
+    for (c = 0; c < pick.size(); c++) {
+        if (pick[c] >= 0)
+            res->row(c) = proj.row(pick[c]);
+        else if (pick[c] < -1)
+            res->row(c) = der.row(-2-pick[c])*proj;
     }
-    return 0;
+    fused->op    = QSharedPointer<const MatrixXf>(res);
+    fused->vecs  = vecs;
+    fused->pick  = pick;
+    fused->deriv = deriv;
+    return fused->op;
 }
 
 
+static bool buf_is_filtered(MneRawData *data, MneRawBufDef *buf, mneChSelection sel)
+/*
+ * Have all channels needed by sel been filtered in this buffer?
+ */
+{
+    int c;
 
+    if (!buf->valid)
+        return false;
+    if (sel) {
+        for (c = 0; c < sel->nchan; c++)
+            if (sel->pick[c] >= 0 && !buf->ch_filtered[sel->pick[c]])
+                return false;
+        if (sel->nderiv > 0 && data->deriv_matched) {
+            MneDeriv* der = data->deriv_matched;
+            for (c = 0; c < der->deriv_data->ncol; c++)
+                if (der->in_use[c] > 0 && !buf->ch_filtered[c])
+                    return false;
+        }
+    }
+    else {
+        for (c = 0; c < data->info->nchan; c++)
+            if (!buf->ch_filtered[c])
+                return false;
+    }
+    return true;
+}
 
 
+static int filter_bufs(MneRawData *data, MneRawBufDef *bufs, int nbuf, mneChSelection sel, const float *dc)
+/*
+ * Filter the channels needed by sel in nbuf adjacent filtered buffers. This does what mne_apply_filter does
+ * channel by channel, but all channels of all buffers go through one batched FFT filter at once
+ */
+{
+    mneFilterDef filter = data->filter;
+    filterData   d      = (filterData)data->filter_data;
+    int          nchan  = data->info->nchan;
+    int          taper  = filter->taper_size;
+    int          k,c,s,j,f;
+    int          *need;
+    float        *vals;
+    float        dc_offset;
+    QVector<int> jobs[2];       /* Buffer * nchan + channel for the ordinary and the EOG response */
+    MatrixXd     in,out;
+    int          res = OK;
 
-
-
-
-#define APPROX_RING_BUF_SIZE (600*1024*1024)
-
-static int approx_ring_buf_size = APPROX_RING_BUF_SIZE;
+    need = MALLOC_36(nchan,int);
+    for (c = 0; c < nchan; c++)
+        need[c] = sel == NULL;
+    if (sel) {
+        for (c = 0; c < sel->nchan; c++)
+            if (sel->pick[c] >= 0)
+                need[sel->pick[c]] = TRUE;
+        /*
+         * Also channels included in derivations if they are used
+         */
+        if (sel->nderiv > 0 && data->deriv_matched) {
+            MneDeriv* der = data->deriv_matched;
+            for (c = 0; c < der->deriv_data->ncol; c++)
+                if (der->in_use[c] > 0)
+                    need[c] = TRUE;
+        }
+    }
+    for (k = 0; k < nbuf; k++) {
+        for (c = 0; c < nchan; c++) {
+            if (!need[c] || bufs[k].ch_filtered[c])
+                continue;
+            /*
+             * Zero padding
+             */
+            vals = bufs[k].vals[c];
+            for (s = 0; s < taper; s++)
+                vals[s] = 0.0;
+            for (s = taper + filter->size; s < bufs[k].ns; s++)
+                vals[s] = 0.0;
+            /*
+             * Stimulus channels are only zero padded
+             */
+            if (data->info->chInfo[c].kind == FIFFV_STIM_CH || !filter->filter_on) {
+                bufs[k].ch_filtered[c] = TRUE;
+                continue;
+            }
+            if (!d || !d->batch) {
+                dc_offset = dc ? dc[c] : 0.0;
+                for (s = taper; s < taper + filter->size; s++)
+                    vals[s] = vals[s] - dc_offset;
+                bufs[k].ch_filtered[c] = TRUE;
+                continue;
+            }
+            jobs[data->info->chInfo[c].kind == FIFFV_EOG_CH ? 1 : 0].append(k*nchan + c);
+        }
+    }
+    for (f = 0; f < 2 && res == OK; f++) {
+        if (jobs[f].isEmpty())
+            continue;
+        /*
+         * Collect the data segments with the dc offset removed, filter, and put the results back
+         */
+        in.resize(jobs[f].size(),filter->size);
+        for (j = 0; j < jobs[f].size(); j++) {
+            k = jobs[f][j] / nchan;
+            c = jobs[f][j] % nchan;
+            dc_offset = dc ? dc[c] : 0.0;
+            vals = bufs[k].vals[c] + taper;
+            for (s = 0; s < filter->size; s++)
+                in(j,s) = vals[s] - dc_offset;
+        }
+        if (!(f == 0 ? d->batch : d->eog_batch)->filter(in,out,taper,0,bufs[0].ns)) {
+            res = FAIL;
+            break;
+        }
+        for (j = 0; j < jobs[f].size(); j++) {
+            k = jobs[f][j] / nchan;
+            c = jobs[f][j] % nchan;
+            vals = bufs[k].vals[c];
+            for (s = 0; s < bufs[k].ns; s++)
+                vals[s] = out(j,s);
+            bufs[k].ch_filtered[c] = TRUE;
+        }
+    }
+    FREE_36(need);
+    return res;
+}
 
 
 
@@ -998,14 +1079,15 @@ MneRawData::MneRawData()
 ,event_list(NULL)
 ,max_event(0)
 ,dig_trigger_mask(0)
-,ring(NULL)
-,filt_ring(NULL)
+,cache(NULL)
 ,filt_bufs(NULL)
 ,nfilt_buf(0)
 ,first_sample_val(NULL)
 ,filter(NULL)
 ,filter_data(NULL)
 ,filter_data_free(NULL)
+,filt_next(0)
+,fused_proj(new MneRawFusedProj)
 ,offsets(NULL)
 ,deriv(NULL)
 ,deriv_matched(NULL)
@@ -1030,11 +1112,13 @@ MneRawData::~MneRawData()
     this->filename.clear();
     this->ch_names.clear();
 
+    if (this->cache) {
+        this->cache->remove(this->bufs,this->nbuf);
+        this->cache->remove(this->filt_bufs,this->nfilt_buf);
+    }
     MneRawBufDef::free_bufs(this->bufs,this->nbuf);
-    mne_free_ring_buffer_36(this->ring);
-
     MneRawBufDef::free_bufs(this->filt_bufs,this->nfilt_buf);
-    mne_free_ring_buffer_36(this->filt_ring);
+    delete this->cache;
 
     if(this->proj)
         delete this->proj;
@@ -1060,6 +1144,7 @@ MneRawData::~MneRawData()
     delete this->deriv;
     delete this->deriv_matched;
     FREE_36(this->deriv_offsets);
+    delete this->fused_proj;
 }
 
 
@@ -1072,6 +1157,19 @@ void MneRawData::mne_raw_add_filter_response(MneRawData *data, int *highpass_eff
 {
     if (!data)
         return;
+    /*
+       * The response only depends on the filter definition and the sampling frequency
+       */
+    if (data->filter && data->filter_data && data->filter_data_free == filter_data_free) {
+        filterData d = (filterData)data->filter_data;
+        if (mne_compare_filters(&d->def,data->filter) == 0 &&
+                d->def.size == data->filter->size &&
+                d->def.taper_size == data->filter->taper_size &&
+                d->sfreq == data->info->sfreq) {
+            *highpass_effective = d->highpass_effective;
+            return;
+        }
+    }
     /*
        * Free the previous filter definition
        */
@@ -1107,14 +1205,13 @@ void MneRawData::setup_filter_bufs(MneRawData *data)
     MneRawBufDef* bufs;
     int       j,k;
     int       firstsamp;
-    int       nring_buf;
     int       highpass_effective;
 
+    if (data->cache)
+        data->cache->remove(data->filt_bufs,data->nfilt_buf);
     MneRawBufDef::free_bufs(data->filt_bufs,data->nfilt_buf);
     data->filt_bufs = NULL;
     data->nfilt_buf = 0;
-    mne_free_ring_buffer(data->filt_ring);
-    data->filt_ring = NULL;
 
     if (!data || !data->filter)
         return;
@@ -1146,9 +1243,6 @@ void MneRawData::setup_filter_bufs(MneRawData *data)
     }
     data->filt_bufs = bufs;
     data->nfilt_buf = nfilt_buf;
-    nring_buf       = approx_ring_buf_size/((2*filter->taper_size+filter->size)*
-                                            data->info->nchan*sizeof(float));
-    data->filt_ring = mne_initialize_ring(nring_buf);
     mne_raw_add_filter_response(data,&highpass_effective);
 
     return;
@@ -1166,9 +1260,9 @@ int MneRawData::load_one_buffer(MneRawData *data, MneRawBufDef *buf)
         printf("Cannot load a skip");
         return FAIL;
     }
-    if (!buf->vals) {		/* The data space may have been reused */
-        buf->valid = FALSE;
-        mne_allocate_from_ring(data->ring, buf->nchan,buf->ns,&buf->vals);
+    if (!buf->vals) {		/* Has to be acquired from the cache first */
+        printf("Raw buffer is not resident");
+        return FAIL;
     }
     if (buf->valid)
         return OK;
@@ -1245,6 +1339,38 @@ bad :
 }
 
 
+//*************************************************************************************************************
+
+int MneRawData::acquire_buffer(MneRawData *data, MneRawBufDef *buf)
+/*
+     * Pin one raw buffer in the cache, load and compensate it if this has not been done yet.
+     * Release it with data->cache->unpin(buf)
+     */
+{
+    {
+        QReadLocker locker(&data->raw_lock);
+        if (data->cache->pin(buf)) {
+            if (buf->valid && (!data->comp || (!data->comp->undo && !data->comp->current) || buf->comp_status == data->comp_now))
+                return OK;
+            data->cache->unpin(buf);
+        }
+    }
+    /*
+       * Loading and compensation write the buffer and the compensation workspace
+       */
+    QWriteLocker locker(&data->raw_lock);
+    if (!data->cache->pin(buf)) {
+        data->cache->allocate(buf);
+        buf->valid = FALSE;
+    }
+    if (load_one_buffer(data,buf) != OK || compensate_buffer(data,buf) != OK) {
+        data->cache->unpin(buf);
+        return FAIL;
+    }
+    return OK;
+}
+
+
 //*************************************************************************************************************
 
 int MneRawData::mne_raw_pick_data(MneRawData *data, mneChSelection sel, int firsts, int ns, float **picked)
@@ -1312,15 +1438,12 @@ int MneRawData::mne_raw_pick_data(MneRawData *data, mneChSelection sel, int firs
             }
             else {
                 /*
-             * Load the buffer
+             * Load the buffer and apply compensation
              */
-                if (load_one_buffer(data,this_buf) != OK)
-                    return FAIL;
-                /*
-             * Apply compensation
-             */
-                if (compensate_buffer(data,this_buf) != OK)
+                if (acquire_buffer(data,this_buf) != OK) {
+                    FREE_CMATRIX_36(deriv_vals);
                     return FAIL;
+                }
                 ns2 = s2 = 0;
                 if (sel) {
                     /*
@@ -1334,6 +1457,7 @@ int MneRawData::mne_raw_pick_data(MneRawData *data, mneChSelection sel, int firs
                             deriv_ns    = this_buf->ns;
                         }
                         if (mne_sparse_mat_mult2(data->deriv_matched->deriv_data->data,this_buf->vals,this_buf->ns,deriv_vals) == FAIL) {
+                            data->cache->unpin(this_buf);
                             FREE_CMATRIX_36(deriv_vals);
                             return FAIL;
                         }
@@ -1362,6 +1486,7 @@ int MneRawData::mne_raw_pick_data(MneRawData *data, mneChSelection sel, int firs
                         for (p = start, s2 = s, ns2 = ns; p < this_buf->ns && ns2 > 0; p++, ns2--, s2++)
                             picked[c][s2] = this_buf->vals[c][p];
                 }
+                data->cache->unpin(this_buf);
                 s  = s2;
                 ns = ns2;
             }
@@ -1405,14 +1530,18 @@ int MneRawData::mne_raw_pick_data_proj(MneRawData *data, mneChSelection sel, int
      * Data from a set of channels, apply projection
      */
 {
-    int          k,s,p,start,c,fills;
+    int          k,s,p,start,c,fills,n;
     MneRawBufDef* this_buf;
-    float        **values;
-    float        *pvalues;
-    float        *deriv_pvalues = NULL;
+    MatrixXf     res;
+    QSharedPointer<const MatrixXf> fused;
 
     if (!data->proj || (sel && !MneProjOp::mne_proj_op_affect(data->proj,sel->chspick,sel->nchan) && !MneProjOp::mne_proj_op_affect(data->proj,sel->chspick_nospace,sel->nchan)))
         return mne_raw_pick_data(data,sel,firsts,ns,picked);
+    /*
+       * Projection, picking and derivations in one matrix
+       */
+    if ((fused = get_fused_proj(data,sel)).isNull())
+        return FAIL;
 
     if (firsts < data->first_samp) {
         for (s = 0, p = firsts; p < data->first_samp; s++, p++) {
@@ -1428,7 +1557,6 @@ int MneRawData::mne_raw_pick_data_proj(MneRawData *data, mneChSelection sel, int
     }
     else
         s = 0;
-    pvalues = MALLOC_36(data->info->nchan,float);
     for (k = 0, this_buf = data->bufs; k < data->nbuf; k++, this_buf++) {
         if (this_buf->lasts >= firsts) {
             start = firsts - this_buf->firsts;
@@ -1449,57 +1577,29 @@ int MneRawData::mne_raw_pick_data_proj(MneRawData *data, mneChSelection sel, int
             }
             else {
                 /*
-             * Load the buffer
-             */
-                if (load_one_buffer(data,this_buf) != OK)
-                    return FAIL;
-                /*
-             * Apply compensation
+             * Load the buffer and apply compensation
              */
-                if (compensate_buffer(data,this_buf) != OK)
+                if (acquire_buffer(data,this_buf) != OK)
                     return FAIL;
                 /*
-             * Apply projection
+             * Apply projection to all samples needed from this buffer at once
              */
-                values = this_buf->vals;
-                if (sel && sel->nderiv > 0 && data->deriv_matched)
-                    deriv_pvalues = MALLOC_36(data->deriv_matched->deriv_data->nrow,float);
-                for (p = start; p < this_buf->ns && ns > 0; p++, ns--, s++) {
-                    for (c = 0; c < data->info->nchan; c++)
-                        pvalues[c] = values[c][p];
-                    if (MneProjOp::mne_proj_op_proj_vector(data->proj,pvalues,data->info->nchan,TRUE) != OK)
-                        qWarning()<<"Error";
-                    if (sel) {
-                        if (sel->nderiv > 0 && data->deriv_matched) {
-                            if (mne_sparse_vec_mult2(data->deriv_matched->deriv_data->data,pvalues,deriv_pvalues) == FAIL)
-                                return FAIL;
-                        }
-                        for (c = 0; c < sel->nchan; c++) {
-                            /*
-                   * First try the ordinary channels...
-                   */
-                            if (sel->pick[c] >= 0)
-                                picked[c][s] = pvalues[sel->pick[c]];
-                            /*
-                   * ...then the derived ones
-                   */
-                            else if (sel->pick_deriv[c] >= 0 && data->deriv_matched)
-                                picked[c][s] = deriv_pvalues[sel->pick_deriv[c]];
-                        }
-                    }
-                    else {
-                        for (c = 0; c < data->info->nchan; c++) {
-                            picked[c][s] = pvalues[c];
-                        }
-                    }
+                n = qMin(this_buf->ns - start,ns);
+                res.noalias() = (*fused)*Map<const RowMajorMatrixXf>(this_buf->vals[0],this_buf->nchan,this_buf->ns).middleCols(start,n);
+                data->cache->unpin(this_buf);
+                for (c = 0; c < res.rows(); c++) {
+                    if (sel && sel->pick[c] < 0 && (sel->nderiv <= 0 || !data->deriv_matched || sel->pick_deriv[c] < 0))
+                        continue;
+                    for (p = 0; p < n; p++)
+                        picked[c][s+p] = res(c,p);
                 }
+                s  += n;
+                ns -= n;
             }
             if (ns == 0)
                 break;
         }
     }
-    FREE_36(deriv_pvalues);
-    FREE_36(pvalues);
     /*
        * Extend with the last available sample or zero if the request is beyond the data
        */
@@ -1540,9 +1640,9 @@ int MneRawData::load_one_filt_buf(MneRawData *data, MneRawBufDef *buf)
 
     float **vals;
 
-    if (!buf->vals) {
-        buf->valid = FALSE;
-        mne_allocate_from_ring(data->filt_ring, buf->nchan, buf->ns,&buf->vals);
+    if (!buf->vals) {		/* Has to be acquired from the cache first */
+        printf("Filtered buffer is not resident");
+        return FAIL;
     }
     if (buf->valid)
         return OK;
@@ -1567,6 +1667,56 @@ int MneRawData::load_one_filt_buf(MneRawData *data, MneRawBufDef *buf)
 }
 
 
+//*************************************************************************************************************
+
+int MneRawData::acquire_filt_bufs(MneRawData *data, int first, int last, mneChSelection sel, const float *dc)
+/*
+     * Pin the filtered buffers first...last in the cache, load them and filter the channels needed by sel if this
+     * has not been done yet. All buffers still to be filtered are filtered in one batch. Release them with
+     * data->cache->unpin(buf)
+     */
+{
+    MneRawBufDef* bufs = data->filt_bufs;
+    int k,j;
+
+    {
+        QReadLocker locker(&data->filt_lock);
+        for (k = first; k <= last; k++) {
+            if (!data->cache->pin(bufs+k))
+                break;
+            if (!buf_is_filtered(data,bufs+k,sel)) {
+                data->cache->unpin(bufs+k);
+                break;
+            }
+        }
+        if (k > last)
+            return OK;
+    }
+    /*
+       * Loading and filtering write the buffers. The ones pinned above stay resident and filtered
+       */
+    QWriteLocker locker(&data->filt_lock);
+    for (j = k; j <= last; j++) {
+        if (!data->cache->pin(bufs+j)) {
+            data->cache->allocate(bufs+j);
+            bufs[j].valid = FALSE;
+        }
+    }
+    for (j = k; j <= last; j++)
+        if (load_one_filt_buf(data,bufs+j) != OK)
+            goto bad;
+    if (filter_bufs(data,bufs+k,last-k+1,sel,dc) != OK)
+        goto bad;
+    return OK;
+
+bad : {
+        for (j = first; j <= last; j++)
+            data->cache->unpin(bufs+j);
+        return FAIL;
+    }
+}
+
+
 //*************************************************************************************************************
 
 int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int firsts, int ns, float **picked)
@@ -1576,14 +1726,13 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
 {
     int          k,s,bs,c;
     int          bs1,bs2,s1,s2,lasts;
+    int          first_buf,last_buf,next_buf,ahead_buf;
     MneRawBufDef* this_buf;
     float        *values;
     float        **deriv_vals = NULL;
     float        *dc          = NULL;
-    float        dc_offset;
     int          deriv_ns     = 0;
     int          nderiv       = 0;
-    int          filter_was;
 
     if (!data->filter || !data->filter->filter_on)
         return mne_raw_pick_data_proj(data,sel,firsts,ns,picked);
@@ -1610,14 +1759,18 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
         /*
          * Is this correct??
          */
-        if (data->comp && data->comp->current)
+        if (data->comp && data->comp->current) {
+            /*
+             * The compensation uses workspace of its own
+             */
+            QWriteLocker locker(&data->raw_lock);
             if (MneCTFCompDataSet::mne_apply_ctf_comp(data->comp,TRUE,dc,data->info->nchan,NULL,0) != OK)
                 goto bad;
+        }
         if (data->proj)
             if (MneProjOp::mne_proj_op_proj_vector(data->proj,dc,data->info->nchan,TRUE) != OK)
                 goto bad;
     }
-    filter_was = data->filter->filter_on;
     /*
        * Find the first buffer to consider
        */
@@ -1625,91 +1778,28 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
         if (this_buf->lasts >= firsts)
             break;
     }
-    for (; k < data->nfilt_buf && this_buf->firsts <= lasts; k++, this_buf++) {
+    first_buf = k;
+    for (last_buf = first_buf-1; last_buf+1 < data->nfilt_buf && data->filt_bufs[last_buf+1].firsts <= lasts; last_buf++)
+        ;
+    /*
+       * When reading sequentially, the buffer following this segment is filtered in the same pass
+       */
+    next_buf  = data->filt_next.loadAcquire();
+    ahead_buf = last_buf;
+    if (last_buf >= first_buf && (first_buf == next_buf || first_buf == next_buf-1) && last_buf+1 < data->nfilt_buf)
+        ahead_buf = last_buf+1;
+    data->filt_next.storeRelease(last_buf+1);
+    /*
+       * Load the buffers, apply projection and filter all relevant channels (not stimuli)
+       */
+    if (acquire_filt_bufs(data,first_buf,ahead_buf,sel,dc) != OK)
+        goto bad;
+    if (ahead_buf > last_buf)
+        data->cache->unpin(data->filt_bufs+ahead_buf);
+    for (k = first_buf, this_buf = data->filt_bufs+k; k <= last_buf; k++, this_buf++) {
 #ifdef DEBUG
         fprintf(stderr,"this_buf (%d): %d..%d\n",k,this_buf->firsts,this_buf->lasts);
 #endif
-        /*
-         * Load the buffer first and apply projection
-         */
-        if (load_one_filt_buf(data,this_buf) != OK)
-            goto bad;
-        /*
-         * Then filter all relevant channels (not stimuli)
-         */
-        if (sel) {
-            for (c = 0; c < sel->nchan; c++) {
-                if (sel->pick[c] >= 0) {
-                    if (!this_buf->ch_filtered[sel->pick[c]]) {
-                        /*
-                 * Do not filter stimulus channels
-                 */
-                        dc_offset = 0.0;
-                        if (data->info->chInfo[sel->pick[c]].kind == FIFFV_STIM_CH)
-                            data->filter->filter_on = FALSE;
-                        else if (dc)
-                            dc_offset = dc[sel->pick[c]];
-                        if (mne_apply_filter(data->filter,data->filter_data,this_buf->vals[sel->pick[c]],this_buf->ns,TRUE,
-                                             dc_offset,data->info->chInfo[sel->pick[c]].kind) != OK) {
-                            data->filter->filter_on = filter_was;
-                            goto bad;
-                        }
-                        this_buf->ch_filtered[sel->pick[c]] = TRUE;
-                        data->filter->filter_on = filter_was;
-                    }
-                }
-            }
-            /*
-           * Also check channels included in derivations if they are used
-           */
-            if (sel->nderiv > 0 && data->deriv_matched) {
-                MneDeriv* der = data->deriv_matched;
-                for (c = 0; c < der->deriv_data->ncol; c++) {
-                    if (der->in_use[c] > 0 &&
-                            !this_buf->ch_filtered[c]) {
-                        /*
-                 * Do not filter stimulus channels
-                 */
-                        dc_offset = 0.0;
-                        if (data->info->chInfo[c].kind == FIFFV_STIM_CH)
-                            data->filter->filter_on = FALSE;
-                        else if (dc)
-                            dc_offset = dc[c];
-                        if (mne_apply_filter(data->filter,data->filter_data,this_buf->vals[c],this_buf->ns,TRUE,
-                                             dc_offset,data->info->chInfo[c].kind) != OK) {
-                            data->filter->filter_on = filter_was;
-                            goto bad;
-                        }
-                        this_buf->ch_filtered[c] = TRUE;
-                        data->filter->filter_on = filter_was;
-                    }
-                }
-            }
-        }
-        else {
-            /*
-           * Simply filter all channels if there is no selection
-           */
-            for (c = 0; c < data->info->nchan; c++) {
-                if (!this_buf->ch_filtered[c]) {
-                    /*
-               * Do not filter stimulus channels
-               */
-                    dc_offset = 0.0;
-                    if (data->info->chInfo[c].kind == FIFFV_STIM_CH)
-                        data->filter->filter_on = FALSE;
-                    else if (dc)
-                        dc_offset = dc[c];
-                    if (mne_apply_filter(data->filter,data->filter_data,this_buf->vals[c],this_buf->ns,TRUE,
-                                         dc_offset,data->info->chInfo[c].kind) != OK) {
-                        data->filter->filter_on = filter_was;
-                        goto bad;
-                    }
-                    this_buf->ch_filtered[c] = TRUE;
-                    data->filter->filter_on = filter_was;
-                }
-            }
-        }
         /*
          * Decide the picking limits
          */
@@ -1747,8 +1837,11 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
                     nderiv      = data->deriv_matched->deriv_data->nrow;
                     deriv_ns    = this_buf->ns;
                 }
-                if (mne_sparse_mat_mult2(data->deriv_matched->deriv_data->data,this_buf->vals,this_buf->ns,deriv_vals) == FAIL)
+                if (mne_sparse_mat_mult2(data->deriv_matched->deriv_data->data,this_buf->vals,this_buf->ns,deriv_vals) == FAIL) {
+                    for (; k <= last_buf; k++, this_buf++)
+                        data->cache->unpin(this_buf);
                     goto bad;
+                }
             }
             for (c = 0; c < sel->nchan; c++) {
                 /*
@@ -1773,6 +1866,7 @@ int MneRawData::mne_raw_pick_data_filt(MneRawData *data, mneChSelection sel, int
                     picked[c][s] += values[bs];
             }
         }
+        data->cache->unpin(this_buf);
     }
     FREE_CMATRIX_36(deriv_vals);
     FREE_36(dc);
@@ -2022,8 +2116,7 @@ MneRawData *MneRawData::mne_raw_open_file_comp(const QString& name, int omit_ski
     /*
        * Initialize the raw data buffers
        */
-    nbuf = approx_ring_buf_size/(data->info->buf_size*data->info->nchan*sizeof(float));
-    data->ring = mne_initialize_ring(nbuf);
+    data->cache = new MneRawBufCache(raw_cache_budget);
     /*
        * Initialize the filter buffers
        */
@@ -2062,6 +2155,14 @@ bad : {
 }
 
 
+//*************************************************************************************************************
+
+void MneRawData::mne_raw_set_cache_budget(qint64 iByteBudget)
+{
+    raw_cache_budget = iByteBudget;
+}
+
+
 //*************************************************************************************************************
 
 MneRawData *MneRawData::mne_raw_open_file(const QString& name, int omit_skip, int allow_maxshield, mneFilterDef filter)
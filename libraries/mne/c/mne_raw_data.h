@@ -47,6 +47,7 @@
 #include <fiff/fiff_stream.h>
 #include "mne_raw_info.h"
 #include "mne_raw_buf_def.h"
+#include "mne_raw_buf_cache.h"
 #include "mne_proj_op.h"
 #include "mne_sss_data.h"
 #include "mne_ctf_comp_data_set.h"
@@ -70,6 +71,8 @@
 
 #include <QSharedPointer>
 #include <QList>
+#include <QReadWriteLock>
+#include <QAtomicInt>
 
 
 //*************************************************************************************************************
@@ -85,6 +88,8 @@ namespace MNELIB
 // FORWARD DECLARATIONS
 //=============================================================================================================
 
+struct MneRawFusedProj;
+
 
 //=============================================================================================================
 /**
@@ -131,6 +136,18 @@ public:
 
     static int compensate_buffer(MneRawData* data, MneRawBufDef* buf);
 
+    //=========================================================================================================
+    /**
+    * Pins a raw buffer in the cache and loads and compensates it if needed. Concurrent callers only serialize
+    * while a buffer is loaded. The buffer has to be released with data->cache->unpin(buf).
+    *
+    * @param[in] data   The raw data.
+    * @param[in] buf    One of data->bufs.
+    *
+    * @return OK if succeeded, FAIL otherwise.
+    */
+    static int acquire_buffer(MneRawData* data, MneRawBufDef* buf);
+
 
     static int mne_raw_pick_data(MneRawData*    data,
                           mneChSelection sel,
@@ -147,6 +164,22 @@ public:
 
     static int load_one_filt_buf(MneRawData* data, MneRawBufDef* buf);
 
+    //=========================================================================================================
+    /**
+    * Pins the adjacent filtered buffers first...last in the cache, loads them and filters the channels needed by
+    * sel if needed. The channels of all buffers still to be filtered go through one batched FFT filter. The
+    * buffers have to be released with data->cache->unpin(buf).
+    *
+    * @param[in] data   The raw data.
+    * @param[in] first  Index of the first buffer in data->filt_bufs.
+    * @param[in] last   Index of the last buffer in data->filt_bufs.
+    * @param[in] sel    The channel selection, NULL for all channels.
+    * @param[in] dc     Dc offsets to remove before filtering, may be NULL.
+    *
+    * @return OK if succeeded, FAIL otherwise.
+    */
+    static int acquire_filt_bufs(MneRawData* data, int first, int last, mneChSelection sel, const float* dc);
+
 
 
     static int mne_raw_pick_data_filt(MneRawData*    data,
@@ -161,6 +194,15 @@ public:
 
     static MneRawData* mne_raw_open_file(const QString& name, int omit_skip, int allow_maxshield, mneFilterDef filter);
 
+    //=========================================================================================================
+    /**
+    * Sets the byte budget of the buffer caches of files opened afterwards. The cache of an open file is set
+    * with data->cache->setBudget.
+    *
+    * @param[in] iByteBudget    Bytes of raw and filtered buffers held in memory per file.
+    */
+    static void mne_raw_set_cache_budget(qint64 iByteBudget);
+
 
 public:
     QString         filename;             /* This is our file */
@@ -194,8 +236,11 @@ public:
     QString         dig_trigger;        /* Name of the digital trigger channel */
     unsigned int     dig_trigger_mask;  /* Mask applied to digital trigger channel before considering it */
     float            *offsets;          /* Dc offset corrections for display */
-    void             *ring;             /* The ringbuffer (structure is of no interest to us) */
-    void             *filt_ring;        /* Separate ring buffer for filtered data */
+    MNELIB::MneRawBufCache* cache;      /* LRU cache of the raw and filtered buffers (replaces the ring buffers) */
+    QReadWriteLock   raw_lock;          /* Held for writing while raw buffers are loaded and compensated */
+    QReadWriteLock   filt_lock;         /* Held for writing while filtered buffers are loaded and filtered */
+    QAtomicInt       filt_next;         /* Filtered buffer following the last read, detects sequential reading */
+    MNELIB::MneRawFusedProj* fused_proj;/* Projection and derivations restricted to the last selection */
     MNELIB::MneDerivSet*  deriv;        /* Derivation data */
     MNELIB::MneDeriv*     deriv_matched;/* Derivation data matched to this raw data and collected into a single item */
     float            *deriv_offsets;        /* Dc offset corrections for display of the derived channels */
@@ -59,13 +59,17 @@
 
 #include <utils/sphere.h>
 #include <utils/ioutils.h>
+#include <utils/executionconfig.h>
 
 #include <QFile>
 #include <QCoreApplication>
 #include <QtConcurrent>
+#include <QVector>
+#include <QElapsedTimer>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <algorithm>
 
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
@@ -340,6 +344,425 @@ void mne_sort_nearest_by_nearest(MneNearest* points, int npoint)
 }
 
 
+//*************************************************************************************************************
+
+/*
+ * Uniform grid of surface vertices for the nearest vertex queries.
+ * The cells hold a few vertices each, a query visits rings of cells around
+ * the point until the rest of the grid is known to be farther away.
+ */
+typedef struct {
+    float min[3];       /* Grid origin */
+    float h;            /* Cell size */
+    int   n[3];         /* Number of cells in each direction */
+    int   *first;       /* First entry of each cell in vert, ncell+1 entries */
+    int   *vert;        /* The vertices sorted by cell */
+} *vertexGrid,vertexGridRec;
+
+#define GRID_VERT_PER_CELL 4
+#define GRID_BLOCK         64       /* Points per parallel work item */
+
+static void vertex_grid_cell(vertexGrid g, const float *r, int *ijk)
+{
+    int c;
+    for (c = 0; c < 3; c++) {
+        ijk[c] = (int)floor((r[c]-g->min[c])/g->h);
+        if (ijk[c] < 0)
+            ijk[c] = 0;
+        else if (ijk[c] >= g->n[c])
+            ijk[c] = g->n[c]-1;
+    }
+}
+
+static void free_vertex_grid(vertexGrid g)
+{
+    if (!g)
+        return;
+    FREE_17(g->first);
+    FREE_17(g->vert);
+    FREE_17(g);
+}
+
+static vertexGrid make_vertex_grid(float **rr, int np, const int *use)
+/*
+ * Sort the vertices (all of them or those with use[k] set) into the cells
+ */
+{
+    vertexGrid g = MALLOC_17(1,vertexGridRec);
+    float  max[3],ext[3];
+    int    k,c,nuse,ncell,ijk[3],cell;
+    int    *next;
+
+    g->min[X_17] = g->min[Y_17] = g->min[Z_17] = 0.0;
+    max[X_17] = max[Y_17] = max[Z_17] = 0.0;
+    for (k = 0, nuse = 0; k < np; k++) {
+        if (use && !use[k])
+            continue;
+        for (c = 0; c < 3; c++) {
+            if (nuse == 0 || rr[k][c] < g->min[c])
+                g->min[c] = rr[k][c];
+            if (nuse == 0 || rr[k][c] > max[c])
+                max[c] = rr[k][c];
+        }
+        nuse++;
+    }
+    for (c = 0; c < 3; c++)
+        ext[c] = std::max(max[c]-g->min[c],1e-3f);
+    g->h = cbrt(GRID_VERT_PER_CELL*ext[X_17]*ext[Y_17]*ext[Z_17]/std::max(nuse,1));
+    for (;;) {
+        for (c = 0, ncell = 1; c < 3; c++) {
+            g->n[c] = (int)(ext[c]/g->h)+1;
+            ncell *= g->n[c];
+        }
+        if (ncell <= 8*nuse+64)
+            break;
+        g->h = 1.25*g->h;
+    }
+    /*
+     * Counting sort keeps the vertices of each cell in ascending order
+     */
+    g->first = MALLOC_17(ncell+1,int);
+    g->vert  = MALLOC_17(std::max(nuse,1),int);
+    next     = MALLOC_17(ncell,int);
+    for (cell = 0; cell <= ncell; cell++)
+        g->first[cell] = 0;
+    for (k = 0; k < np; k++) {
+        if (use && !use[k])
+            continue;
+        vertex_grid_cell(g,rr[k],ijk);
+        g->first[(ijk[Z_17]*g->n[Y_17]+ijk[Y_17])*g->n[X_17]+ijk[X_17]+1]++;
+    }
+    for (cell = 0; cell < ncell; cell++) {
+        g->first[cell+1] += g->first[cell];
+        next[cell] = g->first[cell];
+    }
+    for (k = 0; k < np; k++) {
+        if (use && !use[k])
+            continue;
+        vertex_grid_cell(g,rr[k],ijk);
+        g->vert[next[(ijk[Z_17]*g->n[Y_17]+ijk[Y_17])*g->n[X_17]+ijk[X_17]]++] = k;
+    }
+    FREE_17(next);
+    return g;
+}
+
+static int nearest_grid_vertex(vertexGrid g, float **rr, float *r, float *mindistp)
+/*
+ * Find the nearest vertex. Ties go to the lowest vertex number as in a linear search.
+ */
+{
+    int   c0[3],lo[3],hi[3],i,j,k,p,v,R,Rmax,cell;
+    int   best = -1;
+    float dist,mindist = 0.0,diff[3];
+
+    vertex_grid_cell(g,r,c0);
+    Rmax = std::max(g->n[X_17],std::max(g->n[Y_17],g->n[Z_17]));
+    for (R = 0; R <= Rmax; R++) {
+        lo[X_17] = std::max(c0[X_17]-R,0); hi[X_17] = std::min(c0[X_17]+R,g->n[X_17]-1);
+        lo[Y_17] = std::max(c0[Y_17]-R,0); hi[Y_17] = std::min(c0[Y_17]+R,g->n[Y_17]-1);
+        lo[Z_17] = std::max(c0[Z_17]-R,0); hi[Z_17] = std::min(c0[Z_17]+R,g->n[Z_17]-1);
+        for (k = lo[Z_17]; k <= hi[Z_17]; k++)
+            for (j = lo[Y_17]; j <= hi[Y_17]; j++)
+                for (i = lo[X_17]; i <= hi[X_17]; i++) {
+                    /*
+                     * Only the cells on the ring
+                     */
+                    if (std::abs(k-c0[Z_17]) != R && std::abs(j-c0[Y_17]) != R && std::abs(i-c0[X_17]) != R) {
+                        if (i < c0[X_17]+R)
+                            i = c0[X_17]+R-1;
+                        continue;
+                    }
+                    cell = (k*g->n[Y_17]+j)*g->n[X_17]+i;
+                    for (p = g->first[cell]; p < g->first[cell+1]; p++) {
+                        v = g->vert[p];
+                        VEC_DIFF_17(r,rr[v],diff);
+                        dist = VEC_LEN_17(diff);
+                        if (best < 0 || dist < mindist || (dist == mindist && v < best)) {
+                            mindist = dist;
+                            best    = v;
+                        }
+                    }
+                }
+        /*
+         * The cells further out are at least R cells away
+         */
+        if (best >= 0 && mindist < 0.999*R*g->h)
+            break;
+    }
+    if (mindistp)
+        *mindistp = mindist;
+    return best;
+}
+
+
+//*************************************************************************************************************
+
+/*
+ * A block of source space points to check against the bounding surface
+ */
+typedef struct {
+    MneSourceSpaceOld*  s;
+    FiffCoordTransOld*  mri_head_t;
+    MneSurfaceOld*      surf;
+    vertexGrid          grid;
+    float               limit;
+    int                 from,to;
+    int                 *omit;      /* 0 = keep, 1 = outside the surface, 2 = too close to the surface */
+} filterBlockRec;
+
+static void filter_point_block(filterBlockRec& b)
+{
+    float  r1[3],mindist;
+    double tot_angle;
+    int    p;
+
+    for (p = b.from; p < b.to; p++) {
+        b.omit[p] = 0;
+        if (!b.s->inuse[p])
+            continue;
+        VEC_COPY_17(r1,b.s->rr[p]);	/* Transform the point to MRI coordinates */
+        if (b.s->coord_frame == FIFFV_COORD_HEAD)
+            FiffCoordTransOld::fiff_coord_trans_inv(r1,b.mri_head_t,FIFFV_MOVE);
+        /*
+         * Check that the source is inside the surface
+         */
+        tot_angle = MneSurfaceOrVolume::sum_solids(r1,b.surf)/(4*M_PI);
+        if (std::fabs(tot_angle-1.0) > 1e-5)
+            b.omit[p] = 1;
+        else if (b.limit > 0.0) {
+            /*
+             * Check the distance limit
+             */
+            if (nearest_grid_vertex(b.grid,b.surf->rr,r1,&mindist) >= 0 && mindist < b.limit)
+                b.omit[p] = 2;
+        }
+    }
+}
+
+static void filter_points(MneSurfaceOld* surf, vertexGrid grid, float limit, FiffCoordTransOld* mri_head_t,
+                          MneSourceSpaceOld* s, FILE *filtered, bool use_threads, int *omitp, int *omit_outsidep)
+/*
+ * Omit the points outside the surface or closer to it than the limit.
+ * The checks run in parallel, the points are omitted and listed in order afterwards.
+ */
+{
+    QList<filterBlockRec> blocks;
+    filterBlockRec        b;
+    int                   *omit = MALLOC_17(std::max(s->np,1),int);
+    int                   p;
+    float                 r1[3];
+
+    b.s          = s;
+    b.mri_head_t = mri_head_t;
+    b.surf       = surf;
+    b.grid       = grid;
+    b.limit      = limit;
+    b.omit       = omit;
+    for (b.from = 0; b.from < s->np; b.from += GRID_BLOCK) {
+        b.to = std::min(b.from+GRID_BLOCK,s->np);
+        blocks.append(b);
+    }
+    if (use_threads && blocks.size() > 1)
+        QtConcurrent::blockingMap(blocks, filter_point_block);
+    else
+        for (p = 0; p < blocks.size(); p++)
+            filter_point_block(blocks[p]);
+
+    for (p = 0; p < s->np; p++) {
+        if (omit[p] == 0)
+            continue;
+        if (omit[p] == 1)
+            (*omit_outsidep)++;
+        else
+            (*omitp)++;
+        s->inuse[p] = FALSE;
+        s->nuse--;
+        if (filtered) {
+            VEC_COPY_17(r1,s->rr[p]);
+            if (s->coord_frame == FIFFV_COORD_HEAD)
+                FiffCoordTransOld::fiff_coord_trans_inv(r1,mri_head_t,FIFFV_MOVE);
+            fprintf(filtered,"%10.3f %10.3f %10.3f\n",
+                    1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
+        }
+    }
+    FREE_17(omit);
+}
+
+
+//*************************************************************************************************************
+
+/*
+ * A block of points to find the closest triangles for
+ */
+typedef struct {
+    MneSurfaceOld*  s;
+    vertexGrid      grid;
+    float           **r;
+    int             *nearest;
+    float           *dist;
+    int             nstep;
+    int             from,to;
+} closestBlockRec;
+
+static int closest_grid_triangle(MneSurfaceOld* s, vertexGrid grid, float *r)
+/*
+ * A triangle having the vertex closest to r as a corner
+ */
+{
+    if (!grid)
+        return -1;
+    int vert = nearest_grid_vertex(grid,s->rr,r,NULL);
+    return (vert >= 0) ? s->neighbor_tri[vert][0] : -1;
+}
+
+static int neighborhood_triangles(MneSurfaceOld* s, int approx_best, int nstep, float *r,
+                                  int *vmark, int *tmark, QVector<int>& verts, QVector<int>& tris)
+/*
+ * Collect the triangles decide_search_restriction would activate around approx_best,
+ * visiting only the neighborhood instead of scanning the whole surface.
+ * The marks are cleared again before returning. The list is sorted to keep the
+ * tie breaking of mne_project_to_surface.
+ */
+{
+    MneTriangle* this_tri = s->tris+approx_best;
+    float diff[3],dist,mindist;
+    int   minvert,j,k,q,v,first,last;
+
+    VEC_DIFF_17(r,this_tri->r1,diff);
+    mindist = VEC_LEN_17(diff);
+    minvert = this_tri->vert[0];
+
+    VEC_DIFF_17(r,this_tri->r2,diff);
+    dist = VEC_LEN_17(diff);
+    if (dist < mindist) {
+        mindist = dist;
+        minvert = this_tri->vert[1];
+    }
+    VEC_DIFF_17(r,this_tri->r3,diff);
+    dist = VEC_LEN_17(diff);
+    if (dist < mindist) {
+        mindist = dist;
+        minvert = this_tri->vert[2];
+    }
+    verts.resize(0);
+    tris.resize(0);
+    if (nstep <= 0)
+        return 0;
+    /*
+     * Breadth first over the vertices within nstep-1 edges, as activate_neighbors does recursively
+     */
+    verts.append(minvert);
+    vmark[minvert] = TRUE;
+    for (j = 0, first = 0; j < nstep; j++) {
+        last = verts.size();
+        for (k = first; k < last; k++) {
+            v = verts[k];
+            for (q = 0; q < s->nneighbor_tri[v]; q++)
+                if (!tmark[s->neighbor_tri[v][q]]) {
+                    tmark[s->neighbor_tri[v][q]] = TRUE;
+                    tris.append(s->neighbor_tri[v][q]);
+                }
+            if (j < nstep-1)
+                for (q = 0; q < s->nneighbor_vert[v]; q++)
+                    if (!vmark[s->neighbor_vert[v][q]]) {
+                        vmark[s->neighbor_vert[v][q]] = TRUE;
+                        verts.append(s->neighbor_vert[v][q]);
+                    }
+        }
+        first = last;
+    }
+    for (k = 0; k < verts.size(); k++)
+        vmark[verts[k]] = FALSE;
+    for (k = 0; k < tris.size(); k++)
+        tmark[tris[k]] = FALSE;
+    std::sort(tris.begin(),tris.end());
+    return tris.size();
+}
+
+static int closest_in_neighborhood(MneSurfaceOld* s, const QVector<int>& tris, float *r, float *distp)
+/*
+ * The closest of the listed triangles, see mne_project_to_surface
+ */
+{
+    float dist,dist0,p,q;
+    int   best,k;
+
+    dist0 = 0.0;
+    for (best = -1, k = 0; k < tris.size(); k++) {
+        MneSurfaceOrVolume::nearest_triangle_point(r,s,NULL,tris[k],&p,&q,&dist);
+        if (best < 0 || std::fabs(dist) < std::fabs(dist0)) {
+            dist0 = dist;
+            best  = tris[k];
+        }
+    }
+    if (distp)
+        *distp = dist0;
+    return best;
+}
+
+static void closest_point_block(closestBlockRec& b)
+{
+    int   *vmark = MALLOC_17(b.s->np,int);
+    int   *tmark = MALLOC_17(b.s->ntri,int);
+    QVector<int> verts,tris;
+    int   k,start;
+    float mydist;
+
+    for (k = 0; k < b.s->np; k++)
+        vmark[k] = FALSE;
+    for (k = 0; k < b.s->ntri; k++)
+        tmark[k] = FALSE;
+
+    for (k = b.from; k < b.to; k++) {
+        start = b.nearest[k] >= 0 ? b.nearest[k] : closest_grid_triangle(b.s,b.grid,b.r[k]);
+        b.nearest[k] = -1;
+        if (start >= 0) {
+            neighborhood_triangles(b.s,start,b.nstep,b.r[k],vmark,tmark,verts,tris);
+            b.nearest[k] = closest_in_neighborhood(b.s,tris,b.r[k],b.dist ? b.dist+k : &mydist);
+        }
+        if (b.nearest[k] < 0 && b.grid) {
+            start = closest_grid_triangle(b.s,b.grid,b.r[k]);
+            if (start >= 0) {
+                neighborhood_triangles(b.s,start,b.nstep,b.r[k],vmark,tmark,verts,tris);
+                b.nearest[k] = closest_in_neighborhood(b.s,tris,b.r[k],b.dist ? b.dist+k : &mydist);
+            }
+        }
+    }
+    FREE_17(vmark);
+    FREE_17(tmark);
+}
+
+
+//*************************************************************************************************************
+
+/*
+ * A block of vertices to compute the neighbor distances for
+ */
+typedef struct {
+    MneSourceSpaceOld*  s;
+    int                 from,to;
+} distanceBlockRec;
+
+static void vertex_distance_block(distanceBlockRec& b)
+{
+    int   k,p;
+    float *dist,diff[3];
+    int   *neigh, nneigh;
+
+    for (k = b.from; k < b.to; k++) {
+        b.s->vert_dist[k]  = dist = MALLOC_17(b.s->nneighbor_vert[k],float);
+        neigh  = b.s->neighbor_vert[k];
+        nneigh = b.s->nneighbor_vert[k];
+        for (p = 0; p < nneigh; p++) {
+            if (neigh[p] >= 0) {
+                VEC_DIFF_17(b.s->rr[k],b.s->rr[neigh[p]],diff);
+                dist[p] = VEC_LEN_17(diff);
+            }
+            else
+                dist[p] = -1.0;
+        }
+    }
+}
 
 
 //*************************************************************************************************************
@@ -461,13 +884,9 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
     * Remove all source space points closer to the surface than a given limit
     */
 {
-    MneSourceSpaceOld* s;
-    int k,p1,p2;
-    float r1[3];
-    float mindist,dist,diff[3];
-    int   minnode;
-    int   omit,omit_outside;
-    double tot_angle;
+    vertexGrid grid;
+    int k;
+    int omit,omit_outside;
 
     if (surf == NULL)
         return OK;
@@ -491,50 +910,10 @@ int MneSurfaceOrVolume::mne_filter_source_spaces(MneSurfaceOld* surf, float limi
     printf(" (will take a few...)\n");
     omit         = 0;
     omit_outside = 0;
-    for (k = 0; k < nspace; k++) {
-        s = spaces[k];
-        for (p1 = 0; p1 < s->np; p1++)
-            if (s->inuse[p1]) {
-                VEC_COPY_17(r1,s->rr[p1]);	/* Transform the point to MRI coordinates */
-                if (s->coord_frame == FIFFV_COORD_HEAD)
-                    FiffCoordTransOld::fiff_coord_trans_inv(r1,mri_head_t,FIFFV_MOVE);
-                /*
-                * Check that the source is inside the inner skull surface
-                */
-                tot_angle = sum_solids(r1,surf)/(4*M_PI);
-                if (std::fabs(tot_angle-1.0) > 1e-5) {
-                    omit_outside++;
-                    s->inuse[p1] = FALSE;
-                    s->nuse--;
-                    if (filtered)
-                        fprintf(filtered,"%10.3f %10.3f %10.3f\n",
-                                1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-                }
-                else if (limit > 0.0) {
-                    /*
-                        * Check the distance limit
-                        */
-                    mindist = 1.0;
-                    minnode = 0;
-                    for (p2 = 0; p2 < surf->np; p2++) {
-                        VEC_DIFF_17(r1,surf->rr[p2],diff);
-                        dist = VEC_LEN_17(diff);
-                        if (dist < mindist) {
-                            mindist = dist;
-                            minnode = p2;
-                        }
-                    }
-                    if (mindist < limit) {
-                        omit++;
-                        s->inuse[p1] = FALSE;
-                        s->nuse--;
-                        if (filtered)
-                            fprintf(filtered,"%10.3f %10.3f %10.3f\n",
-                                    1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-                    }
-                }
-            }
-    }
+    grid = make_vertex_grid(surf->rr,surf->np,NULL);
+    for (k = 0; k < nspace; k++)
+        filter_points(surf,grid,limit,mri_head_t,spaces[k],filtered,true,&omit,&omit_outside);
+    free_vertex_grid(grid);
     if (omit_outside > 0)
         printf("%d source space points omitted because they are outside the inner skull surface.\n",
                omit_outside);
@@ -670,58 +1049,15 @@ void MneSurfaceOrVolume::rearrange_source_space(MneSourceSpaceOld* s)
 void *MneSurfaceOrVolume::filter_source_space(void *arg)
 {
     FilterThreadArg* a = (FilterThreadArg*)arg;
-    int    p1,p2;
-    double tot_angle;
-    int    omit,omit_outside;
-    float  r1[3];
-    float  mindist,dist,diff[3];
-    int    minnode;
+    int        omit,omit_outside;
+    vertexGrid grid;
 
     omit         = 0;
     omit_outside = 0;
 
-    for (p1 = 0; p1 < a->s->np; p1++) {
-        if (a->s->inuse[p1]) {
-            VEC_COPY_17(r1,a->s->rr[p1]);	/* Transform the point to MRI coordinates */
-            if (a->s->coord_frame == FIFFV_COORD_HEAD)
-                FiffCoordTransOld::fiff_coord_trans_inv(r1,a->mri_head_t,FIFFV_MOVE);
-            /*
-           * Check that the source is inside the inner skull surface
-           */
-            tot_angle = sum_solids(r1,a->surf)/(4*M_PI);
-            if (std::fabs(tot_angle-1.0) > 1e-5) {
-                omit_outside++;
-                a->s->inuse[p1] = FALSE;
-                a->s->nuse--;
-                if (a->filtered)
-                    fprintf(a->filtered,"%10.3f %10.3f %10.3f\n",
-                            1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-            }
-            else if (a->limit > 0.0) {
-                /*
-         * Check the distance limit
-         */
-                mindist = 1.0;
-                minnode = 0;
-                for (p2 = 0; p2 < a->surf->np; p2++) {
-                    VEC_DIFF_17(r1,a->surf->rr[p2],diff);
-                    dist = VEC_LEN_17(diff);
-                    if (dist < mindist) {
-                        mindist = dist;
-                        minnode = p2;
-                    }
-                }
-                if (mindist < a->limit) {
-                    omit++;
-                    a->s->inuse[p1] = FALSE;
-                    a->s->nuse--;
-                    if (a->filtered)
-                        fprintf(a->filtered,"%10.3f %10.3f %10.3f\n",
-                                1000*r1[X_17],1000*r1[Y_17],1000*r1[Z_17]);
-                }
-            }
-        }
-    }
+    grid = make_vertex_grid(a->surf->rr,a->surf->np,NULL);
+    filter_points(a->surf,grid,a->limit,a->mri_head_t,a->s,a->filtered,false,&omit,&omit_outside);
+    free_vertex_grid(grid);
     if (omit_outside > 0)
         fprintf(stderr,"%d source space points omitted because they are outside the inner skull surface.\n",
                 omit_outside);
@@ -742,8 +1078,9 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
 {
     MneSurfaceOld*    surf = NULL;
     int             k;
-    int             nproc = QThread::idealThreadCount();
-    FilterThreadArg* a;
+    int             nproc = UTILSLIB::ExecutionConfig::threadCount();
+    int             omit,omit_outside;
+    vertexGrid      grid;
 
     if (!bemfile)
         return OK;
@@ -766,49 +1103,23 @@ int MneSurfaceOrVolume::filter_source_spaces(float limit, char *bemfile, FiffCoo
     if (limit > 0.0)
         fprintf(stderr,"and at least %6.1f mm away",1000*limit);
     fprintf(stderr," (will take a few...)\n");
-    if (nproc < 2 || nspace == 1 || !use_threads) {
-        /*
-        * This is the conventional calculation
-        */
-        for (k = 0; k < nspace; k++) {
-            a = new FilterThreadArg();
-            a->s = spaces[k];
-            a->mri_head_t = mri_head_t;
-            a->surf = surf;
-            a->limit = limit;
-            a->filtered = filtered;
-            filter_source_space(a);
-            if(a)
-                delete a;
-            rearrange_source_space(spaces[k]);
-        }
-    }
-    else {
-        /*
-        * Calculate all (both) source spaces simultaneously
-        */
-        QList<FilterThreadArg*> args;//filterThreadArg *args = MALLOC_17(nspace,filterThreadArg);
-
-        for (k = 0; k < nspace; k++) {
-            a = new FilterThreadArg();
-            a->s = spaces[k];
-            a->mri_head_t = mri_head_t;
-            a->surf = surf;
-            a->limit = limit;
-            a->filtered = filtered;
-            args.append(a);
-        }
-        /*
-        * Ready to start the threads & Wait for them to complete
-        */
-        QtConcurrent::blockingMap(args, filter_source_space);
-
-        for (k = 0; k < nspace; k++) {
-            rearrange_source_space(spaces[k]);
-            if(args[k])
-                delete args[k];
-        }
-    }
+    /*
+    * The source spaces are processed one after another, the points of each in parallel
+    */
+    grid = make_vertex_grid(surf->rr,surf->np,NULL);
+    for (k = 0; k < nspace; k++) {
+        omit         = 0;
+        omit_outside = 0;
+        filter_points(surf,grid,limit,mri_head_t,spaces[k],filtered,use_threads && nproc > 1,&omit,&omit_outside);
+        if (omit_outside > 0)
+            fprintf(stderr,"%d source space points omitted because they are outside the inner skull surface.\n",
+                    omit_outside);
+        if (omit > 0)
+            fprintf(stderr,"%d source space points omitted because of the %6.1f-mm distance limit.\n",
+                    omit,1000*limit);
+        rearrange_source_space(spaces[k]);
+    }
+    free_vertex_grid(grid);
     if(surf)
         delete surf;
     printf("Thank you for waiting.\n\n");
@@ -1563,26 +1874,48 @@ void MneSurfaceOrVolume::mne_find_closest_on_surface_approx(MneSurfaceOld* s, fl
 /*
       * Find the closest triangle on the surface for each point and the distance to it
       * This uses the values in nearest as approximations of the closest triangle
+      * Where these are missing, the search starts from the closest vertex found with a grid
       */
 {
-    MneProjData* p = new MneProjData(s);
-    int k,was;
-    float mydist;
+    QList<closestBlockRec> blocks;
+    closestBlockRec        b;
+    int *use;
+    int k;
 
     fprintf(stderr,"%s for %d points %d steps...",nearest[0] < 0 ? "Closest" : "Approx closest",np,nstep);
 
-    for (k = 0; k < np; k++) {
-        was = nearest[k];
-        decide_search_restriction(s,p,nearest[k],nstep,r[k]);
-        nearest[k] =  mne_project_to_surface(s,p,r[k],0,dist ? dist+k : &mydist);
-        if (nearest[k] < 0) {
-            decide_search_restriction(s,p,-1,nstep,r[k]);
-            nearest[k] =  mne_project_to_surface(s,p,r[k],0,dist ? dist+k : &mydist);
-        }
-    }
+    /*
+     * The grid is only needed for points without an approximation
+     */
+    b.grid = NULL;
+    for (k = 0; k < np; k++)
+        if (nearest[k] < 0)
+            break;
+    if (k < np) {
+        use = MALLOC_17(s->np,int);
+        for (k = 0; k < s->np; k++)
+            use[k] = s->nneighbor_tri[k] > 0;
+        b.grid = make_vertex_grid(s->rr,s->np,use);
+        FREE_17(use);
+    }
+    b.s       = s;
+    b.r       = r;
+    b.nearest = nearest;
+    b.dist    = dist;
+    b.nstep   = nstep;
+    for (b.from = 0; b.from < np; b.from += GRID_BLOCK) {
+        b.to = std::min(b.from+GRID_BLOCK,np);
+        blocks.append(b);
+    }
+    if (blocks.size() > 1)
+        QtConcurrent::blockingMap(blocks, closest_point_block);
+    else
+        for (k = 0; k < blocks.size(); k++)
+            closest_point_block(blocks[k]);
+    if (b.grid)
+        free_vertex_grid(b.grid);
 
     fprintf(stderr,"[done]\n");
-    delete p;
     return;
 }
 
@@ -2079,10 +2412,8 @@ int MneSurfaceOrVolume::mne_transform_source_space(MneSourceSpaceOld* ss, FiffCo
         printf("Coordinate transformation does not match with the source space coordinate system.");
         return FAIL;
     }
-    for (k = 0; k < ss->np; k++) {
-        FiffCoordTransOld::fiff_coord_trans(ss->rr[k],t,FIFFV_MOVE);
-        FiffCoordTransOld::fiff_coord_trans(ss->nn[k],t,FIFFV_NO_MOVE);
-    }
+    FiffCoordTransOld::fiff_coord_trans_points(ss->rr,ss->np,t,FIFFV_MOVE);
+    FiffCoordTransOld::fiff_coord_trans_points(ss->nn,ss->np,t,FIFFV_NO_MOVE);
     if (ss->tris) {
         for (k = 0; k < ss->ntri; k++)
             FiffCoordTransOld::fiff_coord_trans(ss->tris[k].nn,t,FIFFV_NO_MOVE);
@@ -2533,9 +2864,9 @@ void MneSurfaceOrVolume::mne_compute_surface_cm(MneSurfaceOld *s)
 
 void MneSurfaceOrVolume::calculate_vertex_distances(MneSourceSpaceOld* s)
 {
-    int   k,p,ndist;
-    float *dist,diff[3];
-    int   *neigh, nneigh;
+    QList<distanceBlockRec> blocks;
+    distanceBlockRec        b;
+    int   k,ndist;
 
     if (!s->neighbor_vert || !s->nneighbor_vert)
         return;
@@ -2547,20 +2878,18 @@ void MneSurfaceOrVolume::calculate_vertex_distances(MneSourceSpaceOld* s)
     }
     s->vert_dist = MALLOC_17(s->np,float *);
     printf("\tDistances between neighboring vertices...");
-    for (k = 0, ndist = 0; k < s->np; k++) {
-        s->vert_dist[k]  = dist = MALLOC_17(s->nneighbor_vert[k],float);
-        neigh  = s->neighbor_vert[k];
-        nneigh = s->nneighbor_vert[k];
-        for (p = 0; p < nneigh; p++) {
-            if (neigh[p] >= 0) {
-                VEC_DIFF_17(s->rr[k],s->rr[neigh[p]],diff);
-                dist[p] = VEC_LEN_17(diff);
-            }
-            else
-                dist[p] = -1.0;
-            ndist++;
-        }
+    b.s = s;
+    for (b.from = 0; b.from < s->np; b.from += 16*GRID_BLOCK) {
+        b.to = std::min(b.from+16*GRID_BLOCK,s->np);
+        blocks.append(b);
     }
+    if (blocks.size() > 1)
+        QtConcurrent::blockingMap(blocks, vertex_distance_block);
+    else
+        for (k = 0; k < blocks.size(); k++)
+            vertex_distance_block(blocks[k]);
+    for (k = 0, ndist = 0; k < s->np; k++)
+        ndist += s->nneighbor_vert[k];
     printf("[%d distances done]\n",ndist);
     return;
 }
@@ -2904,9 +3233,11 @@ int MneSurfaceOrVolume::align_fiducials(FiffDigitizerData* head_dig,
                                         MneMshDisplaySurface* head_surf,
                                         int niter,
                                         int scale_head,
-                                        float omit_dist)
+                                        float omit_dist,
+                                        float conv_tol)
 /*
  * Align the MEG fiducials to the MRI fiducials
+ * The iterative refinement stops early once the RMS distance changes less than conv_tol
  */
 {
     float           *head_fid[3],*mri_fid[3],**fid;
@@ -2915,6 +3246,8 @@ int MneSurfaceOrVolume::align_fiducials(FiffDigitizerData* head_dig,
     FiffDigitizerData*  dig = NULL;
     float          nasion_weight = 5.0;
     float          scales[3];
+    float          rms,prev_rms;
+    QElapsedTimer  timer;
 
     if (!head_dig) {
         qCritical("MEG head coordinate system digitizer data not available");
@@ -2987,13 +3320,28 @@ int MneSurfaceOrVolume::align_fiducials(FiffDigitizerData* head_dig,
     * Optional iterative refinement
     */
     if (niter > 0 && head_surf) {
+        timer.start();
+        prev_rms = -1.0;
         for (k = 0; k < niter; k++) {
             if (iterate_alignment_once(head_dig,head_surf,nasion_weight,mri_fid[1],k == niter-1 && niter > 1) == FAIL)
                 goto bad;
+            if (conv_tol > 0 && k < niter-1) {
+                rms = rms_digitizer_distance(head_dig,head_surf);
+                if (prev_rms >= 0 && std::fabs(prev_rms-rms) < conv_tol) {
+                    /*
+                    * Converged: finish with the exact distances as the last step would
+                    */
+                    k++;
+                    head_dig->dist_valid = FALSE;
+                    calculate_digitizer_distances(head_dig,head_surf,FALSE,FALSE);
+                    break;
+                }
+                prev_rms = rms;
+            }
         }
 
-        fprintf(stderr,"%d / %d iterations done. RMS dist = %7.1f mm\n",k,niter,
-                1000.0*rms_digitizer_distance(head_dig,head_surf));
+        fprintf(stderr,"%d / %d iterations done in %.1f ms. RMS dist = %7.1f mm\n",k,niter,
+                timer.nsecsElapsed()/1.0e6,1000.0*rms_digitizer_distance(head_dig,head_surf));
         FiffCoordTransOld::mne_print_coord_transform_label(stderr,QString("After refinement :").toLatin1().data(),head_dig->head_mri_t_adj);
     }
 
@@ -3142,7 +3490,6 @@ void MneSurfaceOrVolume::calculate_digitizer_distances(FIFFLIB::FiffDigitizerDat
         if ((dig->active[k] && !dig->discard[k]) || do_all) {
             point = dig->points.at(k);
             VEC_COPY_17(rr[nactive],point.r);
-            FiffCoordTransOld::fiff_coord_trans(rr[nactive],t,FIFFV_MOVE);
             if (do_approx) {
                 closest[nactive] = dig->closest[k];
                 if (closest[nactive] < 0)
@@ -3153,6 +3500,7 @@ void MneSurfaceOrVolume::calculate_digitizer_distances(FIFFLIB::FiffDigitizerDat
             nactive++;
         }
     }
+    FiffCoordTransOld::fiff_coord_trans_points(rr,nactive,t,FIFFV_MOVE);
 
     mne_find_closest_on_surface_approx(head->s,rr,nactive,closest,dist,nstep);
     /*
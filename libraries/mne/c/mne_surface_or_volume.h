@@ -346,7 +346,8 @@ public:
                                MneMshDisplaySurface* head_surf,
                                int niter,
                                int scale_head,
-                               float omit_dist);
+                               float omit_dist,
+                               float conv_tol = 0.0f);      /* Stop iterating when the RMS distance changes less (optional) */
 
     static void get_head_scale(FIFFLIB::FiffDigitizerData* dig,
                                    float **mri_fid,
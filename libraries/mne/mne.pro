@@ -79,6 +79,7 @@ SOURCES += \
     mne_inverse_operator.cpp \
     mne_epoch_data.cpp \
     mne_epoch_data_list.cpp \
+    mne_epoch_average.cpp \
     mne_cluster_info.cpp \
     mne_surface.cpp \
     mne_corsourceestimate.cpp\
@@ -95,6 +96,7 @@ SOURCES += \
     c/mne_proj_item.cpp \
     c/mne_proj_op.cpp \
     c/mne_raw_buf_def.cpp \
+    c/mne_raw_buf_cache.cpp \
     c/mne_raw_data.cpp \
     c/mne_raw_info.cpp \
     c/mne_sss_data.cpp \
@@ -129,6 +131,7 @@ HEADERS += \
     mne_inverse_operator.h \
     mne_epoch_data.h \
     mne_epoch_data_list.h \
+    mne_epoch_average.h \
     mne_cluster_info.h \
     mne_surface.h \
     mne_corsourceestimate.h\
@@ -145,6 +148,7 @@ HEADERS += \
     c/mne_proj_item.h \
     c/mne_proj_op.h \
     c/mne_raw_buf_def.h \
+    c/mne_raw_buf_cache.h \
     c/mne_raw_data.h \
     c/mne_raw_info.h \
     c/mne_sss_data.h \
@@ -478,13 +478,8 @@ void MNEBem::warp(const MatrixXf & sLm, const MatrixXf &dLm)
 
 void MNEBem::transform(const FiffCoordTrans trans)
 {
-    MatrixX3f vert;
     for (int i=0; i<this->m_qListBemSurface.size(); i++)
-    {
-        vert = this->m_qListBemSurface[i].rr;
-        vert = trans.apply_trans(vert);
-        this->m_qListBemSurface[i].rr = vert;
-    }
+        trans.apply_trans_inplace(this->m_qListBemSurface[i].rr);
     return;
 }
 
@@ -493,12 +488,7 @@ void MNEBem::transform(const FiffCoordTrans trans)
 
 void MNEBem::invtransform(const FiffCoordTrans trans)
 {
-    MatrixX3f vert;
     for (int i=0; i<this->m_qListBemSurface.size(); i++)
-    {
-        vert = this->m_qListBemSurface[i].rr;
-        vert = trans.apply_inverse_trans(vert);
-        this->m_qListBemSurface[i].rr = vert;
-    }
+        trans.apply_inverse_trans_inplace(this->m_qListBemSurface[i].rr);
     return;
 }
@@ -0,0 +1,215 @@
+//=============================================================================================================
+/**
+* @file     mne_epoch_average.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     Definition of the MNEEpochAverage Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_epoch_average.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace MNELIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MNEEpochAverage::MNEEpochAverage(fiff_int_t first, fiff_int_t last, const VectorXd& reject)
+: m_iFirst(first)
+, m_iLast(last)
+, m_vecReject(reject)
+, m_iCount(0)
+, m_iRejected(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void MNEEpochAverage::clear()
+{
+    m_iCount = 0;
+    m_iRejected = 0;
+    m_matMean = MatrixXd();
+    m_matM2 = MatrixXd();
+}
+
+
+//*************************************************************************************************************
+
+bool MNEEpochAverage::append(const MatrixXd& epoch)
+{
+    if(m_iCount == 0) {
+        if(m_iLast >= m_iFirst && epoch.cols() != m_iLast - m_iFirst + 1) {
+            printf("MNEEpochAverage::append - The epoch has %d samples instead of %d\n", (int)epoch.cols(), m_iLast - m_iFirst + 1);
+            return false;
+        }
+    } else if(epoch.rows() != m_matMean.rows() || epoch.cols() != m_matMean.cols()) {
+        printf("MNEEpochAverage::append - The epoch size %d x %d does not fit the average\n", (int)epoch.rows(), (int)epoch.cols());
+        return false;
+    }
+
+    if(m_vecReject.size() == epoch.rows()) {
+        for(qint32 r = 0; r < epoch.rows(); ++r) {
+            if(m_vecReject[r] > 0.0 && epoch.row(r).maxCoeff() - epoch.row(r).minCoeff() > m_vecReject[r]) {
+                ++m_iRejected;
+                return false;
+            }
+        }
+    }
+
+    if(m_iCount == 0) {
+        m_matMean = epoch;
+        m_matM2 = MatrixXd::Zero(epoch.rows(), epoch.cols());
+        if(m_iLast < m_iFirst)
+            m_iLast = m_iFirst + epoch.cols() - 1;
+        m_iCount = 1;
+        return true;
+    }
+
+    //
+    //   Welford update, numerically stable for any number of epochs
+    //
+    ++m_iCount;
+    MatrixXd matDelta = epoch - m_matMean;
+    m_matMean += matDelta / m_iCount;
+    m_matM2.array() += matDelta.array() * (epoch - m_matMean).array();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd MNEEpochAverage::variance() const
+{
+    if(m_iCount < 2)
+        return MatrixXd::Zero(m_matMean.rows(), m_matMean.cols());
+
+    return m_matM2 / (m_iCount - 1);
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd MNEEpochAverage::standardError() const
+{
+    if(m_iCount < 2)
+        return MatrixXd::Zero(m_matMean.rows(), m_matMean.cols());
+
+    return (m_matM2.array() / ((double)(m_iCount - 1) * m_iCount)).sqrt().matrix();
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd MNEEpochAverage::snr() const
+{
+    MatrixXd matStdErr = standardError();
+
+    return (matStdErr.array() > 0.0).select(m_matMean.array().abs() / matStdErr.array(), 0.0).matrix();
+}
+
+
+//*************************************************************************************************************
+
+FiffEvoked MNEEpochAverage::evoked(FiffInfo& info, bool proj, bool stdErr, const QString& comment) const
+{
+    FiffEvoked p_evoked;
+
+    if(m_iCount == 0)
+        return p_evoked;
+
+    p_evoked.setInfo(info, proj);
+
+    p_evoked.nave = m_iCount;
+    p_evoked.aspect_kind = stdErr ? FIFFV_ASPECT_STD_ERR : FIFFV_ASPECT_AVERAGE;
+
+    p_evoked.first = m_iFirst;
+    p_evoked.last = m_iLast;
+
+    RowVectorXf times = RowVectorXf(m_iLast-m_iFirst+1);
+    for (qint32 k = 0; k < times.size(); ++k)
+        times[k] = ((float)(m_iFirst+k)) / info.sfreq;
+    p_evoked.times = times;
+
+    p_evoked.comment = comment;
+
+    MatrixXd matData = stdErr ? standardError() : m_matMean;
+
+    if(p_evoked.proj.rows() > 0 && !stdErr)
+    {
+        matData = p_evoked.proj * matData;
+        printf("\tSSP projectors applied to the evoked data\n");
+    }
+
+    p_evoked.data = matData;
+
+    return p_evoked;
+}
+
+
+//*************************************************************************************************************
+
+VectorXd MNEEpochAverage::rejectionThresholds(const FiffInfo& info, const RowVectorXi& picks, const QMap<QString,double>& reject)
+{
+    qint32 iNChan = picks.size() > 0 ? picks.size() : info.nchan;
+    VectorXd vecReject = VectorXd::Zero(iNChan);
+    for(qint32 r = 0; r < iNChan && !reject.isEmpty(); ++r) {
+        const FiffChInfo& ch = info.chs[picks.size() > 0 ? picks[r] : r];
+        if(info.bads.contains(ch.ch_name))
+            continue;
+
+        if(ch.kind == FIFFV_MEG_CH && ch.unit == FIFF_UNIT_T_M)
+            vecReject[r] = reject.value("grad", 0.0);
+        else if(ch.kind == FIFFV_MEG_CH && ch.unit == FIFF_UNIT_T)
+            vecReject[r] = reject.value("mag", 0.0);
+        else if(ch.kind == FIFFV_EEG_CH)
+            vecReject[r] = reject.value("eeg", 0.0);
+        else if(ch.kind == FIFFV_EOG_CH)
+            vecReject[r] = reject.value("eog", 0.0);
+    }
+
+    return vecReject;
+}
@@ -0,0 +1,247 @@
+//=============================================================================================================
+/**
+* @file     mne_epoch_average.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     MNEEpochAverage class declaration.
+*
+*/
+
+#ifndef MNE_EPOCH_AVERAGE_H
+#define MNE_EPOCH_AVERAGE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_types.h>
+#include <fiff/fiff_info.h>
+#include <fiff/fiff_evoked.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MNE INCLUDES
+//=============================================================================================================
+
+#include "mne_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QMap>
+#include <QSharedPointer>
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNELIB
+//=============================================================================================================
+
+namespace MNELIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Running average of epochs. The epochs are added one after the other and only the running mean and the sum
+* of squared deviations (Welford) are kept, which gives the variance, the standard error and the SNR of the
+* average without holding the epochs in memory.
+*
+* @brief Running epoch average
+*/
+class MNESHARED_EXPORT MNEEpochAverage
+{
+public:
+    typedef QSharedPointer<MNEEpochAverage> SPtr;              /**< Shared pointer type for MNEEpochAverage. */
+    typedef QSharedPointer<const MNEEpochAverage> ConstSPtr;   /**< Const shared pointer type for MNEEpochAverage. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a running average.
+    *
+    * @param[in] first      First time sample of the epochs relative to the event.
+    * @param[in] last       Last time sample of the epochs relative to the event.
+    * @param[in] reject     Peak-to-peak rejection threshold per row, 0 = not checked (optional, no rejection).
+    */
+    MNEEpochAverage(FIFFLIB::fiff_int_t first = 0, FIFFLIB::fiff_int_t last = -1, const VectorXd& reject = VectorXd());
+
+    //=========================================================================================================
+    /**
+    * Resets the average to zero epochs, keeps the time range and the rejection thresholds.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Adds an epoch to the average unless it is rejected. The first epoch sets the size if no time range was
+    * given.
+    *
+    * @param[in] epoch      The epoch [channels x samples].
+    *
+    * @return true if the epoch was added, false if it was rejected or does not fit the size of the average.
+    */
+    bool append(const MatrixXd& epoch);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of averaged epochs.
+    *
+    * @return the number of averaged epochs
+    */
+    inline FIFFLIB::fiff_int_t count() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of rejected epochs.
+    *
+    * @return the number of rejected epochs
+    */
+    inline FIFFLIB::fiff_int_t rejected() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the running mean.
+    *
+    * @return the mean [channels x samples]
+    */
+    inline const MatrixXd& mean() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the unbiased variance of the epochs, zero for less than two epochs.
+    *
+    * @return the variance [channels x samples]
+    */
+    MatrixXd variance() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the standard error of the mean, sqrt(variance/count).
+    *
+    * @return the standard error [channels x samples]
+    */
+    MatrixXd standardError() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the SNR of the average, |mean|/standard error, zero where the standard error is zero.
+    *
+    * @return the SNR [channels x samples]
+    */
+    MatrixXd snr() const;
+
+    //=========================================================================================================
+    /**
+    * Creates the evoked data of the average or of its standard error. The standard error needs the channel
+    * covariance to be projected, it is returned unprojected. Project the epochs before they are appended if
+    * a projected standard error is needed.
+    *
+    * @param[in] info       Measurement info of the averaged channels.
+    * @param[in] proj       Apply SSP projection vectors (optional, default = false)
+    * @param[in] stdErr     Create the standard error (FIFFV_ASPECT_STD_ERR) instead of the average (optional)
+    * @param[in] comment    Comment of the evoked data, e.g. the event code (optional)
+    *
+    * @return the evoked data, empty if no epoch was averaged
+    */
+    FIFFLIB::FiffEvoked evoked(FIFFLIB::FiffInfo& info, bool proj = false, bool stdErr = false, const QString& comment = QString()) const;
+
+    //=========================================================================================================
+    /**
+    * Peak-to-peak rejection thresholds of the given channels by their type. Bad channels are not checked.
+    *
+    * @param[in] info       Measurement info.
+    * @param[in] picks      Channels (optional, default all channels).
+    * @param[in] reject     Thresholds per channel type, keys "grad", "mag", "eeg" and "eog".
+    *
+    * @return one threshold per channel, 0 = not checked
+    */
+    static VectorXd rejectionThresholds(const FIFFLIB::FiffInfo& info, const RowVectorXi& picks, const QMap<QString,double>& reject);
+
+private:
+    FIFFLIB::fiff_int_t m_iFirst;       /**< First time sample. */
+    FIFFLIB::fiff_int_t m_iLast;        /**< Last time sample. */
+    VectorXd            m_vecReject;    /**< Peak-to-peak threshold per row, 0 = not checked. */
+    FIFFLIB::fiff_int_t m_iCount;       /**< Number of averaged epochs. */
+    FIFFLIB::fiff_int_t m_iRejected;    /**< Number of rejected epochs. */
+    MatrixXd            m_matMean;      /**< Running mean. */
+    MatrixXd            m_matM2;        /**< Running sum of squared deviations from the mean. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline FIFFLIB::fiff_int_t MNEEpochAverage::count() const
+{
+    return m_iCount;
+}
+
+
+//*************************************************************************************************************
+
+inline FIFFLIB::fiff_int_t MNEEpochAverage::rejected() const
+{
+    return m_iRejected;
+}
+
+
+//*************************************************************************************************************
+
+inline const MatrixXd& MNEEpochAverage::mean() const
+{
+    return m_matMean;
+}
+
+} // NAMESPACE
+
+#endif // MNE_EPOCH_AVERAGE_H
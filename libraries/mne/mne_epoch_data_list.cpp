@@ -41,6 +41,26 @@
 #include "mne_epoch_data_list.h"
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent>
+#include <QPair>
+#include <QVector>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -50,6 +70,180 @@ using namespace FIFFLIB;
 using namespace MNELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE STATIC HELPERS
+//=============================================================================================================
+
+/**
+* Cutting out a single epoch from a segment of raw data.
+*/
+struct EpochCut {
+    MNEEpochData::SPtr  pEpoch;         /**< The epoch to fill. */
+    const MatrixXd*     pSegment;       /**< The raw data segment containing the epoch. */
+    qint32              iOffset;        /**< First column of the epoch in the segment. */
+    qint32              iNSamp;         /**< Number of samples of the epoch. */
+    qint32              iBaseFrom;      /**< First baseline column relative to the epoch start, -1 if no baseline. */
+    qint32              iBaseTo;        /**< Last baseline column relative to the epoch start. */
+    const VectorXd*     pReject;        /**< Peak-to-peak threshold per row, 0 = not checked, NULL if no rejection. */
+    bool                bReject;        /**< Result of the artifact check. */
+};
+
+
+//*************************************************************************************************************
+
+static void cutEpoch(EpochCut& cut)
+{
+    MatrixXd& epoch = cut.pEpoch->epoch;
+    epoch = cut.pSegment->block(0, cut.iOffset, cut.pSegment->rows(), cut.iNSamp);
+
+    if(cut.iBaseFrom >= 0) {
+        VectorXd vecMean = epoch.block(0, cut.iBaseFrom, epoch.rows(), cut.iBaseTo - cut.iBaseFrom + 1).rowwise().mean();
+        epoch.colwise() -= vecMean;
+    }
+
+    cut.bReject = false;
+    if(cut.pReject) {
+        for(qint32 r = 0; r < epoch.rows(); ++r) {
+            double dThreshold = (*cut.pReject)[r];
+            if(dThreshold > 0.0 && epoch.row(r).maxCoeff() - epoch.row(r).minCoeff() > dThreshold) {
+                cut.bReject = true;
+                break;
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Reads the epochs of the given events segment by segment and hands each accepted epoch with the index of its
+* event to the sink. Returns the number of rejected epochs.
+*/
+static qint32 readEpochSegments(FiffRawData& raw,
+                                const QList<fiff_int_t>& eventSamples,
+                                fiff_int_t event,
+                                float tmin,
+                                float tmax,
+                                const RowVectorXi& picks,
+                                bool baseline,
+                                float bmin,
+                                float bmax,
+                                const QMap<QString,double>& reject,
+                                const std::function<void(qint32, const MNEEpochData::SPtr&)>& sink)
+{
+    if(eventSamples.isEmpty() || raw.rawdir.isEmpty())
+        return 0;
+
+    float sfreq = raw.info.sfreq;
+    fiff_int_t iStart = (fiff_int_t)floor(tmin*sfreq + 0.5);
+    fiff_int_t iStop = (fiff_int_t)floor(tmax*sfreq + 0.5);
+    qint32 iNSamp = iStop - iStart + 1;
+
+    if(iNSamp <= 0) {
+        printf("MNEEpochDataList::readEpochs - tmax has to be larger than tmin\n");
+        return 0;
+    }
+
+    //
+    //   Baseline interval in columns of the epoch
+    //
+    qint32 iBaseFrom = -1, iBaseTo = -1;
+    if(baseline) {
+        iBaseFrom = qBound(0, (qint32)floor(bmin*sfreq + 0.5) - iStart, iNSamp - 1);
+        iBaseTo = qBound(0, (qint32)floor(bmax*sfreq + 0.5) - iStart, iNSamp - 1);
+        if(iBaseTo < iBaseFrom) {
+            printf("MNEEpochDataList::readEpochs - Empty baseline interval, no baseline correction is applied\n");
+            iBaseFrom = -1;
+        }
+    }
+
+    //
+    //   Rejection thresholds for the picked channels
+    //
+    VectorXd vecReject = MNEEpochAverage::rejectionThresholds(raw.info, picks, reject);
+
+    //
+    //   Sort the epochs which lie completely in the recording by their first sample
+    //
+    QList<QPair<fiff_int_t, qint32> > lOrder; // first sample, index into eventSamples
+    for(qint32 i = 0; i < eventSamples.size(); ++i) {
+        fiff_int_t from = eventSamples[i] + iStart;
+        if(from < raw.first_samp || from + iNSamp - 1 > raw.last_samp) {
+            printf("MNEEpochDataList::readEpochs - Epoch of event at sample %d exceeds the data range, omitted\n", eventSamples[i]);
+            continue;
+        }
+        lOrder.append(qMakePair(from, i));
+    }
+    std::sort(lOrder.begin(), lOrder.end());
+
+    qint32 iRejected = 0;
+
+    //
+    //   Merge epochs sharing a raw data buffer into segments, each segment is read once.
+    //   Segments are limited to about 30 s to keep the memory footprint bounded.
+    //
+    if(raw.rawdir_last.size() != raw.rawdir.size())
+        raw.build_rawdir_index();
+
+    qint32 iMaxSegment = qMax(iNSamp, (qint32)(30.0f*sfreq));
+
+    qint32 k = 0;
+    while(k < lOrder.size()) {
+        fiff_int_t segFrom = lOrder[k].first;
+        fiff_int_t segTo = segFrom + iNSamp - 1;
+        qint32 iBuffer = raw.find_rawdir_entry(segTo);
+        fiff_int_t bufferLast = iBuffer < raw.rawdir.size() ? raw.rawdir[iBuffer].last : raw.last_samp;
+
+        qint32 kEnd = k + 1;
+        while(kEnd < lOrder.size() && lOrder[kEnd].first <= bufferLast && lOrder[kEnd].first + iNSamp - segFrom <= iMaxSegment) {
+            segTo = lOrder[kEnd].first + iNSamp - 1;
+            iBuffer = raw.find_rawdir_entry(segTo);
+            bufferLast = iBuffer < raw.rawdir.size() ? raw.rawdir[iBuffer].last : raw.last_samp;
+            ++kEnd;
+        }
+
+        MatrixXd matSegment, matTimes;
+        if(!raw.read_raw_segment(matSegment, matTimes, segFrom, segTo, picks)) {
+            printf("MNEEpochDataList::readEpochs - Could not read samples %d ... %d\n", segFrom, segTo);
+            k = kEnd;
+            continue;
+        }
+
+        QList<EpochCut> lCuts;
+        for(qint32 j = k; j < kEnd; ++j) {
+            EpochCut cut;
+            cut.pEpoch = MNEEpochData::SPtr(new MNEEpochData());
+            cut.pEpoch->event = event;
+            cut.pEpoch->tmin = ((float)(lOrder[j].first) - (float)(raw.first_samp))/sfreq;
+            cut.pEpoch->tmax = ((float)(lOrder[j].first + iNSamp - 1) - (float)(raw.first_samp))/sfreq;
+            cut.pSegment = &matSegment;
+            cut.iOffset = lOrder[j].first - segFrom;
+            cut.iNSamp = iNSamp;
+            cut.iBaseFrom = iBaseFrom;
+            cut.iBaseTo = iBaseTo;
+            cut.pReject = reject.isEmpty() ? Q_NULLPTR : &vecReject;
+            cut.bReject = false;
+            lCuts.append(cut);
+        }
+
+        QtConcurrent::blockingMap(lCuts, cutEpoch);
+
+        for(qint32 j = 0; j < lCuts.size(); ++j) {
+            if(lCuts[j].bReject)
+                ++iRejected;
+            else
+                sink(lOrder[k + j].second, lCuts[j].pEpoch);
+        }
+
+        k = kEnd;
+    }
+
+    return iRejected;
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -132,3 +326,75 @@ FiffEvoked MNEEpochDataList::average(FiffInfo& info, fiff_int_t first, fiff_int_
 
     return p_evoked;
 }
+
+
+//*************************************************************************************************************
+
+MNEEpochDataList MNEEpochDataList::readEpochs(FiffRawData& raw,
+                                              const QList<fiff_int_t>& eventSamples,
+                                              fiff_int_t event,
+                                              float tmin,
+                                              float tmax,
+                                              const RowVectorXi& picks,
+                                              bool baseline,
+                                              float bmin,
+                                              float bmax,
+                                              const QMap<QString,double>& reject)
+{
+    MNEEpochDataList data;
+
+    QVector<MNEEpochData::SPtr> vecEpochs(eventSamples.size());
+    qint32 iRejected = readEpochSegments(raw, eventSamples, event, tmin, tmax, picks, baseline, bmin, bmax, reject,
+                                         [&vecEpochs](qint32 iIndex, const MNEEpochData::SPtr& pEpoch) {
+        vecEpochs[iIndex] = pEpoch;
+    });
+
+    for(qint32 i = 0; i < vecEpochs.size(); ++i)
+        if(vecEpochs[i])
+            data.append(vecEpochs[i]);
+
+    printf("MNEEpochDataList::readEpochs - %d epochs read, %d rejected\n", data.size(), iRejected);
+
+    return data;
+}
+
+
+//*************************************************************************************************************
+
+MNEEpochAverage MNEEpochDataList::averageEpochs(FiffRawData& raw,
+                                                const QList<fiff_int_t>& eventSamples,
+                                                fiff_int_t event,
+                                                float tmin,
+                                                float tmax,
+                                                const RowVectorXi& picks,
+                                                bool baseline,
+                                                float bmin,
+                                                float bmax,
+                                                const QMap<QString,double>& reject)
+{
+    float sfreq = raw.info.sfreq;
+    MNEEpochAverage average((fiff_int_t)floor(tmin*sfreq + 0.5), (fiff_int_t)floor(tmax*sfreq + 0.5));
+
+    qint32 iRejected = readEpochSegments(raw, eventSamples, event, tmin, tmax, picks, baseline, bmin, bmax, reject,
+                                         [&average](qint32, const MNEEpochData::SPtr& pEpoch) {
+        average.append(pEpoch->epoch);
+    });
+
+    printf("MNEEpochDataList::averageEpochs - %d epochs averaged, %d rejected\n", average.count(), iRejected);
+
+    return average;
+}
+
+
+//*************************************************************************************************************
+
+QList<FiffProj> MNEEpochDataList::compute_proj(const FiffInfo& p_info, const RowVectorXi& picks, qint32 nGrad, qint32 nMag, qint32 nEeg, FiffProj::Decomposition decomposition) const
+{
+    QList<MatrixXd> lEpochs;
+    for(qint32 i = 0; i < this->size(); ++i)
+        lEpochs.append(this->at(i)->epoch);
+
+    QString sDesc = this->isEmpty() ? QString("Epochs") : QString("Epochs-%1").arg(this->at(0)->event);
+
+    return FiffProj::compute_from_epochs(p_info, lEpochs, picks, sDesc, nGrad, nMag, nEeg, decomposition);
+}
@@ -43,6 +43,8 @@
 
 #include <fiff/fiff_types.h>
 #include <fiff/fiff_evoked.h>
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_proj.h>
 
 
 //*************************************************************************************************************
@@ -52,6 +54,7 @@
 
 #include "mne_global.h"
 #include "mne_epoch_data.h"
+#include "mne_epoch_average.h"
 
 
 //*************************************************************************************************************
@@ -60,7 +63,9 @@
 //=============================================================================================================
 
 #include <QList>
+#include <QMap>
 #include <QSharedPointer>
+#include <QString>
 
 
 //*************************************************************************************************************
@@ -116,6 +121,91 @@ public:
                                 FIFFLIB::fiff_int_t last,
                                 VectorXi sel = FIFFLIB::defaultVectorXi,
                                 bool proj = false);
+
+    //=========================================================================================================
+    /**
+    * Reads the epochs of all given events in one pass. The events are sorted and grouped into segments of
+    * raw data such that every raw data buffer is read and calibrated only once. The epochs of each segment
+    * are then cut out, baseline corrected and checked for artifacts in parallel.
+    *
+    * @param[in] raw            The raw data
+    * @param[in] eventSamples   The samples of the events
+    * @param[in] event          The event code which is stored with the epochs
+    * @param[in] tmin           Start time of the epochs relative to the event in seconds
+    * @param[in] tmax           End time of the epochs relative to the event in seconds
+    * @param[in] picks          Channels to read (optional, default all channels)
+    * @param[in] baseline       Whether to subtract the mean of the baseline interval (optional, default = false)
+    * @param[in] bmin           Start of the baseline interval relative to the event in seconds
+    * @param[in] bmax           End of the baseline interval relative to the event in seconds
+    * @param[in] reject         Peak-to-peak rejection thresholds per channel type, keys "grad", "mag", "eeg"
+    *                           and "eog" (optional). Bad channels are not checked.
+    *
+    * @return the accepted epochs, ordered like eventSamples
+    */
+    static MNEEpochDataList readEpochs(FIFFLIB::FiffRawData& raw,
+                                       const QList<FIFFLIB::fiff_int_t>& eventSamples,
+                                       FIFFLIB::fiff_int_t event,
+                                       float tmin,
+                                       float tmax,
+                                       const RowVectorXi& picks = FIFFLIB::defaultRowVectorXi,
+                                       bool baseline = false,
+                                       float bmin = 0.0f,
+                                       float bmax = 0.0f,
+                                       const QMap<QString,double>& reject = QMap<QString,double>());
+
+    //=========================================================================================================
+    /**
+    * Averages the epochs of all given events while they are read. Reads like readEpochs, but each accepted
+    * epoch is added to the running average and released, so only one raw data segment and the running sums
+    * are held in memory, independent of the number of epochs.
+    *
+    * @param[in] raw            The raw data
+    * @param[in] eventSamples   The samples of the events
+    * @param[in] event          The event code which is stored with the epochs
+    * @param[in] tmin           Start time of the epochs relative to the event in seconds
+    * @param[in] tmax           End time of the epochs relative to the event in seconds
+    * @param[in] picks          Channels to read (optional, default all channels)
+    * @param[in] baseline       Whether to subtract the mean of the baseline interval (optional, default = false)
+    * @param[in] bmin           Start of the baseline interval relative to the event in seconds
+    * @param[in] bmax           End of the baseline interval relative to the event in seconds
+    * @param[in] reject         Peak-to-peak rejection thresholds per channel type, keys "grad", "mag", "eeg"
+    *                           and "eog" (optional). Bad channels are not checked.
+    *
+    * @return the running average with mean, variance and count of the accepted epochs
+    */
+    static MNEEpochAverage averageEpochs(FIFFLIB::FiffRawData& raw,
+                                         const QList<FIFFLIB::fiff_int_t>& eventSamples,
+                                         FIFFLIB::fiff_int_t event,
+                                         float tmin,
+                                         float tmax,
+                                         const RowVectorXi& picks = FIFFLIB::defaultRowVectorXi,
+                                         bool baseline = false,
+                                         float bmin = 0.0f,
+                                         float bmax = 0.0f,
+                                         const QMap<QString,double>& reject = QMap<QString,double>());
+
+    //=========================================================================================================
+    /**
+    * python compute_proj_epochs
+    *
+    * Computes SSP vectors from the epochs, e.g. from epochs around ECG or EOG events. See
+    * FiffProj::compute_from_epochs.
+    *
+    * @param[in] p_info         measurement info
+    * @param[in] picks          The channels the epochs were read with (optional, default all channels)
+    * @param[in] nGrad          Number of vectors for the gradiometers
+    * @param[in] nMag           Number of vectors for the magnetometers
+    * @param[in] nEeg           Number of vectors for the EEG channels
+    * @param[in] decomposition  The decomposition used to find the vectors (optional)
+    *
+    * @return the inactive projection items
+    */
+    QList<FIFFLIB::FiffProj> compute_proj(const FIFFLIB::FiffInfo& p_info,
+                                          const RowVectorXi& picks = FIFFLIB::defaultRowVectorXi,
+                                          qint32 nGrad = 2,
+                                          qint32 nMag = 2,
+                                          qint32 nEeg = 2,
+                                          FIFFLIB::FiffProj::Decomposition decomposition = FIFFLIB::FiffProj::CovarianceDecomposition) const;
 };
 
 } // NAMESPACE
@@ -60,6 +60,8 @@
 
 #include <fs/colortable.h>
 #include <fs/label.h>
+#include <utils/cachefile.h>
+#include <utils/cachelocation.h>
 #include <utils/mnemath.h>
 #include <utils/kmeans.h>
 
@@ -72,6 +74,8 @@
 #include <iostream>
 #include <QtConcurrent>
 #include <QFuture>
+#include <QCryptographicHash>
+#include <QDataStream>
 
 
 //*************************************************************************************************************
@@ -84,6 +88,179 @@ using namespace UTILSLIB;
 using namespace FSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE STATIC HELPERS
+//=============================================================================================================
+
+/**
+* Copies the selected rows of a matrix.
+*/
+template<typename T>
+static Matrix<T, Dynamic, Dynamic> pickRows(const Matrix<T, Dynamic, Dynamic>& p_mat, const RowVectorXi& p_sel)
+{
+    if(p_mat.size() == 0)
+        return Matrix<T, Dynamic, Dynamic>();
+
+    Matrix<T, Dynamic, Dynamic> t_mat(p_sel.size(), p_mat.cols());
+    for(qint32 i = 0; i < p_sel.size(); ++i)
+        t_mat.row(i) = p_mat.row(p_sel[i]);
+    return t_mat;
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Copies the selected columns of a matrix.
+*/
+template<typename T>
+static Matrix<T, Dynamic, Dynamic> pickCols(const Matrix<T, Dynamic, Dynamic>& p_mat, const VectorXi& p_sel)
+{
+    if(p_mat.size() == 0)
+        return Matrix<T, Dynamic, Dynamic>();
+
+    Matrix<T, Dynamic, Dynamic> t_mat(p_mat.rows(), p_sel.size());
+    for(qint32 i = 0; i < p_sel.size(); ++i)
+        t_mat.col(i) = p_mat.col(p_sel[i]);
+    return t_mat;
+}
+
+
+//*************************************************************************************************************
+
+static const char CLUSTERCACHE_KIND[] = "cluster";     /**< Kind of the cluster cache files. */
+
+
+//*************************************************************************************************************
+
+/**
+* Adds a matrix with its dimensions to a hash.
+*/
+template<typename T>
+static void hashMatrix(QCryptographicHash& p_hash, const T& p_mat)
+{
+    qint32 t_iDims[2] = {(qint32)p_mat.rows(), (qint32)p_mat.cols()};
+    p_hash.addData((const char *)t_iDims, sizeof(t_iDims));
+    p_hash.addData((const char *)p_mat.data(), p_mat.size() * sizeof(typename T::Scalar));
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Returns the key of the clustering of the given regions, i.e. the hash of everything RegionData::cluster
+* depends on: the (whitened) region gain matrices, the source indices and label of each region, the number of
+* clusters and the distance measure.
+*/
+static QByteArray clusterCacheKey(const QList<RegionData>& p_qListRegionData)
+{
+    QCryptographicHash t_hash(QCryptographicHash::Sha1);
+    for(qint32 i = 0; i < p_qListRegionData.size(); ++i)
+    {
+        const RegionData& t_region = p_qListRegionData[i];
+        qint32 t_iHeader[3] = {t_region.iLabelIdxIn, t_region.nClusters, t_region.bUseWhitened ? 1 : 0};
+        t_hash.addData((const char *)t_iHeader, sizeof(t_iHeader));
+        t_hash.addData(t_region.sDistMeasure.isEmpty() ? QByteArray("cityblock") : t_region.sDistMeasure.toUtf8());
+        hashMatrix(t_hash, t_region.idcs);
+        hashMatrix(t_hash, t_region.matRoiG);
+        if(t_region.bUseWhitened)
+            hashMatrix(t_hash, t_region.matRoiGWhitened);
+    }
+
+    return t_hash.result();
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Returns the cache file of a clustering, it is named by the key and located in the directory of CacheLocation.
+*/
+static QString clusterCacheFile(const QByteArray& p_baKey)
+{
+    return CacheLocation::filePath(QString("%1.mnecluster").arg(QString::fromLatin1(p_baKey.toHex())));
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Reads cached clustering results, fails if they don't fit to the input regions.
+*/
+static bool readClusterCache(const QByteArray& p_baKey, const QList<RegionData>& p_qListRegionData, QList<RegionDataOut>& p_qListRegionDataOut)
+{
+    QByteArray t_baPayload;
+    if(!CacheFile::read(clusterCacheFile(p_baKey), QString(CLUSTERCACHE_KIND), p_baKey, t_baPayload))
+        return false;
+
+    QDataStream t_Stream(t_baPayload);
+
+    qint32 t_iRegions = 0;
+    t_Stream >> t_iRegions;
+    if(t_Stream.status() != QDataStream::Ok || t_iRegions != p_qListRegionData.size())
+        return false;
+
+    QList<RegionDataOut> t_qListRegionDataOut;
+    for(qint32 i = 0; i < p_qListRegionData.size(); ++i)
+    {
+        const RegionData& t_region = p_qListRegionData[i];
+        RegionDataOut t_regionOut;
+        t_Stream >> t_regionOut.iLabelIdxOut;
+
+        if(!CacheFile::readMatrix(t_Stream, t_regionOut.roiIdx)
+                || !CacheFile::readMatrix(t_Stream, t_regionOut.ctrs)
+                || !CacheFile::readMatrix(t_Stream, t_regionOut.sumd)
+                || !CacheFile::readMatrix(t_Stream, t_regionOut.D))
+            return false;
+
+        if(t_regionOut.iLabelIdxOut != t_region.iLabelIdxIn
+                || t_regionOut.roiIdx.size() != t_region.matRoiG.rows()
+                || t_regionOut.ctrs.cols() != t_region.matRoiG.cols()
+                || t_regionOut.D.rows() != t_regionOut.roiIdx.size()
+                || t_regionOut.D.cols() != t_regionOut.ctrs.rows())
+            return false;
+
+        t_qListRegionDataOut.append(t_regionOut);
+    }
+
+    p_qListRegionDataOut = t_qListRegionDataOut;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Writes clustering results to the cache.
+*/
+static bool writeClusterCache(const QByteArray& p_baKey, const QList<RegionDataOut>& p_qListRegionDataOut)
+{
+    QByteArray t_baPayload;
+    QDataStream t_Stream(&t_baPayload, QIODevice::WriteOnly);
+    t_Stream << (qint32)p_qListRegionDataOut.size();
+
+    for(qint32 i = 0; i < p_qListRegionDataOut.size(); ++i)
+    {
+        const RegionDataOut& t_regionOut = p_qListRegionDataOut[i];
+        t_Stream << t_regionOut.iLabelIdxOut;
+        CacheFile::writeMatrix(t_Stream, t_regionOut.roiIdx);
+        CacheFile::writeMatrix(t_Stream, t_regionOut.ctrs);
+        CacheFile::writeMatrix(t_Stream, t_regionOut.sumd);
+        CacheFile::writeMatrix(t_Stream, t_regionOut.D);
+    }
+
+    QString t_sCacheFile = clusterCacheFile(p_baKey);
+    if(!CacheFile::write(t_sCacheFile, QString(CLUSTERCACHE_KIND), p_baKey, t_baPayload))
+    {
+        qWarning("MNEForwardSolution::cluster_forward_solution - Couldn't write the cluster cache file %s", t_sCacheFile.toUtf8().constData());
+        return false;
+    }
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -144,6 +321,8 @@ MNEForwardSolution::MNEForwardSolution(const MNEForwardSolution &p_MNEForwardSol
 , src(p_MNEForwardSolution.src)
 , source_rr(p_MNEForwardSolution.source_rr)
 , source_nn(p_MNEForwardSolution.source_nn)
+, sol_compact(p_MNEForwardSolution.sol_compact)
+, sol_grad_compact(p_MNEForwardSolution.sol_grad_compact)
 {
 
 }
@@ -173,6 +352,92 @@ void MNEForwardSolution::clear()
     src.clear();
     source_rr = MatrixX3f(0,3);
     source_nn = MatrixX3f(0,3);
+    sol_compact.clear();
+    sol_grad_compact.clear();
+}
+
+
+//*************************************************************************************************************
+
+void MNEForwardSolution::compact()
+{
+    if(this->isCompact())
+        return;
+
+    const FiffNamedMatrix& t_sol = *this->sol;
+    const FiffNamedMatrix& t_solGrad = *this->sol_grad;
+
+    sol_compact = QSharedPointer<const MatrixXf>(new MatrixXf(t_sol.data.cast<float>()));
+    if(!t_solGrad.isEmpty())
+        sol_grad_compact = QSharedPointer<const MatrixXf>(new MatrixXf(t_solGrad.data.cast<float>()));
+
+    // New named matrices without data, the double data is released once no other copy shares it
+    sol = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(t_sol.nrow, t_sol.ncol, t_sol.row_names, t_sol.col_names, MatrixXd()));
+    if(sol_grad_compact)
+        sol_grad = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(t_solGrad.nrow, t_solGrad.ncol, t_solGrad.row_names, t_solGrad.col_names, MatrixXd()));
+}
+
+
+//*************************************************************************************************************
+
+void MNEForwardSolution::expand()
+{
+    if(!this->isCompact())
+        return;
+
+    this->sol->data = sol_compact->cast<double>();
+    if(sol_grad_compact)
+        this->sol_grad->data = sol_grad_compact->cast<double>();
+
+    sol_compact.clear();
+    sol_grad_compact.clear();
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd MNEForwardSolution::gain(const RowVectorXi& p_vecRows, bool p_bFixedOri) const
+{
+    bool t_bStrided = p_bFixedOri && this->surf_ori && !this->isFixedOrient();
+    if(p_bFixedOri && !t_bStrided && !this->isFixedOrient())
+        qWarning("Warning: Only surface-oriented, free-orientation forward solutions can be converted to fixed orientaton.\n");
+
+    qint32 t_iRows = this->isCompact() ? sol_compact->rows() : this->sol->data.rows();
+    qint32 t_iCols = this->isCompact() ? sol_compact->cols() : this->sol->data.cols();
+    qint32 t_iNSel = p_vecRows.size() > 0 ? p_vecRows.size() : t_iRows;
+    qint32 t_iNCol = t_bStrided ? t_iCols / 3 : t_iCols;
+
+    //
+    //   Only the picked rows and, for the fixed orientation, the normal components are copied
+    //
+    MatrixXd G(t_iNSel, t_iNCol);
+    for(qint32 j = 0; j < t_iNCol; ++j)
+    {
+        qint32 c = t_bStrided ? 3*j + 2 : j;
+        for(qint32 i = 0; i < t_iNSel; ++i)
+        {
+            qint32 r = p_vecRows.size() > 0 ? p_vecRows[i] : i;
+            G(i,j) = this->isCompact() ? (double)(*sol_compact)(r,c) : this->sol->data(r,c);
+        }
+    }
+
+    return G;
+}
+
+
+//*************************************************************************************************************
+
+Map<const MatrixXd, 0, OuterStride<> > MNEForwardSolution::fixed_ori_view() const
+{
+    const MatrixXd& t_data = this->sol->data;
+
+    if(!this->surf_ori || this->isFixedOrient() || this->isCompact() || t_data.cols() < 3)
+    {
+        qWarning("Warning: The fixed orientation view needs a surface-oriented, free-orientation forward solution in double precision.\n");
+        return Map<const MatrixXd, 0, OuterStride<> >(t_data.data(), t_data.rows(), 0, OuterStride<>(qMax<Index>(1, t_data.rows())));
+    }
+
+    return Map<const MatrixXd, 0, OuterStride<> >(t_data.data() + 2*t_data.rows(), t_data.rows(), t_data.cols()/3, OuterStride<>(3*t_data.rows()));
 }
 
 
@@ -243,10 +508,13 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
 
     MatrixXd t_G_new;
 
+    //Qt Concurrent List, the labels of both hemispheres are clustered in one pass
+    QList<RegionData> m_qListRegionDataIn;
+    QVector<qint32> t_vecHemiRegions(this->src.size(), 0);
+
     for(qint32 h = 0; h < this->src.size(); ++h )
     {
 
-        count = 0;
         offset = 0;
 
         // Offset for continuous indexing;
@@ -269,9 +537,6 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
         for(qint32 i = 0; i < vertno_labeled.rows(); ++i)
             vertno_labeled[i] = p_AnnotationSet[h].getLabelIds()[this->src[h].vertno[i]];
 
-        //Qt Concurrent List
-        QList<RegionData> m_qListRegionDataIn;
-
         //
         // Generate cluster input data
         //
@@ -346,6 +611,7 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
                     t_sensG.sDistMeasure = p_sMethod;
 
                     m_qListRegionDataIn.append(t_sensG);
+                    ++t_vecHemiRegions[h];
 
                     printf("[added]\n");
                 }
@@ -355,27 +621,51 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
                 }
             }
         }
+    }
 
 
-        //
-        // Calculate clusters
-        //
-        printf("Clustering... ");
+    //
+    // Calculate clusters
+    //
+    QList<RegionDataOut> m_qListRegionDataOut;
+    QByteArray t_baCacheKey = clusterCacheKey(m_qListRegionDataIn);
+
+    if(readClusterCache(t_baCacheKey, m_qListRegionDataIn, m_qListRegionDataOut))
+    {
+        printf("Clustering... [read from cache %s]\n", clusterCacheFile(t_baCacheKey).toUtf8().constData());
+    }
+    else
+    {
+        printf("Clustering %d labels... ", m_qListRegionDataIn.size());
         QFuture< RegionDataOut > res;
         res = QtConcurrent::mapped(m_qListRegionDataIn, &RegionData::cluster);
         res.waitForFinished();
+        m_qListRegionDataOut = res.results();
+        printf("[done]\n");
+
+        if(writeClusterCache(t_baCacheKey, m_qListRegionDataOut))
+            printf("Clustering stored in cache %s\n", clusterCacheFile(t_baCacheKey).toUtf8().constData());
+    }
+
+
+    //
+    // Assign results
+    //
+    QList<RegionData>::const_iterator itIn = m_qListRegionDataIn.constBegin();
+    QList<RegionDataOut>::const_iterator itOut = m_qListRegionDataOut.constBegin();
+
+    for(qint32 h = 0; h < this->src.size(); ++h )
+    {
+        count = 0;
+
+        Colortable t_CurrentColorTable = p_AnnotationSet[h].getColortable();
+        VectorXi label_ids = t_CurrentColorTable.getLabelIds();
 
-        //
-        // Assign results
-        //
         MatrixXd t_G_partial;
 
         qint32 nClusters;
         qint32 nSens;
-        QList<RegionData>::const_iterator itIn;
-        itIn = m_qListRegionDataIn.begin();
-        QFuture<RegionDataOut>::const_iterator itOut;
-        for (itOut = res.constBegin(); itOut != res.constEnd(); ++itOut)
+        for(qint32 r = 0; r < t_vecHemiRegions[h]; ++r, ++itIn, ++itOut)
         {
             nClusters = itOut->ctrs.rows();
             nSens = itOut->ctrs.cols()/3;
@@ -480,8 +770,6 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
                     ++count;
                 }
             }
-
-            ++itIn;
         }
 
         //
@@ -490,8 +778,6 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
 //        p_fwdOut.src[h].rr.conservativeResize(count, 3);
 //        p_fwdOut.src[h].nn.conservativeResize(count, 3);
         p_fwdOut.src[h].vertno.conservativeResize(count);
-
-        printf("[done]\n");
     }
 
 
@@ -840,12 +1126,27 @@ FiffCov MNEForwardSolution::compute_depth_prior(const MatrixXd &Gain, const Fiff
     if(limit_depth_chs)
         MNEForwardSolution::restrict_gain_matrix(G, gain_info);
 
+    VectorXd d = MNEForwardSolution::compute_depth_norms(G, is_fixed_ori);
+
+    // ToDo Currently the fwd solns never have "patch_areas" defined
+    if(patch_areas.cols() > 0)
+    {
+//            d /= patch_areas ** 2
+        printf("\tToDo!!!!! >>> Patch areas taken into account in the depth weighting\n");
+    }
+
+    return MNEForwardSolution::compute_depth_prior(d, is_fixed_ori, exp, limit, limit_depth_chs);
+}
+
+
+//*************************************************************************************************************
+
+VectorXd MNEForwardSolution::compute_depth_norms(const MatrixXd &G, bool is_fixed_ori)
+{
     VectorXd d;
-    // Compute the gain matrix
     if(is_fixed_ori)
     {
-        d = (G.array().square()).rowwise().sum(); //ToDo: is this correct - is G squared?
-//            d = np.sum(G ** 2, axis=0)
+        d = G.colwise().squaredNorm().transpose();
     }
     else
     {
@@ -860,13 +1161,14 @@ FiffCov MNEForwardSolution::compute_depth_prior(const MatrixXd &Gain, const Fiff
         }
     }
 
-    // ToDo Currently the fwd solns never have "patch_areas" defined
-    if(patch_areas.cols() > 0)
-    {
-//            d /= patch_areas ** 2
-        printf("\tToDo!!!!! >>> Patch areas taken into account in the depth weighting\n");
-    }
+    return d;
+}
+
 
+//*************************************************************************************************************
+
+FiffCov MNEForwardSolution::compute_depth_prior(const VectorXd &d, bool is_fixed_ori, double exp, double limit, bool limit_depth_chs)
+{
     qint32 n_limit;
     VectorXd w = d.cwiseInverse();
     VectorXd ws = w;
@@ -1009,19 +1311,19 @@ MNEForwardSolution MNEForwardSolution::pick_channels(const QStringList& include,
     }
     printf("\t%d out of %d channels remain after picking\n", nuse, fwd.nchan);
 
-    //   Pick the correct rows of the forward operator
-    MatrixXd newData(nuse, fwd.sol->data.cols());
-    for(quint32 i = 0; i < nuse; ++i)
-        newData.row(i) = fwd.sol->data.row(sel[i]);
-
-    fwd.sol->data = newData;
-    fwd.sol->nrow = nuse;
+    //   Pick the correct rows of the forward operator. New matrices are built from the const originals, which
+    //   avoids detaching, i.e. copying, the shared full matrices first.
+    const FiffNamedMatrix& t_sol = *this->sol;
+    const FiffNamedMatrix& t_solGrad = *this->sol_grad;
 
     QStringList ch_names;
     for(qint32 i = 0; i < sel.cols(); ++i)
-        ch_names << fwd.sol->row_names[sel(i)];
+        ch_names << t_sol.row_names[sel(i)];
+
+    fwd.sol = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(nuse, t_sol.ncol, ch_names, t_sol.col_names, pickRows(t_sol.data, sel)));
+    if(this->sol_compact)
+        fwd.sol_compact = QSharedPointer<const MatrixXf>(new MatrixXf(pickRows(*this->sol_compact, sel)));
     fwd.nchan = nuse;
-    fwd.sol->row_names = ch_names;
 
     QList<FiffChInfo> chs;
     for(qint32 i = 0; i < sel.cols(); ++i)
@@ -1035,17 +1337,14 @@ MNEForwardSolution MNEForwardSolution::pick_channels(const QStringList& include,
             bads.append(fwd.info.bads[i]);
     fwd.info.bads = bads;
 
-    if(!fwd.sol_grad->isEmpty())
+    if(!t_solGrad.isEmpty() || this->sol_grad_compact)
     {
-        newData.resize(nuse, fwd.sol_grad->data.cols());
-        for(quint32 i = 0; i < nuse; ++i)
-            newData.row(i) = fwd.sol_grad->data.row(sel[i]);
-        fwd.sol_grad->data = newData;
-        fwd.sol_grad->nrow = nuse;
         QStringList row_names;
         for(qint32 i = 0; i < sel.cols(); ++i)
-            row_names << fwd.sol_grad->row_names[sel(i)];
-        fwd.sol_grad->row_names = row_names;
+            row_names << t_solGrad.row_names[sel(i)];
+        fwd.sol_grad = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(nuse, t_solGrad.ncol, row_names, t_solGrad.col_names, pickRows(t_solGrad.data, sel)));
+        if(this->sol_grad_compact)
+            fwd.sol_grad_compact = QSharedPointer<const MatrixXf>(new MatrixXf(pickRows(*this->sol_grad_compact, sel)));
     }
 
     return fwd;
@@ -1086,16 +1385,16 @@ MNEForwardSolution MNEForwardSolution::pick_regions(const QList<Label> &p_qListL
     selectedFwd.source_nn = nn;
 
     VectorXi selSolIdcs = tripletSelection(selVertices);
-    MatrixXd G(selectedFwd.sol->data.rows(),selSolIdcs.size());
 //    selectedFwd.sol_grad; //ToDo
-    qint32 rows = G.rows();
 
-    for(qint32 i = 0; i < selSolIdcs.size(); ++i)
-        G.block(0, i, rows, 1) = selectedFwd.sol->data.col(selSolIdcs[i]);
+    const FiffNamedMatrix& t_sol = *this->sol;
+    QStringList t_colNames;
+    for(qint32 i = 0; i < selSolIdcs.size() && t_sol.col_names.size() == t_sol.ncol; ++i)
+        t_colNames << t_sol.col_names[selSolIdcs[i]];
 
-    selectedFwd.sol->data = G;
-    selectedFwd.sol->nrow = selectedFwd.sol->data.rows();
-    selectedFwd.sol->ncol = selectedFwd.sol->data.cols();
+    selectedFwd.sol = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(t_sol.nrow, selSolIdcs.size(), t_sol.row_names, t_colNames, pickCols(t_sol.data, selSolIdcs)));
+    if(this->sol_compact)
+        selectedFwd.sol_compact = QSharedPointer<const MatrixXf>(new MatrixXf(pickCols(*this->sol_compact, selSolIdcs)));
     selectedFwd.nsource = selectedFwd.sol->ncol / 3;
 
     selectedFwd.src = selectedFwd.src.pick_regions(p_qListLabels);
@@ -1121,6 +1420,19 @@ MNEForwardSolution MNEForwardSolution::pick_types(bool meg, bool eeg, const QStr
 //*************************************************************************************************************
 
 void MNEForwardSolution::prepare_forward(const FiffInfo &p_info, const FiffCov &p_noise_cov, bool p_pca, FiffInfo &p_outFwdInfo, MatrixXd &gain, FiffCov &p_outNoiseCov, MatrixXd &p_outWhitener, qint32 &p_outNumNonZero) const
+{
+    VectorXi fwd_idx;
+    prepare_forward(p_info, p_noise_cov, p_pca, p_outFwdInfo, fwd_idx, p_outNoiseCov, p_outWhitener, p_outNumNonZero);
+
+    gain.resize(fwd_idx.size(), this->sol->data.cols());
+    for(qint32 i = 0; i < fwd_idx.size(); ++i)
+        gain.row(i) = this->sol->data.row(fwd_idx[i]);
+}
+
+
+//*************************************************************************************************************
+
+void MNEForwardSolution::prepare_forward(const FiffInfo &p_info, const FiffCov &p_noise_cov, bool p_pca, FiffInfo &p_outFwdInfo, VectorXi &fwd_idx, FiffCov &p_outNoiseCov, MatrixXd &p_outWhitener, qint32 &p_outNumNonZero) const
 {
     QStringList fwd_ch_names, ch_names;
     for(qint32 i = 0; i < this->info.chs.size(); ++i)
@@ -1177,7 +1489,7 @@ void MNEForwardSolution::prepare_forward(const FiffInfo &p_info, const FiffCov &
         }
     }
 
-    VectorXi fwd_idx = VectorXi::Zero(ch_names.size());
+    fwd_idx = VectorXi::Zero(ch_names.size());
     VectorXi info_idx = VectorXi::Zero(ch_names.size());
     qint32 idx;
     qint32 count_fwd_idx = 0;
@@ -1200,10 +1512,6 @@ void MNEForwardSolution::prepare_forward(const FiffInfo &p_info, const FiffCov &
     fwd_idx.conservativeResize(count_fwd_idx);
     info_idx.conservativeResize(count_info_idx);
 
-    gain.resize(count_fwd_idx, this->sol->data.cols());
-    for(qint32 i = 0; i < count_fwd_idx; ++i)
-        gain.row(i) = this->sol->data.row(fwd_idx[i]);
-
     p_outFwdInfo = p_info.pick_info(info_idx);
 
     printf("\tTotal rank is %d\n", p_outNumNonZero);
@@ -1436,23 +1744,19 @@ bool MNEForwardSolution::read(QIODevice& p_IODevice, MNEForwardSolution& fwd, bo
         {
             printf("\tChanging to fixed-orientation forward solution...");
 
+            //fix_rot = make_block_diag(nn',1) is applied block by block
             MatrixXd tmp = fwd.source_nn.transpose().cast<double>();
-            SparseMatrix<double>* fix_rot = MNEMath::make_block_diag(tmp,1);
-            fwd.sol->data *= (*fix_rot);
+            MNEMath::multiply_block_diag(fwd.sol->data, tmp, 1, fwd.sol->data);
             fwd.sol->ncol  = fwd.nsource;
             fwd.source_ori = FIFFV_MNE_FIXED_ORI;
 
             if (!fwd.sol_grad->isEmpty())
             {
-                SparseMatrix<double> t_matKron;
-                SparseMatrix<double> t_eye(3,3);
-                for (qint32 i = 0; i < 3; ++i)
-                    t_eye.insert(i,i) = 1.0f;
-                t_matKron = kroneckerProduct(*fix_rot,t_eye);//kron(fix_rot,eye(3));
-                fwd.sol_grad->data *= t_matKron;
+                //kron(fix_rot,eye(3)) is the block diagonal of kron(nn',eye(3)) with blocks of 3 columns
+                MatrixXd t_matKron = kroneckerProduct(tmp, MatrixXd::Identity(3,3));
+                MNEMath::multiply_block_diag(fwd.sol_grad->data, t_matKron, 3, fwd.sol_grad->data);
                 fwd.sol_grad->ncol   = 3*fwd.nsource;
             }
-            delete fix_rot;
             printf("[done]\n");
         }
     }
@@ -1519,21 +1823,16 @@ bool MNEForwardSolution::read(QIODevice& p_IODevice, MNEForwardSolution& fwd, bo
             }
             nuse += t_SourceSpace[k].nuse;
         }
+        //surf_rot = make_block_diag(nn',3) is applied as dense 3 x 3 blocks
         MatrixXd tmp = fwd.source_nn.transpose().cast<double>();
-        SparseMatrix<double>* surf_rot = MNEMath::make_block_diag(tmp,3);
-
-        fwd.sol->data *= *surf_rot;
+        MNEMath::multiply_block_diag(fwd.sol->data, tmp, 3, fwd.sol->data);
 
         if (!fwd.sol_grad->isEmpty())
         {
-            SparseMatrix<double> t_matKron;
-            SparseMatrix<double> t_eye(3,3);
-            for (qint32 i = 0; i < 3; ++i)
-                t_eye.insert(i,i) = 1.0f;
-            t_matKron = kroneckerProduct(*surf_rot,t_eye);//kron(surf_rot,eye(3));
-            fwd.sol_grad->data *= t_matKron;
+            //kron(surf_rot,eye(3)) is the block diagonal of kron(nn',eye(3)) with blocks of 9 columns
+            MatrixXd t_matKron = kroneckerProduct(tmp, MatrixXd::Identity(3,3));
+            MNEMath::multiply_block_diag(fwd.sol_grad->data, t_matKron, 9, fwd.sol_grad->data);
         }
-        delete surf_rot;
         printf("[done]\n");
     }
     else
@@ -1796,38 +2095,41 @@ void MNEForwardSolution::restrict_gain_matrix(MatrixXd &G, const FiffInfo &info)
         return;
     }
 
-    RowVectorXi sel = info.pick_types(QString("grad"));
+    RowVectorXi sel = MNEForwardSolution::restrict_gain_channels(info);
     if(sel.size() > 0)
     {
         for(qint32 i = 0; i < sel.size(); ++i)
             G.row(i) = G.row(sel[i]);
         G.conservativeResize(sel.size(), G.cols());
+    }
+}
+
+
+//*************************************************************************************************************
+
+RowVectorXi MNEForwardSolution::restrict_gain_channels(const FiffInfo &info)
+{
+    RowVectorXi sel = info.pick_types(QString("grad"));
+    if(sel.size() > 0)
+    {
         printf("\t%ld planar channels", sel.size());
+        return sel;
     }
-    else
+
+    sel = info.pick_types(QString("mag"));
+    if (sel.size() > 0)
     {
-        sel = info.pick_types(QString("mag"));
-        if (sel.size() > 0)
-        {
-            for(qint32 i = 0; i < sel.size(); ++i)
-                G.row(i) = G.row(sel[i]);
-            G.conservativeResize(sel.size(), G.cols());
-            printf("\t%ld magnetometer or axial gradiometer channels", sel.size());
-        }
-        else
-        {
-            sel = info.pick_types(false, true);
-            if(sel.size() > 0)
-            {
-                for(qint32 i = 0; i < sel.size(); ++i)
-                    G.row(i) = G.row(sel[i]);
-                G.conservativeResize(sel.size(), G.cols());
-                printf("\t%ld EEG channels\n", sel.size());
-            }
-            else
-                printf("Could not find MEG or EEG channels\n");
-        }
+        printf("\t%ld magnetometer or axial gradiometer channels", sel.size());
+        return sel;
     }
+
+    sel = info.pick_types(false, true);
+    if(sel.size() > 0)
+        printf("\t%ld EEG channels\n", sel.size());
+    else
+        printf("Could not find MEG or EEG channels\n");
+
+    return sel;
 }
 
 
@@ -1840,11 +2142,20 @@ void MNEForwardSolution::to_fixed_ori()
         qWarning("Warning: Only surface-oriented, free-orientation forward solutions can be converted to fixed orientaton.\n");//ToDo: Throw here//qCritical//qFatal
         return;
     }
-    qint32 count = 0;
-    for(qint32 i = 2; i < this->sol->data.cols(); i += 3)
-        this->sol->data.col(count) = this->sol->data.col(i);//ToDo: is this right? - just take z?
-    this->sol->data.conservativeResize(this->sol->data.rows(), count);
-    this->sol->ncol = this->sol->ncol / 3;
+    // The surface oriented z component is the one along the normal. The new matrix is made from the strided
+    // normal columns only, without detaching the shared full matrix first.
+    const FiffNamedMatrix& t_sol = *this->sol;
+    MatrixXd t_data = t_sol.data.size() > 0 ? MatrixXd(fixed_ori_view()) : MatrixXd();
+    QStringList t_colNames;
+    for(qint32 i = 2; i < t_sol.col_names.size(); i += 3)
+        t_colNames << t_sol.col_names[i];
+    this->sol = FiffNamedMatrix::SDPtr(new FiffNamedMatrix(t_sol.nrow, t_sol.ncol / 3, t_sol.row_names, t_colNames, t_data));
+
+    if(this->isCompact())
+    {
+        const MatrixXf& t_compact = *this->sol_compact;
+        this->sol_compact = QSharedPointer<const MatrixXf>(new MatrixXf(Map<const MatrixXf, 0, OuterStride<> >(t_compact.data() + 2*t_compact.rows(), t_compact.rows(), t_compact.cols()/3, OuterStride<>(3*t_compact.rows()))));
+    }
     this->source_ori = FIFFV_MNE_FIXED_ORI;
     printf("\tConverted the forward solution into the fixed-orientation mode.\n");
 }
@@ -249,7 +249,9 @@ public:
     //=========================================================================================================
     /**
     * Cluster the forward solution and stores the result to p_fwdOut.
-    * The clustering is done by using the provided annotations
+    * The clustering is done by using the provided annotations, the labels of both hemispheres are clustered in
+    * parallel. The clustering results are cached in the directory of UTILSLIB::CacheLocation and reused by later
+    * calls with the same gain matrix, annotations, cluster size, method and whitening.
     *
     * @param[in]    p_AnnotationSet     Annotation set containing the annotation of left & right hemisphere
     * @param[in]    p_iClusterSize      Maximal cluster size per roi
@@ -288,6 +290,33 @@ public:
     */
     static FiffCov compute_depth_prior(const MatrixXd &Gain, const FiffInfo &gain_info, bool is_fixed_ori, double exp = 0.8, double limit = 10.0, const MatrixXd &patch_areas = defaultConstMatrixXd, bool limit_depth_chs = false);
 
+    //=========================================================================================================
+    /**
+    * Compute weighting for depth prior from the source norms, see compute_depth_norms. This allows to collect
+    * the norms block by block from gain matrices which do not fit into memory at once.
+    *
+    * @param[in] d                  The source norms
+    * @param[in] is_fixed_ori       Fixed orientation?
+    * @param[in] exp                float in [0, 1]. Depth weighting coefficients. (optional; default = 0.8)
+    * @param[in] limit              (optional; default = 10.0)
+    * @param[in] limit_depth_chs    Were only the best depth-weighting channels used for the norms? (optional)
+    *
+    * @return the depth prior
+    */
+    static FiffCov compute_depth_prior(const VectorXd &d, bool is_fixed_ori, double exp = 0.8, double limit = 10.0, bool limit_depth_chs = false);
+
+    //=========================================================================================================
+    /**
+    * Compute the source norms used by the depth weighting: the squared norm of each column for fixed
+    * orientations, the largest eigenvalue of the 3 x 3 Gram matrix of each source otherwise.
+    *
+    * @param[in] G              gain matrix, or a block of complete sources of it
+    * @param[in] is_fixed_ori   Fixed orientation?
+    *
+    * @return the norm of each source
+    */
+    static VectorXd compute_depth_norms(const MatrixXd &G, bool is_fixed_ori);
+
     //=========================================================================================================
     /**
     * Indicates whether fwd conatins a clustered forward solution.
@@ -365,6 +394,22 @@ public:
     */
     void prepare_forward(const FiffInfo &p_info, const FiffCov &p_noise_cov, bool p_pca, FiffInfo &p_outFwdInfo, MatrixXd &gain, FiffCov &p_outNoiseCov, MatrixXd &p_outWhitener, qint32 &p_outNumNonZero) const;
 
+    //=========================================================================================================
+    /**
+    * Prepare forward for assembling the inverse operator without copying the gain matrix. The rows of the gain
+    * matrix are returned as indices into the forward solution, so it can be processed in blocks of columns.
+    *
+    * @param[in] p_info             The measurement info to specify the channels to include. Bad channels in info['bads'] are not used.
+    * @param[in] p_noise_cov        The noise covariance matrix.
+    * @param[in] p_pca              Calculate pca or not.
+    * @param[out] p_outFwdInfo      Measurement info of the selected channels
+    * @param[out] fwd_idx           The rows of the forward solution which form the gain matrix
+    * @param[out] p_outNoiseCov     noise covariance matrix
+    * @param[out] p_outWhitener     Whitener
+    * @param[out] p_outNumNonZero   the rank (non zeros)
+    */
+    void prepare_forward(const FiffInfo &p_info, const FiffCov &p_noise_cov, bool p_pca, FiffInfo &p_outFwdInfo, VectorXi &fwd_idx, FiffCov &p_outNoiseCov, MatrixXd &p_outWhitener, qint32 &p_outNumNonZero) const;
+
 //    //=========================================================================================================
 //    /**
 //    * Prepares a forward solution, Bad channels, after clustering etc ToDo...
@@ -464,10 +509,67 @@ public:
 
     //=========================================================================================================
     /**
-    * Helper to convert the forward solution to fixed ori from free
+    * Select the gain matrix rows for optimal depth weighting, see restrict_gain_matrix
+    *
+    * @param[in] info       Fiff information
+    *
+    * @return the selected rows, empty if there are neither MEG nor EEG channels
+    */
+    static RowVectorXi restrict_gain_channels(const FiffInfo &info);
+
+    //=========================================================================================================
+    /**
+    * Helper to convert the forward solution to fixed ori from free. Keeps the normal (z) components of
+    * the surface oriented solution, a compact solution stays compact.
     */
     void to_fixed_ori();
 
+    //=========================================================================================================
+    /**
+    * Stores the forward solution in single precision, which halves the memory of sol and sol_grad. The
+    * double data of sol and sol_grad is dropped, the named matrices keep their names and dimensions.
+    * pick_channels, pick_types, pick_regions, to_fixed_ori and gain work on the compact solution, all other
+    * operations need the double data back with expand.
+    */
+    void compact();
+
+    //=========================================================================================================
+    /**
+    * Restores the double precision data of a compact forward solution.
+    */
+    void expand();
+
+    //=========================================================================================================
+    /**
+    * Returns whether the forward solution is stored in single precision, see compact.
+    *
+    * @return true if compact, false otherwise
+    */
+    inline bool isCompact() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the gain matrix of the given channels in double precision, from the compact or the double data.
+    * Only the picked part is copied, the forward solution stays as it is.
+    *
+    * @param[in] p_vecRows      The rows to pick, empty picks all (optional).
+    * @param[in] p_bFixedOri    Pick the normal components of a surface oriented, free orientation solution,
+    *                           i.e. the gain of to_fixed_ori without converting the solution (optional).
+    *
+    * @return the gain matrix
+    */
+    MatrixXd gain(const RowVectorXi& p_vecRows = defaultRowVectorXi, bool p_bFixedOri = false) const;
+
+    //=========================================================================================================
+    /**
+    * Returns a copy-free view of the fixed orientation gain of a surface oriented, free orientation
+    * solution in double precision, i.e. every third column of sol->data. The view is valid as long
+    * as sol->data is not changed.
+    *
+    * @return the fixed orientation gain, empty if the solution does not fit
+    */
+    Map<const MatrixXd, 0, OuterStride<> > fixed_ori_view() const;
+
     //=========================================================================================================
     /**
     * overloading the stream out operator<<
@@ -510,6 +612,8 @@ public:
     MNESourceSpace src;                 /**< Geometric description of the source spaces (hemispheres) */
     MatrixX3f source_rr;                /**< Source locations */
     MatrixX3f source_nn;                /**< Source normals (number depends on fixed or free orientation) */
+    QSharedPointer<const MatrixXf> sol_compact;         /**< Single precision forward solution if compact, sol->data is empty then. */
+    QSharedPointer<const MatrixXf> sol_grad_compact;    /**< Single precision sol_grad if compact and available. */
 };
 
 //*************************************************************************************************************
@@ -539,6 +643,14 @@ inline bool MNEForwardSolution::isFixedOrient() const
 }
 
 
+//*************************************************************************************************************
+
+inline bool MNEForwardSolution::isCompact() const
+{
+    return !this->sol_compact.isNull();
+}
+
+
 //*************************************************************************************************************
 
 inline std::ostream& operator<<(std::ostream& out, const MNELIB::MNEForwardSolution &p_MNEForwardSolution)
@@ -258,16 +258,11 @@ bool MNEHemisphere::transform_hemisphere_to(fiff_int_t dest, const FiffCoordTran
         return false;
     }
 
-    MatrixXf t = trans.trans.block(0,0,3,4);
 //        res             = src;
     this->coord_frame = dest;
-    MatrixXf t_rr = MatrixXf::Ones(this->np, 4);
-    t_rr.block(0, 0, this->np, 3) = this->rr;
-    MatrixXf t_nn = MatrixXf::Zero(this->np, 4);
-    t_nn.block(0, 0, this->np, 3) = this->nn;
 
-    this->rr    = (t*t_rr.transpose()).transpose();
-    this->nn    = (t*t_nn.transpose()).transpose();
+    trans.apply_trans_inplace(this->rr, true);
+    trans.apply_trans_inplace(this->nn, false);
 
     return true;
 }
@@ -48,6 +48,7 @@
 //=============================================================================================================
 
 #include <iostream>
+#include <limits>
 
 
 //*************************************************************************************************************
@@ -65,6 +66,7 @@
 //=============================================================================================================
 
 #include <Eigen/SVD>
+#include <Eigen/Eigenvalues>
 
 
 //*************************************************************************************************************
@@ -76,6 +78,76 @@ using namespace UTILSLIB;
 using namespace MNELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Copies the columns [col, col + ncols) of the gain matrix given by the forward solution rows fwd_idx.
+*/
+MatrixXd gain_block(const MNEForwardSolution &forward, const VectorXi &fwd_idx, qint32 col, qint32 ncols)
+{
+    MatrixXd G(fwd_idx.size(), ncols);
+    for(qint32 i = 0; i < fwd_idx.size(); ++i)
+        G.row(i) = forward.sol->data.block(fwd_idx[i], col, 1, ncols);
+    return G;
+}
+
+//=============================================================================================================
+/**
+* Number of source columns per block, whole sources only.
+*/
+qint32 source_block_size(qint32 block_size, bool is_fixed_ori)
+{
+    qint32 nOri = is_fixed_ori ? 1 : 3;
+    return qMax(nOri, (block_size / nOri) * nOri);
+}
+
+//=============================================================================================================
+/**
+* Eigen decomposition of the lead field Gram matrix G*G' = U*S^2*U', of which only the lower triangle is set.
+* The singular values are returned in decreasing order.
+*/
+void decompose_gram(const MatrixXd &t_GGT, VectorXd &p_sing, MatrixXd &t_U)
+{
+    SelfAdjointEigenSolver<MatrixXd> eig(t_GGT.selfadjointView<Lower>());
+
+    // eigenvalues are in increasing order
+    qint32 n_comp = eig.eigenvalues().size();
+    p_sing.resize(n_comp);
+    t_U.resize(t_GGT.rows(), n_comp);
+    double t_dTol = eig.eigenvalues().maxCoeff() * n_comp * std::numeric_limits<double>::epsilon();
+    for(qint32 i = 0; i < n_comp; ++i)
+    {
+        double t_dEig = eig.eigenvalues()[n_comp-1-i];
+        p_sing[i] = t_dEig > t_dTol ? sqrt(t_dEig) : 0.0;
+        t_U.col(i) = eig.eigenvectors().col(n_comp-1-i);
+    }
+}
+
+//=============================================================================================================
+/**
+* Divides the columns of G'*U by the singular values, which turns them into the right singular vectors.
+*/
+void scale_eigen_leads(MatrixXd &t_V, const VectorXd &p_sing)
+{
+    for(qint32 i = 0; i < t_V.cols(); ++i)
+    {
+        if(p_sing[i] > 0)
+            t_V.col(i) /= p_sing[i];
+        else
+            t_V.col(i).setZero();
+    }
+}
+
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -160,71 +232,91 @@ MNEInverseOperator::~MNEInverseOperator()
 
 bool MNEInverseOperator::assemble_kernel(const Label &label, QString method, bool pick_normal, MatrixXd &K, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno)
 {
-    MatrixXd t_eigen_leads = this->eigen_leads->data;
-    MatrixXd t_source_cov = this->source_cov->data;
-    if(method.compare("MNE") != 0)
-        noise_norm = this->noisenorm;
+    MatrixXd t_leads, t_trans;
+    if(!assemble_kernel_factored(label, method, pick_normal, t_leads, t_trans, noise_norm, vertno))
+        return false;
 
-    vertno = this->src.get_vertno();
+    K = t_leads*t_trans;
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
+    //store assembled kernel
+    m_K = K;
 
-    if(!label.isEmpty())
-    {
-        qDebug() << "ToDo: Label selection needs to be debugged - not done jet!";
-        VectorXi src_sel;
-        vertno = this->src.label_src_vertno_sel(label, src_sel);
+    return true;
+}
 
-        if(method.compare("MNE") != 0)
-        {
-            tripletList.clear();
-            tripletList.reserve(noise_norm.nonZeros());
 
-            for (qint32 k = 0; k < noise_norm.outerSize(); ++k)
-            {
-                for (SparseMatrix<double>::InnerIterator it(noise_norm,k); it; ++it)
-                {
-                    //ToDo bad search - increase speed by using stl search
-                    qint32 row = -1;
-                    for(qint32 i = 0; i < src_sel.size(); ++i)
-                        if(src_sel[i] == it.row())
-                            row = i;
-                    if(row != -1)
-                        tripletList.push_back(T(it.row(), it.col(), it.value()));
-                }
-            }
+//*************************************************************************************************************
 
-            noise_norm = SparseMatrix<double>(src_sel.size(),noise_norm.cols());
-            noise_norm.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
+bool MNEInverseOperator::assemble_kernel(const QList<Label> &labels, QString method, bool pick_normal, MatrixXd &K, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno)
+{
+    MatrixXd t_leads, t_trans;
+    if(!assemble_kernel_factored(labels, method, pick_normal, t_leads, t_trans, noise_norm, vertno))
+        return false;
 
-        if(this->source_ori == FIFFV_MNE_FREE_ORI)
-        {
-            VectorXi src_sel_new(src_sel.size()*3);
+    K = t_leads*t_trans;
 
-            for(qint32 i = 0; i < src_sel.size(); ++i)
-            {
-                src_sel_new[i*3] = src_sel[i]*3;
-                src_sel_new[i*3+1] = src_sel[i]*3+1;
-                src_sel_new[i*3+2] = src_sel[i]*3+2;
-            }
-            src_sel = src_sel_new;
-        }
+    //store assembled kernel
+    m_K = K;
 
+    return true;
+}
 
-        for(qint32 i = 0; i < src_sel.size(); ++i)
-        {
-            t_eigen_leads.row(i) = t_eigen_leads.row(src_sel[i]);
-            t_source_cov = t_source_cov.row(src_sel[i]);
-        }
-        t_eigen_leads.conservativeResize(src_sel.size(), t_eigen_leads.cols());
-        t_source_cov.conservativeResize(src_sel.size(), t_source_cov.cols());
+
+//*************************************************************************************************************
+
+bool MNEInverseOperator::assemble_kernel_factored(const Label &label, QString method, bool pick_normal, MatrixXd &leads, MatrixXd &trans, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno)
+{
+    if(label.isEmpty())
+    {
+        vertno = this->src.get_vertno();
+        return assemble_kernel_selected(VectorXi(), method, pick_normal, leads, trans, noise_norm);
+    }
+
+    VectorXi src_sel;
+    vertno = this->src.label_src_vertno_sel(label, src_sel);
+    if(src_sel.size() == 0)
+    {
+        qWarning("MNEInverseOperator::assemble_kernel_factored - The label %s contains no sources.\n", label.name.toUtf8().constData());
+        return false;
+    }
+
+    return assemble_kernel_selected(src_sel, method, pick_normal, leads, trans, noise_norm);
+}
+
+
+//*************************************************************************************************************
+
+bool MNEInverseOperator::assemble_kernel_factored(const QList<Label> &labels, QString method, bool pick_normal, MatrixXd &leads, MatrixXd &trans, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno)
+{
+    if(labels.isEmpty())
+    {
+        vertno = this->src.get_vertno();
+        return assemble_kernel_selected(VectorXi(), method, pick_normal, leads, trans, noise_norm);
     }
 
+    VectorXi src_sel;
+    vertno = this->src.label_src_vertno_sel(labels, src_sel);
+    if(src_sel.size() == 0)
+    {
+        qWarning("MNEInverseOperator::assemble_kernel_factored - The labels contain no sources.\n");
+        return false;
+    }
+
+    return assemble_kernel_selected(src_sel, method, pick_normal, leads, trans, noise_norm);
+}
+
+
+//*************************************************************************************************************
+
+bool MNEInverseOperator::assemble_kernel_selected(const VectorXi &src_sel, QString method, bool pick_normal, MatrixXd &leads, MatrixXd &trans, SparseMatrix<double> &noise_norm) const
+{
+    const MatrixXd& t_eigen_leads = this->eigen_leads->data;
+    const MatrixXd& t_source_cov = this->source_cov->data;
+    const bool bFree = this->source_ori == FIFFV_MNE_FREE_ORI;
+
     if(pick_normal)
     {
-        if(this->source_ori != FIFFV_MNE_FREE_ORI)
+        if(!bFree)
         {
             qWarning("Warning: Pick normal can only be used with a free orientation inverse operator.\n");
             return false;
@@ -236,36 +328,70 @@ bool MNEInverseOperator::assemble_kernel(const Label &label, QString method, boo
             qWarning("The pick_normal parameter is only valid when working with loose orientations.\n");
             return false;
         }
+    }
 
-        // keep only the normal components
-        qint32 count = 0;
-        for(qint32 i = 2; i < t_eigen_leads.rows(); i+=3)
-        {
-            t_eigen_leads.row(count) = t_eigen_leads.row(i);
-            ++count;
-        }
-        t_eigen_leads.conservativeResize(count, t_eigen_leads.cols());
+    //
+    //   Rows of the eigen leads which belong to the selected sources, the normal component is the last of three
+    //
+    qint32 nSel = src_sel.size() > 0 ? src_sel.size() : (bFree ? t_eigen_leads.rows()/3 : t_eigen_leads.rows());
 
-        count = 0;
-        for(qint32 i = 2; i < t_source_cov.rows(); i+=3)
+    VectorXi t_vecRows(bFree && !pick_normal ? 3*nSel : nSel);
+    for(qint32 i = 0; i < nSel; ++i)
+    {
+        qint32 iSrc = src_sel.size() > 0 ? src_sel[i] : i;
+        if(!bFree)
+            t_vecRows[i] = iSrc;
+        else if(pick_normal)
+            t_vecRows[i] = 3*iSrc+2;
+        else
         {
-            t_source_cov.row(count) = t_source_cov.row(i);
-            ++count;
+            t_vecRows[3*i] = 3*iSrc;
+            t_vecRows[3*i+1] = 3*iSrc+1;
+            t_vecRows[3*i+2] = 3*iSrc+2;
         }
-        t_source_cov.conservativeResize(count, t_source_cov.cols());
     }
 
-    tripletList.clear();
-    tripletList.reserve(reginv.rows());
+    //
+    //   The noise normalization holds one factor per source location
+    //
+    if(method.compare("MNE") == 0)
+        noise_norm = SparseMatrix<double>();
+    else if(src_sel.size() == 0 || this->noisenorm.rows() == 0)
+        noise_norm = this->noisenorm;
+    else
+    {
+        typedef Eigen::Triplet<double> T;
+        std::vector<T> tripletList;
+        tripletList.reserve(nSel);
+        VectorXd t_vecNoiseNorm = this->noisenorm.diagonal();
+        for(qint32 i = 0; i < nSel; ++i)
+            tripletList.push_back(T(i, i, t_vecNoiseNorm[src_sel[i]]));
+
+        noise_norm = SparseMatrix<double>(nSel, nSel);
+        noise_norm.setFromTriplets(tripletList.begin(), tripletList.end());
+    }
+
+    //
+    //   The data transformation does not depend on the selection, the regularization stays the one of the
+    //   whole source space. Drop the components which were zeroed by the regularization, they do not
+    //   contribute to the kernel
+    //
+    VectorXi t_vecComp(reginv.rows());
+    qint32 nComp = 0;
     for(qint32 i = 0; i < reginv.rows(); ++i)
-        tripletList.push_back(T(i, i, reginv(i,0)));
-    SparseMatrix<double> t_reginv(reginv.rows(),reginv.rows());
-    t_reginv.setFromTriplets(tripletList.begin(), tripletList.end());
+        if(reginv(i) != 0)
+            t_vecComp[nComp++] = i;
+    t_vecComp.conservativeResize(nComp);
+
+    MatrixXd t_matFields(nComp, eigen_fields->data.cols());
+    for(qint32 i = 0; i < nComp; ++i)
+        t_matFields.row(i) = reginv(t_vecComp[i]) * eigen_fields->data.row(t_vecComp[i]);
+
+    trans = t_matFields*whitener*proj;
 
-    MatrixXd trans = t_reginv*eigen_fields->data*whitener*proj;
     //
     //   Transformation into current distributions by weighting the eigenleads
-    //   with the weights computed above
+    //   with the weights computed above, only the selected rows are formed
     //
     if (eigen_leads_weighted)
     {
@@ -273,30 +399,22 @@ bool MNEInverseOperator::assemble_kernel(const Label &label, QString method, boo
         //     R^0.5 has been already factored in
         //
         printf("(eigenleads already weighted)...");
-        K = t_eigen_leads*trans;
     }
     else
     {
         //
         //     R^0.5 has to factored in
         //
-       printf("(eigenleads need to be weighted)...");
-
-       std::vector<T> tripletList2;
-       tripletList2.reserve(t_source_cov.rows());
-       for(qint32 i = 0; i < t_source_cov.rows(); ++i)
-           tripletList2.push_back(T(i, i, sqrt(t_source_cov(i,0))));
-       SparseMatrix<double> t_sourceCov(t_source_cov.rows(),t_source_cov.rows());
-       t_sourceCov.setFromTriplets(tripletList2.begin(), tripletList2.end());
-
-       K = t_sourceCov*t_eigen_leads*trans;
+        printf("(eigenleads need to be weighted)...");
     }
 
-    if(method.compare("MNE") == 0)
-        noise_norm = SparseMatrix<double>();
-
-    //store assembled kernel
-    m_K = K;
+    leads.resize(t_vecRows.size(), nComp);
+    for(qint32 i = 0; i < t_vecRows.size(); ++i)
+    {
+        double dWeight = eigen_leads_weighted ? 1.0 : sqrt(t_source_cov(t_vecRows[i],0));
+        for(qint32 j = 0; j < nComp; ++j)
+            leads(i,j) = dWeight * t_eigen_leads(t_vecRows[i], t_vecComp[j]);
+    }
 
     return true;
 }
@@ -686,7 +804,7 @@ MatrixXd MNEInverseOperator::cluster_kernel(const AnnotationSet &p_AnnotationSet
 
 //*************************************************************************************************************
 
-MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov &p_noise_cov, float loose, float depth, bool fixed, bool limit_depth_chs)
+MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov &p_noise_cov, float loose, float depth, bool fixed, bool limit_depth_chs, qint32 block_size)
 {
     bool is_fixed_ori = forward.isFixedOrient();
     MNEInverseOperator p_MNEInverseOperator;
@@ -732,19 +850,48 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     // 3. Load the projection data
     // 4. Load the sensor noise covariance matrix and attach it to the forward
     //
+    // In the blocked mode the gain matrix is never copied, only its rows in the forward solution are kept
+    //
+    bool blocked = block_size > 0;
     FiffInfo gain_info;
     MatrixXd gain;
+    VectorXi fwd_idx;
     MatrixXd whitener;
     qint32 n_nzero;
     FiffCov p_outNoiseCov;
-    forward.prepare_forward(info, p_noise_cov, false, gain_info, gain, p_outNoiseCov, whitener, n_nzero);
+    if(blocked)
+        forward.prepare_forward(info, p_noise_cov, false, gain_info, fwd_idx, p_outNoiseCov, whitener, n_nzero);
+    else
+        forward.prepare_forward(info, p_noise_cov, false, gain_info, gain, p_outNoiseCov, whitener, n_nzero);
+    qint32 n_cols = forward.sol->data.cols();
 
     //
     // 5. Compose the depth weight matrix
     //
     FiffCov::SDPtr p_depth_prior;
     MatrixXd patch_areas;
-    if(depth > 0)
+    if(depth > 0 && blocked)
+    {
+        RowVectorXi sel = limit_depth_chs ? MNEForwardSolution::restrict_gain_channels(gain_info) : RowVectorXi();
+        VectorXi depth_idx = fwd_idx;
+        if(sel.size() > 0)
+        {
+            depth_idx.resize(sel.size());
+            for(qint32 i = 0; i < sel.size(); ++i)
+                depth_idx[i] = fwd_idx[sel[i]];
+        }
+
+        qint32 n_block = source_block_size(block_size, is_fixed_ori);
+        VectorXd d(is_fixed_ori ? n_cols : n_cols/3);
+        for(qint32 c = 0; c < n_cols; c += n_block)
+        {
+            qint32 n = qMin(n_block, n_cols - c);
+            VectorXd d_block = MNEForwardSolution::compute_depth_norms(gain_block(forward, depth_idx, c, n), is_fixed_ori);
+            d.segment(is_fixed_ori ? c : c/3, d_block.size()) = d_block;
+        }
+        p_depth_prior = FiffCov::SDPtr(new FiffCov(MNEForwardSolution::compute_depth_prior(d, is_fixed_ori, depth, 10.0, limit_depth_chs)));
+    }
+    else if(depth > 0)
     {
         std::cout << "ToDo: patch_areas" << std::endl;
 //        patch_areas = forward.get('patch_areas', None)
@@ -752,10 +899,11 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     }
     else
     {
-        p_depth_prior->data = MatrixXd::Ones(gain.cols(), gain.cols());
+        p_depth_prior = FiffCov::SDPtr(new FiffCov());
+        p_depth_prior->data = MatrixXd::Ones(n_cols, 1);
         p_depth_prior->kind = FIFFV_MNE_DEPTH_PRIOR_COV;
         p_depth_prior->diag = true;
-        p_depth_prior->dim = gain.cols();
+        p_depth_prior->dim = n_cols;
         p_depth_prior->nfree = 1;
     }
 
@@ -781,7 +929,10 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
 //            forward = deepcopy(forward)
             forward.to_fixed_ori();
             is_fixed_ori = forward.isFixedOrient();
-            forward.prepare_forward(info, p_outNoiseCov, false, gain_info, gain, p_outNoiseCov, whitener, n_nzero);
+            if(blocked)
+                forward.prepare_forward(info, p_outNoiseCov, false, gain_info, fwd_idx, p_outNoiseCov, whitener, n_nzero);
+            else
+                forward.prepare_forward(info, p_outNoiseCov, false, gain_info, gain, p_outNoiseCov, whitener, n_nzero);
         }
     }
     printf("\tComputing inverse operator with %d channels.\n", gain_info.ch_names.size());
@@ -807,10 +958,28 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     // 9. Apply whitening to the forward computation matrix
     //
     printf("\tWhitening the forward solution.\n");
-    gain = whitener*gain;
+    if(!blocked)
+        gain = whitener*gain;
 
     // 10. Exclude the source space points within the labels (not done)
 
+    // We set this for consistency with mne C code written inverses
+    if(depth == 0)
+        p_depth_prior = FiffCov::SDPtr();
+
+    if(blocked)
+        return assemble_inverse_operator_blocked(info, forward, gain_info, fwd_idx, whitener, n_nzero, p_outNoiseCov, p_source_cov, p_depth_prior, p_orient_prior, block_size);
+
+    return assemble_inverse_operator(info, forward, gain_info, gain, n_nzero, p_outNoiseCov, p_source_cov, p_depth_prior, p_orient_prior);
+}
+
+
+//*************************************************************************************************************
+
+MNEInverseOperator MNEInverseOperator::assemble_inverse_operator(const FiffInfo &info, const MNEForwardSolution &forward, const FiffInfo &gain_info, MatrixXd &gain, qint32 n_nzero, const FiffCov &p_noise_cov, FiffCov::SDPtr &p_source_cov, const FiffCov::SDPtr &p_depth_prior, const FiffCov::SDPtr &p_orient_prior, bool use_gram)
+{
+    MNEInverseOperator p_MNEInverseOperator;
+
     //
     // 11. Do appropriate source weighting to the forward computation matrix
     //
@@ -823,7 +992,7 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     for(qint32 i = 0; i < gain.rows(); ++i)
         gain.row(i) = gain.row(i).array() * source_std.array();
 
-    double trace_GRGT = (gain * gain.transpose()).trace();//pow(gain.norm(), 2);
+    double trace_GRGT = gain.squaredNorm();//(gain * gain.transpose()).trace();
     double scaling_source_cov = (double)n_nzero / trace_GRGT;
 
     p_source_cov->data.array() *= scaling_source_cov;
@@ -836,23 +1005,117 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     //
     // 12. Decompose the combined matrix
     //
-    printf("Computing SVD of whitened and weighted lead field matrix.\n");
-    JacobiSVD<MatrixXd> svd(gain, ComputeThinU | ComputeThinV);
-    std::cout << "ToDo Sorting Necessary?" << std::endl;
-    VectorXd p_sing = svd.singularValues();
-    MatrixXd t_U = svd.matrixU();
-    MNEMath::sort<double>(p_sing, t_U);
-    FiffNamedMatrix::SDPtr p_eigen_fields = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( svd.matrixU().cols(),
-                                                                                        svd.matrixU().rows(),
+    VectorXd p_sing;
+    MatrixXd t_U;
+    MatrixXd t_V;
+    if(use_gram)
+    {
+        //
+        // The lead field has far more columns than rows: decompose the small Gram matrix G*G' = U*S^2*U' instead
+        // and recover the right singular vectors by V = G'*U*S^-1
+        //
+        printf("Computing eigen decomposition of the whitened and weighted lead field Gram matrix.\n");
+        MatrixXd t_GGT(gain.rows(), gain.rows());
+        t_GGT.setZero();
+        t_GGT.selfadjointView<Lower>().rankUpdate(gain);
+        decompose_gram(t_GGT, p_sing, t_U);
+
+        t_V = gain.transpose() * t_U;
+        scale_eigen_leads(t_V, p_sing);
+    }
+    else
+    {
+        printf("Computing SVD of whitened and weighted lead field matrix.\n");
+        JacobiSVD<MatrixXd> svd(gain, ComputeThinU | ComputeThinV);
+        std::cout << "ToDo Sorting Necessary?" << std::endl;
+        p_sing = svd.singularValues();
+        t_U = svd.matrixU();
+        MNEMath::sort<double>(p_sing, t_U);
+
+        p_sing = svd.singularValues();
+        t_V = svd.matrixV();
+        MNEMath::sort<double>(p_sing, t_V);
+    }
+
+    return compose_inverse_operator(info, forward, gain_info, t_U, t_V, p_sing, trace_GRGT, p_noise_cov, p_source_cov, p_depth_prior, p_orient_prior);
+}
+
+
+//*************************************************************************************************************
+
+MNEInverseOperator MNEInverseOperator::assemble_inverse_operator_blocked(const FiffInfo &info, const MNEForwardSolution &forward, const FiffInfo &gain_info, const VectorXi &fwd_idx, const MatrixXd &whitener, qint32 n_nzero, const FiffCov &p_noise_cov, FiffCov::SDPtr &p_source_cov, const FiffCov::SDPtr &p_depth_prior, const FiffCov::SDPtr &p_orient_prior, qint32 block_size)
+{
+    qint32 n_chan = fwd_idx.size();
+    qint32 n_cols = forward.sol->data.cols();
+    qint32 n_block = source_block_size(block_size, forward.isFixedOrient());
+
+    //
+    // 11. Do appropriate source weighting to the forward computation matrix
+    // 12. Decompose the combined matrix
+    //
+    // Only the Gram matrix of the whitened and weighted lead field is accumulated, block by block
+    //
+    printf("\tAccumulating the whitened and weighted lead field Gram matrix in blocks of %d columns.\n", n_block);
+    RowVectorXd source_std = p_source_cov->data.array().sqrt().transpose();
+
+    MatrixXd t_GGT = MatrixXd::Zero(n_chan, n_chan);
+    MatrixXd t_G;
+    for(qint32 c = 0; c < n_cols; c += n_block)
+    {
+        qint32 n = qMin(n_block, n_cols - c);
+        t_G = whitener * gain_block(forward, fwd_idx, c, n);
+        t_G *= source_std.segment(c, n).asDiagonal();
+        t_GGT.selfadjointView<Lower>().rankUpdate(t_G);
+    }
+
+    // Adjusting Source Covariance matrix to make trace of G*R*G' equal
+    // to number of sensors.
+    printf("\tAdjusting source covariance matrix.\n");
+    double trace_GRGT = t_GGT.trace();
+    double scaling_source_cov = (double)n_nzero / trace_GRGT;
+
+    p_source_cov->data.array() *= scaling_source_cov;
+    t_GGT *= scaling_source_cov;
+
+    printf("Computing eigen decomposition of the whitened and weighted lead field Gram matrix.\n");
+    VectorXd p_sing;
+    MatrixXd t_U;
+    decompose_gram(t_GGT, p_sing, t_U);
+    t_GGT.resize(0,0);
+
+    //
+    // The eigen leads V = G'*U*S^-1, again block by block, are the only full size matrix which is kept
+    //
+    source_std = p_source_cov->data.array().sqrt().transpose();
+
+    MatrixXd t_V(n_cols, t_U.cols());
+    for(qint32 c = 0; c < n_cols; c += n_block)
+    {
+        qint32 n = qMin(n_block, n_cols - c);
+        t_G = whitener * gain_block(forward, fwd_idx, c, n);
+        t_G *= source_std.segment(c, n).asDiagonal();
+        t_V.middleRows(c, n).noalias() = t_G.transpose() * t_U;
+    }
+    scale_eigen_leads(t_V, p_sing);
+
+    return compose_inverse_operator(info, forward, gain_info, t_U, t_V, p_sing, trace_GRGT, p_noise_cov, p_source_cov, p_depth_prior, p_orient_prior);
+}
+
+
+//*************************************************************************************************************
+
+MNEInverseOperator MNEInverseOperator::compose_inverse_operator(const FiffInfo &info, const MNEForwardSolution &forward, const FiffInfo &gain_info, const MatrixXd &t_U, const MatrixXd &t_V, const VectorXd &p_sing, double trace_GRGT, const FiffCov &p_noise_cov, const FiffCov::SDPtr &p_source_cov, const FiffCov::SDPtr &p_depth_prior, const FiffCov::SDPtr &p_orient_prior)
+{
+    MNEInverseOperator p_MNEInverseOperator;
+
+    FiffNamedMatrix::SDPtr p_eigen_fields = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( t_U.cols(),
+                                                                                        t_U.rows(),
                                                                                         defaultQStringList,
                                                                                         gain_info.ch_names,
                                                                                         t_U.transpose() ));
 
-    p_sing = svd.singularValues();
-    MatrixXd t_V = svd.matrixV();
-    MNEMath::sort<double>(p_sing, t_V);
-    FiffNamedMatrix::SDPtr p_eigen_leads = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( svd.matrixV().rows(),
-                                                                                       svd.matrixV().cols(),
+    FiffNamedMatrix::SDPtr p_eigen_leads = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( t_V.rows(),
+                                                                                       t_V.cols(),
                                                                                        defaultQStringList,
                                                                                        defaultQStringList,
                                                                                        t_V ));
@@ -895,17 +1158,13 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     else
         p_iMethods = FIFFV_MNE_EEG;
 
-    // We set this for consistency with mne C code written inverses
-    if(depth == 0)
-        p_depth_prior = FiffCov::SDPtr();
-
     p_MNEInverseOperator.eigen_fields = p_eigen_fields;
     p_MNEInverseOperator.eigen_leads = p_eigen_leads;
     p_MNEInverseOperator.sing = p_sing;
     p_MNEInverseOperator.nave = p_nave;
     p_MNEInverseOperator.depth_prior = p_depth_prior;
     p_MNEInverseOperator.source_cov = p_source_cov;
-    p_MNEInverseOperator.noise_cov = FiffCov::SDPtr(new FiffCov(p_outNoiseCov));
+    p_MNEInverseOperator.noise_cov = FiffCov::SDPtr(new FiffCov(p_noise_cov));
     p_MNEInverseOperator.orient_prior = p_orient_prior;
     p_MNEInverseOperator.projs = info.projs;
     p_MNEInverseOperator.eigen_leads_weighted = false;
@@ -1062,9 +1321,8 @@ MNEInverseOperator MNEInverseOperator::prepare_inverse_operator(qint32 nave ,flo
             //   Even in this case return only one noise-normalization factor
             //   per source location
             //
-            VectorXd* t = MNEMath::combine_xyz(noise_norm.transpose());
-            noise_norm_new = t->cwiseSqrt();//double otherwise values are getting too small
-            delete t;
+            MNEMath::combine_xyz(noise_norm, noise_norm_new);
+            noise_norm_new = noise_norm_new.cwiseSqrt();//double otherwise values are getting too small
             //
             //   This would replicate the same value on three consequtive
             //   entries
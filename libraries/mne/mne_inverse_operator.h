@@ -230,6 +230,62 @@ public:
     */
     bool assemble_kernel(const Label &label, QString method, bool pick_normal, MatrixXd &K, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno);
 
+    //=========================================================================================================
+    /**
+    * Assembles the kernel rows of the sources covered by a set of labels, e.g. the regions of interest of a
+    * neurofeedback paradigm. The regularization is the one of the whole source space, so the rows are identical
+    * to the corresponding rows of the full kernel, but only the selected rows are formed. Labels can also be
+    * built directly from vertex numbers. Without labels the full kernel is assembled.
+    *
+    * @param[in] labels         The labels, of one or both hemispheres.
+    * @param[in] method         The applied normals. ("MNE" | "dSPM" | "sLORETA")
+    * @param[in] pick_normal    Pick normals.
+    * @param[out] K             Kernel, the selected sources x nChannels.
+    * @param[out] noise_norm    Noise normals of the selected sources.
+    * @param[out] vertno        Selected vertices of the hemispheres.
+    *
+    * @return true when successful, false otherwise
+    */
+    bool assemble_kernel(const QList<Label> &labels, QString method, bool pick_normal, MatrixXd &K, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno);
+
+    //=========================================================================================================
+    /**
+    * Assembles the kernel in its factored form K = leads * trans, with leads = R^0.5 * eigen_leads and
+    * trans = reginv * eigen_fields * whitener * proj. The components which were zeroed by the regularization
+    * are dropped, so the inner dimension is the rank of the kernel. Applying both factors in sequence is cheaper
+    * than the dense kernel whenever the rank is small compared to the number of channels and sources, i.e. after
+    * SSP or for label restricted kernels. Unlike assemble_kernel the stored kernel is not updated.
+    *
+    * @param[in] label          labels.
+    * @param[in] method         The applied normals. ("MNE" | "dSPM" | "sLORETA")
+    * @param[in] pick_normal    Pick normals.
+    * @param[out] leads         Weighted eigen leads, nSources x rank.
+    * @param[out] trans         Data transformation, rank x nChannels.
+    * @param[out] noise_norm    Noise normals.
+    * @param[out] vertno        Vertices of the hemispheres.
+    *
+    * @return true when successful, false otherwise
+    */
+    bool assemble_kernel_factored(const Label &label, QString method, bool pick_normal, MatrixXd &leads, MatrixXd &trans, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno);
+
+    //=========================================================================================================
+    /**
+    * Assembles the kernel rows of the sources covered by a set of labels in their factored form, see
+    * assemble_kernel_factored and assemble_kernel. Only leads is restricted to the selection, trans is shared by
+    * all selections.
+    *
+    * @param[in] labels         The labels, of one or both hemispheres.
+    * @param[in] method         The applied normals. ("MNE" | "dSPM" | "sLORETA")
+    * @param[in] pick_normal    Pick normals.
+    * @param[out] leads         Weighted eigen leads of the selected sources, nSelected x rank.
+    * @param[out] trans         Data transformation, rank x nChannels.
+    * @param[out] noise_norm    Noise normals of the selected sources.
+    * @param[out] vertno        Selected vertices of the hemispheres.
+    *
+    * @return true when successful, false otherwise
+    */
+    bool assemble_kernel_factored(const QList<Label> &labels, QString method, bool pick_normal, MatrixXd &leads, MatrixXd &trans, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno);
+
     //=========================================================================================================
     /**
     * Check that channels in inverse operator are measurements.
@@ -288,10 +344,54 @@ public:
     * @param[in] depth              float in [0, 1]. Depth weighting coefficients. If None, no depth weighting is performed.
     * @param[in] fixed              Use fixed source orientations normal to the cortical mantle. If True, the loose parameter is ignored.
     * @param[in] limit_depth_chs    If True, use only grad channels in depth weighting (equivalent to MNE C code). If grad chanels aren't present, only mag channels will be used (if no mag, then eeg). If False, use all channels.
+    * @param[in] block_size         If > 0, the lead field is processed in blocks of at most this many source columns taken directly from the forward solution, so that the whitened lead field is never held in memory at once. Meant for high density source spaces (optional; default = 0, off).
     *
     * @return the assembled inverse operator
     */
-    static MNEInverseOperator make_inverse_operator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov& p_noise_cov, float loose = 0.2f, float depth = 0.8f, bool fixed = false, bool limit_depth_chs = true);
+    static MNEInverseOperator make_inverse_operator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov& p_noise_cov, float loose = 0.2f, float depth = 0.8f, bool fixed = false, bool limit_depth_chs = true, qint32 block_size = 0);
+
+    //=========================================================================================================
+    /**
+    * Assembles the inverse operator from an already whitened lead field and source covariance, i.e. runs the
+    * source weighting and decomposition steps of make_inverse_operator. Callers which keep the priors of a
+    * forward solution can use this to refresh the inverse operator for a new noise covariance.
+    *
+    * @param[in] info               The measurement info.
+    * @param[in] forward            Forward operator.
+    * @param[in] gain_info          The measurement info of the lead field channels (see prepare_forward).
+    * @param[in, out] gain          The whitened lead field, returns the weighted lead field.
+    * @param[in] n_nzero            The rank of the noise covariance.
+    * @param[in] p_noise_cov        The prepared noise covariance matrix (see prepare_forward).
+    * @param[in, out] p_source_cov   The source covariance, combined depth and orientation prior. Gets scaled in place.
+    * @param[in] p_depth_prior      The depth prior.
+    * @param[in] p_orient_prior     The orientation prior.
+    * @param[in] use_gram           Decompose the lead field by the eigen decomposition of gain*gain' instead of a full SVD. Much faster when there are far fewer channels than sources.
+    *
+    * @return the assembled inverse operator
+    */
+    static MNEInverseOperator assemble_inverse_operator(const FiffInfo &info, const MNEForwardSolution &forward, const FiffInfo &gain_info, MatrixXd &gain, qint32 n_nzero, const FiffCov &p_noise_cov, FiffCov::SDPtr &p_source_cov, const FiffCov::SDPtr &p_depth_prior, const FiffCov::SDPtr &p_orient_prior, bool use_gram = false);
+
+    //=========================================================================================================
+    /**
+    * Assembles the inverse operator like assemble_inverse_operator with use_gram, but reads the lead field block
+    * by block from the forward solution. Only the channels x channels Gram matrix is accumulated, the eigen
+    * leads are the only matrix of the full lead field size which is kept.
+    *
+    * @param[in] info               The measurement info.
+    * @param[in] forward            Forward operator.
+    * @param[in] gain_info          The measurement info of the lead field channels (see prepare_forward).
+    * @param[in] fwd_idx            The rows of the forward solution which form the lead field (see prepare_forward).
+    * @param[in] whitener           The whitener (see prepare_forward).
+    * @param[in] n_nzero            The rank of the noise covariance.
+    * @param[in] p_noise_cov        The prepared noise covariance matrix (see prepare_forward).
+    * @param[in, out] p_source_cov   The source covariance, combined depth and orientation prior. Gets scaled in place.
+    * @param[in] p_depth_prior      The depth prior.
+    * @param[in] p_orient_prior     The orientation prior.
+    * @param[in] block_size         The maximal number of source columns per block.
+    *
+    * @return the assembled inverse operator
+    */
+    static MNEInverseOperator assemble_inverse_operator_blocked(const FiffInfo &info, const MNEForwardSolution &forward, const FiffInfo &gain_info, const VectorXi &fwd_idx, const MatrixXd &whitener, qint32 n_nzero, const FiffCov &p_noise_cov, FiffCov::SDPtr &p_source_cov, const FiffCov::SDPtr &p_depth_prior, const FiffCov::SDPtr &p_orient_prior, qint32 block_size);
 
     //=========================================================================================================
     /**
@@ -381,6 +481,43 @@ public:
     SparseMatrix<double> noisenorm;         /**< These are the noise-normalization factors */
 
 private:
+    //=========================================================================================================
+    /**
+    * Composes the inverse operator from the decomposition of the whitened and weighted lead field, the common
+    * last step of assemble_inverse_operator and assemble_inverse_operator_blocked.
+    *
+    * @param[in] info               The measurement info.
+    * @param[in] forward            Forward operator.
+    * @param[in] gain_info          The measurement info of the lead field channels.
+    * @param[in] t_U                The eigen fields, left singular vectors.
+    * @param[in] t_V                The eigen leads, right singular vectors.
+    * @param[in] p_sing             The singular values.
+    * @param[in] trace_GRGT         The trace of the weighted lead field Gram matrix before scaling.
+    * @param[in] p_noise_cov        The prepared noise covariance matrix.
+    * @param[in] p_source_cov       The scaled source covariance.
+    * @param[in] p_depth_prior      The depth prior.
+    * @param[in] p_orient_prior     The orientation prior.
+    *
+    * @return the assembled inverse operator
+    */
+    static MNEInverseOperator compose_inverse_operator(const FiffInfo &info, const MNEForwardSolution &forward, const FiffInfo &gain_info, const MatrixXd &t_U, const MatrixXd &t_V, const VectorXd &p_sing, double trace_GRGT, const FiffCov &p_noise_cov, const FiffCov::SDPtr &p_source_cov, const FiffCov::SDPtr &p_depth_prior, const FiffCov::SDPtr &p_orient_prior);
+
+    //=========================================================================================================
+    /**
+    * Assembles the factored kernel of a selection of sources, the common part of the assemble_kernel_factored
+    * variants. Only the eigen lead rows of the selection are weighted.
+    *
+    * @param[in] src_sel        Indices of the selected sources in the source space, all sources if empty.
+    * @param[in] method         The applied normals. ("MNE" | "dSPM" | "sLORETA")
+    * @param[in] pick_normal    Pick normals.
+    * @param[out] leads         Weighted eigen leads of the selected sources, nSelected x rank.
+    * @param[out] trans         Data transformation, rank x nChannels.
+    * @param[out] noise_norm    Noise normals of the selected sources.
+    *
+    * @return true when successful, false otherwise
+    */
+    bool assemble_kernel_selected(const VectorXi &src_sel, QString method, bool pick_normal, MatrixXd &leads, MatrixXd &trans, SparseMatrix<double> &noise_norm) const;
+
     MatrixXd m_K;                           /**< Everytime a new kernel is assamebled a copy is stored here */
 };
 
@@ -65,6 +65,14 @@
 #include <Eigen/Geometry>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -79,6 +87,24 @@ using namespace Eigen;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+#define BVH_LEAF_SIZE   4       /**< Triangles per hierarchy leaf */
+#define BVH_STACK_SIZE  64      /**< Traversal stack, enough for any median split hierarchy */
+
+namespace
+{
+//=============================================================================================================
+/**
+ * Orders triangles by their centroid coordinate along one axis
+ */
+struct CentroidLess
+{
+    CentroidLess(const MatrixX3f &centroids, int axis) : m_centroids(centroids), m_iAxis(axis) {}
+    bool operator()(int i, int j) const { return m_centroids(i,m_iAxis) < m_centroids(j,m_iAxis); }
+    const MatrixX3f &m_centroids;
+    int m_iAxis;
+};
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -95,7 +121,7 @@ MNEProjectToSurface::MNEProjectToSurface()
 , c(VectorXf::Zero(1))
 , det(VectorXf::Zero(1))
 {
-
+    build_bvh();
 }
 
 
@@ -129,10 +155,11 @@ MNEProjectToSurface::MNEProjectToSurface(const MNEBemSurface &p_MNEBemSurf)
     {
         for (int i = 0; i < p_MNEBemSurf.ntri; ++i)
         {
-            nn.row(i) = r12.row(i).transpose().cross(r13.row(i).transpose()).transpose();
+            nn.row(i) = r12.row(i).transpose().cross(r13.row(i).transpose()).normalized().transpose();
         }
     }
     det = (a.array()*b.array() - c.array()*c.array()).matrix();
+    build_bvh();
 }
 
 
@@ -153,13 +180,14 @@ MNEProjectToSurface::MNEProjectToSurface(const MNESurface &p_MNESurf)
         r1.row(i) = p_MNESurf.rr.row(p_MNESurf.tris(i,0));
         r12.row(i) = p_MNESurf.rr.row(p_MNESurf.tris(i,1)) - r1.row(i);
         r13.row(i) = p_MNESurf.rr.row(p_MNESurf.tris(i,2)) - r1.row(i);
-        nn.row(i) = r12.row(i).transpose().cross(r13.row(i).transpose()).transpose();
+        nn.row(i) = r12.row(i).transpose().cross(r13.row(i).transpose()).normalized().transpose();
         a(i) = r12.row(i) * r12.row(i).transpose();
         b(i) = r13.row(i) * r13.row(i).transpose();
         c(i) = r12.row(i) * r13.row(i).transpose();
     }
 
     det = (a.array()*b.array() - c.array()*c.array()).matrix();
+    build_bvh();
 }
 
 
@@ -180,10 +208,6 @@ bool MNEProjectToSurface::mne_find_closest_on_surface(const MatrixXf &r, const i
     Vector3f rTriK;
     for (int k = 0; k < np; ++k)
     {
-        /*
-         * To do: decide_search_restriction for the use in an iterative closest point to plane algorithm
-         * For now it's OK to go through all triangles.
-         */
         if (!this->mne_project_to_surface(r.row(k).transpose(), rTriK, bestTri, bestDist))
         {
             qDebug() << "The projection of point number " << k << " didn't work./n";
@@ -202,22 +226,67 @@ bool MNEProjectToSurface::mne_find_closest_on_surface(const MatrixXf &r, const i
 bool MNEProjectToSurface::mne_project_to_surface(const Vector3f &r, Vector3f &rTri, int &bestTri, float &bestDist)
 {
     float p = 0, q = 0, p0 = 0, q0 = 0, dist0 = 0;
+    int stack[BVH_STACK_SIZE];
+    int nstack = 0;
     bestDist = 0.0f;
     bestTri = -1;
-    for (int tri = 0; tri < a .size(); ++tri)
+
+    if (bvhCount.size() == 0)
+    {
+        qDebug() << "No triangles to project on./n";
+        return false;
+    }
+
+    //Depth first, skipping the nodes which are farther away than the best triangle so far
+    stack[nstack++] = 0;
+    while (nstack > 0)
     {
-        if (!this->nearest_triangle_point(r, tri, p0, q0, dist0))
+        int node = stack[--nstack];
+        float boxDist = (bvhMin.row(node) - r.transpose()).cwiseMax(r.transpose() - bvhMax.row(node)).cwiseMax(0.0f).norm();
+        if (bestTri >= 0 && boxDist > std::fabs(bestDist)*(1.0f + 1e-5f))
         {
-            qDebug() << "The projection on triangle " << tri << " didn't work./n";
-            return false;
+            continue;
         }
 
-        if ((bestTri < 0) || (std::fabs(dist0) < std::fabs(bestDist)))
+        if (bvhCount(node) > 0)
+        {
+            for (int k = bvhFirst(node); k < bvhFirst(node) + bvhCount(node); ++k)
+            {
+                int tri = bvhTri(k);
+                if (!this->nearest_triangle_point(r, tri, p0, q0, dist0))
+                {
+                    qDebug() << "The projection on triangle " << tri << " didn't work./n";
+                    return false;
+                }
+
+                //Ties go to the lowest triangle number as with a search through all triangles
+                if ((bestTri < 0) || (std::fabs(dist0) < std::fabs(bestDist)) ||
+                        (std::fabs(dist0) == std::fabs(bestDist) && tri < bestTri))
+                {
+                    bestDist = dist0;
+                    p = p0;
+                    q = q0;
+                    bestTri = tri;
+                }
+            }
+        }
+        else
         {
-            bestDist = dist0;
-            p = p0;
-            q = q0;
-            bestTri = tri;
+            //Visit the nearer child first
+            int left = node + 1;
+            int right = bvhFirst(node);
+            float leftDist = (bvhMin.row(left) - r.transpose()).cwiseMax(r.transpose() - bvhMax.row(left)).cwiseMax(0.0f).squaredNorm();
+            float rightDist = (bvhMin.row(right) - r.transpose()).cwiseMax(r.transpose() - bvhMax.row(right)).cwiseMax(0.0f).squaredNorm();
+            if (leftDist < rightDist)
+            {
+                stack[nstack++] = right;
+                stack[nstack++] = left;
+            }
+            else
+            {
+                stack[nstack++] = left;
+                stack[nstack++] = right;
+            }
         }
     }
 
@@ -352,3 +421,78 @@ bool MNEProjectToSurface::project_to_triangle(Vector3f &rTri, const float p, con
     rTri = this->r1.row(tri) + p*this->r12.row(tri) + q*this->r13.row(tri);
     return true;
 }
+
+
+//*************************************************************************************************************
+
+void MNEProjectToSurface::build_bvh()
+{
+    int ntri = a.size();
+    int nnode = 0;
+
+    bvhTri.resize(ntri);
+    for (int i = 0; i < ntri; ++i)
+    {
+        bvhTri(i) = i;
+    }
+
+    //A binary tree with at least one triangle per leaf has less than 2*ntri nodes
+    bvhMin.resize(std::max(2*ntri-1,1),3);
+    bvhMax.resize(std::max(2*ntri-1,1),3);
+    bvhFirst.resize(std::max(2*ntri-1,1));
+    bvhCount.resize(std::max(2*ntri-1,1));
+
+    if (ntri > 0)
+    {
+        MatrixX3f centroids = r1 + (r12 + r13)/3.0f;
+        build_bvh_node(0, ntri, centroids, nnode);
+    }
+
+    bvhMin.conservativeResize(nnode,3);
+    bvhMax.conservativeResize(nnode,3);
+    bvhFirst.conservativeResize(nnode);
+    bvhCount.conservativeResize(nnode);
+}
+
+
+//*************************************************************************************************************
+
+int MNEProjectToSurface::build_bvh_node(const int first, const int count, const MatrixX3f &centroids, int &nnode)
+{
+    int node = nnode++;
+    RowVector3f cmin, cmax;
+
+    //Bounds of the triangles and of their centroids
+    bvhMin.row(node) = r1.row(bvhTri(first));
+    bvhMax.row(node) = r1.row(bvhTri(first));
+    cmin = cmax = centroids.row(bvhTri(first));
+    for (int k = first; k < first + count; ++k)
+    {
+        int tri = bvhTri(k);
+        RowVector3f r2 = r1.row(tri) + r12.row(tri);
+        RowVector3f r3 = r1.row(tri) + r13.row(tri);
+        bvhMin.row(node) = bvhMin.row(node).cwiseMin(r1.row(tri)).cwiseMin(r2).cwiseMin(r3);
+        bvhMax.row(node) = bvhMax.row(node).cwiseMax(r1.row(tri)).cwiseMax(r2).cwiseMax(r3);
+        cmin = cmin.cwiseMin(centroids.row(tri));
+        cmax = cmax.cwiseMax(centroids.row(tri));
+    }
+
+    if (count <= BVH_LEAF_SIZE)
+    {
+        bvhFirst(node) = first;
+        bvhCount(node) = count;
+        return node;
+    }
+
+    //Split at the median along the longest centroid extent
+    int axis;
+    (cmax - cmin).maxCoeff(&axis);
+    int half = count/2;
+    std::nth_element(bvhTri.data() + first, bvhTri.data() + first + half, bvhTri.data() + first + count,
+                     CentroidLess(centroids, axis));
+
+    bvhCount(node) = 0;
+    build_bvh_node(first, half, centroids, nnode);
+    bvhFirst(node) = build_bvh_node(first + half, count - half, centroids, nnode);
+    return node;
+}
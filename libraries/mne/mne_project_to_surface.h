@@ -187,6 +187,31 @@ private:
      */
     bool project_to_triangle(Eigen::Vector3f &rTri, const float p, const float q, const int tri);
 
+    //=========================================================================================================
+    /**
+     * Builds the bounding volume hierarchy over the triangles, which lets the projection skip all triangles
+     * farther away than the best one found so far.
+     *
+     * @brief build_bvh
+     */
+    void build_bvh();
+
+    //=========================================================================================================
+    /**
+     * Builds the subtree for the triangles bvhTri[first] ... bvhTri[first+count-1] by median splits along the
+     * longest extent of the triangle centroids.
+     *
+     * @brief build_bvh_node
+     *
+     * @param[in] first         First triangle of the node in bvhTri
+     * @param[in] count         Number of triangles in the node
+     * @param[in] centroids     The triangle centroids
+     * @param[in, out] nnode    Number of nodes built so far
+     *
+     * @return the index of the node
+     */
+    int build_bvh_node(const int first, const int count, const Eigen::MatrixX3f &centroids, int &nnode);
+
     Eigen::MatrixX3f r1;         /**< Cartesian Vector to the first triangel corner */
     Eigen::MatrixX3f r12;        /**< Cartesian Vector from the first to the second triangel corner */
     Eigen::MatrixX3f r13;        /**< Cartesian Vector from the first to the third triangel corner */
@@ -195,6 +220,12 @@ private:
     Eigen::VectorXf b;           /**< r13*r13 */
     Eigen::VectorXf c;           /**< r12*r13 */
     Eigen::VectorXf det;         /**< Determinant of the Matrix [a c, c b] */
+
+    Eigen::MatrixX3f bvhMin;     /**< Lower corner of the bounding box of each hierarchy node */
+    Eigen::MatrixX3f bvhMax;     /**< Upper corner of the bounding box of each hierarchy node */
+    Eigen::VectorXi bvhFirst;    /**< First triangle in bvhTri (leaves) or the second child (inner nodes, the first child follows the node) */
+    Eigen::VectorXi bvhCount;    /**< Number of triangles of a leaf, 0 for inner nodes */
+    Eigen::VectorXi bvhTri;      /**< Triangle numbers sorted by leaf */
 };
 
 
@@ -43,6 +43,11 @@
 #include <QFile>
 #include <QDataStream>
 #include <QSharedPointer>
+#include <QByteArray>
+#include <QtEndian>
+#include <QDebug>
+
+#include <string.h>
 
 
 //*************************************************************************************************************
@@ -53,6 +58,46 @@
 using namespace MNELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define STC_READ_CHUNK_BYTES (4*1024*1024)  /**< Bytes which are read from the device at once by readBlock. */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Opens the device if it is not open yet, in p_modeOpen if given, otherwise checks that it was opened in p_mode.
+*/
+bool openStcDevice(QIODevice &p_IODevice, QIODevice::OpenMode p_mode, QIODevice::OpenMode p_modeOpen = QIODevice::NotOpen)
+{
+    if(p_IODevice.isOpen())
+        return (p_IODevice.openMode() & p_mode) == p_mode;
+    return p_IODevice.open(p_modeOpen == QIODevice::NotOpen ? p_mode : p_modeOpen);
+}
+
+
+//=============================================================================================================
+/**
+* Position of the time point count in the stc header, the data follows right after it.
+*/
+inline qint64 stcSamplesPos(qint64 p_iNVertices)
+{
+    return 3*sizeof(quint32) + p_iNVertices*sizeof(quint32);
+}
+
+} //NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -118,17 +163,13 @@ void MNESourceEstimate::clear()
 
 //*************************************************************************************************************
 
-MNESourceEstimate MNESourceEstimate::reduce(qint32 start, qint32 n)
+MNESourceEstimate MNESourceEstimate::reduce(qint32 start, qint32 n) const
 {
     MNESourceEstimate p_sourceEstimateReduced;
 
-    qint32 rows = this->data.rows();
-
-    p_sourceEstimateReduced.data = MatrixXd::Zero(rows,n);
-    p_sourceEstimateReduced.data = this->data.block(0, start, rows, n);
+    p_sourceEstimateReduced.data = this->data.middleCols(start, n);
     p_sourceEstimateReduced.vertices = this->vertices;
-    p_sourceEstimateReduced.times = RowVectorXf::Zero(n);
-    p_sourceEstimateReduced.times = this->times.block(0,start,1,n);
+    p_sourceEstimateReduced.times = this->times.segment(start, n);
     p_sourceEstimateReduced.tmin = p_sourceEstimateReduced.times(0);
     p_sourceEstimateReduced.tstep = this->tstep;
 
@@ -136,6 +177,42 @@ MNESourceEstimate MNESourceEstimate::reduce(qint32 start, qint32 n)
 }
 
 
+//*************************************************************************************************************
+
+QList<MNESourceEstimate> MNESourceEstimate::morph(const QList<MNESourceEstimate>& p_qListStc, const SparseMatrix<double>& p_matMorph, const VectorXi& p_vecVerticesTo)
+{
+    QList<MNESourceEstimate> t_qListMorphed;
+
+    if(p_matMorph.rows() != p_vecVerticesTo.size()) {
+        qWarning() << "MNESourceEstimate::morph - The morph operator has" << p_matMorph.rows() << "rows for" << p_vecVerticesTo.size() << "vertices.";
+        return t_qListMorphed;
+    }
+
+    qint32 cols = 0;
+    for(qint32 i = 0; i < p_qListStc.size(); ++i) {
+        if(p_qListStc[i].data.rows() != p_matMorph.cols()) {
+            qWarning() << "MNESourceEstimate::morph - Source estimate" << i << "has" << p_qListStc[i].data.rows() << "sources, the morph operator" << p_matMorph.cols() << ".";
+            return t_qListMorphed;
+        }
+        cols += p_qListStc[i].data.cols();
+    }
+
+    //
+    // One product for all estimates
+    //
+    MatrixXd t_matData(p_matMorph.cols(), cols);
+    for(qint32 i = 0, c = 0; i < p_qListStc.size(); c += p_qListStc[i].data.cols(), ++i)
+        t_matData.middleCols(c, p_qListStc[i].data.cols()) = p_qListStc[i].data;
+
+    MatrixXd t_matMorphed = p_matMorph * t_matData;
+
+    for(qint32 i = 0, c = 0; i < p_qListStc.size(); c += p_qListStc[i].data.cols(), ++i)
+        t_qListMorphed.append(MNESourceEstimate(t_matMorphed.middleCols(c, p_qListStc[i].data.cols()), p_vecVerticesTo, p_qListStc[i].tmin, p_qListStc[i].tstep));
+
+    return t_qListMorphed;
+}
+
+
 //*************************************************************************************************************
 
 bool MNESourceEstimate::read(QIODevice &p_IODevice, MNESourceEstimate& p_stc)
@@ -242,6 +319,212 @@ bool MNESourceEstimate::write(QIODevice &p_IODevice)
 }
 
 
+//*************************************************************************************************************
+
+bool MNESourceEstimate::writeHeader(QIODevice &p_IODevice, const VectorXi &p_vertices, float p_tmin, float p_tstep)
+{
+    // Opened for reading too, appendBlock reads the header back
+    if(!openStcDevice(p_IODevice, QIODevice::WriteOnly, QIODevice::ReadWrite | QIODevice::Truncate))
+    {
+        printf("Failed to write source estimate header!\n");
+        return false;
+    }
+
+    QDataStream t_stream(&p_IODevice);
+    t_stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    t_stream.setByteOrder(QDataStream::BigEndian);
+    t_stream.setVersion(QDataStream::Qt_5_0);
+
+    p_IODevice.seek(0);
+
+    // start time and sampling rate in ms
+    t_stream << (float)1000*p_tmin;
+    t_stream << (float)1000*p_tstep;
+    t_stream << (quint32)p_vertices.size();
+    for(qint32 i = 0; i < p_vertices.size(); ++i)
+        t_stream << (quint32)p_vertices[i];
+    // no time points yet
+    t_stream << (quint32)0;
+
+    return t_stream.status() == QDataStream::Ok;
+}
+
+
+//*************************************************************************************************************
+
+bool MNESourceEstimate::appendBlock(QIODevice &p_IODevice, const MatrixXd &p_matData)
+{
+    VectorXi t_vertices;
+    float t_tmin, t_tstep;
+    qint32 t_iSamples;
+
+    if(!openStcDevice(p_IODevice, QIODevice::ReadWrite) || !readHeader(p_IODevice, t_vertices, t_tmin, t_tstep, t_iSamples))
+    {
+        printf("Failed to append to source estimate, the header has to be written first!\n");
+        return false;
+    }
+
+    if(p_matData.rows() != t_vertices.size())
+    {
+        printf("Failed to append to source estimate, the block has %d sources instead of %d!\n", (int)p_matData.rows(), (int)t_vertices.size());
+        return false;
+    }
+
+    //
+    // The data is stored time point by time point, i.e. in the column major order of Eigen
+    //
+    QByteArray t_buffer(p_matData.size()*sizeof(quint32), Qt::Uninitialized);
+    uchar* t_pDst = reinterpret_cast<uchar*>(t_buffer.data());
+    for(qint32 i = 0; i < p_matData.size(); ++i, t_pDst += sizeof(quint32))
+    {
+        float value = (float)p_matData.data()[i];
+        quint32 bits;
+        memcpy(&bits, &value, sizeof(quint32));
+        qToBigEndian(bits, t_pDst);
+    }
+
+    qint64 t_iDataPos = stcSamplesPos(t_vertices.size()) + sizeof(quint32);
+    if(!p_IODevice.seek(t_iDataPos + (qint64)t_iSamples*t_vertices.size()*sizeof(quint32))
+            || p_IODevice.write(t_buffer) != t_buffer.size())
+    {
+        printf("Failed to append to source estimate!\n");
+        return false;
+    }
+
+    //
+    // Update the number of time points
+    //
+    QDataStream t_stream(&p_IODevice);
+    t_stream.setByteOrder(QDataStream::BigEndian);
+    t_stream.setVersion(QDataStream::Qt_5_0);
+
+    p_IODevice.seek(stcSamplesPos(t_vertices.size()));
+    t_stream << (quint32)(t_iSamples + p_matData.cols());
+
+    return t_stream.status() == QDataStream::Ok;
+}
+
+
+//*************************************************************************************************************
+
+bool MNESourceEstimate::readHeader(QIODevice &p_IODevice, VectorXi &p_vertices, float &p_tmin, float &p_tstep, qint32 &p_iSamples)
+{
+    if(!openStcDevice(p_IODevice, QIODevice::ReadOnly) || !p_IODevice.seek(0))
+        return false;
+
+    QDataStream t_stream(&p_IODevice);
+    t_stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    t_stream.setByteOrder(QDataStream::BigEndian);
+    t_stream.setVersion(QDataStream::Qt_5_0);
+
+    t_stream >> p_tmin;
+    p_tmin /= 1000;
+    t_stream >> p_tstep;
+    p_tstep /= 1000;
+    quint32 t_nVertices;
+    t_stream >> t_nVertices;
+    if(t_stream.status() != QDataStream::Ok)
+        return false;
+    p_vertices = VectorXi(t_nVertices);
+    for(quint32 i = 0; i < t_nVertices; ++i)
+        t_stream >> p_vertices[i];
+    quint32 t_nTimePts;
+    t_stream >> t_nTimePts;
+    p_iSamples = t_nTimePts;
+
+    return t_stream.status() == QDataStream::Ok;
+}
+
+
+//*************************************************************************************************************
+
+bool MNESourceEstimate::readBlock(QIODevice &p_IODevice, MNESourceEstimate& p_stc, qint32 start, qint32 n, const VectorXi &p_vecRows)
+{
+    VectorXi t_vertices;
+    float t_tmin, t_tstep;
+    qint32 t_iSamples;
+
+    if(!readHeader(p_IODevice, t_vertices, t_tmin, t_tstep, t_iSamples))
+    {
+        printf("Failed to read source estimate header!\n");
+        return false;
+    }
+
+    if(n < 0)
+        n = t_iSamples - start;
+    if(start < 0 || n < 0 || start + n > t_iSamples)
+    {
+        printf("Time points %d to %d are out of range of the source estimate with %d time points!\n", start, start + n - 1, t_iSamples);
+        return false;
+    }
+
+    qint32 t_nVertices = t_vertices.size();
+    bool t_bAllRows = p_vecRows.size() == 0;
+    for(qint32 i = 0; i < p_vecRows.size(); ++i)
+    {
+        if(p_vecRows[i] < 0 || p_vecRows[i] >= t_nVertices)
+        {
+            printf("Source %d is out of range of the source estimate with %d sources!\n", p_vecRows[i], t_nVertices);
+            return false;
+        }
+    }
+
+    qint32 t_nRows = t_bAllRows ? t_nVertices : p_vecRows.size();
+    MatrixXd t_matData(t_nRows, n);
+
+    //
+    // Read chunks of whole time points and keep the selected sources
+    //
+    qint64 t_iBytesPerSample = (qint64)t_nVertices*sizeof(quint32);
+    qint32 t_iChunk = t_iBytesPerSample > 0 ? qMax<qint64>(1, STC_READ_CHUNK_BYTES / t_iBytesPerSample) : n;
+
+    if(n > 0 && t_nVertices > 0 && !p_IODevice.seek(stcSamplesPos(t_nVertices) + sizeof(quint32) + start*t_iBytesPerSample))
+    {
+        printf("Failed to read source estimate data!\n");
+        return false;
+    }
+
+    QByteArray t_buffer;
+    for(qint32 c = 0; c < n && t_nVertices > 0; c += t_iChunk)
+    {
+        qint32 t_iCols = qMin(t_iChunk, n - c);
+        t_buffer = p_IODevice.read(t_iCols*t_iBytesPerSample);
+        if(t_buffer.size() != t_iCols*t_iBytesPerSample)
+        {
+            printf("Failed to read source estimate data!\n");
+            return false;
+        }
+
+        const uchar* t_pSrc = reinterpret_cast<const uchar*>(t_buffer.constData());
+        for(qint32 j = 0; j < t_iCols; ++j, t_pSrc += t_iBytesPerSample)
+        {
+            for(qint32 i = 0; i < t_nRows; ++i)
+            {
+                quint32 bits = qFromBigEndian<quint32>(t_pSrc + (t_bAllRows ? i : p_vecRows[i])*sizeof(quint32));
+                float value;
+                memcpy(&value, &bits, sizeof(float));
+                t_matData(i, c + j) = value;
+            }
+        }
+    }
+
+    p_stc.data = t_matData;
+    if(t_bAllRows)
+        p_stc.vertices = t_vertices;
+    else
+    {
+        p_stc.vertices = VectorXi(t_nRows);
+        for(qint32 i = 0; i < t_nRows; ++i)
+            p_stc.vertices[i] = t_vertices[p_vecRows[i]];
+    }
+    p_stc.tmin = t_tmin + start*t_tstep;
+    p_stc.tstep = t_tstep;
+    p_stc.update_times();
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 void MNESourceEstimate::update_times()
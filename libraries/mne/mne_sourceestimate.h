@@ -50,6 +50,7 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 
 //*************************************************************************************************************
@@ -145,7 +146,21 @@ public:
     * @param[in] start  The start index to cut the estimate from.
     * @param[in] n      Number of samples to cut from start index.
     */
-    MNESourceEstimate reduce(qint32 start, qint32 n);
+    MNESourceEstimate reduce(qint32 start, qint32 n) const;
+
+    //=========================================================================================================
+    /**
+    * Morphs source estimates to another source space. All estimates are stacked side by side and multiplied
+    * with the sparse morph operator at once, which is much faster for many estimates than morphing them one
+    * after the other. The operator can be assembled from MneMorphMap::pick_morph_map for both hemispheres.
+    *
+    * @param[in] p_qListStc         The source estimates, each with p_matMorph.cols() sources.
+    * @param[in] p_matMorph         The morph operator, one row for each source in the destination source space.
+    * @param[in] p_vecVerticesTo    The vertices of the destination source space.
+    *
+    * @return the morphed source estimates, an empty list if the sizes do not match.
+    */
+    static QList<MNESourceEstimate> morph(const QList<MNESourceEstimate>& p_qListStc, const SparseMatrix<double>& p_matMorph, const VectorXi& p_vecVerticesTo);
 
     //=========================================================================================================
     /**
@@ -170,6 +185,64 @@ public:
     */
     bool write(QIODevice &p_IODevice);
 
+    //=========================================================================================================
+    /**
+    * Starts streaming a stc file. Writes the header with zero time points, the data is appended afterwards
+    * with appendBlock. The file stays valid after every block. The device is opened for reading and writing
+    * if it is not open yet and left open, the caller closes it when the recording ends.
+    *
+    * @param [in] p_IODevice    IO device to write the stc to.
+    * @param [in] p_vertices    The vertices of the source estimates which are going to be appended.
+    * @param [in] p_tmin        Time of the first sample.
+    * @param [in] p_tstep       Time between two samples.
+    *
+    * @return true if successful, false otherwise
+    */
+    static bool writeHeader(QIODevice &p_IODevice, const VectorXi &p_vertices, float p_tmin, float p_tstep);
+
+    //=========================================================================================================
+    /**
+    * Appends a time block, e.g. the result of MinimumNorm::calculateInverse, to a stc file which was started
+    * with writeHeader or written before. The data is stored as float32 like all stc data, the time point
+    * count in the header is updated.
+    *
+    * @param [in] p_IODevice    IO device to append to, opened for reading and writing if it is not open.
+    * @param [in] p_matData     The data block of shape [n_dipoles x n_times].
+    *
+    * @return true if successful, false otherwise
+    */
+    static bool appendBlock(QIODevice &p_IODevice, const MatrixXd &p_matData);
+
+    //=========================================================================================================
+    /**
+    * Reads the header of a stc file without the data. The device is opened if it is not open yet and left open.
+    *
+    * @param [in] p_IODevice    IO device to read from.
+    * @param [out] p_vertices   The vertices.
+    * @param [out] p_tmin       Time of the first sample.
+    * @param [out] p_tstep      Time between two samples.
+    * @param [out] p_iSamples   Number of time points in the file.
+    *
+    * @return true if successful, false otherwise
+    */
+    static bool readHeader(QIODevice &p_IODevice, VectorXi &p_vertices, float &p_tmin, float &p_tstep, qint32 &p_iSamples);
+
+    //=========================================================================================================
+    /**
+    * Reads a time range of selected sources from a stc file. Only the requested time points are read from
+    * the device, which makes it possible to browse recordings which do not fit into memory. The device is
+    * opened if it is not open yet and left open.
+    *
+    * @param [in] p_IODevice    IO device to read from.
+    * @param [out] p_stc        The read stc, tmin is the time of the first read sample.
+    * @param [in] start         The first time point to read.
+    * @param [in] n             The number of time points to read, -1 reads up to the end.
+    * @param [in] p_vecRows     The rows, i.e. the positions in the vertices vector, to read. Empty reads all.
+    *
+    * @return true if successful, false otherwise
+    */
+    static bool readBlock(QIODevice &p_IODevice, MNESourceEstimate& p_stc, qint32 start, qint32 n = -1, const VectorXi &p_vecRows = VectorXi());
+
     //=========================================================================================================
     /**
     * Returns whether SourceEstimate is empty.
@@ -50,6 +50,7 @@
 //=============================================================================================================
 
 #include <iostream>
+#include <algorithm>
 
 
 //*************************************************************************************************************
@@ -135,7 +136,7 @@ QList<VectorXi> MNESourceSpace::label_src_vertno_sel(const Label &p_label, Vecto
     else if (p_label.hemi == 1) //rh
     {
         VectorXi vertno_sel = MNEMath::intersect(vertno[1], p_label.vertices, src_sel);
-        src_sel.array() += p_label.vertices.size();
+        src_sel.array() += vertno[0].size();
         vertno[0] = VectorXi();
         vertno[1] = vertno_sel;
     }
@@ -175,6 +176,46 @@ QList<VectorXi> MNESourceSpace::label_src_vertno_sel(const Label &p_label, Vecto
 }
 
 
+//*************************************************************************************************************
+
+QList<VectorXi> MNESourceSpace::label_src_vertno_sel(const QList<Label> &p_qListLabels, VectorXi &src_sel) const
+{
+    QList<VectorXi> vertno;
+    vertno << this->m_qListHemispheres[0].vertno << this->m_qListHemispheres[1].vertno;
+
+    //
+    //   Merge the vertices of the labels per hemisphere, overlapping labels select a source once
+    //
+    std::vector<int> t_vecVertices[2];
+    for(qint32 i = 0; i < p_qListLabels.size(); ++i)
+    {
+        const Label& t_label = p_qListLabels[i];
+        if(t_label.hemi != 0 && t_label.hemi != 1)
+        {
+            qWarning("Unknown hemisphere type of label %s\n", t_label.name.toUtf8().constData());
+            continue;
+        }
+        for(qint32 j = 0; j < t_label.vertices.size(); ++j)
+            t_vecVertices[t_label.hemi].push_back(t_label.vertices[j]);
+    }
+
+    VectorXi t_vecSel[2];
+    for(qint32 h = 0; h < 2; ++h)
+    {
+        std::sort(t_vecVertices[h].begin(), t_vecVertices[h].end());
+        t_vecVertices[h].erase(std::unique(t_vecVertices[h].begin(), t_vecVertices[h].end()), t_vecVertices[h].end());
+
+        VectorXi t_vecLabelVertices = Map<VectorXi>(t_vecVertices[h].data(), t_vecVertices[h].size());
+        vertno[h] = MNEMath::intersect(vertno[h], t_vecLabelVertices, t_vecSel[h]);
+    }
+
+    src_sel.resize(t_vecSel[0].size() + t_vecSel[1].size());
+    src_sel << t_vecSel[0], (t_vecSel[1].array() + this->m_qListHemispheres[0].vertno.size()).matrix();
+
+    return vertno;
+}
+
+
 //*************************************************************************************************************
 
 MNESourceSpace MNESourceSpace::pick_regions(const QList<Label> &p_qListLabels) const
@@ -183,6 +183,18 @@ public:
     */
     QList<VectorXi> label_src_vertno_sel(const Label &p_label, VectorXi &src_sel) const;
 
+    //=========================================================================================================
+    /**
+    * Find vertex numbers and indices from several labels of one or both hemispheres. A source covered by more
+    * than one label is selected once. The selection is sorted, the left hemisphere comes first.
+    *
+    * @param[in] p_qListLabels  Source space labels
+    * @param[out] src_sel       Indices of the selected vertices in source space
+    *
+    * @return vertno list of length 2 Vertex numbers for lh and rh
+    */
+    QList<VectorXi> label_src_vertno_sel(const QList<Label> &p_qListLabels, VectorXi &src_sel) const;
+
     //=========================================================================================================
     /**
     * ### MNE toolbox root function ###: Definition of the mne_patch_info function
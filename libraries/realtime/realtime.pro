@@ -79,6 +79,8 @@ SOURCES += \
     rtClient/rtclient.cpp \
     rtClient/rtdataclient.cpp \
     rtClient/rtcmdclient.cpp \
+    rtClient/rtshmemring.cpp \
+    rtClient/rtrawcodec.cpp \
     rtCommand/command.cpp \
     rtCommand/commandmanager.cpp \
     rtCommand/commandparser.cpp \
@@ -88,13 +90,18 @@ SOURCES += \
     rtProcessing/rtave.cpp \
     rtProcessing/rtnoise.cpp \
     rtProcessing/rthpis.cpp \
-    rtProcessing/rtfilter.cpp
+    rtProcessing/rtfilter.cpp \
+    rtProcessing/rtresample.cpp \
+    rtProcessing/rtstreamaligner.cpp
 
 HEADERS +=  \
     realtime_global.h \
     rtClient/rtclient.h \
     rtClient/rtcmdclient.h \
     rtClient/rtdataclient.h \
+    rtClient/rtmulticastfragment.h \
+    rtClient/rtrawcodec.h \
+    rtClient/rtshmemring.h \
     rtCommand/command.h \
     rtCommand/commandmanager.h \
     rtCommand/commandparser.h \
@@ -104,7 +111,9 @@ HEADERS +=  \
     rtProcessing/rtave.h \
     rtProcessing/rtnoise.h \
     rtProcessing/rthpis.h \
-    rtProcessing/rtfilter.h
+    rtProcessing/rtfilter.h \
+    rtProcessing/rtresample.h \
+    rtProcessing/rtstreamaligner.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
 INCLUDEPATH += $${MNE_INCLUDE_DIR}
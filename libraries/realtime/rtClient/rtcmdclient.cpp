@@ -48,13 +48,11 @@
 //=============================================================================================================
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QThread>
 
 #include <iostream>
 
-
-#define USENEW 1
-
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -69,9 +67,15 @@ using namespace REALTIMELIB;
 
 RtCmdClient::RtCmdClient(QObject *parent) :
         QTcpSocket(parent)
+        , m_iNextRequestId(0)
+        , m_iReplyBlockSize(0)
 {
     QObject::connect(&m_commandManager, &CommandManager::triggered, this,
             &RtCmdClient::sendCommandJSON);
+
+    //Replies to posted commands arrive while the event loop runs
+    QObject::connect(this, &QTcpSocket::readyRead, this,
+            &RtCmdClient::readReplies);
 }
 
 //*************************************************************************************************************
@@ -85,24 +89,15 @@ void RtCmdClient::connectToHost(QString &p_sRtServerHostName)
 
 QString RtCmdClient::sendCLICommand(const QString &p_sCommand)
 {
-    QString t_sCommand = QString("%1\n").arg(p_sCommand);
     QString p_sReply;
 
-    if (this->state() == QAbstractSocket::ConnectedState)
-    {
-        this->write(t_sCommand.toUtf8().constData(), t_sCommand.size());
-        this->waitForBytesWritten();
-
-        //thats not the most elegant way
-        this->waitForReadyRead(1000);
-        QByteArray t_qByteArrayRaw;
-        // TODO(cpieloth): We need a break condition e.g. last byte == \0 or \n
-        // Large responses can be split to more than one packet which could be a problem on big network latencies.
-        while (this->bytesAvailable() > 0 && this->canReadLine())
-            t_qByteArrayRaw += this->readAll();
-
-        p_sReply = QString(t_qByteArrayRaw);
-    }
+    //Command line requests carry no correlation id, they are answered in order
+    qint32 t_iRequestId = postRequest(QString("%1\n").arg(p_sCommand), true);
+    if(t_iRequestId >= 0 && waitForReplies(QList<qint32>() << t_iRequestId, 1000))
+        p_sReply = takeReply(t_iRequestId);
+    else
+        takeReply(t_iRequestId);
+
     return p_sReply;
 }
 
@@ -110,82 +105,175 @@ QString RtCmdClient::sendCLICommand(const QString &p_sCommand)
 
 void RtCmdClient::sendCommandJSON(const Command &p_command)
 {
-    const QString t_sCommand = QString("{\"commands\":{%1}}\n").arg(p_command.toStringReadySend());
-
     QString t_sReply;
 
-    if (this->state() == QAbstractSocket::ConnectedState)
+    qint32 t_iRequestId = postCommandJSON(p_command, true);
+    if(t_iRequestId >= 0)
     {
-        // Send request
-#ifdef USENEW
-        QByteArray block;
-        QDataStream out(&block, QIODevice::WriteOnly);
-        out.setVersion(QDataStream::Qt_5_1);
+        waitForReplies(QList<qint32>() << t_iRequestId);
+        t_sReply = takeReply(t_iRequestId);
+    }
 
-        out << (quint16)0;
-        out << t_sCommand;
-        out.device()->seek(0);
-        out << (quint16)(block.size() - sizeof(quint16));
+    m_qMutex.lock();
+//    m_sAvailableData.append(t_sReply); //ToDo check this
+    m_sAvailableData = t_sReply;
+    m_qMutex.unlock();
 
-        this->write(block);
-        this->waitForBytesWritten();
+    emit response(t_sReply);
+}
 
-        // Receive response
-        QDataStream in(this);
-        in.setVersion(QDataStream::Qt_5_1);
 
-        quint16 blockSize = 0;
+//*************************************************************************************************************
 
-        bool respComplete = false;
+QStringList RtCmdClient::sendCommandsJSON(const QList<Command> &p_qListCommands, qint32 msecs)
+{
+    QList<qint32> t_qListRequestIds;
+    for(qint32 i = 0; i < p_qListCommands.size(); ++i)
+        t_qListRequestIds.append(postCommandJSON(p_qListCommands[i], true));
 
-        do
-        {
-            this->waitForReadyRead(100);
-
-            if (blockSize == 0)
-            {
-                if (this->bytesAvailable() >= (int)sizeof(quint16))
-                    in >> blockSize;
-            }
-            else if(this->bytesAvailable() >= blockSize)
-            {
-                in >> t_sReply;
-                respComplete = true;
-            }
-        } while (!respComplete && blockSize < 65000);//Sanity Check -> allowed maximal blocksize is 65.000
-#else
-        this->write(t_sCommand.toUtf8().constData(), t_sCommand.size());
-        this->waitForBytesWritten();
-
-        // Receive response
-        bool respComplete = false;
-        QByteArray t_qByteArrayRaw;
-        do
-        {
-            if (this->waitForReadyRead(100))
-            {
-                t_qByteArrayRaw += this->readAll();
-                // We need a break condition,
-                // because we do not have a stop character and do not know how many bytes to receive.
-                respComplete = t_qByteArrayRaw.count('{')
-                        == t_qByteArrayRaw.count('}');
-            }
-            qDebug() << "Response: " << t_qByteArrayRaw.size() << " bytes";
-        } while (!respComplete);
-        t_sReply = QString(t_qByteArrayRaw);
-#endif
-    }
-    else
+    waitForReplies(t_qListRequestIds, msecs);
+
+    QStringList t_qListReplies;
+    for(qint32 i = 0; i < t_qListRequestIds.size(); ++i)
+        t_qListReplies.append(takeReply(t_qListRequestIds[i]));
+
+    return t_qListReplies;
+}
+
+
+//*************************************************************************************************************
+
+qint32 RtCmdClient::postCommandJSON(const Command &p_command, bool p_bKeepReply)
+{
+    return postRequest(QString("{\"commands\":{%1},\"id\":%2}\n").arg(p_command.toStringReadySend()).arg(m_iNextRequestId), p_bKeepReply);
+}
+
+
+//*************************************************************************************************************
+
+qint32 RtCmdClient::postRequest(const QString &p_sRequest, bool p_bKeepReply)
+{
+    if (this->state() != QAbstractSocket::ConnectedState)
     {
         qWarning() << "Request was not send, because client is not connected!";
+        return -1;
     }
 
+    qint32 t_iRequestId = m_iNextRequestId++;
+
     m_qMutex.lock();
-//    m_sAvailableData.append(t_sReply); //ToDo check this
-    m_sAvailableData = t_sReply;
+    m_qListPendingIds.append(t_iRequestId);
+    if(p_bKeepReply)
+        m_qSetKeptIds.insert(t_iRequestId);
     m_qMutex.unlock();
 
-    emit response(t_sReply);
+    // Send request
+    QByteArray block;
+    QDataStream out(&block, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_1);
+
+    out << (quint16)0;
+    out << p_sRequest;
+    out.device()->seek(0);
+    out << (quint16)(block.size() - sizeof(quint16));
+
+    this->write(block);
+    this->waitForBytesWritten();
+
+    return t_iRequestId;
+}
+
+
+//*************************************************************************************************************
+
+bool RtCmdClient::waitForReplies(const QList<qint32> &p_qListRequestIds, qint32 msecs)
+{
+    if(p_qListRequestIds.contains(-1))
+        return false;
+
+    QElapsedTimer t_timer;
+    t_timer.start();
+
+    forever
+    {
+        readReplies();
+
+        bool t_bComplete = true;
+        m_qMutex.lock();
+        for(qint32 i = 0; i < p_qListRequestIds.size() && t_bComplete; ++i)
+            t_bComplete = m_qMapReplies.contains(p_qListRequestIds[i]);
+        m_qMutex.unlock();
+
+        if(t_bComplete)
+            return true;
+
+        if(this->state() != QAbstractSocket::ConnectedState || (msecs != -1 && t_timer.elapsed() >= msecs))
+            return false;
+
+        this->waitForReadyRead(100);
+    }
+}
+
+
+//*************************************************************************************************************
+
+QString RtCmdClient::takeReply(qint32 p_iRequestId)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_qSetKeptIds.remove(p_iRequestId);
+    return m_qMapReplies.take(p_iRequestId);
+}
+
+
+//*************************************************************************************************************
+
+void RtCmdClient::readReplies()
+{
+    QDataStream in(this);
+    in.setVersion(QDataStream::Qt_5_1);
+
+    forever
+    {
+        if(m_iReplyBlockSize == 0)
+        {
+            if(this->bytesAvailable() < (int)sizeof(quint16))
+                return;
+            in >> m_iReplyBlockSize;
+        }
+
+        if(this->bytesAvailable() < m_iReplyBlockSize)
+            return;
+
+        QString t_sReply;
+        in >> t_sReply;
+        m_iReplyBlockSize = 0;
+
+        m_qMutex.lock();
+
+        //Replies to requests with a correlation id are sent as {"id":<id>,"reply":<reply>}, servers without
+        //correlation ids reply in the order of the requests
+        qint32 t_iRequestId = -1;
+        QJsonObject t_jsonObjectReply;
+        if(t_sReply.startsWith(QString("{\"id\":")))
+            t_jsonObjectReply = QJsonDocument::fromJson(t_sReply.toUtf8()).object();
+
+        if(t_jsonObjectReply.value(QString("reply")).isString() && t_jsonObjectReply.value(QString("id")).isDouble())
+        {
+            t_iRequestId = (qint32)t_jsonObjectReply.value(QString("id")).toDouble();
+            t_sReply = t_jsonObjectReply.value(QString("reply")).toString();
+        }
+        else if(!m_qListPendingIds.isEmpty())
+            t_iRequestId = m_qListPendingIds.first();
+
+        m_qListPendingIds.removeOne(t_iRequestId);
+
+        if(m_qSetKeptIds.contains(t_iRequestId))
+            m_qMapReplies.insert(t_iRequestId, t_sReply);
+
+        m_qMutex.unlock();
+
+        emit commandReply(t_iRequestId, t_sReply);
+    }
 }
 
 
@@ -198,12 +286,20 @@ qint32 RtCmdClient::requestBufsize()
 
     //Receive
     m_qMutex.lock();
-    QByteArray t_sJsonCommands = m_sAvailableData.toUtf8();
+    QString t_sReply = m_sAvailableData;
     m_qMutex.unlock();
 
+    return parseBufsize(t_sReply);
+}
+
+
+//*************************************************************************************************************
+
+qint32 RtCmdClient::parseBufsize(const QString &p_sReply)
+{
     //Parse
     QJsonParseError error;
-    QJsonDocument t_jsonDocumentOrigin = QJsonDocument::fromJson(t_sJsonCommands, &error);
+    QJsonDocument t_jsonDocumentOrigin = QJsonDocument::fromJson(p_sReply.toUtf8(), &error);
 
     if (error.error == QJsonParseError::NoError)
     {
@@ -261,13 +357,21 @@ qint32 RtCmdClient::requestConnectors(QMap<qint32, QString> &p_qMapConnectors)
 
     //Receive
     m_qMutex.lock();
-    QByteArray t_sJsonConnectors = m_sAvailableData.toUtf8();
+    QString t_sReply = m_sAvailableData;
     m_qMutex.unlock();
 
+    return parseConnectors(t_sReply, p_qMapConnectors);
+}
+
+
+//*************************************************************************************************************
+
+qint32 RtCmdClient::parseConnectors(const QString &p_sReply, QMap<qint32, QString> &p_qMapConnectors)
+{
     //Parse
     QJsonParseError error;
     QJsonDocument t_jsonDocumentOrigin = QJsonDocument::fromJson(
-            t_sJsonConnectors, &error);
+            p_sReply.toUtf8(), &error);
 
     QJsonObject t_jsonObjectConnectors;
 
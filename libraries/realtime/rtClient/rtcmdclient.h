@@ -55,9 +55,13 @@
 //=============================================================================================================
 
 #include <QDataStream>
+#include <QList>
+#include <QMap>
 #include <QMutex>
+#include <QSet>
 #include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 #include <QTcpSocket>
 
 
@@ -78,6 +82,8 @@ namespace REALTIMELIB
 //=============================================================================================================
 /**
 * The real-time command client class provides an interface to communicate with the command port 4217 of a running mne_rt_server.
+* Commands can be pipelined: postCommandJSON sends a command tagged with a correlation id without waiting for the reply,
+* the reply is emitted with this id by commandReply and can be collected with waitForReplies and takeReply.
 *
 * @brief Real-time command client
 */
@@ -126,7 +132,7 @@ public:
 
     //=========================================================================================================
     /**
-    * Sends a command to a connected mne_rt_server
+    * Sends a command to a connected mne_rt_server and waits for its reply
     *
     * @param[in] p_command    The command to send
     *
@@ -134,6 +140,72 @@ public:
     */
     void sendCommandJSON(const Command &p_command);
 
+    //=========================================================================================================
+    /**
+    * Sends commands to a connected mne_rt_server in one round trip, all commands are sent before the first reply
+    * is awaited.
+    *
+    * @param[in] p_qListCommands    The commands to send.
+    * @param[in] msecs              time to wait for all replies in milliseconds, -1 waits without time out.
+    *
+    * @return the replies in the order of the commands, empty for a command which wasn't answered in time.
+    */
+    QStringList sendCommandsJSON(const QList<Command> &p_qListCommands, qint32 msecs = 30000);
+
+    //=========================================================================================================
+    /**
+    * Sends a command to a connected mne_rt_server without waiting for the reply. The reply is emitted by
+    * commandReply, kept replies can additionally be collected with takeReply.
+    *
+    * @param[in] p_command      The command to send.
+    * @param[in] p_bKeepReply   Whether the reply is kept until it is taken with takeReply.
+    *
+    * @return the correlation id of the request, -1 if the client is not connected.
+    */
+    qint32 postCommandJSON(const Command &p_command, bool p_bKeepReply = false);
+
+    //=========================================================================================================
+    /**
+    * Waits until the kept replies to the given requests are received.
+    *
+    * @param[in] p_qListRequestIds  Correlation ids of the requests.
+    * @param[in] msecs              time to wait in milliseconds, -1 waits without time out.
+    *
+    * @return true if all replies are received, false otherwise.
+    */
+    bool waitForReplies(const QList<qint32> &p_qListRequestIds, qint32 msecs = 30000);
+
+    //=========================================================================================================
+    /**
+    * Takes the kept reply to a request.
+    *
+    * @param[in] p_iRequestId   Correlation id of the request.
+    *
+    * @return the reply, empty if it wasn't received.
+    */
+    QString takeReply(qint32 p_iRequestId);
+
+    //=========================================================================================================
+    /**
+    * Parses the reply to getbufsize.
+    *
+    * @param[in] p_sReply   The reply.
+    *
+    * @return the buffer size, -1 if the reply can't be parsed.
+    */
+    static qint32 parseBufsize(const QString &p_sReply);
+
+    //=========================================================================================================
+    /**
+    * Parses the reply to conlist.
+    *
+    * @param[in] p_sReply           The reply.
+    * @param[out] p_qMapConnectors  list of connectors
+    *
+    * @return the active connector.
+    */
+    static qint32 parseConnectors(const QString &p_sReply, QMap<qint32, QString> &p_qMapConnectors);
+
     //=========================================================================================================
     /**
     * Returns the available data.
@@ -203,10 +275,42 @@ signals:
     */
     void response(QString p_sResponse);
 
+    //=========================================================================================================
+    /**
+    * Emits a received reply with the correlation id of its request.
+    *
+    * @param[in] p_iRequestId   Correlation id of the request, -1 for a reply to no pending request.
+    * @param[in] p_sReply       the received reply
+    */
+    void commandReply(qint32 p_iRequestId, QString p_sReply);
+
 private:
-    CommandManager  m_commandManager;   /**< The command manager. */
-    QMutex          m_qMutex;           /**< Access serialization between threads */
-    QString         m_sAvailableData;   /**< The last received response. */
+    //=========================================================================================================
+    /**
+    * Sends a request block without waiting for the reply.
+    *
+    * @param[in] p_sRequest     The JSON or command line formatted request.
+    * @param[in] p_bKeepReply   Whether the reply is kept until it is taken with takeReply.
+    *
+    * @return the correlation id of the request, -1 if the client is not connected.
+    */
+    qint32 postRequest(const QString &p_sRequest, bool p_bKeepReply);
+
+    //=========================================================================================================
+    /**
+    * Reads all complete reply blocks from the socket and assigns them to their requests.
+    */
+    void readReplies();
+
+    CommandManager          m_commandManager;       /**< The command manager. */
+    QMutex                  m_qMutex;               /**< Access serialization between threads */
+    QString                 m_sAvailableData;       /**< The last received response. */
+
+    qint32                  m_iNextRequestId;       /**< Correlation id of the next request. */
+    quint16                 m_iReplyBlockSize;      /**< Size of the reply block being received, 0 between blocks. */
+    QList<qint32>           m_qListPendingIds;      /**< Requests waiting for their reply, in the order they were sent. */
+    QSet<qint32>            m_qSetKeptIds;          /**< Requests whose reply is kept until taken. */
+    QMap<qint32, QString>   m_qMapReplies;          /**< Kept replies by their request id. */
 };
 
 //*************************************************************************************************************
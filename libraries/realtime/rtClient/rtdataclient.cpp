@@ -41,8 +41,24 @@
 //=============================================================================================================
 
 #include "rtdataclient.h"
+#include "rtmulticastfragment.h"
 #include <fiff/fiff_file.h>
 
+#include <string.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtCore/qfloat16.h>
+#include <QtEndian>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QDebug>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -52,6 +68,20 @@
 using namespace REALTIMELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+const qint64 RETRANSMISSION_TIMEOUT_MS = 100;  /**< Time to wait for lost multicast datagrams before a raw buffer is skipped. */
+const qint32 MAX_RETRANSMISSION = 1024;        /**< Larger gaps are not requested, the server does not serve them. */
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -60,7 +90,25 @@ using namespace REALTIMELIB;
 RtDataClient::RtDataClient(QObject *parent)
 : QTcpSocket(parent)
 , m_clientID(-1)
+, m_iReadPos(0)
+, m_iScanPos(0)
+, m_iTagHead(0)
+, m_pMulticastSocket(Q_NULLPTR)
+, m_gapPolicy(RequestRetransmission)
+, m_bMulticastStarted(false)
+, m_uiNextSequence(0)
+, m_uiNextBufferId(0)
 {
+    m_multicastStatistics.iBuffers = 0;
+    m_multicastStatistics.iGaps = 0;
+    m_multicastStatistics.iRequested = 0;
+    m_multicastStatistics.iSkipped = 0;
+    m_multicastTimer.start();
+
+    m_qTimerShmemPoll.setTimerType(Qt::PreciseTimer);
+    connect(&m_qTimerShmemPoll, &QTimer::timeout,
+            this, &RtDataClient::onShmemPoll);
+
     getClientId();
 }
 
@@ -372,7 +420,27 @@ void RtDataClient::readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t&
 
     kind = t_pTag->kind;
 
-    if(kind == FIFF_DATA_BUFFER)
+    if(kind == FIFF_DATA_BUFFER && t_pTag->getType() == FIFFT_BYTE)
+    {
+        //Quantized and compressed samples, see setSampleEncoding
+        if(!RtRawCodec::decode(reinterpret_cast<const uchar*>(t_pTag->data()), t_pTag->size(), data))
+            qWarning() << "RtDataClient::readRawBuffer - Malformed compressed raw buffer.";
+    }
+    else if(kind == FIFF_DATA_BUFFER && t_pTag->getType() == FIFFT_SHORT)
+    {
+        //Half precision samples, see setHalfPrecision
+        qint32 nSamples = (t_pTag->size()/2)/p_nChannels;
+        const qint16* t_pHalf = t_pTag->toShort();
+
+        data.resize(p_nChannels, nSamples);
+        for(qint32 i = 0; i < p_nChannels*nSamples; ++i)
+        {
+            qfloat16 t_half;
+            memcpy(&t_half, &t_pHalf[i], sizeof(qint16));
+            data.data()[i] = t_half;
+        }
+    }
+    else if(kind == FIFF_DATA_BUFFER)
     {
         qint32 nSamples = (t_pTag->size()/4)/p_nChannels;
         data = MatrixXf(Map< MatrixXf >(t_pTag->toFloat(), p_nChannels, nSamples));
@@ -382,6 +450,215 @@ void RtDataClient::readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t&
 }
 
 
+//*************************************************************************************************************
+
+void RtDataClient::startReceiving(qint32 p_iBufferSize)
+{
+    //A reserved capacity is kept when the buffer is rewound
+    m_qReceiveBuffer.resize(0);
+    m_qReceiveBuffer.reserve(p_iBufferSize);
+    m_iReadPos = 0;
+    m_iScanPos = 0;
+    m_qVecTagTimestamps.resize(0);
+    m_iTagHead = 0;
+
+    if(m_pMulticastSocket)
+    {
+        connect(m_pMulticastSocket, &QUdpSocket::readyRead,
+                this, &RtDataClient::onMulticastReadyRead, Qt::UniqueConnection);
+        onMulticastReadyRead();
+        return;
+    }
+
+    if(m_pShmemRing)
+    {
+        m_qTimerShmemPoll.start(1);
+        onShmemPoll();
+        return;
+    }
+
+    connect(this, &QTcpSocket::readyRead,
+            this, &RtDataClient::onReadyRead, Qt::UniqueConnection);
+
+    //Bytes which arrived before are not announced by readyRead again
+    onReadyRead();
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::stopReceiving()
+{
+    m_qTimerShmemPoll.stop();
+
+    if(m_pMulticastSocket)
+        disconnect(m_pMulticastSocket, &QUdpSocket::readyRead,
+                   this, &RtDataClient::onMulticastReadyRead);
+
+    disconnect(this, &QTcpSocket::readyRead,
+               this, &RtDataClient::onReadyRead);
+
+    m_qReceiveBuffer.resize(0);
+    m_iReadPos = 0;
+    m_iScanPos = 0;
+    m_qVecTagTimestamps.resize(0);
+    m_iTagHead = 0;
+}
+
+
+//*************************************************************************************************************
+
+bool RtDataClient::readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t& kind, qint64& iTimestamp)
+{
+    if(m_iReadPos >= m_iScanPos)
+        return false;
+
+    //Parse the tag in place, the 16 byte header is kind, type, size and next in big endian byte order
+    const uchar* t_pTag = reinterpret_cast<const uchar*>(m_qReceiveBuffer.constData()) + m_iReadPos;
+    kind = qFromBigEndian<qint32>(t_pTag);
+    qint32 t_iType = qFromBigEndian<qint32>(t_pTag + 4);
+    qint32 t_iSize = qFromBigEndian<qint32>(t_pTag + 8);
+    const uchar* t_pData = t_pTag + 16;
+
+    iTimestamp = m_qVecTagTimestamps[m_iTagHead++];
+    m_iReadPos += 16 + t_iSize;
+
+    if(kind == FIFF_DATA_BUFFER && p_nChannels > 0)
+    {
+        if(t_iType == FIFFT_BYTE)
+        {
+            //Quantized and compressed samples, see setSampleEncoding
+            if(!RtRawCodec::decode(t_pData, t_iSize, data))
+                qWarning() << "RtDataClient::readRawBuffer - Malformed compressed raw buffer.";
+        }
+        else if(t_iType == FIFFT_SHORT)
+        {
+            //Half precision samples, see setHalfPrecision
+            qint32 nSamples = (t_iSize/2)/p_nChannels;
+            if(data.rows() != p_nChannels || data.cols() != nSamples)
+                data.resize(p_nChannels, nSamples);
+
+            for(qint32 i = 0; i < p_nChannels*nSamples; ++i)
+            {
+                quint16 t_bits = qFromBigEndian<quint16>(t_pData + 2*i);
+                qfloat16 t_half;
+                memcpy(&t_half, &t_bits, sizeof(quint16));
+                data.data()[i] = t_half;
+            }
+        }
+        else
+        {
+            qint32 nSamples = (t_iSize/4)/p_nChannels;
+            if(data.rows() != p_nChannels || data.cols() != nSamples)
+                data.resize(p_nChannels, nSamples);
+
+            for(qint32 i = 0; i < p_nChannels*nSamples; ++i)
+            {
+                quint32 t_bits = qFromBigEndian<quint32>(t_pData + 4*i);
+                memcpy(&data.data()[i], &t_bits, sizeof(float));
+            }
+        }
+    }
+
+    //Rewind once everything was read
+    if(m_iReadPos == m_qReceiveBuffer.size())
+    {
+        m_qReceiveBuffer.resize(0);
+        m_iReadPos = 0;
+        m_iScanPos = 0;
+        m_qVecTagTimestamps.resize(0);
+        m_iTagHead = 0;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::onReadyRead()
+{
+    qint64 t_iAvailable = this->bytesAvailable();
+    if(t_iAvailable <= 0)
+        return;
+
+    qint64 t_iTimestamp = QDateTime::currentMSecsSinceEpoch();
+
+    compactReceiveBuffer();
+
+    qint32 t_iSize = m_qReceiveBuffer.size();
+    m_qReceiveBuffer.resize(t_iSize + t_iAvailable);
+    qint64 t_iRead = this->read(m_qReceiveBuffer.data() + t_iSize, t_iAvailable);
+    m_qReceiveBuffer.resize(t_iSize + qMax<qint64>(t_iRead, 0));
+
+    scanReceivedTags(t_iTimestamp);
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::onShmemPoll()
+{
+    if(!m_pShmemRing)
+        return;
+
+    qint64 t_iTimestamp = QDateTime::currentMSecsSinceEpoch();
+
+    //The server writes whole tags, the ring never holds a partial one
+    compactReceiveBuffer();
+
+    if(m_pShmemRing->read(m_qReceiveBuffer) > 0)
+        scanReceivedTags(t_iTimestamp);
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::compactReceiveBuffer()
+{
+    if(m_iReadPos > 0)
+    {
+        m_qReceiveBuffer.remove(0, m_iReadPos);
+        m_iScanPos -= m_iReadPos;
+        m_iReadPos = 0;
+        m_qVecTagTimestamps.remove(0, m_iTagHead);
+        m_iTagHead = 0;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::scanReceivedTags(qint64 p_iTimestamp)
+{
+    //Time stamp all tags which are complete now
+    bool t_bNewTags = false;
+    while(m_qReceiveBuffer.size() - m_iScanPos >= 16)
+    {
+        qint32 t_iTagSize = qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(m_qReceiveBuffer.constData()) + m_iScanPos + 8);
+
+        if(t_iTagSize < 0)
+        {
+            qWarning() << "RtDataClient::scanReceivedTags - Corrupt tag received, dropping the receive buffer.";
+            m_qReceiveBuffer.resize(0);
+            m_iScanPos = 0;
+            m_qVecTagTimestamps.resize(0);
+            return;
+        }
+
+        if(m_qReceiveBuffer.size() - m_iScanPos < 16 + t_iTagSize)
+            break;
+
+        m_iScanPos += 16 + t_iTagSize;
+        m_qVecTagTimestamps.append(p_iTimestamp);
+        t_bNewTags = true;
+    }
+
+    if(t_bNewTags)
+        emit rawBufferAvailable();
+}
+
+
 //*************************************************************************************************************
 
 void RtDataClient::setClientAlias(const QString &p_sAlias)
@@ -390,3 +667,268 @@ void RtDataClient::setClientAlias(const QString &p_sAlias)
     t_fiffStream.write_rt_command(2, p_sAlias);//MNE_RT.MNE_RT_SET_CLIENT_ALIAS, alias);
     this->flush();
 }
+
+
+//*************************************************************************************************************
+
+void RtDataClient::setChannelSubscription(const QStringList &p_qListChannels)
+{
+    FiffStream t_fiffStream(this);
+    t_fiffStream.write_rt_command(3, p_qListChannels.join(":"));//MNE_RT.MNE_RT_SET_CLIENT_CHANNELS, channels);
+    this->flush();
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::setDecimation(qint32 p_iDecimation)
+{
+    FiffStream t_fiffStream(this);
+    t_fiffStream.write_rt_command(4, QString::number(p_iDecimation));//MNE_RT.MNE_RT_SET_CLIENT_DECIMATION, decimation);
+    this->flush();
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::setHalfPrecision(bool p_bHalfPrecision)
+{
+    setSampleEncoding(p_bHalfPrecision ? RtRawCodec::Float16 : RtRawCodec::Float32);
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::setSampleEncoding(RtRawCodec::Encoding p_encoding)
+{
+    FiffStream t_fiffStream(this);
+    t_fiffStream.write_rt_command(5, RtRawCodec::encodingName(p_encoding));//MNE_RT.MNE_RT_SET_CLIENT_ENCODING, encoding);
+    this->flush();
+}
+
+
+//*************************************************************************************************************
+
+bool RtDataClient::setSharedMemoryTransport(bool p_bEnable)
+{
+    leaveMulticastGroup();
+
+    FiffStream t_fiffStream(this);
+    t_fiffStream.write_rt_command(6, p_bEnable ? QString("shmem") : QString("tcp"));//MNE_RT.MNE_RT_SET_CLIENT_TRANSPORT, transport);
+    this->flush();
+
+    m_pShmemRing.clear();
+
+    if(!p_bEnable || getClientId() < 0)
+        return false;
+
+    //The server creates the ring when it handles the command, which takes one cycle of its client loop
+    RtShmemRing::SPtr t_pShmemRing(new RtShmemRing(RtShmemRing::clientKey(m_clientID)));
+
+    QElapsedTimer t_timer;
+    t_timer.start();
+    while(!t_pShmemRing->attach())
+    {
+        if(t_timer.elapsed() > 1000)
+        {
+            qWarning() << "RtDataClient::setSharedMemoryTransport - Could not attach to the shared memory ring, is the server running on this host?";
+            t_fiffStream.write_rt_command(6, QString("tcp"));//MNE_RT.MNE_RT_SET_CLIENT_TRANSPORT, transport);
+            this->flush();
+            return false;
+        }
+        QThread::msleep(10);
+    }
+
+    m_pShmemRing = t_pShmemRing;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RtDataClient::joinMulticastGroup(const QHostAddress& p_group, quint16 p_iPort, GapPolicy p_policy)
+{
+    leaveMulticastGroup();
+
+    m_pMulticastSocket = new QUdpSocket(this);
+    if(!m_pMulticastSocket->bind(QHostAddress::AnyIPv4, p_iPort, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)
+            || !m_pMulticastSocket->joinMulticastGroup(p_group))
+    {
+        qWarning() << "RtDataClient::joinMulticastGroup - Could not join" << p_group.toString() << p_iPort << m_pMulticastSocket->errorString();
+        delete m_pMulticastSocket;
+        m_pMulticastSocket = Q_NULLPTR;
+        return false;
+    }
+
+    //A raw buffer arrives as a burst of datagrams
+    m_pMulticastSocket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 4*1024*1024);
+
+    m_multicastGroup = p_group;
+    m_gapPolicy = p_policy;
+    m_bMulticastStarted = false;
+    m_qMapMulticastBuffers.clear();
+    m_multicastStatistics.iBuffers = 0;
+    m_multicastStatistics.iGaps = 0;
+    m_multicastStatistics.iRequested = 0;
+    m_multicastStatistics.iSkipped = 0;
+
+    m_pShmemRing.clear();
+
+    FiffStream t_fiffStream(this);
+    t_fiffStream.write_rt_command(6, QString("multicast"));//MNE_RT.MNE_RT_SET_CLIENT_TRANSPORT, transport);
+    this->flush();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::leaveMulticastGroup()
+{
+    if(!m_pMulticastSocket)
+        return;
+
+    disconnect(m_pMulticastSocket, &QUdpSocket::readyRead,
+               this, &RtDataClient::onMulticastReadyRead);
+    m_pMulticastSocket->leaveMulticastGroup(m_multicastGroup);
+    delete m_pMulticastSocket;
+    m_pMulticastSocket = Q_NULLPTR;
+    m_qMapMulticastBuffers.clear();
+
+    FiffStream t_fiffStream(this);
+    t_fiffStream.write_rt_command(6, QString("tcp"));//MNE_RT.MNE_RT_SET_CLIENT_TRANSPORT, transport);
+    this->flush();
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::onMulticastReadyRead()
+{
+    qint64 t_iTimestamp = QDateTime::currentMSecsSinceEpoch();
+
+    while(m_pMulticastSocket->hasPendingDatagrams())
+    {
+        qint64 t_iSize = m_pMulticastSocket->pendingDatagramSize();
+        if(t_iSize < 0)
+            break;
+
+        if(m_qDatagram.size() < t_iSize)
+            m_qDatagram.resize(t_iSize);
+        qint64 t_iRead = m_pMulticastSocket->readDatagram(m_qDatagram.data(), t_iSize);
+
+        RtMulticastFragment t_fragment;
+        if(!t_fragment.read(m_qDatagram.constData(), t_iRead))
+            continue;
+
+        //
+        // Detect gaps in the datagram sequence, retransmitted datagrams are older than the expected one
+        //
+        if(!m_bMulticastStarted)
+        {
+            //A raw buffer which was joined in the middle can not be completed
+            m_bMulticastStarted = true;
+            m_uiNextSequence = t_fragment.uiSequence + 1;
+            m_uiNextBufferId = t_fragment.uiFragment == 0 ? t_fragment.uiBufferId : t_fragment.uiBufferId + 1;
+        }
+        else
+        {
+            qint32 t_iGap = (qint32)(t_fragment.uiSequence - m_uiNextSequence);
+            if(t_iGap > 0)
+            {
+                ++m_multicastStatistics.iGaps;
+                if(m_gapPolicy == RequestRetransmission && t_iGap <= MAX_RETRANSMISSION)
+                {
+                    FiffStream t_fiffStream(this);
+                    t_fiffStream.write_rt_command(7, QString("%1:%2").arg(m_uiNextSequence).arg(t_fragment.uiSequence - 1));//MNE_RT.MNE_RT_REQUEST_RETRANSMISSION, range);
+                    this->flush();
+                    m_multicastStatistics.iRequested += t_iGap;
+                }
+            }
+            if(t_iGap >= 0)
+                m_uiNextSequence = t_fragment.uiSequence + 1;
+        }
+
+        //
+        // Reassemble, fragments of delivered or skipped raw buffers are late
+        //
+        if((qint32)(t_fragment.uiBufferId - m_uiNextBufferId) < 0)
+            continue;
+
+        MulticastBuffer& t_buffer = m_qMapMulticastBuffers[t_fragment.uiBufferId];
+        if(t_buffer.qVecReceived.isEmpty())
+        {
+            t_buffer.blockData.resize(t_fragment.uiBufferSize);
+            t_buffer.qVecReceived.fill(false, t_fragment.uiNumFragments);
+            t_buffer.iMissing = t_fragment.uiNumFragments;
+            t_buffer.iFirstMs = m_multicastTimer.elapsed();
+        }
+        else if(t_buffer.blockData.size() != (qint32)t_fragment.uiBufferSize)
+        {
+            continue;
+        }
+
+        if(!t_buffer.qVecReceived[t_fragment.uiFragment])
+        {
+            memcpy(t_buffer.blockData.data() + t_fragment.uiFragment * RtMulticastFragment::MAX_PAYLOAD,
+                   m_qDatagram.constData() + RtMulticastFragment::HEADER_SIZE,
+                   RtMulticastFragment::payloadSize(t_fragment.uiBufferSize, t_fragment.uiFragment));
+            t_buffer.qVecReceived[t_fragment.uiFragment] = true;
+            --t_buffer.iMissing;
+        }
+    }
+
+    deliverMulticastBuffers(t_iTimestamp);
+}
+
+
+//*************************************************************************************************************
+
+void RtDataClient::deliverMulticastBuffers(qint64 p_iTimestamp)
+{
+    bool t_bDelivered = false;
+
+    while(!m_qMapMulticastBuffers.isEmpty())
+    {
+        QMap<quint32, MulticastBuffer>::iterator it = m_qMapMulticastBuffers.begin();
+
+        //Number of raw buffers in front of the first one of which no fragment arrived at all
+        qint32 t_iMissingBuffers = (qint32)(it.key() - m_uiNextBufferId);
+
+        if(t_iMissingBuffers == 0 && it.value().iMissing == 0)
+        {
+            if(!t_bDelivered)
+                compactReceiveBuffer();
+            m_qReceiveBuffer.append(it.value().blockData);
+            t_bDelivered = true;
+
+            ++m_multicastStatistics.iBuffers;
+            ++m_uiNextBufferId;
+            m_qMapMulticastBuffers.erase(it);
+            continue;
+        }
+
+        bool t_bSkip = m_gapPolicy == SkipGaps
+                ? t_iMissingBuffers > 0 || m_qMapMulticastBuffers.size() > 1
+                : m_multicastTimer.elapsed() - it.value().iFirstMs > RETRANSMISSION_TIMEOUT_MS;
+
+        if(!t_bSkip)
+            break;
+
+        if(t_iMissingBuffers > 0)
+        {
+            m_multicastStatistics.iSkipped += t_iMissingBuffers;
+            m_uiNextBufferId = it.key();
+        }
+        else
+        {
+            ++m_multicastStatistics.iSkipped;
+            ++m_uiNextBufferId;
+            m_qMapMulticastBuffers.erase(it);
+        }
+    }
+
+    if(t_bDelivered)
+        scanReceivedTags(p_iTimestamp);
+}
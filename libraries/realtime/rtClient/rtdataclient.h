@@ -44,6 +44,8 @@
 //=============================================================================================================
 
 #include "../realtime_global.h"
+#include "rtshmemring.h"
+#include "rtrawcodec.h"
 
 
 //*************************************************************************************************************
@@ -63,7 +65,14 @@
 
 #include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 #include <QTcpSocket>
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QMap>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -96,6 +105,26 @@ public:
     typedef QSharedPointer<RtDataClient> SPtr;               /**< Shared pointer type for RtDataClient. */
     typedef QSharedPointer<const RtDataClient> ConstSPtr;    /**< Const shared pointer type for RtDataClient. */
 
+    //=========================================================================================================
+    /**
+    * What to do when multicast datagrams were lost.
+    */
+    enum GapPolicy {
+        RequestRetransmission,  /**< Request the lost datagrams from the server, skip the buffer if they do not arrive in time. */
+        SkipGaps                /**< Skip incomplete raw buffers as soon as a later one arrives. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Receive statistics of the multicast stream.
+    */
+    struct MulticastStatistics {
+        qint64 iBuffers;        /**< Number of completely received raw buffers. */
+        qint64 iGaps;           /**< Number of gaps in the datagram sequence. */
+        qint64 iRequested;      /**< Number of datagrams requested again. */
+        qint64 iSkipped;        /**< Number of raw buffers skipped because they were incomplete. */
+    };
+
     //=========================================================================================================
     /**
     * Creates the real-time data client.
@@ -146,6 +175,37 @@ public:
     */
     void readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t& kind);
 
+    //=========================================================================================================
+    /**
+    * Switches to the event driven receive path. Incoming bytes are collected in a reusable receive buffer
+    * whenever the socket is readable and rawBufferAvailable is emitted as soon as complete tags arrived. Call
+    * this after the measurement info was read; the blocking read methods must not be used afterwards. With the
+    * shared memory transport the ring is polled instead of the socket.
+    *
+    * @param[in] p_iBufferSize    Initial capacity of the receive buffer in bytes
+    */
+    void startReceiving(qint32 p_iBufferSize = 1024*1024);
+
+    //=========================================================================================================
+    /**
+    * Leaves the event driven receive path. Tags which were not read yet are discarded.
+    */
+    void stopReceiving();
+
+    //=========================================================================================================
+    /**
+    * Takes the next received tag of the event driven receive path without blocking. Raw data buffers are decoded
+    * into data, which is only reallocated if its size does not match the buffer.
+    *
+    * @param[in] p_nChannels    Number of channels to reshape the received data
+    * @param[in, out] data      The preallocated matrix which receives the data
+    * @param[out] kind          Data kind, data is only written for FIFF_DATA_BUFFER
+    * @param[out] iTimestamp    Time when the tag was completely received, in ms since epoch
+    *
+    * @return true if a tag was taken, false if no complete tag is available
+    */
+    bool readRawBuffer(qint32 p_nChannels, MatrixXf& data, fiff_int_t& kind, qint64& iTimestamp);
+
     //=========================================================================================================
     /**
     * Sets the alias of the data client
@@ -154,15 +214,181 @@ public:
     */
     void setClientAlias(const QString &p_sAlias);
 
+    //=========================================================================================================
+    /**
+    * Subscribes to a subset of the channels. Should be set before the measurement info is requested, which
+    * then only contains the subscribed channels.
+    *
+    * @param[in] p_qListChannels    The names of the channels to receive, empty for all channels
+    */
+    void setChannelSubscription(const QStringList &p_qListChannels);
+
+    //=========================================================================================================
+    /**
+    * Subscribes to a decimated stream. The server applies an anti-alias lowpass before decimating and reports
+    * the decimated sampling frequency in the measurement info.
+    *
+    * @param[in] p_iDecimation    The decimation factor, 1 for the full sampling rate
+    */
+    void setDecimation(qint32 p_iDecimation);
+
+    //=========================================================================================================
+    /**
+    * Selects whether the server sends IEEE half precision samples, halving the bandwidth. readRawBuffer
+    * converts them back to single precision.
+    *
+    * @param[in] p_bHalfPrecision    Whether to receive half precision samples
+    */
+    void setHalfPrecision(bool p_bHalfPrecision);
+
+    //=========================================================================================================
+    /**
+    * Selects the sample encoding of the raw buffers. The quantized encodings round each channel to its
+    * calibration step and compress the differences of successive samples, see RtRawCodec, which typically
+    * reduces the bandwidth by a factor of three to four. readRawBuffer decodes all encodings to single
+    * precision. Without this call the server sends floats.
+    *
+    * @param[in] p_encoding    The sample encoding
+    */
+    void setSampleEncoding(RtRawCodec::Encoding p_encoding);
+
+    //=========================================================================================================
+    /**
+    * Selects whether the server writes the raw data blocks to a shared memory ring instead of the socket, which
+    * avoids the TCP loopback for clients on the same host. The measurement info and the commands stay on the
+    * socket. Only takes effect for the event driven receive path, set it before calling startReceiving.
+    *
+    * @param[in] p_bEnable    Whether to use the shared memory transport
+    *
+    * @return true if the shared memory transport is used
+    */
+    bool setSharedMemoryTransport(bool p_bEnable);
+
+    //=========================================================================================================
+    /**
+    * Receives the raw data buffers from the multicast group the server publishes to instead of the socket. The
+    * measurement info and the commands stay on the socket. Only takes effect for the event driven receive path,
+    * join before calling startReceiving.
+    *
+    * @param[in] p_group        The multicast group
+    * @param[in] p_iPort        The port of the multicast group
+    * @param[in] p_policy       What to do when datagrams were lost
+    *
+    * @return true if the group was joined
+    */
+    bool joinMulticastGroup(const QHostAddress& p_group, quint16 p_iPort, GapPolicy p_policy = RequestRetransmission);
+
+    //=========================================================================================================
+    /**
+    * Leaves the multicast group, the raw data buffers are received from the socket again.
+    */
+    void leaveMulticastGroup();
+
+    //=========================================================================================================
+    /**
+    * Returns the receive statistics of the multicast stream.
+    *
+    * @return the statistics
+    */
+    inline MulticastStatistics getMulticastStatistics() const;
+
 private:
+    //=========================================================================================================
+    /**
+    * Appends the available bytes to the receive buffer and time stamps the tags which are complete now.
+    */
+    void onReadyRead();
+
+    //=========================================================================================================
+    /**
+    * Appends the bytes written to the shared memory ring to the receive buffer and time stamps the new tags.
+    */
+    void onShmemPoll();
+
+    //=========================================================================================================
+    /**
+    * Moves the unread bytes of the receive buffer to its front, keeping the allocated memory.
+    */
+    void compactReceiveBuffer();
+
+    //=========================================================================================================
+    /**
+    * Time stamps the tags which are complete now and emits rawBufferAvailable if there are new ones.
+    *
+    * @param[in] p_iTimestamp    The receive time in ms since epoch
+    */
+    void scanReceivedTags(qint64 p_iTimestamp);
+
+    //=========================================================================================================
+    /**
+    * Reads the pending datagrams of the multicast group, requests lost ones and reassembles the raw buffers.
+    */
+    void onMulticastReadyRead();
+
+    //=========================================================================================================
+    /**
+    * Appends the reassembled raw buffers to the receive buffer in order, and skips incomplete ones according to
+    * the gap policy.
+    *
+    * @param[in] p_iTimestamp    The receive time in ms since epoch
+    */
+    void deliverMulticastBuffers(qint64 p_iTimestamp);
+
+    //=========================================================================================================
+    /**
+    * A raw buffer which is reassembled from multicast datagrams.
+    */
+    struct MulticastBuffer {
+        QByteArray      blockData;      /**< The serialized raw buffer. */
+        QVector<bool>   qVecReceived;   /**< Which fragments were received. */
+        qint32          iMissing;       /**< Number of fragments which did not arrive yet. */
+        qint64          iFirstMs;       /**< Receive time of the first fragment. */
+    };
+
     qint32 m_clientID;  /**< Corresponding client id of the data client at mne_rt_server */
 
+    QByteArray      m_qReceiveBuffer;       /**< Receive buffer of the event driven receive path, its memory is reused. */
+    qint32          m_iReadPos;             /**< Start of the next tag which was not read yet. */
+    qint32          m_iScanPos;             /**< End of the last complete tag in the receive buffer. */
+    QVector<qint64> m_qVecTagTimestamps;    /**< Receive time of the complete tags which were not read yet. */
+    qint32          m_iTagHead;             /**< Index of the time stamp of the next tag. */
+
+    RtShmemRing::SPtr   m_pShmemRing;       /**< Shared memory ring of the raw data blocks, NULL for TCP. */
+    QTimer              m_qTimerShmemPoll;  /**< Polls the shared memory ring, which has no notification. */
+
+    QUdpSocket*                     m_pMulticastSocket;         /**< Socket of the joined multicast group, NULL if not joined. */
+    QHostAddress                    m_multicastGroup;           /**< The joined multicast group. */
+    GapPolicy                       m_gapPolicy;                /**< What to do when datagrams were lost. */
+    QByteArray                      m_qDatagram;                /**< Receive buffer of a datagram, its memory is reused. */
+    bool                            m_bMulticastStarted;        /**< Whether the first datagram arrived. */
+    quint32                         m_uiNextSequence;           /**< Sequence number of the next expected datagram. */
+    quint32                         m_uiNextBufferId;           /**< Number of the next raw buffer to deliver. */
+    QMap<quint32, MulticastBuffer>  m_qMapMulticastBuffers;     /**< Raw buffers which are reassembled. */
+    QElapsedTimer                   m_multicastTimer;           /**< Time base of the retransmission timeout. */
+    MulticastStatistics             m_multicastStatistics;      /**< The receive statistics of the multicast stream. */
+
 signals:
-    
+    //=========================================================================================================
+    /**
+    * Emitted by the event driven receive path when new complete tags are available to readRawBuffer.
+    */
+    void rawBufferAvailable();
+
 public slots:
     
 };
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline RtDataClient::MulticastStatistics RtDataClient::getMulticastStatistics() const
+{
+    return m_multicastStatistics;
+}
+
 } // NAMESPACE
 
 #endif // RTDATACLIENT_H
@@ -0,0 +1,169 @@
+//=============================================================================================================
+/**
+* @file     rtmulticastfragment.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+*
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     declaration of the RtMulticastFragment struct.
+*
+*/
+
+#ifndef RTMULTICASTFRAGMENT_H
+#define RTMULTICASTFRAGMENT_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MNE INCLUDES
+//=============================================================================================================
+
+#include "../realtime_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE REALTIMELIB
+//=============================================================================================================
+
+namespace REALTIMELIB
+{
+
+
+//=============================================================================================================
+/**
+* Header of a datagram of the mne_rt_server multicast stream. A serialized FIFF_DATA_BUFFER tag is split into
+* fragments of at most MAX_PAYLOAD bytes, each datagram carries the header in big endian byte order followed by
+* its part of the tag. The sequence number counts datagrams, so a receiver detects lost fragments from gaps.
+*
+* @brief Datagram header of the multicast raw data stream
+*/
+struct RtMulticastFragment
+{
+    enum {
+        MAGIC = 0x4d4e4d43,         /**< 'MNMC' */
+        HEADER_SIZE = 20,           /**< Size of the header in bytes. */
+        MAX_PAYLOAD = 1400          /**< Maximal payload of a datagram, keeps it below the Ethernet MTU. */
+    };
+
+    quint32 uiSequence;     /**< Sequence number of the datagram. */
+    quint32 uiBufferId;     /**< Number of the raw buffer the fragment belongs to. */
+    quint32 uiBufferSize;   /**< Size of the serialized raw buffer in bytes. */
+    quint16 uiFragment;     /**< Index of the fragment within the raw buffer. */
+    quint16 uiNumFragments; /**< Number of fragments of the raw buffer. */
+
+    //=========================================================================================================
+    /**
+    * Writes the header.
+    *
+    * @param[out] p_pData   HEADER_SIZE bytes to write to
+    */
+    inline void write(char* p_pData) const;
+
+    //=========================================================================================================
+    /**
+    * Reads and validates the header of a datagram.
+    *
+    * @param[in] p_pData    The datagram
+    * @param[in] p_iSize    The size of the datagram in bytes
+    *
+    * @return true if the datagram is a valid fragment
+    */
+    inline bool read(const char* p_pData, qint64 p_iSize);
+
+    //=========================================================================================================
+    /**
+    * Returns the payload size of a fragment.
+    *
+    * @param[in] p_uiBufferSize    The size of the serialized raw buffer
+    * @param[in] p_uiFragment      The index of the fragment
+    *
+    * @return the payload size in bytes
+    */
+    static inline qint32 payloadSize(quint32 p_uiBufferSize, quint16 p_uiFragment);
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline void RtMulticastFragment::write(char* p_pData) const
+{
+    uchar* t_pData = reinterpret_cast<uchar*>(p_pData);
+    qToBigEndian<quint32>(MAGIC, t_pData);
+    qToBigEndian<quint32>(uiSequence, t_pData + 4);
+    qToBigEndian<quint32>(uiBufferId, t_pData + 8);
+    qToBigEndian<quint32>(uiBufferSize, t_pData + 12);
+    qToBigEndian<quint16>(uiFragment, t_pData + 16);
+    qToBigEndian<quint16>(uiNumFragments, t_pData + 18);
+}
+
+
+//*************************************************************************************************************
+
+inline bool RtMulticastFragment::read(const char* p_pData, qint64 p_iSize)
+{
+    if(p_iSize < HEADER_SIZE)
+        return false;
+
+    const uchar* t_pData = reinterpret_cast<const uchar*>(p_pData);
+    if(qFromBigEndian<quint32>(t_pData) != MAGIC)
+        return false;
+
+    uiSequence = qFromBigEndian<quint32>(t_pData + 4);
+    uiBufferId = qFromBigEndian<quint32>(t_pData + 8);
+    uiBufferSize = qFromBigEndian<quint32>(t_pData + 12);
+    uiFragment = qFromBigEndian<quint16>(t_pData + 16);
+    uiNumFragments = qFromBigEndian<quint16>(t_pData + 18);
+
+    return uiFragment < uiNumFragments
+            && uiNumFragments == (uiBufferSize + MAX_PAYLOAD - 1) / MAX_PAYLOAD
+            && p_iSize == HEADER_SIZE + payloadSize(uiBufferSize, uiFragment);
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 RtMulticastFragment::payloadSize(quint32 p_uiBufferSize, quint16 p_uiFragment)
+{
+    return qMin<quint32>(MAX_PAYLOAD, p_uiBufferSize - p_uiFragment * (quint32)MAX_PAYLOAD);
+}
+
+} // NAMESPACE
+
+#endif // RTMULTICASTFRAGMENT_H
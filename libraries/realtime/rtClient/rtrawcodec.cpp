@@ -0,0 +1,334 @@
+//=============================================================================================================
+/**
+* @file     rtrawcodec.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+*
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     implementation of the RtRawCodec Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtrawcodec.h"
+
+#include <string.h>
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// LOCAL DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+    const qint32 HEADER_SIZE = 12;          /**< Bits, reserved, rows and columns. */
+    const qint32 CHANNEL_SIZE = 9;          /**< Step, first sample and Rice parameter. */
+    const quint32 RICE_ESCAPE = 24;         /**< Quotients from here on are followed by the raw 32 bit value. */
+
+    inline quint32 zigzag(qint32 v)
+    {
+        return ((quint32)v << 1) ^ (quint32)(v >> 31);
+    }
+
+    inline qint32 unzigzag(quint32 u)
+    {
+        return (qint32)(u >> 1) ^ -(qint32)(u & 1);
+    }
+
+    //Appends bits most significant first
+    class BitWriter
+    {
+    public:
+        BitWriter(QByteArray& p_buffer) : m_buffer(p_buffer), m_iAcc(0), m_iBits(0) {}
+
+        void write(quint32 p_iValue, qint32 p_iBits)
+        {
+            if(p_iBits == 0)
+                return;
+            m_iAcc = (m_iAcc << p_iBits) | (p_iValue & (quint32)((1ull << p_iBits) - 1));
+            m_iBits += p_iBits;
+            while(m_iBits >= 8) {
+                m_iBits -= 8;
+                m_buffer.append((char)(m_iAcc >> m_iBits));
+            }
+        }
+
+        void writeOnes(quint32 p_iCount)
+        {
+            for(; p_iCount >= 16; p_iCount -= 16)
+                write(0xffff, 16);
+            write((1u << p_iCount) - 1, p_iCount);
+        }
+
+        void flush()
+        {
+            if(m_iBits > 0)
+                m_buffer.append((char)(m_iAcc << (8 - m_iBits)));
+            m_iBits = 0;
+        }
+
+    private:
+        QByteArray& m_buffer;
+        quint64     m_iAcc;
+        qint32      m_iBits;
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uchar* p_pData, qint32 p_iSize) : m_pData(p_pData), m_iSize(p_iSize), m_iPos(0), m_iAcc(0), m_iBits(0) {}
+
+        bool read(qint32 p_iBits, quint32& p_iValue)
+        {
+            if(p_iBits == 0) {
+                p_iValue = 0;
+                return true;
+            }
+            while(m_iBits < p_iBits) {
+                if(m_iPos >= m_iSize)
+                    return false;
+                m_iAcc = (m_iAcc << 8) | m_pData[m_iPos++];
+                m_iBits += 8;
+            }
+            m_iBits -= p_iBits;
+            p_iValue = (quint32)(m_iAcc >> m_iBits) & (quint32)((1ull << p_iBits) - 1);
+            return true;
+        }
+
+    private:
+        const uchar*    m_pData;
+        qint32          m_iSize;
+        qint32          m_iPos;
+        quint64         m_iAcc;
+        qint32          m_iBits;
+    };
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+QString RtRawCodec::encodingName(Encoding p_encoding)
+{
+    switch(p_encoding) {
+        case Float16:   return QString("float16");
+        case Int16:     return QString("int16");
+        case Int24:     return QString("int24");
+        default:        return QString("float32");
+    }
+}
+
+
+//*************************************************************************************************************
+
+RtRawCodec::Encoding RtRawCodec::encodingFromName(const QString& p_sName)
+{
+    if(p_sName.compare("float16", Qt::CaseInsensitive) == 0)
+        return Float16;
+    if(p_sName.compare("int16", Qt::CaseInsensitive) == 0)
+        return Int16;
+    if(p_sName.compare("int24", Qt::CaseInsensitive) == 0)
+        return Int24;
+    return Float32;
+}
+
+
+//*************************************************************************************************************
+
+qint32 RtRawCodec::quantizationBits(Encoding p_encoding)
+{
+    if(p_encoding == Int16)
+        return 16;
+    if(p_encoding == Int24)
+        return 24;
+    return 0;
+}
+
+
+//*************************************************************************************************************
+
+QByteArray RtRawCodec::encode(const MatrixXf& p_matData, const VectorXf& p_vecLsb, qint32 p_iBits)
+{
+    qint32 t_iRows = p_matData.rows();
+    qint32 t_iCols = p_matData.cols();
+    float t_fMaxQ = (float)((1 << (p_iBits - 1)) - 1);
+
+    QByteArray t_payload;
+    t_payload.reserve(HEADER_SIZE + CHANNEL_SIZE * t_iRows + p_matData.size());
+    t_payload.resize(HEADER_SIZE + CHANNEL_SIZE * t_iRows);
+
+    uchar* t_pHeader = reinterpret_cast<uchar*>(t_payload.data());
+    t_pHeader[0] = (uchar)p_iBits;
+    t_pHeader[1] = t_pHeader[2] = t_pHeader[3] = 0;
+    qToBigEndian<qint32>(t_iRows, t_pHeader + 4);
+    qToBigEndian<qint32>(t_iCols, t_pHeader + 8);
+
+    BitWriter t_writer(t_payload);
+    QVector<quint32> t_vecResiduals(t_iCols > 0 ? t_iCols - 1 : 0);
+
+    for(qint32 i = 0; i < t_iRows; ++i) {
+        //The calibration step, unless the buffer exceeds its range
+        float t_fMaxAbs = t_iCols > 0 ? p_matData.row(i).cwiseAbs().maxCoeff() : 0.0f;
+        float t_fStep = i < p_vecLsb.size() && p_vecLsb[i] > 0.0f ? p_vecLsb[i] : 0.0f;
+        if(t_fMaxAbs > t_fStep * t_fMaxQ)
+            t_fStep = t_fMaxAbs / t_fMaxQ;
+        if(t_fStep <= 0.0f || !std::isfinite(t_fStep))
+            t_fStep = 1.0f;
+
+        float t_fInvStep = 1.0f / t_fStep;
+        qint32 t_iPrevious = t_iCols > 0 ? (qint32)std::lround(qBound(-t_fMaxQ, p_matData(i,0) * t_fInvStep, t_fMaxQ)) : 0;
+        qint32 t_iFirst = t_iPrevious;
+
+        quint64 t_iSum = 0;
+        for(qint32 j = 1; j < t_iCols; ++j) {
+            qint32 t_iValue = (qint32)std::lround(qBound(-t_fMaxQ, p_matData(i,j) * t_fInvStep, t_fMaxQ));
+            t_vecResiduals[j-1] = zigzag(t_iValue - t_iPrevious);
+            t_iSum += t_vecResiduals[j-1];
+            t_iPrevious = t_iValue;
+        }
+
+        //Rice parameter close to log2 of the mean residual
+        quint32 t_iK = 0;
+        quint64 t_iCount = t_vecResiduals.size();
+        while(t_iK < 30 && (t_iCount << (t_iK + 1)) <= t_iSum)
+            ++t_iK;
+
+        uchar* t_pChannel = reinterpret_cast<uchar*>(t_payload.data()) + HEADER_SIZE + CHANNEL_SIZE * i;
+        quint32 t_iStepBits;
+        memcpy(&t_iStepBits, &t_fStep, sizeof(float));
+        qToBigEndian<quint32>(t_iStepBits, t_pChannel);
+        qToBigEndian<qint32>(t_iFirst, t_pChannel + 4);
+        t_pChannel[8] = (uchar)t_iK;
+
+        for(qint32 j = 0; j < t_vecResiduals.size(); ++j) {
+            quint32 t_iQuotient = t_vecResiduals[j] >> t_iK;
+            if(t_iQuotient < RICE_ESCAPE) {
+                t_writer.writeOnes(t_iQuotient);
+                t_writer.write(0, 1);
+                t_writer.write(t_vecResiduals[j], t_iK);
+            } else {
+                t_writer.writeOnes(RICE_ESCAPE);
+                t_writer.write(t_vecResiduals[j], 32);
+            }
+        }
+    }
+
+    t_writer.flush();
+
+    return t_payload;
+}
+
+
+//*************************************************************************************************************
+
+bool RtRawCodec::decode(const uchar* p_pData, qint32 p_iSize, MatrixXf& p_matData)
+{
+    if(p_iSize < HEADER_SIZE)
+        return false;
+
+    qint32 t_iBits = p_pData[0];
+    qint32 t_iRows = qFromBigEndian<qint32>(p_pData + 4);
+    qint32 t_iCols = qFromBigEndian<qint32>(p_pData + 8);
+
+    if((t_iBits != 16 && t_iBits != 24) || t_iRows < 0 || t_iCols < 0 || t_iRows > (p_iSize - HEADER_SIZE) / CHANNEL_SIZE)
+        return false;
+
+    if(p_matData.rows() != t_iRows || p_matData.cols() != t_iCols)
+        p_matData.resize(t_iRows, t_iCols);
+
+    BitReader t_reader(p_pData + HEADER_SIZE + CHANNEL_SIZE * t_iRows, p_iSize - HEADER_SIZE - CHANNEL_SIZE * t_iRows);
+
+    for(qint32 i = 0; i < t_iRows; ++i) {
+        const uchar* t_pChannel = p_pData + HEADER_SIZE + CHANNEL_SIZE * i;
+        quint32 t_iStepBits = qFromBigEndian<quint32>(t_pChannel);
+        float t_fStep;
+        memcpy(&t_fStep, &t_iStepBits, sizeof(float));
+        qint32 t_iValue = qFromBigEndian<qint32>(t_pChannel + 4);
+        qint32 t_iK = t_pChannel[8];
+
+        if(t_iK > 30)
+            return false;
+
+        if(t_iCols > 0)
+            p_matData(i,0) = t_iValue * t_fStep;
+
+        for(qint32 j = 1; j < t_iCols; ++j) {
+            quint32 t_iQuotient = 0;
+            quint32 t_iBit = 1;
+            while(t_iQuotient < RICE_ESCAPE) {
+                if(!t_reader.read(1, t_iBit))
+                    return false;
+                if(!t_iBit)
+                    break;
+                ++t_iQuotient;
+            }
+
+            quint32 t_iResidual;
+            if(t_iQuotient == RICE_ESCAPE) {
+                if(!t_reader.read(32, t_iResidual))
+                    return false;
+            } else {
+                quint32 t_iRemainder;
+                if(!t_reader.read(t_iK, t_iRemainder))
+                    return false;
+                t_iResidual = (t_iQuotient << t_iK) | t_iRemainder;
+            }
+
+            t_iValue += unzigzag(t_iResidual);
+            p_matData(i,j) = t_iValue * t_fStep;
+        }
+    }
+
+    return true;
+}
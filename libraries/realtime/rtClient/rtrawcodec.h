@@ -0,0 +1,157 @@
+//=============================================================================================================
+/**
+* @file     rtrawcodec.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+*
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     declaration of the RtRawCodec Class.
+*
+*/
+
+#ifndef RTRAWCODEC_H
+#define RTRAWCODEC_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MNE INCLUDES
+//=============================================================================================================
+
+#include "../realtime_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QByteArray>
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE REALTIMELIB
+//=============================================================================================================
+
+namespace REALTIMELIB
+{
+
+
+//=============================================================================================================
+/**
+* Compressed sample encoding of the raw buffers streamed by mne_rt_server. Each channel is quantized to a
+* 16 or 24 bit integer grid whose step is the channel's calibration (cal * range), or coarser when the buffer
+* would not fit that range. The first sample of a channel is sent as is, all others as the zigzag coded
+* difference to their predecessor in Golomb-Rice code with a per channel parameter.
+*
+* The payload is sent as FIFF_DATA_BUFFER tag of type FIFFT_BYTE, all fields in big endian byte order:
+* bits (1 byte), 3 reserved bytes, rows and columns (4 bytes each), per channel the step as float, the first
+* sample (4 bytes) and the Rice parameter (1 byte), followed by the bit stream of the differences.
+*
+* @brief Quantizing delta and Rice codec of raw buffers
+*/
+class REALTIMESHARED_EXPORT RtRawCodec
+{
+public:
+    /** Sample encodings a data client can select, see MNE_RT_SET_CLIENT_ENCODING */
+    enum Encoding {
+        Float32,        /**< Single precision floats, the default. */
+        Float16,        /**< IEEE half precision floats. */
+        Int16,          /**< 16 bit quantized, delta and Rice coded. */
+        Int24           /**< 24 bit quantized, delta and Rice coded. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Returns the name of an encoding as it is used by the encoding command.
+    *
+    * @param[in] p_encoding     The encoding.
+    *
+    * @return the name, i.e. "float32", "float16", "int16" or "int24".
+    */
+    static QString encodingName(Encoding p_encoding);
+
+    //=========================================================================================================
+    /**
+    * Returns the encoding of a name, unknown names select float32 so older clients always get floats.
+    *
+    * @param[in] p_sName    The name of the encoding.
+    *
+    * @return the encoding.
+    */
+    static Encoding encodingFromName(const QString& p_sName);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of quantization bits of an encoding.
+    *
+    * @param[in] p_encoding     The encoding.
+    *
+    * @return 16 or 24 for the quantized encodings, 0 otherwise.
+    */
+    static qint32 quantizationBits(Encoding p_encoding);
+
+    //=========================================================================================================
+    /**
+    * Encodes a raw buffer.
+    *
+    * @param[in] p_matData      The raw buffer, channels x samples.
+    * @param[in] p_vecLsb       The quantization step of each channel, usually cal * range. Channels without a
+    *                           step, or an empty vector, are quantized to the range of the buffer.
+    * @param[in] p_iBits        The number of quantization bits, 16 or 24.
+    *
+    * @return the payload of the FIFF_DATA_BUFFER tag.
+    */
+    static QByteArray encode(const Eigen::MatrixXf& p_matData, const Eigen::VectorXf& p_vecLsb, qint32 p_iBits);
+
+    //=========================================================================================================
+    /**
+    * Decodes a raw buffer. p_matData is only resized when its dimensions differ from the payload.
+    *
+    * @param[in] p_pData        The payload of the FIFF_DATA_BUFFER tag.
+    * @param[in] p_iSize        Size of the payload in bytes.
+    * @param[out] p_matData     The decoded raw buffer, channels x samples.
+    *
+    * @return true if the payload was decoded, false if it is truncated or malformed.
+    */
+    static bool decode(const uchar* p_pData, qint32 p_iSize, Eigen::MatrixXf& p_matData);
+};
+
+} // NAMESPACE
+
+#endif // RTRAWCODEC_H
@@ -0,0 +1,223 @@
+//=============================================================================================================
+/**
+* @file     rtshmemring.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+*
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     definition of the RtShmemRing Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtshmemring.h"
+
+#include <string.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+namespace
+{
+    const quint32 RING_MAGIC = 0x4d52534d;  /**< 'MRSM' */
+}
+
+
+//*************************************************************************************************************
+
+RtShmemRing::RtShmemRing(const QString& p_sKey)
+: m_sharedMemory(p_sKey)
+{
+}
+
+
+//*************************************************************************************************************
+
+QString RtShmemRing::clientKey(qint32 p_iClientId)
+{
+    return QString("mne_rt_server_shmem_%1").arg(p_iClientId);
+}
+
+
+//*************************************************************************************************************
+
+bool RtShmemRing::create(qint32 p_iCapacity)
+{
+    if(p_iCapacity <= 0)
+        return false;
+
+    //On Unix a segment of a crashed process outlives it, attaching and detaching releases it
+    if(m_sharedMemory.attach())
+        m_sharedMemory.detach();
+
+    if(!m_sharedMemory.create(sizeof(Header) + p_iCapacity)) {
+        qWarning() << "RtShmemRing::create - Could not create shared memory segment" << m_sharedMemory.key() << m_sharedMemory.errorString();
+        return false;
+    }
+
+    m_sharedMemory.lock();
+    Header* t_pHeader = static_cast<Header*>(m_sharedMemory.data());
+    t_pHeader->iCapacity = p_iCapacity;
+    t_pHeader->iWritten = 0;
+    t_pHeader->iRead = 0;
+    t_pHeader->iMagic = RING_MAGIC;
+    m_sharedMemory.unlock();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RtShmemRing::attach()
+{
+    if(m_sharedMemory.isAttached())
+        return true;
+
+    if(!m_sharedMemory.attach())
+        return false;
+
+    m_sharedMemory.lock();
+    bool t_bValid = static_cast<const Header*>(m_sharedMemory.constData())->iMagic == RING_MAGIC;
+    m_sharedMemory.unlock();
+
+    if(!t_bValid) {
+        m_sharedMemory.detach();
+        return false;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtShmemRing::detach()
+{
+    if(m_sharedMemory.isAttached())
+        m_sharedMemory.detach();
+}
+
+
+//*************************************************************************************************************
+
+bool RtShmemRing::isAttached() const
+{
+    return m_sharedMemory.isAttached();
+}
+
+
+//*************************************************************************************************************
+
+qint32 RtShmemRing::capacity() const
+{
+    if(!m_sharedMemory.isAttached())
+        return 0;
+
+    return static_cast<const Header*>(m_sharedMemory.constData())->iCapacity;
+}
+
+
+//*************************************************************************************************************
+
+bool RtShmemRing::write(const QByteArray& p_block)
+{
+    if(!m_sharedMemory.isAttached() || !m_sharedMemory.lock())
+        return false;
+
+    Header* t_pHeader = static_cast<Header*>(m_sharedMemory.data());
+    char* t_pData = static_cast<char*>(m_sharedMemory.data()) + sizeof(Header);
+
+    quint64 t_iFree = t_pHeader->iCapacity - (t_pHeader->iWritten - t_pHeader->iRead);
+    if((quint64)p_block.size() > t_iFree) {
+        m_sharedMemory.unlock();
+        return false;
+    }
+
+    //Copy in up to two parts if the block wraps around the end
+    qint32 t_iStart = t_pHeader->iWritten % t_pHeader->iCapacity;
+    qint32 t_iFirst = qMin<qint32>(p_block.size(), t_pHeader->iCapacity - t_iStart);
+    memcpy(t_pData + t_iStart, p_block.constData(), t_iFirst);
+    memcpy(t_pData, p_block.constData() + t_iFirst, p_block.size() - t_iFirst);
+
+    t_pHeader->iWritten += p_block.size();
+
+    m_sharedMemory.unlock();
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+qint32 RtShmemRing::read(QByteArray& p_block)
+{
+    if(!m_sharedMemory.isAttached() || !m_sharedMemory.lock())
+        return 0;
+
+    Header* t_pHeader = static_cast<Header*>(m_sharedMemory.data());
+    const char* t_pData = static_cast<const char*>(m_sharedMemory.constData()) + sizeof(Header);
+
+    qint32 t_iAvailable = t_pHeader->iWritten - t_pHeader->iRead;
+    if(t_iAvailable > 0) {
+        qint32 t_iSize = p_block.size();
+        p_block.resize(t_iSize + t_iAvailable);
+
+        qint32 t_iStart = t_pHeader->iRead % t_pHeader->iCapacity;
+        qint32 t_iFirst = qMin<qint32>(t_iAvailable, t_pHeader->iCapacity - t_iStart);
+        memcpy(p_block.data() + t_iSize, t_pData + t_iStart, t_iFirst);
+        memcpy(p_block.data() + t_iSize + t_iFirst, t_pData, t_iAvailable - t_iFirst);
+
+        t_pHeader->iRead += t_iAvailable;
+    }
+
+    m_sharedMemory.unlock();
+    return t_iAvailable;
+}
@@ -0,0 +1,179 @@
+//=============================================================================================================
+/**
+* @file     rtshmemring.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+*
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief     declaration of the RtShmemRing Class.
+*
+*/
+
+#ifndef RTSHMEMRING_H
+#define RTSHMEMRING_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MNE INCLUDES
+//=============================================================================================================
+
+#include "../realtime_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QSharedMemory>
+#include <QByteArray>
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE REALTIMELIB
+//=============================================================================================================
+
+namespace REALTIMELIB
+{
+
+
+//=============================================================================================================
+/**
+* A byte ring in shared memory with one writing and one reading process. mne_rt_server writes the serialized
+* raw buffer tags of a local client into it instead of the data socket, the client reads them without going
+* through the TCP loopback.
+*
+* @brief Shared memory ring transport for raw buffers
+*/
+class REALTIMESHARED_EXPORT RtShmemRing
+{
+public:
+    typedef QSharedPointer<RtShmemRing> SPtr;               /**< Shared pointer type for RtShmemRing. */
+    typedef QSharedPointer<const RtShmemRing> ConstSPtr;    /**< Const shared pointer type for RtShmemRing. */
+
+    //=========================================================================================================
+    /**
+    * Creates the ring object, the shared memory segment is created or attached separately.
+    *
+    * @param[in] p_sKey    The key of the shared memory segment
+    */
+    explicit RtShmemRing(const QString& p_sKey);
+
+    //=========================================================================================================
+    /**
+    * Returns the key under which the ring of a mne_rt_server data client is created.
+    *
+    * @param[in] p_iClientId    The id of the data client at mne_rt_server
+    *
+    * @return the shared memory key
+    */
+    static QString clientKey(qint32 p_iClientId);
+
+    //=========================================================================================================
+    /**
+    * Creates the shared memory segment, called by the writer.
+    *
+    * @param[in] p_iCapacity    The ring capacity in bytes
+    *
+    * @return true if the segment was created
+    */
+    bool create(qint32 p_iCapacity);
+
+    //=========================================================================================================
+    /**
+    * Attaches to an existing segment, called by the reader.
+    *
+    * @return true if the segment was attached
+    */
+    bool attach();
+
+    //=========================================================================================================
+    /**
+    * Detaches from the segment. The segment is destroyed when the last process detached.
+    */
+    void detach();
+
+    //=========================================================================================================
+    /**
+    * Returns whether the ring is attached to a shared memory segment.
+    *
+    * @return true if attached
+    */
+    bool isAttached() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the capacity of the ring in bytes.
+    *
+    * @return the capacity, 0 if not attached
+    */
+    qint32 capacity() const;
+
+    //=========================================================================================================
+    /**
+    * Writes a block of bytes as a whole.
+    *
+    * @param[in] p_block    The block to write
+    *
+    * @return true if the block was written, false if the ring has not enough room for it right now
+    */
+    bool write(const QByteArray& p_block);
+
+    //=========================================================================================================
+    /**
+    * Appends all bytes which are available to p_block.
+    *
+    * @param[in, out] p_block   The byte array the available bytes are appended to
+    *
+    * @return the number of bytes read
+    */
+    qint32 read(QByteArray& p_block);
+
+private:
+    //=========================================================================================================
+    /**
+    * The header in front of the ring data.
+    */
+    struct Header {
+        quint32 iMagic;         /**< Identifies an initialized ring. */
+        quint32 iCapacity;      /**< Ring capacity in bytes. */
+        quint64 iWritten;       /**< Total number of bytes written. */
+        quint64 iRead;          /**< Total number of bytes read. */
+    };
+
+    QSharedMemory   m_sharedMemory;     /**< The shared memory segment, its lock guards the header. */
+};
+
+
+} // NAMESPACE
+
+#endif // RTSHMEMRING_H
@@ -36,6 +36,7 @@ Command::Command(bool p_bIsJson, QObject *parent)
 , m_sCommand("")
 , m_sDescription("")
 , m_bIsJson(p_bIsJson)
+, m_iRequestId(-1)
 {
 
 }
@@ -46,6 +47,7 @@ Command::Command(bool p_bIsJson, QObject *parent)
 Command::Command(const QString &p_sCommand, const QJsonObject &p_qCommandDescription, bool p_bIsJson, QObject *parent)
 : QObject(parent)
 , m_bIsJson(p_bIsJson)
+, m_iRequestId(-1)
 {
     this->m_sCommand = p_sCommand;
     this->m_sDescription = p_qCommandDescription.value(QString("description")).toString();
@@ -73,6 +75,7 @@ Command::Command(const QString &p_sCommand, const QString &p_sDescription, bool
 , m_sCommand(p_sCommand)
 , m_sDescription(p_sDescription)
 , m_bIsJson(p_bIsJson)
+, m_iRequestId(-1)
 {
 
 }
@@ -86,6 +89,7 @@ Command::Command(   const QString &p_sCommand, const QString &p_sDescription,
 , m_sCommand(p_sCommand)
 , m_sDescription(p_sDescription)
 , m_bIsJson(p_bIsJson)
+, m_iRequestId(-1)
 {
     m_qListParamNames = p_qListParamNames;
     m_qListParamValues = p_qListParamValues;
@@ -103,6 +107,7 @@ Command::Command(   const QString &p_sCommand, const QString &p_sDescription,
 , m_sCommand(p_sCommand)
 , m_sDescription(p_sDescription)
 , m_bIsJson(p_bIsJson)
+, m_iRequestId(-1)
 {
     if(p_qListParamNames.size() == p_qListParamValues.size())
     {
@@ -131,6 +136,7 @@ Command::Command(const Command &p_Command)
 , m_qListParamValues(p_Command.m_qListParamValues)
 , m_qListParamDescriptions(p_Command.m_qListParamDescriptions)
 , m_bIsJson(p_Command.m_bIsJson)
+, m_iRequestId(p_Command.m_iRequestId)
 {
 
 }
@@ -249,6 +255,7 @@ Command& Command::operator= (const Command &rhs)
         m_qListParamNames = rhs.m_qListParamNames;
         m_qListParamValues = rhs.m_qListParamValues;
         m_qListParamDescriptions = rhs.m_qListParamDescriptions;
+        m_iRequestId = rhs.m_iRequestId;
     }
     // to support chained assignment operators (a=b=c), always return *this
     return *this;
@@ -198,6 +198,15 @@ public:
     */
     inline bool& isJson();
 
+    //=========================================================================================================
+    /**
+    * Correlation id of the request which executed this command, the reply is tagged with it. -1 if the request
+    * had no id.
+    *
+    * @return the request id.
+    */
+    inline qint32& requestId();
+
     //=========================================================================================================
     /**
     * Get parameter descriptions
@@ -314,6 +323,7 @@ public:
     QList<QVariant>     m_qListParamValues;
     QStringList         m_qListParamDescriptions;
     bool                m_bIsJson;
+    qint32              m_iRequestId;
 };
 
 //*************************************************************************************************************
@@ -351,6 +361,14 @@ inline bool& Command::isJson()
 }
 
 
+//*************************************************************************************************************
+
+inline qint32& Command::requestId()
+{
+    return m_iRequestId;
+}
+
+
 //*************************************************************************************************************
 
 inline QList<QString> Command::pDescriptions() const
@@ -161,6 +161,7 @@ void CommandManager::update(Subject* p_pSubject)
     if(t_rawCommand.count() >= m_qMapCommands[t_sCommandName].count())
     {
         m_qMapCommands[t_sCommandName].isJson() = t_rawCommand.isJson();
+        m_qMapCommands[t_sCommandName].requestId() = t_rawCommand.requestId();
 
         //Parse Parameters
         for(quint32 i = 0; i < m_qMapCommands[t_sCommandName].count(); ++i)
@@ -67,6 +67,7 @@ using namespace REALTIMELIB;
 
 CommandParser::CommandParser(QObject *parent)
 : QObject(parent)
+, m_iRequestId(-1)
 {
 }
 
@@ -94,6 +95,7 @@ bool CommandParser::parse(const QString &p_sInput, QStringList &p_qListCommandsP
         return false;
 
     p_qListCommandsParsed.clear();
+    m_iRequestId = -1;
 
     //Check if JSON format;
     bool isJson  = false;
@@ -114,6 +116,10 @@ bool CommandParser::parse(const QString &p_sInput, QStringList &p_qListCommandsP
         else
             return false;
 
+        //the optional correlation id of a pipelined request
+        if(t_jsonDocument.object().value(QString("id")).isDouble())
+            m_iRequestId = (qint32)t_jsonDocument.object().value(QString("id")).toDouble();
+
         //iterate over commands
         QJsonObject::Iterator it;
         QJsonObject::Iterator itParam;
@@ -126,6 +132,7 @@ bool CommandParser::parse(const QString &p_sInput, QStringList &p_qListCommandsP
             {
                 RawCommand t_rawCommand(it.key(), true);
                 m_rawCommand = t_rawCommand;
+                m_rawCommand.requestId() = m_iRequestId;
                 t_jsonObjectParameters = it.value().toObject();
 
                 // push command to processed commands
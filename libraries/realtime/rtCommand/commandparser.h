@@ -108,6 +108,15 @@ public:
     */
     inline RawCommand& getRawCommand();
 
+    //=========================================================================================================
+    /**
+    * Returns the correlation id of the last parsed request. Pipelining clients tag each request with an id and
+    * get it back with the reply.
+    *
+    * @return the request id, -1 if the request had none.
+    */
+    inline qint32 getRequestId() const;
+
 
 signals:
     //=========================================================================================================
@@ -121,6 +130,7 @@ signals:
 
 private:
     RawCommand m_rawCommand;
+    qint32 m_iRequestId;        /**< Correlation id of the last parsed request, -1 if it had none. */
 };
 
 //*************************************************************************************************************
@@ -133,6 +143,14 @@ RawCommand& CommandParser::getRawCommand()
     return m_rawCommand;
 }
 
+
+//*************************************************************************************************************
+
+qint32 CommandParser::getRequestId() const
+{
+    return m_iRequestId;
+}
+
 } // NAMESPACE
 
 #endif // COMMANDPARSER_H
@@ -57,6 +57,7 @@ using namespace REALTIMELIB;
 RawCommand::RawCommand(QObject *parent)
 : QObject(parent)
 , m_bIsJson(false)
+, m_iRequestId(-1)
 {
 }
 
@@ -67,6 +68,7 @@ RawCommand::RawCommand(const QString &p_sCommand, bool p_bIsJson, QObject *paren
 : QObject(parent)
 , m_sCommand(p_sCommand)
 , m_bIsJson(p_bIsJson)
+, m_iRequestId(-1)
 {
 }
 
@@ -77,6 +79,7 @@ RawCommand::RawCommand(const RawCommand &p_rawCommand)
 : QObject(p_rawCommand.parent())
 , m_sCommand(p_rawCommand.m_sCommand)
 , m_bIsJson(p_rawCommand.m_bIsJson)
+, m_iRequestId(p_rawCommand.m_iRequestId)
 , m_qListRawParameters(p_rawCommand.m_qListRawParameters)
 {
 
@@ -99,6 +102,7 @@ RawCommand& RawCommand::operator= (const RawCommand &rhs)
     {
         m_sCommand = rhs.m_sCommand;
         m_bIsJson = rhs.m_bIsJson;
+        m_iRequestId = rhs.m_iRequestId;
         m_qListRawParameters = rhs.m_qListRawParameters;
     }
     // to support chained assignment operators (a=b=c), always return *this
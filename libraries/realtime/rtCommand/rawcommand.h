@@ -128,6 +128,14 @@ public:
     */
     inline bool isJson() const;
 
+    //=========================================================================================================
+    /**
+    * Returns the correlation id of the request this command was received with.
+    *
+    * @return the request id, -1 if the request had none.
+    */
+    inline qint32& requestId();
+
     //=========================================================================================================
     /**
     * Returns parameter values
@@ -156,6 +164,7 @@ signals:
 private:
     QString m_sCommand;
     bool m_bIsJson;
+    qint32 m_iRequestId;                    /**< Correlation id of the request, -1 if there is none. */
 
     QList<QString> m_qListRawParameters;    /**< Raw parameters. Their type is not specified jet.*/
 
@@ -188,6 +197,14 @@ bool RawCommand::isJson() const
 }
 
 
+//*************************************************************************************************************
+
+qint32& RawCommand::requestId()
+{
+    return m_iRequestId;
+}
+
+
 //*************************************************************************************************************
 
 QList<QString>& RawCommand::pValues()
@@ -43,8 +43,9 @@
 #include "rtave.h"
 
 #include <utils/ioutils.h>
-#include <utils/detecttrigger.h>
+#include <utils/triggerdetector.h>
 #include <utils/mnemath.h>
+#include <utils/executionconfig.h>
 
 #include <iostream>
 
@@ -78,15 +79,6 @@ using namespace UTILSLIB;
 using namespace Eigen;
 
 
-//*************************************************************************************************************
-//=============================================================================================================
-// DEFINE GLOABAL MEMBER METHODS
-//=============================================================================================================
-
-int             m_dValueVariance = 0.5;           /**< Variance value to detect artifacts */
-double          m_dValueThreshold = 300e-6;          /**< Threshold to detect artifacts */
-
-
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -114,9 +106,11 @@ RtAve::RtAve(quint32 numAverages,
 , m_iNewAverageMode(0)
 , m_bDoBaselineCorrection(false)
 , m_pairBaselineSec(qMakePair(QVariant(QString::number(p_iBaselineFromSecs)),QVariant(QString::number(p_iBaselineToSecs))))
-, m_pStimEvokedSet(FiffEvokedSet::SPtr(new FiffEvokedSet))
 , m_bActivateThreshold(false)
 , m_bActivateVariance(false)
+, m_dValueThreshold(300e-6)
+, m_dValueVariance(0.5)
+, m_iPreStimHistoryIdx(0)
 {
     qRegisterMetaType<FIFFLIB::FiffEvokedSet::SPtr>("FIFFLIB::FiffEvokedSet::SPtr");
 
@@ -217,14 +211,10 @@ void RtAve::setBaselineActive(bool activate)
 
     m_bDoBaselineCorrection = activate;
 
-    if(!m_bDoBaselineCorrection) {
-        for(int i = 0; i < m_pStimEvokedSet->evoked.size(); ++i) {
-            m_pStimEvokedSet->evoked[i].baseline = qMakePair(QVariant("None"), QVariant("None"));
-        }
-    }
-
-    for(int i = 0; i < m_pStimEvokedSet->evoked.size(); ++i) {
-        m_pStimEvokedSet->evoked[i].baseline = m_pairBaselineSec;
+    QMutableMapIterator<double,ConditionAverage> itCondition(m_mapConditions);
+    while(itCondition.hasNext()) {
+        itCondition.next();
+        itCondition.value().evoked.baseline = m_pairBaselineSec;
     }
 }
 
@@ -238,8 +228,10 @@ void RtAve::setBaselineFrom(int fromSamp, int fromMSec)
     m_pairBaselineSec.first = QVariant(QString::number(float(fromMSec)/1000));
     m_pairBaselineSamp.first = QVariant(QString::number(fromSamp));
 
-    for(int i = 0; i < m_pStimEvokedSet->evoked.size(); ++i) {
-        m_pStimEvokedSet->evoked[i].baseline.first = QVariant(QString::number(float(fromMSec)/1000));
+    QMutableMapIterator<double,ConditionAverage> itCondition(m_mapConditions);
+    while(itCondition.hasNext()) {
+        itCondition.next();
+        itCondition.value().evoked.baseline.first = m_pairBaselineSec.first;
     }
 }
 
@@ -253,8 +245,10 @@ void RtAve::setBaselineTo(int toSamp, int toMSec)
     m_pairBaselineSec.second = QVariant(QString::number(float(toMSec)/1000));
     m_pairBaselineSamp.second = QVariant(QString::number(toSamp));
 
-    for(int i = 0; i < m_pStimEvokedSet->evoked.size(); ++i) {
-        m_pStimEvokedSet->evoked[i].baseline.second = QVariant(QString::number(float(toMSec)/1000));
+    QMutableMapIterator<double,ConditionAverage> itCondition(m_mapConditions);
+    while(itCondition.hasNext()) {
+        itCondition.next();
+        itCondition.value().evoked.baseline.second = m_pairBaselineSec.second;
     }
 }
 
@@ -295,6 +289,8 @@ bool RtAve::stop()
 
 void RtAve::run()
 {
+    ExecutionConfig::configureThread("realtime");
+
     //Do initial reset
     reset();
 
@@ -325,346 +321,311 @@ void RtAve::run()
 
 void RtAve::doAveraging(const MatrixXd& rawSegment)
 {
-    //qDebug()<<"";
-    //qDebug()<<"";
-    //qDebug()<<"";
+    //The settings are locked for the whole segment, the conditions only share read access to them
+    QMutexLocker locker(&m_qMutex);
 
-    //Detect trigger
+    //Detect trigger, flanks at the block borders are found once
+    if(m_pTriggerDetector && m_iTriggerChIndex >= 0 && m_iTriggerChIndex < rawSegment.rows()) {
+        m_pTriggerDetector->setThreshold(m_fTriggerThreshold);
+        int iEvents = m_pTriggerDetector->detect(rawSegment);
 
-    //QElapsedTimer time;
-    //time.start();
+        for(int i = 0; i < iEvents; ++i) {
+            const TriggerDetector::Event& event = m_pTriggerDetector->event(i);
 
-    QList<QPair<int,double> > lDetectedTriggers = DetectTrigger::detectTriggerFlanksMax(rawSegment, m_iTriggerChIndex, 0, m_fTriggerThreshold, true);
+            //If number of averages is equals zero do not perform averages
+            int iTriggerPos = m_iNumAverages == 0 ? rawSegment.cols()-1 : int(event.iSample - m_pTriggerDetector->blockStart());
 
-    //qDebug()<<"RtAve::doAveraging() - time for detection"<<time.elapsed();
-    //time.start();
+            m_mapConditions[event.dValue].lTriggerPos.append(iTriggerPos);
+        }
+    }
 
-    for(int i = 0; i < lDetectedTriggers.size(); ++i) {
-        if(!m_mapFillingBackBuffer.contains(lDetectedTriggers.at(i).second)) {
-            double dTriggerType = lDetectedTriggers.at(i).second;
+    //Collect the conditions which have work in this segment, new conditions were inserted above
+    QList<QPair<double, ConditionAverage*> > lConditions;
 
-            //qDebug()<<"Adding dTriggerType"<<dTriggerType;
+    QMutableMapIterator<double,ConditionAverage> itCondition(m_mapConditions);
+    while(itCondition.hasNext()) {
+        itCondition.next();
 
-            m_mapFillingBackBuffer[dTriggerType] = false;
-            m_mapMatDataPostIdx[dTriggerType] = 0;
-            m_mapDataPost[dTriggerType].resize(m_pFiffInfo->chs.size(), m_iPostStimSamples);
-            m_mapDataPost[dTriggerType].setZero();
+        if(itCondition.value().bFillingBackBuffer || !itCondition.value().lTriggerPos.isEmpty()) {
+            lConditions.append(QPair<double, ConditionAverage*>(itCondition.key(), &itCondition.value()));
         }
     }
 
-    //Fill front / pre stim buffer even if no triggers have been located at all yet
-    if(m_mapFillingBackBuffer.isEmpty()) {
-        fillFrontBuffer(rawSegment, -1.0);
+    //Each condition only touches its own running average, so they are averaged concurrently
+    if(lConditions.size() == 1) {
+        processCondition(*lConditions.first().second, lConditions.first().first, rawSegment);
+    } else if(lConditions.size() > 1) {
+        QtConcurrent::blockingMap(lConditions, [this, &rawSegment](QPair<double, ConditionAverage*>& pairCondition) {
+            processCondition(*pairCondition.second, pairCondition.first, rawSegment);
+        });
     }
 
-    //Do averaging for each trigger type
-    QMutableMapIterator<double,bool> idx(m_mapFillingBackBuffer);
-    while(idx.hasNext()) {
-        idx.next();
+    //Hand over the changed conditions only
+    FiffEvokedSet::SPtr pEvokedSet;
 
-        double dTriggerType = idx.key();
+    for(int i = 0; i < lConditions.size(); ++i) {
+        ConditionAverage& condition = *lConditions.at(i).second;
 
-        //qDebug()<<"1 dTriggerType"<<dTriggerType;
+        if(condition.bChanged) {
+            if(!pEvokedSet) {
+                pEvokedSet = FiffEvokedSet::SPtr(new FiffEvokedSet);
+            }
 
-        if(lDetectedTriggers.isEmpty()) {
-            //qDebug()<<"6";
-            //Fill front / pre stim buffer
-            fillFrontBuffer(rawSegment, -1.0);
+            pEvokedSet->evoked.append(condition.evoked);
+            condition.bChanged = false;
         }
+    }
 
-        //Fill back buffer and decide when to do the data packing of the different buffers
-        if(m_mapFillingBackBuffer[dTriggerType]) {
-            //qDebug()<<"2";
-            if(m_mapMatDataPostIdx[dTriggerType] == m_iPostStimSamples) {
-                //qDebug()<<"3";
-                m_mapFillingBackBuffer[dTriggerType] = 0;
+    //Keep the pre stim history for the following triggers
+    fillPreStimHistory(rawSegment);
 
-                //Merge the different buffers
-                mergeData(dTriggerType);
+    locker.unlock();
 
-                //Calculate the final average/evoked data
-                generateEvoked(dTriggerType);
+    if(pEvokedSet) {
+        emit evokedStim(pEvokedSet);
+    }
+}
 
-                //If number of averages was reached emit new average
-                if(m_mapStimAve[dTriggerType].size() > 0) {
-                    emit evokedStim(m_pStimEvokedSet);
-                }
 
-                m_mapFillingBackBuffer[dTriggerType] = false;
+//*************************************************************************************************************
 
-                //qDebug()<<"RtAve::run() - Number of calculated averages:" << m_iNumberCalcAverages[dTriggerType];
-                //qDebug()<<"RtAve::run() - dTriggerType:" << dTriggerType;
-                //qDebug()<<"RtAve::run() - m_mapStimAve[dTriggerType].size():" << m_mapStimAve[dTriggerType].size();
-            } else {
-                //qDebug()<<"4";
-                fillBackBuffer(rawSegment, dTriggerType);
-            }
-        } else {
-            if(lDetectedTriggers.isEmpty()) {
-                //qDebug()<<"6";
-                //Fill front / pre stim buffer
-                fillFrontBuffer(rawSegment, dTriggerType);
-            } else {
-                for(int i = 0; i < lDetectedTriggers.size(); ++i) {
-                    if(dTriggerType == lDetectedTriggers.at(i).second) {
-                        //qDebug()<<"8";
-                        int iTriggerPos = lDetectedTriggers.at(i).first;
-
-                        //If number of averages is equals zero do not perform averages
-                        if(m_iNumAverages == 0) {
-                            iTriggerPos = rawSegment.cols()-1;
-                        }
-
-                        //qDebug()<<"8.1";
-
-                        //Do front buffer stuff
-                        MatrixXd tempMat;
-
-                        if(iTriggerPos >= m_iPreStimSamples) {
-                            tempMat = rawSegment.block(0,iTriggerPos - m_iPreStimSamples,rawSegment.rows(),m_iPreStimSamples);
-                            fillFrontBuffer(tempMat, dTriggerType);
-                        } else {
-                            tempMat = rawSegment.block(0,0,rawSegment.rows(),iTriggerPos);
-                            fillFrontBuffer(tempMat, dTriggerType);
-                        }
-
-                        //qDebug()<<"8.2";
-
-                        //Do back buffer stuff
-                        if(rawSegment.cols() - iTriggerPos >= m_mapDataPost[dTriggerType].cols()) {
-                            m_mapDataPost[dTriggerType] = rawSegment.block(0,iTriggerPos,m_mapDataPost[dTriggerType].rows(),m_mapDataPost[dTriggerType].cols());
-                            m_mapMatDataPostIdx[dTriggerType] = m_iPostStimSamples;
-                        } else {
-                            m_mapDataPost[dTriggerType].block(0,0,m_mapDataPost[dTriggerType].rows(),rawSegment.cols() - iTriggerPos) = rawSegment.block(0,iTriggerPos,rawSegment.rows(),rawSegment.cols() - iTriggerPos);
-                            m_mapMatDataPostIdx[dTriggerType] = rawSegment.cols() - iTriggerPos;
-                        }
-
-                        //qDebug()<<"8.3";
-
-                        m_mapFillingBackBuffer[dTriggerType] = true;
-
-                        //qDebug()<<"Trigger type "<<dTriggerType<<" found at "<<iTriggerPos;
-                    }
-                }
-            }
+void RtAve::processCondition(ConditionAverage& condition, double dTriggerType, const MatrixXd& data)
+{
+    //Continue the epoch which is already started
+    if(condition.bFillingBackBuffer && fillBackBuffer(condition, data, 0)) {
+        finishEpoch(condition, dTriggerType);
+    }
+
+    //Start new epochs, a condition which is still filling its back buffer ignores further triggers
+    for(int i = 0; i < condition.lTriggerPos.size(); ++i) {
+        if(condition.bFillingBackBuffer) {
+            continue;
+        }
+
+        int iTriggerPos = condition.lTriggerPos.at(i);
+
+        startEpoch(condition, data, iTriggerPos);
+
+        if(fillBackBuffer(condition, data, iTriggerPos)) {
+            finishEpoch(condition, dTriggerType);
         }
     }
 
-    //qDebug()<<"RtAve::doAveraging() - time for procesing"<<time.elapsed();
+    condition.lTriggerPos.clear();
 }
 
 
 //*************************************************************************************************************
 
-void RtAve::fillBackBuffer(const MatrixXd &data, double dTriggerType)
+void RtAve::fillPreStimHistory(const MatrixXd &data)
 {
-    QMutexLocker locker(&m_qMutex);
+    if(m_iPreStimSamples <= 0) {
+        return;
+    }
 
-    int iResidualCols = data.cols();
-    if(m_mapMatDataPostIdx[dTriggerType] + data.cols() > m_iPostStimSamples) {
-        iResidualCols = m_iPostStimSamples - m_mapMatDataPostIdx[dTriggerType];
-        m_mapDataPost[dTriggerType].block(0,m_mapMatDataPostIdx[dTriggerType],m_mapDataPost[dTriggerType].rows(),iResidualCols) = data.block(0,0,data.rows(),iResidualCols);
-    } else {
-        m_mapDataPost[dTriggerType].block(0,m_mapMatDataPostIdx[dTriggerType],m_mapDataPost[dTriggerType].rows(),iResidualCols) = data;
+    if(m_matPreStimHistory.rows() != data.rows() || m_matPreStimHistory.cols() != m_iPreStimSamples) {
+        m_matPreStimHistory = MatrixXd::Zero(data.rows(), m_iPreStimSamples);
+        m_iPreStimHistoryIdx = 0;
     }
 
-    m_mapMatDataPostIdx[dTriggerType] += iResidualCols;
+    if(data.cols() >= m_iPreStimSamples) {
+        m_matPreStimHistory = data.rightCols(m_iPreStimSamples);
+        m_iPreStimHistoryIdx = 0;
+        return;
+    }
+
+    //Copy in at most two chunks
+    int iFirst = std::min<int>(data.cols(), m_iPreStimSamples - m_iPreStimHistoryIdx);
+    m_matPreStimHistory.middleCols(m_iPreStimHistoryIdx, iFirst) = data.leftCols(iFirst);
+    if(iFirst < data.cols()) {
+        m_matPreStimHistory.leftCols(data.cols() - iFirst) = data.rightCols(data.cols() - iFirst);
+    }
+
+    m_iPreStimHistoryIdx = (m_iPreStimHistoryIdx + data.cols()) % m_iPreStimSamples;
 }
 
 
 //*************************************************************************************************************
 
-void RtAve::fillFrontBuffer(const MatrixXd &data, double dTriggerType)
+void RtAve::startEpoch(ConditionAverage& condition, const MatrixXd &data, int iTriggerPos) const
 {
-    QMutexLocker locker(&m_qMutex);
+    MatrixXd& matEpoch = condition.matEpoch;
+    if(matEpoch.rows() != data.rows() || matEpoch.cols() != m_iPreStimSamples + m_iPostStimSamples) {
+        matEpoch.resize(data.rows(), m_iPreStimSamples + m_iPostStimSamples);
+    }
 
-    //Init m_mapDataPre
-    if(!m_mapDataPre.contains(dTriggerType)) {
-        if(dTriggerType != -1.0) {
-            m_mapDataPre[dTriggerType] = m_mapDataPre[-1.0];
+    //The newest pre stim samples are part of the current data segment, the older ones come from the history
+    int iFromData = std::min<int>(iTriggerPos, m_iPreStimSamples);
+    int iFromHistory = m_iPreStimSamples - iFromData;
+
+    if(iFromHistory > 0) {
+        if(m_matPreStimHistory.rows() != data.rows() || m_matPreStimHistory.cols() != m_iPreStimSamples) {
+            matEpoch.leftCols(iFromHistory).setZero();
         } else {
-            m_mapDataPre[-1.0].resize(m_pFiffInfo->chs.size(), m_iPreStimSamples);
-            m_mapDataPre[-1.0].setZero();
+            //Newest iFromHistory samples of the ring, starting behind the oldest m_iPreStimSamples - iFromHistory
+            int iStart = (m_iPreStimHistoryIdx + iFromData) % m_iPreStimSamples;
+            int iFirst = std::min<int>(iFromHistory, m_iPreStimSamples - iStart);
+            matEpoch.leftCols(iFirst) = m_matPreStimHistory.middleCols(iStart, iFirst);
+            if(iFirst < iFromHistory) {
+                matEpoch.middleCols(iFirst, iFromHistory - iFirst) = m_matPreStimHistory.leftCols(iFromHistory - iFirst);
+            }
         }
     }
 
-    if(m_mapDataPre[dTriggerType].cols() <= data.cols()) {
-        m_mapDataPre[dTriggerType] = data.block(0,data.cols() - m_iPreStimSamples,data.rows(),m_iPreStimSamples);
-    } else {
-        int residual = m_mapDataPre[dTriggerType].cols() - data.cols();
-
-        //Copy shift data
-        m_mapDataPre[dTriggerType].block(0,0,m_mapDataPre[dTriggerType].rows(),residual) = m_mapDataPre[dTriggerType].block(0,m_mapDataPre[dTriggerType].cols() - residual,m_mapDataPre[dTriggerType].rows(),residual);
-
-        //Copy new data in
-        m_mapDataPre[dTriggerType].block(0,residual,m_mapDataPre[dTriggerType].rows(),data.cols()) = data;
+    if(iFromData > 0) {
+        matEpoch.middleCols(iFromHistory, iFromData) = data.middleCols(iTriggerPos - iFromData, iFromData);
     }
+
+    condition.iPostIdx = 0;
+    condition.bFillingBackBuffer = true;
 }
 
 
 //*************************************************************************************************************
 
-void RtAve::mergeData(double dTriggerType)
+bool RtAve::fillBackBuffer(ConditionAverage& condition, const MatrixXd &data, int iFrom) const
 {
-    QMutexLocker locker(&m_qMutex);
+    int iCols = std::min<int>(data.cols() - iFrom, m_iPostStimSamples - condition.iPostIdx);
 
-    MatrixXd mergedData(m_mapDataPre[dTriggerType].rows(), m_mapDataPre[dTriggerType].cols() + m_mapDataPost[dTriggerType].cols());
+    if(iCols > 0) {
+        condition.matEpoch.middleCols(m_iPreStimSamples + condition.iPostIdx, iCols) = data.middleCols(iFrom, iCols);
+        condition.iPostIdx += iCols;
+    }
 
-    mergedData << m_mapDataPre[dTriggerType], m_mapDataPost[dTriggerType];
+    return condition.iPostIdx == m_iPostStimSamples;
+}
 
-    //Perform artifact threshold
-    bool bArtifactedDetected = checkForArtifact(mergedData);
 
-    if(bArtifactedDetected == false) {
-        //Add cut data to average buffer
-        m_mapStimAve[dTriggerType].append(mergedData);
+//*************************************************************************************************************
 
-        //Pop data from buffer
-        if(m_mapStimAve[dTriggerType].size() > m_iNumAverages && m_iNumAverages >= 1) {
-            m_mapStimAve[dTriggerType].pop_front();
-        }
+void RtAve::finishEpoch(ConditionAverage& condition, double dTriggerType) const
+{
+    condition.bFillingBackBuffer = false;
 
-        //Proceed a bit different if we use zero number of averages
-        if(m_mapStimAve[dTriggerType].size() > 1 && m_iNumAverages == 0) {
-            m_mapStimAve[dTriggerType].pop_front();
-        }
+    if(addEpoch(condition)) {
+        //Calculate the final average/evoked data
+        generateEvoked(condition, dTriggerType);
+
+        condition.bChanged = true;
     }
 }
 
 
 //*************************************************************************************************************
 
-void checkChVariance(QPair<bool, RowVectorXd>& pairData)
+bool RtAve::addEpoch(ConditionAverage& condition) const
 {
-    RowVectorXd temp = pairData.second;
-
-    double dMedian = temp.norm() / temp.cols();
+    MatrixXd& matEpoch = condition.matEpoch;
 
-    temp = temp.array() - dMedian;
-    temp.array().square();
-
-//    qDebug() << "RtAve::checkForArtifact - dMedian" << abs(dMedian);
-//    qDebug() << "RtAve::checkForArtifact - m_iValueVariance * dMedian" << m_iValueVariance * abs(dMedian);
-//    qDebug() << "RtAve::checkForArtifact - compare value " << abs(pairData.second.norm() / pairData.second.cols());
+    //Perform artifact threshold
+    if(checkForArtifact(matEpoch, condition.arena)) {
+        return false;
+    }
 
-    //If variance is 3 times bigger than median -> reject
-    if(temp.norm() / temp.cols() > (m_dValueVariance * std::fabs(dMedian))) {
-        pairData.first = true;
+    if(condition.iCount == 0) {
+        condition.matSum = matEpoch;
     } else {
-        pairData.first = false;
+        condition.matSum += matEpoch;
     }
-}
+    condition.iCount++;
 
+    if(m_iAverageMode == 0) {
+        //Keep the epoch to remove it from the sum later on, its storage is handed over instead of copied
+        QList<MatrixXd>& lEpochs = condition.lEpochs;
+        lEpochs.append(MatrixXd());
+        lEpochs.last().swap(matEpoch);
 
+        //Proceed a bit different if we use zero number of averages
+        int iMaxAverages = m_iNumAverages >= 1 ? m_iNumAverages : 1;
 
-//*************************************************************************************************************
+        if(lEpochs.size() > iMaxAverages) {
+            condition.matSum -= lEpochs.first();
+            condition.iCount--;
 
-void checkChThreshold(QPair<bool, RowVectorXd>& pairData)
-{
-    RowVectorXd temp = pairData.second;
+            //Reuse the storage of the removed epoch for the next one
+            matEpoch.swap(lEpochs.first());
+            lEpochs.pop_front();
+        }
+    }
 
-    temp = temp.array() - temp(0);
+    return true;
+}
 
-    double min = temp.minCoeff();
-    double max = temp.maxCoeff();
 
-//    qDebug() << "RtAve::checkForArtifact - min" << min;
-//    qDebug() << "RtAve::checkForArtifact - max" << max;
-//    qDebug() << "RtAve::checkForArtifact - m_dValueThreshold" << m_dValueThreshold;
+//*************************************************************************************************************
 
-    //If absolute vaue of min or max if bigger than threshold -> reject
-    if((std::fabs(min) > m_dValueThreshold) || (std::fabs(max) > m_dValueThreshold)) {
-        pairData.first = true;
-    } else {
-        pairData.first = false;
+bool RtAve::checkForArtifact(const MatrixXd& data, BlockArena& arena) const
+{
+    if(!(m_bActivateThreshold || m_bActivateVariance) || data.cols() == 0) {
+        return false;
     }
-}
 
+    //Row wise reductions over the whole epoch, no row is copied and the reductions live on the arena
+    BlockArena::Scope scope(arena);
+    const double dCols = data.cols();
+    const int iRows = int(data.rows());
+    BlockArena::VectorMap vecSquaredNorm = arena.vector(m_bActivateVariance ? iRows : 0);
+    BlockArena::VectorMap vecSum = arena.vector(m_bActivateVariance ? iRows : 0);
+    BlockArena::VectorMap vecMax = arena.vector(m_bActivateThreshold ? iRows : 0);
+    BlockArena::VectorMap vecMin = arena.vector(m_bActivateThreshold ? iRows : 0);
+
+    if(m_bActivateVariance) {
+        vecSquaredNorm = data.rowwise().squaredNorm();
+        vecSum = data.rowwise().sum();
+    }
 
-//*************************************************************************************************************
+    if(m_bActivateThreshold) {
+        vecMax = data.rowwise().maxCoeff();
+        vecMin = data.rowwise().minCoeff();
+    }
 
-bool RtAve::checkForArtifact(MatrixXd& data)
-{
-    bool bReject = false;
-
-    if(m_bActivateThreshold || m_bActivateVariance) {
-        //Prepare concurrent data handling
-        QList<QPair<bool, RowVectorXd> > lchData;
-
-        for(int i = 0; i < m_pFiffInfo->chs.size(); ++i) {
-            if((m_pFiffInfo->chs.at(i).kind == FIFFV_MEG_CH || m_pFiffInfo->chs.at(i).kind == FIFFV_EEG_CH)
-                    && !m_pFiffInfo->bads.contains(m_pFiffInfo->chs.at(i).ch_name) && m_pFiffInfo->chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_REF_MAG
-                    && m_pFiffInfo->chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_REF_MAG2) {
-                QPair<bool, RowVectorXd> pair;
-                pair.first = false;
-                pair.second = data.row(i);
-                lchData.append(pair);
-            }
-        }
+    for(int i = 0; i < m_pFiffInfo->chs.size() && i < data.rows(); ++i) {
+        const FiffChInfo& chInfo = m_pFiffInfo->chs.at(i);
 
-        //qDebug() << "RtAve::checkForArtifact - lchData.size()" << lchData.size();
+        if((chInfo.kind != FIFFV_MEG_CH && chInfo.kind != FIFFV_EEG_CH)
+                || chInfo.chpos.coil_type == FIFFV_COIL_BABY_REF_MAG
+                || chInfo.chpos.coil_type == FIFFV_COIL_BABY_REF_MAG2
+                || m_pFiffInfo->bads.contains(chInfo.ch_name)) {
+            continue;
+        }
 
         if(m_bActivateVariance) {
-            //Start the concurrent processing
-            QFuture<void> future = QtConcurrent::map(lchData, checkChVariance);
-            future.waitForFinished();
-
-            for(int i = 0; i < lchData.size(); ++i) {
-                if(lchData.at(i).first) {
-                    bReject = true;
-                    qDebug() << "RtAve::checkForArtifact - Reject trial";
-                    break;
-                }
+            //The deviation of the row from dMedian follows from its squared norm and its sum
+            double dMedian = std::sqrt(vecSquaredNorm(i)) / dCols;
+            double dDeviation = std::sqrt(std::max(0.0, vecSquaredNorm(i) - 2.0 * dMedian * vecSum(i) + dCols * dMedian * dMedian)) / dCols;
+
+            //If variance is 3 times bigger than median -> reject
+            if(dDeviation > m_dValueVariance * std::fabs(dMedian)) {
+                qDebug() << "RtAve::checkForArtifact - Reject trial";
+                return true;
             }
         }
 
-        if(m_bActivateThreshold && !bReject) {
-            //Start the concurrent processing
-            QFuture<void> future = QtConcurrent::map(lchData, checkChThreshold);
-            future.waitForFinished();
-
-            for(int i = 0; i < lchData.size(); ++i) {
-                if(lchData.at(i).first) {
-                    bReject = true;
-                    qDebug() << "RtAve::checkForArtifact - Reject trial";
-                    break;
-                }
+        if(m_bActivateThreshold) {
+            //If the largest excursion from the first sample is bigger than threshold -> reject
+            if(vecMax(i) - data(i,0) > m_dValueThreshold || data(i,0) - vecMin(i) > m_dValueThreshold) {
+                qDebug() << "RtAve::checkForArtifact - Reject trial";
+                return true;
             }
         }
     }
 
-    if(bReject) {
-        qDebug() << "RtAve::checkForArtifact - Reject trial";
-    }
-
-    return bReject;
+    return false;
 }
 
 
 //*************************************************************************************************************
 
-void RtAve::generateEvoked(double dTriggerType)
+void RtAve::generateEvoked(ConditionAverage& condition, double dTriggerType) const
 {
-    QMutexLocker locker(&m_qMutex);
-
-    if(m_mapStimAve[dTriggerType].isEmpty()) {
+    if(condition.iCount == 0) {
         return;
     }
 
-    //Init evoked
-    FiffEvoked evoked;    
-    int iEvokedIdx = -1;
+    FiffEvoked& evoked = condition.evoked;
 
-    for(int i = 0; i < m_pStimEvokedSet->evoked.size(); ++i) {
-        if(m_pStimEvokedSet->evoked.at(i).comment == QString::number(dTriggerType)) {
-            evoked = m_pStimEvokedSet->evoked.at(i);
-            iEvokedIdx = i;
-            break;
-        }
-    }
-
-    //If the evoked is not yet present add it here
-    if(iEvokedIdx == -1) {
+    //Init the evoked of a new condition
+    if(evoked.times.size() != m_iPreStimSamples + m_iPostStimSamples) {
         float T = 1.0/m_pFiffInfo->sfreq;
 
         evoked.setInfo(*m_pFiffInfo.data());
@@ -679,50 +640,23 @@ void RtAve::generateEvoked(double dTriggerType)
     }
 
     // Generate final evoked
-    MatrixXd finalAverage = MatrixXd::Zero(m_mapStimAve[dTriggerType].first().rows(), m_iPreStimSamples+m_iPostStimSamples);
-
-    if(m_iAverageMode == 0) {
-        for(int i = 0; i < m_mapStimAve[dTriggerType].size(); ++i) {
-            finalAverage += m_mapStimAve[dTriggerType].at(i);
-        }
-
-        if(m_mapStimAve[dTriggerType].isEmpty()) {
-            finalAverage = finalAverage/1;
-        } else {
-            finalAverage = finalAverage/m_mapStimAve[dTriggerType].size();
-        }
-
-        if(m_bDoBaselineCorrection) {
-            finalAverage = MNEMath::rescale(finalAverage, evoked.times, m_pairBaselineSec, QString("mean"));
-        }
+    evoked.data = condition.matSum / condition.iCount;
 
-        evoked.data = finalAverage;
+    if(m_bDoBaselineCorrection) {
+        qint32 iFirst, iLast;
+        MNEMath::baselineRange(evoked.times, m_pairBaselineSec, iFirst, iLast);
+        MNEMath::rescaleMean(evoked.data, iFirst, iLast);
+    }
 
-        if(m_mapNumberCalcAverages[dTriggerType] < m_iNumAverages) {
-            m_mapNumberCalcAverages[dTriggerType]++;
+    if(m_iAverageMode == 0) {
+        if(condition.iNumberCalcAverages < m_iNumAverages) {
+            condition.iNumberCalcAverages++;
         }
-
-        evoked.nave = m_mapNumberCalcAverages[dTriggerType];
     } else if(m_iAverageMode == 1) {
-        MatrixXd tempMatrix = m_mapStimAve[dTriggerType].last();
-
-        if(m_bDoBaselineCorrection) {
-            tempMatrix = MNEMath::rescale(tempMatrix, evoked.times, m_pairBaselineSec, QString("mean"));
-        }
-
-        evoked += tempMatrix;
-
-        m_mapNumberCalcAverages[dTriggerType]++;
+        condition.iNumberCalcAverages++;
     }
 
-    //Add new data to evoked data set
-    if(iEvokedIdx != -1) {
-        //Evoked data is already present
-        m_pStimEvokedSet->evoked[iEvokedIdx] = evoked;
-    } else {
-        //Evoked data is not present yet
-        m_pStimEvokedSet->evoked.append(evoked);
-    }
+    evoked.nave = condition.iNumberCalcAverages;
 }
 
 
@@ -740,29 +674,19 @@ void RtAve::reset()
     m_iPostStimSamples = m_iNewPostStimSamples;
     m_iTriggerChIndex = m_iNewTriggerIndex;
     m_iAverageMode = m_iNewAverageMode;
+
+    m_pTriggerDetector = TriggerDetector::SPtr(new TriggerDetector(QList<int>() << m_iTriggerChIndex, m_fTriggerThreshold, TriggerDetector::LevelMode, true));
     m_iNumAverages = m_iNewNumAverages;
 
     qDebug()<<"RtAve::reset() - 2";
 
-    //Clear all evoked data information
-    m_pStimEvokedSet->evoked.clear();
+    //Clear all running averages and their evoked data
+    m_mapConditions.clear();
 
     qDebug()<<"RtAve::reset() - 3";
 
-    //Clear all maps
-//    m_mapDataPre.clear();
-//    m_mapDataPost.clear();
-//    m_mapFillingBackBuffer.clear();
-//    m_mapStimAve.clear();
-//    m_mapNumberCalcAverages.clear();
-
-    m_qMapDetectedTrigger.clear();
-    m_mapStimAve.clear();
-    m_mapDataPre.clear();
-    m_mapDataPost.clear();
-    m_mapMatDataPostIdx.clear();
-    m_mapFillingBackBuffer.clear();
-    m_mapNumberCalcAverages.clear();
+    m_matPreStimHistory.resize(0,0);
+    m_iPreStimHistoryIdx = 0;
 
     qDebug()<<"RtAve::reset() - 4";
 
@@ -48,6 +48,8 @@
 #include <fiff/fiff_info.h>
 
 #include <utils/generics/circularmatrixbuffer.h>
+#include <utils/triggerdetector.h>
+#include <utils/blockarena.h>
 
 
 //*************************************************************************************************************
@@ -58,6 +60,7 @@
 #include <QThread>
 #include <QMutex>
 #include <QSharedPointer>
+#include <QMap>
 
 
 //*************************************************************************************************************
@@ -255,6 +258,32 @@ protected:
     virtual void run();
 
 private:
+    /**
+    * The running average of one trigger type. The conditions are independent of each other and are processed
+    * concurrently.
+    */
+    struct ConditionAverage {
+        ConditionAverage()
+        : iCount(0)
+        , iPostIdx(0)
+        , bFillingBackBuffer(false)
+        , iNumberCalcAverages(0)
+        , bChanged(false)
+        {}
+
+        QList<Eigen::MatrixXd>  lEpochs;                /**< The epochs of the current running average. Holds at most m_iNumAverages epochs. */
+        Eigen::MatrixXd         matSum;                 /**< The running sum of the averaged epochs. */
+        qint32                  iCount;                 /**< The number of epochs in the running sum. */
+        Eigen::MatrixXd         matEpoch;               /**< The epoch which is currently assembled. */
+        qint32                  iPostIdx;               /**< Number of post stim samples already copied to the current epoch. */
+        bool                    bFillingBackBuffer;     /**< Whether the back buffer is currently getting filled. */
+        qint32                  iNumberCalcAverages;    /**< The number of currently calculated averages. */
+        FIFFLIB::FiffEvoked     evoked;                 /**< The current evoked data, without samples before the first average. */
+        QList<int>              lTriggerPos;            /**< The triggers of this type in the current data segment. */
+        bool                    bChanged;               /**< Whether the evoked data changed with the current data segment. */
+        UTILSLIB::BlockArena    arena;                  /**< Temporaries of the artifact check, the conditions are processed concurrently. */
+    };
+
     //=========================================================================================================
     /**
     * do the actual averaging here.
@@ -263,37 +292,85 @@ private:
 
     //=========================================================================================================
     /**
-    * Prepends incoming data to front/pre stim buffer.
+    * Continues the epoch and starts the new epochs of one trigger type for the current data segment.
+    *
+    * @param[in] condition      The running average of the trigger type.
+    * @param[in] dTriggerType   The trigger type.
+    * @param[in] data           The data segment.
     */
-    void fillFrontBuffer(const Eigen::MatrixXd& data, double dTriggerType);
+    void processCondition(ConditionAverage& condition, double dTriggerType, const Eigen::MatrixXd& data);
 
     //=========================================================================================================
     /**
-    * Prepends incoming data to back/post stim buffer.
+    * Appends incoming data to the pre stim history ring buffer, which is shared by all trigger types.
+    *
+    * @param[in] data           The data segment.
     */
-    void fillBackBuffer(const Eigen::MatrixXd& data, double dTriggerType);
+    void fillPreStimHistory(const Eigen::MatrixXd& data);
 
     //=========================================================================================================
     /**
-    * Packs the buffers togehter as one and calcualtes the current running average and emits the result if number of averages has been reached.
+    * Starts a new epoch of a trigger type. The pre stim part is taken from the history ring buffer and the
+    * beginning of the data segment.
+    *
+    * @param[in] condition      The running average of the trigger type.
+    * @param[in] data           The data segment holding the trigger.
+    * @param[in] iTriggerPos    The column of the trigger.
     */
-    void mergeData(double dTriggerType);
+    void startEpoch(ConditionAverage& condition, const Eigen::MatrixXd& data, int iTriggerPos) const;
 
     //=========================================================================================================
     /**
-    * Generates the final evoke variable.
+    * Copies incoming data into the post stim part of the current epoch of a trigger type.
+    *
+    * @param[in] condition      The running average of the trigger type.
+    * @param[in] data           The data segment.
+    * @param[in] iFrom          The first column of data to copy.
+    *
+    * @return   Whether the epoch is complete.
     */
-    void generateEvoked(double dTriggerType);
+    bool fillBackBuffer(ConditionAverage& condition, const Eigen::MatrixXd& data, int iFrom) const;
 
     //=========================================================================================================
     /**
-    * Checks the givven matrix for artifacts beyond a threshold value.
+    * Adds the completed epoch to the running sum of its trigger type. In running average mode the oldest epoch
+    * is subtracted once the number of averages has been reached.
+    *
+    * @param[in] condition      The running average of the trigger type.
+    *
+    * @return   Whether the epoch was accepted, i.e. no artifact was detected.
+    */
+    bool addEpoch(ConditionAverage& condition) const;
+
+    //=========================================================================================================
+    /**
+    * Completes the epoch of a trigger type and updates its evoked data.
+    *
+    * @param[in] condition      The running average of the trigger type.
+    * @param[in] dTriggerType   The trigger type.
+    */
+    void finishEpoch(ConditionAverage& condition, double dTriggerType) const;
+
+    //=========================================================================================================
+    /**
+    * Generates the evoked data of a trigger type from its running sum.
+    *
+    * @param[in] condition      The running average of the trigger type.
+    * @param[in] dTriggerType   The trigger type.
+    */
+    void generateEvoked(ConditionAverage& condition, double dTriggerType) const;
+
+    //=========================================================================================================
+    /**
+    * Checks the given epoch for artifacts. All channels are checked at once with row wise reductions, only the
+    * good MEG and EEG channels can reject the epoch.
     *
     * @param[in] data           The data matrix.
+    * @param[in] arena          The arena of the row wise reductions.
     *
-    * @return   Whether a thresold artifact was detected.
+    * @return   Whether an artifact was detected.
     */
-    bool checkForArtifact(Eigen::MatrixXd& data);
+    bool checkForArtifact(const Eigen::MatrixXd& data, UTILSLIB::BlockArena& arena) const;
 
     //=========================================================================================================
     /**
@@ -331,9 +408,12 @@ private:
     qint32                                          m_iNewTriggerIndex;         /**< Old row index of the data matrix which is to be scanned for triggers */
 
     float                                           m_fTriggerThreshold;        /**< Threshold to detect trigger */
+    UTILSLIB::TriggerDetector::SPtr                 m_pTriggerDetector;         /**< Trigger flank detection, carries its state from block to block. */
 
     bool                                            m_bActivateThreshold;       /**< Whether to do threshold artifact reduction or not. */
     bool                                            m_bActivateVariance;        /**< Whether to do variance artifact reduction or not. */
+    double                                          m_dValueThreshold;          /**< Threshold to detect artifacts. */
+    double                                          m_dValueVariance;           /**< Variance value to detect artifacts. */
     bool                                            m_bIsRunning;               /**< Holds if real-time Covariance estimation is running.*/
     bool                                            m_bAutoAspect;              /**< Auto aspect detection on or off. */
     bool                                            m_bDoBaselineCorrection;    /**< Whether to perform baseline correction. */
@@ -342,24 +422,21 @@ private:
     QPair<QVariant,QVariant>                        m_pairBaselineSamp;         /**< Baseline information in samples form where the seconds are seen relative to the trigger, meaning they can also be negative [from to]*/
 
     FIFFLIB::FiffInfo::SPtr                         m_pFiffInfo;                /**< Holds the fiff measurement information. */
-    FIFFLIB::FiffEvokedSet::SPtr                    m_pStimEvokedSet;           /**< Holds the evoked information. */
 
-    QMap<int,QList<int> >                           m_qMapDetectedTrigger;      /**< Detected trigger for each trigger channel. */
-    QMap<double,QList<Eigen::MatrixXd> >            m_mapStimAve;               /**< the current stimulus average buffer. Holds m_iNumAverages vectors */
-    QMap<double,Eigen::MatrixXd>                    m_mapDataPre;               /**< The matrix holding the pre stim data. */
-    QMap<double,Eigen::MatrixXd>                    m_mapDataPost;              /**< The matrix holding the post stim data. */
-    QMap<double,qint32>                             m_mapMatDataPostIdx;        /**< Current index inside of the matrix m_matDataPost */
-    QMap<double,bool>                               m_mapFillingBackBuffer;     /**< Whether the back buffer is currently getting filled. */
-    QMap<double,qint32>                             m_mapNumberCalcAverages;    /**< The number of currently calculated averages for each trigger type. */
+    QMap<double,ConditionAverage>                   m_mapConditions;            /**< The running averages of the trigger types. */
+
+    Eigen::MatrixXd                                 m_matPreStimHistory;        /**< Ring buffer holding the last m_iPreStimSamples samples. */
+    qint32                                          m_iPreStimHistoryIdx;       /**< Column of the oldest sample in m_matPreStimHistory. */
 
     IOBUFFER::CircularMatrixBuffer<double>::SPtr    m_pRawMatrixBuffer;         /**< The Circular Raw Matrix Buffer. */
 
 signals:
     //=========================================================================================================
     /**
-    * Signal which is emitted when new evoked stimulus data are available.
+    * Signal which is emitted when new evoked stimulus data are available. It is emitted once per data segment
+    * and only holds the evoked data of the trigger types which changed with that segment.
     *
-    * @param[out] p_pEvokedStimSet     The evoked stimulus data set
+    * @param[out] p_pEvokedStimSet     The changed evoked stimulus data
     */
     void evokedStim(FIFFLIB::FiffEvokedSet::SPtr p_pEvokedStimSet);
 };
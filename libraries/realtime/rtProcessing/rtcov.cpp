@@ -43,7 +43,9 @@
 #include "rtcov.h"
 
 #include <iostream>
+#include <cmath>
 #include <fiff/fiff_cov.h>
+#include <utils/executionconfig.h>
 
 
 //*************************************************************************************************************
@@ -52,6 +54,7 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QMutexLocker>
 
 
 //*************************************************************************************************************
@@ -74,6 +77,12 @@ RtCov::RtCov(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, QObject *parent)
 , m_iNewMaxSamples(0)
 , m_pFiffInfo(p_pFiffInfo)
 , m_bIsRunning(false)
+, m_estimationMode(BlockEstimation)
+, m_iUpdateInterval(p_iMaxSamples)
+, m_dTimeConstant(p_iMaxSamples)
+, m_bResetEstimate(true)
+, m_dWeight(0.0)
+, m_iSamples(0)
 {
     qRegisterMetaType<FiffCov::SPtr>("FiffCov::SPtr");
 }
@@ -105,10 +114,41 @@ void RtCov::append(const MatrixXd &p_DataSegment)
 
 void RtCov::setSamples(qint32 samples)
 {
+    QMutexLocker locker(&mutex);
     m_iNewMaxSamples = samples;
 }
 
 
+//*************************************************************************************************************
+
+void RtCov::setEstimationMode(EstimationMode mode)
+{
+    QMutexLocker locker(&mutex);
+    if(mode != m_estimationMode) {
+        m_estimationMode = mode;
+        m_bResetEstimate = true;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtCov::setUpdateInterval(qint32 samples)
+{
+    QMutexLocker locker(&mutex);
+    m_iUpdateInterval = samples > 0 ? samples : 1;
+}
+
+
+//*************************************************************************************************************
+
+void RtCov::setTimeConstant(double samples)
+{
+    QMutexLocker locker(&mutex);
+    m_dTimeConstant = samples > 1.0 ? samples : 1.0;
+}
+
+
 //*************************************************************************************************************
 
 bool RtCov::start()
@@ -142,6 +182,8 @@ bool RtCov::stop()
 
 void RtCov::run()
 {
+    UTILSLIB::ExecutionConfig::configureThread("realtime");
+
     //SETUP
     QStringList exclude;
     for(int i = 0; i<m_pFiffInfo->chs.size(); i++) {
@@ -151,10 +193,7 @@ void RtCov::run()
     }
     bool doProj = true;
 
-    quint32 n_samples = 0;
-
-    FiffCov::SPtr cov(new FiffCov());
-    VectorXd mu;
+    quint32 n_samples_since_update = 0;
 
     while(m_bIsRunning)
     {
@@ -162,23 +201,32 @@ void RtCov::run()
         {
             MatrixXd rawSegment = m_pRawMatrixBuffer->pop();
 
-            if(n_samples == 0)
-            {
-                mu = rawSegment.rowwise().sum();
-                cov->data = rawSegment * rawSegment.transpose();
+            mutex.lock();
+            if(m_iNewMaxSamples > 0) {
+                m_iMaxSamples = m_iNewMaxSamples;
+                m_iNewMaxSamples = 0;
             }
-            else
-            {
-                mu.array() += rawSegment.rowwise().sum().array();
-                cov->data += rawSegment * rawSegment.transpose();
+            EstimationMode mode = m_estimationMode;
+            quint32 iUpdateInterval = m_iUpdateInterval;
+            double dDecay = mode == ExponentialEstimation ? std::exp(-1.0 / m_dTimeConstant) : 1.0;
+            if(m_bResetEstimate) {
+                resetEstimate();
+                n_samples_since_update = 0;
+                m_bResetEstimate = false;
             }
-            n_samples += rawSegment.cols();
+            mutex.unlock();
+
+            accumulate(rawSegment, dDecay);
+            n_samples_since_update += rawSegment.cols();
 
-            if(n_samples > m_iMaxSamples)
+            bool bEmit = mode == BlockEstimation ? m_iSamples > m_iMaxSamples : n_samples_since_update >= iUpdateInterval;
+
+            if(bEmit && m_dWeight > 1.0)
             {
-                mu /= (float)n_samples;
-                cov->data.array() -= n_samples * (mu * mu.transpose()).array();
-                cov->data.array() /= (n_samples - 1);
+                FiffCov::SPtr cov(new FiffCov());
+
+                cov->data = m_matM2.selfadjointView<Lower>();
+                cov->data /= (m_dWeight - 1.0);
 
                 cov->kind = FIFFV_MNE_NOISE_COV;
                 cov->diag = false;
@@ -188,29 +236,86 @@ void RtCov::run()
                 cov->names = m_pFiffInfo->ch_names;
                 cov->projs = m_pFiffInfo->projs;
                 cov->bads = m_pFiffInfo->bads;
-                cov->nfree = n_samples;
+                cov->nfree = mode == BlockEstimation ? m_iSamples : (qint32)m_dWeight;
 
                 // regularize noise covariance
                 *cov.data() = cov->regularize(*m_pFiffInfo, 0.05, 0.05, 0.1, doProj, exclude);
 
                 emit covCalculated(cov);
 
-                cov = FiffCov::SPtr(new FiffCov());
-                n_samples = 0;
+                n_samples_since_update = 0;
+
+                if(mode == BlockEstimation)
+                    resetEstimate();
             }
+        }
+    }
+}
 
 
-//            qint32 samples = rawSegment.cols();
-//            VectorXf mu = rawSegment.rowwise().sum().array() / (float)samples;
+//*************************************************************************************************************
 
-//            MatrixXf noise_covariance = rawSegment * rawSegment.transpose();// noise_covariance == raw_covariance
-//            noise_covariance.array() -= samples * (mu * mu.transpose()).array();
-//            noise_covariance.array() /= (samples - 1);
+void RtCov::resetEstimate()
+{
+    m_vecMean.resize(0);
+    m_matM2.resize(0,0);
+    m_dWeight = 0.0;
+    m_iSamples = 0;
+}
 
-//            std::cout << "Noise Covariance:\n" << noise_covariance.block(0,0,10,10) << std::endl;
 
-//            printf("%d raw buffer (%d x %d) generated\r\n", count, tmp.rows(), tmp.cols());
+//*************************************************************************************************************
 
-        }
+void RtCov::accumulate(const MatrixXd &rawSegment, double dDecay)
+{
+    qint32 n = rawSegment.cols();
+    if(n == 0)
+        return;
+
+    if(m_matM2.rows() != rawSegment.rows()) {
+        m_vecMean = VectorXd::Zero(rawSegment.rows());
+        m_matM2 = MatrixXd::Zero(rawSegment.rows(), rawSegment.rows());
+        m_dWeight = 0.0;
+        m_iSamples = 0;
+    }
+
+    //Statistics of the segment, the newest sample has weight 1. The temporaries live on the arena.
+    UTILSLIB::BlockArena::Scope scope(m_arena);
+    double dWeightSegment;
+    UTILSLIB::BlockArena::VectorMap vecMeanSegment = m_arena.vector(rawSegment.rows());
+    UTILSLIB::BlockArena::MatrixMap matCentered = m_arena.matrix(rawSegment.rows(), n);
+
+    if(dDecay == 1.0) {
+        dWeightSegment = n;
+        vecMeanSegment = rawSegment.rowwise().sum() / dWeightSegment;
+        matCentered = rawSegment.colwise() - vecMeanSegment;
+    } else {
+        UTILSLIB::BlockArena::RowVectorMap vecWeights = m_arena.rowVector(n);
+        for(qint32 j = 0; j < n; ++j)
+            vecWeights(j) = std::pow(dDecay, n - 1 - j);
+
+        dWeightSegment = vecWeights.sum();
+        vecMeanSegment.noalias() = rawSegment * vecWeights.transpose();
+        vecMeanSegment /= dWeightSegment;
+        matCentered = (rawSegment.colwise() - vecMeanSegment) * vecWeights.cwiseSqrt().asDiagonal();
     }
+
+    //Decay the previous estimate over the length of the segment
+    double dDecaySegment = std::pow(dDecay, n);
+    double dWeightOld = m_dWeight * dDecaySegment;
+    if(dDecaySegment != 1.0)
+        m_matM2 *= dDecaySegment;
+
+    //Merge both, touching only the lower triangle
+    double dWeight = dWeightOld + dWeightSegment;
+    UTILSLIB::BlockArena::VectorMap vecDelta = m_arena.vector(rawSegment.rows());
+    vecDelta = vecMeanSegment - m_vecMean;
+
+    m_matM2.selfadjointView<Lower>().rankUpdate(matCentered);
+    if(dWeightOld > 0.0)
+        m_matM2.selfadjointView<Lower>().rankUpdate(vecDelta, dWeightOld * dWeightSegment / dWeight);
+
+    m_vecMean += vecDelta * (dWeightSegment / dWeight);
+    m_dWeight = dWeight;
+    m_iSamples += n;
 }
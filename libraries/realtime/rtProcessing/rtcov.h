@@ -59,6 +59,7 @@
 //=============================================================================================================
 
 #include <utils/generics/circularmatrixbuffer.h>
+#include <utils/blockarena.h>
 
 
 //*************************************************************************************************************
@@ -111,6 +112,12 @@ public:
     typedef QSharedPointer<RtCov> SPtr;             /**< Shared pointer type for RtCov. */
     typedef QSharedPointer<const RtCov> ConstSPtr;  /**< Const shared pointer type for RtCov. */
 
+    enum EstimationMode {
+        BlockEstimation,            /**< Estimate from each chunk of p_iMaxSamples samples, then start over. */
+        CumulativeEstimation,       /**< Running estimate over all samples since start. */
+        ExponentialEstimation       /**< Running estimate with exponentially decaying sample weights. */
+    };
+
     //=========================================================================================================
     /**
     * Creates the real-time covariance estimation object.
@@ -151,6 +158,31 @@ public:
     */
     void setSamples(qint32 samples);
 
+    //=========================================================================================================
+    /**
+    * Set the estimation mode. A change resets the running estimate.
+    *
+    * @param[in] mode       how samples contribute to the estimate
+    */
+    void setEstimationMode(EstimationMode mode);
+
+    //=========================================================================================================
+    /**
+    * Set the number of samples between two emitted covariances of the running estimation modes.
+    *
+    * @param[in] samples    update interval in samples
+    */
+    void setUpdateInterval(qint32 samples);
+
+    //=========================================================================================================
+    /**
+    * Set the time constant of the exponential estimation, i.e. the number of samples after which the weight of a
+    * sample dropped to 1/e.
+    *
+    * @param[in] samples    time constant in samples
+    */
+    void setTimeConstant(double samples);
+
     //=========================================================================================================
     /**
     * Starts the RtCov by starting the producer's thread.
@@ -186,6 +218,22 @@ protected:
     virtual void run();
 
 private:
+    //=========================================================================================================
+    /**
+    * Clears the running estimate.
+    */
+    void resetEstimate();
+
+    //=========================================================================================================
+    /**
+    * Merges a data segment into the running estimate (Welford/Chan update). Only the lower triangle of the
+    * outer product sum is updated, by symmetric rank-k updates.
+    *
+    * @param[in] rawSegment     data segment, one row per channel
+    * @param[in] dDecay         weight decay per sample, 1 for equally weighted samples
+    */
+    void accumulate(const MatrixXd &rawSegment, double dDecay);
+
     QMutex      mutex;                  /**< Provides access serialization between threads*/
 
     quint32      m_iMaxSamples;         /**< Maximal amount of samples received, before covariance is estimated.*/
@@ -197,6 +245,18 @@ private:
     bool        m_bIsRunning;           /**< Holds if real-time Covariance estimation is running.*/
 
     CircularMatrixBuffer<double>::SPtr m_pRawMatrixBuffer;   /**< The Circular Raw Matrix Buffer. */
+
+    EstimationMode  m_estimationMode;   /**< The estimation mode. */
+    quint32     m_iUpdateInterval;      /**< Samples between two emitted covariances of the running modes. */
+    double      m_dTimeConstant;        /**< Time constant in samples of the exponential estimation. */
+    bool        m_bResetEstimate;       /**< Set when the running estimate has to be cleared. */
+
+    VectorXd    m_vecMean;              /**< Weighted mean of the accumulated samples. */
+    MatrixXd    m_matM2;                /**< Lower triangle of the weighted sum of centered outer products. */
+    double      m_dWeight;              /**< Sum of the sample weights. */
+    quint32     m_iSamples;             /**< Number of accumulated samples. */
+
+    UTILSLIB::BlockArena m_arena;       /**< Temporaries of accumulate(), sized by the first segment. */
 };
 
 //*************************************************************************************************************
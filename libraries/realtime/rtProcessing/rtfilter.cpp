@@ -40,6 +40,19 @@
 
 #include "rtfilter.h"
 
+#include <utils/tracer.h>
+#include <utils/executionconfig.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <QDebug>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -57,98 +70,352 @@ using namespace FIFFLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
-void doFilterPerChannelRTMSA(QPair<QList<FilterData>,QPair<int,RowVectorXd> > &channelDataTime)
+namespace
 {
-    for(int i = 0; i < channelDataTime.first.size(); ++i) {
-        //channelDataTime.second.second = channelDataTime.first.at(i).applyConvFilter(channelDataTime.second.second, true, FilterData::ZeroPad);
-        channelDataTime.second.second = channelDataTime.first.at(i).applyFFTFilter(channelDataTime.second.second, true, FilterData::ZeroPad); //FFT Convolution for rt is not suitable. FFT make the signal filtering non causal.
-    }
+
+/**
+* Converts an FIR impulse response to the minimum-phase response of the same length and magnitude with the
+* homomorphic (real cepstrum) method. The cepstrum is computed on a 32 times longer FFT to keep its aliasing small.
+*
+* @param[in] vecImpulse     the impulse response.
+*
+* @return the minimum-phase impulse response.
+*/
+RowVectorXd minimumPhase(const RowVectorXd& vecImpulse)
+{
+    const int iLength = vecImpulse.cols();
+    if(iLength < 2)
+        return vecImpulse;
+
+    int iFFTLength = 2;
+    while(iFFTLength < 32 * iLength)
+        iFFTLength *= 2;
+
+    RowVectorXcd vecSpectrum = RowVectorXcd::Zero(iFFTLength);
+    vecSpectrum.head(iLength) = vecImpulse.cast<std::complex<double> >();
+
+    Eigen::FFT<double> fft;
+    RowVectorXcd vecTemp;
+    fft.fwd(vecTemp, vecSpectrum);
+
+    //Log magnitude, the zeros of the stop band are clipped far below the pass band
+    const double dFloor = 1e-7 * vecTemp.cwiseAbs().maxCoeff();
+    for(int k = 0; k < iFFTLength; ++k)
+        vecTemp(k) = std::log(qMax(std::abs(vecTemp(k)), dFloor));
+
+    //Fold the real cepstrum onto the causal part
+    RowVectorXcd vecCepstrum;
+    fft.inv(vecCepstrum, vecTemp);
+    for(int k = 1; k < iFFTLength / 2; ++k)
+        vecCepstrum(k) *= 2.0;
+    vecCepstrum.tail(iFFTLength / 2 - 1).setZero();
+
+    fft.fwd(vecTemp, vecCepstrum);
+    vecTemp = vecTemp.array().exp();
+    fft.inv(vecSpectrum, vecTemp);
+
+    return vecSpectrum.head(iLength).real();
 }
 
+} // NAMESPACE
+
 
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
 
-RtFilter::RtFilter()
+template<typename T>
+RtFilterT<T>::RtFilterT()
+: m_mode(DelayCompensated)
+, m_iNumChannels(0)
+, m_iBlockSize(0)
+, m_iFilterLength(0)
+, m_iDelay(0)
+, m_iFFTLength(0)
 {
+    resetStats();
 }
 
 
 //*************************************************************************************************************
 
-RtFilter::~RtFilter()
+template<typename T>
+RtFilterT<T>::~RtFilterT()
 {
 }
 
 
 //*************************************************************************************************************
 
-MatrixXd RtFilter::filterChannelsConcurrently(const MatrixXd& matDataIn, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<FilterData>& lFilterData)
+template<typename T>
+bool RtFilterT<T>::prepare(const QList<FilterData>& lFilterData, const QVector<int>& lFilterChannelList, int iNumChannels, int iBlockSize, FilterMode mode)
+{
+    m_iNumChannels = 0;
+    m_iBlockSize = 0;
+    m_fftFilterBatch = FFTFilterBatchT<T>();
+
+    if(iNumChannels <= 0 || iBlockSize <= 0) {
+        qWarning() << "RtFilter::prepare - Invalid block dimension" << iNumChannels << "x" << iBlockSize;
+        return false;
+    }
+
+    //
+    // Combine all filters to one impulse response
+    //
+    m_lCoeffs.clear();
+    m_lSections.clear();
+    RowVectorXd vecImpulse = RowVectorXd::Ones(1);
+    MatrixXd matSOS(0, 6);
+    bool bFIR = false;
+    m_iDelay = 0;
+
+    for(int i = 0; i < lFilterData.size(); ++i) {
+        const RowVectorXd& coeffs = lFilterData.at(i).m_dCoeffA;
+        m_lCoeffs.append(coeffs);
+        m_lSections.append(lFilterData.at(i).m_matSOS);
+
+        //IIR filters are cascaded as second-order sections, their nonlinear phase is not compensated
+        if(lFilterData.at(i).isIIR()) {
+            const MatrixXd& sections = lFilterData.at(i).m_matSOS;
+            matSOS.conservativeResize(matSOS.rows() + sections.rows(), 6);
+            matSOS.bottomRows(sections.rows()) = sections;
+            continue;
+        }
+
+        if(coeffs.cols() == 0)
+            continue;
+
+        bFIR = true;
+
+        RowVectorXd vecCombined = RowVectorXd::Zero(vecImpulse.cols() + coeffs.cols() - 1);
+        for(int k = 0; k < coeffs.cols(); ++k)
+            vecCombined.segment(k, vecImpulse.cols()) += coeffs(k) * vecImpulse;
+        vecImpulse = vecCombined;
+
+        m_iDelay += coeffs.cols()/2;
+    }
+
+    m_mode = mode;
+    m_iFilterLength = vecImpulse.cols();
+
+    //The minimum-phase filter starts right away, its small and frequency dependent delay is not compensated
+    if(m_mode == Causal && bFIR) {
+        vecImpulse = minimumPhase(vecImpulse);
+        m_iDelay = 0;
+    }
+
+    //
+    // Split channels into filtered and passed-through ones
+    //
+    m_vecChannelList = lFilterChannelList;
+    m_vecFilterChannels.clear();
+    m_vecPassChannels.clear();
+    for(int i = 0; i < iNumChannels; ++i) {
+        if(lFilterChannelList.contains(i) && !lFilterData.isEmpty())
+            m_vecFilterChannels.append(i);
+        else
+            m_vecPassChannels.append(i);
+    }
+
+    //
+    // Spectrum of the combined impulse response for overlap-save blocks of history plus block size
+    //
+    m_iFFTLength = 1;
+    while(m_iFFTLength < m_iFilterLength - 1 + iBlockSize)
+        m_iFFTLength *= 2;
+    if(m_iFFTLength < 2)
+        m_iFFTLength = 2;
+
+    RowVectorXd vecImpulsePad = RowVectorXd::Zero(m_iFFTLength);
+    vecImpulsePad.head(m_iFilterLength) = vecImpulse;
+
+    Eigen::FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+    fft.fwd(m_vecSpectrum, vecImpulsePad);
+
+    m_matHistory = MatrixXT::Zero(m_vecFilterChannels.size(), m_iFilterLength - 1);
+    m_biquadCascade.setSections(matSOS, m_vecFilterChannels.size());
+    m_matSegment = MatrixXT::Zero(bFIR ? m_vecFilterChannels.size() : 0, m_iFilterLength - 1 + iBlockSize);
+    m_matFilterData = MatrixXT::Zero(m_vecFilterChannels.size(), iBlockSize);
+    m_matDelay = MatrixXT::Zero(iNumChannels, m_mode == DelayCompensated ? m_iDelay : 0);
+    m_vecLine = RowVectorXT::Zero(m_matDelay.cols() + iBlockSize);
+
+    //
+    // One workspace per thread, each owning a contiguous batch of channels
+    //
+    if(bFIR && !m_vecFilterChannels.isEmpty())
+        m_fftFilterBatch.setSpectrum(m_vecSpectrum, m_iFFTLength, qMin(ExecutionConfig::threadCount(), m_vecFilterChannels.size()));
+
+    m_iNumChannels = iNumChannels;
+    m_iBlockSize = iBlockSize;
+
+    resetStats();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+bool RtFilterT<T>::filter(const MatrixXT& matDataIn, MatrixXT& matDataOut)
 {
-    //Initialise the overlay matrix
-    if(m_matOverlap.cols() != iMaxFilterLength || m_matOverlap.rows() < matDataIn.rows()) {
-        m_matOverlap.resize(matDataIn.rows(), iMaxFilterLength);
-        m_matOverlap.setZero();
+    MNE_TRACE_SCOPE("RtFilter::filter", "realtime");
+
+    if(matDataIn.rows() != m_iNumChannels || matDataIn.cols() != m_iBlockSize) {
+        qWarning() << "RtFilter::filter - Block dimension" << matDataIn.rows() << "x" << matDataIn.cols() << "does not match the prepared" << m_iNumChannels << "x" << m_iBlockSize;
+        return false;
     }
 
-    if(m_matDelay.cols() != iMaxFilterLength/2 || m_matOverlap.rows() < matDataIn.rows()) {
-        m_matDelay.resize(matDataIn.rows(), iMaxFilterLength/2);
-        m_matDelay.setZero();
+    QElapsedTimer timer;
+    timer.start();
+
+    matDataOut.resize(matDataIn.rows(), matDataIn.cols());
+
+    //Filtered channels, the first iHistory samples of the circular convolution are corrupted by the wrap, the rest is the linear convolution
+    if(!m_fftFilterBatch.isEmpty()) {
+        int iHistory = m_matHistory.cols();
+
+        m_matSegment.leftCols(iHistory) = m_matHistory;
+        for(int i = 0; i < m_vecFilterChannels.size(); ++i)
+            m_matSegment.row(i).tail(m_iBlockSize) = matDataIn.row(m_vecFilterChannels[i]);
+
+        m_fftFilterBatch.filter(m_matSegment, m_matFilterData, 0, iHistory, m_iBlockSize);
+
+        m_matHistory = m_matSegment.rightCols(iHistory);
+    } else {
+        for(int i = 0; i < m_vecFilterChannels.size(); ++i)
+            m_matFilterData.row(i) = matDataIn.row(m_vecFilterChannels[i]);
     }
 
-    //Resize output matrix to match input matrix
-    MatrixXd matDataOut(matDataIn.rows(), matDataIn.cols());
+    //IIR sections run on all filtered channels at once, one sample column after the other
+    if(m_biquadCascade.sections() > 0)
+        m_biquadCascade.filter(m_matFilterData, m_matFilterData);
 
-    //Generate QList structure which can be handled by the QConcurrent framework
-    QList<QPair<QList<FilterData>,QPair<int,RowVectorXd> > > timeData;
-    QList<int> notFilterChannelIndex;
+    for(int i = 0; i < m_vecFilterChannels.size(); ++i)
+        matDataOut.row(m_vecFilterChannels[i]) = m_matFilterData.row(i);
 
-    //Only select channels specified in lFilterChannelList
-    for(qint32 i = 0; i < matDataIn.rows(); ++i) {
-        int pos = lFilterChannelList.indexOf(i);
-        if(pos != -1 && pos < matDataIn.rows()) {
-            timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(lFilterData,QPair<int,RowVectorXd>(pos,matDataIn.row(pos))));
+    //Unfiltered channels
+    int iDelay = m_matDelay.cols();
+    for(int i = 0; i < m_vecPassChannels.size(); ++i) {
+        int iChannel = m_vecPassChannels[i];
+
+        if(iDelay == 0) {
+            matDataOut.row(iChannel) = matDataIn.row(iChannel);
         } else {
-            notFilterChannelIndex.append(i);
+            m_vecLine.head(iDelay) = m_matDelay.row(iChannel);
+            m_vecLine.tail(m_iBlockSize) = matDataIn.row(iChannel);
+            matDataOut.row(iChannel) = m_vecLine.head(m_iBlockSize);
+            m_matDelay.row(iChannel) = m_vecLine.tail(iDelay);
         }
     }
 
-    //Do the concurrent filtering
-    if(!timeData.isEmpty()) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                             doFilterPerChannelRTMSA);
+    qint64 usec = timer.nsecsElapsed() / 1000;
+    m_stats.lastUsec = usec;
+    m_stats.minUsec = m_stats.blocks == 0 ? usec : qMin(m_stats.minUsec, usec);
+    m_stats.maxUsec = qMax(m_stats.maxUsec, usec);
+    m_stats.meanUsec += (usec - m_stats.meanUsec) / (m_stats.blocks + 1);
+    ++m_stats.blocks;
 
-        future.waitForFinished();
+    return true;
+}
 
-        //Do the overlap add method and store in matDataOut
-        int iFilteredNumberCols = timeData.at(0).second.second.cols();
 
-        for(int r = 0; r < timeData.size(); r++) {
-            //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-            RowVectorXd tempData = timeData.at(r).second.second;
+//*************************************************************************************************************
 
-            //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-            tempData.head(iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
+template<typename T>
+typename RtFilterT<T>::MatrixXT RtFilterT<T>::filterChannelsConcurrently(const MatrixXT& matDataIn, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<FilterData>& lFilterData)
+{
+    MNE_TRACE_SCOPE("RtFilter::filterChannelsConcurrently", "realtime");
 
-            //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
-            int start = 0;
-            matDataOut.row(timeData.at(r).second.first).segment(start,iFilteredNumberCols-iMaxFilterLength) = tempData.head(iFilteredNumberCols-iMaxFilterLength);
+    Q_UNUSED(iMaxFilterLength);
 
-            //Refresh the m_matOverlap with the new calculated filtered data.
-            m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(iMaxFilterLength);
-        }
+    MatrixXT matDataOut;
+    filterChannelsConcurrently(matDataIn, matDataOut, lFilterChannelList, lFilterData);
+
+    return matDataOut;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+bool RtFilterT<T>::filterChannelsConcurrently(const MatrixXT& matDataIn, MatrixXT& matDataOut, const QVector<int>& lFilterChannelList, const QList<FilterData>& lFilterData)
+{
+    if(!isPrepared(lFilterData, lFilterChannelList, matDataIn.rows(), matDataIn.cols()))
+        prepare(lFilterData, lFilterChannelList, matDataIn.rows(), matDataIn.cols(), DelayCompensated);
+
+    if(!filter(matDataIn, matDataOut)) {
+        matDataOut = matDataIn;
+        return false;
     }
 
-    //Fill filtered data with raw data if the channel was not filtered
-    for(int i = 0; i < notFilterChannelIndex.size(); ++i) {
-        matDataOut.row(notFilterChannelIndex.at(i)) << m_matDelay.row(notFilterChannelIndex.at(i)), matDataIn.row(notFilterChannelIndex.at(i)).head(matDataIn.cols() - iMaxFilterLength/2);
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+RtFilterStats RtFilterT<T>::stats() const
+{
+    RtFilterStats stats = m_stats;
+    stats.delaySamples = m_iDelay;
+    return stats;
+}
+
+
+//*************************************************************************************************************
 
-        //matDataOut.row(notFilterChannelIndex.at(i)).segment(0, matDataIn.row(notFilterChannelIndex.at(i)).cols()) = matDataIn.row(notFilterChannelIndex.at(i));
+template<typename T>
+void RtFilterT<T>::resetStats()
+{
+    m_stats.blocks = 0;
+    m_stats.lastUsec = 0;
+    m_stats.minUsec = 0;
+    m_stats.maxUsec = 0;
+    m_stats.meanUsec = 0.0;
+    m_stats.delaySamples = 0;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+bool RtFilterT<T>::isPrepared(const QList<FilterData>& lFilterData, const QVector<int>& lFilterChannelList, int iNumChannels, int iBlockSize) const
+{
+    if(iNumChannels != m_iNumChannels || iBlockSize != m_iBlockSize || m_mode != DelayCompensated)
+        return false;
+
+    if(lFilterData.size() != m_lCoeffs.size())
+        return false;
+
+    for(int i = 0; i < lFilterData.size(); ++i) {
+        if(lFilterData.at(i).m_dCoeffA.cols() != m_lCoeffs.at(i).cols() || lFilterData.at(i).m_dCoeffA != m_lCoeffs.at(i))
+            return false;
+
+        const MatrixXd& sections = lFilterData.at(i).m_matSOS;
+        if(sections.rows() != m_lSections.at(i).rows() || sections.cols() != m_lSections.at(i).cols() || sections != m_lSections.at(i))
+            return false;
     }
 
-    m_matDelay = matDataIn.block(0, matDataIn.cols()-iMaxFilterLength/2, matDataIn.rows(), iMaxFilterLength/2);
+    if(lFilterChannelList != m_vecChannelList)
+        return false;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EXPLICIT INSTANTIATIONS
+//=============================================================================================================
+
+namespace REALTIMELIB
+{
+
+template class REALTIMESHARED_EXPORT RtFilterT<double>;
+template class REALTIMESHARED_EXPORT RtFilterT<float>;
 
-    return matDataOut;
 }
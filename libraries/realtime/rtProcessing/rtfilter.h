@@ -43,6 +43,8 @@
 #include "../realtime_global.h"
 
 #include <utils/filterTools/filterdata.h>
+#include <utils/filterTools/biquadcascade.h>
+#include <utils/filterTools/fftfilterbatch.h>
 #include <fiff/fiff_info.h>
 
 
@@ -52,8 +54,8 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
-#include <QtConcurrent/QtConcurrent>
-#include <QFuture>
+#include <QList>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -82,45 +84,163 @@ namespace REALTIMELIB
 
 //=============================================================================================================
 /**
-* Real-time noise Spectrum estimation
+* Per-block latency counters of the streaming filter
+*/
+struct RtFilterStats
+{
+    qint64  blocks;         /**< Number of filtered blocks. */
+    qint64  lastUsec;       /**< Processing time of the last block in microseconds. */
+    qint64  minUsec;        /**< Minimal processing time of a block in microseconds. */
+    qint64  maxUsec;        /**< Maximal processing time of a block in microseconds. */
+    double  meanUsec;       /**< Mean processing time of a block in microseconds. */
+    int     delaySamples;   /**< Delay in samples the output carries with respect to the input. */
+};
+
+
+//=============================================================================================================
+/**
+* Streaming multi-channel filter. The combined impulse response of all FIR filters is transformed once in
+* prepare(). Each block is then filtered with overlap-save FFT convolution on the preallocated per-thread
+* workspaces of a UTILSLIB::FFTFilterBatchT, so filter() does not allocate as long as the block size stays the same. IIR filters are applied
+* afterwards as one cascade of second-order sections.
 *
-* @brief Real-time Noise estimation
+* The filters are designed and combined in double precision, the data, the histories and the workspaces are of the
+* scalar type of the filter. Explicitly instantiated for double (RtFilter) and float (RtFilterF), e.g. for
+* pipelines which stream the single precision buffers of the rt_server, at half the memory traffic per block.
+*
+* @brief Real-time overlap-save filter
 */
-class REALTIMESHARED_EXPORT RtFilter
+template<typename T>
+class RtFilterT
 {
 
 public:
-    typedef QSharedPointer<RtFilter> SPtr;             /**< Shared pointer type for RtFilter. */
-    typedef QSharedPointer<const RtFilter> ConstSPtr;  /**< Const shared pointer type for RtFilter. */
+    typedef QSharedPointer<RtFilterT> SPtr;             /**< Shared pointer type for RtFilterT. */
+    typedef QSharedPointer<const RtFilterT> ConstSPtr;  /**< Const shared pointer type for RtFilterT. */
+
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> MatrixXT;     /**< Dynamic matrix of the precision. */
+    typedef Eigen::Matrix<T, 1, Eigen::Dynamic> RowVectorXT;                /**< Dynamic row vector of the precision. */
+
+    enum FilterMode {
+        DelayCompensated,       /**< Filtered channels run the linear-phase FIR filters and carry their delay of delay() samples, unfiltered channels are delayed by the same amount, so all channels stay aligned. */
+        Causal                  /**< Filtered channels run the minimum-phase version of the combined FIR filter, which has the same magnitude response but almost no delay. Unfiltered channels are passed through, delay() is 0. */
+    };
 
     //=========================================================================================================
     /**
-    * Creates the real-time covariance estimation object.
+    * Creates the real-time filter object.
     */
-    explicit RtFilter();
+    explicit RtFilterT();
 
     //=========================================================================================================
     /**
-    * Destroys the Real-time noise estimation object.
+    * Destroys the real-time filter object.
     */
-    ~RtFilter();
+    ~RtFilterT();
 
     //=========================================================================================================
     /**
-    * Calculates the filtered version of the raw input data
+    * Precomputes the filter spectrum, the workspaces and the channel histories for streaming blocks of a fixed
+    * size. All filters are applied one after another, i.e. their impulse responses are convolved to one filter,
+    * which is converted to minimum phase in Causal mode. Resets the filter state.
+    *
+    * @param [in] lFilterData           filters to apply.
+    * @param [in] lFilterChannelList    indices of the channels which are to be filtered.
+    * @param [in] iNumChannels          number of rows of the blocks.
+    * @param [in] iBlockSize            number of columns of the blocks.
+    * @param [in] mode                  how unfiltered channels are handled.
     *
-    * @param [in] matDataIn     data which is to be filtered
-    * @param [out] matDataOut    data which is to be filtered
-    * @param [in] iDataIndex    current position in the global data matrix
+    * @return true if succeeded, false otherwise.
     */
-    Eigen::MatrixXd filterChannelsConcurrently(const Eigen::MatrixXd& matDataIn, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<UTILSLIB::FilterData> &lFilterData);
+    bool prepare(const QList<UTILSLIB::FilterData>& lFilterData, const QVector<int>& lFilterChannelList, int iNumChannels, int iBlockSize, FilterMode mode = DelayCompensated);
+
+    //=========================================================================================================
+    /**
+    * Filters the next block of the stream. The block has to match the dimensions passed to prepare().
+    *
+    * @param [in] matDataIn     data which is to be filtered.
+    * @param [out] matDataOut   filtered data, resized to the dimension of matDataIn.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool filter(const MatrixXT& matDataIn, MatrixXT& matDataOut);
+
+    //=========================================================================================================
+    /**
+    * Calculates the filtered version of the raw input data. Prepares the filter whenever the filters, the
+    * channel selection or the block dimensions change and filters in DelayCompensated mode.
+    *
+    * @param [in] matDataIn             data which is to be filtered
+    * @param [in] iMaxFilterLength      unused, the delay is derived from the filters. Kept for compatibility.
+    * @param [in] lFilterChannelList    indices of the channels which are to be filtered.
+    * @param [in] lFilterData           filters to apply.
+    *
+    * @return the filtered data.
+    */
+    MatrixXT filterChannelsConcurrently(const MatrixXT& matDataIn, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<UTILSLIB::FilterData> &lFilterData);
+
+    //=========================================================================================================
+    /**
+    * Same as above, but the filtered data is written to matDataOut, which keeps its storage between blocks of
+    * the same dimension. No heap memory is allocated once the filter is prepared and runs on one thread.
+    *
+    * @param [in] matDataIn             data which is to be filtered
+    * @param [out] matDataOut           filtered data, a copy of matDataIn if the filter failed.
+    * @param [in] lFilterChannelList    indices of the channels which are to be filtered.
+    * @param [in] lFilterData           filters to apply.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool filterChannelsConcurrently(const MatrixXT& matDataIn, MatrixXT& matDataOut, const QVector<int>& lFilterChannelList, const QList<UTILSLIB::FilterData> &lFilterData);
+
+    //=========================================================================================================
+    /**
+    * Returns the delay in samples the output carries with respect to the input for the filtered channels.
+    *
+    * @return the filter delay in samples.
+    */
+    inline int delay() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the latency counters.
+    *
+    * @return the latency counters.
+    */
+    RtFilterStats stats() const;
+
+    //=========================================================================================================
+    /**
+    * Resets the latency counters.
+    */
+    void resetStats();
 
 protected:
-    Eigen::MatrixXd                 m_matOverlap;                   /**< Last overlap block */
-    Eigen::MatrixXd                 m_matDelay;                     /**< Last delay block */
+    MatrixXT                        m_matDelay;                     /**< Delay line of the unfiltered channels. */
+    MatrixXT                        m_matHistory;                   /**< Last m_iFilterLength-1 input samples of the filtered channels. */
 
 private:
+    bool isPrepared(const QList<UTILSLIB::FilterData>& lFilterData, const QVector<int>& lFilterChannelList, int iNumChannels, int iBlockSize) const;
+
+    FilterMode                      m_mode;                         /**< The filter mode. */
+    int                             m_iNumChannels;                 /**< Number of rows of the blocks. */
+    int                             m_iBlockSize;                   /**< Number of columns of the blocks. */
+    int                             m_iFilterLength;                /**< Length of the combined impulse response. */
+    int                             m_iDelay;                       /**< Filter delay in samples. */
+    int                             m_iFFTLength;                   /**< Length of the FFT. */
+    QVector<int>                    m_vecChannelList;               /**< Channel selection the filter was prepared for. */
+    QVector<int>                    m_vecFilterChannels;            /**< Indices of the filtered channels. */
+    QVector<int>                    m_vecPassChannels;              /**< Indices of the unfiltered channels. */
+    QList<Eigen::RowVectorXd>       m_lCoeffs;                      /**< Filter coefficients the filter was prepared for. */
+    QList<Eigen::MatrixXd>          m_lSections;                    /**< Second-order sections the filter was prepared for. */
+    Eigen::RowVectorXcd             m_vecSpectrum;                  /**< Half spectrum of the combined impulse response. */
+    RowVectorXT                     m_vecLine;                      /**< Workspace of the delay line. */
+    UTILSLIB::FFTFilterBatchT<T>    m_fftFilterBatch;               /**< FFT convolution of the filtered channels, empty without FIR filters. */
+    MatrixXT                        m_matSegment;                   /**< Workspace holding the history followed by the current block of the filtered channels. */
+    UTILSLIB::BiquadCascadeT<T>     m_biquadCascade;                /**< Cascade of the second-order sections of all IIR filters. */
+    MatrixXT                        m_matFilterData;                /**< Workspace of the filtered channels. */
 
+    RtFilterStats                   m_stats;                        /**< The latency counters. */
 };
 
 //*************************************************************************************************************
@@ -128,6 +248,24 @@ private:
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+template<typename T>
+inline int RtFilterT<T>::delay() const
+{
+    return m_iDelay;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EXPLICIT INSTANTIATIONS
+//=============================================================================================================
+
+extern template class REALTIMESHARED_EXPORT RtFilterT<double>;
+extern template class REALTIMESHARED_EXPORT RtFilterT<float>;
+
+typedef RtFilterT<double> RtFilter;     /**< Double precision real-time filter. */
+typedef RtFilterT<float> RtFilterF;     /**< Single precision real-time filter. */
+
 } // NAMESPACE
 
 #endif // RTFILTER_H
@@ -50,6 +50,7 @@
 #include <fiff/fiff_dig_point_set.h>
 #include <fiff/fiff_dig_point.h>
 #include <fiff/fiff_coord_trans.h>
+#include <inverse/hpiFit/hpifit.h>
 
 
 //*************************************************************************************************************
@@ -102,6 +103,7 @@ struct FittingResult {
     FIFFLIB::FiffDigPointSet fittedCoils;
     FIFFLIB::FiffCoordTrans devHeadTrans;
     QVector<double> errorDistances;
+    INVERSELIB::HPIFitTimings timings;
 };
 
 //=============================================================================================================
@@ -131,6 +133,9 @@ public:
 
 signals:
     void resultReady(const REALTIMELIB::FittingResult &fitResult);
+
+private:
+    INVERSELIB::HPIFit  m_hpiFit;       /**< The HPI fit, keeps the sensor setup and the previous fit for warm starts. */
 };
 
 //=============================================================================================================
@@ -41,6 +41,8 @@
 
 #include "rtinvop.h"
 
+#include <utils/executionconfig.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -48,6 +50,7 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QElapsedTimer>
 
 
 //*************************************************************************************************************
@@ -68,6 +71,10 @@ RtInvOp::RtInvOp(FiffInfo::SPtr &p_pFiffInfo, MNEForwardSolution::SPtr &p_pFwd,
 , m_bIsRunning(false)
 , m_pFiffInfo(p_pFiffInfo)
 , m_pFwd(p_pFwd)
+, m_iMinUpdateInterval(0)
+, m_fLoose(0.2f)
+, m_fDepth(0.8f)
+, m_bForwardPicked(false)
 {
     qRegisterMetaType<MNEInverseOperator::SPtr>("MNEInverseOperator::SPtr");
 }
@@ -95,6 +102,16 @@ void RtInvOp::appendNoiseCov(FiffCov &p_noiseCov)
 }
 
 
+//*************************************************************************************************************
+
+void RtInvOp::setMinUpdateInterval(qint32 p_iMsec)
+{
+    mutex.lock();
+    m_iMinUpdateInterval = p_iMsec > 0 ? p_iMsec : 0;
+    mutex.unlock();
+}
+
+
 //*************************************************************************************************************
 
 bool RtInvOp::stop()
@@ -110,21 +127,99 @@ bool RtInvOp::stop()
 
 void RtInvOp::run()
 {
+    UTILSLIB::ExecutionConfig::configureThread("realtime");
+
     m_bIsRunning = true;
 
+    QElapsedTimer t_timer;
+
     while(m_bIsRunning)
     {
-        if(m_vecNoiseCov.size() > 0)
+        mutex.lock();
+        bool t_bUpdate = m_vecNoiseCov.size() > 0 && (!t_timer.isValid() || t_timer.elapsed() >= m_iMinUpdateInterval);
+        FiffCov t_noiseCov;
+        if(t_bUpdate)
+        {
+            // Coalesce bursts - only the most recent noise covariance matters
+            t_noiseCov = m_vecNoiseCov.last();
+            m_vecNoiseCov.clear();
+        }
+        mutex.unlock();
+
+        if(!t_bUpdate)
         {
-            // Restrict forward solution as necessary for MEG
-            MNEForwardSolution t_forwardMeg = m_pFwd->pick_types(true, false);
+            msleep(1);
+            continue;
+        }
+
+        t_timer.start();
+
+        MNEInverseOperator::SPtr t_invOpMeg = updateInverseOperator(t_noiseCov);
+
+        printf("RtInvOp: inverse operator updated in %lld ms\n", t_timer.elapsed());
 
-            mutex.lock();
-            MNEInverseOperator::SPtr t_invOpMeg(new MNEInverseOperator(*m_pFiffInfo.data(), t_forwardMeg, m_vecNoiseCov[0], 0.2f, 0.8f));
-            m_vecNoiseCov.pop_front();
-            mutex.unlock();
+        emit invOperatorCalculated(t_invOpMeg);
+    }
+}
+
+
+//*************************************************************************************************************
+
+MNEInverseOperator::SPtr RtInvOp::updateInverseOperator(const FiffCov &p_noiseCov)
+{
+    // Restrict forward solution as necessary for MEG
+    if(!m_bForwardPicked)
+    {
+        m_forwardMeg = m_pFwd->pick_types(true, false);
+        m_bForwardPicked = true;
+    }
 
-            emit invOperatorCalculated(t_invOpMeg);
+    bool t_bFixedOri = m_forwardMeg.isFixedOrient();
+
+    // Loose orientation needs surface oriented sources, let make_inverse_operator report it
+    if(!t_bFixedOri && m_forwardMeg.source_ori == -1)
+        return MNEInverseOperator::SPtr(new MNEInverseOperator(*m_pFiffInfo.data(), m_forwardMeg, p_noiseCov, m_fLoose, m_fDepth));
+
+    FiffInfo t_gainInfo;
+    MatrixXd t_matGain;
+    MatrixXd t_matWhitener;
+    qint32 t_iNumNonZero;
+    FiffCov t_noiseCov;
+    m_forwardMeg.prepare_forward(*m_pFiffInfo.data(), p_noiseCov, false, t_gainInfo, t_matGain, t_noiseCov, t_matWhitener, t_iNumNonZero);
+
+    //
+    // The priors only depend on the lead field of the selected channels
+    //
+    if(!m_pSourcePrior || t_gainInfo.ch_names != m_qListGainChNames)
+    {
+        printf("RtInvOp: computing source priors for %d channels.\n", t_gainInfo.ch_names.size());
+
+        m_pDepthPrior = FiffCov::SDPtr(new FiffCov(MNEForwardSolution::compute_depth_prior(t_matGain, t_gainInfo, t_bFixedOri, m_fDepth)));
+        m_pSourcePrior = FiffCov::SDPtr(new FiffCov(*m_pDepthPrior));
+
+        m_pOrientPrior = FiffCov::SDPtr();
+        if(!t_bFixedOri)
+        {
+            m_pOrientPrior = FiffCov::SDPtr(new FiffCov(m_forwardMeg.compute_orient_prior(m_fLoose)));
+            m_pSourcePrior->data.array() *= m_pOrientPrior->data.array();
         }
+
+        m_qListGainChNames = t_gainInfo.ch_names;
     }
+
+    // assemble_inverse_operator scales the source covariance in place
+    FiffCov::SDPtr t_pSourceCov(new FiffCov(*m_pSourcePrior));
+
+    t_matGain = t_matWhitener * t_matGain;
+
+    return MNEInverseOperator::SPtr(new MNEInverseOperator(MNEInverseOperator::assemble_inverse_operator(*m_pFiffInfo.data(),
+                                                                                                         m_forwardMeg,
+                                                                                                         t_gainInfo,
+                                                                                                         t_matGain,
+                                                                                                         t_iNumNonZero,
+                                                                                                         t_noiseCov,
+                                                                                                         t_pSourceCov,
+                                                                                                         m_pDepthPrior,
+                                                                                                         m_pOrientPrior,
+                                                                                                         true)));
 }
@@ -134,6 +134,15 @@ public:
     */
     void appendNoiseCov(FiffCov &p_NoiseCov);
 
+    //=========================================================================================================
+    /**
+    * Sets the minimal time between two inverse operator updates. Noise covariances arriving in between are
+    * coalesced, only the most recent one is used for the next update.
+    *
+    * @param[in] p_iMsec    minimal update interval in milliseconds
+    */
+    void setMinUpdateInterval(qint32 p_iMsec);
+
     //=========================================================================================================
     /**
     * Stops the RtInv by stopping the producer's thread.
@@ -169,6 +178,18 @@ protected:
     virtual void run();
 
 private:
+    //=========================================================================================================
+    /**
+    * Calculates the inverse operator for the given noise covariance. The noise covariance independent parts of
+    * the forward model, i.e. the channel selection, the depth and the orientation prior, are computed once and
+    * reused as long as the selected channels do not change.
+    *
+    * @param[in] p_noiseCov     Noise covariance estimation
+    *
+    * @return the inverse operator
+    */
+    MNEInverseOperator::SPtr updateInverseOperator(const FiffCov &p_noiseCov);
+
     QMutex      mutex;                  /**< Provides access serialization between threads. */
     bool        m_bIsRunning;           /**< Whether RtInv is running. */
 
@@ -176,6 +197,17 @@ private:
 
     FiffInfo::SPtr m_pFiffInfo;         /**< The fiff measurement information. */
     MNEForwardSolution::SPtr m_pFwd;    /**< The forward solution. */
+
+    qint32      m_iMinUpdateInterval;   /**< Minimal time between two inverse operator updates in msec. */
+    float       m_fLoose;               /**< The loose orientation parameter. */
+    float       m_fDepth;               /**< The depth weighting exponent. */
+
+    bool                    m_bForwardPicked;       /**< Whether m_forwardMeg was picked from m_pFwd. */
+    MNEForwardSolution      m_forwardMeg;           /**< The MEG part of the forward solution. */
+    QStringList             m_qListGainChNames;     /**< The channels the cached priors were computed for. */
+    FiffCov::SDPtr          m_pDepthPrior;          /**< Cached depth prior. */
+    FiffCov::SDPtr          m_pOrientPrior;         /**< Cached orientation prior. */
+    FiffCov::SDPtr          m_pSourcePrior;         /**< Cached source covariance (depth times orientation prior), not yet scaled. */
 };
 
 //*************************************************************************************************************
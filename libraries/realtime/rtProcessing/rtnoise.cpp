@@ -45,6 +45,8 @@
 
 #include <iostream>
 #include <fiff/fiff_cov.h>
+#include <utils/spectral.h>
+#include <utils/executionconfig.h>
 
 
 //*************************************************************************************************************
@@ -52,6 +54,9 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QtConcurrent/QtConcurrent>
+#include <QMutexLocker>
+#include <QThread>
 #include <QDebug>
 
 
@@ -62,6 +67,81 @@
 
 using namespace REALTIMELIB;
 using namespace FIFFLIB;
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE REALTIMELIB
+//=============================================================================================================
+
+namespace REALTIMELIB
+{
+
+//=============================================================================================================
+/**
+* Workspace of one batch of channels. The FFT object keeps its plan for the FFT length.
+*/
+struct RtNoiseWorkspace
+{
+    int                 iFirstRow;      /**< First channel of this batch. */
+    int                 iNumRows;       /**< Number of channels of this batch. */
+    Eigen::FFT<double>  fft;            /**< FFT object of this batch. */
+    RowVectorXd         vecTime;        /**< Windowed segment, zero-padded to the FFT length. */
+    RowVectorXcd        vecFreq;        /**< Half spectrum of vecTime. */
+};
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Adds the power spectral density of the first segment in the segment buffer for all channels of one workspace
+*/
+struct PsdBatch
+{
+    typedef void result_type;
+
+    PsdBatch(const MatrixXd* p_pMatBuffer, const RowVectorXd* p_pVecWindow, const RowVectorXd* p_pVecBinScale, MatrixXd* p_pMatPsd, double dWeightOld, double dWeightNew)
+    : m_pMatBuffer(p_pMatBuffer)
+    , m_pVecWindow(p_pVecWindow)
+    , m_pVecBinScale(p_pVecBinScale)
+    , m_pMatPsd(p_pMatPsd)
+    , m_dWeightOld(dWeightOld)
+    , m_dWeightNew(dWeightNew)
+    {
+    }
+
+    void operator()(QSharedPointer<RtNoiseWorkspace>& workspace) const
+    {
+        int iSegmentLength = m_pVecWindow->cols();
+
+        for(int r = workspace->iFirstRow; r < workspace->iFirstRow + workspace->iNumRows; ++r) {
+            workspace->vecTime.head(iSegmentLength) = m_pMatBuffer->row(r).head(iSegmentLength).cwiseProduct(*m_pVecWindow);
+
+            workspace->fft.fwd(workspace->vecFreq, workspace->vecTime);
+
+            m_pMatPsd->row(r) = m_dWeightOld * m_pMatPsd->row(r) + m_dWeightNew * workspace->vecFreq.cwiseAbs2().cwiseProduct(*m_pVecBinScale);
+        }
+    }
+
+    const MatrixXd*     m_pMatBuffer;
+    const RowVectorXd*  m_pVecWindow;
+    const RowVectorXd*  m_pVecBinScale;
+    MatrixXd*           m_pMatPsd;
+    double              m_dWeightOld;
+    double              m_dWeightNew;
+};
+
+}
 
 
 //*************************************************************************************************************
@@ -75,6 +155,15 @@ RtNoise::RtNoise(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, qint32 p_data
 , m_pFiffInfo(p_pFiffInfo)
 , m_dataLength(p_dataLen)
 , m_bIsRunning(false)
+, m_dOverlap(0.5)
+, m_sWindowType("hanning")
+, m_averagingMode(LinearAveraging)
+, m_dExponentialWeight(0.1)
+, m_bSettingsChanged(false)
+, m_iSegmentLength(0)
+, m_iHop(1)
+, m_iBufferedSamples(0)
+, m_iNumSegments(0)
 , m_iNumOfBlocks(0)
 , m_iBlockSize(0)
 , m_iSensors(0)
@@ -86,70 +175,55 @@ RtNoise::RtNoise(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, qint32 p_data
     m_Fs = m_pFiffInfo->sfreq;
 
     m_bSendDataToBuffer = true;
+}
 
-    m_fWin.clear();
 
-    //create a hanning window
-    m_fWin = hanning(m_iFFTlength,0);
+//*************************************************************************************************************
 
-    qDebug()<<"Hanning window is created.";
+void RtNoise::setOverlap(double dOverlap)
+{
+    QMutexLocker locker(&mutex);
+    m_dOverlap = qBound(0.0, dOverlap, 0.95);
+    m_bSettingsChanged = true;
+}
 
+
+//*************************************************************************************************************
+
+void RtNoise::setWindowType(const QString &sWindowType)
+{
+    QMutexLocker locker(&mutex);
+    m_sWindowType = sWindowType;
+    m_bSettingsChanged = true;
 }
 
 
 //*************************************************************************************************************
 
-RtNoise::~RtNoise()
+void RtNoise::setAveragingMode(AveragingMode mode)
 {
-    if(this->isRunning()){
-        stop();
-    }
+    QMutexLocker locker(&mutex);
+    m_averagingMode = mode;
+    m_bSettingsChanged = true;
 }
 
+
 //*************************************************************************************************************
 
-QVector <float> RtNoise::hanning(int N, short itype)
+void RtNoise::setExponentialWeight(double dWeight)
 {
-    int half, i, idx, n;
-    QVector <float> w(N,0.0);
+    QMutexLocker locker(&mutex);
+    m_dExponentialWeight = qBound(1e-6, dWeight, 1.0);
+}
 
-    if(itype==1)    //periodic function
-        n = N-1;
-    else
-        n = N;
 
-    if(n%2==0)
-    {
-        half = n/2;
-        for(i=0; i<half; i++) //CALC_HANNING   Calculates Hanning window samples.
-            w[i] = 0.5 * (1 - cos(2*3.14159265*(i+1) / (n+1)));
-
-        idx = half-1;
-        for(i=half; i<n; i++) {
-            w[i] = w[idx];
-            idx--;
-        }
-    }
-    else
-    {
-        half = (n+1)/2;
-        for(i=0; i<half; i++) //CALC_HANNING   Calculates Hanning window samples.
-            w[i] = 0.5 * (1 - cos(23.14159265*(i+1) / (n+1)));
-
-        idx = half-2;
-        for(i=half; i<n; i++) {
-            w[i] = w[idx];
-            idx--;
-        }
-    }
+//*************************************************************************************************************
 
-    if(itype==1)    //periodic function
-    {
-        for(i=N-1; i>=1; i--)
-            w[i] = w[i-1];
-        w[0] = 0.0;
+RtNoise::~RtNoise()
+{
+    if(this->isRunning()){
+        stop();
     }
-    return(w);
 }
 
 //*************************************************************************************************************
@@ -199,7 +273,10 @@ bool RtNoise::stop()
 
 void RtNoise::run()
 {
+    ExecutionConfig::configureThread("realtime");
+
     bool FirstStart = true;
+    int iBlocks = 0;
 
     while(m_bIsRunning)
     {
@@ -207,106 +284,137 @@ void RtNoise::run()
         {
             MatrixXd block = m_pRawMatrixBuffer->pop();
 
-            if(FirstStart){
-                //init the circ buffer and parameters
-                if(m_dataLength < 0) m_dataLength = 10;
+            if(block.cols() == 0)
+                continue;
+
+            mutex.lock();
+            bool bSettingsChanged = m_bSettingsChanged;
+            m_bSettingsChanged = false;
+            mutex.unlock();
+
+            if(FirstStart || bSettingsChanged || block.rows() != m_iSensors || block.cols() != m_iBlockSize){
+                //init the segment buffer and parameters
+                if(m_dataLength <= 0) m_dataLength = 10;
                 m_iNumOfBlocks = m_dataLength;//60;
                 m_iBlockSize =  block.cols();
-                m_iSensors =  block.rows();
 
-                m_matCircBuf.resize(m_iSensors,m_iNumOfBlocks*m_iBlockSize);
+                prepare(block.rows());
 
-                m_iBlockIndex = 0;
+                iBlocks = 0;
                 FirstStart = false;
             }
-            //concate blocks
-            for (int i=0; i< m_iSensors; i++)
-                for (int j=0; j< m_iBlockSize; j++)
-                    m_matCircBuf(i,j+m_iBlockIndex*m_iBlockSize) = block(i,j);
-
-
-            m_iBlockIndex ++;
-            if (m_iBlockIndex >= m_iNumOfBlocks){
-
-                //m_pRawMatrixBuffer.clear(); //empty the buffer
-
-                m_bSendDataToBuffer = false;
-                //stop collect block and start to calculate the spectrum
-                m_iBlockIndex = 0;
-
-                MatrixXd sum_psdx = MatrixXd::Zero(m_iSensors,m_iFFTlength/2+1);
-
-                int nb = floor(m_iNumOfBlocks*m_iBlockSize/m_iFFTlength)+1;
-                qDebug()<<"nb"<<nb<<"NumOfBlocks"<<m_iNumOfBlocks<<"BlockSize"<<m_iBlockSize;
-                MatrixXd t_mat(m_iSensors,m_iFFTlength);
-                MatrixXd t_psdx(m_iSensors,m_iFFTlength/2+1);
-                for (int n = 0; n<nb; n++){
-                    //collect a data block with data length of m_iFFTlength;
-                    if(n==nb-1)
-                    {
-                        for(qint32 ii=0; ii<m_iSensors; ii++)
-                        for(qint32 jj=0; jj<m_iFFTlength; jj++)
-                            if(jj+n*m_iFFTlength<m_iNumOfBlocks*m_iBlockSize)
-                                t_mat(ii,jj) = m_matCircBuf(ii,jj+n*m_iFFTlength);
-                            else
-                                t_mat(ii,jj) = 0.0;
-
-                    }
-                    else
-                    {
-                        for(qint32 ii=0; ii<m_iSensors; ii++)
-                        for(qint32 jj=0; jj<m_iFFTlength; jj++)
-                            t_mat(ii,jj) = m_matCircBuf(ii,jj+n*m_iFFTlength);
-                    }
-
-                    //FFT calculation by row
-                    for(qint32 i = 0; i < t_mat.rows(); i++){
-                        RowVectorXd data;
-
-                        data = t_mat.row(i);
-
-                        //zero-pad data to m_iFFTlength
-                        RowVectorXd t_dataZeroPad = RowVectorXd::Zero(m_iFFTlength);
-                        t_dataZeroPad.head(data.cols()) = data;
-
-                        for (qint32 lk = 0; lk<m_iFFTlength; lk++)
-                            t_dataZeroPad[lk] = t_dataZeroPad[lk]*m_fWin[lk];
-
-                        //generate fft object
-                        Eigen::FFT<double> fft;
-                        fft.SetFlag(fft.HalfSpectrum);
-
-                        //fft-transform data sequence
-                        RowVectorXcd t_freqData(m_iFFTlength/2+1);
-                        fft.fwd(t_freqData,t_dataZeroPad);
-
-                        // calculate spectrum from FFT
-                        for(qint32 j=0; j<m_iFFTlength/2+1;j++)
-                        {
-                            double mag_abs = sqrt(t_freqData(j).real()* t_freqData(j).real() +  t_freqData(j).imag()*t_freqData(j).imag());
-                            double spower = (1.0/(m_Fs*m_iFFTlength))* mag_abs;
-                            if (j>0&&j<m_iFFTlength/2) spower = 2.0*spower;
-                            sum_psdx(i,j) = sum_psdx(i,j) + spower;
-                        }
-                     }//row computing is done
-                }//nb
 
+            //append block to the segment buffer
+            if(m_iBufferedSamples + block.cols() > m_matCircBuf.cols())
+                m_matCircBuf.conservativeResize(Eigen::NoChange, m_iBufferedSamples + block.cols());
+            m_matCircBuf.middleCols(m_iBufferedSamples, block.cols()) = block;
+            m_iBufferedSamples += block.cols();
+
+            int iNewSegments = addSegments();
+            ++iBlocks;
+
+            //Linear averaging reports every m_iNumOfBlocks blocks and starts over, exponential averaging with every new segment
+            bool bEmit = m_averagingMode == LinearAveraging ? (iBlocks >= m_iNumOfBlocks && m_iNumSegments > 0) : iNewSegments > 0;
+
+            if(bEmit) {
                 //DB-calculation
-                for(qint32 ii=0; ii<m_iSensors; ii++)
-                    for(qint32 jj=0; jj<m_iFFTlength/2+1; jj++)
-                        t_psdx(ii,jj) = 10.0*log10(sum_psdx(ii,jj)/nb);
+                double dNorm = m_averagingMode == LinearAveraging ? 1.0 / m_iNumSegments : 1.0;
+                MatrixXd t_psdx = (10.0 * (m_matPsd.array() * dNorm).log10()).matrix();
 
-                qDebug()<<"Send spectrum to Noise Estimator";
                 emit SpecCalculated(t_psdx); //send back the spectrum result
-                if(m_pRawMatrixBuffer->size()>0)
-                    m_pRawMatrixBuffer->clear();
 
-                m_bSendDataToBuffer = true;
+                if(m_averagingMode == LinearAveraging) {
+                    m_matPsd.setZero();
+                    m_iNumSegments = 0;
+                    iBlocks = 0;
+                }
             }
+        }
+    }
+}
+
 
+//*************************************************************************************************************
+
+void RtNoise::prepare(int iSensors)
+{
+    mutex.lock();
+    double dOverlap = m_dOverlap;
+    QString sWindowType = m_sWindowType;
+    mutex.unlock();
+
+    m_iSensors = iSensors;
+
+    //Short data lengths use a single zero-padded segment, like a plain periodogram
+    m_iSegmentLength = qMin(m_iFFTlength, m_iNumOfBlocks * m_iBlockSize);
+    m_iHop = qMax(1, (int)((1.0 - dOverlap) * m_iSegmentLength + 0.5));
+
+    m_vecWindow = Spectral::generateTapers(m_iSegmentLength, sWindowType).first.row(0);
+
+    //One sided power spectral density: |X|^2 / (fs * sum(w^2)), doubled except for DC and Nyquist
+    int iBins = m_iFFTlength/2 + 1;
+    m_vecBinScale = RowVectorXd::Constant(iBins, 2.0 / (m_Fs * m_vecWindow.squaredNorm()));
+    m_vecBinScale[0] *= 0.5;
+    if(m_iFFTlength % 2 == 0)
+        m_vecBinScale[iBins-1] *= 0.5;
+
+    m_matCircBuf.resize(m_iSensors, m_iSegmentLength + m_iBlockSize);
+    m_iBufferedSamples = 0;
+    m_matPsd = MatrixXd::Zero(m_iSensors, iBins);
+    m_iNumSegments = 0;
+
+    //
+    // One workspace per thread, each owning a contiguous batch of channels
+    //
+    m_lWorkspaces.clear();
+    int iBatches = qMin(ExecutionConfig::threadCount(), qMax(1, m_iSensors));
+    for(int b = 0; b < iBatches; ++b) {
+        QSharedPointer<RtNoiseWorkspace> workspace(new RtNoiseWorkspace);
+
+        workspace->iFirstRow = b * m_iSensors / iBatches;
+        workspace->iNumRows = (b + 1) * m_iSensors / iBatches - workspace->iFirstRow;
+        workspace->fft.SetFlag(workspace->fft.HalfSpectrum);
+        workspace->vecTime = RowVectorXd::Zero(m_iFFTlength);
+        workspace->vecFreq = RowVectorXcd::Zero(iBins);
+
+        m_lWorkspaces.append(workspace);
+    }
+}
+
+
+//*************************************************************************************************************
+
+int RtNoise::addSegments()
+{
+    mutex.lock();
+    double dExponentialWeight = m_dExponentialWeight;
+    mutex.unlock();
+
+    int iAdded = 0;
+
+    while(m_iBufferedSamples >= m_iSegmentLength) {
+        double dWeightOld = 1.0;
+        double dWeightNew = 1.0;
+        if(m_averagingMode == ExponentialAveraging && m_iNumSegments > 0) {
+            dWeightNew = dExponentialWeight;
+            dWeightOld = 1.0 - dExponentialWeight;
         }
 
+        PsdBatch batch(&m_matCircBuf, &m_vecWindow, &m_vecBinScale, &m_matPsd, dWeightOld, dWeightNew);
+        if(m_lWorkspaces.size() == 1)
+            batch(m_lWorkspaces.first());
+        else
+            QtConcurrent::blockingMap(m_lWorkspaces, batch);
+
+        ++m_iNumSegments;
+        ++iAdded;
+
+        //Advance by one hop, the overlap stays in the buffer
+        int iKeep = m_iBufferedSamples - m_iHop;
+        for(int c = 0; c < iKeep; ++c)
+            m_matCircBuf.col(c) = m_matCircBuf.col(c + m_iHop);
+        m_iBufferedSamples = iKeep;
     }
 
+    return iAdded;
 }
-
@@ -71,6 +71,8 @@
 #include <QMutex>
 #include <QSharedPointer>
 #include <QVector>
+#include <QList>
+#include <QString>
 
 
 //*************************************************************************************************************
@@ -100,6 +102,14 @@ using namespace IOBUFFER;
 using namespace FIFFLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+struct RtNoiseWorkspace;
+
+
 //=============================================================================================================
 /**
 * Real-time noise Spectrum estimation
@@ -113,6 +123,11 @@ public:
     typedef QSharedPointer<RtNoise> SPtr;             /**< Shared pointer type for RtNoise. */
     typedef QSharedPointer<const RtNoise> ConstSPtr;  /**< Const shared pointer type for RtNoise. */
 
+    enum AveragingMode {
+        LinearAveraging,        /**< Average all segments of p_dataLen blocks, then start over. */
+        ExponentialAveraging    /**< Exponentially weighted running average, updated with every new segment. */
+    };
+
     //=========================================================================================================
     /**
     * Creates the real-time covariance estimation object.
@@ -123,6 +138,38 @@ public:
     */
     explicit RtNoise(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, qint32 p_dataLen, QObject *parent = 0);
 
+    //=========================================================================================================
+    /**
+    * Sets the overlap of consecutive Welch segments.
+    *
+    * @param[in] dOverlap   overlap as fraction of the FFT length, in [0, 0.95]
+    */
+    void setOverlap(double dOverlap);
+
+    //=========================================================================================================
+    /**
+    * Sets the window applied to each segment, see UTILSLIB::Spectral::generateTapers.
+    *
+    * @param[in] sWindowType    "hanning" or "ones"
+    */
+    void setWindowType(const QString &sWindowType);
+
+    //=========================================================================================================
+    /**
+    * Sets the averaging mode of the segment spectra.
+    *
+    * @param[in] mode       the averaging mode
+    */
+    void setAveragingMode(AveragingMode mode);
+
+    //=========================================================================================================
+    /**
+    * Sets the weight of a new segment in exponential averaging mode.
+    *
+    * @param[in] dWeight    weight of the newest segment, in (0, 1]
+    */
+    void setExponentialWeight(double dWeight);
+
     //=========================================================================================================
     /**
     * Destroys the Real-time noise estimation object.
@@ -180,9 +227,23 @@ protected:
     */
     virtual void run();
 
-    QVector <float> hanning(int N, short itype);
-
 private:
+    //=========================================================================================================
+    /**
+    * Creates the window, the segment buffer and one FFT workspace per batch of channels.
+    *
+    * @param[in] iSensors   number of channels
+    */
+    void prepare(int iSensors);
+
+    //=========================================================================================================
+    /**
+    * Adds the spectra of all complete segments in the segment buffer to the running estimate.
+    *
+    * @return the number of added segments
+    */
+    int addSegments();
+
     QMutex      mutex;                  /**< Provides access serialization between threads*/
 
     FiffInfo::SPtr  m_pFiffInfo;        /**< Holds the fiff measurement information. */
@@ -191,10 +252,24 @@ private:
 
     CircularMatrixBuffer<double>::SPtr m_pRawMatrixBuffer;   /**< The Circular Raw Matrix Buffer. */
 
-    QVector <float> m_fWin;
-
     double m_Fs;
 
+    double          m_dOverlap;                 /**< Overlap of consecutive segments as fraction of the FFT length. */
+    QString         m_sWindowType;              /**< The window type. */
+    AveragingMode   m_averagingMode;            /**< The averaging mode. */
+    double          m_dExponentialWeight;       /**< Weight of a new segment in exponential averaging mode. */
+    bool            m_bSettingsChanged;         /**< Whether the settings changed since the last prepare. */
+
+    int             m_iSegmentLength;           /**< Length of a segment, zero-padded to the FFT length. */
+    RowVectorXd     m_vecWindow;                /**< The segment window. */
+    RowVectorXd     m_vecBinScale;              /**< Scales squared spectra to the one sided power spectral density. */
+    int             m_iHop;                     /**< Samples between the starts of consecutive segments. */
+    int             m_iBufferedSamples;         /**< Valid samples in m_matCircBuf. */
+    MatrixXd        m_matPsd;                   /**< The running power spectral density estimate. */
+    int             m_iNumSegments;             /**< Number of segments in m_matPsd. */
+
+    QList<QSharedPointer<RtNoiseWorkspace> > m_lWorkspaces;    /**< One workspace per batch of channels. */
+
     qint32 m_iFFTlength;
     qint32 m_dataLength;
 
@@ -204,7 +279,7 @@ protected:
     int m_iSensors;
     int m_iBlockIndex;
 
-    MatrixXd m_matCircBuf;
+    MatrixXd m_matCircBuf;      /**< Segment buffer holding the samples not yet covered by a complete segment. */
 
 public:
     MatrixXd m_matSpecData;
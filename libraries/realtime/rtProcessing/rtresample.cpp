@@ -0,0 +1,355 @@
+//=============================================================================================================
+/**
+* @file     rtresample.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RtResample class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtresample.h"
+
+#include <fiff/fiff_raw_data.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtMath>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace {
+
+int greatestCommonDivisor(int a, int b)
+{
+    while(b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+//Modified Bessel function of the first kind of order zero
+double besselI0(double x)
+{
+    double dSum = 1.0;
+    double dTerm = 1.0;
+    for(int k = 1; k < 100; ++k) {
+        dTerm *= (x / (2.0 * k)) * (x / (2.0 * k));
+        dSum += dTerm;
+        if(dTerm < 1e-12 * dSum)
+            break;
+    }
+    return dSum;
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtResample::RtResample()
+: m_iUp(1)
+, m_iDown(1)
+, m_iNumChannels(0)
+, m_iTaps(0)
+, m_iHalfLength(0)
+, m_iPhase(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+RtResample::RtResample(int iUp, int iDown, int iNumChannels, int iZeroCrossings, double dRolloff, double dBeta)
+: m_iUp(1)
+, m_iDown(1)
+, m_iNumChannels(0)
+, m_iTaps(0)
+, m_iHalfLength(0)
+, m_iPhase(0)
+{
+    prepare(iUp, iDown, iNumChannels, iZeroCrossings, dRolloff, dBeta);
+}
+
+
+//*************************************************************************************************************
+
+bool RtResample::prepare(int iUp, int iDown, int iNumChannels, int iZeroCrossings, double dRolloff, double dBeta)
+{
+    if(iUp <= 0 || iDown <= 0 || iNumChannels <= 0 || iZeroCrossings <= 0 || dRolloff <= 0.0 || dRolloff > 1.0) {
+        qWarning() << "RtResample::prepare - Invalid parameters";
+        return false;
+    }
+
+    int iGcd = greatestCommonDivisor(iUp, iDown);
+    m_iUp = iUp / iGcd;
+    m_iDown = iDown / iGcd;
+    m_iNumChannels = iNumChannels;
+
+    //The prototype is centered on an input sample, its length is 2*m_iHalfLength*m_iUp+1 at the upsampled rate
+    m_iHalfLength = halfLength(m_iUp, m_iDown, iZeroCrossings, dRolloff);
+    m_iTaps = 2 * m_iHalfLength + 1;
+
+    int iLength = 2 * m_iHalfLength * m_iUp + 1;
+    int iCenter = m_iHalfLength * m_iUp;
+    double dCutoff = dRolloff / qMax(m_iUp, m_iDown);
+    double dWindowNorm = besselI0(dBeta);
+
+    VectorXd vecPrototype = VectorXd::Zero(m_iTaps * m_iUp);
+    for(int n = 0; n < iLength; ++n) {
+        double x = dCutoff * (n - iCenter);
+        double dSinc = (n == iCenter) ? 1.0 : qSin(M_PI * x) / (M_PI * x);
+        double r = double(n - iCenter) / iCenter;
+        double dWindow = besselI0(dBeta * qSqrt(qMax(0.0, 1.0 - r * r))) / dWindowNorm;
+        vecPrototype(n) = dCutoff * dSinc * dWindow;
+    }
+
+    //Phase p holds the taps p, p+m_iUp, p+2*m_iUp, ..., reversed so they meet the input columns in order
+    m_matPhases.resize(m_iTaps, m_iUp);
+    for(int p = 0; p < m_iUp; ++p) {
+        for(int m = 0; m < m_iTaps; ++m) {
+            m_matPhases(m_iTaps - 1 - m, p) = vecPrototype(p + m * m_iUp);
+        }
+
+        //Unit gain at DC for every phase, so constant input gives constant output without ripple
+        m_matPhases.col(p) /= m_matPhases.col(p).sum();
+    }
+
+    reset();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void RtResample::reset()
+{
+    m_iPhase = 0;
+    m_matBuffer = MatrixXd::Zero(m_iNumChannels, qMax(0, m_iTaps - 1));
+}
+
+
+//*************************************************************************************************************
+
+bool RtResample::resample(const MatrixXd& matDataIn, MatrixXd& matDataOut)
+{
+    if(m_iTaps == 0) {
+        matDataOut = matDataIn;
+        return true;
+    }
+
+    if(matDataIn.rows() != m_iNumChannels) {
+        qWarning() << "RtResample::resample - The block has" << matDataIn.rows() << "rows instead of" << m_iNumChannels;
+        return false;
+    }
+
+    int iHistory = m_iTaps - 1;
+    int iBlockSize = matDataIn.cols();
+
+    //Append the block to the carried samples, the buffer only grows for larger blocks
+    if(m_matBuffer.cols() != iHistory + iBlockSize) {
+        MatrixXd matHistory = m_matBuffer.leftCols(iHistory);
+        m_matBuffer.resize(m_iNumChannels, iHistory + iBlockSize);
+        m_matBuffer.leftCols(iHistory) = matHistory;
+    }
+    m_matBuffer.rightCols(iBlockSize) = matDataIn;
+
+    qint64 iEnd = qint64(iBlockSize) * m_iUp;
+    int iNumOut = m_iPhase < iEnd ? int((iEnd - m_iPhase + m_iDown - 1) / m_iDown) : 0;
+    matDataOut.resize(m_iNumChannels, iNumOut);
+
+    for(int k = 0; k < iNumOut; ++k) {
+        qint64 t = m_iPhase + qint64(k) * m_iDown;
+        int i = int(t / m_iUp);
+        int p = int(t % m_iUp);
+        matDataOut.col(k).noalias() = m_matBuffer.middleCols(i, m_iTaps) * m_matPhases.col(p);
+    }
+
+    m_iPhase += qint64(iNumOut) * m_iDown - iEnd;
+
+    //Carry the last samples, blocks shorter than the history keep part of the old one, so the columns may overlap
+    if(iBlockSize >= iHistory) {
+        m_matBuffer.leftCols(iHistory) = m_matBuffer.middleCols(iBlockSize, iHistory);
+    } else {
+        UTILSLIB::BlockArena::Scope scope(m_arena);
+        UTILSLIB::BlockArena::MatrixMap matCarry = m_arena.matrix(m_iNumChannels, iHistory);
+        matCarry = m_matBuffer.middleCols(iBlockSize, iHistory);
+        m_matBuffer.leftCols(iHistory) = matCarry;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool RtResample::ratio(double dFromFreq, double dToFreq, int& iUp, int& iDown, int iMaxFactor)
+{
+    if(dFromFreq <= 0.0 || dToFreq <= 0.0) {
+        return false;
+    }
+
+    for(int iCandidate = 1; iCandidate <= iMaxFactor; ++iCandidate) {
+        double dUp = dToFreq / dFromFreq * iCandidate;
+        int iCandidateUp = qRound(dUp);
+
+        if(iCandidateUp >= 1 && iCandidateUp <= iMaxFactor && qAbs(dFromFreq * iCandidateUp / iCandidate - dToFreq) <= 1e-9 * dToFreq) {
+            int iGcd = greatestCommonDivisor(iCandidateUp, iCandidate);
+            iUp = iCandidateUp / iGcd;
+            iDown = iCandidate / iGcd;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtResample::resampleOffline(const MatrixXd& matData, int iUp, int iDown, int iZeroCrossings, double dRolloff, double dBeta)
+{
+    if(iUp <= 0 || iDown <= 0) {
+        qWarning() << "RtResample::resampleOffline - Invalid factors";
+        return MatrixXd();
+    }
+
+    int iCount = int((qint64(matData.cols()) * iUp + iDown - 1) / iDown);
+
+    return resampleRange(matData, 0, iCount, iUp, iDown, iZeroCrossings, dRolloff, dBeta);
+}
+
+
+//*************************************************************************************************************
+
+bool RtResample::resampleRawSegment(const FiffRawData& raw, double dToFreq, MatrixXd& matData, MatrixXd& matTimes, fiff_int_t from, fiff_int_t to, const RowVectorXi& sel)
+{
+    int iUp, iDown;
+    if(!ratio(raw.info.sfreq, dToFreq, iUp, iDown)) {
+        qWarning() << "RtResample::resampleRawSegment - No rational factor converts" << raw.info.sfreq << "Hz to" << dToFreq << "Hz";
+        return false;
+    }
+
+    if(from < 0)
+        from = raw.first_samp;
+    if(to < 0)
+        to = raw.last_samp;
+
+    if(from < raw.first_samp || to > raw.last_samp || from > to) {
+        qWarning() << "RtResample::resampleRawSegment - Invalid segment" << from << to;
+        return false;
+    }
+
+    //Context on both sides, so only the ends of the file are continued by zeros
+    int iHalfLength = halfLength(iUp, iDown, 10, 0.9);
+    fiff_int_t iBefore = qMin<fiff_int_t>(iHalfLength, from - raw.first_samp);
+    fiff_int_t iAfter = qMin<fiff_int_t>(iHalfLength, raw.last_samp - to);
+
+    MatrixXd matRawData, matRawTimes;
+    if(!const_cast<FiffRawData&>(raw).read_raw_segment(matRawData, matRawTimes, from - iBefore, to + iAfter, sel)) {
+        qWarning() << "RtResample::resampleRawSegment - Could not read the segment";
+        return false;
+    }
+
+    int iCount = int((qint64(to - from + 1) * iUp + iDown - 1) / iDown);
+    matData = resampleRange(matRawData, iBefore, iCount, iUp, iDown, 10, 0.9, 8.0);
+
+    matTimes.resize(1, iCount);
+    for(int k = 0; k < iCount; ++k) {
+        matTimes(0, k) = (from + double(k) * iDown / iUp) / raw.info.sfreq;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+int RtResample::halfLength(int iUp, int iDown, int iZeroCrossings, double dRolloff)
+{
+    //iZeroCrossings zero crossings of the sinc, counted at the lower of both rates
+    double dHalfLengthUpsampled = iZeroCrossings * qMax(iUp, iDown) / dRolloff;
+
+    return qMax(1, int(qCeil(dHalfLengthUpsampled / iUp)));
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtResample::resampleRange(const MatrixXd& matData, int iOffset, int iCount, int iUp, int iDown, int iZeroCrossings, double dRolloff, double dBeta)
+{
+    RtResample resampler;
+    if(matData.rows() == 0 || !resampler.prepare(iUp, iDown, matData.rows(), iZeroCrossings, dRolloff, dBeta)) {
+        return MatrixXd();
+    }
+
+    //Start the output phase at the delay of the prototype plus the offset, both in upsampled samples
+    resampler.m_iPhase = (qint64(iOffset) + resampler.m_iHalfLength) * resampler.m_iUp;
+
+    //Continue the data by zeros until the last output sample has all its taps
+    qint64 iLast = resampler.m_iPhase + qint64(qMax(0, iCount - 1)) * resampler.m_iDown;
+    int iPadding = qMax<qint64>(0, iLast / resampler.m_iUp + 1 - matData.cols());
+
+    MatrixXd matPadded(matData.rows(), matData.cols() + iPadding);
+    matPadded << matData, MatrixXd::Zero(matData.rows(), iPadding);
+
+    MatrixXd matResampled;
+    resampler.resample(matPadded, matResampled);
+
+    return matResampled.leftCols(qMin<int>(iCount, matResampled.cols()));
+}
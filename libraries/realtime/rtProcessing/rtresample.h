@@ -0,0 +1,300 @@
+//=============================================================================================================
+/**
+* @file     rtresample.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RtResample class declaration.
+*
+*/
+
+#ifndef RTRESAMPLE_H
+#define RTRESAMPLE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../realtime_global.h"
+
+#include <fiff/fiff_types.h>
+
+#include <utils/blockarena.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+namespace FIFFLIB {
+    class FiffRawData;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE REALTIMELIB
+//=============================================================================================================
+
+namespace REALTIMELIB
+{
+
+
+//=============================================================================================================
+/**
+* Streaming multi-channel resampler by a rational factor iUp/iDown. The anti-aliasing lowpass is a Kaiser
+* windowed sinc, split into iUp polyphase components so only the taps which meet input samples are evaluated.
+* Every output sample is the product of the block of input columns with one reversed polyphase component, i.e. a
+* matrix-vector product over the contiguous channel columns which Eigen vectorizes. The last input samples and the
+* output phase are carried from one block to the next, so consecutive blocks give the same result as one long one.
+*
+* @brief Real-time polyphase resampler
+*/
+class REALTIMESHARED_EXPORT RtResample
+{
+
+public:
+    typedef QSharedPointer<RtResample> SPtr;             /**< Shared pointer type for RtResample. */
+    typedef QSharedPointer<const RtResample> ConstSPtr;  /**< Const shared pointer type for RtResample. */
+
+    //=========================================================================================================
+    /**
+    * Creates an empty resampler which passes the data through.
+    */
+    explicit RtResample();
+
+    //=========================================================================================================
+    /**
+    * Creates the resampler, see prepare().
+    *
+    * @param [in] iUp               upsampling factor.
+    * @param [in] iDown             downsampling factor.
+    * @param [in] iNumChannels      number of rows of the blocks.
+    * @param [in] iZeroCrossings    number of zero crossings of the sinc on each side, i.e. the filter half length in samples of the lower rate.
+    * @param [in] dRolloff          cutoff of the lowpass relative to the lower Nyquist frequency.
+    * @param [in] dBeta             Kaiser window parameter.
+    */
+    RtResample(int iUp, int iDown, int iNumChannels, int iZeroCrossings = 10, double dRolloff = 0.9, double dBeta = 8.0);
+
+    //=========================================================================================================
+    /**
+    * Designs the polyphase filter bank for resampling by iUp/iDown and resets the stream. The factors are reduced
+    * by their greatest common divisor.
+    *
+    * @param [in] iUp               upsampling factor.
+    * @param [in] iDown             downsampling factor.
+    * @param [in] iNumChannels      number of rows of the blocks.
+    * @param [in] iZeroCrossings    number of zero crossings of the sinc on each side, i.e. the filter half length in samples of the lower rate.
+    * @param [in] dRolloff          cutoff of the lowpass relative to the lower Nyquist frequency.
+    * @param [in] dBeta             Kaiser window parameter.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool prepare(int iUp, int iDown, int iNumChannels, int iZeroCrossings = 10, double dRolloff = 0.9, double dBeta = 8.0);
+
+    //=========================================================================================================
+    /**
+    * Clears the carried input samples and the output phase.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Resamples the next block of the stream. Blocks may have any number of columns, the number of output
+    * columns follows from the carried output phase, on average it is iUp/iDown times the number of input columns.
+    *
+    * @param [in] matDataIn     data which is to be resampled, one row per channel.
+    * @param [out] matDataOut   resampled data.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool resample(const Eigen::MatrixXd& matDataIn, Eigen::MatrixXd& matDataOut);
+
+    //=========================================================================================================
+    /**
+    * Returns the delay in output samples the output carries with respect to the input.
+    *
+    * @return the delay in output samples.
+    */
+    inline double delay() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the upsampling factor after reduction.
+    *
+    * @return the upsampling factor.
+    */
+    inline int up() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the downsampling factor after reduction.
+    *
+    * @return the downsampling factor.
+    */
+    inline int down() const;
+
+    //=========================================================================================================
+    /**
+    * Finds the smallest factors iUp/iDown which convert dFromFreq to dToFreq exactly, up to a relative tolerance of
+    * 1e-9.
+    *
+    * @param [in] dFromFreq         sampling frequency of the input.
+    * @param [in] dToFreq           sampling frequency of the output.
+    * @param [out] iUp              upsampling factor.
+    * @param [out] iDown            downsampling factor.
+    * @param [in] iMaxFactor        largest factor to consider.
+    *
+    * @return true if such factors exist, false otherwise.
+    */
+    static bool ratio(double dFromFreq, double dToFreq, int& iUp, int& iDown, int iMaxFactor = 1000);
+
+    //=========================================================================================================
+    /**
+    * Resamples a whole data matrix. In contrast to the streaming resampler the filter delay is compensated, the
+    * output sample k lies at the time of the input sample k*iDown/iUp and the output has ceil(cols*iUp/iDown)
+    * columns. The data is continued by zeros beyond both ends.
+    *
+    * @param [in] matData           data which is to be resampled, one row per channel.
+    * @param [in] iUp               upsampling factor.
+    * @param [in] iDown             downsampling factor.
+    * @param [in] iZeroCrossings    number of zero crossings of the sinc on each side.
+    * @param [in] dRolloff          cutoff of the lowpass relative to the lower Nyquist frequency.
+    * @param [in] dBeta             Kaiser window parameter.
+    *
+    * @return the resampled data.
+    */
+    static Eigen::MatrixXd resampleOffline(const Eigen::MatrixXd& matData, int iUp, int iDown, int iZeroCrossings = 10, double dRolloff = 0.9, double dBeta = 8.0);
+
+    //=========================================================================================================
+    /**
+    * Reads a segment of raw data and resamples it to dToFreq. The segment is read with the filter half length of
+    * context on both sides, as far as the file allows, so the filter does not see artificial edges inside the file.
+    *
+    * @param [in] raw           raw data to read from.
+    * @param [in] dToFreq       sampling frequency of the output.
+    * @param [out] matData      resampled data, one row per selected channel.
+    * @param [out] matTimes     times of the resampled samples.
+    * @param [in] from          first sample of the segment, the first sample of the file if < 0.
+    * @param [in] to            last sample of the segment, the last sample of the file if < 0.
+    * @param [in] sel           channels to read, all if empty.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    static bool resampleRawSegment(const FIFFLIB::FiffRawData& raw, double dToFreq, Eigen::MatrixXd& matData, Eigen::MatrixXd& matTimes, FIFFLIB::fiff_int_t from = -1, FIFFLIB::fiff_int_t to = -1, const Eigen::RowVectorXi& sel = Eigen::RowVectorXi());
+
+private:
+    //=========================================================================================================
+    /**
+    * Returns the filter half length in input samples.
+    *
+    * @param [in] iUp               reduced upsampling factor.
+    * @param [in] iDown             reduced downsampling factor.
+    * @param [in] iZeroCrossings    number of zero crossings of the sinc on each side.
+    * @param [in] dRolloff          cutoff of the lowpass relative to the lower Nyquist frequency.
+    *
+    * @return the half length.
+    */
+    static int halfLength(int iUp, int iDown, int iZeroCrossings, double dRolloff);
+
+    //=========================================================================================================
+    /**
+    * Resamples iCount delay compensated output samples, the first one at the time of input column iOffset.
+    *
+    * @param [in] matData           data which is to be resampled, one row per channel.
+    * @param [in] iOffset           input column of the first output sample.
+    * @param [in] iCount            number of output samples.
+    * @param [in] iUp               upsampling factor.
+    * @param [in] iDown             downsampling factor.
+    * @param [in] iZeroCrossings    number of zero crossings of the sinc on each side.
+    * @param [in] dRolloff          cutoff of the lowpass relative to the lower Nyquist frequency.
+    * @param [in] dBeta             Kaiser window parameter.
+    *
+    * @return the resampled data.
+    */
+    static Eigen::MatrixXd resampleRange(const Eigen::MatrixXd& matData, int iOffset, int iCount, int iUp, int iDown, int iZeroCrossings, double dRolloff, double dBeta);
+
+    int                 m_iUp;              /**< Upsampling factor. */
+    int                 m_iDown;            /**< Downsampling factor. */
+    int                 m_iNumChannels;     /**< Number of rows of the blocks. */
+    int                 m_iTaps;            /**< Number of taps of each polyphase component. */
+    int                 m_iHalfLength;      /**< Filter half length in input samples, the delay of the prototype filter. */
+    qint64              m_iPhase;           /**< Position of the next output in upsampled samples relative to the first column of the next block. */
+    Eigen::MatrixXd     m_matPhases;        /**< Reversed polyphase components, one column per phase. */
+    Eigen::MatrixXd     m_matBuffer;        /**< The carried input samples followed by the current block. */
+    UTILSLIB::BlockArena m_arena;           /**< Temporaries of resample(). */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline double RtResample::delay() const
+{
+    return double(m_iHalfLength) * m_iUp / m_iDown;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtResample::up() const
+{
+    return m_iUp;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtResample::down() const
+{
+    return m_iDown;
+}
+
+} // NAMESPACE
+
+#endif // RTRESAMPLE_H
@@ -0,0 +1,227 @@
+//=============================================================================================================
+/**
+* @file     rtstreamaligner.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RtStreamAligner class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtstreamaligner.h"
+
+#include <string.h>
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtGlobal>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace {
+
+const double ALIGN_MARGIN_S     = 0.02;     /**< Latency of the secondary stream in addition to its buffer length. */
+const double RESYNC_S           = 0.5;      /**< Alignment error after which the stream is aligned again. */
+const double MAX_FIFO_S         = 10.0;     /**< Queued samples after which the stream is aligned again. */
+const double PHASE_GAIN         = 0.05;     /**< Share of the alignment error corrected per buffer. */
+const double FREQUENCY_GAIN     = 0.000625; /**< Share of the alignment error taken over into the clock ratio per buffer. */
+const double MAX_DRIFT          = 0.005;    /**< Maximal deviation of the clock ratio from the nominal ratio. */
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtStreamAligner::RtStreamAligner()
+: m_iNumChannels(0)
+, m_dSFreq(0.0)
+, m_dRefSFreq(0.0)
+, m_dRatio(1.0)
+{
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void RtStreamAligner::prepare(int iNumChannels, double dSFreq, double dRefSFreq)
+{
+    m_iNumChannels = iNumChannels;
+    m_dSFreq = dSFreq;
+    m_dRefSFreq = dRefSFreq;
+    m_dRatio = dRefSFreq > 0.0 ? dSFreq / dRefSFreq : 1.0;
+
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void RtStreamAligner::reset()
+{
+    m_iFifoCount = 0;
+    m_iFifoStart = 0;
+    m_iLastArrivalNs = 0;
+    m_iMaxBlock = 0;
+    m_bAligned = false;
+    m_dPos = 0.0;
+    m_dStep = m_dRatio;
+}
+
+
+//*************************************************************************************************************
+
+bool RtStreamAligner::append(const MatrixXf& matBuffer, qint64 iArrivalNs)
+{
+    //Buffers which do not match the measurement info cannot be merged
+    if(m_iNumChannels == 0 || matBuffer.rows() != m_iNumChannels)
+        return false;
+
+    qint32 t_iCols = matBuffer.cols();
+
+    if(m_matFifo.rows() != m_iNumChannels) {
+        m_matFifo.resize(m_iNumChannels, 8 * t_iCols);
+        m_iFifoCount = 0;
+    } else if(m_iFifoCount + t_iCols > m_matFifo.cols()) {
+        m_matFifo.conservativeResize(NoChange, 2 * (m_iFifoCount + t_iCols));
+    }
+
+    m_matFifo.middleCols(m_iFifoCount, t_iCols) = matBuffer;
+    m_iFifoCount += t_iCols;
+    m_iLastArrivalNs = iArrivalNs;
+    m_iMaxBlock = qMax(m_iMaxBlock, t_iCols);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+qint32 RtStreamAligner::resample(qint64 iRefArrivalNs, MatrixXf& matOut, int iRow, bool& bResynced)
+{
+    qint32 t_iSamples = matOut.cols();
+
+    bResynced = false;
+
+    if(m_iFifoCount == 0 || m_matFifo.rows() != m_iNumChannels) {
+        matOut.middleRows(iRow, m_iNumChannels).setZero();
+        return t_iSamples;
+    }
+
+    //
+    // Position of the last reference sample in the secondary stream. Both arrival times stand for the last sample
+    // of their buffer, so the reference sample is the last queued sample shifted by the difference of the arrivals.
+    //
+    double t_dMeasured = (double)(m_iFifoStart + m_iFifoCount - 1)
+            + (double)(iRefArrivalNs - m_iLastArrivalNs) * 1.0e-9 * m_dSFreq;
+
+    double t_dError = t_dMeasured - (m_dPos + (t_iSamples - 1) * m_dStep);
+
+    if(!m_bAligned || std::fabs(t_dError) > RESYNC_S * m_dSFreq || m_iFifoCount > MAX_FIFO_S * m_dSFreq) {
+        bResynced = m_bAligned;
+        m_dStep = m_dRatio;
+        m_dPos = t_dMeasured - (t_iSamples - 1) * m_dStep;
+        m_bAligned = true;
+    } else {
+        //Phase and frequency servo, follows the drift of the amplifier clocks
+        m_dPos += PHASE_GAIN * t_dError;
+        m_dStep += FREQUENCY_GAIN * t_dError / t_iSamples;
+        m_dStep = qBound(m_dRatio * (1.0 - MAX_DRIFT), m_dStep, m_dRatio * (1.0 + MAX_DRIFT));
+    }
+
+    //
+    // Linear interpolation in place into the merged block, samples which did not arrive yet are held
+    //
+    qint32 t_iHeld = 0;
+
+    for(qint32 j = 0; j < t_iSamples; ++j)
+    {
+        double t_dPos = m_dPos + j * m_dStep;
+        qint64 t_iIndex = (qint64)std::floor(t_dPos);
+        float t_fFrac = (float)(t_dPos - t_iIndex);
+        qint64 t_iCol = t_iIndex - m_iFifoStart;
+
+        if(t_iCol < 0) {
+            matOut.block(iRow, j, m_iNumChannels, 1) = m_matFifo.col(0);
+        } else if(t_iCol + 1 < m_iFifoCount) {
+            matOut.block(iRow, j, m_iNumChannels, 1) = (1.0f - t_fFrac) * m_matFifo.col(t_iCol) + t_fFrac * m_matFifo.col(t_iCol + 1);
+        } else {
+            matOut.block(iRow, j, m_iNumChannels, 1) = m_matFifo.col(m_iFifoCount - 1);
+            ++t_iHeld;
+        }
+    }
+
+    m_dPos += t_iSamples * m_dStep;
+
+    //Drop the resampled samples, the one before the next position is kept for the interpolation
+    qint64 t_iDrop = qMin((qint64)std::floor(m_dPos) - m_iFifoStart - 1, (qint64)m_iFifoCount - 1);
+    if(t_iDrop > 0) {
+        memmove(m_matFifo.data(), m_matFifo.data() + t_iDrop * m_iNumChannels, (m_iFifoCount - t_iDrop) * m_iNumChannels * sizeof(float));
+        m_iFifoStart += t_iDrop;
+        m_iFifoCount -= t_iDrop;
+    }
+
+    return t_iHeld;
+}
+
+
+//*************************************************************************************************************
+
+qint64 RtStreamAligner::latencyNs() const
+{
+    if(m_dSFreq <= 0.0)
+        return (qint64)(ALIGN_MARGIN_S * 1.0e9);
+
+    return (qint64)(((double)m_iMaxBlock / m_dSFreq + ALIGN_MARGIN_S) * 1.0e9);
+}
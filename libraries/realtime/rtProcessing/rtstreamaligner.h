@@ -0,0 +1,230 @@
+//=============================================================================================================
+/**
+* @file     rtstreamaligner.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RtStreamAligner class declaration.
+*
+*/
+
+#ifndef RTSTREAMALIGNER_H
+#define RTSTREAMALIGNER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../realtime_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE REALTIMELIB
+//=============================================================================================================
+
+namespace REALTIMELIB
+{
+
+
+//=============================================================================================================
+/**
+* Aligns a secondary raw stream to the clock of a reference stream. Both streams are timed by the arrival of
+* their buffers, the arrival time of a buffer is taken as the time of its last sample. The reference samples
+* are mapped to positions in the secondary stream and the secondary samples are interpolated linearly at these
+* positions. A phase and frequency servo keeps the positions aligned when the amplifier clocks drift apart.
+* The secondary samples of a reference buffer arrive up to latencyNs() after the reference buffer, the caller
+* holds the reference buffers back by this latency before it calls resample().
+*
+* @brief Aligns a secondary raw stream to a reference stream
+*/
+class REALTIMESHARED_EXPORT RtStreamAligner
+{
+
+public:
+    typedef QSharedPointer<RtStreamAligner> SPtr;             /**< Shared pointer type for RtStreamAligner. */
+    typedef QSharedPointer<const RtStreamAligner> ConstSPtr;  /**< Const shared pointer type for RtStreamAligner. */
+
+    //=========================================================================================================
+    /**
+    * Creates an empty aligner, see prepare().
+    */
+    explicit RtStreamAligner();
+
+    //=========================================================================================================
+    /**
+    * Sets the channels and the sampling rates and resets the stream.
+    *
+    * @param [in] iNumChannels      number of rows of the secondary buffers.
+    * @param [in] dSFreq            sampling frequency of the secondary stream.
+    * @param [in] dRefSFreq         sampling frequency of the reference stream.
+    */
+    void prepare(int iNumChannels, double dSFreq, double dRefSFreq);
+
+    //=========================================================================================================
+    /**
+    * Clears the queued samples and the alignment.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Appends a buffer of the secondary stream to the queue. Buffers with the wrong number of rows are ignored.
+    *
+    * @param [in] matBuffer         the buffer, one row per channel.
+    * @param [in] iArrivalNs        the arrival time of the buffer in ns.
+    *
+    * @return true if the buffer was queued, false otherwise.
+    */
+    bool append(const Eigen::MatrixXf& matBuffer, qint64 iArrivalNs);
+
+    //=========================================================================================================
+    /**
+    * Resamples the queued samples to the next reference buffer and drops the samples which are no longer needed.
+    * Samples which did not arrive yet are held.
+    *
+    * @param [in] iRefArrivalNs     the arrival time of the reference buffer in ns.
+    * @param [out] matOut           the merged block, it has the columns of the reference buffer.
+    * @param [in] iRow              first row of the secondary channels in matOut.
+    * @param [out] bResynced        whether the stream had to be aligned again.
+    *
+    * @return the number of held samples.
+    */
+    qint32 resample(qint64 iRefArrivalNs, Eigen::MatrixXf& matOut, int iRow, bool& bResynced);
+
+    //=========================================================================================================
+    /**
+    * Returns the latency of the secondary samples with respect to the reference samples of the same time, i.e.
+    * the length of the largest buffer plus a margin for the transport jitter.
+    *
+    * @return the latency in ns.
+    */
+    qint64 latencyNs() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of secondary samples per reference sample the servo currently assumes.
+    *
+    * @return the clock ratio.
+    */
+    inline double step() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of rows of the secondary buffers.
+    *
+    * @return the number of channels, 0 before prepare().
+    */
+    inline int numChannels() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the sampling frequency of the secondary stream.
+    *
+    * @return the sampling frequency.
+    */
+    inline double sFreq() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the sampling frequency of the reference stream.
+    *
+    * @return the sampling frequency.
+    */
+    inline double refSFreq() const;
+
+private:
+    int                 m_iNumChannels;     /**< Number of rows of the secondary buffers. */
+    double              m_dSFreq;           /**< Sampling frequency of the secondary stream. */
+    double              m_dRefSFreq;        /**< Sampling frequency of the reference stream. */
+    double              m_dRatio;           /**< Nominal sampling rate ratio of the secondary to the reference stream. */
+    Eigen::MatrixXf     m_matFifo;          /**< Received samples which were not resampled yet. */
+    qint32              m_iFifoCount;       /**< Number of samples in m_matFifo. */
+    qint64              m_iFifoStart;       /**< Index of the first sample of m_matFifo in the secondary stream. */
+    qint64              m_iLastArrivalNs;   /**< Arrival time of the last buffer. */
+    qint32              m_iMaxBlock;        /**< Largest buffer, sets the latency. */
+    bool                m_bAligned;         /**< Whether m_dPos and m_dStep are aligned to the reference stream. */
+    double              m_dPos;             /**< Position of the next reference sample in the secondary stream. */
+    double              m_dStep;            /**< Secondary samples per reference sample, follows the clock drift. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline double RtStreamAligner::step() const
+{
+    return m_dStep;
+}
+
+
+//*************************************************************************************************************
+
+inline int RtStreamAligner::numChannels() const
+{
+    return m_iNumChannels;
+}
+
+
+//*************************************************************************************************************
+
+inline double RtStreamAligner::sFreq() const
+{
+    return m_dSFreq;
+}
+
+
+//*************************************************************************************************************
+
+inline double RtStreamAligner::refSFreq() const
+{
+    return m_dRefSFreq;
+}
+
+} // NAMESPACE
+
+#endif // RTSTREAMALIGNER_H
@@ -0,0 +1,260 @@
+//=============================================================================================================
+/**
+* @file     blockarena.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the BlockArena class.
+*
+*/
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "blockarena.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// SYSTEM INCLUDES
+//=============================================================================================================
+
+#include <stdlib.h>
+#include <stdint.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+const qint64 s_iAlignment = 64;     /**< Alignment of the temporaries, a cache line and at least EIGEN_MAX_ALIGN_BYTES. */
+
+
+//*************************************************************************************************************
+
+qint64 alignedSize(qint64 iBytes)
+{
+    return (iBytes + s_iAlignment - 1) / s_iAlignment * s_iAlignment;
+}
+
+
+//*************************************************************************************************************
+
+char* alignedAlloc(qint64 iBytes)
+{
+    //The offset to the original pointer is stored in front of the aligned block
+    char* pRaw = static_cast<char*>(malloc(size_t(iBytes + s_iAlignment)));
+    if(!pRaw) {
+        return NULL;
+    }
+
+    char* pAligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(pRaw) + s_iAlignment) & ~uintptr_t(s_iAlignment - 1));
+    *(reinterpret_cast<unsigned char*>(pAligned) - 1) = static_cast<unsigned char>(pAligned - pRaw);
+    return pAligned;
+}
+
+
+//*************************************************************************************************************
+
+void alignedFree(char* pAligned)
+{
+    if(pAligned) {
+        free(pAligned - *(reinterpret_cast<unsigned char*>(pAligned) - 1));
+    }
+}
+
+} // anonymous namespace
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+BlockArena::Scope::Scope(BlockArena& arena)
+: m_arena(arena)
+, m_iOffset(arena.m_iOffset)
+, m_iUsed(arena.m_iUsed)
+, m_iChunks(arena.m_vecChunks.size())
+{
+}
+
+
+//*************************************************************************************************************
+
+BlockArena::Scope::~Scope()
+{
+    m_arena.release(m_iOffset, m_iUsed, m_iChunks);
+}
+
+
+//*************************************************************************************************************
+
+BlockArena::BlockArena(qint64 iBytes)
+: m_pBuffer(NULL)
+, m_iCapacity(0)
+, m_iOffset(0)
+, m_iUsed(0)
+, m_iHighWaterMark(0)
+, m_iHeapAllocations(0)
+{
+    reserve(iBytes);
+}
+
+
+//*************************************************************************************************************
+
+BlockArena::BlockArena(const BlockArena& other)
+: m_pBuffer(NULL)
+, m_iCapacity(0)
+, m_iOffset(0)
+, m_iUsed(0)
+, m_iHighWaterMark(0)
+, m_iHeapAllocations(0)
+{
+    reserve(qMax(other.m_iCapacity, other.m_iHighWaterMark));
+}
+
+
+//*************************************************************************************************************
+
+BlockArena::~BlockArena()
+{
+    release(0, 0, 0);
+    alignedFree(m_pBuffer);
+}
+
+
+//*************************************************************************************************************
+
+BlockArena& BlockArena::operator=(const BlockArena& other)
+{
+    if(this != &other) {
+        reset();
+        reserve(qMax(other.m_iCapacity, other.m_iHighWaterMark));
+    }
+
+    return *this;
+}
+
+
+//*************************************************************************************************************
+
+void BlockArena::reserve(qint64 iBytes)
+{
+    if(m_iUsed > 0) {
+        qWarning("BlockArena::reserve - Temporaries are in use, the capacity is not changed.");
+        return;
+    }
+
+    if(iBytes > m_iCapacity) {
+        allocateBuffer(alignedSize(iBytes));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void BlockArena::reset()
+{
+    release(0, 0, 0);
+}
+
+
+//*************************************************************************************************************
+
+void* BlockArena::allocate(qint64 iBytes)
+{
+    qint64 iSize = alignedSize(qMax(qint64(1), iBytes));
+
+    m_iUsed += iSize;
+    m_iHighWaterMark = qMax(m_iHighWaterMark, m_iUsed);
+
+    if(m_iOffset + iSize <= m_iCapacity) {
+        void* pMemory = m_pBuffer + m_iOffset;
+        m_iOffset += iSize;
+        return pMemory;
+    }
+
+    //The block needs more than the buffer, the buffer grows when the arena is released to its start
+    char* pChunk = alignedAlloc(iSize);
+    if(!pChunk) {
+        qFatal("BlockArena::allocate - Out of memory.");
+    }
+
+    m_vecChunks.append(pChunk);
+    ++m_iHeapAllocations;
+
+    return pChunk;
+}
+
+
+//*************************************************************************************************************
+
+void BlockArena::release(qint64 iOffset, qint64 iUsed, int iChunks)
+{
+    for(int i = iChunks; i < m_vecChunks.size(); ++i) {
+        alignedFree(m_vecChunks[i]);
+    }
+    m_vecChunks.resize(iChunks);
+
+    m_iOffset = iOffset;
+    m_iUsed = iUsed;
+
+    if(m_iUsed == 0 && m_iHighWaterMark > m_iCapacity) {
+        allocateBuffer(m_iHighWaterMark);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void BlockArena::allocateBuffer(qint64 iBytes)
+{
+    alignedFree(m_pBuffer);
+
+    m_pBuffer = alignedAlloc(iBytes);
+    if(!m_pBuffer) {
+        qFatal("BlockArena::allocateBuffer - Out of memory.");
+    }
+
+    m_iCapacity = iBytes;
+    ++m_iHeapAllocations;
+}
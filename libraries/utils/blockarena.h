@@ -0,0 +1,329 @@
+//=============================================================================================================
+/**
+* @file     blockarena.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the BlockArena class.
+*
+*/
+#ifndef BLOCKARENA_H
+#define BLOCKARENA_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+* Bump allocator for the temporaries of one processing block. The temporaries are handed out as Eigen Maps on
+* one contiguous buffer and are all released at once with reset() or when a Scope ends, e.g. at the end of the
+* block. A block which needs more than the buffer holds gets heap chunks for the rest. When the arena is
+* released to its start, the buffer is grown to the largest block seen so far, so after the first block the
+* processing of equally sized blocks does not touch the heap anymore.
+*
+* The memory is aligned to 64 bytes, which satisfies the vectorization of Eigen. The Maps stay valid until the
+* arena or the Scope they were taken in is released. The arena is not thread safe, each thread uses its own. A
+* copy of an arena gets empty storage of the same capacity, the temporaries themselves are not copied.
+*
+* @brief Block scoped arena for Eigen temporaries.
+*/
+class UTILSSHARED_EXPORT BlockArena
+{
+public:
+    typedef Eigen::Map<Eigen::MatrixXd, Eigen::AlignedMax> MatrixMap;          /**< Matrix on the arena. */
+    typedef Eigen::Map<Eigen::VectorXd, Eigen::AlignedMax> VectorMap;          /**< Column vector on the arena. */
+    typedef Eigen::Map<Eigen::RowVectorXd, Eigen::AlignedMax> RowVectorMap;    /**< Row vector on the arena. */
+
+    //=========================================================================================================
+    /**
+    * Remembers the state of an arena and releases everything taken after it when it goes out of scope.
+    */
+    class Scope
+    {
+    public:
+        //=====================================================================================================
+        /**
+        * Remembers the current state of the arena.
+        *
+        * @param[in] arena      The arena.
+        */
+        explicit Scope(BlockArena& arena);
+
+        //=====================================================================================================
+        /**
+        * Releases the temporaries taken since the construction.
+        */
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+
+        BlockArena&     m_arena;        /**< The arena. */
+        qint64          m_iOffset;      /**< Offset into the buffer at construction. */
+        qint64          m_iUsed;        /**< Bytes in use at construction. */
+        int             m_iChunks;      /**< Number of heap chunks at construction. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs an arena.
+    *
+    * @param[in] iBytes     The initial capacity in bytes, the arena grows to the needs of the blocks.
+    */
+    explicit BlockArena(qint64 iBytes = 0);
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty arena of the capacity of another one.
+    *
+    * @param[in] other      The arena whose capacity is used.
+    */
+    BlockArena(const BlockArena& other);
+
+    //=========================================================================================================
+    /**
+    * Frees the storage.
+    */
+    ~BlockArena();
+
+    //=========================================================================================================
+    /**
+    * Releases all temporaries and gives the arena the capacity of the other one.
+    *
+    * @param[in] other      The arena whose capacity is used.
+    *
+    * @return this arena.
+    */
+    BlockArena& operator=(const BlockArena& other);
+
+    //=========================================================================================================
+    /**
+    * Grows the buffer to at least the given capacity. Only allowed while no temporaries are taken.
+    *
+    * @param[in] iBytes     The capacity in bytes.
+    */
+    void reserve(qint64 iBytes);
+
+    //=========================================================================================================
+    /**
+    * Releases all temporaries. The buffer grows to the largest amount taken so far, if it was exceeded.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Takes raw memory from the arena.
+    *
+    * @param[in] iBytes     The number of bytes.
+    *
+    * @return the memory, aligned to 64 bytes.
+    */
+    void* allocate(qint64 iBytes);
+
+    //=========================================================================================================
+    /**
+    * Takes an uninitialized matrix from the arena.
+    *
+    * @param[in] iRows      The number of rows.
+    * @param[in] iCols      The number of columns.
+    *
+    * @return the matrix.
+    */
+    inline MatrixMap matrix(int iRows, int iCols);
+
+    //=========================================================================================================
+    /**
+    * Takes an uninitialized column vector from the arena.
+    *
+    * @param[in] iSize      The number of coefficients.
+    *
+    * @return the vector.
+    */
+    inline VectorMap vector(int iSize);
+
+    //=========================================================================================================
+    /**
+    * Takes an uninitialized row vector from the arena.
+    *
+    * @param[in] iSize      The number of coefficients.
+    *
+    * @return the vector.
+    */
+    inline RowVectorMap rowVector(int iSize);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of bytes taken since the last release.
+    *
+    * @return the bytes in use.
+    */
+    inline qint64 used() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the size of the buffer.
+    *
+    * @return the capacity in bytes.
+    */
+    inline qint64 capacity() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the largest number of bytes which was in use at a time.
+    *
+    * @return the high water mark in bytes.
+    */
+    inline qint64 highWaterMark() const;
+
+    //=========================================================================================================
+    /**
+    * Returns how often the arena allocated heap memory, for the buffer or for chunks beyond it. It stays
+    * constant once the arena has reached the size the blocks need.
+    *
+    * @return the number of heap allocations.
+    */
+    inline qint64 heapAllocations() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Releases everything taken after a state, see Scope.
+    *
+    * @param[in] iOffset    Offset into the buffer of the state.
+    * @param[in] iUsed      Bytes in use of the state.
+    * @param[in] iChunks    Number of heap chunks of the state.
+    */
+    void release(qint64 iOffset, qint64 iUsed, int iChunks);
+
+    //=========================================================================================================
+    /**
+    * Replaces the buffer by one of the given capacity.
+    *
+    * @param[in] iBytes     The capacity in bytes.
+    */
+    void allocateBuffer(qint64 iBytes);
+
+    char*               m_pBuffer;          /**< The buffer, aligned to 64 bytes. */
+    qint64              m_iCapacity;        /**< Size of the buffer in bytes. */
+    qint64              m_iOffset;          /**< First free byte of the buffer. */
+    qint64              m_iUsed;            /**< Bytes taken since the last release, including the chunks. */
+    qint64              m_iHighWaterMark;   /**< Largest value of m_iUsed. */
+    qint64              m_iHeapAllocations; /**< Number of heap allocations. */
+    QVector<char*>      m_vecChunks;        /**< Heap chunks of the temporaries which did not fit the buffer. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline BlockArena::MatrixMap BlockArena::matrix(int iRows, int iCols)
+{
+    return MatrixMap(static_cast<double*>(allocate(qint64(iRows) * iCols * sizeof(double))), iRows, iCols);
+}
+
+
+//*************************************************************************************************************
+
+inline BlockArena::VectorMap BlockArena::vector(int iSize)
+{
+    return VectorMap(static_cast<double*>(allocate(qint64(iSize) * sizeof(double))), iSize);
+}
+
+
+//*************************************************************************************************************
+
+inline BlockArena::RowVectorMap BlockArena::rowVector(int iSize)
+{
+    return RowVectorMap(static_cast<double*>(allocate(qint64(iSize) * sizeof(double))), iSize);
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 BlockArena::used() const
+{
+    return m_iUsed;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 BlockArena::capacity() const
+{
+    return m_iCapacity;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 BlockArena::highWaterMark() const
+{
+    return m_iHighWaterMark;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 BlockArena::heapAllocations() const
+{
+    return m_iHeapAllocations;
+}
+
+} // NAMESPACE UTILSLIB
+
+#endif // BLOCKARENA_H
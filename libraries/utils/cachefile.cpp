@@ -0,0 +1,159 @@
+//=============================================================================================================
+/**
+* @file     cachefile.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the definition of the CacheFile class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "cachefile.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+const char CACHEFILE_MAGIC[] = "MNECAC01";              /**< Identifies a cache file and its format version. */
+const quint32 CACHEFILE_BYTE_ORDER_MARK = 0x01020304;   /**< Written raw to detect cache files of another byte order. */
+
+} // anonymous namespace
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+bool CacheFile::write(const QString& sFilePath, const QString& sKind, const QByteArray& baKey, const QByteArray& baPayload)
+{
+    QSaveFile file(sFilePath);
+    if(!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.writeRawData(CACHEFILE_MAGIC, sizeof(CACHEFILE_MAGIC) - 1);
+    stream.writeRawData((const char *)&CACHEFILE_BYTE_ORDER_MARK, sizeof(CACHEFILE_BYTE_ORDER_MARK));
+    stream << sKind << baKey << baPayload;
+
+    if(stream.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+
+//*************************************************************************************************************
+
+bool CacheFile::read(const QString& sFilePath, const QString& sKind, const QByteArray& baKey, QByteArray& baPayload)
+{
+    QFile file(sFilePath);
+    if(!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    char cMagic[sizeof(CACHEFILE_MAGIC) - 1];
+    quint32 uiByteOrderMark = 0;
+    if(stream.readRawData(cMagic, sizeof(cMagic)) != (int)sizeof(cMagic)
+            || memcmp(cMagic, CACHEFILE_MAGIC, sizeof(cMagic)) != 0
+            || stream.readRawData((char *)&uiByteOrderMark, sizeof(uiByteOrderMark)) != (int)sizeof(uiByteOrderMark)
+            || uiByteOrderMark != CACHEFILE_BYTE_ORDER_MARK) {
+        return false;
+    }
+
+    QString sFileKind;
+    QByteArray baFileKey;
+    stream >> sFileKind >> baFileKey;
+    if(stream.status() != QDataStream::Ok || sFileKind != sKind || baFileKey != baKey) {
+        return false;
+    }
+
+    stream >> baPayload;
+
+    return stream.status() == QDataStream::Ok;
+}
+
+
+//*************************************************************************************************************
+
+QByteArray CacheFile::sourceKey(const QString& sSourceFile)
+{
+    QFileInfo info(sSourceFile);
+    if(!info.exists()) {
+        return QByteArray();
+    }
+
+    QByteArray baKey;
+    QDataStream stream(&baKey, QIODevice::WriteOnly);
+    stream << (qint64)info.size() << (qint64)info.lastModified().toMSecsSinceEpoch();
+
+    return baKey;
+}
@@ -0,0 +1,184 @@
+//=============================================================================================================
+/**
+* @file     cachefile.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the CacheFile class.
+*
+*/
+
+#ifndef CACHEFILE_H
+#define CACHEFILE_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QString>
+#include <QByteArray>
+#include <QDataStream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//=============================================================================================================
+/**
+* Common format of the cache files of the libraries. A cache file starts with a magic, a byte order mark, the
+* kind of its content and a key which identifies what the content was derived from, e.g. size and modification
+* time of a source file or the parameters of a computation. The content follows in native byte order, so that
+* matrices are read back with block reads. Files are written atomically: a concurrent reader sees either the
+* previous file or the complete new one. The files are located with CacheLocation.
+*
+* @brief Reading and writing of cache files.
+*/
+class UTILSSHARED_EXPORT CacheFile
+{
+public:
+    //=========================================================================================================
+    /**
+    * Writes a cache file.
+    *
+    * @param[in] sFilePath      The cache file, see CacheLocation::filePath.
+    * @param[in] sKind          The kind of the content, e.g. "surf".
+    * @param[in] baKey          Identifies what the content was derived from.
+    * @param[in] baPayload      The content.
+    *
+    * @return true if the file was written, false otherwise.
+    */
+    static bool write(const QString& sFilePath, const QString& sKind, const QByteArray& baKey, const QByteArray& baPayload);
+
+    //=========================================================================================================
+    /**
+    * Reads a cache file. Fails if the file does not exist, has another format or byte order, or was written
+    * for another kind or key.
+    *
+    * @param[in] sFilePath      The cache file, see CacheLocation::filePath.
+    * @param[in] sKind          The kind of the content, e.g. "surf".
+    * @param[in] baKey          Identifies what the content was derived from.
+    * @param[out] baPayload     The content.
+    *
+    * @return true if the content was read, false otherwise.
+    */
+    static bool read(const QString& sFilePath, const QString& sKind, const QByteArray& baKey, QByteArray& baPayload);
+
+    //=========================================================================================================
+    /**
+    * Returns the key of content which was derived from a file, i.e. its size and modification time.
+    *
+    * @param[in] sSourceFile    The source file.
+    *
+    * @return the key, empty if the file does not exist.
+    */
+    static QByteArray sourceKey(const QString& sSourceFile);
+
+    //=========================================================================================================
+    /**
+    * Writes a matrix with its dimensions to a payload.
+    *
+    * @param[in] stream         The payload stream.
+    * @param[in] mat            The matrix to write.
+    */
+    template<typename T>
+    static void writeMatrix(QDataStream& stream, const T& mat);
+
+    //=========================================================================================================
+    /**
+    * Reads a matrix written by writeMatrix from a payload.
+    *
+    * @param[in] stream         The payload stream.
+    * @param[out] mat           The read matrix.
+    *
+    * @return true if the matrix was read completely and fits the matrix type, false otherwise.
+    */
+    template<typename T>
+    static bool readMatrix(QDataStream& stream, T& mat);
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+template<typename T>
+void CacheFile::writeMatrix(QDataStream& stream, const T& mat)
+{
+    stream << (qint32)mat.rows() << (qint32)mat.cols();
+    stream.writeRawData((const char *)mat.data(), (int)(mat.size() * sizeof(typename T::Scalar)));
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+bool CacheFile::readMatrix(QDataStream& stream, T& mat)
+{
+    qint32 iRows = 0, iCols = 0;
+    stream >> iRows >> iCols;
+
+    if(stream.status() != QDataStream::Ok || iRows < 0 || iCols < 0
+            || (T::RowsAtCompileTime != Eigen::Dynamic && iRows != T::RowsAtCompileTime)
+            || (T::ColsAtCompileTime != Eigen::Dynamic && iCols != T::ColsAtCompileTime)) {
+        return false;
+    }
+
+    mat.resize(iRows, iCols);
+    const int iBytes = (int)(mat.size() * sizeof(typename T::Scalar));
+
+    return stream.readRawData((char *)mat.data(), iBytes) == iBytes;
+}
+
+} // NAMESPACE UTILSLIB
+
+#endif // CACHEFILE_H
@@ -0,0 +1,145 @@
+//=============================================================================================================
+/**
+* @file     cachelocation.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the CacheLocation class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "cachelocation.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStandardPaths>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+//=============================================================================================================
+/**
+* The configured cache directory.
+*/
+struct CacheRegistry {
+    QMutex      mutex;          /**< Guards the directory. */
+    QString     sDirectory;     /**< The directory, empty for the default location. */
+
+    CacheRegistry()
+    : sDirectory(QString::fromLocal8Bit(qgetenv("MNE_CACHE_DIR")))
+    {
+    }
+};
+
+
+//*************************************************************************************************************
+
+CacheRegistry& cacheRegistry()
+{
+    static CacheRegistry s_registry;
+    return s_registry;
+}
+
+} // anonymous namespace
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+void CacheLocation::setDirectory(const QString& sDirectory)
+{
+    CacheRegistry& registry = cacheRegistry();
+    QMutexLocker locker(&registry.mutex);
+    registry.sDirectory = sDirectory;
+}
+
+
+//*************************************************************************************************************
+
+QString CacheLocation::directory()
+{
+    CacheRegistry& registry = cacheRegistry();
+    QMutexLocker locker(&registry.mutex);
+    if(!registry.sDirectory.isEmpty()) {
+        return registry.sDirectory;
+    }
+
+    QString sDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return sDirectory.isEmpty() ? QDir::tempPath() + QString("/mne-cpp") : sDirectory;
+}
+
+
+//*************************************************************************************************************
+
+QString CacheLocation::filePath(const QString& sFileName)
+{
+    QDir dir(directory());
+    if(!dir.exists() && !dir.mkpath(QString("."))) {
+        qWarning("CacheLocation::filePath - Could not create the cache directory %s.", dir.path().toUtf8().constData());
+    }
+    return dir.filePath(sFileName);
+}
+
+
+//*************************************************************************************************************
+
+QString CacheLocation::filePath(const QString& sSource, const QString& sSuffix)
+{
+    QFileInfo info(sSource);
+    QByteArray key = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).left(8).toHex();
+    return filePath(QString("%1-%2%3").arg(info.completeBaseName()).arg(QString(key)).arg(sSuffix));
+}
@@ -0,0 +1,120 @@
+//=============================================================================================================
+/**
+* @file     cachelocation.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the CacheLocation class.
+*
+*/
+
+#ifndef CACHELOCATION_H
+#define CACHELOCATION_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//=============================================================================================================
+/**
+* Central location of the files the libraries cache derived data in, e.g. BEM solutions, compiled dictionaries
+* and event lists. The caches are not written next to their input, which may be read-only or shared.
+*
+* The directory is read from the environment variable MNE_CACHE_DIR when the library is loaded and can be
+* changed by setDirectory(). Without either, QStandardPaths::CacheLocation is used.
+*
+* @brief Directory of the cache files.
+*/
+class UTILSSHARED_EXPORT CacheLocation
+{
+public:
+    //=========================================================================================================
+    /**
+    * Sets the cache directory.
+    *
+    * @param[in] sDirectory     The directory, an empty string selects the default location.
+    */
+    static void setDirectory(const QString& sDirectory);
+
+    //=========================================================================================================
+    /**
+    * Returns the cache directory.
+    *
+    * @return the directory.
+    */
+    static QString directory();
+
+    //=========================================================================================================
+    /**
+    * Returns the path of a cache file in the cache directory. The directory is created if it does not exist.
+    *
+    * @param[in] sFileName      The name of the cache file.
+    *
+    * @return the path of the cache file.
+    */
+    static QString filePath(const QString& sFileName);
+
+    //=========================================================================================================
+    /**
+    * Returns the path of the cache file which belongs to an input file. The name consists of the base name of
+    * the input, a hash of its absolute path, so that inputs with the same name do not share a cache file, and
+    * the suffix.
+    *
+    * @param[in] sSource        The input file.
+    * @param[in] sSuffix        The suffix of the cache file, e.g. ".events".
+    *
+    * @return the path of the cache file.
+    */
+    static QString filePath(const QString& sSource, const QString& sSuffix);
+};
+
+} // NAMESPACE UTILSLIB
+
+#endif // CACHELOCATION_H
@@ -0,0 +1,498 @@
+//=============================================================================================================
+/**
+* @file     executionconfig.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the ExecutionConfig class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "executionconfig.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// SYSTEM INCLUDES
+//=============================================================================================================
+
+#if defined(Q_OS_LINUX)
+    #include <pthread.h>
+    #include <sched.h>
+#elif defined(Q_OS_WIN)
+    #include <windows.h>
+#endif
+
+#include <stdio.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+//=============================================================================================================
+/**
+* The configuration of one pool.
+*/
+struct PoolConfig {
+    int                             iThreads;       /**< Number of threads, 0 for the default size. */
+    QThread::Priority               priority;       /**< Thread priority. */
+    QList<int>                      lCores;         /**< The cores the threads are pinned to. */
+    QSharedPointer<QThreadPool>     pPool;          /**< The pool, created on first use. Not used for the default pool. */
+
+    PoolConfig()
+    : iThreads(0)
+    , priority(QThread::InheritPriority)
+    {
+    }
+};
+
+
+//=============================================================================================================
+/**
+* The configuration of all pools.
+*/
+struct ExecutionRegistry {
+    QMutex                      mutex;              /**< Guards the configuration. */
+    QMap<QString, PoolConfig>   mapPools;           /**< The configured pools by name. */
+    int                         iOpenMpThreads;     /**< The OpenMP limit, -1 for none. */
+
+    ExecutionRegistry()
+    : iOpenMpThreads(-1)
+    {
+    }
+};
+
+
+//*************************************************************************************************************
+
+ExecutionRegistry& executionRegistry()
+{
+    static ExecutionRegistry s_registry;
+    return s_registry;
+}
+
+
+//*************************************************************************************************************
+
+const char* const s_priorityNames[] = { "idle", "lowest", "low", "normal", "high", "highest", "timecritical", "inherit" };   /**< The names of the QThread::Priority values. */
+
+
+//*************************************************************************************************************
+
+bool parsePriority(const QString& sPriority, QThread::Priority& priority)
+{
+    for(int i = 0; i <= QThread::InheritPriority; ++i) {
+        if(sPriority.compare(QString(s_priorityNames[i]), Qt::CaseInsensitive) == 0) {
+            priority = static_cast<QThread::Priority>(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+bool parseCores(const QString& sCores, QList<int>& lCores)
+{
+    QStringList lRanges = sCores.split(',', QString::SkipEmptyParts);
+
+    for(int i = 0; i < lRanges.size(); ++i) {
+        QStringList lBounds = lRanges[i].split('-');
+        bool bFirst = false, bLast = false;
+
+        int iFirst = lBounds[0].trimmed().toInt(&bFirst);
+        int iLast = lBounds.size() == 2 ? lBounds[1].trimmed().toInt(&bLast) : iFirst;
+
+        if(!bFirst || (lBounds.size() == 2 && !bLast) || lBounds.size() > 2 || iFirst < 0 || iLast < iFirst) {
+            return false;
+        }
+
+        for(int iCore = iFirst; iCore <= iLast; ++iCore) {
+            if(!lCores.contains(iCore)) {
+                lCores.append(iCore);
+            }
+        }
+    }
+
+    return !lCores.isEmpty();
+}
+
+
+//*************************************************************************************************************
+
+int poolThreads(const ExecutionRegistry& registry, const QString& sName)
+{
+    int iThreads = registry.mapPools.value(sName).iThreads;
+
+    if(iThreads < 1 && sName != QString("default")) {
+        iThreads = registry.mapPools.value(QString("default")).iThreads;
+    }
+
+    return iThreads < 1 ? qMax(1, QThread::idealThreadCount()) : iThreads;
+}
+
+
+//*************************************************************************************************************
+
+bool pinCurrentThread(const QList<int>& lCores)
+{
+    if(lCores.isEmpty()) {
+        return true;
+    }
+
+#if defined(Q_OS_LINUX)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+
+    for(int i = 0; i < lCores.size(); ++i) {
+        if(lCores[i] < CPU_SETSIZE) {
+            CPU_SET(lCores[i], &cpuSet);
+        }
+    }
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#elif defined(Q_OS_WIN)
+    DWORD_PTR mask = 0;
+
+    for(int i = 0; i < lCores.size(); ++i) {
+        if(lCores[i] < static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+            mask |= static_cast<DWORD_PTR>(1) << lCores[i];
+        }
+    }
+
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    return false;
+#endif
+}
+
+
+//=============================================================================================================
+/**
+* Applies the configuration of MNE_EXECUTION when the library is loaded.
+*/
+struct ExecutionAutoConfig {
+    ExecutionAutoConfig()
+    {
+        QString sConfig = QString::fromLocal8Bit(qgetenv("MNE_EXECUTION"));
+
+        if(!sConfig.isEmpty() && !ExecutionConfig::configure(sConfig)) {
+            fprintf(stderr, "ExecutionConfig: Ignoring MNE_EXECUTION.\n");
+        }
+    }
+};
+
+ExecutionAutoConfig s_executionAutoConfig;
+
+} // anonymous namespace
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+void ExecutionConfig::setPool(const QString& sName, int iThreads, QThread::Priority priority, const QList<int>& lCores)
+{
+    ExecutionRegistry& registry = executionRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    PoolConfig& config = registry.mapPools[sName];
+    config.iThreads = qMax(0, iThreads);
+    config.priority = priority;
+    config.lCores = lCores;
+
+    //Resize the pools which already exist, the default pool also sizes the pools without an own size
+    QMap<QString, PoolConfig>::iterator it;
+    for(it = registry.mapPools.begin(); it != registry.mapPools.end(); ++it) {
+        if(it.value().pPool) {
+            it.value().pPool->setMaxThreadCount(poolThreads(registry, it.key()));
+        }
+    }
+
+    if(sName == QString("default")) {
+        QThreadPool::globalInstance()->setMaxThreadCount(poolThreads(registry, sName));
+    }
+}
+
+
+//*************************************************************************************************************
+
+int ExecutionConfig::threadCount(const QString& sName)
+{
+    ExecutionRegistry& registry = executionRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    return poolThreads(registry, sName);
+}
+
+
+//*************************************************************************************************************
+
+QThread::Priority ExecutionConfig::priority(const QString& sName)
+{
+    ExecutionRegistry& registry = executionRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    return registry.mapPools.value(sName).priority;
+}
+
+
+//*************************************************************************************************************
+
+QList<int> ExecutionConfig::cores(const QString& sName)
+{
+    ExecutionRegistry& registry = executionRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    return registry.mapPools.value(sName).lCores;
+}
+
+
+//*************************************************************************************************************
+
+QThreadPool* ExecutionConfig::pool(const QString& sName)
+{
+    if(sName == QString("default")) {
+        return QThreadPool::globalInstance();
+    }
+
+    ExecutionRegistry& registry = executionRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    PoolConfig& config = registry.mapPools[sName];
+
+    if(!config.pPool) {
+        config.pPool = QSharedPointer<QThreadPool>(new QThreadPool);
+        config.pPool->setMaxThreadCount(poolThreads(registry, sName));
+    }
+
+    return config.pPool.data();
+}
+
+
+//*************************************************************************************************************
+
+QFuture<void> ExecutionConfig::run(const QString& sName, const std::function<void()>& work)
+{
+    return QtConcurrent::run(pool(sName), [sName, work]() {
+        ExecutionConfig::configureThread(sName);
+        work();
+    });
+}
+
+
+//*************************************************************************************************************
+
+bool ExecutionConfig::configureThread(const QString& sName)
+{
+    ExecutionRegistry& registry = executionRegistry();
+
+    registry.mutex.lock();
+    QThread::Priority priority = registry.mapPools.value(sName).priority;
+    QList<int> lCores = registry.mapPools.value(sName).lCores;
+    registry.mutex.unlock();
+
+    if(priority != QThread::InheritPriority && QThread::currentThread()->priority() != priority) {
+        QThread::currentThread()->setPriority(priority);
+    }
+
+    return pinCurrentThread(lCores);
+}
+
+
+//*************************************************************************************************************
+
+void ExecutionConfig::setOpenMpThreads(int iThreads)
+{
+    ExecutionRegistry& registry = executionRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    registry.iOpenMpThreads = iThreads < 1 ? -1 : iThreads;
+}
+
+
+//*************************************************************************************************************
+
+int ExecutionConfig::openMpThreads()
+{
+    ExecutionRegistry& registry = executionRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    return registry.iOpenMpThreads;
+}
+
+
+//*************************************************************************************************************
+
+bool ExecutionConfig::configure(const QString& sConfig)
+{
+    QList<QString> lNames;
+    QList<PoolConfig> lConfigs;
+    int iOpenMpThreads = 0;
+
+    //Parse everything first, so an invalid configuration changes nothing
+    QStringList lEntries = sConfig.split(';', QString::SkipEmptyParts);
+
+    for(int i = 0; i < lEntries.size(); ++i) {
+        QString sEntry = lEntries[i].trimmed();
+        int iAssign = sEntry.indexOf('=');
+
+        if(iAssign <= 0) {
+            fprintf(stderr, "ExecutionConfig::configure - Entry \"%s\" has no pool name.\n", sEntry.toUtf8().constData());
+            return false;
+        }
+
+        QString sName = sEntry.left(iAssign).trimmed();
+        QString sValue = sEntry.mid(iAssign + 1).trimmed();
+        PoolConfig config;
+
+        //Split off the priority and the cores
+        int iColon = sValue.indexOf(':');
+        if(iColon >= 0) {
+            if(!parsePriority(sValue.mid(iColon + 1).trimmed(), config.priority)) {
+                fprintf(stderr, "ExecutionConfig::configure - Unknown priority in \"%s\".\n", sEntry.toUtf8().constData());
+                return false;
+            }
+            sValue = sValue.left(iColon);
+        }
+
+        int iAt = sValue.indexOf('@');
+        if(iAt >= 0) {
+            if(!parseCores(sValue.mid(iAt + 1), config.lCores)) {
+                fprintf(stderr, "ExecutionConfig::configure - Invalid cores in \"%s\".\n", sEntry.toUtf8().constData());
+                return false;
+            }
+            sValue = sValue.left(iAt);
+        }
+
+        bool bOk = false;
+        config.iThreads = sValue.trimmed().toInt(&bOk);
+
+        if(!bOk || config.iThreads < 0) {
+            fprintf(stderr, "ExecutionConfig::configure - Invalid number of threads in \"%s\".\n", sEntry.toUtf8().constData());
+            return false;
+        }
+
+        if(sName == QString("openmp")) {
+            iOpenMpThreads = config.iThreads;
+        } else {
+            lNames.append(sName);
+            lConfigs.append(config);
+        }
+    }
+
+    for(int i = 0; i < lNames.size(); ++i) {
+        setPool(lNames[i], lConfigs[i].iThreads, lConfigs[i].priority, lConfigs[i].lCores);
+    }
+
+    if(iOpenMpThreads > 0) {
+        setOpenMpThreads(iOpenMpThreads);
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+QString ExecutionConfig::toString()
+{
+    ExecutionRegistry& registry = executionRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    QStringList lEntries;
+
+    QMap<QString, PoolConfig>::const_iterator it;
+    for(it = registry.mapPools.constBegin(); it != registry.mapPools.constEnd(); ++it) {
+        QString sEntry = QString("%1=%2").arg(it.key()).arg(it.value().iThreads);
+
+        if(!it.value().lCores.isEmpty()) {
+            QStringList lCores;
+            for(int i = 0; i < it.value().lCores.size(); ++i) {
+                lCores.append(QString::number(it.value().lCores[i]));
+            }
+            sEntry.append(QString("@%1").arg(lCores.join(',')));
+        }
+
+        if(it.value().priority != QThread::InheritPriority) {
+            sEntry.append(QString(":%1").arg(s_priorityNames[it.value().priority]));
+        }
+
+        lEntries.append(sEntry);
+    }
+
+    if(registry.iOpenMpThreads > 0) {
+        lEntries.append(QString("openmp=%1").arg(registry.iOpenMpThreads));
+    }
+
+    return lEntries.join(';');
+}
+
+
+//*************************************************************************************************************
+
+QCommandLineOption ExecutionConfig::commandLineOption()
+{
+    return QCommandLineOption("execution",
+                              "Configures the thread pools, e.g. \"default=6@2-7;realtime=2@0,1:highest;openmp=4\", see UTILSLIB::ExecutionConfig.",
+                              "config");
+}
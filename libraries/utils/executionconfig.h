@@ -0,0 +1,224 @@
+//=============================================================================================================
+/**
+* @file     executionconfig.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the ExecutionConfig class.
+*
+*/
+
+#ifndef EXECUTIONCONFIG_H
+#define EXECUTIONCONFIG_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QCommandLineOption>
+#include <QFuture>
+#include <QList>
+#include <QString>
+#include <QThread>
+#include <QThreadPool>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <functional>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//=============================================================================================================
+/**
+* Central configuration of the threads all libraries use, so that processing does not oversubscribe the cores
+* which the acquisition needs. A configuration consists of named pools and an OpenMP thread limit:
+*
+*   - "default" is QThreadPool::globalInstance(), which QtConcurrent uses. Its size is also the number of
+*     batches the libraries split their work into (threadCount()).
+*   - "realtime" describes the dedicated processing threads, e.g. RtAve, RtCov, RtInvOp and RtNoise, which
+*     apply it with configureThread() when they start.
+*   - Any other name gets its own QThreadPool, see pool() and run().
+*
+* Each pool has a size, a thread priority and an optional set of cores its threads are pinned to. Priority and
+* pinning are applied by configureThread(), which run() calls for each task. Pinning is supported on Linux and
+* Windows.
+*
+* The configuration is read from the environment variable MNE_EXECUTION when the library is loaded and can be
+* changed by configure(), e.g. with the value of commandLineOption(). The format is a semicolon separated list of
+* <pool>=<threads>[@<cores>][:<priority>] entries and an optional openmp=<threads> entry, e.g.
+* "default=6@2-7;realtime=2@0,1:highest;openmp=4". The priorities are the ones of QThread::Priority in lower case
+* without "Priority", e.g. "low" or "timecritical".
+*
+* @brief Shared thread pools, thread priorities, core pinning and OpenMP limits.
+*/
+class UTILSSHARED_EXPORT ExecutionConfig
+{
+public:
+    //=========================================================================================================
+    /**
+    * Configures a pool.
+    *
+    * @param[in] sName      The name of the pool.
+    * @param[in] iThreads   The number of threads, values below 1 select QThread::idealThreadCount().
+    * @param[in] priority   The thread priority, QThread::InheritPriority keeps the priority of the threads.
+    * @param[in] lCores     The cores the threads are pinned to, an empty list does not pin them.
+    */
+    static void setPool(const QString& sName, int iThreads, QThread::Priority priority = QThread::InheritPriority, const QList<int>& lCores = QList<int>());
+
+    //=========================================================================================================
+    /**
+    * Returns the number of threads of a pool. Pools which were not configured have the size of the default pool.
+    *
+    * @param[in] sName      The name of the pool.
+    *
+    * @return the number of threads.
+    */
+    static int threadCount(const QString& sName = QString("default"));
+
+    //=========================================================================================================
+    /**
+    * Returns the thread priority of a pool.
+    *
+    * @param[in] sName      The name of the pool.
+    *
+    * @return the priority, QThread::InheritPriority if the pool does not change it.
+    */
+    static QThread::Priority priority(const QString& sName = QString("default"));
+
+    //=========================================================================================================
+    /**
+    * Returns the cores the threads of a pool are pinned to.
+    *
+    * @param[in] sName      The name of the pool.
+    *
+    * @return the cores, an empty list if the threads are not pinned.
+    */
+    static QList<int> cores(const QString& sName = QString("default"));
+
+    //=========================================================================================================
+    /**
+    * Returns the thread pool of a pool, which is created on first use. The default pool is
+    * QThreadPool::globalInstance(). The pools stay valid until the library is unloaded.
+    *
+    * @param[in] sName      The name of the pool.
+    *
+    * @return the thread pool.
+    */
+    static QThreadPool* pool(const QString& sName = QString("default"));
+
+    //=========================================================================================================
+    /**
+    * Runs a function on a pool. The priority and the pinning of the pool are applied to the worker thread first.
+    *
+    * @param[in] sName      The name of the pool.
+    * @param[in] work       The function.
+    *
+    * @return the future of the function.
+    */
+    static QFuture<void> run(const QString& sName, const std::function<void()>& work);
+
+    //=========================================================================================================
+    /**
+    * Applies the priority and the pinning of a pool to the calling thread.
+    *
+    * @param[in] sName      The name of the pool.
+    *
+    * @return false if the thread could not be pinned, true otherwise.
+    */
+    static bool configureThread(const QString& sName);
+
+    //=========================================================================================================
+    /**
+    * Sets the number of threads OpenMP parallel regions should use.
+    *
+    * @param[in] iThreads   The number of threads, values below 1 remove the limit.
+    */
+    static void setOpenMpThreads(int iThreads);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of threads OpenMP parallel regions should use.
+    *
+    * @return the number of threads, -1 if there is no limit and the OpenMP default should be used.
+    */
+    static int openMpThreads();
+
+    //=========================================================================================================
+    /**
+    * Configures the pools and the OpenMP limit from a configuration string, see the class description. Pools
+    * which are not mentioned keep their configuration.
+    *
+    * @param[in] sConfig    The configuration.
+    *
+    * @return true if the configuration could be parsed, false otherwise. Nothing is changed in this case.
+    */
+    static bool configure(const QString& sConfig);
+
+    //=========================================================================================================
+    /**
+    * Returns the current configuration in the format of configure().
+    *
+    * @return the configuration.
+    */
+    static QString toString();
+
+    //=========================================================================================================
+    /**
+    * Returns the command line option applications offer to configure the execution, its value is handed to
+    * configure().
+    *
+    * @return the option "execution".
+    */
+    static QCommandLineOption commandLineOption();
+};
+
+} // NAMESPACE UTILSLIB
+
+#endif // EXECUTIONCONFIG_H
@@ -0,0 +1,239 @@
+//=============================================================================================================
+/**
+* @file     biquadcascade.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    BiquadCascade class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "biquadcascade.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+/**
+* Runs all sections over one sample column of iNumChannels channels. Uses Eigen's packet primitives, i.e.
+* SSE/AVX/NEON as enabled for the build. The packets of one section are independent, so they overlap in the
+* pipeline, and the states of the whole cascade stay in the first level cache from one sample to the next.
+*
+* @param[in] matCoeffs      normalized coefficients, one row [b0 b1 b2 -a1 -a2] per section.
+* @param[in, out] pZ1       first states, one column of iNumChannels per section.
+* @param[in, out] pZ2       second states, one column of iNumChannels per section.
+* @param[in] iNumChannels   number of channels.
+* @param[in] pIn            input sample column.
+* @param[out] pOut          output sample column, may equal pIn.
+*/
+template<typename T>
+inline void filterColumn(const Matrix<T, Dynamic, Dynamic>& matCoeffs, T* pZ1, T* pZ2, int iNumChannels, const T* pIn, T* pOut)
+{
+    using namespace Eigen::internal;
+
+    typedef typename packet_traits<T>::type Packet;
+    const int iPacketSize = packet_traits<T>::size;
+    const int iVectorized = iNumChannels - iNumChannels % iPacketSize;
+
+    for(int s = 0; s < matCoeffs.rows(); ++s) {
+        const T* pSrc = s == 0 ? pIn : pOut;
+        T* z1 = pZ1 + s * iNumChannels;
+        T* z2 = pZ2 + s * iNumChannels;
+
+        const Packet b0 = pset1<Packet>(matCoeffs(s,0));
+        const Packet b1 = pset1<Packet>(matCoeffs(s,1));
+        const Packet b2 = pset1<Packet>(matCoeffs(s,2));
+        const Packet a1 = pset1<Packet>(matCoeffs(s,3));
+        const Packet a2 = pset1<Packet>(matCoeffs(s,4));
+
+        for(int c = 0; c < iVectorized; c += iPacketSize) {
+            Packet x = ploadu<Packet>(pSrc + c);
+            Packet y = pmadd(b0, x, ploadu<Packet>(z1 + c));
+            pstoreu(z1 + c, pmadd(a1, y, pmadd(b1, x, ploadu<Packet>(z2 + c))));
+            pstoreu(z2 + c, pmadd(a2, y, pmul(b2, x)));
+            pstoreu(pOut + c, y);
+        }
+
+        for(int c = iVectorized; c < iNumChannels; ++c) {
+            T x = pSrc[c];
+            T y = matCoeffs(s,0) * x + z1[c];
+            z1[c] = matCoeffs(s,3) * y + matCoeffs(s,1) * x + z2[c];
+            z2[c] = matCoeffs(s,4) * y + matCoeffs(s,2) * x;
+            pOut[c] = y;
+        }
+    }
+}
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename T>
+BiquadCascadeT<T>::BiquadCascadeT()
+{
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+BiquadCascadeT<T>::BiquadCascadeT(const MatrixXd& matSOS, int iNumChannels)
+{
+    setSections(matSOS, iNumChannels);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void BiquadCascadeT<T>::setSections(const MatrixXd& matSOS, int iNumChannels)
+{
+    if(matSOS.rows() > 0 && matSOS.cols() != 6) {
+        qWarning() << "BiquadCascade::setSections - Sections need six coefficients, got" << matSOS.cols();
+        m_matCoeffs.resize(0, 5);
+    } else {
+        //Normalize to a0 = 1 in double precision, then round to the precision of the cascade
+        m_matCoeffs.resize(matSOS.rows(), 5);
+        for(int s = 0; s < matSOS.rows(); ++s) {
+            double a0 = matSOS(s,3);
+            m_matCoeffs(s,0) = T(matSOS(s,0) / a0);
+            m_matCoeffs(s,1) = T(matSOS(s,1) / a0);
+            m_matCoeffs(s,2) = T(matSOS(s,2) / a0);
+            m_matCoeffs(s,3) = T(-matSOS(s,4) / a0);
+            m_matCoeffs(s,4) = T(-matSOS(s,5) / a0);
+        }
+    }
+
+    m_matZ1.resize(iNumChannels, m_matCoeffs.rows());
+    m_matZ2.resize(iNumChannels, m_matCoeffs.rows());
+
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void BiquadCascadeT<T>::reset()
+{
+    m_matZ1.setZero();
+    m_matZ2.setZero();
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void BiquadCascadeT<T>::filter(const MatrixXT& matDataIn, MatrixXT& matDataOut)
+{
+    if(matDataIn.rows() != m_matZ1.rows()) {
+        qWarning() << "BiquadCascade::filter - Number of channels" << matDataIn.rows() << "does not match" << m_matZ1.rows();
+        return;
+    }
+
+    if(&matDataOut != &matDataIn) {
+        matDataOut.resize(matDataIn.rows(), matDataIn.cols());
+
+        if(m_matCoeffs.rows() == 0) {
+            matDataOut = matDataIn;
+            return;
+        }
+    }
+
+    const int iNumChannels = matDataIn.rows();
+
+    for(int t = 0; t < matDataIn.cols(); ++t)
+        filterColumn<T>(m_matCoeffs, m_matZ1.data(), m_matZ2.data(), iNumChannels, matDataIn.data() + t * iNumChannels, matDataOut.data() + t * iNumChannels);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+typename BiquadCascadeT<T>::RowVectorXT BiquadCascadeT<T>::filterRow(const MatrixXd& matSOS, const RowVectorXT& data, bool bZeroPhase)
+{
+    BiquadCascadeT<T> cascade(matSOS, 1);
+
+    MatrixXT matData = data;
+    cascade.filter(matData, matData);
+
+    if(bZeroPhase) {
+        MatrixXT matReverse = matData.rowwise().reverse();
+        cascade.reset();
+        cascade.filter(matReverse, matReverse);
+        matData = matReverse.rowwise().reverse();
+    }
+
+    return matData;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EXPLICIT INSTANTIATIONS
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+template class UTILSSHARED_EXPORT BiquadCascadeT<double>;
+template class UTILSSHARED_EXPORT BiquadCascadeT<float>;
+
+}
@@ -0,0 +1,212 @@
+//=============================================================================================================
+/**
+* @file     biquadcascade.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    BiquadCascade class declaration.
+*
+*/
+
+#ifndef BIQUADCASCADE_H
+#define BIQUADCASCADE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Streams multi-channel data through a cascade of second-order sections (transposed direct form II). The filter
+* state of every channel is kept between calls. Channels are contiguous in a column of the data, so neighbouring
+* channels are filtered together in one SIMD packet with Eigen's packet primitives (SSE/AVX/NEON as enabled for
+* the build). The samples are processed one column after the other, so the states of all sections stay in the
+* first level cache and the independent packets of a section overlap in the pipeline.
+*
+* The sections are designed and normalized in double precision and then rounded to the scalar type of the
+* cascade. Explicitly instantiated for double (BiquadCascade) and float (BiquadCascadeF), the float cascade
+* processes twice as many channels per SIMD register.
+*
+* @brief Multi-channel biquad cascade.
+*/
+template<typename T>
+class BiquadCascadeT
+{
+public:
+    typedef QSharedPointer<BiquadCascadeT> SPtr;             /**< Shared pointer type for BiquadCascadeT. */
+    typedef QSharedPointer<const BiquadCascadeT> ConstSPtr;  /**< Const shared pointer type for BiquadCascadeT. */
+
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> MatrixXT;     /**< Dynamic matrix of the precision. */
+    typedef Eigen::Matrix<T, Eigen::Dynamic, 1> VectorXT;                   /**< Dynamic vector of the precision. */
+    typedef Eigen::Matrix<T, 1, Eigen::Dynamic> RowVectorXT;                /**< Dynamic row vector of the precision. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty BiquadCascadeT object which passes the data through.
+    */
+    BiquadCascadeT();
+
+    //=========================================================================================================
+    /**
+    * Constructs a BiquadCascadeT object.
+    *
+    * @param [in] matSOS        second-order sections, one row [b0 b1 b2 a0 a1 a2] per section.
+    * @param [in] iNumChannels  number of channels.
+    */
+    BiquadCascadeT(const MatrixXd& matSOS, int iNumChannels = 1);
+
+    //=========================================================================================================
+    /**
+    * Sets the sections and clears the filter state.
+    *
+    * @param [in] matSOS        second-order sections, one row [b0 b1 b2 a0 a1 a2] per section.
+    * @param [in] iNumChannels  number of channels.
+    */
+    void setSections(const MatrixXd& matSOS, int iNumChannels = 1);
+
+    //=========================================================================================================
+    /**
+    * Clears the filter state.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Filters the next block of the stream. matDataOut may be the same matrix as matDataIn.
+    *
+    * @param [in] matDataIn     data which is to be filtered, one row per channel.
+    * @param [out] matDataOut   filtered data.
+    */
+    void filter(const MatrixXT& matDataIn, MatrixXT& matDataOut);
+
+    //=========================================================================================================
+    /**
+    * Filters a single channel without keeping state.
+    *
+    * @param [in] matSOS        second-order sections, one row [b0 b1 b2 a0 a1 a2] per section.
+    * @param [in] data          data which is to be filtered.
+    * @param [in] bZeroPhase    whether to filter forward and backward, which cancels the phase and squares the magnitude.
+    *
+    * @return the filtered data.
+    */
+    static RowVectorXT filterRow(const MatrixXd& matSOS, const RowVectorXT& data, bool bZeroPhase = false);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of sections.
+    *
+    * @return the number of sections.
+    */
+    inline int sections() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of channels.
+    *
+    * @return the number of channels.
+    */
+    inline int channels() const;
+
+private:
+    MatrixXT        m_matCoeffs;    /**< Normalized coefficients, one row [b0 b1 b2 -a1 -a2] per section. */
+    MatrixXT        m_matZ1;        /**< First state of each section, one column per section. */
+    MatrixXT        m_matZ2;        /**< Second state of each section, one column per section. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+template<typename T>
+inline int BiquadCascadeT<T>::sections() const
+{
+    return m_matCoeffs.rows();
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline int BiquadCascadeT<T>::channels() const
+{
+    return m_matZ1.rows();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EXPLICIT INSTANTIATIONS
+//=============================================================================================================
+
+extern template class UTILSSHARED_EXPORT BiquadCascadeT<double>;
+extern template class UTILSSHARED_EXPORT BiquadCascadeT<float>;
+
+typedef BiquadCascadeT<double> BiquadCascade;   /**< Double precision biquad cascade. */
+typedef BiquadCascadeT<float> BiquadCascadeF;   /**< Single precision biquad cascade. */
+
+} // NAMESPACE UTILSLIB
+
+#endif // BIQUADCASCADE_H
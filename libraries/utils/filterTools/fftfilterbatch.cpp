@@ -0,0 +1,264 @@
+//=============================================================================================================
+/**
+* @file     fftfilterbatch.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FFTFilterBatch class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fftfilterbatch.h"
+#include "../executionconfig.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE WORKSPACE
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+* Workspace of one batch of rows. The FFT object keeps its plans, the buffers keep their size.
+*/
+template<typename T>
+struct FFTFilterWorkspace
+{
+    typedef Eigen::Matrix<T, 1, Eigen::Dynamic> RowVectorXT;                   /**< Real row vector of the precision. */
+    typedef Eigen::Matrix<std::complex<T>, 1, Eigen::Dynamic> RowVectorXcT;    /**< Complex row vector of the precision. */
+
+    int                 iBatch;         /**< Index of the batch. */
+    Eigen::FFT<T>       fft;            /**< FFT object of this batch. */
+    RowVectorXT         vecTime;        /**< Zero-padded FFT frame. */
+    RowVectorXcT        vecFreq;        /**< Half spectrum of vecTime. */
+    RowVectorXT         vecOut;         /**< Circular convolution result. */
+};
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* FFT filtering of the rows of one workspace
+*/
+template<typename T>
+struct FilterBatch
+{
+    typedef void result_type;
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> MatrixXT;
+    typedef Eigen::Matrix<std::complex<T>, 1, Eigen::Dynamic> RowVectorXcT;
+
+    FilterBatch(const MatrixXT* p_pMatIn, MatrixXT* p_pMatOut, const RowVectorXcT* p_pSpectrum, int p_iBatches, int p_iPadFront, int p_iOutFirst)
+    : m_pMatIn(p_pMatIn)
+    , m_pMatOut(p_pMatOut)
+    , m_pSpectrum(p_pSpectrum)
+    , m_iBatches(p_iBatches)
+    , m_iPadFront(p_iPadFront)
+    , m_iOutFirst(p_iOutFirst)
+    {
+    }
+
+    void operator()(QSharedPointer<FFTFilterWorkspace<T> >& workspace) const
+    {
+        if(workspace->iBatch >= m_iBatches)
+            return;
+
+        int iRows = m_pMatIn->rows();
+        int iBegin = workspace->iBatch * iRows / m_iBatches;
+        int iEnd = (workspace->iBatch + 1) * iRows / m_iBatches;
+        int iCols = m_pMatIn->cols();
+        int iOutLength = m_pMatOut->cols();
+
+        //Only the data segment changes from row to row, the zero padding stays
+        workspace->vecTime.head(m_iPadFront).setZero();
+        workspace->vecTime.tail(workspace->vecTime.cols() - m_iPadFront - iCols).setZero();
+
+        for(int r = iBegin; r < iEnd; ++r) {
+            workspace->vecTime.segment(m_iPadFront, iCols) = m_pMatIn->row(r);
+
+            workspace->fft.fwd(workspace->vecFreq, workspace->vecTime);
+            workspace->vecFreq.array() *= m_pSpectrum->array();
+            workspace->fft.inv(workspace->vecOut, workspace->vecFreq);
+
+            m_pMatOut->row(r) = workspace->vecOut.segment(m_iOutFirst, iOutLength);
+        }
+    }
+
+    const MatrixXT*     m_pMatIn;
+    MatrixXT*           m_pMatOut;
+    const RowVectorXcT* m_pSpectrum;
+    int                 m_iBatches;
+    int                 m_iPadFront;
+    int                 m_iOutFirst;
+};
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename T>
+FFTFilterBatchT<T>::FFTFilterBatchT()
+: m_iFFTLength(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+FFTFilterBatchT<T>::FFTFilterBatchT(const RowVectorXcd& vecSpectrum, int iFFTLength, int iMaxBatches)
+: m_iFFTLength(0)
+{
+    setSpectrum(vecSpectrum, iFFTLength, iMaxBatches);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+bool FFTFilterBatchT<T>::setSpectrum(const RowVectorXcd& vecSpectrum, int iFFTLength, int iMaxBatches)
+{
+    m_iFFTLength = 0;
+    m_lWorkspaces.clear();
+
+    if(iFFTLength < 2 || vecSpectrum.cols() != iFFTLength/2 + 1) {
+        qWarning() << "FFTFilterBatch::setSpectrum - Spectrum of" << vecSpectrum.cols() << "bins does not match the FFT length" << iFFTLength;
+        return false;
+    }
+
+    m_iFFTLength = iFFTLength;
+    m_vecSpectrum = vecSpectrum.template cast<std::complex<T> >();
+
+    int iBatches = iMaxBatches < 1 ? ExecutionConfig::threadCount() : iMaxBatches;
+    for(int b = 0; b < iBatches; ++b) {
+        QSharedPointer<FFTFilterWorkspace<T> > workspace(new FFTFilterWorkspace<T>);
+
+        workspace->iBatch = b;
+        workspace->fft.SetFlag(workspace->fft.HalfSpectrum);
+        workspace->vecTime = FFTFilterWorkspace<T>::RowVectorXT::Zero(m_iFFTLength);
+        workspace->vecFreq = RowVectorXcT::Zero(m_vecSpectrum.cols());
+        workspace->vecOut = FFTFilterWorkspace<T>::RowVectorXT::Zero(m_iFFTLength);
+
+        m_lWorkspaces.append(workspace);
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+bool FFTFilterBatchT<T>::filter(const MatrixXT& matDataIn, MatrixXT& matDataOut, int iPadFront, int iOutFirst, int iOutLength)
+{
+    if(iOutLength < 0)
+        iOutLength = m_iFFTLength - iOutFirst;
+
+    if(m_lWorkspaces.isEmpty()
+            || iPadFront < 0 || iPadFront + matDataIn.cols() > m_iFFTLength
+            || iOutFirst < 0 || iOutFirst + iOutLength > m_iFFTLength) {
+        qWarning() << "FFTFilterBatch::filter - Data of" << matDataIn.cols() << "samples at" << iPadFront << "or output" << iOutFirst << "+" << iOutLength << "do not fit the FFT length" << m_iFFTLength;
+        return false;
+    }
+
+    matDataOut.resize(matDataIn.rows(), iOutLength);
+
+    if(matDataIn.rows() == 0)
+        return true;
+
+    int iBatches = qMin(m_lWorkspaces.size(), (int)matDataIn.rows());
+    FilterBatch<T> batch(&matDataIn, &matDataOut, &m_vecSpectrum, iBatches, iPadFront, iOutFirst);
+
+    if(iBatches == 1)
+        batch(m_lWorkspaces.first());
+    else
+        QtConcurrent::blockingMap(m_lWorkspaces, batch);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EXPLICIT INSTANTIATIONS
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+template class UTILSSHARED_EXPORT FFTFilterBatchT<double>;
+template class UTILSSHARED_EXPORT FFTFilterBatchT<float>;
+
+}
@@ -0,0 +1,213 @@
+//=============================================================================================================
+/**
+* @file     fftfilterbatch.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FFTFilterBatch class declaration.
+*
+*/
+
+#ifndef FFTFILTERBATCH_H
+#define FFTFILTERBATCH_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+template<typename T>
+struct FFTFilterWorkspace;
+
+
+//=============================================================================================================
+/**
+* Filters many channels with one frequency response by FFT convolution. Every row is zero-padded to the FFT
+* length, multiplied with the half spectrum of the filter and transformed back. The rows are split into
+* contiguous batches, one per thread, and every batch owns an FFT object and buffers which keep their plans and
+* sizes between calls. Shared by the real-time overlap-save filter and the offline window filtering.
+*
+* The spectrum is passed in double precision and rounded to the scalar type of the batch. Explicitly instantiated
+* for double (FFTFilterBatch) and float (FFTFilterBatchF), the float batch runs single precision FFTs on buffers
+* of half the size.
+*
+* @brief Multi-channel FFT filter.
+*/
+template<typename T>
+class FFTFilterBatchT
+{
+public:
+    typedef QSharedPointer<FFTFilterBatchT> SPtr;             /**< Shared pointer type for FFTFilterBatchT. */
+    typedef QSharedPointer<const FFTFilterBatchT> ConstSPtr;  /**< Const shared pointer type for FFTFilterBatchT. */
+
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> MatrixXT;                     /**< Dynamic matrix of the precision. */
+    typedef Eigen::Matrix<std::complex<T>, 1, Eigen::Dynamic> RowVectorXcT;                 /**< Complex row vector of the precision. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty FFTFilterBatchT object.
+    */
+    FFTFilterBatchT();
+
+    //=========================================================================================================
+    /**
+    * Constructs a FFTFilterBatchT object.
+    *
+    * @param [in] vecSpectrum   half spectrum of the filter, iFFTLength/2+1 bins.
+    * @param [in] iFFTLength    length of the FFT.
+    * @param [in] iMaxBatches   maximal number of batches, the ideal thread count if smaller than one.
+    */
+    FFTFilterBatchT(const RowVectorXcd& vecSpectrum, int iFFTLength, int iMaxBatches = 0);
+
+    //=========================================================================================================
+    /**
+    * Sets the filter spectrum and allocates the workspaces.
+    *
+    * @param [in] vecSpectrum   half spectrum of the filter, iFFTLength/2+1 bins.
+    * @param [in] iFFTLength    length of the FFT.
+    * @param [in] iMaxBatches   maximal number of batches, the ideal thread count if smaller than one.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool setSpectrum(const RowVectorXcd& vecSpectrum, int iFFTLength, int iMaxBatches = 0);
+
+    //=========================================================================================================
+    /**
+    * Filters all rows of matDataIn. Each row is placed at iPadFront of a zero-padded FFT frame, and
+    * the samples iOutFirst to iOutFirst+iOutLength-1 of the circular convolution are written to the
+    * matching row of matDataOut. matDataOut must not be the same matrix as matDataIn.
+    *
+    * @param [in] matDataIn     data which is to be filtered, one row per channel.
+    * @param [out] matDataOut   filtered data, resized to matDataIn.rows() x iOutLength.
+    * @param [in] iPadFront     number of zeros in front of the data.
+    * @param [in] iOutFirst     first sample of the convolution result to return.
+    * @param [in] iOutLength    number of samples to return, the rest of the FFT frame if negative.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool filter(const MatrixXT& matDataIn, MatrixXT& matDataOut, int iPadFront = 0, int iOutFirst = 0, int iOutLength = -1);
+
+    //=========================================================================================================
+    /**
+    * Returns the length of the FFT.
+    *
+    * @return the length of the FFT, 0 if no spectrum is set.
+    */
+    inline int fftLength() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether no spectrum is set.
+    *
+    * @return true if no spectrum is set.
+    */
+    inline bool isEmpty() const;
+
+private:
+    int                                             m_iFFTLength;   /**< Length of the FFT. */
+    RowVectorXcT                                    m_vecSpectrum;  /**< Half spectrum of the filter. */
+    QList<QSharedPointer<FFTFilterWorkspace<T> > >  m_lWorkspaces;  /**< One workspace per batch of rows. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+template<typename T>
+inline int FFTFilterBatchT<T>::fftLength() const
+{
+    return m_iFFTLength;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+inline bool FFTFilterBatchT<T>::isEmpty() const
+{
+    return m_lWorkspaces.isEmpty();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EXPLICIT INSTANTIATIONS
+//=============================================================================================================
+
+extern template class UTILSSHARED_EXPORT FFTFilterBatchT<double>;
+extern template class UTILSSHARED_EXPORT FFTFilterBatchT<float>;
+
+typedef FFTFilterBatchT<double> FFTFilterBatch;     /**< Double precision FFT filter batch. */
+typedef FFTFilterBatchT<float> FFTFilterBatchF;     /**< Single precision FFT filter batch. */
+
+} // NAMESPACE UTILSLIB
+
+#endif // FFTFILTERBATCH_H
@@ -43,9 +43,13 @@
 #include "filterdata.h"
 
 #include "../mnemath.h"
+#include "../cachefile.h"
+#include "../cachelocation.h"
 
 #include "parksmcclellan.h"
 #include "cosinefilter.h"
+#include "iirfilter.h"
+#include "biquadcascade.h"
 
 
 //*************************************************************************************************************
@@ -61,7 +65,12 @@
 // Qt INCLUDES
 //=============================================================================================================
 
+#include <QCache>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
 
 
 //*************************************************************************************************************
@@ -85,6 +94,97 @@ using namespace UTILSLIB;
 
 
 //*************************************************************************************************************
+//=============================================================================================================
+// DEFINE STATIC HELPERS
+//=============================================================================================================
+
+static const char DESIGNCACHE_KIND[] = "filter";                 /**< Kind of the filter design cache files. */
+static const int DESIGNCACHE_MAX_ENTRIES = 256;                  /**< Number of designs kept in memory. */
+
+/**
+* A designed filter, i.e. everything designFilter computes from the filter parameters.
+*/
+struct FilterDesign
+{
+    RowVectorXd     coeffA;
+    MatrixXd        matSOS;
+    RowVectorXcd    fftCoeffA;
+};
+
+/**
+* The designs of all FilterData objects of the process.
+*/
+struct FilterDesignCache
+{
+    FilterDesignCache()
+    : designs(DESIGNCACHE_MAX_ENTRIES)
+    {
+    }
+
+    QMutex mutex;
+    QCache<QByteArray, FilterDesign> designs;
+};
+
+Q_GLOBAL_STATIC(FilterDesignCache, s_filterDesignCache)
+
+
+//*************************************************************************************************************
+
+/**
+* Returns the cache file of a design, it is named by the hash of the key and located in the directory of
+* CacheLocation.
+*/
+static QString designCacheFile(const QByteArray& p_key)
+{
+    return CacheLocation::filePath(QString("%1.mnefilter").arg(QString::fromLatin1(QCryptographicHash::hash(p_key, QCryptographicHash::Sha1).toHex())));
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Reads a persisted design, fails if the file belongs to other filter parameters.
+*/
+static bool readDesignCache(const QString& p_sCacheFile, const QByteArray& p_key, FilterDesign& p_design)
+{
+    QByteArray t_baPayload;
+    if(!CacheFile::read(p_sCacheFile, QString(DESIGNCACHE_KIND), p_key, t_baPayload))
+        return false;
+
+    QDataStream t_Stream(t_baPayload);
+
+    FilterDesign t_design;
+    if(!CacheFile::readMatrix(t_Stream, t_design.coeffA)
+            || !CacheFile::readMatrix(t_Stream, t_design.matSOS)
+            || !CacheFile::readMatrix(t_Stream, t_design.fftCoeffA))
+        return false;
+
+    p_design = t_design;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Persists a design.
+*/
+static bool writeDesignCache(const QString& p_sCacheFile, const QByteArray& p_key, const FilterDesign& p_design)
+{
+    QByteArray t_baPayload;
+    QDataStream t_Stream(&t_baPayload, QIODevice::WriteOnly);
+    CacheFile::writeMatrix(t_Stream, p_design.coeffA);
+    CacheFile::writeMatrix(t_Stream, p_design.matSOS);
+    CacheFile::writeMatrix(t_Stream, p_design.fftCoeffA);
+
+    return CacheFile::write(p_sCacheFile, QString(DESIGNCACHE_KIND), p_key, t_baPayload);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
 
 FilterData::FilterData()
 : m_Type(UNKNOWN)
@@ -92,6 +192,7 @@ FilterData::FilterData()
 , m_iFFTlength(512)
 , m_sName("Unknown")
 , m_dParksWidth(0.1)
+, m_dRipple(0.5)
 , m_designMethod(External)
 , m_dCenterFreq(0.5)
 , m_dBandwidth(0.1)
@@ -111,6 +212,7 @@ FilterData::FilterData(QString unique_name, FilterType type, int order, double c
 , m_iFFTlength(fftlength)
 , m_sName(unique_name)
 , m_dParksWidth(parkswidth)
+, m_dRipple(0.5)
 , m_designMethod(designMethod)
 , m_dCenterFreq(centerfreq)
 , m_dBandwidth(bandwidth)
@@ -124,7 +226,39 @@ FilterData::FilterData(QString unique_name, FilterType type, int order, double c
 
 void FilterData::designFilter()
 {
-    switch(m_designMethod) {
+    m_matSOS.resize(0, 6);
+
+    //
+    //  Take the design from the cache if a filter with the same parameters was designed before
+    //
+    QByteArray t_key = designKey();
+    bool t_bCached = false;
+    if(!t_key.isEmpty()) {
+        QMutexLocker locker(&s_filterDesignCache->mutex);
+        FilterDesign* t_pDesign = s_filterDesignCache->designs.object(t_key);
+        if(t_pDesign) {
+            m_dCoeffA = t_pDesign->coeffA;
+            m_matSOS = t_pDesign->matSOS;
+            m_dFFTCoeffA = t_pDesign->fftCoeffA;
+            t_bCached = true;
+        }
+    }
+
+    QString t_sCacheFile = t_bCached || t_key.isEmpty() ? QString() : designCacheFile(t_key);
+    if(!t_sCacheFile.isEmpty()) {
+        FilterDesign t_design;
+        if(readDesignCache(t_sCacheFile, t_key, t_design)) {
+            m_dCoeffA = t_design.coeffA;
+            m_matSOS = t_design.matSOS;
+            m_dFFTCoeffA = t_design.fftCoeffA;
+            t_bCached = true;
+
+            QMutexLocker locker(&s_filterDesignCache->mutex);
+            s_filterDesignCache->designs.insert(t_key, new FilterDesign(t_design));
+        }
+    }
+
+    switch(t_bCached ? External : m_designMethod) {
         case Tschebyscheff: {
             ParksMcClellan filter(m_iFilterOrder, m_dCenterFreq, m_dBandwidth, m_dParksWidth, (ParksMcClellan::TPassType)m_Type);
             m_dCoeffA = filter.FirCoeff;
@@ -183,6 +317,47 @@ void FilterData::designFilter()
 
             break;
         }
+
+        case Butterworth:
+        case Chebyshev: {
+            if(m_Type == UNKNOWN)
+                break;
+
+            IIRFilter filteriir(m_iFilterOrder,
+                                m_dCenterFreq,
+                                m_dBandwidth,
+                                (IIRFilter::TPassType)m_Type,
+                                m_designMethod == Chebyshev ? IIRFilter::Chebyshev : IIRFilter::Butterworth,
+                                m_dRipple);
+
+            //IIR filters have no FIR coefficients, only the response is kept for plotting
+            m_matSOS = filteriir.m_matSOS;
+            m_dCoeffA.resize(0);
+            m_dFFTCoeffA = IIRFilter::frequencyResponse(m_matSOS, m_iFFTlength);
+
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    //
+    //  Keep the new design for the next filter with the same parameters
+    //
+    if(!t_bCached && !t_key.isEmpty()) {
+        FilterDesign t_design;
+        t_design.coeffA = m_dCoeffA;
+        t_design.matSOS = m_matSOS;
+        t_design.fftCoeffA = m_dFFTCoeffA;
+
+        {
+            QMutexLocker locker(&s_filterDesignCache->mutex);
+            s_filterDesignCache->designs.insert(t_key, new FilterDesign(t_design));
+        }
+
+        if(!t_sCacheFile.isEmpty() && !writeDesignCache(t_sCacheFile, t_key, t_design))
+            qWarning("FilterData::designFilter - Couldn't write the filter design cache file %s", t_sCacheFile.toUtf8().constData());
     }
 
     switch(m_Type) {
@@ -205,6 +380,32 @@ void FilterData::designFilter()
 }
 
 
+//*************************************************************************************************************
+
+void FilterData::clearDesignCache()
+{
+    QMutexLocker locker(&s_filterDesignCache->mutex);
+    s_filterDesignCache->designs.clear();
+}
+
+
+//*************************************************************************************************************
+
+QByteArray FilterData::designKey() const
+{
+    //External coefficients are not designed from the parameters
+    if(m_designMethod == External || m_Type == UNKNOWN)
+        return QByteArray();
+
+    QByteArray t_key;
+    QDataStream t_Stream(&t_key, QIODevice::WriteOnly);
+    t_Stream << (qint32)m_designMethod << (qint32)m_Type << (qint32)m_iFilterOrder << (qint32)m_iFFTlength
+             << m_dCenterFreq << m_dBandwidth << m_dParksWidth << m_dRipple << m_sFreq;
+
+    return t_key;
+}
+
+
 //*************************************************************************************************************
 
 void FilterData::fftTransformCoeffs()
@@ -227,6 +428,9 @@ void FilterData::fftTransformCoeffs()
 
 RowVectorXd FilterData::applyConvFilter(const RowVectorXd& data, bool keepOverhead, CompensateEdgeEffects compensateEdgeEffects) const
 {
+    if(isIIR())
+        return BiquadCascade::filterRow(m_matSOS, data, false);
+
     if(data.cols()<m_dCoeffA.cols() && compensateEdgeEffects==MirrorData){
         qDebug()<<QString("Error in FilterData: Number of filter taps(%1) bigger then data size(%2). Not enough data to perform mirroring!").arg(m_dCoeffA.cols()).arg(data.cols());
         return data;
@@ -268,6 +472,9 @@ RowVectorXd FilterData::applyConvFilter(const RowVectorXd& data, bool keepOverhe
 
 RowVectorXd FilterData::applyFFTFilter(const RowVectorXd& data, bool keepOverhead, CompensateEdgeEffects compensateEdgeEffects) const
 {
+    if(isIIR())
+        return BiquadCascade::filterRow(m_matSOS, data, true);
+
     if(data.cols()<m_dCoeffA.cols() && compensateEdgeEffects==MirrorData) {
         qDebug()<<QString("Error in FilterData: Number of filter taps(%1) bigger then data size(%2). Not enough data to perform mirroring!").arg(m_dCoeffA.cols()).arg(data.cols());
         return data;
@@ -323,6 +530,14 @@ RowVectorXd FilterData::applyFFTFilter(const RowVectorXd& data, bool keepOverhea
 }
 
 
+//*************************************************************************************************************
+
+bool FilterData::isIIR() const
+{
+    return m_matSOS.rows() > 0;
+}
+
+
 //*************************************************************************************************************
 
 QString FilterData::getStringForDesignMethod(const FilterData::DesignMethod &designMethod)
@@ -338,6 +553,12 @@ QString FilterData::getStringForDesignMethod(const FilterData::DesignMethod &des
     if(designMethod == FilterData::Tschebyscheff)
         designMethodString = "Tschebyscheff";
 
+    if(designMethod == FilterData::Butterworth)
+        designMethodString = "Butterworth";
+
+    if(designMethod == FilterData::Chebyshev)
+        designMethodString = "Chebyshev";
+
     return designMethodString;
 }
 
@@ -379,6 +600,12 @@ FilterData::DesignMethod FilterData::getDesignMethodForString(const QString &des
     if(designMethodString == "Cosine")
         designMethod = FilterData::Cosine;
 
+    if(designMethodString == "Butterworth")
+        designMethod = FilterData::Butterworth;
+
+    if(designMethodString == "Chebyshev")
+        designMethod = FilterData::Chebyshev;
+
     return designMethod;
 }
 
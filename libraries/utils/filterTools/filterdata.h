@@ -72,6 +72,7 @@
 // Qt INCLUDES
 //=============================================================================================================
 
+#include <QByteArray>
 #include <QString>
 #include <QMetaType>
 
@@ -102,7 +103,9 @@ public:
     enum DesignMethod {
         Tschebyscheff,
         Cosine,
-        External
+        External,
+        Butterworth,
+        Chebyshev
     } m_designMethod;
 
     enum FilterType {
@@ -134,7 +137,7 @@ public:
     * @param [in] parkswidth determines the width of the filter slopes (steepness)
     * @param [in] sFreq sampling frequency
     * @param [in] fftlength length of the fft (multiple integer of 2^x)
-    * @param [in] designMethod specifies the design method to use. Choose between Cosind and Tschebyscheff
+    * @param [in] designMethod specifies the design method to use. Choose between Cosind and Tschebyscheff (FIR) or Butterworth and Chebyshev (IIR, order is the order of the analog prototype)
     */
     FilterData(QString unique_name, FilterType type, int order, double centerfreq, double bandwidth, double parkswidth, double sFreq, qint32 fftlength=4096, DesignMethod designMethod = Cosine);
 
@@ -150,6 +153,7 @@ public:
 
     /**
     * Applies the current filter to the input data using convolution in time domain. Pro: Uses only past samples (real-time capable) Con: Might not be as ideal as acausal version (steepness etc.)
+    * IIR filters run through their second-order sections once, forward in time.
     *
     * @param [in] data holds the data to be filtered
     * @param [in] keepOverhead whether the result should still include the overhead information in front and back of the data
@@ -160,6 +164,7 @@ public:
 
     /**
     * Applies the current filter to the input data using multiplication in frequency domain. Pro: Fast, good filter parameters Con: Smears in error from future samples. Uses future samples (nor real time capable)
+    * IIR filters run through their second-order sections forward and backward, which gives zero phase.
     *
     * @param [in] data holds the data to be filtered
     * @param [in] keepOverhead whether the result should still include the overhead information in front and back of the data
@@ -169,6 +174,11 @@ public:
     */
     RowVectorXd applyFFTFilter(const RowVectorXd& data, bool keepOverhead = false, CompensateEdgeEffects compensateEdgeEffects = MirrorData) const;
 
+    /**
+     * @brief isIIR returns whether the filter is given by second-order sections instead of FIR coefficients
+     */
+    bool isIIR() const;
+
     /**
      * @brief getStringForDesignMethod returns the current design method as a string
      */
@@ -189,12 +199,21 @@ public:
      */
     static FilterData::FilterType getFilterTypeForString(const QString &filerTypeString);
 
+    /**
+     * @brief clearDesignCache drops the filter designs kept in memory. All FilterData objects of the process
+     * share their designs, the coefficients and their FFT are computed only once for the same type, order,
+     * cut offs, sampling frequency, FFT length and design method. The designs are also kept between sessions
+     * in the directory of CacheLocation, which is not cleared.
+     */
+    static void clearDesignCache();
+
     double          m_sFreq;            /**< the sampling frequency. */
     int             m_iFilterOrder;     /**< represents the order of the filter instance. */
     int             m_iFFTlength;       /**< represents the filter length. */
     double          m_dCenterFreq;      /**< contains center freq of the filter. */
     double          m_dBandwidth;       /**< contains bandwidth of the filter. */
     double          m_dParksWidth;      /**< contains the parksmcallen width. */
+    double          m_dRipple;          /**< pass band ripple in dB of the Chebyshev design. */
 
     double          m_dLowpassFreq;     /**< lowpass freq (higher cut off) of the filter. */
     double          m_dHighpassFreq;        /**< lowpass freq (lower cut off) of the filter. */
@@ -204,8 +223,16 @@ public:
     RowVectorXd     m_dCoeffA;          /**< contains the forward filter coefficient set. */
     RowVectorXd     m_dCoeffB;          /**< contains the backward filter coefficient set (empty if FIR filter). */
 
-    RowVectorXcd    m_dFFTCoeffA;       /**< the FFT-transformed forward filter coefficient set, required for frequency-domain filtering, zero-padded to m_iFFTlength. */
+    MatrixXd        m_matSOS;           /**< second-order sections [b0 b1 b2 a0 a1 a2] of IIR filters (empty if FIR filter). */
+
+    RowVectorXcd    m_dFFTCoeffA;       /**< the FFT-transformed forward filter coefficient set, required for frequency-domain filtering, zero-padded to m_iFFTlength. For IIR filters the frequency response. */
     RowVectorXcd    m_dFFTCoeffB;       /**< the FFT-transformed backward filter coefficient set, required for frequency-domain filtering, zero-padded to m_iFFTlength. */
+
+private:
+    /**
+     * @brief designKey returns the key of the design cache for the current parameters, empty if the filter is not designed from them
+     */
+    QByteArray designKey() const;
 };
 
 //*************************************************************************************************************
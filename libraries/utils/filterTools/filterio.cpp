@@ -40,6 +40,7 @@
 //=============================================================================================================
 
 #include "filterio.h"
+#include "iirfilter.h"
 
 
 //*************************************************************************************************************
@@ -87,6 +88,7 @@ bool FilterIO::readFilter(QString path, FilterData &filter)
     //Start reading from file
     QTextStream in(&file);
     QVector<double> coefficientsTemp;
+    QList<QStringList> sectionsTemp;
 
     while(!in.atEnd())
     {
@@ -135,9 +137,26 @@ bool FilterIO::readFilter(QString path, FilterData &filter)
             if(line.contains("DesignMethod") && fields.size()==2)
                 filter.m_designMethod = FilterData::getDesignMethodForString(fields.at(1));
 
-        } else // Read filter coefficients
+        } else if(fields.size() == 6) // Read second-order section of IIR filters
+            sectionsTemp.append(fields);
+        else // Read filter coefficients
             coefficientsTemp.push_back(fields.join("").toDouble());
     }
+
+    if(!sectionsTemp.isEmpty()) {
+        filter.m_matSOS.resize(sectionsTemp.size(), 6);
+        for(int s = 0; s < sectionsTemp.size(); ++s)
+            for(int i = 0; i < 6; ++i)
+                filter.m_matSOS(s,i) = sectionsTemp.at(s).at(i).toDouble();
+
+        filter.m_dCoeffA.resize(0);
+        filter.m_dFFTCoeffA = IIRFilter::frequencyResponse(filter.m_matSOS, filter.m_iFFTlength);
+
+        file.close();
+
+        return true;
+    }
+
     // Check if reading was successful and correct
     if(filter.m_iFilterOrder != coefficientsTemp.size())
         filter.m_iFilterOrder = coefficientsTemp.size();
@@ -195,6 +214,10 @@ bool FilterIO::writeFilter(const QString &path, const FilterData &filter)
         for(int i = 0 ; i<filter.m_dCoeffA.cols() ;i++)
             out << filter.m_dCoeffA(i) << "\n";
 
+        for(int s = 0 ; s<filter.m_matSOS.rows() ;s++)
+            out << filter.m_matSOS(s,0) << " " << filter.m_matSOS(s,1) << " " << filter.m_matSOS(s,2) << " "
+                << filter.m_matSOS(s,3) << " " << filter.m_matSOS(s,4) << " " << filter.m_matSOS(s,5) << "\n";
+
         file.close();
 
         return true;
@@ -0,0 +1,303 @@
+//=============================================================================================================
+/**
+* @file     iirfilter.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    IIRFilter class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "iirfilter.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <complex>
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QVector>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC HELPERS
+//=============================================================================================================
+
+namespace
+{
+
+typedef std::complex<double> Complex;
+
+const double PI = 3.14159265358979323846;
+
+//=============================================================================================================
+/**
+* Sampling frequency of the normalized bilinear transform. Frequencies normed to the nyquist frequency are
+* prewarped with 2*fs*tan(pi*f/fs).
+*/
+const double BILINEAR_FS = 2.0;
+
+double prewarp(double f)
+{
+    return 2.0 * BILINEAR_FS * std::tan(PI * f / BILINEAR_FS);
+}
+
+Complex product(const QVector<Complex>& values, Complex offset)
+{
+    Complex result(1.0, 0.0);
+    for(int i = 0; i < values.size(); ++i)
+        result *= offset - values[i];
+    return result;
+}
+
+//=============================================================================================================
+/**
+* Splits roots into quadratic factors [1 c1 c2]. Complex roots contribute with their conjugate, real roots are
+* paired and a remaining real root gives a first order factor.
+*/
+QVector<Vector3d> quadraticFactors(const QVector<Complex>& roots)
+{
+    QVector<Vector3d> factors;
+    QVector<double> reals;
+
+    for(int i = 0; i < roots.size(); ++i) {
+        double tol = 1e-10 * std::max(1.0, std::abs(roots[i]));
+        if(std::abs(roots[i].imag()) <= tol)
+            reals.append(roots[i].real());
+        else if(roots[i].imag() > 0)
+            factors.append(Vector3d(1.0, -2.0 * roots[i].real(), std::norm(roots[i])));
+    }
+
+    for(int i = 0; i + 1 < reals.size(); i += 2)
+        factors.append(Vector3d(1.0, -(reals[i] + reals[i+1]), reals[i] * reals[i+1]));
+
+    if(reals.size() % 2 != 0)
+        factors.append(Vector3d(1.0, -reals.last(), 0.0));
+
+    return factors;
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+IIRFilter::IIRFilter()
+{
+}
+
+
+//*************************************************************************************************************
+
+IIRFilter::IIRFilter(int order, double centerfreq, double bandwidth, TPassType type, Prototype prototype, double ripple)
+{
+    if(order < 1) {
+        qWarning() << "IIRFilter - Invalid filter order" << order;
+        return;
+    }
+
+    if(prototype == Chebyshev && ripple <= 0.0) {
+        qWarning() << "IIRFilter - Invalid pass band ripple" << ripple;
+        return;
+    }
+
+    //
+    // Analog lowpass prototype with cut off 1 rad/s
+    //
+    QVector<Complex> zeros, poles;
+    double gain = 1.0;
+
+    double eps = std::sqrt(std::pow(10.0, 0.1 * ripple) - 1.0);
+    double mu = std::asinh(1.0 / eps) / order;
+
+    for(int m = -order + 1; m < order; m += 2) {
+        double theta = PI * m / (2.0 * order);
+
+        if(prototype == Chebyshev)
+            poles.append(-std::sinh(Complex(mu, theta)));
+        else
+            poles.append(-std::exp(Complex(0.0, theta)));
+    }
+
+    if(prototype == Chebyshev) {
+        gain = product(poles, 0.0).real();
+        if(order % 2 == 0)
+            gain /= std::sqrt(1.0 + eps * eps);
+    }
+
+    //
+    // Frequency transformation in the s-plane
+    //
+    double low = centerfreq - bandwidth / 2.0;
+    double high = centerfreq + bandwidth / 2.0;
+
+    if((type == LPF || type == HPF) && (centerfreq <= 0.0 || centerfreq >= 1.0)) {
+        qWarning() << "IIRFilter - Cut off frequency" << centerfreq << "has to be between 0 and the nyquist frequency";
+        return;
+    }
+
+    if((type == BPF || type == NOTCH) && (low <= 0.0 || high >= 1.0 || low >= high)) {
+        qWarning() << "IIRFilter - Band" << low << "-" << high << "has to be between 0 and the nyquist frequency";
+        return;
+    }
+
+    int degree = poles.size() - zeros.size();
+
+    switch(type) {
+        case LPF: {
+            double wo = prewarp(centerfreq);
+            for(int i = 0; i < poles.size(); ++i)
+                poles[i] *= wo;
+            gain *= std::pow(wo, degree);
+            break;
+        }
+
+        case HPF: {
+            double wo = prewarp(centerfreq);
+            gain *= (product(zeros, 0.0) / product(poles, 0.0)).real();
+            for(int i = 0; i < poles.size(); ++i)
+                poles[i] = wo / poles[i];
+            for(int i = 0; i < degree; ++i)
+                zeros.append(0.0);
+            break;
+        }
+
+        case BPF: {
+            double w1 = prewarp(low), w2 = prewarp(high);
+            double bw = w2 - w1, wo = std::sqrt(w1 * w2);
+
+            QVector<Complex> bandPoles;
+            for(int i = 0; i < poles.size(); ++i) {
+                Complex p = poles[i] * bw / 2.0;
+                Complex d = std::sqrt(p * p - wo * wo);
+                bandPoles << p + d << p - d;
+            }
+            poles = bandPoles;
+
+            for(int i = 0; i < degree; ++i)
+                zeros.append(0.0);
+            gain *= std::pow(bw, degree);
+            break;
+        }
+
+        case NOTCH: {
+            double w1 = prewarp(low), w2 = prewarp(high);
+            double bw = w2 - w1, wo = std::sqrt(w1 * w2);
+
+            gain *= (product(zeros, 0.0) / product(poles, 0.0)).real();
+
+            QVector<Complex> bandPoles;
+            for(int i = 0; i < poles.size(); ++i) {
+                Complex p = (bw / 2.0) / poles[i];
+                Complex d = std::sqrt(p * p - wo * wo);
+                bandPoles << p + d << p - d;
+            }
+            poles = bandPoles;
+
+            for(int i = 0; i < degree; ++i)
+                zeros << Complex(0.0, wo) << Complex(0.0, -wo);
+            break;
+        }
+    }
+
+    //
+    // Bilinear transform to the z-plane
+    //
+    double fs2 = 2.0 * BILINEAR_FS;
+
+    gain *= (product(zeros, fs2) / product(poles, fs2)).real();
+
+    for(int i = 0; i < zeros.size(); ++i)
+        zeros[i] = (fs2 + zeros[i]) / (fs2 - zeros[i]);
+    for(int i = 0; i < poles.size(); ++i)
+        poles[i] = (fs2 + poles[i]) / (fs2 - poles[i]);
+    while(zeros.size() < poles.size())
+        zeros.append(-1.0);
+
+    //
+    // Second-order sections, the gain is applied to the first one
+    //
+    QVector<Vector3d> num = quadraticFactors(zeros);
+    QVector<Vector3d> den = quadraticFactors(poles);
+
+    m_matSOS = MatrixXd::Zero(den.size(), 6);
+    for(int s = 0; s < den.size(); ++s) {
+        if(s < num.size())
+            m_matSOS.block(s, 0, 1, 3) = num[s].transpose();
+        else
+            m_matSOS(s, 0) = 1.0;
+        m_matSOS.block(s, 3, 1, 3) = den[s].transpose();
+    }
+    m_matSOS.block(0, 0, 1, 3) *= gain;
+}
+
+
+//*************************************************************************************************************
+
+RowVectorXcd IIRFilter::frequencyResponse(const MatrixXd& matSOS, int fftLength)
+{
+    RowVectorXcd response = RowVectorXcd::Ones(fftLength / 2 + 1);
+
+    for(int k = 0; k < response.cols(); ++k) {
+        Complex z1 = std::exp(Complex(0.0, -2.0 * PI * k / fftLength));
+        Complex z2 = z1 * z1;
+
+        for(int s = 0; s < matSOS.rows(); ++s)
+            response(k) *= (matSOS(s,0) + matSOS(s,1) * z1 + matSOS(s,2) * z2) / (matSOS(s,3) + matSOS(s,4) * z1 + matSOS(s,5) * z2);
+    }
+
+    return response;
+}
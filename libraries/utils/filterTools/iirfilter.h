@@ -0,0 +1,123 @@
+//=============================================================================================================
+/**
+* @file     iirfilter.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    IIRFilter class declaration.
+*
+*/
+
+#ifndef IIRFILTER_H
+#define IIRFILTER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Designs Butterworth and Chebyshev (type I) IIR filters as cascades of second-order sections. The analog
+* prototype is transformed to the requested band in the s-plane and mapped to the z-plane with the prewarped
+* bilinear transform.
+*
+* @brief Creates an IIR filter as second-order sections.
+*/
+class UTILSSHARED_EXPORT IIRFilter
+{
+public:
+    enum TPassType {LPF, HPF, BPF, NOTCH };
+
+    enum Prototype {Butterworth, Chebyshev };
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty IIRFilter object.
+    */
+    IIRFilter();
+
+    //=========================================================================================================
+    /**
+    * Constructs an IIRFilter object.
+    *
+    * @param order order of the analog prototype. Band pass and notch filters have twice as many poles.
+    * @param centerfreq cut off frequency (LPF, HPF) or center of the band (BPF, NOTCH), normed to the nyquist frequency
+    * @param bandwidth ignored if type is LPF, HPF. If BPF, NOTCH: width of the band, normed to the nyquist frequency
+    * @param type filter type (lowpass, highpass, etc.)
+    * @param prototype analog prototype
+    * @param ripple pass band ripple in dB, only used by the Chebyshev prototype
+    */
+    IIRFilter(int order, double centerfreq, double bandwidth, TPassType type, Prototype prototype = Butterworth, double ripple = 0.5);
+
+    //=========================================================================================================
+    /**
+    * Evaluates the frequency response of a cascade of second-order sections at fftLength/2+1 equally spaced
+    * frequencies from 0 to the nyquist frequency.
+    *
+    * @param [in] matSOS        second-order sections, one row [b0 b1 b2 a0 a1 a2] per section.
+    * @param [in] fftLength     length of the corresponding fft.
+    *
+    * @return the half spectrum of the filter.
+    */
+    static RowVectorXcd frequencyResponse(const MatrixXd& matSOS, int fftLength);
+
+    MatrixXd        m_matSOS;       /**< the second-order sections, one row [b0 b1 b2 a0 a1 a2] per section. */
+};
+
+} // NAMESPACE UTILSLIB
+
+#endif // IIRFILTER_H
@@ -148,6 +148,13 @@ public:
     */
     inline quint32 size() const;
 
+    //=========================================================================================================
+    /**
+    * Fraction of the buffer which holds matrices that were not popped yet, a snapshot while other threads
+    * push or pop.
+    */
+    inline double fillLevel() const;
+
     //=========================================================================================================
     /**
     * Rows of the stored matrices of the buffer.
@@ -317,6 +324,15 @@ inline quint32 CircularMatrixBuffer<_Tp>::size() const
 }
 
 
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline double CircularMatrixBuffer<_Tp>::fillLevel() const
+{
+    return m_uiMaxNumElements > 0 ? (double)m_pUsedElements->available() / m_uiMaxNumElements : 0.0;
+}
+
+
 //*************************************************************************************************************
 
 template<typename _Tp>
@@ -0,0 +1,536 @@
+//=============================================================================================================
+/**
+* @file     lockfreematrixbuffer.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    LockFreeMatrixBuffer class declaration
+*
+*/
+
+#ifndef LOCKFREEMATRIXBUFFER_H
+#define LOCKFREEMATRIXBUFFER_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+#include "buffer.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <typeinfo>
+#include <string.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QThread>
+#include <stdio.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE IOBUFFER
+//=============================================================================================================
+
+namespace IOBUFFER
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Lock-free matrix ring for exactly one producer and one consumer thread. Head and tail are atomic counters of
+* whole matrices, each slot holds one matrix and is copied with a single memcpy. Producer and consumer can also
+* claim a slot and work on it in place, which avoids the copy altogether. A thread waiting for the other side
+* spins and, depending on the wait policy, backs off to yielding and sleeping.
+*
+* @brief The lock-free single-producer/single-consumer matrix buffer
+*/
+template<typename _Tp>
+class LockFreeMatrixBuffer : public Buffer
+{
+public:
+    typedef QSharedPointer<LockFreeMatrixBuffer> SPtr;              /**< Shared pointer type for LockFreeMatrixBuffer. */
+    typedef QSharedPointer<const LockFreeMatrixBuffer> ConstSPtr;   /**< Const shared pointer type for LockFreeMatrixBuffer. */
+
+    enum WaitPolicy {
+        BusySpin,       /**< Spin until the other side progresses, yielding once every 1024 iterations. Lowest latency, occupies a core while waiting. */
+        Backoff         /**< Spin shortly, then yield, then sleep. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a LockFreeMatrixBuffer.
+    *
+    * @param [in] uiMaxNumMatrices  number of matrix slots.
+    * @param [in] uiRows            Number of rows.
+    * @param [in] uiCols            Number of columns.
+    * @param [in] policy            how to wait for free or filled slots.
+    */
+    explicit LockFreeMatrixBuffer(unsigned int uiMaxNumMatrices, unsigned int uiRows, unsigned int uiCols, WaitPolicy policy = Backoff);
+
+    //=========================================================================================================
+    /**
+    * Destroys the LockFreeMatrixBuffer.
+    */
+    ~LockFreeMatrixBuffer();
+
+    //=========================================================================================================
+    /**
+    * Adds a whole matrix at the end buffer. Waits for a free slot. Producer thread only.
+    *
+    * @param [in] pMatrix pointer to a Matrix which should be apend to the end.
+    */
+    inline void push(const Matrix<_Tp, Dynamic, Dynamic>* pMatrix);
+
+    //=========================================================================================================
+    /**
+    * Returns the first matrix (first in first out). Waits for a filled slot. Consumer thread only.
+    *
+    * @return the first matrix, a zero matrix if the buffer is paused or was released.
+    */
+    inline Matrix<_Tp, Dynamic, Dynamic> pop();
+
+    //=========================================================================================================
+    /**
+    * Copies the first matrix (first in first out) to matrix without reallocating it if it has the right
+    * dimension. Waits for a filled slot. Consumer thread only.
+    *
+    * @param [out] matrix   the first matrix, a zero matrix if the buffer is paused or was released.
+    *
+    * @return true if a matrix was popped, false if the buffer is paused or was released.
+    */
+    inline bool pop(Matrix<_Tp, Dynamic, Dynamic>& matrix);
+
+    //=========================================================================================================
+    /**
+    * Waits for a free slot and returns it for writing rows()*cols() values in column-major order, e.g. through
+    * an Eigen::Map. The slot is published with commitPushSlot(). Producer thread only.
+    *
+    * @return the free slot, NULL if the buffer is paused or was released.
+    */
+    inline _Tp* claimPushSlot();
+
+    //=========================================================================================================
+    /**
+    * Publishes the slot returned by claimPushSlot() to the consumer.
+    */
+    inline void commitPushSlot();
+
+    //=========================================================================================================
+    /**
+    * Waits for a filled slot and returns it for reading rows()*cols() values in column-major order. The slot is
+    * handed back to the producer with commitPopSlot(). Consumer thread only.
+    *
+    * @return the filled slot, NULL if the buffer is paused or was released.
+    */
+    inline const _Tp* claimPopSlot();
+
+    //=========================================================================================================
+    /**
+    * Hands the slot returned by claimPopSlot() back to the producer.
+    */
+    inline void commitPopSlot();
+
+    //=========================================================================================================
+    /**
+    * Drops all matrices which have not been popped yet. Must not run concurrently with pop().
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Size of the buffer.
+    */
+    inline quint32 size() const;
+
+    //=========================================================================================================
+    /**
+    * Number of matrices which can be popped.
+    */
+    inline quint32 count() const;
+
+    //=========================================================================================================
+    /**
+    * Rows of the stored matrices of the buffer.
+    */
+    inline quint32 rows() const;
+
+    //=========================================================================================================
+    /**
+    * Cols of the stored matrices of the buffer.
+    */
+    inline quint32 cols() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the wait policy.
+    *
+    * @param [in] policy    how to wait for free or filled slots.
+    */
+    inline void setWaitPolicy(WaitPolicy policy);
+
+    //=========================================================================================================
+    /**
+    * Pauses the buffer. Skpis any incoming matrices and only pops zero matrices.
+    */
+    inline void pause(bool);
+
+    //=========================================================================================================
+    /**
+    * Releases a waiting or the next waiting pop() from the buffer. It returns a zero matrix.
+    * @param [out] bool returns true if the release was not pending yet, otherwise false.
+    */
+    inline bool releaseFromPop();
+
+    //=========================================================================================================
+    /**
+    * Releases a waiting or the next waiting push() from the buffer. The matrix is skipped.
+    * @param [out] bool returns true if the release was not pending yet, otherwise false.
+    */
+    inline bool releaseFromPush();
+
+private:
+    //=========================================================================================================
+    /**
+    * Waits until a slot is free (producer) or filled (consumer).
+    *
+    * @param [in] bProducer     whether the producer or the consumer waits.
+    *
+    * @return true if a slot is available, false if the wait was released.
+    */
+    inline bool waitForSlot(bool bProducer);
+
+    unsigned int    m_uiMaxNumMatrices;         /**< Holds the maximal number of matrices.*/
+    unsigned int    m_uiRows;                   /**< Holds the number rows.*/
+    unsigned int    m_uiCols;                   /**< Holds the number cols.*/
+    unsigned int    m_uiMatrixSize;             /**< Holds the number of elements of one matrix.*/
+    _Tp*            m_pBuffer;                  /**< Holds the matrix slots.*/
+    WaitPolicy      m_policy;                   /**< Holds the wait policy.*/
+    quint32         m_uiPushIndex;              /**< Holds the index of the slot claimed by the producer.*/
+    quint32         m_uiPopIndex;               /**< Holds the index of the slot claimed by the consumer.*/
+
+    char            m_cPadHead[64];             /**< Keeps head and tail on separate cache lines.*/
+    QAtomicInt      m_iHead;                    /**< Number of pushed matrices, written by the producer only.*/
+    char            m_cPadTail[64];             /**< Keeps head and tail on separate cache lines.*/
+    QAtomicInt      m_iTail;                    /**< Number of popped matrices, written by the consumer only.*/
+    char            m_cPadFlags[64];            /**< Keeps the flags off the counter cache lines.*/
+    QAtomicInt      m_iPause;                   /**< Set while the buffer is paused, written by any thread.*/
+    QAtomicInt      m_iReleasePop;              /**< Set when a pop() is to be released.*/
+    QAtomicInt      m_iReleasePush;             /**< Set when a push() is to be released.*/
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename _Tp>
+LockFreeMatrixBuffer<_Tp>::LockFreeMatrixBuffer(unsigned int uiMaxNumMatrices, unsigned int uiRows, unsigned int uiCols, WaitPolicy policy)
+: Buffer(typeid(_Tp).name())
+, m_uiMaxNumMatrices(uiMaxNumMatrices)
+, m_uiRows(uiRows)
+, m_uiCols(uiCols)
+, m_uiMatrixSize(m_uiRows*m_uiCols)
+, m_pBuffer(new _Tp[m_uiMaxNumMatrices*m_uiMatrixSize])
+, m_policy(policy)
+, m_uiPushIndex(0)
+, m_uiPopIndex(0)
+, m_iHead(0)
+, m_iTail(0)
+, m_iPause(0)
+, m_iReleasePop(0)
+, m_iReleasePush(0)
+{
+
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+LockFreeMatrixBuffer<_Tp>::~LockFreeMatrixBuffer()
+{
+    delete [] m_pBuffer;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void LockFreeMatrixBuffer<_Tp>::push(const Matrix<_Tp, Dynamic, Dynamic>* pMatrix)
+{
+    if(m_iPause.loadAcquire())
+        return;
+
+    if(pMatrix->size() != (int)m_uiMatrixSize) {
+        printf("Error: Matrix not appended to LockFreeMatrixBuffer - wrong dimensions\n");
+        return;
+    }
+
+    _Tp* pSlot = claimPushSlot();
+    if(!pSlot)
+        return;
+
+    memcpy(pSlot, pMatrix->data(), m_uiMatrixSize*sizeof(_Tp));
+    commitPushSlot();
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline Matrix<_Tp, Dynamic, Dynamic> LockFreeMatrixBuffer<_Tp>::pop()
+{
+    Matrix<_Tp, Dynamic, Dynamic> matrix(m_uiRows, m_uiCols);
+    pop(matrix);
+    return matrix;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool LockFreeMatrixBuffer<_Tp>::pop(Matrix<_Tp, Dynamic, Dynamic>& matrix)
+{
+    matrix.resize(m_uiRows, m_uiCols);
+
+    const _Tp* pSlot = claimPopSlot();
+    if(!pSlot) {
+        matrix.setZero();
+        return false;
+    }
+
+    memcpy(matrix.data(), pSlot, m_uiMatrixSize*sizeof(_Tp));
+    commitPopSlot();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline _Tp* LockFreeMatrixBuffer<_Tp>::claimPushSlot()
+{
+    if(m_iPause.loadAcquire() || !waitForSlot(true))
+        return Q_NULLPTR;
+
+    m_uiPushIndex = (quint32)m_iHead.loadAcquire();
+    return m_pBuffer + (m_uiPushIndex % m_uiMaxNumMatrices) * m_uiMatrixSize;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void LockFreeMatrixBuffer<_Tp>::commitPushSlot()
+{
+    m_iHead.storeRelease((int)(m_uiPushIndex + 1));
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline const _Tp* LockFreeMatrixBuffer<_Tp>::claimPopSlot()
+{
+    if(m_iPause.loadAcquire() || !waitForSlot(false))
+        return Q_NULLPTR;
+
+    m_uiPopIndex = (quint32)m_iTail.loadAcquire();
+    return m_pBuffer + (m_uiPopIndex % m_uiMaxNumMatrices) * m_uiMatrixSize;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void LockFreeMatrixBuffer<_Tp>::commitPopSlot()
+{
+    //Relative to the claimed index, so a concurrent clear() can not move the tail past the head
+    m_iTail.storeRelease((int)(m_uiPopIndex + 1));
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool LockFreeMatrixBuffer<_Tp>::waitForSlot(bool bProducer)
+{
+    QAtomicInt& iRelease = bProducer ? m_iReleasePush : m_iReleasePop;
+
+    for(int iSpin = 0; ; ) {
+        quint32 uiCount = (quint32)m_iHead.loadAcquire() - (quint32)m_iTail.loadAcquire();
+        if(bProducer ? uiCount < m_uiMaxNumMatrices : uiCount > 0)
+            return true;
+
+        //A release is consumed by the wait it ends
+        if(iRelease.testAndSetOrdered(1, 0))
+            return false;
+
+        if(m_policy == Backoff) {
+            //The counter stops at the sleep threshold, so it never overflows
+            if(iSpin >= 256) {
+                QThread::usleep(100);
+            } else {
+                if(iSpin >= 64)
+                    QThread::yieldCurrentThread();
+                ++iSpin;
+            }
+        } else if(++iSpin == 1024) {
+            //Let other threads scheduled on this core run now and then
+            QThread::yieldCurrentThread();
+            iSpin = 0;
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+void LockFreeMatrixBuffer<_Tp>::clear()
+{
+    m_iTail.storeRelease(m_iHead.loadAcquire());
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 LockFreeMatrixBuffer<_Tp>::size() const
+{
+    return m_uiMaxNumMatrices;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 LockFreeMatrixBuffer<_Tp>::count() const
+{
+    return (quint32)m_iHead.loadAcquire() - (quint32)m_iTail.loadAcquire();
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 LockFreeMatrixBuffer<_Tp>::rows() const
+{
+    return m_uiRows;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 LockFreeMatrixBuffer<_Tp>::cols() const
+{
+    return m_uiCols;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void LockFreeMatrixBuffer<_Tp>::setWaitPolicy(WaitPolicy policy)
+{
+    m_policy = policy;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void LockFreeMatrixBuffer<_Tp>::pause(bool bPause)
+{
+    m_iPause.storeRelease(bPause ? 1 : 0);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool LockFreeMatrixBuffer<_Tp>::releaseFromPop()
+{
+    return m_iReleasePop.testAndSetOrdered(0, 1);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool LockFreeMatrixBuffer<_Tp>::releaseFromPush()
+{
+    return m_iReleasePush.testAndSetOrdered(0, 1);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// TYPEDEF
+//=============================================================================================================
+
+typedef UTILSSHARED_EXPORT LockFreeMatrixBuffer<float>                    _float_LockFreeMatrixBuffer;               /**< Defines LockFreeMatrixBuffer of float type.*/
+typedef UTILSSHARED_EXPORT LockFreeMatrixBuffer<double>                   _double_LockFreeMatrixBuffer;              /**< Defines LockFreeMatrixBuffer of double type.*/
+
+} // NAMESPACE
+
+#endif // LOCKFREEMATRIXBUFFER_H
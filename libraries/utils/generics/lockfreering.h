@@ -0,0 +1,413 @@
+//=============================================================================================================
+/**
+* @file     lockfreering.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    LockFreeRing class declaration
+*
+*/
+
+#ifndef LOCKFREERING_H
+#define LOCKFREERING_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QThread>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE IOBUFFER
+//=============================================================================================================
+
+namespace IOBUFFER
+{
+
+
+//=============================================================================================================
+/**
+* Bounded lock-free ring of values for any number of producer and consumer threads, each value is taken by
+* exactly one consumer. Every slot carries a sequence number which tells whether it is free or filled for the
+* current lap, producers and consumers claim slots by a compare-and-swap on the enqueue and dequeue counters.
+* Pushing never waits: a full ring rejects the value and counts it as dropped. The time a value spent in the
+* ring is measured and summarized in the statistics.
+*
+* After shutdown() no value is accepted anymore, consumers drain the values which are left and are then
+* released, including those which are waiting in pop().
+*
+* @brief The lock-free multi-producer/multi-consumer ring
+*/
+template<typename _Tp>
+class LockFreeRing
+{
+public:
+    typedef QSharedPointer<LockFreeRing> SPtr;              /**< Shared pointer type for LockFreeRing. */
+    typedef QSharedPointer<const LockFreeRing> ConstSPtr;   /**< Const shared pointer type for LockFreeRing. */
+
+    //=========================================================================================================
+    /**
+    * Hand-off statistics of the ring.
+    */
+    struct Statistics {
+        qint64 iPushed;             /**< Number of accepted values. */
+        qint64 iPopped;             /**< Number of taken values. */
+        qint64 iDropped;            /**< Number of values rejected because the ring was full. */
+        qint64 iLastLatencyUs;      /**< Time the last taken value spent in the ring, in us. */
+        qint64 iMeanLatencyUs;      /**< Mean time a value spent in the ring, in us. */
+        qint64 iMaxLatencyUs;       /**< Longest time a value spent in the ring, in us. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a LockFreeRing.
+    *
+    * @param [in] uiMinSize     minimal number of slots, rounded up to the next power of two.
+    */
+    explicit LockFreeRing(unsigned int uiMinSize);
+
+    //=========================================================================================================
+    /**
+    * Destroys the LockFreeRing.
+    */
+    ~LockFreeRing();
+
+    //=========================================================================================================
+    /**
+    * Appends a value without waiting.
+    *
+    * @param [in] value     the value to append.
+    *
+    * @return true if the value was appended, false if the ring is full or was shut down.
+    */
+    inline bool tryPush(const _Tp& value);
+
+    //=========================================================================================================
+    /**
+    * Takes the first value (first in first out) without waiting.
+    *
+    * @param [out] value    the first value.
+    *
+    * @return true if a value was taken, false if the ring is empty.
+    */
+    inline bool tryPop(_Tp& value);
+
+    //=========================================================================================================
+    /**
+    * Takes the first value (first in first out). Spins shortly when the ring is empty and then backs off to
+    * yielding and sleeping.
+    *
+    * @param [out] value        the first value.
+    * @param [in] iTimeoutMs    maximal time to wait in ms, -1 to wait until a value arrives or the ring is shut down.
+    *
+    * @return true if a value was taken, false on a timeout or if the ring is shut down and empty.
+    */
+    inline bool pop(_Tp& value, int iTimeoutMs = -1);
+
+    //=========================================================================================================
+    /**
+    * Rejects all further values and releases the consumers once the ring is drained.
+    */
+    inline void shutdown();
+
+    //=========================================================================================================
+    /**
+    * Returns whether the ring was shut down.
+    */
+    inline bool isShutdown() const;
+
+    //=========================================================================================================
+    /**
+    * Number of slots.
+    */
+    inline quint32 size() const;
+
+    //=========================================================================================================
+    /**
+    * Number of values which can be popped. Only a snapshot while other threads push or pop.
+    */
+    inline quint32 count() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the hand-off statistics.
+    */
+    inline Statistics statistics() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * A slot of the ring.
+    */
+    struct Slot {
+        QAtomicInt  iSequence;      /**< Equals the enqueue position when the slot is free, the position + 1 when it is filled.*/
+        _Tp         value;          /**< The value.*/
+        qint64      iPushedNs;      /**< Time the value was pushed.*/
+    };
+
+    quint32                 m_uiSize;           /**< Holds the number of slots, a power of two.*/
+    quint32                 m_uiMask;           /**< Holds the mask of the slot index.*/
+    Slot*                   m_pSlots;           /**< Holds the slots.*/
+    QElapsedTimer           m_timer;            /**< Time base of the latency.*/
+
+    char                    m_cPadEnqueue[64];  /**< Keeps the counters on separate cache lines.*/
+    QAtomicInt              m_iEnqueuePos;      /**< Number of claimed push slots.*/
+    char                    m_cPadDequeue[64];  /**< Keeps the counters on separate cache lines.*/
+    QAtomicInt              m_iDequeuePos;      /**< Number of claimed pop slots.*/
+    char                    m_cPadFlags[64];    /**< Keeps the flags and statistics off the counter cache lines.*/
+    QAtomicInt              m_iShutdown;        /**< Set when the ring was shut down.*/
+
+    QAtomicInteger<qint64>  m_iPushed;          /**< Number of accepted values.*/
+    QAtomicInteger<qint64>  m_iPopped;          /**< Number of taken values.*/
+    QAtomicInteger<qint64>  m_iDropped;         /**< Number of rejected values.*/
+    QAtomicInteger<qint64>  m_iLastLatencyNs;   /**< Latency of the last taken value.*/
+    QAtomicInteger<qint64>  m_iSumLatencyNs;    /**< Sum of the latencies of all taken values.*/
+    QAtomicInteger<qint64>  m_iMaxLatencyNs;    /**< Largest latency.*/
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename _Tp>
+LockFreeRing<_Tp>::LockFreeRing(unsigned int uiMinSize)
+: m_uiSize(2)
+, m_iEnqueuePos(0)
+, m_iDequeuePos(0)
+, m_iShutdown(0)
+, m_iPushed(0)
+, m_iPopped(0)
+, m_iDropped(0)
+, m_iLastLatencyNs(0)
+, m_iSumLatencyNs(0)
+, m_iMaxLatencyNs(0)
+{
+    //A power of two keeps the slot index continuous when the counters wrap around
+    while(m_uiSize < uiMinSize)
+        m_uiSize <<= 1;
+    m_uiMask = m_uiSize - 1;
+
+    m_pSlots = new Slot[m_uiSize];
+    for(quint32 i = 0; i < m_uiSize; ++i) {
+        m_pSlots[i].iSequence.storeRelease((int)i);
+        m_pSlots[i].iPushedNs = 0;
+    }
+
+    m_timer.start();
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+LockFreeRing<_Tp>::~LockFreeRing()
+{
+    delete [] m_pSlots;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool LockFreeRing<_Tp>::tryPush(const _Tp& value)
+{
+    if(m_iShutdown.loadAcquire())
+        return false;
+
+    quint32 uiPos = (quint32)m_iEnqueuePos.loadAcquire();
+    Slot* pSlot;
+
+    for(;;) {
+        pSlot = &m_pSlots[uiPos & m_uiMask];
+        qint32 iDiff = (qint32)((quint32)pSlot->iSequence.loadAcquire() - uiPos);
+
+        if(iDiff == 0) {
+            if(m_iEnqueuePos.testAndSetOrdered((int)uiPos, (int)(uiPos + 1)))
+                break;
+            uiPos = (quint32)m_iEnqueuePos.loadAcquire();
+        } else if(iDiff < 0) {
+            //The slot of this lap was not popped yet
+            m_iDropped.fetchAndAddOrdered(1);
+            return false;
+        } else {
+            uiPos = (quint32)m_iEnqueuePos.loadAcquire();
+        }
+    }
+
+    pSlot->value = value;
+    pSlot->iPushedNs = m_timer.nsecsElapsed();
+    pSlot->iSequence.storeRelease((int)(uiPos + 1));
+
+    m_iPushed.fetchAndAddOrdered(1);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool LockFreeRing<_Tp>::tryPop(_Tp& value)
+{
+    quint32 uiPos = (quint32)m_iDequeuePos.loadAcquire();
+    Slot* pSlot;
+
+    for(;;) {
+        pSlot = &m_pSlots[uiPos & m_uiMask];
+        qint32 iDiff = (qint32)((quint32)pSlot->iSequence.loadAcquire() - (uiPos + 1));
+
+        if(iDiff == 0) {
+            if(m_iDequeuePos.testAndSetOrdered((int)uiPos, (int)(uiPos + 1)))
+                break;
+            uiPos = (quint32)m_iDequeuePos.loadAcquire();
+        } else if(iDiff < 0) {
+            //The slot of this lap was not pushed yet
+            return false;
+        } else {
+            uiPos = (quint32)m_iDequeuePos.loadAcquire();
+        }
+    }
+
+    value = pSlot->value;
+    pSlot->value = _Tp();
+    qint64 iLatencyNs = m_timer.nsecsElapsed() - pSlot->iPushedNs;
+    pSlot->iSequence.storeRelease((int)(uiPos + m_uiSize));
+
+    m_iPopped.fetchAndAddOrdered(1);
+    m_iLastLatencyNs.storeRelease(iLatencyNs);
+    m_iSumLatencyNs.fetchAndAddOrdered(iLatencyNs);
+
+    qint64 iMaxLatencyNs = m_iMaxLatencyNs.loadAcquire();
+    while(iLatencyNs > iMaxLatencyNs && !m_iMaxLatencyNs.testAndSetOrdered(iMaxLatencyNs, iLatencyNs))
+        iMaxLatencyNs = m_iMaxLatencyNs.loadAcquire();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool LockFreeRing<_Tp>::pop(_Tp& value, int iTimeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    for(int iSpin = 0; ; ++iSpin) {
+        if(tryPop(value))
+            return true;
+
+        if(m_iShutdown.loadAcquire()) {
+            //A push might have been published between the failed pop and the shutdown check
+            return tryPop(value);
+        }
+
+        if(iTimeoutMs >= 0 && timer.elapsed() >= iTimeoutMs)
+            return false;
+
+        if(iSpin >= 256)
+            QThread::usleep(100);
+        else if(iSpin >= 64)
+            QThread::yieldCurrentThread();
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void LockFreeRing<_Tp>::shutdown()
+{
+    m_iShutdown.storeRelease(1);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool LockFreeRing<_Tp>::isShutdown() const
+{
+    return m_iShutdown.loadAcquire() != 0;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 LockFreeRing<_Tp>::size() const
+{
+    return m_uiSize;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 LockFreeRing<_Tp>::count() const
+{
+    qint32 iCount = (qint32)((quint32)m_iEnqueuePos.loadAcquire() - (quint32)m_iDequeuePos.loadAcquire());
+    return iCount > 0 ? (quint32)iCount : 0;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline typename LockFreeRing<_Tp>::Statistics LockFreeRing<_Tp>::statistics() const
+{
+    Statistics stats;
+    stats.iPushed = m_iPushed.loadAcquire();
+    stats.iPopped = m_iPopped.loadAcquire();
+    stats.iDropped = m_iDropped.loadAcquire();
+    stats.iLastLatencyUs = m_iLastLatencyNs.loadAcquire() / 1000;
+    stats.iMeanLatencyUs = stats.iPopped > 0 ? m_iSumLatencyNs.loadAcquire() / stats.iPopped / 1000 : 0;
+    stats.iMaxLatencyUs = m_iMaxLatencyNs.loadAcquire() / 1000;
+    return stats;
+}
+
+} // NAMESPACE
+
+#endif // LOCKFREERING_H
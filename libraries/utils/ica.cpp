@@ -0,0 +1,374 @@
+//=============================================================================================================
+/**
+* @file     ica.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the Ica class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "ica.h"
+#include "mnemath.h"
+#include "executionconfig.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Eigenvalues>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtMath>
+#include <QtConcurrent>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <random>
+#include <algorithm>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+#define ICA_MIN_BATCH_SAMPLES   4096    /**< Smallest number of samples worth a batch of its own. */
+
+/**
+* Symmetric decorrelation W = (W * W^T)^(-1/2) * W, which makes the rows of W orthonormal without favouring any one.
+*/
+MatrixXd symmetricDecorrelation(const MatrixXd& matW)
+{
+    SelfAdjointEigenSolver<MatrixXd> eig(matW * matW.transpose());
+    VectorXd vecInvSqrt = eig.eigenvalues().cwiseMax(1e-300).cwiseSqrt().cwiseInverse();
+
+    return eig.eigenvectors() * vecInvSqrt.asDiagonal() * eig.eigenvectors().transpose() * matW;
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+Ica::Ica()
+: m_iIterations(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+bool Ica::fit(const MatrixXd& matData, int iComponents, int iDecimation, int iMaxIterations, double dTolerance, unsigned int uSeed)
+{
+    m_matUnmixing.resize(0, matData.rows());
+    m_matMixing.resize(matData.rows(), 0);
+    m_vecMean = VectorXd::Zero(matData.rows());
+    m_iIterations = 0;
+
+    iDecimation = qMax(1, iDecimation);
+    const int iChannels = matData.rows();
+    const int iSamples = (matData.cols() + iDecimation - 1) / iDecimation;
+
+    if(iChannels == 0 || iSamples < 2 || iComponents < 1) {
+        qWarning() << "Ica::fit - Invalid data of" << iChannels << "x" << iSamples << "samples or" << iComponents << "components";
+        return false;
+    }
+
+    //
+    // Center and scale the decimated data
+    //
+    MatrixXd matX(iChannels, iSamples);
+    for(int s = 0; s < iSamples; ++s)
+        matX.col(s) = matData.col(s * iDecimation);
+
+    m_vecMean = matX.rowwise().mean();
+    matX.colwise() -= m_vecMean;
+
+    VectorXd vecScale = (matX.rowwise().squaredNorm() / double(iSamples - 1)).cwiseSqrt();
+    for(int c = 0; c < iChannels; ++c)
+        vecScale(c) = vecScale(c) > 0.0 ? 1.0 / vecScale(c) : 0.0;
+    matX = vecScale.asDiagonal() * matX;
+
+    //
+    // Whitening with the leading principal components, Z = sqrt(n-1) * S^-1 * U^T * X has unit covariance
+    //
+    MatrixXd matU, matV;
+    VectorXd vecS;
+    int iRank = MNEMath::randomizedSvd(matX, iComponents, matU, vecS, matV, 1e-10);
+    if(iRank < iComponents) {
+        qWarning() << "Ica::fit - The data only has rank" << iRank << ", fitting" << iRank << "instead of" << iComponents << "components";
+        iComponents = iRank;
+    }
+    if(iComponents == 0) {
+        qWarning() << "Ica::fit - The data has no variance";
+        return false;
+    }
+
+    const double dSqrtN = std::sqrt(double(iSamples - 1));
+    MatrixXd matWhitening = dSqrtN * vecS.cwiseInverse().asDiagonal() * matU.transpose();
+    MatrixXd matZ = matWhitening * matX;
+    matX.resize(0, 0);
+
+    //
+    // Symmetric FastICA, the sums over the samples are split into batches of contiguous columns
+    //
+    int iBatches = qBound(1, iSamples / ICA_MIN_BATCH_SAMPLES, ExecutionConfig::threadCount());
+    QVector<int> vecBatches;
+    for(int b = 0; b < iBatches; ++b)
+        vecBatches.append(b);
+    QVector<MatrixXd> vecGZ(iBatches);
+    QVector<VectorXd> vecGDeriv(iBatches);
+
+    std::mt19937 generator(uSeed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    MatrixXd matW(iComponents, iComponents);
+    for(int j = 0; j < matW.cols(); ++j)
+        for(int i = 0; i < matW.rows(); ++i)
+            matW(i,j) = normal(generator);
+    matW = symmetricDecorrelation(matW);
+
+    bool bConverged = false;
+    for(m_iIterations = 1; m_iIterations <= iMaxIterations; ++m_iIterations) {
+        //E{g(W*z) * z^T} and E{g'(W*z)} with g = tanh
+        QtConcurrent::blockingMap(vecBatches, [&](const int& b) {
+            int iBegin = b * iSamples / iBatches;
+            int iEnd = (b + 1) * iSamples / iBatches;
+
+            MatrixXd matG = (matW * matZ.middleCols(iBegin, iEnd - iBegin)).array().tanh().matrix();
+            vecGZ[b].noalias() = matG * matZ.middleCols(iBegin, iEnd - iBegin).transpose();
+            vecGDeriv[b] = (1.0 - matG.array().square()).matrix().rowwise().sum();
+        });
+
+        MatrixXd matGZ = vecGZ[0];
+        VectorXd vecG = vecGDeriv[0];
+        for(int b = 1; b < iBatches; ++b) {
+            matGZ += vecGZ[b];
+            vecG += vecGDeriv[b];
+        }
+
+        MatrixXd matWNew = symmetricDecorrelation((matGZ - vecG.asDiagonal() * matW) / double(iSamples));
+
+        //The rows converge up to their sign
+        double dChange = ((matWNew * matW.transpose()).diagonal().cwiseAbs().array() - 1.0).abs().maxCoeff();
+        matW = matWNew;
+
+        if(dChange < dTolerance) {
+            bConverged = true;
+            break;
+        }
+    }
+    m_iIterations = qMin(m_iIterations, iMaxIterations);
+
+    if(!bConverged)
+        qWarning() << "Ica::fit - FastICA did not converge within" << iMaxIterations << "iterations";
+
+    //
+    // Unmixing of the unscaled channels and its pseudo inverse, W * W^T = I gives A = D^-1 U S W^T / sqrt(n-1)
+    //
+    MatrixXd matUnmixing = matW * matWhitening * vecScale.asDiagonal();
+    MatrixXd matMixingScaled = matU * vecS.asDiagonal() * matW.transpose() / dSqrtN;
+
+    //Order by explained variance of the scaled data, the sources have unit variance
+    VectorXd vecVariance = matMixingScaled.colwise().squaredNorm().transpose();
+    QVector<int> vecOrder;
+    for(int i = 0; i < iComponents; ++i)
+        vecOrder.append(i);
+    std::stable_sort(vecOrder.begin(), vecOrder.end(), [&](int a, int b) { return vecVariance(a) > vecVariance(b); });
+
+    m_matUnmixing.resize(iComponents, iChannels);
+    m_matMixing.resize(iChannels, iComponents);
+    for(int i = 0; i < iComponents; ++i) {
+        m_matUnmixing.row(i) = matUnmixing.row(vecOrder[i]);
+        for(int c = 0; c < iChannels; ++c)
+            m_matMixing(c,i) = vecScale(c) > 0.0 ? matMixingScaled(c,vecOrder[i]) / vecScale(c) : 0.0;
+    }
+
+    return bConverged;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd Ica::sources(const MatrixXd& matData) const
+{
+    if(matData.rows() != m_matUnmixing.cols()) {
+        qWarning() << "Ica::sources - Data of" << matData.rows() << "channels does not match the fit of" << m_matUnmixing.cols();
+        return MatrixXd();
+    }
+
+    return m_matUnmixing * (matData.colwise() - m_vecMean);
+}
+
+
+//*************************************************************************************************************
+
+VectorXd Ica::scores(const MatrixXd& matData, const RowVectorXd& vecReference) const
+{
+    VectorXd vecScores = VectorXd::Zero(components());
+
+    if(matData.cols() != vecReference.cols() || matData.cols() < 2) {
+        qWarning() << "Ica::scores - Reference of" << vecReference.cols() << "samples does not match the data of" << matData.cols();
+        return vecScores;
+    }
+
+    MatrixXd matSources = sources(matData);
+    if(matSources.rows() == 0)
+        return vecScores;
+
+    matSources.colwise() -= matSources.rowwise().mean();
+    RowVectorXd vecRef = vecReference.array() - vecReference.mean();
+    double dRefNorm = vecRef.norm();
+
+    for(int i = 0; i < matSources.rows(); ++i) {
+        double dNorm = matSources.row(i).norm() * dRefNorm;
+        vecScores(i) = dNorm > 0.0 ? qAbs(matSources.row(i).dot(vecRef)) / dNorm : 0.0;
+    }
+
+    return vecScores;
+}
+
+
+//*************************************************************************************************************
+
+QVector<int> Ica::findOutliers(const VectorXd& vecScores, double dThreshold, int iMaxIterations)
+{
+    QVector<bool> vecSelected(vecScores.size(), false);
+
+    for(int it = 0; it < iMaxIterations; ++it) {
+        double dSum = 0.0, dSumSq = 0.0;
+        int iCount = 0;
+        for(int i = 0; i < vecScores.size(); ++i) {
+            if(!vecSelected[i]) {
+                dSum += vecScores(i);
+                dSumSq += vecScores(i) * vecScores(i);
+                ++iCount;
+            }
+        }
+        if(iCount < 2)
+            break;
+
+        double dMean = dSum / iCount;
+        double dStd = std::sqrt(qMax(0.0, dSumSq / iCount - dMean * dMean));
+        if(dStd <= 0.0)
+            break;
+
+        bool bNew = false;
+        for(int i = 0; i < vecScores.size(); ++i) {
+            if(!vecSelected[i] && qAbs(vecScores(i) - dMean) / dStd > dThreshold) {
+                vecSelected[i] = true;
+                bNew = true;
+            }
+        }
+        if(!bNew)
+            break;
+    }
+
+    QVector<int> vecOutliers;
+    for(int i = 0; i < vecSelected.size(); ++i)
+        if(vecSelected[i])
+            vecOutliers.append(i);
+
+    return vecOutliers;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd Ica::projector(const QVector<int>& vecExclude) const
+{
+    const int iChannels = m_matUnmixing.cols();
+    MatrixXd matProj = MatrixXd::Identity(iChannels, iChannels);
+
+    for(int i = 0; i < vecExclude.size(); ++i) {
+        int iComp = vecExclude[i];
+        if(iComp < 0 || iComp >= components()) {
+            qWarning() << "Ica::projector - Component" << iComp << "does not exist";
+            continue;
+        }
+        matProj.noalias() -= m_matMixing.col(iComp) * m_matUnmixing.row(iComp);
+    }
+
+    return matProj;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd Ica::projector(const QVector<int>& vecExclude, const QVector<int>& vecPicks, int iNumChannels) const
+{
+    if(vecPicks.size() != m_matUnmixing.cols()) {
+        qWarning() << "Ica::projector - The" << vecPicks.size() << "picks do not match the fit of" << m_matUnmixing.cols() << "channels";
+        return MatrixXd();
+    }
+
+    MatrixXd matPicked = projector(vecExclude);
+    MatrixXd matProj = MatrixXd::Identity(iNumChannels, iNumChannels);
+
+    for(int i = 0; i < vecPicks.size(); ++i) {
+        if(vecPicks[i] < 0 || vecPicks[i] >= iNumChannels) {
+            qWarning() << "Ica::projector - Pick" << vecPicks[i] << "is out of range";
+            return MatrixXd();
+        }
+        for(int j = 0; j < vecPicks.size(); ++j)
+            matProj(vecPicks[i], vecPicks[j]) = matPicked(i,j);
+    }
+
+    return matProj;
+}
@@ -0,0 +1,272 @@
+//=============================================================================================================
+/**
+* @file     ica.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the Ica class.
+*
+*/
+
+#ifndef ICA_H
+#define ICA_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+* Independent component analysis of multi-channel data with FastICA (Hyvarinen, 1999). Every channel is centered
+* and scaled to unit variance, so channels of different types get the same weight, and the data is then whitened
+* with the leading components of a randomized SVD. The whitened data is unmixed with the symmetric (parallel)
+* FastICA fixed point iteration with the logcosh contrast, in which all components are updated at once. The
+* products over the samples are split into batches which run in parallel.
+*
+* The statistics do not depend on the order of the samples, so the fit may only use every iDecimation-th sample
+* of long recordings. Components are scored by their correlation with reference channels, e.g. EOG or ECG, and
+* the selected ones are removed from the data with a single precomputed channel projector, which can be combined
+* with the SSP operator of FIFFLIB::FiffRawData or applied to real-time blocks.
+*
+* @brief FastICA artifact removal.
+*/
+class UTILSSHARED_EXPORT Ica
+{
+
+public:
+    typedef QSharedPointer<Ica> SPtr;             /**< Shared pointer type for Ica. */
+    typedef QSharedPointer<const Ica> ConstSPtr;  /**< Const shared pointer type for Ica. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an unfitted Ica.
+    */
+    Ica();
+
+    //=========================================================================================================
+    /**
+    * Fits the unmixing matrix to the data. Channels without variance do not take part in the whitening.
+    *
+    * @param[in] matData            the data (channels x samples).
+    * @param[in] iComponents        number of components, at most the rank of the data.
+    * @param[in] iDecimation        only every iDecimation-th sample is used.
+    * @param[in] iMaxIterations     maximal number of FastICA iterations.
+    * @param[in] dTolerance         the iteration stops once no row of the unmixing changes its direction by more
+    *                               than this, measured as 1 - |cos| of the angle between the iterates.
+    * @param[in] uSeed              seed of the random start of the unmixing.
+    *
+    * @return true if the iteration converged, false if it did not or the data is invalid. The unmixing of the
+    *         last iteration is kept if it did not converge.
+    */
+    bool fit(const Eigen::MatrixXd& matData,
+             int iComponents,
+             int iDecimation = 1,
+             int iMaxIterations = 200,
+             double dTolerance = 1e-4,
+             unsigned int uSeed = 42);
+
+    //=========================================================================================================
+    /**
+    * Computes the component time courses.
+    *
+    * @param[in] matData    data of the fitted channels (channels x samples).
+    *
+    * @return the sources (components x samples), of unit variance on the fitted data.
+    */
+    Eigen::MatrixXd sources(const Eigen::MatrixXd& matData) const;
+
+    //=========================================================================================================
+    /**
+    * Scores the components by the absolute Pearson correlation of their time courses with a reference channel.
+    *
+    * @param[in] matData        data of the fitted channels (channels x samples).
+    * @param[in] vecReference   the reference, e.g. an EOG or ECG channel of the same samples.
+    *
+    * @return the scores of the components, between 0 and 1.
+    */
+    Eigen::VectorXd scores(const Eigen::MatrixXd& matData, const Eigen::RowVectorXd& vecReference) const;
+
+    //=========================================================================================================
+    /**
+    * Selects outlying scores. The z-scores are computed over the scores not yet selected, all above the threshold
+    * are selected, and this is repeated up to iMaxIterations times or until no further score is selected.
+    *
+    * @param[in] vecScores      the scores, e.g. as returned by scores().
+    * @param[in] dThreshold     the z-score threshold.
+    * @param[in] iMaxIterations maximal number of passes.
+    *
+    * @return the indices of the selected scores in ascending order.
+    */
+    static QVector<int> findOutliers(const Eigen::VectorXd& vecScores, double dThreshold = 3.0, int iMaxIterations = 2);
+
+    //=========================================================================================================
+    /**
+    * Returns the projector which removes components from the fitted channels, I - A_e * W_e with the mixing
+    * columns A_e and unmixing rows W_e of the excluded components. It is applied to the data as is, without
+    * removing the channel means, so the constant offsets of the channels change by A_e * W_e * mean().
+    *
+    * @param[in] vecExclude     indices of the components to remove.
+    *
+    * @return the projector (channels x channels).
+    */
+    Eigen::MatrixXd projector(const QVector<int>& vecExclude) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the projector which removes components, embedded into the identity of all channels of a recording,
+    * e.g. to be combined with the SSP operator of a FIFFLIB::FiffRawData as raw.proj = P * raw.proj.
+    *
+    * @param[in] vecExclude     indices of the components to remove.
+    * @param[in] vecPicks       indices of the fitted channels among all channels, in the order of the fit.
+    * @param[in] iNumChannels   number of all channels.
+    *
+    * @return the projector (iNumChannels x iNumChannels), empty if the picks do not match the fit.
+    */
+    Eigen::MatrixXd projector(const QVector<int>& vecExclude, const QVector<int>& vecPicks, int iNumChannels) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the unmixing matrix. The components are ordered by the variance of the scaled data they explain.
+    *
+    * @return the unmixing (components x channels).
+    */
+    inline const Eigen::MatrixXd& unmixing() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the mixing matrix, the pseudo inverse of the unmixing.
+    *
+    * @return the mixing (channels x components).
+    */
+    inline const Eigen::MatrixXd& mixing() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the channel means of the fitted data.
+    *
+    * @return the means (channels).
+    */
+    inline const Eigen::VectorXd& mean() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of components.
+    *
+    * @return the number of components, 0 if not fitted.
+    */
+    inline int components() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of FastICA iterations of the last fit.
+    *
+    * @return the number of iterations.
+    */
+    inline int iterations() const;
+
+private:
+    Eigen::MatrixXd     m_matUnmixing;  /**< Unmixing (components x channels). */
+    Eigen::MatrixXd     m_matMixing;    /**< Mixing (channels x components). */
+    Eigen::VectorXd     m_vecMean;      /**< Channel means of the fitted data. */
+    int                 m_iIterations;  /**< FastICA iterations of the last fit. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline const Eigen::MatrixXd& Ica::unmixing() const
+{
+    return m_matUnmixing;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::MatrixXd& Ica::mixing() const
+{
+    return m_matMixing;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::VectorXd& Ica::mean() const
+{
+    return m_vecMean;
+}
+
+
+//*************************************************************************************************************
+
+inline int Ica::components() const
+{
+    return m_matUnmixing.rows();
+}
+
+
+//*************************************************************************************************************
+
+inline int Ica::iterations() const
+{
+    return m_iIterations;
+}
+
+}//namespace
+
+#endif // ICA_H
@@ -47,6 +47,7 @@
 //=============================================================================================================
 
 #include <QDataStream>
+#include <QByteArray>
 
 
 //*************************************************************************************************************
@@ -87,8 +88,13 @@ VectorXi IOUtils::fread3_many(QDataStream &p_qStream, qint32 count)
 {
     VectorXi res(count);
 
+    //Read all values at once, a stream read per value dominates the loading time of large surfaces
+    QByteArray bytes(3*count, 0);
+    p_qStream.readRawData(bytes.data(), bytes.size());
+    const unsigned char* ubytes = (const unsigned char*) bytes.constData();
+
     for(qint32 i = 0; i < count; ++i)
-        res[i] = IOUtils::fread3(p_qStream);
+        res[i] = (ubytes[3*i] << 16) + (ubytes[3*i+1] << 8) + ubytes[3*i+2];
 
     return res;
 }
@@ -253,6 +259,38 @@ void IOUtils::swap_doublep(double *source)
 }
 
 
+//*************************************************************************************************************
+
+void IOUtils::swap_shortp_many(qint16 *source, qint64 count)
+{
+    quint16 *usource = (quint16 *)(source);
+
+    for(qint64 i = 0; i < count; ++i)
+        usource[i] = (quint16)((usource[i] >> 8) | (usource[i] << 8));
+}
+
+
+//*************************************************************************************************************
+
+void IOUtils::swap_intp_many(qint32 *source, qint64 count)
+{
+    quint32 *usource = (quint32 *)(source);
+
+    for(qint64 i = 0; i < count; ++i) {
+        const quint32 v = usource[i];
+        usource[i] = (v >> 24) | ((v >> 8) & 0x0000ff00u) | ((v << 8) & 0x00ff0000u) | (v << 24);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void IOUtils::swap_floatp_many(float *source, qint64 count)
+{
+    swap_intp_many((qint32 *)(source), count);
+}
+
+
 //*************************************************************************************************************
 
 QStringList IOUtils::get_new_chnames_conventions(const QStringList& chNames)
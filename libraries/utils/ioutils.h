@@ -202,6 +202,33 @@ public:
     */
     static void swap_doublep(double *source);
 
+    //=========================================================================================================
+    /**
+    * swap an array of shorts in place. The loop is branch free so that it is vectorized by the compiler.
+    *
+    * @param[in, out] source     shorts to swap
+    * @param[in] count           number of shorts
+    */
+    static void swap_shortp_many(qint16 *source, qint64 count);
+
+    //=========================================================================================================
+    /**
+    * swap an array of integers in place. The loop is branch free so that it is vectorized by the compiler.
+    *
+    * @param[in, out] source     integers to swap
+    * @param[in] count           number of integers
+    */
+    static void swap_intp_many(qint32 *source, qint64 count);
+
+    //=========================================================================================================
+    /**
+    * swap an array of floats in place. The loop is branch free so that it is vectorized by the compiler.
+    *
+    * @param[in, out] source     floats to swap
+    * @param[in] count           number of floats
+    */
+    static void swap_floatp_many(float *source, qint64 count);
+
     //=========================================================================================================
     /**
     * Write Eigen Matrix to file
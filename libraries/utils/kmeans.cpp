@@ -50,6 +50,7 @@
 #include <iostream>
 #include <algorithm>
 #include <vector>
+#include <limits>
 #include <time.h>
 
 
@@ -59,6 +60,8 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QList>
+#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -81,6 +84,8 @@ KMeans::KMeans(QString distance, QString start, qint32 replicates, QString empty
 , m_sEmptyact(emptyact)
 , m_iMaxit(maxit)
 , m_bOnline(online)
+, m_bBounded(true)
+, m_iSeed(-1)
 , emptyErrCnt(0)
 , iter(0)
 , k(0)
@@ -103,7 +108,7 @@ bool KMeans::calculate( MatrixXd X, qint32 kClusters, VectorXi& idx, MatrixXd& C
         return false;
 
     //Init random generator
-    srand ( time(NULL) );
+    srand ( m_iSeed < 0 ? time(NULL) : m_iSeed );
 
 // n points in p dimensional space
     k = kClusters;
@@ -155,44 +160,39 @@ bool KMeans::calculate( MatrixXd X, qint32 kClusters, VectorXi& idx, MatrixXd& C
     //
     // Done with input argument processing, begin clustering
     //
-    if (m_bOnline)
-    {
-        Del = MatrixXd(n,k);
-        Del.fill(std::numeric_limits<double>::quiet_NaN());// reassignment criterion
-    }
-
-    double totsumDBest = std::numeric_limits<double>::max();
     emptyErrCnt = 0;
 
-    VectorXi idxBest;
-    MatrixXd Cbest;
-    VectorXd sumDBest;
-    MatrixXd Dbest;
-
+    // The start centroids are drawn up front, so the replicates can run in parallel without sharing the random
+    // generator
+    QList<Replicate> t_qListReplicates;
     for(qint32 rep = 0; rep < m_iReps; ++rep)
     {
+        Replicate t_replicate;
+        t_replicate.totsumD = std::numeric_limits<double>::max();
+        t_replicate.bValid = false;
+
         if (m_sStart.compare("uniform") == 0)
         {
-            C = MatrixXd::Zero(k,p);
+            t_replicate.C = MatrixXd::Zero(k,p);
             for(qint32 i = 0; i < k; ++i)
                 for(qint32 j = 0; j < p; ++j)
-                    C(i,j) = unifrnd(Xmins[j], Xmaxs[j]);
+                    t_replicate.C(i,j) = unifrnd(Xmins[j], Xmaxs[j]);
             // For 'cosine' and 'correlation', these are uniform inside a subset
             // of the unit hypersphere.  Still need to center them for
             // 'correlation'.  (Re)normalization for 'cosine'/'correlation' is
             // done at each iteration.
             if (m_sDistance.compare("correlation") == 0)
-                C.array() -= (C.array().rowwise().sum()/p).replicate(1, p).array();
+                t_replicate.C.array() -= (t_replicate.C.array().rowwise().sum()/p).replicate(1, p).array();
         }
         else if (m_sStart.compare("sample") == 0)
         {
-            C = MatrixXd::Zero(k,p);
+            t_replicate.C = MatrixXd::Zero(k,p);
             for(qint32 i = 0; i < k; ++i)
-                C.block(i,0,1,p) = X.block(rand() % n, 0, 1, p);
-            // DEBUG
-//            C.block(0,0,1,p) = X.block(2, 0, 1, p);
-//            C.block(1,0,1,p) = X.block(7, 0, 1, p);
-//            C.block(2,0,1,p) = X.block(17, 0, 1, p);
+                t_replicate.C.block(i,0,1,p) = X.block(rand() % n, 0, 1, p);
+        }
+        else if (m_sStart.compare("plus") == 0)
+        {
+            t_replicate.C = seedPlus(X);
         }
     //    else if (start.compare("cluster") == 0)
     //    {
@@ -204,126 +204,190 @@ bool KMeans::calculate( MatrixXd X, qint32 kClusters, VectorXi& idx, MatrixXd& C
     //        C = CC(:,:,rep);
     //    }
 
-        // Compute the distance from every point to each cluster centroid and the
-        // initial assignment of points to clusters
-        D = distfun(X, C);//, 0);
-        idx = VectorXi::Zero(D.rows());
-        d = VectorXd::Zero(D.rows());
-
-        for(qint32 i = 0; i < D.rows(); ++i)
-            d[i] = D.row(i).minCoeff(&idx[i]);
+        t_qListReplicates.append(t_replicate);
+    }
 
-        m = VectorXi::Zero(k);
-        for(qint32 i = 0; i < k; ++i)
-            for (qint32 j = 0; j < idx.rows(); ++j)
-                if(idx[j] == i)
-                    ++ m[i];
+    if(m_iReps == 1)
+        runReplicate(X, t_qListReplicates[0]);
+    else
+    {
+        const KMeans* t_pKMeans = this;
+        QtConcurrent::blockingMap(t_qListReplicates, [t_pKMeans, &X](Replicate& replicate) {
+            KMeans t_kMeans(*t_pKMeans);
+            t_kMeans.runReplicate(X, replicate);
+        });
+    }
 
-        try // catch empty cluster errors and move on to next rep
+    // Save the best solution
+    qint32 t_iBest = -1;
+    for(qint32 rep = 0; rep < m_iReps; ++rep)
+    {
+        if(!t_qListReplicates[rep].bValid)
         {
-            // Begin phase one:  batch reassignments
-            bool converged = batchUpdate(X, C, idx);
+            // If an empty cluster error occurred in one of multiple replicates, move on to the next replicate.
+            // Error only when all replicates fail.
+            emptyErrCnt = emptyErrCnt + 1;
+//            printf("Replicate %d terminated: empty cluster created.\n", rep);
+            continue;
+        }
+
+        if(t_iBest < 0 || t_qListReplicates[rep].totsumD < t_qListReplicates[t_iBest].totsumD)
+            t_iBest = rep;
+    }
+
+    if (t_iBest < 0)
+    {
+//        error(message('EmptyClusterAllReps'));
+        return false;
+    }
+
+    // Return the best solution
+    idx = t_qListReplicates[t_iBest].idx;
+    C = t_qListReplicates[t_iBest].C;
+    sumD = t_qListReplicates[t_iBest].sumD;
+    D = t_qListReplicates[t_iBest].D;
+    totsumD = t_qListReplicates[t_iBest].totsumD;
+
+//if hadNaNs
+//    idx = statinsertnan(wasnan, idx);
+//end
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void KMeans::runReplicate(const MatrixXd& X, Replicate& replicate)
+{
+    MatrixXd& C = replicate.C;
+    VectorXi& idx = replicate.idx;
+    MatrixXd& D = replicate.D;
+
+    if (m_bOnline)
+    {
+        Del = MatrixXd(n,k);
+        Del.fill(std::numeric_limits<double>::quiet_NaN());// reassignment criterion
+    }
+
+    // Compute the distance from every point to each cluster centroid and the
+    // initial assignment of points to clusters
+    D = distfun(X, C);//, 0);
+    idx = VectorXi::Zero(D.rows());
+    d = VectorXd::Zero(D.rows());
 
-            // Begin phase two:  single reassignments
-            if (m_bOnline)
-                converged = onlineUpdate(X, C, idx);
+    for(qint32 i = 0; i < D.rows(); ++i)
+        d[i] = D.row(i).minCoeff(&idx[i]);
 
-            if (!converged)
-                printf("Failed To Converge during replicate %d\n", rep);
+    m = VectorXi::Zero(k);
+    for (qint32 j = 0; j < idx.rows(); ++j)
+        ++ m[idx[j]];
 
-            // Calculate cluster-wise sums of distances
-            VectorXi nonempties = VectorXi::Zero(m.rows());
-            quint32 count = 0;
-            for(qint32 i = 0; i < m.rows(); ++i)
+    try // catch empty cluster errors and move on to next rep
+    {
+        // Begin phase one:  batch reassignments
+        bool converged;
+        if(m_bBounded && (m_sDistance.compare("sqeuclidean") == 0 || m_sDistance.compare("cityblock") == 0))
+            converged = boundedUpdate(X, D, C, idx);
+        else
+            converged = batchUpdate(X, C, idx);
+
+        // Begin phase two:  single reassignments
+        if (m_bOnline)
+            converged = onlineUpdate(X, C, idx);
+
+        if (!converged)
+            printf("Failed To Converge during replicate\n");
+
+        // Calculate cluster-wise sums of distances
+        VectorXi nonempties = VectorXi::Zero(m.rows());
+        quint32 count = 0;
+        for(qint32 i = 0; i < m.rows(); ++i)
+        {
+            if(m[i] > 0)
             {
-                if(m[i] > 0)
-                {
-                    nonempties[i] = 1;
-                    ++count;
-                }
+                nonempties[i] = 1;
+                ++count;
             }
-            MatrixXd C_tmp(count,C.cols());
-            count = 0;
-            for(qint32 i = 0; i < nonempties.rows(); ++i)
+        }
+        MatrixXd C_tmp(count,C.cols());
+        count = 0;
+        for(qint32 i = 0; i < nonempties.rows(); ++i)
+        {
+            if(nonempties[i])
             {
-                if(nonempties[i])
-                {
-                    C_tmp.row(count) = C.row(i);
-                    ++count;
-                }
+                C_tmp.row(count) = C.row(i);
+                ++count;
             }
+        }
 
-            MatrixXd D_tmp = distfun(X, C_tmp);//, iter);
-            count = 0;
-            for(qint32 i = 0; i < nonempties.rows(); ++i)
+        MatrixXd D_tmp = distfun(X, C_tmp);//, iter);
+        count = 0;
+        for(qint32 i = 0; i < nonempties.rows(); ++i)
+        {
+            if(nonempties[i])
             {
-                if(nonempties[i])
-                {
-                    D.col(i) = D_tmp.col(count);
-                    C.row(i) = C_tmp.row(count);
-                    ++count;
-                }
+                D.col(i) = D_tmp.col(count);
+                C.row(i) = C_tmp.row(count);
+                ++count;
             }
+        }
 
-            d = VectorXd::Zero(n);
-            for(qint32 i = 0; i < n; ++i)
-                d[i] += D.array()(idx[i]*n+i);//Colum Major
+        d = VectorXd::Zero(n);
+        for(qint32 i = 0; i < n; ++i)
+            d[i] += D.array()(idx[i]*n+i);//Colum Major
 
-            sumD = VectorXd::Zero(k);
-            for(qint32 i = 0; i < k; ++i)
-                for (qint32 j = 0; j < idx.rows(); ++j)
-                    if(idx[j] == i)
-                        sumD[i] += d[j];
+        replicate.sumD = VectorXd::Zero(k);
+        for (qint32 j = 0; j < idx.rows(); ++j)
+            replicate.sumD[idx[j]] += d[j];
 
-            totsumD = sumD.array().sum();
+        replicate.totsumD = replicate.sumD.array().sum();
+        replicate.bValid = true;
 
-//            printf("%d iterations, total sum of distances = %f\n", iter, totsumD);
+//        printf("%d iterations, total sum of distances = %f\n", iter, replicate.totsumD);
+    }
+    catch (int e)
+    {
+        // An empty cluster error, rethrow an other kind of error
+        if(e != 0)
+            throw;
+    } // catch
+}
 
-            // Save the best solution so far
-            if (totsumD < totsumDBest)
-            {
-                totsumDBest = totsumD;
-                idxBest = idx;
-                Cbest = C;
-                sumDBest = sumD;
-                Dbest = D;
-            }
-        }
-        catch (int e)
+
+//*************************************************************************************************************
+
+MatrixXd KMeans::seedPlus(const MatrixXd& X)
+{
+    MatrixXd C = MatrixXd::Zero(k,p);
+    C.row(0) = X.row(rand() % n);
+
+    VectorXd minD = distfun(X, C.row(0));
+
+    for(qint32 i = 1; i < k; ++i)
+    {
+        double t_dSum = minD.sum();
+
+        // Draw the next centroid, all points coincide with a centroid if the sum vanishes
+        qint32 t_iNext = rand() % n;
+        if(t_dSum > 0)
         {
-            if(e == 0)
+            double t_dTarget = t_dSum * ((double)rand() / ((double)RAND_MAX + 1.0));
+            double t_dCum = 0;
+            for(t_iNext = 0; t_iNext < n - 1; ++t_iNext)
             {
-                // If an empty cluster error occurred in one of multiple replicates, catch
-                // it, warn, and move on to next replicate.  Error only when all replicates
-                // fail.  Rethrow an other kind of error.
-                if (m_iReps == 1)
-                    return false;
-                else
-                {
-                    emptyErrCnt = emptyErrCnt + 1;
-//                    printf("Replicate %d terminated: empty cluster created at iteration %d.\n", rep, iter);
-                    if (emptyErrCnt == m_iReps)
-                    {
-//                        error(message('EmptyClusterAllReps'));
-                        return false;
-                    }
-
-                }
+                t_dCum += minD[t_iNext];
+                if(t_dCum > t_dTarget)
+                    break;
             }
-        } // catch
+        }
 
-    } // replicates
+        C.row(i) = X.row(t_iNext);
 
-    // Return the best solution
-    idx = idxBest;
-    C = Cbest;
-    sumD = sumDBest;
-    D = Dbest;
+        if(i < k - 1)
+            minD = minD.cwiseMin(distfun(X, C.row(i)).col(0));
+    }
 
-//if hadNaNs
-//    idx = statinsertnan(wasnan, idx);
-//end
-    return true;
+    return C;
 }
 
 
@@ -372,54 +436,35 @@ bool KMeans::batchUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
         }
 
         // Deal with clusters that have just lost all their members
-        VectorXi empties = VectorXi::Zero(changed.rows());
+        std::vector<int> empties;
         for(qint32 i = 0; i < changed.rows(); ++i)
-            if(m(i) == 0)
-                empties[i] = 1;
+            if(m[changed[i]] == 0)
+                empties.push_back(changed[i]);
 
-        if (empties.sum() > 0)
+        if (!empties.empty())
         {
-            if (m_sEmptyact.compare("error") == 0)
-            {
+            std::vector<int> updated;
+            if(!emptyUpdate(X, empties, C, idx, updated))
                 return converged;
-//                throw 0;
-            }
-            else if (m_sEmptyact.compare("drop") == 0)
-            {
-    //            // Remove the empty cluster from any further processing
-    //            D(:,empties) = NaN;
-    //            changed = changed(m(changed) > 0);
-    //            warning('Empty cluster created at iteration %d during replicate %d.',iter, rep,);
-            }
-            else if (m_sEmptyact.compare("singleton") == 0)
+
+            // Dropped clusters attract no points, the replaced ones and those which gave a point away get their
+            // new distances
+            for(quint32 i = 0; i < empties.size(); ++i)
+                if(m[empties[i]] == 0)
+                    D.col(empties[i]).fill(std::numeric_limits<double>::max());
+
+            std::vector<int> tmp(changed.data(), changed.data() + changed.rows());
+            for(quint32 i = 0; i < updated.size(); ++i)
             {
-    //            warning('Empty cluster created at iteration %d during replicate %d.', iter, rep);
-
-    //            for i = empties
-    //                d = D((idx-1)*n + (1:n)'); // use newly updated distances
-
-    //                % Find the point furthest away from its current cluster.
-    //                % Take that point out of its cluster and use it to create
-    //                % a new singleton cluster to replace the empty one.
-    //                [dlarge, lonely] = max(d);
-    //                from = idx(lonely); % taking from this cluster
-    //                if m(from) < 2
-    //                    % In the very unusual event that the cluster had only
-    //                    % one member, pick any other non-singleton point.
-    //                    from = find(m>1,1,'first');
-    //                    lonely = find(idx==from,1,'first');
-    //                end
-    //                C(i,:) = X(lonely,:);
-    //                m(i) = 1;
-    //                idx(lonely) = i;
-    //                D(:,i) = distfun(X, C(i,:), distance, iter);
-
-    //                % Update clusters from which points are taken
-    //                [C(from,:), m(from)] = gcentroids(X, idx, from, distance);
-    //                D(:,from) = distfun(X, C(from,:), distance, iter);
-    //                changed = unique([changed from]);
-    //            end
+                D.col(updated[i]) = distfun(X, C.row(updated[i]));
+                tmp.push_back(updated[i]);
             }
+
+            std::sort(tmp.begin(),tmp.end());
+            tmp.resize( std::unique(tmp.begin(),tmp.end()) - tmp.begin() );
+            changed.resize(tmp.size());
+            for(quint32 i = 0; i < tmp.size(); ++i)
+                changed[i] = tmp[i];
         }
 
         // Compute the total sum of distances for the current configuration.
@@ -434,8 +479,11 @@ bool KMeans::batchUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
             MatrixXd C_new;
             VectorXi m_new;
             gcentroids(X, idx, changed, C_new, m_new);
-            C.block(0,0,k,C.cols()) = C_new;
-            m.block(0,0,k,1) = m_new;
+            for(qint32 i = 0; i < changed.rows(); ++i)
+            {
+                C.row(changed[i]) = C_new.row(i);
+                m[changed[i]] = m_new[i];
+            }
             --iter;
             break;
         }
@@ -515,6 +563,241 @@ bool KMeans::batchUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
 
 
 
+//*************************************************************************************************************
+
+bool KMeans::emptyUpdate(const MatrixXd& X, const std::vector<int>& empties, MatrixXd& C, VectorXi& idx, std::vector<int>& updated)
+{
+    if (m_sEmptyact.compare("error") == 0)
+        return false;
+
+    // With "drop" the empty clusters simply keep no members
+    if (m_sEmptyact.compare("singleton") == 0)
+    {
+//        printf("Empty cluster created at iteration %d.\n", iter);
+        for(quint32 e = 0; e < empties.size(); ++e)
+        {
+            qint32 i = empties[e];
+
+            // Find the point furthest away from its current cluster. Take that point out of its cluster and use
+            // it to create a new singleton cluster to replace the empty one.
+            MatrixXd D = distfun(X, C);
+            qint32 lonely = 0;
+            double dlarge = -1;
+            for(qint32 j = 0; j < n; ++j)
+            {
+                if(m[idx[j]] > 0 && D(j, idx[j]) > dlarge)
+                {
+                    dlarge = D(j, idx[j]);
+                    lonely = j;
+                }
+            }
+
+            qint32 from = idx[lonely];
+            if (m[from] < 2)
+            {
+                // In the very unusual event that the cluster had only one member, pick any other non-singleton
+                // point
+                for(from = 0; from < k && m[from] < 2; ++from);
+                if(from == k)
+                    return false;
+                for(lonely = 0; idx[lonely] != from; ++lonely);
+            }
+
+            C.row(i) = X.row(lonely);
+            m[i] = 1;
+            idx[lonely] = i;
+
+            // Update the cluster from which the point was taken
+            MatrixXd C_from;
+            VectorXi m_from;
+            gcentroids(X, idx, VectorXi::Constant(1, from), C_from, m_from);
+            C.row(from) = C_from.row(0);
+            m[from] = m_from[0];
+
+            updated.push_back(i);
+            updated.push_back(from);
+        }
+
+        std::sort(updated.begin(),updated.end());
+        updated.resize( std::unique(updated.begin(),updated.end()) - updated.begin() );
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool KMeans::boundedUpdate(const MatrixXd& X, const MatrixXd& D, MatrixXd& C, VectorXi& idx)
+{
+    // The bounds need a metric, so the square root of the squared euclidean distance is used
+    bool bSqEuclidean = m_sDistance.compare("sqeuclidean") == 0;
+    double dInf = std::numeric_limits<double>::max();
+
+    // Points and centroids as columns, so the distance of a single point reads contiguous memory
+    MatrixXd Xt = X.transpose();
+    MatrixXd Ct = C.transpose();
+
+    // Metric distance of a point to a centroid
+    auto metric = [&](qint32 i, qint32 j) -> double {
+        return bSqEuclidean ? (Xt.col(i) - Ct.col(j)).norm() : (Xt.col(i) - Ct.col(j)).cwiseAbs().sum();
+    };
+
+    // Upper bound of the distance of each point to its own centroid, lower bounds of the distances to all
+    // centroids, one column per point. The start distances are exact.
+    VectorXd upper(n);
+    MatrixXd lower = D.transpose();
+    if(bSqEuclidean)
+        lower = lower.array().sqrt();
+
+    for(qint32 i = 0; i < n; ++i)
+        upper[i] = lower(idx[i], i);
+
+    VectorXi changed(k);
+    for(qint32 i = 0; i < k; ++i)
+        changed[i] = i;
+
+    VectorXd delta(k);
+
+    //
+    // Begin phase one:  batch reassignments
+    //
+    iter = 0;
+    bool converged = false;
+    while(true)
+    {
+        ++iter;
+
+        // Calculate the new cluster centroids and counts and how far the centroids moved
+        MatrixXd C_new;
+        VectorXi m_new;
+        gcentroids(X, idx, changed, C_new, m_new);
+
+        delta.setZero();
+        for(qint32 i = 0; i < changed.rows(); ++i)
+        {
+            m[changed[i]] = m_new[i];
+            if(m_new[i] > 0)
+                delta[changed[i]] = bSqEuclidean ? (C.row(changed[i]) - C_new.row(i)).norm() : (C.row(changed[i]) - C_new.row(i)).cwiseAbs().sum();
+            C.row(changed[i]) = C_new.row(i);
+            Ct.col(changed[i]) = C_new.row(i).transpose();
+        }
+
+        // Move the bounds with the centroids, the bounds of unchanged centroids stay exact
+        for(qint32 i = 0; i < n; ++i)
+            upper[i] += delta[idx[i]];
+        for(qint32 i = 0; i < changed.rows(); ++i)
+            lower.row(changed[i]).array() -= delta[changed[i]];
+
+        // Deal with clusters that have just lost all their members the same way batchUpdate does. Dropped
+        // clusters are skipped by the reassignment, the bounds to replaced centroids are recomputed exactly.
+        std::vector<int> empties;
+        for(qint32 i = 0; i < changed.rows(); ++i)
+            if(m[changed[i]] == 0)
+                empties.push_back(changed[i]);
+
+        if (!empties.empty())
+        {
+            std::vector<int> updated;
+            if(!emptyUpdate(X, empties, C, idx, updated))
+                return converged;
+
+            std::vector<bool> isUpdated(k, false);
+            for(quint32 i = 0; i < updated.size(); ++i)
+            {
+                qint32 j = updated[i];
+                isUpdated[j] = true;
+                Ct.col(j) = C.row(j).transpose();
+                for(qint32 l = 0; l < n; ++l)
+                    lower(j,l) = metric(l, j);
+            }
+            for(qint32 i = 0; i < n; ++i)
+                if(isUpdated[idx[i]])
+                    upper[i] = lower(idx[i], i);
+        }
+
+        if (iter >= m_iMaxit)
+            break;
+
+        // Half the distances between the centroids, no point closer to its centroid than half the distance to
+        // another centroid can move there
+        MatrixXd halfD_C = MatrixXd::Constant(k, k, dInf);
+        if(k > 1)
+        {
+            halfD_C = distfun(C, C);
+            if(bSqEuclidean)
+                halfD_C = 0.5 * halfD_C.array().sqrt();
+            else
+                halfD_C *= 0.5;
+            halfD_C = (halfD_C.array() == halfD_C.array()).select(halfD_C, dInf);
+            halfD_C.diagonal().setConstant(dInf);
+        }
+        VectorXd halfSep = halfD_C.colwise().minCoeff().transpose();
+
+        // Reassign each point whose bounds do not rule out a move, ties are resolved in favor of not moving
+        std::vector<int> tmp;
+        for(qint32 i = 0; i < n; ++i)
+        {
+            qint32 a = idx[i];
+            if(upper[i] <= halfSep[a])
+                continue;
+
+            bool bTight = false;
+            for(qint32 j = 0; j < k; ++j)
+            {
+                if(j == a || m[j] == 0 || upper[i] <= lower(j,i) || upper[i] <= halfD_C(j,a))
+                    continue;
+
+                if(!bTight)
+                {
+                    upper[i] = metric(i, a);
+                    lower(a,i) = upper[i];
+                    bTight = true;
+                    if(upper[i] <= lower(j,i) || upper[i] <= halfD_C(j,a))
+                        continue;
+                }
+
+                lower(j,i) = metric(i, j);
+                if(lower(j,i) < upper[i])
+                {
+                    a = j;
+                    upper[i] = lower(j,i);
+                }
+            }
+
+            if(a != idx[i])
+            {
+                tmp.push_back(idx[i]);
+                tmp.push_back(a);
+                idx[i] = a;
+            }
+        }
+
+//        printf("%6d\t%6d\t%8d\n",iter,1,(int)tmp.size()/2);
+        if (tmp.empty())
+        {
+            converged = true;
+            break;
+        }
+
+        // Find clusters that gained or lost members
+        std::sort(tmp.begin(),tmp.end());
+        tmp.resize( std::unique(tmp.begin(),tmp.end()) - tmp.begin() );
+
+        changed.resize(tmp.size());
+        for(quint32 i = 0; i < tmp.size(); ++i)
+            changed[i] = tmp[i];
+    } // phase one
+
+    // Compute the total sum of distances for the final configuration
+    totsumD = 0;
+    for(qint32 i = 0; i < n; ++i)
+        totsumD += bSqEuclidean ? (Xt.col(i) - Ct.col(idx[i])).squaredNorm() : (Xt.col(i) - Ct.col(idx[i])).cwiseAbs().sum();
+
+    return converged;
+}
+
+
 //*************************************************************************************************************
 
 bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
@@ -594,6 +877,11 @@ bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
     qint32 nummoved = 0;
     qint32 iter1 = iter;
     bool converged = false;
+
+    VectorXi nidx = VectorXi::Zero(Del.rows());
+    VectorXd minDel = VectorXd::Zero(Del.rows());
+    bool bFullScan = true;
+
     while (iter < m_iMaxit)
     {
         // Calculate distances to each cluster from each point, and the
@@ -718,11 +1006,39 @@ bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
         previdx = idx;
         prevtotsumD = totsumD;
 
-        VectorXi nidx = VectorXi::Zero(Del.rows());
-        VectorXd minDel = VectorXd::Zero(Del.rows());
+        if(bFullScan)
+        {
+            for(qint32 i = 0; i < Del.rows(); ++i)
+                minDel[i] = Del.row(i).minCoeff(&nidx[i]);
+            bFullScan = false;
+        }
+        else
+        {
+            // Only the columns of the changed clusters are new. Points whose best move pointed to one of them are
+            // rescanned, all others only compare against the new columns.
+            VectorXi rescan = VectorXi::Zero(Del.rows());
+            for(qint32 i = 0; i < Del.rows(); ++i)
+                for(qint32 j = 0; j < changed.rows(); ++j)
+                    if(nidx[i] == changed[j])
+                        rescan[i] = 1;
+
+            for(qint32 j = 0; j < changed.rows(); ++j)
+            {
+                qint32 c = changed[j];
+                for(qint32 i = 0; i < Del.rows(); ++i)
+                {
+                    if(!rescan[i] && (Del(i,c) < minDel[i] || (Del(i,c) == minDel[i] && c < nidx[i])))
+                    {
+                        minDel[i] = Del(i,c);
+                        nidx[i] = c;
+                    }
+                }
+            }
 
-        for(qint32 i = 0; i < Del.rows(); ++i)
-            minDel[i] = Del.row(i).minCoeff(&nidx[i]);
+            for(qint32 i = 0; i < Del.rows(); ++i)
+                if(rescan[i])
+                    minDel[i] = Del.row(i).minCoeff(&nidx[i]);
+        }
 
         VectorXi moved = VectorXi::Zero(previdx.rows());
         qint32 count = 0;
@@ -788,26 +1104,25 @@ bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
         lastmoved = moved[0];
 
         qint32 oidx = idx(moved[0]);
-        nidx[0] = nidx(moved[0]);
-        nidx.conservativeResize(1);
-        totsumD += Del(moved[0],nidx[0]) - Del(moved[0],oidx);
+        qint32 nidx0 = nidx(moved[0]);
+        totsumD += Del(moved[0],nidx0) - Del(moved[0],oidx);
 
         // Update the cluster index vector, and the old and new cluster
         // counts and centroids
-        idx[ moved[0] ] = nidx[0];
-        m( nidx[0] ) = m( nidx[0] ) + 1;
+        idx[ moved[0] ] = nidx0;
+        m( nidx0 ) = m( nidx0 ) + 1;
         m( oidx ) = m( oidx ) - 1;
 
 
         if (m_sDistance.compare("sqeuclidean") == 0)
         {
-            C.row(nidx[0]) = C.row(nidx[0]).array() + (X.row(moved[0]) - C.row(nidx[0])).array() / m[nidx[0]];
+            C.row(nidx0) = C.row(nidx0).array() + (X.row(moved[0]) - C.row(nidx0)).array() / m[nidx0];
             C.row(oidx) = C.row(oidx).array() - (X.row(moved[0]) - C.row(oidx)).array() / m[oidx];
         }
         else if (m_sDistance.compare("cityblock") == 0)
         {
             VectorXi onidx(2);
-            onidx << oidx, nidx[0];//ToDo always right?
+            onidx << oidx, nidx0;//ToDo always right?
 
             qint32 i;
             for(qint32 h = 0; h < 2; ++h)
@@ -855,7 +1170,7 @@ bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
         }
         else if (m_sDistance.compare("cosine") == 0 || m_sDistance.compare("correlation") == 0)
         {
-            C.row(nidx[0]).array() += (X.row(moved[0]) - C.row(nidx[0])).array() / m[nidx[0]];
+            C.row(nidx0).array() += (X.row(moved[0]) - C.row(nidx0)).array() / m[nidx0];
             C.row(oidx).array() += (X.row(moved[0]) - C.row(oidx)).array() / m[oidx];
         }
         else if (m_sDistance.compare("hamming") == 0)
@@ -868,8 +1183,8 @@ bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
 //                C(oidx,:) = .5*sign(2*Xsum(oidx,:) - m(oidx)) + .5;
         }
 
-        VectorXi sorted_onidx(1+nidx.rows());
-        sorted_onidx << oidx, nidx;
+        VectorXi sorted_onidx(2);
+        sorted_onidx << oidx, nidx0;
         std::sort(sorted_onidx.data(), sorted_onidx.data()+sorted_onidx.rows());
         changed = sorted_onidx;
     } // phase two
@@ -881,20 +1196,18 @@ bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
 
 //*************************************************************************************************************
 //DISTFUN Calculate point to cluster centroid distances.
-MatrixXd KMeans::distfun(const MatrixXd& X, MatrixXd& C)//, qint32 iter)
+MatrixXd KMeans::distfun(const MatrixXd& X, const MatrixXd& C)//, qint32 iter)
 {
-    MatrixXd D = MatrixXd::Zero(n,C.rows());
+    MatrixXd D = MatrixXd::Zero(X.rows(),C.rows());
     qint32 nclusts = C.rows();
 
     if (m_sDistance.compare("sqeuclidean") == 0)
     {
-        for(qint32 i = 0; i < nclusts; ++i)
-        {
-            D.col(i) = (X.col(0).array() - C(i,0)).pow(2);
-
-            for(qint32 j = 1; j < p; ++j)
-                D.col(i) = D.col(i).array() + (X.col(j).array() - C(i,j)).pow(2);
-        }
+        // |x - c|^2 = |x|^2 + |c|^2 - 2 x c', the cross terms are one matrix product
+        D.noalias() = -2.0 * X * C.transpose();
+        D.colwise() += X.rowwise().squaredNorm();
+        D.rowwise() += C.rowwise().squaredNorm().transpose();
+        D = (D.array() < 0.0).select(0.0, D); // keeps the NaN distances of empty clusters
     }
     else if (m_sDistance.compare("cityblock") == 0)
     {
@@ -910,17 +1223,12 @@ MatrixXd KMeans::distfun(const MatrixXd& X, MatrixXd& C)//, qint32 iter)
     else if (m_sDistance.compare("cosine") == 0 || m_sDistance.compare("correlation") == 0)
     {
         // The points are normalized, centroids are not, so normalize them
-        MatrixXd normC = C.array().pow(2).rowwise().sum().sqrt();
+        VectorXd normC = C.rowwise().norm();
 //        if any(normC < eps(class(normC))) % small relative to unit-length data points
 //            error('Zero cluster centroid created at iteration %d.',iter);
-        for (qint32 i = 0; i < nclusts; ++i)
-        {
-            MatrixXd C_tmp = (C.row(i).array() / normC(i,0)).transpose();
-            D.col(i) = X * C_tmp;//max(1 - X * (C(i,:)./normC(i))', 0);
-            for(qint32 j = 0; j < D.rows(); ++j)
-                if(D(j,i) < 0)
-                    D(j,i) = 0;
-        }
+        D.noalias() = X * (normC.cwiseInverse().asDiagonal() * C).transpose();
+        D = 1.0 - D.array();
+        D = (D.array() < 0.0).select(0.0, D);//max(1 - X * (C(i,:)./normC(i))', 0);
     }
 //case 'hamming'
 //    for i = 1:nclusts
@@ -946,50 +1254,38 @@ void KMeans::gcentroids(const MatrixXd& X, const VectorXi& index, const VectorXi
     centroids.fill(std::numeric_limits<double>::quiet_NaN());
     counts = VectorXi::Zero(num);
 
-    VectorXi members;
+    // Sort the points into their clusters once, instead of scanning all points per cluster
+    std::vector<std::vector<qint32> > t_vecMembers(k);
+    for(qint32 j = 0; j < index.rows(); ++j)
+        if(index[j] >= 0 && index[j] < k)
+            t_vecMembers[index[j]].push_back(j);
 
     qint32 c;
 
     for(qint32 i = 0; i < num; ++i)
     {
-        c = 0;
-        members = VectorXi::Zero(index.rows());
-        for(qint32 j = 0; j < index.rows(); ++j)
-        {
-            if(index[j] == clusts[i])
-            {
-                members[c] = j;
-                ++c;
-            }
-        }
-        members.conservativeResize(c);
+        const std::vector<qint32>& members = t_vecMembers[clusts[i]];
+        c = members.size();
         if (c > 0)
         {
             counts[i] = c;
             if(m_sDistance.compare("sqeuclidean") == 0)
             {
                 //Initialize
-                if(members.rows() > 0)
-                    centroids.row(i) = RowVectorXd::Zero(centroids.cols());
+                centroids.row(i) = RowVectorXd::Zero(centroids.cols());
 
-                for(qint32 j = 0; j < members.rows(); ++j)
-                    centroids.row(i).array() += X.row(members[j]).array() / counts[i];
+                for(qint32 j = 0; j < c; ++j)
+                    centroids.row(i) += X.row(members[j]);
+                centroids.row(i) /= counts[i];
             }
             else if(m_sDistance.compare("cityblock") == 0)
             {
                 // Separate out sorted coords for points in i'th cluster,
                 // and use to compute a fast median, component-wise
                 MatrixXd Xsorted(counts[i],p);
-                c = 0;
 
-                for(qint32 j = 0; j < index.rows(); ++j)
-                {
-                    if(index[j] == clusts[i])
-                    {
-                        Xsorted.row(c) = X.row(j);
-                        ++c;
-                    }
-                }
+                for(qint32 j = 0; j < c; ++j)
+                    Xsorted.row(j) = X.row(members[j]);
 
                 for(qint32 j = 0; j < Xsorted.cols(); ++j)
                     std::sort(Xsorted.col(j).data(),Xsorted.col(j).data()+Xsorted.rows());
@@ -1002,7 +1298,9 @@ void KMeans::gcentroids(const MatrixXd& X, const VectorXi& index, const VectorXi
             }
             else if(m_sDistance.compare("cosine") == 0 || m_sDistance.compare("correlation") == 0)
             {
-                for(qint32 j = 0; j < members.rows(); ++j)
+                centroids.row(i) = RowVectorXd::Zero(centroids.cols());
+
+                for(qint32 j = 0; j < c; ++j)
                     centroids.row(i).array() += X.row(members[j]).array() / counts[i]; // unnormalized
             }
 //            else if(m_sDistance.compare("hamming") == 0)
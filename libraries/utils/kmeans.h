@@ -44,6 +44,14 @@
 #include "utils_global.h"
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <vector>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // Qt INCLUDES
@@ -90,7 +98,7 @@ public:
     typedef QSharedPointer<const KMeans> ConstSPtr; /**< Const shared pointer type for KMeans. */
 
     //distance {'sqeuclidean','cityblock','cosine','correlation','hamming'};
-    //startNames = {'uniform','sample','cluster'};
+    //startNames = {'uniform','sample','plus','cluster'};
     //emptyactNames = {'error','drop','singleton'};
 
     //=========================================================================================================
@@ -98,8 +106,8 @@ public:
     * Constructs a KMeans algorithm object.
     *
     * @param[in] distance   (optional) K-Means distance measure: "sqeuclidean" (default), "cityblock" , "cosine", "correlation", "hamming"
-    * @param[in] start      (optional) Cluster initialization: "sample" (default), "uniform", "cluster"
-    * @param[in] replicates (optional) Number of K-Means replicates, which are generated. Best is returned.
+    * @param[in] start      (optional) Cluster initialization: "sample" (default), "uniform", "plus" (k-means++), "cluster"
+    * @param[in] replicates (optional) Number of K-Means replicates, which are generated in parallel. Best is returned.
     * @param[in] emptyact   (optional) What happens if a cluster wents empty: "error" (default), "drop", "singleton"
     * @param[in] online     (optional) If centroids should be updated during iterations: true (default), false
     * @param[in] maxit      (optional) maximal number of iterations per replicate; 100 by default
@@ -119,8 +127,60 @@ public:
     */
     bool calculate( MatrixXd X, qint32 kClusters, VectorXi& idx, MatrixXd& C, VectorXd& sumD, MatrixXd& D);
 
+    //=========================================================================================================
+    /**
+    * Sets the seed of the random generator which draws the start centroids.
+    *
+    * @param[in] seed   The seed, a negative seed (default) seeds with the current time
+    */
+    inline void setSeed(qint32 seed);
+
+    //=========================================================================================================
+    /**
+    * Switches the bounded batch phase for "sqeuclidean" and "cityblock", on by default. Switched off, the plain
+    * batch phase runs for all distances.
+    *
+    * @param[in] bounded    If the bounded batch phase should be used
+    */
+    inline void setBounded(bool bounded);
+
 
 private:
+    //=========================================================================================================
+    /**
+    * The state and the result of one replicate.
+    */
+    struct Replicate
+    {
+        MatrixXd C;         /**< Cluster centroids, initialized with the start centroids */
+        VectorXi idx;       /**< The cluster indeces to which cluster the input points belong to */
+        VectorXd sumD;      /**< Summation of the distances to the centroid within one cluster */
+        MatrixXd D;         /**< Cluster distances to the centroid */
+        double totsumD;     /**< Total sum of centroid distances */
+        bool bValid;        /**< If the replicate finished without an empty cluster error */
+    };
+
+    //=========================================================================================================
+    /**
+    * Runs a replicate from its start centroids. Uses the iteration state of this object, so parallel replicates
+    * run on copies.
+    *
+    * @param[in] X              Input data
+    * @param[in, out] replicate The replicate
+    */
+    void runReplicate(const MatrixXd& X, Replicate& replicate);
+
+    //=========================================================================================================
+    /**
+    * k-means++ seeding. Each further centroid is a point drawn with a probability proportional to its distance to
+    * the closest centroid chosen so far.
+    *
+    * @param[in] X  Input data
+    *
+    * @return The start centroids
+    */
+    MatrixXd seedPlus(const MatrixXd& X);
+
     //=========================================================================================================
     /**
     * Calculate point to cluster centroid distances.
@@ -130,7 +190,24 @@ private:
     *
     * @return Cluster centroid distances
     */
-    MatrixXd distfun(const MatrixXd& X, MatrixXd& C);//, qint32 iter);
+    MatrixXd distfun(const MatrixXd& X, const MatrixXd& C);//, qint32 iter);
+
+    //=========================================================================================================
+    /**
+    * Batch reassignments for the metric distances "sqeuclidean" and "cityblock" after Elkan. An upper bound of
+    * the distance to the own centroid and lower bounds of the distances to all centroids are kept per point and
+    * moved with the centroids. Together with the triangle inequality on the centroid distances they rule out most
+    * moves, so only few distances are computed once the centroids settle. Yields the same assignments as
+    * batchUpdate.
+    *
+    * @param[in] X          Input data
+    * @param[in] D          Distances of the points to the start centroids
+    * @param[in, out] C     Cluster centroids
+    * @param[in, out] idx   The cluster indeces to which cluster the input points belong to
+    *
+    * @return true if converged, false otherwise
+    */
+    bool boundedUpdate(const MatrixXd& X, const MatrixXd& D, MatrixXd& C, VectorXi& idx);
 
     //=========================================================================================================
     /**
@@ -144,6 +221,22 @@ private:
     */
     bool batchUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx);
 
+    //=========================================================================================================
+    /**
+    * Handles clusters which lost all their members in the batch phase according to the empty action: "error"
+    * stops the batch phase, "drop" keeps the clusters out of further processing and "singleton" replaces each
+    * by the point furthest away from its centroid.
+    *
+    * @param[in] X              Input data
+    * @param[in] empties        The clusters which went empty
+    * @param[in, out] C         Cluster centroids
+    * @param[in, out] idx       The cluster indeces to which cluster the input points belong to
+    * @param[out] updated       The clusters whose centroids were replaced or lost a point to a singleton
+    *
+    * @return false if the batch phase has to stop, true otherwise
+    */
+    bool emptyUpdate(const MatrixXd& X, const std::vector<int>& empties, MatrixXd& C, VectorXi& idx, std::vector<int>& updated);
+
     //=========================================================================================================
     /**
     * Centroids and counts stratified by group.
@@ -188,6 +281,8 @@ private:
     QString m_sEmptyact;    /**< What should be done if a cluster wents empty: "error" (default), "drop", "singleton" */
     qint32 m_iMaxit;        /**< Maximal number of iterations per replicate */
     bool m_bOnline;         /**< If online update should be performed */
+    bool m_bBounded;        /**< If the bounded batch phase is used for "sqeuclidean" and "cityblock" */
+    qint32 m_iSeed;         /**< Seed of the random generator, negative to seed with the current time */
 
     qint32 emptyErrCnt;     /**< Counts the occurence of empty errors */
 
@@ -208,6 +303,25 @@ private:
 
 };
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline void KMeans::setSeed(qint32 seed)
+{
+    m_iSeed = seed;
+}
+
+
+//*************************************************************************************************************
+
+inline void KMeans::setBounded(bool bounded)
+{
+    m_bBounded = bounded;
+}
+
 } // NAMESPACE
 
 #endif // KMEANS_H
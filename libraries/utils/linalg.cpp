@@ -0,0 +1,416 @@
+//=============================================================================================================
+/**
+* @file     linalg.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the LinAlg class.
+*
+*/
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "linalg.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QLibrary>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QStringList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// SYSTEM INCLUDES
+//=============================================================================================================
+
+#include <stdio.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+typedef void (*SgemmFunc)(const char*, const char*, const int*, const int*, const int*,
+                          const float*, const float*, const int*, const float*, const int*,
+                          const float*, float*, const int*);     /**< The Fortran sgemm. */
+
+typedef void (*DgemmFunc)(const char*, const char*, const int*, const int*, const int*,
+                          const double*, const double*, const int*, const double*, const int*,
+                          const double*, double*, const int*);   /**< The Fortran dgemm. */
+
+typedef void (*SetThreadsFunc)(int);                             /**< The thread setters of MKL and OpenBLAS. */
+
+typedef Matrix<float,Dynamic,Dynamic,RowMajor> MatrixRowMajorXf;
+typedef Matrix<double,Dynamic,Dynamic,RowMajor> MatrixRowMajorXd;
+
+
+//=============================================================================================================
+/**
+* The loaded library and the selected backend.
+*/
+struct LinAlgRegistry {
+    QMutex                      mutex;          /**< Guards the registry. */
+    QSharedPointer<QLibrary>    pLibrary;       /**< The loaded library. */
+    SgemmFunc                   sgemm;          /**< sgemm of the loaded library. */
+    DgemmFunc                   dgemm;          /**< dgemm of the loaded library. */
+    SetThreadsFunc              setThreads;     /**< The thread setter of the loaded library, NULL if it has none. */
+    LinAlg::Backend             backend;        /**< The selected backend. */
+    qint64                      iMinimumSize;   /**< Multiply-adds from which on the library is used. */
+
+    LinAlgRegistry()
+    : sgemm(NULL)
+    , dgemm(NULL)
+    , setThreads(NULL)
+    , backend(LinAlg::EigenBackend)
+    , iMinimumSize(32768)
+    {
+    }
+};
+
+
+//*************************************************************************************************************
+
+LinAlgRegistry& linAlgRegistry()
+{
+    static LinAlgRegistry s_registry;
+    return s_registry;
+}
+
+
+//*************************************************************************************************************
+
+QFunctionPointer resolve(QLibrary& library, const char* pName)
+{
+    //Fortran symbols carry a trailing underscore with most compilers, MKL exports both
+    QFunctionPointer pFunc = library.resolve((QByteArray(pName) + "_").constData());
+    return pFunc ? pFunc : library.resolve(pName);
+}
+
+
+//*************************************************************************************************************
+
+bool useLibrary(qint64 iSize)
+{
+    LinAlgRegistry& registry = linAlgRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    return registry.backend == LinAlg::BlasBackend && iSize >= registry.iMinimumSize;
+}
+
+
+//=============================================================================================================
+/**
+* Applies the configuration of MNE_LINALG when the library is loaded.
+*/
+struct LinAlgAutoConfig {
+    LinAlgAutoConfig()
+    {
+        QString sConfig = QString::fromLocal8Bit(qgetenv("MNE_LINALG"));
+
+        if(!sConfig.isEmpty() && !LinAlg::configure(sConfig)) {
+            fprintf(stderr, "LinAlg: Ignoring MNE_LINALG.\n");
+        }
+    }
+};
+
+LinAlgAutoConfig s_linAlgAutoConfig;
+
+} // anonymous namespace
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+QString LinAlg::linkedLibrary()
+{
+#if defined(MNE_LINALG_MKL)
+    return QString("MKL");
+#elif defined(MNE_LINALG_OPENBLAS)
+    return QString("OpenBLAS");
+#else
+    return QString("Eigen");
+#endif
+}
+
+
+//*************************************************************************************************************
+
+bool LinAlg::loadLibrary(const QString& sLibrary)
+{
+    QStringList lCandidates;
+    if(sLibrary.isEmpty()) {
+        lCandidates << "mkl_rt" << "openblas" << "blas";
+    } else {
+        lCandidates << sLibrary;
+    }
+
+    for(int i = 0; i < lCandidates.size(); ++i) {
+        QSharedPointer<QLibrary> pLibrary(new QLibrary(lCandidates.at(i)));
+        if(!pLibrary->load()) {
+#ifdef Q_OS_UNIX
+            //Distributions often ship only the versioned runtime library, e.g. libopenblas.so.0
+            pLibrary->setFileNameAndVersion(lCandidates.at(i), 0);
+            if(!pLibrary->load()) {
+                continue;
+            }
+#else
+            continue;
+#endif
+        }
+
+        SgemmFunc sgemm = reinterpret_cast<SgemmFunc>(resolve(*pLibrary, "sgemm"));
+        DgemmFunc dgemm = reinterpret_cast<DgemmFunc>(resolve(*pLibrary, "dgemm"));
+        if(!sgemm || !dgemm) {
+            continue;
+        }
+
+        SetThreadsFunc setThreads = reinterpret_cast<SetThreadsFunc>(pLibrary->resolve("MKL_Set_Num_Threads"));
+        if(!setThreads) {
+            setThreads = reinterpret_cast<SetThreadsFunc>(pLibrary->resolve("openblas_set_num_threads"));
+        }
+
+        LinAlgRegistry& registry = linAlgRegistry();
+        QMutexLocker locker(&registry.mutex);
+
+        //The previous library stays loaded, products may still run on it in other threads
+        registry.pLibrary = pLibrary;
+        registry.sgemm = sgemm;
+        registry.dgemm = dgemm;
+        registry.setThreads = setThreads;
+        registry.backend = BlasBackend;
+
+        return true;
+    }
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+QString LinAlg::loadedLibrary()
+{
+    LinAlgRegistry& registry = linAlgRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    return registry.pLibrary ? registry.pLibrary->fileName() : QString();
+}
+
+
+//*************************************************************************************************************
+
+bool LinAlg::setBackend(Backend backend)
+{
+    LinAlgRegistry& registry = linAlgRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    if(backend == BlasBackend && !registry.pLibrary) {
+        return false;
+    }
+
+    registry.backend = backend;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+LinAlg::Backend LinAlg::backend()
+{
+    LinAlgRegistry& registry = linAlgRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    return registry.backend;
+}
+
+
+//*************************************************************************************************************
+
+bool LinAlg::setThreads(int iThreads)
+{
+    LinAlgRegistry& registry = linAlgRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    if(!registry.setThreads || iThreads < 1) {
+        return false;
+    }
+
+    registry.setThreads(iThreads);
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void LinAlg::setMinimumSize(qint64 iSize)
+{
+    LinAlgRegistry& registry = linAlgRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    registry.iMinimumSize = qMax(qint64(0), iSize);
+}
+
+
+//*************************************************************************************************************
+
+qint64 LinAlg::minimumSize()
+{
+    LinAlgRegistry& registry = linAlgRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    return registry.iMinimumSize;
+}
+
+
+//*************************************************************************************************************
+
+void LinAlg::multiply(const float* m1, const float* m2, float* result, int d1, int d2, int d3)
+{
+    if(useLibrary(qint64(d1) * d2 * d3)) {
+        SgemmFunc sgemm = linAlgRegistry().sgemm;
+        const float fOne = 1.0f;
+        const float fZero = 0.0f;
+
+        //The row major product is the column major product of the transposes, result^T = m2^T * m1^T
+        sgemm("N", "N", &d3, &d1, &d2, &fOne, m2, &d3, m1, &d2, &fZero, result, &d3);
+        return;
+    }
+
+    Map<MatrixRowMajorXf>(result, d1, d3).noalias() = Map<const MatrixRowMajorXf>(m1, d1, d2) * Map<const MatrixRowMajorXf>(m2, d2, d3);
+}
+
+
+//*************************************************************************************************************
+
+void LinAlg::multiply(const double* m1, const double* m2, double* result, int d1, int d2, int d3)
+{
+    if(useLibrary(qint64(d1) * d2 * d3)) {
+        DgemmFunc dgemm = linAlgRegistry().dgemm;
+        const double dOne = 1.0;
+        const double dZero = 0.0;
+
+        dgemm("N", "N", &d3, &d1, &d2, &dOne, m2, &d3, m1, &d2, &dZero, result, &d3);
+        return;
+    }
+
+    Map<MatrixRowMajorXd>(result, d1, d3).noalias() = Map<const MatrixRowMajorXd>(m1, d1, d2) * Map<const MatrixRowMajorXd>(m2, d2, d3);
+}
+
+
+//*************************************************************************************************************
+
+void LinAlg::multiply(const MatrixXd& matA, const MatrixXd& matB, MatrixXd& matResult, bool bTransposeA)
+{
+    int iRows = int(bTransposeA ? matA.cols() : matA.rows());
+    int iInner = int(bTransposeA ? matA.rows() : matA.cols());
+    int iCols = int(matB.cols());
+
+    if(iInner != matB.rows()) {
+        printf("LinAlg::multiply - The dimensions of the operands do not match.\n");
+        return;
+    }
+
+    if(!useLibrary(qint64(iRows) * iInner * iCols)) {
+        if(bTransposeA) {
+            matResult.noalias() = matA.transpose() * matB;
+        } else {
+            matResult.noalias() = matA * matB;
+        }
+        return;
+    }
+
+    matResult.resize(iRows, iCols);
+
+    DgemmFunc dgemm = linAlgRegistry().dgemm;
+    const double dOne = 1.0;
+    const double dZero = 0.0;
+    int iLda = int(matA.rows());
+    int iLdb = int(matB.rows());
+
+    dgemm(bTransposeA ? "T" : "N", "N", &iRows, &iCols, &iInner, &dOne, matA.data(), &iLda, matB.data(), &iLdb, &dZero, matResult.data(), &iRows);
+}
+
+
+//*************************************************************************************************************
+
+bool LinAlg::configure(const QString& sConfig)
+{
+    QString sValue = sConfig.trimmed();
+
+    if(sValue.compare("eigen", Qt::CaseInsensitive) == 0) {
+        return setBackend(EigenBackend);
+    }
+
+    if(sValue.compare("blas", Qt::CaseInsensitive) == 0) {
+        return loadLibrary();
+    }
+
+    if(sValue.startsWith("blas:", Qt::CaseInsensitive) && sValue.size() > 5) {
+        return loadLibrary(sValue.mid(5));
+    }
+
+    return false;
+}
+
+
+//*************************************************************************************************************
+
+QString LinAlg::toString()
+{
+    LinAlgRegistry& registry = linAlgRegistry();
+    QMutexLocker locker(&registry.mutex);
+
+    if(registry.backend == BlasBackend && registry.pLibrary) {
+        return QString("blas:%1").arg(registry.pLibrary->fileName());
+    }
+
+    return QString("eigen (%1)").arg(linkedLibrary());
+}
@@ -0,0 +1,227 @@
+//=============================================================================================================
+/**
+* @file     linalg.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the LinAlg class.
+*
+*/
+#ifndef LINALG_H
+#define LINALG_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+* Selects the BLAS the hand-written dense products run on, e.g. the float** products of the ported MNE C code.
+* The Eigen products and decompositions themselves are bound to a vendor library at compile time: with
+* qmake MNECPP_CONFIG+=withMkl Eigen uses MKL for its products, LLT, LU, QR, SVD and eigen solvers, with
+* MNECPP_CONFIG+=withOpenBlas it uses the BLAS and LAPACKE of OpenBLAS. linkedLibrary() tells which one.
+*
+* The products of this class have two backends:
+*
+*   - EigenBackend multiplies with Eigen, which is the vendor library in the builds above.
+*   - BlasBackend calls sgemm/dgemm of a BLAS library which is loaded at runtime with loadLibrary(), e.g. mkl_rt
+*     or openblas. Builds without a vendor library can use an optimized BLAS this way.
+*
+* Products with less than minimumSize() multiply-adds always use Eigen, for those the call overhead of the
+* library dominates. The backend is read from the environment variable MNE_LINALG when the library is loaded,
+* "eigen" selects EigenBackend, "blas" loads the first of the default libraries and "blas:<library>" a given one.
+*
+* @brief Runtime selection of the BLAS for the hand-written dense products.
+*/
+class UTILSSHARED_EXPORT LinAlg
+{
+public:
+    enum Backend {
+        EigenBackend,   /**< Eigen, which is bound to MKL or OpenBLAS in builds with withMkl or withOpenBlas. */
+        BlasBackend     /**< sgemm and dgemm of the library loaded with loadLibrary(). */
+    };
+
+    //=========================================================================================================
+    /**
+    * Returns the library Eigen is bound to at compile time.
+    *
+    * @return "MKL", "OpenBLAS" or "Eigen".
+    */
+    static QString linkedLibrary();
+
+    //=========================================================================================================
+    /**
+    * Loads a BLAS library and selects BlasBackend. A library which was loaded before is kept if the new one can
+    * not be loaded.
+    *
+    * @param[in] sLibrary   The file name or path of the library, an empty name tries mkl_rt, openblas and blas.
+    *
+    * @return true if the library provides sgemm and dgemm, false otherwise.
+    */
+    static bool loadLibrary(const QString& sLibrary = QString());
+
+    //=========================================================================================================
+    /**
+    * Returns the file name of the library loaded with loadLibrary().
+    *
+    * @return the file name, empty if no library was loaded.
+    */
+    static QString loadedLibrary();
+
+    //=========================================================================================================
+    /**
+    * Selects the backend of the products.
+    *
+    * @param[in] backend    The backend.
+    *
+    * @return false if BlasBackend was requested but no library is loaded, true otherwise.
+    */
+    static bool setBackend(Backend backend);
+
+    //=========================================================================================================
+    /**
+    * Returns the backend of the products.
+    *
+    * @return the backend.
+    */
+    static Backend backend();
+
+    //=========================================================================================================
+    /**
+    * Sets the number of threads of the loaded library, if it offers a way to set them (MKL and OpenBLAS do).
+    * Processing which already runs in parallel on the pools of ExecutionConfig should use 1.
+    *
+    * @param[in] iThreads   The number of threads.
+    *
+    * @return true if the threads were set, false otherwise.
+    */
+    static bool setThreads(int iThreads);
+
+    //=========================================================================================================
+    /**
+    * Sets the number of multiply-adds from which on the products use the loaded library.
+    *
+    * @param[in] iSize      The number of multiply-adds, d1*d2*d3 of the product.
+    */
+    static void setMinimumSize(qint64 iSize);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of multiply-adds from which on the products use the loaded library.
+    *
+    * @return the number of multiply-adds, 32768 by default.
+    */
+    static qint64 minimumSize();
+
+    //=========================================================================================================
+    /**
+    * Multiplies two dense row major matrices, result(d1 x d3) = m1(d1 x d2) * m2(d2 x d3).
+    *
+    * @param[in] m1         The first matrix, d1 x d2 contiguous floats.
+    * @param[in] m2         The second matrix, d2 x d3 contiguous floats.
+    * @param[out] result    The result, d1 x d3 contiguous floats. It must not overlap the operands.
+    * @param[in] d1         The rows of m1.
+    * @param[in] d2         The columns of m1 and the rows of m2.
+    * @param[in] d3         The columns of m2.
+    */
+    static void multiply(const float* m1, const float* m2, float* result, int d1, int d2, int d3);
+
+    //=========================================================================================================
+    /**
+    * Multiplies two dense row major matrices, result(d1 x d3) = m1(d1 x d2) * m2(d2 x d3).
+    *
+    * @param[in] m1         The first matrix, d1 x d2 contiguous doubles.
+    * @param[in] m2         The second matrix, d2 x d3 contiguous doubles.
+    * @param[out] result    The result, d1 x d3 contiguous doubles. It must not overlap the operands.
+    * @param[in] d1         The rows of m1.
+    * @param[in] d2         The columns of m1 and the rows of m2.
+    * @param[in] d3         The columns of m2.
+    */
+    static void multiply(const double* m1, const double* m2, double* result, int d1, int d2, int d3);
+
+    //=========================================================================================================
+    /**
+    * Multiplies two matrices, matResult = (bTransposeA ? matA^T : matA) * matB.
+    *
+    * @param[in] matA           The first matrix.
+    * @param[in] matB           The second matrix.
+    * @param[out] matResult     The result. It must not be one of the operands.
+    * @param[in] bTransposeA    Whether matA is used transposed.
+    */
+    static void multiply(const Eigen::MatrixXd& matA, const Eigen::MatrixXd& matB, Eigen::MatrixXd& matResult, bool bTransposeA = false);
+
+    //=========================================================================================================
+    /**
+    * Configures the backend from a value of MNE_LINALG, see the class description.
+    *
+    * @param[in] sConfig    The configuration.
+    *
+    * @return true if the configuration could be applied, false otherwise.
+    */
+    static bool configure(const QString& sConfig);
+
+    //=========================================================================================================
+    /**
+    * Returns the current configuration, e.g. "eigen (OpenBLAS)" or "blas:libmkl_rt.so".
+    *
+    * @return the configuration.
+    */
+    static QString toString();
+};
+
+} // NAMESPACE UTILSLIB
+
+#endif // LINALG_H
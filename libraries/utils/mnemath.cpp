@@ -49,6 +49,7 @@
 #include <iostream>
 #include <algorithm>    // std::sort
 #include <vector>       // std::vector
+#include <random>
 
 //DEBUG fstream
 //#include <fstream>
@@ -86,24 +87,52 @@ using namespace UTILSLIB;
 //=============================================================================================================
 
 VectorXd* MNEMath::combine_xyz(const VectorXd& vec)
+{
+    VectorXd* comb = new VectorXd;
+
+    if(!combine_xyz(vec, *comb))
+    {
+        delete comb;
+        return NULL;
+    }
+
+    return comb;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEMath::combine_xyz(const VectorXd& vec, VectorXd& comb)
 {
     if (vec.size() % 3 != 0)
     {
         printf("Input must be a row or a column vector with 3N components");
-        return NULL;
+        return false;
     }
 
-    MatrixXd tmp = MatrixXd(vec.transpose());
-    SparseMatrix<double>* s = make_block_diag(tmp,3);
+    comb = Map<const Matrix<double, 3, Dynamic> >(vec.data(), 3, vec.size()/3).colwise().squaredNorm().transpose();
+
+    return true;
+}
 
-    SparseMatrix<double> sC = *s*s->transpose();
-    VectorXd* comb = new VectorXd(sC.rows());
 
-    for(qint32 i = 0; i < sC.rows(); ++i)
-        (*comb)[i] = sC.coeff(i,i);
+//*************************************************************************************************************
 
-    delete s;
-    return comb;
+bool MNEMath::combine_xyz(const MatrixXd& mat, MatrixXd& comb)
+{
+    if (mat.rows() % 3 != 0)
+    {
+        printf("Input must be a matrix with 3N rows");
+        return false;
+    }
+
+    const qint32 n = mat.rows()/3;
+    comb.resize(n, mat.cols());
+
+    for(qint32 i = 0; i < mat.cols(); ++i)
+        comb.col(i) = Map<const Matrix<double, 3, Dynamic> >(mat.col(i).data(), 3, n).colwise().squaredNorm().transpose();
+
+    return true;
 }
 
 
@@ -111,7 +140,7 @@ VectorXd* MNEMath::combine_xyz(const VectorXd& vec)
 
 double MNEMath::getConditionNumber(const MatrixXd& A, VectorXd &s)
 {
-    JacobiSVD<MatrixXd> svd(A);
+    BDCSVD<MatrixXd> svd(A);
     s = svd.singularValues();
 
     double c = s.maxCoeff()/s.minCoeff();
@@ -124,7 +153,7 @@ double MNEMath::getConditionNumber(const MatrixXd& A, VectorXd &s)
 
 double MNEMath::getConditionSlope(const MatrixXd& A, VectorXd &s)
 {
-    JacobiSVD<MatrixXd> svd(A);
+    BDCSVD<MatrixXd> svd(A);
     s = svd.singularValues();
 
     double c = s.maxCoeff()/s.mean();
@@ -144,7 +173,12 @@ void MNEMath::get_whitener(MatrixXd &A, bool pca, QString ch_type, VectorXd &eig
     eigvec = t_eigenSolver.eigenvectors().transpose();
 
     MNEMath::sort<double>(eig, eigvec, false);
-    qint32 rnk = MNEMath::rank(A);
+
+    //The singular values of a self-adjoint matrix are its absolute eigenvalues, no need for another SVD
+    qint32 rnk = 0;
+    double t_dMax = eig.cwiseAbs().maxCoeff() * 1e-8;
+    for(qint32 i = 0; i < eig.size(); ++i)
+        rnk += std::fabs(eig[i]) > t_dMax ? 1 : 0;
 
     for(qint32 i = 0; i < eig.size()-rnk; ++i)
         eig(i) = 0;
@@ -339,6 +373,95 @@ SparseMatrix<double>* MNEMath::make_block_diag(const MatrixXd &A, qint32 n)
 }
 
 
+//*************************************************************************************************************
+
+bool MNEMath::make_block_diag(const MatrixXd &A, qint32 n, SparseMatrix<double>& bd)
+{
+    const qint32 ma = A.rows();
+    const qint32 na = A.cols();
+
+    if(n <= 0 || na % n != 0)
+    {
+        printf("Width of matrix must be even multiple of n\n");
+        return false;
+    }
+
+    //Column j of the block diagonal holds column j of A in the rows of block j/n, the compressed column storage is
+    //written directly. resize keeps the allocated value and index arrays of a matrix of the same size.
+    bd.resize((na/n)*ma, na);
+    bd.resizeNonZeros(ma*na);
+
+    int* t_pOuter = bd.outerIndexPtr();
+    int* t_pInner = bd.innerIndexPtr();
+    double* t_pValues = bd.valuePtr();
+
+    for(qint32 j = 0; j < na; ++j)
+    {
+        const qint32 t_iRowOffset = (j/n)*ma;
+        t_pOuter[j] = j*ma;
+        for(qint32 r = 0; r < ma; ++r)
+        {
+            t_pInner[j*ma + r] = t_iRowOffset + r;
+            t_pValues[j*ma + r] = A(r, j);
+        }
+    }
+    t_pOuter[na] = ma*na;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEMath::multiply_block_diag(const MatrixXd &A, const MatrixXd &B, qint32 n, MatrixXd &C)
+{
+    const qint32 ma = B.rows();
+    const qint32 na = B.cols();
+
+    if(n <= 0 || na % n != 0 || A.cols() != (na/n)*ma)
+    {
+        printf("Width of matrix must be even multiple of n and match the block diagonal\n");
+        return false;
+    }
+
+    const qint32 bdn = na/n;
+
+    //Square blocks can overwrite their own columns, otherwise an aliased output needs a copy of A
+    if(&A == &C && ma != n)
+    {
+        MatrixXd t_matA = A;
+        return multiply_block_diag(t_matA, B, n, C);
+    }
+
+    if(&A != &C)
+        C.resize(A.rows(), na);
+
+    if(ma == 3 && n == 3)
+    {
+        for(qint32 i = 0; i < bdn; ++i)
+        {
+            const Matrix3d t_matBlock = B.block<3,3>(0, 3*i);
+            C.middleCols<3>(3*i) = A.middleCols<3>(3*i) * t_matBlock;
+        }
+    }
+    else if(ma == 3 && n == 1)
+    {
+        for(qint32 i = 0; i < bdn; ++i)
+        {
+            const Vector3d t_vecBlock = B.col(i);
+            C.col(i).noalias() = A.middleCols<3>(3*i) * t_vecBlock;
+        }
+    }
+    else
+    {
+        for(qint32 i = 0; i < bdn; ++i)
+            C.middleCols(i*n, n) = A.middleCols(i*ma, ma) * B.middleCols(i*n, n);
+    }
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 int MNEMath::nchoose2(int n)
@@ -352,11 +475,79 @@ int MNEMath::nchoose2(int n)
 }
 
 
+//*************************************************************************************************************
+
+qint32 MNEMath::randomizedSvd(const MatrixXd& A, qint32 iRank, MatrixXd& U, VectorXd& s, MatrixXd& V, double dTol, qint32 iOversampling, qint32 iPowerIterations)
+{
+    const qint32 t_iMinDim = std::min(A.rows(), A.cols());
+    iRank = std::max(0, std::min(iRank, t_iMinDim));
+    const qint32 t_iSketch = std::min(iRank + std::max(0, iOversampling), t_iMinDim);
+
+    if(iRank == 0 || A.size() == 0)
+    {
+        U.resize(A.rows(), 0);
+        s.resize(0);
+        V.resize(A.cols(), 0);
+        return 0;
+    }
+
+    if(t_iSketch >= t_iMinDim)
+    {
+        BDCSVD<MatrixXd> t_svd(A, ComputeThinU | ComputeThinV);
+        U = t_svd.matrixU().leftCols(iRank);
+        s = t_svd.singularValues().head(iRank);
+        V = t_svd.matrixV().leftCols(iRank);
+    }
+    else
+    {
+        //Fixed seed, results are reproducible from call to call
+        std::mt19937 t_generator(42);
+        std::normal_distribution<double> t_normal(0.0, 1.0);
+        MatrixXd t_matOmega(A.cols(), t_iSketch);
+        for(qint32 j = 0; j < t_matOmega.cols(); ++j)
+            for(qint32 i = 0; i < t_matOmega.rows(); ++i)
+                t_matOmega(i,j) = t_normal(t_generator);
+
+        //Range finder, every product is re-orthonormalized to keep the small singular values from vanishing
+        MatrixXd t_matQ = HouseholderQR<MatrixXd>(A * t_matOmega).householderQ() * MatrixXd::Identity(A.rows(), t_iSketch);
+        for(qint32 i = 0; i < iPowerIterations; ++i)
+        {
+            MatrixXd t_matZ = HouseholderQR<MatrixXd>(A.transpose() * t_matQ).householderQ() * MatrixXd::Identity(A.cols(), t_iSketch);
+            t_matQ = HouseholderQR<MatrixXd>(A * t_matZ).householderQ() * MatrixXd::Identity(A.rows(), t_iSketch);
+        }
+
+        //SVD of the small projected matrix B = Q^T A
+        MatrixXd t_matB = t_matQ.transpose() * A;
+        BDCSVD<MatrixXd> t_svd(t_matB, ComputeThinU | ComputeThinV);
+        U = t_matQ * t_svd.matrixU().leftCols(iRank);
+        s = t_svd.singularValues().head(iRank);
+        V = t_svd.matrixV().leftCols(iRank);
+    }
+
+    qint32 k = iRank;
+    if(dTol > 0.0)
+    {
+        const double t_dMin = s[0] * dTol;
+        while(k > 0 && s[k-1] <= t_dMin)
+            --k;
+    }
+
+    if(k < iRank)
+    {
+        U.conservativeResize(NoChange, k);
+        s.conservativeResize(k);
+        V.conservativeResize(NoChange, k);
+    }
+
+    return k;
+}
+
+
 //*************************************************************************************************************
 
 qint32 MNEMath::rank(const MatrixXd& A, double tol)
 {
-    JacobiSVD<MatrixXd> t_svdA(A);//U and V are not computed
+    BDCSVD<MatrixXd> t_svdA(A);//U and V are not computed
     VectorXd s = t_svdA.singularValues();
     double t_dMax = s.maxCoeff();
     t_dMax *= tol;
@@ -367,6 +558,33 @@ qint32 MNEMath::rank(const MatrixXd& A, double tol)
 }
 
 
+//*************************************************************************************************************
+
+qint32 MNEMath::rankSelfAdjoint(const MatrixXd& A, double tol)
+{
+    SelfAdjointEigenSolver<MatrixXd> t_eigenSolver(A, EigenvaluesOnly);
+    VectorXd s = t_eigenSolver.eigenvalues().cwiseAbs();
+    double t_dMax = s.maxCoeff();
+    t_dMax *= tol;
+    qint32 sum = 0;
+    for(qint32 i = 0; i < s.size(); ++i)
+        sum += s[i] > t_dMax ? 1 : 0;
+    return sum;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd MNEMath::pinvTruncated(const MatrixXd& A, qint32 iRank, double dTol)
+{
+    MatrixXd U, V;
+    VectorXd s;
+    randomizedSvd(A, iRank, U, s, V, dTol);
+
+    return V * s.cwiseInverse().asDiagonal() * U.transpose();
+}
+
+
 //*************************************************************************************************************
 
 MatrixXd MNEMath::rescale(const MatrixXd &data, const RowVectorXf &times, QPair<QVariant,QVariant> baseline, QString mode)
@@ -383,42 +601,16 @@ MatrixXd MNEMath::rescale(const MatrixXd &data, const RowVectorXf &times, QPair<
 
     qint32 imin = 0;
     qint32 imax = times.size();
+    baselineRange(times, baseline, imin, imax);
 
-    if(!baseline.first.isValid())
-        imin = 0;
-    else
-    {
-        float bmin = baseline.first.toFloat();
-        for(qint32 i = 0; i < times.size(); ++i)
-        {
-            if(times[i] >= bmin)
-            {
-                imin = i;
-                break;
-            }
-        }
-    }
-    if (!baseline.second.isValid())
-        imax = times.size();
-    else
+    if(mode.compare("mean") == 0)
     {
-        float bmax = baseline.second.toFloat();
-        for(qint32 i = times.size()-1; i >= 0; --i)
-        {
-            if(times[i] <= bmax)
-            {
-                imax = i+1;
-                break;
-            }
-        }
+        rescaleMean(data_out, imin, imax);
+        return data_out;
     }
 
     VectorXd mean = data_out.block(0, imin,data_out.rows(),imax-imin).rowwise().mean();
-    if(mode.compare("mean") == 0)
-    {
-        data_out -= mean.rowwise().replicate(data.cols());
-    }
-    else if(mode.compare("logratio") == 0)
+    if(mode.compare("logratio") == 0)
     {
         for(qint32 i = 0; i < data_out.rows(); ++i)
             for(qint32 j = 0; j < data_out.cols(); ++j)
@@ -448,4 +640,42 @@ MatrixXd MNEMath::rescale(const MatrixXd &data, const RowVectorXf &times, QPair<
     return data_out;
 }
 
+
+//*************************************************************************************************************
+
+void MNEMath::baselineRange(const RowVectorXf &times, const QPair<QVariant,QVariant> &baseline, qint32 &iFirst, qint32 &iLast)
+{
+    iFirst = 0;
+    iLast = times.size();
+
+    if(!baseline.first.isValid())
+        iFirst = 0;
+    else
+    {
+        float bmin = baseline.first.toFloat();
+        for(qint32 i = 0; i < times.size(); ++i)
+        {
+            if(times[i] >= bmin)
+            {
+                iFirst = i;
+                break;
+            }
+        }
+    }
+    if (!baseline.second.isValid())
+        iLast = times.size();
+    else
+    {
+        float bmax = baseline.second.toFloat();
+        for(qint32 i = times.size()-1; i >= 0; --i)
+        {
+            if(times[i] <= bmax)
+            {
+                iLast = i+1;
+                break;
+            }
+        }
+    }
+}
+
 //*************************************************************************************************************
@@ -55,6 +55,7 @@
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
 #include <Eigen/SVD>
+#include <Eigen/Eigenvalues>
 
 
 //*************************************************************************************************************
@@ -123,6 +124,34 @@ public:
     */
     static VectorXd* combine_xyz(const VectorXd& vec);
 
+    //=========================================================================================================
+    /**
+    * mne_combine_xyz
+    *
+    * Compute the three Cartesian components of a vector together, the result is written to comb which keeps its
+    * storage when it already has the right size.
+    *
+    * @param[in] vec    Input vector [ x1 y1 z1 ... x_n y_n z_n ]
+    * @param[out] comb  Output vector [x1^2+y1^2+z1^2 ... x_n^2+y_n^2+z_n^2 ]
+    *
+    * @return true if succeeded, false if the size of vec is no multiple of 3
+    */
+    static bool combine_xyz(const VectorXd& vec, VectorXd& comb);
+
+    //=========================================================================================================
+    /**
+    * mne_combine_xyz
+    *
+    * Compute the three Cartesian components of every column of a matrix together, e.g. of a free orientation
+    * source estimate.
+    *
+    * @param[in] mat    Input matrix, each column is [ x1 y1 z1 ... x_n y_n z_n ]^T
+    * @param[out] comb  Output matrix (rows(mat)/3 x cols(mat)), each column is [x1^2+y1^2+z1^2 ... x_n^2+y_n^2+z_n^2 ]^T
+    *
+    * @return true if succeeded, false if the number of rows of mat is no multiple of 3
+    */
+    static bool combine_xyz(const MatrixXd& mat, MatrixXd& comb);
+
 //    //=========================================================================================================
 //    /**
 //    * ### MNE toolbox root function ###: Definition of the mne_block_diag function - decoding part
@@ -215,6 +244,36 @@ public:
     */
     static SparseMatrix<double>* make_block_diag(const MatrixXd &A, qint32 n);
 
+    //=========================================================================================================
+    /**
+    * mne_block_diag
+    *
+    * Make a sparse block diagonal matrix from the elements in "A", see make_block_diag above. The compressed
+    * storage is filled directly, a bd of a previous call keeps its allocated memory.
+    *
+    * @param[in] A      Matrix which should be diagonlized
+    * @param[in] n      Columns of the submatrices
+    * @param[out] bd    The sparse block diagonal matrix.
+    *
+    * @return true if succeeded, false if the width of A is no multiple of n
+    */
+    static bool make_block_diag(const MatrixXd &A, qint32 n, SparseMatrix<double>& bd);
+
+    //=========================================================================================================
+    /**
+    * Multiplies a matrix with the block diagonal matrix of "B" without building it: C = A * make_block_diag(B, n).
+    * Every ma x n submatrix of B is applied to its ma columns of A as a dense block, with fixed size products for
+    * the 3 x 3 and 3 x 1 blocks of the orientation priors. C may be the same object as A.
+    *
+    * @param[in] A      Matrix with (cols(B)/n)*rows(B) columns
+    * @param[in] B      Matrix comprising cols(B)/n submatrices of size rows(B) x n
+    * @param[in] n      Columns of the submatrices
+    * @param[out] C     The product (rows(A) x cols(B)).
+    *
+    * @return true if succeeded, false if the dimensions do not match
+    */
+    static bool multiply_block_diag(const MatrixXd &A, const MatrixXd &B, qint32 n, MatrixXd &C);
+
     //=========================================================================================================
     /**
     * Calculates the combination of n over 2 (nchoosek(n,2))
@@ -224,6 +283,26 @@ public:
     */
     static int nchoose2(int n);
 
+    //=========================================================================================================
+    /**
+    * Computes a truncated singular value decomposition A ~ U * diag(s) * V^T with a randomized range finder
+    * (Halko et al., 2011). A gaussian sketch of iRank + iOversampling columns is sharpened by iPowerIterations
+    * re-orthonormalized power iterations before the small projected problem is solved with a BDCSVD. Falls back
+    * to a full BDCSVD when the sketch is not smaller than the matrix.
+    *
+    * @param[in] A                  Matrix to decompose.
+    * @param[in] iRank              Target rank.
+    * @param[out] U                 Left singular vectors (rows(A) x k).
+    * @param[out] s                 Singular values in descending order (k).
+    * @param[out] V                 Right singular vectors (cols(A) x k).
+    * @param[in] dTol               Relative threshold, singular values below dTol times the largest one are dropped.
+    * @param[in] iOversampling      Number of additional sketch columns.
+    * @param[in] iPowerIterations   Number of power iterations.
+    *
+    * @return the number k of returned singular triplets.
+    */
+    static qint32 randomizedSvd(const MatrixXd& A, qint32 iRank, MatrixXd& U, VectorXd& s, MatrixXd& V, double dTol = 0.0, qint32 iOversampling = 10, qint32 iPowerIterations = 2);
+
     //=========================================================================================================
     /**
     * ToDo make this a template function
@@ -237,6 +316,18 @@ public:
     */
     static qint32 rank(const MatrixXd& A, double tol = 1e-8);
 
+    //=========================================================================================================
+    /**
+    * Returns the rank of a self-adjoint matrix A, e.g. a covariance matrix. The singular values are the absolute
+    * eigenvalues, which are much cheaper to compute than a SVD.
+    *
+    * @param[in] A      Self-adjoint matrix to get the rank from
+    * @param[in] tol    realtive threshold: biggest singualr value multiplied with tol is smallest singular value considered non-zero
+    *
+    * @return rank of matrix A
+    */
+    static qint32 rankSelfAdjoint(const MatrixXd& A, double tol = 1e-8);
+
     //=========================================================================================================
     /**
     * ToDo: Maybe new processing class
@@ -257,6 +348,31 @@ public:
     */
     static MatrixXd rescale(const MatrixXd &data, const RowVectorXf &times, QPair<QVariant,QVariant> baseline, QString mode);
 
+    //=========================================================================================================
+    /**
+    * Determines the sample range of a baseline interval
+    *
+    * @param[in] times          Time instants is seconds.
+    * @param[in] baseline       Baseline interval, see rescale.
+    * @param[out] iFirst        First sample of the baseline.
+    * @param[out] iLast         One past the last sample of the baseline.
+    */
+    static void baselineRange(const RowVectorXf &times, const QPair<QVariant,QVariant> &baseline, qint32 &iFirst, qint32 &iLast);
+
+    //=========================================================================================================
+    /**
+    * Subtracts the mean over the baseline samples from each row in place, without temporary copies of the data.
+    * A baseline without samples leaves the data unchanged.
+    *
+    * @param[in, out] data      Data with one channel per row and one sample per column, e.g. a mapped C matrix.
+    * @param[in] iFirst         First sample of the baseline.
+    * @param[in] iLast          One past the last sample of the baseline.
+    *
+    * @return the subtracted mean of each row.
+    */
+    template<typename Derived>
+    static Matrix<typename Derived::Scalar, Dynamic, 1> rescaleMean(MatrixBase<Derived> &data, qint32 iFirst, qint32 iLast);
+
     //=========================================================================================================
     /**
     * Sorts a vector (ascending order) in place and returns the track of the original indeces
@@ -381,6 +497,29 @@ public:
     */
     template<typename T>
     static Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> pinv(const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>& a);
+
+    //=========================================================================================================
+    /**
+    * Creates the pseudo inverse of a self-adjoint matrix, e.g. a covariance or gram matrix, from its
+    * eigendecomposition.
+    *
+    * @param[in]  a        self-adjoint matrix.
+    */
+    template<typename T>
+    static Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> pinvSelfAdjoint(const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>& a);
+
+    //=========================================================================================================
+    /**
+    * Creates a truncated pseudo inverse of a matrix from its randomized SVD. Only the leading iRank singular
+    * values above dTol times the largest one are inverted.
+    *
+    * @param[in] A          Matrix to invert.
+    * @param[in] iRank      Target rank.
+    * @param[in] dTol       Relative threshold of the inverted singular values.
+    *
+    * @return the truncated pseudo inverse (cols(A) x rows(A)).
+    */
+    static MatrixXd pinvTruncated(const MatrixXd& A, qint32 iRank, double dTol = 1e-8);
 };
 
 //*************************************************************************************************************
@@ -388,6 +527,27 @@ public:
 // INLINE & TEMPLATE DEFINITIONS
 //=============================================================================================================
 
+template<typename Derived>
+Matrix<typename Derived::Scalar, Dynamic, 1> MNEMath::rescaleMean(MatrixBase<Derived> &data, qint32 iFirst, qint32 iLast)
+{
+    typedef typename Derived::Scalar Scalar;
+
+    if(iFirst < 0)
+        iFirst = 0;
+    if(iLast > data.cols())
+        iLast = data.cols();
+    if(iLast <= iFirst)
+        return Matrix<Scalar, Dynamic, 1>::Zero(data.rows());
+
+    Matrix<Scalar, Dynamic, 1> mean = data.middleCols(iFirst, iLast-iFirst).rowwise().sum() / Scalar(iLast-iFirst);
+    data.colwise() -= mean;
+
+    return mean;
+}
+
+
+//*************************************************************************************************************
+
 template< typename T>
 VectorXi MNEMath::sort(Matrix<T, Dynamic, 1> &v, bool desc)
 {
@@ -630,12 +790,25 @@ void MNEMath::histcounts(const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>&
 template<typename T>
 Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> MNEMath::pinv(const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>& a)
 {
-    double epsilon = std::numeric_limits<double>::epsilon();
-    Eigen::JacobiSVD< Eigen::MatrixXd > svd(a ,Eigen::ComputeThinU | Eigen::ComputeThinV);
+    //BDCSVD switches to a JacobiSVD for small matrices itself
+    double epsilon = std::numeric_limits<T>::epsilon();
+    Eigen::BDCSVD< Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> > svd(a ,Eigen::ComputeThinU | Eigen::ComputeThinV);
     double tolerance = epsilon * std::max(a.cols(), a.rows()) * svd.singularValues().array().abs()(0);
     return svd.matrixV() * (svd.singularValues().array().abs() > tolerance).select(svd.singularValues().array().inverse(),0).matrix().asDiagonal() * svd.matrixU().adjoint();
 }
 
+
+//*************************************************************************************************************
+
+template<typename T>
+Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> MNEMath::pinvSelfAdjoint(const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>& a)
+{
+    double epsilon = std::numeric_limits<T>::epsilon();
+    Eigen::SelfAdjointEigenSolver< Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> > eig(a);
+    double tolerance = epsilon * a.rows() * eig.eigenvalues().array().abs().maxCoeff();
+    return eig.eigenvectors() * (eig.eigenvalues().array().abs() > tolerance).select(eig.eigenvalues().array().inverse(),0).matrix().asDiagonal() * eig.eigenvectors().adjoint();
+}
+
 //*************************************************************************************************************
 
 } // NAMESPACE
@@ -129,6 +129,15 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
     }
     std::cout << "absolute energy of signal: " << residuum_energy << "\n";
 
+    //spectra of the residuum channels, updated with each subtracted atom
+    MatrixXcd residuum_spectra(sample_count, channel_count);
+    for(qint32 chn = 0; chn < channel_count; chn++)
+    {
+        VectorXcd residuum_spectrum;
+        fft.fwd(residuum_spectrum, VectorXcd(residuum.col(chn).cast<std::complex<double> >()));
+        residuum_spectra.col(chn) = residuum_spectrum;
+    }
+
     while(it < max_iterations && (energy_threshold < residuum_energy) && sample_count > 1)
     {
         channel_count = channel_count * (boost / 100.0); //reducing the number of observed channels in the algorithm to increase speed performance
@@ -146,56 +155,40 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
         gabor_Atom->energy = 0;
         qreal phase = 0;
 
+        //split the dyadic grid of scales and modulations into searches of similar size, large scales have many modulations
+        QList<ScaleSearch> scale_searches;
         while(s < sample_count)
         {
             k = 0;                               //for modulation 2*pi*k/N
-            p = floor(sample_count / 2);         //translation
-            VectorXd envelope = GaborAtom::gauss_function(sample_count, s, p);
-            VectorXcd fft_envelope = RowVectorXcd::Zero(sample_count);
-            fft.fwd(fft_envelope, envelope);
-
             while(k < sample_count/2)
             {
-                p = floor(sample_count/2);
-                VectorXcd modulation = modulation_function(sample_count, k);
-                VectorXcd modulated_resid = VectorXcd::Zero(sample_count);
-                VectorXcd fft_modulated_resid = VectorXcd::Zero(sample_count);
-                VectorXcd fft_m_e_resid = VectorXcd::Zero(sample_count);
-                VectorXd corr_coeffs = VectorXd::Zero(sample_count);
+                ScaleSearch search;
+                search.scale = s;
+                while(k < sample_count/2 && search.modulations.size() < 16)
+                {
+                    search.modulations.append(k);
+                    k += pow(2.0,(-j))*sample_count/2;
+                }
+                scale_searches.append(search);
+            }
+            j++;
+            s = pow(2.0,j);
+        }
 
+        QtConcurrent::blockingMap(scale_searches, [&residuum, &residuum_spectra, channel_count, fix_phase](ScaleSearch& search) {
+            search_scale(search, residuum, residuum_spectra, channel_count, fix_phase);
+        });
+
+        //compare the candidates in the order of the grid
+        for(qint32 i = 0; i < scale_searches.size(); i++)
+        {
+            qint32 candidate = 0;
+            for(qint32 m = 0; m < scale_searches[i].modulations.size(); m++)
+            {
                 //iteration for multichannel, depending on boost setting
                 for(qint32 chn = 0; chn < channel_count; chn++)
                 {
-                    qint32 max_index = 0;
-                    qreal maximum = 0;
-                    phase = 0;
-                    p = floor(sample_count/2);//here is difference to dr. gratkowski´s code (he didn´t reset parameter p)
-
-                    //complex correlation of signal and sinus-modulated gaussfunction
-                    for(qint32 l = 0; l< sample_count; l++)
-                        modulated_resid[l] = residuum(l, chn) * modulation[l];
-
-                    fft.fwd(fft_modulated_resid, modulated_resid);
-
-                    for( qint32 m = 0; m < sample_count; m++)
-                        fft_m_e_resid[m] = fft_modulated_resid[m] * conj(fft_envelope[m]);
-
-                    fft.inv(corr_coeffs, fft_m_e_resid);
-                    maximum = corr_coeffs[0];
-
-                    //find index of maximum correlation-coefficient to use in translation
-                    for(qint32 i = 1; i < corr_coeffs.rows(); i++)
-                        if(maximum < corr_coeffs[i])
-                        {
-                            maximum = corr_coeffs[i];
-                            max_index = i;
-                        }
-
-                    //adapting translation p to create atomtranslation correctly
-                    if(max_index >= p) p = max_index - p + 1;
-                    else p = max_index + p;
-
-                    VectorXd atom_parameters = calculate_atom(sample_count, s, p, k, chn, residuum, RETURNPARAMETERS, fix_phase);
+                    const VectorXd& atom_parameters = scale_searches[i].atom_parameters[candidate++];
                     qreal temp_scalar_product = 0;
                     if(trial_separation) temp_scalar_product = max_scalar_product[chn];
                     else temp_scalar_product = max_scalar_product[0];
@@ -223,13 +216,8 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
                             max_scalar_product[0]      = atom_parameters[4];
 
                     }
-
                 }
-                k += pow(2.0,(-j))*sample_count/2;
-
             }
-            j++;
-            s = pow(2.0,j);
         }
         std::cout << "\n" << "===============" << " found parameters " << it + 1 << "===============" << ":\n\n"<<
                      "scale: " << gabor_Atom->scale << " trans: " << gabor_Atom->translation <<
@@ -339,6 +327,12 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
                     gabor_Atom->energy += pow(gabor_Atom->max_scalar_product * best_match[j], 2);
                 }
             }
+
+            //the residuum spectrum loses the spectrum of the subtracted atom
+            qreal atom_scalar_product = trial_separation ? gabor_Atom->max_scalar_product : gabor_Atom->max_scalar_list.at(chn);
+            VectorXcd atom_spectrum;
+            fft.fwd(atom_spectrum, VectorXcd((atom_scalar_product * best_match).cast<std::complex<double> >()));
+            residuum_spectra.col(chn) -= atom_spectrum;
             if(trial_separation)
             {
                 atoms_in_chns.replace(chn, *gabor_Atom);            // change energy
@@ -384,6 +378,80 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
     return atom_list;
 }
 
+//*************************************************************************************************************
+
+void AdaptiveMp::search_scale(ScaleSearch& search, const MatrixXd& residuum, const MatrixXcd& residuum_spectra, qint32 channel_count, bool fix_phase)
+{
+    Eigen::FFT<double> fft;
+    qint32 sample_count = residuum.rows();
+    qreal s = search.scale;
+    qint32 p = floor(sample_count / 2);      //translation
+
+    VectorXd envelope = GaborAtom::gauss_function(sample_count, s, p);
+    VectorXcd fft_envelope = RowVectorXcd::Zero(sample_count);
+    fft.fwd(fft_envelope, envelope);
+
+    VectorXcd modulated_resid = VectorXcd::Zero(sample_count);
+    VectorXcd fft_modulated_resid = VectorXcd::Zero(sample_count);
+    VectorXcd fft_m_e_resid = VectorXcd::Zero(sample_count);
+    VectorXd corr_coeffs = VectorXd::Zero(sample_count);
+
+    for(qint32 m = 0; m < search.modulations.size(); m++)
+    {
+        qreal k = search.modulations[m];
+
+        //modulating with an integer k shifts the spectrum by k bins
+        bool shift_spectrum = (k == floor(k));
+        VectorXcd modulation;
+        if(!shift_spectrum)
+            modulation = modulation_function(sample_count, k);
+
+        for(qint32 chn = 0; chn < channel_count; chn++)
+        {
+            qint32 max_index = 0;
+            qreal maximum = 0;
+            p = floor(sample_count/2);//here is difference to dr. gratkowski´s code (he didn´t reset parameter p)
+
+            //complex correlation of signal and sinus-modulated gaussfunction
+            if(shift_spectrum)
+            {
+                qint32 shift = qint32(k) % sample_count;
+                qreal norm = 1 / sqrt(qreal(sample_count));
+                for(qint32 l = 0; l < sample_count; l++)
+                    fft_m_e_resid[l] = norm * residuum_spectra((l - shift + sample_count) % sample_count, chn) * conj(fft_envelope[l]);
+            }
+            else
+            {
+                for(qint32 l = 0; l< sample_count; l++)
+                    modulated_resid[l] = residuum(l, chn) * modulation[l];
+
+                fft.fwd(fft_modulated_resid, modulated_resid);
+
+                for(qint32 l = 0; l < sample_count; l++)
+                    fft_m_e_resid[l] = fft_modulated_resid[l] * conj(fft_envelope[l]);
+            }
+
+            fft.inv(corr_coeffs, fft_m_e_resid);
+            maximum = corr_coeffs[0];
+
+            //find index of maximum correlation-coefficient to use in translation
+            for(qint32 i = 1; i < corr_coeffs.rows(); i++)
+                if(maximum < corr_coeffs[i])
+                {
+                    maximum = corr_coeffs[i];
+                    max_index = i;
+                }
+
+            //adapting translation p to create atomtranslation correctly
+            if(max_index >= p) p = max_index - p + 1;
+            else p = max_index + p;
+
+            search.atom_parameters.append(calculate_atom(sample_count, s, p, k, chn, residuum, RETURNPARAMETERS, fix_phase));
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 VectorXcd AdaptiveMp::modulation_function(qint32 N, qreal k)
@@ -399,7 +467,7 @@ VectorXcd AdaptiveMp::modulation_function(qint32 N, qreal k)
 
 //*************************************************************************************************************
 
-VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, MatrixXd residuum, ReturnValue return_value = RETURNATOM, bool fix_phase = false)
+VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, const MatrixXd& residuum, ReturnValue return_value = RETURNATOM, bool fix_phase = false)
 {
     GaborAtom *gabor_Atom = new GaborAtom();
     qreal phase = 0;
@@ -463,7 +531,7 @@ VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 tra
 //*************************************************************************************************************
 
 void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflection, qreal simplex_expansion, qreal simplex_contraction, qreal simplex_full_contraction,
-                                      GaborAtom *gabor_Atom, VectorXd max_scalar_product, qint32 sample_count, bool fix_phase, MatrixXd residuum, bool trial_separation, qint32 chn)
+                                      GaborAtom *gabor_Atom, VectorXd max_scalar_product, qint32 sample_count, bool fix_phase, const MatrixXd& residuum, bool trial_separation, qint32 chn)
 {
     //Maximisation Simplex Algorithm implemented by Botao Jia, adapted to the MP Algorithm by Martin Henfling. Copyright (C) 2010 Botao Jia
     //ToDo: change to clean use of EIGEN, @present its mixed with Namespace std and <vector>
@@ -193,7 +193,7 @@ public:
     *
     * @return depending on returnValue returning the real atom calculated or the manipulated parameters: scale, translation, modulation, phase, scalarproduct
     */
-    static VectorXd calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, MatrixXd residuum, ReturnValue return_value, bool fix_phase);
+    static VectorXd calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, const MatrixXd& residuum, ReturnValue return_value, bool fix_phase);
 
     //=========================================================================================================
     /**
@@ -217,7 +217,7 @@ public:
     * @return depending on returnValue returning the real atom calculated or the manipulated parameters: scale, translation, modulation, phase, scalarproduct
     */
     void simplex_maximisation(qint32 simplex_it, qreal simplex_reflection, qreal simplex_expansion, qreal simplex_contraction, qreal simplex_full_contraction,
-                              GaborAtom *gabor_Atom, VectorXd max_scalar_product, qint32 sample_count, bool fix_phase, MatrixXd residuum, bool trial_separation, qint32 chn);
+                              GaborAtom *gabor_Atom, VectorXd max_scalar_product, qint32 sample_count, bool fix_phase, const MatrixXd& residuum, bool trial_separation, qint32 chn);
 
     //=========================================================================================================
 
@@ -240,6 +240,36 @@ signals:
 
     void send_warning(qint32 warning);
 
+private:
+    //=========================================================================================================
+    /**
+    * A part of the dyadic grid of scales and modulations, searched by one worker.
+    */
+    struct ScaleSearch
+    {
+        qreal scale;                        /**< The scale */
+        QList<qreal> modulations;           /**< The modulations to search */
+        QList<VectorXd> atom_parameters;    /**< The parameters of the best translation per modulation and channel, see calculate_atom */
+    };
+
+    //=========================================================================================================
+    /**
+    * adaptiveMP_search_scale
+    *
+    * ### MP toolbox root function ###
+    *
+    * finds the best translation for each modulation and channel of a scale search. The correlations of all
+    * translations come from one inverse FFT. For integer modulations the spectrum of the modulated residuum is the
+    * shifted residuum spectrum, so no forward FFT is needed.
+    *
+    * @param[in, out] search            the scale search, the atom parameters are appended
+    * @param[in] residuum               the signalresiduum
+    * @param[in] residuum_spectra       the spectra of the residuum channels
+    * @param[in] channel_count          number of channels to search
+    * @param[in] fix_phase              whether fix phase or varying
+    */
+    static void search_scale(ScaleSearch& search, const MatrixXd& residuum, const MatrixXcd& residuum_spectra, qint32 channel_count, bool fix_phase);
+
 };
 
 }   // NAMESPACE
@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "fixdictmp.h"
+#include "../cachelocation.h"
 
 
 //*************************************************************************************************************
@@ -73,6 +74,8 @@
 #include <QtConcurrent>
 #include <QFuture>
 #include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
 #include <QStringList>
 
 
@@ -83,6 +86,17 @@
 
 using namespace UTILSLIB;
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define FIXDICTMP_COMPILED_MAGIC        0x4D504443      /**< "MPDC", marks a compiled dictionary file. */
+#define FIXDICTMP_COMPILED_VERSION      1               /**< Version of the compiled dictionary format. */
+#define FIXDICTMP_MAX_CORR_VALUES       (1 << 25)       /**< Correlations and cached gram columns kept in memory (256 MB). */
+#define FIXDICTMP_MAX_GRAM_CACHE        64              /**< Maximum number of cached gram columns. */
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -145,7 +159,35 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
     bool sample_count_mismatch = false;
 
     this->residuum = signal;
-    parsed_dicts = parse_xml_dict(path);
+    parsed_dicts = load_dict(path);
+
+    //all atoms fitted to the signal length, correlated with one GEMM per channel
+    QList<QPair<qint32, qint32> > atom_index;
+    MatrixXd atom_matrix = fit_atoms(parsed_dicts, sample_count, atom_index);
+
+    if(atom_matrix.cols() == 0)
+    {
+        std::cout << "\nno atoms found in dictionary.\n";
+        emit finished_calc();
+        return;
+    }
+
+    qint32 corr_channel_count = channel_count * (boost / 100.0); //reducing the number of observed channels in the algorithm to increase speed performance
+    if(boost == 0 || corr_channel_count == 0)
+        corr_channel_count = 1;
+
+    //after the first iteration the correlations are updated with the gram column of the subtracted atom
+    qint64 corr_block_size = qint64(sample_count) * atom_matrix.cols();
+    qint64 gram_cache_size = qMin(qint64(FIXDICTMP_MAX_GRAM_CACHE), FIXDICTMP_MAX_CORR_VALUES / corr_block_size - corr_channel_count);
+    bool use_gram = gram_cache_size > 0;
+
+    QList<MatrixXd> correlations;
+    QMap<qint32, MatrixXd> gram_cache;
+    bool correlations_valid = false;
+
+    QList<qint32> corr_channels;
+    for(qint32 chn = 0; chn < corr_channel_count; chn++)
+        corr_channels.append(chn);
 
     //calculate signal_energy
     for(qint32 channel = 0; channel < channel_count; channel++)
@@ -161,31 +203,45 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
 
     while(it < max_iterations && energy_threshold < residuum_energy)
     {
-        FixDictAtom global_best_matching;
+        if(!correlations_valid)
+            correlate_all(this->residuum, corr_channel_count, atom_matrix, correlations);
 
-        QList<find_best_matching> list_of_best;
-        for(qint32 i = 0; i < parsed_dicts.length(); i++)
+        //find the atom and translation of maximum correlation-coefficient in all observed channels
+        qint32 best_col = 0;
+        std::ptrdiff_t best_lag = 0;
+        qreal max_scalar_product = 0;
+
+        for(qint32 col = 0; col < atom_matrix.cols(); col++)
         {
-            find_best_matching current_best_matching;
-            current_best_matching.pdict = parsed_dicts.at(i);
-            current_best_matching.current_resid = this->residuum;
-            current_best_matching.boost = boost;
-            list_of_best.append(current_best_matching);
+            for(qint32 chn = 0; chn < corr_channel_count; chn++)
+            {
+                std::ptrdiff_t max_index;
+                qreal scalar_product = correlations.at(chn).col(col).maxCoeff(&max_index);
+
+                if((col == 0 && chn == 0) || std::fabs(scalar_product) > std::fabs(max_scalar_product))
+                {
+                    max_scalar_product = scalar_product;
+                    best_col = col;
+                    best_lag = max_index;
+                }
+            }
         }
 
-        QFuture<FixDictAtom> mapped_best_matchings = QtConcurrent::mapped(list_of_best, &find_best_matching::parallel_correlation);// parse_threads;
-        mapped_best_matchings.waitForFinished();
+        const Dictionary& best_dict = parsed_dicts.at(atom_index.at(best_col).first);
+        FixDictAtom global_best_matching = best_dict.atoms.at(atom_index.at(best_col).second);
+        global_best_matching.max_scalar_product = max_scalar_product;
 
-        QFuture<FixDictAtom>::const_iterator i;
-        for (i = mapped_best_matchings.constBegin(); i != mapped_best_matchings.constEnd(); i++)
-        {
-            //FixDictAtom current_best_matching = correlation(parsed_dicts.at(i));
-            if(i == mapped_best_matchings.constBegin())
-                global_best_matching = *i;
+        //adapting translation p to create atomtranslation correctly
+        qint32 p = floor(sample_count / 2);
+        if(best_lag >= p && sample_count % (2) == 0) p = best_lag - p;
+        else if(best_lag >= p && sample_count % (2) != 0) p = best_lag - p - 1;
+        else p = best_lag + p;
 
-            else if(std::fabs(i->max_scalar_product) > std::fabs(global_best_matching.max_scalar_product))
-                global_best_matching = *i;
-        }
+        global_best_matching.translation = p;
+        global_best_matching.atom_formula = best_dict.atom_formula;
+        global_best_matching.dict_source = best_dict.source;
+        global_best_matching.type = best_dict.type;
+        global_best_matching.sample_count = best_dict.sample_count;
 
         global_best_matching.display_text = create_display_text(global_best_matching);
 
@@ -223,6 +279,39 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
             }
         }
 
+        //the subtracted atom is the fitted atom shifted by best_lag unless it was cut at the signal borders, then the
+        //correlations change by its gram column, otherwise they are recalculated
+        correlations_valid = false;
+        if(use_gram)
+        {
+            VectorXd shifted_atom(sample_count);
+            for(qint32 k = 0; k < sample_count; k++)
+                shifted_atom[(k + best_lag) % sample_count] = atom_matrix(k, best_col);
+
+            if((shifted_atom - fitted_atom).norm() < 1e-10)
+            {
+                if(!gram_cache.contains(best_col))
+                {
+                    if(gram_cache.size() >= gram_cache_size)
+                        gram_cache.clear();
+                    gram_cache.insert(best_col, lag_matrix(atom_matrix.col(best_col)) * atom_matrix);
+                }
+
+                const MatrixXd& gram = gram_cache[best_col];
+                const QList<qreal>& scalar_list = global_best_matching.max_scalar_list;
+                qint32 lag = best_lag;
+
+                //correlation at translation t changes by the gram row of translation t - lag
+                QtConcurrent::blockingMap(corr_channels, [&correlations, &gram, &scalar_list, lag, sample_count](qint32& chn) {
+                    MatrixXd& corr = correlations[chn];
+                    corr.bottomRows(sample_count - lag) -= scalar_list.at(chn) * gram.topRows(sample_count - lag);
+                    corr.topRows(lag) -= scalar_list.at(chn) * gram.bottomRows(lag);
+                });
+
+                correlations_valid = true;
+            }
+        }
+
         global_best_matching.atom_samples = fitted_atom;
 
 
@@ -425,6 +514,252 @@ QList<Dictionary> FixDictMp::parse_xml_dict(QString path)
 }
 
 
+//*************************************************************************************************************
+
+QList<Dictionary> FixDictMp::load_dict(QString path)
+{
+    QList<Dictionary> loaded_dicts;
+
+    if(load_compiled_dict(path, loaded_dicts))
+    {
+        for(qint32 i = 0; i < loaded_dicts.length(); i++)
+            if(loaded_dicts.at(i).sample_count != this->residuum.rows())
+            {
+                emit send_warning(2);
+                break;
+            }
+
+        return loaded_dicts;
+    }
+
+    //use the compiled copy as long as the xml file was not changed
+    QString compiled_path = CacheLocation::filePath(path, QString(".bin"));
+    QFileInfo xml_info(path);
+    QFileInfo compiled_info(compiled_path);
+
+    if(compiled_info.exists() && compiled_info.lastModified() >= xml_info.lastModified() && load_compiled_dict(compiled_path, loaded_dicts))
+    {
+        for(qint32 i = 0; i < loaded_dicts.length(); i++)
+            if(loaded_dicts.at(i).sample_count != this->residuum.rows())
+            {
+                emit send_warning(2);
+                break;
+            }
+
+        return loaded_dicts;
+    }
+
+    loaded_dicts = parse_xml_dict(path);
+
+    if(save_compiled_dict(loaded_dicts, compiled_path))
+        std::cout << "compiled dictionary written to " << compiled_path.toStdString() << "\n";
+    else
+        std::cout << "could not write compiled dictionary " << compiled_path.toStdString() << "\n";
+
+    return loaded_dicts;
+}
+
+
+//*************************************************************************************************************
+
+bool FixDictMp::save_compiled_dict(const QList<Dictionary>& dicts, QString path)
+{
+    //the samples are written as raw doubles, which are read back on little endian machines only
+    if(QSysInfo::ByteOrder != QSysInfo::LittleEndian)
+        return false;
+
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    stream << (quint32)FIXDICTMP_COMPILED_MAGIC << (qint32)FIXDICTMP_COMPILED_VERSION << (qint32)dicts.length();
+
+    for(qint32 i = 0; i < dicts.length(); i++)
+    {
+        const Dictionary& dict = dicts.at(i);
+        stream << (qint32)dict.type << dict.source << dict.atom_formula << dict.sample_count << (qint32)dict.atoms.length();
+
+        for(qint32 j = 0; j < dict.atoms.length(); j++)
+        {
+            const FixDictAtom& atom = dict.atoms.at(j);
+            stream << atom.id;
+
+            if(dict.type == GABORATOM)
+                stream << atom.gabor_atom.scale << atom.gabor_atom.modulation << atom.gabor_atom.phase;
+            else if(dict.type == CHIRPATOM)
+                stream << atom.chirp_atom.scale << atom.chirp_atom.modulation << atom.chirp_atom.phase << atom.chirp_atom.chirp;
+            else
+                stream << atom.formula_atom.a << atom.formula_atom.b << atom.formula_atom.c << atom.formula_atom.d
+                       << atom.formula_atom.e << atom.formula_atom.f << atom.formula_atom.g << atom.formula_atom.h;
+
+            stream << (qint32)atom.atom_samples.rows();
+            stream.writeRawData((const char*)atom.atom_samples.data(), atom.atom_samples.rows() * sizeof(double));
+        }
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+
+//*************************************************************************************************************
+
+bool FixDictMp::load_compiled_dict(QString path, QList<Dictionary>& dicts)
+{
+    if(QSysInfo::ByteOrder != QSysInfo::LittleEndian)
+        return false;
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly) || file.size() < 12)
+        return false;
+
+    uchar* mapped = file.map(0, file.size());
+    if(!mapped)
+        return false;
+
+    //the mapped file is read in place, only the samples are copied into the atoms
+    QByteArray data = QByteArray::fromRawData((const char*)mapped, file.size());
+    QDataStream stream(data);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    quint32 magic;
+    qint32 version, dict_count;
+    stream >> magic >> version >> dict_count;
+
+    if(magic != FIXDICTMP_COMPILED_MAGIC || version != FIXDICTMP_COMPILED_VERSION || dict_count < 0)
+    {
+        file.unmap(mapped);
+        return false;
+    }
+
+    QList<Dictionary> read_dicts;
+    for(qint32 i = 0; i < dict_count && stream.status() == QDataStream::Ok; i++)
+    {
+        Dictionary dict;
+        qint32 type, atom_count;
+        stream >> type >> dict.source >> dict.atom_formula >> dict.sample_count >> atom_count;
+        dict.type = (AtomType)type;
+
+        for(qint32 j = 0; j < atom_count && stream.status() == QDataStream::Ok; j++)
+        {
+            FixDictAtom atom;
+            stream >> atom.id;
+
+            if(dict.type == GABORATOM)
+                stream >> atom.gabor_atom.scale >> atom.gabor_atom.modulation >> atom.gabor_atom.phase;
+            else if(dict.type == CHIRPATOM)
+                stream >> atom.chirp_atom.scale >> atom.chirp_atom.modulation >> atom.chirp_atom.phase >> atom.chirp_atom.chirp;
+            else
+                stream >> atom.formula_atom.a >> atom.formula_atom.b >> atom.formula_atom.c >> atom.formula_atom.d
+                       >> atom.formula_atom.e >> atom.formula_atom.f >> atom.formula_atom.g >> atom.formula_atom.h;
+
+            qint32 length;
+            stream >> length;
+
+            qint64 pos = stream.device()->pos();
+            if(length < 0 || pos + length * (qint64)sizeof(double) > file.size())
+            {
+                stream.setStatus(QDataStream::ReadCorruptData);
+                break;
+            }
+
+            atom.atom_samples.resize(length);
+            memcpy(atom.atom_samples.data(), mapped + pos, length * sizeof(double));
+            stream.skipRawData(length * sizeof(double));
+
+            dict.atoms.append(atom);
+        }
+
+        read_dicts.append(dict);
+    }
+
+    bool valid = stream.status() == QDataStream::Ok;
+    file.unmap(mapped);
+
+    if(valid)
+        dicts = read_dicts;
+
+    return valid;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd FixDictMp::fit_atoms(const QList<Dictionary>& dicts, qint32 sample_count, QList<QPair<qint32, qint32> >& atom_index)
+{
+    atom_index.clear();
+    for(qint32 i = 0; i < dicts.length(); i++)
+        for(qint32 j = 0; j < dicts.at(i).atoms.length(); j++)
+            atom_index.append(qMakePair(i, j));
+
+    MatrixXd atom_matrix = MatrixXd::Zero(sample_count, atom_index.length());
+    qint32 p = floor(sample_count / 2);//translation
+
+    for(qint32 col = 0; col < atom_index.length(); col++)
+    {
+        const VectorXd& atom_samples = dicts.at(atom_index.at(col).first).atoms.at(atom_index.at(col).second).atom_samples;
+
+        VectorXd resized_atom = VectorXd::Zero(sample_count);
+
+        if(atom_samples.rows() > sample_count)
+            for(qint32 k = 0; k < sample_count; k++)
+                resized_atom[k] = atom_samples[k + floor(atom_samples.rows() / 2) - floor(sample_count / 2)];
+        else resized_atom = atom_samples;
+
+        if(resized_atom.rows() < sample_count)
+            for(qint32 k = 0; k < resized_atom.rows(); k++)
+                atom_matrix(k + p - floor(resized_atom.rows() / 2), col) = resized_atom[k];
+        else atom_matrix.col(col) = resized_atom;
+
+        //normalization
+        qreal norm = atom_matrix.col(col).norm();
+        if(norm != 0) atom_matrix.col(col) /= norm;
+    }
+
+    return atom_matrix;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd FixDictMp::lag_matrix(const VectorXd& signal)
+{
+    qint32 sample_count = signal.rows();
+    MatrixXd lags(sample_count, sample_count);
+
+    for(qint32 t = 0; t < sample_count; t++)
+    {
+        lags.row(t).head(sample_count - t) = signal.tail(sample_count - t).transpose();
+        lags.row(t).tail(t) = signal.head(t).transpose();
+    }
+
+    return lags;
+}
+
+
+//*************************************************************************************************************
+
+void FixDictMp::correlate_all(const MatrixXd& residuum, qint32 channel_count, const MatrixXd& atom_matrix, QList<MatrixXd>& correlations)
+{
+    correlations.clear();
+    QList<qint32> channels;
+    for(qint32 chn = 0; chn < channel_count; chn++)
+    {
+        correlations.append(MatrixXd());
+        channels.append(chn);
+    }
+
+    //row t of a channel holds the correlation coefficients of all atoms translated by t samples
+    QtConcurrent::blockingMap(channels, [&residuum, &atom_matrix, &correlations](qint32& chn) {
+        correlations[chn].noalias() = lag_matrix(residuum.col(chn)) * atom_matrix;
+    });
+}
+
+
 //*************************************************************************************************************
 
 Dictionary FixDictMp::fill_dict(const QDomNode &pdict)
@@ -209,6 +209,40 @@ public:
 
     QList<Dictionary> parse_xml_dict(QString path);
 
+    //=========================================================================================================
+    /**
+    * Loads the dictionaries of a dictionary file. A compiled dictionary is loaded directly. For an xml dictionary
+    * its compiled copy in the directory of CacheLocation is used when it is newer than the xml file, otherwise the
+    * xml file is parsed and the compiled copy is written for the next run.
+    *
+    * @param[in] path   path of the xml or compiled dictionary file.
+    *
+    * @return the loaded dictionaries.
+    */
+    QList<Dictionary> load_dict(QString path);
+
+    //=========================================================================================================
+    /**
+    * Writes dictionaries in the compiled binary format, which is memory mapped when loaded.
+    *
+    * @param[in] dicts  the dictionaries to write.
+    * @param[in] path   path of the compiled dictionary file.
+    *
+    * @return true if the file was written.
+    */
+    static bool save_compiled_dict(const QList<Dictionary>& dicts, QString path);
+
+    //=========================================================================================================
+    /**
+    * Reads dictionaries from a memory mapped compiled dictionary file.
+    *
+    * @param[in] path   path of the compiled dictionary file.
+    * @param[out] dicts the read dictionaries.
+    *
+    * @return true if the file is a valid compiled dictionary.
+    */
+    static bool load_compiled_dict(QString path, QList<Dictionary>& dicts);
+
     //=========================================================================================================
 
     Dictionary fill_dict(const QDomNode &pdict);
@@ -221,6 +255,43 @@ public:
 
     //static void build_molecule_xml_file(qint32 level_counter);
 
+private:
+
+    //=========================================================================================================
+    /**
+    * Fits all atoms of the dictionaries to the signal length the same way as correlation does, i.e. centered,
+    * cut or zero padded and normalized.
+    *
+    * @param[in] dicts          the dictionaries.
+    * @param[in] sample_count   the signal length.
+    * @param[out] atom_index    dictionary and atom index of each column.
+    *
+    * @return the fitted atoms, one per column.
+    */
+    static MatrixXd fit_atoms(const QList<Dictionary>& dicts, qint32 sample_count, QList<QPair<qint32, qint32> >& atom_index);
+
+    //=========================================================================================================
+    /**
+    * Builds the matrix of all circular translations of a signal, row t holds the signal shifted by t samples. The
+    * product with the fitted atoms gives the circular cross correlation of the signal with every atom.
+    *
+    * @param[in] signal     the signal.
+    *
+    * @return the translation matrix.
+    */
+    static MatrixXd lag_matrix(const VectorXd& signal);
+
+    //=========================================================================================================
+    /**
+    * Correlates the first channels of the residuum with all fitted atoms at all translations, one GEMM per channel.
+    *
+    * @param[in] residuum       the residuum.
+    * @param[in] channel_count  the number of correlated channels.
+    * @param[in] atom_matrix    the fitted atoms.
+    * @param[out] correlations  per channel the translations x atoms correlation matrix.
+    */
+    static void correlate_all(const MatrixXd& residuum, qint32 channel_count, const MatrixXd& atom_matrix, QList<MatrixXd>& correlations);
+
 
 public slots:
 
@@ -52,6 +52,15 @@
 
 #include <Eigen/Core>
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QList>
+#include <QtConcurrent>
+
 #define ALPHA 1.0
 #define BETA 0.5
 #define GAMMA 2.0
@@ -115,6 +124,60 @@ public:
                                     int report,
                                     bool (*report_func)(int loop, const Matrix<T,Dynamic, 1>& fitpar, double fval));
 
+    //=========================================================================================================
+    /**
+    * Minimization with the simplex algorithm and a vectorized cost function. Each step evaluates the reflection,
+    * the expansion and both contractions of the worst vertex in one call, a shrink evaluates all new vertices in
+    * one call. The steps taken are the same as in simplex_minimize, neval and max_eval only count the evaluations
+    * simplex_minimize would do.
+    *
+    * @param[in] p              The initial simplex
+    * @param[in] y              Function values at the vertices
+    * @param[in] ftol           Relative convergence tolerance
+    * @param[in] func           The vectorized function, evaluates each row of x into the corresponding entry of f
+    * @param[in] user_data      Data to be passed to the above function in each evaluation
+    * @param[in] max_eval       Maximum number of function evaluations
+    * @param[in] neval          Number of function evaluations
+    * @param[in] report         How often to report (-1 = no_reporting)
+    * @param[in] report_func    The function to be called when reporting
+    *
+    * @return True when setup was successful, false otherwise
+    */
+    template <typename T>
+    static bool simplex_minimize_batch( Matrix<T,Dynamic,Dynamic>& p,
+                                        Matrix<T,Dynamic, 1>& y,
+                                        T ftol,
+                                        void (*func)(const Matrix<T,Dynamic,Dynamic>& x, Matrix<T,Dynamic, 1>& f, const void *user_data),
+                                        const void *user_data,
+                                        int max_eval,
+                                        int &neval,
+                                        int report,
+                                        bool (*report_func)(int loop, const Matrix<T,Dynamic, 1>& fitpar, double fval));
+
+    //=========================================================================================================
+    /**
+    * Runs simplex_minimize from several initial simplices in parallel on the global thread pool. The function has
+    * to be thread safe for the given user data.
+    *
+    * @param[in] p              The initial simplices, the final simplices on return
+    * @param[in] y              Function values at the vertices of each simplex
+    * @param[in] ftol           Relative convergence tolerance
+    * @param[in] func           The function to be evaluated
+    * @param[in] user_data      Data to be passed to the above function in each evaluation
+    * @param[in] max_eval       Maximum number of function evaluations per start
+    * @param[out] neval         Number of function evaluations of each start
+    *
+    * @return The index of the start which converged to the lowest function value, -1 if no start converged
+    */
+    template <typename T>
+    static int simplex_minimize_multistart( QList<Matrix<T,Dynamic,Dynamic> >& p,
+                                            QList<Matrix<T,Dynamic, 1> >& y,
+                                            T ftol,
+                                            T (*func)(const Matrix<T,Dynamic, 1>& x, const void *user_data),
+                                            const void *user_data,
+                                            int max_eval,
+                                            QList<int> &neval);
+
 private:
 
     template <typename T>
@@ -212,6 +275,187 @@ bool SimplexAlgorithm::simplex_minimize(   Matrix<T,Dynamic,Dynamic>& p, Matrix<
 }
 
 
+//*************************************************************************************************************
+
+template <typename T>
+bool SimplexAlgorithm::simplex_minimize_batch(  Matrix<T,Dynamic,Dynamic>& p, Matrix<T,Dynamic, 1>& y, T ftol,
+                                                void (*func)(const Matrix<T,Dynamic,Dynamic>& x, Matrix<T,Dynamic, 1>& f, const void *user_data),
+                                                const void *user_data, int max_eval, int &neval, int report,
+                                                bool (*report_func)(int loop, const Matrix<T,Dynamic, 1>& fitpar, double fval))
+{
+    int   ndim = p.cols();  /* Number of variables */
+    int   i,ilo,ihi,inhi;
+    int   mpts = ndim+1;
+    T ytry,ysave,rtol;
+    Matrix<T,Dynamic, 1> psum(ndim);
+    Matrix<T,Dynamic, 1> psum_refl(ndim);
+    Matrix<T,Dynamic,Dynamic> ptry(4,ndim);
+    Matrix<T,Dynamic, 1> ftry(4);
+    Matrix<T,Dynamic,Dynamic> pshrink(ndim,ndim);
+    Matrix<T,Dynamic, 1> fshrink(ndim);
+    bool  result = true;
+    int   count = 0;
+    int   loop  = 1;
+
+    /*
+    * The candidates are formed as in tryit: the reflection, the expansion and the outside contraction of the
+    * reflected simplex, and the inside contraction of the original one
+    */
+    T fac1_refl = (1.0+ALPHA)/ndim;
+    T fac2_refl = fac1_refl+ALPHA;
+    T fac1_exp = (1.0-GAMMA)/ndim;
+    T fac2_exp = fac1_exp-GAMMA;
+    T fac1_con = (1.0-BETA)/ndim;
+    T fac2_con = fac1_con-BETA;
+
+    neval = 0;
+    psum = p.colwise().sum();
+
+    if (report_func != NULL && report > 0) {
+        report_func(0,static_cast< Matrix<T,Dynamic, 1> >(p.row(0)),-1.0);
+    }
+
+    for (;;count++,loop++) {
+        ilo = 1;
+        ihi  =  y[1]>y[2] ? (inhi = 2,1) : (inhi = 1,2);
+        for (i = 0; i < mpts; i++) {
+            if (y[i]  <  y[ilo])
+                ilo = i;
+            if (y[i] > y[ihi]) {
+                inhi = ihi;
+                ihi = i;
+            } else if (y[i] > y[inhi])
+                if (i !=  ihi)
+                    inhi = i;
+        }
+        rtol = 2.0*std::fabs(y[ihi]-y[ilo])/(std::fabs(y[ihi])+std::fabs(y[ilo]));
+        /*
+        * Report that we are proceeding...
+        */
+        if (count == report && report_func != NULL) {
+            if (!report_func(loop,static_cast< Matrix<T,Dynamic, 1> >(p.row(ilo)),y[ilo])) {
+                qCritical("Interation interrupted.");
+                result = false;
+                break;
+            }
+            count = 0;
+        }
+        if (rtol < ftol) break;
+        if (neval >=  max_eval) {
+            qCritical("Maximum number of evaluations exceeded.");
+            result  =  false;
+            break;
+        }
+
+        /*
+        * Evaluate all candidates of this step at once
+        */
+        ptry.row(0) = psum * fac1_refl - p.row(ihi).transpose() * fac2_refl;
+        psum_refl = psum + ptry.row(0).transpose() - p.row(ihi).transpose();
+        ptry.row(1) = psum_refl * fac1_exp - ptry.row(0).transpose() * fac2_exp;
+        ptry.row(2) = psum_refl * fac1_con - ptry.row(0).transpose() * fac2_con;
+        ptry.row(3) = psum * fac1_con - p.row(ihi).transpose() * fac2_con;
+        (*func)(ptry,ftry,user_data);
+
+        ytry = ftry[0];
+        ++neval;
+        bool reflected = ytry < y[ihi];
+        if (reflected) {
+            y[ihi] = ytry;
+            psum = psum_refl;
+            p.row(ihi) = ptry.row(0);
+        }
+
+        if (ytry <= y[ilo]) {
+            ++neval;
+            if (ftry[1] < y[ihi]) {
+                y[ihi] = ftry[1];
+                psum += ptry.row(1).transpose() - p.row(ihi).transpose();
+                p.row(ihi) = ptry.row(1);
+            }
+        }
+        else if (ytry >= y[inhi]) {
+            ysave = y[ihi];
+            int icon = reflected ? 2 : 3;
+            ytry = ftry[icon];
+            ++neval;
+            if (ytry < y[ihi]) {
+                y[ihi] = ytry;
+                psum += ptry.row(icon).transpose() - p.row(ihi).transpose();
+                p.row(ihi) = ptry.row(icon);
+            }
+            if (ytry >= ysave) {
+                int k = 0;
+                for (i = 0; i < mpts; i++) {
+                    if (i !=  ilo) {
+                        pshrink.row(k++) = 0.5 * ( p.row(i) + p.row(ilo) );
+                    }
+                }
+                (*func)(pshrink,fshrink,user_data);
+                k = 0;
+                for (i = 0; i < mpts; i++) {
+                    if (i !=  ilo) {
+                        p.row(i) = pshrink.row(k);
+                        y[i] = fshrink[k++];
+                    }
+                }
+                neval +=  ndim;
+                psum = p.colwise().sum();
+            }
+        }
+    }
+
+    return result;
+}
+
+
+//*************************************************************************************************************
+
+template <typename T>
+int SimplexAlgorithm::simplex_minimize_multistart(  QList<Matrix<T,Dynamic,Dynamic> >& p,
+                                                    QList<Matrix<T,Dynamic, 1> >& y,
+                                                    T ftol,
+                                                    T (*func)(const Matrix<T,Dynamic, 1>& x, const void *user_data),
+                                                    const void *user_data,
+                                                    int max_eval,
+                                                    QList<int> &neval)
+{
+    if (p.size() != y.size()) {
+        qCritical("The number of initial simplices and function values does not match.");
+        return -1;
+    }
+
+    struct Start {
+        Matrix<T,Dynamic,Dynamic>*  p;
+        Matrix<T,Dynamic, 1>*       y;
+        int                         neval;
+        bool                        converged;
+    };
+
+    //Each start works on its own simplex and values, the lists are not touched while the starts run
+    QList<Start> starts;
+    for (int i = 0; i < p.size(); i++) {
+        Start start = { &p[i], &y[i], 0, false };
+        starts.append(start);
+    }
+
+    QtConcurrent::blockingMap(starts, [ftol, func, user_data, max_eval](Start& start) {
+        start.converged = simplex_minimize<T>(*start.p, *start.y, ftol, func, user_data, max_eval, start.neval, -1, NULL);
+    });
+
+    int best = -1;
+    neval.clear();
+    for (int i = 0; i < starts.size(); i++) {
+        neval.append(starts.at(i).neval);
+        if (starts.at(i).converged && (best < 0 || y.at(i).minCoeff() < y.at(best).minCoeff())) {
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+
 //*************************************************************************************************************
 
 template <typename T>
@@ -59,6 +59,10 @@
 //=============================================================================================================
 
 #include <QtMath>
+#include <QtConcurrent>
+#include <QThreadPool>
+#include <QMutex>
+#include <QMap>
 
 
 //*************************************************************************************************************
@@ -70,6 +74,98 @@ using namespace UTILSLIB;
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+/**
+* Rows of the input data handled by one thread, which owns the FFT object and with it the FFT plan.
+*/
+template<typename T>
+struct SpectraBatch {
+    typedef Matrix<T, Dynamic, Dynamic>                 MatrixXT;
+    typedef Matrix<std::complex<T>, Dynamic, Dynamic>   MatrixXcT;
+
+    const MatrixXT*         pData;          /**< The input data. */
+    const MatrixXT*         pTapers;        /**< The tapers. */
+    int                     iNfft;          /**< The FFT length. */
+    int                     iFirstRow;      /**< The first row of this batch. */
+    int                     iNumRows;       /**< The number of rows of this batch. */
+    QVector<MatrixXcT>*     pTapSpectra;    /**< The resulting tapered spectra per row. */
+};
+
+template<typename T>
+void computeSpectraBatch(SpectraBatch<T>& batch)
+{
+    FFT<T> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+
+    const Matrix<T, Dynamic, Dynamic>& matData = *batch.pData;
+    const Matrix<T, Dynamic, Dynamic>& matTaper = *batch.pTapers;
+    int iNFreqs = int(floor(batch.iNfft / 2.0)) + 1;
+
+    //The zero-padding stays untouched, only the head is overwritten per taper
+    Matrix<T, 1, Dynamic> vecInputFFT = Matrix<T, 1, Dynamic>::Zero(batch.iNfft);
+    Matrix<std::complex<T>, 1, Dynamic> vecTmpFreq;
+
+    for (int r = batch.iFirstRow; r < batch.iFirstRow + batch.iNumRows; ++r) {
+        Matrix<std::complex<T>, Dynamic, Dynamic> matTapSpectrum(matTaper.rows(), iNFreqs);
+        for (int i = 0; i < matTaper.rows(); ++i) {
+            vecInputFFT.head(matData.cols()) = matData.row(r).cwiseProduct(matTaper.row(i));
+            fft.fwd(vecTmpFreq, vecInputFFT);
+            matTapSpectrum.row(i) = vecTmpFreq;
+        }
+        (*batch.pTapSpectra)[r] = matTapSpectrum;
+    }
+}
+
+template<typename T>
+QVector<Matrix<std::complex<T>, Dynamic, Dynamic> > computeSpectraMatrix(const Matrix<T, Dynamic, Dynamic> &matData,
+                                                                         const Matrix<T, Dynamic, Dynamic> &matTaper,
+                                                                         int iNfft,
+                                                                         bool bUseThreads)
+{
+    QVector<Matrix<std::complex<T>, Dynamic, Dynamic> > vecTapSpectra;
+
+    //Check inputs
+    if (matData.cols() != matTaper.cols()) {
+        return vecTapSpectra;
+    }
+    if (iNfft < matData.cols()) {
+        return vecTapSpectra;
+    }
+
+    vecTapSpectra.resize(matData.rows());
+
+    int iNumBatches = bUseThreads ? qBound(1, QThreadPool::globalInstance()->maxThreadCount(), int(matData.rows())) : 1;
+
+    QList<SpectraBatch<T> > lBatches;
+    for (int b = 0; b < iNumBatches; ++b) {
+        SpectraBatch<T> batch;
+        batch.pData = &matData;
+        batch.pTapers = &matTaper;
+        batch.iNfft = iNfft;
+        batch.iFirstRow = b * matData.rows() / iNumBatches;
+        batch.iNumRows = (b + 1) * matData.rows() / iNumBatches - batch.iFirstRow;
+        batch.pTapSpectra = &vecTapSpectra;
+        lBatches.append(batch);
+    }
+
+    if (lBatches.size() == 1) {
+        computeSpectraBatch<T>(lBatches.first());
+    } else {
+        QtConcurrent::blockingMap(lBatches, &computeSpectraBatch<T>);
+    }
+
+    return vecTapSpectra;
+}
+
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -104,6 +200,28 @@ MatrixXcd Spectral::computeTaperedSpectra(const RowVectorXd &vecData,
 }
 
 
+//*************************************************************************************************************
+
+QVector<MatrixXcd> Spectral::computeTaperedSpectraMatrix(const MatrixXd &matData,
+                                                         const MatrixXd &matTaper,
+                                                         int iNfft,
+                                                         bool bUseThreads)
+{
+    return computeSpectraMatrix<double>(matData, matTaper, iNfft, bUseThreads);
+}
+
+
+//*************************************************************************************************************
+
+QVector<MatrixXcf> Spectral::computeTaperedSpectraMatrix(const MatrixXf &matData,
+                                                         const MatrixXf &matTaper,
+                                                         int iNfft,
+                                                         bool bUseThreads)
+{
+    return computeSpectraMatrix<float>(matData, matTaper, iNfft, bUseThreads);
+}
+
+
 //*************************************************************************************************************
 
 RowVectorXd Spectral::psdFromTaperedSpectra(const MatrixXcd &matTapSpectrum,
@@ -134,6 +252,30 @@ RowVectorXd Spectral::psdFromTaperedSpectra(const MatrixXcd &matTapSpectrum,
 }
 
 
+//*************************************************************************************************************
+
+MatrixXd Spectral::psdFromTaperedSpectraMatrix(const QVector<MatrixXcd> &vecTapSpectra,
+                                               const VectorXd &vecTapWeights,
+                                               int iNfft,
+                                               double dSampFreq)
+{
+    if (vecTapSpectra.isEmpty()) {
+        return MatrixXd();
+    }
+
+    MatrixXd matPsd(vecTapSpectra.size(), vecTapSpectra.first().cols());
+    for (int r = 0; r < vecTapSpectra.size(); ++r) {
+        RowVectorXd vecPsd = psdFromTaperedSpectra(vecTapSpectra.at(r), vecTapWeights, iNfft, dSampFreq);
+        if (vecPsd.cols() != matPsd.cols()) {
+            return MatrixXd();
+        }
+        matPsd.row(r) = vecPsd;
+    }
+
+    return matPsd;
+}
+
+
 //*************************************************************************************************************
 
 RowVectorXcd Spectral::csdFromTaperedSpectra(const MatrixXcd &vecTapSpectrumSeed,
@@ -194,6 +336,16 @@ VectorXd Spectral::calculateFFTFreqs(int iNfft, double dSampFreq)
 
 QPair<MatrixXd, VectorXd> Spectral::generateTapers(int iSignalLength, const QString &sWindowType)
 {
+    static QMutex mutex;
+    static QMap<QPair<int, QString>, QPair<MatrixXd, VectorXd> > mapTapers;
+
+    QPair<int, QString> key(iSignalLength, sWindowType);
+
+    QMutexLocker locker(&mutex);
+    if (mapTapers.contains(key)) {
+        return mapTapers.value(key);
+    }
+
     QPair<MatrixXd, VectorXd> pairOut;
     if (sWindowType == "hanning") {
         pairOut.first = hanningWindow(iSignalLength);
@@ -205,6 +357,13 @@ QPair<MatrixXd, VectorXd> Spectral::generateTapers(int iSignalLength, const QStr
         pairOut.first = hanningWindow(iSignalLength);
         pairOut.second = VectorXd::Ones(1);
     }
+
+    //Only a few lengths and window types are in use at a time
+    if (mapTapers.size() >= 32) {
+        mapTapers.clear();
+    }
+    mapTapers.insert(key, pairOut);
+
     return pairOut;
 }
 
@@ -62,6 +62,7 @@
 
 #include <QString>
 #include <QPair>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -101,6 +102,39 @@ public:
                                                   const Eigen::MatrixXd &matTaper,
                                                   int iNfft);
 
+    //=========================================================================================================
+    /**
+    * Calculates the full tapered spectra of all rows of the input data. Each thread reuses one FFT plan for all of
+    * its rows.
+    *
+    * @param[in] matData         input data (time domain, channels x samples), for which the spectra are computed
+    * @param[in] matTaper        tapers used to compute the spectra
+    * @param[in] iNfft           FFT length
+    * @param[in] bUseThreads     whether to distribute the rows over the threads of the global thread pool
+    *
+    * @return tapered spectra (tapers x frequencies) of each row of the input data
+    */
+    static QVector<Eigen::MatrixXcd> computeTaperedSpectraMatrix(const Eigen::MatrixXd &matData,
+                                                                 const Eigen::MatrixXd &matTaper,
+                                                                 int iNfft,
+                                                                 bool bUseThreads = true);
+
+    //=========================================================================================================
+    /**
+    * Calculates the full tapered spectra of all rows of the input data in single precision.
+    *
+    * @param[in] matData         input data (time domain, channels x samples), for which the spectra are computed
+    * @param[in] matTaper        tapers used to compute the spectra
+    * @param[in] iNfft           FFT length
+    * @param[in] bUseThreads     whether to distribute the rows over the threads of the global thread pool
+    *
+    * @return tapered spectra (tapers x frequencies) of each row of the input data
+    */
+    static QVector<Eigen::MatrixXcf> computeTaperedSpectraMatrix(const Eigen::MatrixXf &matData,
+                                                                 const Eigen::MatrixXf &matTaper,
+                                                                 int iNfft,
+                                                                 bool bUseThreads = true);
+
     //=========================================================================================================
     /**
     * Calculates the power spectral density of given tapered spectrum
@@ -117,6 +151,22 @@ public:
                                                     int iNfft,
                                                     double dSampFreq=1.0);
 
+    //=========================================================================================================
+    /**
+    * Calculates the power spectral densities of the tapered spectra of all rows
+    *
+    * @param[in] vecTapSpectra     tapered spectra of each row, as returned by computeTaperedSpectraMatrix
+    * @param[in] vecTapWeights     taper weights
+    * @param[in] iNfft             FFT length
+    * @param[in] dSampFreq         sampling frequency of the input data
+    *
+    * @return power spectral densities (rows x frequencies)
+    */
+    static Eigen::MatrixXd psdFromTaperedSpectraMatrix(const QVector<Eigen::MatrixXcd> &vecTapSpectra,
+                                                       const Eigen::VectorXd &vecTapWeights,
+                                                       int iNfft,
+                                                       double dSampFreq=1.0);
+
     //=========================================================================================================
     /**
     * Calculates the cross-spectral density of the tapered spectra of seed and target
@@ -150,7 +200,7 @@ public:
 
     //=========================================================================================================
     /**
-    * Calculates a hanning window of given length
+    * Calculates a hanning window of given length. The tapers are cached per length and window type.
     *
     * @param[in] iSignalLength    length of the hanning window
     * @param[in] sWindowType      type of the window function used to compute tapered spectra
@@ -79,7 +79,7 @@ VectorXd Spectrogram::gauss_window (qint32 sample_count, qreal scale, quint32 tr
 
 //*************************************************************************************************************
 
-MatrixXd Spectrogram::make_spectrogram(VectorXd signal, qint32 window_size = 0)
+MatrixXd Spectrogram::make_spectrogram(const VectorXd &signal, qint32 window_size = 0)
 {
     if(window_size == 0)
         window_size = signal.rows()/4;
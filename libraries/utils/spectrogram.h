@@ -83,7 +83,7 @@ public:
     *
     * @return spectrogram-matrix (tf-representation of the input signal)
     */
-    static MatrixXd make_spectrogram(VectorXd signal, qint32 window_size);
+    static MatrixXd make_spectrogram(const VectorXd &signal, qint32 window_size);
 
 private:
 
@@ -193,17 +193,15 @@ bool Sphere::fit_sphere_to_points(const MatrixXf &rr, float simplex_size, Vector
 
     user.report = false;
 
-    for (int k = 0; k < 4; k++) {
-        init_vals[k] = fit_eval( static_cast<VectorXf>(init_simplex.row(k)), &user );
-    }
+    fit_eval_batch(init_simplex, init_vals, &user);
 
     user.report = false;
 
-    //Start the minimization
-    if(!SimplexAlgorithm::simplex_minimize<float>(  init_simplex,   /* The initial simplex */
+    //Start the minimization, the candidate vertices of each step are evaluated together
+    if(!SimplexAlgorithm::simplex_minimize_batch<float>(init_simplex,   /* The initial simplex */
                                                     init_vals,      /* Function values at the vertices */
                                                     ftol,           /* Relative convergence tolerance */
-                                                    fit_eval,       /* The function to be evaluated */
+                                                    fit_eval_batch, /* The function to be evaluated */
                                                     &user,          /* Data to be passed to the above function in each evaluation */
                                                     max_eval,       /* Maximum number of function evaluations */
                                                     neval,          /* Number of function evaluations */
@@ -292,6 +290,31 @@ float Sphere::fit_eval(const VectorXf &fitpar, const void  *user_data)
 }
 
 
+//*************************************************************************************************************
+
+void Sphere::fit_eval_batch(const MatrixXf &fitpars, VectorXf &fvals, const void  *user_data)
+{
+    /*
+    * The same cost as fit_eval for each row, the points are traversed once per vertex without temporaries
+    */
+    const fitUserNew& user = (fitUserNew)user_data;
+    const MatrixXf& rr = user->rr;
+
+    fvals.resize(fitpars.rows());
+
+    for(int k = 0; k < fitpars.rows(); ++k) {
+        ArrayXf one = ((rr.col(0).array() - fitpars(k,0)).square()
+                       + (rr.col(1).array() - fitpars(k,1)).square()
+                       + (rr.col(2).array() - fitpars(k,2)).square()).sqrt();
+
+        float sum = one.sum();
+        float sum2 = one.matrix().dot(one.matrix());
+
+        fvals[k] = sum2 - sum*sum/rr.rows();
+    }
+}
+
+
 //*************************************************************************************************************
 
 float Sphere::opt_rad(const VectorXf &r0,const fitUserNew user)
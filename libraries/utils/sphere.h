@@ -178,6 +178,16 @@ private:
     */
     static float fit_eval(const Eigen::VectorXf &fitpar, const void  *user_data);
 
+    //=========================================================================================================
+    /**
+    * The vectorized simplex cost function, evaluates several vertices in one pass
+    *
+    * @param[in] fitpars    The simplex vertices to evaluate, one per row.
+    * @param[out] fvals     The distance (cost) of each vertex (sphere center).
+    * @param[in] user_data  The user data containing the n x 3 matrix of cartesian data
+    */
+    static void fit_eval_batch(const Eigen::MatrixXf &fitpars, Eigen::VectorXf &fvals, const void  *user_data);
+
     //=========================================================================================================
     /**
     * The report function, called to rpeort the optimization status
@@ -0,0 +1,174 @@
+//=============================================================================================================
+/**
+* @file     streamingspectrogram.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+* @brief    Definition of the StreamingSpectrogram class.
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "streamingspectrogram.h"
+#include "math.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+StreamingSpectrogram::StreamingSpectrogram(qint32 iChannels,
+                                           qint32 iFrameLength,
+                                           qint32 iHop,
+                                           qint32 iRingSize,
+                                           double dWindowScale)
+: m_iChannels(qMax(1, iChannels))
+, m_iFrameLength(qMax(2, iFrameLength))
+, m_iHop(qMax(1, iHop))
+, m_iRingSize(qMax(1, iRingSize))
+, m_iBins(m_iFrameLength/2)
+, m_iBuffered(0)
+, m_iSkip(0)
+, m_iTotalFrames(0)
+{
+    if(dWindowScale <= 0)
+        dWindowScale = m_iFrameLength/4;
+
+    //Same gaussian as Spectrogram::gauss_window, centered in the frame
+    m_vecWindow.resize(m_iFrameLength);
+    for(qint32 n = 0; n < m_iFrameLength; ++n) {
+        double t = (double(n) - m_iFrameLength/2) / dWindowScale;
+        m_vecWindow[n] = exp(-3.14 * pow(t, 2)) * pow(sqrt(dWindowScale), -1) * pow(2.0, 0.25);
+    }
+
+    m_fft.SetFlag(m_fft.HalfSpectrum);
+    m_vecTime = RowVectorXd::Zero(m_iFrameLength);
+    m_vecFreq = RowVectorXcd::Zero(m_iFrameLength/2 + 1);
+    m_matBuffer = MatrixXd::Zero(m_iChannels, m_iFrameLength);
+
+    for(qint32 c = 0; c < m_iChannels; ++c)
+        m_vecRings.append(MatrixXd::Zero(m_iBins, m_iRingSize));
+}
+
+
+//*************************************************************************************************************
+
+void StreamingSpectrogram::reset()
+{
+    m_iBuffered = 0;
+    m_iSkip = 0;
+    m_iTotalFrames = 0;
+
+    for(qint32 c = 0; c < m_iChannels; ++c)
+        m_vecRings[c].setZero();
+}
+
+
+//*************************************************************************************************************
+
+qint32 StreamingSpectrogram::append(const MatrixXd& matSamples)
+{
+    if(matSamples.rows() != m_iChannels) {
+        printf("StreamingSpectrogram::append - %d rows were given, %d channels expected.\n", int(matSamples.rows()), m_iChannels);
+        return 0;
+    }
+
+    qint32 iNewFrames = 0;
+    qint32 iPos = 0;
+
+    while(iPos < matSamples.cols()) {
+        //A hop longer than the frame skips the samples between two frames
+        if(m_iSkip > 0) {
+            qint32 iSkipped = qMin(m_iSkip, qint32(matSamples.cols()) - iPos);
+            m_iSkip -= iSkipped;
+            iPos += iSkipped;
+            continue;
+        }
+
+        qint32 iCopy = qMin(m_iFrameLength - m_iBuffered, qint32(matSamples.cols()) - iPos);
+        m_matBuffer.middleCols(m_iBuffered, iCopy) = matSamples.middleCols(iPos, iCopy);
+        m_iBuffered += iCopy;
+        iPos += iCopy;
+
+        if(m_iBuffered < m_iFrameLength)
+            break;
+
+        //Power spectrum of the complete frame into the next ring column
+        qint32 iColumn = ringIndex(m_iTotalFrames);
+        for(qint32 c = 0; c < m_iChannels; ++c) {
+            m_vecTime = m_matBuffer.row(c).cwiseProduct(m_vecWindow);
+            m_fft.fwd(m_vecFreq, m_vecTime);
+            m_vecRings[c].col(iColumn) = m_vecFreq.head(m_iBins).cwiseAbs2().transpose();
+        }
+
+        ++m_iTotalFrames;
+        ++iNewFrames;
+
+        //Keep the overlap with the next frame
+        if(m_iHop < m_iFrameLength) {
+            qint32 iKeep = m_iFrameLength - m_iHop;
+            for(qint32 s = 0; s < iKeep; ++s)
+                m_matBuffer.col(s) = m_matBuffer.col(s + m_iHop);
+            m_iBuffered = iKeep;
+        } else {
+            m_iBuffered = 0;
+            m_iSkip = m_iHop - m_iFrameLength;
+        }
+    }
+
+    return iNewFrames;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd StreamingSpectrogram::spectrogram(qint32 iChannel) const
+{
+    if(iChannel < 0 || iChannel >= m_iChannels)
+        return MatrixXd();
+
+    qint32 iFrames = frameCount();
+    MatrixXd tf_matrix(m_iBins, iFrames);
+
+    for(qint32 f = 0; f < iFrames; ++f)
+        tf_matrix.col(f) = m_vecRings[iChannel].col(ringIndex(m_iTotalFrames - iFrames + f));
+
+    return tf_matrix;
+}
@@ -0,0 +1,233 @@
+//=============================================================================================================
+/**
+* @file     streamingspectrogram.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+* @brief    Declaration of the StreamingSpectrogram class.
+*/
+
+#ifndef STREAMINGSPECTROGRAM_H
+#define STREAMINGSPECTROGRAM_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+* Short-time power spectra of a multi channel stream. Appended samples are buffered until a frame is complete,
+* every hop samples a frame is windowed with a gaussian window, transformed with the retained FFT object and its
+* power spectrum is written to a ring of frequency frames. Only frames of new samples are computed.
+*
+* @brief Streaming short-time spectrogram.
+*/
+class UTILSSHARED_EXPORT StreamingSpectrogram
+{
+
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a StreamingSpectrogram.
+    *
+    * @param[in] iChannels          number of channels.
+    * @param[in] iFrameLength       number of samples per frame, which is also the FFT length.
+    * @param[in] iHop               number of samples between the starts of two frames.
+    * @param[in] iRingSize          number of frames kept in the ring.
+    * @param[in] dWindowScale       width of the gaussian window, 0 uses a quarter of the frame length as
+    *                               Spectrogram::make_spectrogram does for the signal length.
+    */
+    StreamingSpectrogram(qint32 iChannels,
+                         qint32 iFrameLength,
+                         qint32 iHop = 1,
+                         qint32 iRingSize = 512,
+                         double dWindowScale = 0);
+
+    //=========================================================================================================
+    /**
+    * Drops the buffered samples and all frames.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Appends samples and computes the frames which are completed by them.
+    *
+    * @param[in] matSamples     the new samples (channels x samples).
+    *
+    * @return the number of new frames.
+    */
+    qint32 append(const Eigen::MatrixXd& matSamples);
+
+    //=========================================================================================================
+    /**
+    * Returns the spectrogram of a channel with the frames in the ring from the oldest to the newest.
+    *
+    * @param[in] iChannel       the channel.
+    *
+    * @return spectrogram-matrix (frequencies x frames).
+    */
+    Eigen::MatrixXd spectrogram(qint32 iChannel) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the ring of frequency frames of a channel. Column ringIndex(i) holds the frame i of the stream.
+    *
+    * @param[in] iChannel       the channel.
+    *
+    * @return the ring (frequencies x ring size).
+    */
+    inline const Eigen::MatrixXd& ring(qint32 iChannel) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the ring column of a frame, the frame has to be one of the last frameCount() frames.
+    *
+    * @param[in] iFrame         the frame number counted from the start of the stream.
+    *
+    * @return the ring column.
+    */
+    inline qint32 ringIndex(qint64 iFrame) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of frames held by the ring.
+    *
+    * @return the number of frames in the ring.
+    */
+    inline qint32 frameCount() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of frames computed since the start of the stream.
+    *
+    * @return the number of computed frames.
+    */
+    inline qint64 totalFrames() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of frequency bins of a frame, the bins up to half the frame length.
+    *
+    * @return the number of frequency bins.
+    */
+    inline qint32 binCount() const;
+
+private:
+    qint32                                  m_iChannels;        /**< Number of channels. */
+    qint32                                  m_iFrameLength;     /**< Samples per frame and FFT length. */
+    qint32                                  m_iHop;             /**< Samples between two frame starts. */
+    qint32                                  m_iRingSize;        /**< Number of frames in the ring. */
+    qint32                                  m_iBins;            /**< Frequency bins per frame. */
+
+    Eigen::FFT<double>                      m_fft;              /**< FFT object, keeps its plan for the frame length. */
+    Eigen::RowVectorXd                      m_vecWindow;        /**< The gaussian window. */
+    Eigen::RowVectorXd                      m_vecTime;          /**< Windowed frame of one channel. */
+    Eigen::RowVectorXcd                     m_vecFreq;          /**< Spectrum of one channel. */
+
+    Eigen::MatrixXd                         m_matBuffer;        /**< Samples of the next frame (channels x samples). */
+    qint32                                  m_iBuffered;        /**< Number of buffered samples. */
+    qint32                                  m_iSkip;            /**< Samples to drop before the next frame starts, if the hop exceeds the frame length. */
+
+    QVector<Eigen::MatrixXd>                m_vecRings;         /**< Ring of frequency frames per channel. */
+    qint64                                  m_iTotalFrames;     /**< Number of frames computed so far. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline const Eigen::MatrixXd& StreamingSpectrogram::ring(qint32 iChannel) const
+{
+    return m_vecRings[iChannel];
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 StreamingSpectrogram::ringIndex(qint64 iFrame) const
+{
+    return qint32(iFrame % m_iRingSize);
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 StreamingSpectrogram::frameCount() const
+{
+    return qint32(qMin(m_iTotalFrames, qint64(m_iRingSize)));
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 StreamingSpectrogram::totalFrames() const
+{
+    return m_iTotalFrames;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 StreamingSpectrogram::binCount() const
+{
+    return m_iBins;
+}
+
+}//namespace
+
+#endif // STREAMINGSPECTROGRAM_H
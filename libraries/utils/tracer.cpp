@@ -0,0 +1,355 @@
+//=============================================================================================================
+/**
+* @file     tracer.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Tracer definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "tracer.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstdlib>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE LOCAL TYPES AND FUNCTIONS
+//=============================================================================================================
+
+namespace {
+
+//=============================================================================================================
+/**
+* The events of one thread. Only the owning thread writes events and the count.
+*/
+struct TraceThreadBuffer {
+    qint32                      iThreadId;      /**< Sequential id of the thread in the trace. */
+    QString                     sThreadName;    /**< Name of the thread, guarded by the registry mutex. */
+    QVector<Tracer::Event>      vecEvents;      /**< The preallocated event slots. */
+    QAtomicInt                  iCount;         /**< Number of published events. */
+    QAtomicInt                  iGeneration;    /**< The trace the events belong to. */
+    QAtomicInt                  iDropped;       /**< Number of events dropped because the buffer was full. */
+};
+
+
+//=============================================================================================================
+/**
+* The buffers of all threads which recorded an event and the time base.
+*/
+struct TraceRegistry {
+    QMutex                                      mutex;          /**< Guards the buffer list and the thread names. */
+    QList<QSharedPointer<TraceThreadBuffer> >   lBuffers;       /**< The buffers, kept after their thread finished. */
+    QElapsedTimer                               timer;          /**< The time base. */
+    QAtomicInt                                  iGeneration;    /**< Incremented by each start(). */
+    QString                                     sAutoFileName;  /**< The file the trace is written to at exit, from MNE_TRACE_FILE. */
+
+    TraceRegistry()
+    {
+        timer.start();
+    }
+};
+
+
+//*************************************************************************************************************
+
+TraceRegistry& traceRegistry()
+{
+    static TraceRegistry s_registry;
+    return s_registry;
+}
+
+
+//*************************************************************************************************************
+
+thread_local QSharedPointer<TraceThreadBuffer> t_pTraceThreadBuffer;
+
+TraceThreadBuffer* traceThreadBuffer()
+{
+    if(!t_pTraceThreadBuffer) {
+        TraceRegistry& registry = traceRegistry();
+
+        QSharedPointer<TraceThreadBuffer> pBuffer(new TraceThreadBuffer);
+        pBuffer->vecEvents.resize(TRACER_THREAD_BUFFER_SIZE);
+        pBuffer->iGeneration.storeRelease(registry.iGeneration.loadAcquire());
+
+        QThread* pThread = QThread::currentThread();
+        if(pThread && !pThread->objectName().isEmpty()) {
+            pBuffer->sThreadName = pThread->objectName();
+        } else if(QCoreApplication::instance() && pThread == QCoreApplication::instance()->thread()) {
+            pBuffer->sThreadName = QString("Main");
+        }
+
+        QMutexLocker locker(&registry.mutex);
+        pBuffer->iThreadId = registry.lBuffers.size() + 1;
+        if(pBuffer->sThreadName.isEmpty()) {
+            pBuffer->sThreadName = QString("Thread %1").arg(pBuffer->iThreadId);
+        }
+        registry.lBuffers.append(pBuffer);
+
+        t_pTraceThreadBuffer = pBuffer;
+    }
+
+    return t_pTraceThreadBuffer.data();
+}
+
+
+//*************************************************************************************************************
+
+QString jsonEscaped(const char* sText)
+{
+    QString sEscaped = QString::fromUtf8(sText);
+    sEscaped.replace(QChar('\\'), QString("\\\\"));
+    sEscaped.replace(QChar('"'), QString("\\\""));
+    return sEscaped;
+}
+
+
+//*************************************************************************************************************
+
+void writeAutoTrace()
+{
+    Tracer::stop();
+    Tracer::writeChromeTrace(traceRegistry().sAutoFileName);
+}
+
+
+//=============================================================================================================
+/**
+* Starts the tracer when the library is loaded if MNE_TRACE_FILE is set and writes the trace at exit.
+*/
+struct TraceAutoStart {
+    TraceAutoStart()
+    {
+        QString sFileName = QString::fromLocal8Bit(qgetenv("MNE_TRACE_FILE"));
+        if(sFileName.isEmpty()) {
+            return;
+        }
+
+        traceRegistry().sAutoFileName = sFileName;
+        Tracer::start();
+
+        //Registered after the registry was constructed, so it runs before the registry is destroyed
+        std::atexit(writeAutoTrace);
+    }
+};
+
+TraceAutoStart s_traceAutoStart;
+
+} // anonymous namespace
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE STATIC MEMBERS
+//=============================================================================================================
+
+QAtomicInt Tracer::s_iEnabled(0);
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+void Tracer::start()
+{
+    TraceRegistry& registry = traceRegistry();
+    registry.iGeneration.ref();
+    s_iEnabled.storeRelease(1);
+}
+
+
+//*************************************************************************************************************
+
+void Tracer::stop()
+{
+    s_iEnabled.storeRelease(0);
+}
+
+
+//*************************************************************************************************************
+
+qint64 Tracer::now()
+{
+    return traceRegistry().timer.nsecsElapsed();
+}
+
+
+//*************************************************************************************************************
+
+void Tracer::record(const char* sName, const char* sCategory, qint64 iStartNs, qint64 iDurationNs)
+{
+    TraceThreadBuffer* pBuffer = traceThreadBuffer();
+
+    //A new trace was started since the last event of this thread
+    const int iGeneration = traceRegistry().iGeneration.loadAcquire();
+    if(pBuffer->iGeneration.load() != iGeneration) {
+        pBuffer->iCount.storeRelease(0);
+        pBuffer->iDropped.storeRelease(0);
+        pBuffer->iGeneration.storeRelease(iGeneration);
+    }
+
+    const int iCount = pBuffer->iCount.load();
+    if(iCount >= TRACER_THREAD_BUFFER_SIZE) {
+        pBuffer->iDropped.ref();
+        return;
+    }
+
+    Event& event = pBuffer->vecEvents.data()[iCount];
+    event.sName = sName;
+    event.sCategory = sCategory;
+    event.iStartNs = iStartNs;
+    event.iDurationNs = iDurationNs;
+
+    pBuffer->iCount.storeRelease(iCount + 1);
+}
+
+
+//*************************************************************************************************************
+
+void Tracer::setThreadName(const QString& sName)
+{
+    TraceThreadBuffer* pBuffer = traceThreadBuffer();
+
+    QMutexLocker locker(&traceRegistry().mutex);
+    pBuffer->sThreadName = sName;
+}
+
+
+//*************************************************************************************************************
+
+qint64 Tracer::droppedEvents()
+{
+    TraceRegistry& registry = traceRegistry();
+    const int iGeneration = registry.iGeneration.loadAcquire();
+
+    QMutexLocker locker(&registry.mutex);
+
+    qint64 iDropped = 0;
+    for(int i = 0; i < registry.lBuffers.size(); ++i) {
+        if(registry.lBuffers.at(i)->iGeneration.loadAcquire() == iGeneration) {
+            iDropped += registry.lBuffers.at(i)->iDropped.loadAcquire();
+        }
+    }
+
+    return iDropped;
+}
+
+
+//*************************************************************************************************************
+
+bool Tracer::writeChromeTrace(const QString& sFileName)
+{
+    QFile file(sFileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning("Tracer::writeChromeTrace - Could not open %s.", sFileName.toUtf8().constData());
+        return false;
+    }
+
+    TraceRegistry& registry = traceRegistry();
+    const int iGeneration = registry.iGeneration.loadAcquire();
+    const qint64 iPid = QCoreApplication::applicationPid();
+    const qint64 iDropped = droppedEvents();
+
+    QTextStream out(&file);
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    out.setRealNumberPrecision(3);
+
+    out << "{\"traceEvents\":[\n";
+
+    QMutexLocker locker(&registry.mutex);
+
+    bool bFirst = true;
+    for(int i = 0; i < registry.lBuffers.size(); ++i) {
+        const TraceThreadBuffer* pBuffer = registry.lBuffers.at(i).data();
+
+        if(!bFirst) {
+            out << ",\n";
+        }
+        bFirst = false;
+
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << iPid << ",\"tid\":" << pBuffer->iThreadId
+            << ",\"args\":{\"name\":\"" << jsonEscaped(pBuffer->sThreadName.toUtf8().constData()) << "\"}}";
+
+        if(pBuffer->iGeneration.loadAcquire() != iGeneration) {
+            continue;
+        }
+
+        //Timestamps and durations are given in us
+        const int iCount = pBuffer->iCount.loadAcquire();
+        for(int j = 0; j < iCount; ++j) {
+            const Event& event = pBuffer->vecEvents.at(j);
+            out << ",\n{\"name\":\"" << jsonEscaped(event.sName) << "\",\"cat\":\"" << jsonEscaped(event.sCategory)
+                << "\",\"ph\":\"X\",\"ts\":" << event.iStartNs / 1000.0 << ",\"dur\":" << event.iDurationNs / 1000.0
+                << ",\"pid\":" << iPid << ",\"tid\":" << pBuffer->iThreadId << "}";
+        }
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << iDropped << "}}\n";
+
+    return true;
+}
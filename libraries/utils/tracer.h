@@ -0,0 +1,251 @@
+//=============================================================================================================
+/**
+* @file     tracer.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Tracer and ScopedTrace declaration.
+*
+*/
+
+#ifndef TRACER_H
+#define TRACER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInt>
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define TRACER_THREAD_BUFFER_SIZE 65536     /**< Number of events each thread can record until the next start(). */
+
+//=============================================================================================================
+/**
+* Traces the enclosing scope. Only compiled in with MNECPP_CONFIG+=withTracing, which defines MNE_TRACING.
+* name and category have to be string literals or otherwise outlive the export.
+*/
+#ifdef MNE_TRACING
+    #define MNE_TRACE_CONCAT_IMPL(a, b) a##b
+    #define MNE_TRACE_CONCAT(a, b) MNE_TRACE_CONCAT_IMPL(a, b)
+    #define MNE_TRACE_SCOPE(name, category) UTILSLIB::ScopedTrace MNE_TRACE_CONCAT(t_scopedTrace, __LINE__)(name, category)
+#else
+    #define MNE_TRACE_SCOPE(name, category)
+#endif
+
+#define MNE_TRACE_FUNCTION(category) MNE_TRACE_SCOPE(Q_FUNC_INFO, category)
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+
+//=============================================================================================================
+/**
+* Records scoped trace events of all threads and exports them in the Chrome trace event format, which is read
+* by chrome://tracing and ui.perfetto.dev. Each thread writes to its own buffer, which is registered once under
+* a mutex on its first event. Afterwards recording takes no lock: the owning thread fills the next slot and
+* publishes it with a release store of the event count. A full buffer drops further events until the next
+* start(). While the tracer is stopped a trace scope costs one atomic load.
+*
+* Tracing is started by start() or, without any code changes, for a whole run of mne_scan or an example by
+* setting the environment variable MNE_TRACE_FILE to the output file. The trace is then written when the
+* application exits. Since queued signals are delivered on the thread of the receiver, the slots show up on the
+* receiving thread, so the hand-offs between threads can be read off the trace.
+*
+* @brief Lightweight scoped tracing with Chrome trace export.
+*/
+class UTILSSHARED_EXPORT Tracer
+{
+public:
+    //=========================================================================================================
+    /**
+    * A complete event, i.e. a scope with its start and duration.
+    */
+    struct Event {
+        const char* sName;          /**< Name of the event. */
+        const char* sCategory;      /**< Category of the event, e.g. the library. */
+        qint64      iStartNs;       /**< Start since the time base of the tracer in ns. */
+        qint64      iDurationNs;    /**< Duration in ns. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Discards the events of the previous trace and starts recording.
+    */
+    static void start();
+
+    //=========================================================================================================
+    /**
+    * Stops recording. The recorded events are kept until the next start().
+    */
+    static void stop();
+
+    //=========================================================================================================
+    /**
+    * Returns whether events are recorded.
+    *
+    * @return true if the tracer was started, false otherwise.
+    */
+    static inline bool isEnabled();
+
+    //=========================================================================================================
+    /**
+    * Returns the current time since the time base of the tracer.
+    *
+    * @return the time in ns.
+    */
+    static qint64 now();
+
+    //=========================================================================================================
+    /**
+    * Records a complete event on the buffer of the calling thread.
+    *
+    * @param[in] sName          Name of the event.
+    * @param[in] sCategory      Category of the event.
+    * @param[in] iStartNs       Start, see now().
+    * @param[in] iDurationNs    Duration in ns.
+    */
+    static void record(const char* sName, const char* sCategory, qint64 iStartNs, qint64 iDurationNs);
+
+    //=========================================================================================================
+    /**
+    * Sets the name the calling thread is shown with in the trace. Defaults to the object name of the QThread.
+    *
+    * @param[in] sName      The thread name.
+    */
+    static void setThreadName(const QString& sName);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of events dropped because a thread buffer was full.
+    *
+    * @return the number of dropped events since the last start().
+    */
+    static qint64 droppedEvents();
+
+    //=========================================================================================================
+    /**
+    * Writes the events of the current trace in the Chrome trace event format. Should be called after stop(),
+    * events recorded while writing may or may not be part of the file.
+    *
+    * @param[in] sFileName      The output file.
+    *
+    * @return true if the file was written, false otherwise.
+    */
+    static bool writeChromeTrace(const QString& sFileName);
+
+private:
+    static QAtomicInt   s_iEnabled;     /**< Set while events are recorded. */
+};
+
+
+//=============================================================================================================
+/**
+* Records the lifetime of the scope it lives in, use it through MNE_TRACE_SCOPE and MNE_TRACE_FUNCTION.
+*
+* @brief Scoped trace event.
+*/
+class ScopedTrace
+{
+public:
+    //=========================================================================================================
+    /**
+    * Starts the event if the tracer is enabled.
+    *
+    * @param[in] sName      Name of the event.
+    * @param[in] sCategory  Category of the event.
+    */
+    inline ScopedTrace(const char* sName, const char* sCategory);
+
+    //=========================================================================================================
+    /**
+    * Records the event.
+    */
+    inline ~ScopedTrace();
+
+private:
+    const char* m_sName;        /**< Name of the event. */
+    const char* m_sCategory;    /**< Category of the event. */
+    qint64      m_iStartNs;     /**< Start of the event, -1 if the tracer was disabled. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool Tracer::isEnabled()
+{
+    return s_iEnabled.loadAcquire() != 0;
+}
+
+
+//*************************************************************************************************************
+
+inline ScopedTrace::ScopedTrace(const char* sName, const char* sCategory)
+: m_sName(sName)
+, m_sCategory(sCategory)
+, m_iStartNs(Tracer::isEnabled() ? Tracer::now() : -1)
+{
+}
+
+
+//*************************************************************************************************************
+
+inline ScopedTrace::~ScopedTrace()
+{
+    if(m_iStartNs >= 0) {
+        Tracer::record(m_sName, m_sCategory, m_iStartNs, Tracer::now() - m_iStartNs);
+    }
+}
+
+} // NAMESPACE UTILSLIB
+
+#endif // TRACER_H
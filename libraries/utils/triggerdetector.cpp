@@ -0,0 +1,200 @@
+//=============================================================================================================
+/**
+* @file     triggerdetector.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+* @brief    Definition of the TriggerDetector class.
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "triggerdetector.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+TriggerDetector::TriggerDetector(const QList<int>& lTriggerChannels,
+                                 double dThreshold,
+                                 DetectionMode mode,
+                                 bool bRemoveOffset,
+                                 int iBurstLengthSamp,
+                                 int iMaxEvents)
+: m_lTriggerChannels(lTriggerChannels)
+, m_dThreshold(dThreshold)
+, m_mode(mode)
+, m_bRemoveOffset(bRemoveOffset)
+, m_iBurstLengthSamp(qMax(0, iBurstLengthSamp))
+, m_vecEvents(qMax(1, iMaxEvents))
+, m_iEventCount(0)
+, m_bOverflow(false)
+{
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void TriggerDetector::reset()
+{
+    int iChannels = m_lTriggerChannels.size();
+
+    m_iEventCount = 0;
+    m_bOverflow = false;
+    m_iSampleCount = 0;
+    m_iBlockStart = 0;
+
+    m_vecOffset = VectorXd::Zero(iChannels);
+    m_vecLastSample = VectorXd::Zero(iChannels);
+    m_vecLastAbove = Array<bool, Dynamic, 1>::Constant(iChannels, false);
+    m_vecNextAllowed = Matrix<qint64, Dynamic, 1>::Zero(iChannels);
+}
+
+
+//*************************************************************************************************************
+
+void TriggerDetector::setThreshold(double dThreshold)
+{
+    m_dThreshold = dThreshold;
+}
+
+
+//*************************************************************************************************************
+
+int TriggerDetector::detect(const MatrixXd& data)
+{
+    int iChannels = m_lTriggerChannels.size();
+    int iSamples = data.cols();
+
+    m_iEventCount = 0;
+    m_bOverflow = false;
+    m_iBlockStart = m_iSampleCount;
+
+    if(iSamples == 0 || iChannels == 0) {
+        return 0;
+    }
+
+    for(int i = 0; i < iChannels; ++i) {
+        if(m_lTriggerChannels.at(i) < 0 || m_lTriggerChannels.at(i) >= data.rows()) {
+            qWarning() << "TriggerDetector::detect - Trigger channel" << m_lTriggerChannels.at(i) << "is not part of the data with" << data.rows() << "rows.";
+            return 0;
+        }
+    }
+
+    //Gather the trigger channels behind the last sample of the previous block
+    m_matSignal.resize(iChannels, iSamples + 1);
+    for(int i = 0; i < iChannels; ++i) {
+        m_matSignal.row(i).tail(iSamples) = data.row(m_lTriggerChannels.at(i));
+    }
+
+    if(m_iSampleCount == 0) {
+        //The first sample of the stream has no gradient
+        m_vecLastSample = m_matSignal.col(1);
+        m_vecOffset = m_bRemoveOffset ? m_vecLastSample : VectorXd::Zero(iChannels);
+    }
+    m_matSignal.col(0) = m_vecLastSample;
+
+    //Threshold all channels and samples at once
+    switch(m_mode) {
+        case RisingGradientMode:
+            m_matCriterion = m_matSignal.rightCols(iSamples).array() - m_matSignal.leftCols(iSamples).array();
+            break;
+        case FallingGradientMode:
+            m_matCriterion = m_matSignal.leftCols(iSamples).array() - m_matSignal.rightCols(iSamples).array();
+            break;
+        default:
+            m_matCriterion = m_matSignal.rightCols(iSamples).array().colwise() - m_vecOffset.array();
+            break;
+    }
+
+    m_matAbove.resize(iChannels, iSamples + 1);
+    m_matAbove.col(0) = m_vecLastAbove;
+    m_matAbove.rightCols(iSamples) = m_matCriterion >= m_dThreshold;
+
+    m_vecCrossing = (m_matAbove.rightCols(iSamples) && !m_matAbove.leftCols(iSamples)).colwise().any();
+
+    //Visit only the samples with a crossing
+    for(int j = 0; j < iSamples; ++j) {
+        if(!m_vecCrossing(j)) {
+            continue;
+        }
+
+        qint64 iSample = m_iBlockStart + j;
+
+        for(int i = 0; i < iChannels; ++i) {
+            if(!m_matAbove(i, j + 1) || m_matAbove(i, j) || iSample < m_vecNextAllowed(i)) {
+                continue;
+            }
+
+            m_vecNextAllowed(i) = iSample + m_iBurstLengthSamp + 1;
+
+            if(m_iEventCount == m_vecEvents.size()) {
+                m_bOverflow = true;
+                continue;
+            }
+
+            Event& event = m_vecEvents[m_iEventCount++];
+            event.iChannel = m_lTriggerChannels.at(i);
+            event.iSample = iSample;
+            event.dValue = m_mode == LevelMode ? m_matSignal(i, j + 1) : m_matCriterion(i, j);
+        }
+    }
+
+    //Carry the state to the next block
+    m_vecLastSample = m_matSignal.col(iSamples);
+    m_vecLastAbove = m_matAbove.col(iSamples);
+    m_iSampleCount += iSamples;
+
+    if(m_bOverflow) {
+        qWarning() << "TriggerDetector::detect - More than" << m_vecEvents.size() << "events in one block, the surplus events were dropped.";
+    }
+
+    return m_iEventCount;
+}
@@ -0,0 +1,261 @@
+//=============================================================================================================
+/**
+* @file     triggerdetector.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+* @brief    Declaration of the TriggerDetector class.
+*/
+
+#ifndef TRIGGERDETECTOR_H
+#define TRIGGERDETECTOR_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QList>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+* Streaming threshold crossing detection on several trigger channels. All trigger channels of a block are compared
+* with the threshold in one vectorized pass, only the samples with a crossing are visited afterwards. The last sample,
+* the threshold state and the burst hold-off of each channel are carried from block to block, so a flank at a block
+* boundary is found exactly once. The events of a block are written to a preallocated event array.
+*
+* Unlike DetectTrigger, event samples are counted from the first sample of the stream and the level offset is
+* the first sample of the stream, not the first sample of each block. Subtract blockStart() for the index within
+* the last block.
+*
+* @brief Multi channel trigger flank detection on a stream of blocks.
+*/
+class UTILSSHARED_EXPORT TriggerDetector
+{
+
+public:
+    typedef QSharedPointer<TriggerDetector> SPtr;            /**< Shared pointer type for TriggerDetector. */
+    typedef QSharedPointer<const TriggerDetector> ConstSPtr; /**< Const shared pointer type for TriggerDetector. */
+
+    /**
+    * The signal which is compared with the threshold.
+    */
+    enum DetectionMode {
+        LevelMode,                  /**< The signal itself, as DetectTrigger::detectTriggerFlanksMax. */
+        RisingGradientMode,         /**< The gradient, as DetectTrigger::detectTriggerFlanksGrad with "Rising". */
+        FallingGradientMode         /**< The negative gradient, as DetectTrigger::detectTriggerFlanksGrad with "Falling". */
+    };
+
+    /**
+    * A detected trigger flank.
+    */
+    struct Event {
+        int     iChannel;           /**< The row index of the trigger channel in the data. */
+        qint64  iSample;            /**< The sample index counted from the start of the stream. */
+        double  dValue;             /**< The signal value, in the gradient modes the gradient at the flank. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a TriggerDetector.
+    *
+    * @param[in] lTriggerChannels   The row indices of the trigger channels.
+    * @param[in] dThreshold         The threshold a flank has to reach.
+    * @param[in] mode               The signal which is compared with the threshold.
+    * @param[in] bRemoveOffset      In the level mode, subtract the first sample of the stream of each channel.
+    * @param[in] iBurstLengthSamp   The number of samples after a flank in which a channel does not trigger again.
+    * @param[in] iMaxEvents         The size of the event array, i.e. the maximum number of events per block.
+    */
+    TriggerDetector(const QList<int>& lTriggerChannels,
+                    double dThreshold,
+                    DetectionMode mode = LevelMode,
+                    bool bRemoveOffset = false,
+                    int iBurstLengthSamp = 100,
+                    int iMaxEvents = 1024);
+
+    //=========================================================================================================
+    /**
+    * Starts a new stream, the carried state of all channels is dropped.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Sets the threshold, the carried state is kept.
+    *
+    * @param[in] dThreshold         The threshold a flank has to reach.
+    */
+    void setThreshold(double dThreshold);
+
+    //=========================================================================================================
+    /**
+    * Detects the flanks of the next block of the stream.
+    *
+    * @param[in] data               The next block (channels x samples).
+    *
+    * @return The number of events written to the event array. Events are ordered by sample and channel.
+    */
+    int detect(const Eigen::MatrixXd& data);
+
+    //=========================================================================================================
+    /**
+    * Returns an event of the last block.
+    *
+    * @param[in] i                  The event index, below eventCount().
+    *
+    * @return The event.
+    */
+    inline const Event& event(int i) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of events of the last block.
+    *
+    * @return The number of events.
+    */
+    inline int eventCount() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the last block had more events than the event array holds. The surplus events are dropped.
+    *
+    * @return Whether events were dropped.
+    */
+    inline bool overflowed() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the stream index of the first sample of the last block.
+    *
+    * @return The stream index of the first sample of the last block.
+    */
+    inline qint64 blockStart() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the row indices of the trigger channels.
+    *
+    * @return The trigger channels.
+    */
+    inline const QList<int>& triggerChannels() const;
+
+private:
+    QList<int>                                  m_lTriggerChannels;     /**< The row indices of the trigger channels. */
+    double                                      m_dThreshold;           /**< The threshold. */
+    DetectionMode                               m_mode;                 /**< The detection mode. */
+    bool                                        m_bRemoveOffset;        /**< Whether the first sample is subtracted in the level mode. */
+    int                                         m_iBurstLengthSamp;     /**< The hold-off after a flank in samples. */
+
+    QVector<Event>                              m_vecEvents;            /**< The preallocated event array. */
+    int                                         m_iEventCount;          /**< The number of events of the last block. */
+    bool                                        m_bOverflow;            /**< Whether events of the last block were dropped. */
+
+    qint64                                      m_iSampleCount;         /**< The number of samples seen since the start of the stream. */
+    qint64                                      m_iBlockStart;          /**< The stream index of the first sample of the last block. */
+    Eigen::VectorXd                             m_vecOffset;            /**< The first sample of each channel. */
+    Eigen::VectorXd                             m_vecLastSample;        /**< The last sample of each channel. */
+    Eigen::Array<bool, Eigen::Dynamic, 1>       m_vecLastAbove;         /**< Whether the last sample of each channel reached the threshold. */
+    Eigen::Matrix<qint64, Eigen::Dynamic, 1>    m_vecNextAllowed;       /**< The first stream sample at which each channel may trigger again. */
+
+    Eigen::MatrixXd                             m_matSignal;            /**< The trigger channels of a block, preceded by the last sample. */
+    Eigen::ArrayXXd                             m_matCriterion;         /**< The signal compared with the threshold. */
+    Eigen::Array<bool, Eigen::Dynamic, Eigen::Dynamic> m_matAbove;      /**< Whether a sample reached the threshold, preceded by the last state. */
+    Eigen::Array<bool, 1, Eigen::Dynamic>       m_vecCrossing;          /**< Whether any channel crosses the threshold at a sample. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline const TriggerDetector::Event& TriggerDetector::event(int i) const
+{
+    return m_vecEvents[i];
+}
+
+
+//*************************************************************************************************************
+
+inline int TriggerDetector::eventCount() const
+{
+    return m_iEventCount;
+}
+
+
+//*************************************************************************************************************
+
+inline bool TriggerDetector::overflowed() const
+{
+    return m_bOverflow;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 TriggerDetector::blockStart() const
+{
+    return m_iBlockStart;
+}
+
+
+//*************************************************************************************************************
+
+inline const QList<int>& TriggerDetector::triggerChannels() const
+{
+    return m_lTriggerChannels;
+}
+
+} // NAMESPACE
+
+#endif // TRIGGERDETECTOR_H
@@ -74,14 +74,29 @@ SOURCES += \
     filterTools/parksmcclellan.cpp \
     filterTools/filterdata.cpp \
     filterTools/filterio.cpp \
+    filterTools/iirfilter.cpp \
+    filterTools/biquadcascade.cpp \
+    filterTools/fftfilterbatch.cpp \
     detecttrigger.cpp \
+    triggerdetector.cpp \
     spectrogram.cpp \
+    streamingspectrogram.cpp \
+    wavelettfr.cpp \
     warp.cpp \
     filterTools/sphara.cpp \
     sphere.cpp \
+    tracer.cpp \
+    executionconfig.cpp \
+    cachelocation.cpp \
+    cachefile.cpp \
+    linalg.cpp \
+    blockarena.cpp \
+    ica.cpp \
     generics/buffer.cpp \
     generics/circularbuffer.cpp \
     generics/circularmatrixbuffer.cpp \
+    generics/lockfreematrixbuffer.cpp \
+    generics/lockfreering.cpp \
     generics/observerpattern.cpp \
     spectral.cpp
 
@@ -102,16 +117,31 @@ HEADERS += \
     filterTools/parksmcclellan.h \
     filterTools/filterdata.h \
     filterTools/filterio.h \
+    filterTools/iirfilter.h \
+    filterTools/biquadcascade.h \
+    filterTools/fftfilterbatch.h \
     detecttrigger.h \
+    triggerdetector.h \
     spectrogram.h \
+    streamingspectrogram.h \
+    wavelettfr.h \
     warp.h \
     filterTools/sphara.h \
     sphere.h \
+    tracer.h \
+    executionconfig.h \
+    cachelocation.h \
+    cachefile.h \
+    linalg.h \
+    blockarena.h \
+    ica.h \
     simplex_algorithm.h \
     generics/buffer.h \
     generics/circularbuffer.h \
     generics/circularbuffer_old.h \
     generics/circularmatrixbuffer.h \
+    generics/lockfreematrixbuffer.h \
+    generics/lockfreering.h \
     generics/circularmultichannelbuffer_old.h \
     generics/commandpattern.h \
     generics/observerpattern.h \
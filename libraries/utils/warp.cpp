@@ -63,6 +63,8 @@
 #include <QDebug>
 #include <QFile>
 #include <QList>
+#include <QPair>
+#include <QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -73,6 +75,14 @@
 using namespace UTILSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define WARP_BLOCK_ROWS 1024    /**< Vertices per parallel block of the warp evaluation. */
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -102,34 +112,72 @@ void Warp::calculate(const MatrixXf & sLm, const MatrixXf &dLm, QList<MatrixXf>
 
 //*************************************************************************************************************
 
+QList<MatrixXf> Warp::calculate(const MatrixXf & sLm, const QList<MatrixXf> &dLmList, const MatrixXf & sVert)
+{
+    QList<MatrixXf> wVertList;
+
+    if(dLmList.isEmpty())
+        return wVertList;
+
+    MatrixXf dLm(sLm.rows(), 3*dLmList.size());
+    for (int i=0; i<dLmList.size(); i++)
+    {
+        if(dLmList.at(i).rows() != sLm.rows() || dLmList.at(i).cols() != 3)
+        {
+            qWarning() << "Warp::calculate - Destination landmarks" << i << "do not match the source landmarks.";
+            return wVertList;
+        }
+        dLm.middleCols(3*i,3) = dLmList.at(i);
+    }
+
+    MatrixXf warpWeight, polWeight;
+    calcWeighting(sLm, dLm, warpWeight, polWeight);
+    MatrixXf wVert = warpVertices(sVert, sLm, warpWeight, polWeight);
+
+    for (int i=0; i<dLmList.size(); i++)
+        wVertList.append(wVert.middleCols(3*i,3));
+
+    return wVertList;
+}
+
+//*************************************************************************************************************
+
 bool Warp::calcWeighting(const MatrixXf &sLm, const MatrixXf &dLm, MatrixXf& warpWeight, MatrixXf& polWeight)
 {
-    MatrixXf K = MatrixXf::Zero(sLm.rows(),sLm.rows());     //K(i,j)=||sLm(i)-sLm(j)||
-    for (int i=0; i<sLm.rows(); i++)
-        K.col(i)=((sLm.rowwise()-sLm.row(i)).rowwise().norm());
+    //
+    // L only depends on the source landmarks, repeated warps with the same ones reuse its factorization
+    //
+    if (sLm.rows() != m_matSLm.rows() || sLm.cols() != m_matSLm.cols() || sLm != m_matSLm)
+    {
+        MatrixXf K = MatrixXf::Zero(sLm.rows(),sLm.rows()); //K(i,j)=||sLm(i)-sLm(j)||
+        for (int i=0; i<sLm.rows(); i++)
+            K.col(i)=((sLm.rowwise()-sLm.row(i)).rowwise().norm());
+
+//        std::cout << "Here is the matrix K:" << std::endl << K << std::endl;
 
-//    std::cout << "Here is the matrix K:" << std::endl << K << std::endl;
+        MatrixXf P (sLm.rows(),4);                          //P=[ones,sLm]
+        P << MatrixXf::Ones(sLm.rows(),1),sLm;
+//        std::cout << "Here is the matrix P:" << std::endl << P << std::endl;
 
-    MatrixXf P (sLm.rows(),4);                              //P=[ones,sLm]
-    P << MatrixXf::Ones(sLm.rows(),1),sLm;
-//    std::cout << "Here is the matrix P:" << std::endl << P << std::endl;
+        MatrixXf L ((sLm.rows()+4),(sLm.rows()+4));         //L=Full Matrix of the linear eq.
+        L <<    K,P,
+                P.transpose(),MatrixXf::Zero(4,4);
+//        std::cout << "Here is the matrix L:" << std::endl << L << std::endl;
 
-    MatrixXf L ((sLm.rows()+4),(sLm.rows()+4));             //L=Full Matrix of the linear eq.
-    L <<    K,P,
-            P.transpose(),MatrixXf::Zero(4,4);
-//    std::cout << "Here is the matrix L:" << std::endl << L << std::endl;
+        m_luL.compute(L);                                   //LU decomposition is one method to solve lin. eq.
+        m_matSLm = sLm;
+    }
 
-    MatrixXf Y ((dLm.rows()+4),3);                          //Y=[dLm,Zero]
+    MatrixXf Y ((dLm.rows()+4),dLm.cols());                 //Y=[dLm,Zero]
     Y <<    dLm,
-            MatrixXf::Zero(4,3);
+            MatrixXf::Zero(4,dLm.cols());
 //    std::cout << "Here is the matrix Y:" << std::endl << Y << std::endl;
 
     //
     // calculate the weighting matrix (Y=L*W)
     //
-    MatrixXf W ((dLm.rows()+4),3);                          //W=[warpWeight,polWeight]
-    Eigen::FullPivLU <MatrixXf> Lu(L);                      //LU decomposition is one method to solve lin. eq.
-    W=Lu.solve(Y);
+    MatrixXf W ((dLm.rows()+4),dLm.cols());                 //W=[warpWeight,polWeight]
+    W=m_luL.solve(Y);
 //    std::cout << "Here is the matrix W:" << std::endl << W << std::endl;
 
     warpWeight = W.topRows(sLm.rows());
@@ -143,18 +191,37 @@ bool Warp::calcWeighting(const MatrixXf &sLm, const MatrixXf &dLm, MatrixXf& war
 
 MatrixXf Warp::warpVertices(const MatrixXf &sVert, const MatrixXf & sLm, const MatrixXf& warpWeight, const MatrixXf& polWeight)
 {
-    MatrixXf wVert = sVert * polWeight.bottomRows(3);         //Pol. Warp
-    wVert.rowwise() += polWeight.row(0);                      //Translation
+    MatrixXf wVert(sVert.rows(), warpWeight.cols());
 
     //
-    // TPS Warp
+    // Every block of rows is warped on its own, the blocks write disjoint rows of wVert
     //
-    MatrixXf K = MatrixXf::Zero(sVert.rows(),sLm.rows());     //K(i,j)=||sLm(i)-sLm(j)||
-    for (int i=0; i<sVert.rows(); i++)
-        K.row(i)=((sLm.rowwise()-sVert.row(i)).rowwise().norm().transpose());
-//    std::cout << "Here is the matrix K:" << std::endl << K << std::endl;
+    auto warpBlock = [&](const QPair<int,int>& block) {
+        const MatrixXf vert = sVert.middleRows(block.first, block.second);
+
+        MatrixXf wBlock = vert * polWeight.bottomRows(3);     //Pol. Warp
+        wBlock.rowwise() += polWeight.row(0);                 //Translation
+
+        //
+        // TPS Warp
+        //
+        MatrixXf K(vert.rows(),sLm.rows());                   //K(i,j)=||sVert(i)-sLm(j)||
+        for (int j=0; j<sLm.rows(); j++)
+            K.col(j)=((vert.rowwise()-sLm.row(j)).rowwise().norm());
+
+        wBlock.noalias() += K*warpWeight;
+        wVert.middleRows(block.first, block.second) = wBlock;
+    };
+
+    QList<QPair<int,int> > blocks;
+    for (int i=0; i<sVert.rows(); i+=WARP_BLOCK_ROWS)
+        blocks.append(qMakePair(i, qMin(WARP_BLOCK_ROWS, static_cast<int>(sVert.rows())-i)));
+
+    if (blocks.size() > 1)
+        QtConcurrent::blockingMap(blocks, warpBlock);
+    else if (blocks.size() == 1)
+        warpBlock(blocks.first());
 
-    wVert += K*warpWeight;
 //    std::cout << "Here is the matrix wVert:" << std::endl << wVert << std::endl;
     return wVert;
 }
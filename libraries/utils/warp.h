@@ -50,6 +50,7 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <Eigen/LU>
 
 
 //*************************************************************************************************************
@@ -117,6 +118,20 @@ public:
     */
     void calculate(const MatrixXf & sLm, const MatrixXf &dLm, QList<MatrixXf> & vertList);
 
+    //=========================================================================================================
+    /**
+    * Calculates the TPS Warps of one source geometry to several destinations at once, e.g. a template head to
+    * the digitizer points of several recordings. The weights of all destinations are solved with one
+    * factorization and the vertices are evaluated in a single pass.
+    *
+    * @param[in]  sLm       3D Landmarks of the source geometry
+    * @param[in]  dLmList   3D Landmarks of the destination geometries, each with the rows of sLm
+    * @param[in]  sVert     Vertices of the source geometry
+    *
+    * @return List of the warped vertices, one per destination
+    */
+    QList<MatrixXf> calculate(const MatrixXf & sLm, const QList<MatrixXf> &dLmList, const MatrixXf & sVert);
+
     //=========================================================================================================
     /**
     * Read electrode positions from MRI Database
@@ -131,10 +146,11 @@ private:
 
     //=========================================================================================================
     /**
-    * Calculate the weighting parameters.
+    * Calculate the weighting parameters. The factorization of the linear system only depends on the source
+    * landmarks and is reused as long as they do not change.
     *
     * @param[in]  sLm      3D Landmarks of the source geometry
-    * @param[in]  dLm      3D Landmarks of the destination geometry
+    * @param[in]  dLm      3D Landmarks of the destination geometry, several destinations side by side
     * @param[out] warpWeight Weighting parameters of the tps warp
     * @param[out] polWeight  Weighting papameters of the polynomial warp
     */
@@ -142,7 +158,8 @@ private:
 
     //=========================================================================================================
     /**
-    * Warp the Vertices of the source geometry
+    * Warp the Vertices of the source geometry. Large vertex sets are evaluated in parallel blocks of rows, which
+    * also bounds the size of the kernel matrix.
     *
     * @param[in]  sVert    Vertices of the source geometry
     * @param[in]  sLm      3D Landmarks of the source geometry
@@ -153,6 +170,8 @@ private:
     */
     MatrixXf warpVertices(const MatrixXf & sVert, const MatrixXf & sLm, const MatrixXf& warpWeight, const MatrixXf& polWeight);
 
+    MatrixXf            m_matSLm;   /**< Source landmarks of the cached factorization. */
+    FullPivLU<MatrixXf> m_luL;      /**< LU factorization of the linear equation of m_matSLm. */
 };
 
 } // NAMESPACE
@@ -0,0 +1,572 @@
+//=============================================================================================================
+/**
+* @file     wavelettfr.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the WaveletTfr class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "wavelettfr.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Eigenvalues>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtMath>
+#include <QtConcurrent>
+#include <QMutex>
+#include <QMap>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+#define TFR_EPOCH_BATCH     32      /**< Epochs whose spectra are held at a time. */
+
+/**
+* Solves the tridiagonal system (T - shift*I) x = b with partial pivoting, as LAPACK dgtsv does. Zero pivots are
+* replaced by a tiny value, so shifts at eigenvalues can be used for inverse iteration.
+*/
+VectorXd solveTridiagonal(const VectorXd& vecDiag, const VectorXd& vecOffDiag, double dShift, VectorXd vecB)
+{
+    const int n = vecDiag.size();
+    const double dTiny = 1e-14 * qMax(1.0, vecDiag.cwiseAbs().maxCoeff());
+
+    VectorXd d = vecDiag.array() - dShift;
+    VectorXd dl = vecOffDiag;
+    VectorXd du = vecOffDiag;
+    VectorXd du2 = VectorXd::Zero(qMax(0, n - 2));
+
+    for(int i = 0; i < n - 1; ++i) {
+        if(qAbs(d(i)) >= qAbs(dl(i))) {
+            if(d(i) == 0.0)
+                d(i) = dTiny;
+            double fact = dl(i) / d(i);
+            d(i+1) -= fact * du(i);
+            vecB(i+1) -= fact * vecB(i);
+        } else {
+            double fact = d(i) / dl(i);
+            d(i) = dl(i);
+            double temp = d(i+1);
+            d(i+1) = du(i) - fact * temp;
+            if(i < n - 2) {
+                du2(i) = du(i+1);
+                du(i+1) = -fact * du2(i);
+            }
+            du(i) = temp;
+            temp = vecB(i);
+            vecB(i) = vecB(i+1);
+            vecB(i+1) = temp - fact * vecB(i+1);
+        }
+    }
+    if(d(n-1) == 0.0)
+        d(n-1) = dTiny;
+
+    vecB(n-1) /= d(n-1);
+    if(n > 1)
+        vecB(n-2) = (vecB(n-2) - du(n-2) * vecB(n-1)) / d(n-2);
+    for(int i = n - 3; i >= 0; --i)
+        vecB(i) = (vecB(i) - du(i) * vecB(i+1) - du2(i) * vecB(i+2)) / d(i);
+
+    return vecB;
+}
+
+/**
+* Places a wavelet centered on sample 0 of the FFT buffer, negative times wrap around to its end.
+*/
+void centerWavelet(const RowVectorXcd& vecWavelet, int iNfft, VectorXcd& vecBuffer)
+{
+    vecBuffer = VectorXcd::Zero(iNfft);
+    const int iCenter = vecWavelet.size() / 2;
+    for(int i = 0; i < vecWavelet.size(); ++i)
+        vecBuffer(((i - iCenter) % iNfft + iNfft) % iNfft) = vecWavelet(i);
+}
+
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+WaveletTfr::WaveletTfr()
+: m_iSamples(0)
+, m_iNfft(0)
+, m_iTapers(1)
+, m_iOrientations(1)
+, m_iEpochs(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+bool WaveletTfr::prepare(const VectorXd& vecFreqs, double dSFreq, int iSamples, Method method, double dCycles, double dTimeBandwidth)
+{
+    if(vecFreqs.size() == 0 || vecFreqs.minCoeff() <= 0.0 || vecFreqs.maxCoeff() >= dSFreq / 2.0 || iSamples <= 0 || dCycles <= 0.0) {
+        qWarning() << "WaveletTfr::prepare - Invalid parameters";
+        return false;
+    }
+
+    int iTapers = method == Multitaper ? int(qFloor(dTimeBandwidth - 1.0)) : 1;
+    if(iTapers < 1) {
+        qWarning() << "WaveletTfr::prepare - The time-bandwidth product has to be at least 2";
+        return false;
+    }
+
+    m_vecFreqs = vecFreqs;
+    m_iSamples = iSamples;
+    m_iTapers = iTapers;
+
+    //
+    // The wavelet spectra only depend on the parameters, engines with the same ones share them
+    //
+    static QMutex mutex;
+    static QMap<QString, QPair<MatrixXcd, int> > mapSpectra;
+
+    QString sKey = QString("%1 %2 %3 %4 %5").arg(dSFreq, 0, 'g', 17).arg(iSamples).arg(int(method)).arg(dCycles, 0, 'g', 17).arg(dTimeBandwidth, 0, 'g', 17);
+    for(int f = 0; f < vecFreqs.size(); ++f)
+        sKey += QString(" %1").arg(vecFreqs(f), 0, 'g', 17);
+
+    QMutexLocker locker(&mutex);
+    if(mapSpectra.contains(sKey)) {
+        m_matWaveletSpectra = mapSpectra.value(sKey).first;
+        m_iNfft = mapSpectra.value(sKey).second;
+        reset();
+        return true;
+    }
+
+    QList<RowVectorXcd> lWavelets;
+    int iMaxLength = 0;
+    for(int f = 0; f < vecFreqs.size(); ++f) {
+        double dFreq = vecFreqs(f);
+
+        if(method == Morlet) {
+            //Gaussian of sigma_t = cycles/(2*pi*f), cut at 5 sigma on both sides
+            double dSigma = dCycles / (2.0 * M_PI * dFreq);
+            int iHalf = int(qCeil(5.0 * dSigma * dSFreq)) - 1;
+            RowVectorXcd vecWavelet(2 * iHalf + 1);
+            for(int i = -iHalf; i <= iHalf; ++i) {
+                double t = i / dSFreq;
+                vecWavelet(i + iHalf) = std::polar(qExp(-t * t / (2.0 * dSigma * dSigma)), 2.0 * M_PI * dFreq * t);
+            }
+            vecWavelet /= qSqrt(0.5) * vecWavelet.norm();
+            lWavelets.append(vecWavelet);
+        } else {
+            //Tapers spanning the cycles, each one with the oscillation referenced to its center
+            int iLength = qMax(2, int(dCycles / dFreq * dSFreq));
+            MatrixXd matTapers = dpss(iLength, dTimeBandwidth / 2.0, iTapers);
+            for(int k = 0; k < iTapers; ++k) {
+                RowVectorXcd vecWavelet(iLength);
+                for(int i = 0; i < iLength; ++i) {
+                    double t = (i - iLength / 2) / dSFreq;
+                    vecWavelet(i) = std::polar(matTapers(k, i), 2.0 * M_PI * dFreq * t);
+                }
+                vecWavelet /= qSqrt(0.5) * vecWavelet.norm();
+                lWavelets.append(vecWavelet);
+            }
+        }
+        iMaxLength = qMax(iMaxLength, int(lWavelets.last().size()));
+    }
+
+    //Linear, not circular convolution of the epoch with the longest wavelet
+    m_iNfft = 1;
+    while(m_iNfft < iSamples + iMaxLength - 1)
+        m_iNfft *= 2;
+
+    FFT<double> fft;
+    m_matWaveletSpectra.resize(m_iNfft, lWavelets.size());
+    VectorXcd vecBuffer, vecSpectrum;
+    for(int w = 0; w < lWavelets.size(); ++w) {
+        centerWavelet(lWavelets[w], m_iNfft, vecBuffer);
+        fft.fwd(vecSpectrum, vecBuffer);
+        m_matWaveletSpectra.col(w) = vecSpectrum;
+    }
+
+    //Only a few parameter sets are in use at a time
+    if(mapSpectra.size() >= 16)
+        mapSpectra.clear();
+    mapSpectra.insert(sKey, qMakePair(m_matWaveletSpectra, m_iNfft));
+
+    reset();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void WaveletTfr::setProjection(const MatrixXd& matKernel, int iOrientations, const VectorXd& vecScale)
+{
+    m_matKernel = matKernel;
+    m_iOrientations = qMax(1, iOrientations);
+    m_vecScale = vecScale;
+
+    if(m_matKernel.rows() % m_iOrientations != 0 || (m_vecScale.size() > 0 && m_vecScale.size() != m_matKernel.rows() / m_iOrientations)) {
+        qWarning() << "WaveletTfr::setProjection - The kernel rows do not match the orientations or the scale";
+        m_matKernel.resize(0, 0);
+        m_iOrientations = 1;
+        m_vecScale.resize(0);
+    }
+
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void WaveletTfr::clearProjection()
+{
+    m_matKernel.resize(0, 0);
+    m_iOrientations = 1;
+    m_vecScale.resize(0);
+
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void WaveletTfr::reset()
+{
+    m_iEpochs = 0;
+    m_vecPowerSum.clear();
+    m_vecPhaseSum.clear();
+
+    if(m_matKernel.size() > 0)
+        allocate(m_matKernel.rows());
+}
+
+
+//*************************************************************************************************************
+
+QVector<MatrixXcd> WaveletTfr::transform(const MatrixXd& matEpoch) const
+{
+    QVector<MatrixXcd> vecCoeffs;
+
+    if(m_iNfft == 0 || matEpoch.cols() != m_iSamples || (m_matKernel.size() > 0 && matEpoch.rows() != m_matKernel.cols())) {
+        qWarning() << "WaveletTfr::transform - The epoch does not match the prepared engine";
+        return vecCoeffs;
+    }
+
+    MatrixXcd matSpectra = epochSpectra(matEpoch);
+
+    vecCoeffs.resize(m_matWaveletSpectra.cols());
+    QVector<int> vecWavelets(m_matWaveletSpectra.cols());
+    for(int w = 0; w < vecWavelets.size(); ++w)
+        vecWavelets[w] = w;
+
+    QtConcurrent::blockingMap(vecWavelets, [&](const int& w) {
+        FFT<double> fft;
+        convolve(fft, matSpectra, w, vecCoeffs[w]);
+    });
+
+    return vecCoeffs;
+}
+
+
+//*************************************************************************************************************
+
+bool WaveletTfr::addEpoch(const MatrixXd& matEpoch)
+{
+    return addEpochs(QList<MatrixXd>() << matEpoch);
+}
+
+
+//*************************************************************************************************************
+
+bool WaveletTfr::addEpochs(const QList<MatrixXd>& lEpochs)
+{
+    if(m_iNfft == 0) {
+        qWarning() << "WaveletTfr::addEpochs - Not prepared";
+        return false;
+    }
+
+    for(int e = 0; e < lEpochs.size(); ++e) {
+        int iRows = m_matKernel.size() > 0 ? m_matKernel.cols() : (m_vecPhaseSum.isEmpty() ? lEpochs.first().rows() : m_vecPhaseSum.first().rows());
+        if(lEpochs[e].cols() != m_iSamples || lEpochs[e].rows() != iRows) {
+            qWarning() << "WaveletTfr::addEpochs - Epoch" << e << "does not match the prepared engine";
+            return false;
+        }
+    }
+
+    if(lEpochs.isEmpty())
+        return true;
+
+    if(m_vecPhaseSum.isEmpty())
+        allocate(lEpochs.first().rows());
+
+    QVector<int> vecFreqs(m_vecFreqs.size());
+    for(int f = 0; f < vecFreqs.size(); ++f)
+        vecFreqs[f] = f;
+
+    const int iOutRows = m_vecPowerSum.first().rows();
+
+    for(int iFirst = 0; iFirst < lEpochs.size(); iFirst += TFR_EPOCH_BATCH) {
+        int iBatch = qMin(TFR_EPOCH_BATCH, lEpochs.size() - iFirst);
+
+        //
+        // The spectra of the batch in parallel over the epochs
+        //
+        QVector<MatrixXcd> vecSpectra(iBatch);
+        QVector<int> vecEpochs(iBatch);
+        for(int e = 0; e < iBatch; ++e)
+            vecEpochs[e] = e;
+
+        QtConcurrent::blockingMap(vecEpochs, [&](const int& e) {
+            vecSpectra[e] = epochSpectra(lEpochs[iFirst + e]);
+        });
+
+        //
+        // Each frequency accumulates into its own slice, so the frequencies run in parallel without locking
+        //
+        QtConcurrent::blockingMap(vecFreqs, [&](const int& f) {
+            FFT<double> fft;
+            MatrixXcd matCoeffs;
+            MatrixXd matPower;
+
+            for(int e = 0; e < iBatch; ++e) {
+                for(int k = 0; k < m_iTapers; ++k) {
+                    convolve(fft, vecSpectra[e], f * m_iTapers + k, matCoeffs);
+
+                    matPower = matCoeffs.cwiseAbs2();
+                    if(m_iOrientations > 1) {
+                        for(int r = 0; r < iOutRows; ++r)
+                            m_vecPowerSum[f].row(r) += matPower.middleRows(r * m_iOrientations, m_iOrientations).colwise().sum();
+                    } else {
+                        m_vecPowerSum[f] += matPower;
+                    }
+
+                    m_vecPhaseSum[f].array() += matCoeffs.array() / matPower.array().sqrt().max(1e-300);
+                }
+            }
+        });
+
+        m_iEpochs += iBatch;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd WaveletTfr::power(int iRow) const
+{
+    MatrixXd matPower(m_vecFreqs.size(), m_iSamples);
+
+    if(m_iEpochs == 0 || iRow < 0 || iRow >= rows())
+        return MatrixXd();
+
+    double dScale = m_vecScale.size() > 0 ? m_vecScale(iRow) * m_vecScale(iRow) : 1.0;
+    for(int f = 0; f < m_vecFreqs.size(); ++f)
+        matPower.row(f) = m_vecPowerSum[f].row(iRow) * (dScale / (m_iEpochs * m_iTapers));
+
+    return matPower;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd WaveletTfr::powerAtFrequency(int iFreq) const
+{
+    if(m_iEpochs == 0 || iFreq < 0 || iFreq >= m_vecFreqs.size())
+        return MatrixXd();
+
+    MatrixXd matPower = m_vecPowerSum[iFreq] / double(m_iEpochs * m_iTapers);
+    if(m_vecScale.size() > 0)
+        matPower = m_vecScale.cwiseAbs2().asDiagonal() * matPower;
+
+    return matPower;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd WaveletTfr::itc(int iRow) const
+{
+    if(m_iEpochs == 0 || iRow < 0 || iRow >= rows())
+        return MatrixXd();
+
+    MatrixXd matItc(m_vecFreqs.size(), m_iSamples);
+    for(int f = 0; f < m_vecFreqs.size(); ++f)
+        matItc.row(f) = m_vecPhaseSum[f].middleRows(iRow * m_iOrientations, m_iOrientations).cwiseAbs().colwise().mean() / double(m_iEpochs * m_iTapers);
+
+    return matItc;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd WaveletTfr::dpss(int iLength, double dHalfBandwidth, int iTapers)
+{
+    //
+    // The tapers are the eigenvectors of the largest eigenvalues of a tridiagonal matrix commuting with the
+    // concentration problem (Percival & Walden). The eigenvalues are found without eigenvectors, the vectors by
+    // inverse iteration, so long tapers cost O(n^2) instead of O(n^3).
+    //
+    iTapers = qBound(1, iTapers, iLength);
+    double dW = dHalfBandwidth / iLength;
+
+    VectorXd vecDiag(iLength);
+    VectorXd vecOffDiag(qMax(1, iLength - 1));
+    for(int i = 0; i < iLength; ++i) {
+        double x = (iLength - 1 - 2.0 * i) / 2.0;
+        vecDiag(i) = x * x * qCos(2.0 * M_PI * dW);
+    }
+    for(int i = 1; i < iLength; ++i)
+        vecOffDiag(i - 1) = i * (iLength - i) / 2.0;
+
+    MatrixXd matTapers(iTapers, iLength);
+
+    if(iLength == 1) {
+        matTapers.setOnes();
+        return matTapers;
+    }
+
+    SelfAdjointEigenSolver<MatrixXd> solver;
+    solver.computeFromTridiagonal(vecDiag, vecOffDiag.head(iLength - 1), EigenvaluesOnly);
+    const VectorXd& vecEigenvalues = solver.eigenvalues();
+
+    for(int k = 0; k < iTapers; ++k) {
+        double dLambda = vecEigenvalues(iLength - 1 - k);
+
+        VectorXd vecTaper(iLength);
+        for(int i = 0; i < iLength; ++i)
+            vecTaper(i) = 1.0 + 0.1 * qSin(0.7 * i + k);
+
+        for(int iter = 0; iter < 3; ++iter) {
+            vecTaper = solveTridiagonal(vecDiag, vecOffDiag.head(iLength - 1), dLambda, vecTaper);
+            for(int j = 0; j < k; ++j)
+                vecTaper -= matTapers.row(j).dot(vecTaper) * matTapers.row(j).transpose();
+            vecTaper.normalize();
+        }
+
+        //Even tapers have a positive sum, odd ones start with a positive lobe
+        double dSign = 0.0;
+        for(int i = 0; i < iLength; ++i)
+            dSign += vecTaper(i) * (k % 2 == 0 ? 1.0 : (iLength - 1) / 2.0 - i);
+        if(dSign < 0.0)
+            vecTaper = -vecTaper;
+
+        matTapers.row(k) = vecTaper.transpose();
+    }
+
+    return matTapers;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXcd WaveletTfr::epochSpectra(const MatrixXd& matEpoch) const
+{
+    FFT<double> fft;
+
+    MatrixXcd matSpectra(matEpoch.rows(), m_iNfft);
+    VectorXcd vecBuffer = VectorXcd::Zero(m_iNfft);
+    VectorXcd vecSpectrum;
+
+    for(int c = 0; c < matEpoch.rows(); ++c) {
+        vecBuffer.head(m_iSamples) = matEpoch.row(c).transpose().cast<std::complex<double> >();
+        fft.fwd(vecSpectrum, vecBuffer);
+        matSpectra.row(c) = vecSpectrum.transpose();
+    }
+
+    return matSpectra;
+}
+
+
+//*************************************************************************************************************
+
+void WaveletTfr::convolve(FFT<double>& fft, const MatrixXcd& matSpectra, int iWavelet, MatrixXcd& matCoeffs) const
+{
+    VectorXcd vecSpectrum;
+    VectorXcd vecTime;
+
+    MatrixXcd matSensor(matSpectra.rows(), m_iSamples);
+    for(int c = 0; c < matSpectra.rows(); ++c) {
+        vecSpectrum = matSpectra.row(c).transpose().cwiseProduct(m_matWaveletSpectra.col(iWavelet));
+        fft.inv(vecTime, vecSpectrum);
+        matSensor.row(c) = vecTime.head(m_iSamples).transpose();
+    }
+
+    if(m_matKernel.size() == 0) {
+        matCoeffs = matSensor;
+        return;
+    }
+
+    //The kernel is real, the real and the imaginary parts are projected in one product
+    MatrixXd matParts(matSensor.rows(), 2 * m_iSamples);
+    matParts << matSensor.real(), matSensor.imag();
+    MatrixXd matProjected = m_matKernel * matParts;
+
+    matCoeffs.resize(m_matKernel.rows(), m_iSamples);
+    matCoeffs.real() = matProjected.leftCols(m_iSamples);
+    matCoeffs.imag() = matProjected.rightCols(m_iSamples);
+}
+
+
+//*************************************************************************************************************
+
+void WaveletTfr::allocate(int iRows)
+{
+    m_vecPowerSum.fill(MatrixXd::Zero(iRows / m_iOrientations, m_iSamples), m_vecFreqs.size());
+    m_vecPhaseSum.fill(MatrixXcd::Zero(iRows, m_iSamples), m_vecFreqs.size());
+}
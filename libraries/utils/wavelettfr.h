@@ -0,0 +1,324 @@
+//=============================================================================================================
+/**
+* @file     wavelettfr.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Declaration of the WaveletTfr class.
+*
+*/
+
+#ifndef WAVELETTFR_H
+#define WAVELETTFR_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QVector>
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+* Time-frequency decomposition of epochs with Morlet wavelets or multitaper (DPSS tapered) wavelets. Every
+* channel is transformed once per epoch, the convolution with each wavelet is a product with its spectrum, which
+* is computed once in prepare() and cached for all engines with the same parameters. Epochs are added in batches,
+* the spectra of a batch are computed in parallel over epochs and channels and the wavelets are then processed in
+* parallel, each one accumulating the power and the phase sums over the epochs into its own frequency slice.
+*
+* With a projection set, e.g. the imaging kernel of INVERSELIB::MinimumNorm, the complex sensor coefficients of each
+* wavelet are projected before the power is formed, so the induced power is obtained in source space without
+* applying the inverse to every sample of the raw data.
+*
+* @brief Batched Morlet and multitaper time-frequency transform
+*/
+class UTILSSHARED_EXPORT WaveletTfr
+{
+
+public:
+    typedef QSharedPointer<WaveletTfr> SPtr;             /**< Shared pointer type for WaveletTfr. */
+    typedef QSharedPointer<const WaveletTfr> ConstSPtr;  /**< Const shared pointer type for WaveletTfr. */
+
+    enum Method {
+        Morlet,         /**< Gaussian windowed complex exponentials. */
+        Multitaper      /**< DPSS tapered complex exponentials, the power is averaged over the tapers. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs an unprepared WaveletTfr.
+    */
+    WaveletTfr();
+
+    //=========================================================================================================
+    /**
+    * Designs the wavelets and their spectra for epochs of a fixed length and resets the accumulation.
+    *
+    * @param[in] vecFreqs           frequencies in Hz.
+    * @param[in] dSFreq             sampling frequency in Hz.
+    * @param[in] iSamples           number of samples of the epochs.
+    * @param[in] method             Morlet or multitaper wavelets.
+    * @param[in] dCycles            number of cycles of each wavelet.
+    * @param[in] dTimeBandwidth     time-bandwidth product of the tapers, floor(dTimeBandwidth-1) tapers of half
+    *                               bandwidth dTimeBandwidth/2 are used, only used by the multitaper method.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool prepare(const Eigen::VectorXd& vecFreqs,
+                 double dSFreq,
+                 int iSamples,
+                 Method method = Morlet,
+                 double dCycles = 7.0,
+                 double dTimeBandwidth = 4.0);
+
+    //=========================================================================================================
+    /**
+    * Projects the complex coefficients of the channels before the power is formed, the power of iOrientations
+    * consecutive projected rows is summed into one row. Resets the accumulation.
+    *
+    * @param[in] matKernel          projection (rows x channels), e.g. an imaging kernel.
+    * @param[in] iOrientations      number of consecutive rows which belong to one output row, e.g. 3 for free
+    *                               orientations.
+    * @param[in] vecScale           amplitude scale of each output row, e.g. the dSPM noise normalization, none if empty.
+    */
+    void setProjection(const Eigen::MatrixXd& matKernel, int iOrientations = 1, const Eigen::VectorXd& vecScale = Eigen::VectorXd());
+
+    //=========================================================================================================
+    /**
+    * Removes the projection and resets the accumulation.
+    */
+    void clearProjection();
+
+    //=========================================================================================================
+    /**
+    * Drops the accumulated epochs.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Transforms a single epoch without accumulating it.
+    *
+    * @param[in] matEpoch   the epoch (channels x samples).
+    *
+    * @return the complex coefficients of each wavelet, (projected) rows x samples. The wavelets are ordered by
+    *         frequency, the tapers of a frequency follow each other.
+    */
+    QVector<Eigen::MatrixXcd> transform(const Eigen::MatrixXd& matEpoch) const;
+
+    //=========================================================================================================
+    /**
+    * Adds an epoch to the accumulated power and inter-trial coherence.
+    *
+    * @param[in] matEpoch   the epoch (channels x samples).
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool addEpoch(const Eigen::MatrixXd& matEpoch);
+
+    //=========================================================================================================
+    /**
+    * Adds epochs to the accumulated power and inter-trial coherence, in parallel over epochs, channels and
+    * wavelets.
+    *
+    * @param[in] lEpochs    the epochs (channels x samples each).
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool addEpochs(const QList<Eigen::MatrixXd>& lEpochs);
+
+    //=========================================================================================================
+    /**
+    * Returns the mean power over the accumulated epochs (and tapers) of an output row.
+    *
+    * @param[in] iRow       the channel, or the output row with a projection.
+    *
+    * @return the power (frequencies x samples).
+    */
+    Eigen::MatrixXd power(int iRow) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the mean power over the accumulated epochs (and tapers) of all output rows at one frequency.
+    *
+    * @param[in] iFreq      index of the frequency.
+    *
+    * @return the power (rows x samples).
+    */
+    Eigen::MatrixXd powerAtFrequency(int iFreq) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the inter-trial coherence, the length of the mean unit phase vector over the accumulated epochs (and
+    * tapers). With more than one orientation the coherence of the orientations of a row is averaged.
+    *
+    * @param[in] iRow       the channel, or the output row with a projection.
+    *
+    * @return the inter-trial coherence (frequencies x samples).
+    */
+    Eigen::MatrixXd itc(int iRow) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of accumulated epochs.
+    *
+    * @return the number of epochs.
+    */
+    inline int epochs() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of output rows, the number of channels or of projected rows divided by the orientations.
+    * Before the first epoch without a projection it is 0.
+    *
+    * @return the number of output rows.
+    */
+    inline int rows() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the frequencies.
+    *
+    * @return the frequencies in Hz.
+    */
+    inline const Eigen::VectorXd& freqs() const;
+
+    //=========================================================================================================
+    /**
+    * Computes discrete prolate spheroidal sequences (Slepian tapers) with unit norm.
+    *
+    * @param[in] iLength            length of the tapers.
+    * @param[in] dHalfBandwidth     half bandwidth in cycles per taper length, the NW of the tapers.
+    * @param[in] iTapers            number of tapers.
+    *
+    * @return the tapers (tapers x length).
+    */
+    static Eigen::MatrixXd dpss(int iLength, double dHalfBandwidth, int iTapers);
+
+private:
+    //=========================================================================================================
+    /**
+    * Computes the full spectra of the rows of an epoch.
+    *
+    * @param[in] matEpoch   the epoch (channels x samples).
+    *
+    * @return the spectra (channels x FFT length).
+    */
+    Eigen::MatrixXcd epochSpectra(const Eigen::MatrixXd& matEpoch) const;
+
+    //=========================================================================================================
+    /**
+    * Convolves the channels of an epoch with one wavelet and applies the projection.
+    *
+    * @param[in] fft            the FFT object of the calling thread.
+    * @param[in] matSpectra     spectra of the epoch as returned by epochSpectra.
+    * @param[in] iWavelet       index of the wavelet.
+    * @param[out] matCoeffs     the complex coefficients (rows x samples).
+    */
+    void convolve(Eigen::FFT<double>& fft, const Eigen::MatrixXcd& matSpectra, int iWavelet, Eigen::MatrixXcd& matCoeffs) const;
+
+    //=========================================================================================================
+    /**
+    * Allocates the accumulators for a number of projected rows.
+    *
+    * @param[in] iRows      number of projected rows.
+    */
+    void allocate(int iRows);
+
+    Eigen::VectorXd             m_vecFreqs;             /**< Frequencies in Hz. */
+    int                         m_iSamples;             /**< Number of samples of the epochs. */
+    int                         m_iNfft;                /**< FFT length, at least the epoch plus the longest wavelet. */
+    int                         m_iTapers;              /**< Number of wavelets per frequency. */
+    Eigen::MatrixXcd            m_matWaveletSpectra;    /**< Spectra of the wavelets (FFT length x wavelets), centered on sample 0. */
+
+    Eigen::MatrixXd             m_matKernel;            /**< The projection, empty if none. */
+    int                         m_iOrientations;        /**< Projected rows per output row. */
+    Eigen::VectorXd             m_vecScale;             /**< Amplitude scale per output row, empty if none. */
+
+    int                         m_iEpochs;              /**< Number of accumulated epochs. */
+    QVector<Eigen::MatrixXd>    m_vecPowerSum;          /**< Power sum per frequency (output rows x samples). */
+    QVector<Eigen::MatrixXcd>   m_vecPhaseSum;          /**< Unit phase sum per frequency (projected rows x samples). */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline int WaveletTfr::epochs() const
+{
+    return m_iEpochs;
+}
+
+
+//*************************************************************************************************************
+
+inline int WaveletTfr::rows() const
+{
+    return m_vecPowerSum.isEmpty() ? 0 : int(m_vecPowerSum.first().rows());
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::VectorXd& WaveletTfr::freqs() const
+{
+    return m_vecFreqs;
+}
+
+}//namespace
+
+#endif // WAVELETTFR_H
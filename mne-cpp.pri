@@ -107,11 +107,52 @@ QMAKE_TARGET_COPYRIGHT = Copyright (C) 2018 Authors of mne-cpp. All rights reser
 ## To build only the minimal version, i.e, for mne_rt_server run: qmake MNECPP_CONFIG+=minimalVersion
 ## To set CodeCov coverage compiler flag run: qmake MNECPP_CONFIG+=withCodeCov
 ## To disable tests run: qmake MNECPP_CONFIG+=noTests
+## To build the performance benchmarks under testframes/benchmarks run: qmake MNECPP_CONFIG+=withBenchmarks
 ## To disable examples run: qmake MNECPP_CONFIG+=noExamples
 ## To disable applications run: qmake MNECPP_CONFIG+=noApplications
 ## To build basic MNE Scan version run: qmake MNECPP_CONFIG+=buildBasicMneScanVersion
 ## To build MNE-CPP libraries as static libs: qmake MNECPP_CONFIG+=static
 ## To build MNE-CPP Deep library based CNTK: qmake MNECPP_CONFIG+=buildDeep
+## To build the inverse library with the CUDA backend (set CUDA_PATH if not /usr/local/cuda): qmake MNECPP_CONFIG+=withCuda
+## To compile in the MNE_TRACE_SCOPE trace points, see utils/tracer.h: qmake MNECPP_CONFIG+=withTracing
+## To run the temporal filters of MNE Scan in single precision by default, see realtime/rtProcessing/rtfilter.h: qmake MNECPP_CONFIG+=withFloatPipeline
+## To bind the Eigen products and decompositions to Intel MKL (set MKLROOT), see utils/linalg.h: qmake MNECPP_CONFIG+=withMkl
+## To bind the Eigen products and decompositions to OpenBLAS (set OPENBLAS_DIR if not in the system paths): qmake MNECPP_CONFIG+=withOpenBlas
+
+contains(MNECPP_CONFIG, withTracing) {
+    DEFINES += MNE_TRACING
+}
+
+contains(MNECPP_CONFIG, withFloatPipeline) {
+    DEFINES += MNE_RT_FLOAT
+}
+
+#All translation units have to see the same Eigen bindings, which is why they are set here and not per library
+contains(MNECPP_CONFIG, withMkl) {
+    DEFINES += EIGEN_USE_MKL_ALL MNE_LINALG_MKL
+    MKL_DIR = $$(MKLROOT)
+    isEmpty(MKL_DIR): MKL_DIR = /opt/intel/mkl
+    INCLUDEPATH += $${MKL_DIR}/include
+    win32 {
+        LIBS += -L$${MKL_DIR}/lib/intel64 -lmkl_intel_lp64 -lmkl_intel_thread -lmkl_core -llibiomp5md
+    }
+    else:macx {
+        LIBS += -L$${MKL_DIR}/lib -lmkl_intel_lp64 -lmkl_intel_thread -lmkl_core -liomp5 -lpthread -lm -ldl
+    }
+    else {
+        LIBS += -L$${MKL_DIR}/lib/intel64 -lmkl_intel_lp64 -lmkl_gnu_thread -lmkl_core -lgomp -lpthread -lm -ldl
+    }
+}
+else:contains(MNECPP_CONFIG, withOpenBlas) {
+    #The prototypes of BLAS and LAPACKE come with Eigen. OpenBLAS builds LAPACKE in by default, distributions
+    #which ship it separately, e.g. Debian, need OPENBLAS_LIBS="-lopenblas -llapacke"
+    DEFINES += EIGEN_USE_BLAS EIGEN_USE_LAPACKE MNE_LINALG_OPENBLAS
+    OPENBLAS_DIR = $$(OPENBLAS_DIR)
+    OPENBLAS_LIBS = $$(OPENBLAS_LIBS)
+    isEmpty(OPENBLAS_LIBS): OPENBLAS_LIBS = -lopenblas
+    !isEmpty(OPENBLAS_DIR): LIBS += -L$${OPENBLAS_DIR}/lib
+    LIBS += $${OPENBLAS_LIBS}
+}
 
 #Build minimalVersion for qt versions < 5.10.0
 !minQtVersion(5, 10, 0) {
@@ -0,0 +1,168 @@
+//=============================================================================================================
+/**
+* @file     allocation_counter.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Counts the heap allocations of a benchmark process.
+*
+*/
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInteger>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// SYSTEM INCLUDES
+//=============================================================================================================
+
+#include <stdlib.h>
+#include <errno.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE CLASS AllocationCounter
+//=============================================================================================================
+
+/**
+* Counts the heap allocations of the whole process, so benchmarks can verify that the steady state of a real-time
+* stage does not allocate. Eigen, Qt and operator new all end up in malloc, which is why the malloc family is
+* replaced. That relies on the symbol interposition of glibc, on other platforms isSupported() returns false.
+* The header defines the replacements and has to be included by exactly one source file of a benchmark.
+*
+* @brief Process wide heap allocation counter.
+*/
+class AllocationCounter
+{
+public:
+    //=========================================================================================================
+    /**
+    * Returns whether the allocations are counted on this platform.
+    *
+    * @return true if the allocations are counted.
+    */
+    static bool isSupported()
+    {
+#if defined(__GLIBC__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    //=========================================================================================================
+    /**
+    * Returns the number of allocations since the start of the process.
+    *
+    * @return the number of allocations.
+    */
+    static qint64 count()
+    {
+        return s_allocations.loadAcquire();
+    }
+
+    //=========================================================================================================
+    /**
+    * Counts an allocation, called by the replaced malloc family.
+    */
+    static void add()
+    {
+        s_allocations.fetchAndAddRelaxed(1);
+    }
+
+private:
+    static QAtomicInteger<qint64> s_allocations;    /**< The number of allocations, constant initialized before any allocation. */
+};
+
+QAtomicInteger<qint64> AllocationCounter::s_allocations(0);
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+#if defined(__GLIBC__)
+
+extern "C" {
+
+void* __libc_malloc(size_t iSize) Q_DECL_NOTHROW;
+void* __libc_calloc(size_t iCount, size_t iSize) Q_DECL_NOTHROW;
+void* __libc_realloc(void* pMemory, size_t iSize) Q_DECL_NOTHROW;
+void* __libc_memalign(size_t iAlignment, size_t iSize) Q_DECL_NOTHROW;
+
+void* malloc(size_t iSize) Q_DECL_NOTHROW
+{
+    AllocationCounter::add();
+    return __libc_malloc(iSize);
+}
+
+void* calloc(size_t iCount, size_t iSize) Q_DECL_NOTHROW
+{
+    AllocationCounter::add();
+    return __libc_calloc(iCount, iSize);
+}
+
+void* realloc(void* pMemory, size_t iSize) Q_DECL_NOTHROW
+{
+    AllocationCounter::add();
+    return __libc_realloc(pMemory, iSize);
+}
+
+void* memalign(size_t iAlignment, size_t iSize) Q_DECL_NOTHROW
+{
+    AllocationCounter::add();
+    return __libc_memalign(iAlignment, iSize);
+}
+
+void* aligned_alloc(size_t iAlignment, size_t iSize) Q_DECL_NOTHROW
+{
+    AllocationCounter::add();
+    return __libc_memalign(iAlignment, iSize);
+}
+
+int posix_memalign(void** ppMemory, size_t iAlignment, size_t iSize) Q_DECL_NOTHROW
+{
+    AllocationCounter::add();
+    *ppMemory = __libc_memalign(iAlignment, iSize);
+    return *ppMemory || iSize == 0 ? 0 : ENOMEM;
+}
+
+} // extern "C"
+
+#endif
+
+#endif // ALLOCATION_COUNTER_H
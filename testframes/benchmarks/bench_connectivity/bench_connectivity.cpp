@@ -0,0 +1,201 @@
+//=============================================================================================================
+/**
+* @file     bench_connectivity.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Benchmarks of the spectral connectivity metrics.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "benchmark_recorder.h"
+
+#include <fiff/fiff.h>
+#include "connectivity/metrics/abstractmetric.h"
+#include "connectivity/metrics/coherency.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace CONNECTIVITYLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS BenchConnectivity
+*
+* @brief Benchmarks the tapered spectra and Coherency::computeCoherency on epochs of the MNE sample raw data.
+*
+*/
+class BenchConnectivity : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchConnectivity();
+
+private slots:
+    void initTestCase();
+    void computeTaperedSpectra_data();
+    void computeTaperedSpectra();
+    void computeCoherency_data();
+    void computeCoherency();
+    void cleanup();
+    void cleanupTestCase();
+
+private:
+    BenchmarkRecorder       m_recorder;         /**< Records the samples of this suite. */
+    QList<MatrixXd>         m_lTrials;          /**< 50 epochs of 256 samples of the gradiometers. */
+    TaperedSpectra          m_spectra;          /**< The tapered spectra of m_lTrials. */
+};
+
+
+//*************************************************************************************************************
+
+BenchConnectivity::BenchConnectivity()
+: m_recorder("bench_connectivity")
+{
+}
+
+
+//*************************************************************************************************************
+
+void BenchConnectivity::initTestCase()
+{
+    QFile fileRaw(QDir::currentPath()+"/MNE-sample-data/MEG/sample/sample_audvis_raw.fif");
+    if(!fileRaw.exists()) {
+        QSKIP("The MNE sample data was not found.");
+    }
+
+    FiffRawData raw(fileRaw);
+    RowVectorXi picks = raw.info.pick_types(QString("grad"), false, false, QStringList(), raw.info.bads);
+
+    //50 consecutive epochs of 256 samples
+    const int iSamples = 256;
+    for(int i = 0; i < 50; ++i) {
+        MatrixXd matData, matTimes;
+        const fiff_int_t from = raw.first_samp + i * iSamples;
+        QVERIFY(raw.read_raw_segment(matData, matTimes, from, from + iSamples - 1, picks));
+        m_lTrials.append(matData);
+    }
+
+    m_spectra = AbstractMetric::computeTaperedSpectra(m_lTrials, iSamples, "hanning");
+}
+
+
+//*************************************************************************************************************
+
+void BenchConnectivity::computeTaperedSpectra_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchConnectivity::computeTaperedSpectra()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    TaperedSpectra spectra;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        spectra = AbstractMetric::computeTaperedSpectra(m_lTrials, 256, "hanning");
+    }
+}
+
+
+//*************************************************************************************************************
+
+void BenchConnectivity::computeCoherency_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchConnectivity::computeCoherency()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    QVector<MatrixXcd> vecCoherency;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        vecCoherency = Coherency::computeCoherency(m_spectra);
+    }
+
+    QCOMPARE(vecCoherency.size(), m_lTrials.first().rows());
+}
+
+
+//*************************************************************************************************************
+
+void BenchConnectivity::cleanup()
+{
+    m_recorder.setThreads(-1);
+}
+
+
+//*************************************************************************************************************
+
+void BenchConnectivity::cleanupTestCase()
+{
+    m_recorder.setThreads(-1);
+    m_recorder.write();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(BenchConnectivity)
+#include "bench_connectivity.moc"
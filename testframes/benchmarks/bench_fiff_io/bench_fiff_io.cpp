@@ -0,0 +1,309 @@
+//=============================================================================================================
+/**
+* @file     bench_fiff_io.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Benchmarks of the raw data reading and writing.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "benchmark_recorder.h"
+
+#include <fiff/fiff.h>
+
+#include <QBuffer>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS BenchFiffIo
+*
+* @brief Benchmarks opening the MNE sample raw data, read_raw_segment and write_raw_buffer on 10 s of it,
+*        uncompressed and compressed.
+*
+*/
+class BenchFiffIo : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchFiffIo();
+
+private slots:
+    void initTestCase();
+    void openStream();
+    void readRawSegment_data();
+    void readRawSegment();
+    void writeRawBuffer_data();
+    void writeRawBuffer();
+    void writeRawBufferCompressed_data();
+    void writeRawBufferCompressed();
+    void readRawSegmentMemory_data();
+    void readRawSegmentMemory();
+    void cleanup();
+    void cleanupTestCase();
+
+private:
+    void writeRaw(QByteArray& baData, bool bCompressed) const;
+
+    BenchmarkRecorder               m_recorder;     /**< Records the samples of this suite. */
+    QFile                           m_fileRaw;      /**< The raw data file. */
+    QSharedPointer<FiffRawData>     m_pRaw;         /**< The raw data read from m_fileRaw. */
+    MatrixXd                        m_matData;      /**< 10 s of raw data, the input of writeRawBuffer. */
+};
+
+
+//*************************************************************************************************************
+
+BenchFiffIo::BenchFiffIo()
+: m_recorder("bench_fiff_io")
+{
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::initTestCase()
+{
+    m_fileRaw.setFileName(QDir::currentPath()+"/MNE-sample-data/MEG/sample/sample_audvis_raw.fif");
+    if(!m_fileRaw.exists()) {
+        QSKIP("The MNE sample data was not found.");
+    }
+
+    m_pRaw = QSharedPointer<FiffRawData>(new FiffRawData(m_fileRaw));
+
+    MatrixXd matTimes;
+    QVERIFY(m_pRaw->read_raw_segment(m_matData, matTimes, m_pRaw->first_samp, m_pRaw->first_samp + 10 * (int)m_pRaw->info.sfreq - 1));
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::openStream()
+{
+    //Reading the tag directory and building the directory tree dominates opening a file. m_fileRaw stays open
+    //for m_pRaw, so the file is opened through its own device.
+    QFile file(m_fileRaw.fileName());
+    int iEntries = 0;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, 1);
+
+        FiffStream stream(&file);
+        QVERIFY(stream.open());
+        iEntries = stream.nent();
+        stream.close();
+    }
+
+    QVERIFY(iEntries > 0);
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::readRawSegment_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::readRawSegment()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    const fiff_int_t from = m_pRaw->first_samp;
+    const fiff_int_t to = from + 10 * (int)m_pRaw->info.sfreq - 1;
+
+    MatrixXd matData, matTimes;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        m_pRaw->read_raw_segment(matData, matTimes, from, to);
+    }
+
+    QCOMPARE(matData.cols(), m_matData.cols());
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::writeRawBuffer_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::writeRawBuffer()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    //Write to memory, so the benchmark covers the encoding and not the disk
+    QByteArray baData;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        writeRaw(baData, false);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::writeRawBufferCompressed_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::writeRawBufferCompressed()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    QByteArray baData;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        writeRaw(baData, true);
+    }
+
+    QByteArray baPlain;
+    writeRaw(baPlain, false);
+    qDebug() << "Compressed file size" << baData.size() << "of" << baPlain.size() << "bytes";
+
+    QVERIFY(baData.size() < baPlain.size());
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::readRawSegmentMemory_data()
+{
+    QTest::addColumn<bool>("compressed");
+
+    QTest::newRow("plain") << false;
+    QTest::newRow("compressed") << true;
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::readRawSegmentMemory()
+{
+    QFETCH(bool, compressed);
+
+    //Read the files from memory, so the benchmark compares the decoding and not the disk
+    QByteArray baData;
+    writeRaw(baData, compressed);
+
+    QBuffer buffer(&baData);
+    FiffRawData raw(buffer);
+
+    MatrixXd matData, matTimes;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, 1);
+        raw.read_raw_segment(matData, matTimes, raw.first_samp, raw.last_samp);
+    }
+
+    QCOMPARE(matData.cols(), m_matData.cols());
+    QVERIFY((matData - m_matData).cwiseAbs().maxCoeff() <= 1e-6 * m_matData.cwiseAbs().maxCoeff());
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::cleanup()
+{
+    m_recorder.setThreads(-1);
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::cleanupTestCase()
+{
+    m_recorder.setThreads(-1);
+    m_recorder.write();
+}
+
+
+//*************************************************************************************************************
+
+void BenchFiffIo::writeRaw(QByteArray& baData, bool bCompressed) const
+{
+    //Buffers of one second, as written by the MNE Scan recording
+    const int iBlockSize = (int)m_pRaw->info.sfreq;
+
+    baData.clear();
+    QBuffer buffer(&baData);
+    RowVectorXd cals;
+    FiffStream::SPtr pStream = FiffStream::start_writing_raw(buffer, m_pRaw->info, cals);
+    pStream->set_raw_compression(bCompressed);
+    for(int iFirst = 0; iFirst < m_matData.cols(); iFirst += iBlockSize) {
+        pStream->write_raw_buffer(m_matData.middleCols(iFirst, qMin(iBlockSize, (int)m_matData.cols() - iFirst)), cals);
+    }
+    pStream->finish_writing_raw();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(BenchFiffIo)
+#include "bench_fiff_io.moc"
@@ -0,0 +1,174 @@
+//=============================================================================================================
+/**
+* @file     bench_fwd.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Benchmarks of the forward solution computation.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "benchmark_recorder.h"
+
+#include <fwd/computeFwd/compute_fwd_settings.h>
+#include <fwd/computeFwd/compute_fwd.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FWDLIB;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS BenchFwd
+*
+* @brief Benchmarks ComputeFwd::calculateFwd for the MEG forward solution of the MNE sample data.
+*
+*/
+class BenchFwd : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchFwd();
+
+private slots:
+    void initTestCase();
+    void calculateFwd_data();
+    void calculateFwd();
+    void cleanup();
+    void cleanupTestCase();
+
+private:
+    BenchmarkRecorder       m_recorder;     /**< Records the samples of this suite. */
+    ComputeFwdSettings      m_settings;     /**< The settings of the sample forward solution. */
+};
+
+
+//*************************************************************************************************************
+
+BenchFwd::BenchFwd()
+: m_recorder("bench_fwd")
+{
+}
+
+
+//*************************************************************************************************************
+
+void BenchFwd::initTestCase()
+{
+    m_settings.include_meg = true;
+    m_settings.accurate = true;
+    m_settings.srcname = QDir::currentPath()+"/MNE-sample-data/subjects/sample/bem/sample-oct-6-src.fif";
+    m_settings.measname = QDir::currentPath()+"/MNE-sample-data/MEG/sample/sample_audvis_raw.fif";
+    m_settings.mriname = QDir::currentPath()+"/MNE-sample-data/subjects/sample/mri/brain-neuromag/sets/COR.fif";
+    m_settings.mri_head_ident = false;
+    m_settings.transname.clear();
+    m_settings.bemname = QDir::currentPath()+"/MNE-sample-data/subjects/sample/bem/sample-5120-5120-5120-bem.fif";
+    m_settings.mindist = 5.0f/1000.0f;
+    m_settings.solname = QDir::tempPath()+"/bench_fwd-meg-oct-6-fwd.fif";
+
+    if(!QFile::exists(m_settings.srcname) || !QFile::exists(m_settings.bemname)) {
+        QSKIP("The MNE sample data was not found.");
+    }
+
+    m_settings.checkIntegrity();
+}
+
+
+//*************************************************************************************************************
+
+void BenchFwd::calculateFwd_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchFwd::calculateFwd()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+    m_settings.nthread = threads;
+
+    //A single computation takes seconds, repeating it would not make the numbers more reliable
+    QBENCHMARK_ONCE {
+        BenchmarkTimer timer(m_recorder, threads);
+        ComputeFwd cmpFwd(&m_settings);
+        cmpFwd.calculateFwd();
+    }
+
+    QVERIFY(QFile::exists(m_settings.solname));
+}
+
+
+//*************************************************************************************************************
+
+void BenchFwd::cleanup()
+{
+    m_recorder.setThreads(-1);
+}
+
+
+//*************************************************************************************************************
+
+void BenchFwd::cleanupTestCase()
+{
+    m_recorder.setThreads(-1);
+    m_recorder.write();
+
+    QFile::remove(m_settings.solname);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(BenchFwd)
+#include "bench_fwd.moc"
@@ -0,0 +1,178 @@
+//=============================================================================================================
+/**
+* @file     bench_geometryinfo.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Benchmarks of the surface constrained distance calculation.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "benchmark_recorder.h"
+
+#include <disp3D/helpers/geometryinfo/geometryinfo.h>
+#include <fiff/fiff.h>
+#include <mne/mne_bem.h>
+#include <mne/mne_bem_surface.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+using namespace FIFFLIB;
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS BenchGeometryInfo
+*
+* @brief Benchmarks GeometryInfo::scdc from the MEG sensors on the inner skull surface of the MNE sample data.
+*
+*/
+class BenchGeometryInfo : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchGeometryInfo();
+
+private slots:
+    void initTestCase();
+    void scdc_data();
+    void scdc();
+    void cleanup();
+    void cleanupTestCase();
+
+private:
+    BenchmarkRecorder       m_recorder;         /**< Records the samples of this suite. */
+    MNEBemSurface           m_surface;          /**< The surface the distances are calculated on. */
+    QVector<qint32>         m_vecSubset;        /**< The vertices closest to the MEG sensors. */
+};
+
+
+//*************************************************************************************************************
+
+BenchGeometryInfo::BenchGeometryInfo()
+: m_recorder("bench_geometryinfo")
+{
+}
+
+
+//*************************************************************************************************************
+
+void BenchGeometryInfo::initTestCase()
+{
+    QFile fileBem(QDir::currentPath()+"/MNE-sample-data/subjects/sample/bem/sample-5120-bem.fif");
+    QFile fileEvoked(QDir::currentPath()+"/MNE-sample-data/MEG/sample/sample_audvis-ave.fif");
+    if(!fileBem.exists() || !fileEvoked.exists()) {
+        QSKIP("The MNE sample data was not found.");
+    }
+
+    MNEBem bem(fileBem);
+    m_surface = bem[0];
+
+    FiffEvoked evoked(fileEvoked, 0, QPair<QVariant, QVariant>(QVariant(), 0));
+    QVector<Vector3f> vecSensors;
+    for(const FiffChInfo &info : evoked.info.chs) {
+        if(info.kind == FIFFV_MEG_CH) {
+            vecSensors.push_back(info.chpos.r0);
+        }
+    }
+
+    m_vecSubset = GeometryInfo::projectSensors(m_surface.rr, vecSensors);
+}
+
+
+//*************************************************************************************************************
+
+void BenchGeometryInfo::scdc_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchGeometryInfo::scdc()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    QSharedPointer<MatrixXd> pDistances;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        pDistances = GeometryInfo::scdc(m_surface.rr, m_surface.neighbor_vert, m_vecSubset, 0.03);
+    }
+
+    QCOMPARE((int)pDistances->cols(), m_vecSubset.size());
+}
+
+
+//*************************************************************************************************************
+
+void BenchGeometryInfo::cleanup()
+{
+    m_recorder.setThreads(-1);
+}
+
+
+//*************************************************************************************************************
+
+void BenchGeometryInfo::cleanupTestCase()
+{
+    m_recorder.setThreads(-1);
+    m_recorder.write();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(BenchGeometryInfo)
+#include "bench_geometryinfo.moc"
@@ -0,0 +1,377 @@
+//=============================================================================================================
+/**
+* @file     bench_inverse.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Benchmarks of the inverse solvers.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "benchmark_recorder.h"
+
+#include <fiff/fiff.h>
+#include <fs/annotationset.h>
+#include <mne/mne.h>
+#include <inverse/minimumNorm/minimumnorm.h>
+#include <inverse/rapMusic/rapmusic.h>
+#include <inverse/rapMusic/rapmusickernel.h>
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace FSLIB;
+using namespace MNELIB;
+using namespace INVERSELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS BenchInverse
+*
+* @brief Benchmarks MinimumNorm::calculateInverse for the whole source space and for a label restricted kernel,
+*        RapMusic::calculateInverse in double and single precision and the RAP MUSIC pair kernels on the MNE
+*        sample data.
+*
+*/
+class BenchInverse : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchInverse();
+
+private slots:
+    void initTestCase();
+    void minimumNorm_data();
+    void minimumNorm();
+    void minimumNormLabels_data();
+    void minimumNormLabels();
+    void compareLabelKernel();
+    void rapMusic_data();
+    void rapMusic();
+    void rapMusicSinglePrecision_data();
+    void rapMusicSinglePrecision();
+    void pairKernelDouble();
+    void pairKernelFloat();
+    void cleanup();
+    void cleanupTestCase();
+
+private:
+    BenchmarkRecorder               m_recorder;         /**< Records the samples of this suite. */
+    FiffEvoked                      m_evoked;           /**< The left auditory evoked response. */
+    FiffEvoked                      m_evokedPicked;     /**< m_evoked restricted to the channels of the forward solution. */
+    MatrixXd                        m_matData;          /**< 10 s of evoked data, the input of minimumNorm. */
+    QSharedPointer<MinimumNorm>     m_pMinimumNorm;     /**< The dSPM solver, set up for m_evoked. */
+    QSharedPointer<MinimumNorm>     m_pMinimumNormRoi;  /**< m_pMinimumNorm restricted to m_qListLabels. */
+    QList<Label>                    m_qListLabels;      /**< The first 150 sources of each hemisphere. */
+    QSharedPointer<RapMusic>        m_pRapMusic;        /**< The RAP MUSIC solver on the clustered forward solution. */
+    QSharedPointer<RapMusic>        m_pRapMusicFloat;   /**< m_pRapMusic scanning in single precision. */
+    MatrixXd                        m_matLeadField;     /**< The clustered lead field, the input of the pair kernels. */
+    MatrixXd                        m_matU_B;           /**< An orthonormal signal subspace for the pair kernels. */
+
+    template<typename T>
+    void benchPairKernel();
+};
+
+
+//*************************************************************************************************************
+
+BenchInverse::BenchInverse()
+: m_recorder("bench_inverse")
+{
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::initTestCase()
+{
+    QFile fileEvoked(QDir::currentPath()+"/MNE-sample-data/MEG/sample/sample_audvis-ave.fif");
+    QFile fileInv(QDir::currentPath()+"/MNE-sample-data/MEG/sample/sample_audvis-meg-eeg-oct-6-meg-eeg-inv.fif");
+    QFile fileFwd(QDir::currentPath()+"/MNE-sample-data/MEG/sample/sample_audvis-meg-eeg-oct-6-fwd.fif");
+    if(!fileEvoked.exists() || !fileInv.exists() || !fileFwd.exists()) {
+        QSKIP("The MNE sample data was not found.");
+    }
+
+    m_evoked = FiffEvoked(fileEvoked, 0, QPair<QVariant, QVariant>(QVariant(), 0));
+    QVERIFY(!m_evoked.isEmpty());
+
+    //Tile the evoked response to 10 s, the length of a typical raw data block
+    const int iCols = 10 * (int)m_evoked.info.sfreq;
+    m_matData.resize(m_evoked.data.rows(), iCols);
+    for(int iFirst = 0; iFirst < iCols; iFirst += m_evoked.data.cols()) {
+        const int n = qMin((int)m_evoked.data.cols(), iCols - iFirst);
+        m_matData.middleCols(iFirst, n) = m_evoked.data.leftCols(n);
+    }
+
+    MNEInverseOperator inverseOperator(fileInv);
+    m_pMinimumNorm = QSharedPointer<MinimumNorm>(new MinimumNorm(inverseOperator, 1.0f / 9.0f, "dSPM"));
+    m_pMinimumNorm->doInverseSetup(m_evoked.nave, false);
+
+    //A region of interest of a few hundred sources
+    for(qint32 h = 0; h < 2; ++h) {
+        VectorXi vecVertices = inverseOperator.src[h].vertno.head(150);
+        m_qListLabels.append(Label(vecVertices, MatrixX3f(), VectorXd(), h, h == 0 ? "roi-lh" : "roi-rh"));
+    }
+    m_pMinimumNormRoi = QSharedPointer<MinimumNorm>(new MinimumNorm(inverseOperator, 1.0f / 9.0f, "dSPM"));
+    m_pMinimumNormRoi->setLabels(m_qListLabels);
+    m_pMinimumNormRoi->doInverseSetup(m_evoked.nave, false);
+
+    MNEForwardSolution fwd(fileFwd);
+    AnnotationSet annotationSet("sample", 2, "aparc.a2009s", QDir::currentPath()+"/MNE-sample-data/subjects");
+    MNEForwardSolution fwdClustered = fwd.cluster_forward_solution(annotationSet, 20);
+    m_evokedPicked = m_evoked.pick_channels(fwdClustered.info.ch_names);
+    m_pRapMusic = QSharedPointer<RapMusic>(new RapMusic(fwdClustered, false, 7));
+    m_pRapMusicFloat = QSharedPointer<RapMusic>(new RapMusic(fwdClustered, false, 7, 0.5, true));
+
+    //The subspace of the first samples after the stimulus
+    m_matLeadField = fwdClustered.sol->data;
+    JacobiSVD<MatrixXd> svd(m_evokedPicked.data, ComputeThinU);
+    m_matU_B = svd.matrixU().leftCols(7);
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::minimumNorm_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::minimumNorm()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    MNESourceEstimate sourceEstimate;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        sourceEstimate = m_pMinimumNorm->calculateInverse(m_matData, m_evoked.times(0), 1.0f / m_evoked.info.sfreq);
+    }
+
+    QVERIFY(!sourceEstimate.isEmpty());
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::minimumNormLabels_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::minimumNormLabels()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    MNESourceEstimate sourceEstimate;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        sourceEstimate = m_pMinimumNormRoi->calculateInverse(m_matData, m_evoked.times(0), 1.0f / m_evoked.info.sfreq);
+    }
+
+    QCOMPARE((int)sourceEstimate.data.rows(), 300);
+    QCOMPARE((int)sourceEstimate.vertices.size(), 300);
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::compareLabelKernel()
+{
+    //The restricted kernel keeps the regularization of the whole source space, its rows are rows of the full kernel
+    const MatrixXd& matKernel = m_pMinimumNorm->getKernel();
+    const MatrixXd& matKernelRoi = m_pMinimumNormRoi->getKernel();
+    const MNESourceSpace& src = m_pMinimumNorm->getSourceSpace();
+    const qint32 iNumLh = src[0].vertno.size();
+    const qint32 iOri = matKernel.rows() / (iNumLh + src[1].vertno.size());
+
+    QCOMPARE((int)matKernelRoi.rows(), 300 * iOri);
+    QCOMPARE(matKernelRoi.cols(), matKernel.cols());
+
+    MatrixXd matRows(matKernelRoi.rows(), matKernel.cols());
+    matRows.topRows(150 * iOri) = matKernel.topRows(150 * iOri);
+    matRows.bottomRows(150 * iOri) = matKernel.middleRows(iNumLh * iOri, 150 * iOri);
+
+    QVERIFY((matKernelRoi - matRows).norm() <= 1e-10 * matRows.norm());
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::rapMusic_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::rapMusic()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    MNESourceEstimate sourceEstimate;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        sourceEstimate = m_pRapMusic->calculateInverse(m_evokedPicked);
+    }
+
+    QVERIFY(!sourceEstimate.isEmpty());
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::rapMusicSinglePrecision_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::rapMusicSinglePrecision()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    MNESourceEstimate sourceEstimate;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        sourceEstimate = m_pRapMusicFloat->calculateInverse(m_evokedPicked);
+    }
+
+    QVERIFY(!sourceEstimate.isEmpty());
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::pairKernelDouble()
+{
+    benchPairKernel<double>();
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::pairKernelFloat()
+{
+    benchPairKernel<float>();
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void BenchInverse::benchPairKernel()
+{
+    //All pairs of the first grid point on one thread, the time per pair of the scan
+    typedef RapMusicKernel<T> Kernel;
+
+    const typename Kernel::MatrixXT matLeadField = m_matLeadField.cast<T>();
+    const typename Kernel::MatrixXT matU_B = m_matU_B.cast<T>();
+    const int iNumPoints = matLeadField.cols() / 3;
+
+    typename Kernel::MatrixX6T matPair(matLeadField.rows(), 6);
+    typename Kernel::Workspace workspace(matLeadField.rows(), matU_B.cols());
+
+    double dSum = 0.0;
+    qint64 iNumPairs = 0;
+    QElapsedTimer timerPairs;
+    timerPairs.start();
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, 1);
+        for(int i = 0; i < iNumPoints; ++i) {
+            Kernel::gainMatrixPair(matLeadField, 0, i, matPair);
+            dSum += Kernel::subcorr(matPair, matU_B, workspace);
+        }
+        iNumPairs += iNumPoints;
+    }
+
+    printf("[BenchInverse] %.0f pairs per second\n", (double)iNumPairs * 1e9 / (double)qMax(timerPairs.nsecsElapsed(), qint64(1)));
+
+    QVERIFY(dSum > 0.0);
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::cleanup()
+{
+    m_recorder.setThreads(-1);
+}
+
+
+//*************************************************************************************************************
+
+void BenchInverse::cleanupTestCase()
+{
+    m_recorder.setThreads(-1);
+    m_recorder.write();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(BenchInverse)
+#include "bench_inverse.moc"
@@ -0,0 +1,345 @@
+//=============================================================================================================
+/**
+* @file     bench_linalg.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Benchmarks of the dense linear algebra backends.
+*
+*/
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "benchmark_recorder.h"
+
+#include <utils/linalg.h>
+#include <utils/mnemath.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Dense>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS BenchLinAlg
+*
+* @brief Benchmarks the dense products and decompositions of the inverse and forward computations on the BLAS
+* backends. The products run on Eigen and, if a BLAS library can be loaded, on LinAlg::BlasBackend. The
+* decompositions run on the library Eigen is bound to at compile time, which is why the results of each build
+* are written to their own file, bench_linalg_<linked library>.json. Set MNE_LINALG, e.g. to "blas:mkl_rt", to
+* choose the library which is loaded.
+*
+*/
+class BenchLinAlg : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchLinAlg();
+
+private slots:
+    void initTestCase();
+    void multiplyFloat_data();
+    void multiplyFloat();
+    void applyKernel_data();
+    void applyKernel();
+    void pinvLeadField_data();
+    void pinvLeadField();
+    void eigenCovariance_data();
+    void eigenCovariance();
+    void invertBem_data();
+    void invertBem();
+    void cleanup();
+    void cleanupTestCase();
+
+private:
+    void addBackendRows() const;
+    bool setUp(int iThreads, const QString& sBackend);
+
+    BenchmarkRecorder   m_recorder;         /**< Records the samples of this suite. */
+    bool                m_bHasLibrary;      /**< Whether a BLAS library could be loaded. */
+    MatrixXd            m_matLeadField;     /**< Lead field sized matrix, channels x sources. */
+    MatrixXd            m_matKernel;        /**< Imaging kernel sized matrix, sources x channels. */
+    MatrixXd            m_matData;          /**< Data, channels x samples. */
+    MatrixXd            m_matCov;           /**< Covariance, channels x channels. */
+    MatrixXf            m_matBem;           /**< BEM coefficient sized matrix, well conditioned. */
+};
+
+
+//*************************************************************************************************************
+
+BenchLinAlg::BenchLinAlg()
+: m_recorder("bench_linalg_" + LinAlg::linkedLibrary().toLower())
+, m_bHasLibrary(false)
+{
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::initTestCase()
+{
+    //Keep the library selected by MNE_LINALG, try the default ones otherwise
+    m_bHasLibrary = !LinAlg::loadedLibrary().isEmpty() || LinAlg::loadLibrary();
+    printf("[BenchLinAlg] Eigen is bound to %s, loaded BLAS: %s\n",
+           LinAlg::linkedLibrary().toUtf8().constData(),
+           m_bHasLibrary ? LinAlg::loadedLibrary().toUtf8().constData() : "none");
+
+    //Sizes of the MNE sample data: 306 channels, an oct-6 source space and a 3 x 5120 BEM
+    m_matLeadField = MatrixXd::Random(306, 8196);
+    m_matKernel = MatrixXd::Random(8196, 306);
+    m_matData = MatrixXd::Random(306, 600);
+
+    MatrixXd matNoise = MatrixXd::Random(306, 2000);
+    m_matCov = matNoise * matNoise.transpose() / 2000.0;
+
+    m_matBem = MatrixXf::Random(3000, 3000);
+    m_matBem.diagonal().array() += 3000.0f;
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::addBackendRows() const
+{
+    QTest::addColumn<QString>("backend");
+    QTest::addColumn<int>("threads");
+
+    QStringList lBackends;
+    lBackends << "eigen";
+    if(m_bHasLibrary) {
+        lBackends << "blas";
+    }
+
+    QList<int> lThreads = m_recorder.threadCounts();
+    for(int i = 0; i < lBackends.size(); ++i) {
+        for(int j = 0; j < lThreads.size(); ++j) {
+            QTest::newRow(QString("%1 %2 threads").arg(lBackends.at(i)).arg(lThreads.at(j)).toUtf8().constData()) << lBackends.at(i) << lThreads.at(j);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool BenchLinAlg::setUp(int iThreads, const QString& sBackend)
+{
+    m_recorder.setThreads(iThreads);
+    Eigen::setNbThreads(iThreads);
+    LinAlg::setThreads(iThreads);
+
+    return LinAlg::setBackend(sBackend == "blas" ? LinAlg::BlasBackend : LinAlg::EigenBackend);
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::multiplyFloat_data()
+{
+    addBackendRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::multiplyFloat()
+{
+    QFETCH(QString, backend);
+    QFETCH(int, threads);
+    QVERIFY(setUp(threads, backend));
+
+    //The float** products of the BEM and CTF compensation code
+    const int iDim = int(m_matBem.rows());
+    MatrixXf matResult(iDim, iDim);
+
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        LinAlg::multiply(m_matBem.data(), m_matBem.data(), matResult.data(), iDim, iDim, iDim);
+    }
+
+    QVERIFY(matResult.allFinite());
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::applyKernel_data()
+{
+    addBackendRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::applyKernel()
+{
+    QFETCH(QString, backend);
+    QFETCH(int, threads);
+    QVERIFY(setUp(threads, backend));
+
+    MatrixXd matSol;
+
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        LinAlg::multiply(m_matKernel, m_matData, matSol);
+    }
+
+    QCOMPARE(int(matSol.rows()), int(m_matKernel.rows()));
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::pinvLeadField_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::pinvLeadField()
+{
+    QFETCH(int, threads);
+    setUp(threads, "eigen");
+
+    MatrixXd matPinv;
+
+    //A single decomposition takes long enough for a reliable number
+    QBENCHMARK_ONCE {
+        BenchmarkTimer timer(m_recorder, threads);
+        matPinv = MNEMath::pinv(m_matLeadField);
+    }
+
+    QCOMPARE(int(matPinv.rows()), int(m_matLeadField.cols()));
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::eigenCovariance_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::eigenCovariance()
+{
+    QFETCH(int, threads);
+    setUp(threads, "eigen");
+
+    VectorXd vecEig;
+
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        SelfAdjointEigenSolver<MatrixXd> es(m_matCov);
+        vecEig = es.eigenvalues();
+    }
+
+    QVERIFY(vecEig.minCoeff() > 0.0);
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::invertBem_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::invertBem()
+{
+    QFETCH(int, threads);
+    setUp(threads, "eigen");
+
+    MatrixXf matInv;
+
+    //The LU inversion of the BEM solution
+    QBENCHMARK_ONCE {
+        BenchmarkTimer timer(m_recorder, threads);
+        matInv = m_matBem.partialPivLu().inverse();
+    }
+
+    QVERIFY(matInv.allFinite());
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::cleanup()
+{
+    m_recorder.setThreads(-1);
+    Eigen::setNbThreads(0);
+}
+
+
+//*************************************************************************************************************
+
+void BenchLinAlg::cleanupTestCase()
+{
+    m_recorder.setThreads(-1);
+    m_recorder.write();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(BenchLinAlg)
+#include "bench_linalg.moc"
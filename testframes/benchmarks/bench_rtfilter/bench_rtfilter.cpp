@@ -0,0 +1,320 @@
+//=============================================================================================================
+/**
+* @file     bench_rtfilter.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Benchmarks of the real-time filter.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "benchmark_recorder.h"
+#include "allocation_counter.h"
+
+#include <fiff/fiff.h>
+#include <utils/filterTools/filterdata.h>
+#include <realtime/rtProcessing/rtfilter.h>
+#include <realtime/rtProcessing/rtresample.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace UTILSLIB;
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS BenchRtFilter
+*
+* @brief Benchmarks RtFilter on blocks of the MNE sample raw data.
+*
+*/
+class BenchRtFilter : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchRtFilter();
+
+private slots:
+    void initTestCase();
+    void filterBlock_data();
+    void filterBlock();
+    void filterBlockFloat_data();
+    void filterBlockFloat();
+    void filterChannelsConcurrently_data();
+    void filterChannelsConcurrently();
+    void steadyStateAllocations();
+    void cleanup();
+    void cleanupTestCase();
+
+private:
+    BenchmarkRecorder       m_recorder;         /**< Records the samples of this suite. */
+    MatrixXd                m_matData;          /**< 10 s of raw data. */
+    QVector<int>            m_vecChannels;      /**< The filtered channels. */
+    QList<FilterData>       m_lFilterData;      /**< The band pass filter. */
+};
+
+
+//*************************************************************************************************************
+
+BenchRtFilter::BenchRtFilter()
+: m_recorder("bench_rtfilter")
+{
+}
+
+
+//*************************************************************************************************************
+
+void BenchRtFilter::initTestCase()
+{
+    QFile fileRaw(QDir::currentPath()+"/MNE-sample-data/MEG/sample/sample_audvis_raw.fif");
+    if(!fileRaw.exists()) {
+        QSKIP("The MNE sample data was not found.");
+    }
+
+    FiffRawData raw(fileRaw);
+
+    MatrixXd matTimes;
+    QVERIFY(raw.read_raw_segment(m_matData, matTimes, raw.first_samp, raw.first_samp + 10 * (int)raw.info.sfreq - 1));
+
+    for(int i = 0; i < raw.info.nchan; ++i) {
+        if(raw.info.chs.at(i).kind == FIFFV_MEG_CH || raw.info.chs.at(i).kind == FIFFV_EEG_CH) {
+            m_vecChannels.append(i);
+        }
+    }
+
+    //1 - 40 Hz band pass with 512 taps
+    const double dNyquist = raw.info.sfreq / 2.0;
+    m_lFilterData << FilterData("BPF", FilterData::BPF, 512, 20.5 / dNyquist, 39.0 / dNyquist, 5.0 / dNyquist, raw.info.sfreq, 4096, FilterData::Cosine);
+}
+
+
+//*************************************************************************************************************
+
+void BenchRtFilter::filterBlock_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchRtFilter::filterBlock()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    //Stream the data in blocks of 200 samples, as they arrive in MNE Scan
+    const int iBlockSize = 200;
+    const int iNumBlocks = m_matData.cols() / iBlockSize;
+
+    RtFilter rtFilter;
+    QVERIFY(rtFilter.prepare(m_lFilterData, m_vecChannels, m_matData.rows(), iBlockSize));
+
+    MatrixXd matBlock, matFiltered;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        for(int i = 0; i < iNumBlocks; ++i) {
+            matBlock = m_matData.middleCols(i * iBlockSize, iBlockSize);
+            rtFilter.filter(matBlock, matFiltered);
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void BenchRtFilter::filterBlockFloat_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchRtFilter::filterBlockFloat()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    const int iBlockSize = 200;
+    const int iNumBlocks = m_matData.cols() / iBlockSize;
+
+    RtFilterF rtFilterFloat;
+    QVERIFY(rtFilterFloat.prepare(m_lFilterData, m_vecChannels, m_matData.rows(), iBlockSize));
+
+    const MatrixXf matDataFloat = m_matData.cast<float>();
+    MatrixXf matBlock, matFiltered;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        for(int i = 0; i < iNumBlocks; ++i) {
+            matBlock = matDataFloat.middleCols(i * iBlockSize, iBlockSize);
+            rtFilterFloat.filter(matBlock, matFiltered);
+        }
+    }
+
+    //Compare one stream with the double precision filter. The rounding error scales with the input, e.g. with the
+    //offsets the band pass removes, so it is taken relative to the largest input amplitude of the channel
+    RtFilter rtFilter;
+    QVERIFY(rtFilter.prepare(m_lFilterData, m_vecChannels, m_matData.rows(), iBlockSize));
+    QVERIFY(rtFilterFloat.prepare(m_lFilterData, m_vecChannels, m_matData.rows(), iBlockSize));
+
+    MatrixXd matBlockDouble, matFilteredDouble;
+    double dMaxError = 0.0;
+    for(int i = 0; i < iNumBlocks; ++i) {
+        matBlockDouble = m_matData.middleCols(i * iBlockSize, iBlockSize);
+        matBlock = matDataFloat.middleCols(i * iBlockSize, iBlockSize);
+        rtFilter.filter(matBlockDouble, matFilteredDouble);
+        rtFilterFloat.filter(matBlock, matFiltered);
+
+        for(int c = 0; c < m_vecChannels.size(); ++c) {
+            int iChannel = m_vecChannels[c];
+            double dScale = matBlockDouble.row(iChannel).cwiseAbs().maxCoeff();
+            if(dScale > 0.0) {
+                dMaxError = qMax(dMaxError, (matFilteredDouble.row(iChannel) - matFiltered.row(iChannel).cast<double>()).cwiseAbs().maxCoeff() / dScale);
+            }
+        }
+    }
+
+    printf("[BenchRtFilter] maximal relative deviation of the single precision filter %g\n", dMaxError);
+    QVERIFY(dMaxError < 1e-4);
+}
+
+
+//*************************************************************************************************************
+
+void BenchRtFilter::filterChannelsConcurrently_data()
+{
+    m_recorder.addThreadRows();
+}
+
+
+//*************************************************************************************************************
+
+void BenchRtFilter::filterChannelsConcurrently()
+{
+    QFETCH(int, threads);
+    m_recorder.setThreads(threads);
+
+    RtFilter rtFilter;
+
+    MatrixXd matFiltered;
+    QBENCHMARK {
+        BenchmarkTimer timer(m_recorder, threads);
+        matFiltered = rtFilter.filterChannelsConcurrently(m_matData, 512, m_vecChannels, m_lFilterData);
+    }
+
+    QCOMPARE(matFiltered.rows(), m_matData.rows());
+}
+
+
+//*************************************************************************************************************
+
+void BenchRtFilter::steadyStateAllocations()
+{
+    if(!AllocationCounter::isSupported()) {
+        QSKIP("The heap allocations can only be counted with glibc.");
+    }
+
+    //QtConcurrent allocates for each parallel call, the steady state is checked on one thread
+    m_recorder.setThreads(1);
+
+    const int iBlockSize = 200;
+    const int iNumBlocks = m_matData.cols() / iBlockSize;
+    const int iWarmUpBlocks = 2;
+
+    //The block size is a multiple of the decimation, so every block gets the same number of output samples
+    RtFilter rtFilter;
+    RtResample rtResample(1, 2, m_matData.rows());
+
+    MatrixXd matBlock, matFiltered, matResampled;
+    qint64 iAllocations = 0;
+
+    for(int i = 0; i < iNumBlocks; ++i) {
+        //The first blocks prepare the filter and size the workspaces
+        if(i == iWarmUpBlocks) {
+            iAllocations = AllocationCounter::count();
+        }
+
+        matBlock = m_matData.middleCols(i * iBlockSize, iBlockSize);
+        QVERIFY(rtFilter.filterChannelsConcurrently(matBlock, matFiltered, m_vecChannels, m_lFilterData));
+        QVERIFY(rtResample.resample(matFiltered, matResampled));
+    }
+
+    iAllocations = AllocationCounter::count() - iAllocations;
+    printf("[BenchRtFilter] %lld heap allocations in %d steady state blocks\n", iAllocations, iNumBlocks - iWarmUpBlocks);
+
+    QCOMPARE(iAllocations, qint64(0));
+}
+
+
+//*************************************************************************************************************
+
+void BenchRtFilter::cleanup()
+{
+    m_recorder.setThreads(-1);
+}
+
+
+//*************************************************************************************************************
+
+void BenchRtFilter::cleanupTestCase()
+{
+    m_recorder.setThreads(-1);
+    m_recorder.write();
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(BenchRtFilter)
+#include "bench_rtfilter.moc"
@@ -0,0 +1,288 @@
+//=============================================================================================================
+/**
+* @file     benchmark_recorder.h
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    BenchmarkRecorder and BenchmarkTimer declaration and inline implementation.
+*
+*/
+
+#ifndef BENCHMARK_RECORDER_H
+#define BENCHMARK_RECORDER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDateTime>
+#include <QSysInfo>
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QVector>
+
+#include <algorithm>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE CLASS BenchmarkRecorder
+//=============================================================================================================
+
+/**
+* Collects the wall times of the benchmarks of one suite and writes them to a JSON file, so runs on different
+* machines and commits can be compared by scripts. QtTest prints its QBENCHMARK results as text or XML only.
+*
+* The thread counts of the sweep are the powers of two up to QThreadPool::maxThreadCount plus the maximum
+* itself. They can be set with the environment variable MNE_BENCHMARK_THREADS, e.g. "1,4,8". The results are
+* written to MNE_BENCHMARK_OUT or, if it is not set, to ./benchmark-results/<suite>.json.
+*
+* @brief Records benchmark samples and writes them as JSON.
+*/
+class BenchmarkRecorder
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a recorder for the given suite.
+    *
+    * @param[in] sSuite     The name of the suite, used for the file name of the results.
+    */
+    explicit BenchmarkRecorder(const QString& sSuite)
+    : m_sSuite(sSuite)
+    , m_iMaxThreads(QThreadPool::globalInstance()->maxThreadCount())
+    {
+    }
+
+    //=========================================================================================================
+    /**
+    * Returns the thread counts the benchmarks are swept over.
+    *
+    * @return The thread counts in ascending order.
+    */
+    QList<int> threadCounts() const
+    {
+        QList<int> lThreads;
+
+        QString sThreads = QString::fromLocal8Bit(qgetenv("MNE_BENCHMARK_THREADS"));
+        if(!sThreads.isEmpty()) {
+            QStringList lItems = sThreads.split(",", QString::SkipEmptyParts);
+            for(int i = 0; i < lItems.size(); ++i) {
+                int iThreads = lItems.at(i).trimmed().toInt();
+                if(iThreads > 0 && !lThreads.contains(iThreads)) {
+                    lThreads << iThreads;
+                }
+            }
+            std::sort(lThreads.begin(), lThreads.end());
+        }
+
+        if(lThreads.isEmpty()) {
+            for(int n = 1; n < m_iMaxThreads; n *= 2) {
+                lThreads << n;
+            }
+            lThreads << m_iMaxThreads;
+        }
+
+        return lThreads;
+    }
+
+    //=========================================================================================================
+    /**
+    * Adds the column "threads" and one row per thread count to the data table of the current benchmark.
+    * Call it from the _data() function of the benchmark.
+    */
+    void addThreadRows() const
+    {
+        QTest::addColumn<int>("threads");
+
+        QList<int> lThreads = threadCounts();
+        for(int i = 0; i < lThreads.size(); ++i) {
+            QTest::newRow(QString("%1 threads").arg(lThreads.at(i)).toUtf8().constData()) << lThreads.at(i);
+        }
+    }
+
+    //=========================================================================================================
+    /**
+    * Sets the number of threads of the global thread pool, which all parallel code of the libraries runs on.
+    *
+    * @param[in] iThreads   The number of threads, the original count if iThreads < 1.
+    */
+    void setThreads(int iThreads) const
+    {
+        QThreadPool::globalInstance()->setMaxThreadCount(iThreads > 0 ? iThreads : m_iMaxThreads);
+    }
+
+    //=========================================================================================================
+    /**
+    * Adds a sample.
+    *
+    * @param[in] sName      The name of the benchmark.
+    * @param[in] iThreads   The number of threads the sample was taken with.
+    * @param[in] iNsecs     The wall time in nanoseconds.
+    */
+    void addSample(const QString& sName, int iThreads, qint64 iNsecs)
+    {
+        QString sKey = QString("%1@%2").arg(sName).arg(iThreads, 4, 10, QChar('0'));
+        if(!m_mapSamples.contains(sKey)) {
+            m_lKeys << sKey;
+            m_mapNames.insert(sKey, qMakePair(sName, iThreads));
+        }
+        m_mapSamples[sKey].append(iNsecs);
+    }
+
+    //=========================================================================================================
+    /**
+    * Writes the samples recorded so far. Each benchmark and thread count is summarized by the number of
+    * iterations and the minimum, median and mean wall time, the speedup is relative to the smallest thread
+    * count of the benchmark.
+    *
+    * @return true if the file was written, false otherwise.
+    */
+    bool write() const
+    {
+        QJsonArray jsonResults;
+        QMap<QString, double> mapReference;
+
+        for(int i = 0; i < m_lKeys.size(); ++i) {
+            QVector<qint64> vecSamples = m_mapSamples.value(m_lKeys.at(i));
+            if(vecSamples.isEmpty()) {
+                continue;
+            }
+            std::sort(vecSamples.begin(), vecSamples.end());
+
+            double dSum = 0.0;
+            for(int j = 0; j < vecSamples.size(); ++j) {
+                dSum += vecSamples.at(j);
+            }
+
+            const QPair<QString, int> pairName = m_mapNames.value(m_lKeys.at(i));
+            double dMedian = vecSamples.at(vecSamples.size() / 2) / 1.0e6;
+            if(!mapReference.contains(pairName.first)) {
+                mapReference.insert(pairName.first, dMedian);
+            }
+
+            QJsonObject jsonResult;
+            jsonResult.insert("name", pairName.first);
+            jsonResult.insert("threads", pairName.second);
+            jsonResult.insert("iterations", vecSamples.size());
+            jsonResult.insert("min_ms", vecSamples.first() / 1.0e6);
+            jsonResult.insert("median_ms", dMedian);
+            jsonResult.insert("mean_ms", dSum / vecSamples.size() / 1.0e6);
+            jsonResult.insert("speedup", dMedian > 0.0 ? mapReference.value(pairName.first) / dMedian : 0.0);
+            jsonResults.append(jsonResult);
+        }
+
+        QJsonObject jsonRoot;
+        jsonRoot.insert("suite", m_sSuite);
+        jsonRoot.insert("date", QDateTime::currentDateTime().toString(Qt::ISODate));
+        jsonRoot.insert("qt_version", QString(qVersion()));
+        jsonRoot.insert("cpu_architecture", QSysInfo::currentCpuArchitecture());
+        jsonRoot.insert("max_threads", m_iMaxThreads);
+        jsonRoot.insert("results", jsonResults);
+
+        QString sPath = QString::fromLocal8Bit(qgetenv("MNE_BENCHMARK_OUT"));
+        if(sPath.isEmpty()) {
+            sPath = QDir::currentPath() + "/benchmark-results";
+        }
+        if(!QDir().mkpath(sPath)) {
+            qWarning("BenchmarkRecorder::write - Could not create %s.", sPath.toUtf8().constData());
+            return false;
+        }
+
+        QFile file(sPath + "/" + m_sSuite + ".json");
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning("BenchmarkRecorder::write - Could not open %s.", file.fileName().toUtf8().constData());
+            return false;
+        }
+        file.write(QJsonDocument(jsonRoot).toJson());
+        printf("[BenchmarkRecorder] Results written to %s\n", file.fileName().toUtf8().constData());
+
+        return true;
+    }
+
+private:
+    QString                                 m_sSuite;       /**< The name of the suite. */
+    int                                     m_iMaxThreads;  /**< The thread count of the global pool at construction. */
+    QStringList                             m_lKeys;        /**< The keys of the samples in the order they were first added. */
+    QMap<QString, QPair<QString, int> >     m_mapNames;     /**< The benchmark name and thread count of each key. */
+    QMap<QString, QVector<qint64> >         m_mapSamples;   /**< The wall times in nanoseconds of each key. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE CLASS BenchmarkTimer
+//=============================================================================================================
+
+/**
+* Times the scope it lives in and adds the wall time to a BenchmarkRecorder. Put it first into the body of a
+* QBENCHMARK block, so each iteration is recorded. The name is the current test function.
+*
+* @brief Scoped benchmark timer.
+*/
+class BenchmarkTimer
+{
+public:
+    //=========================================================================================================
+    /**
+    * Starts the timer.
+    *
+    * @param[in] recorder   The recorder the sample is added to.
+    * @param[in] iThreads   The number of threads the sample is taken with.
+    */
+    BenchmarkTimer(BenchmarkRecorder& recorder, int iThreads)
+    : m_recorder(recorder)
+    , m_iThreads(iThreads)
+    {
+        m_timer.start();
+    }
+
+    //=========================================================================================================
+    /**
+    * Stops the timer and adds the sample.
+    */
+    ~BenchmarkTimer()
+    {
+        m_recorder.addSample(QString(QTest::currentTestFunction()), m_iThreads, m_timer.nsecsElapsed());
+    }
+
+private:
+    BenchmarkRecorder&  m_recorder;     /**< The recorder the sample is added to. */
+    int                 m_iThreads;     /**< The number of threads the sample is taken with. */
+    QElapsedTimer       m_timer;        /**< The timer. */
+};
+
+#endif // BENCHMARK_RECORDER_H
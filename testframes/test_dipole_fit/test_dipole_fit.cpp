@@ -77,6 +77,9 @@ private slots:
     void initTestCase();
     void dipoleFitSimple();
     void dipoleFitAdvanced();
+    void dipoleFitParallel();
+    void dipoleFitGradient();
+    void dipoleFitPackedCoils();
     void cleanupTestCase();
 
 private:
@@ -273,6 +276,215 @@ void TestDipoleFit::dipoleFitAdvanced()
 }
 
 
+//*************************************************************************************************************
+
+void TestDipoleFit::dipoleFitParallel()
+{
+    QString refFileName(QDir::currentPath()+"/mne-cpp-test-data/Result/ref_dip_fit.dat");
+    QFile testFile;
+
+    //*********************************************************************************************************
+    // Dipole Fit Settings
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Dipole Fit Settings >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    //Same as dipoleFitSimple, distributed over four threads. Without warm starts every time point is fitted exactly as in the serial run.
+    DipoleFitSettings settings;
+    testFile.setFileName(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif"); QVERIFY( testFile.exists() );
+    settings.measname = testFile.fileName();
+    settings.is_raw = false;
+    settings.setno = 1;
+    settings.include_meg = true;
+    settings.include_eeg = true;
+    settings.tmin = 32.0f/1000.0f;
+    settings.tmax = 148.0f/1000.0f;
+    settings.bmin = -100.0f/1000.0f;
+    settings.bmax = 0.0f/1000.0f;
+    settings.dipname = QDir::currentPath()+"/mne-cpp-test-data/Result/dip_fit_parallel.dat";
+    settings.nthreads = 4;
+
+    settings.checkIntegrity();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Dipole Fit Settings Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+
+
+    //*********************************************************************************************************
+    // Compute Dipole Fit
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compute Dipole Fit >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    DipoleFit dipFit(&settings);
+    ECDSet set = dipFit.calculateFit();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compute Dipole Fit Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+
+
+    //*********************************************************************************************************
+    // Compare to the serial reference
+    //*********************************************************************************************************
+
+    set.save_dipoles_dip(settings.dipname);
+    m_ECDSet = ECDSet::read_dipoles_dip(settings.dipname);
+    m_refECDSet = ECDSet::read_dipoles_dip(refFileName);
+
+    compareFit();
+}
+
+
+//*************************************************************************************************************
+
+void TestDipoleFit::dipoleFitGradient()
+{
+    QFile testFile;
+
+    //
+    // Dipole Fit Settings
+    //
+    //Same time window as dipoleFitSimple with MEG only, where all field gradients are analytic
+    DipoleFitSettings settings;
+    testFile.setFileName(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif"); QVERIFY( testFile.exists() );
+    settings.measname = testFile.fileName();
+    settings.is_raw = false;
+    settings.setno = 1;
+    settings.include_meg = true;
+    settings.include_eeg = false;
+    settings.tmin = 32.0f/1000.0f;
+    settings.tmax = 148.0f/1000.0f;
+    settings.bmin = -100.0f/1000.0f;
+    settings.bmax = 0.0f/1000.0f;
+
+    settings.checkIntegrity();
+
+    //
+    // Fit with the simplex and with Levenberg-Marquardt
+    //
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compare Simplex and Gradient Fit >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    QElapsedTimer timer;
+
+    timer.start();
+    ECDSet simplexSet = DipoleFit(&settings).calculateFit();
+    qint64 simplexTime = timer.elapsed();
+
+    settings.gradient_fit = true;
+    timer.start();
+    ECDSet gradientSet = DipoleFit(&settings).calculateFit();
+    qint64 gradientTime = timer.elapsed();
+
+    QVERIFY( simplexSet.size() > 0 );
+    QVERIFY( simplexSet.size() == gradientSet.size() );
+
+    double simplexEval = 0.0, gradientEval = 0.0, gradientGrad = 0.0;
+    double simplexGood = 0.0, gradientGood = 0.0;
+
+    for (int i = 0; i < simplexSet.size(); ++i)
+    {
+        printf("Dipole %d: %7.1f ms simplex %4d evaluations g = %6.2f %% gradient %4d evaluations %4d gradients g = %6.2f %%\n", i,
+                1000*simplexSet[i].time,simplexSet[i].neval,100.0*simplexSet[i].good,gradientSet[i].neval,gradientSet[i].ngrad,100.0*gradientSet[i].good);
+
+        QVERIFY( gradientSet[i].valid );
+        QVERIFY( simplexSet[i].ngrad == 0 );
+        QVERIFY( gradientSet[i].ngrad > 0 );
+        simplexEval += simplexSet[i].neval;
+        gradientEval += gradientSet[i].neval;
+        gradientGrad += gradientSet[i].ngrad;
+        simplexGood += simplexSet[i].good;
+        gradientGood += gradientSet[i].good;
+    }
+    simplexEval /= simplexSet.size(); gradientEval /= gradientSet.size(); gradientGrad /= gradientSet.size();
+    simplexGood /= simplexSet.size(); gradientGood /= gradientSet.size();
+
+    // A field gradient evaluates the field and its derivatives along the three coordinates, it is weighted as
+    // the 1 + 3 evaluations a finite difference gradient would need
+    double gradientCost = gradientEval + 4.0*gradientGrad;
+
+    printf("Simplex  : %6.1f evaluations per dipole, mean g = %6.2f %%, %lld ms\n",simplexEval,100.0*simplexGood,simplexTime);
+    printf("Gradient : %6.1f evaluations and %6.1f gradients per dipole (%6.1f weighted), mean g = %6.2f %%, %lld ms\n",
+           gradientEval,gradientGrad,gradientCost,100.0*gradientGood,gradientTime);
+
+    QVERIFY( gradientCost < simplexEval );
+    QVERIFY( gradientGood > simplexGood - 0.001 );
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compare Simplex and Gradient Fit Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
+//*************************************************************************************************************
+
+void TestDipoleFit::dipoleFitPackedCoils()
+{
+    QFile testFile;
+
+    //
+    // Dipole Fit Settings
+    //
+    //Same time window as dipoleFitGradient, the sphere model field is evaluated over the coil integration points
+    DipoleFitSettings settings;
+    testFile.setFileName(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif"); QVERIFY( testFile.exists() );
+    settings.measname = testFile.fileName();
+    settings.is_raw = false;
+    settings.setno = 1;
+    settings.include_meg = true;
+    settings.include_eeg = false;
+    settings.accurate = true;
+    settings.tmin = 32.0f/1000.0f;
+    settings.tmax = 148.0f/1000.0f;
+    settings.bmin = -100.0f/1000.0f;
+    settings.bmax = 0.0f/1000.0f;
+
+    settings.checkIntegrity();
+
+    //
+    // Fit with the per coil and with the packed coil integration points
+    //
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compare Coil and Packed Coil Fit >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    QElapsedTimer timer;
+
+    timer.start();
+    ECDSet coilSet = DipoleFit(&settings).calculateFit();
+    qint64 coilTime = timer.elapsed();
+
+    settings.packed_coils = true;
+    timer.start();
+    ECDSet packedSet = DipoleFit(&settings).calculateFit();
+    qint64 packedTime = timer.elapsed();
+
+    QVERIFY( coilSet.size() > 0 );
+    QVERIFY( coilSet.size() == packedSet.size() );
+
+    double maxDist = 0.0, maxGood = 0.0;
+    qint64 coilEval = 0, packedEval = 0;
+
+    for (int i = 0; i < coilSet.size(); ++i)
+    {
+        double dist = (coilSet[i].rd - packedSet[i].rd).norm();
+        double good = std::fabs(coilSet[i].good - packedSet[i].good);
+
+        printf("Dipole %d: %7.1f ms distance %8.4f mm g difference %8.5f %%\n", i,
+                1000*coilSet[i].time,1000*dist,100.0*good);
+
+        QVERIFY( packedSet[i].valid == coilSet[i].valid );
+        maxDist = std::max(maxDist,dist);
+        maxGood = std::max(maxGood,good);
+        coilEval += coilSet[i].neval;
+        packedEval += packedSet[i].neval;
+    }
+
+    printf("Coil   : %lld evaluations, %lld ms, %8.1f evaluations/s\n",coilEval,coilTime,1000.0*coilEval/qMax(coilTime,(qint64)1));
+    printf("Packed : %lld evaluations, %lld ms, %8.1f evaluations/s\n",packedEval,packedTime,1000.0*packedEval/qMax(packedTime,(qint64)1));
+    printf("Max distance %8.4f mm, max g difference %8.5f %%\n",1000*maxDist,100.0*maxGood);
+
+    //The single-precision sums may make the simplex take a different path, the fits must agree within 0.1 mm
+    QVERIFY( maxDist < 1e-4 );
+    QVERIFY( maxGood < 1e-3 );
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compare Coil and Packed Coil Fit Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+
 //*************************************************************************************************************
 
 void TestDipoleFit::compareFit()
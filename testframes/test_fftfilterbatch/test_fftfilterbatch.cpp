@@ -0,0 +1,240 @@
+//=============================================================================================================
+/**
+* @file     test_fftfilterbatch.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the batched multi-channel FFT filter
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/filterTools/fftfilterbatch.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFFTFilterBatch
+*
+* @brief The TestFFTFilterBatch class compares the batched FFT filter with a direct convolution, for any number
+*        of batches, with padding and output offsets and in single precision
+*
+*/
+class TestFFTFilterBatch: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFFTFilterBatch();
+
+private slots:
+    void initTestCase();
+    void compareConvolution_data();
+    void compareConvolution();
+    void compareOffsets();
+    void compareFloat();
+    void rejectSizes();
+    void cleanupTestCase();
+
+private:
+    double          epsilon;
+
+    int             m_iFFTLength;   /**< Length of the FFT frames. */
+    RowVectorXd     m_vecTaps;      /**< The filter taps. */
+    RowVectorXcd    m_vecSpectrum;  /**< Half spectrum of the taps. */
+    MatrixXd        m_matData;      /**< The channels to filter. */
+    MatrixXd        m_matRef;       /**< Direct linear convolution of the channels with the taps. */
+};
+
+
+//*************************************************************************************************************
+
+TestFFTFilterBatch::TestFFTFilterBatch()
+: epsilon(1e-10)
+, m_iFFTLength(256)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFFTFilterBatch::initTestCase()
+{
+    std::srand(11);
+
+    m_vecTaps = RowVectorXd::Random(31);
+    m_matData = MatrixXd::Random(7, 200);
+
+    RowVectorXd vecFrame = RowVectorXd::Zero(m_iFFTLength);
+    vecFrame.head(m_vecTaps.cols()) = m_vecTaps;
+
+    FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+    fft.fwd(m_vecSpectrum, vecFrame);
+
+    // The frame holds the full linear convolution, so the circular one equals it
+    qint32 iConvLength = m_matData.cols() + m_vecTaps.cols() - 1;
+    m_matRef = MatrixXd::Zero(m_matData.rows(), iConvLength);
+    for(qint32 r = 0; r < m_matData.rows(); ++r)
+        for(qint32 i = 0; i < m_matData.cols(); ++i)
+            for(qint32 k = 0; k < m_vecTaps.cols(); ++k)
+                m_matRef(r, i + k) += m_matData(r, i) * m_vecTaps(k);
+}
+
+
+//*************************************************************************************************************
+
+void TestFFTFilterBatch::compareConvolution_data()
+{
+    QTest::addColumn<int>("batches");
+
+    QTest::newRow("1 batch") << 1;
+    QTest::newRow("3 batches") << 3;
+    QTest::newRow("more batches than rows") << 16;
+}
+
+
+//*************************************************************************************************************
+
+void TestFFTFilterBatch::compareConvolution()
+{
+    QFETCH(int, batches);
+
+    FFTFilterBatch filter(m_vecSpectrum, m_iFFTLength, batches);
+    QVERIFY( !filter.isEmpty() );
+    QCOMPARE( filter.fftLength(), m_iFFTLength );
+
+    MatrixXd matOut;
+    QVERIFY( filter.filter(m_matData, matOut) );
+
+    QCOMPARE( (int)matOut.rows(), (int)m_matData.rows() );
+    QCOMPARE( (int)matOut.cols(), m_iFFTLength );
+    QVERIFY( (matOut.leftCols(m_matRef.cols()) - m_matRef).cwiseAbs().maxCoeff() < epsilon );
+    QVERIFY( matOut.rightCols(m_iFFTLength - m_matRef.cols()).cwiseAbs().maxCoeff() < epsilon );
+
+    // The workspaces are reused by the next call
+    MatrixXd matSecond;
+    QVERIFY( filter.filter(m_matData.topRows(2), matSecond) );
+    QVERIFY( matSecond == matOut.topRows(2) );
+}
+
+
+//*************************************************************************************************************
+
+void TestFFTFilterBatch::compareOffsets()
+{
+    FFTFilterBatch filter(m_vecSpectrum, m_iFFTLength, 3);
+
+    // Data placed behind 15 zeros is delayed by 15 samples, reading from there returns the convolution from 0
+    MatrixXd matOut;
+    QVERIFY( filter.filter(m_matData, matOut, 15, 15, m_matData.cols()) );
+
+    QCOMPARE( (int)matOut.cols(), (int)m_matData.cols() );
+    QVERIFY( (matOut - m_matRef.leftCols(m_matData.cols())).cwiseAbs().maxCoeff() < epsilon );
+}
+
+
+//*************************************************************************************************************
+
+void TestFFTFilterBatch::compareFloat()
+{
+    FFTFilterBatchF filter(m_vecSpectrum, m_iFFTLength, 3);
+
+    MatrixXf matOut;
+    QVERIFY( filter.filter(m_matData.cast<float>(), matOut, 0, 0, m_matRef.cols()) );
+
+    double dScale = m_matRef.cwiseAbs().maxCoeff();
+    QVERIFY( (matOut.cast<double>() - m_matRef).cwiseAbs().maxCoeff() < 1e-5 * dScale );
+}
+
+
+//*************************************************************************************************************
+
+void TestFFTFilterBatch::rejectSizes()
+{
+    // The spectrum has to have iFFTLength/2+1 bins
+    FFTFilterBatch filter;
+    QVERIFY( filter.isEmpty() );
+    QVERIFY( !filter.setSpectrum(m_vecSpectrum, 2 * m_iFFTLength) );
+    QVERIFY( filter.isEmpty() );
+    QCOMPARE( filter.fftLength(), 0 );
+
+    // Data and output have to fit the frame
+    QVERIFY( filter.setSpectrum(m_vecSpectrum, m_iFFTLength) );
+
+    MatrixXd matOut;
+    QVERIFY( !filter.filter(m_matData, matOut, m_iFFTLength - 10) );
+    QVERIFY( !filter.filter(m_matData, matOut, 0, 100, m_iFFTLength) );
+    QVERIFY( !filter.filter(MatrixXd::Zero(1, m_iFFTLength + 1), matOut) );
+}
+
+
+//*************************************************************************************************************
+
+void TestFFTFilterBatch::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFFTFilterBatch)
+#include "test_fftfilterbatch.moc"
@@ -40,6 +40,7 @@
 //=============================================================================================================
 
 #include <fiff/fiff_cov.h>
+#include <fiff/fiff_raw_data.h>
 
 #include <iostream>
 #include <utils/ioutils.h>
@@ -53,6 +54,14 @@
 #include <QtTest>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Eigenvalues>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -83,6 +92,8 @@ private slots:
     void compareDiag();
     void compareDim();
     void compareNfree();
+    void computeProjFromRaw();
+    void computeCovFromRaw();
     void cleanupTestCase();
 
 private:
@@ -173,6 +184,107 @@ void TestFiffCov::compareNfree()
 }
 
 
+//*************************************************************************************************************
+
+void TestFiffCov::computeProjFromRaw()
+{
+    QFile t_fileRaw(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    FiffRawData raw(t_fileRaw);
+
+    //
+    //   Reference: eigenvectors of the magnetometer data of the accepted segments
+    //
+    qint32 iStep = qRound(raw.info.sfreq);
+    qint32 nSegments = (raw.last_samp - raw.first_samp + 1) / iStep;
+
+    RowVectorXi picks = raw.info.pick_types(QString("mag"), false, false, QStringList(), raw.info.bads);
+    MatrixXd data, times;
+    QVERIFY( raw.read_raw_segment(data, times, raw.first_samp, raw.first_samp + nSegments * iStep - 1, picks) );
+
+    MatrixXd XXt = data * data.transpose();
+    SelfAdjointEigenSolver<MatrixXd> es(XXt);
+
+    QList<FiffProj> projsCov = FiffProj::compute_from_raw(raw, 1.0f, 0, 3, 0);
+    QList<FiffProj> projsRand = FiffProj::compute_from_raw(raw, 1.0f, 0, 3, 0, QMap<QString,double>(), FiffProj::RandomizedDecomposition);
+
+    QVERIFY( projsCov.size() == 3 && projsRand.size() == 3 );
+    for(qint32 k = 0; k < 3; ++k)
+    {
+        VectorXd u = es.eigenvectors().col(picks.size() - 1 - k);
+
+        QVERIFY( projsCov[k].kind == FIFFV_PROJ_ITEM_FIELD && !projsCov[k].active );
+        QVERIFY( projsCov[k].data->ncol == picks.size() && projsCov[k].data->col_names.size() == picks.size() );
+        QVERIFY( projsCov[k].desc.startsWith("axial-Raw-") );
+
+        QVERIFY( std::fabs(std::fabs(projsCov[k].data->data.row(0).dot(u.transpose())) - 1.0) < epsilon );
+        QVERIFY( std::fabs(std::fabs(projsRand[k].data->data.row(0).dot(u.transpose())) - 1.0) < 1e-3 );
+    }
+
+    //
+    //   A rejection limit below the data range removes all segments
+    //
+    QMap<QString,double> mapReject;
+    mapReject.insert("mag", 1e-15);
+    QVERIFY( FiffProj::compute_from_raw(raw, 1.0f, 0, 3, 0, mapReject).isEmpty() );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffCov::computeCovFromRaw()
+{
+    QFile t_fileRaw(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    FiffRawData raw(t_fileRaw);
+
+    RowVectorXi picks = raw.info.pick_types(QString("mag"), false, false, QStringList(), raw.info.bads);
+
+    //
+    //   Reference: sum of the products of the separately demeaned segments
+    //
+    float fTStep = 0.2f;
+    qint32 iStep = qRound(fTStep * raw.info.sfreq);
+    qint32 nSegments = (raw.last_samp - raw.first_samp + 1) / iStep;
+
+    MatrixXd matRef = MatrixXd::Zero(picks.size(), picks.size());
+    MatrixXd data, times;
+    for(qint32 s = 0; s < nSegments; ++s)
+    {
+        fiff_int_t from = raw.first_samp + s * iStep;
+        QVERIFY( raw.read_raw_segment(data, times, from, from + iStep - 1, picks) );
+
+        data.colwise() -= data.rowwise().mean();
+        matRef += data * data.transpose();
+    }
+    matRef /= (double)(nSegments * iStep - nSegments);
+
+    FiffCov cov = FiffCov::compute_from_raw(raw, picks, fTStep);
+
+    QVERIFY( cov.kind == FIFFV_MNE_NOISE_COV && !cov.diag );
+    QVERIFY( cov.dim == picks.size() && cov.names.size() == picks.size() );
+    QVERIFY( cov.names[0] == raw.info.ch_names[picks[0]] );
+    QVERIFY( cov.nfree == nSegments * iStep - nSegments );
+    QVERIFY( (cov.data - matRef).norm() / matRef.norm() < epsilon );
+
+    //
+    //   The shrinkage keeps the trace of the single channel type and scales the off-diagonal elements uniformly
+    //
+    FiffCov covLW = FiffCov::compute_from_raw(raw, picks, fTStep, QMap<QString,double>(), FiffCov::LedoitWolf);
+
+    QVERIFY( std::fabs(covLW.data.trace() - cov.data.trace()) / cov.data.trace() < epsilon );
+
+    double dRatio = covLW.data(1,0) / cov.data(1,0);
+    QVERIFY( dRatio >= 0.0 && dRatio <= 1.0 );
+    QVERIFY( std::fabs(covLW.data(2,0) / cov.data(2,0) - dRatio) < epsilon );
+
+    //
+    //   A rejection limit below the data range removes all segments
+    //
+    QMap<QString,double> mapReject;
+    mapReject.insert("mag", 1e-15);
+    QVERIFY( FiffCov::compute_from_raw(raw, picks, fTStep, mapReject).data.size() == 0 );
+}
+
+
 //*************************************************************************************************************
 
 void TestFiffCov::cleanupTestCase()
@@ -76,6 +76,7 @@ public:
 private slots:
     void initTestCase();
     void checkFiffCoordTrans();
+    void readEvokedSetLazy();
     void cleanupTestCase();
 
 private:
@@ -165,6 +166,61 @@ void TestFiffMneTypesIO::checkFiffCoordTrans()
     stream->close();
 }
 
+//*************************************************************************************************************
+
+void TestFiffMneTypesIO::readEvokedSetLazy()
+{
+    QFile t_fileEager(evokedName);
+    FiffEvokedSet t_eagerSet;
+    QVERIFY(FiffEvokedSet::read(t_fileEager, t_eagerSet));
+    QVERIFY(t_eagerSet.evoked.size() > 1);
+
+    //Only the directory is read, the data sets are materialized on demand
+    QFile t_fileLazy(evokedName);
+    FiffEvokedSet t_lazySet;
+    QVERIFY(FiffEvokedSet::read_entries(t_fileLazy, t_lazySet));
+    QVERIFY(t_lazySet.evoked.isEmpty());
+    QCOMPARE(t_lazySet.evoked_nodes.size(), t_eagerSet.evoked.size());
+
+    qint32 i, j;
+    for(i = 0; i < t_lazySet.comments.size(); ++i) {
+        QCOMPARE(t_lazySet.find_entry(t_lazySet.comments[i], t_lazySet.aspect_kinds[i]), i);
+
+        FiffEvoked t_evoked;
+        QVERIFY(t_lazySet.read_evoked(i, t_evoked));
+        QCOMPARE(t_evoked.comment, t_eagerSet.evoked[i].comment);
+        QCOMPARE(t_evoked.data.rows(), t_eagerSet.evoked[i].data.rows());
+        QCOMPARE(t_evoked.data.cols(), t_eagerSet.evoked[i].data.cols());
+        QVERIFY((t_evoked.data - t_eagerSet.evoked[i].data).cwiseAbs().maxCoeff() <= 0.0);
+    }
+    QCOMPARE(t_lazySet.find_entry(QString("No such condition")), -1);
+
+    //Channel selection during reading equals reading everything and picking afterwards
+    QStringList t_include;
+    t_include << t_lazySet.info.ch_names[0] << t_lazySet.info.ch_names[2] << t_lazySet.info.ch_names[t_lazySet.info.nchan - 1];
+
+    for(j = 0; j < 2; ++j) {
+        bool t_bProj = (j == 0);
+
+        QFile t_fileRef(evokedName);
+        FiffEvoked t_reference;
+        QVERIFY(FiffEvoked::read(t_fileRef, t_reference, 1, defaultVariantPair, t_bProj));
+        FiffEvoked t_picked = t_reference.pick_channels(t_include);
+
+        FiffEvoked t_selected;
+        QVERIFY(t_lazySet.read_evoked(1, t_selected, t_include, defaultQStringList, defaultVariantPair, t_bProj));
+
+        QCOMPARE(t_selected.info.nchan, t_include.size());
+        QCOMPARE(t_selected.info.ch_names, t_picked.info.ch_names);
+        QCOMPARE(t_selected.data.rows(), t_picked.data.rows());
+        QVERIFY((t_selected.data - t_picked.data).cwiseAbs().maxCoeff() <= epsilon * t_picked.data.cwiseAbs().maxCoeff());
+    }
+
+    FiffEvoked t_outOfRange;
+    QVERIFY(!t_lazySet.read_evoked(t_lazySet.evoked_nodes.size(), t_outOfRange));
+}
+
+
 //*************************************************************************************************************
 
 void TestFiffMneTypesIO::cleanupTestCase()
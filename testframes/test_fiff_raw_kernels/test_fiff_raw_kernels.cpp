@@ -0,0 +1,327 @@
+//=============================================================================================================
+/**
+* @file     test_fiff_raw_kernels.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test and micro benchmark of the raw data dequantization kernels
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <fiff/fiff_raw_kernels.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define NCHAN   306
+#define NSAMP   10000
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiffRawKernels
+*
+* @brief The TestFiffRawKernels class verifies the vectorized dequantization kernels against the scalar
+*        version and benchmarks them against the Eigen based conversion on 306 x 10000 buffers
+*
+*/
+class TestFiffRawKernels: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiffRawKernels();
+
+private slots:
+    void initTestCase();
+    void compareBackends_data();
+    void compareBackends();
+    void benchmarkEigen_data();
+    void benchmarkEigen();
+    void benchmarkKernels_data();
+    void benchmarkKernels();
+    void cleanupTestCase();
+
+private:
+    void addTypes();
+    const QByteArray& buffer(fiff_int_t type) const;
+
+    QByteArray  m_baShort;      /**< Big endian 16 bit buffer. */
+    QByteArray  m_baInt;        /**< Big endian 32 bit buffer. */
+    QByteArray  m_baFloat;      /**< Big endian float buffer. */
+    VectorXd    m_vecCals;      /**< Calibration factors. */
+    FiffRawKernels::Backend m_detected; /**< Backend selected by the CPU detection. */
+};
+
+
+//*************************************************************************************************************
+
+TestFiffRawKernels::TestFiffRawKernels()
+: m_detected(FiffRawKernels::Scalar)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawKernels::initTestCase()
+{
+    m_detected = FiffRawKernels::backend();
+    qDebug() << "Detected backend:" << FiffRawKernels::backendName(m_detected);
+
+    const qint64 n = static_cast<qint64>(NCHAN)*NSAMP;
+    m_baShort.resize(n*sizeof(qint16));
+    m_baInt.resize(n*sizeof(qint32));
+    m_baFloat.resize(n*sizeof(float));
+
+    qsrand(42);
+    for(qint64 i = 0; i < n; ++i)
+    {
+        const qint32 value = qrand() - RAND_MAX/2;
+        const float fvalue = static_cast<float>(value)/RAND_MAX;
+        quint32 word;
+        memcpy(&word, &fvalue, sizeof(float));
+
+        qToBigEndian<qint16>(static_cast<qint16>(value), reinterpret_cast<uchar*>(m_baShort.data()) + i*sizeof(qint16));
+        qToBigEndian<qint32>(value, reinterpret_cast<uchar*>(m_baInt.data()) + i*sizeof(qint32));
+        qToBigEndian<quint32>(word, reinterpret_cast<uchar*>(m_baFloat.data()) + i*sizeof(float));
+    }
+
+    m_vecCals = VectorXd::Random(NCHAN);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawKernels::addTypes()
+{
+    QTest::addColumn<int>("type");
+
+    QTest::newRow("dau_pack16") << static_cast<int>(FIFFT_DAU_PACK16);
+    QTest::newRow("int") << static_cast<int>(FIFFT_INT);
+    QTest::newRow("float") << static_cast<int>(FIFFT_FLOAT);
+}
+
+
+//*************************************************************************************************************
+
+const QByteArray& TestFiffRawKernels::buffer(fiff_int_t type) const
+{
+    if (type == FIFFT_INT)
+        return m_baInt;
+    if (type == FIFFT_FLOAT)
+        return m_baFloat;
+    return m_baShort;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawKernels::compareBackends_data()
+{
+    addTypes();
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawKernels::compareBackends()
+{
+    QFETCH(int, type);
+    const uchar* src = reinterpret_cast<const uchar*>(buffer(type).constData());
+
+    //
+    //   Odd lengths exercise the scalar tails of the vector kernels
+    //
+    const qint32 n = NCHAN*7 + 5;
+    VectorXd reference(n), result(n), scale = VectorXd::Random(n);
+
+    QVERIFY(FiffRawKernels::setBackend(FiffRawKernels::Scalar));
+    QVERIFY(FiffRawKernels::dequantize(type, src, n, scale.data(), reference.data()));
+
+    for(int b = FiffRawKernels::SSE41; b <= FiffRawKernels::NEON; ++b)
+    {
+        FiffRawKernels::Backend backend = static_cast<FiffRawKernels::Backend>(b);
+        if (!FiffRawKernels::setBackend(backend))
+            continue;
+
+        result.setZero();
+        QVERIFY(FiffRawKernels::dequantize(type, src, n, scale.data(), result.data()));
+        QVERIFY2(result == reference, qPrintable(FiffRawKernels::backendName(backend)));
+
+        result.setZero();
+        QVERIFY(FiffRawKernels::dequantize(type, src, n, Q_NULLPTR, result.data()));
+        QVERIFY2(result.cwiseProduct(scale).isApprox(reference), qPrintable(FiffRawKernels::backendName(backend)));
+    }
+
+    FiffRawKernels::setBackend(m_detected);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawKernels::benchmarkEigen_data()
+{
+    addTypes();
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawKernels::benchmarkEigen()
+{
+    QFETCH(int, type);
+
+    //
+    //   The classic path: swap a copy of the buffer in place, widen it with Eigen and apply the calibration
+    //
+    QByteArray work(buffer(type));
+    MatrixXd data(NCHAN, NSAMP);
+    const qint64 n = static_cast<qint64>(NCHAN)*NSAMP;
+
+    QBENCHMARK {
+        memcpy(work.data(), buffer(type).constData(), work.size());
+        if (type == FIFFT_DAU_PACK16)
+        {
+            qint16* p = reinterpret_cast<qint16*>(work.data());
+            for(qint64 i = 0; i < n; ++i)
+                p[i] = qFromBigEndian<qint16>(reinterpret_cast<const uchar*>(p + i));
+            data = m_vecCals.asDiagonal()*Map<MatrixDau16>(p, NCHAN, NSAMP).cast<double>();
+        }
+        else if (type == FIFFT_INT)
+        {
+            qint32* p = reinterpret_cast<qint32*>(work.data());
+            for(qint64 i = 0; i < n; ++i)
+                p[i] = qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(p + i));
+            data = m_vecCals.asDiagonal()*Map<MatrixXi>(p, NCHAN, NSAMP).cast<double>();
+        }
+        else
+        {
+            quint32* p = reinterpret_cast<quint32*>(work.data());
+            for(qint64 i = 0; i < n; ++i)
+                p[i] = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(p + i));
+            data = m_vecCals.asDiagonal()*Map<MatrixXf>(reinterpret_cast<float*>(p), NCHAN, NSAMP).cast<double>();
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawKernels::benchmarkKernels_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<int>("backend");
+
+    for(int b = FiffRawKernels::Scalar; b <= FiffRawKernels::NEON; ++b)
+    {
+        FiffRawKernels::Backend backend = static_cast<FiffRawKernels::Backend>(b);
+        if (!FiffRawKernels::isSupported(backend))
+            continue;
+
+        const QByteArray name = FiffRawKernels::backendName(backend).toUtf8();
+        QTest::newRow(QByteArray("dau_pack16 " + name).constData()) << static_cast<int>(FIFFT_DAU_PACK16) << b;
+        QTest::newRow(QByteArray("int " + name).constData()) << static_cast<int>(FIFFT_INT) << b;
+        QTest::newRow(QByteArray("float " + name).constData()) << static_cast<int>(FIFFT_FLOAT) << b;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawKernels::benchmarkKernels()
+{
+    QFETCH(int, type);
+    QFETCH(int, backend);
+
+    QVERIFY(FiffRawKernels::setBackend(static_cast<FiffRawKernels::Backend>(backend)));
+
+    const uchar* src = reinterpret_cast<const uchar*>(buffer(type).constData());
+    const qint32 word = type == FIFFT_DAU_PACK16 ? sizeof(qint16) : sizeof(qint32);
+    MatrixXd data(NCHAN, NSAMP);
+
+    QBENCHMARK {
+        for(qint32 s = 0; s < NSAMP; ++s)
+            FiffRawKernels::dequantize(type, src + static_cast<qint64>(s)*NCHAN*word, NCHAN, m_vecCals.data(), data.col(s).data());
+    }
+
+    FiffRawKernels::setBackend(m_detected);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawKernels::cleanupTestCase()
+{
+    FiffRawKernels::setBackend(m_detected);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFiffRawKernels)
+#include "test_fiff_raw_kernels.moc"
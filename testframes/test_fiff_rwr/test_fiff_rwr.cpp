@@ -40,6 +40,10 @@
 //=============================================================================================================
 
 #include <fiff/fiff.h>
+#include <fiff/fiff_raw_prefetcher.h>
+#include <fiff/fiff_raw_splitter.h>
+#include <fiff/fiff_event_scanner.h>
+#include <utils/cachelocation.h>
 
 #include <iostream>
 
@@ -50,6 +54,9 @@
 //=============================================================================================================
 
 #include <QtTest>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
 
 
 //*************************************************************************************************************
@@ -59,6 +66,43 @@
 
 using namespace FIFFLIB;
 
+
+//=============================================================================================================
+/**
+* File whose writes can be held back, so the queue of the asynchronous writer fills up deterministically
+*
+* @brief File with a gate in front of the writes
+*/
+class GatedFile : public QFile
+{
+public:
+    GatedFile(const QString& name) : QFile(name), m_bOpen(true) {}
+
+    void setGateOpen(bool open)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bOpen = open;
+        m_cond.wakeAll();
+    }
+
+protected:
+    qint64 writeData(const char* data, qint64 len)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            while(!m_bOpen)
+                m_cond.wait(&m_mutex);
+        }
+        return QFile::writeData(data, len);
+    }
+
+private:
+    QMutex          m_mutex;
+    QWaitCondition  m_cond;
+    bool            m_bOpen;
+};
+
+
 //=============================================================================================================
 /**
 * DECLARE CLASS TestFiffRWR
@@ -78,6 +122,14 @@ private slots:
     void compareData();
     void compareTimes();
     void compareInfo();
+    void compareMappedRead();
+    void compareCompressedWrite();
+    void compareSplitWrite();
+    void compareBasicInfo();
+    void comparePrefetchedRead();
+    void compareEventScan();
+    void compareAsyncWrite();
+    void compareAsyncWriteDrop();
     void cleanupTestCase();
 
 private:
@@ -319,6 +371,383 @@ void TestFiffRWR::compareInfo()
     }
 }
 
+//*************************************************************************************************************
+
+void TestFiffRWR::compareMappedRead()
+{
+    QFile t_fileStream("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    QFile t_fileMapped("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+
+    FiffRawData raw_stream(t_fileStream);
+    FiffRawData raw_mapped(t_fileMapped);
+    QVERIFY( raw_mapped.file->map_file() );
+
+    fiff_int_t from = raw_stream.first_samp + 100;
+    fiff_int_t to = raw_stream.first_samp + 2*raw_stream.info.sfreq;
+
+    MatrixXd data_stream, data_mapped, times;
+    QVERIFY( raw_stream.read_raw_segment(data_stream, times, from, to) );
+    QVERIFY( raw_mapped.read_raw_segment(data_mapped, times, from, to) );
+
+    QVERIFY( data_stream.rows() == data_mapped.rows() && data_stream.cols() == data_mapped.cols() );
+    QVERIFY( (data_stream - data_mapped).cwiseAbs().maxCoeff() < epsilon );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareCompressedWrite()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    QFile t_filePlain("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_plain_out.fif");
+    QFile t_fileCompressed("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_compressed_out.fif");
+
+    FiffRawData raw(t_fileIn);
+    fiff_int_t from = raw.first_samp;
+    fiff_int_t quantum = ceil(raw.info.sfreq);
+
+    //
+    //   Write the same buffers uncompressed and compressed
+    //
+    RowVectorXd cals;
+    FiffStream::SPtr outPlain = FiffStream::start_writing_raw(t_filePlain, raw.info, cals);
+    FiffStream::SPtr outCompressed = FiffStream::start_writing_raw(t_fileCompressed, raw.info, cals);
+    outCompressed->set_raw_compression(true);
+    QVERIFY( outCompressed->raw_compression() );
+
+    outPlain->write_int(FIFF_FIRST_SAMPLE, &from);
+    outCompressed->write_int(FIFF_FIRST_SAMPLE, &from);
+
+    MatrixXd data, times;
+    for(fiff_int_t first = from; first < from + 3*quantum; first += quantum)
+    {
+        QVERIFY( raw.read_raw_segment(data, times, first, first + quantum - 1) );
+        outPlain->write_raw_buffer(data, cals);
+        outCompressed->write_raw_buffer(data, cals);
+    }
+    outPlain->finish_writing_raw();
+    outCompressed->finish_writing_raw();
+
+    QVERIFY( t_fileCompressed.size() < t_filePlain.size() );
+
+    //
+    //   Decoding is lossless, also when only a few channels are picked
+    //
+    FiffRawData rawPlain(t_filePlain);
+    FiffRawData rawCompressed(t_fileCompressed);
+    QVERIFY( rawPlain.last_samp == rawCompressed.last_samp );
+
+    MatrixXd dataPlain, dataCompressed;
+    QVERIFY( rawPlain.read_raw_segment(dataPlain, times, from + 100, from + 2*quantum) );
+    QVERIFY( rawCompressed.read_raw_segment(dataCompressed, times, from + 100, from + 2*quantum) );
+    QVERIFY( dataPlain == dataCompressed );
+
+    RowVectorXi sel(3);
+    sel << 0, 100, raw.info.nchan - 1;
+    QVERIFY( rawPlain.read_raw_segment(dataPlain, times, from, from + quantum, sel) );
+    QVERIFY( rawCompressed.read_raw_segment(dataCompressed, times, from, from + quantum, sel) );
+    QVERIFY( dataPlain == dataCompressed );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareSplitWrite()
+{
+    QString t_sFileSplit("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_split_out.fif");
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    QFile t_fileSplit(t_sFileSplit);
+
+    FiffRawData raw(t_fileIn);
+    fiff_int_t from = raw.first_samp;
+    fiff_int_t quantum = 600;
+
+    //
+    //   Parts of 2 MB hold two buffers each
+    //
+    RowVectorXd cals;
+    FiffStream::SPtr outSplit = FiffStream::start_writing_raw(t_fileSplit, raw.info, cals);
+    outSplit->write_int(FIFF_FIRST_SAMPLE, &from);
+    QVERIFY( outSplit->start_split_writing(2*1024*1024, from) );
+    QVERIFY( outSplit->is_split_writing() );
+
+    MatrixXd data, times;
+    for(fiff_int_t first = from; first < from + 6*quantum; first += quantum)
+    {
+        QVERIFY( raw.read_raw_segment(data, times, first, first + quantum - 1) );
+        outSplit->write_raw_buffer(data, cals);
+    }
+    outSplit->finish_writing_raw();
+
+    QVERIFY( QFile::exists(FiffRawSplitter::partFileName(t_sFileSplit, 2)) );
+    QVERIFY( !QFile::exists(FiffRawSplitter::partFileName(t_sFileSplit, 3)) );
+
+    //
+    //   The parts are read as one recording, also across the part boundaries
+    //
+    FiffRawData rawSplit(t_fileSplit);
+    QVERIFY( rawSplit.splits.size() == 2 );
+    QVERIFY( rawSplit.first_samp == from && rawSplit.last_samp == from + 6*quantum - 1 );
+
+    MatrixXd dataSplit, timesSplit;
+    QVERIFY( raw.read_raw_segment(data, times, from + 100, from + 5*quantum) );
+    QVERIFY( rawSplit.read_raw_segment(dataSplit, timesSplit, from + 100, from + 5*quantum) );
+    QVERIFY( (data - dataSplit).cwiseAbs().maxCoeff() < epsilon );
+    QVERIFY( times == timesSplit );
+
+    QFile::remove(FiffRawSplitter::partFileName(t_sFileSplit, 1));
+    QFile::remove(FiffRawSplitter::partFileName(t_sFileSplit, 2));
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareBasicInfo()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    FiffStream::SPtr t_pStream(new FiffStream(&t_fileIn));
+    QVERIFY( t_pStream->open() );
+
+    FiffInfo infoFull, infoBasic;
+    FiffDirNode::SPtr meas;
+    QVERIFY( t_pStream->read_meas_info(t_pStream->dirtree(), infoFull, meas) );
+    QVERIFY( t_pStream->read_meas_info(t_pStream->dirtree(), infoBasic, meas, FiffStream::MeasInfoBasic) );
+    t_pStream->close();
+
+    //
+    //   The basic fields are identical, the optional ones are left out
+    //
+    QVERIFY( infoBasic.nchan == infoFull.nchan );
+    QVERIFY( infoBasic.sfreq == infoFull.sfreq );
+    QVERIFY( infoBasic.ch_names == infoFull.ch_names );
+    QVERIFY( infoBasic.meas_date[0] == infoFull.meas_date[0] );
+    QVERIFY( !infoFull.projs.isEmpty() && infoBasic.projs.isEmpty() );
+    QVERIFY( !infoFull.dig.isEmpty() && infoBasic.dig.isEmpty() );
+    QVERIFY( infoBasic.dev_head_t.isEmpty() && infoBasic.bads.isEmpty() );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::comparePrefetchedRead()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    FiffRawData raw(t_fileIn);
+
+    fiff_int_t quantum = 600;
+    FiffRawPrefetcher prefetcher(raw, quantum, 3);
+
+    //
+    //   Sequential segments are served by the read-ahead, a jump restarts it
+    //
+    MatrixXd data, prefetched, times;
+    QList<fiff_int_t> starts;
+    starts << raw.first_samp << raw.first_samp + quantum << raw.first_samp + 2*quantum << raw.first_samp + 10*quantum << raw.first_samp + 11*quantum;
+
+    for(qint32 k = 0; k < starts.size(); ++k)
+    {
+        QVERIFY( raw.read_raw_segment(data, times, starts[k], starts[k] + quantum - 1) );
+        QVERIFY( prefetcher.read_raw_segment(prefetched, times, starts[k], starts[k] + quantum - 1) );
+        QVERIFY( data == prefetched );
+    }
+
+    FiffRawPrefetcherStats stats = prefetcher.stats();
+    QVERIFY( stats.hits == 4 && stats.misses == 1 );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareEventScan()
+{
+    QString t_sFileName("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    QFile t_fileIn(t_sFileName);
+    FiffRawData raw(t_fileIn);
+
+    QTemporaryDir t_cacheDir;
+    QVERIFY( t_cacheDir.isValid() );
+    UTILSLIB::CacheLocation::setDirectory(t_cacheDir.path());
+    QVERIFY( QFileInfo(FiffEventScanner::cacheName(t_sFileName)).absolutePath() == QDir(t_cacheDir.path()).absolutePath() );
+
+    //
+    //   Reference: one detector over the whole stim channel
+    //
+    RowVectorXi sel(1);
+    sel[0] = raw.info.ch_names.indexOf("STI 014");
+    QVERIFY( sel[0] >= 0 );
+
+    MatrixXd data, times;
+    QVERIFY( raw.read_raw_segment(data, times, raw.first_samp, raw.last_samp, sel) );
+
+    QList<int> rows;
+    rows << 0;
+    UTILSLIB::TriggerDetector detector(rows, 0.5, UTILSLIB::TriggerDetector::LevelMode, false, 50, data.cols());
+    qint32 nEvents = detector.detect(data);
+    QVERIFY( nEvents > 0 );
+
+    //
+    //   Short chunks put many flanks close to a chunk boundary
+    //
+    FiffEventScanner scanner(QStringList() << "STI 014", 0.5, UTILSLIB::TriggerDetector::LevelMode, false, 50);
+    scanner.setChunkLength(0.37);
+
+    MatrixXi events;
+    QVERIFY( scanner.scan(raw, events) );
+    QVERIFY( events.rows() == nEvents );
+    for(qint32 i = 0; i < nEvents; ++i)
+    {
+        QVERIFY( events(i, 0) == raw.first_samp + detector.event(i).iSample );
+        QVERIFY( events(i, 1) == 0 );
+        QVERIFY( events(i, 2) == qRound(detector.event(i).dValue) );
+    }
+
+    //
+    //   The second scan of the file is served by the cache, other parameters do not match it
+    //
+    MatrixXi scanned, cached;
+    QVERIFY( scanner.scanFile(t_sFileName, scanned) );
+    QVERIFY( QFile::exists(FiffEventScanner::cacheName(t_sFileName)) );
+    QVERIFY( !QFile::exists(t_sFileName + QString(".events")) );
+    QVERIFY( scanned == events );
+
+    FiffId id = raw.file->id();
+    QVERIFY( scanner.readCache(t_sFileName, id, cached) );
+    QVERIFY( cached == events );
+
+    FiffEventScanner rising(QStringList() << "STI 014", 0.5, UTILSLIB::TriggerDetector::RisingGradientMode);
+    QVERIFY( !rising.readCache(t_sFileName, id, cached) );
+
+    UTILSLIB::CacheLocation::setDirectory(QString());
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareAsyncWrite()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    QFile t_filePlain("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_plain_out.fif");
+    QFile t_fileAsync("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_async_out.fif");
+
+    FiffRawData raw(t_fileIn);
+    fiff_int_t from = raw.first_samp;
+    fiff_int_t quantum = ceil(raw.info.sfreq);
+
+    //
+    //   Write the same buffers synchronously and through the writer thread
+    //
+    RowVectorXd cals;
+    FiffStream::SPtr outPlain = FiffStream::start_writing_raw(t_filePlain, raw.info, cals);
+    FiffStream::SPtr outAsync = FiffStream::start_writing_raw(t_fileAsync, raw.info, cals);
+    QVERIFY( outAsync->start_async_writing(4, false) );
+    QVERIFY( outAsync->is_async_writing() );
+
+    outPlain->write_int(FIFF_FIRST_SAMPLE, &from);
+    outAsync->write_int(FIFF_FIRST_SAMPLE, &from);
+
+    MatrixXd data, times;
+    for(fiff_int_t first = from; first < from + 5*quantum; first += quantum)
+    {
+        QVERIFY( raw.read_raw_segment(data, times, first, first + quantum - 1) );
+        QVERIFY( outPlain->write_raw_buffer(data, cals) );
+        QVERIFY( outAsync->write_raw_buffer(data, cals) );
+    }
+
+    FiffAsyncWriterStats stats = outAsync->async_writing_stats();
+    QVERIFY( stats.queued == 5 );
+    QVERIFY( stats.dropped == 0 );
+
+    outPlain->finish_writing_raw();
+    outAsync->finish_writing_raw();
+
+    //
+    //   Without drops the files are identical
+    //
+    FiffRawData rawPlain(t_filePlain);
+    FiffRawData rawAsync(t_fileAsync);
+    QVERIFY( rawPlain.last_samp == rawAsync.last_samp );
+    QVERIFY( rawPlain.rawdir.size() == rawAsync.rawdir.size() );
+
+    MatrixXd dataPlain, dataAsync;
+    QVERIFY( rawPlain.read_raw_segment(dataPlain, times, from, from + 5*quantum - 1) );
+    QVERIFY( rawAsync.read_raw_segment(dataAsync, times, from, from + 5*quantum - 1) );
+    QVERIFY( dataPlain == dataAsync );
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRWR::compareAsyncWriteDrop()
+{
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+    GatedFile t_fileAsync("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_async_drop_out.fif");
+
+    FiffRawData raw(t_fileIn);
+    fiff_int_t from = raw.first_samp;
+    fiff_int_t quantum = ceil(raw.info.sfreq);
+
+    QList<MatrixXd> buffers;
+    MatrixXd data, times;
+    for(fiff_int_t first = from; first < from + 5*quantum; first += quantum)
+    {
+        QVERIFY( raw.read_raw_segment(data, times, first, first + quantum - 1) );
+        buffers.append(data);
+    }
+
+    RowVectorXd cals;
+    FiffStream::SPtr outAsync = FiffStream::start_writing_raw(t_fileAsync, raw.info, cals);
+    outAsync->write_int(FIFF_FIRST_SAMPLE, &from);
+    QVERIFY( outAsync->start_async_writing(1, true) );
+
+    //
+    //   The first buffer occupies the only slot while its write is held, the next two are dropped
+    //
+    t_fileAsync.setGateOpen(false);
+    QVERIFY( outAsync->write_raw_buffer(buffers[0], cals) );
+    QVERIFY( !outAsync->write_raw_buffer(buffers[1], cals) );
+    QVERIFY( !outAsync->write_raw_buffer(buffers[2], cals) );
+    t_fileAsync.setGateOpen(true);
+
+    QElapsedTimer timer;
+    timer.start();
+    while(outAsync->async_writing_stats().written < 1 && timer.elapsed() < 10000)
+        QThread::msleep(1);
+
+    QVERIFY( outAsync->write_raw_buffer(buffers[3], cals) );
+
+    timer.restart();
+    while(outAsync->async_writing_stats().written < 2 && timer.elapsed() < 10000)
+        QThread::msleep(1);
+
+    QVERIFY( outAsync->write_raw_buffer(buffers[4], cals) );
+
+    FiffAsyncWriterStats stats = outAsync->async_writing_stats();
+    QVERIFY( stats.queued == 3 );
+    QVERIFY( stats.dropped == 2 );
+
+    outAsync->finish_writing_raw();
+
+    //
+    //   The skip keeps the buffers after the gap at their time, the gap reads as zeros
+    //
+    QFile t_fileOut("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short_test_async_drop_out.fif");
+    FiffRawData rawAsync(t_fileOut);
+    QVERIFY( rawAsync.first_samp == from );
+    QVERIFY( rawAsync.last_samp == from + 5*quantum - 1 );
+    QVERIFY( rawAsync.rawdir.size() == 4 );
+
+    QVERIFY( rawAsync.read_raw_segment(data, times, from, from + 5*quantum - 1) );
+    for(qint32 k = 0; k < 5; ++k)
+    {
+        MatrixXd block = data.middleCols(k*quantum, quantum);
+        if(k == 1 || k == 2)
+            QVERIFY( block.cwiseAbs().maxCoeff() == 0.0 );
+        else
+            QVERIFY( (block - buffers[k]).cwiseAbs().maxCoeff() <= 1e-6*buffers[k].cwiseAbs().maxCoeff() );
+    }
+}
+
+
 //*************************************************************************************************************
 
 void TestFiffRWR::cleanupTestCase()
@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include <disp3D/helpers/geometryinfo/geometryinfo.h>
+#include <disp3D/helpers/meshdecimation/meshdecimation.h>
 #include <mne/mne_bem.h>
 #include <mne/mne_bem_surface.h>
 
@@ -77,6 +78,8 @@ private slots:
     void testEmptyInputsForProjecting();
     void testEmptyInputsForSCDC();
     void testDimensionsForSCDC();
+    void testCachedSCDC();
+    void testMeshDecimation();
     void cleanupTestCase();
 
 private:
@@ -200,6 +203,78 @@ void TestGeometryInfo::testDimensionsForSCDC() {
 }
 
 
+//*************************************************************************************************************
+
+void TestGeometryInfo::testCachedSCDC() {
+    // the disk cache is opt-in
+    QVERIFY(GeometryInfo::cacheDirectory().isEmpty());
+
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    GeometryInfo::setCacheDirectory(cacheDir.path());
+    GeometryInfo::clearCache();
+
+    QVector<qint32> vecSubset = smallSubset;
+    QSharedPointer<MatrixXd> distTable = GeometryInfo::scdc(smallSurface.rr, smallSurface.neighbor_vert, vecSubset, 0.5);
+
+    // first call computes and stores, the second one is served from memory
+    QSharedPointer<MatrixXd> cachedTable = GeometryInfo::scdcCached(smallSurface.rr, smallSurface.neighbor_vert, vecSubset, 0.5);
+    QVERIFY(*cachedTable == *distTable);
+    QCOMPARE(QDir(cacheDir.path()).entryList(QDir::Files).size(), 1);
+
+    // modifying the returned table must not change the cache
+    cachedTable->setZero();
+    QVERIFY(*GeometryInfo::scdcCached(smallSurface.rr, smallSurface.neighbor_vert, vecSubset, 0.5) == *distTable);
+
+    // after clearing the memory cache the table is read from disk
+    GeometryInfo::clearCache();
+    QVERIFY(*GeometryInfo::scdcCached(smallSurface.rr, smallSurface.neighbor_vert, vecSubset, 0.5) == *distTable);
+
+    // a different cancel distance is a different table
+    QSharedPointer<MatrixXd> otherTable = GeometryInfo::scdcCached(smallSurface.rr, smallSurface.neighbor_vert, vecSubset, 0.1);
+    QVERIFY(*otherTable == *GeometryInfo::scdc(smallSurface.rr, smallSurface.neighbor_vert, vecSubset, 0.1));
+    QCOMPARE(QDir(cacheDir.path()).entryList(QDir::Files).size(), 2);
+
+    GeometryInfo::setCacheDirectory(QString());
+    GeometryInfo::clearCache();
+}
+
+
+//*************************************************************************************************************
+
+void TestGeometryInfo::testMeshDecimation() {
+    QVector<DecimatedMesh> vecLevels = MeshDecimation::createLevelsOfDetail(realSurface.rr, realSurface.tris, 3);
+    QVERIFY(!vecLevels.isEmpty());
+
+    int iNumVertPrevious = realSurface.rr.rows();
+
+    for(int i = 0; i < vecLevels.size(); ++i) {
+        const DecimatedMesh& level = vecLevels.at(i);
+        const int iNumVert = level.vecVertexIds.rows();
+
+        // every level is coarser than the previous one
+        QVERIFY(iNumVert < iNumVertPrevious);
+        QVERIFY(level.matTris.rows() > 0);
+        iNumVertPrevious = iNumVert;
+
+        // each representative vertex maps onto its own cluster
+        QVERIFY(level.vecVertexMap.rows() == realSurface.rr.rows());
+        for(int k = 0; k < iNumVert; ++k) {
+            QCOMPARE(level.vecVertexMap(level.vecVertexIds(k)), k);
+        }
+
+        // triangles reference valid, distinct vertices
+        QVERIFY(level.matTris.minCoeff() >= 0);
+        QVERIFY(level.matTris.maxCoeff() < iNumVert);
+        for(int t = 0; t < level.matTris.rows(); ++t) {
+            QVERIFY(level.matTris(t,0) != level.matTris(t,1));
+            QVERIFY(level.matTris(t,1) != level.matTris(t,2));
+            QVERIFY(level.matTris(t,0) != level.matTris(t,2));
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 void TestGeometryInfo::cleanupTestCase() {
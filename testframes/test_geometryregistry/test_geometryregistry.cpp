@@ -0,0 +1,254 @@
+//=============================================================================================================
+/**
+* @file     test_geometryregistry.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Tests the sharing of geometry buffers through the GeometryRegistry.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <disp3D/engine/model/3dhelpers/geometryregistry.h>
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QPointer>
+#include <Qt3DRender/QGeometry>
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace DISP3DLIB;
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestGeometryRegistry
+*
+* @brief The TestGeometryRegistry class verifies that identical buffer contents are shared between geometries
+*
+*/
+class TestGeometryRegistry: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestGeometryRegistry();
+
+private slots:
+    void initTestCase();
+    void sharedBuffer();
+    void separateBuffers();
+    void handOver();
+    void nullRelease();
+    void cleanupTestCase();
+
+private:
+    QByteArray createData(int iSize, float fOffset) const;
+    void flushDeletes() const;
+
+    int m_iNumberBuffers;      /**< Number of registered buffers before a test. */
+};
+
+
+//*************************************************************************************************************
+
+TestGeometryRegistry::TestGeometryRegistry()
+: m_iNumberBuffers(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestGeometryRegistry::initTestCase()
+{
+    m_iNumberBuffers = GeometryRegistry::getNumberBuffers();
+}
+
+
+//*************************************************************************************************************
+
+void TestGeometryRegistry::sharedBuffer()
+{
+    Qt3DRender::QGeometry* pGeometry1 = new Qt3DRender::QGeometry();
+    Qt3DRender::QGeometry* pGeometry2 = new Qt3DRender::QGeometry();
+
+    //Two geometries with the same content get the same buffer, owned by the first one
+    Qt3DRender::QBuffer* pBuffer1 = GeometryRegistry::acquireBuffer(createData(300, 0.0f), Qt3DRender::QBuffer::VertexBuffer, pGeometry1);
+    Qt3DRender::QBuffer* pBuffer2 = GeometryRegistry::acquireBuffer(createData(300, 0.0f), Qt3DRender::QBuffer::VertexBuffer, pGeometry2);
+
+    QVERIFY(pBuffer1 != Q_NULLPTR);
+    QCOMPARE(pBuffer1, pBuffer2);
+    QCOMPARE(pBuffer1->parent(), static_cast<QObject*>(pGeometry1));
+    QCOMPARE(GeometryRegistry::getNumberBuffers(), m_iNumberBuffers + 1);
+
+    QPointer<Qt3DRender::QBuffer> pShared = pBuffer1;
+
+    GeometryRegistry::releaseBuffer(pBuffer1, pGeometry1);
+    GeometryRegistry::releaseBuffer(pBuffer2, pGeometry2);
+    flushDeletes();
+
+    //The last release removes the entry and deletes the buffer
+    QCOMPARE(GeometryRegistry::getNumberBuffers(), m_iNumberBuffers);
+    QVERIFY(pShared.isNull());
+
+    delete pGeometry1;
+    delete pGeometry2;
+}
+
+
+//*************************************************************************************************************
+
+void TestGeometryRegistry::separateBuffers()
+{
+    Qt3DRender::QGeometry* pGeometry = new Qt3DRender::QGeometry();
+
+    //The buffer type is part of the key, so equal bytes used as index data are not shared with vertex data
+    Qt3DRender::QBuffer* pVertex = GeometryRegistry::acquireBuffer(createData(300, 0.0f), Qt3DRender::QBuffer::VertexBuffer, pGeometry);
+    Qt3DRender::QBuffer* pIndex = GeometryRegistry::acquireBuffer(createData(300, 0.0f), Qt3DRender::QBuffer::IndexBuffer, pGeometry);
+    Qt3DRender::QBuffer* pOther = GeometryRegistry::acquireBuffer(createData(300, 1.0f), Qt3DRender::QBuffer::VertexBuffer, pGeometry);
+
+    QVERIFY(pVertex != pIndex);
+    QVERIFY(pVertex != pOther);
+    QVERIFY(pIndex != pOther);
+    QCOMPARE(pIndex->type(), Qt3DRender::QBuffer::IndexBuffer);
+    QCOMPARE(pOther->data(), createData(300, 1.0f));
+    QCOMPARE(GeometryRegistry::getNumberBuffers(), m_iNumberBuffers + 3);
+
+    GeometryRegistry::releaseBuffer(pVertex, pGeometry);
+    GeometryRegistry::releaseBuffer(pIndex, pGeometry);
+    GeometryRegistry::releaseBuffer(pOther, pGeometry);
+    flushDeletes();
+
+    QCOMPARE(GeometryRegistry::getNumberBuffers(), m_iNumberBuffers);
+
+    delete pGeometry;
+}
+
+
+//*************************************************************************************************************
+
+void TestGeometryRegistry::handOver()
+{
+    Qt3DRender::QGeometry* pGeometry1 = new Qt3DRender::QGeometry();
+    Qt3DRender::QGeometry* pGeometry2 = new Qt3DRender::QGeometry();
+
+    Qt3DRender::QBuffer* pBuffer = GeometryRegistry::acquireBuffer(createData(90, 2.0f), Qt3DRender::QBuffer::VertexBuffer, pGeometry1);
+    GeometryRegistry::acquireBuffer(createData(90, 2.0f), Qt3DRender::QBuffer::VertexBuffer, pGeometry2);
+
+    QPointer<Qt3DRender::QBuffer> pShared = pBuffer;
+
+    //Releasing and deleting the owner must leave the buffer alive for the remaining user
+    GeometryRegistry::releaseBuffer(pBuffer, pGeometry1);
+    QCOMPARE(pBuffer->parent(), static_cast<QObject*>(pGeometry2));
+    QCOMPARE(GeometryRegistry::getNumberBuffers(), m_iNumberBuffers + 1);
+
+    delete pGeometry1;
+    flushDeletes();
+
+    QVERIFY(!pShared.isNull());
+    QCOMPARE(pShared->data(), createData(90, 2.0f));
+
+    //A new geometry with the same content still finds the handed over buffer
+    Qt3DRender::QGeometry* pGeometry3 = new Qt3DRender::QGeometry();
+    QCOMPARE(GeometryRegistry::acquireBuffer(createData(90, 2.0f), Qt3DRender::QBuffer::VertexBuffer, pGeometry3), pBuffer);
+
+    GeometryRegistry::releaseBuffer(pBuffer, pGeometry2);
+    GeometryRegistry::releaseBuffer(pBuffer, pGeometry3);
+    flushDeletes();
+
+    QCOMPARE(GeometryRegistry::getNumberBuffers(), m_iNumberBuffers);
+    QVERIFY(pShared.isNull());
+
+    delete pGeometry2;
+    delete pGeometry3;
+}
+
+
+//*************************************************************************************************************
+
+void TestGeometryRegistry::nullRelease()
+{
+    Qt3DRender::QGeometry* pGeometry = new Qt3DRender::QGeometry();
+
+    GeometryRegistry::releaseBuffer(Q_NULLPTR, pGeometry);
+    QCOMPARE(GeometryRegistry::getNumberBuffers(), m_iNumberBuffers);
+
+    delete pGeometry;
+}
+
+
+//*************************************************************************************************************
+
+void TestGeometryRegistry::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+QByteArray TestGeometryRegistry::createData(int iSize, float fOffset) const
+{
+    QByteArray data;
+    data.resize(iSize * sizeof(float));
+    float* pData = reinterpret_cast<float*>(data.data());
+
+    for(int i = 0; i < iSize; ++i) {
+        pData[i] = fOffset + 0.1f * i;
+    }
+
+    return data;
+}
+
+
+//*************************************************************************************************************
+
+void TestGeometryRegistry::flushDeletes() const
+{
+    QCoreApplication::sendPostedEvents(Q_NULLPTR, QEvent::DeferredDelete);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestGeometryRegistry)
+#include "test_geometryregistry.moc"
@@ -0,0 +1,303 @@
+//=============================================================================================================
+/**
+* @file     test_ica.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the FastICA artifact removal
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/ica.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <random>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestIca
+*
+* @brief The TestIca class verifies that FastICA recovers known sources from a noisy mixture of channels of
+*        different scales, that the artifact source is found by its reference and removed by the projector
+*
+*/
+class TestIca: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestIca();
+
+private slots:
+    void initTestCase();
+    void compareSources_data();
+    void compareSources();
+    void compareScores();
+    void compareProjector();
+    void compareFindOutliers();
+    void cleanupTestCase();
+
+private:
+    double bestCorrelation(const MatrixXd& matSources, const RowVectorXd& vecSource) const;
+
+    int         m_iSources;     /**< Number of simulated sources. */
+    MatrixXd    m_matSources;   /**< The simulated sources, the last one is a spike train artifact. */
+    MatrixXd    m_matMixing;    /**< The simulated mixing. */
+    MatrixXd    m_matData;      /**< The noisy mixture. */
+};
+
+
+//*************************************************************************************************************
+
+TestIca::TestIca()
+: m_iSources(4)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestIca::initTestCase()
+{
+    const int iChannels = 30;
+    const int iSamples = 60000;
+
+    std::mt19937 generator(3);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+
+    //A sine, a square wave, laplacian noise and a cardiac like spike train
+    m_matSources.resize(m_iSources, iSamples);
+    for(int t = 0; t < iSamples; ++t) {
+        double u = uniform(generator);
+        m_matSources(0, t) = qSin(2.0 * M_PI * t / 97.0);
+        m_matSources(1, t) = (t / 53) % 2 ? 1.0 : -1.0;
+        m_matSources(2, t) = (u < 0.0 ? -1.0 : 1.0) * qLn(1.0 - qAbs(u));
+        m_matSources(3, t) = t % 800 < 20 ? 5.0 : 0.0;
+    }
+
+    m_matMixing.resize(iChannels, m_iSources);
+    for(int i = 0; i < m_matMixing.size(); ++i)
+        m_matMixing.data()[i] = normal(generator);
+
+    m_matData = m_matMixing * m_matSources;
+    for(int i = 0; i < m_matData.size(); ++i)
+        m_matData.data()[i] += 0.05 * normal(generator);
+
+    //The first channels are of a different type, e.g. magnetometers in T next to channels in V
+    m_matMixing.topRows(10) *= 1e-12;
+    m_matData.topRows(10) *= 1e-12;
+}
+
+
+//*************************************************************************************************************
+
+double TestIca::bestCorrelation(const MatrixXd& matSources, const RowVectorXd& vecSource) const
+{
+    RowVectorXd vecRef = vecSource.array() - vecSource.mean();
+
+    double dBest = 0.0;
+    for(int i = 0; i < matSources.rows(); ++i) {
+        RowVectorXd vecEst = matSources.row(i).array() - matSources.row(i).mean();
+        dBest = qMax(dBest, qAbs(vecEst.dot(vecRef)) / (vecEst.norm() * vecRef.norm()));
+    }
+
+    return dBest;
+}
+
+
+//*************************************************************************************************************
+
+void TestIca::compareSources_data()
+{
+    QTest::addColumn<int>("decimation");
+
+    QTest::newRow("All samples") << 1;
+    QTest::newRow("Decimated") << 3;
+}
+
+
+//*************************************************************************************************************
+
+void TestIca::compareSources()
+{
+    QFETCH(int, decimation);
+
+    Ica ica;
+    QVERIFY(ica.fit(m_matData, m_iSources, decimation));
+    QCOMPARE(ica.components(), m_iSources);
+
+    //The unmixing is the pseudo inverse of the mixing
+    QVERIFY((ica.unmixing() * ica.mixing() - MatrixXd::Identity(m_iSources, m_iSources)).norm() < 1e-10);
+
+    MatrixXd matEstimated = ica.sources(m_matData);
+    for(int s = 0; s < m_iSources; ++s)
+        QVERIFY(bestCorrelation(matEstimated, m_matSources.row(s)) > 0.99);
+
+    //More components than the data has are reduced to its rank
+    Ica icaRank;
+    MatrixXd matRankDeficient = m_matData.topRows(3);
+    icaRank.fit(matRankDeficient, 5);
+    QCOMPARE(icaRank.components(), 3);
+}
+
+
+//*************************************************************************************************************
+
+void TestIca::compareScores()
+{
+    Ica ica;
+    QVERIFY(ica.fit(m_matData, m_iSources));
+
+    //A noisy reference of the spike train, e.g. an ECG channel
+    RowVectorXd vecReference = m_matSources.row(3) + 0.5 * RowVectorXd::Random(m_matSources.cols());
+
+    VectorXd vecScores = ica.scores(m_matData, vecReference);
+    QCOMPARE(int(vecScores.size()), m_iSources);
+
+    int iBest;
+    vecScores.maxCoeff(&iBest);
+    QVERIFY(vecScores(iBest) > 0.9);
+    QVERIFY(bestCorrelation(ica.sources(m_matData).row(iBest), m_matSources.row(3)) > 0.99);
+
+    for(int i = 0; i < vecScores.size(); ++i)
+        if(i != iBest)
+            QVERIFY(vecScores(i) < 0.1);
+}
+
+
+//*************************************************************************************************************
+
+void TestIca::compareProjector()
+{
+    Ica ica;
+    QVERIFY(ica.fit(m_matData, m_iSources));
+
+    VectorXd vecScores = ica.scores(m_matData, m_matSources.row(3));
+    int iBest;
+    vecScores.maxCoeff(&iBest);
+
+    QVector<int> vecExclude;
+    vecExclude << iBest;
+    MatrixXd matProj = ica.projector(vecExclude);
+    QCOMPARE(int(matProj.rows()), int(m_matData.rows()));
+
+    //Up to the constant offsets, the projected data is the data without the artifact
+    MatrixXd matArtifact = m_matMixing.col(3) * m_matSources.row(3);
+    MatrixXd matResidual = matProj * m_matData - (m_matData - matArtifact);
+    matResidual.colwise() -= matResidual.rowwise().mean();
+
+    QVERIFY(matResidual.topRows(10).norm() < 0.05 * matArtifact.topRows(10).norm());
+    QVERIFY(matResidual.bottomRows(20).norm() < 0.05 * matArtifact.bottomRows(20).norm());
+
+    //A projector removes what it projects out
+    QVERIFY((matProj * matProj - matProj).norm() < 1e-10 * matProj.norm());
+
+    //Embedded into a recording with further channels the picked block is the same and the rest is the identity
+    QVector<int> vecPicks;
+    for(int i = 0; i < m_matData.rows(); ++i)
+        vecPicks << i + 2;
+    MatrixXd matProjAll = ica.projector(vecExclude, vecPicks, m_matData.rows() + 4);
+    QCOMPARE(int(matProjAll.rows()), int(m_matData.rows()) + 4);
+    QVERIFY((matProjAll.block(2, 2, m_matData.rows(), m_matData.rows()) - matProj).norm() < 1e-12 * matProj.norm());
+    QCOMPARE(matProjAll(0, 0), 1.0);
+    QCOMPARE(matProjAll(0, 5), 0.0);
+    QCOMPARE(matProjAll(m_matData.rows() + 3, m_matData.rows() + 3), 1.0);
+}
+
+
+//*************************************************************************************************************
+
+void TestIca::compareFindOutliers()
+{
+    VectorXd vecScores(10);
+    vecScores << 0.10, 0.12, 0.09, 0.11, 0.10, 0.95, 0.13, 0.08, 0.10, 0.60;
+
+    //The first pass only finds the strongest outlier, which hides the second one in the spread
+    QVector<int> vecOutliers = Ica::findOutliers(vecScores, 2.0, 1);
+    QCOMPARE(vecOutliers.size(), 1);
+    QCOMPARE(vecOutliers.at(0), 5);
+
+    vecOutliers = Ica::findOutliers(vecScores, 2.0);
+    QCOMPARE(vecOutliers.size(), 2);
+    QCOMPARE(vecOutliers.at(0), 5);
+    QCOMPARE(vecOutliers.at(1), 9);
+}
+
+
+//*************************************************************************************************************
+
+void TestIca::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestIca)
+#include "test_ica.moc"
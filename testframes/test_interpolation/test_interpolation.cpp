@@ -62,6 +62,21 @@ using namespace DISP3DLIB;
 using namespace MNELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+double customCubic(const double dIn)
+{
+    return dIn * dIn * dIn;
+}
+
+}
+
+
 //=============================================================================================================
 /**
 * DECLARE CLASS interpolation
@@ -81,6 +96,9 @@ private slots:
     void testDimensionsForInterpolation();
     void testSumOfRow();
     void testEmptyInputsForWeightMatrix();
+    void testSparseDistanceTable();
+    void testCustomWeightFunction();
+    void benchmarkInterpolationMat();
     void cleanupTestCase();
 
 private:
@@ -244,6 +262,86 @@ void TestInterpolation::testEmptyInputsForWeightMatrix()
     QVERIFY((resultMat->rows() == 0) && (resultMat->cols() == 0));
 }
 
+//*************************************************************************************************************
+
+void TestInterpolation::testSparseDistanceTable()
+{
+    const double dCancelDist = 0.5;
+
+    QVector<qint32> vecSubset = smallSubset;
+    QSharedPointer<MatrixXd> distTable = GeometryInfo::scdc(smallSurface.rr, smallSurface.neighbor_vert, vecSubset, dCancelDist);
+    QSharedPointer<SparseMatrix<float> > sparseDistTable = GeometryInfo::scdcSparse(smallSurface.rr, smallSurface.neighbor_vert, vecSubset, dCancelDist);
+
+    QVERIFY(sparseDistTable->rows() == distTable->rows());
+    QVERIFY(sparseDistTable->cols() == distTable->cols());
+
+    // the sparse table holds exactly the distances below the cancel distance
+    MatrixXf matSparseDist = MatrixXf::Constant(sparseDistTable->rows(), sparseDistTable->cols(), FLOAT_INFINITY);
+    for (int k = 0; k < sparseDistTable->outerSize(); ++k) {
+        for (SparseMatrix<float>::InnerIterator it(*sparseDistTable, k); it; ++it) {
+            matSparseDist(it.row(), it.col()) = it.value();
+        }
+    }
+
+    for (int r = 0; r < distTable->rows(); ++r) {
+        for (int c = 0; c < distTable->cols(); ++c) {
+            if ((*distTable)(r,c) < dCancelDist) {
+                QVERIFY(std::fabs(matSparseDist(r,c) - (*distTable)(r,c)) < 1e-5);
+            } else {
+                QVERIFY(matSparseDist(r,c) >= dCancelDist - 1e-5);
+            }
+        }
+    }
+
+    // both tables give the same weights
+    MatrixXf matDenseWeights = MatrixXf(*Interpolation::createInterpolationMat(vecSubset, distTable, Interpolation::cubic, dCancelDist));
+    MatrixXf matSparseWeights = MatrixXf(*Interpolation::createInterpolationMat(vecSubset, sparseDistTable, Interpolation::cubic, dCancelDist));
+
+    QVERIFY((matDenseWeights - matSparseWeights).cwiseAbs().maxCoeff() < 1e-4);
+}
+
+
+//*************************************************************************************************************
+
+void TestInterpolation::testCustomWeightFunction()
+{
+    // the built-in weight functions take an inlined code path, any other function pointer is called as it is
+    QSharedPointer<MatrixXd> distTable = GeometryInfo::scdc(smallSurface.rr, smallSurface.neighbor_vert, smallSubset, 0.5);
+
+    MatrixXf matBuiltInWeights = MatrixXf(*Interpolation::createInterpolationMat(smallSubset, distTable, Interpolation::cubic, 0.5));
+    MatrixXf matCustomWeights = MatrixXf(*Interpolation::createInterpolationMat(smallSubset, distTable, customCubic, 0.5));
+
+    QVERIFY(matBuiltInWeights.rows() == matCustomWeights.rows());
+    QVERIFY(matBuiltInWeights.cols() == matCustomWeights.cols());
+    QVERIFY((matBuiltInWeights - matCustomWeights).cwiseAbs().maxCoeff() < 1e-6);
+}
+
+
+//*************************************************************************************************************
+
+void TestInterpolation::benchmarkInterpolationMat()
+{
+    QVector<qint32> mappedSubSet = GeometryInfo::projectSensors(realSurface.rr,
+                                                                megSensors);
+
+    QSharedPointer<MatrixXd> distanceMatrix = GeometryInfo::scdc(realSurface.rr,
+                                                                 realSurface.neighbor_vert,
+                                                                 mappedSubSet,
+                                                                 0.20);
+
+    QSharedPointer<SparseMatrix<float> > w;
+
+    QBENCHMARK {
+        w = Interpolation::createInterpolationMat(mappedSubSet,
+                                                  distanceMatrix,
+                                                  Interpolation::linear,
+                                                  0.20);
+    }
+
+    QVERIFY(w->rows() == realSurface.rr.rows());
+}
+
+
 //*************************************************************************************************************
 
 void TestInterpolation::cleanupTestCase()
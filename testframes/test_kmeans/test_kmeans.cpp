@@ -0,0 +1,233 @@
+//=============================================================================================================
+/**
+* @file     test_kmeans.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the KMeans bounded batch phase against the plain batch phase
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/kmeans.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestKMeans
+*
+* @brief The TestKMeans class compares the bounded batch phase of KMeans with the plain batch phase on fixed
+*        seeds, for separated clusters and for clusters that go empty under every empty action
+*
+*/
+class TestKMeans: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestKMeans();
+
+private slots:
+    void initTestCase();
+    void compareBatch_data();
+    void compareBatch();
+    void compareEmpty_data();
+    void compareEmpty();
+    void cleanupTestCase();
+
+private:
+    void compareRuns(const MatrixXd& X, qint32 k, const QString& sDistance, const QString& sEmptyact);
+
+    MatrixXd    m_matBlobs;     /**< Three separated blobs of 30 points each in 3D. */
+    MatrixXd    m_matDistinct;  /**< 30 points on three distinct locations, four clusters always start with an empty one. */
+};
+
+
+//*************************************************************************************************************
+
+TestKMeans::TestKMeans()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::initTestCase()
+{
+    std::srand(42);
+
+    m_matBlobs = 0.5 * (MatrixXd::Random(90, 3).array() + 1.0);
+    for(qint32 i = 0; i < m_matBlobs.rows(); ++i)
+        m_matBlobs(i, i % 3) += 10.0;
+
+    // Four start centroids sampled from three locations, so two of them coincide and the second one gets no
+    // members
+    m_matDistinct = MatrixXd::Zero(30, 2);
+    for(qint32 i = 0; i < m_matDistinct.rows(); ++i)
+    {
+        if(i % 3 == 1)
+            m_matDistinct(i, 0) = 4.0;
+        else if(i % 3 == 2)
+            m_matDistinct(i, 1) = 3.0;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::compareRuns(const MatrixXd& X, qint32 k, const QString& sDistance, const QString& sEmptyact)
+{
+    for(qint32 seed = 1; seed <= 20; ++seed)
+    {
+        VectorXi idxBounded, idxBatch;
+        MatrixXd CBounded, CBatch, DBounded, DBatch;
+        VectorXd sumDBounded, sumDBatch;
+
+        KMeans t_kMeansBounded(sDistance, QString("sample"), 1, sEmptyact, false);
+        t_kMeansBounded.setSeed(seed);
+        bool bBounded = t_kMeansBounded.calculate(X, k, idxBounded, CBounded, sumDBounded, DBounded);
+
+        KMeans t_kMeansBatch(sDistance, QString("sample"), 1, sEmptyact, false);
+        t_kMeansBatch.setSeed(seed);
+        t_kMeansBatch.setBounded(false);
+        bool bBatch = t_kMeansBatch.calculate(X, k, idxBatch, CBatch, sumDBatch, DBatch);
+
+        QCOMPARE(bBounded, bBatch);
+        QVERIFY(idxBounded == idxBatch);
+
+        // Dropped clusters keep no centroid
+        for(qint32 i = 0; i < k; ++i)
+        {
+            QCOMPARE(CBounded.row(i).hasNaN(), CBatch.row(i).hasNaN());
+            if(!CBounded.row(i).hasNaN())
+                QVERIFY(CBounded.row(i).isApprox(CBatch.row(i), 1e-10));
+        }
+
+        if(sEmptyact == "singleton")
+        {
+            VectorXi counts = VectorXi::Zero(k);
+            for(qint32 i = 0; i < idxBounded.rows(); ++i)
+                ++counts[idxBounded[i]];
+            QVERIFY(counts.minCoeff() > 0);
+        }
+        else if(sEmptyact == "drop")
+            QVERIFY(CBounded.hasNaN());
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::compareBatch_data()
+{
+    QTest::addColumn<QString>("distance");
+
+    QTest::newRow("sqeuclidean") << QString("sqeuclidean");
+    QTest::newRow("cityblock") << QString("cityblock");
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::compareBatch()
+{
+    QFETCH(QString, distance);
+
+    compareRuns(m_matBlobs, 3, distance, QString("error"));
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::compareEmpty_data()
+{
+    QTest::addColumn<QString>("distance");
+    QTest::addColumn<QString>("emptyact");
+
+    QStringList t_qListDistances = QStringList() << "sqeuclidean" << "cityblock";
+    QStringList t_qListEmptyacts = QStringList() << "error" << "drop" << "singleton";
+    for(qint32 i = 0; i < t_qListDistances.size(); ++i)
+        for(qint32 j = 0; j < t_qListEmptyacts.size(); ++j)
+            QTest::newRow(QString("%1 %2").arg(t_qListDistances[i]).arg(t_qListEmptyacts[j]).toUtf8().constData()) << t_qListDistances[i] << t_qListEmptyacts[j];
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::compareEmpty()
+{
+    QFETCH(QString, distance);
+    QFETCH(QString, emptyact);
+
+    compareRuns(m_matDistinct, 4, distance, emptyact);
+}
+
+
+//*************************************************************************************************************
+
+void TestKMeans::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestKMeans)
+#include "test_kmeans.moc"
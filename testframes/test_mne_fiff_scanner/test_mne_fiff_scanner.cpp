@@ -0,0 +1,167 @@
+//=============================================================================================================
+/**
+* @file     test_mne_fiff_scanner.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the metadata scan mode of mne_show_fiff
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <mne_fiff_scanner.h>
+
+#include <fiff/fiff.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QJsonArray>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace SHOWFIFF;
+using namespace FIFFLIB;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneFiffScanner
+*
+* @brief The TestMneFiffScanner class verifies the metadata the batch scanner of mne_show_fiff reports against
+*        the fully read measurement info
+*
+*/
+class TestMneFiffScanner: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneFiffScanner();
+
+private slots:
+    void initTestCase();
+    void compareProjs_data();
+    void compareProjs();
+    void cleanupTestCase();
+};
+
+
+//*************************************************************************************************************
+
+TestMneFiffScanner::TestMneFiffScanner()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneFiffScanner::initTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneFiffScanner::compareProjs_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<bool>("active");
+
+    //The SSP vectors of the raw data are idle, the ones of the averages were applied
+    QTest::newRow("raw") << QString("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif") << false;
+    QTest::newRow("evoked") << QString("./mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif") << true;
+}
+
+
+//*************************************************************************************************************
+
+void TestMneFiffScanner::compareProjs()
+{
+    QFETCH(QString, fileName);
+    QFETCH(bool, active);
+
+    QJsonObject result = MneFiffScanner::scan_file(fileName, false);
+    QVERIFY(result["ok"].toBool());
+
+    //
+    //   Read the complete measurement info for reference
+    //
+    QFile file(fileName);
+    FiffStream::SPtr stream(new FiffStream(&file));
+    QVERIFY(stream->open());
+
+    FiffInfo info;
+    FiffDirNode::SPtr meas;
+    QVERIFY(stream->read_meas_info(stream->dirtree(), info, meas));
+    stream->close();
+
+    QVERIFY(info.projs.size() > 0);
+
+    QJsonArray projs = result["projs"].toArray();
+    QCOMPARE(projs.size(), info.projs.size());
+
+    for(int k = 0; k < projs.size(); ++k) {
+        QJsonObject proj = projs[k].toObject();
+
+        QVERIFY(!proj["desc"].toString().isEmpty());
+        QCOMPARE(proj["desc"].toString(), info.projs[k].desc);
+        QCOMPARE(proj["kind"].toInt(), info.projs[k].kind);
+        QCOMPARE(proj["active"].toBool(), info.projs[k].active);
+        QCOMPARE(proj["active"].toBool(), active);
+        QCOMPARE(proj["nvec"].toInt(), info.projs[k].data->nrow);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneFiffScanner::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMneFiffScanner)
+#include "test_mne_fiff_scanner.moc"
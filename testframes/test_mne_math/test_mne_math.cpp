@@ -0,0 +1,305 @@
+//=============================================================================================================
+/**
+* @file     test_mne_math.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test and benchmark of the MNEMath SVD, rank and pseudo inverse utilities
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/mnemath.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SVD>
+#include <Eigen/Eigenvalues>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define RANK    60
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneMath
+*
+* @brief The TestMneMath class compares the BDCSVD, randomized SVD and self-adjoint variants of the MNEMath rank
+*        and pseudo inverse utilities with a JacobiSVD reference on a 306 x 306 covariance and a 366 x 8196 lead
+*        field like matrix and benchmarks them
+*
+*/
+class TestMneMath: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneMath();
+
+private slots:
+    void initTestCase();
+    void compareRank();
+    void comparePinv();
+    void compareRandomizedSvd_data();
+    void compareRandomizedSvd();
+    void benchmarkSvd_data();
+    void benchmarkSvd();
+    void cleanupTestCase();
+
+private:
+    void addProblems();
+    const MatrixXd& problem(int type) const;
+
+    MatrixXd    m_matCov;       /**< 306 x 306 covariance of rank RANK plus noise. */
+    MatrixXd    m_matLead;      /**< 366 x 8196 matrix of rank RANK plus noise. */
+};
+
+
+//*************************************************************************************************************
+
+TestMneMath::TestMneMath()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneMath::initTestCase()
+{
+    std::srand(42);
+
+    MatrixXd t_matMixing = MatrixXd::Random(306, RANK);
+    m_matCov = t_matMixing * t_matMixing.transpose() + 1e-10 * MatrixXd::Identity(306, 306);
+
+    m_matLead = MatrixXd::Random(366, RANK) * MatrixXd::Random(RANK, 8196) + 1e-9 * MatrixXd::Random(366, 8196);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneMath::addProblems()
+{
+    QTest::addColumn<int>("type");
+
+    QTest::newRow("306x306") << 0;
+    QTest::newRow("366x8196") << 1;
+}
+
+
+//*************************************************************************************************************
+
+const MatrixXd& TestMneMath::problem(int type) const
+{
+    if (type == 1)
+        return m_matLead;
+    return m_matCov;
+}
+
+
+//*************************************************************************************************************
+
+void TestMneMath::compareRank()
+{
+    QCOMPARE(MNEMath::rank(m_matCov), RANK);
+    QCOMPARE(MNEMath::rankSelfAdjoint(m_matCov), RANK);
+    QCOMPARE(MNEMath::rank(m_matLead), RANK);
+
+    //get_whitener takes the rank from its own eigenvalues
+    MatrixXd t_matCov = m_matCov;
+    VectorXd t_vecEig;
+    MatrixXd t_matEigvec;
+    MNEMath::get_whitener(t_matCov, false, QString("MEG"), t_vecEig, t_matEigvec);
+    QCOMPARE(static_cast<int>((t_vecEig.array() != 0.0).count()), RANK);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneMath::comparePinv()
+{
+    MatrixXd t_matSmall = MatrixXd::Random(306, 8);
+
+    //A full rank covariance, the noise eigenvalues of m_matCov would dominate the error of an untruncated inverse
+    MatrixXd t_matMixing = MatrixXd::Random(306, 400);
+    MatrixXd t_matCov = t_matMixing * t_matMixing.transpose();
+
+    JacobiSVD<MatrixXd> t_svd(t_matCov, ComputeThinU | ComputeThinV);
+    double t_dTol = std::numeric_limits<double>::epsilon() * 306 * t_svd.singularValues()(0);
+    MatrixXd t_matReference = t_svd.matrixV() * (t_svd.singularValues().array() > t_dTol).select(t_svd.singularValues().array().inverse(), 0).matrix().asDiagonal() * t_svd.matrixU().adjoint();
+
+    MatrixXd t_matPinv = MNEMath::pinv<double>(t_matCov);
+    MatrixXd t_matPinvSelfAdjoint = MNEMath::pinvSelfAdjoint<double>(t_matCov);
+
+    QVERIFY((t_matCov * t_matPinv * t_matCov - t_matCov).norm() < 1e-10 * t_matCov.norm());
+    QVERIFY((t_matCov * t_matPinvSelfAdjoint * t_matCov - t_matCov).norm() < 1e-10 * t_matCov.norm());
+    QVERIFY((t_matPinvSelfAdjoint - t_matPinv).norm() < 1e-6 * t_matPinv.norm());
+    QVERIFY((t_matPinv - t_matReference).norm() < 1e-6 * t_matReference.norm());
+
+    //Small matrices are handed to a JacobiSVD by the BDCSVD
+    MatrixXd t_matSmallPinv = MNEMath::pinv<double>(t_matSmall);
+    QVERIFY((t_matSmallPinv * t_matSmall - MatrixXd::Identity(8, 8)).norm() < 1e-10);
+
+    //The truncated pseudo inverse of the leading RANK components
+    MatrixXd t_matPinvTruncated = MNEMath::pinvTruncated(m_matLead, RANK);
+    QVERIFY((m_matLead * t_matPinvTruncated * m_matLead - m_matLead).norm() < 1e-6 * m_matLead.norm());
+}
+
+
+//*************************************************************************************************************
+
+void TestMneMath::compareRandomizedSvd_data()
+{
+    addProblems();
+}
+
+
+//*************************************************************************************************************
+
+void TestMneMath::compareRandomizedSvd()
+{
+    QFETCH(int, type);
+    const MatrixXd& A = problem(type);
+
+    VectorXd t_vecReference = JacobiSVD<MatrixXd>(A).singularValues();
+    VectorXd t_vecBdc = BDCSVD<MatrixXd>(A).singularValues();
+    QVERIFY((t_vecBdc - t_vecReference).norm() < 1e-10 * t_vecReference.norm());
+
+    MatrixXd U, V;
+    VectorXd s;
+    qint32 k = MNEMath::randomizedSvd(A, RANK, U, s, V);
+    QCOMPARE(k, RANK);
+    QVERIFY((s - t_vecReference.head(RANK)).norm() < 1e-8 * t_vecReference.norm());
+    QVERIFY((U * s.asDiagonal() * V.transpose() - A).norm() < 1e-6 * A.norm());
+    QVERIFY((U.transpose() * U - MatrixXd::Identity(k, k)).norm() < 1e-10);
+
+    //The tolerance drops the noise components of an overestimated rank
+    k = MNEMath::randomizedSvd(A, RANK + 20, U, s, V, 1e-6);
+    QCOMPARE(k, RANK);
+    QCOMPARE(static_cast<int>(s.size()), RANK);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneMath::benchmarkSvd_data()
+{
+    QTest::addColumn<int>("type");
+    QTest::addColumn<int>("method");
+
+    QTest::newRow("306x306 JacobiSVD") << 0 << 0;
+    QTest::newRow("306x306 BDCSVD") << 0 << 1;
+    QTest::newRow("306x306 randomized") << 0 << 2;
+    QTest::newRow("306x306 self-adjoint") << 0 << 3;
+    QTest::newRow("366x8196 JacobiSVD") << 1 << 0;
+    QTest::newRow("366x8196 BDCSVD") << 1 << 1;
+    QTest::newRow("366x8196 randomized") << 1 << 2;
+}
+
+
+//*************************************************************************************************************
+
+void TestMneMath::benchmarkSvd()
+{
+    QFETCH(int, type);
+    QFETCH(int, method);
+    const MatrixXd& A = problem(type);
+
+    MatrixXd U, V;
+    VectorXd s;
+
+    QBENCHMARK {
+        switch(method) {
+            case 0: {
+                JacobiSVD<MatrixXd> t_svd(A, ComputeThinU | ComputeThinV);
+                s = t_svd.singularValues();
+                break;
+            }
+            case 1: {
+                BDCSVD<MatrixXd> t_svd(A, ComputeThinU | ComputeThinV);
+                s = t_svd.singularValues();
+                break;
+            }
+            case 2:
+                MNEMath::randomizedSvd(A, RANK, U, s, V);
+                break;
+            default: {
+                SelfAdjointEigenSolver<MatrixXd> t_eigenSolver(A);
+                s = t_eigenSolver.eigenvalues();
+                break;
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestMneMath::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMneMath)
+#include "test_mne_math.moc"
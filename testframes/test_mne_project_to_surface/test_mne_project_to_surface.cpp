@@ -0,0 +1,271 @@
+//=============================================================================================================
+/**
+* @file     test_mne_project_to_surface.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test and benchmark of the bounding volume hierarchy used by MNEProjectToSurface
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <mne/mne_bem_surface.h>
+#include <mne/mne_project_to_surface.h>
+
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QElapsedTimer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define NRING       388         /* Rings and vertices per ring of the test surface -> 301088 triangles */
+#define NPOINT      10000
+#define NCHECK      100
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMneProjectToSurface
+*
+* @brief The TestMneProjectToSurface class checks the accelerated nearest triangle search against an exhaustive
+*        search and reports the throughput for 10000 points on a surface with about 300000 triangles
+*
+*/
+class TestMneProjectToSurface: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMneProjectToSurface();
+
+private slots:
+    void initTestCase();
+    void projectToSurface();
+    void cleanupTestCase();
+
+private:
+    float bruteForceDistance(const Vector3f &r) const;
+
+    MNEBemSurface   m_surf;         /**< Synthetic triangulated head like surface. */
+    MatrixXf        m_matPoints;    /**< Points to project, NPOINT x 3. */
+};
+
+
+//*************************************************************************************************************
+
+TestMneProjectToSurface::TestMneProjectToSurface()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjectToSurface::initTestCase()
+{
+    //
+    //   A bumpy ellipsoid, closed with one vertex at each pole
+    //
+    const int nu = NRING;
+    const int nv = NRING;
+
+    m_surf.np = nu*nv+2;
+    m_surf.rr.resize(m_surf.np,3);
+    for(int i = 0; i < nv; ++i) {
+        for(int j = 0; j < nu; ++j) {
+            double th = M_PI*(i+1)/(nv+1);
+            double ph = 2.0*M_PI*j/nu;
+            double R = 0.09*(1.0+0.1*std::sin(3.0*ph)*std::sin(2.0*th));
+            m_surf.rr.row(i*nu+j) << R*std::sin(th)*std::cos(ph), R*std::sin(th)*std::sin(ph), 0.04+1.2*R*std::cos(th);
+        }
+    }
+    m_surf.rr.row(nu*nv) << 0.0f, 0.0f, 0.04f+1.2f*0.09f;
+    m_surf.rr.row(nu*nv+1) << 0.0f, 0.0f, 0.04f-1.2f*0.09f;
+
+    m_surf.ntri = 2*(nv-1)*nu + 2*nu;
+    m_surf.tris.resize(m_surf.ntri,3);
+    int k = 0;
+    for(int i = 0; i < nv-1; ++i) {
+        for(int j = 0; j < nu; ++j) {
+            int a = i*nu+j;
+            int b = i*nu+(j+1)%nu;
+            int c = (i+1)*nu+j;
+            int d = (i+1)*nu+(j+1)%nu;
+            m_surf.tris.row(k++) << a, c, b;
+            m_surf.tris.row(k++) << b, c, d;
+        }
+    }
+    for(int j = 0; j < nu; ++j) {
+        m_surf.tris.row(k++) << nu*nv, j, (j+1)%nu;
+        m_surf.tris.row(k++) << nu*nv+1, (nv-1)*nu+(j+1)%nu, (nv-1)*nu+j;
+    }
+    m_surf.tri_nn = MatrixX3d::Zero(m_surf.ntri,3);
+
+    qsrand(42);
+    m_matPoints.resize(NPOINT,3);
+    for(int i = 0; i < NPOINT; ++i)
+        for(int j = 0; j < 3; ++j)
+            m_matPoints(i,j) = 0.24f*((float)qrand()/RAND_MAX-0.5f) + (j == 2 ? 0.04f : 0.0f);
+
+    qDebug() << "Test surface with" << m_surf.ntri << "triangles";
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjectToSurface::projectToSurface()
+{
+    QElapsedTimer timer;
+
+    timer.start();
+    MNEProjectToSurface proj(m_surf);
+    qint64 tBuild = timer.nsecsElapsed();
+
+    MatrixXf rTri(NPOINT,3);
+    VectorXi vecNearest;
+    VectorXf vecDist;
+
+    timer.restart();
+    QVERIFY(proj.mne_find_closest_on_surface(m_matPoints, NPOINT, rTri, vecNearest, vecDist));
+    qint64 tQuery = timer.nsecsElapsed();
+
+    QCOMPARE((int)vecNearest.size(), NPOINT);
+
+    //
+    //   Compare a subset against the exhaustive search
+    //
+    float maxDiff = 0.0f;
+    timer.restart();
+    for(int i = 0; i < NCHECK; ++i) {
+        float dist = bruteForceDistance(m_matPoints.row(i).transpose());
+        maxDiff = qMax(maxDiff, std::fabs(std::fabs(vecDist(i)) - dist));
+        QVERIFY(std::fabs((rTri.row(i) - m_matPoints.row(i)).norm() - dist) < 1e-6);
+    }
+    qint64 tBrute = timer.nsecsElapsed();
+
+    qDebug() << "Hierarchy built in" << tBuild/1.0e6 << "ms";
+    qDebug() << NPOINT << "points projected in" << tQuery/1.0e6 << "ms";
+    qDebug() << "Exhaustive search extrapolated to" << NPOINT << "points:" << tBrute/1.0e6*NPOINT/NCHECK << "ms";
+    qDebug() << "Maximum distance difference" << maxDiff;
+
+    QVERIFY(maxDiff < 1e-6);
+}
+
+
+//*************************************************************************************************************
+
+void TestMneProjectToSurface::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+float TestMneProjectToSurface::bruteForceDistance(const Vector3f &r) const
+{
+    float best = -1.0f;
+
+    for(int i = 0; i < m_surf.ntri; ++i) {
+        Vector3f a = m_surf.rr.row(m_surf.tris(i,0)).transpose();
+        Vector3f b = m_surf.rr.row(m_surf.tris(i,1)).transpose();
+        Vector3f c = m_surf.rr.row(m_surf.tris(i,2)).transpose();
+
+        //
+        //   Closest point on the triangle by Voronoi region classification
+        //
+        Vector3f ab = b-a, ac = c-a, ap = r-a;
+        Vector3f bp = r-b, cp = r-c;
+        float d1 = ab.dot(ap), d2 = ac.dot(ap);
+        float d3 = ab.dot(bp), d4 = ac.dot(bp);
+        float d5 = ab.dot(cp), d6 = ac.dot(cp);
+        float va = d3*d6-d5*d4, vb = d5*d2-d1*d6, vc = d1*d4-d3*d2;
+        Vector3f q;
+
+        if(d1 <= 0.0f && d2 <= 0.0f)
+            q = a;
+        else if(d3 >= 0.0f && d4 <= d3)
+            q = b;
+        else if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+            q = a + d1/(d1-d3)*ab;
+        else if(d6 >= 0.0f && d5 <= d6)
+            q = c;
+        else if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+            q = a + d2/(d2-d6)*ac;
+        else if(va <= 0.0f && d4-d3 >= 0.0f && d5-d6 >= 0.0f)
+            q = b + (d4-d3)/((d4-d3)+(d5-d6))*(c-b);
+        else
+            q = a + (vb*ab + vc*ac)/(va+vb+vc);
+
+        float dist = (r-q).norm();
+        if(best < 0.0f || dist < best)
+            best = dist;
+    }
+    return best;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMneProjectToSurface)
+#include "test_mne_project_to_surface.moc"
@@ -0,0 +1,245 @@
+//=============================================================================================================
+/**
+* @file     test_rtfilter.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test the delay of the streaming filter modes.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <realtime/rtProcessing/rtfilter.h>
+#include <utils/filterTools/filterdata.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtFilter
+*
+* @brief The TestRtFilter class streams impulses through RtFilter and verifies the group delay of the filtered
+*        and the unfiltered channels in both filter modes
+*
+*/
+class TestRtFilter: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtFilter();
+
+private slots:
+    void initTestCase();
+    void impulseDelayCompensated();
+    void impulseCausal();
+    void cleanupTestCase();
+
+private:
+    MatrixXd streamImpulse(RtFilter::FilterMode mode, int& iDelay);
+    double groupDelay(const RowVectorXd& vecResponse) const;
+
+    QList<FilterData>   m_lFilterData;      /**< A linear-phase low pass. */
+    int                 m_iImpulse;         /**< Sample of the input impulse. */
+    int                 m_iSamples;         /**< Number of streamed samples. */
+    int                 m_iBlockSize;       /**< Size of the streamed blocks. */
+};
+
+
+//*************************************************************************************************************
+
+TestRtFilter::TestRtFilter()
+: m_iImpulse(30)
+, m_iSamples(600)
+, m_iBlockSize(50)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtFilter::initTestCase()
+{
+    //Hamming windowed sinc with 129 taps, i.e. a linear-phase filter with a group delay of 64 samples
+    const int iTaps = 129;
+    const double dCutOff = 0.1;
+    RowVectorXd vecCoeffs(iTaps);
+    for(int n = 0; n < iTaps; ++n) {
+        double m = n - (iTaps - 1) / 2.0;
+        double dSinc = m == 0.0 ? 2.0 * dCutOff : qSin(2.0 * M_PI * dCutOff * m) / (M_PI * m);
+        vecCoeffs(n) = dSinc * (0.54 - 0.46 * qCos(2.0 * M_PI * n / (iTaps - 1)));
+    }
+
+    FilterData filter;
+    filter.m_dCoeffA = vecCoeffs;
+    m_lFilterData << filter;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtFilter::streamImpulse(RtFilter::FilterMode mode, int& iDelay)
+{
+    //Channel 0 is filtered, channel 1 is passed through
+    MatrixXd matData = MatrixXd::Zero(2, m_iSamples);
+    matData.col(m_iImpulse).setOnes();
+
+    QVector<int> vecChannels;
+    vecChannels << 0;
+
+    RtFilter rtFilter;
+    if(!rtFilter.prepare(m_lFilterData, vecChannels, matData.rows(), m_iBlockSize, mode))
+        return MatrixXd();
+
+    iDelay = rtFilter.delay();
+
+    MatrixXd matOut(matData.rows(), m_iSamples);
+    MatrixXd matBlock;
+    for(int i = 0; i < m_iSamples; i += m_iBlockSize) {
+        if(!rtFilter.filter(matData.middleCols(i, m_iBlockSize), matBlock))
+            return MatrixXd();
+        matOut.middleCols(i, m_iBlockSize) = matBlock;
+    }
+
+    return matOut;
+}
+
+
+//*************************************************************************************************************
+
+double TestRtFilter::groupDelay(const RowVectorXd& vecResponse) const
+{
+    //Group delay at DC of the response to the impulse, relative to the impulse
+    double dMoment = 0.0;
+    for(int n = 0; n < vecResponse.cols(); ++n)
+        dMoment += n * vecResponse(n);
+
+    return dMoment / vecResponse.sum() - m_iImpulse;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtFilter::impulseDelayCompensated()
+{
+    int iDelay = -1;
+    MatrixXd matOut = streamImpulse(RtFilter::DelayCompensated, iDelay);
+    QCOMPARE(int(matOut.cols()), m_iSamples);
+    QCOMPARE(iDelay, 64);
+
+    //The filtered channel is the shifted impulse response, its group delay is the reported delay
+    QVERIFY((matOut.row(0).segment(m_iImpulse, 129) - m_lFilterData.first().m_dCoeffA).cwiseAbs().maxCoeff() < 1e-12);
+    QVERIFY(qAbs(groupDelay(matOut.row(0)) - iDelay) < 1e-9);
+
+    //The unfiltered channel is delayed by the same amount
+    QCOMPARE(matOut(1, m_iImpulse + iDelay), 1.0);
+    QVERIFY(qAbs(matOut.row(1).cwiseAbs().sum() - 1.0) < 1e-12);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtFilter::impulseCausal()
+{
+    int iDelay = -1;
+    MatrixXd matOut = streamImpulse(RtFilter::Causal, iDelay);
+    QCOMPARE(int(matOut.cols()), m_iSamples);
+    QCOMPARE(iDelay, 0);
+
+    //The unfiltered channel is passed through
+    QCOMPARE(matOut(1, m_iImpulse), 1.0);
+    QVERIFY(qAbs(matOut.row(1).cwiseAbs().sum() - 1.0) < 1e-12);
+
+    //The filtered channel does not respond before the impulse and has a fraction of the linear-phase delay
+    QVERIFY(matOut.row(0).head(m_iImpulse).cwiseAbs().maxCoeff() < 1e-12);
+    double dGroupDelay = groupDelay(matOut.row(0));
+    QVERIFY(dGroupDelay > 0.0);
+    QVERIFY(dGroupDelay < 16.0);
+
+    //The magnitude response is the one of the linear-phase filter
+    const int iFFTLength = 1024;
+    RowVectorXd vecLinear = RowVectorXd::Zero(iFFTLength);
+    RowVectorXd vecMinimum = RowVectorXd::Zero(iFFTLength);
+    vecLinear.head(129) = m_lFilterData.first().m_dCoeffA;
+    vecMinimum.head(m_iSamples - m_iImpulse) = matOut.row(0).tail(m_iSamples - m_iImpulse);
+
+    Eigen::FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+    RowVectorXcd vecSpecLinear, vecSpecMinimum;
+    fft.fwd(vecSpecLinear, vecLinear);
+    fft.fwd(vecSpecMinimum, vecMinimum);
+
+    QVERIFY((vecSpecLinear.cwiseAbs() - vecSpecMinimum.cwiseAbs()).cwiseAbs().maxCoeff() < 1e-3);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtFilter::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtFilter)
+#include "test_rtfilter.moc"
@@ -0,0 +1,235 @@
+//=============================================================================================================
+/**
+* @file     test_rtrawcodec.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the quantizing raw buffer codec
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <realtime/rtClient/rtrawcodec.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtRawCodec
+*
+* @brief The TestRtRawCodec class verifies that raw buffers on the calibration grid round-trip losslessly, that
+*        buffers beyond the integer range are quantized coarser and that malformed payloads are rejected
+*
+*/
+class TestRtRawCodec: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtRawCodec();
+
+private slots:
+    void initTestCase();
+    void compareLossless_data();
+    void compareLossless();
+    void compareCoarse();
+    void rejectMalformed();
+    void compareNames();
+    void cleanupTestCase();
+
+private:
+    MatrixXi    m_matSteps;     /**< Random walk of calibration steps with one large jump per channel. */
+    VectorXf    m_vecLsb;       /**< Calibration step of each channel. */
+};
+
+
+//*************************************************************************************************************
+
+TestRtRawCodec::TestRtRawCodec()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRawCodec::initTestCase()
+{
+    std::srand(7);
+
+    m_vecLsb.resize(4);
+    m_vecLsb << 1e-13f, 2e-12f, 1e-6f, 1.0f;
+
+    m_matSteps.resize(m_vecLsb.size(), 1000);
+    for(qint32 i = 0; i < m_matSteps.rows(); ++i) {
+        qint32 iValue = i * 100;
+        for(qint32 j = 0; j < m_matSteps.cols(); ++j) {
+            iValue += std::rand() % 17 - 8;
+            m_matSteps(i,j) = iValue;
+        }
+
+        // A jump which needs the escape of the Rice code
+        m_matSteps(i,500) = 20000;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRawCodec::compareLossless_data()
+{
+    QTest::addColumn<int>("bits");
+
+    QTest::newRow("int16") << 16;
+    QTest::newRow("int24") << 24;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRawCodec::compareLossless()
+{
+    QFETCH(int, bits);
+
+    MatrixXf matData = m_vecLsb.asDiagonal() * m_matSteps.cast<float>();
+
+    QByteArray payload = RtRawCodec::encode(matData, m_vecLsb, bits);
+
+    MatrixXf matDecoded;
+    QVERIFY( RtRawCodec::decode(reinterpret_cast<const uchar*>(payload.constData()), payload.size(), matDecoded) );
+
+    QCOMPARE( matDecoded.rows(), matData.rows() );
+    QCOMPARE( matDecoded.cols(), matData.cols() );
+    QVERIFY( matDecoded == matData );
+
+    // Small differences take a few bits per sample, less than a quarter of float32
+    QVERIFY( payload.size() < matData.size() * (qint32)sizeof(float) / 4 );
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRawCodec::compareCoarse()
+{
+    // The buffer exceeds the 16 bit range of the calibration step, so the step is coarsened to fit
+    MatrixXf matData = 1e-9f * m_matSteps.cast<float>();
+    VectorXf vecLsb = VectorXf::Constant(matData.rows(), 1e-13f);
+
+    QByteArray payload = RtRawCodec::encode(matData, vecLsb, 16);
+
+    MatrixXf matDecoded;
+    QVERIFY( RtRawCodec::decode(reinterpret_cast<const uchar*>(payload.constData()), payload.size(), matDecoded) );
+
+    for(qint32 i = 0; i < matData.rows(); ++i) {
+        float fStep = matData.row(i).cwiseAbs().maxCoeff() / 32767.0f;
+        QVERIFY( (matDecoded.row(i) - matData.row(i)).cwiseAbs().maxCoeff() <= 0.51f * fStep );
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRawCodec::rejectMalformed()
+{
+    MatrixXf matData = m_vecLsb.asDiagonal() * m_matSteps.cast<float>();
+    QByteArray payload = RtRawCodec::encode(matData, m_vecLsb, 16);
+    const uchar* pData = reinterpret_cast<const uchar*>(payload.constData());
+
+    MatrixXf matDecoded;
+
+    // A truncated bit stream and a truncated header
+    QVERIFY( !RtRawCodec::decode(pData, payload.size() - 1, matDecoded) );
+    QVERIFY( !RtRawCodec::decode(pData, 8, matDecoded) );
+
+    // An unknown number of bits
+    QByteArray corrupt = payload;
+    corrupt[0] = 8;
+    QVERIFY( !RtRawCodec::decode(reinterpret_cast<const uchar*>(corrupt.constData()), corrupt.size(), matDecoded) );
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRawCodec::compareNames()
+{
+    QList<RtRawCodec::Encoding> lEncodings;
+    lEncodings << RtRawCodec::Float32 << RtRawCodec::Float16 << RtRawCodec::Int16 << RtRawCodec::Int24;
+
+    for(qint32 i = 0; i < lEncodings.size(); ++i)
+        QCOMPARE( RtRawCodec::encodingFromName(RtRawCodec::encodingName(lEncodings[i])), lEncodings[i] );
+
+    QCOMPARE( RtRawCodec::encodingFromName("INT24"), RtRawCodec::Int24 );
+    QCOMPARE( RtRawCodec::encodingFromName("unknown"), RtRawCodec::Float32 );
+
+    QCOMPARE( RtRawCodec::quantizationBits(RtRawCodec::Int16), 16 );
+    QCOMPARE( RtRawCodec::quantizationBits(RtRawCodec::Int24), 24 );
+    QCOMPARE( RtRawCodec::quantizationBits(RtRawCodec::Float16), 0 );
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRawCodec::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtRawCodec)
+#include "test_rtrawcodec.moc"
@@ -0,0 +1,245 @@
+//=============================================================================================================
+/**
+* @file     test_rtresample.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the streaming and offline polyphase resampler
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <realtime/rtProcessing/rtresample.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtResample
+*
+* @brief The TestRtResample class verifies that the streaming resampler gives the same result for any block
+*        partitioning and that the offline variant reproduces band limited signals at the new rate
+*
+*/
+class TestRtResample: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtResample();
+
+private slots:
+    void initTestCase();
+    void compareBlocks_data();
+    void compareBlocks();
+    void compareSine_data();
+    void compareSine();
+    void compareRatio();
+    void cleanupTestCase();
+
+private:
+    void addRatios();
+
+    MatrixXd    m_matData;      /**< Random multi-channel test data. */
+};
+
+
+//*************************************************************************************************************
+
+TestRtResample::TestRtResample()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtResample::initTestCase()
+{
+    m_matData = MatrixXd::Random(8, 3000);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtResample::addRatios()
+{
+    QTest::addColumn<int>("up");
+    QTest::addColumn<int>("down");
+
+    QTest::newRow("1/4") << 1 << 4;
+    QTest::newRow("2/3") << 2 << 3;
+    QTest::newRow("3/2") << 3 << 2;
+    QTest::newRow("160/147") << 160 << 147;
+    QTest::newRow("5/1") << 5 << 1;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtResample::compareBlocks_data()
+{
+    addRatios();
+}
+
+
+//*************************************************************************************************************
+
+void TestRtResample::compareBlocks()
+{
+    QFETCH(int, up);
+    QFETCH(int, down);
+
+    RtResample whole(up, down, m_matData.rows());
+    MatrixXd matWhole;
+    QVERIFY(whole.resample(m_matData, matWhole));
+
+    //Uneven blocks, some of them shorter than the filter
+    RtResample blocks(up, down, m_matData.rows());
+    const int sizes[] = {1, 7, 100, 3, 513, 64};
+    MatrixXd matBlocks(m_matData.rows(), 0);
+    int iPos = 0;
+    int k = 0;
+    while(iPos < m_matData.cols()) {
+        int iSize = qMin<int>(sizes[k++ % 6], m_matData.cols() - iPos);
+        MatrixXd matOut;
+        QVERIFY(blocks.resample(m_matData.middleCols(iPos, iSize), matOut));
+
+        MatrixXd matAppended(m_matData.rows(), matBlocks.cols() + matOut.cols());
+        matAppended << matBlocks, matOut;
+        matBlocks = matAppended;
+        iPos += iSize;
+    }
+
+    QCOMPARE(matBlocks.cols(), matWhole.cols());
+    QVERIFY((matBlocks - matWhole).cwiseAbs().maxCoeff() < 1e-12);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtResample::compareSine_data()
+{
+    addRatios();
+}
+
+
+//*************************************************************************************************************
+
+void TestRtResample::compareSine()
+{
+    QFETCH(int, up);
+    QFETCH(int, down);
+
+    //A tone well below the lower Nyquist frequency and a constant
+    const int iSamples = 4000;
+    double dFreq = 0.05 * qMin(1.0, double(up) / down);
+    MatrixXd matData(2, iSamples);
+    for(int i = 0; i < iSamples; ++i) {
+        matData(0, i) = qSin(2.0 * M_PI * dFreq * i);
+        matData(1, i) = 1.0;
+    }
+
+    MatrixXd matOut = RtResample::resampleOffline(matData, up, down);
+    QCOMPARE(int(matOut.cols()), int(qCeil(double(iSamples) * up / down)));
+
+    double dError = 0.0;
+    double dErrorDC = 0.0;
+    for(int k = 0; k < matOut.cols(); ++k) {
+        double t = double(k) * down / up;
+        if(t > 200 && t < iSamples - 200) {
+            dError = qMax(dError, qAbs(matOut(0, k) - qSin(2.0 * M_PI * dFreq * t)));
+            dErrorDC = qMax(dErrorDC, qAbs(matOut(1, k) - 1.0));
+        }
+    }
+
+    QVERIFY(dError < 1e-3);
+    QVERIFY(dErrorDC < 1e-12);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtResample::compareRatio()
+{
+    int iUp, iDown;
+
+    QVERIFY(RtResample::ratio(44100.0, 48000.0, iUp, iDown));
+    QCOMPARE(iUp, 160);
+    QCOMPARE(iDown, 147);
+
+    QVERIFY(RtResample::ratio(1000.0, 250.0, iUp, iDown));
+    QCOMPARE(iUp, 1);
+    QCOMPARE(iDown, 4);
+
+    QVERIFY(!RtResample::ratio(1000.0, 1000.0 * M_PI, iUp, iDown));
+}
+
+
+//*************************************************************************************************************
+
+void TestRtResample::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtResample)
+#include "test_rtresample.moc"
@@ -0,0 +1,207 @@
+//=============================================================================================================
+/**
+* @file     test_rtshmemring.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the shared memory ring transport
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <realtime/rtClient/rtshmemring.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QCoreApplication>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtShmemRing
+*
+* @brief The TestRtShmemRing class verifies that blocks pass the shared memory ring in order and unchanged, also
+*        when they wrap around its end, and that a full ring refuses a block as a whole
+*
+*/
+class TestRtShmemRing: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtShmemRing();
+
+private slots:
+    void initTestCase();
+    void compareAttach();
+    void compareWrap();
+    void rejectFull();
+    void cleanupTestCase();
+
+private:
+    QByteArray makeBlock(qint32 iSize, char cFirst) const;
+
+    QString             m_sKey;         /**< Shared memory key of this test run. */
+    RtShmemRing::SPtr   m_pWriter;      /**< The ring end of the server. */
+    RtShmemRing::SPtr   m_pReader;      /**< The ring end of the client. */
+};
+
+
+//*************************************************************************************************************
+
+TestRtShmemRing::TestRtShmemRing()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtShmemRing::initTestCase()
+{
+    m_sKey = QString("test_rtshmemring_%1").arg(QCoreApplication::applicationPid());
+
+    m_pWriter = RtShmemRing::SPtr(new RtShmemRing(m_sKey));
+    m_pReader = RtShmemRing::SPtr(new RtShmemRing(m_sKey));
+}
+
+
+//*************************************************************************************************************
+
+void TestRtShmemRing::compareAttach()
+{
+    // Nothing to attach to before the writer created the segment
+    QVERIFY( !m_pReader->attach() );
+    QCOMPARE( m_pReader->capacity(), 0 );
+
+    QVERIFY( m_pWriter->create(64) );
+    QVERIFY( m_pReader->attach() );
+    QVERIFY( m_pReader->isAttached() );
+    QCOMPARE( m_pReader->capacity(), 64 );
+
+    QCOMPARE( RtShmemRing::clientKey(3), QString("mne_rt_server_shmem_3") );
+}
+
+
+//*************************************************************************************************************
+
+void TestRtShmemRing::compareWrap()
+{
+    QByteArray read;
+    QCOMPARE( m_pReader->read(read), 0 );
+
+    // The second block starts at 40 and wraps around the end of the 64 byte ring
+    QByteArray first = makeBlock(40, 'a');
+    QByteArray second = makeBlock(50, 'A');
+
+    QVERIFY( m_pWriter->write(first) );
+    QCOMPARE( m_pReader->read(read), 40 );
+    QVERIFY( read == first );
+
+    read.clear();
+    QVERIFY( m_pWriter->write(second) );
+    QCOMPARE( m_pReader->read(read), 50 );
+    QVERIFY( read == second );
+
+    // Reads append to what is already there
+    QVERIFY( m_pWriter->write(first.left(10)) );
+    QVERIFY( m_pWriter->write(first.mid(10)) );
+    read.clear();
+    QCOMPARE( m_pReader->read(read), 40 );
+    QVERIFY( read == first );
+}
+
+
+//*************************************************************************************************************
+
+void TestRtShmemRing::rejectFull()
+{
+    QByteArray read;
+
+    QVERIFY( m_pWriter->write(makeBlock(60, 'a')) );
+
+    // A block which does not fit is not written in part
+    QVERIFY( !m_pWriter->write(makeBlock(10, 'A')) );
+    QVERIFY( m_pWriter->write(makeBlock(4, '0')) );
+    QVERIFY( !m_pWriter->write(makeBlock(1, '0')) );
+
+    QCOMPARE( m_pReader->read(read), 64 );
+    QVERIFY( read == makeBlock(60, 'a') + makeBlock(4, '0') );
+
+    // A detached ring neither writes nor reads
+    m_pReader->detach();
+    QVERIFY( !m_pReader->isAttached() );
+    QVERIFY( !m_pReader->write(makeBlock(1, '0')) );
+    QCOMPARE( m_pReader->read(read), 0 );
+}
+
+
+//*************************************************************************************************************
+
+void TestRtShmemRing::cleanupTestCase()
+{
+    m_pReader->detach();
+    m_pWriter->detach();
+}
+
+
+//*************************************************************************************************************
+
+QByteArray TestRtShmemRing::makeBlock(qint32 iSize, char cFirst) const
+{
+    QByteArray block(iSize, 0);
+    for(qint32 i = 0; i < iSize; ++i)
+        block[i] = (char)(cFirst + i % 26);
+
+    return block;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtShmemRing)
+#include "test_rtshmemring.moc"
@@ -0,0 +1,233 @@
+//=============================================================================================================
+/**
+* @file     test_rtstreamaligner.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the alignment of a secondary raw stream to a reference stream
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <realtime/rtProcessing/rtstreamaligner.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtMath>
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestRtStreamAligner
+*
+* @brief The TestRtStreamAligner class merges two synthetic streams of a tone with a known phase difference the
+*        way the stream merger of mne_rt_server does and verifies that the secondary stream keeps its phase
+*        with respect to the primary stream
+*
+*/
+class TestRtStreamAligner: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtStreamAligner();
+
+private slots:
+    void initTestCase();
+    void alignStreams_data();
+    void alignStreams();
+    void cleanupTestCase();
+
+private:
+    MatrixXf tone(qint64 iFirst, int iSamples, double dSFreq, double dPhase) const;
+
+    double      m_dFreq;        /**< Frequency of the tone. */
+    double      m_dPhase;       /**< Phase of the secondary tone with respect to the primary tone. */
+};
+
+
+//*************************************************************************************************************
+
+TestRtStreamAligner::TestRtStreamAligner()
+: m_dFreq(7.0)
+, m_dPhase(M_PI / 4.0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtStreamAligner::initTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MatrixXf TestRtStreamAligner::tone(qint64 iFirst, int iSamples, double dSFreq, double dPhase) const
+{
+    MatrixXf matData(2, iSamples);
+    for(int j = 0; j < iSamples; ++j) {
+        double t = double(iFirst + j) / dSFreq;
+        matData(0, j) = qSin(2.0 * M_PI * m_dFreq * t + dPhase);
+        matData(1, j) = qCos(2.0 * M_PI * m_dFreq * t + dPhase);
+    }
+    return matData;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtStreamAligner::alignStreams_data()
+{
+    QTest::addColumn<double>("sFreq");
+    QTest::addColumn<int>("block");
+    QTest::addColumn<double>("tolerance");
+
+    //The tolerance is the error of the linear interpolation of the tone at the secondary rate
+    QTest::newRow("250 Hz") << 250.0 << 40 << 0.01;
+    QTest::newRow("600 Hz") << 600.0 << 60 << 0.002;
+    QTest::newRow("2000 Hz") << 2000.0 << 25 << 0.001;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtStreamAligner::alignStreams()
+{
+    QFETCH(double, sFreq);
+    QFETCH(int, block);
+    QFETCH(double, tolerance);
+
+    const double dRefSFreq = 1000.0;
+    const int iRefBlock = 100;
+    const qint64 iTransportNs = 1000000;
+    const qint64 iDurationNs = 10000000000LL;
+    const qint64 iSettleNs = 1000000000LL;
+
+    RtStreamAligner aligner;
+    aligner.prepare(2, sFreq, dRefSFreq);
+
+    QList<MatrixXf> qListPending;
+    QList<qint64> qListPendingNs;
+    qint64 iRefFirst = 0;
+    qint64 iFirst = 0;
+    double dError = 0.0;
+    qint32 iHeld = 0;
+    qint32 iMerged = 0;
+    bool bResynced = false;
+
+    //
+    // Both streams start at the same time, each buffer arrives a fixed transport time after its last sample. The
+    // streams are polled every ms and the reference buffers are held back by the latency of the secondary stream,
+    // as in the stream merger.
+    //
+    for(qint64 iNowNs = 0; iNowNs < iDurationNs; iNowNs += 1000000)
+    {
+        qint64 iArrivalNs;
+
+        while((iArrivalNs = qint64(double(iFirst + block - 1) / sFreq * 1.0e9) + iTransportNs) <= iNowNs) {
+            QVERIFY(aligner.append(tone(iFirst, block, sFreq, m_dPhase), iArrivalNs));
+            iFirst += block;
+        }
+
+        while((iArrivalNs = qint64(double(iRefFirst + iRefBlock - 1) / dRefSFreq * 1.0e9) + iTransportNs) <= iNowNs) {
+            qListPending.append(tone(iRefFirst, iRefBlock, dRefSFreq, 0.0));
+            qListPendingNs.append(iArrivalNs);
+            iRefFirst += iRefBlock;
+        }
+
+        while(!qListPending.isEmpty() && iNowNs - qListPendingNs.first() >= aligner.latencyNs()) {
+            MatrixXf matMerged(4, iRefBlock);
+            matMerged.topRows(2) = qListPending.first();
+
+            bool bResync = false;
+            qint32 iBlockHeld = aligner.resample(qListPendingNs.first(), matMerged, 2, bResync);
+
+            if(qListPendingNs.first() > iSettleNs) {
+                MatrixXf matExpected = tone(iRefFirst - iRefBlock * qListPending.size(), iRefBlock, dRefSFreq, m_dPhase);
+                dError = qMax(dError, double((matMerged.bottomRows(2) - matExpected).cwiseAbs().maxCoeff()));
+                iHeld += iBlockHeld;
+                bResynced = bResynced || bResync;
+                ++iMerged;
+            }
+
+            qListPending.removeFirst();
+            qListPendingNs.removeFirst();
+        }
+    }
+
+    QVERIFY(iMerged > 80);
+    QVERIFY(!bResynced);
+    QCOMPARE(iHeld, 0);
+    QVERIFY(dError < tolerance);
+    QVERIFY(qAbs(aligner.step() - sFreq / dRefSFreq) < 1e-6 * sFreq / dRefSFreq);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtStreamAligner::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtStreamAligner)
+#include "test_rtstreamaligner.moc"
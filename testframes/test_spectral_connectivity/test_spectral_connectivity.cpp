@@ -40,13 +40,32 @@
 //=============================================================================================================
 
 #include <utils/ioutils.h>
+#include <utils/spectral.h>
 #include "connectivity/metrics/coherence.h"
+#include "connectivity/metrics/crosscorrelation.h"
 #include "connectivity/metrics/imagcoherence.h"
 #include "connectivity/metrics/phaselockingvalue.h"
 #include "connectivity/metrics/phaselagindex.h"
 #include "connectivity/metrics/unbiasedsquaredphaselagindex.h"
 #include "connectivity/metrics/weightedphaselagindex.h"
 #include "connectivity/metrics/debiasedsquaredweightedphaselagindex.h"
+#include "connectivity/connectivity.h"
+#include "connectivity/connectivitysettings.h"
+#include "connectivity/incrementalconnectivity.h"
+#include "connectivity/connectivitystatistics.h"
+#include "connectivity/network/network.h"
+#include "connectivity/network/networkedge.h"
+#include "connectivity/network/sparsenetwork.h"
+#include "connectivity/network/graphmetrics.h"
+#include "connectivity/sourceroireduction.h"
+
+#include <fiff/fiff_info.h>
+#include <fiff/fiff_stream.h>
+#include <fs/label.h>
+#include <mne/mne_sourcespace.h>
+
+#include <limits>
+#include <cmath>
 
 
 //*************************************************************************************************************
@@ -55,6 +74,8 @@
 //=============================================================================================================
 
 #include <QtTest>
+#include <QThreadPool>
+#include <QElapsedTimer>
 
 
 //*************************************************************************************************************
@@ -63,6 +84,7 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <Eigen/SVD>
 
 
 //*************************************************************************************************************
@@ -73,6 +95,9 @@
 using namespace Eigen;
 using namespace CONNECTIVITYLIB;
 using namespace UTILSLIB;
+using namespace FIFFLIB;
+using namespace FSLIB;
+using namespace MNELIB;
 
 
 //=============================================================================================================
@@ -98,6 +123,16 @@ private slots:
     void spectralConnectivityPLI2();
     void spectralConnectivityWPLI();
     void spectralConnectivityWPLI2();
+    void spectralConnectivityMultiMethod();
+    void spectralConnectivityBands();
+    void spectralConnectivityIncremental();
+    void spectralConnectivitySparseNetwork();
+    void spectralConnectivityCrossCorrelation();
+    void spectralConnectivityRoiReduction();
+    void spectralConnectivityGraphMetrics();
+    void spectralConnectivitySurrogates();
+    void spectralConnectivityScaling();
+    void spectralBatchedSpectra();
     void cleanupTestCase();
 
 private:
@@ -376,6 +411,608 @@ void TestSpectralConnectivity::spectralConnectivityWPLI2()
 }
 
 
+//*************************************************************************************************************
+
+void TestSpectralConnectivity::spectralConnectivityMultiMethod()
+{
+    //*********************************************************************************************************
+    // Load Data
+    //*********************************************************************************************************
+
+    ConnectivitySettings settings;
+    settings.m_matDataList = readConnectivityData();
+    settings.m_iNfft = settings.m_matDataList.at(0).cols();
+    settings.m_sWindowType = "hanning";
+    settings.m_sConnectivityMethods << "COH" << "IMAGCOH" << "PLV" << "PLI" << "WPLI";
+
+    //*********************************************************************************************************
+    // Compute all methods with shared tapered spectra and each one on its own
+    //*********************************************************************************************************
+
+    QList<Network> lNetworks = Connectivity(settings).calculateConnectivities();
+
+    QList<Network> lRefNetworks;
+    lRefNetworks << Coherence::coherence(settings.m_matDataList, settings.m_matNodePositions, settings.m_iNfft, settings.m_sWindowType)
+                 << ImagCoherence::imagCoherence(settings.m_matDataList, settings.m_matNodePositions, settings.m_iNfft, settings.m_sWindowType)
+                 << PhaseLockingValue::phaseLockingValue(settings.m_matDataList, settings.m_matNodePositions, settings.m_iNfft, settings.m_sWindowType)
+                 << PhaseLagIndex::phaseLagIndex(settings.m_matDataList, settings.m_matNodePositions, settings.m_iNfft, settings.m_sWindowType)
+                 << WeightedPhaseLagIndex::weightedPhaseLagIndex(settings.m_matDataList, settings.m_matNodePositions, settings.m_iNfft, settings.m_sWindowType);
+
+    //*********************************************************************************************************
+    // Compare
+    //*********************************************************************************************************
+
+    QCOMPARE(lNetworks.size(), lRefNetworks.size());
+
+    for (int i = 0; i < lNetworks.size(); ++i) {
+        QCOMPARE(lNetworks.at(i).getEdges().size(), lRefNetworks.at(i).getEdges().size());
+        QVERIFY(lNetworks.at(i).getEdges().size() > 0);
+
+        for (int j = 0; j < lNetworks.at(i).getEdges().size(); ++j) {
+            MatrixXd matWeight = lNetworks.at(i).getEdges().at(j)->getWeight();
+            MatrixXd matRefWeight = lRefNetworks.at(i).getEdges().at(j)->getWeight();
+            QCOMPARE(matWeight.size(), matRefWeight.size());
+            // Same arithmetic in the same order, so the results must be identical (NaN included)
+            QVERIFY(((matWeight.array() == matRefWeight.array()) ||
+                     (matWeight.array() != matWeight.array() && matRefWeight.array() != matRefWeight.array())).all());
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectralConnectivity::spectralConnectivityBands()
+{
+    //*********************************************************************************************************
+    // Load Data
+    //*********************************************************************************************************
+
+    ConnectivitySettings settings;
+    settings.m_matDataList = readConnectivityData();
+    settings.m_iNfft = settings.m_matDataList.at(0).cols();
+    settings.m_sWindowType = "hanning";
+    settings.m_sConnectivityMethods << "COH" << "PLV" << "WPLI";
+    FiffInfo info;
+    info.sfreq = 1000.0f;
+    settings.setFiffInfo(info);
+
+    //*********************************************************************************************************
+    // Compute the full frequency axis and the alpha and beta bands only
+    //*********************************************************************************************************
+
+    QList<Network> lRefNetworks = Connectivity(settings).calculateConnectivities();
+
+    settings.m_lFrequencyBands << QPair<float,float>(8.0f, 12.0f) << QPair<float,float>(13.0f, 30.0f);
+    QList<Network> lBandNetworks = Connectivity(settings).calculateConnectivities();
+
+    //*********************************************************************************************************
+    // Compare against the full axis averaged over each band
+    //*********************************************************************************************************
+
+    int iNBands = settings.m_lFrequencyBands.size();
+    QCOMPARE(lBandNetworks.size(), lRefNetworks.size() * iNBands);
+
+    for (int i = 0; i < lRefNetworks.size(); ++i) {
+        for (int b = 0; b < iNBands; ++b) {
+            const Network& bandNetwork = lBandNetworks.at(i * iNBands + b);
+            QCOMPARE(bandNetwork.getEdges().size(), lRefNetworks.at(i).getEdges().size());
+            QVERIFY(bandNetwork.getEdges().size() > 0);
+
+            for (int j = 0; j < bandNetwork.getEdges().size(); ++j) {
+                MatrixXd matRefWeight = lRefNetworks.at(i).getEdges().at(j)->getWeight();
+                double dRef = 0.0;
+                int iNBins = 0;
+                for (int f = 0; f < matRefWeight.rows(); ++f) {
+                    double dFreq = f * settings.m_fSFreq / settings.m_iNfft;
+                    if (dFreq >= settings.m_lFrequencyBands.at(b).first && dFreq <= settings.m_lFrequencyBands.at(b).second) {
+                        dRef += matRefWeight(f,0);
+                        ++iNBins;
+                    }
+                }
+                QVERIFY(iNBins > 0);
+
+                MatrixXd matWeight = bandNetwork.getEdges().at(j)->getWeight();
+                QCOMPARE(matWeight.size(), 1);
+                QVERIFY(fabs(matWeight(0,0) - dRef / iNBins) < 1e-10);
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectralConnectivity::spectralConnectivityIncremental()
+{
+    //*********************************************************************************************************
+    // Generate data: 8 channels, 20 trials, 128 samples
+    //*********************************************************************************************************
+
+    QList<MatrixXd> matDataList;
+    qsrand(11);
+    for (int i = 0; i < 20; ++i) {
+        MatrixXd matTrial(8, 128);
+        for (int r = 0; r < matTrial.rows(); ++r) {
+            for (int c = 0; c < matTrial.cols(); ++c) {
+                matTrial(r,c) = double(qrand()) / RAND_MAX - 0.5;
+            }
+        }
+        matDataList.append(matTrial);
+    }
+
+    //*********************************************************************************************************
+    // Slide a window of 8 trials over the data and compare against the batch estimate of the last 8 trials
+    //*********************************************************************************************************
+
+    int iWindowSize = 8;
+
+    ConnectivitySettings settings;
+    settings.m_matDataList = matDataList.mid(matDataList.size() - iWindowSize);
+    settings.m_iNfft = 128;
+    settings.m_sWindowType = "hanning";
+    settings.m_sConnectivityMethods = IncrementalConnectivity::supportedMethods();
+
+    QList<Network> lRefNetworks = Connectivity(settings).calculateConnectivities();
+    QCOMPARE(lRefNetworks.size(), settings.m_sConnectivityMethods.size());
+
+    for (int m = 0; m < settings.m_sConnectivityMethods.size(); ++m) {
+        IncrementalConnectivity incremental(settings.m_sConnectivityMethods.at(m), settings.m_iNfft, settings.m_sWindowType, iWindowSize);
+        for (int i = 0; i < matDataList.size(); ++i) {
+            incremental.addTrial(matDataList.at(i));
+        }
+        QCOMPARE(incremental.getNumberTrials(), iWindowSize);
+
+        Network network = incremental.getNetwork();
+        QCOMPARE(network.getConnectivityMethod(), lRefNetworks.at(m).getConnectivityMethod());
+        QCOMPARE(network.getEdges().size(), lRefNetworks.at(m).getEdges().size());
+        QVERIFY(network.getEdges().size() > 0);
+
+        for (int j = 0; j < network.getEdges().size(); ++j) {
+            MatrixXd matWeight = network.getEdges().at(j)->getWeight();
+            MatrixXd matRefWeight = lRefNetworks.at(m).getEdges().at(j)->getWeight();
+            QCOMPARE(matWeight.size(), matRefWeight.size());
+            QVERIFY(((matWeight - matRefWeight).array().abs() < 1e-8 ||
+                     (matWeight.array() != matWeight.array() && matRefWeight.array() != matRefWeight.array())).all());
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectralConnectivity::spectralConnectivitySparseNetwork()
+{
+    //*********************************************************************************************************
+    // Compute the coherence network
+    //*********************************************************************************************************
+
+    QList<MatrixXd> matDataList = readConnectivityData();
+    int iNfft = matDataList.at(0).cols();
+    int iFreq = 10;
+    float fThreshold = 0.1f;
+    int iTopK = 3;
+
+    Network network = Coherence::coherence(matDataList, MatrixX3f(), iNfft, "hanning");
+    QVector<MatrixXd> vecCoh = Coherence::computeCoherence(matDataList, iNfft, "hanning");
+
+    //*********************************************************************************************************
+    // Prune while building the sparse networks, from the network and straight from the metric
+    //*********************************************************************************************************
+
+    SparseNetwork sparseNetwork = SparseNetwork::fromNetwork(network, fThreshold, iTopK, iFreq);
+    SparseNetwork sparseMetric = SparseNetwork::fromConnectivity(vecCoh, MatrixX3f(), "Coherence", fThreshold, iTopK, iFreq);
+
+    QCOMPARE(sparseNetwork.getNumberNodes(), network.getNodes().size());
+    QCOMPARE(sparseNetwork.getRowPointers(), sparseMetric.getRowPointers());
+    QCOMPARE(sparseNetwork.getEndNodes(), sparseMetric.getEndNodes());
+    QCOMPARE(sparseNetwork.getWeights(), sparseMetric.getWeights());
+
+    //*********************************************************************************************************
+    // Every node keeps its strongest edges above the threshold, sorted by end node and without self loops
+    //*********************************************************************************************************
+
+    const QVector<int>& vecRowPtr = sparseNetwork.getRowPointers();
+    const QVector<int>& vecEndNodes = sparseNetwork.getEndNodes();
+    const QVector<float>& vecWeights = sparseNetwork.getWeights();
+
+    for (int i = 0; i < sparseNetwork.getNumberNodes(); ++i) {
+        QVector<double> vecCandidates;
+        for (int j = 0; j < vecCoh.at(i).rows(); ++j) {
+            if (j != i && std::fabs(vecCoh.at(i)(j,iFreq)) >= fThreshold) {
+                vecCandidates.append(std::fabs(vecCoh.at(i)(j,iFreq)));
+            }
+        }
+        std::sort(vecCandidates.begin(), vecCandidates.end());
+
+        int iNEdges = vecRowPtr.at(i+1) - vecRowPtr.at(i);
+        QCOMPARE(iNEdges, qMin(iTopK, vecCandidates.size()));
+
+        for (int e = vecRowPtr.at(i); e < vecRowPtr.at(i+1); ++e) {
+            QVERIFY(vecEndNodes.at(e) != i);
+            QVERIFY(std::fabs(vecWeights.at(e)) >= fThreshold);
+            QVERIFY(std::fabs(vecWeights.at(e)) >= vecCandidates.at(vecCandidates.size() - iNEdges) - 1e-6);
+            QVERIFY(std::fabs(vecWeights.at(e) - vecCoh.at(i)(vecEndNodes.at(e),iFreq)) < 1e-6);
+            if (e > vecRowPtr.at(i)) {
+                QVERIFY(vecEndNodes.at(e-1) < vecEndNodes.at(e));
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectralConnectivity::spectralConnectivityCrossCorrelation()
+{
+    //*********************************************************************************************************
+    // A sinusoid with a period of 50 samples and a copy delayed by 10 samples
+    //*********************************************************************************************************
+
+    int iNSamples = 500;
+    int iPeriod = 50;
+    int iDelay = 10;
+
+    MatrixXd matData(2, iNSamples);
+    for (int n = 0; n < iNSamples; ++n) {
+        matData(0,n) = std::sin(2.0 * M_PI * n / iPeriod);
+        matData(1,n) = std::sin(2.0 * M_PI * (n - iDelay) / iPeriod);
+    }
+
+    MatrixXd matSwapped(2, iNSamples);
+    matSwapped.row(0) = matData.row(1);
+    matSwapped.row(1) = matData.row(0);
+
+    //*********************************************************************************************************
+    // Compare the maximum and its lag with the cross correlation in the time domain, for a lag window which
+    // holds the delay and for one which does not
+    //*********************************************************************************************************
+
+    QList<int> lMaxLags = QList<int>() << -1 << 20 << 4;
+
+    for (int t = 0; t < lMaxLags.size(); ++t) {
+        int iMaxLag = lMaxLags.at(t) < 0 ? iNSamples - 1 : lMaxLags.at(t);
+
+        double dRefMax = -std::numeric_limits<double>::max();
+        int iRefLag = 0;
+        for (int iLag = -iMaxLag; iLag <= iMaxLag; ++iLag) {
+            double dSum = 0.0;
+            for (int m = qMax(0, -iLag); m < qMin(iNSamples, iNSamples - iLag); ++m) {
+                dSum += matData(0,m+iLag) * matData(1,m);
+            }
+            if (dSum > dRefMax) {
+                dRefMax = dSum;
+                iRefLag = iLag;
+            }
+        }
+
+        // Row 1 follows row 0, so the lag of row 0 to row 1 is negative
+        MatrixXi matLag = CrossCorrelation::crossCorrelationLags(matData, lMaxLags.at(t));
+        QCOMPARE(matLag(0,1), iRefLag);
+        QVERIFY(std::abs(matLag(0,1)) <= iMaxLag);
+        QCOMPARE(CrossCorrelation::crossCorrelationLags(matSwapped, lMaxLags.at(t))(0,1), -iRefLag);
+
+        if (iMaxLag >= iDelay) {
+            QCOMPARE(matLag(0,1), -iDelay);
+        } else {
+            QCOMPARE(matLag(0,1), -iMaxLag);
+        }
+
+        // The edge between both nodes is the second one, after the self edge of node 0
+        Network network = CrossCorrelation::crossCorrelation(QList<MatrixXd>() << matData, MatrixX3f(), lMaxLags.at(t));
+        QVERIFY(std::fabs(network.getEdges().at(1)->getWeight()(0,0) - dRefMax) < 1e-6 * std::fabs(dRefMax));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectralConnectivity::spectralConnectivityRoiReduction()
+{
+    //*********************************************************************************************************
+    // Source space with known orientations in one label per hemisphere
+    //*********************************************************************************************************
+
+    QFile t_fileSrc(QDir::currentPath()+"./MNE-sample-data/subjects/sample/bem/sample-oct-6-src.fif");
+    FiffStream::SPtr t_pStream(new FiffStream(&t_fileSrc));
+    QVERIFY(t_pStream->open());
+
+    MNESourceSpace sourceSpace;
+    QVERIFY(MNESourceSpace::readFromStream(t_pStream, true, sourceSpace));
+    QCOMPARE(sourceSpace.size(), 2);
+
+    // Normals along +-z in the left and along +-x in the right label, the expected flips follow the sign
+    MatrixX3f matNormalsLh(6,3);
+    matNormalsLh << 0,0,1, 0,0,1, 0,0,-1, 0.1f,0,0.995f, 0,0,-1, 0,0,1;
+    VectorXd vecFlipLh(6);
+    vecFlipLh << 1, 1, -1, 1, -1, 1;
+
+    MatrixX3f matNormalsRh(5,3);
+    matNormalsRh << 1,0,0, -1,0,0, 1,0,0, 0.995f,0.1f,0, -1,0,0;
+    VectorXd vecFlipRh(5);
+    vecFlipRh << 1, -1, 1, 1, -1;
+
+    QList<MatrixX3f> lNormals = QList<MatrixX3f>() << matNormalsLh << matNormalsRh;
+    QList<VectorXd> lFlips = QList<VectorXd>() << vecFlipLh << vecFlipRh;
+    QList<Label> lLabels;
+    QList<VectorXi> lRows;
+
+    int iNSourcesLh = sourceSpace[0].vertno.size();
+    for (int h = 0; h < 2; ++h) {
+        int iN = lNormals.at(h).rows();
+        VectorXi vecVertices = sourceSpace[h].vertno.head(iN);
+        for (int i = 0; i < iN; ++i) {
+            sourceSpace[h].nn.row(vecVertices(i)) = lNormals.at(h).row(i).normalized();
+        }
+
+        lLabels.append(Label(vecVertices, MatrixX3f::Zero(iN,3), VectorXd::Zero(iN), h, QString("label_%1").arg(h)));
+        lRows.append(VectorXi::LinSpaced(iN, h * iNSourcesLh, h * iNSourcesLh + iN - 1));
+    }
+
+    //*********************************************************************************************************
+    // Each label carries one signal, signed by the flip of its sources, plus noise
+    //*********************************************************************************************************
+
+    int iNSources = iNSourcesLh + sourceSpace[1].vertno.size();
+    int iNSamples = 200;
+
+    RowVectorXd vecSignal(iNSamples);
+    for (int t = 0; t < iNSamples; ++t) {
+        vecSignal(t) = std::sin(2.0 * M_PI * t / 40.0) + 0.5 * std::sin(2.0 * M_PI * t / 13.0);
+    }
+
+    std::srand(7);
+    MatrixXd matData = 0.05 * MatrixXd::Random(iNSources, iNSamples);
+    for (int h = 0; h < 2; ++h) {
+        for (int i = 0; i < lRows.at(h).size(); ++i) {
+            matData.row(lRows.at(h)(i)) += lFlips.at(h)(i) * (1.0 + 0.2 * i) * vecSignal;
+        }
+    }
+
+    //*********************************************************************************************************
+    // Compare with extract_label_time_course of mne-python. The flip is the sign of the normals projected on
+    // their first right singular vector, oriented so that the projections are positive on average:
+    //
+    //     _, _, Vh = linalg.svd(ori, full_matrices=False)
+    //     dots = np.dot(ori, Vh[0]); if np.mean(dots) < 0: dots *= -1
+    //     flip = np.sign(dots)
+    //
+    //     mean:       np.mean(label_tc, axis=0)
+    //     mean_flip:  np.mean(flip[:, np.newaxis] * label_tc, axis=0)
+    //     pca_flip:   U, s, V = linalg.svd(label_tc, full_matrices=False)
+    //                 sign = np.sign(np.dot(U[:, 0], flip)); scale = linalg.norm(s) / np.sqrt(len(vertidx))
+    //                 label_tc = sign * scale * V[0]
+    //*********************************************************************************************************
+
+    QList<SourceRoiReduction::ReductionMode> lModes = QList<SourceRoiReduction::ReductionMode>()
+            << SourceRoiReduction::Mean << SourceRoiReduction::MeanFlip << SourceRoiReduction::PcaFlip;
+
+    for (int m = 0; m < lModes.size(); ++m) {
+        SourceRoiReduction reduction;
+        QVERIFY(reduction.init(sourceSpace, lLabels, lModes.at(m), matData));
+        QCOMPARE(reduction.getLabels().size(), 2);
+
+        MatrixXd matRoiData = reduction.reduce(matData);
+        QCOMPARE(matRoiData.rows(), 2);
+        QCOMPARE(matRoiData.cols(), iNSamples);
+
+        for (int h = 0; h < 2; ++h) {
+            int iN = lRows.at(h).size();
+            MatrixXd matLabelData(iN, iNSamples);
+            for (int i = 0; i < iN; ++i) {
+                matLabelData.row(i) = matData.row(lRows.at(h)(i));
+            }
+
+            RowVectorXd vecRef;
+            if (lModes.at(m) == SourceRoiReduction::Mean) {
+                vecRef = matLabelData.colwise().mean();
+            } else if (lModes.at(m) == SourceRoiReduction::MeanFlip) {
+                vecRef = (lFlips.at(h).asDiagonal() * matLabelData).colwise().mean();
+            } else {
+                JacobiSVD<MatrixXd> svd(matLabelData, ComputeThinU | ComputeThinV);
+                double dSign = svd.matrixU().col(0).dot(lFlips.at(h)) < 0.0 ? -1.0 : 1.0;
+                double dScale = svd.singularValues().norm() / std::sqrt(double(iN));
+                vecRef = dSign * dScale * svd.matrixV().col(0).transpose();
+            }
+
+            QVERIFY((matRoiData.row(h) - vecRef).norm() < 1e-8 * vecRef.norm());
+
+            // With the flip the label signal is recovered with its sign, without it the flipped sources cancel
+            if (lModes.at(m) != SourceRoiReduction::Mean) {
+                QVERIFY(matRoiData.row(h).dot(vecSignal) > 0.9 * matRoiData.row(h).norm() * vecSignal.norm());
+            }
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectralConnectivity::spectralConnectivityGraphMetrics()
+{
+    //*********************************************************************************************************
+    // Shortest paths of the coherence network against Floyd-Warshall
+    //*********************************************************************************************************
+
+    QList<MatrixXd> matDataList = readConnectivityData();
+    int iNfft = matDataList.at(0).cols();
+
+    Network network = Coherence::coherence(matDataList, MatrixX3f(), iNfft, "hanning");
+    GraphMeasures measures = GraphMetrics::computeMeasures(network);
+
+    MatrixXd matWeights = GraphMetrics::weightMatrix(network.getConnectivityMatrix());
+    int iNNodes = matWeights.rows();
+
+    MatrixXd matFloyd = (matWeights.array() > 0.0).select(matWeights.cwiseInverse(), std::numeric_limits<double>::infinity());
+    matFloyd.diagonal().setZero();
+    for (int k = 0; k < iNNodes; ++k) {
+        for (int i = 0; i < iNNodes; ++i) {
+            for (int j = 0; j < iNNodes; ++j) {
+                matFloyd(i,j) = qMin(matFloyd(i,j), matFloyd(i,k) + matFloyd(k,j));
+            }
+        }
+    }
+
+    QCOMPARE(measures.matDistances.rows(), iNNodes);
+    for (int i = 0; i < iNNodes; ++i) {
+        for (int j = 0; j < iNNodes; ++j) {
+            QVERIFY(std::fabs(measures.matDistances(i,j) - matFloyd(i,j)) < 1e-10);
+        }
+        QVERIFY(measures.vecClustering(i) >= 0.0 && measures.vecClustering(i) <= 1.0 + 1e-10);
+    }
+    QVERIFY(measures.dModularity >= -1e-10);
+
+    //*********************************************************************************************************
+    // Two cliques joined by a weak edge split into two communities
+    //*********************************************************************************************************
+
+    MatrixXd matCliques = MatrixXd::Zero(8,8);
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            if (i != j && (i < 4) == (j < 4)) {
+                matCliques(i,j) = 1.0;
+            }
+        }
+    }
+    matCliques(3,4) = matCliques(4,3) = 0.1;
+
+    VectorXi vecCommunities = GraphMetrics::communities(matCliques);
+    QCOMPARE(vecCommunities.maxCoeff(), 1);
+    for (int i = 1; i < 8; ++i) {
+        QCOMPARE(vecCommunities(i) == vecCommunities(0), i < 4);
+    }
+
+    // Q = sum over communities of within/2m - (strength/2m)^2
+    double dTotal = matCliques.sum();
+    double dExpected = 2.0 * (12.0 / dTotal - std::pow(12.1 / dTotal, 2));
+    QVERIFY(std::fabs(GraphMetrics::modularity(matCliques, vecCommunities) - dExpected) < 1e-12);
+
+    VectorXd vecClustering = GraphMetrics::clusteringCoefficient(matCliques);
+    QVERIFY(std::fabs(vecClustering(0) - 1.0) < 1e-12);
+    QVERIFY(vecClustering(3) < 1.0);
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectralConnectivity::spectralConnectivitySurrogates()
+{
+    //*********************************************************************************************************
+    // Generate data: row 1 follows row 0, row 2 is independent, 30 trials, 128 samples
+    //*********************************************************************************************************
+
+    QList<MatrixXd> matDataList;
+    qsrand(13);
+    for (int i = 0; i < 30; ++i) {
+        MatrixXd matTrial(3, 128);
+        for (int r = 0; r < matTrial.rows(); ++r) {
+            for (int c = 0; c < matTrial.cols(); ++c) {
+                matTrial(r,c) = double(qrand()) / RAND_MAX - 0.5;
+            }
+        }
+        matTrial.row(1) = matTrial.row(0) + 0.5 * matTrial.row(1);
+        matDataList.append(matTrial);
+    }
+
+    ConnectivitySettings settings;
+    settings.m_matDataList = matDataList;
+    settings.m_iNfft = 128;
+
+    //*********************************************************************************************************
+    // The coupled pair is never reached by a surrogate, all p-values are valid and reproducible
+    //*********************************************************************************************************
+
+    int iNSurrogates = 99;
+    double dMinP = 1.0 / (iNSurrogates + 1);
+
+    for (int type = 0; type < 2; ++type) {
+        ConnectivityStatistics::SurrogateType surrogateType = static_cast<ConnectivityStatistics::SurrogateType>(type);
+
+        SurrogateResult result = ConnectivityStatistics::surrogateTest(settings, "COH", iNSurrogates, surrogateType, 5);
+        SurrogateResult repeated = ConnectivityStatistics::surrogateTest(settings, "COH", iNSurrogates, surrogateType, 5);
+
+        QCOMPARE(result.iNSurrogates, iNSurrogates);
+        QCOMPARE(result.vecPValues.size(), 3);
+        QVERIFY(result.vecPValues.at(0) == repeated.vecPValues.at(0));
+
+        // Leave out the DC bin, its phase carries no information
+        const MatrixXd& matPValues = result.vecPValues.at(0);
+        for (int f = 1; f < matPValues.cols(); ++f) {
+            QVERIFY(std::fabs(matPValues(1,f) - dMinP) < 1e-12);
+            QVERIFY(matPValues(2,f) >= dMinP - 1e-12 && matPValues(2,f) <= 1.0 + 1e-12);
+        }
+
+        // The independent pair is not significant on most frequencies
+        int iNSignificant = (matPValues.row(2).array() <= 0.02).count();
+        QVERIFY(iNSignificant < matPValues.cols() / 10);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestSpectralConnectivity::spectralConnectivityScaling()
+{
+    //*********************************************************************************************************
+    // Generate data: 16 channels, 128 trials, 256 samples
+    //*********************************************************************************************************
+
+    QList<MatrixXd> matDataList;
+    qsrand(7);
+    for (int i = 0; i < 128; ++i) {
+        MatrixXd matTrial(16, 256);
+        for (int r = 0; r < matTrial.rows(); ++r) {
+            for (int c = 0; c < matTrial.cols(); ++c) {
+                matTrial(r,c) = double(qrand()) / RAND_MAX - 0.5;
+            }
+        }
+        matDataList.append(matTrial);
+    }
+
+    TaperedSpectra spectra = AbstractMetric::computeTaperedSpectra(matDataList, 256, "hanning");
+
+    //*********************************************************************************************************
+    // Time the trial map-reduce with an increasing number of threads
+    //*********************************************************************************************************
+
+    int iMaxThreads = QThreadPool::globalInstance()->maxThreadCount();
+    QList<int> lThreads;
+    for (int n = 1; n < iMaxThreads; n *= 2) {
+        lThreads << n;
+    }
+    lThreads << iMaxThreads;
+
+    QVector<MatrixXd> vecRefWPLI, vecRefPLI;
+    double dRefTime = 0.0;
+    QElapsedTimer timer;
+
+    for (int t = 0; t < lThreads.size(); ++t) {
+        QThreadPool::globalInstance()->setMaxThreadCount(lThreads.at(t));
+
+        timer.start();
+        QVector<MatrixXd> vecWPLI = WeightedPhaseLagIndex::computeWPLI(spectra);
+        QVector<MatrixXd> vecPLI = PhaseLagIndex::computePLI(spectra);
+        double dTime = timer.nsecsElapsed() / 1.0e6;
+
+        if (t == 0) {
+            vecRefWPLI = vecWPLI;
+            vecRefPLI = vecPLI;
+            dRefTime = dTime;
+        } else {
+            // Only the grouping of the sums changes
+            for (int j = 0; j < vecWPLI.size(); ++j) {
+                QVERIFY((vecWPLI.at(j) - vecRefWPLI.at(j)).cwiseAbs().maxCoeff() < 1e-10);
+                QVERIFY((vecPLI.at(j) - vecRefPLI.at(j)).cwiseAbs().maxCoeff() < 1e-10);
+            }
+        }
+
+        printf("WPLI + PLI with %2d threads: %8.1f ms (speedup %.2f)\n", lThreads.at(t), dTime, dRefTime / dTime);
+    }
+
+    QThreadPool::globalInstance()->setMaxThreadCount(iMaxThreads);
+}
+
+
 //*************************************************************************************************************
 
 QList<MatrixXd> TestSpectralConnectivity::readConnectivityData()
@@ -429,6 +1066,60 @@ void TestSpectralConnectivity::compareConnectivity()
 }
 
 
+//*************************************************************************************************************
+
+void TestSpectralConnectivity::spectralBatchedSpectra()
+{
+    //*********************************************************************************************************
+    // Generate data: 9 channels, 250 samples, zero-padded to an FFT length of 301
+    //*********************************************************************************************************
+
+    MatrixXd matData(9, 250);
+    qsrand(11);
+    for (int r = 0; r < matData.rows(); ++r) {
+        for (int c = 0; c < matData.cols(); ++c) {
+            matData(r,c) = double(qrand()) / RAND_MAX - 0.5;
+        }
+    }
+    int iNfft = 301;
+
+    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(matData.cols(), "hanning");
+
+    //*********************************************************************************************************
+    // Compare the batched spectra with the row-wise ones
+    //*********************************************************************************************************
+
+    QVector<MatrixXcd> vecTapSpectra = Spectral::computeTaperedSpectraMatrix(matData, tapers.first, iNfft);
+    QVector<MatrixXcd> vecTapSpectraSerial = Spectral::computeTaperedSpectraMatrix(matData, tapers.first, iNfft, false);
+    QVector<MatrixXcf> vecTapSpectraFloat = Spectral::computeTaperedSpectraMatrix(MatrixXf(matData.cast<float>()),
+                                                                                   MatrixXf(tapers.first.cast<float>()),
+                                                                                   iNfft);
+    MatrixXd matPsd = Spectral::psdFromTaperedSpectraMatrix(vecTapSpectra, tapers.second, iNfft);
+
+    QCOMPARE(vecTapSpectra.size(), int(matData.rows()));
+    QCOMPARE(vecTapSpectraFloat.size(), int(matData.rows()));
+    QCOMPARE(int(matPsd.rows()), int(matData.rows()));
+
+    for (int r = 0; r < matData.rows(); ++r) {
+        MatrixXcd matTapSpectrum = Spectral::computeTaperedSpectra(matData.row(r), tapers.first, iNfft);
+        RowVectorXd vecPsd = Spectral::psdFromTaperedSpectra(matTapSpectrum, tapers.second, iNfft);
+        double dNorm = matTapSpectrum.norm();
+
+        QVERIFY((vecTapSpectra.at(r) - matTapSpectrum).norm() <= 1e-12 * dNorm);
+        QVERIFY(vecTapSpectraSerial.at(r) == vecTapSpectra.at(r));
+        QVERIFY((vecTapSpectraFloat.at(r).cast<std::complex<double> >() - matTapSpectrum).norm() <= 1e-5 * dNorm);
+        QVERIFY((matPsd.row(r) - vecPsd).norm() <= 1e-12 * vecPsd.norm());
+    }
+
+    //*********************************************************************************************************
+    // The cached tapers are the same
+    //*********************************************************************************************************
+
+    QVERIFY(Spectral::generateTapers(matData.cols(), "hanning").first == tapers.first);
+    QCOMPARE(int(Spectral::generateTapers(matData.cols(), "ones").first.cols()), int(matData.cols()));
+}
+
+
 //*************************************************************************************************************
 
 void TestSpectralConnectivity::cleanupTestCase()
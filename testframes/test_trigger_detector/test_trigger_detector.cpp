@@ -0,0 +1,227 @@
+//=============================================================================================================
+/**
+* @file     test_trigger_detector.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the stream indexing of the TriggerDetector
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/triggerdetector.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestTriggerDetector
+*
+* @brief The TestTriggerDetector class pins the stream indexing of the TriggerDetector: event samples are counted
+*        from the first sample of the stream, and the level offset is the first sample of the stream, not of the
+*        block
+*
+*/
+class TestTriggerDetector: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestTriggerDetector();
+
+private slots:
+    void initTestCase();
+    void streamIndexing();
+    void blockBorderFlank();
+    void streamOffset();
+    void burstAcrossBlocks();
+    void cleanupTestCase();
+
+private:
+    QList<qint64> detectBlocks(TriggerDetector& detector, const RowVectorXd& vecSignal, qint32 iBlockSize);
+};
+
+
+//*************************************************************************************************************
+
+TestTriggerDetector::TestTriggerDetector()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestTriggerDetector::initTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestTriggerDetector::streamIndexing()
+{
+    TriggerDetector detector(QList<int>() << 0, 0.5, TriggerDetector::LevelMode, false, 0);
+
+    MatrixXd matBlock = MatrixXd::Zero(1, 10);
+    QCOMPARE(detector.detect(matBlock), 0);
+    QCOMPARE(detector.blockStart(), qint64(0));
+
+    // The flank is the fourth sample of the second block
+    matBlock.rightCols(7).setOnes();
+    QCOMPARE(detector.detect(matBlock), 1);
+    QCOMPARE(detector.blockStart(), qint64(10));
+    QCOMPARE(detector.event(0).iChannel, 0);
+    QCOMPARE(detector.event(0).iSample, qint64(13));
+    QCOMPARE(detector.event(0).iSample - detector.blockStart(), qint64(3));
+
+    // reset() starts counting from zero again
+    detector.reset();
+    QCOMPARE(detector.detect(matBlock), 1);
+    QCOMPARE(detector.blockStart(), qint64(0));
+    QCOMPARE(detector.event(0).iSample, qint64(3));
+}
+
+
+//*************************************************************************************************************
+
+void TestTriggerDetector::blockBorderFlank()
+{
+    TriggerDetector detector(QList<int>() << 0, 0.5, TriggerDetector::LevelMode, false, 0);
+
+    // The flank is the first sample of the second block, the signal stays high afterwards
+    RowVectorXd vecSignal = RowVectorXd::Zero(40);
+    vecSignal.tail(30).setOnes();
+
+    QList<qint64> lEvents = detectBlocks(detector, vecSignal, 10);
+
+    QCOMPARE(lEvents.size(), 1);
+    QCOMPARE(lEvents[0], qint64(10));
+}
+
+
+//*************************************************************************************************************
+
+void TestTriggerDetector::streamOffset()
+{
+    TriggerDetector detector(QList<int>() << 0 << 1, 0.5, TriggerDetector::LevelMode, true, 0);
+
+    // Both channels sit on a baseline of 5 which is above the threshold. Channel 1 steps up with the first sample
+    // of the second block. An offset taken from the first sample of each block would hide that flank.
+    MatrixXd matBlock = MatrixXd::Constant(2, 10, 5.0);
+    QCOMPARE(detector.detect(matBlock), 0);
+
+    matBlock.row(1).setConstant(5.6);
+    QCOMPARE(detector.detect(matBlock), 1);
+    QCOMPARE(detector.event(0).iChannel, 1);
+    QCOMPARE(detector.event(0).iSample, qint64(10));
+    QCOMPARE(detector.event(0).dValue, 5.6);
+
+    QCOMPARE(detector.detect(matBlock), 0);
+}
+
+
+//*************************************************************************************************************
+
+void TestTriggerDetector::burstAcrossBlocks()
+{
+    TriggerDetector detector(QList<int>() << 0, 0.5, TriggerDetector::LevelMode, false, 5);
+
+    // Single sample pulses, the one at 11 falls into the hold-off of the one at 8 in the previous block
+    RowVectorXd vecSignal = RowVectorXd::Zero(30);
+    vecSignal(8) = 1.0;
+    vecSignal(11) = 1.0;
+    vecSignal(15) = 1.0;
+
+    QList<qint64> lEvents = detectBlocks(detector, vecSignal, 10);
+
+    QCOMPARE(lEvents.size(), 2);
+    QCOMPARE(lEvents[0], qint64(8));
+    QCOMPARE(lEvents[1], qint64(15));
+}
+
+
+//*************************************************************************************************************
+
+void TestTriggerDetector::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+QList<qint64> TestTriggerDetector::detectBlocks(TriggerDetector& detector, const RowVectorXd& vecSignal, qint32 iBlockSize)
+{
+    QList<qint64> lEvents;
+
+    for(qint32 i = 0; i < vecSignal.cols(); i += iBlockSize) {
+        MatrixXd matBlock = vecSignal.segment(i, qMin(iBlockSize, (qint32)vecSignal.cols() - i));
+
+        qint32 iEvents = detector.detect(matBlock);
+        for(qint32 j = 0; j < iEvents; ++j)
+            lEvents.append(detector.event(j).iSample);
+    }
+
+    return lEvents;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestTriggerDetector)
+#include "test_trigger_detector.moc"
@@ -0,0 +1,297 @@
+//=============================================================================================================
+/**
+* @file     test_wavelettfr.cpp
+* @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>;
+*           Matti Hamalainen <msh@nmr.mgh.harvard.edu>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, Christoph Dinh and Matti Hamalainen. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the Morlet and multitaper time-frequency transform
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/wavelettfr.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtMath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestWaveletTfr
+*
+* @brief The TestWaveletTfr class verifies the tapers, the power and coherence of known signals and that
+*        batches and projections give the same result as single epochs and projected data
+*
+*/
+class TestWaveletTfr: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestWaveletTfr();
+
+private slots:
+    void initTestCase();
+    void compareDpss();
+    void compareSine_data();
+    void compareSine();
+    void compareBatches_data();
+    void compareBatches();
+    void compareProjection_data();
+    void compareProjection();
+    void cleanupTestCase();
+
+private:
+    void addMethods();
+
+    VectorXd            m_vecFreqs;     /**< Frequencies of the transforms. */
+    double              m_dSFreq;       /**< Sampling frequency. */
+    int                 m_iSamples;     /**< Samples per epoch. */
+    QList<MatrixXd>     m_lEpochs;      /**< Random multi-channel test epochs. */
+};
+
+
+//*************************************************************************************************************
+
+TestWaveletTfr::TestWaveletTfr()
+: m_dSFreq(500.0)
+, m_iSamples(400)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestWaveletTfr::initTestCase()
+{
+    m_vecFreqs.resize(3);
+    m_vecFreqs << 10.0, 20.0, 40.0;
+
+    //More epochs than one batch
+    for(int e = 0; e < 70; ++e)
+        m_lEpochs.append(MatrixXd::Random(6, m_iSamples));
+}
+
+
+//*************************************************************************************************************
+
+void TestWaveletTfr::addMethods()
+{
+    QTest::addColumn<int>("method");
+
+    QTest::newRow("Morlet") << int(WaveletTfr::Morlet);
+    QTest::newRow("Multitaper") << int(WaveletTfr::Multitaper);
+}
+
+
+//*************************************************************************************************************
+
+void TestWaveletTfr::compareDpss()
+{
+    //The tapers are the leading eigenvectors of the tridiagonal matrix commuting with the concentration problem
+    const int iLength = 64;
+    const double dHalfBandwidth = 2.5;
+    const int iTapers = 4;
+
+    MatrixXd matTapers = WaveletTfr::dpss(iLength, dHalfBandwidth, iTapers);
+    QCOMPARE(int(matTapers.rows()), iTapers);
+    QCOMPARE(int(matTapers.cols()), iLength);
+
+    MatrixXd matTridiag = MatrixXd::Zero(iLength, iLength);
+    for(int i = 0; i < iLength; ++i) {
+        double x = (iLength - 1 - 2.0 * i) / 2.0;
+        matTridiag(i, i) = x * x * qCos(2.0 * M_PI * dHalfBandwidth / iLength);
+    }
+    for(int i = 1; i < iLength; ++i)
+        matTridiag(i, i - 1) = matTridiag(i - 1, i) = i * (iLength - i) / 2.0;
+
+    SelfAdjointEigenSolver<MatrixXd> solver(matTridiag);
+    for(int k = 0; k < iTapers; ++k) {
+        VectorXd vecRef = solver.eigenvectors().col(iLength - 1 - k);
+        VectorXd vecTaper = matTapers.row(k).transpose();
+        QVERIFY(qMin((vecRef - vecTaper).norm(), (vecRef + vecTaper).norm()) < 1e-10);
+    }
+
+    QVERIFY((matTapers * matTapers.transpose() - MatrixXd::Identity(iTapers, iTapers)).norm() < 1e-10);
+    QVERIFY(matTapers.row(0).sum() > 0.0);
+}
+
+
+//*************************************************************************************************************
+
+void TestWaveletTfr::compareSine_data()
+{
+    addMethods();
+}
+
+
+//*************************************************************************************************************
+
+void TestWaveletTfr::compareSine()
+{
+    QFETCH(int, method);
+
+    MatrixXd matSine(1, m_iSamples);
+    for(int i = 0; i < m_iSamples; ++i)
+        matSine(0, i) = qSin(2.0 * M_PI * 20.0 * i / m_dSFreq);
+
+    WaveletTfr tfr;
+    QVERIFY(tfr.prepare(m_vecFreqs, m_dSFreq, m_iSamples, WaveletTfr::Method(method), 5.0));
+    QVERIFY(tfr.addEpochs(QList<MatrixXd>() << matSine << matSine << matSine));
+    QCOMPARE(tfr.epochs(), 3);
+
+    //The power peaks at the frequency of the tone, identical Morlet epochs are fully coherent
+    MatrixXd matPower = tfr.power(0);
+    int iMid = m_iSamples / 2;
+    QVERIFY(matPower(1, iMid) > 100.0 * matPower(0, iMid));
+    QVERIFY(matPower(1, iMid) > 100.0 * matPower(2, iMid));
+
+    if(method == WaveletTfr::Morlet)
+        QVERIFY(qAbs(tfr.itc(0)(1, iMid) - 1.0) < 1e-10);
+}
+
+
+//*************************************************************************************************************
+
+void TestWaveletTfr::compareBatches_data()
+{
+    addMethods();
+}
+
+
+//*************************************************************************************************************
+
+void TestWaveletTfr::compareBatches()
+{
+    QFETCH(int, method);
+
+    WaveletTfr single;
+    QVERIFY(single.prepare(m_vecFreqs, m_dSFreq, m_iSamples, WaveletTfr::Method(method), 5.0));
+    for(int e = 0; e < m_lEpochs.size(); ++e)
+        QVERIFY(single.addEpoch(m_lEpochs[e]));
+
+    WaveletTfr batched;
+    QVERIFY(batched.prepare(m_vecFreqs, m_dSFreq, m_iSamples, WaveletTfr::Method(method), 5.0));
+    QVERIFY(batched.addEpochs(m_lEpochs));
+
+    QCOMPARE(batched.epochs(), single.epochs());
+    for(int r = 0; r < single.rows(); ++r) {
+        QVERIFY((single.power(r) - batched.power(r)).cwiseAbs().maxCoeff() < 1e-10);
+        QVERIFY((single.itc(r) - batched.itc(r)).cwiseAbs().maxCoeff() < 1e-10);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestWaveletTfr::compareProjection_data()
+{
+    addMethods();
+}
+
+
+//*************************************************************************************************************
+
+void TestWaveletTfr::compareProjection()
+{
+    QFETCH(int, method);
+
+    //Three sources with three orientations each and a per source scale as the noise normalization
+    MatrixXd matKernel = MatrixXd::Random(9, m_lEpochs.first().rows());
+    VectorXd vecScale(3);
+    vecScale << 1.0, 2.0, 3.0;
+
+    WaveletTfr projected;
+    QVERIFY(projected.prepare(m_vecFreqs, m_dSFreq, m_iSamples, WaveletTfr::Method(method), 5.0));
+    projected.setProjection(matKernel, 3, vecScale);
+    QVERIFY(projected.addEpochs(m_lEpochs));
+    QCOMPARE(projected.rows(), 3);
+
+    //The transform is linear, so it is the same on the projected data
+    QList<MatrixXd> lProjectedEpochs;
+    for(int e = 0; e < m_lEpochs.size(); ++e)
+        lProjectedEpochs.append(matKernel * m_lEpochs[e]);
+
+    WaveletTfr reference;
+    QVERIFY(reference.prepare(m_vecFreqs, m_dSFreq, m_iSamples, WaveletTfr::Method(method), 5.0));
+    QVERIFY(reference.addEpochs(lProjectedEpochs));
+
+    for(int r = 0; r < 3; ++r) {
+        MatrixXd matRef = MatrixXd::Zero(m_vecFreqs.size(), m_iSamples);
+        for(int o = 0; o < 3; ++o)
+            matRef += reference.power(3 * r + o);
+        matRef *= vecScale(r) * vecScale(r);
+
+        QVERIFY((projected.power(r) - matRef).cwiseAbs().maxCoeff() < 1e-10 * matRef.maxCoeff());
+        QVERIFY((projected.powerAtFrequency(1).row(r) - projected.power(r).row(1)).norm() < 1e-10 * matRef.maxCoeff());
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestWaveletTfr::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestWaveletTfr)
+#include "test_wavelettfr.moc"
@@ -41,17 +41,36 @@ SUBDIRS += \
     test_codecov \
     test_dipole_fit \
     test_fiff_rwr \
+    test_fiff_raw_kernels \
+    test_rtresample \
+    test_rtfilter \
+    test_fftfilterbatch \
+    test_rtstreamaligner \
+    test_rtrawcodec \
+    test_rtshmemring \
+    test_wavelettfr \
+    test_ica \
+    test_mne_math \
+    test_kmeans \
+    test_trigger_detector \
     test_fiff_mne_types_io \
     test_forward_solution \
     test_fiff_cov \
     test_fiff_digitizer \
     test_mne_msh_display_surface_set \
+    test_mne_project_to_surface \
+    test_mne_fiff_scanner \
 
 !contains(MNECPP_CONFIG, minimalVersion) {
     qtHaveModule(charts) {
         SUBDIRS += \
             test_interpolation \
             test_geometryinfo \
+            test_geometryregistry \
             test_spectral_connectivity
     }
 }
+
+contains(MNECPP_CONFIG, withBenchmarks) {
+    SUBDIRS += benchmarks
+}